@@ -2367,6 +2367,55 @@ void TF_SessionRun(TF_Session* session, const TF_Buffer* run_options,
                 status);
 }
 
+void TF_SessionRunWithOutputTensors(
+    TF_Session* session, const TF_Buffer* run_options, const TF_Output* inputs,
+    TF_Tensor* const* input_values, int ninputs, const TF_Output* outputs,
+    TF_Tensor* const* output_values, int noutputs,
+    const TF_Operation* const* target_opers, int ntargets,
+    TF_Buffer* run_metadata, TF_Status* status) {
+  for (int i = 0; i < noutputs; ++i) {
+    const DataType dtype =
+        static_cast<DataType>(TF_TensorType(output_values[i]));
+    if (!tensorflow::DataTypeCanUseMemcpy(dtype)) {
+      status->status = InvalidArgument(
+          "Unsupported dtype ", tensorflow::DataTypeString(dtype),
+          " for caller-owned output ", i);
+      return;
+    }
+  }
+
+  std::vector<TF_Tensor*> fetched(noutputs, nullptr);
+  TF_SessionRun(session, run_options, inputs, input_values, ninputs, outputs,
+                fetched.data(), noutputs, target_opers, ntargets, run_metadata,
+                status);
+  for (int i = 0; i < noutputs && status->status.ok(); ++i) {
+    TF_Tensor* src = fetched[i];
+    TF_Tensor* dst = output_values[i];
+    Tensor src_tensor, dst_tensor;
+    status->status = TF_TensorToTensor(src, &src_tensor);
+    if (!status->status.ok()) break;
+    status->status = TF_TensorToTensor(dst, &dst_tensor);
+    if (!status->status.ok()) break;
+    if (src_tensor.dtype() != dst_tensor.dtype() ||
+        src_tensor.shape() != dst_tensor.shape()) {
+      status->status = InvalidArgument(
+          "Output ", OutputName(outputs[i]), " is a ",
+          tensorflow::DataTypeString(src_tensor.dtype()), " tensor of shape ",
+          src_tensor.shape().DebugString(), " but caller-owned output ", i,
+          " is a ", tensorflow::DataTypeString(dst_tensor.dtype()),
+          " tensor of shape ", dst_tensor.shape().DebugString());
+      break;
+    }
+    // The fetched tensor already aliases the caller's buffer when e.g. a fed
+    // view is fetched through an op that forwards its input.
+    const size_t num_bytes = src_tensor.TotalBytes();
+    if (num_bytes > 0 && TF_TensorData(src) != TF_TensorData(dst)) {
+      std::memcpy(TF_TensorData(dst), TF_TensorData(src), num_bytes);
+    }
+  }
+  for (TF_Tensor* t : fetched) TF_DeleteTensor(t);
+}
+
 void TF_SessionPRunSetup(TF_Session* session, const TF_Output* inputs,
                          int ninputs, const TF_Output* outputs, int noutputs,
                          const TF_Operation* const* target_opers, int ntargets,
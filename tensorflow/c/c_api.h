@@ -1285,6 +1285,33 @@ TF_CAPI_EXPORT extern void TF_SessionRun(
     // Output status
     TF_Status*);
 
+// Like TF_SessionRun, but writes the outputs into caller-owned tensors.
+//
+// On entry output_values[i] must be a tensor with the dtype and shape of
+// outputs[i], typically a view created by TF_NewTensor with a NULL deallocator
+// over a buffer owned by the caller (e.g. a response buffer). The buffer must
+// be aligned to TF_TensorDefaultAlignment(), since TF_NewTensor copies
+// misaligned buffers. On success the contents of output_values[i] are
+// replaced by the value of outputs[i]; the data is not copied when the
+// fetched tensor already aliases that buffer. Ownership of output_values[]
+// stays with the caller. Only numeric (memcpy-able) dtypes are supported.
+//
+// On failure, the contents of output_values[] are unspecified.
+TF_CAPI_EXPORT extern void TF_SessionRunWithOutputTensors(
+    TF_Session* session,
+    // RunOptions
+    const TF_Buffer* run_options,
+    // Input tensors
+    const TF_Output* inputs, TF_Tensor* const* input_values, int ninputs,
+    // Output tensors
+    const TF_Output* outputs, TF_Tensor* const* output_values, int noutputs,
+    // Target operations
+    const TF_Operation* const* target_opers, int ntargets,
+    // RunMetadata
+    TF_Buffer* run_metadata,
+    // Output status
+    TF_Status*);
+
 // Set up the graph with the intended feeds (inputs) and fetches (outputs) for a
 // sequence of partial run calls.
 //
@@ -154,6 +154,18 @@ TEST(CAPI, Tensor) {
 
 void NoOpDeallocator(void* data, size_t, void*) {}
 
+TEST(CAPI, TensorViewWithoutDeallocator) {
+  alignas(EIGEN_MAX_ALIGN_BYTES) float values[6] = {1, 2, 3, 4, 5, 6};
+  int64_t dims[] = {2, 3};
+  TF_Tensor* t = TF_NewTensor(TF_FLOAT, dims, 2, values, sizeof(values),
+                              /*deallocator=*/nullptr, nullptr);
+  ASSERT_TRUE(t != nullptr);
+  EXPECT_EQ(static_cast<void*>(values), TF_TensorData(t));
+  TF_DeleteTensor(t);
+  // The buffer of the view is still owned, and usable, by the caller.
+  EXPECT_EQ(6, values[5]);
+}
+
 TEST(CAPI, MalformedTensor) {
   // See https://github.com/tensorflow/tensorflow/issues/7394
   // num_dims = 0 implies a scalar, so should be backed by at least 4 bytes of
@@ -1051,6 +1063,55 @@ TEST(CAPI, Session) {
   TF_DeleteStatus(s);
 }
 
+TEST(CAPI, SessionRunWithOutputTensors) {
+  TF_Status* s = TF_NewStatus();
+  TF_Graph* graph = TF_NewGraph();
+  TF_Operation* feed = Placeholder(graph, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_Operation* two = ScalarConst(2, graph, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_Operation* add = Add(feed, two, graph, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_SessionOptions* opts = TF_NewSessionOptions();
+  TF_Session* session = TF_NewSession(graph, opts, s);
+  TF_DeleteSessionOptions(opts);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  alignas(EIGEN_MAX_ALIGN_BYTES) int32 input = 3;
+  alignas(EIGEN_MAX_ALIGN_BYTES) int32 result = 0;
+  TF_Tensor* input_value = TF_NewTensor(TF_INT32, nullptr, 0, &input,
+                                        sizeof(input), nullptr, nullptr);
+  TF_Tensor* output_value = TF_NewTensor(TF_INT32, nullptr, 0, &result,
+                                         sizeof(result), nullptr, nullptr);
+  TF_Output feeds[] = {{feed, 0}};
+  TF_Output fetches[] = {{add, 0}};
+  TF_SessionRunWithOutputTensors(session, nullptr, feeds, &input_value, 1,
+                                 fetches, &output_value, 1, nullptr, 0,
+                                 nullptr, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  EXPECT_EQ(3 + 2, result);
+  EXPECT_EQ(static_cast<void*>(&result), TF_TensorData(output_value));
+
+  // The caller-owned output must have the shape of the fetched tensor.
+  int64_t dims[] = {1};
+  TF_Tensor* wrong_shape = TF_NewTensor(TF_INT32, dims, 1, &result,
+                                        sizeof(result), nullptr, nullptr);
+  TF_SessionRunWithOutputTensors(session, nullptr, feeds, &input_value, 1,
+                                 fetches, &wrong_shape, 1, nullptr, 0,
+                                 nullptr, s);
+  EXPECT_EQ(TF_INVALID_ARGUMENT, TF_GetCode(s)) << TF_Message(s);
+
+  TF_DeleteTensor(wrong_shape);
+  TF_DeleteTensor(output_value);
+  TF_DeleteTensor(input_value);
+  TF_CloseSession(session, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_DeleteSession(session, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_DeleteGraph(graph);
+  TF_DeleteStatus(s);
+}
+
 // If `device` is non-empty, run Min op on that device.
 // Otherwise run it on the default device (CPU).
 void RunMinTest(const string& device, bool use_XLA) {
@@ -795,6 +795,14 @@ int TFE_TensorHandleDeviceID(TFE_TensorHandle* h, TF_Status* status) {
   return tensorflow::unwrap(h)->DeviceId(&status->status);
 }
 
+void TFE_TensorHandlePrefetchToHost(TFE_TensorHandle* h, TF_Status* status) {
+  if (h == nullptr) {
+    status->status = tensorflow::errors::InvalidArgument("Invalid handle");
+    return;
+  }
+  status->status = tensorflow::unwrap(h)->PrefetchToHost();
+}
+
 TF_CAPI_EXPORT extern void TFE_TensorHandleGetStatus(TFE_TensorHandle* h,
                                                      TF_Status* status) {
   status->status = tensorflow::unwrap(h)->TensorHandleStatus();
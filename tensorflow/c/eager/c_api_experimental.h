@@ -715,6 +715,13 @@ TF_CAPI_EXPORT extern const char* TFE_TensorHandleDeviceType(
 TF_CAPI_EXPORT extern int TFE_TensorHandleDeviceID(TFE_TensorHandle* h,
                                                    TF_Status* status);
 
+// Starts copying `h` to host memory in the background, so that a later
+// TFE_TensorHandleResolve does not have to wait for a device-to-host copy. In
+// async mode the copy runs once the op producing `h` has executed. Handles
+// that are already on the host, or can't be prefetched, are left unchanged.
+TF_CAPI_EXPORT extern void TFE_TensorHandlePrefetchToHost(TFE_TensorHandle* h,
+                                                          TF_Status* status);
+
 // Returns the status for the tensor handle. In TFRT, a tensor handle can carry
 // error info if error happens. If so, the status will be set with the error
 // info. If not, status will be set as OK.
@@ -244,6 +244,9 @@ class ImmediateExecutionContext : public AbstractContext {
 
   struct CacheStats {
     int64_t kernel_cache_size;
+    // Number of kernel cache lookups that found or didn't find a kernel.
+    int64_t kernel_cache_hits = 0;
+    int64_t kernel_cache_misses = 0;
     int64_t device_cache_size;
     std::map<std::string, int64_t> func_kernel_cache_entries;
     int64_t local_rendezvous_cache_active_size;
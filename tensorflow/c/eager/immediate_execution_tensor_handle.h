@@ -55,6 +55,10 @@ class ImmediateExecutionTensorHandle : public AbstractTensorHandle {
   virtual int DeviceId(Status* status) const = 0;
   // Returns a tensor for the handle. If tensor is remote, it will be copied.
   virtual AbstractTensorInterface* Resolve(Status* status) = 0;
+  // Starts copying the tensor to host memory in the background, so that a
+  // later `Resolve` finds the host copy instead of copying synchronously.
+  // Handles which can't prefetch ignore the request.
+  virtual Status PrefetchToHost() { return absl::OkStatus(); }
 
   std::string DebugString() const override;
 
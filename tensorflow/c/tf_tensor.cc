@@ -120,8 +120,8 @@ TF_Tensor* TF_NewTensor(TF_DataType dtype, const int64_t* dims, int num_dims,
                                len, tensorflow::deallocate_buffer, nullptr,
                                /*owns_memory=*/true);
     std::memcpy(buf->data(), data, len);
-    // Free the original buffer.
-    deallocator(data, len, deallocator_arg);
+    // Free the original buffer, unless it is a non-owning view.
+    if (deallocator != nullptr) deallocator(data, len, deallocator_arg);
   } else {
     buf = new TF_ManagedBuffer(data, len, deallocator, deallocator_arg,
                                /*owns_memory=*/false);
@@ -63,6 +63,11 @@ typedef struct TF_Tensor TF_Tensor;
 // Clients must provide a custom deallocator function so they can pass in
 // memory managed by something like numpy.
 //
+// `deallocator` may be NULL, in which case the tensor is a non-owning view of
+// data[0,len-1]: the caller keeps ownership of the buffer and must keep it
+// alive as long as the tensor, or any tensor produced from it by a session
+// run, is in use.
+//
 // May return NULL (and invoke the deallocator) if the provided data buffer
 // (data, len) is inconsistent with a tensor of the given TF_DataType
 // and the shape specified by (dima, num_dims).
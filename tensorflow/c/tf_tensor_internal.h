@@ -53,7 +53,9 @@ class TF_ManagedBuffer : public tensorflow::TensorBuffer {
         owns_memory_(owns_memory) {}
 
   ~TF_ManagedBuffer() override {
-    (*deallocator_)(data(), len_, deallocator_arg_);
+    if (deallocator_ != nullptr) {
+      (*deallocator_)(data(), len_, deallocator_arg_);
+    }
   }
 
   size_t size() const override { return len_; }
@@ -15,10 +15,13 @@ limitations under the License.
 
 #include "tensorflow/cc/saved_model/loader.h"
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <string>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
@@ -35,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/op_def.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/monitoring/sampler.h"
@@ -43,6 +47,7 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/file_system_helper.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
 #include "tensorflow/core/protobuf/saver.pb.h"
@@ -78,6 +83,14 @@ constexpr char kLoadAttemptSuccess[] = "success";
 // `tensorflow::LoadSavedModel` API label.
 constexpr char kCCLoadLabel[] = "cc_load";
 
+// Phases of loading a SavedModel reported to
+// metrics::SavedModelLoadPhaseDuration().
+constexpr char kReadMetaGraphPhase[] = "read_meta_graph";
+constexpr char kCreateSessionPhase[] = "create_session";
+constexpr char kPrefetchVariablesPhase[] = "prefetch_variables";
+constexpr char kRestoreVariablesPhase[] = "restore_variables";
+constexpr char kRunInitOpPhase[] = "run_init_op";
+
 uint64 GetLatencyMicroseconds(const uint64 start_microseconds) {
   const uint64 end_microseconds = EnvTime::NowMicros();
   // Avoid clock skew.
@@ -85,6 +98,93 @@ uint64 GetLatencyMicroseconds(const uint64 start_microseconds) {
   return end_microseconds - start_microseconds;
 }
 
+// Reads the variable data files of a SavedModel into the page cache on a
+// background thread, so that the reads overlap with parsing the graph and
+// creating the session, and the restore op then finds the data in memory.
+//
+// The files are memory-mapped and touched page by page, so nothing is
+// prefetched from file systems that do not support memory-mapping, where the
+// data could not be kept. Nothing is prefetched either if the files do not
+// fit comfortably into the available RAM.
+class VariablesPrefetcher {
+ public:
+  explicit VariablesPrefetcher(const string& export_dir) {
+    Env* env = Env::Default();
+    const string variables_prefix =
+        io::JoinPath(export_dir, kSavedModelVariablesDirectory,
+                     kSavedModelVariablesFilename);
+    std::vector<string> filenames;
+    if (!env->GetMatchingPaths(absl::StrCat(variables_prefix, ".data-*"),
+                               &filenames)
+             .ok() ||
+        filenames.empty()) {
+      return;
+    }
+    uint64 total_bytes = 0;
+    for (const string& filename : filenames) {
+      uint64 file_bytes = 0;
+      if (!env->GetFileSize(filename, &file_bytes).ok()) return;
+      total_bytes += file_bytes;
+    }
+    if (total_bytes > static_cast<uint64>(port::AvailableRam()) / 2) {
+      VLOG(1) << "Not prefetching " << total_bytes
+              << " bytes of variables of SavedModel at " << export_dir;
+      return;
+    }
+    thread_.reset(env->StartThread(
+        ThreadOptions(), "saved_model_prefetch_variables",
+        [this, env, filenames = std::move(filenames)] {
+          const uint64 start_microseconds = EnvTime::NowMicros();
+          {
+            thread::ThreadPool pool(
+                env, "saved_model_prefetch_shards",
+                std::min<int>(filenames.size(), kMaxPrefetchThreads));
+            for (const string& filename : filenames) {
+              pool.Schedule([this, env, &filename] {
+                PrefetchFile(env, filename);
+              });
+            }
+          }
+          metrics::SavedModelLoadPhaseDuration(kCCLoadLabel,
+                                               kPrefetchVariablesPhase)
+              .Add(GetLatencyMicroseconds(start_microseconds));
+        }));
+  }
+
+  // Stops prefetching and waits for the background thread.
+  ~VariablesPrefetcher() {
+    cancelled_.store(true, std::memory_order_relaxed);
+    thread_.reset();
+  }
+
+  // Waits until all the files are prefetched.
+  void Wait() { thread_.reset(); }
+
+ private:
+  static constexpr int kMaxPrefetchThreads = 8;
+  static constexpr uint64 kPageBytes = 4096;
+  // Cancellation is checked once every this many bytes.
+  static constexpr uint64 kCancellationCheckBytes = 1 << 20;
+
+  void PrefetchFile(Env* env, const string& filename) {
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    if (!env->NewReadOnlyMemoryRegionFromFile(filename, &region).ok()) return;
+    const volatile char* data =
+        static_cast<const volatile char*>(region->data());
+    for (uint64 offset = 0; offset < region->length(); offset += kPageBytes) {
+      if (offset % kCancellationCheckBytes == 0 &&
+          cancelled_.load(std::memory_order_relaxed)) {
+        return;
+      }
+      // Faults the page in.
+      (void)data[offset];
+    }
+  }
+
+  std::atomic<bool> cancelled_{false};
+  std::unique_ptr<Thread> thread_;
+};
+
 // Ensure that constant tensors loaded from the saved model have valid shape.
 // Also ensure that constant nodes have a value assigned to them.
 // TODO(b/154763635): this is temporary and will be replaced with a better audit
@@ -297,12 +397,22 @@ Status LoadSavedModelInternal(const SessionOptions& session_options,
                               const string& export_dir,
                               const std::unordered_set<string>& tags,
                               SavedModelBundle* const bundle) {
+  VariablesPrefetcher prefetcher(export_dir);
+  uint64 start_microseconds = EnvTime::NowMicros();
   TF_RETURN_IF_ERROR(ReadMetaGraphDefFromSavedModel(export_dir, tags,
                                                     &bundle->meta_graph_def));
   TF_RETURN_IF_ERROR(
       ReadSavedModelDebugInfoIfPresent(export_dir, &bundle->debug_info));
+  metrics::SavedModelLoadPhaseDuration(kCCLoadLabel, kReadMetaGraphPhase)
+      .Add(GetLatencyMicroseconds(start_microseconds));
+
+  start_microseconds = EnvTime::NowMicros();
   TF_RETURN_IF_ERROR(LoadMetagraphIntoSession(
       session_options, bundle->meta_graph_def, &bundle->session));
+  metrics::SavedModelLoadPhaseDuration(kCCLoadLabel, kCreateSessionPhase)
+      .Add(GetLatencyMicroseconds(start_microseconds));
+
+  prefetcher.Wait();
   TF_RETURN_IF_ERROR(RestoreSession(run_options, bundle->meta_graph_def,
                                     export_dir, &bundle->session));
   return absl::OkStatus();
@@ -424,13 +534,23 @@ Status LoadSavedModelInternal(const SessionOptions& session_options,
                               const string& export_dir,
                               const std::unordered_set<string>& tags,
                               SavedModelBundleLite* const bundle) {
+  VariablesPrefetcher prefetcher(export_dir);
+  uint64 start_microseconds = EnvTime::NowMicros();
   MetaGraphDef meta_graph_def;
   TF_RETURN_IF_ERROR(
       ReadMetaGraphDefFromSavedModel(export_dir, tags, &meta_graph_def));
+  metrics::SavedModelLoadPhaseDuration(kCCLoadLabel, kReadMetaGraphPhase)
+      .Add(GetLatencyMicroseconds(start_microseconds));
+
+  start_microseconds = EnvTime::NowMicros();
   std::unique_ptr<Session> session;
   TF_RETURN_IF_ERROR(LoadGraphDefIntoSession(
       session_options, std::move(*meta_graph_def.mutable_graph_def()),
       &session));
+  metrics::SavedModelLoadPhaseDuration(kCCLoadLabel, kCreateSessionPhase)
+      .Add(GetLatencyMicroseconds(start_microseconds));
+
+  prefetcher.Wait();
   TF_RETURN_IF_ERROR(
       RestoreSession(run_options, meta_graph_def, export_dir, &session));
   *bundle = SavedModelBundleLite(
@@ -506,11 +626,17 @@ Status RestoreSession(const RunOptions& run_options,
       internal::GetInitOp(export_dir, meta_graph, &init_op_name));
   TF_RETURN_IF_ERROR(RunInitOp(run_options, export_dir, meta_graph,
                                asset_file_defs, session->get(), init_op_name));
+  const uint64 init_graph_walltime =
+      GetLatencyMicroseconds(graph_init_start_microseconds);
   load_latency_by_stage->GetCell(export_dir, "restore_graph")
       ->Add(restore_graph_walltime);
   // Record wall time spent in init op.
   load_latency_by_stage->GetCell(export_dir, "init_graph")
-      ->Add(GetLatencyMicroseconds(graph_init_start_microseconds));
+      ->Add(init_graph_walltime);
+  metrics::SavedModelLoadPhaseDuration(kCCLoadLabel, kRestoreVariablesPhase)
+      .Add(restore_graph_walltime);
+  metrics::SavedModelLoadPhaseDuration(kCCLoadLabel, kRunInitOpPhase)
+      .Add(init_graph_walltime);
   return absl::OkStatus();
 }
 
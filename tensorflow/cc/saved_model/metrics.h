@@ -105,6 +105,12 @@ ParseSavedModelPathAndSingleprint(std::string path_and_singleprint);
 // found when loading the SavedModel.
 monitoring::GaugeCell<std::string>& SavedModelFoundFingerprintOnLoad();
 
+// Returns "/tensorflow/core/saved_model/read/phase_durations" cell belonging
+// to fields (`api_label`, `phase`), where `phase` is a step of loading a
+// SavedModel such as "read_meta_graph" or "restore_variables".
+monitoring::SamplerCell& SavedModelLoadPhaseDuration(
+    absl::string_view api_label, absl::string_view phase);
+
 // Returns "/tensorflow/core/checkpoint/read/read_durations" cell belonging to
 // field `api_label`.
 monitoring::SamplerCell& CheckpointReadDuration(absl::string_view api_label);
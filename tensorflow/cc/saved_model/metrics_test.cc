@@ -53,6 +53,13 @@ TEST(MetricsTest, TestSavedModelRead) {
   EXPECT_EQ(SavedModelReadCount("2").value(), 2);
 }
 
+TEST(MetricsTest, TestSavedModelLoadPhaseDuration) {
+  EXPECT_EQ(SavedModelLoadPhaseDuration("foo", "bar").value().num(), 0);
+  SavedModelLoadPhaseDuration("foo", "bar").Add(100);
+  EXPECT_EQ(SavedModelLoadPhaseDuration("foo", "bar").value().num(), 1);
+  EXPECT_EQ(SavedModelLoadPhaseDuration("foo", "baz").value().num(), 0);
+}
+
 TEST(MetricsTest, TestCheckpointRead) {
   EXPECT_EQ(CheckpointReadDuration("foo").value().num(), 0);
   CheckpointReadDuration("foo").Add(100);
@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <vector>
+
 #include "tensorflow/cc/saved_model/constants.h"
 #include "tensorflow/cc/saved_model/loader.h"
 #include "tensorflow/cc/saved_model/metrics.h"
@@ -384,6 +386,35 @@ TEST_F(LoaderTest, UpdateMetricsV1) {
   EXPECT_EQ(metrics::SavedModelReadApi(kCCLoadLabel).value(), api_count + 1);
 }
 
+TEST_F(LoaderTest, UpdateLoadPhaseMetrics) {
+  SavedModelBundle bundle;
+  SessionOptions session_options;
+  RunOptions run_options;
+  const string kCCLoadLabel = "cc_load";
+
+  const std::vector<string> phases = {"read_meta_graph", "create_session",
+                                      "restore_variables", "run_init_op"};
+  std::vector<double> counts;
+  for (const string& phase : phases) {
+    counts.push_back(metrics::SavedModelLoadPhaseDuration(kCCLoadLabel, phase)
+                         .value()
+                         .num());
+  }
+  const string export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+  TF_ASSERT_OK(LoadSavedModel(session_options, run_options, export_dir,
+                              {kSavedModelTagServe}, &bundle));
+  CheckSavedModelBundle(export_dir, bundle);
+
+  for (size_t i = 0; i < phases.size(); ++i) {
+    EXPECT_EQ(metrics::SavedModelLoadPhaseDuration(kCCLoadLabel, phases[i])
+                  .value()
+                  .num(),
+              counts[i] + 1)
+        << phases[i];
+  }
+}
+
 TEST_F(LoaderTest, UpdateFingerprintMetrics) {
   SavedModelBundle bundle;
   SessionOptions session_options;
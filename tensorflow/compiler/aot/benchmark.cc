@@ -106,6 +106,12 @@ void DumpStatsToStdout(const Stats& stats) {
     printf("  %-*s %*.3f us\n", max_label_size, g.first.c_str(), max_digits + 4,
            g.second);
   }
+  if (stats.total_us > 0) {
+    const double iters_per_sec = count_us * 1e6 / stats.total_us;
+    printf("Throughput: %.3f iterations/s, %.3f items/s (%lld per iteration)\n",
+           iters_per_sec, iters_per_sec * stats.items_per_iter,
+           static_cast<long long>(stats.items_per_iter));  // NOLINT
+  }
 }
 
 void Benchmark(const Options& options, const BenchmarkFn& fn, Stats* stats) {
@@ -115,6 +121,7 @@ void Benchmark(const Options& options, const BenchmarkFn& fn, Stats* stats) {
                              : options.max_micros;
   // NOLINTNEXTLINE
   printf("Running benchmark for %lld us\n", static_cast<long long>(max_us));
+  stats->items_per_iter = options.items_per_iter;
   const int64_t start_us = NowMicros();
   int64_t iters = 0;
   while (true) {
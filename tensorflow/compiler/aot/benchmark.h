@@ -42,12 +42,17 @@ struct Options {
 
   int64_t max_iters = 0;   // Maximum iterations to run, ignored if <= 0.
   int64_t max_micros = 0;  // Maximum microseconds to run, ignored if <= 0.
+
+  // Number of items, e.g. the batch size, that each iteration processes. Used
+  // to report the throughput in items per second.
+  int64_t items_per_iter = 1;
 };
 
 // Stats holds statistics collected during benchmarking.
 struct Stats {
   std::vector<int64_t> per_iter_us;  // Per-iteration deltas in us.
   int64_t total_us;                  // Total time in us.
+  int64_t items_per_iter = 1;        // Items processed by each iteration.
 
   Stats() : total_us(0) { per_iter_us.reserve(5000); }
 };
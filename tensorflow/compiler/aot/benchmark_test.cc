@@ -40,6 +40,18 @@ TEST(Benchmark, Benchmark) {
   EXPECT_EQ(stats5.per_iter_us.size(), 5);
 }
 
+TEST(Benchmark, RecordsItemsPerIter) {
+  AddComp add;
+
+  Options options;
+  options.max_iters = 3;
+  options.items_per_iter = 8;
+  Stats stats;
+  Benchmark(options, [&] { add.Run(); }, &stats);
+  EXPECT_EQ(stats.per_iter_us.size(), 3);
+  EXPECT_EQ(stats.items_per_iter, 8);
+}
+
 }  // namespace
 }  // namespace benchmark
 }  // namespace tfcompile
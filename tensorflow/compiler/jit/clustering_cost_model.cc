@@ -0,0 +1,101 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/clustering_cost_model.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/jit/flags.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+
+absl::StatusOr<ClusteringCostModel> ClusteringCostModel::Parse(
+    absl::string_view text) {
+  ClusteringCostModel cost_model;
+  int line_number = 0;
+  for (absl::string_view line : absl::StrSplit(text, '\n')) {
+    ++line_number;
+    line = absl::StripAsciiWhitespace(line);
+    if (line.empty() || line[0] == '#') continue;
+
+    std::vector<absl::string_view> fields =
+        absl::StrSplit(line, absl::ByAnyChar(" \t"), absl::SkipEmpty());
+    double native_us, xla_us;
+    if (fields.size() != 3 || !absl::SimpleAtod(fields[1], &native_us) ||
+        !absl::SimpleAtod(fields[2], &xla_us)) {
+      return errors::InvalidArgument(
+          "Malformed op timing on line ", line_number, ": \"", line,
+          "\". Expected \"<op type> <TF kernel time> <XLA time>\".");
+    }
+    cost_model.benefit_us_[fields[0]] = native_us - xla_us;
+  }
+  return cost_model;
+}
+
+absl::StatusOr<ClusteringCostModel> ClusteringCostModel::LoadFromFile(
+    Env* env, const std::string& path) {
+  std::string text;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, path, &text));
+  return Parse(text);
+}
+
+double ClusteringCostModel::EstimatedBenefitUs(absl::string_view op) const {
+  auto it = benefit_us_.find(op);
+  return it == benefit_us_.end() ? 0 : it->second;
+}
+
+bool ClusteringCostModel::IsMergeProfitable(double a, double b) {
+  // Clusters that are slower with XLA are not compiled, so on their own they
+  // contribute no benefit.
+  return a + b >= std::max(a, 0.0) + std::max(b, 0.0);
+}
+
+absl::StatusOr<const ClusteringCostModel*> GetClusteringCostModelFromFlags() {
+  static mutex* mu = new mutex();
+  static auto* cost_models =
+      new absl::flat_hash_map<std::string,
+                              std::unique_ptr<ClusteringCostModel>>();
+
+  const std::string& path =
+      GetMarkForCompilationPassFlags()->tf_xla_clustering_cost_model_file;
+  if (path.empty()) return nullptr;
+
+  mutex_lock lock(*mu);
+  std::unique_ptr<ClusteringCostModel>& cost_model = (*cost_models)[path];
+  if (cost_model == nullptr) {
+    absl::StatusOr<ClusteringCostModel> loaded =
+        ClusteringCostModel::LoadFromFile(Env::Default(), path);
+    if (!loaded.ok()) {
+      cost_models->erase(path);
+      return loaded.status();
+    }
+    cost_model = std::make_unique<ClusteringCostModel>(*std::move(loaded));
+  }
+  return cost_model.get();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,70 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_CLUSTERING_COST_MODEL_H_
+#define TENSORFLOW_COMPILER_JIT_CLUSTERING_COST_MODEL_H_
+
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+
+// Estimates how much time clustering ops for XLA saves, from measured per-op
+// timings. Used by the auto-clustering pass to only form clusters that are
+// predicted to be faster with XLA than with the regular TF kernels.
+//
+// The estimated benefit of an op is its time with the TF kernel minus its time
+// in an XLA cluster, and that of a cluster is the sum over its ops. Ops
+// without timings are assumed to be neither faster nor slower with XLA.
+class ClusteringCostModel {
+ public:
+  ClusteringCostModel() = default;
+
+  // Parses per-op timings, one op per line as
+  //
+  //   <op type> <TF kernel time in us> <XLA time in us>
+  //
+  // Empty lines and lines starting with '#' are ignored.
+  static absl::StatusOr<ClusteringCostModel> Parse(absl::string_view text);
+
+  // As above, but reads the timings from the file at `path`.
+  static absl::StatusOr<ClusteringCostModel> LoadFromFile(
+      Env* env, const std::string& path);
+
+  // Returns the estimated benefit, in microseconds, of running an op of type
+  // `op` in an XLA cluster. Negative if the op is slower with XLA.
+  double EstimatedBenefitUs(absl::string_view op) const;
+
+  // Returns true if merging two clusters with the estimated benefits `a` and
+  // `b` is predicted to be at least as fast as compiling only the clusters
+  // that are faster with XLA.
+  static bool IsMergeProfitable(double a, double b);
+
+ private:
+  absl::flat_hash_map<std::string, double> benefit_us_;
+};
+
+// Returns the cost model read from the file set with
+// `--tf_xla_clustering_cost_model_file`, or null if the flag isn't set. The
+// file is only read once.
+absl::StatusOr<const ClusteringCostModel*> GetClusteringCostModelFromFlags();
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_CLUSTERING_COST_MODEL_H_
@@ -0,0 +1,71 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/clustering_cost_model.h"
+
+#include <string>
+
+#include "tensorflow/compiler/jit/flags.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(ClusteringCostModelTest, Parse) {
+  TF_ASSERT_OK_AND_ASSIGN(ClusteringCostModel cost_model,
+                          ClusteringCostModel::Parse(R"(
+# op native xla
+MatMul 10 4
+  GatherV2	2 5
+)"));
+  EXPECT_DOUBLE_EQ(cost_model.EstimatedBenefitUs("MatMul"), 6);
+  EXPECT_DOUBLE_EQ(cost_model.EstimatedBenefitUs("GatherV2"), -3);
+  EXPECT_DOUBLE_EQ(cost_model.EstimatedBenefitUs("Add"), 0);
+}
+
+TEST(ClusteringCostModelTest, ParseMalformed) {
+  EXPECT_FALSE(ClusteringCostModel::Parse("MatMul 10").ok());
+  EXPECT_FALSE(ClusteringCostModel::Parse("MatMul ten 4").ok());
+}
+
+TEST(ClusteringCostModelTest, IsMergeProfitable) {
+  EXPECT_TRUE(ClusteringCostModel::IsMergeProfitable(6, 0));
+  EXPECT_TRUE(ClusteringCostModel::IsMergeProfitable(6, 2));
+  EXPECT_FALSE(ClusteringCostModel::IsMergeProfitable(6, -3));
+  EXPECT_FALSE(ClusteringCostModel::IsMergeProfitable(-3, -1));
+}
+
+TEST(ClusteringCostModelTest, GetFromFlags) {
+  MarkForCompilationPassFlags* flags = GetMarkForCompilationPassFlags();
+  flags->tf_xla_clustering_cost_model_file = "";
+  TF_ASSERT_OK_AND_ASSIGN(const ClusteringCostModel* cost_model,
+                          GetClusteringCostModelFromFlags());
+  EXPECT_EQ(cost_model, nullptr);
+
+  std::string path =
+      io::JoinPath(testing::TmpDir(), "clustering_cost_model.txt");
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), path, "MatMul 10 4\n"));
+  flags->tf_xla_clustering_cost_model_file = path;
+  TF_ASSERT_OK_AND_ASSIGN(cost_model, GetClusteringCostModelFromFlags());
+  ASSERT_NE(cost_model, nullptr);
+  EXPECT_DOUBLE_EQ(cost_model->EstimatedBenefitUs("MatMul"), 6);
+  flags->tf_xla_clustering_cost_model_file = "";
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -16,12 +16,16 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_DEVICE_COMPILATION_CACHE_H_
 #define TENSORFLOW_COMPILER_JIT_DEVICE_COMPILATION_CACHE_H_
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
 #include <utility>
 #include <variant>
+#include <vector>
 
 #include "absl/strings/str_cat.h"
 #include "tensorflow/compiler/jit/device_compilation_cluster_signature.h"
@@ -29,6 +33,7 @@ limitations under the License.
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 #include "xla/client/local_client.h"
 #include "xla/pjrt/pjrt_client.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
@@ -59,15 +64,37 @@ inline int64_t ExecutableSize<xla::PjRtLoadedExecutable>(
 }
 }  // namespace device_compilation_cache_internal
 
+// Order in which `DeviceCompilationCache` evicts its entries.
+enum class DeviceCompilationCacheEvictionPolicy {
+  // Least recently requested entries first.
+  kLru,
+  // Least frequently requested entries first.
+  kLfu,
+};
+
 // Cache to store compiled HLO, executables and related metadata keyed by
 // `DeviceCompilationClusterSignature`. The cache owns the stored
 // CompilationResults and Executables.
-// Currently no cache eviction policy is implemented and the cache grows without
-// bound.
+// By default the cache grows without bound. If `EvictionOptions` has a size
+// budget, `EvictToFit()` drops the compiled HLO and executables of unused
+// entries until the cache fits in it again. The keys and request counts of
+// evicted entries are kept, and their signatures are compiled again on their
+// next request.
 template <typename ExecutableType>
 class DeviceCompilationCache {
  public:
+  struct EvictionOptions {
+    // Upper bound on the size of the cached executables and HLO modules, in
+    // bytes. No entries are evicted if zero.
+    int64_t max_size_bytes = 0;
+
+    DeviceCompilationCacheEvictionPolicy policy =
+        DeviceCompilationCacheEvictionPolicy::kLru;
+  };
+
   DeviceCompilationCache() = default;
+  explicit DeviceCompilationCache(EvictionOptions eviction_options)
+      : eviction_options_(eviction_options) {}
   ~DeviceCompilationCache() = default;
 
   using Key = DeviceCompilationClusterSignature;
@@ -77,6 +104,18 @@ class DeviceCompilationCache {
     int64_t request_count = 0;
     const XlaCompiler::CompilationResult* compilation_result = nullptr;
     ExecutableType* executable = nullptr;
+    // The number of times the compiled executable of the entry was evicted.
+    int64_t eviction_count = 0;
+    // Keeps `compilation_result` and `executable` from being evicted while
+    // this value, or a copy of it, is alive.
+    std::shared_ptr<const void> pin;
+  };
+
+  // The compiled HLO and executable of an evicted entry.
+  struct EvictedValue {
+    std::unique_ptr<XlaCompiler::CompilationResult> compilation_result;
+    std::unique_ptr<ExecutableType> executable;
+    int64_t size_bytes = 0;
   };
 
   // Returns std::nullopt if value for the supplied key is not found. If a value
@@ -98,6 +137,20 @@ class DeviceCompilationCache {
                  compilation_result,
              std::optional<std::unique_ptr<ExecutableType>> executable);
 
+  // Evicts compiled entries, in the order of the eviction policy, until the
+  // cache fits in `EvictionOptions::max_size_bytes`. Entries pinned by a live
+  // `Value` are never evicted. Entries for which `is_hot` returns true are only
+  // evicted if evicting all the other unpinned entries is not enough. The
+  // evicted executables may still be running on the device and are returned to
+  // the caller, which must only destroy them once they have finished.
+  std::vector<EvictedValue> EvictToFit(
+      const std::function<bool(const Key&, const Value&)>& is_hot = nullptr);
+
+  // Returns the total size of the cached executables and HLO modules.
+  int64_t SizeInBytes() const { return size_bytes_.load(); }
+
+  const EvictionOptions& eviction_options() const { return eviction_options_; }
+
   std::string DebugString() const;
 
  private:
@@ -123,19 +176,50 @@ class DeviceCompilationCache {
     // executable has been built.
     std::unique_ptr<ExecutableType> executable TF_GUARDED_BY(mu);
 
-    std::string DebugString() const {
-      mutex_lock lock(mu);
+    // The size of `compilation_result` and `executable` as last accounted for
+    // in the size of the cache.
+    int64_t size_bytes TF_GUARDED_BY(mu) = 0;
+
+    // When the entry was last requested or compiled.
+    uint64 last_use_us TF_GUARDED_BY(mu) = 0;
 
-      int64_t executable_size =
-          device_compilation_cache_internal::ExecutableSize<ExecutableType>(
-              executable.get());
+    // Shared with the values returned by lookups. The entry is in use while
+    // it has more than one owner. Values are only copied from it under `mu`,
+    // so an entry that is seen unused under `mu` stays unused until `mu` is
+    // released.
+    const std::shared_ptr<const void> pin = std::make_shared<int>(0);
 
-      int64_t hlo_module_size = 0;
+    // The number of times the compiled executable was evicted.
+    int64_t eviction_count TF_GUARDED_BY(mu) = 0;
+
+    int64_t ExecutableSizeInBytes() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu) {
+      return device_compilation_cache_internal::ExecutableSize<ExecutableType>(
+          executable.get());
+    }
+
+    int64_t HloModuleSizeInBytes() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu) {
       if (compilation_result != nullptr &&
           compilation_result->computation != nullptr) {
-        hlo_module_size =
-            compilation_result->computation->proto().ByteSizeLong();
+        return compilation_result->computation->proto().ByteSizeLong();
       }
+      return 0;
+    }
+
+    Value ToValue() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu) {
+      return {/*compile_state=*/compile_state,
+              /*compilation_status=*/compilation_status,
+              /*request_count=*/request_count,
+              /*compilation_result=*/compilation_result.get(),
+              /*executable=*/executable.get(),
+              /*eviction_count=*/eviction_count,
+              /*pin=*/pin};
+    }
+
+    std::string DebugString() const {
+      mutex_lock lock(mu);
+
+      int64_t executable_size = ExecutableSizeInBytes();
+      int64_t hlo_module_size = HloModuleSizeInBytes();
 
       return absl::StrCat(
           "{compile_state: ", compile_state, ", request_count: ", request_count,
@@ -143,14 +227,29 @@ class DeviceCompilationCache {
           ", compilation_result?: ", compilation_result != nullptr,
           ", hlo_module_size: ", hlo_module_size, " bytes",
           ", executable?: ", executable != nullptr,
-          ", executable_size: ", executable_size, " bytes}");
+          ", executable_size: ", executable_size, " bytes",
+          ", eviction_count: ", eviction_count, "}");
     }
   };
 
+  // Returns true if the entry has been compiled successfully and no value
+  // returned by a lookup of it is still alive.
+  static bool IsEvictable(const Entry& entry)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(entry.mu) {
+    return entry.compile_state == DeviceCompileState::kCompiled &&
+           entry.compilation_status.ok() && entry.size_bytes > 0 &&
+           entry.pin.use_count() == 1;
+  }
+
+  const EvictionOptions eviction_options_;
+
   mutable mutex compile_cache_mu_;
   absl::flat_hash_map<Key, std::unique_ptr<Entry>, Key::Hash> cache_
       TF_GUARDED_BY(compile_cache_mu_);
 
+  // Sum of the `size_bytes` of the entries.
+  std::atomic<int64_t> size_bytes_{0};
+
   DeviceCompilationCache(const DeviceCompilationCache&) = delete;
   void operator=(const DeviceCompilationCache&) = delete;
 };
@@ -173,12 +272,9 @@ DeviceCompilationCache<ExecutableType>::Lookup(const Key& key) const {
   }
 
   mutex_lock lock(entry->mu);
-  Value value = {/*compile_state=*/entry->compile_state,
-                 /*compilation_status=*/entry->compilation_status,
-                 /*request_count=*/++entry->request_count,
-                 /*compilation_result=*/entry->compilation_result.get(),
-                 /*executable=*/entry->executable.get()};
-  return value;
+  ++entry->request_count;
+  entry->last_use_us = Env::Default()->NowMicros();
+  return entry->ToValue();
 }
 
 template <typename ExecutableType>
@@ -195,12 +291,9 @@ DeviceCompilationCache<ExecutableType>::LookupOrCreate(const Key& key) {
   }
 
   mutex_lock lock(entry->mu);
-  Value value = {/*compile_state=*/entry->compile_state,
-                 /*compilation_status=*/entry->compilation_status,
-                 /*request_count=*/++entry->request_count,
-                 /*compilation_result=*/entry->compilation_result.get(),
-                 /*executable=*/entry->executable.get()};
-  return value;
+  ++entry->request_count;
+  entry->last_use_us = Env::Default()->NowMicros();
+  return entry->ToValue();
 }
 
 template <typename ExecutableType>
@@ -231,13 +324,76 @@ void DeviceCompilationCache<ExecutableType>::Store(
     }
     if (executable.has_value()) {
       entry->executable = std::move(*executable);
+      entry->last_use_us = Env::Default()->NowMicros();
     }
+    const int64_t size_bytes =
+        entry->ExecutableSizeInBytes() + entry->HloModuleSizeInBytes();
+    size_bytes_ += size_bytes - entry->size_bytes;
+    entry->size_bytes = size_bytes;
   }
 
   VLOG(4) << "Added/updated cache entry: key=" << key.HumanString()
           << ", entry=" << entry->DebugString();
 }
 
+template <typename ExecutableType>
+std::vector<typename DeviceCompilationCache<ExecutableType>::EvictedValue>
+DeviceCompilationCache<ExecutableType>::EvictToFit(
+    const std::function<bool(const Key&, const Value&)>& is_hot) {
+  std::vector<EvictedValue> evicted;
+  const int64_t max_size_bytes = eviction_options_.max_size_bytes;
+  if (max_size_bytes <= 0 || size_bytes_ <= max_size_bytes) {
+    return evicted;
+  }
+
+  struct Candidate {
+    Entry* entry;
+    bool is_hot;
+    uint64 last_use_us;
+    int64_t request_count;
+  };
+
+  // Holding `compile_cache_mu_` keeps new lookups from finding the entries
+  // while they are evicted.
+  mutex_lock lock(compile_cache_mu_);
+  std::vector<Candidate> candidates;
+  for (const auto& [key, entry] : cache_) {
+    mutex_lock entry_lock(entry->mu);
+    if (!IsEvictable(*entry)) continue;
+    candidates.push_back({entry.get(), is_hot && is_hot(key, entry->ToValue()),
+                          entry->last_use_us, entry->request_count});
+  }
+
+  const bool lfu =
+      eviction_options_.policy == DeviceCompilationCacheEvictionPolicy::kLfu;
+  std::sort(candidates.begin(), candidates.end(),
+            [lfu](const Candidate& a, const Candidate& b) {
+              if (a.is_hot != b.is_hot) return b.is_hot;
+              if (lfu && a.request_count != b.request_count) {
+                return a.request_count < b.request_count;
+              }
+              return a.last_use_us < b.last_use_us;
+            });
+
+  for (const Candidate& candidate : candidates) {
+    if (size_bytes_ <= max_size_bytes) break;
+    Entry* entry = candidate.entry;
+    mutex_lock entry_lock(entry->mu);
+    if (!IsEvictable(*entry)) continue;
+    evicted.push_back({std::move(entry->compilation_result),
+                       std::move(entry->executable), entry->size_bytes});
+    entry->compile_state = DeviceCompileState::kUncompiled;
+    entry->compilation_status = absl::OkStatus();
+    ++entry->eviction_count;
+    size_bytes_ -= entry->size_bytes;
+    entry->size_bytes = 0;
+  }
+
+  VLOG(2) << "Evicted " << evicted.size() << " compilation cache entries, "
+          << "cache size is now " << size_bytes_ << " bytes";
+  return evicted;
+}
+
 template <typename ExecutableType>
 std::string DeviceCompilationCache<ExecutableType>::DebugString() const {
   std::string s = "DeviceCompilationCache<ExecutableType> {\n";
@@ -22,6 +22,7 @@ limitations under the License.
 #include <vector>
 
 #include <gtest/gtest.h>
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/test.h"
 #include "tsl/protobuf/error_codes.pb.h"
@@ -32,6 +33,16 @@ struct FakeExecutable {
   std::string data;
   explicit FakeExecutable(const std::string& s) : data(s) {}
 };
+}  // namespace
+
+namespace device_compilation_cache_internal {
+template <>
+int64_t ExecutableSize<FakeExecutable>(const FakeExecutable* executable) {
+  return executable != nullptr ? executable->data.size() : 0;
+}
+}  // namespace device_compilation_cache_internal
+
+namespace {
 
 using Cache = DeviceCompilationCache<FakeExecutable>;
 using Signature = DeviceCompilationClusterSignature;
@@ -216,5 +227,146 @@ TEST(DeviceCompilationCacheTest, StoreMultipleEntries) {
   EXPECT_EQ(cache_value_2->executable->data, "bar_exe");
 }
 
+TEST(DeviceCompilationCacheTest, SizeInBytes) {
+  auto cache = std::make_unique<Cache>();
+
+  TF_ASSERT_OK_AND_ASSIGN(auto key1, BuildSampleSignature("foo"));
+  TF_ASSERT_OK_AND_ASSIGN(auto key2, BuildSampleSignature("bar"));
+  cache->Store(key1, DeviceCompileState::kCompiled, absl::OkStatus(),
+               std::nullopt, std::make_unique<FakeExecutable>("foo_exe"));
+  cache->Store(key2, DeviceCompileState::kCompiled, absl::OkStatus(),
+               std::nullopt, std::make_unique<FakeExecutable>("bar"));
+  EXPECT_EQ(cache->SizeInBytes(), 10);
+
+  cache->Store(key1, std::nullopt, std::nullopt, std::nullopt,
+               std::make_unique<FakeExecutable>("f"));
+  EXPECT_EQ(cache->SizeInBytes(), 4);
+}
+
+Cache::EvictionOptions TestEvictionOptions(
+    DeviceCompilationCacheEvictionPolicy policy) {
+  Cache::EvictionOptions eviction_options;
+  eviction_options.max_size_bytes = 10;
+  eviction_options.policy = policy;
+  return eviction_options;
+}
+
+TEST(DeviceCompilationCacheTest, NoEvictionWithoutSizeBudget) {
+  auto cache = std::make_unique<Cache>();
+
+  TF_ASSERT_OK_AND_ASSIGN(auto key, BuildSampleSignature("foo"));
+  cache->Store(key, DeviceCompileState::kCompiled, absl::OkStatus(),
+               std::nullopt, std::make_unique<FakeExecutable>("foo_exe"));
+
+  EXPECT_TRUE(cache->EvictToFit().empty());
+  EXPECT_EQ(cache->Lookup(key)->compile_state, DeviceCompileState::kCompiled);
+}
+
+TEST(DeviceCompilationCacheTest, NoEvictionOfPinnedEntries) {
+  Cache::EvictionOptions eviction_options;
+  eviction_options.max_size_bytes = 1;
+  auto cache = std::make_unique<Cache>(eviction_options);
+
+  TF_ASSERT_OK_AND_ASSIGN(auto key, BuildSampleSignature("foo"));
+  cache->Store(key, DeviceCompileState::kCompiled, absl::OkStatus(),
+               std::nullopt, std::make_unique<FakeExecutable>("foo_exe"));
+
+  auto cache_value = cache->Lookup(key);
+  ASSERT_TRUE(cache_value.has_value());
+  auto cache_value_copy = *cache_value;
+  EXPECT_TRUE(cache->EvictToFit().empty());
+  EXPECT_EQ(cache->SizeInBytes(), 7);
+
+  cache_value.reset();
+  EXPECT_TRUE(cache->EvictToFit().empty());
+  EXPECT_EQ(cache_value_copy.executable->data, "foo_exe");
+
+  cache_value_copy = Cache::Value();
+  auto evicted = cache->EvictToFit();
+  ASSERT_EQ(evicted.size(), 1);
+  EXPECT_EQ(evicted[0].executable->data, "foo_exe");
+  EXPECT_EQ(cache->SizeInBytes(), 0);
+}
+
+TEST(DeviceCompilationCacheTest, EvictLeastRecentlyUsed) {
+  auto cache = std::make_unique<Cache>(
+      TestEvictionOptions(DeviceCompilationCacheEvictionPolicy::kLru));
+
+  TF_ASSERT_OK_AND_ASSIGN(auto key1, BuildSampleSignature("foo"));
+  TF_ASSERT_OK_AND_ASSIGN(auto key2, BuildSampleSignature("bar"));
+  cache->Store(key1, DeviceCompileState::kCompiled, absl::OkStatus(),
+               std::nullopt, std::make_unique<FakeExecutable>("foo_exe"));
+  cache->LookupOrCreate(key1);
+  cache->LookupOrCreate(key1);
+  Env::Default()->SleepForMicroseconds(1000);
+  cache->Store(key2, DeviceCompileState::kCompiled, absl::OkStatus(),
+               std::nullopt, std::make_unique<FakeExecutable>("bar_exe"));
+
+  auto evicted = cache->EvictToFit();
+  ASSERT_EQ(evicted.size(), 1);
+  EXPECT_EQ(evicted[0].executable->data, "foo_exe");
+  EXPECT_EQ(evicted[0].size_bytes, 7);
+  EXPECT_EQ(cache->SizeInBytes(), 7);
+
+  auto cache_value = cache->Lookup(key1);
+  EXPECT_EQ(cache_value->compile_state, DeviceCompileState::kUncompiled);
+  EXPECT_EQ(cache_value->request_count, 3);
+  EXPECT_EQ(cache_value->eviction_count, 1);
+  EXPECT_TRUE(cache_value->executable == nullptr);
+  EXPECT_EQ(cache->Lookup(key2)->executable->data, "bar_exe");
+}
+
+TEST(DeviceCompilationCacheTest, EvictLeastFrequentlyUsed) {
+  auto cache = std::make_unique<Cache>(
+      TestEvictionOptions(DeviceCompilationCacheEvictionPolicy::kLfu));
+
+  TF_ASSERT_OK_AND_ASSIGN(auto key1, BuildSampleSignature("foo"));
+  TF_ASSERT_OK_AND_ASSIGN(auto key2, BuildSampleSignature("bar"));
+  cache->Store(key1, DeviceCompileState::kCompiled, absl::OkStatus(),
+               std::nullopt, std::make_unique<FakeExecutable>("foo_exe"));
+  cache->LookupOrCreate(key1);
+  cache->LookupOrCreate(key1);
+  cache->Store(key2, DeviceCompileState::kCompiled, absl::OkStatus(),
+               std::nullopt, std::make_unique<FakeExecutable>("bar_exe"));
+  cache->LookupOrCreate(key2);
+
+  auto evicted = cache->EvictToFit();
+  ASSERT_EQ(evicted.size(), 1);
+  EXPECT_EQ(evicted[0].executable->data, "bar_exe");
+  EXPECT_EQ(cache->Lookup(key1)->executable->data, "foo_exe");
+  EXPECT_EQ(cache->Lookup(key2)->eviction_count, 1);
+}
+
+TEST(DeviceCompilationCacheTest, EvictHotEntriesLast) {
+  auto cache = std::make_unique<Cache>(
+      TestEvictionOptions(DeviceCompilationCacheEvictionPolicy::kLru));
+
+  TF_ASSERT_OK_AND_ASSIGN(auto key1, BuildSampleSignature("foo"));
+  TF_ASSERT_OK_AND_ASSIGN(auto key2, BuildSampleSignature("bar"));
+  cache->Store(key1, DeviceCompileState::kCompiled, absl::OkStatus(),
+               std::nullopt, std::make_unique<FakeExecutable>("foo_exe"));
+  Env::Default()->SleepForMicroseconds(1000);
+  cache->Store(key2, DeviceCompileState::kCompiled, absl::OkStatus(),
+               std::nullopt, std::make_unique<FakeExecutable>("bar_exe"));
+
+  auto evicted = cache->EvictToFit(
+      [&key1](const Signature& key, const Cache::Value& value) {
+        return key == key1;
+      });
+  ASSERT_EQ(evicted.size(), 1);
+  EXPECT_EQ(evicted[0].executable->data, "bar_exe");
+  EXPECT_EQ(cache->Lookup(key1)->executable->data, "foo_exe");
+
+  // Hot entries are evicted too if the cache doesn't fit otherwise.
+  Env::Default()->SleepForMicroseconds(1000);
+  cache->Store(key2, DeviceCompileState::kCompiled, absl::OkStatus(),
+               std::nullopt, std::make_unique<FakeExecutable>("bar_exe_2"));
+  evicted = cache->EvictToFit(
+      [](const Signature& key, const Cache::Value& value) { return true; });
+  ASSERT_EQ(evicted.size(), 1);
+  EXPECT_EQ(evicted[0].executable->data, "foo_exe");
+  EXPECT_EQ(cache->SizeInBytes(), 9);
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -65,6 +65,10 @@ constexpr int64_t kDefaultCompilationThreshold = 2;
 // Maximum number of ongoing compilations.
 constexpr int64_t kMaxNumOngoingCompilations = kNumAsyncDeviceCompilerThreads;
 
+// A signature is hot if it is requested for at least 1 in this many executions
+// of its cluster.
+constexpr int64_t kHotSignatureExecutionShare = 4;
+
 }  // namespace
 
 DeviceCompilationProfiler::~DeviceCompilationProfiler() {
@@ -198,6 +202,17 @@ bool DeviceCompilationProfiler::ShouldCompileCluster(
   return reached_compile_threshold;
 }
 
+bool DeviceCompilationProfiler::IsHotSignature(const NameAttrList& function,
+                                               int64_t request_count) const {
+  mutex_lock lock(mu_);
+  auto it = cluster_compile_stats_.find(function.name());
+  if (it == cluster_compile_stats_.end() || it->second.is_megamorphic) {
+    return false;
+  }
+  return request_count > 0 && request_count * kHotSignatureExecutionShare >=
+                                  it->second.execution_count;
+}
+
 void DeviceCompilationProfiler::IncrementOngoingAsyncCompilations() {
   mutex_lock lock(mu_);
   num_ongoing_compilations_++;
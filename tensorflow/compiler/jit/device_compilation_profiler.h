@@ -78,6 +78,13 @@ class DeviceCompilationProfiler : public ResourceBase {
                                      int64_t compile_time_us,
                                      bool used_persistent_cache);
 
+  // Returns true if a signature of `function` that has been requested
+  // `request_count` times is hot, i.e. the cluster is not megamorphic and the
+  // signature accounts for a large share of its executions. The executables
+  // of hot signatures are evicted from the compilation cache last.
+  bool IsHotSignature(const NameAttrList& function,
+                      int64_t request_count) const;
+
   void IncrementOngoingAsyncCompilations();
   void DecrementOngoingAsyncCompilations();
   int64_t GetNumOngoingAsyncCompilations() const;
@@ -105,6 +105,23 @@ TEST(DeviceCompilationProfilerTest, OngoingAsyncCompilations) {
   EXPECT_EQ(profiler->GetNumOngoingAsyncCompilations(), 0);
 }
 
+TEST(DeviceCompilationProfilerTest, IsHotSignature) {
+  DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
+  core::ScopedUnref profiler_ref(profiler);
+
+  NameAttrList function;
+  function.set_name("TestFunc");
+  EXPECT_FALSE(profiler->IsHotSignature(function, 1));
+
+  for (int i = 0; i < 8; ++i) {
+    profiler->RegisterExecution(function);
+  }
+  EXPECT_TRUE(profiler->IsHotSignature(function, 8));
+  EXPECT_TRUE(profiler->IsHotSignature(function, 2));
+  EXPECT_FALSE(profiler->IsHotSignature(function, 1));
+  EXPECT_FALSE(profiler->IsHotSignature(function, 0));
+}
+
 TEST(DeviceCompilationProfilerTest, ShouldCompileClusterNotFound) {
   DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
   core::ScopedUnref profiler_ref(profiler);
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_DEVICE_COMPILER_H_
 #define TENSORFLOW_COMPILER_JIT_DEVICE_COMPILER_H_
 
+#include <functional>
 #include <memory>
 #include <numeric>
 #include <optional>
@@ -99,22 +100,33 @@ class DeviceCompiler : public ResourceBase {
   // `ExecutableType` and sets `out_executable` to point to it. The
   // resulting executable pointer may be null if the computation has no
   // non-constant outputs.
+  //
+  // The cache may evict the compilation result and executable once they are
+  // no longer in use. Callers that use them after this call returns must pass
+  // a non-null `out_pin` and keep `*out_pin` alive for as long as they do.
   Status CompileIfNeeded(
       const XlaCompiler::Options& options, const NameAttrList& function,
       const std::vector<XlaCompiler::Argument>& args,
       const XlaCompiler::CompileOptions& compile_options,
       DeviceCompileMode compile_mode, DeviceCompilationProfiler* profiler,
       const XlaCompiler::CompilationResult** out_compilation_result,
-      ExecutableType** out_executable);
-
-  // As above, but for a single op.
+      ExecutableType** out_executable,
+      std::shared_ptr<const void>* out_pin = nullptr);
+
+  // As above, but for a single op. Only `kStrict` and `kAsync` compile modes
+  // are supported. With `kAsync`, the op is compiled in the background and
+  // null is returned into both `out_compilation_result` and `out_executable`
+  // until the compilation has finished; the caller must then run the op
+  // without XLA.
   Status CompileSingleOpIfNeeded(
       const XlaCompiler::Options& options,
       const std::vector<XlaCompiler::Argument>& args,
       const XlaCompiler::CompileOptions& compile_options, OpKernelContext* ctx,
       DeviceCompilationProfiler* profiler,
       const XlaCompiler::CompilationResult** out_compilation_result,
-      ExecutableType** out_executable);
+      ExecutableType** out_executable,
+      DeviceCompileMode compile_mode = DeviceCompileMode::kStrict,
+      std::shared_ptr<const void>* out_pin = nullptr);
 
   ClientType* client() const { return compiler_client_->client(); }
   const DeviceType& device_type() const { return persistor_->device_type(); }
@@ -138,8 +150,11 @@ class DeviceCompiler : public ResourceBase {
       DeviceCompileMode compile_mode, OpKernelContext* ctx,
       DeviceCompilationProfiler* profiler,
       const XlaCompiler::CompilationResult** out_compilation_result,
-      ExecutableType** out_executable);
+      ExecutableType** out_executable, std::shared_ptr<const void>* out_pin);
 
+  // `single_op_arg` must be non-null for `CompileScope::kOp`. It is used
+  // instead of the `OpKernelContext` so that single ops can also be compiled
+  // after the kernel invocation has returned.
   StatusOr<typename DeviceCompilationCache<ExecutableType>::Value>
   CompileStrict(
       const DeviceCompilationClusterSignature& sig,
@@ -148,17 +163,31 @@ class DeviceCompiler : public ResourceBase {
       const std::vector<XlaCompiler::Argument>& args,
       const NameAttrList& function,
       typename DeviceCompilationCache<ExecutableType>::Value cache_value,
-      CompileScope scope, OpKernelContext* ctx,
+      CompileScope scope,
+      const XlaCompiler::SingleOpCompileArgument* single_op_arg,
       DeviceCompilationProfiler* profiler, mutex* mu)
       TF_EXCLUSIVE_LOCKS_REQUIRED(*mu);
 
-  Status CompileAsynchronous(const DeviceCompilationClusterSignature& sig,
-                             const XlaCompiler::CompileOptions& compile_options,
-                             const XlaCompiler::Options& options,
-                             const std::vector<XlaCompiler::Argument>& args,
-                             const NameAttrList& function, CompileScope scope,
-                             OpKernelContext* ctx,
-                             DeviceCompilationProfiler* profiler);
+  Status CompileAsynchronous(
+      const DeviceCompilationClusterSignature& sig,
+      const XlaCompiler::CompileOptions& compile_options,
+      const XlaCompiler::Options& options,
+      const std::vector<XlaCompiler::Argument>& args,
+      const NameAttrList& function, CompileScope scope,
+      std::optional<XlaCompiler::SingleOpCompileArgument> single_op_arg,
+      DeviceCompilationProfiler* profiler);
+
+  // Runs the pending asynchronous compilation of the hottest cluster, i.e. the
+  // one that `DeviceCompilationProfiler` has seen executed the most, so that
+  // clusters that are run often get compiled first when all the compiler
+  // threads are busy. Scheduled once on `async_compiler_threads_` for every
+  // pending compilation.
+  void RunHottestPendingCompilation();
+
+  // Evicts entries from `cache_` if it exceeds its size budget. Signatures that
+  // `profiler` considers hot are evicted last. Waits for the programs running
+  // on the device to finish before destroying the evicted executables.
+  void EvictFromCacheIfNeeded(DeviceCompilationProfiler* profiler);
 
   std::unique_ptr<DeviceExecutablePersistor<ExecutableType, ClientType>>
       persistor_;
@@ -169,11 +198,26 @@ class DeviceCompiler : public ResourceBase {
   // Pool of threads for asynchronous compilations.
   std::unique_ptr<thread::ThreadPool> async_compiler_threads_;
 
+  // An asynchronous compilation that is waiting for a compiler thread.
+  struct PendingCompilation {
+    NameAttrList function;
+    DeviceCompilationProfiler* profiler;
+    std::function<void()> compile;
+  };
+  mutex pending_compilations_mu_;
+  std::vector<PendingCompilation> pending_compilations_
+      TF_GUARDED_BY(pending_compilations_mu_);
+
   mutex cluster_mutexes_mu_;
   absl::flat_hash_map<DeviceCompilationClusterSignature, std::unique_ptr<mutex>,
                       DeviceCompilationClusterSignature::Hash>
       cluster_mutexes_ TF_GUARDED_BY(cluster_mutexes_mu_);
 
+  // Maps the names of the signatures to the names of their clusters, as known
+  // to `DeviceCompilationProfiler`.
+  absl::flat_hash_map<std::string, std::string> cluster_names_
+      TF_GUARDED_BY(cluster_mutexes_mu_);
+
   DeviceCompiler(const DeviceCompiler&) = delete;
   void operator=(const DeviceCompiler&) = delete;
 };
@@ -203,6 +247,23 @@ inline Status EligibleToPersist(DeviceCompileState compile_state,
   }
   return absl::OkStatus();
 }
+
+template <typename ExecutableType>
+typename DeviceCompilationCache<ExecutableType>::EvictionOptions
+GetCacheEvictionOptionsFromFlags() {
+  const MarkForCompilationPassFlags* flags = GetMarkForCompilationPassFlags();
+  typename DeviceCompilationCache<ExecutableType>::EvictionOptions
+      eviction_options;
+  eviction_options.max_size_bytes = flags->tf_xla_compilation_cache_max_bytes;
+  const std::string& policy = flags->tf_xla_compilation_cache_eviction_policy;
+  if (policy == "lfu") {
+    eviction_options.policy = DeviceCompilationCacheEvictionPolicy::kLfu;
+  } else if (policy != "lru") {
+    LOG(WARNING) << "Unknown --tf_xla_compilation_cache_eviction_policy "
+                 << policy << ", evicting least recently used entries first.";
+  }
+  return eviction_options;
+}
 }  // namespace device_compiler_internal
 
 template <typename ExecutableType, typename ClientType>
@@ -213,7 +274,9 @@ DeviceCompiler<ExecutableType, ClientType>::DeviceCompiler(
         compiler_client)
     : persistor_(std::move(persistor)),
       compiler_client_(std::move(compiler_client)) {
-  cache_ = std::make_unique<DeviceCompilationCache<ExecutableType>>();
+  cache_ = std::make_unique<DeviceCompilationCache<ExecutableType>>(
+      device_compiler_internal::GetCacheEvictionOptionsFromFlags<
+          ExecutableType>());
   async_compiler_threads_ = std::make_unique<tensorflow::thread::ThreadPool>(
       tensorflow::Env::Default(), "async_compiler_threads",
       kNumAsyncDeviceCompilerThreads);
@@ -250,10 +313,10 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileIfNeeded(
     const XlaCompiler::CompileOptions& compile_options,
     DeviceCompileMode compile_mode, DeviceCompilationProfiler* profiler,
     const XlaCompiler::CompilationResult** out_compilation_result,
-    ExecutableType** out_executable) {
+    ExecutableType** out_executable, std::shared_ptr<const void>* out_pin) {
   return CompileImpl(compile_options, options, function, args,
                      CompileScope::kFunction, compile_mode, /*ctx=*/nullptr,
-                     profiler, out_compilation_result, out_executable);
+                     profiler, out_compilation_result, out_executable, out_pin);
 }
 
 template <typename ExecutableType, typename ClientType>
@@ -263,7 +326,12 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileSingleOpIfNeeded(
     const XlaCompiler::CompileOptions& compile_options, OpKernelContext* ctx,
     DeviceCompilationProfiler* profiler,
     const XlaCompiler::CompilationResult** out_compilation_result,
-    ExecutableType** out_executable) {
+    ExecutableType** out_executable, DeviceCompileMode compile_mode,
+    std::shared_ptr<const void>* out_pin) {
+  if (compile_mode == DeviceCompileMode::kLazy) {
+    return errors::InvalidArgument(
+        "Lazy compilation is not supported for single ops.");
+  }
   const NodeDef& def = ctx->op_kernel().def();
   NameAttrList name;
   name.set_name(def.op());
@@ -273,8 +341,8 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileSingleOpIfNeeded(
   // and causes false uniqueness between nodes.
   name.mutable_attr()->erase("_class");
   return CompileImpl(compile_options, options, name, args, CompileScope::kOp,
-                     DeviceCompileMode::kStrict, ctx, profiler,
-                     out_compilation_result, out_executable);
+                     compile_mode, ctx, profiler, out_compilation_result,
+                     out_executable, out_pin);
 }
 
 template <typename ExecutableType, typename ClientType>
@@ -286,7 +354,8 @@ DeviceCompiler<ExecutableType, ClientType>::CompileStrict(
     const std::vector<XlaCompiler::Argument>& args,
     const NameAttrList& function,
     typename DeviceCompilationCache<ExecutableType>::Value cache_value,
-    CompileScope scope, OpKernelContext* ctx,
+    CompileScope scope,
+    const XlaCompiler::SingleOpCompileArgument* single_op_arg,
     DeviceCompilationProfiler* profiler, mutex* mu) {
   tensorflow::Env* env = tensorflow::Env::Default();
   const uint64 compile_start_us = env->NowMicros();
@@ -299,8 +368,9 @@ DeviceCompiler<ExecutableType, ClientType>::CompileStrict(
       std::make_unique<XlaCompiler::CompilationResult>();
 
   if (scope == CompileScope::kOp) {
+    TF_RET_CHECK(single_op_arg != nullptr);
     cache_value.compilation_status = compiler.CompileSingleOp(
-        compile_options, ctx, args, out_compilation_result.get());
+        compile_options, *single_op_arg, args, out_compilation_result.get());
   } else {
     CHECK(scope == CompileScope::kFunction);  // Crash OK
     cache_value.compilation_status = compiler.Compile(
@@ -339,6 +409,7 @@ DeviceCompiler<ExecutableType, ClientType>::CompileStrict(
   cache_value.executable = out_executable.get();
   cache_->Store(sig, cache_value.compile_state, cache_value.compilation_status,
                 std::move(out_compilation_result), std::move(out_executable));
+  EvictFromCacheIfNeeded(profiler);
 
   const uint64 compile_end_us = env->NowMicros();
   const uint64 compile_time_us = compile_end_us - compile_start_us;
@@ -355,7 +426,8 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileAsynchronous(
     const XlaCompiler::CompileOptions& compile_options,
     const XlaCompiler::Options& options,
     const std::vector<XlaCompiler::Argument>& args,
-    const NameAttrList& function, CompileScope scope, OpKernelContext* ctx,
+    const NameAttrList& function, CompileScope scope,
+    std::optional<XlaCompiler::SingleOpCompileArgument> single_op_arg,
     DeviceCompilationProfiler* profiler) {
   // Explicitly capture all required data by value for async compilation.
   // Update compilation state in cache.
@@ -372,7 +444,7 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileAsynchronous(
   // All values are captured by value. Make sure that all pointer values (like
   // entry) do not get freed until the lambda has finished.
   const std::string& function_name = function.name();
-  async_compiler_threads_->Schedule([=] {
+  auto compile = [=] {
     VLOG(2) << "Starting asynchronous compilation of cluster " << function_name
             << '.';
     // We don't need to lock mu, but do it anyway to satisfy thread safety
@@ -380,8 +452,10 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileAsynchronous(
     mutex mu;
     mutex_lock lock(mu);
     auto cache_value = typename DeviceCompilationCache<ExecutableType>::Value();
-    auto s = CompileStrict(signature, compile_options, options, args, function,
-                           cache_value, scope, ctx, profiler, &mu);
+    auto s = CompileStrict(
+        signature, compile_options, options, args, function, cache_value,
+        scope, single_op_arg.has_value() ? &*single_op_arg : nullptr,
+        profiler, &mu);
     VLOG(2) << "Finished asynchronous compililation of cluster "
             << function_name << '.';
     profiler->DecrementOngoingAsyncCompilations();
@@ -390,10 +464,65 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileAsynchronous(
       cache_->Store(signature, std::nullopt, s.status(), std::nullopt,
                     std::nullopt);
     }
-  });
+  };
+  {
+    mutex_lock lock(pending_compilations_mu_);
+    pending_compilations_.push_back({function, profiler, std::move(compile)});
+  }
+  async_compiler_threads_->Schedule([this] { RunHottestPendingCompilation(); });
   return absl::OkStatus();
 }
 
+template <typename ExecutableType, typename ClientType>
+void DeviceCompiler<ExecutableType,
+                    ClientType>::RunHottestPendingCompilation() {
+  std::function<void()> compile;
+  {
+    mutex_lock lock(pending_compilations_mu_);
+    if (pending_compilations_.empty()) return;
+    // Execution counts keep growing while compilations are pending, so they
+    // are looked up here rather than when the compilation is queued.
+    int64_t hottest_execution_count = -1;
+    auto hottest = pending_compilations_.begin();
+    for (auto it = pending_compilations_.begin();
+         it != pending_compilations_.end(); ++it) {
+      auto stats = it->profiler->GetCompileStats(it->function);
+      int64_t execution_count = stats.ok() ? stats->execution_count : 0;
+      if (execution_count > hottest_execution_count) {
+        hottest_execution_count = execution_count;
+        hottest = it;
+      }
+    }
+    compile = std::move(hottest->compile);
+    pending_compilations_.erase(hottest);
+  }
+  compile();
+}
+
+template <typename ExecutableType, typename ClientType>
+void DeviceCompiler<ExecutableType, ClientType>::EvictFromCacheIfNeeded(
+    DeviceCompilationProfiler* profiler) {
+  auto evicted = cache_->EvictToFit(
+      [this, profiler](
+          const DeviceCompilationClusterSignature& signature,
+          const typename DeviceCompilationCache<ExecutableType>::Value& value) {
+        NameAttrList function;
+        {
+          mutex_lock lock(cluster_mutexes_mu_);
+          auto it = cluster_names_.find(signature.name);
+          if (it == cluster_names_.end()) return false;
+          function.set_name(it->second);
+        }
+        return profiler->IsHotSignature(function, value.request_count);
+      });
+  if (evicted.empty()) return;
+
+  compiler_client_->WaitForProgramsToFinish();
+  for (const auto& evicted_value : evicted) {
+    metrics::UpdateXlaCompilationCacheEviction(evicted_value.size_bytes);
+  }
+}
+
 template <typename ExecutableType, typename ClientType>
 Status DeviceCompiler<ExecutableType, ClientType>::CompileImpl(
     const XlaCompiler::CompileOptions& compile_options,
@@ -402,7 +531,7 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileImpl(
     DeviceCompileMode compile_mode, OpKernelContext* ctx,
     DeviceCompilationProfiler* profiler,
     const XlaCompiler::CompilationResult** out_compilation_result,
-    ExecutableType** out_executable) {
+    ExecutableType** out_executable, std::shared_ptr<const void>* out_pin) {
   DCHECK_NE(out_executable, nullptr);
   VLOG(2) << "DeviceCompiler::Compile " << DebugString();
 
@@ -422,6 +551,7 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileImpl(
     auto it =
         cluster_mutexes_.emplace(signature, std::make_unique<mutex>()).first;
     cluster_mutex = it->second.get();
+    cluster_names_.try_emplace(signature.name, function.name());
   }
 
   profiler->RegisterExecution(function);
@@ -470,19 +600,29 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileImpl(
                                         current_request_count)) {
       VLOG(2) << "Not compiling for signature: " << human_signature;
       return absl::OkStatus();
-    } else if (compile_mode == DeviceCompileMode::kAsync) {
+    }
+    if (cache_value.eviction_count > 0) {
+      metrics::UpdateXlaCompilationCacheRecompileCount();
+    }
+    std::optional<XlaCompiler::SingleOpCompileArgument> single_op_arg;
+    if (scope == CompileScope::kOp) {
+      single_op_arg.emplace(*ctx);
+    }
+    if (compile_mode == DeviceCompileMode::kAsync) {
       VLOG(2) << "Queueing asynchronous compilation for signature: "
               << human_signature;
-      TF_RETURN_IF_ERROR(CompileAsynchronous(signature, compile_options,
-                                             options, args, function, scope,
-                                             ctx, profiler));
+      TF_RETURN_IF_ERROR(CompileAsynchronous(
+          signature, compile_options, options, args, function, scope,
+          std::move(single_op_arg), profiler));
       return absl::OkStatus();
     } else {
       VLOG(2) << "Instantly compiling for signature: " << human_signature;
       TF_ASSIGN_OR_RETURN(
           cache_value,
           CompileStrict(signature, compile_options, options, args, function,
-                        cache_value, scope, ctx, profiler, cluster_mutex));
+                        cache_value, scope,
+                        single_op_arg.has_value() ? &*single_op_arg : nullptr,
+                        profiler, cluster_mutex));
     }
   } else if (state == DeviceCompileState::kCompiling) {
     VLOG(2) << "Ongoing asynchronous compilation for signature: "
@@ -495,6 +635,9 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileImpl(
   TF_RETURN_IF_ERROR(cache_value.compilation_status);
   *out_compilation_result = cache_value.compilation_result;
   *out_executable = cache_value.executable;
+  if (out_pin != nullptr) {
+    *out_pin = std::move(cache_value.pin);
+  }
   return absl::OkStatus();
 }
 
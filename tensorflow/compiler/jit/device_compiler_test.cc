@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/status.h"
@@ -516,5 +517,58 @@ TEST_F(OpsTestBase, CompileSingleOpSuccess) {
   EXPECT_TRUE(xla_executable != nullptr);
 }
 
+TEST_F(OpsTestBase, CompileSingleOpAsyncSuccess) {
+  TF_EXPECT_OK(NodeDefBuilder("identity_op", "Identity")
+                   .Input(FakeInput(DT_FLOAT))
+                   .Attr("T", DT_FLOAT)
+                   .Finalize(node_def()));
+  TF_EXPECT_OK(InitOp());
+  AddInputFromArray<float>(TensorShape({1, 2}), {6.9, 4.2});
+  TF_EXPECT_OK(RunOpKernel());
+
+  auto xla_device_compiler = CreateXlaDeviceCompiler();
+  core::ScopedUnref xla_device_compiler_ref(xla_device_compiler);
+
+  auto profiler = new DeviceCompilationProfiler();
+  core::ScopedUnref profiler_ref(profiler);
+
+  const XlaCompiler::CompilationResult* compilation_result = nullptr;
+  xla::LocalExecutable* xla_executable = nullptr;
+
+  XlaOpRegistry::RegisterCompilationKernels();
+  auto flib_def = std::make_unique<FunctionLibraryDefinition>(
+      OpRegistry::Global(), FunctionDefLibrary());
+
+  XlaCompiler::Options options;
+  options.device_type = DeviceType(DEVICE_GPU_XLA_JIT);
+  options.client = GetLocalClient();
+  options.flib_def = flib_def.get();
+
+  std::vector<XlaCompiler::Argument> args(1);
+  args[0].kind = XlaCompiler::Argument::kConstant;
+  args[0].type = DT_FLOAT;
+  args[0].shape = TensorShape({1, 2});
+  args[0].constant_value = GetInput(0);
+  args[0].initialized = true;
+
+  TF_EXPECT_OK(xla_device_compiler->CompileSingleOpIfNeeded(
+      options, args, XlaCompiler::CompileOptions{}, context_.get(), profiler,
+      &compilation_result, &xla_executable, DeviceCompileMode::kAsync));
+
+  // The op is compiled in the background, so the caller has to fall back.
+  EXPECT_TRUE(compilation_result == nullptr);
+  EXPECT_TRUE(xla_executable == nullptr);
+
+  while (profiler->GetNumOngoingAsyncCompilations() > 0) {
+    Env::Default()->SleepForMicroseconds(1000);
+  }
+
+  TF_EXPECT_OK(xla_device_compiler->CompileSingleOpIfNeeded(
+      options, args, XlaCompiler::CompileOptions{}, context_.get(), profiler,
+      &compilation_result, &xla_executable, DeviceCompileMode::kAsync));
+  EXPECT_TRUE(compilation_result != nullptr);
+  EXPECT_TRUE(xla_executable != nullptr);
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -16,8 +16,11 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_DEVICE_EXECUTABLE_PERSISTOR_H_
 #define TENSORFLOW_COMPILER_JIT_DEVICE_EXECUTABLE_PERSISTOR_H_
 
+#include <functional>
+#include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "absl/log/log.h"
 #include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
@@ -28,6 +31,8 @@ limitations under the License.
 #include "xla/util.h"
 #include "tensorflow/core/framework/device.h"
 #include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
@@ -38,11 +43,23 @@ namespace tensorflow {
 // Offers a way to persist and/or load compiled `ExecutableType`s along with the
 // corresponding HLO (`CompilationResult`) to/from `persistent_cache_directory`
 // (if one was provided during construction) on disk  using `ClientType`.
+//
+// Entries can also be shared between processes through a
+// `remote_cache_directory`, e.g. on GCS, and fetched on a miss by a
+// `fetch_on_miss` callback. Entries read from either are copied to
+// `persistent_cache_directory`. Errors of the remote directory and of
+// `fetch_on_miss` are logged and treated as misses, and saving to the remote
+// directory is best effort.
 template <typename ExecutableType, typename ClientType>
 class DeviceExecutablePersistor {
  public:
   // Configuration for setting up persistence (directory, filename prefix, etc).
   struct Config {
+    // Returns the entry of `key`, or std::nullopt if there is none.
+    using FetchOnMissFn = std::function<
+        absl::StatusOr<std::optional<XlaSerializedCacheEntry>>(
+            const XlaSerializedCacheKey& key)>;
+
     Config() = default;
     explicit Config(absl::string_view persistent_cache_directory,
                     bool disable_strict_signature_checks,
@@ -74,6 +91,27 @@ class DeviceExecutablePersistor {
 
     // Cache is read-only if set to true.
     bool persistent_cache_directory_read_only = false;
+
+    // If non-empty, a file system directory path shared by multiple processes,
+    // possibly on a remote file system (e.g. "gs://bucket/dir"). Entries not
+    // found in `persistent_cache_directory` are loaded from it, and persisted
+    // entries are saved to it as well.
+    std::string remote_cache_directory;
+
+    // If set, called to fetch the entries found in neither directory.
+    FetchOnMissFn fetch_on_miss;
+
+    // If true and both directories are set, the entries of the remote cache
+    // directory that match the prefix, device type and environment of this
+    // persistor are copied to `persistent_cache_directory` in the background
+    // on construction.
+    bool prefetch_remote_entries = false;
+
+    // Identify the compiler and the device the executables are compiled for.
+    // They are part of the cache keys, so that entries are only shared
+    // between processes that would compile the same executables.
+    std::string compiler_version;
+    std::string device_description;
   };
 
   DeviceExecutablePersistor(const Config& config,
@@ -109,6 +147,12 @@ class DeviceExecutablePersistor {
   const std::string& persistent_cache_directory() const {
     return persistent_cache_directory_;
   }
+  const std::string& remote_cache_directory() const {
+    return remote_cache_directory_;
+  }
+
+  // Blocks until the prefetch of the remote entries, if any, is done.
+  void WaitForPrefetch() { prefetch_thread_.reset(); }
 
  private:
   // Returns a cache key proto that identifies an entry in the compilation
@@ -127,16 +171,26 @@ class DeviceExecutablePersistor {
       const ExecutableType& executable,
       DeviceCompilerClient<ExecutableType, ClientType>* compiler_client) const;
 
-  // Saves the cache entry in the file directory supplied during the
-  // construction of this class. Overwrites existing entries.
-  Status SaveSerializedEntry(const XlaSerializedCacheEntry& entry) const;
+  // Saves the cache entry in `directory`. Overwrites existing entries.
+  Status SaveSerializedEntry(const XlaSerializedCacheEntry& entry,
+                             const std::string& directory) const;
 
-  // Tries to read a cache entry given a `key` by searching the file directory
-  // supplied during the construction of this class. Returns std::nullopt if no
-  // cache entry is found.
+  // Tries to read a cache entry given a `key` from the persistent cache
+  // directory, then the remote cache directory, then `fetch_on_miss_`.
+  // Returns std::nullopt if no cache entry is found, and only fails for errors
+  // of the persistent cache directory.
   absl::StatusOr<std::optional<XlaSerializedCacheEntry>>
   TryToReadSerializedEntry(const XlaSerializedCacheKey& key) const;
 
+  // Reads the cache entry of `key` in `directory`, if any.
+  absl::StatusOr<std::optional<XlaSerializedCacheEntry>>
+  TryToReadSerializedEntry(const XlaSerializedCacheKey& key,
+                           const std::string& directory) const;
+
+  // Copies the entries of the remote cache directory that can be loaded by
+  // this persistor to the persistent cache directory.
+  void PrefetchRemoteEntries() const;
+
   // Checks if the loaded `entry` matches the expected `key` and `hlo_module`.
   Status VerifyLoadedCacheEntry(const XlaSerializedCacheKey& key,
                                 const xla::HloModuleProto& hlo_module,
@@ -144,7 +198,14 @@ class DeviceExecutablePersistor {
 
   std::string XlaSerializedCacheKeyToString(
       const XlaSerializedCacheKey& key) const;
-  std::string GetFilePath(const XlaSerializedCacheKey& key) const;
+  // Returns the part of the string of `key` that identifies the device and
+  // compiler, which is shared by all the keys of this persistor.
+  std::string XlaSerializedCacheKeySuffix(
+      const XlaSerializedCacheKey& key) const;
+  std::string GetFilePath(const XlaSerializedCacheKey& key,
+                          const std::string& directory) const;
+
+  static constexpr char kXlaSerializedCacheKeySeparator[] = "__";
 
   const DeviceType device_type_;
   const bool disable_strict_signature_checks_;
@@ -157,6 +218,14 @@ class DeviceExecutablePersistor {
   // Cache is read-only if set to true.
   const bool persistent_cache_directory_read_only_;
 
+  const std::string remote_cache_directory_;
+  const typename Config::FetchOnMissFn fetch_on_miss_;
+  const std::string compiler_version_;
+  const std::string device_description_;
+
+  // Runs PrefetchRemoteEntries(). Declared last to be joined first.
+  std::unique_ptr<Thread> prefetch_thread_;
+
   DeviceExecutablePersistor(const DeviceExecutablePersistor&) = delete;
   void operator=(const DeviceExecutablePersistor&) = delete;
 };
@@ -170,28 +239,57 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::
       persistence_prefix_(config.persistence_prefix),
       persistent_cache_directory_(config.persistent_cache_directory),
       persistent_cache_directory_read_only_(
-          config.persistent_cache_directory_read_only) {}
+          config.persistent_cache_directory_read_only),
+      remote_cache_directory_(config.remote_cache_directory),
+      fetch_on_miss_(config.fetch_on_miss),
+      compiler_version_(config.compiler_version),
+      device_description_(config.device_description) {
+  if (config.prefetch_remote_entries && !persistent_cache_directory_.empty() &&
+      !remote_cache_directory_.empty() &&
+      !persistent_cache_directory_read_only_) {
+    prefetch_thread_.reset(Env::Default()->StartThread(
+        ThreadOptions(), "xla_persistent_cache_prefetch",
+        [this]() { PrefetchRemoteEntries(); }));
+  }
+}
 
 template <typename ExecutableType, typename ClientType>
 std::string DeviceExecutablePersistor<ExecutableType, ClientType>::
     XlaSerializedCacheKeyToString(const XlaSerializedCacheKey& key) const {
-  static constexpr char kXlaSerializedCacheKeySeparator[] = "__";
   return absl::StrCat(
       key.prefix(), key.prefix().empty() ? "" : kXlaSerializedCacheKeySeparator,
       key.signature_fingerprint(), kXlaSerializedCacheKeySeparator,
       key.cluster_fingerprint(), kXlaSerializedCacheKeySeparator,
+      XlaSerializedCacheKeySuffix(key));
+}
+
+template <typename ExecutableType, typename ClientType>
+std::string DeviceExecutablePersistor<ExecutableType, ClientType>::
+    XlaSerializedCacheKeySuffix(const XlaSerializedCacheKey& key) const {
+  // The environment is fingerprinted to keep file names short, and left out
+  // if unset so that existing entries can still be read.
+  const bool has_environment =
+      !key.compiler_version().empty() || !key.device_description().empty();
+  return absl::StrCat(
       key.device_type(),
       key.compiled_using_pjrt()
           ? absl::StrCat(kXlaSerializedCacheKeySeparator, "pjrt")
+          : "",
+      has_environment
+          ? absl::StrCat(kXlaSerializedCacheKeySeparator,
+                         Fingerprint64(absl::StrCat(
+                             key.compiler_version(),
+                             kXlaSerializedCacheKeySeparator,
+                             key.device_description())))
           : "");
 }
 
 template <typename ExecutableType, typename ClientType>
 std::string DeviceExecutablePersistor<ExecutableType, ClientType>::GetFilePath(
-    const XlaSerializedCacheKey& key) const {
+    const XlaSerializedCacheKey& key, const std::string& directory) const {
   const std::string file_name =
       absl::StrCat(XlaSerializedCacheKeyToString(key), ".pb");
-  return io::JoinPath(persistent_cache_directory_, file_name);
+  return io::JoinPath(directory, file_name);
 }
 
 template <typename ExecutableType, typename ClientType>
@@ -205,6 +303,8 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::BuildSerializedCacheKey(
   key.set_device_type(device_type().type_string());
   key.set_prefix(persistence_prefix());
   key.set_compiled_using_pjrt(compiled_using_pjrt);
+  key.set_compiler_version(compiler_version_);
+  key.set_device_description(device_description_);
   return key;
 }
 
@@ -228,9 +328,9 @@ DeviceExecutablePersistor<xla::PjRtLoadedExecutable, xla::PjRtClient>::
 template <typename ExecutableType, typename ClientType>
 absl::StatusOr<std::optional<XlaSerializedCacheEntry>>
 DeviceExecutablePersistor<ExecutableType, ClientType>::TryToReadSerializedEntry(
-    const XlaSerializedCacheKey& key) const {
+    const XlaSerializedCacheKey& key, const std::string& directory) const {
   Env* env = Env::Default();
-  const std::string file_path = GetFilePath(key);
+  const std::string file_path = GetFilePath(key, directory);
   if (!env->FileExists(file_path).ok()) {
     return absl::StatusOr<std::optional<XlaSerializedCacheEntry>>(std::nullopt);
   }
@@ -240,6 +340,97 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToReadSerializedEntry(
   return std::optional<XlaSerializedCacheEntry>(entry);
 }
 
+template <typename ExecutableType, typename ClientType>
+absl::StatusOr<std::optional<XlaSerializedCacheEntry>>
+DeviceExecutablePersistor<ExecutableType, ClientType>::TryToReadSerializedEntry(
+    const XlaSerializedCacheKey& key) const {
+  std::optional<XlaSerializedCacheEntry> entry;
+  if (!persistent_cache_directory_.empty()) {
+    TF_ASSIGN_OR_RETURN(
+        entry, TryToReadSerializedEntry(key, persistent_cache_directory_));
+    if (entry.has_value()) {
+      return entry;
+    }
+  }
+  // The shared caches only save compilations, and the compilation status is
+  // cached, so their errors, which may be transient, are misses.
+  if (!remote_cache_directory_.empty()) {
+    absl::StatusOr<std::optional<XlaSerializedCacheEntry>> remote_entry =
+        TryToReadSerializedEntry(key, remote_cache_directory_);
+    if (remote_entry.ok()) {
+      entry = *std::move(remote_entry);
+    } else {
+      LOG(WARNING) << "Failed to read an XLA cache entry from "
+                   << remote_cache_directory_ << ": " << remote_entry.status();
+    }
+  }
+  if (!entry.has_value() && fetch_on_miss_) {
+    absl::StatusOr<std::optional<XlaSerializedCacheEntry>> fetched_entry =
+        fetch_on_miss_(key);
+    if (fetched_entry.ok()) {
+      entry = *std::move(fetched_entry);
+    } else {
+      LOG(WARNING) << "Failed to fetch an XLA cache entry: "
+                   << fetched_entry.status();
+    }
+  }
+  if (entry.has_value() && !persistent_cache_directory_.empty() &&
+      !persistent_cache_directory_read_only_) {
+    Status s = SaveSerializedEntry(*entry, persistent_cache_directory_);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to copy a shared XLA cache entry to "
+                   << persistent_cache_directory_ << ": " << s;
+    }
+  }
+  return entry;
+}
+
+template <typename ExecutableType, typename ClientType>
+void DeviceExecutablePersistor<ExecutableType,
+                               ClientType>::PrefetchRemoteEntries() const {
+  XLA_SCOPED_LOGGING_TIMER(absl::StrCat("Prefetching XLA cache entries from ",
+                                        remote_cache_directory_));
+  Env* env = Env::Default();
+  // All the keys of this persistor share the prefix and the suffix.
+  const XlaSerializedCacheKey key =
+      BuildSerializedCacheKey(/*signature_hash=*/0, xla::HloModuleProto());
+  const std::string pattern = io::JoinPath(
+      remote_cache_directory_,
+      absl::StrCat(key.prefix(),
+                   key.prefix().empty() ? "" : kXlaSerializedCacheKeySeparator,
+                   "*", kXlaSerializedCacheKeySeparator,
+                   XlaSerializedCacheKeySuffix(key), ".pb"));
+  std::vector<std::string> remote_paths;
+  Status s = env->GetMatchingPaths(pattern, &remote_paths);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to list XLA cache entries matching " << pattern
+                 << ": " << s;
+    return;
+  }
+
+  int num_prefetched = 0;
+  for (const std::string& remote_path : remote_paths) {
+    const std::string local_path =
+        io::JoinPath(persistent_cache_directory_, io::Basename(remote_path));
+    if (env->FileExists(local_path).ok()) {
+      continue;
+    }
+    XlaSerializedCacheEntry entry;
+    s = ReadBinaryProto(env, remote_path, &entry);
+    if (s.ok()) {
+      s = SaveSerializedEntry(entry, persistent_cache_directory_);
+    }
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to prefetch XLA cache entry " << remote_path
+                   << ": " << s;
+      continue;
+    }
+    ++num_prefetched;
+  }
+  VLOG(1) << "Prefetched " << num_prefetched << " of " << remote_paths.size()
+          << " XLA cache entries from " << remote_cache_directory_;
+}
+
 template <typename ExecutableType, typename ClientType>
 Status
 DeviceExecutablePersistor<ExecutableType, ClientType>::VerifyLoadedCacheEntry(
@@ -277,21 +468,19 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::VerifyLoadedCacheEntry(
 template <typename ExecutableType, typename ClientType>
 Status
 DeviceExecutablePersistor<ExecutableType, ClientType>::SaveSerializedEntry(
-    const XlaSerializedCacheEntry& entry) const {
+    const XlaSerializedCacheEntry& entry, const std::string& directory) const {
   Env* env = Env::Default();
-  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(persistent_cache_directory_));
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(directory));
 
   // The cache on the filesystem can be read while we're writing out the proto.
   // To prevent reads of partially-written files, we write the proto to a temp
   // file, then move it into place once we're done writing.  And we warn the
   // user if these moves are not known to be atomic.
   bool has_atomic_move = false;
-  env->HasAtomicMove(persistent_cache_directory_, &has_atomic_move)
-      .IgnoreError();
+  env->HasAtomicMove(directory, &has_atomic_move).IgnoreError();
   if (!has_atomic_move) {
     LOG_EVERY_POW_2(WARNING)
-        << "Filesystem for XLA persistent cache at "
-        << persistent_cache_directory_
+        << "Filesystem for XLA persistent cache at " << directory
         << " does not support atomic moves.  Therefore the persistent cache is "
            "racy if you have multiple XLA compilations occurring "
            "simultaneously!  You have been warned. :)";
@@ -299,14 +488,14 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::SaveSerializedEntry(
 
   // Write to temp location, then when that completes, atomically move into the
   // final location.
-  std::string temp_path = io::JoinPath(
-      persistent_cache_directory_, XlaSerializedCacheKeyToString(entry.key()));
+  std::string temp_path =
+      io::JoinPath(directory, XlaSerializedCacheKeyToString(entry.key()));
   if (!env->CreateUniqueFileName(&temp_path, ".pb.tmp")) {
-    return absl::UnavailableError(absl::StrCat(
-        "Could not create a unique file inside ", persistent_cache_directory_));
+    return absl::UnavailableError(
+        absl::StrCat("Could not create a unique file inside ", directory));
   }
   TF_RETURN_IF_ERROR(WriteBinaryProto(env, temp_path, entry));
-  return env->RenameFile(temp_path, GetFilePath(entry.key()));
+  return env->RenameFile(temp_path, GetFilePath(entry.key(), directory));
 }
 
 template <typename ExecutableType, typename ClientType>
@@ -351,7 +540,8 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToLoadExecutable(
     const XlaCompiler::Options& options,
     const XlaCompiler::CompilationResult& compilation_result,
     DeviceCompilerClient<ExecutableType, ClientType>* compiler_client) const {
-  if (persistent_cache_directory_.empty()) {
+  if (persistent_cache_directory_.empty() && remote_cache_directory_.empty() &&
+      !fetch_on_miss_) {
     return std::nullopt;
   }
 
@@ -388,7 +578,8 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToPersistExecutable(
     const XlaCompiler::CompilationResult& compilation_result,
     const ExecutableType& executable,
     DeviceCompilerClient<ExecutableType, ClientType>* client) const {
-  if (persistent_cache_directory_.empty() ||
+  if ((persistent_cache_directory_.empty() &&
+       remote_cache_directory_.empty()) ||
       persistent_cache_directory_read_only_) {
     VLOG(1) << "Not persisting executable. No `persistent_cache_directory` "
                "provided or cache is read-only.";
@@ -400,7 +591,18 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToPersistExecutable(
   TF_ASSIGN_OR_RETURN(XlaSerializedCacheEntry serialized_entry,
                       SerializeEntry(signature_hash, options,
                                      compilation_result, executable, client));
-  TF_RETURN_IF_ERROR(SaveSerializedEntry(std::move(serialized_entry)));
+  if (!persistent_cache_directory_.empty()) {
+    TF_RETURN_IF_ERROR(
+        SaveSerializedEntry(serialized_entry, persistent_cache_directory_));
+  }
+  // Sharing the entry is best effort, and does not fail the compilation.
+  if (!remote_cache_directory_.empty()) {
+    Status s = SaveSerializedEntry(serialized_entry, remote_cache_directory_);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to save an XLA cache entry to "
+                   << remote_cache_directory_ << ": " << s;
+    }
+  }
   return absl::OkStatus();
 }
 
@@ -18,6 +18,7 @@ limitations under the License.
 #include <stdlib.h>
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -37,6 +38,7 @@ limitations under the License.
 #include "xla/pjrt/pjrt_client.h"
 #include "xla/pjrt/tfrt_cpu_pjrt_client.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/statusor.h"
@@ -631,5 +633,215 @@ TEST_F(DeviceExecutionPersistorTest, PersistPjRtAndXlaExecutables) {
   EXPECT_EQ(entry.executable(), serialized_xla_executable_);
 }
 
+TEST_F(DeviceExecutionPersistorTest, PersistToAndLoadFromRemoteCache) {
+  const std::string remote_dir = io::JoinPath(cache_dir_, "shared_remote");
+  XlaDeviceExecutablePersistor::Config writer_config(
+      /*persistent_cache_directory=*/io::JoinPath(cache_dir_, "shared_writer"),
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  writer_config.remote_cache_directory = remote_dir;
+  XlaDeviceExecutablePersistor writer(writer_config,
+                                      DefaultXlaOptions().device_type);
+
+  MockXlaCompilerClient mock_client;
+  EXPECT_CALL(mock_client, SerializeExecutable(_))
+      .WillOnce(Return(serialized_xla_executable_));
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+  TF_EXPECT_OK(writer.TryToPersistExecutable(
+      /*signature_hash=*/123, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, *executable, &mock_client));
+
+  // A persistor with an empty local directory loads the entry from the remote
+  // directory, and copies it to the local one.
+  const std::string reader_dir = io::JoinPath(cache_dir_, "shared_reader");
+  XlaDeviceExecutablePersistor::Config reader_config(
+      /*persistent_cache_directory=*/reader_dir,
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  reader_config.remote_cache_directory = remote_dir;
+  XlaDeviceExecutablePersistor reader(reader_config,
+                                      DefaultXlaOptions().device_type);
+  EXPECT_CALL(mock_client, LoadExecutable(_, _, serialized_xla_executable_))
+      .WillOnce(Return(ByMove(std::move(executable))));
+  auto loaded_executable = reader.TryToLoadExecutable(
+      /*signature_hash=*/123, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, &mock_client);
+  ASSERT_TRUE(loaded_executable.has_value());
+  TF_EXPECT_OK(loaded_executable->status());
+
+  auto key = CreateCacheKey(/*signature_hash=*/123, compilation_result_add_,
+                            reader.device_type(), reader.persistence_prefix());
+  TF_ASSERT_OK_AND_ASSIGN(auto entry, ReadCacheEntryFromFile(key, reader_dir));
+  EXPECT_EQ(entry.executable(), serialized_xla_executable_);
+}
+
+TEST_F(DeviceExecutionPersistorTest, LoadFetchesOnMiss) {
+  auto key = CreateCacheKey(/*signature_hash=*/123, compilation_result_add_,
+                            DefaultXlaOptions().device_type, "xla");
+  XlaSerializedCacheEntry fetched_entry;
+  *fetched_entry.mutable_key() = key;
+  *fetched_entry.mutable_hlo_module() =
+      compilation_result_add_.computation->proto();
+  fetched_entry.set_executable(serialized_xla_executable_);
+
+  XlaDeviceExecutablePersistor::Config config(
+      /*persistent_cache_directory=*/io::JoinPath(cache_dir_, "fetch_on_miss"),
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  int num_fetches = 0;
+  config.fetch_on_miss = [&](const XlaSerializedCacheKey& requested_key)
+      -> absl::StatusOr<std::optional<XlaSerializedCacheEntry>> {
+    ++num_fetches;
+    if (requested_key.signature_fingerprint() != key.signature_fingerprint()) {
+      return std::optional<XlaSerializedCacheEntry>();
+    }
+    return std::optional<XlaSerializedCacheEntry>(fetched_entry);
+  };
+  XlaDeviceExecutablePersistor persistor(config,
+                                         DefaultXlaOptions().device_type);
+
+  MockXlaCompilerClient mock_client;
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+  EXPECT_CALL(mock_client, LoadExecutable(_, _, serialized_xla_executable_))
+      .WillOnce(Return(ByMove(std::move(executable))));
+  EXPECT_FALSE(persistor
+                   .TryToLoadExecutable(
+                       /*signature_hash=*/12345, "different_signature",
+                       DefaultXlaOptions(), compilation_result_add_,
+                       &mock_client)
+                   .has_value());
+  EXPECT_TRUE(persistor
+                  .TryToLoadExecutable(
+                      /*signature_hash=*/123, "signature_string",
+                      DefaultXlaOptions(), compilation_result_add_,
+                      &mock_client)
+                  .has_value());
+  EXPECT_EQ(num_fetches, 2);
+}
+
+TEST_F(DeviceExecutionPersistorTest, FetchErrorsAreMisses) {
+  XlaDeviceExecutablePersistor::Config config(
+      /*persistent_cache_directory=*/io::JoinPath(cache_dir_, "fetch_error"),
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  config.fetch_on_miss = [](const XlaSerializedCacheKey& requested_key)
+      -> absl::StatusOr<std::optional<XlaSerializedCacheEntry>> {
+    return absl::UnavailableError("The cache service is down");
+  };
+  XlaDeviceExecutablePersistor persistor(config,
+                                         DefaultXlaOptions().device_type);
+
+  MockXlaCompilerClient mock_client;
+  EXPECT_FALSE(persistor
+                   .TryToLoadExecutable(
+                       /*signature_hash=*/123, "signature_string",
+                       DefaultXlaOptions(), compilation_result_add_,
+                       &mock_client)
+                   .has_value());
+}
+
+TEST_F(DeviceExecutionPersistorTest, RemoteCacheErrorsDoNotFail) {
+  // The remote directory can neither be read nor created, since its parent
+  // is a file.
+  const std::string file = io::JoinPath(cache_dir_, "remote_error_file");
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), file, "not a directory"));
+  const std::string local_dir = io::JoinPath(cache_dir_, "remote_error_local");
+  XlaDeviceExecutablePersistor::Config config(
+      /*persistent_cache_directory=*/local_dir,
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  config.remote_cache_directory = io::JoinPath(file, "remote");
+  XlaDeviceExecutablePersistor persistor(config,
+                                         DefaultXlaOptions().device_type);
+
+  MockXlaCompilerClient mock_client;
+  EXPECT_FALSE(persistor
+                   .TryToLoadExecutable(
+                       /*signature_hash=*/123, "signature_string",
+                       DefaultXlaOptions(), compilation_result_add_,
+                       &mock_client)
+                   .has_value());
+
+  // The entry is still saved to the local directory.
+  EXPECT_CALL(mock_client, SerializeExecutable(_))
+      .WillOnce(Return(serialized_xla_executable_));
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+  TF_EXPECT_OK(persistor.TryToPersistExecutable(
+      /*signature_hash=*/123, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, *executable, &mock_client));
+  auto key =
+      CreateCacheKey(/*signature_hash=*/123, compilation_result_add_,
+                     persistor.device_type(), persistor.persistence_prefix());
+  TF_ASSERT_OK_AND_ASSIGN(auto entry, ReadCacheEntryFromFile(key, local_dir));
+  EXPECT_EQ(entry.executable(), serialized_xla_executable_);
+}
+
+TEST_F(DeviceExecutionPersistorTest, PrefetchRemoteEntries) {
+  const std::string remote_dir = io::JoinPath(cache_dir_, "prefetch_remote");
+  XlaDeviceExecutablePersistor::Config writer_config(
+      /*persistent_cache_directory=*/"",
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  writer_config.remote_cache_directory = remote_dir;
+  XlaDeviceExecutablePersistor writer(writer_config,
+                                      DefaultXlaOptions().device_type);
+
+  MockXlaCompilerClient mock_client;
+  EXPECT_CALL(mock_client, SerializeExecutable(_))
+      .WillOnce(Return(serialized_xla_executable_));
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+  TF_EXPECT_OK(writer.TryToPersistExecutable(
+      /*signature_hash=*/123, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, *executable, &mock_client));
+
+  const std::string local_dir = io::JoinPath(cache_dir_, "prefetch_local");
+  XlaDeviceExecutablePersistor::Config config(
+      /*persistent_cache_directory=*/local_dir,
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  config.remote_cache_directory = remote_dir;
+  config.prefetch_remote_entries = true;
+  XlaDeviceExecutablePersistor persistor(config,
+                                         DefaultXlaOptions().device_type);
+  persistor.WaitForPrefetch();
+
+  auto key =
+      CreateCacheKey(/*signature_hash=*/123, compilation_result_add_,
+                     persistor.device_type(), persistor.persistence_prefix());
+  TF_ASSERT_OK_AND_ASSIGN(auto entry, ReadCacheEntryFromFile(key, local_dir));
+  EXPECT_EQ(entry.executable(), serialized_xla_executable_);
+}
+
+TEST_F(DeviceExecutionPersistorTest, RemoteEntriesKeyedByCompilerVersion) {
+  const std::string remote_dir = io::JoinPath(cache_dir_, "versioned_remote");
+  XlaDeviceExecutablePersistor::Config writer_config(
+      /*persistent_cache_directory=*/"",
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  writer_config.remote_cache_directory = remote_dir;
+  writer_config.compiler_version = "1";
+  XlaDeviceExecutablePersistor writer(writer_config,
+                                      DefaultXlaOptions().device_type);
+
+  MockXlaCompilerClient mock_client;
+  EXPECT_CALL(mock_client, SerializeExecutable(_))
+      .WillOnce(Return(serialized_xla_executable_));
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+  TF_EXPECT_OK(writer.TryToPersistExecutable(
+      /*signature_hash=*/123, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, *executable, &mock_client));
+
+  XlaDeviceExecutablePersistor::Config reader_config = writer_config;
+  reader_config.compiler_version = "2";
+  XlaDeviceExecutablePersistor reader(reader_config,
+                                      DefaultXlaOptions().device_type);
+  EXPECT_FALSE(reader
+                   .TryToLoadExecutable(
+                       /*signature_hash=*/123, "signature_string",
+                       DefaultXlaOptions(), compilation_result_add_,
+                       &mock_client)
+                   .has_value());
+}
+
 }  // namespace
 }  // namespace tensorflow
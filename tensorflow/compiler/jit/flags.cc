@@ -141,6 +141,11 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
            &mark_for_compilation_flags->tf_xla_clustering_fuel,
            "Places an artificial limit on the number of ops marked as "
            "eligible for clustering."),
+      Flag("tf_xla_clustering_cost_model_file",
+           &mark_for_compilation_flags->tf_xla_clustering_cost_model_file,
+           "If set, a file of per-op timings, one \"<op type> <TF kernel "
+           "time in us> <XLA time in us>\" per line. Auto-clustering then "
+           "only merges clusters when that is predicted to be profitable."),
       Flag("tf_xla_disable_deadness_safety_checks_for_debugging",
            &mark_for_compilation_flags
                 ->tf_xla_disable_deadness_safety_checks_for_debugging,
@@ -175,6 +180,25 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
            &mark_for_compilation_flags->tf_xla_persistent_cache_prefix,
            "Specifies the persistance cache prefix. Default is "
            "\"xla_compile_cache\""),
+      Flag("tf_xla_persistent_cache_remote_directory",
+           &mark_for_compilation_flags
+                ->tf_xla_persistent_cache_remote_directory,
+           "If non-empty, a file system directory path (e.g. on GCS) shared "
+           "with other processes, from which the entries missing from "
+           "--tf_xla_persistent_cache_directory are loaded and to which "
+           "executables are also persisted. Empty by default."),
+      Flag("tf_xla_compilation_cache_max_bytes",
+           &mark_for_compilation_flags->tf_xla_compilation_cache_max_bytes,
+           "If positive, upper bound on the size in bytes of the executables "
+           "and HLO modules in the compilation cache of each device. Entries "
+           "that have not been used for a minute are evicted to stay under "
+           "it. 0 (unbounded) by default."),
+      Flag("tf_xla_compilation_cache_eviction_policy",
+           &mark_for_compilation_flags
+                ->tf_xla_compilation_cache_eviction_policy,
+           "Order in which entries are evicted from the compilation cache, "
+           "\"lru\" for least recently used first (the default) or \"lfu\" "
+           "for least frequently used first."),
       Flag("tf_xla_sparse_core_disable_table_stacking",
            &sparse_core_flags->tf_xla_sparse_core_disable_table_stacking,
            "Disable table stacking for all the tables passed to the SparseCore"
@@ -234,6 +258,7 @@ void AllocateAndParseFlags() {
   mark_for_compilation_flags->tf_xla_cpu_global_jit = false;
   mark_for_compilation_flags->tf_xla_clustering_fuel =
       std::numeric_limits<int64_t>::max();
+  mark_for_compilation_flags->tf_xla_clustering_cost_model_file = "";
   mark_for_compilation_flags
       ->tf_xla_disable_deadness_safety_checks_for_debugging = false;
   mark_for_compilation_flags
@@ -245,6 +270,9 @@ void AllocateAndParseFlags() {
   mark_for_compilation_flags->tf_xla_disable_strict_signature_checks = false;
   mark_for_compilation_flags->tf_xla_persistent_cache_prefix =
       "xla_compile_cache";
+  mark_for_compilation_flags->tf_xla_persistent_cache_remote_directory = "";
+  mark_for_compilation_flags->tf_xla_compilation_cache_max_bytes = 0;
+  mark_for_compilation_flags->tf_xla_compilation_cache_eviction_policy = "lru";
 
   device_flags = new XlaDeviceFlags;
   device_flags->tf_xla_compile_on_demand = false;
@@ -263,6 +291,7 @@ void AllocateAndParseFlags() {
   ops_flags = new XlaOpsCommonFlags;
   ops_flags->tf_xla_always_defer_compilation = false;
   ops_flags->tf_xla_async_compilation = false;
+  ops_flags->tf_xla_shape_buckets = "";
   ops_flags->tf_xla_use_device_api.enabled_for_xla_launch_ = true;
   ops_flags->tf_xla_use_device_api.enabled_for_compile_on_demand_ = true;
   ops_flags->tf_xla_use_device_api.enabled_for_compile_and_run_ = true;
@@ -333,7 +362,16 @@ void AllocateAndParseFlags() {
        Flag("tf_xla_async_compilation", &ops_flags->tf_xla_async_compilation,
             "When lazy compilation is enabled, asynchronous compilation starts "
             "the cluster compilation in the background, and the fallback path "
-            "is executed until the compilation has finished."),
+            "is executed until the compilation has finished. Also applies to "
+            "ops compiled on demand on XLA_CPU devices, which run their CPU "
+            "kernel until the compilation has finished."),
+       Flag("tf_xla_shape_buckets", &ops_flags->tf_xla_shape_buckets,
+            "If set, XlaLaunch pads dimension 0 of the non-constant inputs of "
+            "clusters without resource variables to the smallest bucket that "
+            "fits, and slices dimension 0 of the outputs back, so that few "
+            "executables serve all batch sizes. Either \"pow2\" or a "
+            "comma-separated list of bucket sizes. Only correct for clusters "
+            "whose output rows depend only on the same input rows."),
        Flag("tf_xla_use_device_api_for_xla_launch",
             &ops_flags->tf_xla_use_device_api.enabled_for_xla_launch_,
             "If true, uses Device API (PjRt) for single device compilation and "
@@ -78,6 +78,10 @@ struct MarkForCompilationPassFlags {
   // eligible for clustering.
   int64_t tf_xla_clustering_fuel;
 
+  // If non-empty, a file of measured per-op timings (see ClusteringCostModel)
+  // used to only form clusters that are predicted to be faster with XLA.
+  std::string tf_xla_clustering_cost_model_file;
+
   // If tf_xla_disable_deadness_safety_checks_for_debugging is set to true then
   // we do not do deadness related safety checks.  This is unsound in general,
   // but can be used as a debugging aid.
@@ -111,6 +115,21 @@ struct MarkForCompilationPassFlags {
 
   // Specifies the persistance cache prefix. Default is "xla_compile_cache"
   string tf_xla_persistent_cache_prefix;
+
+  // If non-empty, a file system directory path, e.g. on GCS, that backs
+  // `tf_xla_persistent_cache_directory` and is shared with other processes.
+  std::string tf_xla_persistent_cache_remote_directory;
+
+  // If positive, upper bound on the size in bytes of the executables and HLO
+  // modules in the compilation cache of each device. Entries that have not
+  // been used for a minute are evicted to stay under it. 0 (unbounded) by
+  // default.
+  int64_t tf_xla_compilation_cache_max_bytes;
+
+  // Order in which entries are evicted from the compilation cache, "lru" for
+  // least recently used first (the default) or "lfu" for least frequently
+  // used first.
+  std::string tf_xla_compilation_cache_eviction_policy;
 };
 
 // Flags associated with XLA Sparse Core.
@@ -150,7 +169,14 @@ struct XlaOpsCommonFlags {
   bool tf_xla_always_defer_compilation;
   // If true, _XlaCompile compiles the cluster asynchronously with respect to
   // the main execution. The fallback path is taken while compilation happens.
+  // XlaCompileOnDemandOp also compiles asynchronously when the op has a
+  // regular kernel to fall back to.
   bool tf_xla_async_compilation;
+  // If non-empty, XlaLaunch pads the leading dimension of the inputs of
+  // clusters up to a bucket size before compiling and running them, and slices
+  // the outputs back. Either "pow2", for powers of two, or a comma-separated
+  // list of bucket sizes. Empty (disabled) by default.
+  std::string tf_xla_shape_buckets;
 
   class PjRtForSingleDeviceCompilationRollout {
    public:
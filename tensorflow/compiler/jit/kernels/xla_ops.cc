@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/kernels/xla_ops.h"
 
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
@@ -24,6 +25,7 @@ limitations under the License.
 #include <string_view>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
@@ -105,10 +107,12 @@ class ExecutableClosure {
   explicit ExecutableClosure(
       ClientType* client, ExecutableType* executable,
       const XlaCompiler::CompilationResult* compilation_result,
+      std::shared_ptr<const void> pin,
       ResourceVarsSnapshot resource_var_snapshots, int num_constant_args)
       : client_(client),
         executable_(executable),
         compilation_result_(compilation_result),
+        pin_(std::move(pin)),
         resource_var_snapshots_(std::move(resource_var_snapshots)),
         num_constant_args_(num_constant_args) {}
 
@@ -129,6 +133,9 @@ class ExecutableClosure {
   ClientType* client_;
   ExecutableType* executable_;
   const XlaCompiler::CompilationResult* compilation_result_;
+  // Keeps the compilation cache from evicting `executable_` and
+  // `compilation_result_` until the closure has run.
+  std::shared_ptr<const void> pin_;
   ResourceVarsSnapshot resource_var_snapshots_;
   int num_constant_args_;
 
@@ -373,7 +380,7 @@ Status CompileToLocalExecutable(
     DeviceCompileMode compile_mode, bool may_alias_resource_update,
     xla::LocalClient** client,
     const XlaCompiler::CompilationResult** compilation_result,
-    xla::LocalExecutable** executable) {
+    xla::LocalExecutable** executable, std::shared_ptr<const void>* pin) {
   // We store information about the JIT-compiled XLA computation
   // in the ResourceMgr.
   ResourceMgr* rm = ctx->resource_manager();
@@ -416,7 +423,7 @@ Status CompileToLocalExecutable(
 
   return xla_device_compiler->CompileIfNeeded(
       options, function, args, compile_options, compile_mode, profiler,
-      compilation_result, executable);
+      compilation_result, executable, pin);
 }
 
 Status GetUpdatedVariables(
@@ -480,7 +487,18 @@ XlaLocalLaunchBase::XlaLocalLaunchBase(OpKernelConstruction* ctx,
       resources_(resources),
       function_(function),
       platform_info_(XlaPlatformInfoFromDevice(ctx->device())),
-      has_ref_vars_(has_ref_vars) {}
+      has_ref_vars_(has_ref_vars) {
+  const std::string& shape_buckets =
+      GetXlaOpsCommonFlags()->tf_xla_shape_buckets;
+  // Padding is only done on regular devices, and would leak into the
+  // variables the cluster updates.
+  if (!shape_buckets.empty() && resources_.empty() &&
+      !platform_info_.is_on_xla_device()) {
+    auto buckets = ParseShapeBuckets(shape_buckets);
+    OP_REQUIRES_OK(ctx, buckets.status());
+    shape_buckets_ = *std::move(buckets);
+  }
+}
 
 void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
   VLOG(1) << "XlaLocalLaunchOpBase::Compute "
@@ -498,6 +516,31 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
   xla::PjRtClient* pjrt_client;                // Not owned.
   xla::PjRtLoadedExecutable* pjrt_executable;  // Not owned.
 
+  // Keeps the compilation cache from evicting the executable until the
+  // cluster has run.
+  std::shared_ptr<const void> pin;
+
+  bool use_pjrt = GetXlaOpsCommonFlags()
+                      ->tf_xla_use_device_api.IsEnabledInXlaLaunchForDevice(
+                          platform_info_.device_type());
+
+  // Pad the inputs to a bucketed shape before compiling, so that the cluster
+  // is only compiled for a few shapes when its batch size varies. `inputs`
+  // points into `padded_inputs`, which is shared with the continuation below.
+  auto padded_inputs = std::make_shared<std::vector<Tensor>>();
+  std::optional<int64_t> batch_size;
+  int64_t bucketed_size = 0;
+  if (shape_buckets_.has_value() && !use_pjrt) {
+    auto padded_batch_size = PadInputsToShapeBucket(
+        ctx, constants_, resources_, *shape_buckets_, &inputs,
+        padded_inputs.get());
+    OP_REQUIRES_OK_ASYNC(ctx, padded_batch_size.status(), done);
+    batch_size = *padded_batch_size;
+    if (batch_size.has_value()) {
+      bucketed_size = GetBucketedDimSize(*batch_size, *shape_buckets_);
+    }
+  }
+
   // Note that here we assume the shape of the variables don't change between
   // compilation and execution. The locks on the variables are released before
   // compilation so that we can achieve parallel compilation of different batch
@@ -523,16 +566,13 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
     xla_compiler_args = std::move(status_or_xla_compiler_args.value());
   }
 
-  bool use_pjrt = GetXlaOpsCommonFlags()
-                      ->tf_xla_use_device_api.IsEnabledInXlaLaunchForDevice(
-                          platform_info_.device_type());
   if (use_pjrt) {
     VLOG(2) << "Compiling using PJRT";
     Status status = CompileToPjRtLoadedExecutable(
         *ctx, platform_info_, function_, xla_compiler_args,
         DeviceCompileMode::kStrict, has_ref_vars_,
         /*may_alias_resource_update=*/true, &compilation_result, &pjrt_client,
-        &pjrt_executable);
+        &pjrt_executable, &pin);
     OP_REQUIRES_OK_ASYNC(ctx, status, done);
 
     VLOG(2) << "Compiled using PJRT: " << status;
@@ -542,7 +582,7 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
     VLOG(2) << "Executing using PJRT.";
 
     auto run_pjrt_cluster = [ctx, pjrt_client, pjrt_executable,
-                             compilation_result, done, inputs,
+                             compilation_result, pin, done, inputs,
                              resources = resources_]() {
       // Separate scope so that VariableInfo locks are released before done() is
       // called.
@@ -573,12 +613,13 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
       ctx, function_, /*has_ref_vars=*/has_ref_vars_, platform_info_,
       xla_compiler_args, DeviceCompileMode::kStrict,
       /*may_alias_resource_update=*/true, &client, &compilation_result,
-      &executable);
+      &executable, &pin);
   OP_REQUIRES_OK_ASYNC(ctx, status, done);
 
   // Continuation of the execution, may be run in a different thread.
-  auto run_xla_cluster = [ctx, client, executable, compilation_result, done,
-                          inputs, resources = resources_]() {
+  auto run_xla_cluster = [ctx, client, executable, compilation_result, pin,
+                          done, inputs, padded_inputs, batch_size,
+                          bucketed_size, resources = resources_]() {
     // Separate scope so that VariableInfo locks are released before done is
     // called.
     {
@@ -606,7 +647,7 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
       absl::StatusOr<std::vector<xla::ExecutionInput>> execution_inputs =
           launch_context.PopulateInputs(
               ctx, compilation_result, resource_var_ptrs,
-              /*missing_ctx_input_prefix=*/0, input_output_alias);
+              /*missing_ctx_input_prefix=*/0, input_output_alias, inputs);
       OP_REQUIRES_OK_ASYNC(ctx, execution_inputs.status(), done);
 
       xla::gpu::GpuExecutableRunOptions gpu_options;
@@ -640,6 +681,9 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
               /*missing_ctx_input_prefix=*/0, absl::MakeSpan(variable_infos),
               input_output_alias, resource_var_ptrs),
           done);
+      if (batch_size.has_value()) {
+        SliceOutputsFromShapeBucket(ctx, *batch_size, bucketed_size);
+      }
       VLOG(1) << "Done";
     }
     done();
@@ -741,6 +785,7 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
   xla::LocalExecutable* executable = nullptr;
   xla::PjRtClient* pjrt_client = nullptr;
   xla::PjRtLoadedExecutable* pjrt_executable = nullptr;
+  std::shared_ptr<const void> pin;
   ResourceVarsSnapshot variables_snapshot;
 
   std::vector<const Tensor*> inputs = InputsFromContext(ctx);
@@ -783,11 +828,12 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
       status = CompileToPjRtLoadedExecutable(
           *ctx, platform_info_, function_, args, compile_mode, has_ref_vars_,
           /*may_alias_resource_update=*/false, &kernel, &pjrt_client,
-          &pjrt_executable);
+          &pjrt_executable, &pin);
     } else {
       status = CompileToLocalExecutable(
           ctx, function_, has_ref_vars_, platform_info_, args, compile_mode,
-          /*may_alias_resource_update=*/false, &client, &kernel, &executable);
+          /*may_alias_resource_update=*/false, &client, &kernel, &executable,
+          &pin);
     }
     if (compile_mode != DeviceCompileMode::kLazy ||
         status.code() != error::UNIMPLEMENTED) {
@@ -832,15 +878,15 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
   if (use_pjrt) {
     PjRtExecutableClosureStore::KeyT key =
         PjRtExecutableClosureStore::Global()->Produce(PjRtExecutableClosure(
-            pjrt_client, pjrt_executable, kernel, std::move(variables_snapshot),
-            constants_.size()));
+            pjrt_client, pjrt_executable, kernel, std::move(pin),
+            std::move(variables_snapshot), constants_.size()));
     compilation_key.flat<tstring>()(0) = key;
     VLOG(2) << "Compiled with PJRT. compilation_key: " << key;
   } else {
     XlaExecutableClosureStore::KeyT key =
         XlaExecutableClosureStore::Global()->Produce(XlaExecutableClosure(
-            client, executable, kernel, std::move(variables_snapshot),
-            constants_.size()));
+            client, executable, kernel, std::move(pin),
+            std::move(variables_snapshot), constants_.size()));
     compilation_key.flat<tstring>()(0) = key;
     VLOG(2) << "Compiled with XLA. compilation_key: " << key;
   }
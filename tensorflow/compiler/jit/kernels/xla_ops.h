@@ -17,6 +17,9 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_JIT_KERNELS_XLA_OPS_H_
 
 #include <atomic>
+#include <cstdint>
+#include <optional>
+#include <vector>
 
 #include "tensorflow/compiler/jit/device_compiler.h"
 #include "tensorflow/compiler/jit/xla_device.h"
@@ -66,6 +69,10 @@ class XlaLocalLaunchBase : public AsyncOpKernel {
   const XlaPlatformInfo platform_info_;
 
   bool has_ref_vars_;
+
+  // Bucket sizes the leading dimension of the inputs is padded to, parsed from
+  // `tf_xla_shape_buckets`. Empty for powers of two, unset if disabled.
+  std::optional<std::vector<int64_t>> shape_buckets_;
 };
 
 // XlaLocalLaunchOp is used to replace a region of the TensorFlow graph
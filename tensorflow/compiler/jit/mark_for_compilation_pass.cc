@@ -34,6 +34,7 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_join.h"
+#include "tensorflow/compiler/jit/clustering_cost_model.h"
 #include "tensorflow/compiler/jit/compilability_check_util.h"
 #include "tensorflow/compiler/jit/deadness_analysis.h"
 #include "tensorflow/compiler/jit/defs.h"
@@ -123,6 +124,10 @@ class MarkForCompilationPassImpl {
     std::atomic<int64_t>* fuel;
 
     bool dump_graphs;
+
+    // If not null, clusters are only merged, and compiled, if that is
+    // predicted to be profitable.
+    const ClusteringCostModel* cost_model = nullptr;
   };
 
   MarkForCompilationPassImpl(DebugOptions debug_options, Graph* graph,
@@ -191,6 +196,13 @@ class MarkForCompilationPassImpl {
     // The size of the cluster excluding constant and identity nodes.
     int effective_cluster_size() const { return effective_cluster_size_; }
 
+    // The time compiling the cluster is estimated to save, in microseconds.
+    // Only computed if a ClusteringCostModel is used.
+    double estimated_benefit_us() const { return estimated_benefit_us_; }
+    void set_estimated_benefit_us(double estimated_benefit_us) {
+      estimated_benefit_us_ = estimated_benefit_us;
+    }
+
     // True if the cluster has functional control flow like `If` and `While`.
     bool has_functional_control_flow() const {
       return has_functional_control_flow_;
@@ -249,6 +261,7 @@ class MarkForCompilationPassImpl {
     int cluster_size_ = 1;
     int cycles_graph_node_id_;
     int effective_cluster_size_;
+    double estimated_benefit_us_ = 0;
     bool has_functional_control_flow_;
     DeviceSet devices_;
     std::optional<DeviceId> resource_op_device_;
@@ -587,6 +600,7 @@ void MarkForCompilationPassImpl::Cluster::Merge(Cluster* other) {
 
   cluster_size_ += other->cluster_size_;
   effective_cluster_size_ += other->effective_cluster_size_;
+  estimated_benefit_us_ += other->estimated_benefit_us_;
   has_functional_control_flow_ |= other->has_functional_control_flow_;
 
   devices_.UnionWith(other->devices_);
@@ -989,7 +1003,12 @@ Status MarkForCompilationPassImpl::CreateClusters() {
     // to (recursively) verify this fact, but that's probably not worth the
     // trouble.
 
-    if (cluster->effective_cluster_size() >= debug_options_.min_cluster_size ||
+    // With a cost model, clusters that are predicted to be slower with XLA
+    // are not compiled either.
+    bool is_profitable = debug_options_.cost_model == nullptr ||
+                         cluster->estimated_benefit_us() >= 0;
+    if ((cluster->effective_cluster_size() >= debug_options_.min_cluster_size &&
+         is_profitable) ||
         cluster->has_functional_control_flow() ||
         cluster->is_xla_compile_attr_true()) {
       string& name = cluster_names[cluster->cycles_graph_node_id()];
@@ -1180,6 +1199,10 @@ Status MarkForCompilationPassImpl::BuildInitialClusterSet() {
         resource_op_device, resource_var_operation_node_id, deadness_predicate,
         /*is_xla_compile_attr_true=*/is_xla_compile_attr_true,
         GetXlaScope(node));
+    if (debug_options_.cost_model != nullptr) {
+      new_cluster->set_estimated_benefit_us(
+          debug_options_.cost_model->EstimatedBenefitUs(node->type_string()));
+    }
 
     cluster_for_node_[node->id()].Get() = new_cluster;
   }
@@ -1551,6 +1574,17 @@ absl::StatusOr<bool> MarkForCompilationPassImpl::TryToContractEdge(
         from, to, "the new cluster will be larger than the max cluster size");
   }
 
+  if (debug_options_.cost_model != nullptr &&
+      !ClusteringCostModel::IsMergeProfitable(from->estimated_benefit_us(),
+                                              to->estimated_benefit_us())) {
+    return LogNotContractableAndReturnFalse(
+        from, to,
+        absl::StrCat("the cost model predicts that merging clusters with "
+                     "estimated benefits of ",
+                     from->estimated_benefit_us(), "us and ",
+                     to->estimated_benefit_us(), "us is not profitable"));
+  }
+
   TF_ASSIGN_OR_RETURN(bool will_introduce_cross_device_dependency,
                       ClusteringWillIntroduceInterDeviceDependency(*from, *to));
 
@@ -1924,6 +1958,8 @@ Status MarkForCompilationPass::Run(
   debug_options.min_cluster_size = flags->tf_xla_min_cluster_size;
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
   debug_options.dump_graphs = flags->tf_xla_clustering_debug;
+  TF_ASSIGN_OR_RETURN(debug_options.cost_model,
+                      GetClusteringCostModelFromFlags());
 
   return MarkForCompilation(options, debug_options);
 }
@@ -1943,6 +1979,8 @@ Status MarkForCompilationPass::RunForTest(
   debug_options.min_cluster_size = flags->tf_xla_min_cluster_size;
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
   debug_options.dump_graphs = flags->tf_xla_clustering_debug;
+  TF_ASSIGN_OR_RETURN(debug_options.cost_model,
+                      GetClusteringCostModelFromFlags());
 
   return MarkForCompilation(options, debug_options);
 }
@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/sendrecv_ops.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/compiler/jit/defs.h"
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/mark_for_compilation_pass_test_helper.h"
 #include "tensorflow/compiler/jit/node_matchers.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
@@ -51,6 +52,9 @@ limitations under the License.
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -142,6 +146,36 @@ TEST(XlaCompilationTest, Chains) {
   EXPECT_TRUE(clusters.find("D") == clusters.cend());
 }
 
+TEST(XlaCompilationTest, CostModelRejectsUnprofitableMerges) {
+  std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
+  {
+    GraphDefBuilder builder(GraphDefBuilder::kFailImmediately);
+    Node* a =
+        ops::SourceOp("UncompilableNullary", builder.opts().WithName("A"));
+    Node* b = ops::UnaryOp("Sigmoid", a, builder.opts().WithName("B"));
+    Node* c = ops::UnaryOp("Sigmoid", b, builder.opts().WithName("C"));
+    Node* d = ops::UnaryOp("Relu", c, builder.opts().WithName("D"));
+    ops::UnaryOp("Relu", d, builder.opts().WithName("E"));
+    TF_EXPECT_OK(GraphDefBuilderToGraph(builder, graph.get()));
+  }
+
+  // Relu is slower with XLA, so it is left out of the Sigmoid cluster.
+  string cost_model_file = io::JoinPath(testing::TmpDir(), "cost_model.txt");
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), cost_model_file,
+                                 "Sigmoid 10 2\nRelu 1 3\n"));
+  MarkForCompilationPassFlags* flags = GetMarkForCompilationPassFlags();
+  flags->tf_xla_clustering_cost_model_file = cost_model_file;
+  auto reset_flag = gtl::MakeCleanup(
+      [flags] { flags->tf_xla_clustering_cost_model_file.clear(); });
+
+  TF_ASSERT_OK(MarkForCompilationPassTestHelper::MarkForCompilation(&graph));
+  auto clusters = GetClusters(*graph);
+  EXPECT_EQ(2, clusters.size());
+  EXPECT_EQ(clusters["B"], clusters["C"]);
+  EXPECT_TRUE(clusters.find("D") == clusters.cend());
+  EXPECT_TRUE(clusters.find("E") == clusters.cend());
+}
+
 TEST(XlaCompilationTest, UncompilableCycles) {
   std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
   {
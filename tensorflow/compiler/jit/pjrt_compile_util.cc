@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/pjrt_compile_util.h"
 
+#include <memory>
 #include <vector>
 
 #include "tensorflow/compiler/jit/device_compilation_profiler.h"
@@ -45,7 +46,8 @@ Status CompileToPjRtLoadedExecutable(
     DeviceCompileMode compile_mode, bool has_ref_vars,
     bool may_alias_resource_update, FunctionLibraryRuntime* flr,
     ResourceMgr* rm, const XlaCompiler::CompilationResult** compilation_result,
-    xla::PjRtClient** client, xla::PjRtLoadedExecutable** executable) {
+    xla::PjRtClient** client, xla::PjRtLoadedExecutable** executable,
+    std::shared_ptr<const void>* pin) {
   PjRtDeviceCompiler* pjrt_device_compiler;
   DeviceCompilationProfiler* profiler;
   TF_RETURN_IF_ERROR(GetOrCreatePjRtDeviceCompilerAndProfiler(
@@ -67,7 +69,7 @@ Status CompileToPjRtLoadedExecutable(
 
   return pjrt_device_compiler->CompileIfNeeded(
       options, function, args, compile_options, compile_mode, profiler,
-      compilation_result, executable);
+      compilation_result, executable, pin);
 }
 
 Status CompileToPjRtLoadedExecutable(
@@ -77,13 +79,14 @@ Status CompileToPjRtLoadedExecutable(
     DeviceCompileMode compile_mode, bool has_ref_vars,
     bool may_alias_resource_update,
     const XlaCompiler::CompilationResult** compilation_result,
-    xla::PjRtClient** client, xla::PjRtLoadedExecutable** executable) {
+    xla::PjRtClient** client, xla::PjRtLoadedExecutable** executable,
+    std::shared_ptr<const void>* pin) {
   TF_ASSIGN_OR_RETURN(ResourceMgr * rm, GetResourceMgrForDeviceCompiler(
                                             ctx, platform_info.device_type()));
   return CompileToPjRtLoadedExecutable(
       ctx.device(), platform_info, function, args, compile_mode, has_ref_vars,
       may_alias_resource_update, ctx.function_library(), rm, compilation_result,
-      client, executable);
+      client, executable, pin);
 }
 
 }  // namespace tensorflow
@@ -15,6 +15,9 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_PJRT_COMPILE_UTIL_H_
 #define TENSORFLOW_COMPILER_JIT_PJRT_COMPILE_UTIL_H_
 
+#include <memory>
+#include <vector>
+
 #include "tensorflow/compiler/jit/xla_compile_util.h"
 #include "tensorflow/compiler/jit/xla_platform_info.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
@@ -29,7 +32,9 @@ namespace tensorflow {
 // Compiles a `function` to PjRtLoadedExecutable `executable` with `ctx`.
 // The compilation result is output in `compilation_result`. The PJRT client
 // used for compilation is output in `client`. The PJRT executable is output in
-// `executable`.
+// `executable`. If `pin` is non-null, it is set to a handle that keeps the
+// compilation cache from evicting `compilation_result` and `executable` while
+// it is alive.
 Status CompileToPjRtLoadedExecutable(
     const OpKernelContext& ctx, const XlaPlatformInfo& platform_info,
     const NameAttrList& function,
@@ -37,7 +42,8 @@ Status CompileToPjRtLoadedExecutable(
     DeviceCompileMode compile_mode, bool has_ref_vars,
     bool may_alias_resource_update,
     const XlaCompiler::CompilationResult** compilation_result,
-    xla::PjRtClient** client, xla::PjRtLoadedExecutable** executable);
+    xla::PjRtClient** client, xla::PjRtLoadedExecutable** executable,
+    std::shared_ptr<const void>* pin = nullptr);
 
 // Similar to the above function but it does not take a OpKernelContext.
 // Instead, it takes the following arguments that are obtained from
@@ -53,7 +59,8 @@ Status CompileToPjRtLoadedExecutable(
     DeviceCompileMode compile_mode, bool has_ref_vars,
     bool may_alias_resource_update, FunctionLibraryRuntime* flr,
     ResourceMgr* rm, const XlaCompiler::CompilationResult** compilation_result,
-    xla::PjRtClient** client, xla::PjRtLoadedExecutable** executable);
+    xla::PjRtClient** client, xla::PjRtLoadedExecutable** executable,
+    std::shared_ptr<const void>* pin = nullptr);
 
 }  // namespace tensorflow
 
@@ -15,15 +15,46 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/report_clustering_info_pass.h"
 
+#include <optional>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/jit/clustering_cost_model.h"
 #include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/xla_activity_listener.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
 
 namespace tensorflow {
+namespace {
+// Sets the estimated benefit of the clusters in `summary` of `graph`.
+void AddEstimatedBenefits(const Graph& graph,
+                          const ClusteringCostModel& cost_model,
+                          XlaAutoClusteringSummary* summary) {
+  absl::flat_hash_map<absl::string_view, double> benefit_us;
+  for (Node* n : graph.nodes()) {
+    std::optional<absl::string_view> cluster = GetXlaClusterForNode(*n);
+    if (cluster.has_value()) {
+      benefit_us[*cluster] += cost_model.EstimatedBenefitUs(n->type_string());
+    }
+  }
+  for (XlaAutoClusteringSummary::Cluster& cluster :
+       *summary->mutable_clusters()) {
+    cluster.set_estimated_benefit_us(benefit_us[cluster.name()]);
+  }
+}
+}  // namespace
+
 Status ReportClusteringInfoPass::Run(
     const GraphOptimizationPassOptions& options) {
   XlaAutoClusteringActivity activity;
   *activity.mutable_summary() = GetXlaAutoClusteringSummary(**options.graph);
+  TF_ASSIGN_OR_RETURN(const ClusteringCostModel* cost_model,
+                      GetClusteringCostModelFromFlags());
+  if (cost_model != nullptr) {
+    AddEstimatedBenefits(**options.graph, *cost_model,
+                         activity.mutable_summary());
+  }
   activity.set_global_jit_level(GetGlobalJitLevelForGraph(options));
   activity.set_cpu_global_jit_enabled(
       GetMarkForCompilationPassFlags()->tf_xla_cpu_global_jit);
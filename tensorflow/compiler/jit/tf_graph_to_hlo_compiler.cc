@@ -30,8 +30,16 @@ Status TfGraphToHloCompiler::Compile(const XlaCompiler::CompileOptions& options,
 Status TfGraphToHloCompiler::CompileSingleOp(
     const XlaCompiler::CompileOptions& options, const OpKernelContext* ctx,
     absl::Span<const XlaArgument> args, XlaCompilationResult* result) {
-  return ADD_SOURCE_LOCATION(xla_compiler_.CompileSingleOp(
-      options, XlaCompiler::SingleOpCompileArgument(*ctx), args, result));
+  return CompileSingleOp(options, XlaCompiler::SingleOpCompileArgument(*ctx),
+                         args, result);
+}
+
+Status TfGraphToHloCompiler::CompileSingleOp(
+    const XlaCompiler::CompileOptions& options,
+    const XlaCompiler::SingleOpCompileArgument& single_op_arg,
+    absl::Span<const XlaArgument> args, XlaCompilationResult* result) {
+  return ADD_SOURCE_LOCATION(
+      xla_compiler_.CompileSingleOp(options, single_op_arg, args, result));
 }
 
 }  // namespace tensorflow
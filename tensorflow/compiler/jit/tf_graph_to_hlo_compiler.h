@@ -48,6 +48,13 @@ class TfGraphToHloCompiler : public TfToHloCompiler {
                          absl::Span<const XlaArgument> args,
                          XlaCompilationResult* result) override;
 
+  // As above, but for a single op described by `single_op_arg`, which unlike
+  // the `OpKernelContext` may outlive the kernel invocation.
+  Status CompileSingleOp(
+      const XlaCompiler::CompileOptions& options,
+      const XlaCompiler::SingleOpCompileArgument& single_op_arg,
+      absl::Span<const XlaArgument> args, XlaCompilationResult* result);
+
  private:
   XlaCompiler xla_compiler_;
 
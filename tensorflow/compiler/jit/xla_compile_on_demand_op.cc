@@ -40,6 +40,7 @@ limitations under the License.
 #include "tensorflow/compiler/tf2xla/tf2xla_util.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 #include "tensorflow/compiler/tf2xla/xla_helpers.h"
+#include "tensorflow/compiler/tf2xla/xla_op_registry.h"
 #include "xla/client/local_client.h"
 #include "xla/executable_run_options.h"
 #include "xla/hlo/ir/hlo_input_output_alias_config.h"
@@ -47,11 +48,13 @@ limitations under the License.
 #include "xla/pjrt/tf_pjrt_client.h"
 #include "xla/service/executable.h"
 #include "xla/service/gpu/gpu_executable_run_options.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/op_requires.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -101,8 +104,44 @@ Status GetAndLockVariablesAndBuildXlaCompilerArguments(
                           static_cast<Device*>(ctx.device())));
   return absl::OkStatus();
 }
+
+// Returns the regular TensorFlow kernel to run the op with while it is being
+// compiled asynchronously, or null if the op should be compiled synchronously.
+// Only ops on XLA_CPU devices can fall back, to their CPU kernel, as XLA_CPU
+// tensors are in host memory.
+std::unique_ptr<OpKernel> CreateFallbackKernel(OpKernelConstruction* ctx,
+                                               const DeviceType& device_type) {
+  if (!GetXlaOpsCommonFlags()->tf_xla_async_compilation ||
+      device_type != DeviceType(DEVICE_XLA_CPU)) {
+    return nullptr;
+  }
+  std::string kernel_class_name;
+  if (!FindKernelDef(DeviceType(DEVICE_CPU), ctx->def(), /*def=*/nullptr,
+                     &kernel_class_name)
+           .ok() ||
+      kernel_class_name == "XlaCompileOnDemandOp") {
+    return nullptr;
+  }
+  Status status;
+  std::unique_ptr<OpKernel> kernel = CreateOpKernel(
+      DeviceType(DEVICE_CPU), ctx->device(),
+      ctx->device()->GetAllocator(AllocatorAttributes()), ctx->def(),
+      ctx->graph_def_version(), &status);
+  if (!status.ok() || kernel->AsAsync() != nullptr) {
+    VLOG(1) << "Compiling " << ctx->def().name()
+            << " synchronously as it has no usable CPU kernel: " << status;
+    return nullptr;
+  }
+  return kernel;
+}
 }  // namespace
 
+XlaCompileOnDemandOp::XlaCompileOnDemandOp(OpKernelConstruction* ctx)
+    : OpKernel(ctx),
+      platform_info_(XlaPlatformInfoFromDevice(ctx->device())),
+      fallback_kernel_(
+          CreateFallbackKernel(ctx, platform_info_.device_type())) {}
+
 Status XlaCompileOnDemandOp::Run(const ResourceVarsSnapshot& variable_args,
                                  const XlaCompiler::CompilationResult* result,
                                  const XlaDeviceCompiler* xla_device_compiler,
@@ -172,7 +211,7 @@ Status XlaCompileOnDemandOp::Compile(
     PjRtDeviceCompiler** pjrt_device_compiler,
     DeviceCompilationProfiler** profiler,
     const XlaCompiler::CompilationResult** result,
-    xla::PjRtLoadedExecutable** executable) {
+    xla::PjRtLoadedExecutable** executable, std::shared_ptr<const void>* pin) {
   TF_RETURN_IF_ERROR(GetOrCreatePjRtDeviceCompilerAndProfiler(
       *ctx, platform_info_, ctx->function_library(), pjrt_device_compiler,
       profiler));
@@ -186,7 +225,7 @@ Status XlaCompileOnDemandOp::Compile(
 
   return (*pjrt_device_compiler)
       ->CompileSingleOpIfNeeded(options, args, compile_options, ctx, *profiler,
-                                result, executable);
+                                result, executable, compile_mode(), pin);
 }
 
 Status XlaCompileOnDemandOp::Compile(
@@ -194,7 +233,7 @@ Status XlaCompileOnDemandOp::Compile(
     XlaDeviceCompiler** xla_device_compiler,
     DeviceCompilationProfiler** profiler,
     const XlaCompiler::CompilationResult** result,
-    xla::LocalExecutable** executable) {
+    xla::LocalExecutable** executable, std::shared_ptr<const void>* pin) {
   // We store information about the JIT-compiled XLA computation
   // in the ResourceMgr.
   ResourceMgr* rm = ctx->resource_manager();
@@ -228,12 +267,15 @@ Status XlaCompileOnDemandOp::Compile(
 
   return (*xla_device_compiler)
       ->CompileSingleOpIfNeeded(options, args, compile_options, ctx, *profiler,
-                                result, executable);
+                                result, executable, compile_mode(), pin);
 }
 
 void XlaCompileOnDemandOp::Compute(OpKernelContext* ctx) {
   const XlaCompiler::CompilationResult* result;
   DeviceCompilationProfiler* profiler;
+  // Keeps the compilation cache from evicting `result` and the executable
+  // until the op has run.
+  std::shared_ptr<const void> pin;
 
   OP_REQUIRES(ctx, ctx->function_library(),
               errors::Internal("Function library missing"));
@@ -260,13 +302,22 @@ void XlaCompileOnDemandOp::Compute(OpKernelContext* ctx) {
     PjRtDeviceCompiler* pjrt_device_compiler;
     xla::PjRtLoadedExecutable* pjrt_executable;
     OP_REQUIRES_OK(ctx, Compile(args, ctx, &pjrt_device_compiler, &profiler,
-                                &result, &pjrt_executable));
+                                &result, &pjrt_executable, &pin));
     // Hold the reference to the XLA device compiler and profiler during
     // evaluation. (We could probably free them sooner because the ResourceMgr
     // will retain references, but this is more obviously correct.)
     core::ScopedUnref pjrt_device_compiler_ref(pjrt_device_compiler);
     core::ScopedUnref profiler_ref(profiler);
 
+    if (result == nullptr) {
+      // The op is being compiled asynchronously. Release the variables, as
+      // the fallback kernel locks them itself.
+      variables.clear();
+      VLOG(2) << "Running " << def().name() << " with the fallback kernel.";
+      fallback_kernel_->Compute(ctx);
+      return;
+    }
+
     VLOG(2) << "Compiled op with PJRT: " << ctx->status();
     VLOG(2) << "result != nullptr: " << (result != nullptr);
     VLOG(2) << "pjrt_executable != nullptr: " << (pjrt_executable != nullptr);
@@ -294,13 +345,20 @@ void XlaCompileOnDemandOp::Compute(OpKernelContext* ctx) {
     XlaDeviceCompiler* xla_device_compiler;
     xla::LocalExecutable* executable;
     OP_REQUIRES_OK(ctx, Compile(args, ctx, &xla_device_compiler, &profiler,
-                                &result, &executable));
+                                &result, &executable, &pin));
     // Hold the reference to the XLA device compiler and profiler during
     // evaluation. (We could probably free them sooner because the ResourceMgr
     // will retain references, but this is more obviously correct.)
     core::ScopedUnref xla_device_compiler_ref(xla_device_compiler);
     core::ScopedUnref profiler_ref(profiler);
 
+    if (result == nullptr) {
+      // The op is being compiled asynchronously.
+      VLOG(2) << "Running " << def().name() << " with the fallback kernel.";
+      fallback_kernel_->Compute(ctx);
+      return;
+    }
+
     // Locks are acquired again when populating the `ctx` outputs.
     OP_REQUIRES_OK(
         ctx, Run(variable_args, result, xla_device_compiler, executable, ctx));
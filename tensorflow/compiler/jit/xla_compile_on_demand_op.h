@@ -19,11 +19,13 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_XLA_COMPILE_ON_DEMAND_OP_H_
 #define TENSORFLOW_COMPILER_JIT_XLA_COMPILE_ON_DEMAND_OP_H_
 
+#include <memory>
 #include <vector>
 
 #include "tensorflow/compiler/jit/device_compilation_profiler.h"
 #include "tensorflow/compiler/jit/variable_info.h"
 #include "tensorflow/compiler/jit/variable_info_util.h"
+#include "tensorflow/compiler/jit/xla_compile_util.h"
 #include "tensorflow/compiler/jit/xla_launch_util.h"
 #include "tensorflow/compiler/jit/xla_platform_info.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
@@ -39,11 +41,13 @@ namespace tensorflow {
 // An OpKernel that compiles an op to an XLA computation and runs it. Unlike
 // XlaLaunch this doesn't rely on any rewrites of the graphdef - it will run a
 // vanilla TensorFlow op as long as the bridge supports it.
+//
+// With `tf_xla_async_compilation`, ops that also have a regular TensorFlow
+// kernel for the device are compiled in the background, and are run with that
+// kernel until their compilation has finished.
 class XlaCompileOnDemandOp : public OpKernel {
  public:
-  explicit XlaCompileOnDemandOp(OpKernelConstruction* ctx)
-      : OpKernel(ctx),
-        platform_info_(XlaPlatformInfoFromDevice(ctx->device())) {}
+  explicit XlaCompileOnDemandOp(OpKernelConstruction* ctx);
   void Compute(OpKernelContext* ctx) override;
 
  private:
@@ -53,7 +57,8 @@ class XlaCompileOnDemandOp : public OpKernel {
                      xla_device_compiler,
                  DeviceCompilationProfiler** profiler,
                  const XlaCompiler::CompilationResult** result,
-                 xla::LocalExecutable** executable);
+                 xla::LocalExecutable** executable,
+                 std::shared_ptr<const void>* pin);
 
   Status Compile(const std::vector<XlaCompiler::Argument>& args,
                  OpKernelContext* ctx,
@@ -61,7 +66,8 @@ class XlaCompileOnDemandOp : public OpKernel {
                      pjrt_device_compiler,
                  DeviceCompilationProfiler** profiler,
                  const XlaCompiler::CompilationResult** result,
-                 xla::PjRtLoadedExecutable** executable);
+                 xla::PjRtLoadedExecutable** executable,
+                 std::shared_ptr<const void>* pin);
 
   Status Run(const ResourceVarsSnapshot& variable_args,
              const XlaCompiler::CompilationResult* result,
@@ -69,7 +75,16 @@ class XlaCompileOnDemandOp : public OpKernel {
                  xla_device_compiler,
              xla::LocalExecutable* executable, OpKernelContext* ctx);
 
+  DeviceCompileMode compile_mode() const {
+    return fallback_kernel_ != nullptr ? DeviceCompileMode::kAsync
+                                       : DeviceCompileMode::kStrict;
+  }
+
   const XlaPlatformInfo platform_info_;
+
+  // The regular TensorFlow kernel that runs the op while it is compiled
+  // asynchronously. Null if the op is compiled synchronously.
+  std::unique_ptr<OpKernel> fallback_kernel_;
 };
 
 }  // namespace tensorflow
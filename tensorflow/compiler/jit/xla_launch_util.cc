@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/xla_launch_util.h"
 
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <optional>
 #include <set>
@@ -26,6 +27,9 @@ limitations under the License.
 #include "absl/cleanup/cleanup.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "tensorflow/compiler/jit/pjrt_tensor_buffer.h"
 #include "tensorflow/compiler/jit/pjrt_tensor_buffer_util.h"
@@ -51,6 +55,7 @@ limitations under the License.
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/bits.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/platform/errors.h"
@@ -112,6 +117,104 @@ absl::StatusOr<std::vector<int>> GetConstantInputIndicesFromContext(
   return constant_input_indices;
 }
 
+absl::StatusOr<std::vector<int64_t>> ParseShapeBuckets(absl::string_view spec) {
+  std::vector<int64_t> buckets;
+  if (spec == "pow2") return buckets;
+  for (absl::string_view bucket : absl::StrSplit(spec, ',')) {
+    int64_t size;
+    if (!absl::SimpleAtoi(bucket, &size) || size <= 0) {
+      return errors::InvalidArgument("Invalid shape bucket size \"", bucket,
+                                     "\" in \"", spec, "\".");
+    }
+    buckets.push_back(size);
+  }
+  absl::c_sort(buckets);
+  return buckets;
+}
+
+int64_t GetBucketedDimSize(int64_t size, absl::Span<const int64_t> buckets) {
+  if (size <= 0) return size;
+  if (buckets.empty()) {
+    return int64_t{1} << Log2Ceiling64(static_cast<uint64_t>(size));
+  }
+  auto it = absl::c_lower_bound(buckets, size);
+  return it == buckets.end() ? size : *it;
+}
+
+namespace {
+// Copies `input` to the beginning of `padded` and zeroes the rest of it.
+Status CopyAndZeroPad(OpKernelContext* ctx, const Tensor& input,
+                      Tensor* padded) {
+  const uint64_t size = input.TotalBytes();
+  const uint64_t padding = padded->TotalBytes() - size;
+  se::Stream* stream =
+      ctx->op_device_context() ? ctx->op_device_context()->stream() : nullptr;
+  if (stream == nullptr) {
+    char* dst = static_cast<char*>(DMAHelper::base(padded));
+    std::memcpy(dst, DMAHelper::base(&input), size);
+    std::memset(dst + size, 0, padding);
+    return absl::OkStatus();
+  }
+  se::DeviceMemoryBase dst = XlaTensor::DeviceMemoryFromTensor(*padded);
+  if (size > 0) {
+    TF_RETURN_IF_ERROR(stream->MemcpyD2D(
+        &dst, XlaTensor::DeviceMemoryFromTensor(input), size));
+  }
+  se::DeviceMemoryBase tail = dst.GetByteSlice(size, padding);
+  return stream->MemZero(&tail, padding);
+}
+}  // namespace
+
+absl::StatusOr<std::optional<int64_t>> PadInputsToShapeBucket(
+    OpKernelContext* ctx, absl::Span<const int> constant_indices,
+    absl::Span<const int> resource_indices, absl::Span<const int64_t> buckets,
+    std::vector<const Tensor*>* inputs, std::vector<Tensor>* padded_inputs) {
+  std::optional<int64_t> batch_size;
+  int64_t bucketed_size = 0;
+  padded_inputs->clear();
+  // `inputs` points into `padded_inputs`, which must not be reallocated.
+  padded_inputs->reserve(inputs->size());
+  for (int i = 0; i < inputs->size(); ++i) {
+    const Tensor& input = *(*inputs)[i];
+    if (absl::c_linear_search(constant_indices, i) ||
+        absl::c_linear_search(resource_indices, i) || input.dims() == 0 ||
+        !DataTypeCanUseMemcpy(input.dtype())) {
+      continue;
+    }
+    if (!batch_size.has_value()) {
+      batch_size = input.dim_size(0);
+      bucketed_size = GetBucketedDimSize(*batch_size, buckets);
+      if (bucketed_size == *batch_size) return std::optional<int64_t>();
+    }
+    if (input.dim_size(0) != *batch_size) continue;
+
+    TensorShape padded_shape = input.shape();
+    TF_RETURN_IF_ERROR(padded_shape.SetDimWithStatus(0, bucketed_size));
+    Tensor padded;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_temp(input.dtype(), padded_shape, &padded));
+    TF_RETURN_IF_ERROR(CopyAndZeroPad(ctx, input, &padded));
+    padded_inputs->push_back(std::move(padded));
+    (*inputs)[i] = &padded_inputs->back();
+  }
+  if (padded_inputs->empty()) return std::optional<int64_t>();
+  VLOG(2) << "Padded " << padded_inputs->size() << " inputs from batch size "
+          << *batch_size << " to " << bucketed_size;
+  return batch_size;
+}
+
+void SliceOutputsFromShapeBucket(OpKernelContext* ctx, int64_t batch_size,
+                                 int64_t bucketed_size) {
+  for (int i = 0; i < ctx->num_outputs(); ++i) {
+    Tensor* output = ctx->mutable_output(i);
+    if (output == nullptr || output->dims() == 0 ||
+        output->dim_size(0) != bucketed_size) {
+      continue;
+    }
+    *output = output->Slice(0, batch_size);
+  }
+}
+
 XlaComputationLaunchContext::XlaComputationLaunchContext(
     xla::LocalClient* client, se::DeviceMemoryAllocator* xla_allocator,
     int device_ordinal, bool allocate_xla_tensors, bool use_multiple_streams)
@@ -152,7 +255,8 @@ XlaComputationLaunchContext::PopulateInputs(
     const XlaCompiler::CompilationResult* compilation_result,
     const std::map<int, const Tensor*>& resource_vars,
     int missing_ctx_input_prefix,
-    const xla::HloInputOutputAliasConfig& input_output_alias) {
+    const xla::HloInputOutputAliasConfig& input_output_alias,
+    absl::Span<const Tensor* const> inputs) {
   std::vector<xla::ExecutionInput> arguments;
   arguments.reserve(compilation_result->xla_input_shapes.size());
 
@@ -175,9 +279,10 @@ XlaComputationLaunchContext::PopulateInputs(
                                 update.modified;
                        });
 
-    const Tensor* t = is_resource_variable
-                          ? resource_var_it->second
-                          : &(ctx->input(arg_num - missing_ctx_input_prefix));
+    const int input_num = arg_num - missing_ctx_input_prefix;
+    const Tensor* t = is_resource_variable ? resource_var_it->second
+                      : inputs.empty()     ? &(ctx->input(input_num))
+                                           : inputs[input_num];
     CHECK(t);
     bool donate_buffer =
         t->RefCountIsOne() && is_updated_resource_variable &&
@@ -18,11 +18,15 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_XLA_LAUNCH_UTIL_H_
 #define TENSORFLOW_COMPILER_JIT_XLA_LAUNCH_UTIL_H_
 
+#include <cstdint>
 #include <map>
 #include <memory>
+#include <optional>
 #include <set>
 #include <vector>
 
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tensorflow/compiler/jit/variable_info.h"
 #include "tensorflow/compiler/jit/xla_tensor.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
@@ -49,6 +53,34 @@ std::vector<const Tensor*> InputsFromContext(OpKernelContext* ctx);
 absl::StatusOr<std::vector<int>> GetConstantInputIndicesFromContext(
     OpKernelContext* ctx);
 
+// Parses a `tf_xla_shape_buckets` flag value into sorted bucket sizes. Returns
+// an empty vector for "pow2", i.e. powers of two.
+absl::StatusOr<std::vector<int64_t>> ParseShapeBuckets(absl::string_view spec);
+
+// Returns the smallest bucket size that is at least `size`: the next power of
+// two if `buckets` is empty, or an element of the sorted `buckets` otherwise.
+// Returns `size` if it is not positive or larger than all the buckets.
+int64_t GetBucketedDimSize(int64_t size, absl::Span<const int64_t> buckets);
+
+// Pads dimension 0 of the `inputs` of `ctx` up to the bucket size with zeros,
+// so that clusters are compiled for a few bucketed shapes only. The batch size
+// is dimension 0 of the first input that isn't a constant or a resource, and
+// only the inputs with the same dimension 0 are padded. The padded tensors are
+// stored in `padded_inputs` and replace the original ones in `inputs`.
+//
+// Returns the batch size, or nullopt if it already is a bucket size and no
+// input was padded.
+absl::StatusOr<std::optional<int64_t>> PadInputsToShapeBucket(
+    OpKernelContext* ctx, absl::Span<const int> constant_indices,
+    absl::Span<const int> resource_indices, absl::Span<const int64_t> buckets,
+    std::vector<const Tensor*>* inputs, std::vector<Tensor>* padded_inputs);
+
+// Slices dimension 0 of the outputs of `ctx` computed from inputs padded by
+// PadInputsToShapeBucket, i.e. whose dimension 0 is `bucketed_size`, back to
+// `batch_size`. The sliced outputs share their buffer with the padded ones.
+void SliceOutputsFromShapeBucket(OpKernelContext* ctx, int64_t batch_size,
+                                 int64_t bucketed_size);
+
 Status SetOutputForConstant(
     OpKernelContext* ctx, bool requires_copy_to_device,
     const XlaCompiler::CompilationResult* compilation_result, int output_num);
@@ -185,12 +217,16 @@ class XlaComputationLaunchContext {
   // missing and adjusts input indices accordingly.  All elements in kernel's
   // input_mapping must be greater than or equal to `missing_ctx_input_prefix`
   // (in other words, no inputs actually required by the kernel can be missing).
+  //
+  // If `inputs` is non-empty, it is used instead of the inputs of `ctx`, e.g.
+  // for inputs padded by PadInputsToShapeBucket.
   absl::StatusOr<std::vector<xla::ExecutionInput>> PopulateInputs(
       OpKernelContext* ctx,
       const XlaCompiler::CompilationResult* compilation_result,
       const std::map<int, const Tensor*>& resource_vars,
       int missing_ctx_input_prefix,
-      const xla::HloInputOutputAliasConfig& input_output_alias);
+      const xla::HloInputOutputAliasConfig& input_output_alias,
+      absl::Span<const Tensor* const> inputs = {});
 
   // Given the XLA output in `output`, populate all outputs of `ctx`.  Also
   // writes out the resource variable updates.
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -523,6 +524,73 @@ TEST(XlaLaunchUtilTest, GetPjRtExecuteOptions) {
   EXPECT_TRUE(options.use_major_to_minor_data_layout_for_callbacks);
 }
 
+TEST(XlaLaunchUtilTest, ParseShapeBuckets) {
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<int64_t> buckets,
+                          ParseShapeBuckets("pow2"));
+  EXPECT_TRUE(buckets.empty());
+  TF_ASSERT_OK_AND_ASSIGN(buckets, ParseShapeBuckets("32,8,128"));
+  EXPECT_EQ(buckets, std::vector<int64_t>({8, 32, 128}));
+  EXPECT_FALSE(ParseShapeBuckets("8,x").ok());
+  EXPECT_FALSE(ParseShapeBuckets("0").ok());
+}
+
+TEST(XlaLaunchUtilTest, GetBucketedDimSize) {
+  EXPECT_EQ(GetBucketedDimSize(1, {}), 1);
+  EXPECT_EQ(GetBucketedDimSize(5, {}), 8);
+  EXPECT_EQ(GetBucketedDimSize(64, {}), 64);
+  EXPECT_EQ(GetBucketedDimSize(0, {}), 0);
+  EXPECT_EQ(GetBucketedDimSize(5, {8, 32}), 8);
+  EXPECT_EQ(GetBucketedDimSize(9, {8, 32}), 32);
+  EXPECT_EQ(GetBucketedDimSize(33, {8, 32}), 33);
+}
+
+TEST_F(OpsTestBase, PadInputsAndSliceOutputsForShapeBucket) {
+  TF_EXPECT_OK(NodeDefBuilder("identity_n", "IdentityN")
+                   .Input(FakeInput({DT_FLOAT, DT_INT32, DT_FLOAT}))
+                   .Finalize(node_def()));
+  TF_EXPECT_OK(InitOp());
+  AddInputFromArray<float>(TensorShape({3, 2}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<int32>(TensorShape({3}), {7, 8, 9});
+  // Not padded, as its leading dimension isn't the batch size.
+  AddInputFromArray<float>(TensorShape({2}), {10, 11});
+  CreateContext();
+
+  std::vector<const Tensor*> inputs = InputsFromContext(context_.get());
+  std::vector<Tensor> padded_inputs;
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::optional<int64_t> batch_size,
+      PadInputsToShapeBucket(context_.get(), /*constant_indices=*/{},
+                             /*resource_indices=*/{}, /*buckets=*/{}, &inputs,
+                             &padded_inputs));
+  ASSERT_EQ(batch_size, 3);
+  ASSERT_EQ(padded_inputs.size(), 2);
+  test::ExpectTensorEqual<float>(
+      *inputs[0], test::AsTensor<float>({1, 2, 3, 4, 5, 6, 0, 0},
+                                        TensorShape({4, 2})));
+  test::ExpectTensorEqual<int32>(*inputs[1],
+                                 test::AsTensor<int32>({7, 8, 9, 0}));
+  EXPECT_EQ(inputs[2], &context_->input(2));
+
+  for (int i = 0; i < inputs.size(); ++i) {
+    context_->set_output(i, *inputs[i]);
+  }
+  SliceOutputsFromShapeBucket(context_.get(), *batch_size,
+                              /*bucketed_size=*/4);
+  test::ExpectTensorEqual<float>(*GetOutput(0), *GetInput(0));
+  test::ExpectTensorEqual<int32>(*GetOutput(1), *GetInput(1));
+  test::ExpectTensorEqual<float>(*GetOutput(2), *GetInput(2));
+
+  // Nothing is padded if the batch size already is a bucket size.
+  inputs = InputsFromContext(context_.get());
+  TF_ASSERT_OK_AND_ASSIGN(
+      batch_size,
+      PadInputsToShapeBucket(context_.get(), /*constant_indices=*/{},
+                             /*resource_indices=*/{}, /*buckets=*/{3, 8},
+                             &inputs, &padded_inputs));
+  EXPECT_FALSE(batch_size.has_value());
+  EXPECT_TRUE(padded_inputs.empty());
+}
+
 TEST_F(PjRtExecutionUtilTest, RunPjRtExecutable) {
   XlaOpRegistry::RegisterCompilationKernels();
   TF_EXPECT_OK(NodeDefBuilder("AddV2", "AddV2")
@@ -24,6 +24,7 @@ limitations under the License.
 
 #include "absl/algorithm/container.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/compiler/jit/device_executable_persistor.h"
@@ -41,7 +42,9 @@ limitations under the License.
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/public/version.h"
 #include "tensorflow/core/tfrt/common/create_pjrt_client_util.h"
 #include "tensorflow/core/tfrt/common/global_state.h"
 #include "tensorflow/core/tfrt/common/pjrt_util.h"
@@ -59,12 +62,61 @@ using XlaDeviceExecutablePersistor =
 using PjRtDeviceExecutablePersistor =
     DeviceExecutablePersistor<xla::PjRtLoadedExecutable, xla::PjRtClient>;
 
+using FetchOnMissFn = XlaDeviceExecutablePersistor::Config::FetchOnMissFn;
+
+mutex fetch_on_miss_mu(LINKER_INITIALIZED);
+
+FetchOnMissFn& GetFetchOnMissFn()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(fetch_on_miss_mu) {
+  static auto* fetch_on_miss = new FetchOnMissFn();
+  return *fetch_on_miss;
+}
+
+// Sets up `persistor_config` to share the persistent cache with other
+// processes, if requested. `device_description` describes the device the
+// executables are compiled for.
+template <typename Config>
+void SetUpSharedCache(const std::string& device_description,
+                      Config& persistor_config) {
+  if (persistor_config.persistent_cache_directory.empty()) {
+    return;
+  }
+  persistor_config.remote_cache_directory =
+      GetMarkForCompilationPassFlags()
+          ->tf_xla_persistent_cache_remote_directory;
+  {
+    mutex_lock lock(fetch_on_miss_mu);
+    persistor_config.fetch_on_miss = GetFetchOnMissFn();
+  }
+  if (persistor_config.remote_cache_directory.empty() &&
+      !persistor_config.fetch_on_miss) {
+    return;
+  }
+  persistor_config.prefetch_remote_entries = true;
+  persistor_config.compiler_version =
+      absl::StrCat(TF_VERSION_STRING, "/", tf_git_version());
+  persistor_config.device_description = device_description;
+}
+
 XlaDeviceCompiler* CreateXlaDeviceCompiler(
     const XlaDeviceExecutablePersistor::Config& persistor_config,
     DeviceType compilation_device_type, xla::LocalClient* local_client) {
+  XlaDeviceExecutablePersistor::Config config = persistor_config;
+  se::StreamExecutor* executor =
+      local_client == nullptr
+          ? nullptr
+          : local_client->backend().default_stream_executor();
+  if (executor != nullptr) {
+    const se::DeviceDescription& description =
+        executor->GetDeviceDescription();
+    SetUpSharedCache(absl::StrCat(local_client->platform()->Name(), "/",
+                                  description.name(), "/",
+                                  description.platform_version()),
+                     config);
+  }
   return new XlaDeviceCompiler(
-      std::make_unique<XlaDeviceExecutablePersistor>(
-          std::move(persistor_config), compilation_device_type),
+      std::make_unique<XlaDeviceExecutablePersistor>(std::move(config),
+                                                     compilation_device_type),
       std::make_unique<XlaDeviceCompilerClient>(local_client));
 }
 
@@ -78,6 +130,13 @@ PjRtDeviceCompiler* CreatePjRtDeviceCompiler(DeviceType compilation_device_type,
       GetMarkForCompilationPassFlags()->tf_xla_disable_strict_signature_checks,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_prefix,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_read_only);
+  if (pjrt_client != nullptr && !pjrt_client->addressable_devices().empty()) {
+    SetUpSharedCache(
+        absl::StrCat(pjrt_client->platform_name(), "/",
+                     pjrt_client->addressable_devices()[0]->device_kind(), "/",
+                     pjrt_client->platform_version()),
+        persistor_config);
+  }
 
   return new PjRtDeviceCompiler(
       std::make_unique<PjRtDeviceExecutablePersistor>(
@@ -170,6 +229,11 @@ std::string GetPersistentCacheDirectory(
   return GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_directory;
 }
 
+void SetPersistentCacheFetchOnMissFn(FetchOnMissFn fetch_on_miss) {
+  mutex_lock lock(fetch_on_miss_mu);
+  GetFetchOnMissFn() = std::move(fetch_on_miss);
+}
+
 absl::StatusOr<std::optional<std::set<int>>> ParseVisibleDeviceList(
     absl::string_view visible_device_list) {
   std::set<int> gpu_ids;
@@ -16,12 +16,14 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_XLA_PLATFORM_INFO_H_
 #define TENSORFLOW_COMPILER_JIT_XLA_PLATFORM_INFO_H_
 
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
 
 #include "tensorflow/compiler/jit/device_compiler.h"
 #include "tensorflow/compiler/jit/pjrt_base_device.h"
+#include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
 #include "tensorflow/compiler/jit/xla_device.h"
 #include "xla/stream_executor/integrations/tf_allocator_adapter.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -156,6 +158,14 @@ XlaPlatformInfo XlaPlatformInfoFromDevice(DeviceBase* device);
 std::string GetPersistentCacheDirectory(
     const DeviceType& compilation_device_type);
 
+// Sets the function called to fetch the persistent cache entries found in
+// neither the persistent nor the remote cache directory, e.g. from a
+// compilation service. Only affects the device compilers created afterwards.
+void SetPersistentCacheFetchOnMissFn(
+    std::function<absl::StatusOr<std::optional<XlaSerializedCacheEntry>>(
+        const XlaSerializedCacheKey& key)>
+        fetch_on_miss);
+
 // Returns allocator from platform info if non-null, or populate and return a
 // pointer to the allocator adapter with allocator from context.
 //
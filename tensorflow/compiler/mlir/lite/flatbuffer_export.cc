@@ -522,6 +522,22 @@ namespace {
 using ::mlir::tf_saved_model::kTfSavedModelExportedNamesAttr;
 using ::mlir::tf_saved_model::kTfSavedModelIndexPathAttr;
 
+// Returns the raw storage of `attr` when it already has the layout of a TFLite
+// buffer, so that large constants are exported without first being copied
+// into a tensorflow::Tensor.
+std::optional<absl::string_view> GetRawBufferData(ElementsAttr attr) {
+  auto dense_attr = mlir::dyn_cast<mlir::DenseIntOrFPElementsAttr>(attr);
+  // Splats only store a single element.
+  if (!dense_attr || dense_attr.isSplat()) return std::nullopt;
+  mlir::Type element_type = dense_attr.getElementType();
+  if (!element_type.isIntOrFloat()) return std::nullopt;
+  // Booleans and sub-byte types are packed differently.
+  const unsigned bit_width = element_type.getIntOrFloatBitWidth();
+  if (bit_width == 1 || bit_width % 8 != 0) return std::nullopt;
+  llvm::ArrayRef<char> raw_data = dense_attr.getRawData();
+  return absl::string_view(raw_data.data(), raw_data.size());
+}
+
 // Helper struct that wraps inputs/outputs of a single SignatureDef.
 struct SignatureDefData {
   // Note, we are using maps here to make order deterministic
@@ -543,7 +559,7 @@ class Translator {
   // Translates the given MLIR module into TFLite FlatBuffer format and returns
   // the serialized output. Returns std::nullopt on unsupported, invalid inputs
   // or internal error.
-  static std::optional<std::string> Translate(
+  static std::optional<absl::Cord> Translate(
       ModuleOp module, const toco::TocoFlags& toco_flags,
       const std::unordered_set<std::string>& tags,
       OpOrArgNameMapper* op_or_arg_name_mapper,
@@ -593,7 +609,7 @@ class Translator {
         ->getOrLoadDialect<mlir::tf_executor::TensorFlowExecutorDialect>();
   }
 
-  std::optional<std::string> TranslateInternal();
+  std::optional<absl::Cord> TranslateInternal();
 
   // Returns TFLite buffer populated with constant value if the operation is
   // TFLite constant operation. Otherwise, returns an empty buffer. Emits error
@@ -721,9 +737,9 @@ class Translator {
   // Check compatibility with GPU delegate and returns the compatibility.
   bool CheckGpuDelegateCompatibility(uint8_t* model_buffer_pointer);
 
-  // Append constant and custom op buffers at the end of the flatbuffer and
-  // calculate the offsets
-  void AppendBufferData(absl::Cord& result);
+  // Append constant and custom op buffers to `result`, which starts at
+  // `base_offset` in the model, and calculate their offsets.
+  void AppendBufferData(uint64_t base_offset, absl::Cord& result);
 
   // Update constant & custom op buffer offsets
   // Return false if fail to update offset
@@ -828,7 +844,9 @@ class Translator {
   // Maps buffer data to corresponding buffer index
   // in the idx map, the value is a pair of offset and size
   absl::flat_hash_map<int, std::pair<uint64_t, uint64_t>> buffer_idx_map_;
-  absl::flat_hash_map<int, std::string> buffer_data_map_;
+  // Constants are referenced from the attribute storage of the module instead
+  // of being copied whenever possible.
+  absl::flat_hash_map<int, absl::Cord> buffer_data_map_;
   bool buffer_data_exported_ = false;
 
   // Maps custom options data to corresponding node
@@ -969,7 +987,7 @@ std::optional<BufferOffset<tflite::Buffer>> Translator::BuildBuffer(
     auto packed_buffer = tflite::PackInt4ValuesDensely(data);
     if (use_buffer_offset_) {
       buffer_data_map_[index] =
-          std::string(packed_buffer.begin(), packed_buffer.end());
+          absl::Cord(std::string(packed_buffer.begin(), packed_buffer.end()));
       return tflite::CreateBuffer(builder_, 0, 1, 1);
     } else {
       if (IsModelBiggerThan2GB(packed_buffer.size())) {
@@ -982,13 +1000,21 @@ std::optional<BufferOffset<tflite::Buffer>> Translator::BuildBuffer(
     }
   }
 
+  absl::string_view tensor_data;
   tensorflow::Tensor tensor;
-  auto status = tensorflow::ConvertToTensor(attr, &tensor);
-  if (!status.ok()) {
-    inst->emitError(
-        Twine("failed to convert value attribute to tensor with error: " +
-              status.ToString()));
-    return std::nullopt;
+  std::optional<absl::string_view> raw_data = GetRawBufferData(attr);
+  const bool is_raw_data = raw_data.has_value();
+  if (is_raw_data) {
+    tensor_data = *raw_data;
+  } else {
+    auto status = tensorflow::ConvertToTensor(attr, &tensor);
+    if (!status.ok()) {
+      inst->emitError(
+          Twine("failed to convert value attribute to tensor with error: " +
+                status.ToString()));
+      return std::nullopt;
+    }
+    tensor_data = tensor.tensor_data();
   }
 
   // TensorFlow and TensorFlow Lite use different string encoding formats.
@@ -1003,10 +1029,8 @@ std::optional<BufferOffset<tflite::Buffer>> Translator::BuildBuffer(
     char* tensor_buffer;
     int bytes = dynamic_buffer.WriteToBuffer(&tensor_buffer);
     if (use_buffer_offset_) {
-      std::vector<uint8_t> buffer_data(tensor_buffer, tensor_buffer + bytes);
+      buffer_data_map_[index] = absl::Cord(std::string(tensor_buffer, bytes));
       free(tensor_buffer);
-      buffer_data_map_[index] =
-          std::string(buffer_data.begin(), buffer_data.end());
       return tflite::CreateBuffer(builder_, 0, 1, 1);
     } else {
       if (IsModelBiggerThan2GB(bytes)) {
@@ -1020,9 +1044,13 @@ std::optional<BufferOffset<tflite::Buffer>> Translator::BuildBuffer(
     }
   }
 
-  absl::string_view tensor_data = tensor.tensor_data();
   if (use_buffer_offset_) {
-    buffer_data_map_[index] = std::string(tensor_data);
+    // The attribute storage is owned by the MLIRContext, which outlives the
+    // translation, so it is referenced instead of copied.
+    buffer_data_map_[index] =
+        is_raw_data
+            ? absl::MakeCordFromExternal(tensor_data, [](absl::string_view) {})
+            : absl::Cord(tensor_data);
     return tflite::CreateBuffer(builder_, 0, 1, 1);
   } else {
     if (IsModelBiggerThan2GB(tensor_data.size())) {
@@ -3317,7 +3345,7 @@ bool UpdateEntryFunction(ModuleOp module) {
   return true;
 }
 
-std::optional<std::string> Translator::Translate(
+std::optional<absl::Cord> Translator::Translate(
     ModuleOp module, const toco::TocoFlags& toco_flags,
     const std::unordered_set<std::string>& tags,
     OpOrArgNameMapper* op_or_arg_name_mapper,
@@ -3372,7 +3400,7 @@ bool Translator::CheckGpuDelegateCompatibility(uint8_t* model_buffer_pointer) {
   return gpu_compatibile;
 }
 
-std::optional<std::string> Translator::TranslateInternal() {
+std::optional<absl::Cord> Translator::TranslateInternal() {
   // A list of named regions in the module with main function being the first
   // in the list. The main function is required as the first subgraph in the
   // model is entry point for the model.
@@ -3587,52 +3615,48 @@ std::optional<std::string> Translator::TranslateInternal() {
     }
   }
 
-  absl::Cord result;
-  auto fbs = absl::string_view(
-      reinterpret_cast<const char*>(builder_.GetBufferPointer()),
-      builder_.GetSize());
-  result.Append(fbs);
+  std::string model(reinterpret_cast<const char*>(builder_.GetBufferPointer()),
+                    builder_.GetSize());
+  if (!use_buffer_offset_) return absl::Cord(std::move(model));
 
-  // Return serialized string for the built FlatBuffer.
-  if (use_buffer_offset_) {
-    // Pad to be 16 bytes aligned
-    {
-      std::string pad(kFbAlignment - result.size() % kFbAlignment, '\0');
-      result.Append(std::move(pad));
-    }
-    AppendBufferData(result);
-    std::string result_str = std::string(std::move(result));
-    auto mutable_model = tflite::GetMutableModel(result_str.data());
-    bool ret = UpdateBufferOffsets(mutable_model);
-    if (!ret) {
-      return std::nullopt;
-    }
-    return result_str;
+  // Pad to be 16 bytes aligned
+  model.append(kFbAlignment - model.size() % kFbAlignment, '\0');
+  // The buffers are kept apart from the model so that only the model itself
+  // is copied to update the offsets; the buffers keep referencing the module.
+  absl::Cord buffer_data;
+  AppendBufferData(model.size(), buffer_data);
+  if (!UpdateBufferOffsets(tflite::GetMutableModel(model.data()))) {
+    return std::nullopt;
   }
-  return std::string(result);
+  absl::Cord result(std::move(model));
+  result.Append(std::move(buffer_data));
+  return result;
 }
 
-void Translator::AppendBufferData(absl::Cord& result) {
+void Translator::AppendBufferData(uint64_t base_offset, absl::Cord& result) {
   std::unordered_map<uint64_t, std::pair<int64_t, int64_t>> hashcode_to_pos;
   // Buffer data should be exported only once.
   assert(!buffer_data_exported_);
+  // Pads `result` to an `alignment` aligned offset in the model.
+  auto pad_to = [&](uint64_t alignment) {
+    std::string pad(alignment - (base_offset + result.size()) % alignment,
+                    '\0');
+    result.Append(std::move(pad));
+  };
 
   auto it = buffer_data_map_.begin();
   while (it != buffer_data_map_.end()) {
-    std::string buffer = it->second;
+    absl::Cord buffer = std::move(it->second);
     int64_t index = it->first;
-    int64_t offset = result.size();
+    int64_t offset = base_offset + result.size();
     int64_t size = buffer.size();
-    uint64_t hash = tsl::Fingerprint64(buffer);
+    uint64_t hash = tsl::Fingerprint64(buffer.Flatten());
     if (hashcode_to_pos.find(hash) == hashcode_to_pos.end()) {
       hashcode_to_pos[hash] = std::make_pair(offset, size);
       buffer_idx_map_[index] = std::make_pair(offset, size);
       result.Append(std::move(buffer));
       // Pad to be 16 bytes aligned.
-      {
-        std::string pad(kFbAlignment - result.size() % kFbAlignment, '\0');
-        result.Append(std::move(pad));
-      }
+      pad_to(kFbAlignment);
     } else {
       // only update offset/index.
       buffer_idx_map_[index] = hashcode_to_pos[hash];
@@ -3644,34 +3668,21 @@ void Translator::AppendBufferData(absl::Cord& result) {
   // pad 16 bytes for the last buffer for XNNPack
   result.Append("\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0");
   // pad to be 16 bytes aligned
-  {
-    std::string pad(kFbAlignment - result.size() % kFbAlignment, '\0');
-    result.Append(std::move(pad));
-  }
+  pad_to(kFbAlignment);
 
   for (auto& it : custom_op_data_map_) {
-    {
-      std::string pad(kFbAlignment - result.size() % kFbAlignment, '\0');
-      result.Append(std::move(pad));
-    }
+    pad_to(kFbAlignment);
     if (custom_option_alignment_.has_value()) {
-      {
-        auto alignment = custom_option_alignment_.value();
-        std::string pad(alignment - result.size() % alignment, '\0');
-        result.Append(std::move(pad));
-      }
+      pad_to(custom_option_alignment_.value());
     }
     auto buffer = std::string(it.second.begin(), it.second.end());
-    int64_t offset = result.size();
+    int64_t offset = base_offset + result.size();
     int64_t size = it.second.size();
     custom_op_idx_map_[it.first] = std::make_pair(offset, size);
     result.Append(std::move(buffer));
   }
   // pad to be 16 bytes aligned
-  {
-    std::string pad(kFbAlignment - result.size() % kFbAlignment, '\0');
-    result.Append(std::move(pad));
-  }
+  pad_to(kFbAlignment);
 }
 
 bool Translator::UpdateBufferOffsets(tflite::Model* mutable_model) {
@@ -3881,7 +3892,22 @@ bool MlirToFlatBufferTranslateFunction(mlir::ModuleOp module,
       options.op_or_arg_name_mapper, options.metadata, serialize_stablehlo_ops,
       options.custom_option_alignment);
   if (!maybe_translated) return false;
-  *serialized_flatbuffer = std::move(*maybe_translated);
+  *serialized_flatbuffer = std::string(std::move(*maybe_translated));
+  return true;
+}
+
+bool MlirToFlatBufferTranslateFunction(mlir::ModuleOp module,
+                                       const FlatbufferExportOptions& options,
+                                       llvm::raw_ostream& output,
+                                       bool serialize_stablehlo_ops) {
+  auto maybe_translated = Translator::Translate(
+      module, options.toco_flags, options.saved_model_tags,
+      options.op_or_arg_name_mapper, options.metadata, serialize_stablehlo_ops,
+      options.custom_option_alignment);
+  if (!maybe_translated) return false;
+  for (absl::string_view chunk : maybe_translated->Chunks()) {
+    output.write(chunk.data(), chunk.size());
+  }
   return true;
 }
 
@@ -23,6 +23,7 @@ limitations under the License.
 #include <unordered_set>
 
 #include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
+#include "llvm/Support/raw_ostream.h"  // from @llvm-project
 #include "mlir/IR/BuiltinOps.h"  // from @llvm-project
 #include "tensorflow/compiler/mlir/op_or_arg_name_mapper.h"
 #include "tensorflow/lite/toco/toco_flags.pb.h"
@@ -57,6 +58,16 @@ bool MlirToFlatBufferTranslateFunction(mlir::ModuleOp module,
                                        const FlatbufferExportOptions& options,
                                        std::string* serialized_flatbuffer,
                                        bool serialize_stablehlo_ops = false);
+
+// Same as above, but writes the flatbuffer to `output`. With
+// `toco_flags.use_buffer_offset`, the constant buffers are written straight
+// from the module at 16-byte aligned offsets instead of first being copied
+// into a serialized string, so the model can be converted with little more
+// memory than the module itself and the weights can be mmapped when loaded.
+bool MlirToFlatBufferTranslateFunction(mlir::ModuleOp module,
+                                       const FlatbufferExportOptions& options,
+                                       llvm::raw_ostream& output,
+                                       bool serialize_stablehlo_ops = false);
 }  // namespace tflite
 
 #endif  // TENSORFLOW_COMPILER_MLIR_LITE_FLATBUFFER_EXPORT_H_
@@ -185,7 +185,6 @@ static OwningOpRef<mlir::ModuleOp> FlatBufferFileToMlirTrans(
 
 static LogicalResult MlirToFlatBufferFileTranslateFunction(
     ModuleOp module, llvm::raw_ostream& output) {
-  std::string serialized_flatbuffer;
   std::unique_ptr<tensorflow::OpOrArgNameMapper> op_or_arg_name_mapper;
   if (strip_debug_info) {
     op_or_arg_name_mapper =
@@ -200,11 +199,10 @@ static LogicalResult MlirToFlatBufferFileTranslateFunction(
   options.toco_flags.set_allow_custom_ops(emit_custom_ops);
   options.toco_flags.set_use_buffer_offset(use_buffer_offset);
   options.op_or_arg_name_mapper = op_or_arg_name_mapper.get();
-  if (!tflite::MlirToFlatBufferTranslateFunction(
-          module, options, &serialized_flatbuffer, emit_stablehlo_ops))
+  if (!tflite::MlirToFlatBufferTranslateFunction(module, options, output,
+                                                 emit_stablehlo_ops))
     return mlir::failure();
 
-  output << serialized_flatbuffer;
   return success();
 }
 }  // namespace
@@ -496,7 +496,10 @@ void AddPostVariableFreezingTFToTFLConversionPasses(
                    .RunAndRewriteDynamicRangeQuantizationPasses()) {
       AddDynamicRangeQuantizationPasses(pass_config, *pass_manager);
     }
-    pass_manager->addPass(mlir::createCanonicalizerPass());
+    // Only function bodies are left to canonicalize at this point, so run it
+    // as a function pass for the functions to be processed in parallel.
+    pass_manager->addNestedPass<mlir::func::FuncOp>(
+        mlir::createCanonicalizerPass());
 
     if (pass_config.reduce_type_precision ||
         toco_flags.reduce_type_precision()) {
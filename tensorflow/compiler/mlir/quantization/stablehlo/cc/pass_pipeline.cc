@@ -95,6 +95,9 @@ void AddWeightOnlyQuantizationPasses(
                                          debugger_config.log_dir_path()));
   }
   AddShapeLegalizationPasses(pm);
+  // Blockwise weights are quantized here since they cannot be represented by
+  // quantized types in the composite functions.
+  pm.addPass(createQuantizeWeightBlockwisePass());
   QuantizeCompositeFunctionsPassOptions options;
   // For debugging purposes.
   options.mlir_dump_file_name_ = "quantize_composite_functions";
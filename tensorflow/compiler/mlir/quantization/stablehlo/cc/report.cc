@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/compiler/mlir/quantization/stablehlo/cc/report.h"
 
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <utility>
@@ -21,10 +22,17 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/raw_ostream.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
+#include "mlir/Dialect/Quant/QuantTypes.h"  // from @llvm-project
 #include "mlir/IR/BuiltinAttributes.h"  // from @llvm-project
 #include "mlir/IR/BuiltinOps.h"  // from @llvm-project
+#include "mlir/IR/BuiltinTypes.h"  // from @llvm-project
+#include "mlir/IR/OpDefinition.h"  // from @llvm-project
+#include "mlir/IR/Value.h"  // from @llvm-project
 #include "mlir/IR/Visitors.h"  // from @llvm-project
 #include "mlir/Support/LLVM.h"  // from @llvm-project
 #include "tensorflow/compiler/mlir/quantization/common/lift_as_function_call.h"
@@ -39,6 +47,7 @@ namespace {
 using ::stablehlo::quantization::Method;
 using ::stablehlo::quantization::QuantizationResult;
 using ::stablehlo::quantization::QuantizationResults;
+using ::stablehlo::quantization::WeightSizes;
 using ::stablehlo::quantization::io::WriteStringToFile;
 using ::tsl::protobuf::TextFormat;
 
@@ -50,6 +59,63 @@ std::string GetCompositeFunctionName(const StringRef quantized_func_name) {
       .str();
 }
 
+// Maximum number of ops computing a weight from constants, e.g. the constants,
+// convert, multiply and reshape dequantizing blockwise quantized weights.
+constexpr int kMaxWeightOps = 8;
+
+// Returns the size in bytes of a value of `type`. Quantized elements are
+// counted at their expressed width if `expressed` is true, and at their
+// storage width otherwise.
+std::optional<int64_t> GetSizeInBytes(const Type type, const bool expressed) {
+  const auto tensor_type = mlir::dyn_cast<RankedTensorType>(type);
+  if (!tensor_type || !tensor_type.hasStaticShape()) return std::nullopt;
+  Type element_type = tensor_type.getElementType();
+  if (auto quantized_type =
+          mlir::dyn_cast<quant::QuantizedType>(element_type)) {
+    element_type = expressed ? quantized_type.getExpressedType()
+                             : quantized_type.getStorageType();
+  }
+  if (!element_type.isIntOrFloat()) return std::nullopt;
+  return (tensor_type.getNumElements() * element_type.getIntOrFloatBitWidth() +
+          7) /
+         8;
+}
+
+// Returns the sizes of `weight` if it is only computed from a few constants.
+// The quantized size is the sum of the sizes of those constants.
+std::optional<WeightSizes> GetWeightSizes(const Value weight) {
+  const std::optional<int64_t> float_bytes =
+      GetSizeInBytes(weight.getType(), /*expressed=*/true);
+  if (!float_bytes.has_value()) return std::nullopt;
+
+  int64_t quantized_bytes = 0;
+  SmallVector<Value> values = {weight};
+  llvm::DenseSet<Operation*> visited_ops;
+  while (!values.empty()) {
+    Operation* op = values.pop_back_val().getDefiningOp();
+    // Weights computed from arguments are not constant.
+    if (op == nullptr) return std::nullopt;
+    if (!visited_ops.insert(op).second) continue;
+    if (visited_ops.size() > kMaxWeightOps) return std::nullopt;
+
+    if (op->hasTrait<OpTrait::ConstantLike>()) {
+      const std::optional<int64_t> constant_bytes =
+          GetSizeInBytes(op->getResult(0).getType(), /*expressed=*/false);
+      if (!constant_bytes.has_value()) return std::nullopt;
+      quantized_bytes += *constant_bytes;
+    } else if (op->getNumOperands() == 0) {
+      return std::nullopt;
+    } else {
+      llvm::append_range(values, op->getOperands());
+    }
+  }
+
+  WeightSizes weight_sizes{};
+  weight_sizes.set_float_bytes(*float_bytes);
+  weight_sizes.set_quantized_bytes(quantized_bytes);
+  return weight_sizes;
+}
+
 // Retrieves `QuantizationResult` from `call_op`. If the callee's name starts
 // with `kQuantizedFuncPrefix` then a `QuantizationResult` will be returned with
 // its `name` field set to the callee's name reverted back to the lifted
@@ -73,6 +139,14 @@ std::optional<QuantizationResult> GetQuantizationResult(func::CallOp call_op) {
   result.mutable_quantizable_unit()->set_name(
       GetCompositeFunctionName(callee_name));
   *result.mutable_method() = std::move(*method);
+  // The weight is the second operand of the quantizable units.
+  if (call_op.getNumOperands() > 1) {
+    if (std::optional<WeightSizes> weight_sizes =
+            GetWeightSizes(call_op.getOperand(1));
+        weight_sizes.has_value()) {
+      *result.mutable_weight_sizes() = *std::move(weight_sizes);
+    }
+  }
   return result;
 }
 
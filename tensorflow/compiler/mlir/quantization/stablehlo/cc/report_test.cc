@@ -258,6 +258,42 @@ TEST_F(QuantizationReportTest,
   EXPECT_TRUE(non_quantized_result.method().has_no_quantization());
 }
 
+TEST_F(QuantizationReportTest, InitializeWithModuleOpWithBlockwiseWeight) {
+  constexpr absl::string_view kBlockwiseQuantizedDotGeneral = R"mlir(
+    func.func @main(%arg0: tensor<1x4xf32>) -> tensor<1x2xf32> {
+      %0 = stablehlo.constant dense<1> : tensor<2x2x2xi4>
+      %1 = stablehlo.constant dense<1.000000e+0> : tensor<2x1x2xf32>
+      %2 = stablehlo.convert %0 : (tensor<2x2x2xi4>) -> tensor<2x2x2xf32>
+      %3 = stablehlo.broadcast_in_dim %1, dims = [0, 1, 2] : (tensor<2x1x2xf32>) -> tensor<2x2x2xf32>
+      %4 = stablehlo.multiply %2, %3 : tensor<2x2x2xf32>
+      %5 = stablehlo.reshape %4 : (tensor<2x2x2xf32>) -> tensor<4x2xf32>
+      %6 = call @quantized_dot_general_fn(%arg0, %5) {_quantization_method = "weight_only_ptq { blockwise { block_size: 2 num_bits: 4 } }"} : (tensor<1x4xf32>, tensor<4x2xf32>) -> tensor<1x2xf32>
+      return %6 : tensor<1x2xf32>
+    }
+
+    func.func private @quantized_dot_general_fn(%arg0: tensor<1x4xf32>, %arg1: tensor<4x2xf32>) -> tensor<1x2xf32> {
+      %0 = stablehlo.dot_general %arg0, %arg1, contracting_dims = [1] x [0] : (tensor<1x4xf32>, tensor<4x2xf32>) -> tensor<1x2xf32>
+      return %0 : tensor<1x2xf32>
+    }
+  )mlir";
+
+  const OwningOpRef<ModuleOp> module_op =
+      ParseModuleOpString(kBlockwiseQuantizedDotGeneral);
+  ASSERT_TRUE(module_op);
+
+  const QuantizationReport report(*module_op);
+  const QuantizationResults& results = report.GetQuantizationResults();
+  ASSERT_THAT(results.results(), SizeIs(1));
+
+  const QuantizationResult& result = results.results(0);
+  EXPECT_THAT(result.quantizable_unit().name(),
+              StrEq("composite_dot_general_fn"));
+  EXPECT_EQ(result.method().weight_only_ptq().blockwise().num_bits(), 4);
+  // 4x2 f32 weight vs. 2x2x2 i4 values and 2x1x2 f32 scales.
+  EXPECT_EQ(result.weight_sizes().float_bytes(), 32);
+  EXPECT_EQ(result.weight_sizes().quantized_bytes(), 4 + 16);
+}
+
 TEST_F(QuantizationReportTest, ToString) {
   QuantizationResult result{};
   QuantizableUnit& quantizable_unit = *result.mutable_quantizable_unit();
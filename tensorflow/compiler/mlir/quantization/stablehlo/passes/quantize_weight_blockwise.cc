@@ -0,0 +1,242 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <optional>
+
+#include "llvm/ADT/APInt.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Twine.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
+#include "mlir/IR/Builders.h"  // from @llvm-project
+#include "mlir/IR/BuiltinAttributes.h"  // from @llvm-project
+#include "mlir/IR/BuiltinOps.h"  // from @llvm-project
+#include "mlir/IR/BuiltinTypes.h"  // from @llvm-project
+#include "mlir/IR/Matchers.h"  // from @llvm-project
+#include "mlir/IR/SymbolTable.h"  // from @llvm-project
+#include "mlir/IR/Value.h"  // from @llvm-project
+#include "mlir/Pass/Pass.h"  // from @llvm-project  // IWYU pragma: keep
+#include "mlir/Support/LLVM.h"  // from @llvm-project
+#include "mlir/Support/TypeID.h"  // from @llvm-project
+#include "stablehlo/dialect/StablehloOps.h"  // from @stablehlo
+#include "tensorflow/compiler/mlir/quantization/common/attrs_and_constraints.h"
+#include "tensorflow/compiler/mlir/quantization/common/lift_as_function_call.h"
+#include "tensorflow/compiler/mlir/quantization/stablehlo/passes/passes.h"  // IWYU pragma: keep
+#include "tensorflow/compiler/mlir/quantization/stablehlo/quantization_config.pb.h"
+#include "tensorflow/compiler/mlir/tensorflow/ir/tf_ops.h"
+
+namespace mlir::quant::stablehlo {
+
+#define GEN_PASS_DEF_QUANTIZEWEIGHTBLOCKWISEPASS
+#include "tensorflow/compiler/mlir/quantization/stablehlo/passes/passes.h.inc"
+
+namespace {
+
+using ::stablehlo::quantization::BlockwiseQuantization;
+using ::stablehlo::quantization::Method;
+
+class QuantizeWeightBlockwisePass
+    : public impl::QuantizeWeightBlockwisePassBase<
+          QuantizeWeightBlockwisePass> {
+ public:
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(QuantizeWeightBlockwisePass)
+
+  using impl::QuantizeWeightBlockwisePassBase<
+      QuantizeWeightBlockwisePass>::QuantizeWeightBlockwisePassBase;
+
+ private:
+  void runOnOperation() override;
+};
+
+// Returns the first contracting dimension of the rhs of the dot_general in
+// `func_op`, or std::nullopt if `func_op` is not a lifted dot_general.
+std::optional<int64_t> GetRhsContractingDimension(func::FuncOp func_op) {
+  if (!func_op.getName().contains("dot_general")) return std::nullopt;
+  auto dot_ops = func_op.getOps<mlir::stablehlo::DotGeneralOp>();
+  if (dot_ops.empty()) return std::nullopt;
+  ArrayRef<int64_t> rhs_contracting_dims =
+      (*dot_ops.begin()).getDotDimensionNumbers().getRhsContractingDimensions();
+  if (rhs_contracting_dims.empty()) return std::nullopt;
+  return rhs_contracting_dims.front();
+}
+
+// Replaces the weight of `op` by the dequantization of its blockwise quantized
+// values along `dimension`. Returns false if the weight cannot be quantized
+// that way.
+bool QuantizeWeight(TF::XlaCallModuleOp op, const int64_t dimension,
+                    const BlockwiseQuantization& blockwise) {
+  DenseFPElementsAttr attr;
+  if (!matchPattern(op.getOperand(1), m_Constant(&attr))) return false;
+  const auto weight_type = mlir::dyn_cast<RankedTensorType>(attr.getType());
+  if (!weight_type || !weight_type.getElementType().isF32() ||
+      !weight_type.hasStaticShape()) {
+    return false;
+  }
+
+  const ArrayRef<int64_t> shape = weight_type.getShape();
+  const int64_t block_size = blockwise.block_size();
+  if (shape[dimension] % block_size != 0) {
+    op->emitWarning() << "Contracting dimension of size " << shape[dimension]
+                      << " is not divisible by the block size " << block_size;
+    return false;
+  }
+  const int64_t num_blocks = shape[dimension] / block_size;
+  const int64_t outer_size =
+      std::accumulate(shape.begin(), shape.begin() + dimension, int64_t{1},
+                      std::multiplies<int64_t>());
+  const int64_t inner_size =
+      std::accumulate(shape.begin() + dimension + 1, shape.end(), int64_t{1},
+                      std::multiplies<int64_t>());
+
+  // Symmetric narrow range quantization, e.g. [-127, 127] for 8 bits.
+  const int num_bits = blockwise.num_bits() == 0 ? 8 : blockwise.num_bits();
+  const float max_quantized = static_cast<float>((1 << (num_bits - 1)) - 1);
+  const SmallVector<float> values(attr.getValues<float>());
+  SmallVector<APInt> quantized_values(values.size());
+  SmallVector<float> scales;
+  scales.reserve(outer_size * num_blocks * inner_size);
+  for (int64_t outer = 0; outer < outer_size; ++outer) {
+    for (int64_t block = 0; block < num_blocks; ++block) {
+      for (int64_t inner = 0; inner < inner_size; ++inner) {
+        auto index = [&](int64_t i) {
+          return ((outer * num_blocks + block) * block_size + i) * inner_size +
+                 inner;
+        };
+        float max_abs = 0.0f;
+        for (int64_t i = 0; i < block_size; ++i) {
+          max_abs = std::max(max_abs, std::abs(values[index(i)]));
+        }
+        const float scale = max_abs == 0.0f ? 1.0f : max_abs / max_quantized;
+        for (int64_t i = 0; i < block_size; ++i) {
+          const float quantized =
+              std::clamp(std::round(values[index(i)] / scale), -max_quantized,
+                         max_quantized);
+          quantized_values[index(i)] =
+              APInt(num_bits, static_cast<int64_t>(quantized),
+                    /*isSigned=*/true);
+        }
+        scales.push_back(scale);
+      }
+    }
+  }
+
+  // The blocked dimension is split into [num_blocks, block_size].
+  SmallVector<int64_t> blocked_shape(shape.begin(), shape.end());
+  blocked_shape[dimension] = num_blocks;
+  blocked_shape.insert(blocked_shape.begin() + dimension + 1, block_size);
+  SmallVector<int64_t> scale_shape(blocked_shape);
+  scale_shape[dimension + 1] = 1;
+
+  OpBuilder builder(op);
+  const Location loc = op.getLoc();
+  const Type float_type = builder.getF32Type();
+  auto quantized_weight = builder.create<mlir::stablehlo::ConstantOp>(
+      loc, DenseElementsAttr::get(
+               RankedTensorType::get(blocked_shape,
+                                     builder.getIntegerType(num_bits)),
+               quantized_values));
+  auto scale = builder.create<mlir::stablehlo::ConstantOp>(
+      loc,
+      DenseElementsAttr::get(RankedTensorType::get(scale_shape, float_type),
+                             ArrayRef<float>(scales)));
+
+  const auto blocked_float_type =
+      RankedTensorType::get(blocked_shape, float_type);
+  SmallVector<int64_t> broadcast_dimensions(blocked_shape.size());
+  std::iota(broadcast_dimensions.begin(), broadcast_dimensions.end(), 0);
+  Value dequantized = builder.create<mlir::stablehlo::MulOp>(
+      loc,
+      builder.create<mlir::stablehlo::ConvertOp>(loc, blocked_float_type,
+                                                 quantized_weight),
+      builder.create<mlir::stablehlo::BroadcastInDimOp>(
+          loc, blocked_float_type, scale,
+          builder.getDenseI64ArrayAttr(broadcast_dimensions)));
+  dequantized =
+      builder.create<mlir::stablehlo::ReshapeOp>(loc, weight_type, dequantized);
+
+  Operation* weight_op = op.getOperand(1).getDefiningOp();
+  op->setOperand(1, dequantized);
+  if (weight_op->use_empty()) weight_op->erase();
+  return true;
+}
+
+// Replaces `op` by a call to its entry function renamed with the
+// `kQuantizedFuncPrefix` prefix, so that it is not quantized again and is
+// reported as quantized.
+void ReplaceWithQuantizedCall(TF::XlaCallModuleOp op, func::FuncOp func_op,
+                              SymbolTable& symbol_table) {
+  const StringRef name = func_op.getSymName();
+  if (name.starts_with(kCompositeFuncPrefix)) {
+    symbol_table.rename(
+        func_op, (Twine(kQuantizedFuncPrefix) +
+                  name.drop_front(kCompositeFuncPrefix.size()))
+                     .str());
+  }
+
+  OpBuilder builder(op);
+  auto call_op =
+      builder.create<func::CallOp>(op.getLoc(), func_op, op.getArgs());
+  call_op->setAttr(kQuantizationMethodAttr,
+                   op->getAttr(kQuantizationMethodAttr));
+  op->replaceAllUsesWith(call_op);
+  op->erase();
+}
+
+void QuantizeWeightBlockwisePass::runOnOperation() {
+  ModuleOp module_op = getOperation();
+  SymbolTable symbol_table(module_op);
+
+  SmallVector<TF::XlaCallModuleOp> xla_call_module_ops;
+  module_op.walk(
+      [&](TF::XlaCallModuleOp op) { xla_call_module_ops.push_back(op); });
+
+  for (TF::XlaCallModuleOp op : xla_call_module_ops) {
+    if (!IsWeightOnlyQuantizableOp(*op.getOperation()) ||
+        op.getNumOperands() < 2) {
+      continue;
+    }
+    const Method method = GetQuantizationMethodOrDefault(op);
+    if (!method.weight_only_ptq().has_blockwise()) continue;
+
+    const BlockwiseQuantization& blockwise =
+        method.weight_only_ptq().blockwise();
+    if (blockwise.block_size() <= 0 ||
+        (blockwise.num_bits() != 0 && blockwise.num_bits() != 4 &&
+         blockwise.num_bits() != 8)) {
+      op->emitError() << "Invalid blockwise quantization with block size "
+                      << blockwise.block_size() << " and "
+                      << blockwise.num_bits() << " bits.";
+      return signalPassFailure();
+    }
+
+    auto func_op =
+        symbol_table.lookup<func::FuncOp>(GetEntryFunctionName(op));
+    if (!func_op) continue;
+    const std::optional<int64_t> dimension =
+        GetRhsContractingDimension(func_op);
+    if (!dimension.has_value() || !QuantizeWeight(op, *dimension, blockwise)) {
+      continue;
+    }
+    ReplaceWithQuantizedCall(op, func_op, symbol_table);
+  }
+}
+
+}  // namespace
+
+}  // namespace mlir::quant::stablehlo
@@ -0,0 +1,71 @@
+// RUN: stablehlo-quant-opt %s -split-input-file -stablehlo-quantize-weight-blockwise | FileCheck %s
+
+// Test that the weight of a dot_general is quantized with a scale per block of
+// 2 elements along the contracting dimension and dequantized before the call.
+
+module {
+  func.func @blockwise_dot_general(%arg0: tensor<1x4xf32>) -> tensor<1x2xf32> attributes {tf._original_func_name = "main_0"} {
+    %cst = "tf.Const"() {value = dense<[[1.0, 0.0], [-1.0, 4.0], [0.0, 1.0], [1.0, -1.0]]> : tensor<4x2xf32>} : () -> tensor<4x2xf32>
+    %0 = "tf.XlaCallModule"(%arg0, %cst) {
+      Sout = [#tf_type.shape<1x2>], _entry_function = @composite_dot_general_fn,
+      _original_entry_function = "composite_dot_general_fn",
+      _quantization_method = "weight_only_ptq { blockwise { block_size: 2 } }",
+      _stablehlo_module_attrs = {}, device = "", dim_args_spec = [],
+      disabled_checks = [], has_token_input_output = false, module = "",
+      platforms = [], version = 5 : i64
+    } : (tensor<1x4xf32>, tensor<4x2xf32>) -> tensor<1x2xf32>
+    return %0 : tensor<1x2xf32>
+  }
+
+  func.func private @composite_dot_general_fn(%arg0: tensor<1x4xf32>, %arg1: tensor<4x2xf32>) -> tensor<1x2xf32> attributes {_from_xla_call_module} {
+    %0 = stablehlo.dot_general %arg0, %arg1, contracting_dims = [1] x [0] : (tensor<1x4xf32>, tensor<4x2xf32>) -> tensor<1x2xf32>
+    return %0 : tensor<1x2xf32>
+  }
+}
+
+// CHECK-LABEL: func.func @blockwise_dot_general
+// CHECK-SAME: (%[[ARG_0:.+]]: tensor<1x4xf32>)
+// CHECK-NOT: tf.Const
+// CHECK-DAG: %[[WEIGHT:.+]] = stablehlo.constant dense<{{\[\[\[}}127, 0], [-127, 127]], {{\[\[}}0, 127], [127, -127]]]> : tensor<2x2x2xi8>
+// CHECK-DAG: %[[SCALE:.+]] = stablehlo.constant dense<{{.*}}> : tensor<2x1x2xf32>
+// CHECK-DAG: %[[CONVERT:.+]] = stablehlo.convert %[[WEIGHT]] : (tensor<2x2x2xi8>) -> tensor<2x2x2xf32>
+// CHECK-DAG: %[[BROADCAST:.+]] = stablehlo.broadcast_in_dim %[[SCALE]], dims = [0, 1, 2] : (tensor<2x1x2xf32>) -> tensor<2x2x2xf32>
+// CHECK: %[[MUL:.+]] = stablehlo.multiply %[[CONVERT]], %[[BROADCAST]] : tensor<2x2x2xf32>
+// CHECK: %[[RESHAPE:.+]] = stablehlo.reshape %[[MUL]] : (tensor<2x2x2xf32>) -> tensor<4x2xf32>
+// CHECK: %[[CALL:.+]] = call @quantized_dot_general_fn(%[[ARG_0]], %[[RESHAPE]])
+// CHECK-SAME: _quantization_method = "weight_only_ptq { blockwise { block_size: 2 } }"
+// CHECK-NOT: tf.XlaCallModule
+// CHECK: return %[[CALL]]
+
+// CHECK: func.func private @quantized_dot_general_fn
+
+// -----
+
+// Test that a weight whose contracting dimension is not divisible by the block
+// size is left as is.
+
+module {
+  func.func @indivisible_block_size(%arg0: tensor<1x3xf32>) -> tensor<1x2xf32> attributes {tf._original_func_name = "main_0"} {
+    %cst = "tf.Const"() {value = dense<3.000000e-01> : tensor<3x2xf32>} : () -> tensor<3x2xf32>
+    %0 = "tf.XlaCallModule"(%arg0, %cst) {
+      Sout = [#tf_type.shape<1x2>], _entry_function = @composite_dot_general_fn,
+      _original_entry_function = "composite_dot_general_fn",
+      _quantization_method = "weight_only_ptq { blockwise { block_size: 2 num_bits: 4 } }",
+      _stablehlo_module_attrs = {}, device = "", dim_args_spec = [],
+      disabled_checks = [], has_token_input_output = false, module = "",
+      platforms = [], version = 5 : i64
+    } : (tensor<1x3xf32>, tensor<3x2xf32>) -> tensor<1x2xf32>
+    return %0 : tensor<1x2xf32>
+  }
+
+  func.func private @composite_dot_general_fn(%arg0: tensor<1x3xf32>, %arg1: tensor<3x2xf32>) -> tensor<1x2xf32> attributes {_from_xla_call_module} {
+    %0 = stablehlo.dot_general %arg0, %arg1, contracting_dims = [1] x [0] : (tensor<1x3xf32>, tensor<3x2xf32>) -> tensor<1x2xf32>
+    return %0 : tensor<1x2xf32>
+  }
+}
+
+// CHECK-LABEL: func.func @indivisible_block_size
+// CHECK: %[[CST:.+]] = "tf.Const"
+// CHECK: "tf.XlaCallModule"(%{{.+}}, %[[CST]])
+// CHECK-SAME: _entry_function = @composite_dot_general_fn
+// CHECK-NOT: stablehlo.convert
@@ -193,6 +193,14 @@ void EmitKernel(FunctionEmitterContext& function_context,
     arguments.push_back(id);
   }
 
+  // The registers of unused results are freed right away, so that the values
+  // are destroyed when the registers are reused instead of living until the
+  // end of the function.
+  for (auto result : op.getResults()) {
+    const auto& reg_info = function_context.register_table[result];
+    if (reg_info.num_uses == 0) function_context.FreeRegId(reg_info.id);
+  }
+
   constructor.construct_arguments(arguments.size())
       .Assign(arguments.begin(), arguments.end());
   constructor.construct_last_uses(last_uses.size())
@@ -255,6 +263,8 @@ void EmitFunction(const ModuleEmitterContext& module_context,
     register_table[arg] = {static_cast<int>(std::distance(arg.getUses().begin(),
                                                           arg.getUses().end())),
                            id};
+    // Same as for unused results, unused arguments don't hold their register.
+    if (arg.use_empty()) function_context.FreeRegId(id);
   }
   constructor.construct_input_regs(input_regs);
 
@@ -0,0 +1,6 @@
+func.func @unused_values(%c0: i32, %unused: i32) -> i32 {
+  %c1, %c2 = "test_mlbc.add_sub.i32"(%c0, %c0) : (i32, i32) -> (i32, i32)
+  %c3 = "test_mlbc.add.i32"(%c1, %c1) : (i32, i32) -> i32
+  %c4 = "test_mlbc.add.i32"(%c3, %c3) : (i32, i32) -> i32
+  func.return %c4 : i32
+}
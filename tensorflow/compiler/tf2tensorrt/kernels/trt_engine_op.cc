@@ -40,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/clusters/utils.h"
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
@@ -178,6 +179,13 @@ class TRTEngineOp : public AsyncOpKernel {
   Status GetEngineCacheResource(OpKernelContext* ctx,
                                 TRTEngineCacheResource** cache_res);
 
+  // Writes the engines of `cache_res` to engine_cache_filename_, if set, so
+  // that the engines built at runtime are loaded by the next process instead
+  // of being rebuilt.
+  void MaybeSaveEngines(OpKernelContext* ctx,
+                        const TRTEngineCacheResource* cache_res)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(engine_mutex_);
+
   // Returns a pair of 1) An EngineContext object that is compatible with the
   // input and 2) The index of the IExecutionContext compatible with the input.
   // If a cuda engine for the given input shapes can't be found, returns
@@ -244,6 +252,15 @@ class TRTEngineOp : public AsyncOpKernel {
   // Maximum number of cached engines.
   int max_cached_engines_;
 
+  // Name of the engine cache resource, shared by all the instantiations of
+  // this op.
+  string resource_name_;
+
+  // File the engine cache is loaded from when it is created and saved to
+  // when an engine is built, set from the TF_TRT_ENGINE_CACHE_DIR environment
+  // variable. Empty if the engine cache is not persisted.
+  string engine_cache_filename_;
+
   // Flag to detect whether native segment nodes have been deleted from graph
   bool native_segment_absent_;
 
@@ -441,6 +458,27 @@ TRTEngineOp::TRTEngineOp(OpKernelConstruction* context)
     OP_REQUIRES_OK(context, status);
   }
 
+  // Canonicalize the op name by removing the scopes if any. This is mainly
+  // because in TFv2, the function graph can be instantiated in various ways and
+  // it'll insert scope names to the name of the TRTEngineOps, which will result
+  // in many different engine caches if we use the instantiated op name
+  // directly, but we still want all of them share the same cache (if they were
+  // representing the same subgraph).
+  absl::string_view resource_name = name();
+  size_t last_slash = resource_name.find_last_of('/');
+  if (last_slash != absl::string_view::npos) {
+    resource_name.remove_prefix(last_slash + 1);
+  }
+  resource_name_ = string(resource_name);
+
+  string engine_cache_dir;
+  OP_REQUIRES_OK(context, ReadStringFromEnvVar("TF_TRT_ENGINE_CACHE_DIR",
+                                               /*default_val=*/"",
+                                               &engine_cache_dir));
+  if (!engine_cache_dir.empty()) {
+    engine_cache_filename_ = io::JoinPath(engine_cache_dir, resource_name_);
+  }
+
   // Get a mask of non-resource inputs.
   std::vector<DataType> in_types;
   input_mask_.resize(input_partial_shapes_.size());
@@ -1063,27 +1101,60 @@ Status TRTEngineOp::GetEngineCacheResource(OpKernelContext* ctx,
   tensorflow::profiler::TraceMe activity(
       "TRTEngineOp::GetEngineCachResource",
       tensorflow::profiler::TraceMeLevel::kInfo);
-  // Canonicalize the op name by removing the scopes if any. This is mainly
-  // because in TFv2, the function graph can be instantiated in various ways and
-  // it'll insert scope names to the name of the TRTEngineOps, which will result
-  // in many different engine caches if we use the instantiated op name
-  // directly, but we still want all of them share the same cache (if they were
-  // representing the same subgraph).
-  absl::string_view resource_name = name();
-  size_t last_slash = resource_name.find_last_of('/');
-  if (last_slash != absl::string_view::npos) {
-    resource_name.remove_prefix(last_slash + 1);
-  }
-
   // Get engine cache.
   return ctx->resource_manager()->LookupOrCreate(
-      std::string(kTfTrtContainerName), std::string(resource_name), cache_res,
+      std::string(kTfTrtContainerName), resource_name_, cache_res,
       {[this, ctx](TRTEngineCacheResource** cr) -> Status {
         *cr = new TRTEngineCacheResource(ctx, this->max_cached_engines_);
+        // Calibration and profile generation need an empty cache to run, so
+        // the engines persisted by a previous run are only loaded at
+        // inference.
+        if (engine_cache_filename_.empty() || calibration_mode_ ||
+            profile_generation_mode_ ||
+            !ctx->env()->FileExists(engine_cache_filename_).ok()) {
+          return OkStatus();
+        }
+        int num_loaded_engines = 0;
+        Status status = (*cr)->LoadEngines(ctx->env(), engine_cache_filename_,
+                                           &num_loaded_engines);
+        if (!status.ok()) {
+          // The engines are rebuilt as if the file did not exist.
+          LOG(WARNING) << "Failed to load TRT engines for " << name()
+                       << " from " << engine_cache_filename_ << ": " << status;
+          (*cr)->Unref();
+          *cr = new TRTEngineCacheResource(ctx, this->max_cached_engines_);
+          return OkStatus();
+        }
+        VLOG(1) << "Loaded " << num_loaded_engines << " TRT engines for "
+                << name() << " from " << engine_cache_filename_;
         return OkStatus();
       }});
 }
 
+void TRTEngineOp::MaybeSaveEngines(OpKernelContext* ctx,
+                                   const TRTEngineCacheResource* cache_res) {
+  if (engine_cache_filename_.empty()) return;
+  tensorflow::profiler::TraceMe activity(
+      "TRTEngineOp::MaybeSaveEngines",
+      tensorflow::profiler::TraceMeLevel::kInfo);
+  int num_saved_engines = 0;
+  Status status = ctx->env()->RecursivelyCreateDir(
+      string(io::Dirname(engine_cache_filename_)));
+  if (status.ok()) {
+    status = cache_res->SaveEngines(ctx->env(), engine_cache_filename_,
+                                    &num_saved_engines);
+  }
+  if (!status.ok()) {
+    LOG_FIRST_FEW_WARNING_WITH_PREFIX << "Failed to save TRT engines for "
+                                      << name() << " to "
+                                      << engine_cache_filename_ << ": "
+                                      << status;
+    return;
+  }
+  VLOG(1) << "Saved " << num_saved_engines << " TRT engines for " << name()
+          << " to " << engine_cache_filename_;
+}
+
 StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
     const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
     bool use_calibration, TRTInt8Calibrator* calibrator,
@@ -1202,6 +1273,7 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
       return std::pair<EngineContext*, int>(engine_context, profile_id);
     }
 
+    bool built_at_runtime = false;
     if (!static_engine) {
       if (!allow_build_at_runtime_) {
         // Store an empty engine in the cache so we don't try to load the same
@@ -1225,6 +1297,7 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
         return std::pair<EngineContext*, int>(&empty_context, 0);
       }
       static_engine = std::move(result.value());
+      built_at_runtime = true;
     }
 
     auto raw_static_engine = static_engine.get();
@@ -1246,6 +1319,7 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
     cache.emplace(engine_input_shapes,
                   std::make_unique<EngineContext>(std::move(static_engine),
                                                   std::move(context)));
+    if (built_at_runtime) MaybeSaveEngines(ctx, cache_res);
     // Runtime is safe to delete after engine creation
     VLOG(1) << "Size of serialized TRT engine: "
             << serialized_segment_.capacity();
@@ -1307,6 +1381,7 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
                                                   std::move(exec_contexts)));
     VLOG(1) << "Added new engine to cache of " << name()
             << ". Cache size: " << cache.size();
+    MaybeSaveEngines(ctx, cache_res);
     engine_contexts = cache.at(input_concrete_shapes).get();
     // Query which profile of the new engine matches the actual input.
     profile_id = cache_res->profiles_.GetProfileNumber(input_concrete_shapes);
@@ -27,7 +27,6 @@ limitations under the License.
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/refcount.h"
-#include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -39,7 +38,6 @@ limitations under the License.
 
 namespace tensorflow {
 namespace tensorrt {
-using ::nvinfer1::IRuntime;
 
 class CreateTRTResourceHandle : public OpKernel {
  public:
@@ -107,67 +105,15 @@ class InitializeTRTResource : public OpKernel {
                    return OkStatus();
                  }));
 
-    auto allocator = resource->allocator_.get();
-    OP_REQUIRES(ctx, allocator != nullptr,
-                errors::Internal("Not able to initialize TRT engine cache when "
-                                 "GPU allocator is empty."));
-    OP_REQUIRES(ctx, resource->cache_.size() == 0,
-                errors::Internal("Expect engine cache to be empty, but got ",
-                                 resource->cache_.size(), " entries."));
-
     // Get the file name.
     const string& filename = ctx->input(1).scalar<tstring>()();
     OP_REQUIRES(ctx, !filename.empty(),
                 errors::InvalidArgument("filename cannot be empty."));
 
     // Parse the serialized engines and add them to the cache.
-    std::unique_ptr<RandomAccessFile> file;
-    OP_REQUIRES_OK(ctx, ctx->env()->NewRandomAccessFile(filename, &file));
-    auto reader = std::make_unique<io::RecordReader>(file.get());
-
-    uint64 offset = 0;
     int num_loaded_engine = 0;
-    do {
-      tstring record;
-      Status status = reader->ReadRecord(&offset, &record);
-      if (errors::IsOutOfRange(status)) break;
-
-      TRTEngineInstance engine_instance;
-      engine_instance.ParseFromString(record);
-      std::vector<TensorShape> engine_input_shapes;
-      const auto& input_shapes = engine_instance.input_shapes();
-      engine_input_shapes.reserve(input_shapes.size());
-      for (const TensorShapeProto& shape : input_shapes) {
-        engine_input_shapes.emplace_back(shape);
-      }
-
-      TrtUniquePtrType<IRuntime> infer(
-          nvinfer1::createInferRuntime(TRTEngineCacheResource::GetLogger()));
-      infer->setGpuAllocator(allocator);
-      TrtUniquePtrType<nvinfer1::ICudaEngine> engine(
-          infer->deserializeCudaEngine(
-              engine_instance.serialized_engine().c_str(),
-              engine_instance.serialized_engine().size(), nullptr));
-      auto raw_engine = engine.get();
-      std::vector<ExecutionContext> ctx_vec;
-      if (num_loaded_engine == 0) {
-        // Restore profiles if there are any. Currently only 1 engine is allowed
-        // in dynamic mode therefore we call this only for the 0th engine.
-        // it is a no-op in implicit batch mode.
-        OP_REQUIRES_OK(ctx, resource->profiles_.RestoreProfiles(
-                                raw_engine, engine_input_shapes.size()));
-        OP_REQUIRES_OK(ctx, resource->profiles_.CreateExecutionContexts(
-                                raw_engine, &ctx_vec));
-      } else {
-        // Multiple engines are only available in static mode. For each engine
-        // we have only a single execution context.
-        ctx_vec.push_back(ExecutionContext::Create(raw_engine));
-      }
-      resource->cache_.emplace(engine_input_shapes,
-                               std::make_unique<EngineContext>(
-                                   std::move(engine), std::move(ctx_vec)));
-      ++num_loaded_engine;
-    } while (1);
+    OP_REQUIRES_OK(ctx, resource->LoadEngines(ctx->env(), filename,
+                                              &num_loaded_engine));
     VLOG(1) << "Loaded " << num_loaded_engine << " TRT engines for op "
             << handle.name() << " on device " << ctx->device()->name()
             << " from file " << filename;
@@ -240,16 +186,8 @@ class SerializeTRTResource : public OpKernel {
         if (!engine || !engine->GetCudaEngine()) continue;
 
         TRTEngineInstance engine_instance;
-        // Add input shapes.
-        const std::vector<TensorShape>& engine_input_shapes = pair.first;
-        for (const TensorShape& shape : engine_input_shapes) {
-          shape.AsProto(engine_instance.add_input_shapes());
-        }
-        // Add the serialized engine.
-        TrtUniquePtrType<nvinfer1::IHostMemory> engine_data(
-            engine->GetCudaEngine()->serialize());
-        engine_instance.set_serialized_engine(engine_data->data(),
-                                              engine_data->size());
+        resource->SerializeEngine(pair.first, engine.get(), &engine_instance);
+        const string& engine_data = engine_instance.serialized_engine();
 
         if (export_trt_engines_env) {
           const std::string engine_filename =
@@ -257,9 +195,7 @@ class SerializeTRTResource : public OpKernel {
           std::unique_ptr<WritableFile> engine_file;
           OP_REQUIRES_OK(
               ctx, ctx->env()->NewWritableFile(engine_filename, &engine_file));
-          OP_REQUIRES_OK(ctx, engine_file->Append(StringPiece(
-                                  static_cast<char*>(engine_data->data()),
-                                  engine_data->size())));
+          OP_REQUIRES_OK(ctx, engine_file->Append(engine_data));
 
           const std::string dims_filename =
               std::string(export_trt_engines_env) + "/dims-" + resource_name;
@@ -267,7 +203,7 @@ class SerializeTRTResource : public OpKernel {
           OP_REQUIRES_OK(
               ctx, ctx->env()->NewWritableFile(dims_filename, &dims_file));
 
-          for (const TensorShape& shape : engine_input_shapes) {
+          for (const TensorShape& shape : pair.first) {
             OP_REQUIRES_OK(ctx,
                            dims_file->Append(StringPiece(shape.DebugString())));
           }
@@ -17,13 +17,19 @@ limitations under the License.
 
 #include <sstream>
 
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "tensorflow/compiler/tf2tensorrt/common/utils.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_allocator.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/mutex.h"
 
 #if GOOGLE_CUDA && GOOGLE_TENSORRT
+#include "third_party/gpus/cuda/include/cuda_runtime_api.h"
 #include "third_party/tensorrt/NvInfer.h"
 
 namespace tensorflow {
@@ -68,6 +74,18 @@ TRTEngineCacheResource::TRTEngineCacheResource(OpKernelContext* ctx,
   } else {
     allocator_.reset(new TRTDeviceAllocator(alloc));
   }
+
+  const DeviceBase::AcceleratorDeviceInfo* device_info =
+      device->tensorflow_accelerator_device_info();
+  cudaDeviceProp device_properties;
+  if (device_info != nullptr &&
+      cudaGetDeviceProperties(&device_properties, device_info->gpu_id) ==
+          cudaSuccess) {
+    gpu_model_ = device_properties.name;
+  } else {
+    LOG(WARNING) << "Can't get the GPU model of device " << device->name()
+                 << ", serialized engines won't be checked against it.";
+  }
 }
 
 TRTEngineCacheResource::~TRTEngineCacheResource() {
@@ -119,6 +137,125 @@ EngineContext* TRTEngineCacheResource::GetEngineContext(
   return engine_context;
 }
 
+void TRTEngineCacheResource::SerializeEngine(
+    const std::vector<TensorShape>& input_shapes,
+    EngineContext* engine_context, TRTEngineInstance* engine_instance) const {
+  for (const TensorShape& shape : input_shapes) {
+    shape.AsProto(engine_instance->add_input_shapes());
+  }
+  TrtUniquePtrType<nvinfer1::IHostMemory> engine_data(
+      engine_context->GetCudaEngine()->serialize());
+  engine_instance->set_serialized_engine(engine_data->data(),
+                                         engine_data->size());
+  engine_instance->set_gpu_model(gpu_model_);
+  engine_instance->set_tensorrt_version(
+      absl::StrJoin(GetLoadedTensorRTVersion(), "."));
+}
+
+Status TRTEngineCacheResource::LoadEngines(Env* env, const string& filename,
+                                           int* num_loaded_engines) {
+  if (allocator_ == nullptr) {
+    return errors::Internal(
+        "Not able to initialize TRT engine cache when GPU allocator is empty.");
+  }
+  if (cache_.size() != 0) {
+    return errors::Internal("Expect engine cache to be empty, but got ",
+                            cache_.size(), " entries.");
+  }
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  auto reader = std::make_unique<io::RecordReader>(file.get());
+  const string tensorrt_version =
+      absl::StrJoin(GetLoadedTensorRTVersion(), ".");
+
+  uint64 offset = 0;
+  *num_loaded_engines = 0;
+  do {
+    tstring record;
+    Status status = reader->ReadRecord(&offset, &record);
+    if (errors::IsOutOfRange(status)) break;
+    TF_RETURN_IF_ERROR(status);
+
+    TRTEngineInstance engine_instance;
+    engine_instance.ParseFromString(record);
+    // Deserializing an engine built for another GPU model or TensorRT version
+    // fails or, worse, yields an engine that crashes at execution.
+    if ((!engine_instance.gpu_model().empty() && !gpu_model_.empty() &&
+         engine_instance.gpu_model() != gpu_model_) ||
+        (!engine_instance.tensorrt_version().empty() &&
+         engine_instance.tensorrt_version() != tensorrt_version)) {
+      LOG(WARNING) << "Skipping TRT engine of " << filename << " built for "
+                   << engine_instance.gpu_model() << " with TensorRT "
+                   << engine_instance.tensorrt_version() << ", running on "
+                   << gpu_model_ << " with TensorRT " << tensorrt_version;
+      continue;
+    }
+    std::vector<TensorShape> engine_input_shapes;
+    const auto& input_shapes = engine_instance.input_shapes();
+    engine_input_shapes.reserve(input_shapes.size());
+    for (const TensorShapeProto& shape : input_shapes) {
+      engine_input_shapes.emplace_back(shape);
+    }
+
+    TrtUniquePtrType<nvinfer1::IRuntime> infer(
+        nvinfer1::createInferRuntime(GetLogger()));
+    infer->setGpuAllocator(allocator_.get());
+    TrtUniquePtrType<nvinfer1::ICudaEngine> engine(
+        infer->deserializeCudaEngine(
+            engine_instance.serialized_engine().c_str(),
+            engine_instance.serialized_engine().size(), nullptr));
+    if (!engine) {
+      return errors::Internal("Failed to deserialize TRT engine from ",
+                              filename);
+    }
+    auto raw_engine = engine.get();
+    std::vector<ExecutionContext> ctx_vec;
+    if (*num_loaded_engines == 0) {
+      // Restore profiles if there are any. Currently only 1 engine is allowed
+      // in dynamic mode therefore we call this only for the 0th engine.
+      // it is a no-op in implicit batch mode.
+      TF_RETURN_IF_ERROR(
+          profiles_.RestoreProfiles(raw_engine, engine_input_shapes.size()));
+      TF_RETURN_IF_ERROR(
+          profiles_.CreateExecutionContexts(raw_engine, &ctx_vec));
+    } else {
+      // Multiple engines are only available in static mode. For each engine
+      // we have only a single execution context.
+      ctx_vec.push_back(ExecutionContext::Create(raw_engine));
+    }
+    cache_.emplace(engine_input_shapes,
+                   std::make_unique<EngineContext>(std::move(engine),
+                                                   std::move(ctx_vec)));
+    ++*num_loaded_engines;
+  } while (1);
+  return OkStatus();
+}
+
+Status TRTEngineCacheResource::SaveEngines(Env* env, const string& filename,
+                                           int* num_saved_engines) const {
+  const string tmp_filename = absl::StrCat(filename, ".tmp");
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(tmp_filename, &file));
+  auto writer = std::make_unique<io::RecordWriter>(file.get());
+
+  *num_saved_engines = 0;
+  for (const auto& pair : cache_) {
+    // Ignore engines that failed to build.
+    const std::unique_ptr<EngineContext>& engine = pair.second;
+    if (!engine || !engine->GetCudaEngine()) continue;
+
+    TRTEngineInstance engine_instance;
+    SerializeEngine(pair.first, engine.get(), &engine_instance);
+    TF_RETURN_IF_ERROR(
+        writer->WriteRecord(engine_instance.SerializeAsString()));
+    ++*num_saved_engines;
+  }
+  TF_RETURN_IF_ERROR(writer->Close());
+  TF_RETURN_IF_ERROR(file->Close());
+  return env->RenameFile(tmp_filename, filename);
+}
+
 EngineContext* TRTEngineCacheResource::GetEngineContext(const int profile_id) {
   if (profiles_.NeedProfiles() && profile_id >= profiles_.GetNumProfiles()) {
     LOG(ERROR) << "Out of range: profile_id " << profile_id
@@ -22,12 +22,14 @@ limitations under the License.
 
 #include "tensorflow/compiler/tf2tensorrt/convert/utils.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_allocator.h"
+#include "tensorflow/compiler/tf2tensorrt/utils/trt_engine_instance.pb.h"  // NOLINT
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_engine_utils.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_int8_calibrator.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_logger.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_shape_optimization_profiles.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/env.h"
 
 #if GOOGLE_CUDA && GOOGLE_TENSORRT
 #include "third_party/tensorrt/NvInfer.h"
@@ -235,6 +237,23 @@ class TRTEngineCacheResource : public ResourceBase {
   // Returns nullptr if no compatible EngineContexts is found in cache.
   EngineContext* GetEngineContext(const int profile_id);
 
+  // Fills `engine_instance` with the serialized `engine_context` built for
+  // `input_shapes`, and the GPU model and TensorRT version it was built for.
+  void SerializeEngine(const std::vector<TensorShape>& input_shapes,
+                       EngineContext* engine_context,
+                       TRTEngineInstance* engine_instance) const;
+
+  // Adds the engines of the TRTEngineInstance records of `filename` to the
+  // cache, which must be empty. Engines recorded for another GPU model or
+  // TensorRT version are skipped.
+  Status LoadEngines(Env* env, const string& filename, int* num_loaded_engines);
+
+  // Writes the engines of the cache to `filename` as TRTEngineInstance
+  // records, ignoring the engines that failed to build. The file is replaced
+  // atomically so that a concurrent LoadEngines() never sees a partial file.
+  Status SaveEngines(Env* env, const string& filename,
+                     int* num_saved_engines) const;
+
   // Keep device allocator for TRT.
   std::unique_ptr<TRTBaseAllocator> allocator_;
 
@@ -251,6 +270,10 @@ class TRTEngineCacheResource : public ResourceBase {
   // generation and engine build. During runtime the list of profiles is used to
   // look up a matching profile for the input data.
   TrtShapeOptimizationProfile profiles_;
+
+ private:
+  // The name of the GPU model of the device owning this resource.
+  string gpu_model_;
 };
 
 #endif  // GOOGLE_CUDA && GOOGLE_TENSORRT
@@ -699,6 +699,16 @@ void CollectiveParamResolverLocal::AssignCollectiveType(CollectiveParams* cp) {
       CollectiveRegistry::LookupParamResolverInstance("NcclReduce", &col_impl)
           .ok();
   cp->instance.impl_details.collective_name = GetCollectiveName(cp, use_nccl);
+  // CPU all-reduces may instead use the topology-aware hierarchical ring if
+  // requested with `communication_hint`.
+  if (!use_nccl && cp->instance.type == REDUCTION_COLLECTIVE &&
+      cp->instance.impl_details.communication_hint == "hierarchical" &&
+      cp->group.device_type == DEVICE_CPU &&
+      CollectiveRegistry::LookupParamResolverInstance("HierarchicalRingReduce",
+                                                      &col_impl)
+          .ok()) {
+    cp->instance.impl_details.collective_name = "HierarchicalRingReduce";
+  }
   VLOG(1) << "AssignCollectiveType "
           << cp->instance.impl_details.collective_name;
 }
@@ -90,6 +90,13 @@ auto* direct_session_runs = monitoring::Counter<0>::New(
     "/tensorflow/core/direct_session_runs",
     "The number of times DirectSession::Run() has been called.");
 
+// Returns the cell of `direct_session_runs`, which is looked up only once as
+// `GetCell()` takes the lock of the metric.
+monitoring::CounterCell* DirectSessionRunsCell() {
+  static monitoring::CounterCell* cell = direct_session_runs->GetCell();
+  return cell;
+}
+
 Status NewThreadPoolFromThreadPoolOptions(
     const SessionOptions& options,
     const ThreadPoolOptionProto& thread_pool_options, int pool_number,
@@ -692,8 +699,21 @@ Status DirectSession::RunInternal(
   if (run_metadata != nullptr &&
       (do_trace || update_cost_model ||
        run_options.report_tensor_allocations_upon_oom())) {
-    run_state.collector.reset(
-        new StepStatsCollector(run_metadata->mutable_step_stats()));
+    if (do_trace && run_options.experimental().compact_step_stats() &&
+        !update_cost_model &&
+        !run_options.report_tensor_allocations_upon_oom()) {
+      // Compact mode has room for one execution of every node of the graphs.
+      size_t max_compact_nodes = 0;
+      for (const PerPartitionExecutorsAndLib& partition :
+           executors_and_keys->items) {
+        max_compact_nodes += partition.num_node_ids;
+      }
+      run_state.collector.reset(new StepStatsCollector(
+          run_metadata->mutable_step_stats(), max_compact_nodes));
+    } else {
+      run_state.collector.reset(
+          new StepStatsCollector(run_metadata->mutable_step_stats()));
+    }
     args.stats_collector = run_state.collector.get();
   }
 
@@ -711,6 +731,9 @@ Status DirectSession::RunInternal(
   args.cancellation_manager = &step_cancellation_manager;
 
   Status run_status;
+  // The time spent in the executors, which is excluded from the framework
+  // overhead of the run.
+  uint64 executor_usecs = 0;
 
   auto set_threadpool_args_for_item =
       [&default_runner, &handler](const PerPartitionExecutorsAndLib& item,
@@ -742,7 +765,9 @@ Status DirectSession::RunInternal(
 
     const auto& item = executors_and_keys->items[0];
     set_threadpool_args_for_item(item, &args);
+    const uint64 executor_start_usecs = options_.env->NowMicros();
     run_status = item.executor->Run(args);
+    executor_usecs = options_.env->NowMicros() - executor_start_usecs;
   } else {
     core::RefCountPtr<RefCountedIntraProcessRendezvous> rendezvous(
         new RefCountedIntraProcessRendezvous(device_mgr_.get()));
@@ -760,6 +785,7 @@ Status DirectSession::RunInternal(
                               executors_done.Notify();
                             });
 
+    const uint64 executor_start_usecs = options_.env->NowMicros();
     for (const auto& item : executors_and_keys->items) {
       set_threadpool_args_for_item(item, &args);
       item.executor->RunAsync(args, barrier->Get());
@@ -767,6 +793,7 @@ Status DirectSession::RunInternal(
 
     WaitForNotification(&executors_done, &run_state, &step_cancellation_manager,
                         call_timeout);
+    executor_usecs = options_.env->NowMicros() - executor_start_usecs;
     {
       tf_shared_lock l(run_state.mu);
       run_status = run_state.status;
@@ -836,7 +863,9 @@ Status DirectSession::RunInternal(
       }
     }
   }
-  metrics::UpdateGraphExecTime(options_.env->NowMicros() - start_time_usecs);
+  const uint64 run_time_usecs = options_.env->NowMicros() - start_time_usecs;
+  metrics::UpdateGraphExecTime(run_time_usecs);
+  metrics::UpdateGraphFrameworkOverhead(run_time_usecs - executor_usecs);
 
   return absl::OkStatus();
 }
@@ -860,7 +889,7 @@ Status DirectSession::Run(const RunOptions& run_options,
                           const thread::ThreadPoolOptions& threadpool_options) {
   TF_RETURN_IF_ERROR(CheckNotClosed());
   TF_RETURN_IF_ERROR(CheckGraphCreated("Run()"));
-  direct_session_runs->GetCell()->IncrementBy(1);
+  DirectSessionRunsCell()->IncrementBy(1);
 
   // Extract the inputs names for this run of the session.
   std::vector<string> input_tensor_names;
@@ -1444,6 +1473,7 @@ Status DirectSession::CreateExecutors(
     auto executor_type = options_.config.experimental().executor_type();
     TF_RETURN_IF_ERROR(
         NewExecutor(executor_type, params, *partition_graph, &item->executor));
+    item->num_node_ids = partition_graph->num_node_ids();
     if (!options_.config.experimental().disable_output_partition_graphs() ||
         options_.config.graph_options().build_cost_model() > 0) {
       item->graph = std::move(partition_graph);
@@ -1940,7 +1970,7 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     const thread::ThreadPoolOptions& threadpool_options) {
   TF_RETURN_IF_ERROR(CheckNotClosed());
   TF_RETURN_IF_ERROR(CheckGraphCreated("RunCallable()"));
-  direct_session_runs->GetCell()->IncrementBy(1);
+  DirectSessionRunsCell()->IncrementBy(1);
 
   // Check if we already have an executor for these arguments.
   std::shared_ptr<ExecutorsAndKeys> executors_and_keys;
@@ -1959,11 +1989,6 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
         "Attempted to run callable after handle was released: ", handle);
   }
 
-  // NOTE(mrry): Debug options are not currently supported in the
-  // callable interface.
-  DebugOptions debug_options;
-  RunStateArgs run_state_args(debug_options);
-
   // Configure a call frame for the step, which we use to feed and
   // fetch values to and from the executors.
   if (feed_tensors.size() != executors_and_keys->input_types.size()) {
@@ -2012,8 +2037,9 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
   RunCallableCallFrame call_frame(this, executors_and_keys.get(),
                                   actual_feed_tensors, fetch_tensors);
 
+  // Callables do not support partial runs, so the step has no handle.
   if (LogMemory::IsEnabled()) {
-    LogMemory::RecordStep(step_id, run_state_args.handle);
+    LogMemory::RecordStep(step_id, /*handle=*/"");
   }
 
   TF_RETURN_IF_ERROR(RunInternal(
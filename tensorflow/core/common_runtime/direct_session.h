@@ -148,6 +148,9 @@ class DirectSession : public Session {
     Device* device = nullptr;                // not owned.
     FunctionLibraryRuntime* flib = nullptr;  // not owned.
     std::unique_ptr<Executor> executor;
+    // The number of node IDs of the partition graph, which is kept even when
+    // `graph` is not.
+    int num_node_ids = 0;
   };
 
   // An ExecutorsAndKeys is created for a given set of feeds/fetches.
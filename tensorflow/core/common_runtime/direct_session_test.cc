@@ -46,6 +46,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/stacktrace.h"
@@ -201,6 +202,25 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_Callable) {
   }
 }
 
+TEST_F(DirectSessionMinusAXTest, RunCallable_RecordsFrameworkOverhead) {
+  monitoring::testing::CellReader<monitoring::testing::Histogram> overhead(
+      "/tensorflow/core/graph_run_framework_overhead_usecs_histogram");
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  Session::CallableHandle handle;
+  TF_ASSERT_OK(session->MakeCallable(MakeCallableOptions({}, {y_ + ":0"}, {}),
+                                     &handle));
+  for (int i = 0; i < 3; ++i) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->RunCallable(handle, {}, &outputs, nullptr));
+  }
+  EXPECT_EQ(overhead.Delta().num(), 3);
+  TF_ASSERT_OK(session->ReleaseCallable(handle));
+}
+
 TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_OptimizeForStaticGraph) {
   Initialize({3, 2, -1, 0});
   SessionOptions options(DefaultSessionOptions());
@@ -739,6 +759,82 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetworkWithOpts) {
   EXPECT_EQ(run_metadata.step_stats().dev_stats_size(), 2);
 }
 
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetworkWithCompactStepStats) {
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+  std::vector<std::pair<string, Tensor>> inputs;
+  std::vector<string> output_names = {y_ + ":0"};
+  std::vector<string> target_nodes = {y_neg_};
+  std::vector<Tensor> outputs;
+
+  RunOptions run_options;
+  run_options.set_trace_level(RunOptions::SOFTWARE_TRACE);
+  run_options.mutable_experimental()->set_compact_step_stats(true);
+  RunMetadata run_metadata;
+  TF_ASSERT_OK(session->Run(run_options, inputs, output_names, target_nodes,
+                            &outputs, &run_metadata));
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+
+  ASSERT_TRUE(run_metadata.has_step_stats());
+  EXPECT_EQ(run_metadata.step_stats().dev_stats_size(), 2);
+  bool found_y = false;
+  for (const auto& dev_stats : run_metadata.step_stats().dev_stats()) {
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      EXPECT_GT(node_stats.all_start_nanos(), 0);
+      EXPECT_GE(node_stats.all_end_rel_nanos(), 0);
+      if (node_stats.node_name() != y_) continue;
+      found_y = true;
+      // The 2x1 float output of the MatMul.
+      ASSERT_EQ(node_stats.output_size(), 1);
+      EXPECT_EQ(node_stats.output(0).slot(), 0);
+      EXPECT_EQ(node_stats.output(0)
+                    .tensor_description()
+                    .allocation_description()
+                    .requested_bytes(),
+                8);
+    }
+  }
+  EXPECT_TRUE(found_y);
+}
+
+TEST_F(DirectSessionMinusAXTest,
+       RunSimpleNetworkWithCompactStepStats_DisableOutputPartitionGraphs) {
+  Initialize({3, 2, -1, 0});
+  SessionOptions options(DefaultSessionOptions());
+  options.config.mutable_experimental()->set_disable_output_partition_graphs(
+      true);
+  auto session = absl::WrapUnique(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+  std::vector<std::pair<string, Tensor>> inputs;
+  std::vector<string> output_names = {y_ + ":0"};
+  std::vector<string> target_nodes = {y_neg_};
+  std::vector<Tensor> outputs;
+
+  // The partition graphs are not kept, so the size of the compact trace must
+  // not depend on them.
+  RunOptions run_options;
+  run_options.set_trace_level(RunOptions::SOFTWARE_TRACE);
+  run_options.mutable_experimental()->set_compact_step_stats(true);
+  RunMetadata run_metadata;
+  TF_ASSERT_OK(session->Run(run_options, inputs, output_names, target_nodes,
+                            &outputs, &run_metadata));
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+
+  ASSERT_TRUE(run_metadata.has_step_stats());
+  bool found_y = false;
+  for (const auto& dev_stats : run_metadata.step_stats().dev_stats()) {
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      if (node_stats.node_name() == y_) found_y = true;
+    }
+  }
+  EXPECT_TRUE(found_y);
+}
+
 TEST_F(DirectSessionMinusAXTest, RunSimpleNetworkWithOpts_Callable) {
   Initialize({3, 2, -1, 0});
   auto session = CreateSession();
@@ -472,7 +472,10 @@ void EagerContext::ClearCachesAndDefaultExecutor() {
     // during this time as well.
     mutex_lock ml(cache_mu_);
     default_executor_.WaitForAllPendingNodes().IgnoreError();
-    kernel_cache_.clear();
+    for (KernelCacheShard& shard : kernel_cache_shards_) {
+      mutex_lock sl(shard.mu);
+      shard.kernels.clear();
+    }
     for (auto& entry : registered_functions_) {
       entry.second->cached_kernel_keys->clear();
     }
@@ -1101,7 +1104,14 @@ EagerContext::GetCacheStats() {
   CacheStats stats;
   {
     mutex_lock l(cache_mu_);
-    stats.kernel_cache_size = kernel_cache_.size();
+    stats.kernel_cache_size = 0;
+    for (KernelCacheShard& shard : kernel_cache_shards_) {
+      mutex_lock sl(shard.mu);
+      stats.kernel_cache_size += shard.kernels.size();
+      stats.kernel_cache_hits += shard.hits.load(std::memory_order_relaxed);
+      stats.kernel_cache_misses +=
+          shard.misses.load(std::memory_order_relaxed);
+    }
     for (const auto& iter : registered_functions_) {
       stats.func_kernel_cache_entries[iter.first] =
           iter.second->cached_kernel_keys->size();
@@ -1132,7 +1142,9 @@ Status EagerContext::RemoveFunction(const string& func) {
     is_last_ref = registered_function->RefCountIsOne();
     if (is_last_ref) {
       for (auto& key : *registered_function->cached_kernel_keys) {
-        kernel_cache_.erase(key);
+        KernelCacheShard& shard = GetKernelCacheShard(key);
+        mutex_lock sl(shard.mu);
+        shard.kernels.erase(key);
       }
       registered_functions_.erase(func);
     }
@@ -1215,11 +1227,14 @@ Status EagerContext::SyncExecutors() {
 
 core::RefCountPtr<KernelAndDevice> EagerContext::GetCachedKernel(
     Fprint128 cache_key) {
-  tf_shared_lock l(cache_mu_);
-  auto iter = kernel_cache_.find(cache_key);
-  if (iter == kernel_cache_.end()) {
+  KernelCacheShard& shard = GetKernelCacheShard(cache_key);
+  tf_shared_lock l(shard.mu);
+  auto iter = shard.kernels.find(cache_key);
+  if (iter == shard.kernels.end()) {
+    shard.misses.fetch_add(1, std::memory_order_relaxed);
     return nullptr;
   }
+  shard.hits.fetch_add(1, std::memory_order_relaxed);
   core::RefCountPtr<KernelAndDevice> new_ref(iter->second.get());
   new_ref->Ref();
   return new_ref;
@@ -1235,15 +1250,19 @@ Device* EagerContext::GetCachedDevice(Fprint128 device_cache_key) {
 core::RefCountPtr<KernelAndDevice> EagerContext::AddKernelToCache(
     Fprint128 cache_key, core::RefCountPtr<KernelAndDevice> kernel) {
   mutex_lock ml(cache_mu_);
-  auto iter = kernel_cache_.find(cache_key);
-  if (iter != kernel_cache_.end()) {
-    core::RefCountPtr<KernelAndDevice> new_ref(iter->second.get());
+  {
+    KernelCacheShard& shard = GetKernelCacheShard(cache_key);
+    mutex_lock sl(shard.mu);
+    auto iter = shard.kernels.find(cache_key);
+    if (iter != shard.kernels.end()) {
+      core::RefCountPtr<KernelAndDevice> new_ref(iter->second.get());
+      new_ref->Ref();
+      return new_ref;
+    }
+    core::RefCountPtr<KernelAndDevice> new_ref(kernel.get());
     new_ref->Ref();
-    return new_ref;
+    shard.kernels[cache_key] = std::move(new_ref);
   }
-  core::RefCountPtr<KernelAndDevice> new_ref(kernel.get());
-  new_ref->Ref();
-  kernel_cache_[cache_key] = std::move(new_ref);
   auto* registered_function =
       gtl::FindPtrOrNull(registered_functions_, kernel->name());
 
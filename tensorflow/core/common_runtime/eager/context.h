@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_CONTEXT_H_
 
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <cstddef>
 #include <functional>
@@ -783,9 +784,23 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
 
     std::unique_ptr<std::vector<Fprint128>> cached_kernel_keys;
   };
-  std::unordered_map<Fprint128, core::RefCountPtr<KernelAndDevice>,
-                     Fprint128Hasher>
-      kernel_cache_ TF_GUARDED_BY(cache_mu_);
+  // The kernel cache is sharded by key, so that ops issued concurrently from
+  // many threads mostly look up kernels under different locks. Adding and
+  // removing entries also requires `cache_mu_`, which is acquired first.
+  static constexpr int kNumKernelCacheShards = 16;
+  struct KernelCacheShard {
+    mutex mu;
+    std::unordered_map<Fprint128, core::RefCountPtr<KernelAndDevice>,
+                       Fprint128Hasher>
+        kernels TF_GUARDED_BY(mu);
+    // Kept per shard rather than globally to avoid a contended cache line.
+    std::atomic<int64_t> hits{0};
+    std::atomic<int64_t> misses{0};
+  };
+  KernelCacheShard& GetKernelCacheShard(const Fprint128& cache_key) {
+    return kernel_cache_shards_[cache_key.low64 % kNumKernelCacheShards];
+  }
+  std::array<KernelCacheShard, kNumKernelCacheShards> kernel_cache_shards_;
   std::unordered_map<string, RegisteredFunction*> registered_functions_
       TF_GUARDED_BY(cache_mu_);
 
@@ -310,6 +310,49 @@ TEST_F(EagerContextTest, FunctionErrorRecovery) {
   retvals[0] = nullptr;
 }
 
+TEST_F(EagerContextTest, KernelCacheHitsAndMisses) {
+  InitContext(SessionOptions(), DEVICE_PLACEMENT_EXPLICIT);
+  const FunctionDef identity = FDH::Define(
+      // Name
+      "FloatIdentity",
+      // Args
+      {"x: float"},
+      // Return values
+      {"y: float"},
+      // Attr def
+      {},
+      // Nodes
+      {
+          {{"y"}, "Identity", {"x"}, {{"T", DT_FLOAT}}},
+      });
+  TF_ASSERT_OK(context()->AddFunctionDef(identity));
+  ImmediateExecutionContext::CacheStats stats = context()->GetCacheStats();
+  EXPECT_EQ(stats.kernel_cache_size, 0);
+  EXPECT_EQ(stats.kernel_cache_hits, 0);
+  EXPECT_EQ(stats.kernel_cache_misses, 0);
+
+  Tensor float_tensor = test::AsScalar<float>(3.0);
+  auto input = core::RefCountPtr<ImmediateExecutionTensorHandle>(
+      context()->CreateLocalHandleFromTFTensor(
+          float_tensor, context()->HostCPUName().c_str()));
+  for (int i = 0; i < 3; ++i) {
+    auto op = ImmediateOpPtr(context()->CreateOperation());
+    TF_ASSERT_OK(op->Reset("FloatIdentity",
+                           "/job:localhost/replica:0/task:0/device:CPU:0"));
+    TF_ASSERT_OK(op->AddInput(input.get()));
+    std::vector<AbstractTensorHandle*> retvals(1);
+    int num_retvals = retvals.size();
+    TF_ASSERT_OK(op->Execute(absl::MakeSpan(retvals), &num_retvals));
+    retvals[0]->Unref();
+  }
+
+  // The first execution instantiates the kernel, later ones reuse it.
+  stats = context()->GetCacheStats();
+  EXPECT_EQ(stats.kernel_cache_size, 1);
+  EXPECT_EQ(stats.kernel_cache_misses, 1);
+  EXPECT_EQ(stats.kernel_cache_hits, 2);
+}
+
 TEST_F(EagerContextTest, XlaCompileDeviceType) {
   InitContext(SessionOptions(), DEVICE_PLACEMENT_EXPLICIT, /*async=*/true);
   const Tensor kTwo = test::AsScalar<int64_t>(2);
@@ -100,6 +100,21 @@ AbstractTensorInterface* TensorHandle::Resolve(Status* status) {
   }
 }
 
+Status TensorHandle::PrefetchToHost() {
+  if (Type() != LOCAL || ctx_ == nullptr || IsCPU(device()) ||
+      HasLocalMirror(nullptr)) {
+    return absl::OkStatus();
+  }
+  // With mirroring the copy returns this handle with an extra reference, and
+  // fills the mirror once the producing op and the copy have run.
+  TensorHandle* h_cpu = nullptr;
+  TF_RETURN_IF_ERROR(EagerCopyToDevice(this, ctx_, &ctx_->Executor(),
+                                       ctx_->HostCPU(), /*mirror=*/true,
+                                       &h_cpu));
+  h_cpu->Unref();
+  return absl::OkStatus();
+}
+
 ImmediateExecutionTensorHandle* EagerContext::CopyTensorHandleToDevice(
     ImmediateExecutionTensorHandle* handle, const char* device_name,
     Status* status) {
@@ -19,6 +19,7 @@ limitations under the License.
 #include <functional>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
@@ -26,6 +27,10 @@ limitations under the License.
 
 namespace tensorflow {
 namespace {
+// Maximum number of consecutive synchronous nodes the executor thread runs
+// between acquisitions of the queue lock.
+constexpr int kMaxBatchSize = 64;
+
 bool IsAsyncWaitForRemoteFunctionEnabled() {
   bool enabled = true;
   TF_CHECK_OK(ReadBoolFromEnvVar("TF_ENABLE_ASYNC_WAIT_FOR_REMOTE_FUNCTION",
@@ -160,7 +165,7 @@ Status EagerExecutor::AddOrExecute(std::unique_ptr<EagerNode> node) {
     } else {
       status = status_;
       if (status.ok()) {
-        node_queue_.push(std::move(item));
+        node_queue_.push_back(std::move(item));
         // If there were no previous nodes pending, wake the run thread to
         // start processing requests again.
         if (node_queue_.size() == 1) {
@@ -256,7 +261,7 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
     if (from_queue) {
       // Since this was from the async queue, pop it from the front of the queue
       DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
-      node_queue_.pop();
+      node_queue_.pop_front();
     } else if (async) {
       // If it is an Async node then we will find the node in the unfinished
       // nodes list. However we only notify if we are at the front of the list
@@ -290,7 +295,7 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
       }
       while (!node_queue_.empty()) {
         items_to_destroy.push_front(std::move(node_queue_.front()));
-        node_queue_.pop();
+        node_queue_.pop_front();
       }
       for (auto& it : unfinished_nodes_) {
         items_to_destroy.push_front(std::move(it.second));
@@ -349,6 +354,7 @@ void EagerExecutor::Run() {
       gtl::MakeCleanup([this] { thread_exited_notification_.Notify(); });
   while (true) {
     core::RefCountPtr<NodeItem> curr_item;
+    std::vector<core::RefCountPtr<NodeItem>> batch;
     {
       tensorflow::mutex_lock l(node_queue_mutex_);
       while (node_queue_.empty() || !status_.ok()) {
@@ -362,8 +368,23 @@ void EagerExecutor::Run() {
       // will then contain a nullptr. This can be a problem in
       // WaitForAllPendingNodes where we get the top EagerNode pointer
       // and register a notification for its completion.
-      curr_item.reset(node_queue_.front().get());
-      curr_item->Ref();
+      // Consecutive synchronous nodes are run as a batch, which saves taking
+      // the lock and notifying waiters for each of many small ops.
+      for (const auto& item : node_queue_) {
+        if (batch.size() == kMaxBatchSize || item->node->AsAsync() != nullptr) {
+          break;
+        }
+        item->Ref();
+        batch.emplace_back(item.get());
+      }
+      if (batch.empty()) {
+        curr_item.reset(node_queue_.front().get());
+        curr_item->Ref();
+      }
+    }
+    if (!batch.empty()) {
+      RunBatch(std::move(batch));
+      continue;
     }
     Status status = RunItem(std::move(curr_item), /*from_queue=*/true);
     if (!status.ok()) {
@@ -372,6 +393,45 @@ void EagerExecutor::Run() {
   }
 }
 
+void EagerExecutor::RunBatch(std::vector<core::RefCountPtr<NodeItem>> batch) {
+  int num_done = 0;
+  Status status;
+  for (const auto& item : batch) {
+    if (num_done > 0) {
+      // An earlier async node may have failed while this batch was running,
+      // in which case the rest of the batch has already been aborted.
+      tf_shared_lock l(node_queue_mutex_);
+      if (!status_.ok()) break;
+    }
+    DVLOG(3) << "Running Node: [id " << item->id << "] "
+             << item->node->DebugString();
+    status = item->node->Run();
+    if (!status.ok()) break;
+    item->state = NodeState::kDONE;
+    ++num_done;
+  }
+  if (num_done > 0) {
+    mutex_lock l(node_queue_mutex_);
+    // An error in an earlier async node may have cleared the queue, and
+    // already notified the waiters.
+    if (status_.ok()) {
+      for (int i = 0; i < num_done; ++i) {
+        DCHECK(!node_queue_.empty() &&
+               batch[i].get() == node_queue_.front().get());
+        node_queue_.pop_front();
+      }
+      NotifyWaiters(batch.front()->id);
+      nodes_done_.notify_all();
+    }
+  }
+  if (!status.ok()) {
+    VLOG(1) << "Failed to run item: " << status;
+    NodeDone(batch[num_done], status, /*from_queue=*/true);
+  }
+  // `batch` is destroyed here, while not holding node_queue_mutex_, since
+  // node destructors may enqueue more operations.
+}
+
 Status EagerExecutor::RunItem(core::RefCountPtr<NodeItem> item,
                               bool from_queue) {
   DVLOG(3) << "Running Node: [id " << item->id << "] "
@@ -434,7 +494,7 @@ Status EagerExecutor::MoveToUnfinished(core::RefCountPtr<NodeItem> item,
 
   if (from_queue) {
     DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
-    node_queue_.pop();
+    node_queue_.pop_front();
   }
 
   DVLOG(3) << "Add Node: [id " << item->id << "] to unfinished map.";
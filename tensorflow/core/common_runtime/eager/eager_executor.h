@@ -18,6 +18,7 @@ limitations under the License.
 #include <algorithm>
 #include <atomic>
 #include <cstddef>
+#include <deque>
 #include <functional>
 #include <map>
 #include <memory>
@@ -211,6 +212,11 @@ class EagerExecutor {
   void Run();
 
   Status RunItem(core::RefCountPtr<NodeItem> item, bool from_queue);
+
+  // Runs `batch`, consecutive synchronous nodes from the front of the queue,
+  // until one of them fails, and removes the ones that succeeded from the
+  // queue under a single acquisition of node_queue_mutex_.
+  void RunBatch(std::vector<core::RefCountPtr<NodeItem>> batch);
   Status MoveToUnfinished(core::RefCountPtr<NodeItem> item, bool from_queue);
 
   // The impl of WaitForAllPendingNodes
@@ -230,7 +236,7 @@ class EagerExecutor {
   condition_variable nodes_done_ TF_GUARDED_BY(node_queue_mutex_);
 
   // Queue of pending NodeItems. Ordered by NodeItem::id.
-  std::queue<core::RefCountPtr<NodeItem>> node_queue_
+  std::deque<core::RefCountPtr<NodeItem>> node_queue_
       TF_GUARDED_BY(node_queue_mutex_);
 
   // Ordered by NodeItem::id.
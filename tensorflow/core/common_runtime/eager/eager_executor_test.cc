@@ -14,8 +14,10 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/eager/eager_executor.h"
 
+#include <functional>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
@@ -102,6 +104,38 @@ class TestAsyncEagerNode : public AsyncEagerNode {
   Status run_return_status_;
 };
 
+// An async node that finishes when `done` is called.
+class DeferredAsyncEagerNode : public AsyncEagerNode {
+ public:
+  explicit DeferredAsyncEagerNode(StatusCallback* done) : done_(done) {}
+
+  Status Prepare() override { return absl::OkStatus(); }
+  void RunAsync(StatusCallback done) override { *done_ = std::move(done); }
+  void Abort(Status status) override {}
+  string DebugString() const override { return "deferredAsyncEagerNode"; }
+
+ private:
+  StatusCallback* done_;
+};
+
+// A node that runs `run`.
+class CallbackEagerNode : public EagerNode {
+ public:
+  explicit CallbackEagerNode(std::function<void()> run)
+      : run_(std::move(run)) {}
+
+  Status Prepare() override { return absl::OkStatus(); }
+  Status Run() override {
+    run_();
+    return absl::OkStatus();
+  }
+  void Abort(Status status) override {}
+  string DebugString() const override { return "callbackEagerNode"; }
+
+ private:
+  std::function<void()> run_;
+};
+
 TEST(EagerExecutorTest, TestSyncExecutorWithEagerNode) {
   auto sync_executor = std::make_unique<EagerExecutor>(
       /*async=*/false, /*enable_streaming_enqueue=*/true);
@@ -241,6 +275,77 @@ TEST(EagerExecutorTest, TestAsyncExecutorFailRun) {
   ASSERT_EQ(state->read_state(), TestState::State::kFailure);
 }
 
+TEST(EagerExecutorTest, TestAsyncExecutorWithManyEagerNodes) {
+  auto async_executor = std::make_unique<EagerExecutor>(
+      /*async=*/true, /*enable_streaming_enqueue=*/true);
+
+  // More nodes than are run in one batch, interleaved with async nodes.
+  std::vector<TestState> states(200);
+  for (int i = 0; i < states.size(); ++i) {
+    if (i % 50 == 49) {
+      TF_ASSERT_OK(async_executor->AddOrExecute(
+          std::make_unique<TestAsyncEagerNode>(&states[i])));
+    } else {
+      TF_ASSERT_OK(async_executor->AddOrExecute(
+          std::make_unique<TestEagerNode>(&states[i])));
+    }
+  }
+  TF_ASSERT_OK(async_executor->WaitForAllPendingNodes());
+  for (TestState& state : states) {
+    ASSERT_EQ(state.read_state(), TestState::State::kSuccess);
+  }
+}
+
+TEST(EagerExecutorTest, TestAsyncExecutorFailRunStopsLaterNodes) {
+  auto async_executor = std::make_unique<EagerExecutor>(
+      /*async=*/true, /*enable_streaming_enqueue=*/true);
+
+  constexpr int kFailingNode = 100;
+  std::vector<TestState> states(200);
+  for (int i = 0; i < states.size(); ++i) {
+    // Nodes added after the failure are rejected.
+    async_executor
+        ->AddOrExecute(std::make_unique<TestEagerNode>(
+            &states[i], absl::OkStatus(),
+            i == kFailingNode ? errors::Internal("test") : absl::OkStatus()))
+        .IgnoreError();
+  }
+  auto status = async_executor->WaitForAllPendingNodes();
+  ASSERT_EQ(status.code(), tensorflow::error::INTERNAL);
+  for (int i = 0; i < states.size(); ++i) {
+    TestState::State expected = TestState::State::kNotRun;
+    if (i < kFailingNode) expected = TestState::State::kSuccess;
+    if (i == kFailingNode) expected = TestState::State::kFailure;
+    ASSERT_EQ(states[i].read_state(), expected) << "node " << i;
+  }
+}
+
+TEST(EagerExecutorTest, TestAsyncExecutorFailRunOfAsyncNodeStopsBatch) {
+  auto async_executor = std::make_unique<EagerExecutor>(
+      /*async=*/true, /*enable_streaming_enqueue=*/true);
+
+  StatusCallback async_done;
+  TF_ASSERT_OK(async_executor->AddOrExecute(
+      std::make_unique<DeferredAsyncEagerNode>(&async_done)));
+  // The first synchronous node fails the async node that runs before it,
+  // which must stop the nodes after it, even in the same batch.
+  async_executor
+      ->AddOrExecute(std::make_unique<CallbackEagerNode>(
+          [&async_done]() { async_done(errors::Internal("test")); }))
+      .IgnoreError();
+  std::vector<TestState> states(10);
+  for (TestState& state : states) {
+    async_executor->AddOrExecute(std::make_unique<TestEagerNode>(&state))
+        .IgnoreError();
+  }
+  auto status = async_executor->WaitForAllPendingNodes();
+  ASSERT_EQ(status.code(), tensorflow::error::INTERNAL);
+  for (int i = 0; i < states.size(); ++i) {
+    ASSERT_EQ(states[i].read_state(), TestState::State::kNotRun)
+        << "node " << i;
+  }
+}
+
 TEST(EagerExecutorTest, TestAsyncExecutorFailPrepareWithAsyncNode) {
   auto async_executor = std::make_unique<EagerExecutor>(
       /*async=*/true, /*enable_streaming_enqueue=*/true);
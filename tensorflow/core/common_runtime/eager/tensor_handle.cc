@@ -25,6 +25,7 @@ limitations under the License.
 #include <variant>
 #include <vector>
 
+#include "absl/base/config.h"
 #include "absl/status/status.h"
 #include "absl/strings/substitute.h"
 #include "absl/types/variant.h"
@@ -66,8 +67,77 @@ string SafeDeviceDebugString(Device* device) {
   }
 }
 
+// Maximum number of freed TensorHandle allocations kept for reuse by each
+// thread. Disabled under sanitizers so that they can still detect uses of
+// deleted handles.
+#if defined(ABSL_HAVE_ADDRESS_SANITIZER) || \
+    defined(ABSL_HAVE_MEMORY_SANITIZER) || defined(ABSL_HAVE_THREAD_SANITIZER)
+constexpr int kMaxFreeHandlesPerThread = 0;
+#else
+constexpr int kMaxFreeHandlesPerThread = 64;
+#endif
+
+// Per-thread cache of TensorHandle-sized allocations. Handles may be deleted
+// on a different thread than the one that created them, in which case their
+// memory simply moves to the deleting thread's cache.
+class TensorHandleFreeList {
+ public:
+  ~TensorHandleFreeList() {
+    while (size_ > 0) {
+      ::operator delete(slots_[--size_]);
+    }
+  }
+
+  void* Allocate() {
+    if (size_ == 0) return nullptr;
+    return slots_[--size_];
+  }
+
+  // Returns false if the cache is full and `ptr` must be freed instead.
+  bool Free(void* ptr) {
+    if (size_ == kMaxFreeHandlesPerThread) return false;
+    slots_[size_++] = ptr;
+    return true;
+  }
+
+ private:
+  void* slots_[std::max(kMaxFreeHandlesPerThread, 1)];
+  int size_ = 0;
+};
+
+// Set once the calling thread's free list has been destroyed, after which
+// handles deleted by thread-local destructors bypass it.
+thread_local bool free_list_destroyed = false;
+
+TensorHandleFreeList* GetFreeList() {
+  if (kMaxFreeHandlesPerThread == 0 || free_list_destroyed) return nullptr;
+  struct Holder {
+    ~Holder() { free_list_destroyed = true; }
+    TensorHandleFreeList free_list;
+  };
+  thread_local Holder holder;
+  return &holder.free_list;
+}
+
 }  // namespace
 
+void* TensorHandle::operator new(size_t size) {
+  if (size == sizeof(TensorHandle)) {
+    TensorHandleFreeList* free_list = GetFreeList();
+    void* ptr = free_list != nullptr ? free_list->Allocate() : nullptr;
+    if (ptr != nullptr) return ptr;
+  }
+  return ::operator new(size);
+}
+
+void TensorHandle::operator delete(void* ptr, size_t size) {
+  if (size == sizeof(TensorHandle)) {
+    TensorHandleFreeList* free_list = GetFreeList();
+    if (free_list != nullptr && free_list->Free(ptr)) return;
+  }
+  ::operator delete(ptr);
+}
+
 TensorHandle::PackedTensorHandleData::PackedTensorHandleData(
     std::vector<TensorHandle*>&& handles, const TensorShape& shape)
     : handles_(std::move(handles)), shape_(shape) {
@@ -128,6 +128,12 @@ class TensorHandle : public ImmediateExecutionTensorHandle {
   // defined.
   void Release();
 
+  // Eager execution creates and destroys many short-lived handles, so their
+  // memory is recycled through a small per-thread free list instead of going
+  // back to malloc each time.
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr, size_t size);
+
   tensorflow::DataType DataType() const override;
   Status Shape(tensorflow::PartialTensorShape* shape) const override;
   Status NumDims(int* num_dims) const override;
@@ -139,6 +145,10 @@ class TensorHandle : public ImmediateExecutionTensorHandle {
   const char* DeviceType(Status* status) const override;
   int DeviceId(Status* status) const override;
   AbstractTensorInterface* Resolve(Status* status) override;
+  // Adds a host mirror filled by a copy enqueued on the context's executor,
+  // which `Resolve` then reads. In sync mode the copy is done before
+  // returning.
+  Status PrefetchToHost() override;
 
   // Subclasses may return True to instruct the string formatter
   // to use SummarizeValue instead of the NumPy formatter.
@@ -27,11 +27,14 @@ limitations under the License.
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/device.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace {
@@ -859,4 +862,54 @@ TEST(TensorHandle_DeviceNameTest, OnLocalDevice) {
   ASSERT_EQ(0, device_id) << device_id;
 }
 
+TEST(TensorHandle_FreeListTest, DeleteOnOtherThreads) {
+  StaticDeviceMgr device_mgr(DeviceFactory::NewDevice(
+      "CPU", {}, "/job:localhost/replica:0/task:0/device:CPU:0"));
+  auto ctx = new EagerContext(
+      SessionOptions(),
+      tensorflow::ContextDevicePlacementPolicy::DEVICE_PLACEMENT_SILENT, false,
+      &device_mgr, false, nullptr, nullptr, nullptr,
+      /*run_eager_op_as_function=*/true);
+  absl::Cleanup ctx_cleanup = [&]() { ctx->Unref(); };
+
+  // Handles created on this thread are released on the pool threads, whose
+  // free lists then serve the handles they create themselves.
+  constexpr int kNumHandles = 1000;
+  thread::ThreadPool pool(Env::Default(), "free_list_test", 4);
+  for (int i = 0; i < kNumHandles; ++i) {
+    TensorHandle* handle = TensorHandle::CreateLocalHandle(
+        test::AsScalar<float>(i), nullptr, nullptr, ctx);
+    pool.Schedule([handle, ctx, i]() {
+      TensorHandle* other = TensorHandle::CreateLocalHandle(
+          test::AsScalar<float>(-i), nullptr, nullptr, ctx);
+      const Tensor* t = nullptr;
+      TF_EXPECT_OK(handle->Tensor(&t));
+      EXPECT_EQ(t->scalar<float>()(), i);
+      TF_EXPECT_OK(other->Tensor(&t));
+      EXPECT_EQ(t->scalar<float>()(), -i);
+      handle->Unref();
+      other->Unref();
+    });
+  }
+}
+
+void BM_CreateAndDestroyScalarHandle(::testing::benchmark::State& state) {
+  StaticDeviceMgr device_mgr(DeviceFactory::NewDevice(
+      "CPU", {}, "/job:localhost/replica:0/task:0/device:CPU:0"));
+  auto ctx = new EagerContext(
+      SessionOptions(),
+      tensorflow::ContextDevicePlacementPolicy::DEVICE_PLACEMENT_SILENT, false,
+      &device_mgr, false, nullptr, nullptr, nullptr,
+      /*run_eager_op_as_function=*/true);
+  const Tensor t = test::AsScalar<float>(1.0);
+  for (auto s : state) {
+    Tensor copy = t;
+    TensorHandle* handle =
+        TensorHandle::CreateLocalHandle(std::move(copy), nullptr, nullptr, ctx);
+    handle->Unref();
+  }
+  ctx->Unref();
+}
+BENCHMARK(BM_CreateAndDestroyScalarHandle);
+
 }  // namespace tensorflow
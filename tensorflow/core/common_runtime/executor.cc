@@ -18,9 +18,11 @@ limitations under the License.
 #include <algorithm>
 #include <atomic>
 #include <memory>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/str_join.h"
 #include "absl/time/time.h"
@@ -36,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/renamed_device.h"
 #include "tensorflow/core/common_runtime/simple_propagator_state.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/common_runtime/work_stealing_ready_queue.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
@@ -62,6 +65,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/manual_constructor.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
@@ -75,11 +79,13 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/annotated_traceme.h"
 #include "tensorflow/core/profiler/lib/connected_traceme.h"
 #include "tensorflow/core/profiler/lib/context_types.h"
+#include "tensorflow/core/profiler/lib/op_sampler.h"
 #include "tensorflow/core/profiler/lib/scoped_annotation.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/profiler/lib/traceme_encode.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 #include "tensorflow/core/util/determinism.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/managed_stack_trace.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
 
@@ -145,13 +151,65 @@ struct KernelTimer {
 typedef gtl::InlinedVector<TensorValue, 4> TensorValueVec;
 typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
 
+// The work stealing worker running on the current thread, if any. `queue`
+// identifies the `WorkStealingReadyQueue` that the worker belongs to.
+struct WorkStealingWorker {
+  const void* queue = nullptr;
+  int id = -1;
+};
+thread_local WorkStealingWorker current_work_stealing_worker;
+
+// Returns the number of work stealing workers to use per step, which can be
+// overridden via the TF_WORK_STEALING_EXECUTOR_NUM_WORKERS environment
+// variable.
+int GetWorkStealingNumWorkers() {
+  static const int num_workers = [] {
+    int64_t value;
+    Status s = ReadInt64FromEnvVar("TF_WORK_STEALING_EXECUTOR_NUM_WORKERS",
+                                   port::MaxParallelism(), &value);
+    if (!s.ok() || value <= 0) {
+      LOG(WARNING) << "Invalid TF_WORK_STEALING_EXECUTOR_NUM_WORKERS, using "
+                   << port::MaxParallelism() << " workers: " << s;
+      value = port::MaxParallelism();
+    }
+    return static_cast<int>(value);
+  }();
+  return num_workers;
+}
+
+// Options that select non-default scheduling strategies for `ExecutorImpl`.
+struct ExecutorImplOptions {
+  // If greater than zero, every step dispatches its expensive nodes to at most
+  // that many work stealing workers instead of scheduling one closure per node.
+  int work_stealing_num_workers = 0;
+
+  // If true, and the graph has no control flow, the first successful run
+  // records the cost of every kernel, and later runs replay the resulting
+  // inline vs. scheduled decisions without measuring kernels again.
+  bool record_static_schedule = false;
+
+  // If true, the executor runs on a CPU device and the graph has no control
+  // flow, the outputs of the synchronous kernels are kept from one run to the
+  // next, so that kernels reuse their buffers instead of allocating new ones
+  // once nothing else references them. This trades memory, since the buffers
+  // are not returned to the allocator between runs, for fewer allocations
+  // in graphs whose shapes do not change between runs.
+  bool reuse_output_buffers = false;
+};
+
 class ExecutorImpl : public Executor {
  public:
-  explicit ExecutorImpl(const LocalExecutorParams& p) : immutable_state_(p) {}
+  explicit ExecutorImpl(const LocalExecutorParams& p,
+                        const ExecutorImplOptions& options = {})
+      : immutable_state_(p), options_(options) {}
 
   Status Initialize(const Graph& graph) {
     TF_RETURN_IF_ERROR(immutable_state_.Initialize(graph));
     kernel_stats_.Initialize(immutable_state_.graph_view());
+    if (options_.reuse_output_buffers &&
+        immutable_state_.params().device->device_type() == DEVICE_CPU) {
+      output_buffers_.Initialize(immutable_state_.graph_view());
+    }
     return absl::OkStatus();
   }
 
@@ -166,16 +224,19 @@ class ExecutorImpl : public Executor {
    public:
     KernelStats() = default;
 
+    // Kernels whose `IsExpensive()` returns true start out expensive, the
+    // others start out inexpensive. Either way, the measured costs then
+    // decide.
     void Initialize(const GraphView& gview) {
-      is_expensive_.resize(gview.num_nodes());
+      num_nodes_ = gview.num_nodes();
       cost_estimates_ =
           std::make_unique<std::atomic_uint_fast64_t[]>(gview.num_nodes());
       for (int32_t i = 0; i < gview.num_nodes(); ++i) {
-        if (gview.node(i)) {
-          is_expensive_[i] =
-              gview.node(i)->kernel && gview.node(i)->kernel->IsExpensive();
-          cost_estimates_[i] = kInitialCostEstimateCycles;
-        }
+        const bool has_expensive_marker = gview.node(i) &&
+                                          gview.node(i)->kernel &&
+                                          gview.node(i)->kernel->IsExpensive();
+        cost_estimates_[i] =
+            has_expensive_marker ? kInitialCostEstimateCycles : 0;
       }
     }
 
@@ -183,20 +244,85 @@ class ExecutorImpl : public Executor {
     // executor uses this flag to optimize graph execution, for example
     // by "inlining" inexpensive kernels.
     bool IsExpensive(const NodeItem& node) const {
-      return is_expensive_[node.node_id] &&
-             (cost_estimates_[node.node_id].load(std::memory_order_relaxed) >
-              kOpIsExpensiveThresholdCycles);
+      if (IsFrozen()) return frozen_is_expensive_[node.node_id];
+      return cost_estimates_[node.node_id].load(std::memory_order_relaxed) >
+             kOpIsExpensiveThresholdCycles;
+    }
+
+    // Returns false if the schedule has been frozen, since the cost of frozen
+    // kernels no longer needs to be measured.
+    bool IsMeasured() const { return !IsFrozen(); }
+
+    // Starts recording a static schedule. Returns false if a schedule is
+    // already being recorded or has been frozen.
+    //
+    // Only the run that started the recording calls `RecordCost()`, for every
+    // synchronous kernel it measures. Concurrent runs keep updating the
+    // dynamic cost estimates, which do not affect the recording.
+    bool StartRecording() {
+      int expected = kDynamic;
+      if (!mode_.compare_exchange_strong(expected, kRecording)) return false;
+      // Kernels that the recording run does not measure, e.g. because they
+      // are traced, keep their current estimate.
+      recorded_cycles_.resize(num_nodes_);
+      for (int32_t i = 0; i < num_nodes_; ++i) {
+        recorded_cycles_[i] =
+            cost_estimates_[i].load(std::memory_order_relaxed);
+      }
+      return true;
+    }
+
+    // Records the cost of `node` in the run that records the static schedule.
+    // Each node runs once in the graphs that are recorded, so this needs no
+    // synchronization.
+    void RecordCost(const NodeItem& node, uint64 elapsed_cycles) {
+      recorded_cycles_[node.node_id] = elapsed_cycles;
+    }
+
+    // Ends the recording started by `StartRecording()`. If `freeze` is true,
+    // the recorded costs are turned into fixed inline vs. scheduled
+    // decisions, which `IsExpensive()` returns from then on. Otherwise, the
+    // executor goes back to dynamic cost estimation.
+    //
+    // If every node of the frozen schedule is synchronous and inexpensive, the
+    // nodes are also put in a fixed order, which `StaticSchedule()` returns, so
+    // that later runs execute them one after the other without propagating
+    // readiness along the edges.
+    void StopRecording(const ImmutableExecutorState& immutable_state,
+                       bool freeze) {
+      DCHECK_EQ(mode_.load(std::memory_order_relaxed), kRecording);
+      if (!freeze) {
+        recorded_cycles_.clear();
+        mode_.store(kDynamic);
+        return;
+      }
+      frozen_is_expensive_.resize(num_nodes_);
+      bool any_expensive = false;
+      for (int32_t i = 0; i < num_nodes_; ++i) {
+        frozen_is_expensive_[i] =
+            recorded_cycles_[i] > kOpIsExpensiveThresholdCycles;
+        any_expensive |= frozen_is_expensive_[i];
+      }
+      recorded_cycles_.clear();
+      if (!any_expensive) {
+        static_schedule_ = TopologicalOrder(immutable_state);
+      }
+      // Publishes `frozen_is_expensive_` and `static_schedule_` to concurrent
+      // readers of `mode_`.
+      mode_.store(kFrozen, std::memory_order_release);
     }
 
-    // Returns the value of kernel->IsExpensive().
-    bool HasExpensiveMarker(const NodeItem& node) const {
-      return is_expensive_[node.node_id];
+    // Returns the order in which the nodes of a frozen static schedule run, or
+    // nullptr if they are scheduled dynamically.
+    const std::vector<const NodeItem*>* StaticSchedule() const {
+      if (!IsFrozen() || static_schedule_.empty()) return nullptr;
+      return &static_schedule_;
     }
 
     // Updates the dynamic cost estimate, which is used to determine whether the
     // given node is expensive. The new cost estimate is a weighted average of
-    // the old cost estimate and the latest cost. We only update cost estimates
-    // for kernels for which IsExpensive() return true.
+    // the old cost estimate and the latest cost, so that kernels whose marker
+    // is wrong move to the other side of the threshold.
     void UpdateCostEstimate(const NodeItem& node, uint64 elapsed_cycles) {
       // N.B. Updates to `cost_estimate` are atomic but unlocked.  Simultaneous
       // updates may result in one or more updates being ignored.  This does not
@@ -213,18 +339,123 @@ class ExecutorImpl : public Executor {
    private:
     // Initial time (in CPU cycles) we expect an operation to take.  Used to
     // determine whether an operation should be place in a threadpool.
-    // Operations start out "expensive".
+    // Operations with an expensive marker start out "expensive".
     static constexpr uint64 kInitialCostEstimateCycles = 100 * 1000 * 1000;
     static constexpr uint64 kOpIsExpensiveThresholdCycles = 8000;
     static constexpr uint64 kCostDecay = 10;
 
-    std::vector<bool> is_expensive_;
-    // std::unique_ptr<std::atomic<bool>[]> is_expensive_;
+    enum Mode { kDynamic, kRecording, kFrozen };
+
+    bool IsFrozen() const {
+      return mode_.load(std::memory_order_acquire) == kFrozen;
+    }
+
+    // Returns the nodes reachable from the roots of `immutable_state` in an
+    // order that runs every node after its inputs and control inputs, or an
+    // empty vector if one of them is asynchronous.
+    static std::vector<const NodeItem*> TopologicalOrder(
+        const ImmutableExecutorState& immutable_state) {
+      const GraphView& gview = immutable_state.graph_view();
+      std::vector<int32_t> num_pending(gview.num_nodes(), 0);
+      for (int32_t i = 0; i < gview.num_nodes(); ++i) {
+        const NodeItem* item = gview.node(i);
+        if (item == nullptr) continue;
+        for (const EdgeInfo& e : item->output_edges()) ++num_pending[e.dst_id];
+        for (const ControlEdgeInfo& e : item->output_control_edges()) {
+          ++num_pending[e.dst_id];
+        }
+      }
+      std::vector<const NodeItem*> order(immutable_state.root_nodes().begin(),
+                                         immutable_state.root_nodes().end());
+      for (size_t i = 0; i < order.size(); ++i) {
+        const NodeItem* item = order[i];
+        if (item->kernel_is_async) return {};
+        for (const EdgeInfo& e : item->output_edges()) {
+          if (--num_pending[e.dst_id] == 0) {
+            order.push_back(&gview.node_ref(e.dst_id));
+          }
+        }
+        for (const ControlEdgeInfo& e : item->output_control_edges()) {
+          if (--num_pending[e.dst_id] == 0) {
+            order.push_back(&gview.node_ref(e.dst_id));
+          }
+        }
+      }
+      return order;
+    }
+
+    int32_t num_nodes_ = 0;
     std::unique_ptr<std::atomic_uint_fast64_t[]> cost_estimates_;
+
+    std::atomic<int> mode_{kDynamic};
+    // The costs measured by the run that records the static schedule.
+    std::vector<uint64> recorded_cycles_;
+    // The inline vs. scheduled decisions, and the node order if every node is
+    // inlined, of a frozen static schedule. Written once before `mode_`
+    // becomes `kFrozen`.
+    std::vector<bool> frozen_is_expensive_;
+    std::vector<const NodeItem*> static_schedule_;
+  };
+
+  // Stores the outputs of the synchronous kernels of a run for the next runs,
+  // when `ExecutorImplOptions::reuse_output_buffers` is set.
+  class OutputBuffers {
+   public:
+    OutputBuffers() = default;
+
+    void Initialize(const GraphView& gview) {
+      nodes_ = std::make_unique<NodeBuffers[]>(gview.num_nodes());
+    }
+
+    bool IsInitialized() const { return nodes_ != nullptr; }
+
+    // Moves the outputs stored for `node` to `tensors`, which has one element
+    // per output of `node`. Concurrent runs of `node` do not get the same
+    // tensors.
+    void Take(const NodeItem& node, Tensor* tensors) {
+      NodeBuffers& buffers = nodes_[node.node_id];
+      mutex_lock l(buffers.mu);
+      for (size_t i = 0; i < buffers.tensors.size(); ++i) {
+        tensors[i] = std::move(buffers.tensors[i]);
+      }
+      buffers.tensors.clear();
+    }
+
+    // Stores the outputs of `node`, except those that share their buffer
+    // with one of the `inputs` of `node` or cannot be reused.
+    void Put(const NodeItem& node, absl::Span<const TensorValue> inputs,
+             const Entry* outputs) {
+      NodeBuffers& buffers = nodes_[node.node_id];
+      mutex_lock l(buffers.mu);
+      // Clearing the tensors keeps the capacity of the vector.
+      buffers.tensors.clear();
+      buffers.tensors.resize(node.num_outputs);
+      for (int i = 0; i < node.num_outputs; ++i) {
+        if (outputs[i].state != Entry::State::HAS_VALUE) continue;
+        const Tensor& output = *outputs[i].val;
+        if (!DataTypeCanUseMemcpy(output.dtype()) ||
+            absl::c_any_of(inputs, [&output](const TensorValue& input) {
+              return input.tensor != nullptr &&
+                     input.tensor->SharesBufferWith(output);
+            })) {
+          continue;
+        }
+        buffers.tensors[i] = output;
+      }
+    }
+
+   private:
+    struct NodeBuffers {
+      mutex mu;
+      std::vector<Tensor> tensors TF_GUARDED_BY(mu);
+    };
+    std::unique_ptr<NodeBuffers[]> nodes_;
   };
 
   ImmutableExecutorState immutable_state_;
   KernelStats kernel_stats_;
+  OutputBuffers output_buffers_;
+  const ExecutorImplOptions options_;
 
   ExecutorImpl(const ExecutorImpl&) = delete;
   void operator=(const ExecutorImpl&) = delete;
@@ -284,7 +515,10 @@ class ExecutorState {
  public:
   ExecutorState(const Executor::Args& args,
                 const ImmutableExecutorState& immutable_state_,
-                ExecutorImpl::KernelStats* kernel_stats_);
+                ExecutorImpl::KernelStats* kernel_stats_,
+                int work_stealing_num_workers = 0,
+                ExecutorImpl::OutputBuffers* output_buffers = nullptr,
+                bool records_static_schedule = false);
   ~ExecutorState();
 
   void RunAsync(Executor::DoneCallback done);
@@ -295,9 +529,15 @@ class ExecutorState {
   typedef
       typename PropagatorStateType::TaggedNodeReadyQueue TaggedNodeReadyQueue;
   typedef typename PropagatorStateType::TaggedNodeSeq TaggedNodeSeq;
+  typedef WorkStealingReadyQueue<TaggedNode, TaggedNodeReadyQueue>
+      WorkStealingQueue;
 
   struct AsyncState;
 
+  // Only `SimplePropagatorState` runs can follow a static schedule.
+  static constexpr bool kSupportsStaticSchedule =
+      std::is_same<PropagatorStateType, SimplePropagatorState>::value;
+
   // Process a ready node in current thread.
   void Process(const TaggedNode& node, int64_t scheduled_nsec);
 
@@ -333,13 +573,35 @@ class ExecutorState {
                 TaggedNodeReadyQueue* inline_ready);
 
   // Schedule all the expensive nodes in '*ready', and put all the inexpensive
-  // nodes in 'ready' into 'inline_ready'.
+  // nodes in 'ready' into 'inline_ready'. Expensive nodes on longer critical
+  // paths are scheduled first.
   //
   // This method will clear `*ready` before returning.
   //
   // REQUIRES: `!ready->empty()`.
   void ScheduleReady(TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready);
 
+  int32 CriticalPathLength(const TaggedNode& tagged_node) const {
+    return immutable_state_.critical_path_length(
+        tagged_node.node_item->node_id);
+  }
+
+  // Pushes `nodes` onto the work stealing queues, and starts new workers if
+  // fewer than the maximum number of workers are active. If the calling thread
+  // is a worker of this step, the nodes are pushed onto its own queue.
+  //
+  // REQUIRES: `work_stealing_queue_ != nullptr`.
+  void PushWorkStealing(const TaggedNodeSeq& nodes, int64_t scheduled_nsec);
+
+  // Runs nodes from `queue` until all of its shards are empty.
+  //
+  // NOTE: This is static because `state` may be deleted by the last node that
+  // the worker processes. `state` is only dereferenced while the worker holds
+  // a node that has not completed yet.
+  static void RunWorkStealingWorker(ExecutorState* state,
+                                    std::shared_ptr<WorkStealingQueue> queue,
+                                    int64_t scheduled_nsec);
+
   // A wrapper for runner_ to keep track of the pending queue length. Op
   // execution should dispatch work using this function instead of using runner_
   // directly.
@@ -361,6 +623,8 @@ class ExecutorState {
 
   int64_t step_id_;
   int64_t trace_id_;  // for profiler.
+  // true if the synchronous ops of this step are recorded by the OpSampler.
+  const bool sample_ops_;
   int64_t start_time_usecs_ = 0;
   // The deadline for the session to complete by. Empty if unspecified.
   absl::optional<absl::Time> deadline_;
@@ -390,6 +654,16 @@ class ExecutorState {
   CallFrameInterface* call_frame_;
   const ImmutableExecutorState& immutable_state_;
   ExecutorImpl::KernelStats* const kernel_stats_;
+  // Not null if the outputs of the synchronous kernels are kept for the buffers
+  // to be reused by the next runs.
+  ExecutorImpl::OutputBuffers* const output_buffers_;
+  // True if this run records the static schedule of `kernel_stats_`.
+  const bool records_static_schedule_;
+  // Not null if this run follows the frozen static schedule of
+  // `kernel_stats_`, in which case the nodes run one after the other on a
+  // single thread, and `next_scheduled_node_` is the index of the next one.
+  const std::vector<const NodeItem*>* const static_schedule_;
+  size_t next_scheduled_node_ = 1;
   CancellationManager* cancellation_manager_;
   tsl::CoordinationServiceAgent* coordination_service_agent_;
   absl::optional<ManagedStackTrace> stack_trace_ = absl::nullopt;
@@ -401,6 +675,10 @@ class ExecutorState {
 
   PropagatorStateType propagator_;
 
+  // Non-null iff expensive nodes are dispatched to work stealing workers. This
+  // is shared with the workers, which may outlive the `ExecutorState`.
+  std::shared_ptr<WorkStealingQueue> work_stealing_queue_;
+
   // Invoked when the execution finishes.
   Executor::DoneCallback done_cb_;
 
@@ -419,11 +697,13 @@ class ExecutorState {
 template <class PropagatorStateType>
 ExecutorState<PropagatorStateType>::ExecutorState(
     const Executor::Args& args, const ImmutableExecutorState& immutable_state,
-    ExecutorImpl::KernelStats* kernel_stats)
+    ExecutorImpl::KernelStats* kernel_stats, int work_stealing_num_workers,
+    ExecutorImpl::OutputBuffers* output_buffers, bool records_static_schedule)
     : vlog_(VLOG_IS_ON(1)),
       log_memory_(LogMemory::IsEnabled()),
       step_id_(args.step_id),
       trace_id_(args.function_trace_id ? *args.function_trace_id : step_id_),
+      sample_ops_(profiler::OpSampler::Get()->ShouldSampleStep(step_id_)),
       start_time_usecs_(args.start_time_usecs),
       deadline_(args.deadline),
       rendezvous_(args.rendezvous),
@@ -442,6 +722,11 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       call_frame_(args.call_frame),
       immutable_state_(immutable_state),
       kernel_stats_(kernel_stats),
+      output_buffers_(output_buffers),
+      records_static_schedule_(records_static_schedule),
+      static_schedule_(kSupportsStaticSchedule
+                           ? kernel_stats->StaticSchedule()
+                           : nullptr),
       cancellation_manager_(args.cancellation_manager),
       coordination_service_agent_(args.coordination_service_agent),
       stack_trace_(args.stack_trace),
@@ -450,6 +735,10 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       run_all_kernels_inline_(args.run_all_kernels_inline),
       propagator_(immutable_state, step_id_, vlog_),
       num_outstanding_ops_(0) {
+  if (work_stealing_num_workers > 0 && !run_all_kernels_inline_) {
+    work_stealing_queue_ =
+        std::make_shared<WorkStealingQueue>(work_stealing_num_workers);
+  }
   if (args.user_intra_op_threadpool != nullptr) {
     Device* device = immutable_state_.params().device;
     user_device_ = RenamedDevice::NewRenamedDevice(
@@ -512,6 +801,15 @@ void ExecutorState<PropagatorStateType>::RunAsync(Executor::DoneCallback done) {
     done(absl::OkStatus());
   } else {
     done_cb_ = std::move(done);
+    if constexpr (kSupportsStaticSchedule) {
+      if (static_schedule_ != nullptr) {
+        // The schedule starts with the roots and runs its nodes one after the
+        // other, so only one node is ever outstanding.
+        ready.clear();
+        ready.push_back(TaggedNode(static_schedule_->front()));
+        num_outstanding_ops_ = 1;
+      }
+    }
     // Schedule to run all the ready ops in thread pool.
     ScheduleReady(&ready, nullptr);
   }
@@ -581,17 +879,40 @@ bool MightTrace(const tracing::EventCollector* event_collector,
   return profiler::TraceMe::Active(profiler::GetTFTraceMeLevel(is_expensive));
 }
 
+// Records the execution of `op_kernel`, which started at `start_ns`, with the
+// bytes of its outputs into the OpSampler.
+void RecordOpSample(const OpKernel& op_kernel, OpKernelContext* ctx,
+                    uint64 start_ns) {
+  const uint64 end_ns = EnvTime::NowNanos();
+  uint64 bytes = 0;
+  for (int i = 0; i < ctx->num_outputs(); ++i) {
+    const Tensor* output = ctx->mutable_output(i);
+    if (output != nullptr) bytes += output->TotalBytes();
+  }
+  profiler::OpSampler::Get()->Record(op_kernel.name_view(),
+                                     op_kernel.type_string_view(), start_ns,
+                                     end_ns, bytes);
+}
+
 template <class PropagatorStateType>
 Status ExecutorState<PropagatorStateType>::ProcessSync(
     const NodeItem& item, OpKernelContext::Params* params, EntryVector* outputs,
     NodeExecStatsInterface* stats) {
   Status s;
+  gtl::InlinedVector<Tensor, 4> reusable_outputs;
+  if (output_buffers_ != nullptr && item.num_outputs > 0 &&
+      !params->track_allocations) {
+    reusable_outputs.resize(item.num_outputs);
+    output_buffers_->Take(item, reusable_outputs.data());
+    params->reusable_outputs = reusable_outputs.data();
+  }
   OpKernelContext ctx(params, item.num_outputs);
   nodestats::SetOpStart(stats);
 
   OpKernel* op_kernel = item.kernel;
   Device* device = immutable_state_.params().device;
   const bool is_expensive = kernel_stats_->IsExpensive(item);
+  const uint64 sample_start_ns = sample_ops_ ? EnvTime::NowNanos() : 0;
 
   if (TF_PREDICT_FALSE(MightTrace(event_collector_, is_expensive))) {
     tracing::ScopedRegion region(tracing::EventCategory::kCompute,
@@ -603,24 +924,36 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
         },
         profiler::GetTFTraceMeLevel(is_expensive));
     device->Compute(op_kernel, &ctx);
-  } else if (kernel_stats_->HasExpensiveMarker(item)) {
+  } else if (kernel_stats_->IsMeasured()) {
     KernelTimer timer;
     device->Compute(op_kernel, &ctx);
     // For expensive kernels, always update the cost estimate. For inexpensive
     // kernels, update the cost estimate with ~1/16 probability. This assumes
     // that the last 4 bits of the CPU cycle count is uniformly distributed.
     constexpr int kKernelExecutionTrackingInvocationSkipCount = 16;
-    if (is_expensive ||
-        timer.start_cycles % kKernelExecutionTrackingInvocationSkipCount == 0) {
+    if (TF_PREDICT_FALSE(records_static_schedule_)) {
+      kernel_stats_->RecordCost(item, timer.ElapsedCycles());
+    } else if (is_expensive ||
+               timer.start_cycles %
+                       kKernelExecutionTrackingInvocationSkipCount ==
+                   0) {
       kernel_stats_->UpdateCostEstimate(item, timer.ElapsedCycles());
     }
   } else {
     device->Compute(op_kernel, &ctx);
   }
   nodestats::SetOpEnd(stats);
+  if (TF_PREDICT_FALSE(sample_ops_)) {
+    RecordOpSample(*op_kernel, &ctx, sample_start_ns);
+  }
   if (outputs->size() < item.num_outputs) outputs->resize(item.num_outputs);
   s = ProcessOutputs(item, &ctx, outputs->data(), stats);
   nodestats::SetMemory(stats, &ctx);
+  if (params->reusable_outputs != nullptr) {
+    // `params` is reused by the next node.
+    params->reusable_outputs = nullptr;
+    if (s.ok()) output_buffers_->Put(item, params->inputs, outputs->data());
+  }
   return s;
 }
 
@@ -912,6 +1245,12 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
 
       // Set up compute params.
       params->op_kernel = item.kernel;
+      if (DeviceContext* dc = immutable_state_.device_context(id)) {
+        params->op_device_context = dc;
+      } else {
+        params->op_device_context = device_context_;
+      }
+      params->wait_device_contexts = immutable_state_.wait_device_contexts(id);
       params->frame_iter = propagator_.GetFrameAndIter(tagged_node);
       params->is_input_dead = is_input_dead;
       params->output_attr_array = item.output_attrs();
@@ -947,7 +1286,23 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
       activity_watcher::ActivityEnd(activity_id);
       // Propagates outputs.
       if (s.ok()) {
-        propagator_.PropagateOutputs(tagged_node, &outputs, ready.get());
+        bool follows_static_schedule = false;
+        if constexpr (kSupportsStaticSchedule) {
+          if (static_schedule_ != nullptr) {
+            // The schedule, rather than the pending counts, decides which node
+            // runs next.
+            follows_static_schedule = true;
+            propagator_.PropagateOutputsToScheduledNodes(tagged_node,
+                                                         &outputs);
+            if (next_scheduled_node_ < static_schedule_->size()) {
+              ready->push_back(
+                  TaggedNode((*static_schedule_)[next_scheduled_node_++]));
+            }
+          }
+        }
+        if (!follows_static_schedule) {
+          propagator_.PropagateOutputs(tagged_node, &outputs, ready.get());
+        }
       }
 
       // Clear outputs without deallocating the `outputs` vector.
@@ -1302,9 +1657,13 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
     TaggedNodeSeq expensive_nodes;
     if (inline_ready == nullptr) {
       // Schedule to run all the ready ops in thread pool.
-      for (auto& tagged_node : *ready) {
-        RunTask([=]() { Process(tagged_node, scheduled_nsec); },
-                /*sample_rate=*/ready->size());
+      if (work_stealing_queue_) {
+        PushWorkStealing(*ready, scheduled_nsec);
+      } else {
+        for (auto& tagged_node : *ready) {
+          RunTask([=]() { Process(tagged_node, scheduled_nsec); },
+                  /*sample_rate=*/ready->size());
+        }
       }
     } else {
       for (auto& tagged_node : *ready) {
@@ -1313,10 +1672,18 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
           // Inline this inexpensive node.
           inline_ready->push_back(tagged_node);
         } else {
-          if (curr_expensive_node) {
-            expensive_nodes.push_back(*curr_expensive_node);
+          // Keep the last expensive node on the longest critical path for
+          // this thread.
+          if (curr_expensive_node == nullptr ||
+              CriticalPathLength(tagged_node) >=
+                  CriticalPathLength(*curr_expensive_node)) {
+            if (curr_expensive_node) {
+              expensive_nodes.push_back(*curr_expensive_node);
+            }
+            curr_expensive_node = &tagged_node;
+          } else {
+            expensive_nodes.push_back(tagged_node);
           }
-          curr_expensive_node = &tagged_node;
         }
       }
     }
@@ -1329,8 +1696,21 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
         expensive_nodes.push_back(*curr_expensive_node);
       }
     }
+    if (expensive_nodes.size() > 1) {
+      // Both the inter-op pool and the work stealing queue run nodes roughly in
+      // the order they are enqueued, so dispatch the nodes on longer critical
+      // paths first.
+      std::stable_sort(expensive_nodes.begin(), expensive_nodes.end(),
+                       [this](const TaggedNode& a, const TaggedNode& b) {
+                         return CriticalPathLength(a) > CriticalPathLength(b);
+                       });
+    }
     if (!expensive_nodes.empty()) {
-      if (expensive_nodes.size() < kInlineScheduleReadyThreshold) {
+      if (work_stealing_queue_) {
+        // Idle workers steal the expensive nodes, so there is no need to fan
+        // them out via child threads.
+        PushWorkStealing(expensive_nodes, scheduled_nsec);
+      } else if (expensive_nodes.size() < kInlineScheduleReadyThreshold) {
         for (auto& tagged_node : expensive_nodes) {
           RunTask(std::bind(&ExecutorState::Process, this, tagged_node,
                             scheduled_nsec),
@@ -1374,6 +1754,48 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
   ready->clear();
 }
 
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::PushWorkStealing(
+    const TaggedNodeSeq& nodes, int64_t scheduled_nsec) {
+  WorkStealingQueue* queue = work_stealing_queue_.get();
+  const int worker_id = current_work_stealing_worker.queue == queue
+                            ? current_work_stealing_worker.id
+                            : -1;
+  for (const TaggedNode& tagged_node : nodes) {
+    queue->Push(worker_id, tagged_node);
+  }
+  // Start at most one new worker per pushed node. Existing workers pick up the
+  // remaining nodes.
+  for (size_t i = 0; i < nodes.size() && queue->TryAddWorker(); ++i) {
+    RunTask(
+        [this, queue = work_stealing_queue_, scheduled_nsec]() {
+          RunWorkStealingWorker(this, queue, scheduled_nsec);
+        },
+        /*sample_rate=*/nodes.size());
+  }
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::RunWorkStealingWorker(
+    ExecutorState* state, std::shared_ptr<WorkStealingQueue> queue,
+    int64_t scheduled_nsec) {
+  profiler::TraceMe activity("ExecutorState::RunWorkStealingWorker",
+                             profiler::TraceMeLevel::kVerbose);
+  const WorkStealingWorker saved_worker = current_work_stealing_worker;
+  current_work_stealing_worker = {queue.get(), queue->NextWorkerId()};
+  const int worker_id = current_work_stealing_worker.id;
+
+  TaggedNodeReadyQueue inline_ready;
+  do {
+    while (queue->PopInto(worker_id, &inline_ready)) {
+      // The popped node is outstanding, so `state` has not been deleted yet.
+      state->ProcessInline(&inline_ready, scheduled_nsec);
+    }
+  } while (queue->RemoveWorker());
+
+  current_work_stealing_worker = saved_worker;
+}
+
 template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::ScheduleFinish() {
   // Checks condition to decide if needs to invoke Finish(). If there are
@@ -1516,11 +1938,25 @@ void ExecutorImpl::RunAsyncInternal(const Args& args, DoneCallback done) {
                                                &kernel_stats_))
         ->RunAsync(std::move(done));
   } else if (immutable_state_.requires_control_flow_support()) {
-    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_))
+    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_,
+                                        options_.work_stealing_num_workers))
         ->RunAsync(std::move(done));
   } else {
-    (new ExecutorState<SimplePropagatorState>(args, immutable_state_,
-                                              &kernel_stats_))
+    const bool records_static_schedule =
+        options_.record_static_schedule && kernel_stats_.StartRecording();
+    if (records_static_schedule) {
+      // Record the static schedule from this run. Concurrent runs that start
+      // before it completes keep using the dynamic cost estimates.
+      done = [this, done = std::move(done)](const Status& s) {
+        kernel_stats_.StopRecording(immutable_state_, /*freeze=*/s.ok());
+        done(s);
+      };
+    }
+    (new ExecutorState<SimplePropagatorState>(
+         args, immutable_state_, &kernel_stats_,
+         options_.work_stealing_num_workers,
+         output_buffers_.IsInitialized() ? &output_buffers_ : nullptr,
+         records_static_schedule))
         ->RunAsync(std::move(done));
   }
 }
@@ -1559,6 +1995,12 @@ class DefaultExecutorRegistrar {
     Factory* factory = new Factory;
     ExecutorFactory::Register("", factory);
     ExecutorFactory::Register("DEFAULT", factory);
+    ExecutorFactory::Register("WORK_STEALING_EXECUTOR",
+                              new WorkStealingFactory);
+    ExecutorFactory::Register("STATIC_SCHEDULE_EXECUTOR",
+                              new StaticScheduleFactory);
+    ExecutorFactory::Register("REUSE_OUTPUT_BUFFERS_EXECUTOR",
+                              new ReuseOutputBuffersFactory);
   }
 
  private:
@@ -1571,6 +2013,50 @@ class DefaultExecutorRegistrar {
       return absl::OkStatus();
     }
   };
+
+  // Creates executors that dispatch expensive nodes to per-worker ready
+  // queues with work stealing, instead of one inter-op closure per node.
+  class WorkStealingFactory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      ExecutorImplOptions options;
+      options.work_stealing_num_workers = GetWorkStealingNumWorkers();
+      auto impl = std::make_unique<ExecutorImpl>(params, options);
+      TF_RETURN_IF_ERROR(impl->Initialize(graph));
+      *out_executor = std::move(impl);
+      return absl::OkStatus();
+    }
+  };
+
+  // Creates executors that record the inline vs. scheduled decision of every
+  // node on their first successful run, and replay it on later runs. This only
+  // affects graphs without control flow.
+  class StaticScheduleFactory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      ExecutorImplOptions options;
+      options.record_static_schedule = true;
+      auto impl = std::make_unique<ExecutorImpl>(params, options);
+      TF_RETURN_IF_ERROR(impl->Initialize(graph));
+      *out_executor = std::move(impl);
+      return absl::OkStatus();
+    }
+  };
+
+  // Creates executors that keep the outputs of the kernels from one run to the
+  // next, for the kernels to reuse their buffers. This only affects graphs
+  // without control flow on CPU devices.
+  class ReuseOutputBuffersFactory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      ExecutorImplOptions options;
+      options.reuse_output_buffers = true;
+      auto impl = std::make_unique<ExecutorImpl>(params, options);
+      TF_RETURN_IF_ERROR(impl->Initialize(graph));
+      *out_executor = std::move(impl);
+      return absl::OkStatus();
+    }
+  };
 };
 static DefaultExecutorRegistrar registrar;
 
@@ -0,0 +1,178 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Measures the per-node overhead of the executors on small graphs of cheap
+// nodes, so that the executors can be compared on identical graphs. Besides
+// the mean step time, every benchmark reports the median and 99th percentile
+// step latencies and the number of tensor allocations per step. Run with
+// --benchmark_filter=all.
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kDefaultExecutor[] = "";
+constexpr char kSingleThreadedExecutor[] = "SINGLE_THREADED_EXECUTOR";
+constexpr char kWorkStealingExecutor[] = "WORK_STEALING_EXECUTOR";
+constexpr char kStaticScheduleExecutor[] = "STATIC_SCHEDULE_EXECUTOR";
+
+// Runs `g`, after running `init` if it is not null, with the executor of type
+// `executor_type`. Takes ownership of `g` and `init`.
+void RunGraph(::testing::benchmark::State& state, const char* executor_type,
+              Graph* g, Graph* init, int64_t num_nodes) {
+  FixupSourceAndSinkEdges(g);
+  if (init != nullptr) FixupSourceAndSinkEdges(init);
+  test::Benchmark("cpu", g, /*options=*/nullptr, init, /*rendez=*/nullptr,
+                  executor_type, /*old_benchmark_api=*/false)
+      .RunWithStepCounters(state);
+  state.SetLabel(strings::StrCat("Nodes = ", num_nodes));
+  state.SetItemsProcessed(num_nodes * static_cast<int64_t>(state.iterations()));
+}
+
+// A chain of `length` Identity nodes.
+void BM_Chain(::testing::benchmark::State& state, const char* executor_type) {
+  const int length = state.range(0);
+
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* node = test::graph::Constant(g, Tensor(1.0f));
+  for (int i = 0; i < length; ++i) {
+    node = test::graph::Identity(g, node);
+  }
+  RunGraph(state, executor_type, g, /*init=*/nullptr, 1 + length);
+}
+
+// A constant consumed by `width` Identity nodes, whose outputs are joined by a
+// NoOp.
+void BM_FanOut(::testing::benchmark::State& state, const char* executor_type) {
+  const int width = state.range(0);
+
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* source = test::graph::Constant(g, Tensor(1.0f));
+  std::vector<Node*> identities;
+  identities.reserve(width);
+  for (int i = 0; i < width; ++i) {
+    identities.push_back(test::graph::Identity(g, source));
+  }
+  test::graph::NoOp(g, identities);
+  RunGraph(state, executor_type, g, /*init=*/nullptr, 2 + width);
+}
+
+// Reads `num_vars` scalar variables, which are initialized by a separate
+// graph.
+void BM_ManySmallVariables(::testing::benchmark::State& state,
+                           const char* executor_type) {
+  const int num_vars = state.range(0);
+
+  Graph* init = new Graph(OpRegistry::Global());
+  Graph* g = new Graph(OpRegistry::Global());
+  for (int i = 0; i < num_vars; ++i) {
+    const string name = strings::StrCat("var", i);
+    test::graph::Assign(
+        init, test::graph::Var(init, DT_FLOAT, TensorShape({}), name),
+        test::graph::Constant(init, Tensor(1.0f)));
+    test::graph::Identity(
+        g, test::graph::Var(g, DT_FLOAT, TensorShape({}), name));
+  }
+  RunGraph(state, executor_type, g, init, 2 * num_vars);
+}
+
+// A loop of `iters` iterations, whose body only increments its counter.
+void BM_WhileLoop(::testing::benchmark::State& state,
+                  const char* executor_type) {
+  const int iters = state.range(0);
+
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* enter = test::graph::Enter(g, test::graph::Constant(g, Tensor(0)),
+                                   "loop");
+  Node* merge = test::graph::Merge(g, enter, enter);
+  Node* limit = test::graph::Constant(g, Tensor(iters));
+  g->AddControlEdge(merge, limit);
+  Node* cond = test::graph::LoopCond(g, test::graph::Less(g, merge, limit));
+  Node* switch_node = test::graph::Switch(g, merge, cond);
+  test::graph::Exit(g, switch_node);
+  Node* counter = test::graph::Identity(g, switch_node, /*index=*/1);
+  Node* one = test::graph::Constant(g, Tensor(1));
+  g->AddControlEdge(counter, one);
+  Node* next = test::graph::Next(g, g->NewName("next"),
+                                 test::graph::Add(g, counter, one));
+  TF_CHECK_OK(g->UpdateEdge(next, 0, merge, 1));
+  // Every iteration runs the nine nodes from Merge to NextIteration.
+  RunGraph(state, executor_type, g, /*init=*/nullptr, 9 * int64_t{iters});
+}
+
+BENCHMARK_CAPTURE(BM_Chain, default, kDefaultExecutor)
+    ->UseRealTime()
+    ->Arg(1)->Arg(100)->Arg(1000);
+BENCHMARK_CAPTURE(BM_Chain, single_threaded, kSingleThreadedExecutor)
+    ->UseRealTime()
+    ->Arg(1)->Arg(100)->Arg(1000);
+BENCHMARK_CAPTURE(BM_Chain, work_stealing, kWorkStealingExecutor)
+    ->UseRealTime()
+    ->Arg(1)->Arg(100)->Arg(1000);
+BENCHMARK_CAPTURE(BM_Chain, static_schedule, kStaticScheduleExecutor)
+    ->UseRealTime()
+    ->Arg(1)->Arg(100)->Arg(1000);
+
+BENCHMARK_CAPTURE(BM_FanOut, default, kDefaultExecutor)
+    ->UseRealTime()
+    ->Arg(10)->Arg(100)->Arg(1000);
+BENCHMARK_CAPTURE(BM_FanOut, single_threaded, kSingleThreadedExecutor)
+    ->UseRealTime()
+    ->Arg(10)->Arg(100)->Arg(1000);
+BENCHMARK_CAPTURE(BM_FanOut, work_stealing, kWorkStealingExecutor)
+    ->UseRealTime()
+    ->Arg(10)->Arg(100)->Arg(1000);
+BENCHMARK_CAPTURE(BM_FanOut, static_schedule, kStaticScheduleExecutor)
+    ->UseRealTime()
+    ->Arg(10)->Arg(100)->Arg(1000);
+
+// The single threaded executor supports neither reference-typed tensors nor
+// low-level control flow, so it can't run the remaining graphs.
+BENCHMARK_CAPTURE(BM_ManySmallVariables, default, kDefaultExecutor)
+    ->UseRealTime()
+    ->Arg(10)->Arg(100)->Arg(1000);
+BENCHMARK_CAPTURE(BM_ManySmallVariables, work_stealing, kWorkStealingExecutor)
+    ->UseRealTime()
+    ->Arg(10)->Arg(100)->Arg(1000);
+BENCHMARK_CAPTURE(BM_ManySmallVariables, static_schedule,
+                  kStaticScheduleExecutor)
+    ->UseRealTime()
+    ->Arg(10)->Arg(100)->Arg(1000);
+
+BENCHMARK_CAPTURE(BM_WhileLoop, default, kDefaultExecutor)
+    ->UseRealTime()
+    ->Arg(10)->Arg(1000);
+BENCHMARK_CAPTURE(BM_WhileLoop, work_stealing, kWorkStealingExecutor)
+    ->UseRealTime()
+    ->Arg(10)->Arg(1000);
+BENCHMARK_CAPTURE(BM_WhileLoop, static_schedule, kStaticScheduleExecutor)
+    ->UseRealTime()
+    ->Arg(10)->Arg(1000);
+
+}  // namespace
+}  // namespace tensorflow
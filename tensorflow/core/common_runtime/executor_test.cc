@@ -16,6 +16,9 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/executor.h"
 
 #include <algorithm>
+#include <deque>
+#include <functional>
+#include <vector>
 
 #include "tensorflow/cc/framework/ops.h"
 #include "tensorflow/cc/ops/array_ops.h"
@@ -25,14 +28,17 @@ limitations under the License.
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/common_runtime/lower_functional_ops.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/local_rendezvous.h"
 #include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
@@ -42,6 +48,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/strcat.h"
 #include "tensorflow/core/platform/test.h"
@@ -77,8 +84,11 @@ class ExecutorTest : public ::testing::Test {
     delete exec_;
   }
 
-  // Resets executor_ with a new executor based on a graph 'gdef'.
-  void Create(std::unique_ptr<const Graph> graph) {
+  // Resets executor_ with a new executor based on a graph 'gdef'. If
+  // `executor_type` is non-empty, the executor is created via the
+  // `ExecutorFactory` registered for that type.
+  void Create(std::unique_ptr<const Graph> graph,
+              const string& executor_type = "") {
     const int version = graph->versions().producer();
     LocalExecutorParams params;
     params.device = device_.get();
@@ -93,7 +103,13 @@ class ExecutorTest : public ::testing::Test {
     };
     rendez_ = NewLocalRendezvous();
     delete exec_;
-    TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    if (executor_type.empty()) {
+      TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    } else {
+      std::unique_ptr<Executor> exec;
+      TF_CHECK_OK(NewExecutor(executor_type, params, *graph, &exec));
+      exec_ = exec.release();
+    }
     runner_ = [this](std::function<void()> fn) { thread_pool_->Schedule(fn); };
   }
 
@@ -105,6 +121,35 @@ class ExecutorTest : public ::testing::Test {
     return exec_->Run(args);
   }
 
+  // Runs the executor with a runner that queues the closures it is given,
+  // and runs them one at a time in the order they are queued, so that the
+  // dispatched nodes run in the order they are dispatched. Sets
+  // `*num_closures` to the number of closures that ran.
+  Status RunSerially(int* num_closures) {
+    std::deque<std::function<void()>> closures;
+    Executor::Args args;
+    args.rendezvous = rendez_;
+    args.stats_collector = &step_stats_collector_;
+    args.runner = [&closures](std::function<void()> fn) {
+      closures.push_back(std::move(fn));
+    };
+    bool done = false;
+    Status status;
+    exec_->RunAsync(args, [&done, &status](const Status& s) {
+      status = s;
+      done = true;
+    });
+    *num_closures = 0;
+    while (!closures.empty()) {
+      std::function<void()> fn = std::move(closures.front());
+      closures.pop_front();
+      fn();
+      ++*num_closures;
+    }
+    if (!done) return errors::Internal("The executor did not finish.");
+    return status;
+  }
+
   thread::ThreadPool* thread_pool_ = nullptr;
   std::unique_ptr<Device> device_;
   Executor* exec_ = nullptr;
@@ -165,6 +210,42 @@ Rendezvous::ParsedKey Key(const string& sender, const uint64 incarnation,
 #define ALICE "/job:j/replica:0/task:0/cpu:0"
 #define BOB "/job:j/replica:0/task:0/device:GPU:0"
 
+// Adds to `g` the loop `for (i = 0; i < n; ++i) body(i)` in frame
+// `frame_name`, with `body` adding the nodes of an iteration given its
+// counter. The loop is started by `start`, and its Exit node, which outputs
+// the final counter, is returned.
+Node* CountingLoop(Graph* g, Node* start, const string& frame_name, int n,
+                   const std::function<void(Node*)>& body) {
+  Node* zero = test::graph::Constant(g, V(0));
+  g->AddControlEdge(start, zero);
+  Node* enter = test::graph::Enter(g, zero, frame_name);
+  Node* merge = test::graph::Merge(g, enter, enter);
+  Node* limit = test::graph::Constant(g, V(n));
+  g->AddControlEdge(merge, limit);
+  Node* cond = test::graph::LoopCond(g, test::graph::Less(g, merge, limit));
+  Node* switch_node = test::graph::Switch(g, merge, cond);
+  Node* exit = test::graph::Exit(g, switch_node);
+  Node* counter = test::graph::Identity(g, switch_node, /*index=*/1);
+  body(counter);
+  Node* one = test::graph::Constant(g, V(1));
+  g->AddControlEdge(counter, one);
+  Node* next = test::graph::Next(g, g->NewName("next"),
+                                 test::graph::Add(g, counter, one));
+  TF_CHECK_OK(g->UpdateEdge(next, 0, merge, 1));
+  return exit;
+}
+
+// Adds to `g` `depth` nested counting loops of `iters` iterations each,
+// started by `start`, and returns the Exit node of the outermost one.
+Node* NestedCountingLoops(Graph* g, Node* start, int depth, int iters) {
+  return CountingLoop(g, start, strings::StrCat("loop", depth), iters,
+                      [&](Node* counter) {
+                        if (depth > 1) {
+                          NestedCountingLoops(g, counter, depth - 1, iters);
+                        }
+                      });
+}
+
 TEST_F(ExecutorTest, SimpleAdd) {
   // c = a + b
   auto g = std::make_unique<Graph>(OpRegistry::Global());
@@ -266,6 +347,95 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, WorkStealingRandomTree) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g), "WORK_STEALING_EXECUTOR");
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(4096.0, V(out));
+}
+
+TEST_F(ExecutorTest, StaticScheduleRandomTree) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g), "STATIC_SCHEDULE_EXECUTOR");
+  // The first run records the schedule, and the later runs replay it.
+  for (int iters = 0; iters < 3; ++iters) {
+    Rendezvous::Args args;
+    TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args,
+                               V(1.0), false));
+    TF_ASSERT_OK(Run(rendez_));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out,
+                               &is_dead));
+    EXPECT_EQ(4096.0, V(out));
+  }
+}
+
+TEST_F(ExecutorTest, ReuseOutputBuffersRandomTree) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g), "REUSE_OUTPUT_BUFFERS_EXECUTOR");
+  EnableCPUAllocatorStats();
+  Allocator* allocator = device_->GetAllocator(AllocatorAttributes());
+  ASSERT_TRUE(allocator->GetStats().has_value());
+  std::vector<int64_t> num_allocs;
+  for (int iters = 0; iters < 3; ++iters) {
+    Rendezvous::Args args;
+    TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args,
+                               V(iters + 1.0), false));
+    const int64_t num_allocs_before = allocator->GetStats()->num_allocs;
+    // Tracking the allocations of a step, as a stats collector does, turns
+    // off the reuse.
+    Executor::Args exec_args;
+    exec_args.rendezvous = rendez_;
+    exec_args.runner = runner_;
+    TF_ASSERT_OK(exec_->Run(exec_args));
+    num_allocs.push_back(allocator->GetStats()->num_allocs -
+                         num_allocs_before);
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out,
+                               &is_dead));
+    EXPECT_EQ(4096.0 * (iters + 1), V(out));
+  }
+  DisableCPUAllocatorStats();
+  // The later runs reuse the output buffers of the first one, which allocates
+  // an output for each of the 4095 Add nodes.
+  EXPECT_GE(num_allocs[0], 4095);
+  EXPECT_LT(num_allocs[1], num_allocs[0] / 10);
+  EXPECT_LT(num_allocs[2], num_allocs[0] / 10);
+}
+
+TEST_F(ExecutorTest, WorkStealingSimpleSwitch) {
+  // Exercises the control flow propagator in work stealing mode.
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  auto in1 = test::graph::Constant(g.get(), VB(true));
+  auto tmp = test::graph::Switch(g.get(), in0, in1);
+  auto tmp1 = test::graph::Identity(g.get(), tmp, 1);
+  test::graph::Send(g.get(), tmp1, "c", BOB, 1, ALICE);
+  Create(std::move(g), "WORK_STEALING_EXECUTOR");
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0),
+                             false));  // in0 = 1.0
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "c"), args, &out, &is_dead));
+  EXPECT_EQ(1.0, V(out));
+  EXPECT_FALSE(is_dead);
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
@@ -440,6 +610,157 @@ TEST_F(ExecutorTest, NoInputTensors) {
   TF_ASSERT_OK(Run(rendez_));
 }
 
+TEST_F(ExecutorTest, NestedLoops) {
+  // Each instance of an inner loop reuses the frame of a done one.
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto start = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  Node* exit = NestedCountingLoops(g.get(), start, /*depth=*/3, /*iters=*/10);
+  test::graph::Send(g.get(), exit, "b", BOB, 1, ALICE);
+  FixupSourceAndSinkEdges(g.get());
+  Create(std::move(g));
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_FALSE(is_dead);
+  EXPECT_EQ(10.0, V(out));
+}
+
+// Adds to `g` a chain of `length` Neg nodes, which are expensive, fed by
+// `input` and returns its first node.
+Node* NegChain(Graph* g, Node* input, int length) {
+  Node* first = test::graph::Unary(g, "Neg", input);
+  Node* node = first;
+  for (int i = 1; i < length; ++i) {
+    node = test::graph::Unary(g, "Neg", node);
+  }
+  return first;
+}
+
+TEST_F(ExecutorTest, DispatchesLongerCriticalPathsFirst) {
+  // A constant feeds an Identity and chains of 1, 2 and 3 Neg nodes. The
+  // inexpensive Identity runs inline, so the first node of every chain is
+  // dispatched, and the chains are added shortest first.
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  Node* input = test::graph::Constant(g.get(), V(1.0));
+  test::graph::Identity(g.get(), input);
+  const std::vector<Node*> chains = {NegChain(g.get(), input, 1),
+                                     NegChain(g.get(), input, 2),
+                                     NegChain(g.get(), input, 3)};
+  const std::vector<string> chain_names = {
+      chains[0]->name(), chains[1]->name(), chains[2]->name()};
+  FixupSourceAndSinkEdges(g.get());
+  Create(std::move(g));
+
+  int num_closures = 0;
+  TF_ASSERT_OK(RunSerially(&num_closures));
+
+  step_stats_collector_.Finalize();
+  std::vector<string> node_names;
+  for (const auto& dev_stats : step_stats_.dev_stats()) {
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      node_names.push_back(node_stats.node_name());
+    }
+  }
+  std::vector<int> positions;
+  for (const string& name : chain_names) {
+    auto it = std::find(node_names.begin(), node_names.end(), name);
+    ASSERT_NE(it, node_names.end()) << name;
+    positions.push_back(it - node_names.begin());
+  }
+  // The longest chain runs first and the shortest one last.
+  EXPECT_LT(positions[2], positions[1]);
+  EXPECT_LT(positions[1], positions[0]);
+}
+
+// Forwards its input after sleeping for a millisecond, without marking itself
+// expensive.
+REGISTER_OP("SlowInexpensive").Input("x: float").Output("y: float");
+
+class SlowInexpensiveOp : public OpKernel {
+ public:
+  explicit SlowInexpensiveOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    Env::Default()->SleepForMicroseconds(1000);
+    ctx->set_output(0, ctx->input(0));
+  }
+
+  bool IsExpensive() override { return false; }
+};
+
+REGISTER_KERNEL_BUILDER(Name("SlowInexpensive").Device(DEVICE_CPU),
+                        SlowInexpensiveOp);
+
+// Returns a graph where a constant feeds two SlowInexpensive nodes. They run
+// inline while they are considered inexpensive, and one of them is dispatched
+// once they are considered expensive.
+std::unique_ptr<Graph> SlowInexpensiveFanOut() {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  Node* input = test::graph::Constant(g.get(), V(1.0));
+  test::graph::Unary(g.get(), "SlowInexpensive", input);
+  test::graph::Unary(g.get(), "SlowInexpensive", input);
+  FixupSourceAndSinkEdges(g.get());
+  return g;
+}
+
+TEST_F(ExecutorTest, MeasuresKernelsWithoutExpensiveMarker) {
+  Create(SlowInexpensiveFanOut());
+  // Nothing is measured before the first run, so both nodes run inline.
+  int inline_closures = 0;
+  TF_ASSERT_OK(RunSerially(&inline_closures));
+
+  // The cost of inexpensive kernels is sampled on ~1/16 of their runs, and a
+  // single sample of a millisecond makes them expensive.
+  int num_closures = inline_closures;
+  for (int i = 0; i < 1000 && num_closures == inline_closures; ++i) {
+    TF_ASSERT_OK(RunSerially(&num_closures));
+  }
+  EXPECT_EQ(num_closures, inline_closures + 1);
+  // Expensive kernels are measured on every run, so they stay expensive.
+  TF_ASSERT_OK(RunSerially(&num_closures));
+  EXPECT_EQ(num_closures, inline_closures + 1);
+}
+
+TEST_F(ExecutorTest, StaticScheduleFreezesMeasuredCosts) {
+  Create(SlowInexpensiveFanOut(), "STATIC_SCHEDULE_EXECUTOR");
+  // The recording run measures every kernel, while running both nodes inline.
+  int inline_closures = 0;
+  TF_ASSERT_OK(RunSerially(&inline_closures));
+
+  // The frozen schedule treats both nodes as expensive from their measured
+  // costs alone.
+  int num_closures = 0;
+  TF_ASSERT_OK(RunSerially(&num_closures));
+  EXPECT_EQ(num_closures, inline_closures + 1);
+}
+
+TEST_F(ExecutorTest, StaticScheduleRunsInexpensiveNodesInOrder) {
+  // A constant feeds two Neg nodes, which start out expensive, and an Add
+  // joins them.
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  Node* input = test::graph::Constant(g.get(), V(1.0));
+  test::graph::Add(g.get(), test::graph::Unary(g.get(), "Neg", input),
+                   test::graph::Unary(g.get(), "Neg", input));
+  FixupSourceAndSinkEdges(g.get());
+  Create(std::move(g), "STATIC_SCHEDULE_EXECUTOR");
+  // The recording run dispatches one of the Neg nodes.
+  int num_closures = 0;
+  TF_ASSERT_OK(RunSerially(&num_closures));
+  EXPECT_GT(num_closures, 1);
+
+  // Every measured kernel is inexpensive, so the frozen schedule runs all the
+  // nodes one after the other from the first closure.
+  for (int i = 0; i < 3; ++i) {
+    TF_ASSERT_OK(RunSerially(&num_closures));
+    EXPECT_EQ(num_closures, 1);
+  }
+}
+
 // Create a graph that is 'depth' deep. At each level, fan-in and fan-out a
 // maximum of 'width' nodes. All nodes are no-ops and all dependencies are
 // control dependencies.
@@ -494,6 +815,50 @@ BENCHMARK(BM_executor)->UseRealTime()->ArgPair(8192, 32);
 // Tall fat graph
 BENCHMARK(BM_executor)->UseRealTime()->ArgPair(1024, 1024);
 
+// Same as BM_executor, but with a graph of relatively expensive identity
+// nodes, which are dispatched to the inter-op thread pool. Compares the default
+// executor against the work stealing executor.
+static void BM_wide_executor(::testing::benchmark::State& state,
+                             const char* executor_type) {
+  const int width = state.range(0);
+  const int depth = state.range(1);
+
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor t(DT_FLOAT, TensorShape({64, 64}));
+  t.flat<float>().setRandom();
+  std::vector<Node*> level(width, test::graph::Constant(g, t));
+  for (int i = 0; i < depth; ++i) {
+    for (int j = 0; j < width; ++j) {
+      level[j] = test::graph::Unary(g, "Square", level[j]);
+    }
+  }
+  FixupSourceAndSinkEdges(g);
+  test::Benchmark("cpu", g, /*options=*/nullptr, /*init=*/nullptr,
+                  /*rendez=*/nullptr, executor_type,
+                  /*old_benchmark_api=*/false)
+      .Run(state);
+  state.SetItemsProcessed(static_cast<int64_t>(width) * depth *
+                          state.iterations());
+}
+
+static void BM_wide_executor_default(::testing::benchmark::State& state) {
+  BM_wide_executor(state, "");
+}
+
+static void BM_wide_executor_work_stealing(
+    ::testing::benchmark::State& state) {
+  BM_wide_executor(state, "WORK_STEALING_EXECUTOR");
+}
+
+static void BM_wide_executor_static_schedule(
+    ::testing::benchmark::State& state) {
+  BM_wide_executor(state, "STATIC_SCHEDULE_EXECUTOR");
+}
+
+BENCHMARK(BM_wide_executor_default)->UseRealTime()->ArgPair(1024, 4);
+BENCHMARK(BM_wide_executor_work_stealing)->UseRealTime()->ArgPair(1024, 4);
+BENCHMARK(BM_wide_executor_static_schedule)->UseRealTime()->ArgPair(1024, 4);
+
 static void BM_const_identity(::testing::benchmark::State& state) {
   const int width = state.range(0);
   const int outputs_per_const = state.range(1);
@@ -521,6 +886,36 @@ BENCHMARK(BM_const_identity)
     ->ArgPair(100, 1)
     ->ArgPair(100, 100);
 
+// Runs `depth` nested loops of `iters` iterations each, whose bodies only
+// count their iterations, to measure the cost of the propagation of the
+// executor for frames and iterations.
+static void BM_NestedLoops(::testing::benchmark::State& state) {
+  const int depth = state.range(0);
+  const int iters = state.range(1);
+
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* start = test::graph::NoOp(g, {});
+  NestedCountingLoops(g, start, depth, iters);
+  FixupSourceAndSinkEdges(g);
+  test::Benchmark("cpu", g, /*old_benchmark_api=*/false).Run(state);
+
+  int64_t num_iterations = 0;
+  int64_t instances = 1;
+  for (int i = 0; i < depth; ++i) {
+    num_iterations += instances * iters;
+    instances *= iters;
+  }
+  state.SetLabel(strings::StrCat("Iterations = ", num_iterations));
+  state.SetItemsProcessed(num_iterations *
+                          static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_NestedLoops)
+    ->UseRealTime()
+    ->ArgPair(1, 1000)
+    ->ArgPair(1, 10000)
+    ->ArgPair(2, 100)
+    ->ArgPair(3, 20);
+
 static void BM_FeedInputFetchOutput(::testing::benchmark::State& state) {
   Graph* g = new Graph(OpRegistry::Global());
   // z = x + y: x and y are provided as benchmark inputs.  z is the
@@ -42,6 +42,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_split.h"
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
@@ -49,9 +50,12 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device/device_event_mgr.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/device_id_utils.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_bfc_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_device.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id_manager.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_ordered_allocator.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
 #include "tensorflow/core/common_runtime/local_device.h"
@@ -62,6 +66,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant_op_registry.h"
+#include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/types.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -87,6 +92,7 @@ limitations under the License.
 #endif  // TF_GPU_USE_PJRT
 #include "xla/stream_executor/gpu/gpu_stream.h"
 #include "xla/stream_executor/platform/dso_loader.h"
+#include "xla/stream_executor/trace_command_buffer_factory.h"
 #include "tensorflow/core/framework/log_memory.h"
 #include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
@@ -113,6 +119,11 @@ namespace tensorflow {
 
 namespace {
 
+// The number of compactions over which the peak memory in use is kept in the
+// allocator, so that steps do not release memory that the next step mallocs
+// again.
+constexpr int kCompactionPeakWindow = 10;
+
 // Returns priority for the given virtual GPU id from the session options.
 // Returns 0 if no virtual devices are specified.
 int GetPriority(const int tf_device_id, const GPUOptions& options) {
@@ -134,6 +145,145 @@ int GetPriority(const int tf_device_id, const GPUOptions& options) {
   return priority;
 }
 
+// Forwards to a device allocator, but only returns deallocated memory to it
+// once the work queued on `stream` at the time of the deallocation is done.
+// Used for the ops on the additional compute streams of a device, since the
+// device allocator is shared by all its streams.
+class StreamDeferredAllocator : public Allocator {
+ public:
+  StreamDeferredAllocator(Allocator* allocator, se::Stream* stream,
+                          EventMgr* em)
+      : allocator_(allocator), stream_(stream), em_(em) {}
+
+  std::string Name() override { return allocator_->Name(); }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return allocator_->AllocateRaw(alignment, num_bytes);
+  }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override {
+    return allocator_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    Allocator* allocator = allocator_;
+    em_->ThenExecute(stream_,
+                     [allocator, ptr]() { allocator->DeallocateRaw(ptr); });
+  }
+
+  bool TracksAllocationSizes() const override {
+    return allocator_->TracksAllocationSizes();
+  }
+
+  size_t RequestedSize(const void* ptr) const override {
+    return allocator_->RequestedSize(ptr);
+  }
+
+  size_t AllocatedSize(const void* ptr) const override {
+    return allocator_->AllocatedSize(ptr);
+  }
+
+  int64_t AllocationId(const void* ptr) const override {
+    return allocator_->AllocationId(ptr);
+  }
+
+  absl::optional<AllocatorStats> GetStats() override {
+    return allocator_->GetStats();
+  }
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return allocator_->GetMemoryType();
+  }
+
+ private:
+  Allocator* const allocator_;  // not owned
+  se::Stream* const stream_;    // not owned
+  EventMgr* const em_;          // not owned
+};
+
+// Returns the StreamDeferredAllocator of `allocator` for `stream`. Tensors
+// allocated by it may outlive the device, so like the streams themselves,
+// these are never deleted.
+Allocator* GetStreamDeferredAllocator(Allocator* allocator, se::Stream* stream,
+                                      EventMgr* em) {
+  static mutex* mu = new mutex;
+  static auto* allocators =
+      new absl::flat_hash_map<std::pair<Allocator*, se::Stream*>,
+                              std::unique_ptr<Allocator>>;
+  mutex_lock l(*mu);
+  std::unique_ptr<Allocator>& deferred = (*allocators)[{allocator, stream}];
+  if (deferred == nullptr) {
+    deferred = std::make_unique<StreamDeferredAllocator>(allocator, stream, em);
+  }
+  return deferred.get();
+}
+
+// Returns the StreamOrderedAllocator of `allocator` for `stream`. The
+// allocators of the streams of a device share one free list, which is flushed
+// whenever `bfc_allocator`, the BFC allocator `allocator` forwards to, runs out
+// of memory. Like the StreamDeferredAllocators, these and their free lists are
+// never deleted.
+Allocator* GetStreamOrderedAllocator(Allocator* allocator,
+                                     tsl::BFCAllocator* bfc_allocator,
+                                     se::Stream* stream, EventMgr* em) {
+  static mutex* mu = new mutex;
+  static auto* free_lists =
+      new absl::flat_hash_map<Allocator*,
+                              std::unique_ptr<StreamOrderedFreeList>>;
+  static auto* allocators =
+      new absl::flat_hash_map<std::pair<Allocator*, se::Stream*>,
+                              std::unique_ptr<Allocator>>;
+  mutex_lock l(*mu);
+  std::unique_ptr<StreamOrderedFreeList>& free_list = (*free_lists)[allocator];
+  if (free_list == nullptr) {
+    free_list = std::make_unique<StreamOrderedFreeList>(allocator, em);
+    StreamOrderedFreeList* list = free_list.get();
+    bfc_allocator->AddOutOfMemoryCallback([list]() { list->Flush(); });
+  }
+  std::unique_ptr<Allocator>& ordered = (*allocators)[{allocator, stream}];
+  if (ordered == nullptr) {
+    ordered = std::make_unique<StreamOrderedAllocator>(
+        allocator, free_list.get(), stream);
+  }
+  return ordered.get();
+}
+
+// The device and allocator of device memory for the op the current thread
+// computes on one of the additional compute streams of a device, or for all
+// the ops it captures with BaseGPUDevice::CaptureOps(), if any.
+struct CurrentOpGpuAllocator {
+  const BaseGPUDevice* device = nullptr;
+  Allocator* allocator = nullptr;
+  bool capturing = false;
+};
+thread_local CurrentOpGpuAllocator current_op_gpu_allocator;
+
+// Sets the allocator of the current op for the lifetime of the object.
+class ScopedCurrentOpGpuAllocator {
+ public:
+  ScopedCurrentOpGpuAllocator(const BaseGPUDevice* device, Allocator* allocator,
+                              bool capturing = false)
+      : saved_(current_op_gpu_allocator) {
+    current_op_gpu_allocator = {device, allocator, capturing};
+  }
+  ~ScopedCurrentOpGpuAllocator() { current_op_gpu_allocator = saved_; }
+
+ private:
+  const CurrentOpGpuAllocator saved_;
+};
+
+std::vector<Tensor> GetInputTensors(OpKernelContext* context) {
+  std::vector<Tensor> inputs;
+  inputs.reserve(context->num_inputs());
+  for (int i = 0; i < context->num_inputs(); ++i) {
+    if (context->has_input(i) && !context->input_is_ref(i)) {
+      inputs.push_back(context->input(i));
+    }
+  }
+  return inputs;
+}
+
 }  // namespace
 
 #if GOOGLE_CUDA
@@ -212,19 +362,24 @@ class EigenGpuStreamDevice : public ::Eigen::StreamInterface {
     return ret;
   }
   void deallocate(void* buffer) const override {
-    if (LogMemory::IsEnabled() && buffer != nullptr) {
-      LogMemory::RecordRawDeallocation(operation_, step_id_, buffer, allocator_,
-                                       true);
-    }
-    AsyncFreeData* afData =
-        new AsyncFreeData(allocator_, buffer, operation_, step_id_);
+    // The stream callback only logs the deallocation once the stream is done,
+    // so it is skipped when memory logging is off. Stream callbacks are also
+    // not supported while the stream is being captured.
+    if (LogMemory::IsEnabled()) {
+      if (buffer != nullptr) {
+        LogMemory::RecordRawDeallocation(operation_, step_id_, buffer,
+                                         allocator_, true);
+      }
+      AsyncFreeData* afData =
+          new AsyncFreeData(allocator_, buffer, operation_, step_id_);
 #if GOOGLE_CUDA
-    cudaError_t err = cudaStreamAddCallback(stream_, asyncLogFree, afData, 0);
-    CHECK_EQ(err, cudaSuccess);
+      cudaError_t err = cudaStreamAddCallback(stream_, asyncLogFree, afData, 0);
+      CHECK_EQ(err, cudaSuccess);
 #elif TENSORFLOW_USE_ROCM
-    hipError_t err = hipStreamAddCallback(stream_, asyncLogFree, afData, 0);
-    CHECK_EQ(err, hipSuccess);
+      hipError_t err = hipStreamAddCallback(stream_, asyncLogFree, afData, 0);
+      CHECK_EQ(err, hipSuccess);
 #endif
+    }
     allocator_->DeallocateRaw(buffer);
   }
 
@@ -482,13 +637,25 @@ BaseGPUDevice::~BaseGPUDevice() {
   delete accelerator_device_info_;
   if (scratch_) gpu_allocator_->DeallocateRaw(scratch_);
   device_context_->Unref();
+  for (ExtraComputeStream& compute_stream : extra_compute_streams_) {
+    if (compute_stream.scratch) {
+      gpu_allocator_->DeallocateRaw(compute_stream.scratch);
+    }
+    compute_stream.device_context->Unref();
+  }
+  if (capture_stream_.scratch) {
+    gpu_allocator_->DeallocateRaw(capture_stream_.scratch);
+  }
+  if (capture_stream_.device_context) capture_stream_.device_context->Unref();
 }
 
 // This should be idempotent if already initialized.
 Status BaseGPUDevice::InitScratchBuffers() {
   mutex_lock l(scratch_init_mutex_);
-  if (!scratch_) {
-    DCHECK(stream_);
+  // Each compute stream has a scratch buffer of its own, since the semaphore
+  // at its end must not be shared by kernels running concurrently.
+  auto init_scratch = [this](char** scratch) -> Status {
+    if (*scratch) return OkStatus();
     size_t scratch_buffer_size = Eigen::kGpuScratchSize + sizeof(unsigned int);
     profiler::ScopedMemoryDebugAnnotation op_annotation("ScratchBuffer");
     void* scratch_buffer = gpu_allocator_->AllocateRaw(
@@ -502,7 +669,16 @@ Status BaseGPUDevice::InitScratchBuffers() {
         se::DeviceMemoryBase(scratch_buffer, scratch_buffer_size));
     TF_RETURN_IF_ERROR(executor_->SynchronousMemZero(
         &mem, Eigen::kGpuScratchSize + sizeof(unsigned int)));
-    scratch_ = static_cast<char*>(scratch_buffer);
+    *scratch = static_cast<char*>(scratch_buffer);
+    return OkStatus();
+  };
+  DCHECK(stream_);
+  TF_RETURN_IF_ERROR(init_scratch(&scratch_));
+  for (ExtraComputeStream& compute_stream : extra_compute_streams_) {
+    TF_RETURN_IF_ERROR(init_scratch(&compute_stream.scratch));
+  }
+  if (capture_stream_.group) {
+    TF_RETURN_IF_ERROR(init_scratch(&capture_stream_.scratch));
   }
   return OkStatus();
 }
@@ -567,6 +743,67 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
 
   em_ = EventMgrFactory::Singleton()->GetEventMgr(executor_,
                                                   options.config.gpu_options());
+  gpu_options_ = options.config.gpu_options();
+
+  const int num_compute_streams =
+      options.config.gpu_options().experimental().num_compute_streams();
+  if (num_compute_streams < 0) {
+    return errors::InvalidArgument(
+        "GPUOptions.experimental.num_compute_streams must not be negative, "
+        "got ",
+        num_compute_streams);
+  }
+#ifdef TF_GPU_USE_PJRT
+  if (num_compute_streams > 1) {
+    return errors::Unimplemented(
+        "GPUOptions.experimental.num_compute_streams > 1 is not supported when "
+        "the streams are managed by PJRT.");
+  }
+#endif  // TF_GPU_USE_PJRT
+  // Stream-ordered reuse only matters with several compute streams, since the
+  // device allocator is already ordered with respect to a single stream.
+  // The free list is returned to the device allocator when it runs out of
+  // memory, which requires a BFC allocator.
+  GPUBFCAllocator* stream_ordered_bfc_allocator = nullptr;
+  if (num_compute_streams > 1 && options.config.gpu_options()
+                                     .experimental()
+                                     .stream_ordered_allocation()) {
+    stream_ordered_bfc_allocator =
+        GPUProcessState::singleton()->GetGPUBFCAllocator(tf_device_id_);
+    if (stream_ordered_bfc_allocator == nullptr ||
+        !gpu_allocator_->TracksAllocationSizes()) {
+      LOG(WARNING) << "Not using stream-ordered allocation on " << name()
+                   << " since its allocator is not a BFC allocator.";
+      stream_ordered_bfc_allocator = nullptr;
+    }
+  }
+  const bool stream_ordered_allocation =
+      stream_ordered_bfc_allocator != nullptr;
+  if (stream_ordered_allocation) {
+    stream_allocator_ = GetStreamOrderedAllocator(
+        gpu_allocator_, stream_ordered_bfc_allocator, stream_->compute, em_);
+  }
+  for (int i = 1; i < num_compute_streams; ++i) {
+    ExtraComputeStream compute_stream;
+    compute_stream.group = StreamGroupFactory::Global().GetOrCreate(
+        tf_device_id_, i, executor_, options.config.gpu_options());
+    compute_stream.device_context = new GPUDeviceContext(
+        i, compute_stream.group->compute,
+#if TENSORFLOW_USE_ROCM
+        compute_stream.group->nccl,
+#endif
+        compute_stream.group->host_to_device,
+        compute_stream.group->device_to_host,
+        compute_stream.group->device_to_device, host_memory_allocator);
+    compute_stream.allocator =
+        stream_ordered_allocation
+            ? GetStreamOrderedAllocator(gpu_allocator_,
+                                        stream_ordered_bfc_allocator,
+                                        compute_stream.group->compute, em_)
+            : GetStreamDeferredAllocator(gpu_allocator_,
+                                         compute_stream.group->compute, em_);
+    extra_compute_streams_.push_back(compute_stream);
+  }
 
   GPUKernelTracker::Params tracker_params(
       options.config.gpu_options().experimental().kernel_tracker_max_interval(),
@@ -574,6 +811,18 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
       options.config.gpu_options().experimental().kernel_tracker_max_pending());
   timestamped_allocator_ =
       options.config.gpu_options().experimental().timestamped_allocator();
+  compaction_fragmentation_threshold_ =
+      options.config.gpu_options()
+          .experimental()
+          .memory_compaction_fragmentation_threshold();
+  if (compaction_fragmentation_threshold_ > 0) {
+    bfc_allocator_ = GPUProcessState::singleton()->GetGPUBFCAllocator(
+        tf_device_id_);
+    if (bfc_allocator_ == nullptr) {
+      LOG(WARNING) << "Not compacting the memory of " << name()
+                   << " since its allocator is not a BFC allocator.";
+    }
+  }
   pending_cap_ = tracker_params.max_pending;
   if (timestamped_allocator_ ||
       (tracker_params.max_interval > 0 || tracker_params.max_bytes > 0 ||
@@ -799,7 +1048,32 @@ void BaseGPUDevice::Compute(OpKernel* op_kernel, OpKernelContext* context) {
     LogInputs(op_kernel, context);
   }
 
-  op_kernel->Compute(context);
+  // Ops that run on, or consume the outputs of, the additional compute
+  // streams are ordered after the work they depend on, and keep their inputs
+  // alive until their own stream is done with them.
+  const bool uses_other_streams =
+      stream_id > 0 || context->wait_device_contexts() != nullptr;
+  if (uses_other_streams) {
+    Status s = WaitForComputeStreams(context, stream, stream_id);
+    if (!s.ok()) {
+      context->SetStatus(s);
+      return;
+    }
+  }
+
+  Allocator* stream_allocator =
+      stream_id > 0 ? extra_compute_streams_[stream_id - 1].allocator
+                    : stream_allocator_;
+  if (stream_allocator != nullptr) {
+    ScopedCurrentOpGpuAllocator scoped_allocator(this, stream_allocator);
+    op_kernel->Compute(context);
+  } else {
+    op_kernel->Compute(context);
+  }
+
+  if (uses_other_streams) {
+    KeepAliveUntilStreamDone(stream, GetInputTensors(context));
+  }
 
   if (should_log_inputs_and_outputs) {
     LogOutputs(op_kernel, context);
@@ -820,7 +1094,8 @@ void BaseGPUDevice::Compute(OpKernel* op_kernel, OpKernelContext* context) {
       VLOG(1) << "GpuDevice::ComputeHelper scheduled "
               << ComputeOpKernelDebugString(*op_kernel, stream_id);
     }
-    if (kernel_tracker_) {
+    // The kernel tracker only follows the progress of the first stream.
+    if (kernel_tracker_ && stream_id == 0) {
       GPUKernelTracker* tracker = kernel_tracker_.get();
       DCHECK(tracker);
       uint64 queued_count = tracker->MaybeQueue(context);
@@ -854,7 +1129,21 @@ Status BaseGPUDevice::Sync() {
   // enqueued the operation has completed.  We do use other streams for copies
   // and collectives, but in those cases the (Async)OpKernels themselves block
   // until the queued operation has finished.
-  return stream_->compute->BlockHostUntilDone();
+  for (const ExtraComputeStream& compute_stream : extra_compute_streams_) {
+    TF_RETURN_IF_ERROR(compute_stream.group->compute->BlockHostUntilDone());
+  }
+  TF_RETURN_IF_ERROR(stream_->compute->BlockHostUntilDone());
+  // The end of a step is the best time to compact the allocator, since most
+  // of the memory of the step has been freed.
+  if (bfc_allocator_ != nullptr &&
+      bfc_allocator_->GetFreeMemoryStats().fragmentation >
+          compaction_fragmentation_threshold_) {
+    const size_t released_bytes =
+        bfc_allocator_->Compact(kCompactionPeakWindow);
+    VLOG(1) << "Compacted the allocator of " << name() << ", releasing "
+            << strings::HumanReadableNumBytes(released_bytes);
+  }
+  return OkStatus();
 }
 
 void BaseGPUDevice::ComputeAsync(AsyncOpKernel* op_kernel,
@@ -885,6 +1174,24 @@ void BaseGPUDevice::ComputeAsync(AsyncOpKernel* op_kernel,
   }
 
   ScopedActivateExecutorContext scoped_activation{stream->parent()};
+
+  // Asynchronous kernels always run on the first stream, but may consume the
+  // outputs of ops on the other streams.
+  if (context->wait_device_contexts() != nullptr) {
+    Status s = WaitForComputeStreams(context, stream, stream_id);
+    if (!s.ok()) {
+      context->SetStatus(s);
+      done();
+      return;
+    }
+    AsyncOpKernel::DoneCallback parent_done = std::move(done);
+    done = [this, stream, inputs = GetInputTensors(context),
+            parent_done = std::move(parent_done)]() {
+      KeepAliveUntilStreamDone(stream, inputs);
+      parent_done();
+    };
+  }
+
   op_kernel->ComputeAsync(context, std::move(done));
 }
 
@@ -1289,11 +1596,29 @@ void BaseGPUDevice::ReinitializeDevice(OpKernelContext* context,
   ConcretePerOpGpuDevice* concrete_device =
       static_cast<ConcretePerOpGpuDevice*>(device);
   DCHECK(concrete_device);
-  DCHECK_EQ(stream_id, 0);
-  const gpuStream_t gpu_stream = reinterpret_cast<gpuStream_t>(
-      stream_->compute->platform_specific_handle().stream);
+  DCHECK_GE(stream_id, kCaptureStreamId);
+  DCHECK_LE(stream_id, static_cast<int>(extra_compute_streams_.size()));
+  se::Stream* compute = stream_->compute;
+  char* scratch = scratch_;
+  if (stream_id == kCaptureStreamId) {
+    // The allocator already is the one CaptureOps() was called with.
+    compute = capture_stream_.group->compute;
+    scratch = capture_stream_.scratch;
+  } else if (stream_id > 0) {
+    // The temporary buffers of Eigen must not be reused before the stream is
+    // done with them either.
+    const ExtraComputeStream& compute_stream =
+        extra_compute_streams_[stream_id - 1];
+    compute = compute_stream.group->compute;
+    scratch = compute_stream.scratch;
+    allocator = compute_stream.allocator;
+  } else if (stream_allocator_ != nullptr && allocator == gpu_allocator_) {
+    allocator = stream_allocator_;
+  }
+  const gpuStream_t gpu_stream =
+      reinterpret_cast<gpuStream_t>(compute->platform_specific_handle().stream);
   concrete_device->Reinitialize(context, gpu_stream, tf_device_id_, allocator,
-                                scratch_);
+                                scratch);
 }
 
 PerOpGpuDevice* BaseGPUDevice::MakeGpuDevice() {
@@ -1310,7 +1635,6 @@ Status BaseGPUDevice::ReinitializeGpuDevice(OpKernelContext* context,
     const int stream_id = gpu_dc->stream_id();
     VLOG(1) << "  eigen_gpu_device(" << dc << ") => stream[" << stream_id
             << "]";
-    CHECK_EQ(stream_id, 0);
     ReinitializeDevice(context, device, stream_id, allocator);
   } else {
     ReinitializeDevice(context, device, 0, allocator);
@@ -1318,6 +1642,118 @@ Status BaseGPUDevice::ReinitializeGpuDevice(OpKernelContext* context,
   return OkStatus();
 }
 
+Status BaseGPUDevice::FillContextMap(
+    const Graph* graph, std::vector<DeviceContext*>* device_context_map) {
+  if (extra_compute_streams_.empty()) return OkStatus();
+  const std::vector<int> stream_ids = gpu_stream_util::AssignStreams(
+      *graph, extra_compute_streams_.size() + 1);
+  device_context_map->assign(graph->num_node_ids(), nullptr);
+  for (const Node* n : graph->op_nodes()) {
+    const int stream_id = stream_ids[n->id()];
+    if (stream_id > 0) {
+      (*device_context_map)[n->id()] =
+          extra_compute_streams_[stream_id - 1].device_context;
+    }
+  }
+  return OkStatus();
+}
+
+Status BaseGPUDevice::TryGetDeviceContext(DeviceContext** out_context) {
+  if (current_op_gpu_allocator.device == this &&
+      current_op_gpu_allocator.capturing) {
+    capture_stream_.device_context->Ref();
+    *out_context = capture_stream_.device_context;
+  } else {
+    *out_context = nullptr;
+  }
+  return OkStatus();
+}
+
+bool BaseGPUDevice::SupportsOpCapture() const {
+#ifdef TF_GPU_USE_PJRT
+  return false;
+#else
+  return extra_compute_streams_.empty() && kernel_tracker_ == nullptr &&
+         !sync_every_op_ && !LogMemory::IsEnabled();
+#endif  // TF_GPU_USE_PJRT
+}
+
+absl::StatusOr<std::unique_ptr<se::CommandBuffer>> BaseGPUDevice::CaptureOps(
+    Allocator* allocator, absl::AnyInvocable<Status()> fn) {
+  if (!SupportsOpCapture()) {
+    return errors::FailedPrecondition("Device ", name(),
+                                      " does not support capturing ops.");
+  }
+  // Only one thread at a time may record on the capture stream.
+  mutex_lock l(capture_mu_);
+  {
+    mutex_lock scratch_lock(scratch_init_mutex_);
+    if (capture_stream_.group == nullptr) {
+      // Stream group 0 holds the compute stream, and the groups after it
+      // are free since there are no additional compute streams.
+      capture_stream_.group = StreamGroupFactory::Global().GetOrCreate(
+          tf_device_id_, 1, executor_, gpu_options_);
+      capture_stream_.device_context = new GPUDeviceContext(
+          kCaptureStreamId, capture_stream_.group->compute,
+#if TENSORFLOW_USE_ROCM
+          capture_stream_.group->nccl,
+#endif
+          capture_stream_.group->host_to_device,
+          capture_stream_.group->device_to_host,
+          capture_stream_.group->device_to_device,
+          device_context_->host_memory_allocator());
+    }
+  }
+  TF_RETURN_IF_ERROR(InitScratchBuffers());
+
+  ScopedCurrentOpGpuAllocator scoped_allocator(this, allocator,
+                                               /*capturing=*/true);
+  return se::TraceCommandBufferFactory::Create(
+      executor_, capture_stream_.group->compute,
+      [&fn](se::Stream*) { return fn(); }, se::CommandBuffer::Mode::kPrimary);
+}
+
+Status BaseGPUDevice::SubmitCommandBuffer(
+    const se::CommandBuffer& command_buffer) {
+  return executor_->Submit(stream_->compute, command_buffer);
+}
+
+Allocator* BaseGPUDevice::GetGpuAllocatorForCurrentOp() const {
+  if (current_op_gpu_allocator.device == this) {
+    return current_op_gpu_allocator.allocator;
+  }
+  return gpu_allocator_;
+}
+
+Status BaseGPUDevice::WaitForComputeStreams(OpKernelContext* context,
+                                            se::Stream* stream,
+                                            int stream_id) {
+  // An op on another stream may reuse memory freed by any op of the first
+  // stream, so it starts after all the work queued there so far.
+  if (stream_id > 0) {
+    TF_RETURN_IF_ERROR(stream->WaitFor(stream_->compute));
+  }
+  const auto* wait_contexts = context->wait_device_contexts();
+  if (wait_contexts == nullptr) return OkStatus();
+  for (DeviceContext* dc : *wait_contexts) {
+    se::Stream* wait_stream =
+        dc == nullptr ? stream_->compute
+                      : static_cast<GPUDeviceContext*>(dc)->stream();
+    if (wait_stream == stream ||
+        (stream_id > 0 && wait_stream == stream_->compute)) {
+      continue;
+    }
+    TF_RETURN_IF_ERROR(stream->WaitFor(wait_stream));
+  }
+  return OkStatus();
+}
+
+void BaseGPUDevice::KeepAliveUntilStreamDone(se::Stream* stream,
+                                             std::vector<Tensor> tensors) {
+  if (tensors.empty()) return;
+  em_->ThenExecute(stream, [tensors = std::move(tensors)]() {});
+}
+
 Allocator* BaseGPUDevice::GetScopedAllocator(AllocatorAttributes attr,
                                              int64_t step_id) {
   if (attr.scope_id > 0) {
@@ -35,7 +35,10 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/functional/any_invocable.h"
+#include "absl/status/statusor.h"
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "xla/stream_executor/command_buffer.h"
 #ifdef TF_GPU_USE_PJRT
 #include "tensorflow/compiler/jit/pjrt_device_context.h"
 #include "tensorflow/compiler/tf2xla/layout_util.h"
@@ -67,6 +70,7 @@ class StreamInterface;
 }
 
 namespace tensorflow {
+class GPUBFCAllocator;
 class GPUKernelTracker;
 
 class ConcretePerOpGpuDevice : public PerOpGpuDevice {
@@ -139,6 +143,34 @@ class BaseGPUDevice : public LocalDevice {
                                DeviceContext* dc,
                                Allocator* allocator) override;
 
+  // Assigns the ops of `graph` to the compute streams of this device if
+  // GPUOptions.experimental.num_compute_streams is greater than 1.
+  Status FillContextMap(
+      const Graph* graph,
+      std::vector<DeviceContext*>* device_context_map) override;
+
+  // Returns the context of the capture stream while the calling thread runs
+  // the function passed to CaptureOps(), and nullptr otherwise.
+  Status TryGetDeviceContext(DeviceContext** out_context) override;
+
+  // Returns true if CaptureOps() is supported with the options of this device,
+  // i.e. with a single compute stream, and without kernel tracking or memory
+  // logging.
+  bool SupportsOpCapture() const;
+
+  // Records the GPU work that `fn` queues on this device from the calling
+  // thread into a command buffer (e.g. a CUDA graph), without running it.
+  // The executors that `fn` creates run their ops on a dedicated capture
+  // stream, and allocate device memory from `allocator`, so the memory must
+  // stay valid for as long as the command buffer is used. Fails if `fn` fails,
+  // or if it does anything stream capture does not support, such as
+  // synchronizing with the device.
+  absl::StatusOr<std::unique_ptr<se::CommandBuffer>> CaptureOps(
+      Allocator* allocator, absl::AnyInvocable<Status()> fn);
+
+  // Queues the work recorded in `command_buffer` on the compute stream.
+  Status SubmitCommandBuffer(const se::CommandBuffer& command_buffer);
+
   // Returns the platform GPU id of this device within the native driver system;
   // e.g., for CUDA and ROCm this is the ordinal of the GPU within the system.
   int gpu_id() const {
@@ -200,6 +232,12 @@ class BaseGPUDevice : public LocalDevice {
   se::StreamExecutor* executor_;  // not owned
   std::unique_ptr<ScopedAllocatorMgr> scoped_allocator_mgr_;
 
+  // Returns the allocator of device memory for the calling thread. While the
+  // thread computes an op on one of the additional compute streams, this
+  // defers deallocations until the stream has passed the point where they
+  // were requested; otherwise it is `gpu_allocator_`.
+  Allocator* GetGpuAllocatorForCurrentOp() const;
+
  private:
   friend class GPUDeviceTestHelper;
   class StreamGroupFactory;
@@ -209,6 +247,25 @@ class BaseGPUDevice : public LocalDevice {
   mutex scratch_init_mutex_;
   char* scratch_ = nullptr;
   GPUDeviceContext* device_context_;
+  // The compute streams other than `stream_`, present if
+  // GPUOptions.experimental.num_compute_streams is greater than 1. The stream
+  // with id i > 0 is extra_compute_streams_[i - 1].
+  struct ExtraComputeStream {
+    StreamGroup* group = nullptr;
+    GPUDeviceContext* device_context = nullptr;
+    char* scratch = nullptr;
+    Allocator* allocator = nullptr;  // not owned
+  };
+  std::vector<ExtraComputeStream> extra_compute_streams_;
+  // The allocator of the synchronous ops on `stream_` if
+  // GPUOptions.experimental.stream_ordered_allocation is set, and otherwise
+  // nullptr.
+  Allocator* stream_allocator_ = nullptr;  // not owned
+  // The stream CaptureOps() records ops on, created on first use. Its
+  // allocator is unused, since the caller of CaptureOps() provides one.
+  static constexpr int kCaptureStreamId = -1;
+  mutex capture_mu_;
+  ExtraComputeStream capture_stream_;
   DeviceBase::AcceleratorDeviceInfo* accelerator_device_info_ = nullptr;
   mutex trace_mu_;
   tsl::TfDeviceId tf_device_id_;
@@ -218,8 +275,14 @@ class BaseGPUDevice : public LocalDevice {
   std::unique_ptr<GPUKernelTracker> kernel_tracker_;
   int32 pending_cap_ = 0;
   bool timestamped_allocator_ = false;
+  // If set, the allocator is compacted at the end of Sync() when its
+  // fragmentation is above compaction_fragmentation_threshold_.
+  GPUBFCAllocator* bfc_allocator_ = nullptr;  // not owned
+  double compaction_fragmentation_threshold_ = 0;
   NodeFileWriter* node_file_writer_ = nullptr;  // not owned
   const GPUOptions::Experimental::StreamMergeOptions stream_merge_options_;
+  // The options the device was initialized with, to create the capture stream.
+  GPUOptions gpu_options_;
 
   // Initialize scratch buffers used by Eigen.
   Status InitScratchBuffers();
@@ -227,6 +290,15 @@ class BaseGPUDevice : public LocalDevice {
   void ReinitializeDevice(OpKernelContext* context, PerOpGpuDevice* device,
                           int stream_id, Allocator* allocator);
 
+  // Makes `stream`, the compute stream `stream_id` of the op of `context`,
+  // wait for the work of the other compute streams the op depends on.
+  Status WaitForComputeStreams(OpKernelContext* context, se::Stream* stream,
+                               int stream_id);
+
+  // Keeps `tensors` alive until the work currently queued on `stream` is done.
+  void KeepAliveUntilStreamDone(se::Stream* stream,
+                                std::vector<Tensor> tensors);
+
   std::string ComputeOpKernelDebugString(const OpKernel& op_kernel,
                                          const int& stream_id);
 
@@ -52,7 +52,7 @@ class GPUDevice : public BaseGPUDevice {
         return cpu_allocator_;
       }
     } else {
-      return gpu_allocator_;
+      return GetGpuAllocatorForCurrentOp();
     }
   }
 
@@ -0,0 +1,369 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_graph_capture_executor.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_device.h"
+#include "tensorflow/core/common_runtime/gpu_device_context.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/memory_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/util/env_var.h"
+#include "tsl/platform/statusor.h"
+
+namespace tensorflow {
+namespace {
+
+// Forwards allocations to `allocator`, but only returns the memory to it when
+// destroyed, so that the buffers used by a captured step stay valid for as long
+// as its command buffer is replayed.
+class RetainingAllocator : public Allocator {
+ public:
+  explicit RetainingAllocator(Allocator* allocator) : allocator_(allocator) {}
+
+  ~RetainingAllocator() override {
+    for (void* ptr : ptrs_) allocator_->DeallocateRaw(ptr);
+  }
+
+  std::string Name() override {
+    return absl::StrCat("retaining_", allocator_->Name());
+  }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    void* ptr = allocator_->AllocateRaw(alignment, num_bytes);
+    if (ptr != nullptr) {
+      mutex_lock l(mu_);
+      ptrs_.push_back(ptr);
+    }
+    return ptr;
+  }
+
+  void DeallocateRaw(void* ptr) override {}
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return allocator_->GetMemoryType();
+  }
+
+ private:
+  Allocator* const allocator_;  // not owned
+  mutex mu_;
+  std::vector<void*> ptrs_ TF_GUARDED_BY(mu_);
+};
+
+// The call frame of the captured step, which reads the arguments from buffers
+// that are refilled before each replay, and records the results.
+class CaptureCallFrame : public CallFrameInterface {
+ public:
+  CaptureCallFrame(const std::vector<Tensor>* args,
+                   std::vector<Tensor>* retvals)
+      : args_(args), retvals_(retvals) {}
+
+  size_t num_args() const override { return args_->size(); }
+  size_t num_retvals() const override { return retvals_->size(); }
+
+  Status GetArg(int index, const Tensor** val) override {
+    if (index < 0 || index >= static_cast<int>(args_->size())) {
+      return errors::InvalidArgument("Argument ", index, " is out of range.");
+    }
+    *val = &(*args_)[index];
+    return OkStatus();
+  }
+
+  Status SetRetval(int index, const Tensor& val) override {
+    if (index < 0 || index >= static_cast<int>(retvals_->size())) {
+      return errors::InvalidArgument("Return value ", index,
+                                     " is out of range.");
+    }
+    (*retvals_)[index] = val;
+    return OkStatus();
+  }
+
+ private:
+  const std::vector<Tensor>* const args_;  // not owned
+  std::vector<Tensor>* const retvals_;     // not owned
+};
+
+// Returns OkStatus() if the steps of `graph` can be replayed from a command
+// buffer, i.e. if nothing they do depends on the host or on state outside of
+// their arguments.
+Status ValidateGraphIsCapturable(const Device& device, const Graph& graph) {
+  const DeviceType device_type(device.device_type());
+  for (const Node* n : graph.op_nodes()) {
+    if (n->IsSend() || n->IsRecv() || n->IsControlFlow() ||
+        n->IsFunctionCall()) {
+      return errors::Unimplemented("Node ", n->name(), " of type ",
+                                   n->type_string(), " is not supported.");
+    }
+    if (n->op_def().is_stateful() && !n->IsArg() && !n->IsRetval()) {
+      return errors::Unimplemented("Stateful node ", n->name(), " of type ",
+                                   n->type_string(), " is not supported.");
+    }
+    for (DataType dtype : n->output_types()) {
+      if (IsRefType(dtype) || dtype == DT_RESOURCE) {
+        return errors::Unimplemented("Node ", n->name(), " has an output of ",
+                                     DataTypeString(dtype), " type.");
+      }
+    }
+    if (!n->IsArg() && !n->IsRetval()) continue;
+    MemoryTypeVector input_memory_types;
+    MemoryTypeVector output_memory_types;
+    TF_RETURN_IF_ERROR(MemoryTypesForNode(graph.op_registry(), device_type,
+                                          n->def(), &input_memory_types,
+                                          &output_memory_types));
+    const MemoryTypeVector& memory_types =
+        n->IsArg() ? output_memory_types : input_memory_types;
+    for (MemoryType memory_type : memory_types) {
+      if (memory_type != DEVICE_MEMORY) {
+        return errors::Unimplemented("Node ", n->name(),
+                                     " has a value in host memory.");
+      }
+    }
+  }
+  return OkStatus();
+}
+
+int64_t GetWarmupSteps() {
+  static const int64_t warmup_steps = [] {
+    int64_t steps;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_GPU_GRAPH_CAPTURE_WARMUP_STEPS",
+                                    /*default_val=*/2, &steps));
+    return steps;
+  }();
+  return warmup_steps;
+}
+
+se::DeviceMemoryBase AsDeviceMemory(const Tensor& t) {
+  return se::DeviceMemoryBase(const_cast<char*>(t.tensor_data().data()),
+                              t.TotalBytes());
+}
+
+class GpuGraphCaptureExecutor : public Executor {
+ public:
+  GpuGraphCaptureExecutor(BaseGPUDevice* device,
+                          std::unique_ptr<Executor> executor)
+      : device_(device), executor_(std::move(executor)) {}
+
+ private:
+  // The arguments a step was captured with, and what replaying it requires.
+  struct CapturedStep {
+    std::unique_ptr<RetainingAllocator> allocator;
+    std::vector<Tensor> args;
+    std::vector<Tensor> retvals;
+    std::unique_ptr<se::CommandBuffer> command_buffer;
+  };
+  using Signature = std::vector<std::pair<DataType, TensorShape>>;
+
+  void RunAsyncInternal(const Args& args, DoneCallback done) override {
+    Signature signature;
+    if (device_ == nullptr || args.call_frame == nullptr ||
+        !GetSignature(args.call_frame, &signature).ok()) {
+      executor_->RunAsync(args, std::move(done));
+      return;
+    }
+
+    Status s;
+    bool replayed;
+    {
+      mutex_lock l(mu_);
+      replayed = MaybeReplay(args, std::move(signature), &s);
+    }
+    if (replayed) {
+      done(s);
+    } else {
+      executor_->RunAsync(args, std::move(done));
+    }
+  }
+
+  // Replays the step of `args` with arguments `signature` and sets `*status`,
+  // capturing it first if needed. Returns false if the step must be run by the
+  // regular executor instead.
+  bool MaybeReplay(const Args& args, Signature signature, Status* status)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (capture_failed_) return false;
+    if (signature != signature_) {
+      signature_ = std::move(signature);
+      num_matching_steps_ = 0;
+      captured_step_.reset();
+    }
+    if (captured_step_ == nullptr) {
+      if (num_matching_steps_ < GetWarmupSteps()) {
+        ++num_matching_steps_;
+        return false;
+      }
+      Status s = Capture(args);
+      if (!s.ok()) {
+        VLOG(1) << "Running the graph without capturing it on "
+                << device_->name() << ": " << s;
+        capture_failed_ = true;
+        return false;
+      }
+    }
+    *status = Replay(args);
+    return true;
+  }
+
+  static Status GetSignature(CallFrameInterface* call_frame,
+                             Signature* signature) {
+    signature->reserve(call_frame->num_args());
+    for (int i = 0; i < static_cast<int>(call_frame->num_args()); ++i) {
+      const Tensor* arg;
+      TF_RETURN_IF_ERROR(call_frame->GetArg(i, &arg));
+      signature->emplace_back(arg->dtype(), arg->shape());
+    }
+    return OkStatus();
+  }
+
+  // Records a step with the arguments of `args` into `captured_step_`,
+  // without running it.
+  Status Capture(const Args& args) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    auto step = std::make_unique<CapturedStep>();
+    step->allocator = std::make_unique<RetainingAllocator>(
+        device_->GetAllocator(AllocatorAttributes()));
+    for (const auto& [dtype, shape] : signature_) {
+      step->args.emplace_back(step->allocator.get(), dtype, shape);
+      if (!step->args.back().IsInitialized()) {
+        return errors::ResourceExhausted(
+            "Failed to allocate an argument of the captured step.");
+      }
+    }
+    step->retvals.resize(args.call_frame->num_retvals());
+
+    CaptureCallFrame call_frame(&step->args, &step->retvals);
+    Args capture_args = args;
+    capture_args.call_frame = &call_frame;
+    capture_args.stats_collector = nullptr;
+    capture_args.sync_on_finish = false;
+    // All the kernels must be launched from this thread to be captured.
+    capture_args.runner = [](Args::Closure c) { c(); };
+    capture_args.run_all_kernels_inline = true;
+    TF_ASSIGN_OR_RETURN(step->command_buffer,
+                        device_->CaptureOps(step->allocator.get(), [&]() {
+                          return executor_->Run(capture_args);
+                        }));
+    for (const Tensor& retval : step->retvals) {
+      if (!retval.IsInitialized()) {
+        return errors::Internal("A return value was not set while capturing.");
+      }
+    }
+    captured_step_ = std::move(step);
+    return OkStatus();
+  }
+
+  // Runs the step of `args` by copying its arguments into the buffers of the
+  // captured step, submitting the command buffer, and copying out the results.
+  Status Replay(const Args& args) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    se::Stream* stream = static_cast<const GPUDeviceContext*>(
+                             device_->tensorflow_accelerator_device_info()
+                                 ->default_context)
+                             ->stream();
+    for (int i = 0; i < static_cast<int>(captured_step_->args.size()); ++i) {
+      const Tensor* arg;
+      TF_RETURN_IF_ERROR(args.call_frame->GetArg(i, &arg));
+      if (arg->TotalBytes() == 0) continue;
+      se::DeviceMemoryBase dst = AsDeviceMemory(captured_step_->args[i]);
+      TF_RETURN_IF_ERROR(
+          stream->MemcpyD2D(&dst, AsDeviceMemory(*arg), arg->TotalBytes()));
+    }
+    TF_RETURN_IF_ERROR(
+        device_->SubmitCommandBuffer(*captured_step_->command_buffer));
+
+    Allocator* allocator = device_->GetAllocator(AllocatorAttributes());
+    for (int i = 0; i < static_cast<int>(captured_step_->retvals.size());
+         ++i) {
+      const Tensor& captured = captured_step_->retvals[i];
+      Tensor retval(allocator, captured.dtype(), captured.shape());
+      if (!retval.IsInitialized()) {
+        return errors::ResourceExhausted(
+            "Failed to allocate return value ", i, " with shape ",
+            captured.shape().DebugString());
+      }
+      if (retval.TotalBytes() > 0) {
+        se::DeviceMemoryBase dst = AsDeviceMemory(retval);
+        TF_RETURN_IF_ERROR(stream->MemcpyD2D(&dst, AsDeviceMemory(captured),
+                                             retval.TotalBytes()));
+      }
+      TF_RETURN_IF_ERROR(args.call_frame->SetRetval(i, retval));
+    }
+    if (args.sync_on_finish) {
+      TF_RETURN_IF_ERROR(device_->Sync());
+    }
+    return OkStatus();
+  }
+
+  // The device, if the graph can be captured on it, and otherwise nullptr.
+  BaseGPUDevice* const device_;  // not owned
+  const std::unique_ptr<Executor> executor_;
+
+  mutex mu_;
+  bool capture_failed_ TF_GUARDED_BY(mu_) = false;
+  Signature signature_ TF_GUARDED_BY(mu_);
+  int64_t num_matching_steps_ TF_GUARDED_BY(mu_) = 0;
+  std::unique_ptr<CapturedStep> captured_step_ TF_GUARDED_BY(mu_);
+};
+
+class GpuGraphCaptureExecutorRegistrar {
+ public:
+  GpuGraphCaptureExecutorRegistrar() {
+    ExecutorFactory::Register(kGpuGraphCaptureExecutor, new Factory());
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      return NewGpuGraphCaptureExecutor(params, graph, out_executor);
+    }
+  };
+};
+static GpuGraphCaptureExecutorRegistrar registrar;
+
+}  // namespace
+
+Status NewGpuGraphCaptureExecutor(const LocalExecutorParams& params,
+                                  const Graph& graph,
+                                  std::unique_ptr<Executor>* executor) {
+  Executor* local_executor;
+  TF_RETURN_IF_ERROR(NewLocalExecutor(params, graph, &local_executor));
+  auto* device = dynamic_cast<BaseGPUDevice*>(params.device);
+  if (device != nullptr && !device->SupportsOpCapture()) {
+    VLOG(1) << "Device " << device->name() << " does not support capture.";
+    device = nullptr;
+  }
+  if (device != nullptr) {
+    Status s = ValidateGraphIsCapturable(*device, graph);
+    if (!s.ok()) {
+      VLOG(1) << "The graph is not captured on " << device->name() << ": "
+              << s;
+      device = nullptr;
+    }
+  }
+  *executor = std::make_unique<GpuGraphCaptureExecutor>(
+      device, std::unique_ptr<Executor>(local_executor));
+  return OkStatus();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,59 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_GRAPH_CAPTURE_EXECUTOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_GRAPH_CAPTURE_EXECUTOR_H_
+
+#include <memory>
+
+#include "tensorflow/core/common_runtime/executor.h"
+#include "tensorflow/core/common_runtime/local_executor_params.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+
+// The executor type, as set in ConfigProto.experimental.executor_type, of the
+// executor created by NewGpuGraphCaptureExecutor().
+inline constexpr char kGpuGraphCaptureExecutor[] = "GPU_GRAPH_CAPTURE";
+
+// Creates an `Executor` for `graph` that, once the shapes and types of its
+// arguments have been the same for a number of steps (2 by default, set with
+// the TF_GPU_GRAPH_CAPTURE_WARMUP_STEPS environment variable), records the GPU
+// work of a step into a command buffer (e.g. a CUDA graph) and replays it for
+// the following steps with the same arguments, which avoids launching each
+// kernel from the host.
+//
+// Steps are run by a regular executor instead if:
+//
+// 1. The device is not a GPU device, or does not support capturing ops (see
+//    BaseGPUDevice::SupportsOpCapture()).
+// 2. The graph contains Send/Recv, control flow, function call, stateful or
+//    resource ops, or reference-typed tensors, or has arguments or results in
+//    host memory.
+// 3. The step is not run with a call frame, or its arguments differ from those
+//    of the captured step.
+// 4. Capturing the graph fails, e.g. because a kernel synchronizes with the
+//    device. The graph is not captured again in this case.
+//
+// The memory of the captured step is kept for as long as its command buffer
+// is replayed, and replayed steps are serialized.
+Status NewGpuGraphCaptureExecutor(const LocalExecutorParams& params,
+                                  const Graph& graph,
+                                  std::unique_ptr<Executor>* executor);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_GRAPH_CAPTURE_EXECUTOR_H_
@@ -0,0 +1,177 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if (defined(GOOGLE_CUDA) && GOOGLE_CUDA) || \
+    (defined(TENSORFLOW_USE_ROCM) && TENSORFLOW_USE_ROCM)
+
+#include "tensorflow/core/common_runtime/gpu/gpu_graph_capture_executor.h"
+
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/executor.h"
+#include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+// The default of TF_GPU_GRAPH_CAPTURE_WARMUP_STEPS.
+constexpr int kWarmupSteps = 2;
+
+class GpuGraphCaptureExecutorTest : public ::testing::Test {
+ protected:
+  GpuGraphCaptureExecutorTest()
+      : device_(DeviceFactory::NewDevice("GPU", SessionOptions(),
+                                         "/job:a/replica:0/task:0")) {}
+
+  // Creates `exec_` for a graph that negates its argument. If `stateful` is
+  // true, the graph also has a stateful node, which must not be captured.
+  void Create(bool stateful) {
+    auto g = std::make_unique<Graph>(OpRegistry::Global());
+    Node* arg = test::graph::Arg(g.get(), 0, DT_FLOAT);
+    test::graph::Retval(g.get(), 0, test::graph::Unary(g.get(), "Neg", arg));
+    if (stateful) {
+      test::graph::RandomUniform(
+          g.get(), test::graph::Constant(g.get(), test::AsTensor<int32>({4})),
+          DT_FLOAT);
+    }
+    FixupSourceAndSinkEdges(g.get());
+
+    const int version = g->versions().producer();
+    LocalExecutorParams params;
+    params.device = device_.get();
+    params.create_kernel =
+        [this, version](const std::shared_ptr<const NodeProperties>& props,
+                        OpKernel** kernel) {
+          return CreateNonCachedKernel(device_.get(), nullptr, props, version,
+                                       kernel);
+        };
+    params.delete_kernel = [](OpKernel* kernel) {
+      DeleteNonCachedKernel(kernel);
+    };
+    TF_ASSERT_OK(NewGpuGraphCaptureExecutor(params, *g, &exec_));
+  }
+
+  // Runs a step with argument `x`, and returns its result in `*y`. Sets
+  // `*ran_kernels` to whether the kernels of the graph ran, i.e. whether the
+  // step was run by the regular executor rather than replayed.
+  void RunStep(const Tensor& x, Tensor* y, bool* ran_kernels) {
+    DeviceContext* device_context =
+        device_->tensorflow_accelerator_device_info()->default_context;
+    Tensor device_x(device_->GetAllocator(AllocatorAttributes()), x.dtype(),
+                    x.shape());
+    TF_ASSERT_OK(device_context->CopyCPUTensorToDeviceSync(&x, device_.get(),
+                                                           &device_x));
+    FunctionCallFrame call_frame({DT_FLOAT}, {DT_FLOAT});
+    TF_ASSERT_OK(call_frame.SetArgs({device_x}));
+
+    StepStats step_stats;
+    StepStatsCollector collector(&step_stats);
+    Executor::Args args;
+    args.call_frame = &call_frame;
+    args.stats_collector = &collector;
+    args.runner = [](const std::function<void()>& fn) { fn(); };
+    args.sync_on_finish = true;
+    TF_ASSERT_OK(exec_->Run(args));
+    collector.Finalize();
+    *ran_kernels = false;
+    for (const DeviceStepStats& device_stats : step_stats.dev_stats()) {
+      *ran_kernels |= device_stats.node_stats_size() > 0;
+    }
+
+    std::vector<Tensor> retvals;
+    TF_ASSERT_OK(call_frame.ConsumeRetvals(&retvals, false));
+    ASSERT_EQ(retvals.size(), 1);
+    *y = Tensor(retvals[0].dtype(), retvals[0].shape());
+    TF_ASSERT_OK(device_context->CopyDeviceTensorToCPUSync(
+        &retvals[0], "y", device_.get(), y));
+  }
+
+  std::unique_ptr<Device> device_;
+  std::unique_ptr<Executor> exec_;
+};
+
+TEST_F(GpuGraphCaptureExecutorTest, CapturesAfterWarmupAndReplays) {
+  Create(/*stateful=*/false);
+  for (int step = 0; step < kWarmupSteps + 3; ++step) {
+    Tensor y;
+    bool ran_kernels;
+    RunStep(test::AsTensor<float>({1.0f * step, 2.0f}), &y, &ran_kernels);
+    // The captured step is replayed right away, with the arguments of each
+    // step copied into its buffers.
+    EXPECT_EQ(ran_kernels, step < kWarmupSteps) << "step " << step;
+    test::ExpectTensorEqual<float>(
+        y, test::AsTensor<float>({-1.0f * step, -2.0f}));
+  }
+}
+
+TEST_F(GpuGraphCaptureExecutorTest, CapturesAgainWhenArgumentShapesChange) {
+  Create(/*stateful=*/false);
+  Tensor y;
+  bool ran_kernels;
+  for (int step = 0; step <= kWarmupSteps; ++step) {
+    RunStep(test::AsTensor<float>({1.0f, 2.0f}), &y, &ran_kernels);
+  }
+  EXPECT_FALSE(ran_kernels);
+
+  // A new shape is run by the regular executor until it has been warmed up.
+  for (int step = 0; step <= kWarmupSteps; ++step) {
+    RunStep(test::AsTensor<float>({1.0f, 2.0f, 3.0f}), &y, &ran_kernels);
+    EXPECT_EQ(ran_kernels, step < kWarmupSteps) << "step " << step;
+    test::ExpectTensorEqual<float>(
+        y, test::AsTensor<float>({-1.0f, -2.0f, -3.0f}));
+  }
+}
+
+TEST_F(GpuGraphCaptureExecutorTest, FallsBackForStatefulGraphs) {
+  Create(/*stateful=*/true);
+  for (int step = 0; step < kWarmupSteps + 3; ++step) {
+    Tensor y;
+    bool ran_kernels;
+    RunStep(test::AsTensor<float>({1.0f, 2.0f}), &y, &ran_kernels);
+    EXPECT_TRUE(ran_kernels) << "step " << step;
+    test::ExpectTensorEqual<float>(y, test::AsTensor<float>({-1.0f, -2.0f}));
+  }
+}
+
+TEST_F(GpuGraphCaptureExecutorTest, FallsBackWithoutCallFrame) {
+  Create(/*stateful=*/false);
+  for (int step = 0; step < kWarmupSteps + 3; ++step) {
+    Executor::Args args;
+    args.runner = [](const std::function<void()>& fn) { fn(); };
+    // The regular executor fails to read the argument of the graph.
+    EXPECT_FALSE(exec_->Run(args).ok()) << "step " << step;
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -278,6 +278,16 @@ SharedCounter* GPUProcessState::GPUAllocatorCounter(
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 }
 
+GPUBFCAllocator* GPUProcessState::GetGPUBFCAllocator(
+    tsl::TfDeviceId tf_device_id) {
+  mutex_lock l(mu_);
+  if (tf_device_id.value() < 0 ||
+      tf_device_id.value() >= static_cast<int64_t>(gpu_allocators_.size())) {
+    return nullptr;
+  }
+  return gpu_allocators_[tf_device_id.value()].bfc_allocator;
+}
+
 Allocator* GPUProcessState::GetGpuHostAllocator(const GPUOptions& options,
                                                 int numa_node) {
   CHECK(process_state_);
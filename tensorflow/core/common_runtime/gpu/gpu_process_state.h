@@ -136,6 +136,10 @@ class GPUProcessState {
 
   SharedCounter* GPUAllocatorCounter(tsl::TfDeviceId tf_device_id);
 
+  // Returns the BFC allocator of the given GPU, or nullptr if the GPU
+  // allocator has not been created yet or is not a BFC allocator.
+  GPUBFCAllocator* GetGPUBFCAllocator(tsl::TfDeviceId tf_device_id);
+
  protected:
   // GPUProcessState is a singleton that should not normally be deleted except
   // at process shutdown.
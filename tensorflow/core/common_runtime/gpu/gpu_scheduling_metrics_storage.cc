@@ -14,6 +14,11 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/gpu/gpu_scheduling_metrics_storage.h"
 
+#include <cstdint>
+
+#include "absl/synchronization/mutex.h"
+#include "tsl/framework/real_time_in_memory_metric.h"
+
 namespace tensorflow {
 
 /*static*/ GpuSchedulingMetricsStorage&
@@ -22,4 +27,11 @@ GpuSchedulingMetricsStorage::GetGlobalStorage() {
   return *storage;
 }
 
+tsl::RealTimeInMemoryMetric<int64_t>&
+GpuSchedulingMetricsStorage::DeviceExecutionTimeEmaNs(int32_t index_on_host) {
+  absl::MutexLock lock(&mu_);
+  // Elements of a node_hash_map are stable, so the reference stays valid.
+  return device_execution_time_ema_ns_[index_on_host];
+}
+
 }  // namespace tensorflow
@@ -19,6 +19,9 @@ limitations under the License.
 #include <memory>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/node_hash_map.h"
+#include "absl/synchronization/mutex.h"
 #include "tsl/framework/real_time_in_memory_metric.h"
 
 namespace tensorflow {
@@ -38,8 +41,17 @@ class GpuSchedulingMetricsStorage {
     return total_gpu_load_ns_;
   }
 
+  // Gets the metrics for the moving average of the execution time of programs
+  // on the GPU of index `index_on_host`.
+  tsl::RealTimeInMemoryMetric<int64_t>& DeviceExecutionTimeEmaNs(
+      int32_t index_on_host);
+
  private:
   tsl::RealTimeInMemoryMetric<int64_t> total_gpu_load_ns_;
+
+  absl::Mutex mu_;
+  absl::node_hash_map<int32_t, tsl::RealTimeInMemoryMetric<int64_t>>
+      device_execution_time_ema_ns_ ABSL_GUARDED_BY(mu_);
 };
 
 }  // namespace tensorflow
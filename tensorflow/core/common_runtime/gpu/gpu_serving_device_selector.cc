@@ -44,14 +44,21 @@ using DeviceStates = GpuServingDeviceSelector::DeviceStates;
 
 GpuServingDeviceSelector::GpuServingDeviceSelector(
     const int num_devices,
-    std::unique_ptr<ServingDeviceSelector::Policy> device_selector_policy)
+    std::unique_ptr<ServingDeviceSelector::Policy> device_selector_policy,
+    FreeMemoryFn free_memory_fn)
     : device_states_(num_devices),
       device_selector_policy_(std::move(device_selector_policy)),
+      free_memory_fn_(std::move(free_memory_fn)),
       req_id_counter_(0) {}
 
 tsl::DeviceReservation GpuServingDeviceSelector::ReserveDevice(
     absl::string_view program_fingerprint) {
   absl::MutexLock lock(&mu_);
+  if (free_memory_fn_) {
+    for (int32_t i = 0; i < device_states_.size(); ++i) {
+      device_states_[i].free_memory_bytes = free_memory_fn_(i);
+    }
+  }
   DeviceStates device_states;
   device_states.states = absl::Span<const DeviceState>(device_states_);
   auto [it, emplaced] =
@@ -101,6 +108,9 @@ void GpuServingDeviceSelector::Completed(int32_t index_on_host,
   DeviceState& device_state = device_states_.at(index_on_host);
   ServingDeviceSelector::CompletedHelper(device_state, index_on_host, 0,
                                          min_exec_time_, had_error, NowNs());
+  GpuSchedulingMetricsStorage::GetGlobalStorage()
+      .DeviceExecutionTimeEmaNs(index_on_host)
+      .Set(device_state.execution_time_ema_ns);
 
   int64_t total_estimated_time_ns = TotalEstimatedTimeTillIdleNs();
   GpuSchedulingMetricsStorage::GetGlobalStorage().TotalGpuLoadNs().Set(
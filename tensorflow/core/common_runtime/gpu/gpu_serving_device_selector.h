@@ -16,8 +16,11 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_SERVING_DEVICE_SELECTOR_H_
 
 #include <cstdint>
+#include <functional>
 #include <memory>
+#include <optional>
 #include <string>
+#include <utility>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/container/fixed_array.h"
@@ -56,9 +59,17 @@ class GpuServingDeviceSelectorResource : public ResourceBase {
 
 class GpuServingDeviceSelector : public tsl::ServingDeviceSelector {
  public:
+  // Returns the free bytes of memory of the GPU of index `index_on_host`, or
+  // std::nullopt if unknown.
+  using FreeMemoryFn =
+      std::function<std::optional<int64_t>(int32_t index_on_host)>;
+
+  // If set, `free_memory_fn` is called for each device when reserving one, and
+  // its result is passed to the policy as DeviceState::free_memory_bytes.
   GpuServingDeviceSelector(
       int num_devices,
-      std::unique_ptr<ServingDeviceSelector::Policy> device_selector_policy);
+      std::unique_ptr<ServingDeviceSelector::Policy> device_selector_policy,
+      FreeMemoryFn free_memory_fn = nullptr);
 
   tsl::DeviceReservation ReserveDevice(
       absl::string_view program_fingerprint) override;
@@ -84,6 +95,7 @@ class GpuServingDeviceSelector : public tsl::ServingDeviceSelector {
   absl::Mutex mu_;
   absl::FixedArray<DeviceState, 8> device_states_ ABSL_GUARDED_BY(mu_);
   std::unique_ptr<ServingDeviceSelector::Policy> device_selector_policy_;
+  const FreeMemoryFn free_memory_fn_;
   int64_t req_id_counter_ ABSL_GUARDED_BY(mu_);
   // Map from program fingerprint to execution info.
   absl::node_hash_map<std::string, ExecutionInfo> execution_info_
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 
@@ -135,6 +136,59 @@ TEST(GpuServingDeviceSelector, DefaultPolicyOnlyEnqueueCall) {
       0e6);
 }
 
+TEST(GpuServingDeviceSelector, LoadAwarePolicyAvoidsBusyDevice) {
+  ServingDeviceSelectorTestHelper helper;
+  GpuServingDeviceSelector selector(/*num_devices=*/2,
+                                    std::make_unique<tsl::LoadAwarePolicy>());
+  // Run the program back-to-back so that its execution time is recorded.
+  selector.Enqueue(0, "2ms");
+  selector.Enqueue(0, "2ms");
+  helper.ElapseNs(2e6);
+  selector.Completed(0);
+  helper.ElapseNs(2e6);
+  selector.Completed(0);
+  EXPECT_EQ(GpuSchedulingMetricsStorage::GetGlobalStorage()
+                .DeviceExecutionTimeEmaNs(0)
+                .Get(),
+            2e6);
+
+  selector.Enqueue(0, "2ms");
+  tsl::DeviceReservation reservation1 = selector.ReserveDevice("2ms");
+  EXPECT_EQ(reservation1.device_index(), 1);
+  tsl::DeviceReservation reservation2 = selector.ReserveDevice("2ms");
+  EXPECT_EQ(reservation2.device_index(), 1);
+  tsl::DeviceReservation reservation3 = selector.ReserveDevice("2ms");
+  EXPECT_EQ(reservation3.device_index(), 0);
+}
+
+TEST(GpuServingDeviceSelector, LoadAwarePolicyPrefersResidentProgram) {
+  GpuServingDeviceSelector selector(
+      /*num_devices=*/2, std::make_unique<tsl::LoadAwarePolicy>(
+                             /*non_resident_penalty_ns=*/1e6));
+  selector.Enqueue(1, "program");
+  selector.Completed(1);
+
+  for (int i = 0; i < 2; ++i) {
+    tsl::DeviceReservation reservation = selector.ReserveDevice("program");
+    EXPECT_EQ(reservation.device_index(), 1);
+  }
+}
+
+TEST(GpuServingDeviceSelector, LoadAwarePolicyAvoidsLowMemoryDevice) {
+  GpuServingDeviceSelector selector(
+      /*num_devices=*/2,
+      std::make_unique<tsl::LoadAwarePolicy>(/*non_resident_penalty_ns=*/0,
+                                             /*min_free_memory_bytes=*/50),
+      [](int32_t index_on_host) -> std::optional<int64_t> {
+        return index_on_host == 0 ? 10 : 100;
+      });
+
+  tsl::DeviceReservation reservation1 = selector.ReserveDevice("program");
+  EXPECT_EQ(reservation1.device_index(), 1);
+  tsl::DeviceReservation reservation2 = selector.ReserveDevice("program");
+  EXPECT_EQ(reservation2.device_index(), 1);
+}
+
 }  // namespace
 }  // namespace gpu
 }  // namespace tensorflow
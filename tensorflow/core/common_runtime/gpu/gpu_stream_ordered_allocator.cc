@@ -0,0 +1,108 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_ordered_allocator.h"
+
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+
+void* StreamOrderedFreeList::Take(size_t alignment, size_t num_bytes,
+                                  se::Stream* stream) {
+  FreeBuffer buffer;
+  size_t size = 0;
+  {
+    mutex_lock l(mu_);
+    auto best = free_buffers_.end();
+    for (auto it = free_buffers_.lower_bound(num_bytes);
+         it != free_buffers_.end() && it->first / 2 <= num_bytes; ++it) {
+      if (reinterpret_cast<uintptr_t>(it->second.ptr) % alignment != 0) {
+        continue;
+      }
+      if (it->second.stream == stream) {
+        best = it;
+        break;
+      }
+      if (best == free_buffers_.end()) best = it;
+    }
+    if (best == free_buffers_.end()) return nullptr;
+    size = best->first;
+    buffer = best->second;
+    free_buffers_.erase(best);
+    free_bytes_ -= size;
+  }
+  if (buffer.stream != stream) {
+    Status s = stream->WaitFor(buffer.stream);
+    if (!s.ok()) {
+      LOG(ERROR) << "Failed to reuse a buffer across streams: " << s;
+      Put(buffer.ptr, size, buffer.stream);
+      return nullptr;
+    }
+  }
+  return buffer.ptr;
+}
+
+void StreamOrderedFreeList::Put(void* ptr, size_t size, se::Stream* stream) {
+  mutex_lock l(mu_);
+  free_buffers_.emplace(size, FreeBuffer{ptr, stream});
+  free_bytes_ += size;
+}
+
+void StreamOrderedFreeList::Flush() {
+  std::multimap<size_t, FreeBuffer> free_buffers;
+  {
+    mutex_lock l(mu_);
+    free_buffers.swap(free_buffers_);
+    free_bytes_ = 0;
+  }
+  absl::flat_hash_map<se::Stream*, std::vector<void*>> buffers_by_stream;
+  for (const auto& [size, buffer] : free_buffers) {
+    buffers_by_stream[buffer.stream].push_back(buffer.ptr);
+  }
+  Allocator* allocator = allocator_;
+  for (auto& [stream, ptrs] : buffers_by_stream) {
+    em_->ThenExecute(stream, [allocator, ptrs = std::move(ptrs)]() {
+      for (void* ptr : ptrs) allocator->DeallocateRaw(ptr);
+    });
+  }
+}
+
+size_t StreamOrderedFreeList::FreeBytes() {
+  mutex_lock l(mu_);
+  return free_bytes_;
+}
+
+void* StreamOrderedAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  void* ptr = free_list_->Take(alignment, num_bytes, stream_);
+  if (ptr != nullptr) return ptr;
+  // If this runs out of memory, the device allocator flushes the free list.
+  return allocator_->AllocateRaw(alignment, num_bytes, allocation_attr);
+}
+
+void StreamOrderedAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) return;
+  free_list_->Put(ptr, allocator_->AllocatedSize(ptr), stream_);
+}
+
+}  // namespace tensorflow
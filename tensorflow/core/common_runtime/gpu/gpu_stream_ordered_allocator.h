@@ -0,0 +1,129 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_ORDERED_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_ORDERED_ALLOCATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "absl/types/optional.h"
+#include "tensorflow/core/common_runtime/device/device_event_mgr.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// The memory freed by the StreamOrderedAllocators of a device allocator, each
+// buffer tagged with the stream that freed it.
+//
+// The free buffers are invisible to the device allocator, so the owner of the
+// free list is expected to Flush() it whenever the device allocator runs out
+// of memory, e.g. from a BFCAllocator out of memory callback.
+class StreamOrderedFreeList {
+ public:
+  // `em` is the EventMgr of the device of `allocator`.
+  StreamOrderedFreeList(Allocator* allocator, EventMgr* em)
+      : allocator_(allocator), em_(em) {}
+
+  // Returns a free buffer of between `num_bytes` and twice as many bytes,
+  // aligned to `alignment`, that the work queued on `stream` from now on may
+  // use, or nullptr if there is none. Buffers freed on `stream` are preferred,
+  // since those are reusable right away; otherwise `stream` is made to wait
+  // for the stream that freed the buffer.
+  void* Take(size_t alignment, size_t num_bytes, se::Stream* stream);
+
+  // Adds `ptr`, of `size` bytes and freed by the work queued on `stream` so
+  // far, to the free list.
+  void Put(void* ptr, size_t size, se::Stream* stream);
+
+  // Empties the free list. Each buffer is returned to the allocator once the
+  // EventMgr sees the stream that freed it pass the free, so this does not
+  // block.
+  void Flush();
+
+  // Returns the bytes of the buffers in the free list.
+  size_t FreeBytes();
+
+ private:
+  struct FreeBuffer {
+    void* ptr = nullptr;
+    se::Stream* stream = nullptr;  // not owned
+  };
+
+  Allocator* const allocator_;  // not owned
+  EventMgr* const em_;          // not owned
+  mutex mu_;
+  std::multimap<size_t, FreeBuffer> free_buffers_ TF_GUARDED_BY(mu_);
+  size_t free_bytes_ TF_GUARDED_BY(mu_) = 0;
+};
+
+// Forwards to a device allocator, but keeps deallocated memory in a free list
+// shared by the compute streams of the device instead of returning it, so that
+// later allocations on the stream that freed it can reuse it immediately, in
+// stream order, without waiting for the EventMgr to see the stream progress.
+// Requires a device allocator that tracks allocation sizes.
+class StreamOrderedAllocator : public Allocator {
+ public:
+  StreamOrderedAllocator(Allocator* allocator, StreamOrderedFreeList* free_list,
+                         se::Stream* stream)
+      : allocator_(allocator), free_list_(free_list), stream_(stream) {}
+
+  std::string Name() override { return allocator_->Name(); }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+
+  void DeallocateRaw(void* ptr) override;
+
+  bool TracksAllocationSizes() const override { return true; }
+
+  size_t RequestedSize(const void* ptr) const override {
+    return allocator_->RequestedSize(ptr);
+  }
+
+  size_t AllocatedSize(const void* ptr) const override {
+    return allocator_->AllocatedSize(ptr);
+  }
+
+  int64_t AllocationId(const void* ptr) const override {
+    return allocator_->AllocationId(ptr);
+  }
+
+  absl::optional<AllocatorStats> GetStats() override {
+    return allocator_->GetStats();
+  }
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return allocator_->GetMemoryType();
+  }
+
+ private:
+  Allocator* const allocator_;              // not owned
+  StreamOrderedFreeList* const free_list_;  // not owned
+  se::Stream* const stream_;                // not owned
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_ORDERED_ALLOCATOR_H_
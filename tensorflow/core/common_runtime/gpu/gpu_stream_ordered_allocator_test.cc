@@ -0,0 +1,168 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if (defined(GOOGLE_CUDA) && GOOGLE_CUDA) || \
+    (defined(TENSORFLOW_USE_ROCM) && TENSORFLOW_USE_ROCM)
+
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_ordered_allocator.h"
+
+#include <cstdint>
+#include <memory>
+
+#include "xla/stream_executor/gpu/gpu_init.h"
+#include "xla/stream_executor/stream_executor.h"
+#include "tensorflow/core/common_runtime/device/device_event_mgr.h"
+#include "tensorflow/core/common_runtime/device/device_mem_allocator.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_bfc_allocator.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tsl/framework/device_id.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr size_t kAlignment = Allocator::kAllocatorAlignment;
+
+class StreamOrderedAllocatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    se::StreamExecutor* executor =
+        se::GPUMachineManager()->ExecutorForDevice(0).value();
+    tsl::PlatformDeviceId gpu_id(0);
+    bfc_ = std::make_unique<GPUBFCAllocator>(
+        std::make_unique<DeviceMemAllocator>(
+            executor, gpu_id, stream_executor::MemoryType::kDevice,
+            /*alloc_visitors=*/{}, /*free_visitors=*/{}),
+        /*total_memory=*/1 << 20, "GPU_0_bfc", GPUBFCAllocator::Options());
+    free_list_ = std::make_unique<StreamOrderedFreeList>(
+        bfc_.get(),
+        EventMgrFactory::Singleton()->GetEventMgr(executor, GPUOptions()));
+    StreamOrderedFreeList* free_list = free_list_.get();
+    bfc_->AddOutOfMemoryCallback([free_list]() { free_list->Flush(); });
+    stream1_ = executor->CreateStream().value();
+    stream2_ = executor->CreateStream().value();
+    allocator1_ = std::make_unique<StreamOrderedAllocator>(
+        bfc_.get(), free_list_.get(), stream1_.get());
+    allocator2_ = std::make_unique<StreamOrderedAllocator>(
+        bfc_.get(), free_list_.get(), stream2_.get());
+  }
+
+  void TearDown() override {
+    free_list_->Flush();
+    WaitForMemoryReturned();
+  }
+
+  // Waits for the streams, and then for the EventMgr to return all the memory
+  // flushed from the free list to the BFC allocator.
+  void WaitForMemoryReturned() {
+    TF_ASSERT_OK(stream1_->BlockHostUntilDone());
+    TF_ASSERT_OK(stream2_->BlockHostUntilDone());
+    for (int i = 0; i < 1000 && bfc_->GetStats()->bytes_in_use > 0; ++i) {
+      Env::Default()->SleepForMicroseconds(1000);
+    }
+    EXPECT_EQ(0, bfc_->GetStats()->bytes_in_use);
+  }
+
+  std::unique_ptr<GPUBFCAllocator> bfc_;
+  std::unique_ptr<StreamOrderedFreeList> free_list_;
+  std::unique_ptr<se::Stream> stream1_;
+  std::unique_ptr<se::Stream> stream2_;
+  std::unique_ptr<StreamOrderedAllocator> allocator1_;
+  std::unique_ptr<StreamOrderedAllocator> allocator2_;
+};
+
+TEST_F(StreamOrderedAllocatorTest, ReusesMemoryFreedOnSameStream) {
+  void* p = allocator1_->AllocateRaw(kAlignment, 1024);
+  ASSERT_NE(p, nullptr);
+  allocator1_->DeallocateRaw(p);
+  EXPECT_EQ(bfc_->AllocatedSize(p), free_list_->FreeBytes());
+  // The memory is still allocated from the point of view of the BFC
+  // allocator.
+  EXPECT_EQ(static_cast<int64_t>(bfc_->AllocatedSize(p)),
+            bfc_->GetStats()->bytes_in_use);
+
+  void* q = allocator1_->AllocateRaw(kAlignment, 1024);
+  EXPECT_EQ(p, q);
+  EXPECT_EQ(size_t{0}, free_list_->FreeBytes());
+  allocator1_->DeallocateRaw(q);
+}
+
+TEST_F(StreamOrderedAllocatorTest, ReusesMemoryFreedOnOtherStream) {
+  void* p = allocator1_->AllocateRaw(kAlignment, 1024);
+  ASSERT_NE(p, nullptr);
+  allocator1_->DeallocateRaw(p);
+
+  void* q = allocator2_->AllocateRaw(kAlignment, 1024);
+  EXPECT_EQ(p, q);
+  EXPECT_EQ(size_t{0}, free_list_->FreeBytes());
+  allocator2_->DeallocateRaw(q);
+}
+
+TEST_F(StreamOrderedAllocatorTest, PrefersMemoryFreedOnSameStream) {
+  void* p1 = allocator1_->AllocateRaw(kAlignment, 1024);
+  void* p2 = allocator2_->AllocateRaw(kAlignment, 1024);
+  ASSERT_NE(p1, nullptr);
+  ASSERT_NE(p2, nullptr);
+  allocator1_->DeallocateRaw(p1);
+  allocator2_->DeallocateRaw(p2);
+
+  void* q = allocator2_->AllocateRaw(kAlignment, 1024);
+  EXPECT_EQ(p2, q);
+  allocator2_->DeallocateRaw(q);
+}
+
+TEST_F(StreamOrderedAllocatorTest, DoesNotReuseMuchLargerMemory) {
+  void* p = allocator1_->AllocateRaw(kAlignment, 64 << 10);
+  ASSERT_NE(p, nullptr);
+  allocator1_->DeallocateRaw(p);
+
+  void* q = allocator1_->AllocateRaw(kAlignment, 1024);
+  ASSERT_NE(q, nullptr);
+  EXPECT_NE(p, q);
+  allocator1_->DeallocateRaw(q);
+}
+
+TEST_F(StreamOrderedAllocatorTest, FlushReturnsMemoryOnceStreamsPassFrees) {
+  void* p1 = allocator1_->AllocateRaw(kAlignment, 1024);
+  void* p2 = allocator2_->AllocateRaw(kAlignment, 1024);
+  allocator1_->DeallocateRaw(p1);
+  allocator2_->DeallocateRaw(p2);
+  EXPECT_GT(free_list_->FreeBytes(), size_t{0});
+
+  free_list_->Flush();
+  EXPECT_EQ(size_t{0}, free_list_->FreeBytes());
+  WaitForMemoryReturned();
+}
+
+TEST_F(StreamOrderedAllocatorTest, FlushesWhenDeviceAllocatorRunsOutOfMemory) {
+  constexpr size_t kLarge = 768 << 10;
+  void* p = allocator1_->AllocateRaw(kAlignment, kLarge);
+  ASSERT_NE(p, nullptr);
+  allocator1_->DeallocateRaw(p);
+  EXPECT_GT(free_list_->FreeBytes(), size_t{0});
+
+  // An allocation that does not go through the free list only fits once the
+  // free list has been returned to the BFC allocator.
+  void* q = bfc_->AllocateRaw(kAlignment, kLarge);
+  ASSERT_NE(q, nullptr);
+  EXPECT_EQ(size_t{0}, free_list_->FreeBytes());
+  bfc_->DeallocateRaw(q);
+}
+
+}  // namespace
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
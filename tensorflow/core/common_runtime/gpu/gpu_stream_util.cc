@@ -0,0 +1,54 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
+
+#include <vector>
+
+#include "tensorflow/core/graph/algorithm.h"
+
+namespace tensorflow {
+namespace gpu_stream_util {
+
+std::vector<int> AssignStreams(const Graph& graph, int num_streams) {
+  std::vector<int> stream_ids(graph.num_node_ids(), 0);
+  if (num_streams <= 1) return stream_ids;
+
+  // Whether some successor of the node already continues its stream.
+  std::vector<bool> continued(graph.num_node_ids(), false);
+  int next_stream = 0;
+  std::vector<Node*> order;
+  GetReversePostOrder(graph, &order);
+  for (const Node* n : order) {
+    if (!n->IsOp()) continue;
+    int stream_id = -1;
+    for (const Edge* e : n->in_edges()) {
+      const Node* src = e->src();
+      if (!src->IsOp() || continued[src->id()]) continue;
+      continued[src->id()] = true;
+      stream_id = stream_ids[src->id()];
+      break;
+    }
+    if (stream_id < 0) {
+      stream_id = next_stream;
+      next_stream = (next_stream + 1) % num_streams;
+    }
+    stream_ids[n->id()] = stream_id;
+  }
+  return stream_ids;
+}
+
+}  // namespace gpu_stream_util
+}  // namespace tensorflow
@@ -0,0 +1,39 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_UTIL_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_UTIL_H_
+
+#include <vector>
+
+#include "tensorflow/core/graph/graph.h"
+
+namespace tensorflow {
+namespace gpu_stream_util {
+
+// Assigns each op of `graph` one of `num_streams` compute streams, and returns
+// the stream ids indexed by node id.
+//
+// The nodes are visited in topological order. A node continues the stream of
+// the first of its inputs whose stream has not been continued by another node
+// yet, so that chains of dependent ops stay on one stream. Every other node
+// starts a new branch, which is assigned the next stream in round-robin order.
+// If `num_streams` <= 1, all nodes are assigned stream 0.
+std::vector<int> AssignStreams(const Graph& graph, int num_streams);
+
+}  // namespace gpu_stream_util
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_UTIL_H_
@@ -0,0 +1,96 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+Tensor Scalar(float value) {
+  Tensor t(DT_FLOAT, TensorShape({}));
+  t.scalar<float>()() = value;
+  return t;
+}
+
+TEST(GpuStreamUtilTest, SingleStream) {
+  Graph g(OpRegistry::Global());
+  Node* a = test::graph::Constant(&g, Scalar(1.0));
+  Node* b = test::graph::Constant(&g, Scalar(2.0));
+  Node* c = test::graph::Binary(&g, "Add", a, b);
+  FixupSourceAndSinkEdges(&g);
+  std::vector<int> streams = gpu_stream_util::AssignStreams(g, 1);
+  ASSERT_EQ(streams.size(), g.num_node_ids());
+  EXPECT_EQ(streams[a->id()], 0);
+  EXPECT_EQ(streams[b->id()], 0);
+  EXPECT_EQ(streams[c->id()], 0);
+}
+
+TEST(GpuStreamUtilTest, ChainsStayOnOneStream) {
+  Graph g(OpRegistry::Global());
+  Node* a = test::graph::Constant(&g, Scalar(1.0));
+  Node* a1 = test::graph::Identity(&g, a);
+  Node* a2 = test::graph::Identity(&g, a1);
+  Node* b = test::graph::Constant(&g, Scalar(2.0));
+  Node* b1 = test::graph::Identity(&g, b);
+  Node* b2 = test::graph::Identity(&g, b1);
+  Node* sum = test::graph::Binary(&g, "Add", a2, b2);
+  FixupSourceAndSinkEdges(&g);
+  std::vector<int> streams = gpu_stream_util::AssignStreams(g, 2);
+  EXPECT_EQ(streams[a1->id()], streams[a->id()]);
+  EXPECT_EQ(streams[a2->id()], streams[a->id()]);
+  EXPECT_EQ(streams[b1->id()], streams[b->id()]);
+  EXPECT_EQ(streams[b2->id()], streams[b->id()]);
+  EXPECT_NE(streams[a->id()], streams[b->id()]);
+  EXPECT_TRUE(streams[sum->id()] == streams[a->id()] ||
+              streams[sum->id()] == streams[b->id()]);
+}
+
+TEST(GpuStreamUtilTest, BranchesUseOtherStreams) {
+  Graph g(OpRegistry::Global());
+  Node* a = test::graph::Constant(&g, Scalar(1.0));
+  std::vector<Node*> branches;
+  for (int i = 0; i < 4; ++i) {
+    branches.push_back(test::graph::Identity(&g, a));
+  }
+  FixupSourceAndSinkEdges(&g);
+  std::vector<int> streams = gpu_stream_util::AssignStreams(g, 3);
+  std::vector<int> num_nodes(3, 0);
+  for (Node* n : g.op_nodes()) {
+    ASSERT_GE(streams[n->id()], 0);
+    ASSERT_LT(streams[n->id()], 3);
+    ++num_nodes[streams[n->id()]];
+  }
+  // One branch continues the stream of `a`, the others start new ones.
+  for (int count : num_nodes) {
+    EXPECT_GT(count, 0);
+  }
+  int same_stream = 0;
+  for (Node* n : branches) {
+    if (streams[n->id()] == streams[a->id()]) ++same_stream;
+  }
+  EXPECT_GE(same_stream, 1);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -20,6 +20,7 @@ limitations under the License.
 #include <memory>
 #include <utility>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 
 // TODO(b/282059652): Merge google internal and open-source code path once TF
@@ -51,7 +52,10 @@ limitations under the License.
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/tensor_coding.h"
 #include "tensorflow/core/profiler/lib/scoped_annotation.h"
@@ -314,6 +318,137 @@ bool NeedStaging(const Tensor* tensor) {
   return tensor->GetMemoryType() == AllocatorMemoryType::kHostPageable;
 }
 
+// Pageable tensors larger than this are copied through a PinnedStagingRing in
+// chunks of this size.
+constexpr int64_t kStagingChunkBytes = 4 << 20;
+constexpr int kNumStagingChunks = 4;
+constexpr int kStagingPollIntervalUsecs = 10;
+
+// A ring of pinned host buffers reused to copy pageable tensors to and from a
+// device. Copying a chunk between pageable and pinned memory on the host
+// overlaps with the DMA of the neighbouring chunks.
+class PinnedStagingRing {
+ public:
+  // Returns the ring of the device of `stream`, whose buffers are allocated
+  // from `host_allocator` on first use, or nullptr if that fails.
+  static PinnedStagingRing* Get(se::Stream* stream, Allocator* host_allocator) {
+    static mutex* mu = new mutex;
+    static auto* rings =
+        new absl::flat_hash_map<se::StreamExecutor*, PinnedStagingRing*>;
+    mutex_lock l(*mu);
+    auto [it, inserted] = rings->try_emplace(stream->parent(), nullptr);
+    if (inserted) {
+      auto ring = std::make_unique<PinnedStagingRing>();
+      Status s = ring->Init(stream->parent(), host_allocator);
+      if (s.ok()) {
+        it->second = ring.release();
+      } else {
+        LOG(WARNING) << "Failed to create a pinned staging ring, pageable "
+                        "tensors will be staged in full: "
+                     << s;
+      }
+    }
+    return it->second;
+  }
+
+  // Copies `total_bytes` from `src` to `dst` on `stream`. Returns once `src`
+  // has been copied to pinned memory, while the DMA of the last chunks may
+  // still be pending on `stream`.
+  Status CopyToDevice(se::Stream* stream, const void* src,
+                      DeviceMemoryBase* dst, int64_t total_bytes) {
+    mutex_lock l(mu_);
+    for (int64_t i = 0; i * kStagingChunkBytes < total_bytes; ++i) {
+      const int64_t offset = i * kStagingChunkBytes;
+      const int64_t bytes = std::min(kStagingChunkBytes, total_bytes - offset);
+      Chunk& chunk = chunks_[i % kNumStagingChunks];
+      TF_RETURN_IF_ERROR(WaitForChunk(chunk));
+      std::memcpy(chunk.buffer, static_cast<const char*>(src) + offset, bytes);
+      DeviceMemoryBase dst_chunk(static_cast<char*>(dst->opaque()) + offset,
+                                 bytes);
+      TF_RETURN_IF_ERROR(stream->Memcpy(&dst_chunk, chunk.buffer, bytes));
+      TF_RETURN_IF_ERROR(stream->RecordEvent(chunk.event.get()));
+      chunk.pending = true;
+    }
+    return absl::OkStatus();
+  }
+
+  // Copies `total_bytes` from `src` on `stream` to `dst`. Returns once all of
+  // them have arrived in `dst`, like a copy to pageable memory does.
+  Status CopyFromDevice(se::Stream* stream, const DeviceMemoryBase& src,
+                        void* dst, int64_t total_bytes) {
+    mutex_lock l(mu_);
+    const int64_t num_chunks =
+        (total_bytes + kStagingChunkBytes - 1) / kStagingChunkBytes;
+    auto chunk_bytes = [&](int64_t i) {
+      return std::min(kStagingChunkBytes, total_bytes - i * kStagingChunkBytes);
+    };
+    // Keeps the DMA of up to kNumStagingChunks chunks in flight.
+    int64_t num_issued = 0;
+    for (int64_t i = 0; i < num_chunks; ++i) {
+      for (; num_issued < std::min(num_chunks, i + kNumStagingChunks);
+           ++num_issued) {
+        Chunk& chunk = chunks_[num_issued % kNumStagingChunks];
+        TF_RETURN_IF_ERROR(WaitForChunk(chunk));
+        DeviceMemoryBase src_chunk(static_cast<char*>(src.opaque()) +
+                                       num_issued * kStagingChunkBytes,
+                                   chunk_bytes(num_issued));
+        TF_RETURN_IF_ERROR(
+            stream->Memcpy(chunk.buffer, src_chunk, chunk_bytes(num_issued)));
+        TF_RETURN_IF_ERROR(stream->RecordEvent(chunk.event.get()));
+        chunk.pending = true;
+      }
+      Chunk& chunk = chunks_[i % kNumStagingChunks];
+      TF_RETURN_IF_ERROR(WaitForChunk(chunk));
+      std::memcpy(static_cast<char*>(dst) + i * kStagingChunkBytes,
+                  chunk.buffer, chunk_bytes(i));
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  struct Chunk {
+    void* buffer = nullptr;
+    // Recorded after the last DMA from or to `buffer`.
+    std::unique_ptr<se::Event> event;
+    bool pending = false;
+  };
+
+  Status Init(se::StreamExecutor* executor, Allocator* host_allocator) {
+    for (Chunk& chunk : chunks_) {
+      chunk.buffer = host_allocator->AllocateRaw(
+          Allocator::kAllocatorAlignment, kStagingChunkBytes);
+      if (chunk.buffer == nullptr) {
+        return errors::ResourceExhausted("Failed to allocate ",
+                                         kStagingChunkBytes,
+                                         " bytes of pinned host memory.");
+      }
+      TF_ASSIGN_OR_RETURN(chunk.event, executor->CreateEvent());
+    }
+    return absl::OkStatus();
+  }
+
+  // Waits until the last DMA from or to the buffer of `chunk` is done.
+  static Status WaitForChunk(Chunk& chunk) {
+    while (chunk.pending) {
+      switch (chunk.event->PollForStatus()) {
+        case se::Event::Status::kComplete:
+          chunk.pending = false;
+          break;
+        case se::Event::Status::kPending:
+          Env::Default()->SleepForMicroseconds(kStagingPollIntervalUsecs);
+          break;
+        default:
+          return errors::Internal("Failed to wait for a staging copy.");
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  mutex mu_;
+  // The buffers are never freed, as rings live as long as the process.
+  Chunk chunks_[kNumStagingChunks] TF_GUARDED_BY(mu_);
+};
+
 }  // namespace
 
 void GPUUtil::CopyGPUTensorToCPU(Device* gpu_device,
@@ -377,7 +512,19 @@ void GPUUtil::CopyGPUTensorToCPU(Device* gpu_device,
     void* src_ptr = GetBase(gpu_tensor);
     DeviceMemoryBase gpu_src_ptr(src_ptr, total_bytes);
     void* dst_ptr = GetBase(cpu_tensor);
-    s = send_device_to_host_stream->Memcpy(dst_ptr, gpu_src_ptr, total_bytes);
+    PinnedStagingRing* staging_ring = nullptr;
+    if (total_bytes > kStagingChunkBytes && NeedStaging(cpu_tensor) &&
+        device_context->host_memory_allocator() != nullptr) {
+      staging_ring = PinnedStagingRing::Get(
+          send_device_to_host_stream, device_context->host_memory_allocator());
+    }
+    if (staging_ring != nullptr) {
+      s = staging_ring->CopyFromDevice(send_device_to_host_stream, gpu_src_ptr,
+                                       dst_ptr, total_bytes);
+    } else {
+      s = send_device_to_host_stream->Memcpy(dst_ptr, gpu_src_ptr,
+                                             total_bytes);
+    }
     if (!s.ok()) {
       done(s);
       return;
@@ -458,7 +605,17 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
       }
     }
 
-    if (do_staging) {
+    PinnedStagingRing* staging_ring = nullptr;
+    if (do_staging && total_bytes > kStagingChunkBytes) {
+      staging_ring = PinnedStagingRing::Get(recv_host_to_device_stream,
+                                            host_memory_allocator);
+    }
+
+    if (staging_ring != nullptr) {
+      s = staging_ring->CopyToDevice(recv_host_to_device_stream, src_ptr,
+                                     &gpu_dst_ptr, total_bytes);
+      input_ref.Unref();
+    } else if (do_staging) {
       staging_buffer = host_memory_allocator->AllocateRaw(
           tensorflow::Allocator::kAllocatorAlignment, total_bytes);
       std::memcpy(staging_buffer, src_ptr, total_bytes);
@@ -497,10 +654,10 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
       recv_host_to_device_stream,
       [recv_host_to_device_stream, done, input_ref, do_staging, staging_buffer,
        host_memory_allocator, merge_host_to_device_stream]() {
-        if (do_staging) {
-          host_memory_allocator->DeallocateRaw(staging_buffer);
-        } else {
+        if (!do_staging) {
           input_ref.Unref();
+        } else if (staging_buffer != nullptr) {
+          host_memory_allocator->DeallocateRaw(staging_buffer);
         }
         if (!merge_host_to_device_stream) {
           if (!recv_host_to_device_stream->ok()) {
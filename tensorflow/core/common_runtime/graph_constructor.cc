@@ -51,8 +51,11 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/scanner.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/public/version.h"
 
 namespace tensorflow {
@@ -244,6 +247,12 @@ class GraphConstructor {
   Status IsNodeFullyMapped(const NodeDef& node_def, bool* is_node_mapped);
   Status ValidateColocationConstraints(const NodeDef& node_def);
   Status MakeNode(NodeDef&& node_def, Node** node);
+  // Looks up the OpDef of `node_def`, adds the default attrs and validates it
+  // as requested by opts_.
+  Status PrepareNodeDef(NodeDef* node_def);
+  // Runs PrepareNodeDef() on all the NodeDefs on multiple threads ahead of
+  // Convert() if the graph is large and the NodeDefs can be mutated in place.
+  void PrepareNodeDefsInParallel();
   Status MakeEdge(Node* src, int output_index, Node* dst, int input_index);
   Status ValidateShape(Node* node);
   Status ModifyNodeDefForImport(NodeDef* node_def);
@@ -300,6 +309,9 @@ class GraphConstructor {
   // possible. After calling this method, the result of get_node_def(i) is
   // undefined.
   virtual NodeDef consume_node_def(int i) = 0;
+  // Returns the i^th node in the graph to be modified in place, or nullptr if
+  // the nodes are not owned. Must not be called after consume_node_def(i).
+  virtual NodeDef* mutable_node_def(int i) { return nullptr; }
   // Returns the version information for the graph, or nullptr if none is
   // available.
   virtual const VersionDef* versions() const = 0;
@@ -406,6 +418,10 @@ class GraphConstructor {
   };
   std::vector<EdgeInfo> back_edges_;
 
+  // The result of PrepareNodeDef() for each NodeDef, or empty if the NodeDefs
+  // were not prepared ahead of Convert().
+  std::vector<Status> prepare_node_def_status_;
+
   GraphConstructor(const GraphConstructor&) = delete;
   void operator=(const GraphConstructor&) = delete;
 };
@@ -477,6 +493,11 @@ class NodeDefMovingGraphConstructor : public GraphConstructor {
     is_consumed_[i] = true;
     return std::move(*graph_def_.mutable_node(i));
   }
+  NodeDef* mutable_node_def(int i) override {
+    CHECK(!is_consumed_[i])
+        << "NodeDef " << i << " accessed after it was consumed.";
+    return graph_def_.mutable_node(i);
+  }
   const VersionDef* versions() const override { return &graph_def_.versions(); }
   std::optional<FunctionDefLibrary> consume_library() override {
     return std::move(*graph_def_.mutable_library());
@@ -1161,6 +1182,42 @@ GraphConstructor::CreateStackTracesForFunctionDefLibrary(
   }
 }
 
+Status GraphConstructor::PrepareNodeDef(NodeDef* node_def) {
+  const OpDef* op_def;
+  TF_RETURN_IF_ERROR(g_->op_registry()->LookUpOpDef(node_def->op(), &op_def));
+  if (opts_.add_default_attributes) {
+    AddDefaultsToNodeDef(*op_def, node_def);
+  }
+  if (opts_.validate_nodes) {
+    TF_RETURN_IF_ERROR(ValidateNodeDef(*node_def, *op_def));
+  }
+  return absl::OkStatus();
+}
+
+void GraphConstructor::PrepareNodeDefsInParallel() {
+  // Below this many nodes, the preparation is too cheap to be worth the
+  // threads.
+  constexpr int kMinNodesToPrepareInParallel = 10000;
+  const int num_nodes = node_def_count();
+  const int num_threads = std::min(port::MaxParallelism(), 16);
+  if (num_nodes < kMinNodesToPrepareInParallel || num_threads <= 1 ||
+      mutable_node_def(0) == nullptr) {
+    return;
+  }
+
+  // The errors are only returned when the nodes are reached by Convert(), so
+  // that the same error is returned as without preparing them ahead of time.
+  prepare_node_def_status_.resize(num_nodes);
+  thread::ThreadPool pool(Env::Default(), "graph_constructor", num_threads);
+  pool.ParallelFor(num_nodes, /*cost_per_unit=*/10000,
+                   [this](int64_t begin, int64_t end) {
+                     for (int64_t i = begin; i < end; ++i) {
+                       prepare_node_def_status_[i] =
+                           PrepareNodeDef(mutable_node_def(i));
+                     }
+                   });
+}
+
 Status GraphConstructor::Convert() {
   if (debug_info() != nullptr) {
     traces_ = LoadTracesFromDebugInfo(*debug_info());
@@ -1185,6 +1242,18 @@ Status GraphConstructor::Convert() {
         g_->AddFunctionLibrary(*std::move(library), library_traces));
   }
 
+  // The NodeDefs are only modified independently of the graph being built
+  // when not importing.
+  if (!opts_.importing) PrepareNodeDefsInParallel();
+
+  // Every input of a NodeDef becomes an edge, so the requested storage is
+  // only exceeded by the edges added to the source and sink nodes.
+  int num_inputs = 0;
+  for (int i = 0; i < node_def_count(); ++i) {
+    num_inputs += get_node_def(i).input_size();
+  }
+  g_->Reserve(node_def_count(), num_inputs);
+
   std::vector<InputInfo> inputs;
   int processed = 0;
 
@@ -1297,16 +1366,10 @@ Status GraphConstructor::Convert() {
 
     if (opts_.importing) {
       TF_RETURN_IF_ERROR(ModifyNodeDefForImport(&node_def));
+    } else if (!prepare_node_def_status_.empty()) {
+      TF_RETURN_IF_ERROR(prepare_node_def_status_[o]);
     } else {
-      const OpDef* op_def;
-      TF_RETURN_IF_ERROR(
-          g_->op_registry()->LookUpOpDef(node_def.op(), &op_def));
-      if (opts_.add_default_attributes) {
-        AddDefaultsToNodeDef(*op_def, &node_def);
-      }
-      if (opts_.validate_nodes) {
-        TF_RETURN_IF_ERROR(ValidateNodeDef(node_def, *op_def));
-      }
+      TF_RETURN_IF_ERROR(PrepareNodeDef(&node_def));
     }
 
     TF_RETURN_IF_ERROR(MakeNode(std::move(node_def), &node));
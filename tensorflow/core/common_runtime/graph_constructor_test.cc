@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/version.h"
 
@@ -3510,5 +3511,66 @@ TEST_F(GraphConstructorTest,
             "File \"delta.cc\", line 34, in jape");
 }
 
+// Returns a chain of `num_nodes` TestOneInputOneOutput nodes fed by a
+// TestParams node.
+GraphDef MakeChainGraphDef(int num_nodes) {
+  GraphDef gdef;
+  NodeDef* params = gdef.add_node();
+  params->set_name("params");
+  params->set_op("TestParams");
+  for (int i = 0; i < num_nodes; ++i) {
+    NodeDef* node = gdef.add_node();
+    node->set_name(strings::StrCat("n", i));
+    node->set_op("TestOneInputOneOutput");
+    node->add_input(i == 0 ? "params" : strings::StrCat("n", i - 1));
+    (*node->mutable_attr())["T"].set_type(DT_FLOAT);
+  }
+  return gdef;
+}
+
+TEST_F(GraphConstructorTest, ConvertLargeGraphDefByMove) {
+  // Large enough for the NodeDefs to be prepared on multiple threads.
+  GraphDef gdef = MakeChainGraphDef(20000);
+  NodeDef* node = gdef.add_node();
+  node->set_name("default_attr");
+  node->set_op("TestDefaultAttr");
+
+  GraphConstructorOptions opts;
+  TF_ASSERT_OK(ConvertGraphDefToGraph(opts, std::move(gdef), &graph_));
+  EXPECT_TRUE(HasNode("n19999"));
+  EXPECT_TRUE(HasEdge("n19998", 0, "n19999", 0));
+  Node* default_attr = FindNode("default_attr");
+  ASSERT_NE(default_attr, nullptr);
+  int64_t value;
+  TF_ASSERT_OK(GetNodeAttr(default_attr->attrs(), "default_int", &value));
+  EXPECT_EQ(value, 31415);
+}
+
+TEST_F(GraphConstructorTest, ConvertLargeGraphDefByMoveReportsFirstError) {
+  GraphDef gdef = MakeChainGraphDef(20000);
+  gdef.mutable_node(10)->set_op("DoesNotExist");
+  gdef.mutable_node(20)->mutable_attr()->erase("T");
+
+  GraphConstructorOptions opts;
+  Status s = ConvertGraphDefToGraph(opts, std::move(gdef), &graph_);
+  EXPECT_TRUE(errors::IsNotFound(s)) << s;
+  EXPECT_TRUE(absl::StrContains(s.message(), "DoesNotExist")) << s;
+}
+
+void BM_ConvertGraphDefToGraph(::testing::benchmark::State& state) {
+  const int num_nodes = state.range(0);
+  const GraphDef gdef = MakeChainGraphDef(num_nodes);
+  GraphConstructorOptions opts;
+  for (auto s : state) {
+    state.PauseTiming();
+    GraphDef copy = gdef;
+    Graph graph(OpRegistry::Global());
+    state.ResumeTiming();
+    TF_CHECK_OK(ConvertGraphDefToGraph(opts, std::move(copy), &graph));
+  }
+  state.SetItemsProcessed(state.iterations() * num_nodes);
+}
+BENCHMARK(BM_ConvertGraphDefToGraph)->Arg(1000)->Arg(100000)->Arg(1000000);
+
 }  // namespace
 }  // namespace tensorflow
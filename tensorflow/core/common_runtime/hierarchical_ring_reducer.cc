@@ -0,0 +1,332 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_ring_reducer.h"
+
+#include <algorithm>
+#include <map>
+#include <utility>
+
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+namespace {
+
+// Phases of the algorithm, which are part of the buffer keys.
+constexpr int kIntraHostReduceScatter = 0;
+constexpr int kInterHostReduceScatter = 1;
+constexpr int kInterHostAllGather = 2;
+constexpr int kIntraHostAllGather = 3;
+
+int Mod(int a, int n) { return ((a % n) + n) % n; }
+
+}  // namespace
+
+HierarchicalRingReducer::HierarchicalRingReducer()
+    : col_ctx_(nullptr),
+      col_params_(nullptr),
+      num_hosts_(0),
+      num_local_devices_(0),
+      host_index_(-1),
+      local_index_(-1) {}
+
+Status HierarchicalRingReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  if (col_params->instance.type != REDUCTION_COLLECTIVE) {
+    return errors::Internal("HierarchicalRingReduce expects a reduction, got ",
+                            col_params->instance.type);
+  }
+  if (col_params->group.device_type != DEVICE_CPU) {
+    return errors::Unimplemented(
+        "HierarchicalRingReduce only supports CPU devices, got ",
+        col_params->group.device_type.type_string());
+  }
+  return absl::OkStatus();
+}
+
+Status HierarchicalRingReducer::InitializeCollectiveContext(
+    std::shared_ptr<CollectiveContext> col_ctx) {
+  DCHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = col_ctx->col_params.get();
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+/* static */ std::vector<std::vector<int>>
+HierarchicalRingReducer::ComputeHostTopology(
+    const CollectiveParams& col_params) {
+  const std::vector<CollGroupMember>& members = col_params.group.members;
+  std::map<string, std::vector<int>> ranks_by_task;
+  for (int rank = 0; rank < members.size(); ++rank) {
+    ranks_by_task[members[rank].task].push_back(rank);
+  }
+  std::vector<std::vector<int>> hosts;
+  hosts.reserve(ranks_by_task.size());
+  for (auto& [task, ranks] : ranks_by_task) {
+    // Devices sharing a NUMA node are adjacent, so that the intra-host
+    // exchanges of neighbouring devices mostly stay within a node.
+    std::stable_sort(ranks.begin(), ranks.end(), [&members](int a, int b) {
+      return members[a].device.locality().numa_node() <
+             members[b].device.locality().numa_node();
+    });
+    if (!hosts.empty() && hosts.front().size() != ranks.size()) {
+      VLOG(1) << "HierarchicalRingReduce: tasks have different numbers of "
+                 "devices, falling back to a flat ring";
+      hosts.clear();
+      for (int rank = 0; rank < members.size(); ++rank) {
+        hosts.push_back({rank});
+      }
+      return hosts;
+    }
+    hosts.push_back(std::move(ranks));
+  }
+  return hosts;
+}
+
+void HierarchicalRingReducer::Run(StatusCallback done) {
+  CHECK(col_ctx_);
+  CHECK(col_params_);
+  // Like `RingReducer`, this doesn't require non-overlapping collectives.
+  col_ctx_->col_exec->UnblockDependencies(*col_params_);
+
+  hosts_ = ComputeHostTopology(*col_params_);
+  num_hosts_ = hosts_.size();
+  num_local_devices_ = hosts_[0].size();
+  for (int h = 0; h < num_hosts_; ++h) {
+    for (int l = 0; l < num_local_devices_; ++l) {
+      if (hosts_[h][l] == col_params_->default_rank) {
+        host_index_ = h;
+        local_index_ = l;
+      }
+    }
+  }
+  VLOG(1) << "HierarchicalRingReducer::Run for device "
+          << col_ctx_->device_name << " default_rank "
+          << col_params_->default_rank << " hosts " << num_hosts_
+          << " local devices " << num_local_devices_ << " host_index "
+          << host_index_ << " local_index " << local_index_;
+
+  // Start by copying input to output if they're not already the same, i.e. if
+  // we're not computing in-place on the input tensor.
+  if ((col_ctx_->input != col_ctx_->output) &&
+      (DMAHelper::base(col_ctx_->input) != DMAHelper::base(col_ctx_->output))) {
+    Notification note;
+    Status status;
+    CollectiveRemoteAccessLocal::MemCpyAsync(
+        col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->op_device_context(), col_ctx_->device,
+        col_ctx_->device, col_ctx_->op_ctx->input_alloc_attr(0),
+        col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->input,
+        col_ctx_->output, 0 /*dev_to_dev_stream_index*/,
+        [&note, &status](const Status& s) {
+          status.Update(s);
+          note.Notify();
+        });
+    note.WaitForNotification();
+    if (!status.ok()) {
+      done(status);
+      return;
+    }
+  }
+
+  AllocatorAttributes attr = col_ctx_->op_ctx->output_alloc_attr(0);
+  ca_.reset(MakeCollectiveAdapter(col_ctx_->output,
+                                  num_hosts_ * num_local_devices_,
+                                  col_ctx_->device->GetAllocator(attr)));
+  Status status = ReduceScatterWithinHost();
+  if (status.ok()) status = AllReduceAcrossHosts();
+  if (status.ok()) status = AllGatherWithinHost();
+  if (status.ok()) ca_->ConsumeFinalValue(col_ctx_->output);
+  ca_.reset();
+  done(status);
+}
+
+Status HierarchicalRingReducer::ReduceScatterWithinHost() {
+  tsl::profiler::TraceMe activity("IntraHostReduceScatter",
+                                  tsl::profiler::TraceMeLevel::kInfo);
+  // At step s, the device sends the part of the tensor owned by the local
+  // device s places after it, and merges the part it owns received from the
+  // local device s places before it.
+  for (int step = 1; step < num_local_devices_; ++step) {
+    const int dst = Mod(local_index_ + step, num_local_devices_);
+    const int src = Mod(local_index_ - step, num_local_devices_);
+    std::vector<Tensor> send_chunks(num_hosts_);
+    std::vector<Tensor> recv_chunks(num_hosts_);
+    std::vector<Transfer> sends;
+    std::vector<Transfer> recvs;
+    for (int sub = 0; sub < num_hosts_; ++sub) {
+      const int send_chunk = ChunkIndex(dst, sub);
+      const int recv_chunk = ChunkIndex(local_index_, sub);
+      send_chunks[sub] = ca_->ChunkAlias(send_chunk);
+      recv_chunks[sub] = ca_->TempChunk(recv_chunk);
+      sends.push_back({Rank(host_index_, dst), send_chunk, &send_chunks[sub]});
+      recvs.push_back({Rank(host_index_, src), recv_chunk, &recv_chunks[sub]});
+    }
+    TF_RETURN_IF_ERROR(Exchange(kIntraHostReduceScatter, step, sends, recvs));
+    for (int sub = 0; sub < num_hosts_; ++sub) {
+      Tensor chunk = ca_->ChunkAlias(ChunkIndex(local_index_, sub));
+      TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+          col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+          col_params_->merge_op, &chunk, &recv_chunks[sub]));
+    }
+  }
+  return absl::OkStatus();
+}
+
+Status HierarchicalRingReducer::AllReduceAcrossHosts() {
+  tsl::profiler::TraceMe activity("InterHostAllReduce",
+                                  tsl::profiler::TraceMeLevel::kInfo);
+  const int next = Rank(Mod(host_index_ + 1, num_hosts_), local_index_);
+  const int prev = Rank(Mod(host_index_ - 1, num_hosts_), local_index_);
+  // Reduce-scatter the part of the tensor owned by this device across the
+  // corresponding devices of all hosts.
+  for (int step = 0; step < num_hosts_ - 1; ++step) {
+    const int send_chunk =
+        ChunkIndex(local_index_, Mod(host_index_ - step, num_hosts_));
+    const int recv_chunk =
+        ChunkIndex(local_index_, Mod(host_index_ - step - 1, num_hosts_));
+    Tensor send_tensor = ca_->ChunkAlias(send_chunk);
+    Tensor recv_tensor = ca_->TempChunk(recv_chunk);
+    TF_RETURN_IF_ERROR(Exchange(kInterHostReduceScatter, step,
+                                {{next, send_chunk, &send_tensor}},
+                                {{prev, recv_chunk, &recv_tensor}}));
+    Tensor chunk = ca_->ChunkAlias(recv_chunk);
+    TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->merge_op, &chunk, &recv_tensor));
+  }
+
+  // This device now holds the reduction of the whole group for one chunk.
+  const int reduced_sub = Mod(host_index_ + 1, num_hosts_);
+  if (col_params_->final_op) {
+    Tensor chunk = ca_->ChunkAlias(ChunkIndex(local_index_, reduced_sub));
+    Tensor group_size = ca_->Scalar(col_params_->group.group_size);
+    TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->final_op, &chunk, &group_size));
+  }
+
+  // All-gather the reduced chunks around the same ring.
+  for (int step = 0; step < num_hosts_ - 1; ++step) {
+    const int send_chunk =
+        ChunkIndex(local_index_, Mod(reduced_sub - step, num_hosts_));
+    const int recv_chunk =
+        ChunkIndex(local_index_, Mod(host_index_ - step, num_hosts_));
+    Tensor send_tensor = ca_->ChunkAlias(send_chunk);
+    Tensor recv_tensor = ca_->ChunkAlias(recv_chunk);
+    TF_RETURN_IF_ERROR(Exchange(kInterHostAllGather, step,
+                                {{next, send_chunk, &send_tensor}},
+                                {{prev, recv_chunk, &recv_tensor}}));
+  }
+  return absl::OkStatus();
+}
+
+Status HierarchicalRingReducer::AllGatherWithinHost() {
+  tsl::profiler::TraceMe activity("IntraHostAllGather",
+                                  tsl::profiler::TraceMeLevel::kInfo);
+  for (int step = 1; step < num_local_devices_; ++step) {
+    const int dst = Mod(local_index_ + step, num_local_devices_);
+    const int src = Mod(local_index_ - step, num_local_devices_);
+    std::vector<Tensor> send_chunks(num_hosts_);
+    std::vector<Tensor> recv_chunks(num_hosts_);
+    std::vector<Transfer> sends;
+    std::vector<Transfer> recvs;
+    for (int sub = 0; sub < num_hosts_; ++sub) {
+      const int send_chunk = ChunkIndex(local_index_, sub);
+      const int recv_chunk = ChunkIndex(src, sub);
+      send_chunks[sub] = ca_->ChunkAlias(send_chunk);
+      recv_chunks[sub] = ca_->ChunkAlias(recv_chunk);
+      sends.push_back({Rank(host_index_, dst), send_chunk, &send_chunks[sub]});
+      recvs.push_back({Rank(host_index_, src), recv_chunk, &recv_chunks[sub]});
+    }
+    TF_RETURN_IF_ERROR(Exchange(kIntraHostAllGather, step, sends, recvs));
+  }
+  return absl::OkStatus();
+}
+
+Status HierarchicalRingReducer::Exchange(int phase, int step,
+                                         const std::vector<Transfer>& sends,
+                                         const std::vector<Transfer>& recvs) {
+  const int rank = col_params_->default_rank;
+  const std::vector<CollGroupMember>& members = col_params_->group.members;
+  CancellationManager* cancel_mgr = col_ctx_->op_ctx->cancellation_manager();
+  BlockingCounter pending(sends.size() + recvs.size());
+  mutex mu;
+  Status status;
+  auto done = [this, &pending, &mu, &status, cancel_mgr](const Status& s) {
+    if (!s.ok()) {
+      bool abort_started = false;
+      {
+        mutex_lock l(mu);
+        abort_started = status.ok();
+        status.Update(s);
+      }
+      // As in `RingAlg`, abort the other outstanding transfers of the group
+      // unless this is a cancellation, which already cancels them.
+      if (abort_started &&
+          (cancel_mgr == nullptr ||
+           (!cancel_mgr->IsCancelled() && !cancel_mgr->IsCancelling()))) {
+        col_ctx_->col_exec->StartAbort(s);
+      }
+    }
+    pending.DecrementCount();
+  };
+  for (const Transfer& send : sends) {
+    const CollGroupMember& peer = members[send.peer_rank];
+    col_ctx_->col_exec->remote_access()->PostToPeer(
+        peer.device.name(), peer.task,
+        strings::StrCat(col_ctx_->exec_key, ":", phase, ":", step, ":",
+                        send.chunk, ":", rank, ":", send.peer_rank),
+        col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->output_alloc_attr(0), send.tensor,
+        col_ctx_->device_locality, cancel_mgr, done);
+  }
+  for (const Transfer& recv : recvs) {
+    const CollGroupMember& peer = members[recv.peer_rank];
+    col_ctx_->col_exec->remote_access()->RecvFromPeer(
+        peer.device.name(), peer.task, peer.is_local,
+        strings::StrCat(col_ctx_->exec_key, ":", phase, ":", step, ":",
+                        recv.chunk, ":", recv.peer_rank, ":", rank),
+        col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->output_alloc_attr(0), recv.tensor,
+        col_ctx_->device_locality, 0 /*dev_to_dev_stream_index*/, cancel_mgr,
+        done);
+  }
+  pending.Wait();
+  mutex_lock l(mu);
+  return status;
+}
+
+namespace {
+REGISTER_COLLECTIVE(HierarchicalRingReduce, HierarchicalRingReducer);
+}  // namespace
+
+}  // namespace tensorflow
@@ -0,0 +1,102 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+
+namespace tensorflow {
+class Device;
+
+// Topology-aware implementation of collective all-reduce for CPU devices.
+//
+// The members of the group are arranged into hosts by task, and the devices of
+// each host are ordered by NUMA node. With H hosts of m devices each, the
+// tensor is split into m * H chunks and reduced in three phases:
+// 1. Intra-host reduce-scatter: each device directly exchanges with every
+//    other device of its host, after which device l of each host holds the
+//    host-wide sum of its 1/m of the tensor.
+// 2. Inter-host ring all-reduce: the l-th devices of all hosts run a ring
+//    all-reduce on that 1/m of the tensor, so only 1/m of the data crosses
+//    host boundaries per device.
+// 3. Intra-host all-gather: each device sends its fully reduced 1/m of the
+//    tensor to every other device of its host.
+//
+// If the hosts have different numbers of devices, every device is treated as
+// its own host, and the algorithm degenerates to a flat ring all-reduce.
+class HierarchicalRingReducer : public CollectiveImplementationInterface {
+ public:
+  HierarchicalRingReducer();
+  ~HierarchicalRingReducer() override = default;
+
+  // Begins execution of the hierarchical reduce.  Must be called in a
+  // blockable thread, as each step waits for its transfers to complete.
+  void Run(StatusCallback done) override;
+
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  Status InitializeCollectiveContext(
+      std::shared_ptr<CollectiveContext> col_ctx) override;
+
+  // Returns the ranks of the devices of each host, as used by the algorithm.
+  // All hosts have the same number of devices.
+  static std::vector<std::vector<int>> ComputeHostTopology(
+      const CollectiveParams& col_params);
+
+ private:
+  // A chunk of the tensor sent to or received from the device `peer_rank`.
+  struct Transfer {
+    int peer_rank;
+    int chunk;
+    Tensor* tensor;
+  };
+
+  // Sends `sends` and receives `recvs`, and blocks until all the transfers
+  // are done.  Aborts the collective on the first error.
+  Status Exchange(int phase, int step, const std::vector<Transfer>& sends,
+                  const std::vector<Transfer>& recvs);
+
+  Status ReduceScatterWithinHost();
+  Status AllReduceAcrossHosts();
+  Status AllGatherWithinHost();
+
+  // Returns the index of the chunk holding `subchunk` of the `local_index`-th
+  // 1/m of the tensor.
+  int ChunkIndex(int local_index, int subchunk) const {
+    return local_index * num_hosts_ + subchunk;
+  }
+  int Rank(int host_index, int local_index) const {
+    return hosts_[host_index][local_index];
+  }
+
+  std::shared_ptr<CollectiveContext> col_ctx_;
+  const CollectiveParams* col_params_;  // Not owned
+  std::unique_ptr<CollectiveAdapter> ca_;
+  std::vector<std::vector<int>> hosts_;
+  int num_hosts_;
+  int num_local_devices_;
+  int host_index_;
+  int local_index_;
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
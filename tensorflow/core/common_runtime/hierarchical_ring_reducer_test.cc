@@ -0,0 +1,215 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_ring_reducer.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_test_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+std::unique_ptr<OpKernel> GetBinOp(const string& op, DataType dtype,
+                                   const DeviceType& device_type,
+                                   DeviceBase* device) {
+  NodeDef node_def;
+  NodeDefBuilder builder(strings::StrCat(op, "_node"), op);
+  TF_CHECK_OK(builder.Attr("T", dtype)
+                  .Input(FakeInput(dtype))
+                  .Input(FakeInput(dtype))
+                  .Finalize(&node_def));
+  Status status;
+  std::unique_ptr<OpKernel> k = CreateOpKernel(
+      device_type, device, device->GetAllocator(AllocatorAttributes()),
+      node_def, TF_GRAPH_DEF_VERSION, &status);
+  TF_CHECK_OK(status);
+  return k;
+}
+
+class HierarchicalRingReducerTest : public ::testing::Test {
+ protected:
+  void Init(int num_workers, int num_devices, DataType dtype,
+            const TensorShape& shape, int fail_after) {
+    test_env_ = CreateCollectiveTestEnv(num_workers, num_devices, DEVICE_CPU);
+    test_env_->remote_access->set_fail_after(fail_after);
+    for (int wi = 0; wi < num_workers; ++wi) {
+      for (int di = 0; di < num_devices; ++di) {
+        int rank = wi * num_devices + di;
+        instances_.push_back(std::make_unique<DeviceInstance>(
+            rank, dtype, shape, test_env_.get()));
+      }
+    }
+  }
+
+  void Reduce() {
+    std::atomic<int> done(0);
+    for (auto& di : instances_) {
+      SchedClosure([&di, &done] {
+        di->DoReduce();
+        ++done;
+      });
+    }
+    while (done < static_cast<int>(instances_.size())) {
+      Env::Default()->SleepForMicroseconds(1000);
+    }
+  }
+
+  template <typename T>
+  void RunTest(DataType dtype, int num_workers, int num_devices,
+               int tensor_len, int fail_after) {
+    Init(num_workers, num_devices, dtype, TensorShape({tensor_len}),
+         fail_after);
+    std::vector<T> expected(tensor_len);
+    for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+      Tensor* t = &instances_[di]->tensor_;
+      for (int i = 0; i < tensor_len; ++i) {
+        T value = static_cast<T>(di * 10 + i);
+        t->flat<T>()(i) = value;
+        expected[i] += value;
+      }
+    }
+    Reduce();
+    if (fail_after > 0) {
+      for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+        EXPECT_FALSE(instances_[di]->status_.ok());
+      }
+      return;
+    }
+    for (int i = 0; i < tensor_len; ++i) {
+      expected[i] /= static_cast<T>(num_workers * num_devices);
+    }
+    for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+      TF_EXPECT_OK(instances_[di]->status_);
+      test::ExpectTensorEqual<T>(test::AsTensor<T>(expected),
+                                 instances_[di]->tensor_);
+    }
+  }
+
+  class DeviceInstance {
+   public:
+    DeviceInstance(int rank, DataType dtype, const TensorShape& shape,
+                   CollectiveTestEnv* test_env)
+        : test_env_(test_env), tensor_(dtype, shape) {
+      col_params_ =
+          CreateCollectiveParams(*test_env_, rank, "HierarchicalRingReduce",
+                                 REDUCTION_COLLECTIVE, dtype, shape);
+      string dev_name = col_params_->group.members[rank].device.name();
+      TF_CHECK_OK(test_env_->device_mgr->LookupDevice(dev_name, &device_))
+          << "Couldn't find device " << dev_name
+          << " existing devices: " << test_env_->device_mgr->DebugString();
+      merge_op_ = GetBinOp("Add", dtype, DEVICE_CPU, device_);
+      final_op_ = GetBinOp("Div", dtype, DEVICE_CPU, device_);
+      col_params_->merge_op = merge_op_.get();
+      col_params_->final_op = final_op_.get();
+    }
+
+    void DoReduce() {
+      status_ = RunCollective(test_env_, col_params_.get(), device_, &tensor_,
+                              &tensor_);
+    }
+
+    CollectiveTestEnv* test_env_;
+    Tensor tensor_;
+    Device* device_;
+    core::RefCountPtr<CollectiveParams> col_params_;
+    std::unique_ptr<OpKernel> merge_op_;
+    std::unique_ptr<OpKernel> final_op_;
+    Status status_;
+  };
+
+  std::unique_ptr<CollectiveTestEnv> test_env_;
+  std::vector<std::unique_ptr<DeviceInstance>> instances_;
+};
+
+core::RefCountPtr<CollectiveParams> MakeGroup(
+    const std::vector<std::vector<int>>& numa_nodes) {
+  core::RefCountPtr<CollectiveParams> col_params(new CollectiveParams());
+  for (int wi = 0; wi < numa_nodes.size(); ++wi) {
+    for (int di = 0; di < numa_nodes[wi].size(); ++di) {
+      CollGroupMember member;
+      member.task = strings::StrCat("/job:worker/replica:0/task:", wi);
+      member.device.set_name(strings::StrCat(member.task, "/device:CPU:", di));
+      member.device.mutable_locality()->set_numa_node(numa_nodes[wi][di]);
+      col_params->group.members.push_back(member);
+    }
+  }
+  col_params->group.group_size = col_params->group.members.size();
+  return col_params;
+}
+
+TEST(HierarchicalRingReducerTopologyTest, GroupsDevicesByTaskAndNumaNode) {
+  core::RefCountPtr<CollectiveParams> col_params =
+      MakeGroup({{1, 0, 1, 0}, {0, 0, 1, 1}});
+  EXPECT_EQ(HierarchicalRingReducer::ComputeHostTopology(*col_params),
+            std::vector<std::vector<int>>({{1, 3, 0, 2}, {4, 5, 6, 7}}));
+}
+
+TEST(HierarchicalRingReducerTopologyTest, UnevenTasksUseFlatRing) {
+  core::RefCountPtr<CollectiveParams> col_params = MakeGroup({{0, 0, 0}, {0}});
+  EXPECT_EQ(HierarchicalRingReducer::ComputeHostTopology(*col_params),
+            std::vector<std::vector<int>>({{0}, {1}, {2}, {3}}));
+}
+
+#define DEF_TEST(B, W, D, L, A)                                 \
+  TEST_F(HierarchicalRingReducerTest,                           \
+         DaTy##B##_WoSi##W##_DevPerWi##D##_Len##L##_Abrt##A) {  \
+    DataType dtype = DT_##B;                                    \
+    switch (dtype) {                                            \
+      case DT_FLOAT: {                                          \
+        RunTest<float>(dtype, W, D, L, A);                      \
+      } break;                                                  \
+      case DT_DOUBLE: {                                         \
+        RunTest<double>(dtype, W, D, L, A);                     \
+      } break;                                                  \
+      case DT_INT64: {                                          \
+        RunTest<int64_t>(dtype, W, D, L, A);                    \
+      } break;                                                  \
+      default:                                                  \
+        LOG(FATAL) << "Unimplemented";                          \
+    }                                                           \
+  }
+
+// Single task, intra-host phases only.
+DEF_TEST(FLOAT, 1, 4, 1001, 0)
+// One device per task, inter-host ring only.
+DEF_TEST(FLOAT, 4, 1, 1001, 0)
+DEF_TEST(FLOAT, 2, 4, 1, 0)
+DEF_TEST(FLOAT, 2, 4, 128, 0)
+DEF_TEST(FLOAT, 3, 2, 4095, 0)
+DEF_TEST(FLOAT, 4, 4, 1045991, 0)
+DEF_TEST(DOUBLE, 2, 8, 4095, 0)
+DEF_TEST(INT64, 3, 4, 1001, 0)
+DEF_TEST(FLOAT, 2, 4, 4095, 5)
+
+}  // namespace
+}  // namespace tensorflow
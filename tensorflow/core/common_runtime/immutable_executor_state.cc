@@ -15,10 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/immutable_executor_state.h"
 
+#include <algorithm>
+
 #include "absl/memory/memory.h"
+#include "tensorflow/core/framework/device.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/edgeset.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_node_util.h"
@@ -259,9 +263,73 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
   // Initialize PendingCounts only after pending_ids_[node.id] is initialized
   // for all nodes.
   InitializePending(&graph, cf_info);
+  TF_RETURN_IF_ERROR(InitializeDeviceContexts(graph));
+  InitializeCriticalPathLengths(graph);
   return gview_.SetAllocAttrs(&graph, params_.device);
 }
 
+Status ImmutableExecutorState::InitializeDeviceContexts(const Graph& graph) {
+  std::vector<DeviceContext*> contexts;
+  TF_RETURN_IF_ERROR(params_.device->FillContextMap(&graph, &contexts));
+  if (contexts.empty()) return absl::OkStatus();
+  contexts.resize(graph.num_node_ids(), nullptr);
+
+  // Asynchronous kernels may complete on threads and streams of their own, so
+  // they always run with the default context.
+  bool uses_other_contexts = false;
+  for (const Node* n : graph.nodes()) {
+    const NodeItem* item = gview_.node(n->id());
+    if (item == nullptr || item->kernel_is_async) {
+      contexts[n->id()] = nullptr;
+    } else if (contexts[n->id()] != nullptr) {
+      uses_other_contexts = true;
+    }
+  }
+  if (!uses_other_contexts) return absl::OkStatus();
+
+  node_wait_device_contexts_.resize(graph.num_node_ids());
+  for (const Node* n : graph.nodes()) {
+    DeviceContext* context = contexts[n->id()];
+    auto& wait_contexts = node_wait_device_contexts_[n->id()];
+    for (const Edge* e : n->in_edges()) {
+      DeviceContext* src_context = contexts[e->src()->id()];
+      if (src_context != context &&
+          std::find(wait_contexts.begin(), wait_contexts.end(), src_context) ==
+              wait_contexts.end()) {
+        wait_contexts.push_back(src_context);
+      }
+    }
+  }
+  node_device_contexts_ = std::move(contexts);
+  return absl::OkStatus();
+}
+
+void ImmutableExecutorState::InitializeCriticalPathLengths(
+    const Graph& graph) {
+  // In post order every node comes after its consumers, except for the
+  // consumers of NextIteration nodes, whose edges are skipped.
+  std::vector<Node*> post_order;
+  GetPostOrder(graph, &post_order, /*stable_comparator=*/{},
+               /*edge_filter=*/[](const Edge& e) {
+                 return !IsNextIteration(e.src());
+               });
+  critical_path_lengths_.assign(graph.num_node_ids(), 0);
+  for (const Node* n : post_order) {
+    int32 length = 0;
+    if (!IsNextIteration(n)) {
+      for (const Edge* e : n->out_edges()) {
+        length = std::max(length, critical_path_lengths_[e->dst()->id()]);
+      }
+    }
+    const NodeItem* item = gview_.node(n->id());
+    if (item != nullptr && item->kernel != nullptr &&
+        item->kernel->IsExpensive()) {
+      ++length;
+    }
+    critical_path_lengths_[n->id()] = length;
+  }
+}
+
 namespace {
 // If a Node has been marked to use a ScopedAllocator x for output i, then
 // sc_attr will contain the subsequence (i, x) at an even offset.  This function
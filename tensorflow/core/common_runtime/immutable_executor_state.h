@@ -21,9 +21,11 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
 #include "tensorflow/core/common_runtime/graph_view.h"
 #include "tensorflow/core/common_runtime/local_executor_params.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
+#include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
@@ -101,6 +103,30 @@ class ImmutableExecutorState {
 
   bool requires_control_flow_support() const { return requires_control_flow_; }
 
+  // Returns the DeviceContext the node `id` runs with, or nullptr if it runs
+  // with the default context of the executor.
+  DeviceContext* device_context(int id) const {
+    return node_device_contexts_.empty() ? nullptr : node_device_contexts_[id];
+  }
+
+  // Returns the device contexts, other than device_context(id), whose work the
+  // node `id` must wait for, or nullptr if there are none.
+  const absl::InlinedVector<DeviceContext*, 2UL>* wait_device_contexts(
+      int id) const {
+    if (node_wait_device_contexts_.empty() ||
+        node_wait_device_contexts_[id].empty()) {
+      return nullptr;
+    }
+    return &node_wait_device_contexts_[id];
+  }
+
+  // Returns the number of nodes with an expensive kernel on the longest path
+  // from the node `id` to the sink, ignoring loop back edges. The executor
+  // dispatches ready nodes with longer paths first.
+  int32 critical_path_length(int id) const {
+    return critical_path_lengths_[id];
+  }
+
   // Copies the pending counts for nodes in this graph to the given array.
   //
   // This method provides a more efficient way of initializing
@@ -125,6 +151,8 @@ class ImmutableExecutorState {
   static Status BuildControlFlowInfo(const Graph* graph,
                                      ControlFlowInfo* cf_info);
   void InitializePending(const Graph* graph, const ControlFlowInfo& cf_info);
+  Status InitializeDeviceContexts(const Graph& graph);
+  void InitializeCriticalPathLengths(const Graph& graph);
 
   FrameInfo* EnsureFrameInfo(const string& fname);
 
@@ -155,6 +183,16 @@ class ImmutableExecutorState {
   // Shallow copies of the constant tensors used in the graph.
   std::vector<Tensor> const_tensors_;
 
+  // If the device assigns some nodes a DeviceContext other than its default
+  // one, these map node IDs to the context of the node and to the contexts of
+  // its inputs that differ from it. Empty otherwise.
+  std::vector<DeviceContext*> node_device_contexts_;
+  std::vector<absl::InlinedVector<DeviceContext*, 2UL>>
+      node_wait_device_contexts_;
+
+  // Indexed by node ID. See `critical_path_length()`.
+  std::vector<int32> critical_path_lengths_;
+
   ImmutableExecutorState(const ImmutableExecutorState&) = delete;
   void operator=(const ImmutableExecutorState&) = delete;
 };
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "tensorflow/core/common_runtime/device.h"
@@ -23,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/local_device.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/op_segment.h"
@@ -141,6 +143,46 @@ void Benchmark::Run(benchmark::State& state) {
   RunWithRendezvousArgs({}, {}, state);
 }
 
+void Benchmark::RunWithStepCounters(benchmark::State& state) {
+  if (!device_ || state.max_iterations == 0) {
+    return;
+  }
+
+  Executor::Args args;
+  args.rendezvous = rendez_;
+  args.runner = [this](std::function<void()> closure) {
+    pool_->Schedule(closure);
+  };
+  static const int kWarmupRuns = 3;
+  for (int i = 0; i < kWarmupRuns; ++i) {
+    TF_CHECK_OK(exec_->Run(args));
+  }
+  TF_CHECK_OK(device_->Sync());
+
+  EnableCPUAllocatorStats();
+  Allocator* allocator = device_->GetAllocator(AllocatorAttributes());
+  const bool has_alloc_stats = allocator->ClearStats();
+  std::vector<uint64> step_nsecs;
+  Env* env = Env::Default();
+  for (auto s : state) {
+    const uint64 start_nsec = env->NowNanos();
+    TF_CHECK_OK(exec_->Run(args));
+    step_nsecs.push_back(env->NowNanos() - start_nsec);
+  }
+  TF_CHECK_OK(device_->Sync());
+
+  std::sort(step_nsecs.begin(), step_nsecs.end());
+  const size_t last = step_nsecs.size() - 1;
+  state.counters["p50_ns"] = step_nsecs[last / 2];
+  state.counters["p99_ns"] = step_nsecs[last * 99 / 100];
+  if (has_alloc_stats) {
+    if (auto stats = allocator->GetStats()) {
+      state.counters["allocs_per_step"] =
+          static_cast<double>(stats->num_allocs) / step_nsecs.size();
+    }
+  }
+}
+
 string GetRendezvousKey(const Node* node) {
   string send_device;
   TF_CHECK_OK(GetNodeAttr(node->attrs(), "send_device", &send_device));
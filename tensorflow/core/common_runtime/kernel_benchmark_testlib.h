@@ -59,6 +59,12 @@ class Benchmark {
 
   void Run(benchmark::State& state);
 
+  // Same as Run(), but also times every step and reports the median and 99th
+  // percentile step latencies, in nanoseconds, and the number of tensor
+  // allocations per step as the counters "p50_ns", "p99_ns" and
+  // "allocs_per_step" of `state`. Enables the statistics of the CPU allocator.
+  void RunWithStepCounters(benchmark::State& state);
+
   void RunWithRendezvousArgs(
       const std::vector<std::pair<string, Tensor>>& inputs,
       const std::vector<string>& outputs, benchmark::State& state);
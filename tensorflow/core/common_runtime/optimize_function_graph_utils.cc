@@ -48,7 +48,9 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_node_util.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/util/debug_data_dumper.h"
 #include "tsl/platform/env.h"
@@ -232,18 +234,64 @@ absl::StatusOr<OptimizedFunctionGraphInfo> ReadFromCache(
   return optimized_function_graph_info_restored;
 }
 
+// Returns a fingerprint of everything that the optimized graph of the function
+// depends on and that is stable across processes: the function definition and
+// the functions it calls, the attributes and instantiation options, and the
+// devices available for placement.
+uint64 GetFunctionGraphFingerprint(
+    const string& plain_func_name, const FunctionDef& fdef, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const DeviceSet& dev_set, const FunctionLibraryDefinition& lib_def) {
+  string serialized;
+  // The function name is part of the cache file name without its UUID suffix.
+  FunctionDef fdef_without_name = fdef;
+  fdef_without_name.mutable_signature()->clear_name();
+  SerializeToStringDeterministic(fdef_without_name, &serialized);
+  uint64 fingerprint = Fingerprint64(serialized);
+
+  // The library pointer is the only process-specific part of the canonical
+  // instantiation key; the library contents are fingerprinted below.
+  FunctionLibraryRuntime::InstantiateOptions options_without_lib = options;
+  options_without_lib.lib_def = nullptr;
+  fingerprint = FingerprintCat64(
+      fingerprint, Fingerprint64(Canonicalize(plain_func_name, attrs,
+                                              options_without_lib)));
+
+  std::vector<string> device_names;
+  device_names.reserve(dev_set.devices().size());
+  for (const Device* device : dev_set.devices()) {
+    device_names.push_back(device->name());
+  }
+  std::sort(device_names.begin(), device_names.end());
+  for (const string& device_name : device_names) {
+    fingerprint = FingerprintCat64(fingerprint, Fingerprint64(device_name));
+  }
+
+  const FunctionLibraryDefinition reachable_lib_def =
+      lib_def.ReachableDefinitions(fdef);
+  std::vector<string> function_names = reachable_lib_def.ListFunctionNames();
+  std::sort(function_names.begin(), function_names.end());
+  for (const string& name : function_names) {
+    SerializeToStringDeterministic(*reachable_lib_def.Find(name), &serialized);
+    fingerprint = FingerprintCat64(fingerprint, Fingerprint64(serialized));
+  }
+  return fingerprint;
+}
+
 // Gets the full path name of the file cache.
-// TODO(b/276813768) Include more runtime specific info like env/flag
-// values, or line number. An alternative is to use the fingerprint of the
-// graph once graph building cache is enabled.
 //
 // Current file cache key components:
 // 1) Job name.
 // 2) Task ID.
 // 3) Function name (without UUID suffix).
 // 4) TF graph node count.
-string GetFileCacheName(const string& dir_name, const string& function_name,
-                        const FunctionDef* fdef) {
+// 5) Fingerprint of the function and its instantiation, see
+//    GetFunctionGraphFingerprint().
+string GetFileCacheName(
+    const string& dir_name, const string& function_name,
+    const FunctionDef* fdef, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const DeviceSet& dev_set, const FunctionLibraryDefinition& lib_def) {
   string plain_func_name = function_name;
   // Remove the random UUID in the function name.
   if (absl::StrContains(function_name, "_")) {
@@ -252,9 +300,12 @@ string GetFileCacheName(const string& dir_name, const string& function_name,
     plain_func_name = absl::StrJoin(func_name_tokens, "_");
   }
 
+  const uint64 fingerprint = GetFunctionGraphFingerprint(
+      plain_func_name, *fdef, attrs, options, dev_set, lib_def);
   return absl::StrCat(dir_name, "/", tsl::port::JobName(), "_",
                       tsl::port::TaskId(), "_", plain_func_name, "_",
-                      fdef->node_def_size());
+                      fdef->node_def_size(), "_",
+                      absl::Hex(fingerprint, absl::kZeroPad16));
 }
 
 // Generates graph and return information given the input function name,
@@ -602,7 +653,10 @@ absl::StatusOr<OptimizedFunctionGraphInfo> OptimizeFunctionGraph(
                 &dev_set, default_device,
                 options.config_proto.allow_soft_placement(),
                 options.config_proto.log_device_placement());
+  const uint64_t placement_start_time_usecs = env->NowMicros();
   TF_RETURN_IF_ERROR(placer.Run(optimization_options));
+  metrics::UpdateFunctionGraphOptimizationPhaseTime(
+      "placement", env->NowMicros() - placement_start_time_usecs);
 
   DEBUG_DATA_DUMPER()->DumpGraph(function_name, kDebugGroupMain,
                                  "before_post_placement_passes", graph.get(),
@@ -686,7 +740,8 @@ OptimizeFunctionGraphOrReadFromFileCache(
         "Failed to find function ", function_name,
         " in function library: ", lib_def->ToProto().DebugString()));
   }
-  const string file_name = GetFileCacheName(dir_name, function_name, fdef);
+  const string file_name = GetFileCacheName(dir_name, function_name, fdef,
+                                            attrs, options, dev_set, *lib_def);
 
   // Scenario (2): File cache exists for this function; restore from the cache.
   if (env->FileExists(file_name).ok()) {
@@ -807,8 +862,11 @@ PreprocessAndPartitionGraph(
   // Partition the graph.
   auto device_name_to_subgraphs =
       std::make_unique<std::unordered_map<string, std::unique_ptr<Graph>>>();
+  const uint64_t partitioning_start_time_usecs = env->NowMicros();
   TF_RETURN_IF_ERROR(PartitionFunctionGraph(dev_set, std::move(graph),
                                             device_name_to_subgraphs.get()));
+  metrics::UpdateFunctionGraphOptimizationPhaseTime(
+      "partitioning", env->NowMicros() - partitioning_start_time_usecs);
 
   // Dump graphs before post-partitioning passes.
   for (const auto& pair : *device_name_to_subgraphs) {
@@ -67,6 +67,11 @@ absl::StatusOr<OptimizedFunctionGraphInfo> OptimizeFunctionGraph(
 // the file cache if existent. If cache loading fails, it goes ahead and runs
 // the graph optimization passes. Returns error if running the optimization
 // passes fails.
+//
+// Cache files are keyed by a fingerprint of the function definition, the
+// functions it calls, the attributes and instantiation options, and the
+// device set, so that a cache directory can be shared by all the processes
+// running the same program, e.g. the replicas of a job across restarts.
 absl::StatusOr<OptimizedFunctionGraphInfo>
 OptimizeFunctionGraphOrReadFromFileCache(
     const string& function_name, AttrSlice attrs,
@@ -22,6 +22,8 @@ limitations under the License.
 #include <sys/mman.h>  // for munmap
 #endif
 
+#include <algorithm>
+#include <cstring>
 #include <map>
 #include <utility>
 
@@ -259,18 +261,69 @@ void PoolAllocator::EvictOne() {
   }
 }
 
+void* BasicCPUAllocator::AllocAligned(size_t alignment, size_t num_bytes) {
+  if (numa_node_ == port::kNUMANoAffinity) {
+    return port::AlignedMalloc(num_bytes, static_cast<int>(alignment));
+  }
+  return port::NUMAMalloc(numa_node_, num_bytes, static_cast<int>(alignment));
+}
+
+void BasicCPUAllocator::FreeAligned(void* ptr, size_t num_bytes) {
+  if (numa_node_ == port::kNUMANoAffinity) {
+    port::AlignedFree(ptr);
+  } else {
+    port::NUMAFree(ptr, num_bytes);
+  }
+}
+
+void* BasicCPUAllocator::AllocExplicitHugePages(size_t num_bytes) {
+#if defined(MAP_HUGETLB)
+  void* ptr = mmap(nullptr, num_bytes, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (ptr == MAP_FAILED) {
+    LOG_FIRST_N(WARNING, 1)
+        << "Failed to map " << num_bytes
+        << " bytes of explicit huge pages, falling back to transparent huge "
+           "pages: "
+        << strerror(errno);
+    return nullptr;
+  }
+  mutex_lock l(explicit_huge_pages_mu_);
+  explicit_huge_page_allocations_.insert(ptr);
+  return ptr;
+#else
+  LOG_FIRST_N(WARNING, 1) << "Explicit huge pages are not supported on this "
+                             "platform, using transparent huge pages";
+  return nullptr;
+#endif
+}
+
 void* BasicCPUAllocator::Alloc(size_t alignment, size_t num_bytes,
                                size_t* bytes_received) {
   tsl::profiler::TraceMe traceme("BasicCPUAllocator::Alloc");
 
   void* ptr = nullptr;
+  if (huge_pages_ != HugePages::kNone) {
+    // Free() rounds the same way, so it is also correct for callers that pass
+    // the requested rather than the received size.
+    num_bytes = (num_bytes + kHugePageBytes - 1) / kHugePageBytes *
+                kHugePageBytes;
+    alignment = std::max(alignment, kHugePageBytes);
+  }
   *bytes_received = num_bytes;
   if (num_bytes > 0) {
-    if (numa_node_ == port::kNUMANoAffinity) {
-      ptr = port::AlignedMalloc(num_bytes, static_cast<int>(alignment));
-    } else {
-      ptr =
-          port::NUMAMalloc(numa_node_, num_bytes, static_cast<int>(alignment));
+    if (huge_pages_ == HugePages::kExplicit) {
+      ptr = AllocExplicitHugePages(num_bytes);
+    }
+    if (ptr == nullptr) {
+      ptr = AllocAligned(alignment, num_bytes);
+#if defined(MADV_HUGEPAGE)
+      if (ptr != nullptr && huge_pages_ != HugePages::kNone &&
+          madvise(ptr, num_bytes, MADV_HUGEPAGE) != 0) {
+        LOG_FIRST_N(WARNING, 1)
+            << "madvise(MADV_HUGEPAGE) failed: " << strerror(errno);
+      }
+#endif
     }
     VisitAlloc(ptr, numa_node_, num_bytes);
   }
@@ -280,13 +333,22 @@ void* BasicCPUAllocator::Alloc(size_t alignment, size_t num_bytes,
 void BasicCPUAllocator::Free(void* ptr, size_t num_bytes) {
   tsl::profiler::TraceMe traceme("BasicCPUAllocator::Free");
 
+  if (huge_pages_ != HugePages::kNone) {
+    num_bytes = (num_bytes + kHugePageBytes - 1) / kHugePageBytes *
+                kHugePageBytes;
+  }
   if (num_bytes > 0) {
     VisitFree(ptr, numa_node_, num_bytes);
-    if (numa_node_ == port::kNUMANoAffinity) {
-      port::AlignedFree(ptr);
-    } else {
-      port::NUMAFree(ptr, num_bytes);
+#if defined(MAP_HUGETLB)
+    if (huge_pages_ == HugePages::kExplicit) {
+      mutex_lock l(explicit_huge_pages_mu_);
+      if (explicit_huge_page_allocations_.erase(ptr) > 0) {
+        munmap(ptr, num_bytes);
+        return;
+      }
     }
+#endif
+    FreeAligned(ptr, num_bytes);
   }
 }
 }  // namespace tensorflow
@@ -21,6 +21,7 @@ limitations under the License.
 #include <atomic>
 #include <map>
 #include <memory>
+#include <unordered_set>
 #include <vector>
 
 #include "tensorflow/core/framework/allocator.h"
@@ -153,9 +154,28 @@ class Pow2Rounder : public RoundUpInterface {
 
 class BasicCPUAllocator : public SubAllocator {
  public:
+  // How the memory returned by Alloc() is backed.
+  enum class HugePages {
+    // Regular pages.
+    kNone,
+    // Allocations are rounded up to and aligned on 2MB and the kernel is
+    // advised to back them with transparent huge pages.
+    kTransparent,
+    // Allocations are mapped from the explicit huge page pool (MAP_HUGETLB).
+    // Falls back to kTransparent if the pool is exhausted or unsupported.
+    // Explicit huge pages are placed on the NUMA node that first touches them
+    // rather than on `numa_node`.
+    kExplicit,
+  };
+
+  static constexpr size_t kHugePageBytes = 2 << 20;
+
   BasicCPUAllocator(int numa_node, const std::vector<Visitor>& alloc_visitors,
-                    const std::vector<Visitor>& free_visitors)
-      : SubAllocator(alloc_visitors, free_visitors), numa_node_(numa_node) {}
+                    const std::vector<Visitor>& free_visitors,
+                    HugePages huge_pages = HugePages::kNone)
+      : SubAllocator(alloc_visitors, free_visitors),
+        numa_node_(numa_node),
+        huge_pages_(huge_pages) {}
 
   ~BasicCPUAllocator() override {}
 
@@ -171,7 +191,20 @@ class BasicCPUAllocator : public SubAllocator {
   }
 
  private:
+  // Allocates `num_bytes` from the explicit huge page pool, or returns nullptr
+  // if that fails.
+  void* AllocExplicitHugePages(size_t num_bytes);
+
+  void* AllocAligned(size_t alignment, size_t num_bytes);
+  void FreeAligned(void* ptr, size_t num_bytes);
+
   int numa_node_;
+  const HugePages huge_pages_;
+
+  // The allocations that were mapped by AllocExplicitHugePages().
+  mutex explicit_huge_pages_mu_;
+  std::unordered_set<void*> explicit_huge_page_allocations_
+      TF_GUARDED_BY(explicit_huge_pages_mu_);
 
   BasicCPUAllocator(const BasicCPUAllocator&) = delete;
   void operator=(const BasicCPUAllocator&) = delete;
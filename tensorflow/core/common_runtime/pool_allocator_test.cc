@@ -0,0 +1,59 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/pool_allocator.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(BasicCPUAllocatorTest, HugePageBackedAllocations) {
+  for (BasicCPUAllocator::HugePages huge_pages :
+       {BasicCPUAllocator::HugePages::kTransparent,
+        BasicCPUAllocator::HugePages::kExplicit}) {
+    BasicCPUAllocator sub_allocator(port::kNUMANoAffinity, {}, {}, huge_pages);
+    size_t bytes_received = 0;
+    void* ptr = sub_allocator.Alloc(/*alignment=*/64, /*num_bytes=*/3 << 20,
+                                    &bytes_received);
+    ASSERT_NE(ptr, nullptr);
+    // Rounded up to and aligned on huge pages, even if the explicit huge page
+    // pool is empty and the allocator fell back to transparent huge pages.
+    EXPECT_EQ(bytes_received, 2 * BasicCPUAllocator::kHugePageBytes);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) %
+                  BasicCPUAllocator::kHugePageBytes,
+              0);
+    memset(ptr, 0xab, bytes_received);
+    sub_allocator.Free(ptr, bytes_received);
+  }
+}
+
+TEST(BasicCPUAllocatorTest, RegularPagesAreNotRounded) {
+  BasicCPUAllocator sub_allocator(port::kNUMANoAffinity, {}, {});
+  size_t bytes_received = 0;
+  void* ptr = sub_allocator.Alloc(/*alignment=*/64, /*num_bytes=*/1000,
+                                  &bytes_received);
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_EQ(bytes_received, size_t{1000});
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % 64, 0);
+  sub_allocator.Free(ptr, bytes_received);
+}
+
+}  // namespace
+}  // namespace tensorflow
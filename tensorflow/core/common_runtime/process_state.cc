@@ -15,11 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/process_state.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cstring>
 #include <vector>
 
 #include "absl/base/call_once.h"
+#include "absl/strings/ascii.h"
 #include "tensorflow/core/common_runtime/bfc_allocator.h"
 #include "tensorflow/core/common_runtime/pool_allocator.h"
 #include "tensorflow/core/framework/allocator.h"
@@ -28,10 +30,47 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
+namespace {
+
+// Returns the NUMA node the calling thread is bound to, or kNUMANoAffinity.
+// Threads are bound once when they start (e.g. the inter-op threads of a
+// NUMA-aware thread pool), so the node is looked up once per thread.
+int CallingThreadNUMANode() {
+  static thread_local const int numa_node = port::NUMAGetThreadNodeAffinity();
+  return numa_node;
+}
+
+// Reads how the CPU allocator regions should be backed from the
+// TF_CPU_ALLOCATOR_HUGE_PAGES environment variable: "transparent" or
+// "explicit" huge pages, or regular pages if unset.
+BasicCPUAllocator::HugePages ReadHugePagesFromEnvVar() {
+  string huge_pages;
+  Status status =
+      ReadStringFromEnvVar("TF_CPU_ALLOCATOR_HUGE_PAGES", "", &huge_pages);
+  if (!status.ok()) {
+    LOG(ERROR) << "GetCPUAllocator: " << status.message();
+  }
+  huge_pages = absl::AsciiStrToLower(huge_pages);
+  if (huge_pages == "transparent") {
+    return BasicCPUAllocator::HugePages::kTransparent;
+  }
+  if (huge_pages == "explicit") {
+    return BasicCPUAllocator::HugePages::kExplicit;
+  }
+  if (!huge_pages.empty() && huge_pages != "none") {
+    LOG(ERROR) << "GetCPUAllocator: unknown TF_CPU_ALLOCATOR_HUGE_PAGES value '"
+               << huge_pages
+               << "', expected 'transparent', 'explicit' or 'none'";
+  }
+  return BasicCPUAllocator::HugePages::kNone;
+}
+
+}  // namespace
 
 /*static*/ ProcessState* ProcessState::singleton() {
   static ProcessState* instance = new ProcessState;
@@ -62,7 +101,11 @@ ProcessState::MemDesc ProcessState::PtrType(const void* ptr) {
 }
 
 Allocator* ProcessState::GetCPUAllocator(int numa_node) {
-  if (!numa_enabled_ || numa_node == port::kNUMANoAffinity) numa_node = 0;
+  const bool numa_enabled = numa_enabled_.load(std::memory_order_acquire);
+  if (numa_enabled && numa_node == port::kNUMANoAffinity) {
+    numa_node = CallingThreadNUMANode();
+  }
+  if (!numa_enabled || numa_node == port::kNUMANoAffinity) numa_node = 0;
 
   // Check if allocator for the numa node is in lock-free cache.
   if (numa_node < cpu_allocators_cached_.load(std::memory_order_acquire)) {
@@ -76,18 +119,25 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
     // depending on env var setting.
     const bool alloc_visitors_defined =
         (!cpu_alloc_visitors_.empty() || !cpu_free_visitors_.empty());
+    // Huge pages only pay off for the large regions that a BFCAllocator
+    // carves allocations out of, so they imply it by default.
+    const BasicCPUAllocator::HugePages huge_pages = ReadHugePagesFromEnvVar();
+    const bool use_huge_pages =
+        huge_pages != BasicCPUAllocator::HugePages::kNone;
     bool use_bfc_allocator = false;
-    Status status = ReadBoolFromEnvVar(
-        "TF_CPU_ALLOCATOR_USE_BFC", alloc_visitors_defined, &use_bfc_allocator);
+    Status status = ReadBoolFromEnvVar("TF_CPU_ALLOCATOR_USE_BFC",
+                                       alloc_visitors_defined || use_huge_pages,
+                                       &use_bfc_allocator);
     if (!status.ok()) {
       LOG(ERROR) << "GetCPUAllocator: " << status.message();
     }
     Allocator* allocator = nullptr;
     SubAllocator* sub_allocator =
-        (numa_enabled_ || alloc_visitors_defined || use_bfc_allocator)
+        (numa_enabled || alloc_visitors_defined || use_bfc_allocator ||
+         use_huge_pages)
             ? new BasicCPUAllocator(
-                  numa_enabled_ ? numa_node : port::kNUMANoAffinity,
-                  cpu_alloc_visitors_, cpu_free_visitors_)
+                  numa_enabled ? numa_node : port::kNUMANoAffinity,
+                  cpu_alloc_visitors_, cpu_free_visitors_, huge_pages)
             : nullptr;
     if (use_bfc_allocator) {
       // TODO(reedwm): evaluate whether 64GB by default is the best choice.
@@ -101,21 +151,35 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
       int64_t cpu_mem_limit = cpu_mem_limit_in_mb * (1LL << 20);
       DCHECK(sub_allocator);
 
+      // A non-zero value enables the BFC front cache for allocations of up to
+      // that many bytes. Each NUMA node has its own allocator, and therefore
+      // its own front cache.
+      int64_t front_cache_max_chunk_bytes = 0;
+      status = ReadInt64FromEnvVar("TF_CPU_BFC_FRONT_CACHE_MAX_CHUNK_BYTES",
+                                   0, &front_cache_max_chunk_bytes);
+      if (!status.ok()) {
+        LOG(ERROR) << "GetCPUAllocator: " << status.message();
+      }
+
       BFCAllocator::Options allocator_opts;
       allocator_opts.allow_growth = true;
+      allocator_opts.front_cache_max_chunk_bytes =
+          std::clamp<int64_t>(front_cache_max_chunk_bytes, 0, 1 << 20);
       allocator = new BFCAllocator(
           absl::WrapUnique(sub_allocator), cpu_mem_limit,
           /*name=*/"bfc_cpu_allocator_for_gpu", allocator_opts);
 
       VLOG(2) << "Using BFCAllocator with memory limit of "
-              << cpu_mem_limit_in_mb << " MB for ProcessState CPU allocator";
+              << cpu_mem_limit_in_mb << " MB for ProcessState CPU allocator "
+              << "numa_node=" << numa_node
+              << " huge_pages=" << static_cast<int>(huge_pages);
     } else if (sub_allocator) {
       DCHECK(sub_allocator);
       allocator =
           new PoolAllocator(/*pool_size_limit=*/100, /*auto_resize=*/true,
                             sub_allocator, new NoopRounder, "cpu_pool");
       VLOG(2) << "Using PoolAllocator for ProcessState CPU allocator "
-              << "numa_enabled_=" << numa_enabled_
+              << "numa_enabled_=" << numa_enabled
               << " numa_node=" << numa_node;
     } else {
       DCHECK(!sub_allocator);
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_PROCESS_STATE_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_PROCESS_STATE_H_
 
+#include <atomic>
 #include <functional>
 #include <map>
 #include <unordered_map>
@@ -55,15 +56,19 @@ class ProcessState : public ProcessStateInterface {
   };
 
   // If NUMA Allocators are desired, call this before calling any
-  // Allocator accessor.
-  void EnableNUMA() { numa_enabled_ = true; }
+  // Allocator accessor. Safe to call while other threads get allocators.
+  void EnableNUMA() { numa_enabled_.store(true, std::memory_order_release); }
 
   // Returns what we know about the memory at ptr.
   // If we know nothing, it's called CPU 0 with no other attributes.
   MemDesc PtrType(const void* ptr);
 
   // Returns the one CPUAllocator used for the given numa_node.
-  // Treats numa_node == kNUMANoAffinity as numa_node == 0.
+  // If NUMA is enabled, treats numa_node == kNUMANoAffinity as the node the
+  // calling thread is bound to, if any. Otherwise treats it as numa_node == 0.
+  //
+  // Setting TF_CPU_ALLOCATOR_HUGE_PAGES to "transparent" or "explicit" backs
+  // the memory of the allocators with 2MB huge pages of that kind.
   Allocator* GetCPUAllocator(int numa_node) override;
 
   // Registers alloc visitor for the CPU allocator(s).
@@ -92,7 +97,7 @@ class ProcessState : public ProcessStateInterface {
   void TestOnlyReset();
 
   static ProcessState* instance_;
-  bool numa_enabled_;
+  std::atomic<bool> numa_enabled_;
 
   mutex mu_;
 
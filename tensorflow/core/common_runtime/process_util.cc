@@ -22,10 +22,14 @@ limitations under the License.
 #endif  // defined(ENABLE_MKL) && defined(ENABLE_ONEDNN_OPENMP)
 #include <string.h>
 
+#include <map>
+
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/strcat.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/util.h"
@@ -165,6 +169,30 @@ thread::ThreadPool* NewThreadPoolFromSessionOptions(
       /*allocator=*/nullptr);
 }
 
+thread::ThreadPool* NUMAThreadPoolFromSessionOptions(
+    const SessionOptions& options, int numa_node) {
+  static mutex* mu = new mutex();
+  static std::map<int, thread::ThreadPool*>* pools =
+      new std::map<int, thread::ThreadPool*>;
+  mutex_lock l(*mu);
+  thread::ThreadPool*& pool = (*pools)[numa_node];
+  if (pool == nullptr) {
+    int32_t num_threads = options.config.inter_op_parallelism_threads();
+    if (num_threads <= 0) num_threads = GetEnvNumInterOpThreads();
+    if (num_threads <= 0) num_threads = port::MaxParallelism(numa_node);
+    VLOG(1) << "NUMA node " << numa_node
+            << " inter op parallelism threads: " << num_threads;
+    ThreadOptions thread_opts;
+    thread_opts.numa_node = numa_node;
+    pool = new thread::ThreadPool(
+        options.env, thread_opts,
+        strings::StrCat("numa_", numa_node, "_Compute"), num_threads,
+        !options.config.experimental().disable_thread_spinning(),
+        /*allocator=*/nullptr);
+  }
+  return pool;
+}
+
 void SchedClosure(absl::AnyInvocable<void()> closure) {
   if (!tracing::EventCollector::IsEnabled()) {
     return Env::Default()->SchedClosure(std::move(closure));
@@ -51,6 +51,13 @@ int32 NumInterOpThreadsFromSessionOptions(const SessionOptions& options);
 thread::ThreadPool* NewThreadPoolFromSessionOptions(
     const SessionOptions& options, int32_t num_threads = 0);
 
+// Returns a process-wide inter-op ThreadPool whose threads are bound to
+// `numa_node`. Its size is the inter-op parallelism of `options` if it is
+// positive, or else the number of schedulable CPUs on `numa_node`. Caller does
+// not take ownership over threadpool.
+thread::ThreadPool* NUMAThreadPoolFromSessionOptions(
+    const SessionOptions& options, int numa_node);
+
 // Schedule "closure" in the default thread queue.
 void SchedClosure(absl::AnyInvocable<void()> closure);
 
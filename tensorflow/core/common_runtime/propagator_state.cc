@@ -49,6 +49,11 @@ PropagatorState::~PropagatorState() {
   for (auto name_frame : outstanding_frames_) {
     delete name_frame.second;
   }
+  for (auto& info_frames : free_frames_) {
+    for (FrameState* frame : info_frames.second) {
+      delete frame;
+    }
+  }
 }
 
 void PropagatorState::ActivateRoots(gtl::ArraySlice<const NodeItem*> roots,
@@ -280,6 +285,34 @@ void PropagatorState::FindOrCreateChildFrame(FrameState* frame,
     VLOG(2) << "Create frame: " << child_name << " id: " << child_id;
   }
 
+  {
+    mutex_lock executor_lock(mu_);
+    auto it = outstanding_frames_.find(child_id);
+    if (it != outstanding_frames_.end()) {
+      *child = it->second;
+      return;
+    }
+    // Reuse a done instance of the same loop if there is one.
+    auto free_it = free_frames_.find(&frame_info);
+    if (free_it != free_frames_.end() && !free_it->second.empty()) {
+      FrameState* reused = free_it->second.back();
+      free_it->second.pop_back();
+      reused->frame_id = child_id;
+      reused->parent_frame = frame;
+      reused->parent_iter = iter_state;
+      reused->InitializeFrameInfo(frame_info);
+      {
+        mutex_lock l(reused->mu);
+        reused->SetIteration(0, reused->NewIteration(0));
+      }
+      mutex_lock frame_lock(frame->mu);
+      iter_state->outstanding_frame_count++;
+      outstanding_frames_[child_id] = reused;
+      *child = reused;
+      return;
+    }
+  }
+
   FrameState* temp =
       new FrameState(immutable_state_, frame_info.parallel_iterations);
   temp->frame_id = child_id;
@@ -379,13 +412,15 @@ void PropagatorState::DeleteFrame(FrameState* frame, TaggedNodeSeq* ready) {
     }
   }
 
-  // Delete the frame.
+  // Keep the frame for the next instance of its loop. The frame is done, so
+  // no other thread accesses it anymore.
   if (vlog_) VLOG(2) << "Delete frame " << frame->frame_id;
+  frame->ResetForReuse();
   {
     mutex_lock executor_lock(mu_);
     outstanding_frames_.erase(frame->frame_id);
+    free_frames_[frame->frame_info].push_back(frame);
   }
-  delete frame;
 }
 
 void PropagatorState::CleanupFramesIterations(FrameState* frame,
@@ -753,8 +788,7 @@ PropagatorState::FrameState::IncrementIteration(TaggedNodeSeq* ready) {
   iteration_count++;
 
   // Initialize the next iteration.
-  IterationState* next_iter =
-      new IterationState(iteration_count, pending_counts, total_input_tensors);
+  IterationState* next_iter = NewIteration(iteration_count);
   SetIteration(iteration_count, next_iter);
   num_outstanding_iterations++;
   {
@@ -775,7 +809,7 @@ bool PropagatorState::FrameState::CleanupIterations(IterationState* iter_state,
                                                     TaggedNodeSeq* ready) {
   int64_t curr_iter = iter_state->iter_num;
   while (curr_iter <= iteration_count && IsIterationDone(iter_state)) {
-    delete iter_state;
+    ReleaseIteration(iter_state);
     SetIteration(curr_iter, nullptr);
     --num_outstanding_iterations;
     ++curr_iter;
@@ -798,8 +832,41 @@ bool PropagatorState::FrameState::CleanupIterations(IterationState* iter_state,
   return IsFrameDone();
 }
 
+PropagatorState::IterationState* PropagatorState::FrameState::NewIteration(
+    int64_t iter) {
+  if (free_iterations.empty()) {
+    return new IterationState(iter, pending_counts, total_input_tensors);
+  }
+  IterationState* iter_state = free_iterations.back();
+  free_iterations.pop_back();
+  iter_state->Reset(iter, pending_counts);
+  return iter_state;
+}
+
+void PropagatorState::FrameState::ReleaseIteration(IterationState* iter_state) {
+  // Release the tensors that are still held by the iteration (e.g. the inputs
+  // of nodes that were not run) now rather than when it is reused.
+  for (int i = 0; i < total_input_tensors; ++i) {
+    iter_state->input_tensors[i].ClearVal();
+  }
+  free_iterations.push_back(iter_state);
+}
+
+void PropagatorState::FrameState::ResetForReuse() {
+  mutex_lock l(mu);
+  mutex_lock iter_lock(iter_mu);
+  parent_frame = nullptr;
+  parent_iter = nullptr;
+  iteration_count = 0;
+  num_outstanding_iterations = 1;
+  next_iter_roots.clear();
+  inv_values.clear();
+  dead_exits.clear();
+}
+
 void PropagatorState::FrameState::InitializeFrameInfo(
     const ImmutableExecutorState::FrameInfo& finfo) {
+  frame_info = &finfo;
   pending_counts = finfo.pending_counts.get();
   total_input_tensors = finfo.total_inputs;
   num_pending_inputs = finfo.input_count;
@@ -135,8 +135,7 @@ class PropagatorState {
           counts(*pending_counts) {  // Initialize with copy of *pending_counts
     }
 
-    const int64_t
-        iter_num;  // The index of this iteration in the enclosing loop.
+    int64_t iter_num;  // The index of this iteration in the enclosing loop.
 
     // One copy per iteration. For iteration k, i-th node's j-th input is in
     // input_tensors[k][immutable_state_.nodes[i].input_start + j]. An entry is
@@ -206,6 +205,15 @@ class PropagatorState {
       return counts.adjust_for_activation_atomic(h, increment_dead);
     }
 
+    // Prepares this state, whose iteration is done and whose input tensors
+    // are cleared, to be reused for iteration `new_iter_num` of its frame.
+    void Reset(int64_t new_iter_num, const PendingCounts* pending_counts) {
+      iter_num = new_iter_num;
+      outstanding_ops = 0;
+      outstanding_frame_count = 0;
+      counts.CopyFrom(*pending_counts);
+    }
+
     ~IterationState() { delete[] input_tensors; }
 
    private:
@@ -287,6 +295,9 @@ class PropagatorState {
     IterationState** const iterations_raw TF_GUARDED_BY(mu);
     IterationState* iterations_first TF_GUARDED_BY(mu);
 
+    // The states of done iterations, which are recycled for new iterations.
+    std::vector<IterationState*> free_iterations TF_GUARDED_BY(mu);
+
    public:
     // The NextIteration nodes to enter a new iteration. If the number of
     // outstanding iterations reaches the limit, we will defer the start of
@@ -308,6 +319,7 @@ class PropagatorState {
     std::vector<const NodeItem*> dead_exits TF_GUARDED_BY(iter_mu);
 
     // Static information specific to this frame.
+    const ImmutableExecutorState::FrameInfo* frame_info = nullptr;
     PendingCounts* pending_counts = nullptr;
     int total_input_tensors = 0;
     std::vector<const NodeItem*>* nodes = nullptr;
@@ -333,6 +345,20 @@ class PropagatorState {
 
     void SetIteration(int64_t iter, IterationState* state);
 
+    // Returns a state for iteration `iter`, recycling the state of a done
+    // iteration if there is one. Loops with many small iterations would
+    // otherwise spend most of their propagation time allocating them.
+    IterationState* NewIteration(int64_t iter) TF_EXCLUSIVE_LOCKS_REQUIRED(mu);
+
+    // Releases the state of a done iteration, whose input tensors must not be
+    // accessed anymore, to be recycled by `NewIteration()`.
+    void ReleaseIteration(IterationState* iter_state)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu);
+
+    // Clears the state of this done frame so that it can be reused for
+    // another instance of the same loop.
+    void ResetForReuse();
+
     // Adjust the outstanding op count by 'delta' and clean up the iterations in
     // the frame if no more ops are oustanding. Return true iff the execution of
     // the frame is done.
@@ -419,6 +445,9 @@ class PropagatorState {
         delete iterations[i];
         iterations[i] = nullptr;
       }
+      for (IterationState* iter_state : free_iterations) {
+        delete iter_state;
+      }
     }
 
    private:
@@ -546,6 +575,13 @@ class PropagatorState {
   absl::flat_hash_map<uint64, FrameState*> outstanding_frames_
       TF_GUARDED_BY(mu_);
 
+  // The done frames of each loop, which are reused for its new instances
+  // (e.g. an inner loop that is instantiated in every iteration of an outer
+  // loop) along with the iteration states they have recycled.
+  absl::flat_hash_map<const ImmutableExecutorState::FrameInfo*,
+                      std::vector<FrameState*>>
+      free_frames_ TF_GUARDED_BY(mu_);
+
   PropagatorState(const PropagatorState&) = delete;
   void operator=(const PropagatorState&) = delete;
 };
@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/bfloat16.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -404,11 +405,16 @@ void RingAlg::DispatchSend(RingField* rf, const StatusCallback& done) {
   int send_to_rank = (rf->rank + 1) % group_size_;
   int send_to_dev_idx = col_params_->instance.impl_details
                             .subdiv_permutations[rf->subdiv_idx][send_to_rank];
+  const Tensor* send_tensor = &rf->chunk;
+  if (compress_bfloat16_) {
+    CompressChunk(rf);
+    send_tensor = &rf->wire_chunk;
+  }
   col_ctx_->col_exec->remote_access()->PostToPeer(
       col_params_->group.members[send_to_dev_idx].device.name(),
       col_params_->group.members[send_to_dev_idx].task, send_buf_key,
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
-      col_ctx_->op_ctx->output_alloc_attr(0), &rf->chunk,
+      col_ctx_->op_ctx->output_alloc_attr(0), send_tensor,
       col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
       done);
 }
@@ -424,6 +430,20 @@ void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
   Tensor* dst_tensor = (!rf->second_pass && (col_params_->merge_op != nullptr))
                            ? &rf->tmp_chunk
                            : &rf->chunk;
+  StatusCallback recv_done = done;
+  if (compress_bfloat16_) {
+    // Receive the bfloat16 payload, then widen it into the float destination.
+    AllocateWireChunk(rf);
+    recv_done = [rf, dst_tensor, done](const Status& s) {
+      if (s.ok()) {
+        BFloat16ToFloat(rf->wire_chunk.flat<bfloat16>().data(),
+                        dst_tensor->flat<float>().data(),
+                        dst_tensor->NumElements());
+      }
+      done(s);
+    };
+    dst_tensor = &rf->wire_chunk;
+  }
   col_ctx_->col_exec->remote_access()->RecvFromPeer(
       col_params_->group.members[rf->recv_dev_idx].device.name(),
       col_params_->group.members[rf->recv_dev_idx].task,
@@ -431,7 +451,30 @@ void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
       col_ctx_->op_ctx->output_alloc_attr(0), dst_tensor,
       col_ctx_->device_locality, rf->subdiv_idx,
-      col_ctx_->op_ctx->cancellation_manager(), done);
+      col_ctx_->op_ctx->cancellation_manager(), recv_done);
+}
+
+void RingAlg::AllocateWireChunk(RingField* rf) {
+  if (rf->wire_chunk.dtype() == DT_BFLOAT16 &&
+      rf->wire_chunk.shape() == rf->chunk.shape()) {
+    return;
+  }
+  rf->wire_chunk = Tensor(col_ctx_->device->GetAllocator(
+                              col_ctx_->op_ctx->output_alloc_attr(0)),
+                          DT_BFLOAT16, rf->chunk.shape());
+}
+
+void RingAlg::CompressChunk(RingField* rf) {
+  AllocateWireChunk(rf);
+  RoundFloatToBFloat16(rf->chunk.flat<float>().data(),
+                       rf->wire_chunk.flat<bfloat16>().data(),
+                       rf->chunk.NumElements());
+  if (rf->second_pass) {
+    // The second pass distributes final values.  Round the sender's copy too,
+    // so that every device ends up with the same result.
+    BFloat16ToFloat(rf->wire_chunk.flat<bfloat16>().data(),
+                    rf->chunk.flat<float>().data(), rf->chunk.NumElements());
+  }
 }
 
 string RingAlg::FieldState() {
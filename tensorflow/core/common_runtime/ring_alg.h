@@ -75,6 +75,7 @@ class RingAlg : public CollectiveImplementationInterface {
     bool is_final = false;  // is the last field in the pass for this rank
     Tensor chunk;           // alias to field values
     Tensor tmp_chunk;
+    Tensor wire_chunk;      // bfloat16 payload when compress_bfloat16_
     Status status;
     string DebugString() const;
   };
@@ -83,6 +84,10 @@ class RingAlg : public CollectiveImplementationInterface {
   void AdvanceToSecondPass(RingField* rf);
   void DispatchSend(RingField* rf, const StatusCallback& done);
   void DispatchRecv(RingField* rf, const StatusCallback& done);
+  // Helpers for `compress_bfloat16_`.  `CompressChunk` fills `rf->wire_chunk`
+  // with `rf->chunk` rounded to bfloat16.
+  void AllocateWireChunk(RingField* rf);
+  void CompressChunk(RingField* rf);
 
   // For constructing log messages for debugging.
   string FieldState();
@@ -111,6 +116,9 @@ class RingAlg : public CollectiveImplementationInterface {
   Tensor group_size_tensor_;
   Notification group_size_tensor_ready_;
   std::unique_ptr<CollectiveAdapter> ca_;
+  // If true, float chunks are sent as bfloat16 and widened back to float on
+  // receipt, so that reductions still accumulate in float.
+  bool compress_bfloat16_ = false;
   mutex status_mu_;
   Status status_ TF_GUARDED_BY(status_mu_);
   std::vector<RingField> rfv_;
@@ -16,9 +16,11 @@ limitations under the License.
 
 #include <stdlib.h>
 
+#include <algorithm>
 #include <atomic>
 #include <functional>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/collective_rma_local.h"
 #include "tensorflow/core/common_runtime/collective_util.h"
@@ -40,8 +42,51 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
+namespace {
+
+// Upper bound on the number of pieces each chunk is split into by
+// `SplitSubdivsIntoPipelineStages`.
+constexpr int kMaxPipelineStages = 16;
+
+// Splits each chunk of the ring into pieces of at most `pipeline_chunk_bytes`,
+// so that the reduction of a piece overlaps with the transfer of the next one,
+// and a reduced piece is sent on without waiting for the rest of its chunk.
+// The pieces of a chunk are extra subdivisions sharing the chunk's ring
+// permutation, so each of them is an independent RingField.
+void SplitSubdivsIntoPipelineStages(int64_t pipeline_chunk_bytes,
+                                    CollectiveParams* col_params) {
+  if (pipeline_chunk_bytes <= 0) return;
+  CollImplDetails& impl_details = col_params->instance.impl_details;
+  const int num_subdivs = impl_details.subdiv_permutations.size();
+  const int64_t tensor_bytes = col_params->instance.shape.num_elements() *
+                               DataTypeSize(col_params->instance.data_type);
+  const int64_t chunk_bytes =
+      tensor_bytes / (col_params->group.group_size * num_subdivs);
+  const int num_stages = static_cast<int>(std::min<int64_t>(
+      kMaxPipelineStages,
+      (chunk_bytes + pipeline_chunk_bytes - 1) / pipeline_chunk_bytes));
+  if (num_stages <= 1) return;
+
+  std::vector<std::vector<int>> subdiv_permutations;
+  std::vector<int> subdiv_rank;
+  subdiv_permutations.reserve(num_subdivs * num_stages);
+  subdiv_rank.reserve(num_subdivs * num_stages);
+  for (int sdi = 0; sdi < num_subdivs; ++sdi) {
+    for (int stage = 0; stage < num_stages; ++stage) {
+      subdiv_permutations.push_back(impl_details.subdiv_permutations[sdi]);
+      subdiv_rank.push_back(col_params->subdiv_rank[sdi]);
+    }
+  }
+  impl_details.subdiv_permutations = std::move(subdiv_permutations);
+  col_params->subdiv_rank = std::move(subdiv_rank);
+  VLOG(2) << "Split " << num_subdivs << " subdivs into " << num_stages
+          << " pipeline stages of " << chunk_bytes / num_stages << " bytes";
+}
+
+}  // namespace
 
 RingReducer::~RingReducer() { group_size_tensor_ready_.WaitForNotification(); }
 
@@ -49,7 +94,15 @@ Status RingReducer::InitializeCollectiveParams(CollectiveParams* col_params) {
   // TODO(b/113171733): change CHECKs to return errors.
   CHECK_EQ(col_params->instance.type, REDUCTION_COLLECTIVE);
   CHECK_EQ(col_params->instance.impl_details.collective_name, "RingReduce");
-  return RingAlg::InitializeCollectiveParams(col_params);
+  TF_RETURN_IF_ERROR(RingAlg::InitializeCollectiveParams(col_params));
+  // All members must split the same way, so the piece size has to be
+  // configured identically on every worker.
+  int64_t pipeline_chunk_bytes;
+  TF_RETURN_IF_ERROR(
+      ReadInt64FromEnvVar("TF_RING_REDUCE_PIPELINE_CHUNK_BYTES",
+                          /*default_val=*/0, &pipeline_chunk_bytes));
+  SplitSubdivsIntoPipelineStages(pipeline_chunk_bytes, col_params);
+  return absl::OkStatus();
 }
 
 void RingReducer::Run(StatusCallback done) {
@@ -64,6 +117,15 @@ void RingReducer::Run(StatusCallback done) {
   num_subdivs_ = static_cast<int>(
       col_params_->instance.impl_details.subdiv_permutations.size());
   CHECK_GT(num_subdivs_, 0);
+  compress_bfloat16_ =
+      col_params_->instance.impl_details.communication_hint ==
+      kBfloat16CompressionHint;
+  if (compress_bfloat16_ && (col_params_->instance.data_type != DT_FLOAT ||
+                             col_params_->group.device_type != DEVICE_CPU)) {
+    VLOG(1) << "RingReducer: bfloat16 compression is only supported for float "
+               "tensors on CPU, sending uncompressed values";
+    compress_bfloat16_ = false;
+  }
 
   if (VLOG_IS_ON(1)) {
     string buf;
@@ -27,7 +27,13 @@ limitations under the License.
 namespace tensorflow {
 class Device;
 
+inline constexpr char kBfloat16CompressionHint[] = "bfloat16";
+
 // Ring-algorithm implementation of collective all-reduce.
+//
+// If the instance's communication_hint is `kBfloat16CompressionHint`, float
+// chunks are rounded to bfloat16 for transfer and widened back to float before
+// being reduced, which halves the bytes sent at the cost of precision.
 class RingReducer : public RingAlg {
  public:
   RingReducer() : RingAlg(REDUCTION_COLLECTIVE, "Reduce") {}
@@ -38,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/platform/unbounded_work_queue.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/public/version.h"
@@ -374,6 +375,28 @@ TEST_F(RingReducerInitParamsTest, AutomaticSubdivDisabled) {
   RunSubdivPermsTest(cp.get(), {{0, 1, 2, 3}}, {0});
 }
 
+TEST_F(RingReducerInitParamsTest, PipelineStages) {
+  const int kNumDevsPerWorker = 4;
+  const int kNumWorkers = 1;
+  auto test_env =
+      CreateCollectiveTestEnv(kNumWorkers, kNumDevsPerWorker, DEVICE_CPU);
+  // Each of the 4 chunks of 1024 bytes is split into 4 pieces of 256 bytes.
+  auto cp = CreateCollectiveParams(*test_env, /*rank*/ 0, "RingReduce",
+                                   REDUCTION_COLLECTIVE, DT_FLOAT,
+                                   TensorShape({1024}));
+  cp->default_rank = 1;
+  cp->instance.impl_details.subdiv_offsets = {0};
+  setenv("TF_RING_REDUCE_PIPELINE_CHUNK_BYTES", "256", /*overwrite=*/1);
+  RunSubdivPermsTest(cp.get(),
+                     {{0, 1, 2, 3}, {0, 1, 2, 3}, {0, 1, 2, 3}, {0, 1, 2, 3}},
+                     {1, 1, 1, 1});
+
+  // Chunks smaller than the piece size are not split.
+  setenv("TF_RING_REDUCE_PIPELINE_CHUNK_BYTES", "4096", /*overwrite=*/1);
+  RunSubdivPermsTest(cp.get(), {{0, 1, 2, 3}}, {1});
+  unsetenv("TF_RING_REDUCE_PIPELINE_CHUNK_BYTES");
+}
+
 // TODO(b/113171733): change to use TEST_P.
 #define DEF_TEST(B, T, W, D, S, L, A)                                         \
   TEST_F(RingReducerTest,                                                     \
@@ -427,6 +450,97 @@ DEF_TEST(INT64, CPU, 2, 8, 3, 4095, 0)
 DEF_TEST(FLOAT, CPU, 2, 8, 1, 9408, 1)
 DEF_TEST(FLOAT, CPU, 2, 8, 1, 9408, 7)
 DEF_TEST(FLOAT, CPU, 2, 8, 2, 9408, 11)
+
+TEST_F(RingReducerTest, PipelinedChunks) {
+  setenv("TF_RING_REDUCE_PIPELINE_CHUNK_BYTES", "1024", /*overwrite=*/1);
+  RunTest<float>(DT_FLOAT, DEVICE_CPU, /*num_workers=*/2, /*num_devices=*/4,
+                 /*num_subdivs=*/2, /*tensor_len=*/40951, /*fail_after=*/0);
+  unsetenv("TF_RING_REDUCE_PIPELINE_CHUNK_BYTES");
+}
+
+TEST_F(RingReducerTest, Bfloat16Compression) {
+  const int kNumWorkers = 2;
+  const int kNumDevices = 4;
+  const int kTensorLen = 1001;
+  Init(kNumWorkers, kNumDevices, DT_FLOAT, TensorShape({kTensorLen}),
+       DEVICE_CPU, /*num_subdivs=*/2, /*fail_after=*/0);
+  std::vector<float> expected(kTensorLen);
+  for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+    instances_[di]->col_params_->instance.impl_details.communication_hint =
+        kBfloat16CompressionHint;
+    instances_[di]->InitTensor([&expected, di](Tensor* t) {
+      for (int i = 0; i < t->NumElements(); ++i) {
+        float value = 0.01f * (di + 1) * i;
+        t->flat<float>()(i) = value;
+        expected[i] += value;
+      }
+    });
+  }
+  Reduce(/*fail_after=*/0);
+  for (int i = 0; i < kTensorLen; ++i) {
+    expected[i] /= kNumWorkers * kNumDevices;
+  }
+  for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+    TF_EXPECT_OK(instances_[di]->status_);
+    // Values are only accurate to bfloat16 precision, but identical on all
+    // devices.
+    test::ExpectClose(test::AsTensor<float>(expected), instances_[di]->tensor(),
+                      /*atol=*/1e-3, /*rtol=*/2e-2);
+    test::ExpectTensorEqual<float>(instances_[0]->tensor(),
+                                   instances_[di]->tensor());
+  }
+}
+
+// Runs repeated all-reduces of one tensor, for benchmarks.
+class RingReducerBenchmark : public RingReducerTest {
+ public:
+  RingReducerBenchmark(int num_devices, int tensor_len) {
+    Init(/*num_workers=*/1, num_devices, DT_FLOAT, TensorShape({tensor_len}),
+         DEVICE_CPU, /*num_subdivs=*/0, /*fail_after=*/0);
+  }
+
+  void TestBody() override {}
+
+  void Run() {
+    for (auto& di : instances_) {
+      // `InitializeCollectiveParams` expects fresh permutations on each run.
+      di->col_params_->instance.impl_details.subdiv_permutations.clear();
+      di->col_params_->subdiv_rank.clear();
+    }
+    Reduce(/*fail_after=*/0);
+  }
+};
+
+// Reports the bus bandwidth of an all-reduce of `range(1)` floats across
+// `range(0)` devices, i.e. the bandwidth scaled by the 2 * (n - 1) / n bytes
+// each device sends per byte of the tensor, with pieces of `range(2)` bytes
+// if it is positive.
+void BM_RingReduce(::testing::benchmark::State& state) {
+  const int num_devices = state.range(0);
+  const int tensor_len = state.range(1);
+  const int pipeline_chunk_bytes = state.range(2);
+  setenv("TF_RING_REDUCE_PIPELINE_CHUNK_BYTES",
+         strings::StrCat(pipeline_chunk_bytes).c_str(), /*overwrite=*/1);
+  RingReducerBenchmark benchmark(num_devices, tensor_len);
+  for (auto s : state) {
+    benchmark.Run();
+  }
+  unsetenv("TF_RING_REDUCE_PIPELINE_CHUNK_BYTES");
+  const int64_t tensor_bytes = static_cast<int64_t>(tensor_len) * sizeof(float);
+  state.SetBytesProcessed(state.iterations() * tensor_bytes * 2 *
+                          (num_devices - 1) / num_devices);
+  state.SetLabel(strings::StrCat(num_devices, " devices, ", tensor_bytes,
+                                 " bytes, ", pipeline_chunk_bytes,
+                                 " pipeline chunk bytes"));
+}
+BENCHMARK(BM_RingReduce)
+    ->UseRealTime()
+    ->Args({8, 1 << 10, 0})
+    ->Args({8, 1 << 14, 0})
+    ->Args({8, 1 << 18, 0})
+    ->Args({8, 1 << 22, 0})
+    ->Args({8, 1 << 18, 64 << 10})
+    ->Args({8, 1 << 22, 64 << 10});
 #endif
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
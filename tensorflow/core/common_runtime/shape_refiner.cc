@@ -22,11 +22,13 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/common_runtime/eval_const_tensor.h"
 #include "tensorflow/core/common_runtime/function_utils.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/common_shape_fns.h"
+#include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/shape_inference.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -208,6 +210,77 @@ Status ShapeRefiner::InferShapesForFunction(const FunctionDef* function_def,
   return inference_status;
 }
 
+std::string ShapeRefiner::FunctionOutputShapesKey(
+    const NameAttrList& function, InferenceContext* context) {
+  std::string key = Canonicalize(function.name(), AttrSlice(&function.attr()));
+  for (int i = 0; i < context->num_inputs(); ++i) {
+    absl::StrAppend(&key, ";", context->DebugString(context->input(i)));
+    const std::vector<ShapeAndType>* handle_data =
+        context->input_handle_shapes_and_types(i);
+    if (handle_data == nullptr) continue;
+    for (const ShapeAndType& shape_and_type : *handle_data) {
+      absl::StrAppend(&key, ",", context->DebugString(shape_and_type), ":",
+                      shape_and_type.type.ShortDebugString());
+    }
+  }
+  return key;
+}
+
+void ShapeRefiner::MaybeCacheFunctionOutputShapes(const std::string& key,
+                                                  InferenceContext* context) {
+  for (int i = 0; i < context->num_inputs(); ++i) {
+    if (context->requested_input_tensor(i) ||
+        context->requested_input_tensor_as_partial_shape(i)) {
+      return;
+    }
+  }
+  FunctionOutputShapes output_shapes;
+  for (int i = 0; i < context->num_outputs(); ++i) {
+    if (!context->output(i).IsSet()) return;
+    output_shapes.shapes.push_back(
+        context->ShapeHandleToProto(context->output(i)));
+    const std::vector<ShapeAndType>* handle_data =
+        context->output_handle_shapes_and_types(i);
+    if (handle_data == nullptr) {
+      output_shapes.handle_data.emplace_back();
+      continue;
+    }
+    auto& cached_handle_data = output_shapes.handle_data.emplace_back();
+    cached_handle_data.emplace();
+    for (const ShapeAndType& shape_and_type : *handle_data) {
+      cached_handle_data->push_back(
+          {context->ShapeHandleToProto(shape_and_type.shape),
+           shape_and_type.dtype, shape_and_type.type});
+    }
+  }
+  function_output_shapes_[key] = std::move(output_shapes);
+}
+
+Status ShapeRefiner::SetFunctionOutputShapes(
+    const FunctionOutputShapes& output_shapes, InferenceContext* context) {
+  if (static_cast<int>(output_shapes.shapes.size()) != context->num_outputs()) {
+    return errors::Internal("Cached function call has ",
+                            output_shapes.shapes.size(),
+                            " outputs instead of ", context->num_outputs());
+  }
+  for (int i = 0; i < context->num_outputs(); ++i) {
+    ShapeHandle shape;
+    TF_RETURN_IF_ERROR(
+        context->MakeShapeFromShapeProto(output_shapes.shapes[i], &shape));
+    context->set_output(i, shape);
+    if (!output_shapes.handle_data[i].has_value()) continue;
+    std::vector<ShapeAndType> handle_data;
+    for (const auto& shape_and_type : *output_shapes.handle_data[i]) {
+      TF_RETURN_IF_ERROR(
+          context->MakeShapeFromShapeProto(shape_and_type.shape, &shape));
+      handle_data.emplace_back(shape, shape_and_type.dtype,
+                               shape_and_type.type);
+    }
+    context->set_output_handle_shapes_and_types(i, handle_data);
+  }
+  return absl::OkStatus();
+}
+
 Status ShapeRefiner::AddNode(const Node* node) {
   return AddNodeInternal(node, /*outer_context=*/nullptr);
 }
@@ -737,6 +810,12 @@ Status ShapeRefiner::RunShapeFn(const Node* node,
         const FunctionDef* function_def =
             function_library_->Find(function.name());
         if (function_def != nullptr) {
+          const std::string key = FunctionOutputShapesKey(function, c);
+          auto it = function_output_shapes_.find(key);
+          if (it != function_output_shapes_.end()) {
+            return SetFunctionOutputShapes(it->second, c);
+          }
+
           // The constant Tensor map we have for the outside context is not
           // valid inside the function. We need to push a new clean map while
           // performing inference on the function body.
@@ -745,6 +824,9 @@ Status ShapeRefiner::RunShapeFn(const Node* node,
           Status function_inference_status = InferShapesForFunction(
               function_def, AttrSlice(&function.attr()), c);
           const_tensor_map_ = const_tensor_map_copy;
+          if (function_inference_status.ok()) {
+            MaybeCacheFunctionOutputShapes(key, c);
+          }
           return function_inference_status;
         }
       }
@@ -16,14 +16,19 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_SHAPE_REFINER_H_
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/common_runtime/graph_runner.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/full_type.pb.h"
 #include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/macros.h"
@@ -249,6 +254,34 @@ class ShapeRefiner {
                     shape_inference::InferenceContext* context,
                     shape_inference::InferenceContext* outer_context = nullptr);
 
+  // The output shapes inferred for a call to a function. They only depend on
+  // the function, its attrs and the input shapes of the call when no input
+  // tensor was requested during the inference of the function body.
+  struct FunctionOutputShapes {
+    struct HandleShapeAndType {
+      TensorShapeProto shape;
+      DataType dtype;
+      FullTypeDef type;
+    };
+    std::vector<TensorShapeProto> shapes;
+    std::vector<std::optional<std::vector<HandleShapeAndType>>> handle_data;
+  };
+
+  // Returns the key of the output shapes of the call `context` to `function`
+  // in function_output_shapes_.
+  static std::string FunctionOutputShapesKey(
+      const NameAttrList& function, shape_inference::InferenceContext* context);
+
+  // Stores the output shapes of `context` in function_output_shapes_ under
+  // `key` if they do not depend on the values of the inputs.
+  void MaybeCacheFunctionOutputShapes(
+      const std::string& key, shape_inference::InferenceContext* context);
+
+  // Sets the outputs of `context` to the cached `output_shapes`.
+  static Status SetFunctionOutputShapes(
+      const FunctionOutputShapes& output_shapes,
+      shape_inference::InferenceContext* context);
+
   int32 graph_def_version_;
   const OpRegistryInterface* const ops_registry_;
 
@@ -283,6 +316,12 @@ class ShapeRefiner {
   // are refined.
   absl::flat_hash_map<std::string, std::unique_ptr<const Graph>> functions_;
 
+  // Cache the output shapes of the function calls, so that the body of a
+  // function called many times with the same input shapes is only inferred
+  // once.
+  absl::flat_hash_map<std::string, FunctionOutputShapes>
+      function_output_shapes_;
+
   ShapeRefiner(const ShapeRefiner&) = delete;
   void operator=(const ShapeRefiner&) = delete;
 };
@@ -59,6 +59,10 @@ class ShapeRefinerTest : public ::testing::Test {
     return ShapeRefiner::IsUpdatedShapesOrTypes(c, existing, updated);
   }
 
+  static int NumCachedFunctionOutputShapes(const ShapeRefiner& m) {
+    return m.function_output_shapes_.size();
+  }
+
   static constexpr int64_t kMaxTensorSize = ShapeRefiner::kMaxTensorSize;
 
   void TestStridedSlice(const PartialTensorShape& input_shape, int begin,
@@ -1493,6 +1497,35 @@ TEST_F(ShapeRefinerTest, FunctionShapeInferenceFallback) {
   EXPECT_SHAPE("?", m, x2, 0);
 }
 
+TEST_F(ShapeRefinerTest, FunctionShapeInferenceCachesOutputShapes) {
+  FunctionDefLibrary f_lib_proto;
+  *(f_lib_proto.add_function()) = test::function::XTimesTwo();
+  FunctionLibraryDefinition f_lib(OpRegistry::Global(), f_lib_proto);
+
+  Scope root = Scope::NewRootScope();
+  TF_ASSERT_OK(root.graph()->AddFunctionLibrary(f_lib_proto));
+  auto x = ops::Const(root, {{1.0f, 2.0f}});
+  auto y = ops::Const(root, {3.0f, 4.0f, 5.0f});
+  auto x2 = test::function::Call(&root, "x2", "XTimesTwo", {x});
+  auto x4 = test::function::Call(&root, "x4", "XTimesTwo", {x2});
+  auto y2 = test::function::Call(&root, "y2", "XTimesTwo", {y});
+
+  ShapeRefiner m(TF_GRAPH_DEF_VERSION, &f_lib);
+  m.set_function_library_for_shape_inference(&f_lib);
+
+  TF_ASSERT_OK(m.AddNode(x.node()));
+  TF_ASSERT_OK(m.AddNode(y.node()));
+  TF_ASSERT_OK(m.AddNode(x2.node()));
+  TF_ASSERT_OK(m.AddNode(x4.node()));
+  TF_ASSERT_OK(m.AddNode(y2.node()));
+
+  EXPECT_SHAPE("[1,2]", m, x2, 0);
+  EXPECT_SHAPE("[1,2]", m, x4, 0);
+  EXPECT_SHAPE("[3]", m, y2, 0);
+  // The second call with [1,2] inputs reuses the shapes of the first one.
+  EXPECT_EQ(NumCachedFunctionOutputShapes(m), 2);
+}
+
 TEST_F(ShapeRefinerTest, ChainedFunctionShapeInferenceWithMultipleInputs) {
   FunctionDefLibrary f_lib_proto;
   *(f_lib_proto.add_function()) = test::function::XTimesTwo();
@@ -103,6 +103,27 @@ void SimplePropagatorState::PropagateOutputs(const TaggedNode& tagged_node,
   }
 }
 
+void SimplePropagatorState::PropagateOutputsToScheduledNodes(
+    const TaggedNode& tagged_node, EntryVector* outputs) {
+  const NodeItem* item = tagged_node.node_item;
+  for (const EdgeInfo& e : item->output_edges()) {
+    if (e.is_last) {
+      input_tensors_[e.input_slot] = std::move((*outputs)[e.output_slot]);
+    } else {
+      input_tensors_[e.input_slot] = (*outputs)[e.output_slot];
+    }
+#if defined(THREAD_SANITIZER) || defined(DEBUG)
+    // Keeps the pending count checked by `GetInputTensors()` accurate.
+    pending_[e.dst_id].fetch_sub(1, std::memory_order_release);
+#endif  // defined(THREAD_SANITIZER) || defined(DEBUG)
+  }
+#if defined(THREAD_SANITIZER) || defined(DEBUG)
+  for (const ControlEdgeInfo& e : item->output_control_edges()) {
+    pending_[e.dst_id].fetch_sub(1, std::memory_order_release);
+  }
+#endif  // defined(THREAD_SANITIZER) || defined(DEBUG)
+}
+
 void SimplePropagatorState::DumpState() {
   mutex_lock l(mu_);
   // Dump any waiting nodes that are holding on to tensors.
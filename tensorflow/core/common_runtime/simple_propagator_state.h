@@ -116,6 +116,13 @@ class SimplePropagatorState {
   void PropagateOutputs(const TaggedNode& tagged_node, EntryVector* outputs,
                         TaggedNodeSeq* ready);
 
+  // Like `PropagateOutputs()`, for runs that follow a static schedule, which
+  // decides the order in which the nodes run: only moves `outputs` to the
+  // inputs of their dsts, without updating the pending counts or looking for
+  // newly ready nodes.
+  void PropagateOutputsToScheduledNodes(const TaggedNode& tagged_node,
+                                        EntryVector* outputs);
+
   // Returns an array of `Entry` objects corresponding to the inputs of
   // `tagged_node`.
   Entry* GetInputTensors(const TaggedNode& tagged_node) {
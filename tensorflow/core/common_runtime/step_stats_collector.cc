@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 
 #include "tensorflow/core/common_runtime/costmodel_manager.h"
@@ -194,9 +196,83 @@ void NodeExecStatsWrapper::Finalize() {
   allocations_.clear();
 }
 
+void CompactNodeExecStats::Done(const string& device) {
+  device_ = &device;
+  done_.store(true, std::memory_order_release);
+}
+
+void CompactNodeExecStats::RecordExecutorStarted() {
+  all_start_nanos_ = Env::Default()->NowNanos();
+}
+
+void CompactNodeExecStats::RecordComputeStarted() {
+  op_start_nanos_ = Env::Default()->NowNanos();
+}
+
+void CompactNodeExecStats::RecordComputeEnded() {
+  op_end_nanos_ = Env::Default()->NowNanos();
+}
+
+void CompactNodeExecStats::RecordExecutorEnded() {
+  all_end_nanos_ = Env::Default()->NowNanos();
+}
+
+void CompactNodeExecStats::SetOutput(int slot, const Tensor* tensor) {
+  DCHECK(tensor);
+  if (slot >= 0 && slot < kMaxOutputs) {
+    output_bytes_[slot] = tensor->TotalBytes();
+  }
+}
+
+void CompactNodeExecStats::ToNodeExecStats(NodeExecStats* stats) const {
+  stats->set_node_name(node_->name());
+  stats->set_scheduled_micros(scheduled_nanos_ / EnvTime::kMicrosToNanos);
+  stats->set_scheduled_nanos(scheduled_nanos_);
+  stats->set_all_start_micros(all_start_nanos_ / EnvTime::kMicrosToNanos);
+  stats->set_all_start_nanos(all_start_nanos_);
+  // Times which were not recorded, e.g. the compute times of nodes whose
+  // kernel did not run, are left unset.
+  auto relative_micros = [this](int64_t nanos) {
+    return nanos / EnvTime::kMicrosToNanos -
+           all_start_nanos_ / EnvTime::kMicrosToNanos;
+  };
+  if (op_start_nanos_ != 0) {
+    stats->set_op_start_rel_micros(relative_micros(op_start_nanos_));
+    stats->set_op_start_rel_nanos(op_start_nanos_ - all_start_nanos_);
+  }
+  if (op_end_nanos_ != 0) {
+    stats->set_op_end_rel_micros(relative_micros(op_end_nanos_));
+    stats->set_op_end_rel_nanos(op_end_nanos_ - all_start_nanos_);
+  }
+  if (all_end_nanos_ != 0) {
+    stats->set_all_end_rel_micros(relative_micros(all_end_nanos_));
+    stats->set_all_end_rel_nanos(all_end_nanos_ - all_start_nanos_);
+  }
+  for (int slot = 0; slot < kMaxOutputs; ++slot) {
+    if (output_bytes_[slot] < 0) continue;
+    NodeOutput* output = stats->add_output();
+    output->set_slot(slot);
+    AllocationDescription* allocation =
+        output->mutable_tensor_description()->mutable_allocation_description();
+    allocation->set_requested_bytes(output_bytes_[slot]);
+    allocation->set_allocated_bytes(output_bytes_[slot]);
+  }
+  stats->set_timeline_label(strings::StrCat(node_->name(), " = ", node_->op(),
+                                            "(",
+                                            absl::StrJoin(node_->input(), ", "),
+                                            ")"));
+}
+
 StepStatsCollector::StepStatsCollector(StepStats* step_stats)
     : finalized_(false), step_stats_(step_stats) {}
 
+StepStatsCollector::StepStatsCollector(StepStats* step_stats,
+                                       size_t max_compact_nodes)
+    : max_compact_nodes_(max_compact_nodes),
+      compact_nodes_(new CompactNodeExecStats[max_compact_nodes]),
+      finalized_(false),
+      step_stats_(step_stats) {}
+
 static int ExtractGpuWithStreamAll(string device_name) {
   // Check if the device name matches the ".*gpu:(\\d+)/stream:all$" regexp,
   // and if it does return the stream index (always positive). If it doesn't
@@ -430,6 +506,16 @@ NodeExecStatsInterface* StepStatsCollector::CreateNodeExecStats(
   if (IsSend(node) || IsRecv(node)) {
     return nullptr;
   }
+  if (compact_nodes_ != nullptr) {
+    const size_t index =
+        num_compact_nodes_.fetch_add(1, std::memory_order_relaxed);
+    if (index >= max_compact_nodes_) {
+      return nullptr;
+    }
+    CompactNodeExecStats* stats = &compact_nodes_[index];
+    stats->node_ = node;
+    return stats;
+  }
   return new NodeExecStatsWrapper(node, this);
 }
 
@@ -547,6 +633,20 @@ void StepStatsCollector::FinalizeInternal() {
       stats->stats()->Swap(dss->add_node_stats());
     }
   }
+  const size_t num_compact_nodes =
+      std::min(num_compact_nodes_.load(std::memory_order_relaxed),
+               max_compact_nodes_);
+  for (size_t i = 0; i < num_compact_nodes; ++i) {
+    const CompactNodeExecStats& stats = compact_nodes_[i];
+    // Nodes which have not finished, e.g. when the step failed, are dropped.
+    if (!stats.done_.load(std::memory_order_acquire)) continue;
+    DeviceStepStats*& dss = dev_stats_pb[*stats.device_];
+    if (dss == nullptr) {
+      dss = step_stats_->add_dev_stats();
+      dss->set_device(*stats.device_);
+    }
+    stats.ToNodeExecStats(dss->add_node_stats());
+  }
   for (const auto& device_thread : thread_names_) {
     if (dev_stats_pb.find(device_thread.first) == dev_stats_pb.end()) {
       // skip device without DeviceStepStats.
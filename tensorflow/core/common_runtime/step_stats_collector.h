@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_STATS_COLLECTOR_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_STATS_COLLECTOR_H_
 
+#include <atomic>
 #include <memory>
 #include <unordered_map>
 #include <vector>
@@ -131,6 +132,46 @@ class NodeExecStatsWrapper : public NodeExecStatsInterface {
   StepStatsCollector* const step_stats_collector_;  // Not owned.
 };
 
+// Records the statistics of one node into a fixed-size slot of the buffer
+// which a `StepStatsCollector` in compact mode allocates for the step. Only
+// the node times and the sizes of the first few outputs are recorded.
+class CompactNodeExecStats : public NodeExecStatsInterface {
+ public:
+  CompactNodeExecStats() = default;
+
+  void Done(const string& device) override;
+  void RecordExecutorStarted() override;
+  void RecordComputeStarted() override;
+  void RecordComputeEnded() override;
+  void RecordExecutorEnded() override;
+  bool TrackAllocations() const override { return false; }
+  void SetMemory(OpKernelContext* ctx) override {}
+  void SetOutput(int slot, const Tensor* tensor) override;
+  void SetScheduled(int64_t nanos) override { scheduled_nanos_ = nanos; }
+
+ private:
+  friend class StepStatsCollector;
+
+  static constexpr int kMaxOutputs = 4;
+
+  // Converts this record to `stats`.
+  void ToNodeExecStats(NodeExecStats* stats) const;
+
+  const NodeDef* node_ = nullptr;  // Not owned.
+  // Set by `Done`. The executor passes the name of its device, which outlives
+  // the step.
+  const string* device_ = nullptr;
+  std::atomic<bool> done_{false};
+  int64_t scheduled_nanos_ = 0;
+  int64_t all_start_nanos_ = 0;
+  int64_t op_start_nanos_ = 0;
+  int64_t op_end_nanos_ = 0;
+  int64_t all_end_nanos_ = 0;
+  // Bytes of the output in each of the first `kMaxOutputs` slots, or -1 for
+  // slots which were not set.
+  int64_t output_bytes_[kMaxOutputs] = {-1, -1, -1, -1};
+};
+
 // Statistics collection interface for step execution.
 //
 // See `StepStatsCollector` for a concrete implementation of this interface
@@ -159,6 +200,13 @@ class StepStatsCollector : public StepStatsCollectorInterface {
   // Does not take ownership of `step_stats`.
   explicit StepStatsCollector(StepStats* step_stats);
 
+  // Creates a collector in compact mode, which records the statistics of up
+  // to `max_compact_nodes` nodes as `CompactNodeExecStats` in a buffer
+  // allocated here, with no lock or allocation per node, and converts them
+  // to NodeExecStats in Finalize. Further nodes are not recorded. Memory
+  // allocations are not tracked in this mode.
+  StepStatsCollector(StepStats* step_stats, size_t max_compact_nodes);
+
   // BuildCostModel builds or updates a CostModel managed by cost_model_manager,
   // using the currently collected DeviceStats associated with the devices in
   // device_map.
@@ -195,6 +243,11 @@ class StepStatsCollector : public StepStatsCollectorInterface {
 
   void FinalizeInternal() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // The records of compact mode, or null in the default mode.
+  const size_t max_compact_nodes_ = 0;
+  const std::unique_ptr<CompactNodeExecStats[]> compact_nodes_;
+  std::atomic<size_t> num_compact_nodes_{0};
+
   mutex mu_;
   bool finalized_ TF_GUARDED_BY(mu_);
   std::unordered_map<string, NodeStatsVector> dev_stats_ TF_GUARDED_BY(mu_);
@@ -29,6 +29,7 @@ info. It does not have any negative impact on performance. */
 #include "absl/base/call_once.h"
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/local_device.h"
+#include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/scoped_allocator.h"
 #include "tensorflow/core/common_runtime/scoped_allocator_mgr.h"
 #include "tensorflow/core/common_runtime/threadpool_device.h"
@@ -62,6 +63,20 @@ ThreadPoolDevice::ThreadPoolDevice(const SessionOptions& options,
                                name, DEVICE_CPU, memory_limit, locality)),
       allocator_(allocator),
       scoped_allocator_mgr_(new ScopedAllocatorMgr(name)) {
+  // With NUMA affinity, the kernels of this device are also scheduled on
+  // threads of its node, so that a step placed on the device stays close to
+  // the memory of the node's allocator. Sessions which run their kernels
+  // inline keep doing so.
+  const int32_t inter_op_threads =
+      options.config.inter_op_parallelism_threads();
+  const bool run_inline =
+      inter_op_threads < 0 ||
+      (inter_op_threads == 0 && NumInterOpThreadsFromEnvironment() < 0);
+  if (options.config.experimental().use_numa_affinity() && !run_inline) {
+    set_tensorflow_device_thread_pool(
+        NUMAThreadPoolFromSessionOptions(options, locality.numa_node()));
+  }
+
   auto s = NodeFileWriter::GetNodeFileWriterIfEnabled(name, env());
   if (!s.ok()) {
     LOG(ERROR) << s.status();
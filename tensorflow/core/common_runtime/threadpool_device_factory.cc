@@ -38,6 +38,10 @@ class ThreadPoolDeviceFactory : public DeviceFactory {
   Status CreateDevices(const SessionOptions& options, const string& name_prefix,
                        std::vector<std::unique_ptr<Device>>* devices) override {
     int num_numa_nodes = port::NUMANumNodes();
+    if (options.config.experimental().use_numa_affinity()) {
+      // Give each NUMA node its own CPU allocator, as requested below.
+      ProcessState::singleton()->EnableNUMA();
+    }
     int n = 1;
     auto iter = options.config.device_count().find("CPU");
     if (iter != options.config.device_count().end()) {
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/public/session_options.h"
 
 namespace tensorflow {
@@ -68,5 +69,36 @@ TEST(ThreadPoolDeviceTest, CopyTensor) {
   device_context->Unref();
 }
 
+TEST(ThreadPoolDeviceTest, NUMAAffinityGivesTheDeviceAThreadPool) {
+  SessionOptions options;
+  options.config.mutable_experimental()->set_use_numa_affinity(true);
+  DeviceLocality locality;
+  locality.set_numa_node(0);
+  ThreadPoolDevice device(options, "/device:CPU:0", Bytes(256), locality,
+                          cpu_allocator());
+  thread::ThreadPool* pool = device.tensorflow_device_thread_pool();
+  ASSERT_NE(pool, nullptr);
+
+  // The pool is shared by all the devices on the node.
+  ThreadPoolDevice same_node_device(options, "/device:CPU:1", Bytes(256),
+                                    locality, cpu_allocator());
+  EXPECT_EQ(same_node_device.tensorflow_device_thread_pool(), pool);
+}
+
+TEST(ThreadPoolDeviceTest, NoThreadPoolWithoutNUMAAffinity) {
+  ThreadPoolDevice device(SessionOptions(), "/device:CPU:0", Bytes(256),
+                          DeviceLocality(), cpu_allocator());
+  EXPECT_EQ(device.tensorflow_device_thread_pool(), nullptr);
+}
+
+TEST(ThreadPoolDeviceTest, NoThreadPoolWhenRunningInline) {
+  SessionOptions options;
+  options.config.mutable_experimental()->set_use_numa_affinity(true);
+  options.config.set_inter_op_parallelism_threads(-1);
+  ThreadPoolDevice device(options, "/device:CPU:0", Bytes(256),
+                          DeviceLocality(), cpu_allocator());
+  EXPECT_EQ(device.tensorflow_device_thread_pool(), nullptr);
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -0,0 +1,137 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_READY_QUEUE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_READY_QUEUE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A set of per-worker ready queues with work stealing, used by the executor
+// when it runs in "WORK_STEALING_EXECUTOR" mode.
+//
+// Instead of dispatching one closure per ready node to the inter-op thread
+// pool, an `ExecutorState` dispatches at most `num_workers()` long-running
+// worker closures. Each worker owns one shard, pushes the nodes that become
+// ready on its thread onto that shard, and pops from its own shard first
+// before stealing from the shards of the other workers.
+//
+// `TaggedNodeReadyQueue` is the propagator's ready queue type (e.g.
+// `PropagatorState::TaggedNodeReadyQueue`). It is not thread-safe, so every
+// shard guards its queue with its own mutex. The shard mutexes are only
+// contended when a worker steals.
+//
+// Workers are tracked with `TryAddWorker()` and `RemoveWorker()`, which
+// together guarantee that a pushed node is never left in the queues without an
+// active worker to run it.
+template <class TaggedNode, class TaggedNodeReadyQueue>
+class WorkStealingReadyQueue {
+ public:
+  explicit WorkStealingReadyQueue(int num_workers)
+      : num_workers_(std::max(1, num_workers)),
+        shards_(new Shard[num_workers_]) {}
+
+  WorkStealingReadyQueue(const WorkStealingReadyQueue&) = delete;
+  void operator=(const WorkStealingReadyQueue&) = delete;
+
+  int num_workers() const { return num_workers_; }
+
+  // Returns a shard index for a new worker, distributing workers round-robin
+  // over the shards.
+  int NextWorkerId() {
+    return next_worker_id_.fetch_add(1, std::memory_order_relaxed) %
+           num_workers_;
+  }
+
+  // Pushes `node` onto the shard owned by `worker_id`. A negative `worker_id`
+  // means that the caller is not a worker, and a shard is picked round-robin.
+  void Push(int worker_id, const TaggedNode& node) {
+    if (worker_id < 0) worker_id = NextWorkerId();
+    Shard& shard = shards_[worker_id];
+    {
+      mutex_lock l(shard.mu);
+      shard.queue.push_back(node);
+    }
+    num_queued_.fetch_add(1);
+  }
+
+  // Pops a node from the shard owned by `worker_id`, or steals one from
+  // another shard if that shard is empty, and appends it to `*ready`. Returns
+  // false if every shard was observed to be empty.
+  bool PopInto(int worker_id, TaggedNodeReadyQueue* ready) {
+    if (num_queued_.load(std::memory_order_relaxed) <= 0) return false;
+    for (int i = 0; i < num_workers_; ++i) {
+      Shard& shard = shards_[(worker_id + i) % num_workers_];
+      {
+        mutex_lock l(shard.mu);
+        if (shard.queue.empty()) continue;
+        ready->push_back(shard.queue.front());
+        shard.queue.pop_front();
+      }
+      num_queued_.fetch_sub(1);
+      return true;
+    }
+    return false;
+  }
+
+  // Registers a new worker if fewer than `num_workers()` workers are active.
+  // Returns true if the caller must start a worker.
+  bool TryAddWorker() {
+    int active = num_active_workers_.load();
+    while (active < num_workers_) {
+      if (num_active_workers_.compare_exchange_weak(active, active + 1)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Deregisters a worker that observed empty queues. Returns true if nodes
+  // were pushed concurrently and the caller has been re-registered, in which
+  // case it must keep running.
+  //
+  // Either this re-check observes a concurrent `Push()`, or the pusher's
+  // subsequent `TryAddWorker()` observes the decremented worker count.
+  bool RemoveWorker() {
+    num_active_workers_.fetch_sub(1);
+    return num_queued_.load() > 0 && TryAddWorker();
+  }
+
+ private:
+  // Aligned to avoid false sharing between workers' mutexes.
+  struct alignas(64) Shard {
+    mutex mu;
+    TaggedNodeReadyQueue queue TF_GUARDED_BY(mu);
+  };
+
+  const int num_workers_;
+  std::unique_ptr<Shard[]> shards_;
+  std::atomic<int> num_active_workers_{0};
+  // May transiently be negative, because `PopInto()` can observe a node before
+  // the corresponding `Push()` increments the counter.
+  std::atomic<int64_t> num_queued_{0};
+  std::atomic<uint32> next_worker_id_{0};
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_READY_QUEUE_H_
@@ -0,0 +1,207 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/autotune_coordinator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/platform/env_time.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Marginal gains are clamped to this range so that one model with a bad
+// estimate cannot take all resources.
+constexpr double kMinMarginalGain = 0.01;
+constexpr double kMaxMarginalGain = 100.0;
+
+}  // namespace
+
+AutotuneCoordinator& AutotuneCoordinator::Global() {
+  static auto* coordinator = new AutotuneCoordinator();
+  return *coordinator;
+}
+
+void AutotuneCoordinator::Register(
+    std::shared_ptr<model::Model> model,
+    std::shared_ptr<model::RamBudgetManager> ram_budget_manager) {
+  mutex_lock l(mu_);
+  const model::Model* key = model.get();
+  entries_[key] = Entry{std::move(model), std::move(ram_budget_manager),
+                        /*quota=*/std::nullopt};
+  // Rebalances at the next `GetCpuBudget` call.
+  last_rebalance_ms_ = 0;
+}
+
+void AutotuneCoordinator::Deregister(const model::Model* model) {
+  mutex_lock l(mu_);
+  entries_.erase(model);
+  last_rebalance_ms_ = 0;
+}
+
+int64_t AutotuneCoordinator::GetCpuBudget(const model::Model* model,
+                                          int64_t total_cpu_budget) {
+  const int64_t now_ms = EnvTime::NowMicros() / EnvTime::kMillisToMicros;
+  std::vector<std::shared_ptr<model::Model>> models;
+  {
+    tf_shared_lock l(mu_);
+    auto it = entries_.find(model);
+    if (it == entries_.end()) {
+      return total_cpu_budget;
+    }
+    if (it->second.quota.has_value() &&
+        last_rebalance_ms_ + kRebalancePeriodMs > now_ms) {
+      return it->second.quota->cpu_budget;
+    }
+    for (const auto& [unused, entry] : entries_) {
+      models.push_back(entry.model);
+    }
+  }
+
+  // Like `Model::Optimize`, adds the bytes buffered by the models back to the
+  // available RAM so that the budget does not shrink as buffers fill up.
+  double buffered_bytes = 0.0;
+  for (const std::shared_ptr<model::Model>& m : models) {
+    std::shared_ptr<model::Node> output = m->output();
+    if (output != nullptr) {
+      buffered_bytes += output->TotalBufferedBytes();
+    }
+  }
+  const int64_t total_ram_budget = static_cast<int64_t>(
+      model::kRamBudgetShare * (port::AvailableRam() + buffered_bytes));
+
+  mutex_lock l(mu_);
+  RebalanceLocked(total_cpu_budget, total_ram_budget);
+  last_rebalance_ms_ = now_ms;
+  auto it = entries_.find(model);
+  if (it == entries_.end() || !it->second.quota.has_value()) {
+    return total_cpu_budget;
+  }
+  return it->second.quota->cpu_budget;
+}
+
+std::optional<AutotuneCoordinator::Quota> AutotuneCoordinator::GetQuota(
+    const model::Model* model) const {
+  tf_shared_lock l(mu_);
+  auto it = entries_.find(model);
+  if (it == entries_.end()) {
+    return std::nullopt;
+  }
+  return it->second.quota;
+}
+
+void AutotuneCoordinator::Rebalance(int64_t total_cpu_budget,
+                                    int64_t total_ram_budget) {
+  mutex_lock l(mu_);
+  RebalanceLocked(total_cpu_budget, total_ram_budget);
+}
+
+int64_t AutotuneCoordinator::NumModels() const {
+  tf_shared_lock l(mu_);
+  return entries_.size();
+}
+
+void AutotuneCoordinator::RebalanceLocked(int64_t total_cpu_budget,
+                                          int64_t total_ram_budget) {
+  if (entries_.empty()) {
+    return;
+  }
+  std::vector<Entry*> entries;
+  std::vector<double> gains;
+  double total_gain = 0.0;
+  for (auto& [unused, entry] : entries_) {
+    entries.push_back(&entry);
+    gains.push_back(AutotuneMarginalGain(*entry.model));
+    total_gain += gains.back();
+  }
+
+  std::vector<int64_t> cpu_budgets =
+      AllocateByMarginalGain(gains, total_cpu_budget, /*min_units=*/1);
+  for (size_t i = 0; i < entries.size(); ++i) {
+    Quota quota;
+    quota.marginal_gain = gains[i];
+    // Every model gets at least one CPU, even if that over-commits the CPUs.
+    quota.cpu_budget = std::max<int64_t>(cpu_budgets[i], 1);
+    // Splitting in proportion to the gains is what handing out bytes one at
+    // a time by marginal gain converges to.
+    quota.ram_budget =
+        static_cast<int64_t>(total_ram_budget * gains[i] / total_gain);
+    if (entries[i]->ram_budget_manager != nullptr) {
+      entries[i]->ram_budget_manager->UpdateBudgetLimit(quota.ram_budget);
+    }
+    entries[i]->quota = quota;
+    VLOG(2) << "Autotune quota: cpu_budget " << quota.cpu_budget
+            << ", ram_budget " << quota.ram_budget << ", marginal_gain "
+            << quota.marginal_gain;
+  }
+}
+
+double AutotuneMarginalGain(model::Model& model) {
+  const double processing_time_nsec = model.ComputeSnapshotProcessingTimeNsec();
+  const double target_time_nsec = model.ComputeExperimentalTargetTimeNsec();
+  if (processing_time_nsec <= 0.0 || target_time_nsec <= 0.0) {
+    return 1.0;
+  }
+  return std::clamp(processing_time_nsec / target_time_nsec, kMinMarginalGain,
+                    kMaxMarginalGain);
+}
+
+std::vector<int64_t> AllocateByMarginalGain(const std::vector<double>& gains,
+                                            int64_t total, int64_t min_units) {
+  std::vector<int64_t> allocation(gains.size(), 0);
+  if (gains.empty()) {
+    return allocation;
+  }
+  int64_t remaining = total;
+  for (int64_t& units : allocation) {
+    units = std::min(min_units, std::max<int64_t>(remaining, 0));
+    remaining -= units;
+  }
+
+  // Ordered by the gain of giving one more unit to a consumer, then by index
+  // so that ties are broken deterministically.
+  using Candidate = std::pair<double, int64_t>;
+  auto next_unit_gain = [&](int64_t i) {
+    return allocation[i] == 0 ? gains[i] * 2.0 : gains[i] / allocation[i];
+  };
+  auto compare = [](const Candidate& a, const Candidate& b) {
+    return a.first < b.first || (a.first == b.first && a.second > b.second);
+  };
+  std::priority_queue<Candidate, std::vector<Candidate>, decltype(compare)>
+      candidates(compare);
+  for (int64_t i = 0; i < gains.size(); ++i) {
+    candidates.push({next_unit_gain(i), i});
+  }
+  for (; remaining > 0; --remaining) {
+    const int64_t i = candidates.top().second;
+    candidates.pop();
+    ++allocation[i];
+    candidates.push({next_unit_gain(i), i});
+  }
+  return allocation;
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,123 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_AUTOTUNE_COORDINATOR_H_
+#define TENSORFLOW_CORE_DATA_AUTOTUNE_COORDINATOR_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// Name of the experiment that makes input pipelines share the process CPU and
+// RAM budgets through `AutotuneCoordinator::Global()`.
+inline constexpr char kAutotuneCoordinatorExperiment[] =
+    "global_autotune_coordinator";
+
+// Divides the CPU and RAM budgets of a process between the autotuning models
+// of its input pipelines. Without coordination, each model assumes it can use
+// all CPUs and its share of the available RAM, so concurrent pipelines (e.g.
+// train and eval) over-commit both.
+//
+// CPUs are handed out one at a time to the model with the highest marginal
+// gain. A model's gain is how far its input pipeline falls behind its
+// consumer: the estimated time to produce an element divided by the average
+// time between `GetNext` calls. The gain of a model's next CPU is its gain
+// divided by the CPUs it already has, so CPUs go to input-bound pipelines with
+// diminishing returns. Every model is guaranteed at least one CPU. RAM is split
+// in proportion to the gains, which is what the same rule converges to for
+// small units. Models without timing estimates have a gain of 1.
+//
+// The CPU quota of a model is returned by `GetCpuBudget`, which the model's
+// optimization loop uses as its CPU budget. Its RAM quota caps the budget of
+// its `RamBudgetManager`. This class is thread-safe.
+class AutotuneCoordinator {
+ public:
+  struct Quota {
+    int64_t cpu_budget = 0;
+    int64_t ram_budget = 0;
+    double marginal_gain = 0.0;
+  };
+
+  // Minimum time between two rebalances triggered by `GetCpuBudget`.
+  static constexpr int64_t kRebalancePeriodMs = 1000;
+
+  // Returns the process-wide coordinator.
+  static AutotuneCoordinator& Global();
+
+  // Starts coordinating the budgets of `model`. `ram_budget_manager` is the
+  // RAM budget manager of its input pipeline.
+  void Register(std::shared_ptr<model::Model> model,
+                std::shared_ptr<model::RamBudgetManager> ram_budget_manager)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Stops coordinating the budgets of `model`.
+  void Deregister(const model::Model* model) TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the CPU budget of `model` out of `total_cpu_budget`, rebalancing
+  // the quotas first if they are older than `kRebalancePeriodMs`. Returns
+  // `total_cpu_budget` if `model` is not registered.
+  int64_t GetCpuBudget(const model::Model* model, int64_t total_cpu_budget)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the current quota of `model`, or `std::nullopt` if it is not
+  // registered or no quota has been computed yet.
+  std::optional<Quota> GetQuota(const model::Model* model) const
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Divides `total_cpu_budget` CPUs and `total_ram_budget` bytes between the
+  // registered models, and applies the RAM quotas to their RAM budget
+  // managers.
+  void Rebalance(int64_t total_cpu_budget, int64_t total_ram_budget)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of registered models.
+  int64_t NumModels() const TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct Entry {
+    std::shared_ptr<model::Model> model;
+    std::shared_ptr<model::RamBudgetManager> ram_budget_manager;
+    std::optional<Quota> quota;
+  };
+
+  void RebalanceLocked(int64_t total_cpu_budget, int64_t total_ram_budget)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  mutable mutex mu_;
+  absl::flat_hash_map<const model::Model*, Entry> entries_ TF_GUARDED_BY(mu_);
+  int64_t last_rebalance_ms_ TF_GUARDED_BY(mu_) = 0;
+};
+
+// Returns the marginal gain of `model`. See `AutotuneCoordinator`.
+double AutotuneMarginalGain(model::Model& model);
+
+// Divides `total` units between consumers with marginal gains `gains`, giving
+// each unit to the consumer with the highest gain divided by its current
+// allocation. Each consumer first gets `min_units` units, if `total` allows.
+std::vector<int64_t> AllocateByMarginalGain(const std::vector<double>& gains,
+                                            int64_t total, int64_t min_units);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_AUTOTUNE_COORDINATOR_H_
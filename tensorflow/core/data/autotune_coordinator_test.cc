@@ -0,0 +1,119 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/autotune_coordinator.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+TEST(AllocateByMarginalGainTest, EqualGains) {
+  EXPECT_THAT(AllocateByMarginalGain({1.0, 1.0, 1.0}, /*total=*/9,
+                                     /*min_units=*/1),
+              ElementsAre(3, 3, 3));
+}
+
+TEST(AllocateByMarginalGainTest, ProportionalToGains) {
+  EXPECT_THAT(AllocateByMarginalGain({3.0, 1.0}, /*total=*/8,
+                                     /*min_units=*/1),
+              ElementsAre(6, 2));
+}
+
+TEST(AllocateByMarginalGainTest, MinUnits) {
+  EXPECT_THAT(AllocateByMarginalGain({100.0, 1.0}, /*total=*/4,
+                                     /*min_units=*/1),
+              ElementsAre(3, 1));
+  EXPECT_THAT(AllocateByMarginalGain({1.0, 1.0, 1.0}, /*total=*/2,
+                                     /*min_units=*/1),
+              ElementsAre(1, 1, 0));
+}
+
+TEST(AllocateByMarginalGainTest, Empty) {
+  EXPECT_THAT(AllocateByMarginalGain({}, /*total=*/4, /*min_units=*/1),
+              IsEmpty());
+}
+
+TEST(AutotuneMarginalGainTest, NoTimingEstimates) {
+  model::Model model;
+  EXPECT_DOUBLE_EQ(AutotuneMarginalGain(model), 1.0);
+}
+
+TEST(AutotuneCoordinatorTest, UnregisteredModel) {
+  AutotuneCoordinator coordinator;
+  model::Model model;
+  EXPECT_EQ(coordinator.GetCpuBudget(&model, /*total_cpu_budget=*/8), 8);
+  EXPECT_FALSE(coordinator.GetQuota(&model).has_value());
+}
+
+TEST(AutotuneCoordinatorTest, SplitsBudgets) {
+  AutotuneCoordinator coordinator;
+  auto model_1 = std::make_shared<model::Model>();
+  auto model_2 = std::make_shared<model::Model>();
+  auto ram_budget_manager_1 =
+      std::make_shared<model::RamBudgetManager>(/*budget=*/1000);
+  auto ram_budget_manager_2 =
+      std::make_shared<model::RamBudgetManager>(/*budget=*/1000);
+  coordinator.Register(model_1, ram_budget_manager_1);
+  coordinator.Register(model_2, ram_budget_manager_2);
+  EXPECT_EQ(coordinator.NumModels(), 2);
+
+  coordinator.Rebalance(/*total_cpu_budget=*/8, /*total_ram_budget=*/1000);
+  std::optional<AutotuneCoordinator::Quota> quota_1 =
+      coordinator.GetQuota(model_1.get());
+  std::optional<AutotuneCoordinator::Quota> quota_2 =
+      coordinator.GetQuota(model_2.get());
+  ASSERT_TRUE(quota_1.has_value());
+  ASSERT_TRUE(quota_2.has_value());
+  EXPECT_EQ(quota_1->cpu_budget, 4);
+  EXPECT_EQ(quota_2->cpu_budget, 4);
+  EXPECT_EQ(quota_1->ram_budget, 500);
+  EXPECT_EQ(quota_2->ram_budget, 500);
+  EXPECT_EQ(ram_budget_manager_1->AvailableModelRam(), 500);
+  EXPECT_EQ(ram_budget_manager_2->AvailableModelRam(), 500);
+
+  // `model_1` gets everything once `model_2` is gone.
+  coordinator.Deregister(model_2.get());
+  EXPECT_EQ(coordinator.NumModels(), 1);
+  coordinator.Rebalance(/*total_cpu_budget=*/8, /*total_ram_budget=*/1000);
+  quota_1 = coordinator.GetQuota(model_1.get());
+  ASSERT_TRUE(quota_1.has_value());
+  EXPECT_EQ(quota_1->cpu_budget, 8);
+  EXPECT_EQ(quota_1->ram_budget, 1000);
+}
+
+TEST(AutotuneCoordinatorTest, GetCpuBudgetRebalances) {
+  AutotuneCoordinator coordinator;
+  auto model_1 = std::make_shared<model::Model>();
+  auto model_2 = std::make_shared<model::Model>();
+  coordinator.Register(model_1, /*ram_budget_manager=*/nullptr);
+  coordinator.Register(model_2, /*ram_budget_manager=*/nullptr);
+  EXPECT_EQ(coordinator.GetCpuBudget(model_1.get(), /*total_cpu_budget=*/6),
+            3);
+  EXPECT_EQ(coordinator.GetCpuBudget(model_2.get(), /*total_cpu_budget=*/6),
+            3);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -19,6 +19,7 @@ limitations under the License.
 #include <array>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <functional>
 #include <memory>
 #include <queue>
@@ -91,6 +92,7 @@ constexpr char kShuffleAndRepeatFusionOpt[] = "shuffle_and_repeat_fusion";
 constexpr char kFilterFusionOpt[] = "filter_fusion";
 constexpr char kMapAndFilterFusionOpt[] = "map_and_filter_fusion";
 constexpr char kMapFusionOpt[] = "map_fusion";
+constexpr char kMapVectorizationOpt[] = "map_vectorization";
 constexpr char kParallelBatchOpt[] = "parallel_batch";
 constexpr char kAutotuneBufferSizesOpt[] = "autotune_buffer_sizes";
 constexpr char kDisablePrefetchLegacyAutotuneOpt[] =
@@ -193,6 +195,14 @@ void DefaultOptimizationGraphRewrites(
       optimization_disabled->insert(kMapFusionOpt);
     }
   }
+  if (optimization_options.optional_map_vectorization_case() ==
+      OptimizationOptions::kMapVectorization) {
+    if (optimization_options.map_vectorization()) {
+      optimization_enabled->insert(kMapVectorizationOpt);
+    } else {
+      optimization_disabled->insert(kMapVectorizationOpt);
+    }
+  }
   if (optimization_options.optional_noop_elimination_case() ==
       OptimizationOptions::kNoopElimination) {
     if (optimization_options.noop_elimination()) {
@@ -963,6 +973,32 @@ IteratorContext MakeNestedIteratorContext(IteratorContext* ctx) {
   return IteratorContext(std::move(params));
 }
 
+Status CopyToGpuCompatibleMemory(IteratorContext* ctx,
+                                 std::vector<Tensor>* element) {
+  AllocatorAttributes gpu_compatible;
+  gpu_compatible.set_gpu_compatible(true);
+  Allocator* allocator = ctx->allocator(gpu_compatible);
+  if (allocator == ctx->allocator({})) return absl::OkStatus();
+  for (Tensor& component : *element) {
+    if (!DataTypeCanUseMemcpy(component.dtype()) ||
+        component.NumElements() == 0) {
+      continue;
+    }
+    Tensor copy(allocator, component.dtype(), component.shape());
+    if (!copy.IsInitialized()) {
+      return errors::ResourceExhausted(
+          "Failed to allocate ", component.TotalBytes(),
+          " bytes of GPU-compatible memory for a tensor of shape ",
+          component.shape().DebugString());
+    }
+    const StringPiece src = component.tensor_data();
+    std::memcpy(const_cast<char*>(copy.tensor_data().data()), src.data(),
+                src.size());
+    component = std::move(copy);
+  }
+  return absl::OkStatus();
+}
+
 // static
 void DatasetExperimentRegistry::Register(const string& experiment,
                                          JobSelector job_selector,
@@ -1024,6 +1060,12 @@ REGISTER_DATASET_EXPERIMENT("inject_io_prefetch", RandomJobSamplePercentage<0>,
                             AllTasks);
 REGISTER_DATASET_EXPERIMENT("map_fusion", RandomJobSamplePercentage<0>,
                             AllTasks);
+REGISTER_DATASET_EXPERIMENT("bounded_reorder_parallel_map",
+                            RandomJobSamplePercentage<0>, AllTasks);
+REGISTER_DATASET_EXPERIMENT("adaptive_interleave_prefetch",
+                            RandomJobSamplePercentage<0>, AllTasks);
+REGISTER_DATASET_EXPERIMENT("compressed_memory_cache",
+                            RandomJobSamplePercentage<0>, AllTasks);
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
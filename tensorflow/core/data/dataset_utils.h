@@ -347,6 +347,13 @@ int64 GetAutotuneDefaultParallelism(IteratorContext* ctx);
 // function passed to `interleave` or `flat_map`.
 IteratorContext MakeNestedIteratorContext(IteratorContext* ctx);
 
+// Copies the components of `element` that can be copied with memcpy to memory
+// from the GPU-compatible allocator of `ctx`, i.e. the pinned host allocator on
+// hosts with GPUs, so that they can be copied to a GPU by DMA without first
+// being staged in pinned memory. Does nothing if `ctx` has no such allocator.
+Status CopyToGpuCompatibleMemory(IteratorContext* ctx,
+                                 std::vector<Tensor>* element);
+
 // A `DatasetExperimentRegistry::JobSelector` that randomly selects
 // `rollout_pct` percent of all jobs. `name_hash` is a hash of the experiment
 // and job names.
@@ -26,12 +26,14 @@ limitations under the License.
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/data/test_utils.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/dataset.pb.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -227,6 +229,61 @@ TEST(DatasetUtilsTest, MakeNestedIteratorContext) {
   EXPECT_TRUE(nested_ctx.split_providers().empty());
 }
 
+// Forwards to the CPU allocator, counting the allocations.
+class CountingAllocator : public Allocator {
+ public:
+  std::string Name() override { return "counting"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_allocations_;
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+  void DeallocateRaw(void* ptr) override {
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+  int num_allocations() const { return num_allocations_; }
+
+ private:
+  int num_allocations_ = 0;
+};
+
+TEST(DatasetUtilsTest, CopyToGpuCompatibleMemory) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TestContext> test_ctx,
+                          TestContext::Create());
+  CountingAllocator gpu_compatible_allocator;
+  IteratorContext::Params params(test_ctx->op_ctx());
+  params.allocator_getter =
+      [&gpu_compatible_allocator](AllocatorAttributes attrs) -> Allocator* {
+    if (attrs.gpu_compatible()) return &gpu_compatible_allocator;
+    return cpu_allocator();
+  };
+  IteratorContext iter_ctx(params);
+  const Tensor floats = test::AsTensor<float>({1, 2, 3, 4, 5, 6}, {2, 3});
+  const Tensor strings = test::AsTensor<tstring>({"a", "b"}, {2});
+  std::vector<Tensor> element = {floats, strings};
+
+  TF_ASSERT_OK(CopyToGpuCompatibleMemory(&iter_ctx, &element));
+  EXPECT_EQ(gpu_compatible_allocator.num_allocations(), 1);
+  test::ExpectTensorEqual<float>(element[0], floats);
+  EXPECT_NE(element[0].tensor_data().data(), floats.tensor_data().data());
+  // Strings cannot be copied with memcpy, so they are left alone.
+  EXPECT_TRUE(element[1].SharesBufferWith(strings));
+}
+
+TEST(DatasetUtilsTest, CopyToGpuCompatibleMemoryWithoutSuchAllocator) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TestContext> test_ctx,
+                          TestContext::Create());
+  IteratorContext::Params params(test_ctx->op_ctx());
+  params.allocator_getter = [](AllocatorAttributes attrs) {
+    return cpu_allocator();
+  };
+  IteratorContext iter_ctx(params);
+  const Tensor floats = test::AsTensor<float>({1, 2, 3}, {3});
+  std::vector<Tensor> element = {floats};
+
+  TF_ASSERT_OK(CopyToGpuCompatibleMemory(&iter_ctx, &element));
+  EXPECT_TRUE(element[0].SharesBufferWith(floats));
+}
+
 REGISTER_DATASET_EXPERIMENT("test_only_experiment_0",
                             RandomJobSamplePercentage<0>, AllTasks);
 REGISTER_DATASET_EXPERIMENT("test_only_experiment_1",
@@ -668,6 +725,7 @@ GetOptimizationsTestCase GetOptimizationTestCase4() {
   options.mutable_optimization_options()->set_map_and_filter_fusion(true);
   options.mutable_optimization_options()->set_map_fusion(true);
   options.mutable_optimization_options()->set_map_parallelization(true);
+  options.mutable_optimization_options()->set_map_vectorization(true);
   options.mutable_optimization_options()->set_noop_elimination(true);
   options.mutable_optimization_options()->set_parallel_batch(true);
   options.mutable_optimization_options()->set_shuffle_and_repeat_fusion(true);
@@ -678,9 +736,9 @@ GetOptimizationsTestCase GetOptimizationTestCase4() {
           /*expected_enabled=*/
           {"filter_fusion", "filter_parallelization", "make_sloppy",
            "map_and_batch_fusion", "map_and_filter_fusion", "map_fusion",
-           "map_parallelization", "noop_elimination", "parallel_batch",
-           "shuffle_and_repeat_fusion", "slack", "inject_prefetch",
-           "seq_interleave_prefetch"},
+           "map_parallelization", "map_vectorization", "noop_elimination",
+           "parallel_batch", "shuffle_and_repeat_fusion", "slack",
+           "inject_prefetch", "seq_interleave_prefetch"},
           /*expected_disabled=*/{},
           /*expected_default=*/{}};
 }
@@ -23,6 +23,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "tensorflow/core/data/autotune_coordinator.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/rewrite_utils.h"
@@ -190,7 +191,12 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
     cancellation_manager_ = std::make_unique<CancellationManager>();
   }
 
-  ~Iterator() override { cancellation_manager_->StartCancel(); }
+  ~Iterator() override {
+    cancellation_manager_->StartCancel();
+    if (coordinate_autotuning_) {
+      AutotuneCoordinator::Global().Deregister(model_.get());
+    }
+  }
 
   bool SymbolicCheckpointCompatible() const override { return true; }
 
@@ -216,6 +222,13 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
       if (experiments.contains("autotune_buffer_optimization")) {
         model_->AddExperiment("autotune_buffer_optimization");
       }
+      if (experiments.contains("autotune_consumer_contention")) {
+        model_->AddExperiment("autotune_consumer_contention");
+      }
+      if (experiments.contains(kAutotuneCoordinatorExperiment)) {
+        coordinate_autotuning_ = true;
+        AutotuneCoordinator::Global().Register(model_, ram_budget_manager_);
+      }
     }
     IteratorContext iter_ctx(CreateParams(ctx));
     if (model_) {
@@ -354,8 +367,20 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
           // Dynamic RAM budget should only apply to tf.data service.
           raw_ram_budget = params.ComputeInitialAutotuneRamBudget();
         }
+        std::function<int64_t()> cpu_budget_func =
+            params.autotune_cpu_budget_func;
+        if (coordinate_autotuning_) {
+          // The coordinator shares the process CPUs with the other input
+          // pipelines, and caps `ram_budget_manager_` at this pipeline's share
+          // of the RAM.
+          cpu_budget_func = [model = model_.get(),
+                             total_cpu_budget_func = cpu_budget_func]() {
+            return AutotuneCoordinator::Global().GetCpuBudget(
+                model, total_cpu_budget_func());
+          };
+        }
         Status status = model_->OptimizeLoop(
-            params.autotune_algorithm, params.autotune_cpu_budget_func,
+            params.autotune_algorithm, cpu_budget_func,
             params.ram_budget_share, raw_ram_budget, *ram_budget_manager_,
             cancellation_manager_.get());
         if (!status.ok()) {
@@ -370,6 +395,8 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
   // `ram_budget_manager_` coordinates the memory budget and allocation
   // between prefetch legacy autotune and `tensorflow::data::model::Model`
   std::shared_ptr<model::RamBudgetManager> ram_budget_manager_ = nullptr;
+  // Whether `model_` is registered with `AutotuneCoordinator::Global()`.
+  bool coordinate_autotuning_ = false;
   // Controls cancellation of `model_thread_`. Must be ordered before
   // `model_thread_` so that `model_thread_` is destroyed first.
   std::unique_ptr<CancellationManager> cancellation_manager_;
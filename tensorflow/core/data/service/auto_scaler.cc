@@ -26,6 +26,7 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/log.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/metrics.h"
@@ -130,6 +131,28 @@ std::optional<int64_t> AutoScaler::GetOptimalNumberOfWorkers() const
   return std::max(int64_t{1}, optimal_number_of_workers);
 }
 
+absl::flat_hash_map<std::string, double> AutoScaler::GetWorkerUtilizations()
+    const TF_LOCKS_EXCLUDED(mu_) {
+  tsl::mutex_lock l(mu_);
+  absl::flat_hash_map<std::string, double> utilizations;
+  if (worker_throughputs_.empty() || consumption_rates_.empty()) {
+    return utilizations;
+  }
+
+  std::vector<double> consumption_rates_without_outliers;
+  ReplaceOutliers(consumption_rates_, consumption_rates_without_outliers,
+                  kAutoScalerOutlierSigmas);
+  double consumption_rate_per_worker =
+      std::accumulate(consumption_rates_without_outliers.begin(),
+                      consumption_rates_without_outliers.end(), 0.0) /
+      static_cast<double>(worker_throughputs_.size());
+  for (const auto& [worker_address, worker_throughput] : worker_throughputs_) {
+    utilizations[worker_address] =
+        consumption_rate_per_worker / worker_throughput;
+  }
+  return utilizations;
+}
+
 absl::Status AutoScaler::ReportProcessingTime(const std::string& worker_address,
                                               absl::Duration processing_time)
     TF_LOCKS_EXCLUDED(mu_) {
@@ -206,6 +229,20 @@ absl::Status MultipleIterationsAutoScaler::UnregisterIteration(
 
 absl::Status MultipleIterationsAutoScaler::UpdateOptimalNumberOfWorkersMetric(
     int64_t current_number_of_workers) TF_LOCKS_EXCLUDED(mu_) {
+  absl::StatusOr<int64_t> bound_optimal_number_of_workers =
+      GetBoundOptimalNumberOfWorkers(current_number_of_workers);
+  if (!bound_optimal_number_of_workers.ok()) {
+    return bound_optimal_number_of_workers.status();
+  }
+  metrics::RecordTFDataServiceOptimalNumberOfWorkers(
+      bound_optimal_number_of_workers.value());
+
+  return absl::OkStatus();
+}
+
+absl::StatusOr<int64_t>
+MultipleIterationsAutoScaler::GetBoundOptimalNumberOfWorkers(
+    int64_t current_number_of_workers) const TF_LOCKS_EXCLUDED(mu_) {
   if (current_number_of_workers <= 0)
     return absl::InvalidArgumentError(
         "The current number of workers must be positive");
@@ -214,8 +251,8 @@ absl::Status MultipleIterationsAutoScaler::UpdateOptimalNumberOfWorkersMetric(
       GetOptimalNumberOfWorkers();
   if (!optimal_number_of_workers)
     return absl::UnavailableError(
-        "Cannot update the optimal number of workers metric because there are "
-        "no reported processing and target processing times for at least one "
+        "Cannot estimate the optimal number of workers because there are no "
+        "reported processing and target processing times for at least one "
         "iteration");
 
   VLOG(3) << "Estimated optimal number of workers: "
@@ -236,10 +273,7 @@ absl::Status MultipleIterationsAutoScaler::UpdateOptimalNumberOfWorkersMetric(
   VLOG(3) << "Bound optimal number of workers: "
           << bound_optimal_number_of_workers;
 
-  metrics::RecordTFDataServiceOptimalNumberOfWorkers(
-      bound_optimal_number_of_workers);
-
-  return absl::OkStatus();
+  return bound_optimal_number_of_workers;
 }
 
 std::optional<int64_t> MultipleIterationsAutoScaler::GetOptimalNumberOfWorkers()
@@ -263,6 +297,36 @@ std::optional<int64_t> MultipleIterationsAutoScaler::GetOptimalNumberOfWorkers()
     return optimal_number_of_workers;
 }
 
+absl::flat_hash_map<int64_t, int64_t>
+MultipleIterationsAutoScaler::GetOptimalNumberOfWorkersByIteration() const
+    TF_LOCKS_EXCLUDED(mu_) {
+  absl::flat_hash_map<int64_t, int64_t> optimal_numbers_of_workers;
+  tsl::tf_shared_lock l(mu_);
+  for (const auto& [iteration_id, auto_scaler] : auto_scalers_) {
+    std::optional<int64_t> optimal_number_of_workers =
+        auto_scaler->GetOptimalNumberOfWorkers();
+    if (optimal_number_of_workers.has_value()) {
+      optimal_numbers_of_workers[iteration_id] =
+          optimal_number_of_workers.value();
+    }
+  }
+  return optimal_numbers_of_workers;
+}
+
+absl::flat_hash_map<std::string, double>
+MultipleIterationsAutoScaler::GetWorkerUtilizations() const
+    TF_LOCKS_EXCLUDED(mu_) {
+  absl::flat_hash_map<std::string, double> utilizations;
+  tsl::tf_shared_lock l(mu_);
+  for (const auto& [iteration_id, auto_scaler] : auto_scalers_) {
+    for (const auto& [worker_address, utilization] :
+         auto_scaler->GetWorkerUtilizations()) {
+      utilizations[worker_address] += utilization;
+    }
+  }
+  return utilizations;
+}
+
 absl::Status MultipleIterationsAutoScaler::ReportProcessingTime(
     int64_t iteration_id, const std::string& worker_address,
     absl::Duration processing_time) TF_LOCKS_EXCLUDED(mu_) {
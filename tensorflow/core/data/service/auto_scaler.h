@@ -22,6 +22,7 @@ limitations under the License.
 #include <string>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
 #include "absl/time/time.h"
 #include "tsl/platform/mutex.h"
 #include "tsl/platform/status.h"
@@ -73,6 +74,13 @@ class AutoScaler {
   // target processing times, returns nullopt.
   std::optional<int64_t> GetOptimalNumberOfWorkers() const
       TF_LOCKS_EXCLUDED(mu_);
+  // Returns the estimated utilization of each worker that reported a
+  // processing time: the fraction of its throughput needed to serve an even
+  // share of the reported consumption rates. A utilization above 1 means the
+  // worker cannot keep up. Returns an empty map if there are no previously
+  // reported target processing times.
+  absl::flat_hash_map<std::string, double> GetWorkerUtilizations() const
+      TF_LOCKS_EXCLUDED(mu_);
   // Reports the latest observed processing time from the worker with
   // `worker_address`. Returns an error if `processing_time` is ZeroDuration or
   // negative.
@@ -126,11 +134,24 @@ class MultipleIterationsAutoScaler {
   // iteration, or `current_number_of_workers` is not positive.
   absl::Status UpdateOptimalNumberOfWorkersMetric(
       int64_t current_number_of_workers) TF_LOCKS_EXCLUDED(mu_);
+  // Returns the estimated optimal number of workers, limited as in
+  // `UpdateOptimalNumberOfWorkersMetric`. Returns an error under the same
+  // conditions.
+  absl::StatusOr<int64_t> GetBoundOptimalNumberOfWorkers(
+      int64_t current_number_of_workers) const TF_LOCKS_EXCLUDED(mu_);
   // Returns the estimated optimal number of workers according to the current
   // observed workload. If there are no previously reported processing and
   // target processing times for at least one iteration, returns nullopt.
   std::optional<int64_t> GetOptimalNumberOfWorkers() const
       TF_LOCKS_EXCLUDED(mu_);
+  // Returns the estimated optimal number of workers of each iteration with
+  // previously reported processing and target processing times.
+  absl::flat_hash_map<int64_t, int64_t> GetOptimalNumberOfWorkersByIteration()
+      const TF_LOCKS_EXCLUDED(mu_);
+  // Returns the utilization of each worker, as defined by
+  // `AutoScaler::GetWorkerUtilizations`, summed over all iterations.
+  absl::flat_hash_map<std::string, double> GetWorkerUtilizations() const
+      TF_LOCKS_EXCLUDED(mu_);
   // Reports the latest observed processing time from the worker with
   // `worker_address` for iteration with `iteration_id`. Returns an error if
   // `processing_time` is ZeroDuration or negative.
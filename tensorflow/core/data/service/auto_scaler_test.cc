@@ -15,8 +15,11 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/auto_scaler.h"
 
+#include <cstdint>
 #include <optional>
+#include <string>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/lib/monitoring/cell_reader.h"
@@ -27,6 +30,7 @@ namespace tensorflow {
 namespace data {
 namespace {
 
+using ::tsl::testing::IsOkAndHolds;
 using ::tsl::testing::StatusIs;
 
 TEST(AutoScalerTest, GetOptimalNumberOfWorkersInitialState) {
@@ -308,6 +312,37 @@ TEST(AutoScalerTest, RemoveConsumerAfterNewTPTReported) {
   TF_ASSERT_OK(auto_scaler.RemoveConsumer(0));
 }
 
+TEST(AutoScalerTest, GetWorkerUtilizationsNoRegisteredConsumers) {
+  AutoScaler auto_scaler;
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime("/worker/task/0:20000",
+                                                absl::Seconds(0.2)));
+  EXPECT_TRUE(auto_scaler.GetWorkerUtilizations().empty());
+}
+
+// Worker 0:
+//   - Processing time = 0.2 [s] -> Throughput = 5 [elements/s]
+// Worker 1:
+//   - Processing time = 0.1 [s] -> Throughput = 10 [elements/s]
+// Consumer 0:
+//   - Target processing time = 0.1 [s] -> Consumption rate = 10 [elements/s]
+//
+// Consumption rate per worker = 10 / 2 = 5 [elements/s]
+// Utilization of worker 0 = 5 / 5 = 1
+// Utilization of worker 1 = 5 / 10 = 0.5
+TEST(AutoScalerTest, GetWorkerUtilizations) {
+  AutoScaler auto_scaler;
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime("/worker/task/0:20000",
+                                                absl::Seconds(0.2)));
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime("/worker/task/1:20000",
+                                                absl::Seconds(0.1)));
+  TF_ASSERT_OK(auto_scaler.ReportTargetProcessingTime(0, absl::Seconds(0.1)));
+  absl::flat_hash_map<std::string, double> utilizations =
+      auto_scaler.GetWorkerUtilizations();
+  ASSERT_EQ(utilizations.size(), 2);
+  EXPECT_DOUBLE_EQ(utilizations["/worker/task/0:20000"], 1.0);
+  EXPECT_DOUBLE_EQ(utilizations["/worker/task/1:20000"], 0.5);
+}
+
 TEST(MultipleIterationsAutoScalerTest, UnregisterExistingIteration) {
   MultipleIterationsAutoScaler auto_scaler;
   TF_ASSERT_OK(
@@ -743,6 +778,49 @@ TEST(MultipleIterationsAutoScalerTest, RemoveConsumerAfterNewTPTReported) {
   TF_ASSERT_OK(auto_scaler.RemoveConsumer(0, 0));
 }
 
+// Iteration 0:
+//   - Worker 0: Processing time = 0.2 [s] -> Throughput = 5 [elements/s]
+//   - Consumer 0: Target processing time = 0.1 [s] -> Consumption rate = 10
+//   [elements/s]
+//   - Estimated number of workers = 10 / 5 = 2
+//   - Utilization of worker 0 = 10 / 5 = 2
+// Iteration 1:
+//   - Worker 0: Processing time = 0.1 [s] -> Throughput = 10 [elements/s]
+//   - Consumer 0: Target processing time = 0.2 [s] -> Consumption rate = 5
+//   [elements/s]
+//   - Estimated number of workers = ⌈5 / 10⌉ = 1
+//   - Utilization of worker 0 = 5 / 10 = 0.5
+TEST(MultipleIterationsAutoScalerTest, GetEstimatesByIterationAndWorker) {
+  MultipleIterationsAutoScaler auto_scaler;
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime(0, "/worker/task/0:20000",
+                                                absl::Seconds(0.2)));
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(0, 0, absl::Seconds(0.1)));
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime(1, "/worker/task/0:20000",
+                                                absl::Seconds(0.1)));
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(1, 0, absl::Seconds(0.2)));
+
+  absl::flat_hash_map<int64_t, int64_t> optimal_numbers_of_workers =
+      auto_scaler.GetOptimalNumberOfWorkersByIteration();
+  ASSERT_EQ(optimal_numbers_of_workers.size(), 2);
+  EXPECT_EQ(optimal_numbers_of_workers[0], 2);
+  EXPECT_EQ(optimal_numbers_of_workers[1], 1);
+  EXPECT_THAT(auto_scaler.GetBoundOptimalNumberOfWorkers(1), IsOkAndHolds(2));
+
+  absl::flat_hash_map<std::string, double> utilizations =
+      auto_scaler.GetWorkerUtilizations();
+  ASSERT_EQ(utilizations.size(), 1);
+  EXPECT_DOUBLE_EQ(utilizations["/worker/task/0:20000"], 2.5);
+}
+
+TEST(MultipleIterationsAutoScalerTest,
+     GetBoundOptimalNumberOfWorkersNoReportedTimes) {
+  MultipleIterationsAutoScaler auto_scaler;
+  EXPECT_THAT(auto_scaler.GetBoundOptimalNumberOfWorkers(1),
+              StatusIs(absl::StatusCode::kUnavailable));
+}
+
 }  // namespace
 
 }  // namespace data
@@ -0,0 +1,181 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/cache_spill_log.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+
+namespace tensorflow {
+namespace data {
+
+StatusOr<std::unique_ptr<CacheSpillLog>> CacheSpillLog::Create(
+    Env* env, const std::string& directory, size_t max_size_bytes,
+    size_t segment_size_bytes) {
+  if (env->FileExists(directory).ok()) {
+    return errors::AlreadyExists(
+        "tf.data service cross-trainer cache spill directory ", directory,
+        " already exists.");
+  }
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(directory));
+  return absl::WrapUnique(new CacheSpillLog(env, directory, max_size_bytes,
+                                            segment_size_bytes));
+}
+
+CacheSpillLog::CacheSpillLog(Env* env, const std::string& directory,
+                             size_t max_size_bytes, size_t segment_size_bytes)
+    : env_(env),
+      directory_(directory),
+      max_size_bytes_(max_size_bytes),
+      segment_size_bytes_(segment_size_bytes) {}
+
+CacheSpillLog::~CacheSpillLog() {
+  mutex_lock l(mu_);
+  if (writer_) {
+    writer_->Close().IgnoreError();
+  }
+  int64_t undeleted_files, undeleted_dirs;
+  Status s =
+      env_->DeleteRecursively(directory_, &undeleted_files, &undeleted_dirs);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to delete tf.data service cross-trainer cache "
+                 << "spill directory " << directory_ << ": " << s;
+  }
+}
+
+Status CacheSpillLog::Append(size_t index, absl::string_view record) {
+  mutex_lock l(mu_);
+  if (segments_.empty()) {
+    TF_RETURN_IF_ERROR(StartSegment(index));
+  } else {
+    const Segment& last = segments_.back();
+    size_t next_index = last.start_index + last.offsets.size() - 1;
+    if (index != next_index) {
+      return errors::InvalidArgument(
+          "tf.data service cross-trainer cache spill log expected index ",
+          next_index, ", got ", index);
+    }
+    if (last.offsets.back() >= segment_size_bytes_) {
+      TF_RETURN_IF_ERROR(StartSegment(index));
+    }
+  }
+  TF_RETURN_IF_ERROR(writer_->Append(record));
+  // Flushes so that readers see the record.
+  TF_RETURN_IF_ERROR(writer_->Flush());
+  Segment& segment = segments_.back();
+  segment.offsets.push_back(segment.offsets.back() + record.size());
+  size_bytes_ += record.size();
+  DeleteOldSegments();
+  return absl::OkStatus();
+}
+
+StatusOr<std::string> CacheSpillLog::Read(size_t index) {
+  std::shared_ptr<RandomAccessFile> file;
+  uint64_t offset, size;
+  {
+    mutex_lock l(mu_);
+    auto it = std::upper_bound(segments_.begin(), segments_.end(), index,
+                               [](size_t i, const Segment& segment) {
+                                 return i < segment.start_index;
+                               });
+    if (it == segments_.begin()) {
+      return errors::NotFound("Element ", index, " is not in the spill log.");
+    }
+    const Segment& segment = *std::prev(it);
+    size_t offset_index = index - segment.start_index;
+    if (offset_index + 1 >= segment.offsets.size()) {
+      return errors::NotFound("Element ", index, " is not in the spill log.");
+    }
+    file = segment.file;
+    offset = segment.offsets[offset_index];
+    size = segment.offsets[offset_index + 1] - offset;
+  }
+
+  std::string record(size, '\0');
+  StringPiece result;
+  TF_RETURN_IF_ERROR(file->Read(offset, size, &result, record.data()));
+  if (result.size() != size) {
+    return errors::DataLoss("Failed to read element ", index,
+                            " from the spill log: expected ", size,
+                            " bytes, got ", result.size());
+  }
+  if (result.data() != record.data()) {
+    record.assign(result.data(), result.size());
+  }
+  return record;
+}
+
+size_t CacheSpillLog::StartIndex() const {
+  mutex_lock l(mu_);
+  if (segments_.empty() || segments_.front().offsets.size() == 1) {
+    return std::numeric_limits<size_t>::max();
+  }
+  return segments_.front().start_index;
+}
+
+size_t CacheSpillLog::SizeBytes() const {
+  mutex_lock l(mu_);
+  return size_bytes_;
+}
+
+Status CacheSpillLog::StartSegment(size_t index) {
+  if (writer_) {
+    TF_RETURN_IF_ERROR(writer_->Close());
+    writer_.reset();
+  }
+  Segment segment;
+  segment.filename =
+      io::JoinPath(directory_, absl::StrCat("segment_", next_segment_id_++));
+  segment.start_index = index;
+  TF_RETURN_IF_ERROR(env_->NewWritableFile(segment.filename, &writer_));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(segment.filename, &file));
+  segment.file = std::move(file);
+  segments_.push_back(std::move(segment));
+  return absl::OkStatus();
+}
+
+void CacheSpillLog::DeleteOldSegments() {
+  while (size_bytes_ > max_size_bytes_ && segments_.size() > 1) {
+    const Segment& segment = segments_.front();
+    size_bytes_ -= segment.offsets.back();
+    // Ongoing reads keep the file open.
+    Status s = env_->DeleteFile(segment.filename);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to delete tf.data service cross-trainer cache "
+                   << "spill file " << segment.filename << ": " << s;
+    }
+    segments_.pop_front();
+  }
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,108 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_CACHE_SPILL_LOG_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_CACHE_SPILL_LOG_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// An append-only log of records on local disk, indexed by consecutive element
+// positions. It backs the spill tier of the cross-trainer cache.
+//
+// Records are appended to segment files in `directory` without framing; an
+// in-memory index stores the offset of each record. When the log exceeds
+// `max_size_bytes`, its oldest segments are deleted. The directory is deleted
+// when the log is destroyed.
+//
+// `CacheSpillLog` is thread-safe. Reads do not block appends.
+class CacheSpillLog {
+ public:
+  // Creates a log writing to `directory`, which must not exist.
+  // `segment_size_bytes` is the size at which a new segment file is started,
+  // which is the granularity at which old records are deleted.
+  static StatusOr<std::unique_ptr<CacheSpillLog>> Create(
+      Env* env, const std::string& directory, size_t max_size_bytes,
+      size_t segment_size_bytes);
+  ~CacheSpillLog();
+  CacheSpillLog(const CacheSpillLog&) = delete;
+  CacheSpillLog& operator=(const CacheSpillLog&) = delete;
+
+  // Appends the record for position `index`.
+  // REQUIRES: The log is empty, or `index` is the last appended index plus 1.
+  Status Append(size_t index, absl::string_view record);
+
+  // Reads the record at position `index`. Returns NOT_FOUND if it was never
+  // appended or has been deleted.
+  StatusOr<std::string> Read(size_t index);
+
+  // Returns the position of the oldest record, or
+  // `std::numeric_limits<size_t>::max()` if the log is empty.
+  size_t StartIndex() const;
+
+  // Returns the total size of the records in the log.
+  size_t SizeBytes() const;
+
+ private:
+  struct Segment {
+    std::string filename;
+    // Position of the first record in the segment.
+    size_t start_index = 0;
+    // `offsets[i]` is the offset of record `start_index + i`. The last entry is
+    // the end of the last record.
+    std::vector<uint64_t> offsets = {0};
+    // Readers copy the file to read without holding `mu_`.
+    std::shared_ptr<RandomAccessFile> file;
+  };
+
+  CacheSpillLog(Env* env, const std::string& directory, size_t max_size_bytes,
+                size_t segment_size_bytes);
+
+  // Starts a new segment for records starting at `index`.
+  Status StartSegment(size_t index) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Deletes the oldest segments until the log fits in `max_size_bytes_`. The
+  // current segment is never deleted.
+  void DeleteOldSegments() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Env* const env_;
+  const std::string directory_;
+  const size_t max_size_bytes_;
+  const size_t segment_size_bytes_;
+
+  mutable mutex mu_;
+  std::deque<Segment> segments_ TF_GUARDED_BY(mu_);
+  // Writer of the last segment.
+  std::unique_ptr<WritableFile> writer_ TF_GUARDED_BY(mu_);
+  size_t size_bytes_ TF_GUARDED_BY(mu_) = 0;
+  int64_t next_segment_id_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_CACHE_SPILL_LOG_H_
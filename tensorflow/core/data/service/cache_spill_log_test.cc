@@ -0,0 +1,112 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/cache_spill_log.h"
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::testing::IsOkAndHolds;
+using ::tensorflow::testing::StatusIs;
+
+std::string SpillDirectory() {
+  std::string directory = io::JoinPath(testing::TmpDir(), "spill_log");
+  EXPECT_TRUE(Env::Default()->CreateUniqueFileName(&directory, ""));
+  return directory;
+}
+
+StatusOr<std::unique_ptr<CacheSpillLog>> CreateLog(size_t max_size_bytes,
+                                                   size_t segment_size_bytes) {
+  return CacheSpillLog::Create(Env::Default(), SpillDirectory(), max_size_bytes,
+                               segment_size_bytes);
+}
+
+std::string Record(size_t index) { return absl::StrCat("record ", index); }
+
+TEST(CacheSpillLogTest, AppendAndRead) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CacheSpillLog> log,
+                          CreateLog(/*max_size_bytes=*/1 << 20,
+                                    /*segment_size_bytes=*/32));
+  EXPECT_EQ(log->StartIndex(), std::numeric_limits<size_t>::max());
+  for (size_t i = 5; i < 100; ++i) {
+    TF_ASSERT_OK(log->Append(i, Record(i)));
+  }
+  EXPECT_EQ(log->StartIndex(), 5);
+  for (size_t i = 5; i < 100; ++i) {
+    EXPECT_THAT(log->Read(i), IsOkAndHolds(Record(i)));
+  }
+  EXPECT_THAT(log->Read(4), StatusIs(error::NOT_FOUND));
+  EXPECT_THAT(log->Read(100), StatusIs(error::NOT_FOUND));
+}
+
+TEST(CacheSpillLogTest, DeletesOldSegments) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CacheSpillLog> log,
+                          CreateLog(/*max_size_bytes=*/100,
+                                    /*segment_size_bytes=*/30));
+  for (size_t i = 0; i < 1000; ++i) {
+    TF_ASSERT_OK(log->Append(i, Record(i)));
+    EXPECT_LE(log->SizeBytes(), 100 + 30 + Record(i).size());
+  }
+  size_t start_index = log->StartIndex();
+  EXPECT_GT(start_index, 900);
+  EXPECT_THAT(log->Read(start_index - 1), StatusIs(error::NOT_FOUND));
+  for (size_t i = start_index; i < 1000; ++i) {
+    EXPECT_THAT(log->Read(i), IsOkAndHolds(Record(i)));
+  }
+}
+
+TEST(CacheSpillLogTest, RequiresConsecutiveIndices) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CacheSpillLog> log,
+                          CreateLog(/*max_size_bytes=*/1 << 20,
+                                    /*segment_size_bytes=*/1024));
+  TF_ASSERT_OK(log->Append(0, Record(0)));
+  EXPECT_THAT(log->Append(2, Record(2)), StatusIs(error::INVALID_ARGUMENT));
+}
+
+TEST(CacheSpillLogTest, DeletesDirectory) {
+  std::string directory = SpillDirectory();
+  {
+    TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CacheSpillLog> log,
+                            CacheSpillLog::Create(Env::Default(), directory,
+                                                  /*max_size_bytes=*/1 << 20,
+                                                  /*segment_size_bytes=*/1024));
+    TF_ASSERT_OK(log->Append(0, Record(0)));
+    TF_EXPECT_OK(Env::Default()->FileExists(directory));
+    EXPECT_THAT(CacheSpillLog::Create(Env::Default(), directory,
+                                      /*max_size_bytes=*/1 << 20,
+                                      /*segment_size_bytes=*/1024),
+                StatusIs(error::ALREADY_EXISTS));
+  }
+  EXPECT_THAT(Env::Default()->FileExists(directory),
+              StatusIs(error::NOT_FOUND));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
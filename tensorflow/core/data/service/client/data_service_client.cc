@@ -500,10 +500,12 @@ void DataServiceClient::UpdateTasks(const ClientHeartbeatResponse& resp)
   int index = 0;
   while (index < tasks_.size()) {
     std::shared_ptr<Task> task = tasks_[index];
-    if (task_id_to_task.contains(task->info.task_id())) {
+    auto it = task_id_to_task.find(task->info.task_id());
+    if (it != task_id_to_task.end()) {
+      task->draining = it->second.draining();
       // Remove already-known tasks from `task_id_to_task`, so that at the
       // end of the loop, only new tasks remain.
-      task_id_to_task.erase(task->info.task_id());
+      task_id_to_task.erase(it);
       ++index;
     } else {
       // Task has been removed.
@@ -861,6 +863,18 @@ Status DataServiceClient::GetElement(Task* task, int64_t deadline_micros,
                                      bool enqueue_result, bool allow_skip,
                                      std::shared_ptr<Result> result)
     TF_LOCKS_EXCLUDED(mu_) {
+  bool draining;
+  {
+    mutex_lock l(mu_);
+    draining = task->draining;
+  }
+  if (IsCoordinatedRead() && draining) {
+    TF_RETURN_IF_ERROR(MaybeRemoveTask(*task, deadline_micros, *result));
+    mutex_lock l(mu_);
+    if (result->skip) {
+      return absl::OkStatus();
+    }
+  }
   GetElementResult get_element_result;
   while (true) {
     Status s = TryGetElement(*task, allow_skip, get_element_result);
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_H_
 
+#include <algorithm>
 #include <cstddef>
 #include <deque>
 #include <functional>
@@ -24,6 +25,7 @@ limitations under the License.
 #include <utility>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "tensorflow/core/data/service/byte_size.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/platform/errors.h"
@@ -91,6 +93,31 @@ class CachableSequence {
   virtual size_t GetElementSizeBytes(const ElementType&) const = 0;
 };
 
+// An optional second tier for elements evicted from a `CrossTrainerCache`,
+// e.g. on local disk. Trainers which fall behind the in-memory window read
+// spilled elements instead of jumping ahead. Elements are spilled in order, so
+// a tier holds the consecutive elements from `StartIndex()` up to the start of
+// the in-memory window. A tier may drop its oldest elements to bound its size.
+//
+// Implementations must be thread-safe.
+template <class ElementType>
+class CacheSpillTier {
+ public:
+  virtual ~CacheSpillTier() = default;
+
+  // Spills `element`, the element at `index`. Consecutive calls spill
+  // consecutive indices.
+  virtual Status Spill(size_t index, const ElementType& element) = 0;
+
+  // Reads the spilled element at `index`. Returns NOT_FOUND if the element has
+  // been dropped.
+  virtual StatusOr<ElementType> Read(size_t index) = 0;
+
+  // Returns the index of the oldest spilled element, or
+  // `std::numeric_limits<size_t>::max()` if no element is spilled.
+  virtual size_t StartIndex() const = 0;
+};
+
 // Sliding-window cache shared across concurrent trainers.
 template <class ElementType>
 class CrossTrainerCache {
@@ -98,9 +125,13 @@ class CrossTrainerCache {
   // Creates a `CrossTrainerCache` with `max_cache_size_bytes` of memory budget.
   // The cache should be able to hold at least one element, i.e.:
   // REQUIRES: `max_cache_size_bytes >= max(GetElementSizeBytes(*))`
+  //
+  // If `spill_tier` is not null, elements evicted from memory are spilled to
+  // it.
   explicit CrossTrainerCache(
       size_t max_cache_size_bytes,
-      std::unique_ptr<CachableSequence<ElementType>> cachable_sequence);
+      std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+      std::unique_ptr<CacheSpillTier<ElementType>> spill_tier = nullptr);
   virtual ~CrossTrainerCache() = default;
   CrossTrainerCache(const CrossTrainerCache&) = delete;
   CrossTrainerCache& operator=(const CrossTrainerCache&) = delete;
@@ -129,6 +160,11 @@ class CrossTrainerCache {
   // Returns the next element and metrics about this query.
   StatusOr<CacheQueryResult> GetCacheQueryResult(const std::string& trainer_id);
 
+  // Returns true if the next element for `trainer_id` has been evicted from
+  // memory but can be read from `spill_tier_`. Trainers which fell behind the
+  // spill tier are moved to its oldest element.
+  bool IsElementSpilled(const std::string& trainer_id);
+
   // Returns true if element is ready for `trainer_id`. An element is ready if
   // other trainers have read the data and the data remains in the cache. If the
   // data is not ready, one of the trainers need to extend the cache.
@@ -147,6 +183,7 @@ class CrossTrainerCache {
 
   // Frees old elements to keep the cache size below `max_cache_size_bytes_`.
   // `new_element_size_bytes` is the size of the new element being inserted.
+  // Freed elements are spilled to `spill_tier_`, if any.
   void FreeSpace(size_t new_element_size_bytes);
 
   // Records the cache hit rate and cache size.
@@ -165,6 +202,10 @@ class CrossTrainerCache {
   // return this status.
   Status status_ TF_GUARDED_BY(mu_) = absl::OkStatus();
 
+  // Holds elements evicted from `cache_`. Shared with readers which read
+  // spilled elements without holding `mu_`. Reset if spilling fails.
+  std::shared_ptr<CacheSpillTier<ElementType>> spill_tier_ TF_GUARDED_BY(mu_);
+
   // `cache_` stores the cached elements.
   std::deque<std::shared_ptr<const ElementType>> cache_ TF_GUARDED_BY(mu_);
   size_t cache_size_bytes_ TF_GUARDED_BY(mu_) = 0;
@@ -183,9 +224,11 @@ class CrossTrainerCache {
 template <class ElementType>
 CrossTrainerCache<ElementType>::CrossTrainerCache(
     size_t max_cache_size_bytes,
-    std::unique_ptr<CachableSequence<ElementType>> cachable_sequence)
+    std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+    std::unique_ptr<CacheSpillTier<ElementType>> spill_tier)
     : max_cache_size_bytes_(max_cache_size_bytes),
-      cachable_sequence_(std::move(cachable_sequence)) {
+      cachable_sequence_(std::move(cachable_sequence)),
+      spill_tier_(std::move(spill_tier)) {
   DCHECK_GT(max_cache_size_bytes, 0)
       << "CrossTrainerCache size must be greater than 0.";
   VLOG(2) << "Initialized tf.data service cross-trainer cache with "
@@ -212,10 +255,15 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
     const std::string& trainer_id) {
   bool should_extend_cache = false;
   while (true) {
+    std::shared_ptr<CacheSpillTier<ElementType>> spill_tier;
+    size_t spilled_index = 0;
     {
       mutex_lock l(mu_);
       TF_RETURN_IF_ERROR(status_);
-      if (IsElementReady(trainer_id)) {
+      if (IsElementSpilled(trainer_id)) {
+        spill_tier = spill_tier_;
+        spilled_index = trainer_to_element_index_map_[trainer_id]++;
+      } else if (IsElementReady(trainer_id)) {
         TF_ASSIGN_OR_RETURN(std::shared_ptr<const ElementType> element,
                             GetElement(trainer_id));
         return CacheQueryResult{element,
@@ -225,7 +273,7 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
       // Extends the cache or waits for another thread to extend the cache. When
       // concurrent trainers wait for the next element, only one of them should
       // extend the cache.
-      if (extending_cache_) {
+      } else if (extending_cache_) {
         should_extend_cache = false;
         cv_.wait(l);
       } else {
@@ -234,6 +282,19 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
       }
     }
 
+    if (spill_tier) {
+      // Reads from the spill tier without blocking other trainers.
+      StatusOr<ElementType> element = spill_tier->Read(spilled_index);
+      if (absl::IsNotFound(element.status())) {
+        // The tier dropped the element. Moves on to the next one.
+        continue;
+      }
+      TF_RETURN_IF_ERROR(element.status());
+      return CacheQueryResult{
+          std::make_shared<const ElementType>(std::move(element).value()),
+          /*is_cache_hit=*/true};
+    }
+
     if (should_extend_cache) {
       Status s = ExtendCache();
       mutex_lock l(mu_);
@@ -244,6 +305,23 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
   }
 }
 
+template <class ElementType>
+bool CrossTrainerCache<ElementType>::IsElementSpilled(
+    const std::string& trainer_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (spill_tier_ == nullptr) {
+    return false;
+  }
+  size_t& element_index = trainer_to_element_index_map_[trainer_id];
+  size_t spill_start_index = spill_tier_->StartIndex();
+  if (element_index >= cache_start_index_ ||
+      spill_start_index >= cache_start_index_) {
+    return false;
+  }
+  // Trainers behind the spill tier resume from its oldest element.
+  element_index = std::max(element_index, spill_start_index);
+  return true;
+}
+
 template <class ElementType>
 bool CrossTrainerCache<ElementType>::IsElementReady(
     const std::string& trainer_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -305,6 +383,15 @@ void CrossTrainerCache<ElementType>::FreeSpace(size_t new_element_size_bytes)
          cache_size_bytes_ + new_element_size_bytes > max_cache_size_bytes_) {
     size_t free_bytes =
         cachable_sequence_->GetElementSizeBytes(*cache_.front());
+    if (spill_tier_ != nullptr) {
+      Status s = spill_tier_->Spill(cache_start_index_, *cache_.front());
+      if (!s.ok()) {
+        // Spilled elements must be consecutive, so spilling stops here.
+        LOG(WARNING) << "Failed to spill tf.data service cross-trainer cache "
+                     << "element; disabling spilling: " << s;
+        spill_tier_.reset();
+      }
+    }
     cache_.pop_front();
     cache_size_bytes_ -= free_bytes;
     ++cache_start_index_;
@@ -15,6 +15,8 @@ limitations under the License.
 #include "tensorflow/core/data/service/cross_trainer_cache.h"
 
 #include <cstdint>
+#include <deque>
+#include <limits>
 #include <memory>
 #include <string>
 #include <utility>
@@ -121,6 +123,46 @@ size_t ElementOrErrorDataset<Tensor>::GetElementSizeBytes(
   return element.TotalBytes();
 }
 
+// Spill tier which keeps the last `max_elements` spilled elements in memory.
+class BoundedSpillTier : public CacheSpillTier<int64_t> {
+ public:
+  explicit BoundedSpillTier(size_t max_elements)
+      : max_elements_(max_elements) {}
+
+  Status Spill(size_t index, const int64_t& element) override {
+    mutex_lock l(mu_);
+    if (elements_.empty()) {
+      start_index_ = index;
+    }
+    elements_.push_back(element);
+    if (elements_.size() > max_elements_) {
+      elements_.pop_front();
+      ++start_index_;
+    }
+    return absl::OkStatus();
+  }
+
+  StatusOr<int64_t> Read(size_t index) override {
+    mutex_lock l(mu_);
+    if (index < start_index_ || index >= start_index_ + elements_.size()) {
+      return errors::NotFound("Element ", index, " is not spilled.");
+    }
+    return elements_[index - start_index_];
+  }
+
+  size_t StartIndex() const override {
+    mutex_lock l(mu_);
+    return elements_.empty() ? std::numeric_limits<size_t>::max()
+                             : start_index_;
+  }
+
+ private:
+  const size_t max_elements_;
+  mutable mutex mu_;
+  std::deque<int64_t> elements_ TF_GUARDED_BY(mu_);
+  size_t start_index_ TF_GUARDED_BY(mu_) = 0;
+};
+
 std::vector<int64_t> GetRange(const size_t range) {
   std::vector<int64_t> result;
   for (int64_t i = 0; i < range; ++i) {
@@ -205,6 +247,43 @@ TEST(CrossTrainerCacheTest, NewTrainersStartLate) {
   }
 }
 
+TEST(CrossTrainerCacheTest, SlowTrainersReadSpilledData) {
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<InfiniteRange>(),
+      std::make_unique<BoundedSpillTier>(/*max_elements=*/100));
+  EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(0)));
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(0)));
+  for (int i = 1; i < 50; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+
+  // The slow trainer reads evicted elements from the spill tier.
+  for (int i = 1; i < 60; ++i) {
+    EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(i)));
+  }
+  for (int i = 50; i < 60; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+}
+
+TEST(CrossTrainerCacheTest, SlowTrainersSkipDroppedSpilledData) {
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<InfiniteRange>(),
+      std::make_unique<BoundedSpillTier>(/*max_elements=*/10));
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(0)));
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+
+  // 95 to 99 are in memory, and 85 to 94 are spilled.
+  for (int i = 85; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(i)));
+  }
+  EXPECT_THAT(cache.Get("New trainer"), IsOkAndHolds(Pointee(85)));
+}
+
 TEST(CrossTrainerCacheTest, AlternateTrainerExtendsCache) {
   // The cache size is smaller than one int64_t.
   CrossTrainerCache<int64_t> cache(
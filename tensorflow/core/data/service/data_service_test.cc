@@ -101,6 +101,27 @@ TEST(DataServiceTest, RangeDataset_DynamicShard) {
   EXPECT_THAT(result, UnorderedElementsAreArray(Range(20)));
 }
 
+TEST(DataServiceTest, RangeDataset_DynamicShardBatchedSplits) {
+  TestCluster::Config config;
+  config.num_workers = 5;
+  config.worker_split_batch_size = 3;
+  TestCluster cluster(config);
+  TF_ASSERT_OK(cluster.Initialize());
+  DatasetClient<int64_t> dataset_client(cluster);
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      DatasetClient<int64_t>::WorkerResultMap worker_results,
+      dataset_client.Read(RangeDataset(20), ProcessingModeDef::DYNAMIC,
+                          TARGET_WORKERS_AUTO));
+
+  std::vector<int64_t> result;
+  for (const auto& worker_result : worker_results) {
+    result.insert(result.end(), worker_result.second.begin(),
+                  worker_result.second.end());
+  }
+  EXPECT_THAT(result, UnorderedElementsAreArray(Range(20)));
+}
+
 using DataServiceTest_DataShard =
     ::testing::TestWithParam<ProcessingModeDef::ShardingPolicy>;
 
@@ -152,6 +152,38 @@ Status DataServiceDispatcherClient::GetSplit(int64_t iteration_id,
   return absl::OkStatus();
 }
 
+Status DataServiceDispatcherClient::GetSplits(
+    int64_t iteration_id, int64_t repetition, int64_t split_provider_index,
+    int64_t max_splits, int64_t completed_lease_id,
+    const std::string& worker_address, std::vector<Tensor>& splits,
+    int64_t& lease_id, bool& end_of_splits) {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  GetSplitRequest req;
+  req.set_iteration_id(iteration_id);
+  req.set_repetition(repetition);
+  req.set_split_provider_index(split_provider_index);
+  req.set_max_splits(max_splits);
+  req.set_completed_lease_id(completed_lease_id);
+  req.set_worker_address(worker_address);
+  GetSplitResponse resp;
+  grpc::ClientContext client_ctx;
+  grpc::Status status = stub_->GetSplit(&client_ctx, req, &resp);
+  if (!status.ok()) {
+    return grpc_util::WrapError("Failed to get splits", status);
+  }
+  splits.clear();
+  splits.reserve(resp.splits_size());
+  for (const TensorProto& split_proto : resp.splits()) {
+    splits.emplace_back();
+    if (!splits.back().FromProto(split_proto)) {
+      return errors::Internal("Failed to parse split tensor proto");
+    }
+  }
+  lease_id = resp.lease_id();
+  end_of_splits = resp.end_of_splits();
+  return absl::OkStatus();
+}
+
 Status DataServiceDispatcherClient::Snapshot(
     const DatasetDef& dataset, const std::string& path,
     const experimental::DistributedSnapshotMetadata& metadata) {
@@ -335,6 +367,19 @@ Status DataServiceDispatcherClient::GetWorkers(
   return absl::OkStatus();
 }
 
+Status DataServiceDispatcherClient::GetAutoScalingRecommendation(
+    GetAutoScalingRecommendationResponse& recommendation) {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  GetAutoScalingRecommendationRequest req;
+  grpc::ClientContext ctx;
+  grpc::Status s = stub_->GetAutoScalingRecommendation(&ctx, req,
+                                                       &recommendation);
+  if (!s.ok()) {
+    return grpc_util::WrapError("Failed to get autoscaling recommendation", s);
+  }
+  return absl::OkStatus();
+}
+
 Status DataServiceDispatcherClient::GetDataServiceMetadata(
     const std::string& dataset_id, DataServiceMetadata& metadata) {
   TF_RETURN_IF_ERROR(EnsureInitialized());
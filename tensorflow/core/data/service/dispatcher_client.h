@@ -67,6 +67,18 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
                   int64_t split_provider_index, Tensor& split,
                   bool& end_of_splits);
 
+  // Leases up to `max_splits` splits for the specified iteration id,
+  // repetition, and split provider index on behalf of the worker at
+  // `worker_address`, and reports the splits of `completed_lease_id` as
+  // consumed. If `end_of_splits` returns true, the split provider reached its
+  // end after the returned `splits`.
+  Status GetSplits(int64_t iteration_id, int64_t repetition,
+                   int64_t split_provider_index, int64_t max_splits,
+                   int64_t completed_lease_id,
+                   const std::string& worker_address,
+                   std::vector<Tensor>& splits, int64_t& lease_id,
+                   bool& end_of_splits);
+
   // Gets the next split for the specified source of a stream of the snapshot in
   // `base_path`. If `end_of_splits` returns true, then there are no more splits
   // to be processed for the specified stream source.
@@ -124,6 +136,11 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
   // stored in `workers`.
   Status GetWorkers(std::vector<WorkerInfo>& workers);
 
+  // Queries the dispatcher for its recommended number of workers and the
+  // utilization of its workers.
+  Status GetAutoScalingRecommendation(
+      GetAutoScalingRecommendationResponse& recommendation);
+
   // Returns data service metadata for the registered dataset.
   Status GetDataServiceMetadata(const std::string& dataset_id,
                                 DataServiceMetadata& metadata);
@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/data_transfer.h"
 #include "tensorflow/core/data/service/dataset_store.h"
+#include "tensorflow/core/data/service/dispatcher.pb.h"
 #include "tensorflow/core/data/service/snapshot/path_utils.h"
 #include "tensorflow/core/data/service/test_cluster.h"
 #include "tensorflow/core/data/service/test_util.h"
@@ -160,6 +161,17 @@ TEST_F(DispatcherClientTest, GetDataServiceConfig) {
   EXPECT_EQ(config.deployment_mode(), DEPLOYMENT_MODE_COLOCATED);
 }
 
+TEST_F(DispatcherClientTest, GetAutoScalingRecommendationWithoutReports) {
+  TF_ASSERT_OK(SetUpTfDataService(/*num_workers=*/2));
+  GetAutoScalingRecommendationResponse recommendation;
+  TF_ASSERT_OK(
+      dispatcher_client_->GetAutoScalingRecommendation(recommendation));
+  EXPECT_EQ(recommendation.num_serving_workers(), 2);
+  EXPECT_EQ(recommendation.recommended_num_workers(), 0);
+  EXPECT_TRUE(recommendation.iterations().empty());
+  EXPECT_TRUE(recommendation.workers().empty());
+}
+
 TEST_F(DispatcherClientTest, SnapshotSkeletonWritten) {
   TF_ASSERT_OK(SetUpTfDataService(/*num_workers=*/1));
   TF_ASSERT_OK_AND_ASSIGN(absl::flat_hash_set<std::string> paths,
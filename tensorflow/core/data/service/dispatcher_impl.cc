@@ -57,6 +57,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/utils.h"
 #include "tensorflow/core/data/service/validate_utils.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
+#include "tensorflow/core/data/service/worker_pool_controller.h"
 #include "tensorflow/core/data/snapshot_utils.h"
 #include "tensorflow/core/data/standalone.h"
 #include "tensorflow/core/data/utils.h"
@@ -104,6 +105,7 @@ constexpr absl::Duration kDefaultIterationGcCheckInterval = absl::Minutes(10);
 constexpr absl::Duration kDefaultIterationGcTimeout = absl::Minutes(5);
 constexpr absl::Duration kDefaultClientTimeout = absl::Minutes(5);
 constexpr absl::Duration kDefaultWorkerTimeout = absl::Minutes(10);
+constexpr absl::Duration kDefaultWorkerPoolScalingInterval = absl::Minutes(5);
 
 constexpr std::array<const char*, 8> kNodeNameSharingOps = {
     "HashTable",
@@ -183,6 +185,10 @@ DispatcherConfig ApplyConfigDefaults(const DispatcherConfig& config) {
     new_config.set_worker_max_concurrent_snapshots(
         kDefaultWorkerMaxConcurrentSnapshots);
   }
+  if (new_config.worker_pool_scaling_interval_ms() == 0) {
+    new_config.set_worker_pool_scaling_interval_ms(
+        absl::ToInt64Milliseconds(kDefaultWorkerPoolScalingInterval));
+  }
   return new_config;
 }
 }  // namespace
@@ -212,6 +218,18 @@ DataServiceDispatcherImpl::~DataServiceDispatcherImpl() {
 
 Status DataServiceDispatcherImpl::Start() {
   mutex_lock l(mu_);
+  if (!config_.worker_pool_controller().empty()) {
+    if (config_.job_gc_timeout_ms() < 0) {
+      return errors::InvalidArgument(
+          "worker_pool_controller is set, but the maintenance thread which "
+          "makes scaling decisions is disabled by job_gc_timeout_ms=",
+          config_.job_gc_timeout_ms());
+    }
+    TF_RETURN_IF_ERROR(WorkerPoolController::Create(
+        config_.worker_pool_controller(), config_, &worker_pool_controller_));
+    next_worker_pool_scaling_micros_ =
+        env_->NowMicros() + config_.worker_pool_scaling_interval_ms() * 1000;
+  }
   if (config_.job_gc_timeout_ms() >= 0) {
     maintenance_thread_ = absl::WrapUnique(env_->StartThread(
         {}, "maintenance-thread", [&] { MaintenanceThread(); }));
@@ -231,8 +249,9 @@ Status DataServiceDispatcherImpl::Start() {
     started_ = true;
     return absl::OkStatus();
   }
-  journal_writer_ =
-      std::make_unique<FileJournalWriter>(env_, JournalDir(config_.work_dir()));
+  journal_writer_ = std::make_unique<GroupCommitJournalWriter>(
+      std::make_unique<FileJournalWriter>(env_, JournalDir(config_.work_dir())),
+      config_.journal_group_commit_window_us());
   LOG(INFO) << "Attempting to restore dispatcher state from journal in "
             << JournalDir(config_.work_dir());
   Update update;
@@ -247,10 +266,12 @@ Status DataServiceDispatcherImpl::Start() {
     int64_t start = env_->NowMicros();
     while (!end_of_journal) {
       TF_RETURN_IF_ERROR(ApplyWithoutJournaling(update));
+      ++journal_updates_since_checkpoint_;
       TF_RETURN_IF_ERROR(reader.Read(update, end_of_journal));
     }
     absl::Duration duration = absl::Microseconds(env_->NowMicros() - start);
-    LOG(INFO) << "Restored from journal in " << duration << ".";
+    LOG(INFO) << "Restored " << journal_updates_since_checkpoint_
+              << " updates from journal in " << duration << ".";
   }
   for (const auto& iteration : state_.ListIterations()) {
     if (IsDynamicShard(iteration->job->processing_mode)) {
@@ -370,7 +391,8 @@ Status DataServiceDispatcherImpl::FindNewTasks(
   }
   for (const auto& iteration : state_.ListIterations()) {
     if (!assigned_iteration_ids.contains(iteration->iteration_id) &&
-        iteration->IsRoundRobin() && !iteration->finished) {
+        iteration->IsRoundRobin() && !iteration->finished &&
+        !draining_workers_.contains(worker_address)) {
       VLOG(1) << "Creating pending task for reconnected worker "
               << worker_address;
       TF_RETURN_IF_ERROR(CreatePendingTask(iteration, worker_address));
@@ -526,17 +548,46 @@ Status DataServiceDispatcherImpl::GetDatasetDef(
 Status DataServiceDispatcherImpl::GetSplit(const GetSplitRequest* request,
                                            GetSplitResponse* response) {
   TF_RETURN_IF_ERROR(CheckStarted());
-  int64_t iteration_id = request->iteration_id();
-  int64_t repetition = request->repetition();
-  int64_t provider_index = request->split_provider_index();
-  VLOG(3) << "Received GetSplit request for iteration " << iteration_id
-          << ", repetition " << repetition << ", split provider index "
-          << provider_index;
-  mutex_lock l(get_split_mu_);
+  VLOG(3) << "Received GetSplit request for iteration "
+          << request->iteration_id() << ", repetition "
+          << request->repetition() << ", split provider index "
+          << request->split_provider_index() << ", max splits "
+          << request->max_splits();
+  {
+    mutex_lock l(get_split_mu_);
+    TF_RETURN_IF_ERROR(ProduceSplits(*request, *response));
+  }
+  // Syncs the journal after releasing `get_split_mu_`, so that concurrent
+  // requests produce their splits while this one syncs, and are then covered
+  // by a single sync.
+  TF_RETURN_IF_ERROR(SyncJournal());
+  VLOG(3) << "Returning from GetSplit, num_splits="
+          << (response->has_split() ? 1 : response->splits_size())
+          << ", lease_id=" << response->lease_id()
+          << ", end_of_splits=" << response->end_of_splits();
+  return absl::OkStatus();
+}
+
+Status DataServiceDispatcherImpl::ProduceSplits(const GetSplitRequest& request,
+                                                GetSplitResponse& response)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(get_split_mu_) {
+  int64_t iteration_id = request.iteration_id();
+  int64_t repetition = request.repetition();
+  int64_t provider_index = request.split_provider_index();
+  const int64_t max_splits = std::max<int64_t>(request.max_splits(), 1);
   int64_t current_repetition = 0;
   SplitProvider* split_provider = nullptr;
   {
     mutex_lock l(mu_);
+    if (request.completed_lease_id() != 0) {
+      split_leases_.erase(request.completed_lease_id());
+    }
+    if (draining_workers_.contains(request.worker_address())) {
+      response.set_end_of_splits(true);
+      VLOG(3) << "Returning end_of_splits since worker "
+              << request.worker_address() << " is being drained";
+      return absl::OkStatus();
+    }
     std::shared_ptr<const Iteration> iteration;
     TF_RETURN_IF_ERROR(state_.IterationFromId(iteration_id, iteration));
     if (!iteration->distributed_epoch_state.has_value()) {
@@ -546,39 +597,132 @@ Status DataServiceDispatcherImpl::GetSplit(const GetSplitRequest* request,
     }
     current_repetition =
         iteration->distributed_epoch_state.value().repetitions[provider_index];
-    if (request->repetition() < current_repetition) {
-      response->set_end_of_splits(true);
+    if (repetition < current_repetition) {
+      response.set_end_of_splits(true);
       VLOG(3) << "Returning end_of_splits since current repetition "
               << current_repetition
               << " is greater than the requested repetition " << repetition;
       return absl::OkStatus();
     }
+    if (max_splits > 1) {
+      std::optional<SplitLease> lease =
+          TakeReissuedSplitLease(iteration_id, repetition, provider_index);
+      if (lease.has_value()) {
+        VLOG(1) << "Re-issuing " << lease->splits.size()
+                << " splits of iteration " << iteration_id
+                << " to worker " << request.worker_address();
+        AddSplitLease(*std::move(lease), request.worker_address(), response);
+        return absl::OkStatus();
+      }
+    }
     split_provider = split_providers_[iteration_id][provider_index].get();
   }
-  if (request->repetition() > current_repetition) {
+  if (repetition > current_repetition) {
     // This could happen if an iterator is repeated before reaching end of
     // input, e.g. for the longer input to `Dataset.zip`. In this case we mark
     // the previous repetitions as completed and advance to the requested
     // repetition.
     TF_RETURN_IF_ERROR(split_provider->Reset());
   }
-  Tensor split;
+  std::vector<Tensor> splits;
   bool end_of_splits = false;
-  TF_RETURN_IF_ERROR(split_provider->GetNext(&split, &end_of_splits));
-  TF_RETURN_IF_ERROR(RecordSplitProduced(iteration_id, repetition,
-                                         provider_index, end_of_splits));
-  response->set_end_of_splits(end_of_splits);
+  while (!end_of_splits && splits.size() < max_splits) {
+    Tensor split;
+    TF_RETURN_IF_ERROR(split_provider->GetNext(&split, &end_of_splits));
+    if (!end_of_splits) {
+      splits.push_back(std::move(split));
+    }
+  }
+  TF_RETURN_IF_ERROR(RecordSplitsProduced(iteration_id, repetition,
+                                          provider_index, splits.size(),
+                                          end_of_splits));
+  response.set_end_of_splits(end_of_splits);
   if (end_of_splits) {
     // Reset the split provider to prepare for the next iteration.
     TF_RETURN_IF_ERROR(split_provider->Reset());
-  } else {
-    split.AsProtoTensorContent(response->mutable_split());
   }
-  VLOG(3) << "Returning from GetSplit, split=" << split
-          << ", end_of_splits=" << end_of_splits;
+  if (request.max_splits() <= 1) {
+    if (!splits.empty()) {
+      splits[0].AsProtoTensorContent(response.mutable_split());
+    }
+    return absl::OkStatus();
+  }
+  SplitLease lease;
+  lease.iteration_id = iteration_id;
+  lease.repetition = repetition;
+  lease.split_provider_index = provider_index;
+  lease.splits.resize(splits.size());
+  for (int i = 0; i < splits.size(); ++i) {
+    splits[i].AsProtoTensorContent(&lease.splits[i]);
+  }
+  mutex_lock l(mu_);
+  // The worker does not request more splits after the last batch, so the last
+  // batch is not tracked as a lease.
+  AddSplitLease(std::move(lease),
+                end_of_splits ? std::string() : request.worker_address(),
+                response);
   return absl::OkStatus();
 }
 
+std::optional<DataServiceDispatcherImpl::SplitLease>
+DataServiceDispatcherImpl::TakeReissuedSplitLease(int64_t iteration_id,
+                                                  int64_t repetition,
+                                                  int64_t split_provider_index)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  for (auto it = reissued_split_leases_.begin();
+       it != reissued_split_leases_.end();) {
+    if (it->iteration_id != iteration_id ||
+        it->split_provider_index != split_provider_index) {
+      ++it;
+      continue;
+    }
+    if (it->repetition < repetition) {
+      // The iteration moved on to a later repetition.
+      it = reissued_split_leases_.erase(it);
+      continue;
+    }
+    if (it->repetition > repetition) {
+      ++it;
+      continue;
+    }
+    SplitLease lease = std::move(*it);
+    reissued_split_leases_.erase(it);
+    return lease;
+  }
+  return std::nullopt;
+}
+
+void DataServiceDispatcherImpl::AddSplitLease(SplitLease lease,
+                                              const std::string& worker_address,
+                                              GetSplitResponse& response)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  for (const TensorProto& split : lease.splits) {
+    *response.add_splits() = split;
+  }
+  if (worker_address.empty() || lease.splits.empty()) {
+    return;
+  }
+  const int64_t lease_id = next_split_lease_id_++;
+  response.set_lease_id(lease_id);
+  lease.worker_address = worker_address;
+  split_leases_[lease_id] = std::move(lease);
+}
+
+void DataServiceDispatcherImpl::ReissueSplitLeases(
+    const std::string& worker_address) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  for (auto it = split_leases_.begin(); it != split_leases_.end();) {
+    if (it->second.worker_address != worker_address) {
+      ++it;
+      continue;
+    }
+    LOG(INFO) << "Re-issuing " << it->second.splits.size()
+              << " splits of iteration " << it->second.iteration_id
+              << " leased by lost worker " << worker_address;
+    reissued_split_leases_.push_back(std::move(it->second));
+    split_leases_.erase(it++);
+  }
+}
+
 Status DataServiceDispatcherImpl::MakeSplitProviders(
     const std::string& dataset_id,
     std::vector<std::unique_ptr<SplitProvider>>& split_providers)
@@ -939,6 +1083,10 @@ Status DataServiceDispatcherImpl::CreateTasksForIteration(
   tasks.clear();
   tasks.reserve(workers.size());
   for (const auto& worker : workers) {
+    if (draining_workers_.contains(worker->address) &&
+        !IsStaticShard(iteration->job->processing_mode)) {
+      continue;
+    }
     std::shared_ptr<const Task> task;
     TF_RETURN_IF_ERROR(CreateTask(iteration, worker->address, task));
     tasks.push_back(task);
@@ -1155,6 +1303,7 @@ Status DataServiceDispatcherImpl::ClientHeartbeat(
     task_info->set_iteration_id(iteration->iteration_id);
     task_info->set_worker_uid(task->worker_uid);
     task_info->set_starting_round(task->starting_round);
+    task_info->set_draining(draining_workers_.contains(task->worker_address));
   }
   response->set_iteration_finished(iteration->finished);
   response->set_deployment_mode(config_.deployment_mode());
@@ -1179,6 +1328,48 @@ Status DataServiceDispatcherImpl::GetWorkers(const GetWorkersRequest* request,
   return absl::OkStatus();
 }
 
+Status DataServiceDispatcherImpl::GetAutoScalingRecommendation(
+    const GetAutoScalingRecommendationRequest* request,
+    GetAutoScalingRecommendationResponse* response) {
+  TF_RETURN_IF_ERROR(CheckStarted());
+  mutex_lock l(mu_);
+  int64_t num_serving_workers = 0;
+  for (const auto& [worker_address, heartbeat_time] :
+       latest_worker_heartbeats_time_) {
+    if (!draining_workers_.contains(worker_address)) {
+      ++num_serving_workers;
+    }
+  }
+  response->set_num_serving_workers(num_serving_workers);
+  absl::StatusOr<int64_t> recommended_num_workers =
+      auto_scaler_.GetBoundOptimalNumberOfWorkers(
+          std::max<int64_t>(num_serving_workers, 1));
+  if (recommended_num_workers.ok()) {
+    response->set_recommended_num_workers(*recommended_num_workers);
+  }
+  for (const auto& [iteration_id, num_workers] :
+       auto_scaler_.GetOptimalNumberOfWorkersByIteration()) {
+    std::shared_ptr<const Iteration> iteration;
+    if (!state_.IterationFromId(iteration_id, iteration).ok()) {
+      continue;
+    }
+    IterationAutoScalingRecommendation* recommendation =
+        response->add_iterations();
+    recommendation->set_job_id(iteration->job->id);
+    recommendation->set_job_name(iteration->job->job_name);
+    recommendation->set_iteration_id(iteration_id);
+    recommendation->set_recommended_num_workers(num_workers);
+  }
+  for (const auto& [worker_address, utilization] :
+       auto_scaler_.GetWorkerUtilizations()) {
+    WorkerUtilization* worker = response->add_workers();
+    worker->set_worker_address(worker_address);
+    worker->set_utilization(utilization);
+    worker->set_draining(draining_workers_.contains(worker_address));
+  }
+  return absl::OkStatus();
+}
+
 Status DataServiceDispatcherImpl::Snapshot(const SnapshotRequest* request,
                                            SnapshotResponse* response) {
   if (!config_.fault_tolerant_mode()) {
@@ -1351,9 +1542,9 @@ Status DataServiceDispatcherImpl::CheckStarted() TF_LOCKS_EXCLUDED(mu_) {
   return absl::OkStatus();
 }
 
-Status DataServiceDispatcherImpl::RecordSplitProduced(
+Status DataServiceDispatcherImpl::RecordSplitsProduced(
     int64_t iteration_id, int64_t repetition, int64_t split_provider_index,
-    bool finished) TF_LOCKS_EXCLUDED(mu_) {
+    int64_t num_splits, bool finished) TF_LOCKS_EXCLUDED(mu_) {
   mutex_lock l(mu_);
   Update update;
   ProduceSplitUpdate* produce_split = update.mutable_produce_split();
@@ -1361,7 +1552,24 @@ Status DataServiceDispatcherImpl::RecordSplitProduced(
   produce_split->set_repetition(repetition);
   produce_split->set_split_provider_index(split_provider_index);
   produce_split->set_finished(finished);
-  return Apply(update);
+  produce_split->set_num_splits(num_splits);
+  if (journal_writer_.has_value()) {
+    TF_RETURN_IF_ERROR(journal_writer_.value()->WriteUnsynced(update));
+    ++journal_updates_since_checkpoint_;
+  }
+  return state_.Apply(update);
+}
+
+Status DataServiceDispatcherImpl::SyncJournal() TF_LOCKS_EXCLUDED(mu_) {
+  JournalWriter* journal_writer = nullptr;
+  {
+    mutex_lock l(mu_);
+    if (!journal_writer_.has_value()) {
+      return absl::OkStatus();
+    }
+    journal_writer = journal_writer_.value().get();
+  }
+  return journal_writer->Sync();
 }
 
 Status DataServiceDispatcherImpl::ApplyWithoutJournaling(const Update& update)
@@ -1373,46 +1581,108 @@ Status DataServiceDispatcherImpl::Apply(const Update& update)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   if (journal_writer_.has_value()) {
     TF_RETURN_IF_ERROR(journal_writer_.value()->Write(update));
+    ++journal_updates_since_checkpoint_;
   }
   return state_.Apply(update);
 }
 
+Status DataServiceDispatcherImpl::PrepareJournalCheckpoint(
+    std::vector<Update>& checkpoint, int64_t& sequence_number)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  sequence_number = -1;
+  // Waiting for as many updates as the last checkpoint holds bounds the
+  // journal to about twice the size of the compacted state.
+  if (!journal_writer_.has_value() ||
+      config_.journal_checkpoint_interval_updates() <= 0 ||
+      journal_updates_since_checkpoint_ <
+          std::max(config_.journal_checkpoint_interval_updates(),
+                   journal_checkpoint_size_)) {
+    return absl::OkStatus();
+  }
+  TF_ASSIGN_OR_RETURN(sequence_number,
+                      journal_writer_.value()->StartNewFile());
+  checkpoint = state_.Checkpoint();
+  journal_updates_since_checkpoint_ = 0;
+  journal_checkpoint_size_ = checkpoint.size();
+  return absl::OkStatus();
+}
+
 void DataServiceDispatcherImpl::MaintenanceThread() {
   int64_t next_check_micros = 0;
   while (true) {
-    mutex_lock l(mu_);
-    while (!cancelled_ && env_->NowMicros() < next_check_micros) {
-      int64_t remaining_micros = next_check_micros - env_->NowMicros();
-      maintenance_thread_cv_.wait_for(
-          l, std::chrono::microseconds(remaining_micros));
-    }
-    if (cancelled_) {
-      return;
-    }
+    std::vector<Update> checkpoint;
+    int64_t checkpoint_sequence_number = -1;
+    std::optional<int64_t> target_num_workers;
+    std::vector<std::string> workers_to_remove;
     {
-      Status s = ReleaseMissingClients();
+      mutex_lock l(mu_);
+      while (!cancelled_ && env_->NowMicros() < next_check_micros) {
+        int64_t remaining_micros = next_check_micros - env_->NowMicros();
+        maintenance_thread_cv_.wait_for(
+            l, std::chrono::microseconds(remaining_micros));
+      }
+      if (cancelled_) {
+        return;
+      }
+      {
+        Status s = ReleaseMissingClients();
+        if (!s.ok()) {
+          LOG(WARNING) << "Error releasing missing clients: " << s;
+        }
+      }
+      {
+        Status s = auto_scaler_.UpdateOptimalNumberOfWorkersMetric(
+            state_.GetNumberOfRegisteredWorkers());
+        if (!s.ok()) {
+          VLOG(1) << "Error updating the optimal number of workers metric "
+                     "in tf.data service AutoScaler: "
+                  << s;
+        }
+      }
+      {
+        Status s = GcOldIterations();
+        if (!s.ok()) {
+          LOG(WARNING) << "Error garbage collecting old iterations: " << s;
+        }
+      }
+      DetectMissingWorkers();
+      next_check_micros =
+          env_->NowMicros() + (config_.job_gc_check_interval_ms() * 1000);
+      if (worker_pool_controller_) {
+        ScaleWorkerPool(target_num_workers, workers_to_remove);
+        next_check_micros =
+            std::min(next_check_micros, next_worker_pool_scaling_micros_);
+      }
+      {
+        Status s = PrepareJournalCheckpoint(checkpoint,
+                                            checkpoint_sequence_number);
+        if (!s.ok()) {
+          LOG(WARNING) << "Error starting a journal checkpoint: " << s;
+        }
+      }
+    }
+    if (target_num_workers.has_value()) {
+      Status s = worker_pool_controller_->AddWorkers(*target_num_workers);
       if (!s.ok()) {
-        LOG(WARNING) << "Error releasing missing clients: " << s;
+        LOG(WARNING) << "Error adding tf.data service workers: " << s;
       }
     }
-    {
-      Status s = auto_scaler_.UpdateOptimalNumberOfWorkersMetric(
-          state_.GetNumberOfRegisteredWorkers());
+    for (const std::string& worker_address : workers_to_remove) {
+      Status s = worker_pool_controller_->RemoveWorker(worker_address);
       if (!s.ok()) {
-        VLOG(1) << "Error updating the optimal number of workers metric "
-                   "in tf.data service AutoScaler: "
-                << s;
+        LOG(WARNING) << "Error removing tf.data service worker "
+                     << worker_address << ": " << s;
       }
     }
-    {
-      Status s = GcOldIterations();
+    // The checkpoint holds the state preceding the current journal file, so it
+    // is written without blocking further updates.
+    if (checkpoint_sequence_number >= 0) {
+      Status s = WriteJournalCheckpoint(env_, JournalDir(config_.work_dir()),
+                                        checkpoint_sequence_number, checkpoint);
       if (!s.ok()) {
-        LOG(WARNING) << "Error garbage collecting old iterations: " << s;
+        LOG(WARNING) << "Error writing journal checkpoint: " << s;
       }
     }
-    DetectMissingWorkers();
-    next_check_micros =
-        env_->NowMicros() + (config_.job_gc_check_interval_ms() * 1000);
   }
 }
 
@@ -1486,6 +1756,7 @@ void DataServiceDispatcherImpl::DetectMissingWorkers()
         it->second + absl::Milliseconds(config_.worker_timeout_ms())) {
       LOG(INFO) << "Lost worker " << it->first << " due to timeout";
       RemoveWorkerFromAutoScaler(it->first);
+      ReissueSplitLeases(it->first);
 
       latest_worker_heartbeats_time_.erase(it++);
     } else {
@@ -1494,6 +1765,126 @@ void DataServiceDispatcherImpl::DetectMissingWorkers()
   }
 }
 
+void DataServiceDispatcherImpl::ScaleWorkerPool(
+    std::optional<int64_t>& target_num_workers,
+    std::vector<std::string>& workers_to_remove)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  for (auto it = draining_workers_.begin(); it != draining_workers_.end();) {
+    if (IsWorkerDrained(*it)) {
+      LOG(INFO) << "Finished draining tf.data service worker " << *it;
+      workers_to_remove.push_back(*it);
+      draining_workers_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+
+  int64_t now_micros = env_->NowMicros();
+  if (now_micros < next_worker_pool_scaling_micros_) {
+    return;
+  }
+  next_worker_pool_scaling_micros_ =
+      now_micros + config_.worker_pool_scaling_interval_ms() * 1000;
+  std::vector<std::string> serving_workers;
+  for (const auto& [worker_address, heartbeat_time] :
+       latest_worker_heartbeats_time_) {
+    if (!draining_workers_.contains(worker_address)) {
+      serving_workers.push_back(worker_address);
+    }
+  }
+  if (serving_workers.empty()) {
+    return;
+  }
+  const int64_t num_serving_workers = serving_workers.size();
+  absl::StatusOr<int64_t> recommended_num_workers =
+      auto_scaler_.GetBoundOptimalNumberOfWorkers(num_serving_workers);
+  if (!recommended_num_workers.ok()) {
+    VLOG(1) << "Not scaling the tf.data service worker pool: "
+            << recommended_num_workers.status();
+    return;
+  }
+  if (*recommended_num_workers > num_serving_workers) {
+    LOG(INFO) << "Scaling the tf.data service worker pool from "
+              << num_serving_workers << " to " << *recommended_num_workers
+              << " workers";
+    target_num_workers = *recommended_num_workers;
+    return;
+  }
+  if (*recommended_num_workers == num_serving_workers) {
+    return;
+  }
+
+  std::vector<std::string> candidates;
+  for (const std::string& worker_address : serving_workers) {
+    if (CanDrainWorker(worker_address)) {
+      candidates.push_back(worker_address);
+    }
+  }
+  for (const std::string& worker_address :
+       SelectWorkersToDrain(candidates, auto_scaler_.GetWorkerUtilizations(),
+                            num_serving_workers - *recommended_num_workers)) {
+    Status s = StartDrainingWorker(worker_address);
+    if (!s.ok()) {
+      LOG(WARNING) << "Error draining tf.data service worker "
+                   << worker_address << ": " << s;
+    }
+  }
+}
+
+bool DataServiceDispatcherImpl::CanDrainWorker(
+    const std::string& worker_address) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  std::vector<std::shared_ptr<const Task>> tasks;
+  if (!state_.TasksForWorker(worker_address, tasks).ok()) {
+    return false;
+  }
+  for (const auto& task : tasks) {
+    if (!task->finished &&
+        IsStaticShard(task->iteration->job->processing_mode)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Status DataServiceDispatcherImpl::StartDrainingWorker(
+    const std::string& worker_address) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  LOG(INFO) << "Draining tf.data service worker " << worker_address;
+  draining_workers_.insert(worker_address);
+  RemoveWorkerFromAutoScaler(worker_address);
+  std::vector<std::shared_ptr<const Task>> tasks;
+  TF_RETURN_IF_ERROR(state_.TasksForWorker(worker_address, tasks));
+  for (const auto& task : tasks) {
+    const ProcessingModeDef& processing_mode =
+        task->iteration->job->processing_mode;
+    if (task->finished || task->iteration->IsRoundRobin() ||
+        IsDynamicShard(processing_mode) || IsStaticShard(processing_mode)) {
+      continue;
+    }
+    Update update;
+    update.mutable_remove_task()->set_task_id(task->task_id);
+    TF_RETURN_IF_ERROR(Apply(update));
+  }
+  return absl::OkStatus();
+}
+
+bool DataServiceDispatcherImpl::IsWorkerDrained(
+    const std::string& worker_address) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (!latest_worker_heartbeats_time_.contains(worker_address)) {
+    // The worker is lost, so there is nothing left to wait for.
+    return true;
+  }
+  std::vector<std::shared_ptr<const Task>> tasks;
+  if (!state_.TasksForWorker(worker_address, tasks).ok()) {
+    return true;
+  }
+  for (const auto& task : tasks) {
+    if (!task->finished) {
+      return false;
+    }
+  }
+  return true;
+}
+
 Status DataServiceDispatcherImpl::GcOldIterations()
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   std::vector<std::shared_ptr<const Iteration>> iterations =
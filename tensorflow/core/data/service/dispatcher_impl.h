@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DATA_SERVICE_DISPATCHER_IMPL_H_
 
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <optional>
 #include <string>
@@ -35,7 +36,9 @@ limitations under the License.
 #include "tensorflow/core/data/service/snapshot/snapshot_manager.h"
 #include "tensorflow/core/data/service/task_remover.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
+#include "tensorflow/core/data/service/worker_pool_controller.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -131,6 +134,25 @@ namespace data {
 // 7. Consumer 1 heartbeats. Dispatcher sends consumer 1 the task list
 //    containing the new task, and tells it that it no longer needs to block.
 //
+// **Removing workers**
+//
+// When configured with a `WorkerPoolController`, the dispatcher drains workers
+// it no longer needs before asking the controller to remove them. A draining
+// worker does not get new tasks, and its existing tasks are wound down
+// according to their iteration:
+//
+// - Dynamic sharding: the worker gets no more splits, so its tasks finish
+//   once they have processed the splits they already have.
+// - No sharding: the tasks are removed right away, since their elements are
+//   interchangeable with those of other tasks.
+// - Round-robin reads: consumer heartbeats mark the tasks as draining, and
+//   consumers remove them through `MaybeRemoveTask`, so that all consumers
+//   agree on the round in which they stop reading from them.
+//
+// Workers with tasks of statically sharded iterations are never drained, since
+// their shards cannot be moved to other workers. Snapshot streams assigned
+// to a drained worker are not moved before it is removed.
+//
 class DataServiceDispatcherImpl {
  public:
   explicit DataServiceDispatcherImpl(
@@ -180,6 +202,9 @@ class DataServiceDispatcherImpl {
                          ClientHeartbeatResponse* response);
   Status GetWorkers(const GetWorkersRequest* request,
                     GetWorkersResponse* response);
+  Status GetAutoScalingRecommendation(
+      const GetAutoScalingRecommendationRequest* request,
+      GetAutoScalingRecommendationResponse* response);
   Status Snapshot(const SnapshotRequest* request, SnapshotResponse* response);
   Status GetSnapshotSplit(const GetSnapshotSplitRequest* request,
                           GetSnapshotSplitResponse* response);
@@ -310,10 +335,47 @@ class DataServiceDispatcherImpl {
   Status CheckStarted() TF_LOCKS_EXCLUDED(mu_);
   // Restores ongoing tf.data snapshots.
   absl::Status RestoreSnapshots();
-  // Records that a split was produced by a call to `GetSplit`.
-  Status RecordSplitProduced(int64_t iteration_id, int64_t repetition,
-                             int64_t split_provider_index, bool finished)
-      TF_LOCKS_EXCLUDED(mu_);
+  // Splits leased to a worker by a `GetSplit` request with `max_splits > 1`.
+  struct SplitLease {
+    int64_t iteration_id = 0;
+    int64_t repetition = 0;
+    int64_t split_provider_index = 0;
+    std::string worker_address;
+    std::vector<TensorProto> splits;
+  };
+
+  // Produces the splits for a `GetSplit` request.
+  Status ProduceSplits(const GetSplitRequest& request,
+                       GetSplitResponse& response)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(get_split_mu_) TF_LOCKS_EXCLUDED(mu_);
+  // Records that `num_splits` splits were produced by a call to `GetSplit`.
+  // The update is journaled without syncing; call `SyncJournal` before
+  // returning the splits.
+  Status RecordSplitsProduced(int64_t iteration_id, int64_t repetition,
+                              int64_t split_provider_index, int64_t num_splits,
+                              bool finished) TF_LOCKS_EXCLUDED(mu_);
+  // Makes the journaled updates durable.
+  Status SyncJournal() TF_LOCKS_EXCLUDED(mu_);
+  // Returns a lease of a lost worker for the given split provider, if any.
+  std::optional<SplitLease> TakeReissuedSplitLease(int64_t iteration_id,
+                                                   int64_t repetition,
+                                                   int64_t split_provider_index)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Adds the splits of `lease` to `response`, and tracks the lease unless
+  // `worker_address` is empty.
+  void AddSplitLease(SplitLease lease, const std::string& worker_address,
+                     GetSplitResponse& response)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Queues the leases of the lost worker at `worker_address` to be re-issued
+  // to other workers.
+  void ReissueSplitLeases(const std::string& worker_address)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // If enough updates were journaled since the last checkpoint, starts a new
+  // journal file and stores the state preceding it in `checkpoint`. Sets
+  // `sequence_number` to the new file, or to -1 if no checkpoint is due.
+  Status PrepareJournalCheckpoint(std::vector<Update>& checkpoint,
+                                  int64_t& sequence_number)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Applies a state update, updating both the journal and the in-memory state.
   Status Apply(const Update& update) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Applies a state update, but doesn't update the journal. Only meant to be
@@ -332,6 +394,24 @@ class DataServiceDispatcherImpl {
   // Checks for workers that haven't heartbeated recently and alerts the
   // snapshot managers.
   void DetectMissingWorkers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Decides how to resize the worker pool, if a scaling decision is due.
+  // Starts draining workers that are no longer needed. Sets
+  // `target_num_workers` if more workers are needed, and adds the drained
+  // workers to `workers_to_remove`. The caller passes those decisions on to
+  // `worker_pool_controller_` after releasing `mu_`.
+  void ScaleWorkerPool(std::optional<int64_t>& target_num_workers,
+                       std::vector<std::string>& workers_to_remove)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns whether the worker at `worker_address` may be drained.
+  bool CanDrainWorker(const std::string& worker_address)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Stops assigning work to the worker at `worker_address`, and removes its
+  // tasks which don't need to be wound down.
+  Status StartDrainingWorker(const std::string& worker_address)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns whether the worker at `worker_address` has no unfinished tasks.
+  bool IsWorkerDrained(const std::string& worker_address)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Scans for old iterations and marks them as finished.
   Status GcOldIterations() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Returns true if an iteration should be garbage collected.
@@ -379,6 +459,22 @@ class DataServiceDispatcherImpl {
   // Map from worker address to the time of the worker's last heartbeat.
   absl::flat_hash_map<std::string, absl::Time> latest_worker_heartbeats_time_
       TF_GUARDED_BY(mu_);
+  // Outstanding split leases, keyed by lease id. Leases are not journaled: the
+  // splits of leases outstanding when the dispatcher restarts are not
+  // re-issued.
+  absl::flat_hash_map<int64_t, SplitLease> split_leases_ TF_GUARDED_BY(mu_);
+  // Leases of lost workers, to be handed to the next workers requesting splits
+  // from the same split providers.
+  std::deque<SplitLease> reissued_split_leases_ TF_GUARDED_BY(mu_);
+  int64_t next_split_lease_id_ TF_GUARDED_BY(mu_) = 1;
+
+  // Resizes the worker pool. Set in `Start` if configured, and only used by the
+  // maintenance thread afterwards.
+  std::unique_ptr<WorkerPoolController> worker_pool_controller_;
+  // Addresses of the workers being drained. Draining is not journaled: after a
+  // restart, the dispatcher makes new scaling decisions.
+  absl::flat_hash_set<std::string> draining_workers_ TF_GUARDED_BY(mu_);
+  int64_t next_worker_pool_scaling_micros_ TF_GUARDED_BY(mu_) = 0;
 
   // TODO(mpcallanan): Don't recover completed snapshots.
   // TODO(mpcallanan): Garbage collect completed snapshots.
@@ -391,6 +487,10 @@ class DataServiceDispatcherImpl {
 
   std::optional<std::unique_ptr<JournalWriter>> journal_writer_
       TF_GUARDED_BY(mu_);
+  // Number of updates journaled since the last checkpoint.
+  int64_t journal_updates_since_checkpoint_ TF_GUARDED_BY(mu_) = 0;
+  // Number of updates in the last checkpoint.
+  int64_t journal_checkpoint_size_ TF_GUARDED_BY(mu_) = 0;
   DispatcherState state_ TF_GUARDED_BY(mu_);
   // Condition variable for waking up the gc thread.
   condition_variable maintenance_thread_cv_;
@@ -17,10 +17,12 @@ limitations under the License.
 #include <algorithm>
 #include <memory>
 #include <optional>
+#include <queue>
 #include <string>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/data/service/common.h"
@@ -33,6 +35,34 @@ limitations under the License.
 
 namespace tensorflow {
 namespace data {
+namespace {
+
+// Sets the task fields of a `CreateTaskUpdate` or `CreatePendingTaskUpdate`.
+template <class T>
+void SetTaskFields(const DispatcherState::Task& task, T& update) {
+  update.set_task_id(task.task_id);
+  update.set_iteration_id(task.iteration->iteration_id);
+  update.set_worker_address(task.worker_address);
+  for (const DataTransferServerInfo& transfer_server : task.transfer_servers) {
+    *update.add_transfer_servers() = transfer_server;
+  }
+  for (const std::string& worker_tag : task.worker_tags) {
+    update.add_worker_tags(worker_tag);
+  }
+  update.set_worker_uid(task.worker_uid);
+}
+
+template <class K, class V>
+std::vector<K> SortedKeys(const absl::flat_hash_map<K, V>& map) {
+  std::vector<K> keys;
+  keys.reserve(map.size());
+  for (const auto& [key, value] : map) {
+    keys.push_back(key);
+  }
+  std::sort(keys.begin(), keys.end());
+  return keys;
+}
+}  // namespace
 
 DispatcherState::DispatcherState()
     : worker_index_resolver_(std::vector<std::string>{}) {}
@@ -88,6 +118,9 @@ Status DispatcherState::Apply(const Update& update) {
     case Update::kCompressionDisabledAtRuntime:
       CompressionDisabledAtRuntime(update.compression_disabled_at_runtime());
       break;
+    case Update::kCheckpoint:
+      RestoreCheckpoint(update.checkpoint());
+      break;
     case Update::UPDATE_TYPE_NOT_SET:
       return errors::Internal("Update type not set.");
   }
@@ -95,6 +128,167 @@ Status DispatcherState::Apply(const Update& update) {
   return absl::OkStatus();
 }
 
+std::vector<Update> DispatcherState::Checkpoint() const {
+  std::vector<Update> updates;
+  for (const std::string& dataset_id : SortedKeys(datasets_by_id_)) {
+    RegisterDatasetUpdate* register_dataset =
+        updates.emplace_back().mutable_register_dataset();
+    register_dataset->set_dataset_id(dataset_id);
+    *register_dataset->mutable_metadata() =
+        datasets_by_id_.at(dataset_id)->metadata;
+  }
+  for (const std::string& dataset_id :
+       SortedKeys(compression_disabled_at_runtime_)) {
+    CompressionDisabledAtRuntimeUpdate* compression_disabled =
+        updates.emplace_back().mutable_compression_disabled_at_runtime();
+    compression_disabled->set_dataset_id(dataset_id);
+    compression_disabled->set_compression_disabled(
+        compression_disabled_at_runtime_.at(dataset_id));
+  }
+  std::vector<std::string> snapshot_paths(snapshot_paths_.begin(),
+                                          snapshot_paths_.end());
+  std::sort(snapshot_paths.begin(), snapshot_paths.end());
+  for (const std::string& path : snapshot_paths) {
+    updates.emplace_back().mutable_snapshot()->set_path(path);
+  }
+  // Workers come before tasks, since registering a worker resets its tasks.
+  for (const std::string& address : SortedKeys(workers_)) {
+    const Worker& worker = *workers_.at(address);
+    RegisterWorkerUpdate* register_worker =
+        updates.emplace_back().mutable_register_worker();
+    register_worker->set_worker_address(worker.address);
+    for (const DataTransferServerInfo& transfer_server :
+         worker.transfer_servers) {
+      *register_worker->add_transfer_servers() = transfer_server;
+    }
+    for (const std::string& worker_tag : worker.tags) {
+      register_worker->add_worker_tags(worker_tag);
+    }
+    register_worker->set_worker_uid(worker.uid);
+  }
+  for (int64_t job_id : SortedKeys(jobs_by_id_)) {
+    const Job& job = *jobs_by_id_.at(job_id);
+    CreateJobUpdate* create_job = updates.emplace_back().mutable_create_job();
+    create_job->set_job_id(job.id);
+    create_job->set_job_name(job.job_name);
+    create_job->set_dataset_id(job.dataset_id);
+    *create_job->mutable_processing_mode_def() = job.processing_mode;
+    if (job.num_consumers.has_value()) {
+      create_job->set_num_consumers(job.num_consumers.value());
+    }
+    create_job->set_target_workers(job.target_workers);
+    create_job->set_use_cross_trainer_cache(job.use_cross_trainer_cache);
+  }
+
+  CheckpointUpdate checkpoint;
+  checkpoint.set_next_available_job_id(next_available_job_id_);
+  checkpoint.set_next_available_iteration_id(next_available_iteration_id_);
+  checkpoint.set_next_available_iteration_client_id(
+      next_available_iteration_client_id_);
+  checkpoint.set_next_available_task_id(next_available_task_id_);
+  // Iterations are recreated in id order, so that a garbage collected
+  // iteration is replaced by the newer iteration with the same key.
+  for (int64_t iteration_id : SortedKeys(iterations_)) {
+    const Iteration& iteration = *iterations_.at(iteration_id);
+    CreateIterationUpdate* create_iteration =
+        updates.emplace_back().mutable_create_iteration();
+    create_iteration->set_iteration_id(iteration_id);
+    create_iteration->set_job_id(iteration.job->id);
+    create_iteration->set_repetition(iteration.iteration_key.repetition);
+    if (iteration.distributed_epoch_state.has_value()) {
+      const DistributedEpochState& state =
+          iteration.distributed_epoch_state.value();
+      create_iteration->set_num_split_providers(state.repetitions.size());
+      for (int64_t i = 0; i < state.repetitions.size(); ++i) {
+        if (state.repetitions[i] > 0) {
+          ProduceSplitUpdate* produce_split =
+              updates.emplace_back().mutable_produce_split();
+          produce_split->set_iteration_id(iteration_id);
+          produce_split->set_repetition(state.repetitions[i] - 1);
+          produce_split->set_split_provider_index(i);
+          produce_split->set_finished(true);
+        }
+        if (state.indices[i] > 0) {
+          ProduceSplitUpdate* produce_split =
+              updates.emplace_back().mutable_produce_split();
+          produce_split->set_iteration_id(iteration_id);
+          produce_split->set_repetition(state.repetitions[i]);
+          produce_split->set_split_provider_index(i);
+          produce_split->set_num_splits(state.indices[i]);
+        }
+      }
+    }
+    if (iteration.last_client_released_micros >= 0) {
+      CheckpointUpdate::IterationState* iteration_state =
+          checkpoint.add_iterations();
+      iteration_state->set_iteration_id(iteration_id);
+      iteration_state->set_last_client_released_micros(
+          iteration.last_client_released_micros);
+    }
+
+    const std::vector<std::shared_ptr<Task>>& tasks =
+        tasks_by_iteration_.at(iteration_id);
+    for (const auto& task : tasks) {
+      SetTaskFields(*task, *updates.emplace_back().mutable_create_task());
+      if (task->starting_round != 0) {
+        CheckpointUpdate::TaskState* task_state = checkpoint.add_tasks();
+        task_state->set_task_id(task->task_id);
+        task_state->set_starting_round(task->starting_round);
+      }
+    }
+    std::queue<PendingTask> pending_tasks = iteration.pending_tasks;
+    for (; !pending_tasks.empty(); pending_tasks.pop()) {
+      const PendingTask& pending_task = pending_tasks.front();
+      if (pending_task.task->removed) {
+        continue;
+      }
+      CreatePendingTaskUpdate* create_pending_task =
+          updates.emplace_back().mutable_create_pending_task();
+      SetTaskFields(*pending_task.task, *create_pending_task);
+      create_pending_task->set_starting_round(pending_task.target_round);
+      if (pending_task.failures > 0 || !pending_task.ready_consumers.empty()) {
+        CheckpointUpdate::PendingTaskState* pending_task_state =
+            checkpoint.add_pending_tasks();
+        pending_task_state->set_task_id(pending_task.task->task_id);
+        pending_task_state->set_failures(pending_task.failures);
+        std::vector<int64_t> ready_consumers(
+            pending_task.ready_consumers.begin(),
+            pending_task.ready_consumers.end());
+        std::sort(ready_consumers.begin(), ready_consumers.end());
+        for (int64_t ready_consumer : ready_consumers) {
+          pending_task_state->add_ready_consumers(ready_consumer);
+        }
+      }
+    }
+    if (iteration.garbage_collected) {
+      updates.emplace_back()
+          .mutable_garbage_collect_iteration()
+          ->set_iteration_id(iteration_id);
+      continue;
+    }
+    for (const auto& task : tasks) {
+      if (task->finished) {
+        updates.emplace_back().mutable_finish_task()->set_task_id(
+            task->task_id);
+      }
+    }
+  }
+  for (int64_t iteration_client_id : SortedKeys(iterations_for_client_ids_)) {
+    const std::shared_ptr<Iteration>& iteration =
+        iterations_for_client_ids_.at(iteration_client_id);
+    // `IterationForIterationClientId` may leave entries for unknown ids.
+    if (!iteration) {
+      continue;
+    }
+    AcquireIterationClientUpdate* acquire_iteration_client =
+        updates.emplace_back().mutable_acquire_iteration_client();
+    acquire_iteration_client->set_iteration_id(iteration->iteration_id);
+    acquire_iteration_client->set_iteration_client_id(iteration_client_id);
+  }
+  *updates.emplace_back().mutable_checkpoint() = std::move(checkpoint);
+  return updates;
+}
+
 void DispatcherState::RegisterDataset(
     const RegisterDatasetUpdate& register_dataset) {
   std::string dataset_id = register_dataset.dataset_id();
@@ -187,7 +381,8 @@ void DispatcherState::ProduceSplit(const ProduceSplitUpdate& produce_split) {
     state.indices[provider_index] = 0;
     return;
   }
-  state.indices[provider_index]++;
+  state.indices[provider_index] +=
+      std::max<int64_t>(produce_split.num_splits(), 1);
 }
 
 void DispatcherState::AcquireIterationClient(
@@ -484,6 +679,54 @@ void DispatcherState::CompressionDisabledAtRuntime(
   });
 }
 
+void DispatcherState::RestoreCheckpoint(const CheckpointUpdate& checkpoint) {
+  next_available_job_id_ =
+      std::max(next_available_job_id_, checkpoint.next_available_job_id());
+  next_available_iteration_id_ = std::max(
+      next_available_iteration_id_, checkpoint.next_available_iteration_id());
+  next_available_iteration_client_id_ =
+      std::max(next_available_iteration_client_id_,
+               checkpoint.next_available_iteration_client_id());
+  next_available_task_id_ =
+      std::max(next_available_task_id_, checkpoint.next_available_task_id());
+  for (const auto& iteration_state : checkpoint.iterations()) {
+    std::shared_ptr<Iteration>& iteration =
+        iterations_[iteration_state.iteration_id()];
+    DCHECK(iteration);
+    iteration->last_client_released_micros =
+        iteration_state.last_client_released_micros();
+  }
+  for (const auto& task_state : checkpoint.tasks()) {
+    std::shared_ptr<Task>& task = tasks_[task_state.task_id()];
+    DCHECK(task);
+    task->starting_round = task_state.starting_round();
+  }
+  if (checkpoint.pending_tasks().empty()) {
+    return;
+  }
+  absl::flat_hash_map<int64_t, const CheckpointUpdate::PendingTaskState*>
+      pending_task_states;
+  for (const auto& pending_task_state : checkpoint.pending_tasks()) {
+    pending_task_states[pending_task_state.task_id()] = &pending_task_state;
+  }
+  for (auto& [iteration_id, iteration] : iterations_) {
+    // Rotates through the queue to update each pending task in place.
+    for (size_t i = 0; i < iteration->pending_tasks.size(); ++i) {
+      PendingTask pending_task = std::move(iteration->pending_tasks.front());
+      iteration->pending_tasks.pop();
+      auto it = pending_task_states.find(pending_task.task->task_id);
+      if (it != pending_task_states.end()) {
+        pending_task.failures = it->second->failures();
+        pending_task.ready_consumers.clear();
+        pending_task.ready_consumers.insert(
+            it->second->ready_consumers().begin(),
+            it->second->ready_consumers().end());
+      }
+      iteration->pending_tasks.push(std::move(pending_task));
+    }
+  }
+}
+
 std::optional<bool> DispatcherState::CompressionDisabledAtRuntime(
     const std::string& dataset_id) const {
   if (auto it = compression_disabled_at_runtime_.find(dataset_id);
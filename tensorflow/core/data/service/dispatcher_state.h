@@ -73,6 +73,11 @@ class DispatcherState {
   // Applies the given update to the dispatcher's state.
   Status Apply(const Update& update);
 
+  // Returns updates which recreate the current state when applied in order to
+  // a `DispatcherState` with the same config. The last update is a
+  // `CheckpointUpdate`.
+  std::vector<Update> Checkpoint() const;
+
   // A dataset registered with the dispatcher.
   struct Dataset {
     explicit Dataset(const std::string& dataset_id,
@@ -325,6 +330,7 @@ class DispatcherState {
   void Snapshot(const SnapshotUpdate& snapshot);
   void CompressionDisabledAtRuntime(const CompressionDisabledAtRuntimeUpdate&
                                         compression_disabled_at_runtime);
+  void RestoreCheckpoint(const CheckpointUpdate& checkpoint);
 
   // Updates the next available dataset ID.
   void UpdateNextAvailableDatasetId();
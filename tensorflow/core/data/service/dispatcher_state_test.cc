@@ -40,6 +40,7 @@ using IterationKey = DispatcherState::IterationKey;
 using Job = DispatcherState::Job;
 using Iteration = DispatcherState::Iteration;
 using Task = DispatcherState::Task;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 using ::testing::IsEmpty;
 using ::testing::SizeIs;
@@ -652,5 +653,121 @@ TEST(DispatcherState, GetNumberOfRegisteredWorkers) {
   EXPECT_EQ(state.GetNumberOfRegisteredWorkers(), 2);
 }
 
+TEST(DispatcherState, CheckpointRestoresState) {
+  std::string dataset_id = "dataset_id";
+  int64_t iteration_id = 3;
+  int64_t gc_iteration_id = 4;
+  DispatcherState state;
+  TF_ASSERT_OK(RegisterDataset(dataset_id, state));
+  TF_ASSERT_OK(RegisterWorker("worker_a", state));
+  TF_ASSERT_OK(RegisterWorker("worker_b", state));
+  TF_ASSERT_OK(Snapshot("snapshot_path", state));
+  TF_ASSERT_OK(CreateIteration(iteration_id, dataset_id, state));
+  TF_ASSERT_OK(CreateTask(/*task_id=*/10, iteration_id, "worker_a", state));
+  TF_ASSERT_OK(CreateTask(/*task_id=*/11, iteration_id, "worker_b", state));
+  TF_ASSERT_OK(FinishTask(/*task_id=*/10, state));
+  TF_ASSERT_OK(AcquireIterationClientId(iteration_id, 20, state));
+  TF_ASSERT_OK(AcquireIterationClientId(iteration_id, 21, state));
+  TF_ASSERT_OK(ReleaseIterationClientId(21, /*release_time=*/100, state));
+  TF_ASSERT_OK(CreateIteration(gc_iteration_id, dataset_id, state));
+  TF_ASSERT_OK(CreateTask(/*task_id=*/12, gc_iteration_id, "worker_a", state));
+  {
+    Update update;
+    update.mutable_garbage_collect_iteration()->set_iteration_id(
+        gc_iteration_id);
+    TF_ASSERT_OK(state.Apply(update));
+  }
+
+  DispatcherState restored;
+  for (const Update& update : state.Checkpoint()) {
+    TF_ASSERT_OK(restored.Apply(update));
+  }
+  EXPECT_EQ(restored.NextAvailableDatasetId(), state.NextAvailableDatasetId());
+  EXPECT_EQ(restored.NextAvailableJobId(), state.NextAvailableJobId());
+  EXPECT_EQ(restored.NextAvailableIterationId(),
+            state.NextAvailableIterationId());
+  EXPECT_EQ(restored.NextAvailableIterationClientId(),
+            state.NextAvailableIterationClientId());
+  EXPECT_EQ(restored.NextAvailableTaskId(), state.NextAvailableTaskId());
+  EXPECT_EQ(restored.ListSnapshotPaths(), state.ListSnapshotPaths());
+  EXPECT_EQ(restored.GetNumberOfRegisteredWorkers(), 2);
+  EXPECT_THAT(restored.ListActiveClientIds(), UnorderedElementsAre(20));
+
+  std::shared_ptr<const Iteration> iteration;
+  TF_ASSERT_OK(restored.IterationFromId(iteration_id, iteration));
+  EXPECT_EQ(iteration->num_clients, 1);
+  EXPECT_EQ(iteration->last_client_released_micros, 100);
+  EXPECT_FALSE(iteration->finished);
+  std::vector<std::shared_ptr<const Task>> tasks;
+  TF_ASSERT_OK(restored.TasksForIteration(iteration_id, tasks));
+  ASSERT_THAT(tasks, SizeIs(2));
+  EXPECT_TRUE(tasks[0]->finished);
+  EXPECT_FALSE(tasks[1]->finished);
+  TF_ASSERT_OK(restored.TasksForWorker("worker_a", tasks));
+  EXPECT_THAT(tasks, IsEmpty());
+  TF_ASSERT_OK(restored.IterationFromId(gc_iteration_id, iteration));
+  EXPECT_TRUE(iteration->garbage_collected);
+
+  // Checkpointing the restored state yields the same updates.
+  std::vector<Update> expected = state.Checkpoint();
+  std::vector<Update> actual = restored.Checkpoint();
+  ASSERT_EQ(actual.size(), expected.size());
+  for (int i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(actual[i].SerializeAsString(), expected[i].SerializeAsString());
+  }
+}
+
+TEST(DispatcherState, CheckpointRestoresSplitProgress) {
+  std::string dataset_id = "dataset_id";
+  int64_t iteration_id = 3;
+  DispatcherState state;
+  TF_ASSERT_OK(RegisterDataset(dataset_id, state));
+  {
+    Update update;
+    CreateJobUpdate* create_job = update.mutable_create_job();
+    create_job->set_job_id(1);
+    create_job->set_dataset_id(dataset_id);
+    create_job->set_job_name("job");
+    create_job->mutable_processing_mode_def()->set_sharding_policy(
+        ProcessingModeDef::DYNAMIC);
+    TF_ASSERT_OK(state.Apply(update));
+  }
+  {
+    Update update;
+    CreateIterationUpdate* create_iteration = update.mutable_create_iteration();
+    create_iteration->set_iteration_id(iteration_id);
+    create_iteration->set_job_id(1);
+    create_iteration->set_num_split_providers(2);
+    TF_ASSERT_OK(state.Apply(update));
+  }
+  auto produce_split = [&](int64_t provider, int64_t repetition,
+                           int64_t num_splits, bool finished) {
+    Update update;
+    ProduceSplitUpdate* produce_split = update.mutable_produce_split();
+    produce_split->set_iteration_id(iteration_id);
+    produce_split->set_split_provider_index(provider);
+    produce_split->set_repetition(repetition);
+    produce_split->set_num_splits(num_splits);
+    produce_split->set_finished(finished);
+    return state.Apply(update);
+  };
+  TF_ASSERT_OK(produce_split(/*provider=*/0, /*repetition=*/0, 5, false));
+  TF_ASSERT_OK(produce_split(/*provider=*/0, /*repetition=*/0, 0, true));
+  TF_ASSERT_OK(produce_split(/*provider=*/0, /*repetition=*/1, 3, false));
+  TF_ASSERT_OK(produce_split(/*provider=*/1, /*repetition=*/0, 7, false));
+
+  DispatcherState restored;
+  for (const Update& update : state.Checkpoint()) {
+    TF_ASSERT_OK(restored.Apply(update));
+  }
+  std::shared_ptr<const Iteration> iteration;
+  TF_ASSERT_OK(restored.IterationFromId(iteration_id, iteration));
+  ASSERT_TRUE(iteration->distributed_epoch_state.has_value());
+  EXPECT_THAT(iteration->distributed_epoch_state->repetitions,
+              ElementsAre(1, 0));
+  EXPECT_THAT(iteration->distributed_epoch_state->indices,
+              ElementsAre(3, 7));
+}
+
 }  // namespace data
 }  // namespace tensorflow
@@ -63,6 +63,7 @@ HANDLER(GetOrCreateJob);
 HANDLER(GetOrCreateIteration);
 HANDLER(ClientHeartbeat);
 HANDLER(GetWorkers);
+HANDLER(GetAutoScalingRecommendation);
 HANDLER(GetDataServiceMetadata);
 HANDLER(GetDataServiceConfig);
 HANDLER(Snapshot);
@@ -57,6 +57,7 @@ class GrpcDispatcherImpl : public DispatcherService::Service {
   HANDLER(GetOrCreateIteration);
   HANDLER(ClientHeartbeat);
   HANDLER(GetWorkers);
+  HANDLER(GetAutoScalingRecommendation);
   HANDLER(GetDataServiceMetadata);
   HANDLER(GetDataServiceConfig);
   HANDLER(Snapshot);
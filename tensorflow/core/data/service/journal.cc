@@ -18,15 +18,19 @@ limitations under the License.
 #include <algorithm>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/regexp.h"
 
@@ -35,10 +39,15 @@ namespace data {
 
 namespace {
 constexpr StringPiece kJournal = "journal";
+constexpr StringPiece kCheckpoint = "checkpoint";
+constexpr StringPiece kTempSuffix = ".tmp";
 
+// Parses the sequence number of a journal file, a checkpoint, or a temporary
+// checkpoint file.
 Status ParseSequenceNumber(const std::string& journal_file,
                            int64_t* sequence_number) {
-  if (!RE2::FullMatch(journal_file, ".*_(\\d+)", sequence_number)) {
+  if (!RE2::FullMatch(journal_file, ".*_(\\d+)(?:\\.tmp)?",
+                      sequence_number)) {
     return errors::InvalidArgument("Failed to parse journal file name: ",
                                    journal_file);
   }
@@ -52,6 +61,45 @@ std::string DataServiceJournalFile(const std::string& journal_dir,
                       absl::StrCat(kJournal, "_", sequence_number));
 }
 
+std::string DataServiceJournalCheckpointFile(const std::string& journal_dir,
+                                             int64_t sequence_number) {
+  return io::JoinPath(journal_dir,
+                      absl::StrCat(kCheckpoint, "_", sequence_number));
+}
+
+Status WriteJournalCheckpoint(Env* env, const std::string& journal_dir,
+                              int64_t sequence_number,
+                              const std::vector<Update>& updates) {
+  std::string checkpoint_file =
+      DataServiceJournalCheckpointFile(journal_dir, sequence_number);
+  std::string temp_file = absl::StrCat(checkpoint_file, kTempSuffix);
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_RETURN_IF_ERROR(env->NewWritableFile(temp_file, &file));
+    io::RecordWriter writer(file.get());
+    for (const Update& update : updates) {
+      TF_RETURN_IF_ERROR(writer.WriteRecord(update.SerializeAsString()));
+    }
+    TF_RETURN_IF_ERROR(writer.Close());
+    TF_RETURN_IF_ERROR(file->Sync());
+    TF_RETURN_IF_ERROR(file->Close());
+  }
+  TF_RETURN_IF_ERROR(env->RenameFile(temp_file, checkpoint_file));
+  VLOG(1) << "Wrote journal checkpoint " << checkpoint_file << " with "
+          << updates.size() << " updates";
+
+  std::vector<std::string> files;
+  TF_RETURN_IF_ERROR(env->GetChildren(journal_dir, &files));
+  for (const std::string& file : files) {
+    int64_t file_sequence_number;
+    TF_RETURN_IF_ERROR(ParseSequenceNumber(file, &file_sequence_number));
+    if (file_sequence_number < sequence_number) {
+      TF_RETURN_IF_ERROR(env->DeleteFile(io::JoinPath(journal_dir, file)));
+    }
+  }
+  return absl::OkStatus();
+}
+
 FileJournalWriter::FileJournalWriter(Env* env, const std::string& journal_dir)
     : env_(env), journal_dir_(journal_dir) {}
 
@@ -68,8 +116,9 @@ Status FileJournalWriter::EnsureInitialized() {
     TF_RETURN_IF_ERROR(ParseSequenceNumber(file, &sequence_number));
     latest_sequence_number = std::max(latest_sequence_number, sequence_number);
   }
+  sequence_number_ = latest_sequence_number + 1;
   std::string journal_file =
-      DataServiceJournalFile(journal_dir_, latest_sequence_number + 1);
+      DataServiceJournalFile(journal_dir_, sequence_number_);
   TF_RETURN_IF_ERROR(env_->NewAppendableFile(journal_file, &file_));
   writer_ = std::make_unique<io::RecordWriter>(file_.get());
   VLOG(1) << "Created journal writer to write to " << journal_file;
@@ -77,6 +126,11 @@ Status FileJournalWriter::EnsureInitialized() {
 }
 
 Status FileJournalWriter::Write(const Update& update) {
+  TF_RETURN_IF_ERROR(WriteUnsynced(update));
+  return Sync();
+}
+
+Status FileJournalWriter::WriteUnsynced(const Update& update) {
   TF_RETURN_IF_ERROR(EnsureInitialized());
   std::string s = update.SerializeAsString();
   if (s.empty()) {
@@ -84,14 +138,121 @@ Status FileJournalWriter::Write(const Update& update) {
                             " to string");
   }
   TF_RETURN_IF_ERROR(writer_->WriteRecord(s));
-  TF_RETURN_IF_ERROR(writer_->Flush());
-  TF_RETURN_IF_ERROR(file_->Sync());
   if (VLOG_IS_ON(4)) {
     VLOG(4) << "Wrote journal entry: " << update.DebugString();
   }
   return absl::OkStatus();
 }
 
+Status FileJournalWriter::Sync() {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  TF_RETURN_IF_ERROR(writer_->Flush());
+  return file_->Sync();
+}
+
+absl::StatusOr<int64_t> FileJournalWriter::StartNewFile() {
+  if (writer_) {
+    TF_RETURN_IF_ERROR(writer_->Close());
+    TF_RETURN_IF_ERROR(file_->Sync());
+    TF_RETURN_IF_ERROR(file_->Close());
+    writer_.reset();
+    file_.reset();
+  }
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  return sequence_number_;
+}
+
+GroupCommitJournalWriter::GroupCommitJournalWriter(
+    std::unique_ptr<JournalWriter> writer, int64_t sync_window_us)
+    : sync_window_us_(sync_window_us), writer_(std::move(writer)) {}
+
+Status GroupCommitJournalWriter::Write(const Update& update) {
+  int64_t num_updates;
+  {
+    mutex_lock l(mu_);
+    TF_RETURN_IF_ERROR(status_);
+    pending_.push_back(update);
+    num_updates = ++num_queued_;
+  }
+  return Commit(num_updates, /*wait_for_window=*/false);
+}
+
+Status GroupCommitJournalWriter::WriteUnsynced(const Update& update) {
+  mutex_lock l(mu_);
+  TF_RETURN_IF_ERROR(status_);
+  pending_.push_back(update);
+  ++num_queued_;
+  return absl::OkStatus();
+}
+
+Status GroupCommitJournalWriter::Sync() {
+  int64_t num_updates;
+  {
+    mutex_lock l(mu_);
+    num_updates = num_queued_;
+  }
+  return Commit(num_updates, /*wait_for_window=*/true);
+}
+
+absl::StatusOr<int64_t> GroupCommitJournalWriter::StartNewFile() {
+  mutex_lock write_lock(write_mu_);
+  TF_RETURN_IF_ERROR(WritePending());
+  return writer_->StartNewFile();
+}
+
+Status GroupCommitJournalWriter::EnsureInitialized() {
+  mutex_lock l(write_mu_);
+  return writer_->EnsureInitialized();
+}
+
+Status GroupCommitJournalWriter::Commit(int64_t num_updates,
+                                        bool wait_for_window) {
+  // Callers waiting here while another caller syncs usually find their updates
+  // committed by the time they acquire `write_mu_`.
+  mutex_lock write_lock(write_mu_);
+  {
+    mutex_lock l(mu_);
+    if (num_committed_ >= num_updates) {
+      return absl::OkStatus();
+    }
+  }
+  if (wait_for_window && sync_window_us_ > 0) {
+    Env::Default()->SleepForMicroseconds(sync_window_us_);
+  }
+  return WritePending();
+}
+
+Status GroupCommitJournalWriter::WritePending() {
+  std::vector<Update> batch;
+  int64_t num_written;
+  {
+    mutex_lock l(mu_);
+    TF_RETURN_IF_ERROR(status_);
+    if (num_committed_ == num_queued_) {
+      return absl::OkStatus();
+    }
+    batch.swap(pending_);
+    num_written = num_queued_;
+  }
+  Status s;
+  for (const Update& update : batch) {
+    s = writer_->WriteUnsynced(update);
+    if (!s.ok()) {
+      break;
+    }
+  }
+  if (s.ok()) {
+    s = writer_->Sync();
+  }
+  mutex_lock l(mu_);
+  if (!s.ok()) {
+    status_ = s;
+    return s;
+  }
+  num_committed_ = num_written;
+  return absl::OkStatus();
+}
+
 FileJournalReader::FileJournalReader(Env* env, StringPiece journal_dir)
     : env_(env), journal_dir_(journal_dir) {}
 
@@ -99,7 +260,27 @@ Status FileJournalReader::EnsureInitialized() {
   if (reader_) {
     return absl::OkStatus();
   }
-  return UpdateFile(DataServiceJournalFile(journal_dir_, 0));
+  std::vector<std::string> files;
+  Status s = env_->GetChildren(journal_dir_, &files);
+  if (!s.ok() && !absl::IsNotFound(s)) {
+    return s;
+  }
+  int64_t checkpoint_sequence_number = -1;
+  for (const std::string& file : files) {
+    int64_t sequence_number;
+    if (RE2::FullMatch(file, absl::StrCat(kCheckpoint, "_(\\d+)"),
+                       &sequence_number)) {
+      checkpoint_sequence_number =
+          std::max(checkpoint_sequence_number, sequence_number);
+    }
+  }
+  if (checkpoint_sequence_number < 0) {
+    return UpdateFile(DataServiceJournalFile(journal_dir_, 0));
+  }
+  // `Read` moves on to the journal file following the checkpoint.
+  sequence_number_ = checkpoint_sequence_number - 1;
+  return UpdateFile(DataServiceJournalCheckpointFile(
+      journal_dir_, checkpoint_sequence_number));
 }
 
 Status FileJournalReader::Read(Update& update, bool& end_of_journal) {
@@ -15,14 +15,19 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_JOURNAL_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_JOURNAL_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "absl/status/statusor.h"
 #include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
 namespace data {
@@ -31,12 +36,33 @@ namespace data {
 std::string DataServiceJournalFile(const std::string& journal_dir,
                                    int64_t sequence_number);
 
+// Returns the location of the checkpoint which holds the state recorded by all
+// journal files before `sequence_number`.
+std::string DataServiceJournalCheckpointFile(const std::string& journal_dir,
+                                             int64_t sequence_number);
+
+// Atomically writes `updates` as the checkpoint preceding journal file
+// `sequence_number`, then deletes the journal files and checkpoints it
+// replaces. Readers only use the latest checkpoint, so a failure at any point
+// leaves a readable journal.
+Status WriteJournalCheckpoint(Env* env, const std::string& journal_dir,
+                              int64_t sequence_number,
+                              const std::vector<Update>& updates);
+
 // Interface for writing to a journal.
 class JournalWriter {
  public:
   virtual ~JournalWriter() = default;
   // Writes and syncs an update to the journal.
   virtual Status Write(const Update& update) = 0;
+  // Writes an update to the journal without syncing it. The update is durable
+  // after the next call to `Sync`.
+  virtual Status WriteUnsynced(const Update& update) = 0;
+  // Syncs the updates written so far.
+  virtual Status Sync() = 0;
+  // Syncs the updates written so far and writes further updates to a new
+  // journal file. Returns the sequence number of the new file.
+  virtual absl::StatusOr<int64_t> StartNewFile() = 0;
   // Initializes the writer if it is not yet initialized.
   virtual Status EnsureInitialized() = 0;
 };
@@ -57,6 +83,9 @@ class JournalWriter {
 // "journal_0", "journal_1", and "journal_2", the writer will write to
 // "journal_3". The writer will flush updates as they are written, so that they
 // can be stored durably in case of machine failure.
+//
+// A "checkpoint_N" file holds the state recorded by all journal files before
+// "journal_N". See `WriteJournalCheckpoint`.
 class FileJournalWriter : public JournalWriter {
  public:
   // Creates a journal writer to write to the given journal directory.
@@ -67,15 +96,65 @@ class FileJournalWriter : public JournalWriter {
   FileJournalWriter& operator=(const FileJournalWriter&) = delete;
 
   Status Write(const Update& update) override;
+  Status WriteUnsynced(const Update& update) override;
+  Status Sync() override;
+  absl::StatusOr<int64_t> StartNewFile() override;
   Status EnsureInitialized() override;
 
  private:
   Env* env_;
   const std::string journal_dir_;
+  // Sequence number of the current journal file.
+  int64_t sequence_number_ = -1;
   std::unique_ptr<WritableFile> file_;
   std::unique_ptr<io::RecordWriter> writer_;
 };
 
+// GroupCommitJournalWriter is thread-safe.
+//
+// GroupCommitJournalWriter wraps another journal writer to amortize syncs
+// across concurrent writers. `WriteUnsynced` only queues updates. `Write` and
+// `Sync` write all queued updates in order and sync them once, so callers that
+// queue updates while another caller is syncing are covered by a single sync.
+//
+// If `sync_window_us` is positive, `Sync` waits that long before writing so
+// that more updates join the batch. `Write` never waits, since its callers
+// usually hold locks which prevent others from queueing updates.
+class GroupCommitJournalWriter : public JournalWriter {
+ public:
+  explicit GroupCommitJournalWriter(std::unique_ptr<JournalWriter> writer,
+                                    int64_t sync_window_us = 0);
+  GroupCommitJournalWriter(const GroupCommitJournalWriter&) = delete;
+  GroupCommitJournalWriter& operator=(const GroupCommitJournalWriter&) =
+      delete;
+
+  Status Write(const Update& update) override;
+  Status WriteUnsynced(const Update& update) override;
+  Status Sync() override;
+  absl::StatusOr<int64_t> StartNewFile() override;
+  Status EnsureInitialized() override;
+
+ private:
+  // Blocks until the first `num_updates` queued updates are durable.
+  Status Commit(int64_t num_updates, bool wait_for_window);
+  // Writes and syncs all queued updates.
+  Status WritePending() TF_EXCLUSIVE_LOCKS_REQUIRED(write_mu_);
+
+  const int64_t sync_window_us_;
+  // Held while writing and syncing a batch of updates.
+  mutex write_mu_;
+  const std::unique_ptr<JournalWriter> writer_ TF_PT_GUARDED_BY(write_mu_);
+
+  mutex mu_;
+  // Updates which have been queued but not written yet.
+  std::vector<Update> pending_ TF_GUARDED_BY(mu_);
+  int64_t num_queued_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_committed_ TF_GUARDED_BY(mu_) = 0;
+  // Set if writing to `writer_` failed. The journal may then be missing
+  // updates, so no further updates are accepted.
+  Status status_ TF_GUARDED_BY(mu_);
+};
+
 // Interface for reading from a journal.
 class JournalReader {
  public:
@@ -88,8 +167,9 @@ class JournalReader {
 // JournalReader is not thread-safe, requiring external synchronization when
 // used by multiple threads.
 //
-// The journal reader reads through all journal files in the configured journal
-// directory, in order of their sequence numbers. See FileJournalWriter above.
+// The journal reader reads the latest checkpoint in the configured journal
+// directory, if any, followed by the journal files after it in order of their
+// sequence numbers. See FileJournalWriter above.
 class FileJournalReader : public JournalReader {
  public:
   explicit FileJournalReader(Env* env, StringPiece journal_dir);
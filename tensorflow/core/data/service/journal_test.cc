@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/journal.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -25,7 +27,9 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/protobuf/data_service.pb.h"
 
 namespace tensorflow {
@@ -115,6 +119,118 @@ TEST(Journal, AppendExistingJournal) {
   TF_EXPECT_OK(CheckJournalContent(journal_dir, updates));
 }
 
+TEST(Journal, WriteUnsyncedThenSync) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  std::vector<Update> updates = {MakeCreateIterationUpdate(),
+                                 MakeRegisterDatasetUpdate(),
+                                 MakeFinishTaskUpdate()};
+  FileJournalWriter writer(Env::Default(), journal_dir);
+  for (const auto& update : updates) {
+    TF_EXPECT_OK(writer.WriteUnsynced(update));
+  }
+  TF_EXPECT_OK(writer.Sync());
+
+  TF_EXPECT_OK(CheckJournalContent(journal_dir, updates));
+}
+
+TEST(Journal, GroupCommitKeepsOrder) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  std::vector<Update> updates = {MakeCreateIterationUpdate(),
+                                 MakeRegisterDatasetUpdate(),
+                                 MakeFinishTaskUpdate()};
+  GroupCommitJournalWriter writer(
+      std::make_unique<FileJournalWriter>(Env::Default(), journal_dir));
+  TF_EXPECT_OK(writer.WriteUnsynced(updates[0]));
+  TF_EXPECT_OK(writer.WriteUnsynced(updates[1]));
+  TF_EXPECT_OK(writer.Write(updates[2]));
+  TF_EXPECT_OK(writer.Sync());
+
+  TF_EXPECT_OK(CheckJournalContent(journal_dir, updates));
+}
+
+TEST(Journal, GroupCommitConcurrentWrites) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  GroupCommitJournalWriter writer(
+      std::make_unique<FileJournalWriter>(Env::Default(), journal_dir));
+  constexpr int kNumThreads = 8;
+  constexpr int kUpdatesPerThread = 20;
+  {
+    thread::ThreadPool pool(Env::Default(), "journal_writers", kNumThreads);
+    for (int i = 0; i < kNumThreads; ++i) {
+      pool.Schedule([&writer, i] {
+        for (int j = 0; j < kUpdatesPerThread; ++j) {
+          Update update;
+          update.mutable_finish_task()->set_task_id(i * kUpdatesPerThread + j);
+          TF_EXPECT_OK(writer.Write(update));
+        }
+      });
+    }
+  }
+
+  FileJournalReader reader(Env::Default(), journal_dir);
+  std::vector<int64_t> task_ids;
+  while (true) {
+    Update update;
+    bool end_of_journal = false;
+    TF_ASSERT_OK(reader.Read(update, end_of_journal));
+    if (end_of_journal) {
+      break;
+    }
+    task_ids.push_back(update.finish_task().task_id());
+  }
+  std::sort(task_ids.begin(), task_ids.end());
+  ASSERT_EQ(task_ids.size(), kNumThreads * kUpdatesPerThread);
+  for (int i = 0; i < task_ids.size(); ++i) {
+    EXPECT_EQ(task_ids[i], i);
+  }
+}
+
+TEST(Journal, CheckpointReplacesOldFiles) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  FileJournalWriter writer(Env::Default(), journal_dir);
+  TF_ASSERT_OK(writer.Write(MakeCreateIterationUpdate()));
+  TF_ASSERT_OK(writer.Write(MakeFinishTaskUpdate()));
+  TF_ASSERT_OK_AND_ASSIGN(int64_t sequence_number, writer.StartNewFile());
+  EXPECT_EQ(sequence_number, 1);
+  TF_ASSERT_OK(writer.Write(MakeRegisterDatasetUpdate()));
+  // Until the checkpoint is written, the journal is read from the start.
+  TF_EXPECT_OK(CheckJournalContent(
+      journal_dir, {MakeCreateIterationUpdate(), MakeFinishTaskUpdate(),
+                    MakeRegisterDatasetUpdate()}));
+
+  TF_ASSERT_OK(WriteJournalCheckpoint(Env::Default(), journal_dir,
+                                      sequence_number,
+                                      {MakeCreateIterationUpdate()}));
+  EXPECT_TRUE(absl::IsNotFound(
+      Env::Default()->FileExists(DataServiceJournalFile(journal_dir, 0))));
+  TF_EXPECT_OK(CheckJournalContent(
+      journal_dir, {MakeCreateIterationUpdate(), MakeRegisterDatasetUpdate()}));
+}
+
+TEST(Journal, AppendAfterCheckpoint) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  {
+    FileJournalWriter writer(Env::Default(), journal_dir);
+    TF_ASSERT_OK(writer.Write(MakeFinishTaskUpdate()));
+    TF_ASSERT_OK_AND_ASSIGN(int64_t sequence_number, writer.StartNewFile());
+    TF_ASSERT_OK(WriteJournalCheckpoint(Env::Default(), journal_dir,
+                                        sequence_number,
+                                        {MakeRegisterDatasetUpdate()}));
+  }
+  GroupCommitJournalWriter writer(
+      std::make_unique<FileJournalWriter>(Env::Default(), journal_dir),
+      /*sync_window_us=*/1000);
+  TF_ASSERT_OK(writer.WriteUnsynced(MakeCreateIterationUpdate()));
+  TF_ASSERT_OK(writer.Sync());
+  TF_EXPECT_OK(CheckJournalContent(
+      journal_dir, {MakeRegisterDatasetUpdate(), MakeCreateIterationUpdate()}));
+}
+
 TEST(Journal, MissingFile) {
   std::string journal_dir;
   EXPECT_TRUE(NewJournalDir(journal_dir));
@@ -0,0 +1,556 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shared_memory_transfer.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "grpcpp/client_context.h"
+#include "grpcpp/create_channel.h"
+#include "grpcpp/impl/codegen/client_unary_call.h"
+#include "grpcpp/impl/codegen/method_handler.h"
+#include "grpcpp/impl/codegen/rpc_method.h"
+#include "grpcpp/impl/codegen/rpc_service_method.h"
+#include "grpcpp/security/credentials.h"
+#include "grpcpp/security/server_credentials.h"
+#include "grpcpp/server.h"
+#include "grpcpp/server_builder.h"
+#include "grpcpp/server_context.h"
+#include "grpcpp/support/byte_buffer.h"
+#include "grpcpp/support/channel_arguments.h"
+#include "grpcpp/support/proto_buffer_reader.h"
+#include "grpcpp/support/slice.h"
+#include "grpcpp/support/status.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+#include "xla/tsl/distributed_runtime/rpc/grpc_util.h"
+#include "tensorflow/core/data/service/credentials_factory.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/grpc_util.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/data/service/zero_copy_transfer.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kGetElementMethod[] =
+    "/tensorflow.data.SharedMemoryTransferService/GetElement";
+constexpr char kBootIdPath[] = "/proc/sys/kernel/random/boot_id";
+constexpr int64_t kRegionSizeBytes =
+    kSharedMemoryNumSlots * kSharedMemorySlotSizeBytes;
+// How long a client waits to hand its slots back when it is destroyed.
+constexpr int kReleaseTimeoutMs = 1000;
+
+Status GetBootId(std::string* boot_id) {
+  TF_RETURN_IF_ERROR(ReadFileToString(Env::Default(), kBootIdPath, boot_id));
+  absl::StripAsciiWhitespace(boot_id);
+  return absl::OkStatus();
+}
+
+// A mapping of a POSIX shared memory object.
+class SharedMemoryRegion {
+ public:
+  // Creates a new object named `name`, and maps it for writing.
+  static Status Create(const std::string& name, int64_t size,
+                       std::unique_ptr<SharedMemoryRegion>* out) {
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+      return errors::IOError(absl::StrCat("shm_open ", name), errno);
+    }
+    auto cleanup = gtl::MakeCleanup([fd] { close(fd); });
+    // Reserves the memory up front, so that running out of shared memory fails
+    // here instead of raising SIGBUS when writing to a slot.
+    if (int err = posix_fallocate(fd, 0, size); err != 0) {
+      shm_unlink(name.c_str());
+      return errors::IOError(absl::StrCat("posix_fallocate ", name), err);
+    }
+    void* data =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, /*off=*/0);
+    if (data == MAP_FAILED) {
+      shm_unlink(name.c_str());
+      return errors::IOError(absl::StrCat("mmap ", name), errno);
+    }
+    *out = absl::WrapUnique(
+        new SharedMemoryRegion(name, static_cast<char*>(data), size,
+                               /*owned=*/true));
+    return absl::OkStatus();
+  }
+
+  // Maps the existing object named `name` for reading.
+  static Status Open(const std::string& name,
+                     std::unique_ptr<SharedMemoryRegion>* out) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+      return errors::IOError(absl::StrCat("shm_open ", name), errno);
+    }
+    auto cleanup = gtl::MakeCleanup([fd] { close(fd); });
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      return errors::IOError(absl::StrCat("fstat ", name), errno);
+    }
+    void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd,
+                      /*off=*/0);
+    if (data == MAP_FAILED) {
+      return errors::IOError(absl::StrCat("mmap ", name), errno);
+    }
+    *out = absl::WrapUnique(new SharedMemoryRegion(
+        name, static_cast<char*>(data), st.st_size, /*owned=*/false));
+    return absl::OkStatus();
+  }
+
+  ~SharedMemoryRegion() {
+    munmap(data_, size_);
+    if (owned_) {
+      shm_unlink(name_.c_str());
+    }
+  }
+
+  const std::string& name() const { return name_; }
+  char* data() const { return data_; }
+  int64_t size() const { return size_; }
+
+ private:
+  SharedMemoryRegion(const std::string& name, char* data, int64_t size,
+                     bool owned)
+      : name_(name), data_(data), size_(size), owned_(owned) {}
+
+  const std::string name_;
+  char* const data_;
+  const int64_t size_;
+  // Whether the object is unlinked when the region is destroyed.
+  const bool owned_;
+};
+
+class SharedMemoryTransferService : public ::grpc::Service {
+ public:
+  explicit SharedMemoryTransferService(
+      DataTransferServer::GetElementT get_element)
+      : get_element_(std::move(get_element)) {
+    for (int64_t slot = kSharedMemoryNumSlots - 1; slot >= 0; --slot) {
+      free_slots_.push_back(slot);
+    }
+    AddMethod(new ::grpc::internal::RpcServiceMethod(
+        kGetElementMethod, ::grpc::internal::RpcMethod::NORMAL_RPC,
+        new ::grpc::internal::RpcMethodHandler<SharedMemoryTransferService,
+                                               SharedMemoryGetElementRequest,
+                                               ::grpc::ByteBuffer>(
+            std::mem_fn(&SharedMemoryTransferService::GetElement), this)));
+  }
+
+  Status Start() {
+    const std::string name =
+        absl::StrCat("/tf_data_", getpid(), "_", random::New64());
+    return SharedMemoryRegion::Create(name, kRegionSizeBytes, &region_);
+  }
+
+  const std::string& region_name() const { return region_->name(); }
+
+  ::grpc::Status GetElement(::grpc::ServerContext* context,
+                            const SharedMemoryGetElementRequest* request,
+                            ::grpc::ByteBuffer* response) {
+    return ToGrpcStatus(GetElementInternal(*request, response));
+  }
+
+ private:
+  Status GetElementInternal(const SharedMemoryGetElementRequest& request,
+                            ::grpc::ByteBuffer* response) {
+    TF_RETURN_IF_ERROR(ReleaseSlots(request));
+    SharedMemoryGetElementResponse header;
+    header.set_slot(-1);
+    if (!request.has_request()) {
+      return FromGrpcStatus(tsl::GrpcMaybeUnparseProto(header, response));
+    }
+
+    GetElementResult result;
+    TF_RETURN_IF_ERROR(get_element_(&request.request(), &result));
+    ::grpc::ByteBuffer element;
+    TF_RETURN_IF_ERROR(EncodeElementToByteBuffer(result, &element));
+    const int64_t size = element.Length();
+    std::vector<::grpc::Slice> slices;
+    if (!element.Dump(&slices).ok()) {
+      return errors::Internal("Failed to read encoded element.");
+    }
+
+    int64_t slot;
+    if (size <= kSharedMemorySlotSizeBytes && AcquireSlot(&slot)) {
+      const int64_t offset = slot * kSharedMemorySlotSizeBytes;
+      char* dst = region_->data() + offset;
+      for (const ::grpc::Slice& slice : slices) {
+        memcpy(dst, slice.begin(), slice.size());
+        dst += slice.size();
+      }
+      header.set_region(region_->name());
+      header.set_slot(slot);
+      header.set_offset(offset);
+      header.set_size(size);
+      return FromGrpcStatus(tsl::GrpcMaybeUnparseProto(header, response));
+    }
+
+    // Appends the element to the header as the `element` field, sharing the
+    // encoded slices.
+    std::string prefix = header.SerializeAsString();
+    core::PutVarint32(
+        &prefix, (SharedMemoryGetElementResponse::kElementFieldNumber << 3) |
+                     /*length-delimited=*/2);
+    core::PutVarint64(&prefix, size);
+    slices.insert(slices.begin(), ::grpc::Slice(prefix.data(), prefix.size()));
+    ::grpc::ByteBuffer tmp(slices.data(), slices.size());
+    response->Swap(&tmp);
+    return absl::OkStatus();
+  }
+
+  bool AcquireSlot(int64_t* slot) {
+    mutex_lock l(mu_);
+    if (free_slots_.empty()) {
+      return false;
+    }
+    *slot = free_slots_.back();
+    free_slots_.pop_back();
+    return true;
+  }
+
+  Status ReleaseSlots(const SharedMemoryGetElementRequest& request) {
+    mutex_lock l(mu_);
+    for (int64_t slot : request.released_slots()) {
+      if (slot < 0 || slot >= kSharedMemoryNumSlots ||
+          std::find(free_slots_.begin(), free_slots_.end(), slot) !=
+              free_slots_.end()) {
+        return errors::InvalidArgument("Released invalid slot ", slot);
+      }
+      free_slots_.push_back(slot);
+    }
+    return absl::OkStatus();
+  }
+
+  const DataTransferServer::GetElementT get_element_;
+  std::unique_ptr<SharedMemoryRegion> region_;
+  mutex mu_;
+  std::vector<int64_t> free_slots_ TF_GUARDED_BY(mu_);
+};
+
+class SharedMemoryDataTransferServer : public DataTransferServer {
+ public:
+  explicit SharedMemoryDataTransferServer(GetElementT get_element)
+      : service_(std::move(get_element)) {}
+
+  ~SharedMemoryDataTransferServer() override {
+    if (server_) {
+      server_->Shutdown();
+    }
+  }
+
+  Status Start(const experimental::WorkerConfig& config) override {
+    TF_RETURN_IF_ERROR(GetBootId(&boot_id_));
+    TF_RETURN_IF_ERROR(service_.Start());
+    std::shared_ptr<::grpc::ServerCredentials> credentials;
+    TF_RETURN_IF_ERROR(CredentialsFactory::CreateServerCredentials(
+        config.protocol(), &credentials));
+    ::grpc::ServerBuilder builder;
+    builder.AddListeningPort("[::]:0", credentials, &port_);
+    builder.RegisterService(&service_);
+    server_ = builder.BuildAndStart();
+    if (!server_) {
+      return errors::Internal("Could not start ",
+                              kSharedMemoryTransferProtocol,
+                              " data transfer server.");
+    }
+    VLOG(1) << "Started " << kSharedMemoryTransferProtocol
+            << " data transfer server on port " << port_ << " with region "
+            << service_.region_name();
+    return absl::OkStatus();
+  }
+
+  int Port() const override { return port_; }
+
+  absl::StatusOr<std::string> GetCompatibilityInfo() const override {
+    SharedMemoryCompatibilityInfo info;
+    info.set_boot_id(boot_id_);
+    info.set_region(service_.region_name());
+    return info.SerializeAsString();
+  }
+
+ private:
+  SharedMemoryTransferService service_;
+  std::unique_ptr<::grpc::Server> server_;
+  std::string boot_id_;
+  int port_ = 0;
+};
+
+class SharedMemoryDataTransferClient : public DataTransferClient {
+ public:
+  SharedMemoryDataTransferClient(
+      std::shared_ptr<::grpc::ChannelCredentials> credentials,
+      std::string address, Allocator* allocator)
+      : allocator_(allocator),
+        rpcmethod_get_element_(kGetElementMethod,
+                               ::grpc::internal::RpcMethod::NORMAL_RPC) {
+    VLOG(2) << "Create SharedMemoryDataTransferClient for worker " << address
+            << ".";
+    ::grpc::ChannelArguments args;
+    args.SetMaxReceiveMessageSize(-1);
+    channel_ = ::grpc::CreateCustomChannel(address, credentials, args);
+  }
+
+  ~SharedMemoryDataTransferClient() override {
+    // Hands the slots of the last responses back to the worker, so other
+    // clients can use them.
+    SharedMemoryGetElementRequest req;
+    {
+      mutex_lock l(mu_);
+      if (released_slots_.empty()) {
+        return;
+      }
+      req.mutable_released_slots()->Add(released_slots_.begin(),
+                                        released_slots_.end());
+    }
+    ::grpc::ClientContext ctx;
+    ctx.set_deadline(std::chrono::system_clock::now() +
+                     std::chrono::milliseconds(kReleaseTimeoutMs));
+    ::grpc::ByteBuffer resp;
+    ::grpc::Status s =
+        ::grpc::internal::BlockingUnaryCall<SharedMemoryGetElementRequest,
+                                            ::grpc::ByteBuffer>(
+            channel_.get(), rpcmethod_get_element_, &ctx, req, &resp);
+    if (!s.ok()) {
+      VLOG(1) << "Failed to release shared memory slots: "
+              << s.error_message();
+    }
+  }
+
+  Status GetElement(const GetElementRequest& req,
+                    GetElementResult& result) override {
+    VLOG(3) << "GetElement for task " << req.task_id() << " from "
+            << kSharedMemoryTransferProtocol << " worker server.";
+    SharedMemoryGetElementRequest shm_req;
+    *shm_req.mutable_request() = req;
+    ::grpc::ClientContext ctx;
+    gtl::Cleanup<std::function<void()>> cleanup;
+    {
+      mutex_lock l(mu_);
+      if (cancelled_) {
+        return errors::Cancelled("Client was cancelled.");
+      }
+      shm_req.mutable_released_slots()->Add(released_slots_.begin(),
+                                            released_slots_.end());
+      released_slots_.clear();
+      active_contexts_.insert(&ctx);
+      cleanup = gtl::MakeCleanup([this, &ctx] {
+        mutex_lock l(mu_);
+        active_contexts_.erase(&ctx);
+      });
+    }
+    ::grpc::ByteBuffer resp;
+    int64_t start_time_us = env_->NowMicros();
+    ::grpc::Status s =
+        ::grpc::internal::BlockingUnaryCall<SharedMemoryGetElementRequest,
+                                            ::grpc::ByteBuffer>(
+            channel_.get(), rpcmethod_get_element_, &ctx, shm_req, &resp);
+    if (!s.ok()) {
+      // The worker may not have received the released slots.
+      mutex_lock l(mu_);
+      released_slots_.insert(released_slots_.end(),
+                             shm_req.released_slots().begin(),
+                             shm_req.released_slots().end());
+      return grpc_util::WrapError("Failed to get element", s);
+    }
+    TF_RETURN_IF_ERROR(DecodeResponse(&resp, result));
+    int64_t end_time_us = env_->NowMicros();
+    metrics::RecordTFDataServiceGetElementDuration(
+        kSharedMemoryTransferProtocol, end_time_us - start_time_us);
+    return absl::OkStatus();
+  }
+
+  void TryCancel() override {
+    VLOG(2) << "Cancel SharedMemoryDataTransferClient.";
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    for (const auto& ctx : active_contexts_) {
+      ctx->TryCancel();
+    }
+  }
+
+  Status CheckCompatibility(
+      const std::string& server_compatibility_info) const override {
+    SharedMemoryCompatibilityInfo info;
+    if (!info.ParseFromString(server_compatibility_info)) {
+      return errors::InvalidArgument(
+          "Failed to parse compatibility info of the ",
+          kSharedMemoryTransferProtocol, " data transfer server.");
+    }
+    std::string boot_id;
+    TF_RETURN_IF_ERROR(GetBootId(&boot_id));
+    if (boot_id != info.boot_id()) {
+      return errors::FailedPrecondition(
+          "The worker runs on a different host than the client.");
+    }
+    std::unique_ptr<SharedMemoryRegion> region;
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(
+        SharedMemoryRegion::Open(info.region(), &region),
+        "The client cannot map the shared memory region of the worker");
+    return absl::OkStatus();
+  }
+
+ private:
+  // Decodes a `SharedMemoryGetElementResponse`, reading the element from the
+  // worker's region or from the response itself.
+  Status DecodeResponse(::grpc::ByteBuffer* resp, GetElementResult& result) {
+    ::grpc::ProtoBufferReader reader(resp);
+    protobuf::io::CodedInputStream input(&reader);
+    input.SetTotalBytesLimit(std::numeric_limits<int>::max());
+    // The fields are read by hand, so an inline element is decoded straight
+    // into tensors instead of being copied into the proto first.
+    SharedMemoryGetElementResponse header;
+    while (uint32 tag = input.ReadTag()) {
+      const int field = tag >> 3;
+      const int wire_type = tag & 7;
+      uint64 value;
+      uint32 length;
+      if (wire_type == /*varint=*/0) {
+        if (!input.ReadVarint64(&value)) break;
+        if (field == SharedMemoryGetElementResponse::kSlotFieldNumber) {
+          header.set_slot(static_cast<int64_t>(value));
+        } else if (field ==
+                   SharedMemoryGetElementResponse::kOffsetFieldNumber) {
+          header.set_offset(static_cast<int64_t>(value));
+        } else if (field == SharedMemoryGetElementResponse::kSizeFieldNumber) {
+          header.set_size(static_cast<int64_t>(value));
+        }
+      } else if (wire_type == /*length-delimited=*/2 &&
+                 input.ReadVarint32(&length)) {
+        if (field == SharedMemoryGetElementResponse::kRegionFieldNumber) {
+          if (!input.ReadString(header.mutable_region(), length)) break;
+        } else if (field ==
+                   SharedMemoryGetElementResponse::kElementFieldNumber) {
+          auto limit = input.PushLimit(length);
+          TF_RETURN_IF_ERROR(DecodeElement(&input, allocator_, &result));
+          input.PopLimit(limit);
+          return absl::OkStatus();
+        } else if (!input.Skip(length)) {
+          break;
+        }
+      } else {
+        break;
+      }
+    }
+    if (!input.ConsumedEntireMessage() || header.slot() < 0) {
+      return errors::DataLoss("Failed to decode ",
+                              kSharedMemoryTransferProtocol, " response.");
+    }
+    return ReadSlot(header, result);
+  }
+
+  Status ReadSlot(const SharedMemoryGetElementResponse& header,
+                  GetElementResult& result) {
+    std::shared_ptr<SharedMemoryRegion> region;
+    {
+      mutex_lock l(mu_);
+      released_slots_.push_back(header.slot());
+      if (!region_ || region_->name() != header.region()) {
+        std::unique_ptr<SharedMemoryRegion> new_region;
+        TF_RETURN_IF_ERROR(
+            SharedMemoryRegion::Open(header.region(), &new_region));
+        region_ = std::move(new_region);
+      }
+      region = region_;
+    }
+    if (header.offset() < 0 || header.size() < 0 ||
+        header.offset() + header.size() > region->size()) {
+      return errors::DataLoss("Slot ", header.slot(), " at offset ",
+                              header.offset(), " of size ", header.size(),
+                              " is out of the bounds of region ",
+                              header.region());
+    }
+    protobuf::io::ArrayInputStream stream(region->data() + header.offset(),
+                                          header.size());
+    protobuf::io::CodedInputStream input(&stream);
+    return DecodeElement(&input, allocator_, &result);
+  }
+
+  Allocator* const allocator_;
+  std::shared_ptr<::grpc::Channel> channel_;
+  const ::grpc::internal::RpcMethod rpcmethod_get_element_;
+  mutex mu_;
+  // The region of the worker, mapped when the first slot is received.
+  std::shared_ptr<SharedMemoryRegion> region_ TF_GUARDED_BY(mu_);
+  // Slots which have been read but not handed back to the worker yet.
+  std::vector<int64_t> released_slots_ TF_GUARDED_BY(mu_);
+  // Set of all currently active clients contexts. Used to support
+  // cancellation.
+  absl::flat_hash_set<::grpc::ClientContext*> active_contexts_
+      TF_GUARDED_BY(mu_);
+  // Indicates that the client has been cancelled, so no further requests should
+  // be accepted.
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+};
+
+class SharedMemoryTransferRegistrar {
+ public:
+  SharedMemoryTransferRegistrar() {
+    DataTransferServer::Register(
+        kSharedMemoryTransferProtocol,
+        [](DataTransferServer::GetElementT get_element,
+           std::shared_ptr<DataTransferServer>* out) {
+          *out = std::make_shared<SharedMemoryDataTransferServer>(
+              std::move(get_element));
+          return absl::OkStatus();
+        });
+    DataTransferClient::Register(
+        kSharedMemoryTransferProtocol,
+        [](DataTransferClient::Config config,
+           std::unique_ptr<DataTransferClient>* out) {
+          std::shared_ptr<::grpc::ChannelCredentials> credentials;
+          TF_RETURN_IF_ERROR(CredentialsFactory::CreateClientCredentials(
+              config.protocol, &credentials));
+          *out = std::make_unique<SharedMemoryDataTransferClient>(
+              credentials, config.address, config.allocator);
+          return absl::OkStatus();
+        });
+  }
+};
+static SharedMemoryTransferRegistrar shared_memory_transfer_registrar;
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
+#endif  // defined(__linux__)
@@ -0,0 +1,43 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SHARED_MEMORY_TRANSFER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SHARED_MEMORY_TRANSFER_H_
+
+#include <cstdint>
+
+namespace tensorflow {
+namespace data {
+
+// A data transfer protocol for clients running on the same host as the
+// worker. The worker writes elements into slots of a shared memory region,
+// and clients read tensors directly out of the slots. A gRPC channel is only
+// used to request elements and to hand slots back to the worker. Elements
+// which do not fit in a free slot are sent inline over the channel.
+//
+// Clients which cannot map the worker's region, e.g. because they run on a
+// different host or in a different IPC namespace, fail the compatibility check
+// and fall back to gRPC.
+//
+// Only available on Linux.
+constexpr const char kSharedMemoryTransferProtocol[] = "shm";
+
+// Number and size of the slots of the region of each worker.
+constexpr int kSharedMemoryNumSlots = 8;
+constexpr int64_t kSharedMemorySlotSizeBytes = 4 << 20;
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SHARED_MEMORY_TRANSFER_H_
@@ -0,0 +1,125 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shared_memory_transfer.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+
+class SharedMemoryTransferTest : public ::testing::Test {
+ protected:
+  // Starts a server whose elements are `{task_id, tensor of num_floats}`.
+  void StartServer(int64_t num_floats) {
+    TF_ASSERT_OK(DataTransferServer::Build(
+        kSharedMemoryTransferProtocol,
+        [num_floats](const GetElementRequest* request,
+                     GetElementResult* result) {
+          Tensor floats(DT_FLOAT, TensorShape({num_floats}));
+          floats.flat<float>().setConstant(request->task_id());
+          result->components = {test::AsScalar<int64_t>(request->task_id()),
+                                floats};
+          result->element_index = request->task_id();
+          return absl::OkStatus();
+        },
+        &server_));
+    experimental::WorkerConfig config;
+    config.set_protocol("grpc");
+    TF_ASSERT_OK(server_->Start(config));
+  }
+
+  std::unique_ptr<DataTransferClient> CreateClient() {
+    std::unique_ptr<DataTransferClient> client;
+    TF_CHECK_OK(DataTransferClient::Build(
+        kSharedMemoryTransferProtocol,
+        {"grpc", absl::StrCat("localhost:", server_->Port()),
+         /*accelerator_device_info=*/nullptr, /*allocator=*/nullptr},
+        &client));
+    return client;
+  }
+
+  void ExpectElement(DataTransferClient& client, int64_t task_id,
+                     int64_t num_floats) {
+    GetElementRequest request;
+    request.set_task_id(task_id);
+    GetElementResult result;
+    TF_ASSERT_OK(client.GetElement(request, result));
+    EXPECT_EQ(result.element_index, task_id);
+    ASSERT_EQ(result.components.size(), 2);
+    test::ExpectEqual(result.components[0], test::AsScalar<int64_t>(task_id));
+    Tensor floats(DT_FLOAT, TensorShape({num_floats}));
+    floats.flat<float>().setConstant(task_id);
+    test::ExpectEqual(result.components[1], floats);
+  }
+
+  std::shared_ptr<DataTransferServer> server_;
+};
+
+TEST_F(SharedMemoryTransferTest, GetElements) {
+  StartServer(/*num_floats=*/1000);
+  std::unique_ptr<DataTransferClient> client = CreateClient();
+  TF_ASSERT_OK_AND_ASSIGN(std::string info, server_->GetCompatibilityInfo());
+  TF_ASSERT_OK(client->CheckCompatibility(info));
+  // Uses more elements than slots, so slots must be handed back.
+  for (int64_t i = 0; i < 4 * kSharedMemoryNumSlots; ++i) {
+    ExpectElement(*client, i, /*num_floats=*/1000);
+  }
+}
+
+TEST_F(SharedMemoryTransferTest, ManyShortLivedClients) {
+  StartServer(/*num_floats=*/1000);
+  for (int64_t i = 0; i < 2 * kSharedMemoryNumSlots; ++i) {
+    std::unique_ptr<DataTransferClient> client = CreateClient();
+    ExpectElement(*client, i, /*num_floats=*/1000);
+  }
+}
+
+TEST_F(SharedMemoryTransferTest, LargeElementsAreSentInline) {
+  const int64_t num_floats = kSharedMemorySlotSizeBytes / sizeof(float) + 1;
+  StartServer(num_floats);
+  std::unique_ptr<DataTransferClient> client = CreateClient();
+  ExpectElement(*client, /*task_id=*/3, num_floats);
+}
+
+TEST_F(SharedMemoryTransferTest, DifferentHostIsIncompatible) {
+  StartServer(/*num_floats=*/1);
+  std::unique_ptr<DataTransferClient> client = CreateClient();
+  SharedMemoryCompatibilityInfo info;
+  info.set_boot_id("other host");
+  info.set_region("/tf_data_missing");
+  EXPECT_THAT(client->CheckCompatibility(info.SerializeAsString()),
+              StatusIs(error::FAILED_PRECONDITION));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,486 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/snapshot/columnar_chunk.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/snappy.h"
+#include "tensorflow/core/protobuf/snapshot.pb.h"
+#include "tsl/platform/coding.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/tstring.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::data::experimental::ColumnarStripeHeader;
+
+constexpr int64_t kReaderBufferSize = 8 << 20;  // 8MB
+
+ColumnarStripeHeader::ColumnEncoding EncodingForType(DataType dtype) {
+  if (dtype == DT_STRING) {
+    return ColumnarStripeHeader::STRING;
+  }
+  if (dtype == DT_INT64) {
+    return ColumnarStripeHeader::DELTA;
+  }
+  if (DataTypeCanUseMemcpy(dtype)) {
+    return ColumnarStripeHeader::RAW;
+  }
+  return ColumnarStripeHeader::TENSOR_PROTO;
+}
+
+uint64_t ZigZagEncode(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+int64_t ZigZagDecode(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+void EncodeShapes(const std::vector<Tensor>& column, std::string& output) {
+  for (const Tensor& tensor : column) {
+    tsl::core::PutVarint64(&output, tensor.dims());
+    for (int64_t dim : tensor.shape().dim_sizes()) {
+      tsl::core::PutVarint64(&output, dim);
+    }
+  }
+}
+
+void EncodeValues(const std::vector<Tensor>& column,
+                  ColumnarStripeHeader::ColumnEncoding encoding,
+                  std::string& output) {
+  switch (encoding) {
+    case ColumnarStripeHeader::RAW:
+      for (const Tensor& tensor : column) {
+        absl::string_view data = tensor.tensor_data();
+        output.append(data.data(), data.size());
+      }
+      return;
+    case ColumnarStripeHeader::DELTA: {
+      int64_t previous = 0;
+      for (const Tensor& tensor : column) {
+        auto values = tensor.flat<int64_t>();
+        for (int64_t i = 0; i < values.size(); ++i) {
+          tsl::core::PutVarint64(
+              &output, ZigZagEncode(static_cast<int64_t>(
+                           static_cast<uint64_t>(values(i)) -
+                           static_cast<uint64_t>(previous))));
+          previous = values(i);
+        }
+      }
+      return;
+    }
+    case ColumnarStripeHeader::STRING:
+      for (const Tensor& tensor : column) {
+        auto values = tensor.flat<tstring>();
+        for (int64_t i = 0; i < values.size(); ++i) {
+          tsl::core::PutVarint64(&output, values(i).size());
+          output.append(values(i).data(), values(i).size());
+        }
+      }
+      return;
+    default:
+      for (const Tensor& tensor : column) {
+        TensorProto proto;
+        tensor.AsProtoTensorContent(&proto);
+        std::string serialized = proto.SerializeAsString();
+        tsl::core::PutVarint64(&output, serialized.size());
+        output.append(serialized);
+      }
+      return;
+  }
+}
+
+// Encodes `column` as one record, which is Snappy-compressed if that makes it
+// smaller.
+std::string EncodeColumn(const std::vector<Tensor>& column,
+                         ColumnarStripeHeader::Column& metadata) {
+  metadata.set_encoding(EncodingForType(metadata.dtype()));
+  std::string encoded;
+  if (metadata.encoding() != ColumnarStripeHeader::TENSOR_PROTO) {
+    EncodeShapes(column, encoded);
+  }
+  EncodeValues(column, metadata.encoding(), encoded);
+
+  std::string compressed;
+  if (port::Snappy_Compress(encoded.data(), encoded.size(), &compressed) &&
+      compressed.size() < encoded.size()) {
+    metadata.set_snappy_compressed(true);
+    return compressed;
+  }
+  return encoded;
+}
+
+absl::Status Corrupted(absl::string_view what) {
+  return absl::DataLossError(
+      absl::StrCat("Corrupted columnar snapshot chunk: ", what));
+}
+
+absl::Status GetVarint(absl::string_view& input, uint64_t& value) {
+  if (!tsl::core::GetVarint64(&input, &value)) {
+    return Corrupted("truncated varint");
+  }
+  return absl::OkStatus();
+}
+
+absl::Status DecodeShapes(absl::string_view& input, int64_t num_elements,
+                          std::vector<TensorShape>& shapes) {
+  shapes.reserve(num_elements);
+  for (int64_t i = 0; i < num_elements; ++i) {
+    uint64_t rank = 0;
+    TF_RETURN_IF_ERROR(GetVarint(input, rank));
+    TensorShape shape;
+    for (uint64_t d = 0; d < rank; ++d) {
+      uint64_t dim = 0;
+      TF_RETURN_IF_ERROR(GetVarint(input, dim));
+      TF_RETURN_IF_ERROR(shape.AddDimWithStatus(static_cast<int64_t>(dim)));
+    }
+    shapes.push_back(std::move(shape));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status DecodeTensor(absl::string_view& input, DataType dtype,
+                          ColumnarStripeHeader::ColumnEncoding encoding,
+                          const TensorShape& shape, int64_t& previous,
+                          Tensor& tensor) {
+  tensor = Tensor(dtype, shape);
+  switch (encoding) {
+    case ColumnarStripeHeader::RAW: {
+      absl::string_view data = tensor.tensor_data();
+      if (input.size() < data.size()) {
+        return Corrupted("truncated raw column");
+      }
+      std::memcpy(const_cast<char*>(data.data()), input.data(), data.size());
+      input.remove_prefix(data.size());
+      return absl::OkStatus();
+    }
+    case ColumnarStripeHeader::DELTA: {
+      auto values = tensor.flat<int64_t>();
+      for (int64_t i = 0; i < values.size(); ++i) {
+        uint64_t delta = 0;
+        TF_RETURN_IF_ERROR(GetVarint(input, delta));
+        values(i) = static_cast<int64_t>(
+            static_cast<uint64_t>(previous) +
+            static_cast<uint64_t>(ZigZagDecode(delta)));
+        previous = values(i);
+      }
+      return absl::OkStatus();
+    }
+    case ColumnarStripeHeader::STRING: {
+      auto values = tensor.flat<tstring>();
+      for (int64_t i = 0; i < values.size(); ++i) {
+        uint64_t size = 0;
+        TF_RETURN_IF_ERROR(GetVarint(input, size));
+        if (input.size() < size) {
+          return Corrupted("truncated string column");
+        }
+        values(i).assign(input.data(), size);
+        input.remove_prefix(size);
+      }
+      return absl::OkStatus();
+    }
+    default:
+      return Corrupted(absl::StrCat("unexpected encoding ", encoding));
+  }
+}
+
+absl::Status DecodeColumn(const tstring& record, int64_t num_elements,
+                          const ColumnarStripeHeader::Column& metadata,
+                          std::vector<Tensor>& column) {
+  std::string uncompressed;
+  absl::string_view input(record.data(), record.size());
+  if (metadata.snappy_compressed()) {
+    size_t size = 0;
+    if (!port::Snappy_GetUncompressedLength(input.data(), input.size(),
+                                            &size)) {
+      return Corrupted("invalid Snappy column");
+    }
+    uncompressed.resize(size);
+    if (!port::Snappy_Uncompress(input.data(), input.size(),
+                                 uncompressed.data())) {
+      return Corrupted("invalid Snappy column");
+    }
+    input = uncompressed;
+  }
+
+  column.clear();
+  column.reserve(num_elements);
+  if (metadata.encoding() == ColumnarStripeHeader::TENSOR_PROTO) {
+    for (int64_t i = 0; i < num_elements; ++i) {
+      uint64_t size = 0;
+      TF_RETURN_IF_ERROR(GetVarint(input, size));
+      TensorProto proto;
+      Tensor tensor;
+      if (input.size() < size ||
+          !proto.ParseFromArray(input.data(), static_cast<int>(size)) ||
+          !tensor.FromProto(proto)) {
+        return Corrupted("invalid tensor proto");
+      }
+      input.remove_prefix(size);
+      column.push_back(std::move(tensor));
+    }
+  } else {
+    std::vector<TensorShape> shapes;
+    TF_RETURN_IF_ERROR(DecodeShapes(input, num_elements, shapes));
+    int64_t previous = 0;
+    for (const TensorShape& shape : shapes) {
+      Tensor tensor;
+      TF_RETURN_IF_ERROR(DecodeTensor(input, metadata.dtype(),
+                                      metadata.encoding(), shape, previous,
+                                      tensor));
+      column.push_back(std::move(tensor));
+    }
+  }
+  if (!input.empty()) {
+    return Corrupted("trailing bytes in column");
+  }
+  return absl::OkStatus();
+}
+}  // namespace
+
+ColumnarChunkWriter::ColumnarChunkWriter(const std::string& filename,
+                                         int64_t max_stripe_elements)
+    : filename_(filename), max_stripe_elements_(max_stripe_elements) {}
+
+ColumnarChunkWriter::~ColumnarChunkWriter() {
+  if (record_writer_ != nullptr) {
+    absl::Status s = Close();
+    if (!s.ok()) {
+      LOG(ERROR) << "Failed to close columnar snapshot chunk " << filename_
+                 << ": " << s;
+    }
+  }
+}
+
+absl::Status ColumnarChunkWriter::Initialize(tsl::Env* env) {
+  TF_RETURN_IF_ERROR(env->NewAppendableFile(filename_, &dest_));
+  record_writer_ = std::make_unique<io::RecordWriter>(
+      dest_.get(), io::RecordWriterOptions::CreateRecordWriterOptions(
+                       /*compression_type=*/""));
+  return absl::OkStatus();
+}
+
+absl::Status ColumnarChunkWriter::WriteTensors(
+    const std::vector<Tensor>& tensors) {
+  if (record_writer_ == nullptr) {
+    return absl::FailedPreconditionError(absl::StrCat(
+        "Columnar snapshot chunk writer for ", filename_, " is closed."));
+  }
+  if (columns_.empty()) {
+    columns_.resize(tensors.size());
+  }
+  if (tensors.size() != columns_.size()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Columnar snapshot chunks require elements with the same number of "
+        "components. Got ",
+        tensors.size(), " components, expected ", columns_.size(), "."));
+  }
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    if (!columns_[i].empty() &&
+        columns_[i].front().dtype() != tensors[i].dtype()) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Columnar snapshot chunks require components with consistent types. "
+          "Component ",
+          i, " has type ", DataTypeString(tensors[i].dtype()), ", expected ",
+          DataTypeString(columns_[i].front().dtype()), "."));
+    }
+    columns_[i].push_back(tensors[i]);
+  }
+  if (++num_buffered_elements_ >= max_stripe_elements_) {
+    return WriteStripe();
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ColumnarChunkWriter::WriteStripe() {
+  if (num_buffered_elements_ == 0) {
+    return absl::OkStatus();
+  }
+  ColumnarStripeHeader header;
+  header.set_num_elements(num_buffered_elements_);
+  std::vector<std::string> records;
+  records.reserve(columns_.size());
+  for (const std::vector<Tensor>& column : columns_) {
+    ColumnarStripeHeader::Column* metadata = header.add_columns();
+    metadata->set_dtype(column.front().dtype());
+    records.push_back(EncodeColumn(column, *metadata));
+  }
+  TF_RETURN_IF_ERROR(record_writer_->WriteRecord(header.SerializeAsString()));
+  for (const std::string& record : records) {
+    TF_RETURN_IF_ERROR(record_writer_->WriteRecord(record));
+  }
+  for (std::vector<Tensor>& column : columns_) {
+    column.clear();
+  }
+  num_buffered_elements_ = 0;
+  return absl::OkStatus();
+}
+
+absl::Status ColumnarChunkWriter::Sync() {
+  TF_RETURN_IF_ERROR(WriteStripe());
+  TF_RETURN_IF_ERROR(record_writer_->Flush());
+  return dest_->Sync();
+}
+
+absl::Status ColumnarChunkWriter::Close() {
+  if (record_writer_ == nullptr) {
+    return absl::OkStatus();
+  }
+  TF_RETURN_IF_ERROR(WriteStripe());
+  TF_RETURN_IF_ERROR(record_writer_->Close());
+  record_writer_.reset();
+  TF_RETURN_IF_ERROR(dest_->Close());
+  dest_.reset();
+  return absl::OkStatus();
+}
+
+ColumnarChunkReader::ColumnarChunkReader(
+    const std::string& filename,
+    std::optional<std::vector<int64_t>> projection)
+    : filename_(filename), projection_(std::move(projection)) {}
+
+absl::Status ColumnarChunkReader::Initialize(tsl::Env* env) {
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename_, &file_));
+  io::RecordReaderOptions options =
+      io::RecordReaderOptions::CreateRecordReaderOptions(
+          /*compression_type=*/"");
+  options.buffer_size = kReaderBufferSize;
+  record_reader_ =
+      std::make_unique<io::SequentialRecordReader>(file_.get(), options);
+  return absl::OkStatus();
+}
+
+absl::Status ColumnarChunkReader::ReadTensors(
+    std::vector<Tensor>* read_tensors) {
+  if (next_element_index_ >= header_.num_elements()) {
+    TF_RETURN_IF_ERROR(ReadStripeHeader());
+    TF_RETURN_IF_ERROR(ReadStripeColumns());
+  }
+  read_tensors->clear();
+  read_tensors->reserve(columns_.size());
+  for (std::vector<Tensor>& column : columns_) {
+    read_tensors->push_back(std::move(column[next_element_index_]));
+  }
+  ++next_element_index_;
+  return absl::OkStatus();
+}
+
+absl::Status ColumnarChunkReader::SkipRecords(int64_t num_records) {
+  while (num_records > 0) {
+    int64_t remaining = header_.num_elements() - next_element_index_;
+    if (remaining > 0) {
+      int64_t num_skipped = std::min(remaining, num_records);
+      next_element_index_ += num_skipped;
+      num_records -= num_skipped;
+      continue;
+    }
+    TF_RETURN_IF_ERROR(ReadStripeHeader());
+    if (header_.num_elements() <= num_records) {
+      TF_RETURN_IF_ERROR(SkipStripeColumns());
+      num_records -= header_.num_elements();
+      next_element_index_ = header_.num_elements();
+    } else {
+      TF_RETURN_IF_ERROR(ReadStripeColumns());
+    }
+  }
+  return absl::OkStatus();
+}
+
+uint64_t ColumnarChunkReader::BytesRead() const {
+  return record_reader_ == nullptr ? 0 : record_reader_->TellOffset();
+}
+
+absl::Status ColumnarChunkReader::ReadStripeHeader() {
+  tstring record;
+  TF_RETURN_IF_ERROR(record_reader_->ReadRecord(&record));
+  if (!header_.ParseFromArray(record.data(), record.size()) ||
+      header_.num_elements() <= 0) {
+    return Corrupted(absl::StrCat("invalid stripe header in ", filename_));
+  }
+  next_element_index_ = 0;
+  return absl::OkStatus();
+}
+
+absl::Status ColumnarChunkReader::ReadStripeColumns() {
+  const int64_t num_columns = header_.columns_size();
+  std::vector<int64_t> projection;
+  if (projection_.has_value()) {
+    projection = *projection_;
+  } else {
+    for (int64_t i = 0; i < num_columns; ++i) {
+      projection.push_back(i);
+    }
+  }
+
+  std::vector<std::vector<Tensor>> columns(num_columns);
+  std::vector<bool> projected(num_columns, false);
+  for (int64_t index : projection) {
+    if (index < 0 || index >= num_columns) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Projected component ", index, " is out of range for snapshot chunk ",
+          filename_, " with ", num_columns, " components."));
+    }
+    projected[index] = true;
+  }
+  tstring record;
+  for (int64_t i = 0; i < num_columns; ++i) {
+    if (!projected[i]) {
+      int num_skipped = 0;
+      TF_RETURN_IF_ERROR(
+          record_reader_->SkipRecords(/*num_to_skip=*/1, &num_skipped));
+      continue;
+    }
+    TF_RETURN_IF_ERROR(record_reader_->ReadRecord(&record));
+    TF_RETURN_IF_ERROR(DecodeColumn(record, header_.num_elements(),
+                                    header_.columns(i), columns[i]));
+  }
+
+  columns_.clear();
+  columns_.reserve(projection.size());
+  for (int64_t index : projection) {
+    columns_.push_back(columns[index]);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ColumnarChunkReader::SkipStripeColumns() {
+  int num_skipped = 0;
+  return record_reader_->SkipRecords(header_.columns_size(), &num_skipped);
+}
+
+}  // namespace data
+}  // namespace tensorflow
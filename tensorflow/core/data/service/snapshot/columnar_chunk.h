@@ -0,0 +1,135 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_COLUMNAR_CHUNK_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_COLUMNAR_CHUNK_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "tensorflow/core/data/snapshot_utils.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/protobuf/snapshot.pb.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/file_system.h"
+
+namespace tensorflow {
+namespace data {
+
+// Writes snapshot chunks in the columnar format.
+//
+// Elements are buffered and written in stripes. Each stripe is one
+// `ColumnarStripeHeader` record followed by one record per element component
+// ("column"), holding that component for every element of the stripe. Columns
+// are encoded by type (raw bytes, delta-encoded int64s, length-prefixed
+// strings, or serialized `TensorProto`s as a fallback) and are individually
+// Snappy-compressed when that makes them smaller. Since each column is its own
+// record, `ColumnarChunkReader` can skip the components it does not need
+// without decoding them.
+//
+// All elements must have the same number of components and the same dtype for
+// each component. Shapes may vary across elements.
+class ColumnarChunkWriter : public snapshot_util::Writer {
+ public:
+  static constexpr int64_t kDefaultMaxStripeElements = 1024;
+
+  explicit ColumnarChunkWriter(
+      const std::string& filename,
+      int64_t max_stripe_elements = kDefaultMaxStripeElements);
+  ~ColumnarChunkWriter() override;
+
+  absl::Status Initialize(tsl::Env* env) override;
+
+  // Buffers `tensors`, writing a stripe once `max_stripe_elements` elements
+  // are buffered.
+  absl::Status WriteTensors(const std::vector<Tensor>& tensors) override;
+
+  // Writes the buffered elements as a (possibly short) stripe and flushes the
+  // file.
+  absl::Status Sync() override;
+
+  absl::Status Close() override;
+
+ private:
+  // Writes the buffered elements as one stripe.
+  absl::Status WriteStripe();
+
+  const std::string filename_;
+  const int64_t max_stripe_elements_;
+
+  std::unique_ptr<tsl::WritableFile> dest_;
+  std::unique_ptr<io::RecordWriter> record_writer_;
+
+  // Elements of the current stripe, indexed by component, then by element.
+  std::vector<std::vector<Tensor>> columns_;
+  int64_t num_buffered_elements_ = 0;
+};
+
+// Reads snapshot chunks written by `ColumnarChunkWriter`.
+//
+// If `projection` is set, only the listed component indices are decoded and
+// returned, in the listed order. The other columns are skipped.
+class ColumnarChunkReader : public snapshot_util::Reader {
+ public:
+  explicit ColumnarChunkReader(
+      const std::string& filename,
+      std::optional<std::vector<int64_t>> projection = std::nullopt);
+
+  absl::Status Initialize(tsl::Env* env) override;
+
+  // Reads the next element into `read_tensors`. Returns OutOfRange at the end
+  // of the file.
+  absl::Status ReadTensors(std::vector<Tensor>* read_tensors) override;
+
+  // Skips `num_records` elements. Stripes that are skipped entirely are not
+  // decoded.
+  absl::Status SkipRecords(int64_t num_records) override;
+
+  // Returns the number of bytes read, including skipped columns.
+  uint64_t BytesRead() const;
+
+ private:
+  // Reads the header of the next stripe into `header_`.
+  absl::Status ReadStripeHeader();
+
+  // Reads and decodes the projected columns of the stripe whose header has
+  // been read.
+  absl::Status ReadStripeColumns();
+
+  // Skips the column records of the stripe whose header has been read.
+  absl::Status SkipStripeColumns();
+
+  const std::string filename_;
+  const std::optional<std::vector<int64_t>> projection_;
+
+  std::unique_ptr<tsl::RandomAccessFile> file_;
+  std::unique_ptr<io::SequentialRecordReader> record_reader_;
+
+  experimental::ColumnarStripeHeader header_;
+  // Decoded projected columns of the current stripe.
+  std::vector<std::vector<Tensor>> columns_;
+  // Index of the next element to return from the current stripe.
+  int64_t next_element_index_ = 0;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_COLUMNAR_CHUNK_H_
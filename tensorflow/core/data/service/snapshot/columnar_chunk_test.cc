@@ -0,0 +1,187 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/snapshot/columnar_chunk.h"
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/status_matchers.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tsl::testing::StatusIs;
+
+absl::StatusOr<std::string> TestFile() {
+  std::string filename;
+  if (!tsl::Env::Default()->LocalTempFilename(&filename)) {
+    return absl::FailedPreconditionError("Failed to create local temp file.");
+  }
+  return filename;
+}
+
+// Element `i` is {i * 1000 (int64), [i, i + 0.5] (float), "element_i"}.
+std::vector<Tensor> TestElement(int64_t i) {
+  return {Tensor(i * 1000),
+          test::AsTensor<float>({static_cast<float>(i), i + 0.5f}, {2}),
+          Tensor(tstring(absl::StrCat("element_", i)))};
+}
+
+absl::Status WriteElements(const std::string& filename, int64_t num_elements,
+                           int64_t max_stripe_elements) {
+  ColumnarChunkWriter writer(filename, max_stripe_elements);
+  TF_RETURN_IF_ERROR(writer.Initialize(tsl::Env::Default()));
+  for (int64_t i = 0; i < num_elements; ++i) {
+    TF_RETURN_IF_ERROR(writer.WriteTensors(TestElement(i)));
+  }
+  return writer.Close();
+}
+
+absl::StatusOr<std::vector<std::vector<Tensor>>> ReadElements(
+    ColumnarChunkReader& reader) {
+  std::vector<std::vector<Tensor>> elements;
+  while (true) {
+    std::vector<Tensor> element;
+    absl::Status status = reader.ReadTensors(&element);
+    if (absl::IsOutOfRange(status)) {
+      return elements;
+    }
+    TF_RETURN_IF_ERROR(status);
+    elements.push_back(std::move(element));
+  }
+}
+
+class ColumnarChunkParameterizedTest
+    : public ::testing::TestWithParam<int64_t> {
+ protected:
+  int64_t MaxStripeElements() const { return GetParam(); }
+};
+
+TEST_P(ColumnarChunkParameterizedTest, ReadAllColumns) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string filename, TestFile());
+  TF_ASSERT_OK(WriteElements(filename, /*num_elements=*/10,
+                             MaxStripeElements()));
+
+  ColumnarChunkReader reader(filename);
+  TF_ASSERT_OK(reader.Initialize(tsl::Env::Default()));
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<std::vector<Tensor>> elements,
+                          ReadElements(reader));
+  ASSERT_EQ(elements.size(), 10);
+  for (int64_t i = 0; i < elements.size(); ++i) {
+    std::vector<Tensor> expected = TestElement(i);
+    ASSERT_EQ(elements[i].size(), expected.size());
+    for (int64_t j = 0; j < expected.size(); ++j) {
+      test::ExpectEqual(elements[i][j], expected[j]);
+    }
+  }
+}
+
+TEST_P(ColumnarChunkParameterizedTest, ReadProjectedColumns) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string filename, TestFile());
+  TF_ASSERT_OK(WriteElements(filename, /*num_elements=*/10,
+                             MaxStripeElements()));
+
+  ColumnarChunkReader reader(filename, std::vector<int64_t>{2, 0});
+  TF_ASSERT_OK(reader.Initialize(tsl::Env::Default()));
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<std::vector<Tensor>> elements,
+                          ReadElements(reader));
+  ASSERT_EQ(elements.size(), 10);
+  for (int64_t i = 0; i < elements.size(); ++i) {
+    std::vector<Tensor> expected = TestElement(i);
+    ASSERT_EQ(elements[i].size(), 2);
+    test::ExpectEqual(elements[i][0], expected[2]);
+    test::ExpectEqual(elements[i][1], expected[0]);
+  }
+}
+
+TEST_P(ColumnarChunkParameterizedTest, SkipRecords) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string filename, TestFile());
+  TF_ASSERT_OK(WriteElements(filename, /*num_elements=*/10,
+                             MaxStripeElements()));
+
+  ColumnarChunkReader reader(filename);
+  TF_ASSERT_OK(reader.Initialize(tsl::Env::Default()));
+  TF_ASSERT_OK(reader.SkipRecords(7));
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<std::vector<Tensor>> elements,
+                          ReadElements(reader));
+  ASSERT_EQ(elements.size(), 3);
+  test::ExpectEqual(elements[0][0], Tensor(int64_t{7000}));
+  EXPECT_THAT(reader.SkipRecords(1), StatusIs(absl::StatusCode::kOutOfRange));
+}
+
+INSTANTIATE_TEST_SUITE_P(MaxStripeElements, ColumnarChunkParameterizedTest,
+                         ::testing::Values(1, 3, 1024));
+
+TEST(ColumnarChunkTest, NegativeDeltas) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string filename, TestFile());
+  ColumnarChunkWriter writer(filename);
+  TF_ASSERT_OK(writer.Initialize(tsl::Env::Default()));
+  std::vector<int64_t> values = {5, -3, std::numeric_limits<int64_t>::max(),
+                                 std::numeric_limits<int64_t>::min(), 0};
+  for (int64_t value : values) {
+    TF_ASSERT_OK(writer.WriteTensors({Tensor(value)}));
+  }
+  TF_ASSERT_OK(writer.Close());
+
+  ColumnarChunkReader reader(filename);
+  TF_ASSERT_OK(reader.Initialize(tsl::Env::Default()));
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<std::vector<Tensor>> elements,
+                          ReadElements(reader));
+  ASSERT_EQ(elements.size(), values.size());
+  for (int64_t i = 0; i < values.size(); ++i) {
+    test::ExpectEqual(elements[i][0], Tensor(values[i]));
+  }
+}
+
+TEST(ColumnarChunkTest, InconsistentComponents) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string filename, TestFile());
+  ColumnarChunkWriter writer(filename);
+  TF_ASSERT_OK(writer.Initialize(tsl::Env::Default()));
+  TF_ASSERT_OK(writer.WriteTensors({Tensor(int64_t{1})}));
+  EXPECT_THAT(writer.WriteTensors({Tensor(int64_t{1}), Tensor(int64_t{2})}),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(writer.WriteTensors({Tensor(1.0f)}),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(ColumnarChunkTest, ProjectionOutOfRange) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string filename, TestFile());
+  TF_ASSERT_OK(WriteElements(filename, /*num_elements=*/1,
+                             /*max_stripe_elements=*/1));
+
+  ColumnarChunkReader reader(filename, std::vector<int64_t>{3});
+  TF_ASSERT_OK(reader.Initialize(tsl::Env::Default()));
+  std::vector<Tensor> element;
+  EXPECT_THAT(reader.ReadTensors(&element),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -29,9 +29,11 @@ limitations under the License.
 #include "absl/strings/str_cat.h"
 #include "absl/synchronization/mutex.h"
 #include "tensorflow/core/data/service/byte_size.h"
+#include "tensorflow/core/data/service/snapshot/columnar_chunk.h"
 #include "tensorflow/core/data/service/snapshot/utils.h"
 #include "tensorflow/core/data/snapshot_utils.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/protobuf/snapshot.pb.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/path.h"
@@ -48,12 +50,14 @@ ParallelTFRecordWriter::ParallelTFRecordWriter(const std::string& file_prefix,
                                                tsl::Env* env,
                                                ByteSize max_file_size,
                                                int64_t num_write_threads,
-                                               int64_t buffer_size)
+                                               int64_t buffer_size,
+                                               ChunkFormat chunk_format)
     : env_(env),
       file_prefix_(file_prefix),
       compression_(compression),
       max_file_size_(max_file_size),
-      buffer_size_(buffer_size) {
+      buffer_size_(buffer_size),
+      chunk_format_(chunk_format) {
   thread_pool_ = std::make_unique<tsl::thread::ThreadPool>(
       env_, tsl::ThreadOptions{}, "write_tfrecord_thread", num_write_threads);
   for (int64_t i = 0; i < num_write_threads; ++i) {
@@ -116,15 +120,28 @@ bool ParallelTFRecordWriter::HasNext() const ABSL_LOCKS_EXCLUDED(mu_) {
 
 absl::Status ParallelTFRecordWriter::WriteFile() ABSL_LOCKS_EXCLUDED(mu_) {
   TF_ASSIGN_OR_RETURN(const std::string filename, GetUniqueFile());
-  snapshot_util::TFRecordWriter writer(filename, compression_);
-  TF_RETURN_IF_ERROR(writer.Initialize(env_));
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<snapshot_util::Writer> writer,
+                      CreateFileWriter(filename));
   while (ShouldWriteFile(filename)) {
-    TF_RETURN_IF_ERROR(WriteRecord(filename, writer));
+    TF_RETURN_IF_ERROR(WriteRecord(filename, *writer));
   }
-  TF_RETURN_IF_ERROR(writer.Close());
+  TF_RETURN_IF_ERROR(writer->Close());
   return DeleteEmptyFile(filename);
 }
 
+absl::StatusOr<std::unique_ptr<snapshot_util::Writer>>
+ParallelTFRecordWriter::CreateFileWriter(const std::string& filename) const {
+  if (chunk_format_ == experimental::DistributedSnapshotMetadata::COLUMNAR) {
+    auto writer = std::make_unique<ColumnarChunkWriter>(filename);
+    TF_RETURN_IF_ERROR(writer->Initialize(env_));
+    return writer;
+  }
+  auto writer =
+      std::make_unique<snapshot_util::TFRecordWriter>(filename, compression_);
+  TF_RETURN_IF_ERROR(writer->Initialize(env_));
+  return writer;
+}
+
 bool ParallelTFRecordWriter::ShouldWriteFile(const std::string& filename) const
     ABSL_LOCKS_EXCLUDED(mu_) {
   if (!HasNext()) {
@@ -137,7 +154,7 @@ bool ParallelTFRecordWriter::ShouldWriteFile(const std::string& filename) const
 }
 
 absl::Status ParallelTFRecordWriter::WriteRecord(
-    const std::string& filename, snapshot_util::TFRecordWriter& writer) {
+    const std::string& filename, snapshot_util::Writer& writer) {
   TF_ASSIGN_OR_RETURN(std::optional<std::vector<Tensor>> record,
                       GetNextRecord(filename));
   if (!record.has_value()) {
@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/byte_size.h"
 #include "tensorflow/core/data/snapshot_utils.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/protobuf/snapshot.pb.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/threadpool.h"
 
@@ -40,6 +41,9 @@ namespace data {
 // waiting for the file writes, and it writes one shard of file per thread.
 // Returns the file names when writes are finished. This class is thread-safe.
 //
+// If `chunk_format` is `COLUMNAR`, files are written by `ColumnarChunkWriter`,
+// which compresses each column individually and ignores `compression`.
+//
 // Usage example:
 //
 // ParallelTFRecordWriter writer(
@@ -56,11 +60,16 @@ namespace data {
 //                     writer.Finalize());
 class ParallelTFRecordWriter {
  public:
+  using ChunkFormat = experimental::DistributedSnapshotMetadata::ChunkFormat;
+  static constexpr ChunkFormat kTFRecord =
+      experimental::DistributedSnapshotMetadata::TFRECORD;
+
   explicit ParallelTFRecordWriter(const std::string& file_prefix,
                                   const std::string& compression, tsl::Env* env,
                                   ByteSize max_file_size = ByteSize::GB(6),
                                   int64_t num_write_threads = 2,
-                                  int64_t buffer_size = 1);
+                                  int64_t buffer_size = 1,
+                                  ChunkFormat chunk_format = kTFRecord);
   virtual ~ParallelTFRecordWriter();
   ParallelTFRecordWriter(const ParallelTFRecordWriter&) = delete;
   ParallelTFRecordWriter& operator=(const ParallelTFRecordWriter&) = delete;
@@ -97,9 +106,13 @@ class ParallelTFRecordWriter {
   // Whether the file can hold more records without exceeding `max_file_size_`.
   bool ShouldWriteFile(const std::string& filename) const;
 
+  // Creates and initializes the writer for a new file.
+  absl::StatusOr<std::unique_ptr<snapshot_util::Writer>> CreateFileWriter(
+      const std::string& filename) const;
+
   // Writes one record to file.
   absl::Status WriteRecord(const std::string& filename,
-                           snapshot_util::TFRecordWriter& writer);
+                           snapshot_util::Writer& writer);
 
   // Gets the next record from the buffer to write. Returns `std::nullopt` if
   // there are no more records to write.
@@ -120,6 +133,7 @@ class ParallelTFRecordWriter {
   const std::string compression_;
   const ByteSize max_file_size_;
   const int64_t buffer_size_;
+  const ChunkFormat chunk_format_;
 
   mutable absl::Mutex mu_;
   mutable absl::CondVar ready_to_push_;
@@ -31,8 +31,10 @@ limitations under the License.
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/service/byte_size.h"
+#include "tensorflow/core/data/service/snapshot/columnar_chunk.h"
 #include "tensorflow/core/data/snapshot_utils.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/protobuf/snapshot.pb.h"
 #include "tsl/lib/core/status_test_util.h"
 #include "tsl/lib/io/compression.h"
 #include "tsl/platform/env.h"
@@ -283,6 +285,32 @@ TEST(ParallelTFRecordWriterTest, WriteNoRecord) {
               IsOkAndHolds(IsEmpty()));
 }
 
+TEST(ParallelTFRecordWriterTest, WriteColumnarChunks) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string test_dir, TestDir());
+  ParallelTFRecordWriter parallel_tfrecord_writer(
+      test_dir, tsl::io::compression::kNone, tsl::Env::Default(),
+      ByteSize::GB(1), /*num_write_threads=*/2, /*buffer_size=*/1,
+      experimental::DistributedSnapshotMetadata::COLUMNAR);
+
+  RangeIterator range_iterator(100);
+  TF_ASSERT_OK_AND_ASSIGN(
+      ParallelTFRecordWriter::FileToStatsMap file_stats,
+      WriteRecords(parallel_tfrecord_writer, range_iterator));
+
+  std::vector<int64_t> result;
+  for (const auto& [file, stats] : file_stats) {
+    ColumnarChunkReader reader(file);
+    TF_ASSERT_OK(reader.Initialize(tsl::Env::Default()));
+    std::vector<Tensor> record;
+    absl::Status status;
+    while ((status = reader.ReadTensors(&record)).ok()) {
+      result.push_back(record[0].scalar<int64_t>()());
+    }
+    EXPECT_THAT(status, StatusIs(absl::StatusCode::kOutOfRange));
+  }
+  EXPECT_THAT(result, UnorderedElementsAreArray(Range(100)));
+}
+
 TEST(ParallelTFRecordWriterTest, CannotWriteFinalizedWriter) {
   TF_ASSERT_OK_AND_ASSIGN(std::string test_dir, TestDir());
   std::string file_prefix = "file";
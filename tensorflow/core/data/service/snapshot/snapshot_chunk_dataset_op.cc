@@ -14,17 +14,21 @@ limitations under the License.
 ==============================================================================*/
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/service/snapshot/columnar_chunk.h"
 #include "tensorflow/core/data/snapshot_utils.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
@@ -39,11 +43,15 @@ namespace {
 
 constexpr const char* const kChunkFile = "chunk_file";
 constexpr const char* const kCompression = "compression";
+constexpr const char* const kChunkFormat = "chunk_format";
+constexpr const char* const kProjection = "projection";
 constexpr const char* const kStartIndex = "start_index";
 constexpr const char* const kOutputTypes = "output_types";
 constexpr const char* const kOutputShapes = "output_shapes";
 constexpr const char* const kSnapshotChunkDataset = "SnapshotChunkDataset";
 
+constexpr const char* const kColumnar = "COLUMNAR";
+
 constexpr int64_t kTFRecordReaderOutputBufferSize = 512 << 20;  // 512MB
 
 absl::string_view GetSnapshotPath(absl::string_view chunk_file) {
@@ -66,16 +74,21 @@ class SnapshotChunkDatasetOp : public DatasetOpKernel {
   DataTypeVector output_types_;
   std::vector<PartialTensorShape> output_shapes_;
   std::string compression_;
+  std::string chunk_format_;
+  std::vector<int64_t> projection_;
 };
 
 class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
  public:
   Dataset(DatasetContext&& ctx, const std::string& chunk_file,
-          const std::string& compression, const DataTypeVector& dtypes,
+          const std::string& compression, const std::string& chunk_format,
+          const std::vector<int64_t>& projection, const DataTypeVector& dtypes,
           const std::vector<PartialTensorShape>& shapes)
       : DatasetBase(std::move(ctx)),
         chunk_file_(chunk_file),
         compression_(compression),
+        chunk_format_(chunk_format),
+        projection_(projection),
         dtypes_(dtypes),
         shapes_(shapes) {}
 
@@ -103,13 +116,19 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
 
     AttrValue compression;
     b->BuildAttrValue(compression_, &compression);
+    AttrValue chunk_format;
+    b->BuildAttrValue(chunk_format_, &chunk_format);
+    AttrValue projection;
+    b->BuildAttrValue(projection_, &projection);
 
     return b->AddDataset(this,
                          /*inputs=*/
                          {std::make_pair(0, chunk_file)},
                          /*list_inputs=*/{},
                          /*attrs=*/
-                         {{kCompression, compression}},
+                         {{kCompression, compression},
+                          {kChunkFormat, chunk_format},
+                          {kProjection, projection}},
                          /*use_dataset_name=*/true, output);
   }
 
@@ -128,13 +147,32 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
     ~Iterator() override { RecordBytesRead(); }
 
     absl::Status Initialize(IteratorContext* ctx) override {
-      reader_ = std::make_unique<snapshot_util::TFRecordReader>(
-          TranslateFileName(dataset()->chunk_file_), dataset()->compression_,
-          dataset()->dtypes_, kTFRecordReaderOutputBufferSize);
-      return reader_->Initialize(ctx->env());
+      const std::string chunk_file = TranslateFileName(dataset()->chunk_file_);
+      if (dataset()->chunk_format_ == kColumnar) {
+        std::optional<std::vector<int64_t>> projection;
+        if (!dataset()->projection_.empty()) {
+          projection = dataset()->projection_;
+        }
+        columnar_reader_ =
+            std::make_unique<ColumnarChunkReader>(chunk_file, projection);
+        TF_RETURN_IF_ERROR(columnar_reader_->Initialize(ctx->env()));
+        reader_ = columnar_reader_.get();
+        return absl::OkStatus();
+      }
+      tfrecord_reader_ = std::make_unique<snapshot_util::TFRecordReader>(
+          chunk_file, dataset()->compression_, dataset()->dtypes_,
+          kTFRecordReaderOutputBufferSize);
+      TF_RETURN_IF_ERROR(tfrecord_reader_->Initialize(ctx->env()));
+      reader_ = tfrecord_reader_.get();
+      return absl::OkStatus();
     }
 
    protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeSourceNode(std::move(args));
+    }
+
     absl::Status GetNextInternal(IteratorContext* ctx,
                                  std::vector<Tensor>* out_tensors,
                                  bool* end_of_sequence) override {
@@ -167,29 +205,36 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
     }
 
    private:
-    // TODO(b/250921378): Optimize this to not parse every single element. We
-    // may consider switching the data format to ArrayRecords so we can use the
-    // index to jump straight to the starting record.
+    // TODO(b/250921378): Optimize this to not parse every single element of
+    // TFRecord chunks. We may consider switching the data format to
+    // ArrayRecords so we can use the index to jump straight to the starting
+    // record. Columnar chunks skip whole stripes without decoding them.
     absl::Status AdvanceToStartIndex(IteratorContext* ctx) {
-      for (int64_t i = 0; i < start_index_; ++i) {
-        std::vector<Tensor> unused;
-        TF_RETURN_IF_ERROR(reader_->ReadTensors(&unused));
-      }
-      return absl::OkStatus();
+      return reader_->SkipRecords(start_index_);
     }
 
     void RecordBytesRead() {
-      uint64_t bytes_read = reader_->BytesRead();
+      uint64_t bytes_read = 0;
+      if (tfrecord_reader_ != nullptr) {
+        bytes_read = tfrecord_reader_->BytesRead();
+      } else if (columnar_reader_ != nullptr) {
+        bytes_read = columnar_reader_->BytesRead();
+      }
       metrics::GetTFDataBytesReadCounter(kSnapshotChunkDataset)
           ->IncrementBy(bytes_read);
     }
 
-    std::unique_ptr<snapshot_util::TFRecordReader> reader_;
+    std::unique_ptr<snapshot_util::TFRecordReader> tfrecord_reader_;
+    std::unique_ptr<ColumnarChunkReader> columnar_reader_;
+    // Points to whichever of the readers above is used by the chunk format.
+    snapshot_util::Reader* reader_ = nullptr;
     int64_t start_index_ = 0;
   };
 
   const tstring chunk_file_;
   const tstring compression_;
+  const std::string chunk_format_;
+  const std::vector<int64_t> projection_;
   const DataTypeVector dtypes_;
   const std::vector<PartialTensorShape> shapes_;
 };
@@ -199,6 +244,16 @@ SnapshotChunkDatasetOp::SnapshotChunkDatasetOp(OpKernelConstruction* ctx)
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kCompression, &compression_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kChunkFormat, &chunk_format_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kProjection, &projection_));
+  OP_REQUIRES(ctx, projection_.empty() || chunk_format_ == kColumnar,
+              absl::InvalidArgumentError(absl::StrCat(
+                  "Projected reads require ", kColumnar, " snapshot chunks.")));
+  OP_REQUIRES(
+      ctx, projection_.empty() || projection_.size() == output_types_.size(),
+      absl::InvalidArgumentError(absl::StrCat(
+          "Snapshot chunk projection has ", projection_.size(),
+          " components, but output_types has ", output_types_.size(), ".")));
 }
 
 void SnapshotChunkDatasetOp::MakeDataset(OpKernelContext* ctx,
@@ -206,9 +261,9 @@ void SnapshotChunkDatasetOp::MakeDataset(OpKernelContext* ctx,
   tstring chunk_file;
   OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, kChunkFile, &chunk_file));
 
-  *output = new SnapshotChunkDatasetOp::Dataset(DatasetContext(ctx), chunk_file,
-                                                compression_, output_types_,
-                                                output_shapes_);
+  *output = new SnapshotChunkDatasetOp::Dataset(
+      DatasetContext(ctx), chunk_file, compression_, chunk_format_,
+      projection_, output_types_, output_shapes_);
   metrics::RecordTFDataServiceSnapshotOp(
       std::string(GetSnapshotPath(chunk_file)), kSnapshotChunkDataset);
 }
@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/worker.pb.h"
 #include "tensorflow/core/data/snapshot_utils.h"
 #include "tensorflow/core/protobuf/service_config.pb.h"
+#include "tensorflow/core/protobuf/snapshot.pb.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/mutex.h"
 #include "tsl/platform/thread_annotations.h"
@@ -73,6 +74,10 @@ struct SnapshotWriterParams {
   // snapshot. Used only for unit testing.
   bool test_only_keep_temp_files = false;
 
+  // File format of the chunks.
+  experimental::DistributedSnapshotMetadata::ChunkFormat chunk_format =
+      experimental::DistributedSnapshotMetadata::TFRECORD;
+
   std::string StreamDirectory() const {
     return tensorflow::data::StreamDirectory(snapshot_path, stream_index);
   }
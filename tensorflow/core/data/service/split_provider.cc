@@ -15,9 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/split_provider.h"
 
+#include <cstdint>
 #include <functional>
+#include <iterator>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/core/data/service/common.pb.h"
@@ -41,6 +44,22 @@ Status DataServiceSplitProvider::GetNext(Tensor* split, bool* end_of_splits)
     dispatcher_ =
         std::make_unique<DataServiceDispatcherClient>(address_, protocol_);
   }
+  if (max_splits_ > 1) {
+    if (buffered_splits_.empty() && !buffered_end_of_splits_) {
+      TF_RETURN_IF_ERROR(LeaseSplits());
+    }
+    if (buffered_splits_.empty()) {
+      buffered_end_of_splits_ = false;
+      *end_of_splits = true;
+      VLOG(1) << "Reached end of splits for iteration_id=" << iteration_id_
+              << ", repetition=" << repetition_;
+      return absl::OkStatus();
+    }
+    *split = std::move(buffered_splits_.front());
+    buffered_splits_.pop_front();
+    *end_of_splits = false;
+    return absl::OkStatus();
+  }
   TF_RETURN_IF_ERROR(grpc_util::Retry(
       [this, split, end_of_splits]() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         return dispatcher_->GetSplit(iteration_id_, repetition_,
@@ -61,9 +80,40 @@ Status DataServiceSplitProvider::GetNext(Tensor* split, bool* end_of_splits)
   return absl::OkStatus();
 }
 
+Status DataServiceSplitProvider::LeaseSplits()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  std::vector<Tensor> splits;
+  int64_t lease_id = 0;
+  bool end_of_splits = false;
+  TF_RETURN_IF_ERROR(grpc_util::Retry(
+      [&]() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        splits.clear();
+        return dispatcher_->GetSplits(
+            iteration_id_, repetition_, split_provider_index_, max_splits_,
+            /*completed_lease_id=*/lease_id_, worker_address_, splits,
+            lease_id, end_of_splits);
+      },
+      "lease splits",
+      /*deadline_micros=*/Env::Default()->NowMicros() +
+          (timeout_ms_ * EnvTime::kMillisToMicros)));
+  VLOG(1) << "Leased " << splits.size() << " splits with lease " << lease_id
+          << "; with iteration_id=" << iteration_id_
+          << ", repetition=" << repetition_;
+  lease_id_ = lease_id;
+  buffered_splits_.insert(buffered_splits_.end(),
+                          std::make_move_iterator(splits.begin()),
+                          std::make_move_iterator(splits.end()));
+  buffered_end_of_splits_ = end_of_splits;
+  return absl::OkStatus();
+}
+
 Status DataServiceSplitProvider::Reset() TF_LOCKS_EXCLUDED(mu_) {
   mutex_lock l(mu_);
   repetition_++;
+  // Splits of the previous repetition are no longer needed. They count as
+  // consumed when completing their lease.
+  buffered_splits_.clear();
+  buffered_end_of_splits_ = false;
   return absl::OkStatus();
 }
 
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_SPLIT_PROVIDER_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_SPLIT_PROVIDER_H_
 
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <string>
@@ -33,16 +35,23 @@ namespace tensorflow {
 namespace data {
 
 // SplitProvider which reads splits from a tf.data service dispatcher over RPC.
+//
+// If `max_splits` is greater than 1, leases up to `max_splits` splits per
+// request on behalf of the worker at `worker_address`, and buffers them.
 class DataServiceSplitProvider : public SplitProvider {
  public:
   DataServiceSplitProvider(const std::string& address,
                            const std::string& protocol, int64_t iteration_id,
-                           int64_t split_provider_index, int64_t timeout_ms)
+                           int64_t split_provider_index, int64_t timeout_ms,
+                           int64_t max_splits = 1,
+                           const std::string& worker_address = "")
       : address_(address),
         protocol_(protocol),
         iteration_id_(iteration_id),
         split_provider_index_(split_provider_index),
-        timeout_ms_(timeout_ms) {}
+        timeout_ms_(timeout_ms),
+        max_splits_(max_splits),
+        worker_address_(worker_address) {}
 
   Status GetNext(Tensor* split, bool* end_of_splits) override;
   Status Reset() override;
@@ -57,10 +66,22 @@ class DataServiceSplitProvider : public SplitProvider {
   const int64_t iteration_id_;
   const int64_t split_provider_index_;
   const int64_t timeout_ms_;
+  const int64_t max_splits_;
+  const std::string worker_address_;
+
+  // Leases a batch of splits into `buffered_splits_`.
+  Status LeaseSplits() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   mutex mu_;
   int64_t repetition_ TF_GUARDED_BY(mu_) = 0;
   std::unique_ptr<DataServiceDispatcherClient> dispatcher_ TF_GUARDED_BY(mu_);
+  // Leased splits which have not been returned yet.
+  std::deque<Tensor> buffered_splits_ TF_GUARDED_BY(mu_);
+  // Whether the split provider reached its end after `buffered_splits_`.
+  bool buffered_end_of_splits_ TF_GUARDED_BY(mu_) = false;
+  // The lease of the last batch, reported to the dispatcher as completed with
+  // the next request.
+  int64_t lease_id_ TF_GUARDED_BY(mu_) = 0;
 };
 
 // Makes split providers for `dataset_def` and stores them in `split_providers`.
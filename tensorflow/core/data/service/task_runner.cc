@@ -17,10 +17,13 @@ limitations under the License.
 #include <algorithm>
 #include <memory>
 #include <optional>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/service/byte_size.h"
+#include "tensorflow/core/data/service/cache_spill_log.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/cross_trainer_cache.h"
 #include "tensorflow/core/data/service/data_transfer.h"
@@ -29,13 +32,18 @@ limitations under the License.
 #include "tensorflow/core/data/standalone.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/dataset.pb.h"
 #include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -48,6 +56,10 @@ namespace {
 constexpr int64_t kWaitBeforeSkipUs = 100 * 1000;  // 100ms.
 constexpr size_t kDefaultCrossTrainerCacheSizeBytes =
     10 * (size_t{1} << 30);  // 10GB
+constexpr size_t kDefaultCrossTrainerCacheSpillSizeBytes =
+    100 * (size_t{1} << 30);  // 100GB
+constexpr size_t kCrossTrainerCacheSpillSegmentSizeBytes =
+    64 * (size_t{1} << 20);  // 64MB
 
 }  // namespace
 
@@ -100,18 +112,35 @@ Status TaskRunner::Create(const experimental::WorkerConfig& worker_config,
         worker_config.cross_trainer_cache_size_bytes() > 0
             ? worker_config.cross_trainer_cache_size_bytes()
             : kDefaultCrossTrainerCacheSizeBytes;
-    out = std::make_unique<CachingTaskRunner>(std::move(iterator),
-                                              max_cache_size_bytes);
+    std::unique_ptr<CacheSpillLog> spill_log;
+    if (!worker_config.cross_trainer_cache_spill_dir().empty()) {
+      const size_t max_spill_size_bytes =
+          worker_config.cross_trainer_cache_spill_size_bytes() > 0
+              ? worker_config.cross_trainer_cache_spill_size_bytes()
+              : kDefaultCrossTrainerCacheSpillSizeBytes;
+      TF_ASSIGN_OR_RETURN(
+          spill_log,
+          CacheSpillLog::Create(
+              Env::Default(),
+              io::JoinPath(worker_config.cross_trainer_cache_spill_dir(),
+                           absl::StrCat("task_", task_def.task_id(), "_",
+                                        Env::Default()->NowMicros())),
+              max_spill_size_bytes, kCrossTrainerCacheSpillSegmentSizeBytes));
+    }
+    out = std::make_unique<CachingTaskRunner>(
+        std::move(iterator), max_cache_size_bytes, std::move(spill_log));
   } else {
-    out = std::make_unique<FirstComeFirstServedTaskRunner>(std::move(iterator));
+    out = std::make_unique<FirstComeFirstServedTaskRunner>(
+        std::move(iterator), worker_config.num_task_producer_threads());
   }
   return absl::OkStatus();
 }
 
 FirstComeFirstServedTaskRunner::FirstComeFirstServedTaskRunner(
-    std::unique_ptr<TaskIterator> iterator)
-    : iterator_(std::move(iterator)), buffer_(/*buffer_size=*/1) {
-  RunPrefetchThread();
+    std::unique_ptr<TaskIterator> iterator, int64_t num_producer_threads)
+    : iterator_(std::move(iterator)),
+      buffer_(/*buffer_size=*/std::max<int64_t>(num_producer_threads, 1)) {
+  RunPrefetchThreads(std::max<int64_t>(num_producer_threads, 1));
 }
 
 FirstComeFirstServedTaskRunner::~FirstComeFirstServedTaskRunner() { Cancel(); }
@@ -132,21 +161,32 @@ Status FirstComeFirstServedTaskRunner::GetNext(GetElementResult& result) {
 
 Status FirstComeFirstServedTaskRunner::PrefetchFn() {
   while (true) {
-    TF_RETURN_IF_ERROR(buffer_.Push(GetNextFromInputIterator()));
+    StatusOr<GetElementResult> result = GetNextFromInputIterator();
+    const bool is_element = result.ok() && !result->end_of_sequence;
+    Status status = buffer_.Push(std::move(result));
+    if (is_element) {
+      mutex_lock l(mu_);
+      --num_producing_;
+      producing_cv_.notify_all();
+    }
+    TF_RETURN_IF_ERROR(status);
   }
   return absl::OkStatus();
 }
 
-void FirstComeFirstServedTaskRunner::RunPrefetchThread() {
+void FirstComeFirstServedTaskRunner::RunPrefetchThreads(
+    int64_t num_producer_threads) {
   auto prefetch_fn = [this] {
     Status status = PrefetchFn();
     if (!status.ok()) {
       buffer_.Cancel(status);
     }
   };
-  prefetch_thread_ = absl::WrapUnique(Env::Default()->StartThread(
-      /*thread_options=*/{}, /*name=*/"tf_data_service_fcfs_prefetch_thread",
-      prefetch_fn));
+  for (int64_t i = 0; i < num_producer_threads; ++i) {
+    prefetch_threads_.push_back(absl::WrapUnique(Env::Default()->StartThread(
+        /*thread_options=*/{}, /*name=*/"tf_data_service_fcfs_prefetch_thread",
+        prefetch_fn)));
+  }
 }
 
 StatusOr<GetElementResult>
@@ -158,7 +198,21 @@ FirstComeFirstServedTaskRunner::GetNextFromInputIterator()
   result.skip = false;
   {
     mutex_lock l(mu_);
-    TF_RETURN_IF_ERROR(iterator_->GetNext(element, end_of_task));
+    ++num_producing_;
+  }
+  Status status = iterator_->GetNext(element, end_of_task);
+  {
+    mutex_lock l(mu_);
+    if (!status.ok() || end_of_task) {
+      --num_producing_;
+      producing_cv_.notify_all();
+      TF_RETURN_IF_ERROR(status);
+      // Elements which other threads are still producing come before the end
+      // of sequence.
+      while (num_producing_ > 0) {
+        producing_cv_.wait(l);
+      }
+    }
     result.end_of_sequence = end_of_task;
     result.element_index = element_index_++;
   }
@@ -178,10 +232,14 @@ std::shared_ptr<model::Model> FirstComeFirstServedTaskRunner::model() const {
 }
 
 CachingTaskRunner::CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
-                                     size_t max_cache_size_bytes)
+                                     size_t max_cache_size_bytes,
+                                     std::unique_ptr<CacheSpillLog> spill_log)
     : fcfs_task_runner_(std::move(iterator)),
       cache_(max_cache_size_bytes,
-             std::make_unique<GetElementResultSequence>(fcfs_task_runner_)) {
+             std::make_unique<GetElementResultSequence>(fcfs_task_runner_),
+             spill_log == nullptr ? nullptr
+                                  : std::make_unique<GetElementResultSpillTier>(
+                                        std::move(spill_log))) {
   LOG(INFO) << "Initialized tf.data service cross-trainer cache with "
             << ByteSize::Bytes(max_cache_size_bytes) << " of memory.";
 }
@@ -217,6 +275,60 @@ size_t CachingTaskRunner::GetElementResultSequence::GetElementSizeBytes(
   return element.EstimatedMemoryUsageBytes();
 }
 
+CachingTaskRunner::GetElementResultSpillTier::GetElementResultSpillTier(
+    std::unique_ptr<CacheSpillLog> log)
+    : log_(std::move(log)) {}
+
+Status CachingTaskRunner::GetElementResultSpillTier::Spill(
+    size_t index, const GetElementResult& element) {
+  GetElementResponse response;
+  response.set_element_index(element.element_index);
+  const std::vector<Tensor>& components = element.components;
+  const CompressedElement* compressed = nullptr;
+  if (components.size() == 1 && components[0].dtype() == DT_VARIANT &&
+      TensorShapeUtils::IsScalar(components[0].shape())) {
+    compressed = components[0].scalar<Variant>()().get<CompressedElement>();
+  }
+  if (compressed != nullptr) {
+    *response.mutable_compressed() = *compressed;
+  } else {
+    UncompressedElement* uncompressed = response.mutable_uncompressed();
+    for (const Tensor& component : components) {
+      component.AsProtoTensorContent(uncompressed->add_components());
+    }
+  }
+  return log_->Append(index, response.SerializeAsString());
+}
+
+StatusOr<GetElementResult> CachingTaskRunner::GetElementResultSpillTier::Read(
+    size_t index) {
+  TF_ASSIGN_OR_RETURN(std::string record, log_->Read(index));
+  GetElementResponse response;
+  if (!response.ParseFromString(record)) {
+    return errors::DataLoss("Failed to parse spilled element ", index);
+  }
+  GetElementResult result;
+  result.element_index = response.element_index();
+  if (response.has_compressed()) {
+    Tensor tensor(DT_VARIANT, TensorShape{});
+    tensor.scalar<Variant>()() = std::move(*response.mutable_compressed());
+    result.components.push_back(std::move(tensor));
+    return result;
+  }
+  for (const TensorProto& proto : response.uncompressed().components()) {
+    Tensor tensor;
+    if (!tensor.FromProto(proto)) {
+      return errors::DataLoss("Failed to parse spilled element ", index);
+    }
+    result.components.push_back(std::move(tensor));
+  }
+  return result;
+}
+
+size_t CachingTaskRunner::GetElementResultSpillTier::StartIndex() const {
+  return log_->StartIndex();
+}
+
 void CachingTaskRunner::Cancel() {
   VLOG(2) << "Cancelling tf.data service cross-trainer cache task.";
   if (!cache_.IsCancelled()) {
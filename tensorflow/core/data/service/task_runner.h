@@ -19,6 +19,7 @@ limitations under the License.
 #include <optional>
 #include <vector>
 
+#include "tensorflow/core/data/service/cache_spill_log.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/cross_trainer_cache.h"
 #include "tensorflow/core/data/service/data_transfer.h"
@@ -43,7 +44,8 @@ class TaskIterator {
   virtual ~TaskIterator() = default;
   // If the iterator is not yet exhausted, `GetNext` stores the next element in
   // `element` and sets `end_of_sequence` to `false`. Otherwise, sets
-  // `end_of_sequence to `true`.
+  // `end_of_sequence to `true`. It may be called concurrently by a
+  // `FirstComeFirstServedTaskRunner` with more than one producer thread.
   virtual Status GetNext(std::vector<Tensor>& element,
                          bool& end_of_sequence) = 0;
   // Reports the cardinality of the dataset that created this iterator.
@@ -108,8 +110,12 @@ class TaskRunner {
 // It does not consider which consumer is making the request.
 class FirstComeFirstServedTaskRunner : public TaskRunner {
  public:
+  // `num_producer_threads` threads call the iterator concurrently and buffer
+  // one element each. With more than one thread, elements may be produced out
+  // of order, but the end of sequence is only reported once every element
+  // produced before it has been buffered.
   explicit FirstComeFirstServedTaskRunner(
-      std::unique_ptr<TaskIterator> iterator);
+      std::unique_ptr<TaskIterator> iterator, int64_t num_producer_threads = 1);
   ~FirstComeFirstServedTaskRunner() override;
 
   // Gets the next element. It may block if the element is not ready yet.
@@ -126,19 +132,24 @@ class FirstComeFirstServedTaskRunner : public TaskRunner {
   // task has been cancelled.
   Status PrefetchFn();
 
-  // Runs `PrefetchFn` on a dedicated thread.
-  void RunPrefetchThread();
+  // Runs `PrefetchFn` on `num_producer_threads` dedicated threads.
+  void RunPrefetchThreads(int64_t num_producer_threads);
 
-  // Gets the next element from the input iterator.
+  // Gets the next element from the input iterator. If it is the end of
+  // sequence, waits until no other thread is producing an element.
   StatusOr<GetElementResult> GetNextFromInputIterator() TF_LOCKS_EXCLUDED(mu_);
 
   const std::shared_ptr<model::Model> model_;
+  const std::unique_ptr<TaskIterator> iterator_;
   mutex mu_;
-  std::unique_ptr<TaskIterator> iterator_ TF_GUARDED_BY(mu_);
   int64_t element_index_ TF_GUARDED_BY(mu_) = 0;
+  // Number of threads which are getting an element from `iterator_` or
+  // buffering one which is not the end of sequence.
+  int64_t num_producing_ TF_GUARDED_BY(mu_) = 0;
+  condition_variable producing_cv_;
 
   ThreadSafeBuffer<GetElementResult> buffer_;
-  std::unique_ptr<Thread> prefetch_thread_;
+  std::vector<std::unique_ptr<Thread>> prefetch_threads_;
 
   FirstComeFirstServedTaskRunner(const FirstComeFirstServedTaskRunner&) =
       delete;
@@ -152,8 +163,11 @@ class FirstComeFirstServedTaskRunner : public TaskRunner {
 // read the full dataset.
 class CachingTaskRunner : public TaskRunner {
  public:
-  explicit CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
-                             size_t max_cache_size_bytes);
+  // If `spill_log` is not null, elements evicted from the cache are spilled
+  // to it.
+  explicit CachingTaskRunner(
+      std::unique_ptr<TaskIterator> iterator, size_t max_cache_size_bytes,
+      std::unique_ptr<CacheSpillLog> spill_log = nullptr);
   ~CachingTaskRunner() override;
 
   // Gets the next element from the cross-trainer cache, blocking if the data is
@@ -184,6 +198,19 @@ class CachingTaskRunner : public TaskRunner {
     FirstComeFirstServedTaskRunner& fcfs_task_runner_;
   };
 
+  // Spills cached elements to a `CacheSpillLog`, encoded as
+  // `GetElementResponse`s.
+  class GetElementResultSpillTier : public CacheSpillTier<GetElementResult> {
+   public:
+    explicit GetElementResultSpillTier(std::unique_ptr<CacheSpillLog> log);
+    Status Spill(size_t index, const GetElementResult& element) override;
+    StatusOr<GetElementResult> Read(size_t index) override;
+    size_t StartIndex() const override;
+
+   private:
+    const std::unique_ptr<CacheSpillLog> log_;
+  };
+
   FirstComeFirstServedTaskRunner fcfs_task_runner_;
   CrossTrainerCache<GetElementResult> cache_;
 
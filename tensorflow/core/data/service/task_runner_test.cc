@@ -83,6 +83,36 @@ class RangeIterator : public TaskIterator {
   int64_t next_ = 0;
 };
 
+// A thread-safe range iterator which takes longer to produce the later
+// elements, so that concurrent calls finish out of order.
+class SlowRangeIterator : public TaskIterator {
+ public:
+  explicit SlowRangeIterator(const int64_t range) : range_(range) {}
+
+  Status GetNext(std::vector<Tensor>& element, bool& end_of_sequence) override {
+    int64_t next;
+    {
+      mutex_lock l(mu_);
+      next = next_;
+      next_ = std::min(next_ + 1, range_);
+    }
+    end_of_sequence = (next >= range_);
+    if (end_of_sequence) {
+      return absl::OkStatus();
+    }
+    Env::Default()->SleepForMicroseconds(100 * next);
+    element = {Tensor{next}};
+    return absl::OkStatus();
+  }
+
+  int64_t Cardinality() const override { return range_; }
+
+ private:
+  const int64_t range_;
+  mutex mu_;
+  int64_t next_ TF_GUARDED_BY(mu_) = 0;
+};
+
 class InfiniteRangeIterator : public TaskIterator {
  public:
   InfiniteRangeIterator() = default;
@@ -211,6 +241,21 @@ TEST(FirstComeFirstServedTaskRunnerTest, GetNext) {
   EXPECT_TRUE(result.end_of_sequence);
 }
 
+TEST(FirstComeFirstServedTaskRunnerTest, ParallelProducers) {
+  size_t range = 20;
+  FirstComeFirstServedTaskRunner runner(
+      std::make_unique<SlowRangeIterator>(range),
+      /*num_producer_threads=*/4);
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::vector<int64_t> output,
+      GetTaskRunnerOutput<int64_t>(runner, GetElementRequest()));
+  EXPECT_THAT(output, UnorderedElementsAreArray(GetRange(range)));
+
+  GetElementResult result;
+  TF_ASSERT_OK(runner.GetNext(GetElementRequest(), result));
+  EXPECT_TRUE(result.end_of_sequence);
+}
+
 TEST(FirstComeFirstServedTaskRunnerTest, EmptyDataset) {
   FirstComeFirstServedTaskRunner runner(
       std::make_unique<RangeIterator>(/*range=*/0, /*repeat=*/false));
@@ -451,7 +451,8 @@ DataServiceWorkerImpl::MakeDatasetIterator(standalone::Dataset& dataset,
     for (int i = 0; i < task_def.num_split_providers(); ++i) {
       split_providers.push_back(std::make_unique<DataServiceSplitProvider>(
           config_.dispatcher_address(), config_.protocol(),
-          task_def.iteration_id(), i, config_.dispatcher_timeout_ms()));
+          task_def.iteration_id(), i, config_.dispatcher_timeout_ms(),
+          config_.split_batch_size(), worker_address_));
     }
     TF_RETURN_IF_ERROR(
         dataset.MakeIterator(std::move(split_providers), &iterator));
@@ -743,15 +744,15 @@ Status DataServiceWorkerImpl::UpdateSnapshotWriters(
         &dataset_def));
     TF_ASSIGN_OR_RETURN(std::unique_ptr<StandaloneTaskIterator> iterator,
                         MakeSnapshotTaskIterator(snapshot_task, dataset_def));
+    SnapshotWriterParams params{
+        snapshot_task.base_path(), snapshot_task.stream_index(),
+        snapshot_task.metadata().compression(), Env::Default(),
+        ByteSize::Bytes(config_.snapshot_max_chunk_size_bytes())};
+    params.chunk_format = snapshot_task.metadata().chunk_format();
     mutex_lock l(mu_);
     snapshot_writers_.emplace(
         snapshot_task_key,
-        std::make_unique<SnapshotStreamWriter>(
-            SnapshotWriterParams{
-                snapshot_task.base_path(), snapshot_task.stream_index(),
-                snapshot_task.metadata().compression(), Env::Default(),
-                ByteSize::Bytes(config_.snapshot_max_chunk_size_bytes())},
-            std::move(iterator)));
+        std::make_unique<SnapshotStreamWriter>(params, std::move(iterator)));
   }
 
   // Cancel writers for snapshots that are no longer assigned by the dispatcher.
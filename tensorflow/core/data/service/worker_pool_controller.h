@@ -0,0 +1,80 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_WORKER_POOL_CONTROLLER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_WORKER_POOL_CONTROLLER_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
+
+namespace tensorflow {
+namespace data {
+
+// Hook through which the tf.data service dispatcher resizes its worker pool.
+// Orchestration systems implement it and register the implementation under a
+// name, which is selected by `DispatcherConfig.worker_pool_controller`.
+//
+// The dispatcher periodically compares the number of workers recommended by
+// its `MultipleIterationsAutoScaler` with the number of serving workers:
+//
+// - If more workers are needed, it calls `AddWorkers`.
+// - If fewer workers are needed, it drains the least utilized workers: it
+//   stops assigning work to them and waits until their tasks have finished or
+//   have been removed. It then calls `RemoveWorker` for each drained worker.
+//
+// Methods are called from the dispatcher's maintenance thread, one at a time,
+// without holding dispatcher locks.
+class WorkerPoolController {
+ public:
+  using FactoryT =
+      std::function<Status(const experimental::DispatcherConfig&,
+                           std::unique_ptr<WorkerPoolController>*)>;
+  virtual ~WorkerPoolController() = default;
+
+  // Asks for the pool to grow to `target_num_workers` serving workers. This is
+  // called again at each scaling decision until enough workers have
+  // registered, so it should be idempotent.
+  virtual Status AddWorkers(int64_t target_num_workers) = 0;
+
+  // Asks for the drained worker at `worker_address` to be stopped.
+  virtual Status RemoveWorker(const std::string& worker_address) = 0;
+
+  // Registers a WorkerPoolController factory under `name`.
+  static void Register(std::string name, FactoryT factory);
+
+  // Creates a WorkerPoolController from the factory registered with `name`.
+  static Status Create(const std::string& name,
+                       const experimental::DispatcherConfig& config,
+                       std::unique_ptr<WorkerPoolController>* out);
+};
+
+// Returns the `num_workers` workers in `candidates` with the lowest
+// utilization, in order of increasing utilization. Workers without a reported
+// utilization are considered idle.
+std::vector<std::string> SelectWorkersToDrain(
+    const std::vector<std::string>& candidates,
+    const absl::flat_hash_map<std::string, double>& utilizations,
+    int64_t num_workers);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_WORKER_POOL_CONTROLLER_H_
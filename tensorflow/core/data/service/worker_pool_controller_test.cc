@@ -0,0 +1,87 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/worker_pool_controller.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+class FakeWorkerPoolController : public WorkerPoolController {
+ public:
+  Status AddWorkers(int64_t target_num_workers) override {
+    return absl::OkStatus();
+  }
+  Status RemoveWorker(const std::string& worker_address) override {
+    return absl::OkStatus();
+  }
+};
+
+TEST(WorkerPoolControllerTest, Create) {
+  WorkerPoolController::Register(
+      "fake", [](const experimental::DispatcherConfig& config,
+                 std::unique_ptr<WorkerPoolController>* out) {
+        *out = std::make_unique<FakeWorkerPoolController>();
+        return absl::OkStatus();
+      });
+  std::unique_ptr<WorkerPoolController> controller;
+  TF_ASSERT_OK(WorkerPoolController::Create(
+      "fake", experimental::DispatcherConfig(), &controller));
+  EXPECT_NE(controller, nullptr);
+}
+
+TEST(WorkerPoolControllerTest, CreateUnregistered) {
+  std::unique_ptr<WorkerPoolController> controller;
+  EXPECT_THAT(WorkerPoolController::Create(
+                  "unregistered", experimental::DispatcherConfig(),
+                  &controller),
+              StatusIs(error::NOT_FOUND));
+}
+
+TEST(SelectWorkersToDrainTest, SelectsLeastUtilizedWorkers) {
+  std::vector<std::string> candidates = {"worker_0", "worker_1", "worker_2",
+                                         "worker_3"};
+  absl::flat_hash_map<std::string, double> utilizations = {
+      {"worker_0", 0.8}, {"worker_1", 0.3}, {"worker_2", 0.5}};
+  EXPECT_THAT(SelectWorkersToDrain(candidates, utilizations,
+                                   /*num_workers=*/2),
+              ElementsAre("worker_3", "worker_1"));
+}
+
+TEST(SelectWorkersToDrainTest, NotEnoughCandidates) {
+  EXPECT_THAT(SelectWorkersToDrain({"worker_0"}, {}, /*num_workers=*/3),
+              ElementsAre("worker_0"));
+  EXPECT_THAT(SelectWorkersToDrain({}, {}, /*num_workers=*/3), IsEmpty());
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,557 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/zero_copy_transfer.h"
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "grpcpp/client_context.h"
+#include "grpcpp/create_channel.h"
+#include "grpcpp/impl/codegen/client_unary_call.h"
+#include "grpcpp/impl/codegen/method_handler.h"
+#include "grpcpp/impl/codegen/rpc_method.h"
+#include "grpcpp/impl/codegen/rpc_service_method.h"
+#include "grpcpp/security/credentials.h"
+#include "grpcpp/security/server_credentials.h"
+#include "grpcpp/server.h"
+#include "grpcpp/server_builder.h"
+#include "grpcpp/server_context.h"
+#include "grpcpp/support/channel_arguments.h"
+#include "grpcpp/support/proto_buffer_reader.h"
+#include "grpcpp/support/slice.h"
+#include "grpcpp/support/status.h"
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/data/compression_utils.h"
+#include "tensorflow/core/data/service/credentials_factory.h"
+#include "tensorflow/core/data/service/grpc_util.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kGetElementMethod[] =
+    "/tensorflow.data.ZeroCopyTransferService/GetElement";
+
+// Tensor contents at least this large are shared with gRPC instead of being
+// copied into the message.
+constexpr size_t kShareThresholdBytes = 1024;
+
+enum WireType : uint32 { kVarint = 0, kLengthDelimited = 2 };
+
+inline uint32 Tag(int field, WireType type) {
+  return (static_cast<uint32>(field) << 3) | type;
+}
+
+// Accumulates the slices of a message. Small fields are copied into a pending
+// buffer, which is flushed into its own slice before each shared slice.
+class SliceBuilder {
+ public:
+  void AppendTag(int field, WireType type) {
+    core::PutVarint32(&pending_, Tag(field, type));
+  }
+  void AppendVarint(uint64 value) { core::PutVarint64(&pending_, value); }
+  void AppendBytes(const char* data, size_t size) {
+    pending_.append(data, size);
+  }
+  // Appends the data of `tensor`, keeping a reference to its buffer until gRPC
+  // destroys the slice.
+  void AppendShared(const Tensor& tensor) {
+    Flush();
+    absl::string_view data = tensor.tensor_data();
+    slices_.emplace_back(
+        const_cast<char*>(data.data()), data.size(),
+        [](void* arg) { delete static_cast<Tensor*>(arg); },
+        new Tensor(tensor));
+  }
+
+  void Finish(::grpc::ByteBuffer* buffer) {
+    Flush();
+    ::grpc::ByteBuffer tmp(slices_.data(), slices_.size());
+    buffer->Swap(&tmp);
+  }
+
+ private:
+  void Flush() {
+    if (pending_.empty()) return;
+    slices_.emplace_back(pending_.data(), pending_.size());
+    pending_.clear();
+  }
+
+  std::string pending_;
+  std::vector<::grpc::Slice> slices_;
+};
+
+// The encoding of one component of an uncompressed element.
+struct EncodedComponent {
+  // For memcpy-able tensors, the `TensorProto` without its contents, which
+  // follow as `tensor_content`. For other tensors, the whole `TensorProto`.
+  std::string prefix;
+  const Tensor* content = nullptr;
+  // Size of the encoded `TensorProto`.
+  size_t size = 0;
+};
+
+Status EncodeComponent(const Tensor& tensor, EncodedComponent* out) {
+  TensorProto proto;
+  if (DataTypeCanUseMemcpy(tensor.dtype())) {
+    proto.set_dtype(tensor.dtype());
+    tensor.shape().AsProto(proto.mutable_tensor_shape());
+    out->content = &tensor;
+  } else {
+    tensor.AsProtoTensorContent(&proto);
+  }
+  if (!proto.SerializeToString(&out->prefix)) {
+    return errors::Internal("Failed to serialize tensor of shape ",
+                            tensor.shape().DebugString());
+  }
+  out->size = out->prefix.size();
+  if (out->content != nullptr) {
+    const size_t num_bytes = tensor.TotalBytes();
+    out->size += core::VarintLength(Tag(TensorProto::kTensorContentFieldNumber,
+                                        kLengthDelimited)) +
+                 core::VarintLength(num_bytes) + num_bytes;
+  }
+  return absl::OkStatus();
+}
+
+// Returns whether `components` is a compressed element as produced by the
+// worker when compression is enabled.
+bool IsCompressed(const std::vector<Tensor>& components) {
+  return components.size() == 1 && components[0].dtype() == DT_VARIANT &&
+         TensorShapeUtils::IsScalar(components[0].shape()) &&
+         components[0].scalar<Variant>()().get<CompressedElement>() != nullptr;
+}
+
+// Reads the rest of the current (limited) message into `proto`, starting with
+// the field whose tag was just read.
+bool MergeRemaining(protobuf::io::CodedInputStream* input, uint32 tag,
+                    TensorProto* proto) {
+  std::string remaining;
+  core::PutVarint32(&remaining, tag);
+  std::string rest;
+  if (!input->ReadString(&rest, input->BytesUntilLimit())) return false;
+  remaining.append(rest);
+  return proto->MergeFromString(remaining);
+}
+
+bool ParseTensor(protobuf::io::CodedInputStream* input, Allocator* allocator,
+                 Tensor* tensor) {
+  TensorProto meta;
+  bool has_content = false;
+  while (uint32 tag = input->ReadTag()) {
+    if (tag == Tag(TensorProto::kDtypeFieldNumber, kVarint)) {
+      uint32 dtype;
+      if (!input->ReadVarint32(&dtype)) return false;
+      meta.set_dtype(static_cast<DataType>(dtype));
+    } else if (tag == Tag(TensorProto::kTensorShapeFieldNumber,
+                          kLengthDelimited)) {
+      uint32 length;
+      if (!input->ReadVarint32(&length)) return false;
+      auto limit = input->PushLimit(length);
+      if (!meta.mutable_tensor_shape()->MergeFromCodedStream(input) ||
+          !input->ConsumedEntireMessage()) {
+        return false;
+      }
+      input->PopLimit(limit);
+    } else if (tag == Tag(TensorProto::kTensorContentFieldNumber,
+                          kLengthDelimited) &&
+               !has_content && DataTypeCanUseMemcpy(meta.dtype()) &&
+               TensorShape::IsValid(meta.tensor_shape())) {
+      uint32 length;
+      if (!input->ReadVarint32(&length)) return false;
+      TensorShape shape(meta.tensor_shape());
+      if (shape.num_elements() * DataTypeSize(meta.dtype()) != length) {
+        return false;
+      }
+      *tensor = Tensor(allocator, meta.dtype(), shape);
+      if (length > 0 &&
+          !input->ReadRaw(const_cast<char*>(tensor->tensor_data().data()),
+                          length)) {
+        return false;
+      }
+      has_content = true;
+    } else {
+      // Written by another encoder, e.g. a non-memcpy-able tensor or
+      // repeated value fields. Fall back to parsing a `TensorProto`.
+      if (has_content || !MergeRemaining(input, tag, &meta)) return false;
+      return tensor->FromProto(allocator, meta);
+    }
+  }
+  if (has_content) return true;
+  return tensor->FromProto(allocator, meta);
+}
+
+// Parses a `GetElementResponse` with an uncompressed element. Returns false if
+// the message is malformed or has a compressed element.
+bool ParseResponse(protobuf::io::CodedInputStream* input, Allocator* allocator,
+                   GetElementResult* result) {
+  while (uint32 tag = input->ReadTag()) {
+    if (tag == Tag(GetElementResponse::kEndOfSequenceFieldNumber, kVarint)) {
+      uint32 value;
+      if (!input->ReadVarint32(&value)) return false;
+      result->end_of_sequence = value != 0;
+    } else if (tag ==
+               Tag(GetElementResponse::kSkipTaskFieldNumber, kVarint)) {
+      uint32 value;
+      if (!input->ReadVarint32(&value)) return false;
+      result->skip = value != 0;
+    } else if (tag ==
+               Tag(GetElementResponse::kElementIndexFieldNumber, kVarint)) {
+      uint64 value;
+      if (!input->ReadVarint64(&value)) return false;
+      result->element_index = static_cast<int64_t>(value);
+    } else if (tag == Tag(GetElementResponse::kUncompressedFieldNumber,
+                          kLengthDelimited)) {
+      uint32 length;
+      if (!input->ReadVarint32(&length)) return false;
+      auto element_limit = input->PushLimit(length);
+      while (uint32 component_tag = input->ReadTag()) {
+        if (component_tag != Tag(UncompressedElement::kComponentsFieldNumber,
+                                 kLengthDelimited)) {
+          return false;
+        }
+        uint32 component_length;
+        if (!input->ReadVarint32(&component_length)) return false;
+        auto component_limit = input->PushLimit(component_length);
+        result->components.emplace_back();
+        if (!ParseTensor(input, allocator, &result->components.back()) ||
+            input->BytesUntilLimit() != 0) {
+          return false;
+        }
+        input->PopLimit(component_limit);
+      }
+      if (!input->ConsumedEntireMessage()) return false;
+      input->PopLimit(element_limit);
+    } else {
+      return false;
+    }
+  }
+  return input->ConsumedEntireMessage();
+}
+
+// Handles responses that the fast path does not, e.g. compressed elements.
+Status ParseResponseProto(::grpc::ByteBuffer* buffer, Allocator* allocator,
+                          GetElementResult* result) {
+  GetElementResponse resp;
+  ::grpc::ProtoBufferReader reader(buffer);
+  if (!resp.ParseFromZeroCopyStream(&reader)) {
+    return errors::DataLoss("Failed to parse GetElementResponse.");
+  }
+  result->end_of_sequence = resp.end_of_sequence();
+  result->skip = resp.skip_task();
+  result->element_index = resp.element_index();
+  switch (resp.element_case()) {
+    case GetElementResponse::kCompressed: {
+      Tensor tensor(DT_VARIANT, TensorShape{});
+      tensor.scalar<Variant>()() = std::move(resp.compressed());
+      result->components.push_back(tensor);
+      break;
+    }
+    case GetElementResponse::kUncompressed:
+      for (const auto& component : resp.uncompressed().components()) {
+        result->components.emplace_back();
+        if (!result->components.back().FromProto(allocator, component)) {
+          return errors::Internal("Failed to parse tensor.");
+        }
+      }
+      break;
+    case GetElementResponse::ELEMENT_NOT_SET:
+      break;
+  }
+  return absl::OkStatus();
+}
+
+class ZeroCopyTransferService : public ::grpc::Service {
+ public:
+  explicit ZeroCopyTransferService(DataTransferServer::GetElementT get_element)
+      : get_element_(std::move(get_element)) {
+    AddMethod(new ::grpc::internal::RpcServiceMethod(
+        kGetElementMethod, ::grpc::internal::RpcMethod::NORMAL_RPC,
+        new ::grpc::internal::RpcMethodHandler<
+            ZeroCopyTransferService, GetElementRequest, ::grpc::ByteBuffer>(
+            std::mem_fn(&ZeroCopyTransferService::GetElement), this)));
+  }
+
+  ::grpc::Status GetElement(::grpc::ServerContext* context,
+                            const GetElementRequest* request,
+                            ::grpc::ByteBuffer* response) {
+    GetElementResult result;
+    Status s = get_element_(request, &result);
+    if (s.ok()) {
+      s = EncodeElementToByteBuffer(result, response);
+    }
+    return ToGrpcStatus(s);
+  }
+
+ private:
+  const DataTransferServer::GetElementT get_element_;
+};
+
+class ZeroCopyGrpcDataTransferServer : public DataTransferServer {
+ public:
+  explicit ZeroCopyGrpcDataTransferServer(GetElementT get_element)
+      : service_(std::move(get_element)) {}
+
+  ~ZeroCopyGrpcDataTransferServer() override {
+    if (server_) {
+      server_->Shutdown();
+    }
+  }
+
+  Status Start(const experimental::WorkerConfig& config) override {
+    std::shared_ptr<::grpc::ServerCredentials> credentials;
+    TF_RETURN_IF_ERROR(CredentialsFactory::CreateServerCredentials(
+        config.protocol(), &credentials));
+    ::grpc::ServerBuilder builder;
+    builder.AddListeningPort("[::]:0", credentials, &port_);
+    builder.SetMaxSendMessageSize(std::numeric_limits<int32>::max());
+    builder.RegisterService(&service_);
+    server_ = builder.BuildAndStart();
+    if (!server_) {
+      return errors::Internal("Could not start ",
+                              kZeroCopyGrpcTransferProtocol,
+                              " data transfer server.");
+    }
+    VLOG(1) << "Started " << kZeroCopyGrpcTransferProtocol
+            << " data transfer server on port " << port_;
+    return absl::OkStatus();
+  }
+
+  int Port() const override { return port_; }
+
+ private:
+  ZeroCopyTransferService service_;
+  std::unique_ptr<::grpc::Server> server_;
+  int port_ = 0;
+};
+
+class ZeroCopyGrpcDataTransferClient : public DataTransferClient {
+ public:
+  ZeroCopyGrpcDataTransferClient(
+      std::shared_ptr<::grpc::ChannelCredentials> credentials,
+      std::string address, Allocator* allocator)
+      : allocator_(allocator),
+        rpcmethod_get_element_(kGetElementMethod,
+                               ::grpc::internal::RpcMethod::NORMAL_RPC) {
+    VLOG(2) << "Create ZeroCopyGrpcDataTransferClient for worker " << address
+            << ".";
+    ::grpc::ChannelArguments args;
+    args.SetMaxReceiveMessageSize(-1);
+    channel_ = ::grpc::CreateCustomChannel(address, credentials, args);
+  }
+
+  Status GetElement(const GetElementRequest& req,
+                    GetElementResult& result) override {
+    VLOG(3) << "GetElement for task " << req.task_id() << " from "
+            << kZeroCopyGrpcTransferProtocol << " worker server.";
+    ::grpc::ClientContext ctx;
+    gtl::Cleanup<std::function<void()>> cleanup;
+    {
+      mutex_lock l(mu_);
+      if (cancelled_) {
+        return errors::Cancelled("Client was cancelled.");
+      }
+      active_contexts_.insert(&ctx);
+      cleanup = gtl::MakeCleanup([this, &ctx] {
+        mutex_lock l(mu_);
+        active_contexts_.erase(&ctx);
+      });
+    }
+    ::grpc::ByteBuffer resp;
+    int64_t start_time_us = env_->NowMicros();
+    ::grpc::Status s =
+        ::grpc::internal::BlockingUnaryCall<GetElementRequest,
+                                            ::grpc::ByteBuffer>(
+            channel_.get(), rpcmethod_get_element_, &ctx, req, &resp);
+    if (!s.ok()) {
+      return grpc_util::WrapError("Failed to get element", s);
+    }
+    TF_RETURN_IF_ERROR(DecodeElementFromByteBuffer(&resp, allocator_, &result));
+    int64_t end_time_us = env_->NowMicros();
+    metrics::RecordTFDataServiceGetElementDuration(
+        kZeroCopyGrpcTransferProtocol, end_time_us - start_time_us);
+    return absl::OkStatus();
+  }
+
+  void TryCancel() override {
+    VLOG(2) << "Cancel ZeroCopyGrpcDataTransferClient.";
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    for (const auto& ctx : active_contexts_) {
+      ctx->TryCancel();
+    }
+  }
+
+ private:
+  Allocator* const allocator_;
+  std::shared_ptr<::grpc::Channel> channel_;
+  const ::grpc::internal::RpcMethod rpcmethod_get_element_;
+  mutex mu_;
+  // Set of all currently active clients contexts. Used to support
+  // cancellation.
+  absl::flat_hash_set<::grpc::ClientContext*> active_contexts_
+      TF_GUARDED_BY(mu_);
+  // Indicates that the client has been cancelled, so no further requests should
+  // be accepted.
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+};
+
+class ZeroCopyTransferRegistrar {
+ public:
+  ZeroCopyTransferRegistrar() {
+    DataTransferServer::Register(
+        kZeroCopyGrpcTransferProtocol,
+        [](DataTransferServer::GetElementT get_element,
+           std::shared_ptr<DataTransferServer>* out) {
+          *out = std::make_shared<ZeroCopyGrpcDataTransferServer>(
+              std::move(get_element));
+          return absl::OkStatus();
+        });
+    DataTransferClient::Register(
+        kZeroCopyGrpcTransferProtocol,
+        [](DataTransferClient::Config config,
+           std::unique_ptr<DataTransferClient>* out) {
+          std::shared_ptr<::grpc::ChannelCredentials> credentials;
+          TF_RETURN_IF_ERROR(CredentialsFactory::CreateClientCredentials(
+              config.protocol, &credentials));
+          *out = std::make_unique<ZeroCopyGrpcDataTransferClient>(
+              credentials, config.address, config.allocator);
+          return absl::OkStatus();
+        });
+  }
+};
+static ZeroCopyTransferRegistrar zero_copy_transfer_registrar;
+
+}  // namespace
+
+Status EncodeElementToByteBuffer(const GetElementResult& result,
+                                 ::grpc::ByteBuffer* buffer) {
+  std::vector<Tensor> uncompressed;
+  const std::vector<Tensor>* components = &result.components;
+  if (IsCompressed(result.components)) {
+    TF_RETURN_IF_ERROR(UncompressElement(
+        *result.components[0].scalar<Variant>()().get<CompressedElement>(),
+        &uncompressed));
+    components = &uncompressed;
+  }
+
+  std::vector<EncodedComponent> encoded(components->size());
+  uint64 element_size = 0;
+  for (int i = 0; i < components->size(); ++i) {
+    TF_RETURN_IF_ERROR(EncodeComponent((*components)[i], &encoded[i]));
+    element_size += core::VarintLength(Tag(
+                        UncompressedElement::kComponentsFieldNumber,
+                        kLengthDelimited)) +
+                    core::VarintLength(encoded[i].size) + encoded[i].size;
+  }
+  if (element_size > std::numeric_limits<int32>::max()) {
+    return errors::InvalidArgument(
+        "Element of ", element_size, " bytes exceeds the 2GB limit of the ",
+        kZeroCopyGrpcTransferProtocol, " data transfer protocol.");
+  }
+
+  SliceBuilder builder;
+  if (result.end_of_sequence) {
+    builder.AppendTag(GetElementResponse::kEndOfSequenceFieldNumber, kVarint);
+    builder.AppendVarint(1);
+  }
+  if (result.skip) {
+    builder.AppendTag(GetElementResponse::kSkipTaskFieldNumber, kVarint);
+    builder.AppendVarint(1);
+  }
+  if (result.element_index != 0) {
+    builder.AppendTag(GetElementResponse::kElementIndexFieldNumber, kVarint);
+    builder.AppendVarint(static_cast<uint64>(result.element_index));
+  }
+  if (!components->empty()) {
+    builder.AppendTag(GetElementResponse::kUncompressedFieldNumber,
+                      kLengthDelimited);
+    builder.AppendVarint(element_size);
+    for (const EncodedComponent& component : encoded) {
+      builder.AppendTag(UncompressedElement::kComponentsFieldNumber,
+                        kLengthDelimited);
+      builder.AppendVarint(component.size);
+      builder.AppendBytes(component.prefix.data(), component.prefix.size());
+      if (component.content == nullptr) continue;
+      absl::string_view data = component.content->tensor_data();
+      builder.AppendTag(TensorProto::kTensorContentFieldNumber,
+                        kLengthDelimited);
+      builder.AppendVarint(data.size());
+      if (data.size() >= kShareThresholdBytes) {
+        builder.AppendShared(*component.content);
+      } else {
+        builder.AppendBytes(data.data(), data.size());
+      }
+    }
+  }
+  builder.Finish(buffer);
+  return absl::OkStatus();
+}
+
+Status DecodeElementFromByteBuffer(::grpc::ByteBuffer* buffer,
+                                   Allocator* allocator,
+                                   GetElementResult* result) {
+  if (allocator == nullptr) {
+    allocator = cpu_allocator();
+  }
+  *result = GetElementResult();
+  {
+    ::grpc::ProtoBufferReader reader(buffer);
+    protobuf::io::CodedInputStream input(&reader);
+    input.SetTotalBytesLimit(std::numeric_limits<int>::max());
+    if (ParseResponse(&input, allocator, result)) {
+      return absl::OkStatus();
+    }
+  }
+  *result = GetElementResult();
+  return ParseResponseProto(buffer, allocator, result);
+}
+
+Status DecodeElement(protobuf::io::CodedInputStream* input,
+                     Allocator* allocator, GetElementResult* result) {
+  if (allocator == nullptr) {
+    allocator = cpu_allocator();
+  }
+  *result = GetElementResult();
+  if (!ParseResponse(input, allocator, result)) {
+    return errors::DataLoss("Failed to decode element.");
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace data
+}  // namespace tensorflow
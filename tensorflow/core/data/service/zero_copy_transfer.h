@@ -0,0 +1,62 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_ZERO_COPY_TRANSFER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_ZERO_COPY_TRANSFER_H_
+
+#include "grpcpp/support/byte_buffer.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace data {
+
+// A data transfer protocol that sends elements as uncompressed tensors over a
+// separate gRPC server. Workers decompress elements before sending them, and
+// the data of large tensors is handed to gRPC without being copied. Clients
+// read tensor contents straight from the received gRPC slices into tensors
+// allocated with the client's allocator, without building intermediate
+// protos or decompressing.
+//
+// Use it by setting `data_transfer_protocol` to this name in the worker and
+// client configs.
+constexpr const char kZeroCopyGrpcTransferProtocol[] = "grpc+zerocopy";
+
+// Encodes `result` into `buffer` in a format parseable as a
+// `GetElementResponse` with an uncompressed element. Compressed elements are
+// decompressed first. The data of large tensors with memcpy-able types is
+// shared with `result`, which holds a reference to it until gRPC releases
+// `buffer`.
+Status EncodeElementToByteBuffer(const GetElementResult& result,
+                                 ::grpc::ByteBuffer* buffer);
+
+// Decodes a `GetElementResponse` from `buffer` into `result`, allocating
+// memcpy-able tensors with `allocator` (or the CPU allocator if it is null)
+// and reading their data directly into them.
+Status DecodeElementFromByteBuffer(::grpc::ByteBuffer* buffer,
+                                   Allocator* allocator,
+                                   GetElementResult* result);
+
+// Like `DecodeElementFromByteBuffer`, but reads the element from `input` up to
+// its current limit. Only supports elements written by
+// `EncodeElementToByteBuffer`.
+Status DecodeElement(protobuf::io::CodedInputStream* input,
+                     Allocator* allocator, GetElementResult* result);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_ZERO_COPY_TRANSFER_H_
@@ -0,0 +1,156 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/zero_copy_transfer.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "grpcpp/support/proto_buffer_reader.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/compression_utils.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::vector<Tensor> TestElement() {
+  Tensor large(DT_INT64, TensorShape({64, 32}));
+  large.flat<int64_t>().setRandom();
+  return {test::AsTensor<float>({1.0, 2.5, -3.0}, {3}),
+          test::AsScalar<tstring>("element"), large,
+          Tensor(DT_FLOAT, TensorShape({0, 4}))};
+}
+
+void ExpectRoundTrip(const GetElementResult& result,
+                     const std::vector<Tensor>& expected) {
+  ::grpc::ByteBuffer buffer;
+  TF_ASSERT_OK(EncodeElementToByteBuffer(result, &buffer));
+
+  GetElementResult decoded;
+  TF_ASSERT_OK(DecodeElementFromByteBuffer(&buffer, /*allocator=*/nullptr,
+                                           &decoded));
+  EXPECT_EQ(decoded.end_of_sequence, result.end_of_sequence);
+  EXPECT_EQ(decoded.skip, result.skip);
+  EXPECT_EQ(decoded.element_index, result.element_index);
+  ASSERT_EQ(decoded.components.size(), expected.size());
+  for (int i = 0; i < expected.size(); ++i) {
+    test::ExpectEqual(decoded.components[i], expected[i]);
+  }
+}
+
+TEST(ZeroCopyTransferTest, RoundTrip) {
+  GetElementResult result;
+  result.components = TestElement();
+  result.element_index = 42;
+  ExpectRoundTrip(result, TestElement());
+}
+
+TEST(ZeroCopyTransferTest, DecompressesElements) {
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(TestElement(), &compressed));
+  GetElementResult result;
+  result.components.emplace_back(DT_VARIANT, TensorShape({}));
+  result.components[0].scalar<Variant>()() = compressed;
+  ExpectRoundTrip(result, TestElement());
+}
+
+TEST(ZeroCopyTransferTest, EndOfSequence) {
+  GetElementResult result;
+  result.end_of_sequence = true;
+  result.skip = true;
+  ExpectRoundTrip(result, {});
+}
+
+TEST(ZeroCopyTransferTest, EncodingIsGetElementResponse) {
+  GetElementResult result;
+  result.components = TestElement();
+  result.element_index = 7;
+  ::grpc::ByteBuffer buffer;
+  TF_ASSERT_OK(EncodeElementToByteBuffer(result, &buffer));
+
+  GetElementResponse response;
+  ::grpc::ProtoBufferReader reader(&buffer);
+  ASSERT_TRUE(response.ParseFromZeroCopyStream(&reader));
+  EXPECT_EQ(response.element_index(), 7);
+  ASSERT_EQ(response.uncompressed().components_size(), 4);
+  for (int i = 0; i < 4; ++i) {
+    Tensor tensor;
+    ASSERT_TRUE(tensor.FromProto(response.uncompressed().components(i)));
+    test::ExpectEqual(tensor, result.components[i]);
+  }
+}
+
+TEST(ZeroCopyTransferTest, DecodesCompressedResponses) {
+  GetElementResponse response;
+  TF_ASSERT_OK(CompressElement(TestElement(), response.mutable_compressed()));
+  std::string serialized = response.SerializeAsString();
+  ::grpc::Slice slice(serialized.data(), serialized.size());
+  ::grpc::ByteBuffer buffer(&slice, 1);
+
+  GetElementResult decoded;
+  TF_ASSERT_OK(DecodeElementFromByteBuffer(&buffer, /*allocator=*/nullptr,
+                                           &decoded));
+  ASSERT_EQ(decoded.components.size(), 1);
+  std::vector<Tensor> uncompressed;
+  TF_ASSERT_OK(UncompressElement(
+      *decoded.components[0].scalar<Variant>()().get<CompressedElement>(),
+      &uncompressed));
+  ASSERT_EQ(uncompressed.size(), 4);
+}
+
+TEST(ZeroCopyTransferTest, ClientServer) {
+  std::shared_ptr<DataTransferServer> server;
+  TF_ASSERT_OK(DataTransferServer::Build(
+      kZeroCopyGrpcTransferProtocol,
+      [](const GetElementRequest* request, GetElementResult* result) {
+        result->components = TestElement();
+        result->element_index = request->task_id();
+        return absl::OkStatus();
+      },
+      &server));
+  experimental::WorkerConfig config;
+  config.set_protocol("grpc");
+  TF_ASSERT_OK(server->Start(config));
+
+  std::unique_ptr<DataTransferClient> client;
+  TF_ASSERT_OK(DataTransferClient::Build(
+      kZeroCopyGrpcTransferProtocol,
+      {"grpc", absl::StrCat("localhost:", server->Port()),
+       /*accelerator_device_info=*/nullptr, /*allocator=*/nullptr},
+      &client));
+  GetElementRequest request;
+  request.set_task_id(3);
+  GetElementResult result;
+  TF_ASSERT_OK(client->GetElement(request, result));
+  EXPECT_EQ(result.element_index, 3);
+  std::vector<Tensor> expected = TestElement();
+  ASSERT_EQ(result.components.size(), expected.size());
+  test::ExpectEqual(result.components[0], expected[0]);
+  test::ExpectEqual(result.components[1], expected[1]);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,93 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/tf_record_index.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/raw_coding.h"
+#include "tensorflow/core/platform/statusor.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kTFRecordIndexSuffix[] = ".idx";
+
+}  // namespace
+
+std::string TFRecordIndexFileName(const std::string& filename) {
+  return absl::StrCat(filename, kTFRecordIndexSuffix);
+}
+
+absl::StatusOr<std::vector<uint64_t>> BuildTFRecordIndex(
+    Env* env, const std::string& filename) {
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  io::RecordReader reader(file.get());
+  std::vector<uint64_t> offsets;
+  uint64 offset = 0;
+  while (true) {
+    const uint64 record_offset = offset;
+    int num_skipped = 0;
+    absl::Status status =
+        reader.SkipRecords(&offset, /*num_to_skip=*/1, &num_skipped);
+    if (errors::IsOutOfRange(status) && num_skipped == 0) {
+      return offsets;
+    }
+    TF_RETURN_IF_ERROR(status);
+    offsets.push_back(record_offset);
+  }
+}
+
+absl::Status WriteTFRecordIndex(Env* env, const std::string& filename) {
+  TF_ASSIGN_OR_RETURN(std::vector<uint64_t> offsets,
+                      BuildTFRecordIndex(env, filename));
+  std::string contents;
+  contents.reserve(offsets.size() * sizeof(uint64_t));
+  for (uint64_t offset : offsets) {
+    core::PutFixed64(&contents, offset);
+  }
+  return WriteStringToFile(env, TFRecordIndexFileName(filename), contents);
+}
+
+absl::StatusOr<std::vector<uint64_t>> ReadTFRecordIndex(
+    Env* env, const std::string& filename) {
+  const std::string index_filename = TFRecordIndexFileName(filename);
+  std::string contents;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, index_filename, &contents));
+  if (contents.size() % sizeof(uint64_t) != 0) {
+    return errors::DataLoss("Corrupted TFRecord index ", index_filename,
+                            " of size ", contents.size());
+  }
+  std::vector<uint64_t> offsets(contents.size() / sizeof(uint64_t));
+  for (size_t i = 0; i < offsets.size(); ++i) {
+    offsets[i] = core::DecodeFixed64(contents.data() + i * sizeof(uint64_t));
+  }
+  return offsets;
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,57 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_TF_RECORD_INDEX_H_
+#define TENSORFLOW_CORE_DATA_TF_RECORD_INDEX_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace data {
+
+// The record offset index of an uncompressed TFRecord file `filename` is
+// stored next to it, in `TFRecordIndexFileName(filename)`. It holds the byte
+// offset of the start of each record, in order, as little-endian 64-bit
+// integers. It lets random-access readers locate a record without scanning
+// the file, see `io::RecordReader::ReadRecordAtIndex`. Writers can produce it
+// along with the file with `io::RecordWriterOptions::index_dest`, or it can be
+// built afterwards with `WriteTFRecordIndex`.
+
+// Returns the name of the file holding the index of TFRecord file `filename`.
+std::string TFRecordIndexFileName(const std::string& filename);
+
+// Returns the offsets of the records of the uncompressed TFRecord file
+// `filename`, by scanning the record headers of the file.
+absl::StatusOr<std::vector<uint64_t>> BuildTFRecordIndex(
+    Env* env, const std::string& filename);
+
+// Builds the index of the uncompressed TFRecord file `filename` and writes it
+// to `TFRecordIndexFileName(filename)`.
+absl::Status WriteTFRecordIndex(Env* env, const std::string& filename);
+
+// Reads the index of TFRecord file `filename`. Returns a `NotFound` error if
+// the file has no index.
+absl::StatusOr<std::vector<uint64_t>> ReadTFRecordIndex(
+    Env* env, const std::string& filename);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_TF_RECORD_INDEX_H_
@@ -22,6 +22,7 @@ limitations under the License.
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/time/time.h"
+#include "tensorflow/core/data/autotune_coordinator.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/platform/env.h"
@@ -120,6 +121,11 @@ class TfDatazMetricsCollector {
 
   std::shared_ptr<model::Model> GetModel();
 
+  // Returns the CPU and RAM quota assigned to the iterator's model by
+  // `AutotuneCoordinator::Global()`, or `std::nullopt` if the model's budgets
+  // are not coordinated.
+  std::optional<AutotuneCoordinator::Quota> GetAutotuneQuota();
+
  private:
   DatasetBaseIterator* iterator_;  // not owned
   std::shared_ptr<model::Model> model_;
@@ -15,10 +15,13 @@ limitations under the License.
 #include "tensorflow/core/data/tfdataz_metrics.h"
 
 #include <memory>
+#include <optional>
 #include <utility>
 
 #include "absl/time/time.h"
+#include "tensorflow/core/data/autotune_coordinator.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/util/fake_clock_env.h"
@@ -197,6 +200,23 @@ class ScopedTfDataMetricsRegistration {
   std::shared_ptr<TfDatazMetricsCollector> collector_;
 };
 
+TEST(TfDatazMetricsCollectorTest, GetAutotuneQuota) {
+  std::unique_ptr<DatasetBaseIterator> iterator;
+  auto model = std::make_shared<model::Model>();
+  TfDatazMetricsCollector collector(*Env::Default(), iterator.get(), model);
+  EXPECT_FALSE(collector.GetAutotuneQuota().has_value());
+
+  AutotuneCoordinator::Global().Register(model, /*ram_budget_manager=*/nullptr);
+  AutotuneCoordinator::Global().Rebalance(/*total_cpu_budget=*/4,
+                                          /*total_ram_budget=*/100);
+  std::optional<AutotuneCoordinator::Quota> quota =
+      collector.GetAutotuneQuota();
+  AutotuneCoordinator::Global().Deregister(model.get());
+  ASSERT_TRUE(quota.has_value());
+  EXPECT_EQ(quota->cpu_budget, 4);
+  EXPECT_EQ(quota->ram_budget, 100);
+}
+
 TEST(TfDatazMetricsRegistryTest, Register) {
   std::unique_ptr<DatasetBaseIterator> iterator;
   auto collector_one = std::make_shared<TfDatazMetricsCollector>(
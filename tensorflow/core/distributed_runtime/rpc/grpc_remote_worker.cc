@@ -66,6 +66,7 @@ class GrpcRemoteWorker : public WorkerInterface {
         instancesource_(Method(GrpcWorkerMethod::kCompleteInstance)),
         getstepsequence_(Method(GrpcWorkerMethod::kGetStepSequence)),
         markrecvfinished_(Method(GrpcWorkerMethod::kMarkRecvFinished)),
+        recvtensorbatch_(Method(GrpcWorkerMethod::kRecvTensorBatch)),
         logger_(logger),
         target_(target) {}
 
@@ -258,6 +259,28 @@ class GrpcRemoteWorker : public WorkerInterface {
     IssueRequest(request, response, recvtensor_, callback, call_opts);
   }
 
+  void RecvTensorBatchAsync(CallOptions* call_opts,
+                            const RecvTensorBatchRequest* request,
+                            RecvTensorBatchResponse* response,
+                            StatusCallback done) override {
+    VLOG(1) << "RecvTensorBatchAsync req: " << request->requests_size()
+            << " tensors";
+    auto callback = [this, request, response, done](Status s) {
+      // Note done() can delete this worker object, so we need to call done()
+      // last.
+      if (s.ok() && response->responses_size() == request->requests_size()) {
+        for (int i = 0; i < response->responses_size(); ++i) {
+          if (response->responses(i).require_ack()) {
+            IssueMarkRecvFinishedRequest(request->requests(i).request_id());
+          }
+        }
+      }
+      done(s);
+    };
+
+    IssueRequest(request, response, recvtensorbatch_, callback, call_opts);
+  }
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override {
     IssueRequest(request, response, logging_, done);
@@ -333,6 +356,7 @@ class GrpcRemoteWorker : public WorkerInterface {
   const ::grpc::string instancesource_;
   const ::grpc::string getstepsequence_;
   const ::grpc::string markrecvfinished_;
+  const ::grpc::string recvtensorbatch_;
 
   // Support for logging.
   WorkerCacheLogger* logger_;
@@ -23,6 +23,7 @@ limitations under the License.
 #include "grpcpp/alarm.h"
 #include "grpcpp/server_builder.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "xla/tsl/distributed_runtime/rpc/async_service_interface.h"
 #include "xla/tsl/distributed_runtime/rpc/grpc_call.h"
 #include "tensorflow/core/common_runtime/buf_rendezvous.h"
@@ -50,6 +51,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/tracing.h"
@@ -148,6 +150,7 @@ class GrpcWorkerServiceThread {
     SETUP_FOR_REQUEST(RunGraph, 100, true);
     SETUP_FOR_REQUEST(CleanupGraph, 100, false);
     SETUP_FOR_REQUEST(MarkRecvFinished, 10, false);
+    SETUP_FOR_REQUEST(RecvTensorBatch, 100, true);
 
     // TODO(ncteisen): Determine a better policy for enqueuing the
     // appropriate number of each request type.
@@ -301,6 +304,25 @@ class GrpcWorkerServiceThread {
     ENQUEUE_REQUEST(RecvBuf, true);
   }
 
+  void RecvTensorBatchHandler(
+      WorkerCall<RecvTensorBatchRequest, RecvTensorBatchResponse>* call) {
+    Schedule([this, call]() {
+      CallOptions* call_opts = new CallOptions;
+      call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+      worker_->RecvTensorBatchAsync(
+          call_opts, &call->request, &call->response,
+          [call, call_opts](const Status& s) {
+            call->ClearCancelCallback();
+            delete call_opts;
+            if (!s.ok()) {
+              VLOG(3) << "Bad response from RecvTensorBatch:" << s;
+            }
+            call->SendResponse(ToGrpcStatus(s));
+          });
+    });
+    ENQUEUE_REQUEST(RecvTensorBatch, true);
+  }
+
   void CompleteGroupHandler(
       WorkerCall<CompleteGroupRequest, CompleteGroupResponse>* call) {
     Schedule([this, call]() {
@@ -423,7 +445,8 @@ GrpcWorker::GrpcWorker(WorkerEnv* worker_env, const ConfigProto& config)
       recv_buf_max_chunk_(
           config.experimental().recv_buf_max_chunk() > 0
               ? config.experimental().recv_buf_max_chunk()
-              : (config.experimental().recv_buf_max_chunk() < 0 ? 0 : 4096)) {
+              : (config.experimental().recv_buf_max_chunk() < 0 ? 0 : 4096)),
+      batch_response_cache_(std::make_unique<RpcResponseCache>()) {
   if (config.rpc_options().cache_rpc_response()) {
     EnableResponseCache();
   }
@@ -465,17 +488,24 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
     return;
   }
 
-  auto rendezvous_done = [this, request_id, do_response, cache_enabled](
-                             const Tensor& tensor, bool is_dead,
-                             const Status& status) {
-    if (cache_enabled) {
-      // Data is ready. Process all pending requests in the response cache.
-      response_cache_->RequestFinished(request_id, tensor, is_dead, status);
-    } else {
-      do_response(tensor, is_dead, status);
-    }
-  };
+  RecvLocalTensorAsync(
+      opts, request,
+      [this, request_id, do_response, cache_enabled](
+          const Tensor& tensor, bool is_dead, const Status& status) {
+        if (cache_enabled) {
+          // Data is ready. Process all pending requests in the response cache.
+          response_cache_->RequestFinished(request_id, tensor, is_dead, status);
+        } else {
+          do_response(tensor, is_dead, status);
+        }
+      });
+}
 
+void GrpcWorker::RecvLocalTensorAsync(
+    CallOptions* opts, const RecvTensorRequest* request,
+    RpcResponseCache::FinishResponseCB rendezvous_done) {
+  const int64_t request_id = request->request_id();
+  const int64_t step_id = request->step_id();
   auto fail = [&rendezvous_done](const Status& status) {
     rendezvous_done(Tensor(), false, status);
   };
@@ -508,17 +538,19 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
   // failures, and the client might not observe any errors or cancellations but
   // simply waits for the responses. Aborting the step would report an error to
   // the client, and avoid permanent hanging in distributed function execution.
-  opts->SetCancelCallback([this, step_id]() {
-    LOG(WARNING) << "RecvTensor cancelled for " << step_id;
-    AbortStep(step_id);
-  });
+  if (opts != nullptr) {
+    opts->SetCancelCallback([this, step_id]() {
+      LOG(WARNING) << "RecvTensor cancelled for " << step_id;
+      AbortStep(step_id);
+    });
+  }
   env_->rendezvous_mgr->RecvLocalAsync(
       step_id, parsed,
       [opts, rendezvous_done, src_dev, request](
           const Status& status, const Rendezvous::Args& send_args,
           const Rendezvous::Args& recv_args, const Tensor& val,
           const bool is_dead) {
-        opts->ClearCancelCallback();
+        if (opts != nullptr) opts->ClearCancelCallback();
         if (!status.ok()) {
           return rendezvous_done(val, is_dead, status);
         }
@@ -554,6 +586,120 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
       });
 }
 
+void GrpcWorker::RecvTensorBatchAsync(CallOptions* opts,
+                                      const RecvTensorBatchRequest* request,
+                                      RecvTensorBatchResponse* response,
+                                      StatusCallback done) {
+  VLOG(3) << "RecvTensorBatchAsync req: " << request->requests_size()
+          << " tensors";
+  const int num_requests = request->requests_size();
+  if (num_requests == 0) {
+    done(absl::OkStatus());
+    return;
+  }
+
+  for (int i = 0; i < num_requests; ++i) {
+    if (request->requests(i).request_id() == 0) {
+      done(errors::InvalidArgument(
+          "RecvTensorBatch requires a request_id for every tensor"));
+      return;
+    }
+  }
+
+  // A tensor of the batch may only be produced once the receiver consumed
+  // another one, so waiting for all of them could deadlock the step. Instead,
+  // the response is sent as soon as one of the tensors is available, with the
+  // tensors available by then, and lists the others in `not_ready`. Their
+  // recvs go on, and the results are kept in `batch_response_cache_` until the
+  // receiver requests them again with the same request ids.
+  struct BatchState {
+    explicit BatchState(int num_requests) : ready(num_requests, false) {}
+    mutex mu;
+    // Whether the recvs of all the tensors have been started.
+    bool started TF_GUARDED_BY(mu) = false;
+    bool responded TF_GUARDED_BY(mu) = false;
+    std::vector<bool> ready TF_GUARDED_BY(mu);
+    int num_ready TF_GUARDED_BY(mu) = 0;
+    Status status TF_GUARDED_BY(mu);
+  };
+  auto state = std::make_shared<BatchState>(num_requests);
+  for (int i = 0; i < num_requests; ++i) {
+    response->add_responses();
+  }
+  auto maybe_respond = [state, opts, response, done]() {
+    Status status;
+    {
+      mutex_lock l(state->mu);
+      if (state->responded || !state->started || state->num_ready == 0) {
+        return;
+      }
+      state->responded = true;
+      for (int i = 0, n = state->ready.size(); i < n; ++i) {
+        if (!state->ready[i]) response->add_not_ready(i);
+      }
+      status = state->status;
+    }
+    opts->ClearCancelCallback();
+    done(status);
+  };
+
+  // As for RecvTensor, cancelling the RPC aborts the steps of the tensors.
+  absl::flat_hash_set<int64_t> step_ids;
+  for (const RecvTensorRequest& item_request : request->requests()) {
+    step_ids.insert(item_request.step_id());
+  }
+  opts->SetCancelCallback([this, step_ids]() {
+    for (const int64_t step_id : step_ids) {
+      LOG(WARNING) << "RecvTensorBatch cancelled for " << step_id;
+      AbortStep(step_id);
+    }
+  });
+
+  for (int i = 0; i < num_requests; ++i) {
+    auto item_done = [state, response, i, maybe_respond](
+                         const Tensor& tensor, bool is_dead,
+                         const Status& s) {
+      {
+        mutex_lock l(state->mu);
+        if (state->responded) return;
+        state->ready[i] = true;
+        ++state->num_ready;
+        state->status.Update(s);
+        if (s.ok()) {
+          RecvTensorResponse* item_response = response->mutable_responses(i);
+          item_response->set_is_dead(is_dead);
+          item_response->set_send_start_micros(Env::Default()->NowMicros());
+          item_response->set_require_ack(true);
+          if (!is_dead) {
+            tensor.AsProtoTensorContent(item_response->mutable_tensor());
+          }
+        }
+      }
+      maybe_respond();
+    };
+    // The request has to outlive the RPC if the tensor is not ready yet.
+    auto item_request =
+        std::make_shared<RecvTensorRequest>(request->requests(i));
+    const int64_t request_id = item_request->request_id();
+    if (batch_response_cache_->QueueRequest(
+            request_id, item_request->step_id(), item_done)) {
+      continue;
+    }
+    RecvLocalTensorAsync(
+        /*opts=*/nullptr, item_request.get(),
+        [this, item_request, request_id](const Tensor& tensor, bool is_dead,
+                                         const Status& status) {
+          batch_response_cache_->RequestFinished(request_id, tensor, is_dead,
+                                                 status);
+        });
+  }
+  {
+    mutex_lock l(state->mu);
+    state->started = true;
+  }
+  maybe_respond();
+}
+
 namespace {
 // If RecvBufRespExtra.tensor_content is a single large string, then gRPC
 // can stall on the recv side when the string buffer needs to be enlarged,
@@ -736,6 +882,7 @@ void GrpcWorker::CleanupGraphAsync(const CleanupGraphRequest* request,
     // a worker crashes before acking a request.
     response_cache_->CleanEntriesForStep(request->step_id());
   }
+  batch_response_cache_->CleanEntriesForStep(request->step_id());
   Worker::CleanupGraphAsync(request, response, done);
 }
 
@@ -745,6 +892,7 @@ void GrpcWorker::RemoveCacheEntryForId(int64_t request_id) {
   if (response_cache_) {
     response_cache_->EraseRequestId(request_id);
   }
+  batch_response_cache_->EraseRequestId(request_id);
 }
 
 std::unique_ptr<GrpcWorker> NewGrpcWorker(WorkerEnv* env,
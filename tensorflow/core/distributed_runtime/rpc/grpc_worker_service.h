@@ -51,6 +51,13 @@ class GrpcWorker : public Worker {
                                    ::grpc::ByteBuffer* response,
                                    StatusCallback done);
 
+  // Receives the tensors of `request`, and responds as soon as some of them are
+  // available. The others are listed in `response->not_ready()`.
+  void RecvTensorBatchAsync(CallOptions* opts,
+                            const RecvTensorBatchRequest* request,
+                            RecvTensorBatchResponse* response,
+                            StatusCallback done) override;
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override;
 
@@ -68,8 +75,18 @@ class GrpcWorker : public Worker {
   void RemoveCacheEntryForId(int64_t request_id);
 
  private:
+  // Receives the tensor of `request` from the local rendezvous, copied to host
+  // memory, and calls `rendezvous_done` with it. Cancelling `opts`, if not
+  // null, aborts the step.
+  void RecvLocalTensorAsync(CallOptions* opts,
+                            const RecvTensorRequest* request,
+                            RpcResponseCache::FinishResponseCB rendezvous_done);
+
   std::unique_ptr<RpcResponseCache> response_cache_;
   const int32 recv_buf_max_chunk_;
+  // Holds the tensors of RecvTensorBatch requests that were not ready when the
+  // response was sent, until they are requested again.
+  const std::unique_ptr<RpcResponseCache> batch_response_cache_;
 };
 
 std::unique_ptr<GrpcWorker> NewGrpcWorker(WorkerEnv* worker_env,
@@ -0,0 +1,75 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/remote_tensor_transport.h"
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+
+namespace {
+mutex* get_transport_factory_lock() {
+  static mutex transport_factory_lock(LINKER_INITIALIZED);
+  return &transport_factory_lock;
+}
+
+typedef std::unordered_map<std::string, RemoteTensorTransportRegistry::Factory>
+    TransportFactories;
+TransportFactories* transport_factories() {
+  static TransportFactories* factories = new TransportFactories;
+  return factories;
+}
+}  // namespace
+
+/* static */
+void RemoteTensorTransportRegistry::Register(const std::string& name,
+                                             Factory factory) {
+  mutex_lock l(*get_transport_factory_lock());
+  if (!transport_factories()->insert({name, std::move(factory)}).second) {
+    LOG(ERROR) << "Two remote tensor transports are being registered under "
+               << name;
+  }
+}
+
+/* static */
+Status RemoteTensorTransportRegistry::Create(
+    const std::string& name, const WorkerEnv* env,
+    std::unique_ptr<RemoteTensorTransport>* transport) {
+  transport->reset();
+  if (name.empty()) return absl::OkStatus();
+  Factory factory;
+  {
+    mutex_lock l(*get_transport_factory_lock());
+    auto it = transport_factories()->find(name);
+    if (it == transport_factories()->end()) {
+      return errors::NotFound("No remote tensor transport registered as ",
+                              name);
+    }
+    factory = it->second;
+  }
+  *transport = factory(env);
+  if (*transport == nullptr) {
+    return errors::Internal("Failed to create remote tensor transport ", name);
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace tensorflow
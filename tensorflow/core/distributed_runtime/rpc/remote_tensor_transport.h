@@ -0,0 +1,86 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_REMOTE_TENSOR_TRANSPORT_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_REMOTE_TENSOR_TRANSPORT_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/distributed_runtime/base_rendezvous_mgr.h"
+#include "tensorflow/core/distributed_runtime/worker_env.h"
+#include "tensorflow/core/distributed_runtime/worker_interface.h"
+#include "tensorflow/core/framework/rendezvous.h"
+#include "tensorflow/core/framework/tensor.h"
+
+namespace tensorflow {
+
+// A transport for the tensors that RpcRemoteRendezvous receives from other
+// workers, e.g. over RDMA with UCX or libfabric, used instead of the
+// RecvTensor RPC. The gRPC worker service stays in charge of control: a
+// transport may use the source worker's WorkerInterface to exchange
+// connection details or memory region keys, and move the tensor contents
+// itself, e.g. with one-sided reads from memory that it registered through
+// the allocator visitors of ProcessState and GPUProcessState.
+//
+// A transport is created once per worker, by RpcRendezvousMgr, and must be
+// thread-safe.
+class RemoteTensorTransport {
+ public:
+  // Receives one tensor. Like the RecvTensor RPC call, the call is registered
+  // with the rendezvous, so `StartAbort` may be called at any time after
+  // `Start`, and must make the call finish soon. `recv_done` must run exactly
+  // once, after which `status`, `tensor` and `is_dead` hold the result.
+  class RecvCall : public BaseRecvTensorCall {
+   public:
+    virtual const Tensor& tensor() const = 0;
+    virtual bool is_dead() const = 0;
+  };
+
+  virtual ~RemoteTensorTransport() = default;
+
+  // Returns a call that receives the tensor of `parsed` into `dst_device`, as
+  // allocated with `recv_args.alloc_attrs`, or nullptr if this transport
+  // does not handle it, in which case the RecvTensor RPC is used. `worker` is
+  // the source worker, which stays valid until the call's `recv_done` runs.
+  virtual std::unique_ptr<RecvCall> CreateRecvCall(
+      WorkerInterface* worker, int64_t step_id,
+      const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
+      Device* dst_device) = 0;
+};
+
+// Registry of the available RemoteTensorTransports. Transports are linked in
+// with a static "registrar" object that calls `Register`, and the one to use
+// is selected with the TF_RPC_RENDEZVOUS_TRANSPORT environment variable.
+class RemoteTensorTransportRegistry {
+ public:
+  typedef std::function<std::unique_ptr<RemoteTensorTransport>(
+      const WorkerEnv* env)>
+      Factory;
+
+  static void Register(const std::string& name, Factory factory);
+
+  // Returns a new transport of the registered `name`. Returns nullptr if `name`
+  // is empty, and an error if it is not registered or fails to be created.
+  static Status Create(const std::string& name, const WorkerEnv* env,
+                       std::unique_ptr<RemoteTensorTransport>* transport);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_REMOTE_TENSOR_TRANSPORT_H_
@@ -15,6 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
@@ -31,15 +37,80 @@ limitations under the License.
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
+// Decides which recvs are batched. As the size of a tensor is only known once
+// it is received, the policy remembers the size of the tensor last received
+// with each rendezvous key, which stays the same across steps.
+class RpcRecvBatchPolicy {
+ public:
+  explicit RpcRecvBatchPolicy(const RpcRendezvousMgr::RecvBatchOptions& options)
+      : options_(options) {}
+
+  const RpcRendezvousMgr::RecvBatchOptions& options() const {
+    return options_;
+  }
+
+  bool enabled() const { return options_.window_usecs > 0; }
+
+  // Returns whether the recv of `key` from `src_worker` should be batched, and
+  // if so sets `*num_bytes` to the size of the tensor last received with
+  // `key`.
+  bool ShouldBatch(const string& src_worker, StringPiece key,
+                   int64_t* num_bytes) const TF_LOCKS_EXCLUDED(mu_) {
+    tf_shared_lock l(mu_);
+    if (unsupported_workers_.contains(src_worker)) return false;
+    auto it = tensor_bytes_.find(key);
+    if (it == tensor_bytes_.end() || it->second > options_.max_tensor_bytes) {
+      return false;
+    }
+    *num_bytes = it->second;
+    return true;
+  }
+
+  void RecordTensorBytes(StringPiece key, int64_t num_bytes)
+      TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    auto it = tensor_bytes_.find(key);
+    if (it != tensor_bytes_.end()) {
+      it->second = num_bytes;
+    } else if (tensor_bytes_.size() < kMaxKeys) {
+      tensor_bytes_.emplace(string(key), num_bytes);
+    }
+  }
+
+  // Stops batching the recvs from `src_worker`, which does not support the
+  // RecvTensorBatch RPC.
+  void DisableBatching(const string& src_worker) TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    unsupported_workers_.insert(src_worker);
+  }
+
+ private:
+  // Bounds the memory used for the sizes, e.g. if keys change in every step.
+  static constexpr int kMaxKeys = 1 << 16;
+
+  const RpcRendezvousMgr::RecvBatchOptions options_;
+
+  mutable mutex mu_;
+  absl::flat_hash_map<string, int64_t> tensor_bytes_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_set<string> unsupported_workers_ TF_GUARDED_BY(mu_);
+};
+
 namespace {
 
+class RpcRecvTensorBatchCall;
+
 class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  public:
-  RpcRemoteRendezvous(const WorkerEnv* env, int64_t step_id)
-      : BaseRemoteRendezvous(env, step_id) {}
+  RpcRemoteRendezvous(const WorkerEnv* env, int64_t step_id,
+                      std::shared_ptr<RemoteTensorTransport> transport,
+                      std::shared_ptr<RpcRecvBatchPolicy> batch_policy)
+      : BaseRemoteRendezvous(env, step_id),
+        transport_(std::move(transport)),
+        batch_policy_(std::move(batch_policy)) {}
 
  protected:
   void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
@@ -49,6 +120,53 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  private:
   ~RpcRemoteRendezvous() override {}
 
+  // Receives a tensor with `call`, created by `transport_`, from the worker
+  // `rwi` named `src_worker`, and releases the worker when done.
+  void RecvFromTransportAsync(
+      std::unique_ptr<RemoteTensorTransport::RecvCall> call,
+      const string& src_worker, WorkerInterface* rwi,
+      const Rendezvous::Args& recv_args, DoneCallback done);
+
+  // Recvs from the same worker with the same cancellation manager are batched
+  // together, so that a batch can be registered as a single call.
+  using BatchKey = std::pair<string, CancellationManager*>;
+
+  struct PendingBatch {
+    RpcRecvTensorBatchCall* call = nullptr;
+    int64_t id = 0;
+    int64_t num_bytes = 0;
+  };
+
+  // Adds the recv of `parsed`, whose tensor is expected to have `num_bytes`,
+  // from the worker `rwi` named `src_worker` to the pending batch for that
+  // worker, and sends the batch if it is full. Otherwise, a new batch is sent
+  // after the batching window.
+  void EnqueueBatchedRecv(const Rendezvous::ParsedKey& parsed,
+                          const Rendezvous::Args& recv_args, Device* dst_device,
+                          const string& src_worker, WorkerInterface* rwi,
+                          int64_t num_bytes, DoneCallback done)
+      TF_LOCKS_EXCLUDED(batch_mu_);
+
+  // Sends the pending batch for `batch_key` if it is still the batch
+  // `batch_id`.
+  void FlushBatch(const BatchKey& batch_key, int64_t batch_id)
+      TF_LOCKS_EXCLUDED(batch_mu_);
+
+  // Sends `call`, and deletes it once all of its recvs are done.
+  void StartBatch(RpcRecvTensorBatchCall* call);
+
+  // Runs the callbacks of the recvs of `call`, which finished with `s`, and
+  // sends the recvs whose tensors were not ready yet in a new batch.
+  void FinishBatch(RpcRecvTensorBatchCall* call, Status s);
+
+  const std::shared_ptr<RemoteTensorTransport> transport_;
+  const std::shared_ptr<RpcRecvBatchPolicy> batch_policy_;
+
+  mutex batch_mu_;
+  absl::flat_hash_map<BatchKey, PendingBatch> pending_batches_
+      TF_GUARDED_BY(batch_mu_);
+  int64_t next_batch_id_ TF_GUARDED_BY(batch_mu_) = 0;
+
   RpcRemoteRendezvous(const RpcRemoteRendezvous&) = delete;
   void operator=(const RpcRemoteRendezvous&) = delete;
 };
@@ -230,6 +348,127 @@ static RpcRecvTensorFreeList* get_call_freelist() {
   return call_freelist;
 }
 
+// Used to retrieve several small tensors from the same remote worker with a
+// single RecvTensorBatch RPC.
+class RpcRecvTensorBatchCall : public BaseRecvTensorCall {
+ public:
+  struct Item {
+    Rendezvous::ParsedKey parsed;
+    Device* dst_device;
+    Rendezvous::Args recv_args;
+    Rendezvous::DoneCallback done;
+    // Set when the item is requested again because its tensor was not ready.
+    int64_t request_id = 0;
+  };
+
+  RpcRecvTensorBatchCall(const string& src_worker, WorkerInterface* wi,
+                         const Rendezvous::Args& recv_args)
+      : src_worker_(src_worker), wi_(wi), recv_args_(recv_args) {}
+
+  ~RpcRecvTensorBatchCall() override {
+    CHECK_EQ(static_cast<WorkerInterface*>(nullptr), wi_)
+        << "Leaking WorkerInterface in RpcRecvTensorBatchCall destructor.";
+  }
+
+  void Add(int64_t step_id, Item item) {
+    RecvTensorRequest* req = req_.add_requests();
+    req->set_step_id(step_id);
+    const StringPiece key = item.parsed.FullKey();
+    req->set_rendezvous_key(key.data(), key.size());
+    if (item.request_id == 0) item.request_id = GetUniqueRequestId();
+    req->set_request_id(item.request_id);
+    items_.push_back(std::move(item));
+  }
+
+  void Start(std::function<void()> recv_done) override {
+    recv_done_ = std::move(recv_done);
+    // Unlike RpcRecvTensorCall, the RPC may finish before it returns, e.g.
+    // when the worker doesn't support batching, so the callback can't wait for
+    // the abort check below. Instead, whichever of the two finishes last runs
+    // `recv_done_`, which might destroy the current call object.
+    wi_->RecvTensorBatchAsync(&opts_, &req_, &resp_, [this](const Status& s) {
+      bool abort_checked;
+      {
+        mutex_lock l(mu_);
+        status_.Update(s);
+        rpc_done_ = true;
+        abort_checked = abort_checked_;
+      }
+      if (abort_checked) RunRecvDone();
+    });
+
+    // NOTE: As in RpcRecvTensorCall, check if the rendezvous was aborted
+    // after sending out the RPC.
+    Status s;
+    {
+      mutex_lock l(mu_);
+      s = status_;
+    }
+    if (!s.ok()) {
+      opts_.StartCancel();
+    }
+    bool rpc_done;
+    {
+      mutex_lock l(mu_);
+      abort_checked_ = true;
+      rpc_done = rpc_done_;
+    }
+    if (rpc_done) RunRecvDone();
+  }
+
+  void StartAbort(const Status& s) override {
+    {
+      mutex_lock l(mu_);
+      status_.Update(s);
+    }
+    opts_.StartCancel();
+  }
+
+  Status status() const override {
+    mutex_lock l(mu_);
+    return status_;
+  }
+
+  void ReleaseWorker(WorkerCacheInterface* worker_cache) {
+    DCHECK_NE(static_cast<WorkerInterface*>(nullptr), wi_)
+        << "RpcRecvTensorBatchCall::ReleaseWorker() called twice.";
+    worker_cache->ReleaseWorker(src_worker_, wi_);
+    wi_ = nullptr;
+  }
+
+  int size() const { return items_.size(); }
+  std::vector<Item>* items() { return &items_; }
+  const RecvTensorBatchResponse& response() const { return resp_; }
+  const string& src_worker() const { return src_worker_; }
+  const Rendezvous::Args& recv_args() const { return recv_args_; }
+
+ private:
+  void RunRecvDone() {
+    std::function<void()> recv_done = std::move(recv_done_);
+    recv_done();
+  }
+
+  const string src_worker_;
+  WorkerInterface* wi_;  // Not owned.
+  const Rendezvous::Args recv_args_;
+  CallOptions opts_;
+  RecvTensorBatchRequest req_;
+  RecvTensorBatchResponse resp_;
+  std::vector<Item> items_;
+  std::function<void()> recv_done_;
+
+  mutable mutex mu_;
+  Status status_ TF_GUARDED_BY(mu_);
+  bool rpc_done_ TF_GUARDED_BY(mu_) = false;
+  bool abort_checked_ TF_GUARDED_BY(mu_) = false;
+
+  RpcRecvTensorBatchCall(const RpcRecvTensorBatchCall&) = delete;
+  void operator=(const RpcRecvTensorBatchCall&) = delete;
+};
+
+// The maximum number of recvs in a batch.
+constexpr int kMaxBatchSize = 1000;
+
 void RpcRemoteRendezvous::RecvFromRemoteAsync(
     const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
     DoneCallback done) {
@@ -269,6 +508,30 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
     return;
   }
 
+  if (transport_ != nullptr) {
+    std::unique_ptr<RemoteTensorTransport::RecvCall> transport_call =
+        transport_->CreateRecvCall(rwi, step_id_, parsed, recv_args,
+                                   dst_device);
+    if (transport_call != nullptr) {
+      const string src_worker = call->src_worker_;
+      get_call_freelist()->Release(call);
+      RecvFromTransportAsync(std::move(transport_call), src_worker, rwi,
+                             recv_args, std::move(done));
+      return;
+    }
+  }
+
+  int64_t num_bytes = 0;
+  if (batch_policy_->enabled() &&
+      batch_policy_->ShouldBatch(call->src_worker_, parsed.FullKey(),
+                                 &num_bytes)) {
+    const string src_worker = call->src_worker_;
+    get_call_freelist()->Release(call);
+    EnqueueBatchedRecv(parsed, recv_args, dst_device, src_worker, rwi,
+                       num_bytes, std::move(done));
+    return;
+  }
+
   call->Init(rwi, step_id_, parsed.FullKey(), recv_args.alloc_attrs, dst_device,
              recv_args, std::move(done));
 
@@ -295,6 +558,10 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
     // If StartAbort was called prior to DeregisterCall, then the
     // current status should be bad.
     Status s = call->status();
+    if (s.ok() && !call->is_dead() && batch_policy_->enabled()) {
+      batch_policy_->RecordTensorBytes(call->req_.rendezvous_key(),
+                                       call->tensor().TotalBytes());
+    }
     // NOTE: `*session()` can potentially be deleted before we return from
     // `call->done()(...)`, so we must release the worker before calling the
     // callback.
@@ -305,15 +572,248 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
   });
 }
 
+void RpcRemoteRendezvous::RecvFromTransportAsync(
+    std::unique_ptr<RemoteTensorTransport::RecvCall> transport_call,
+    const string& src_worker, WorkerInterface* rwi,
+    const Rendezvous::Args& recv_args, DoneCallback done) {
+  RemoteTensorTransport::RecvCall* call = transport_call.release();
+  WorkerSession* sess = session();
+  std::shared_ptr<WorkerCacheInterface> worker_cache =
+      sess->GetSharedWorkerCache();
+
+  // Record "call" in calls_ so that it can be aborted cleanly.
+  RegisterCall(call, recv_args);
+
+  // RendezvousMgr already aborted, shouldn't start the call any more.
+  if (!call->status().ok()) {
+    DeregisterCall(call, recv_args);
+    Status s = call->status();
+    sess->worker_cache()->ReleaseWorker(src_worker, rwi);
+    delete call;
+    done(s, Args(), Args(), Tensor(), false);
+    return;
+  }
+
+  Ref();
+  call->Start([this, call, src_worker, rwi, recv_args, worker_cache,
+               done = std::move(done)]() {
+    DeregisterCall(call, recv_args);
+    Status s = call->status();
+    // NOTE: `*session()` can potentially be deleted before we return from
+    // `done(...)`, so we must release the worker before calling the callback.
+    session()->worker_cache()->ReleaseWorker(src_worker, rwi);
+    done(s, Args(), recv_args, call->tensor(), call->is_dead());
+    delete call;
+    Unref();
+  });
+}
+
+void RpcRemoteRendezvous::EnqueueBatchedRecv(
+    const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
+    Device* dst_device, const string& src_worker, WorkerInterface* rwi,
+    int64_t num_bytes, DoneCallback done) {
+  const RpcRendezvousMgr::RecvBatchOptions& options = batch_policy_->options();
+  const BatchKey batch_key(src_worker, recv_args.cancellation_manager);
+  RpcRecvTensorBatchCall* full_batch = nullptr;
+  int64_t new_batch_id = -1;
+  {
+    mutex_lock l(batch_mu_);
+    PendingBatch& pending = pending_batches_[batch_key];
+    if (pending.call == nullptr) {
+      // The batch keeps the worker of its first recv, the workers of the other
+      // recvs are released below.
+      pending.call = new RpcRecvTensorBatchCall(src_worker, rwi, recv_args);
+      pending.id = next_batch_id_++;
+      new_batch_id = pending.id;
+      rwi = nullptr;
+    }
+    pending.call->Add(step_id_,
+                      {parsed, dst_device, recv_args, std::move(done)});
+    pending.num_bytes += num_bytes;
+    if (pending.num_bytes >= options.max_batch_bytes ||
+        pending.call->size() >= kMaxBatchSize) {
+      full_batch = pending.call;
+      pending_batches_.erase(batch_key);
+    }
+  }
+  if (rwi != nullptr) {
+    session()->worker_cache()->ReleaseWorker(src_worker, rwi);
+  }
+
+  if (full_batch != nullptr) {
+    StartBatch(full_batch);
+  } else if (new_batch_id >= 0) {
+    Ref();
+    env_->env->SchedClosureAfter(options.window_usecs,
+                                 [this, batch_key, new_batch_id]() {
+                                   FlushBatch(batch_key, new_batch_id);
+                                   Unref();
+                                 });
+  }
+}
+
+void RpcRemoteRendezvous::FlushBatch(const BatchKey& batch_key,
+                                     int64_t batch_id) {
+  RpcRecvTensorBatchCall* call;
+  {
+    mutex_lock l(batch_mu_);
+    auto it = pending_batches_.find(batch_key);
+    // The batch may have been sent already because it was full.
+    if (it == pending_batches_.end() || it->second.id != batch_id) return;
+    call = it->second.call;
+    pending_batches_.erase(it);
+  }
+  StartBatch(call);
+}
+
+void RpcRemoteRendezvous::StartBatch(RpcRecvTensorBatchCall* call) {
+  WorkerSession* sess = session();
+  std::shared_ptr<WorkerCacheInterface> worker_cache =
+      sess->GetSharedWorkerCache();
+
+  // Record "call" in calls_ so that it can be aborted cleanly.
+  RegisterCall(call, call->recv_args());
+
+  // RendezvousMgr already aborted, shouldn't send RPC call any more.
+  if (!call->status().ok()) {
+    DeregisterCall(call, call->recv_args());
+    call->ReleaseWorker(sess->worker_cache());
+    FinishBatch(call, call->status());
+    delete call;
+    return;
+  }
+
+  Ref();
+  call->Start([this, call, worker_cache]() {
+    DeregisterCall(call, call->recv_args());
+    Status s = call->status();
+    // NOTE: `*session()` can potentially be deleted before we return from
+    // the callbacks, so we must release the worker before calling them.
+    call->ReleaseWorker(session()->worker_cache());
+    FinishBatch(call, s);
+    delete call;
+    Unref();
+  });
+}
+
+void RpcRemoteRendezvous::FinishBatch(RpcRecvTensorBatchCall* call, Status s) {
+  std::vector<RpcRecvTensorBatchCall::Item>& items = *call->items();
+  if (errors::IsUnimplemented(s)) {
+    // The source worker can't batch, so receive the tensors one at a time.
+    VLOG(1) << "Not batching recvs from " << call->src_worker() << ": " << s;
+    batch_policy_->DisableBatching(call->src_worker());
+    for (RpcRecvTensorBatchCall::Item& item : items) {
+      RecvFromRemoteAsync(item.parsed, item.recv_args, std::move(item.done));
+    }
+    return;
+  }
+
+  const RecvTensorBatchResponse& response = call->response();
+  if (s.ok() && response.responses_size() != call->size()) {
+    s = errors::Internal("Expected ", call->size(),
+                         " tensors in the RecvTensorBatch response, got ",
+                         response.responses_size());
+  }
+  std::vector<bool> not_ready(call->size(), false);
+  if (s.ok() && response.not_ready_size() > 0) {
+    for (const int i : response.not_ready()) {
+      if (i < 0 || i >= call->size()) {
+        s = errors::Internal("Invalid index ", i,
+                             " in the RecvTensorBatch response");
+        break;
+      }
+      not_ready[i] = true;
+    }
+  }
+  if (s.ok() && response.not_ready_size() > 0) {
+    // Requests the tensors that were not ready again, with the same request
+    // ids so that the source worker answers from the recvs it already started.
+    WorkerInterface* rwi =
+        session()->worker_cache()->GetOrCreateWorker(call->src_worker());
+    if (rwi == nullptr) {
+      s = errors::Internal("No worker known as ", call->src_worker());
+    } else {
+      auto* retry = new RpcRecvTensorBatchCall(call->src_worker(), rwi,
+                                               call->recv_args());
+      for (int i = 0; i < call->size(); ++i) {
+        if (not_ready[i]) retry->Add(step_id_, std::move(items[i]));
+      }
+      StartBatch(retry);
+    }
+  }
+  for (int i = 0; i < call->size(); ++i) {
+    RpcRecvTensorBatchCall::Item& item = items[i];
+    if (!s.ok()) {
+      item.done(s, Args(), Args(), Tensor(), false);
+      continue;
+    }
+    if (not_ready[i]) continue;
+    const RecvTensorResponse& item_response = response.responses(i);
+    Tensor tensor;
+    Status item_status;
+    if (!item_response.is_dead()) {
+      item_status = item.dst_device->MakeTensorFromProto(
+          item_response.tensor(), item.recv_args.alloc_attrs, &tensor);
+      if (item_status.ok()) {
+        batch_policy_->RecordTensorBytes(item.parsed.FullKey(),
+                                         tensor.TotalBytes());
+      }
+    }
+    item.done(item_status, Args(), item.recv_args, tensor,
+              item_response.is_dead());
+  }
+}
+
+std::shared_ptr<RemoteTensorTransport> CreateTransportFromEnv(
+    const WorkerEnv* env) {
+  string name;
+  TF_CHECK_OK(ReadStringFromEnvVar("TF_RPC_RENDEZVOUS_TRANSPORT",
+                                   /*default_val=*/"", &name));
+  std::unique_ptr<RemoteTensorTransport> transport;
+  Status s = RemoteTensorTransportRegistry::Create(name, env, &transport);
+  if (!s.ok()) {
+    LOG(ERROR) << "Receiving remote tensors with the RecvTensor RPC: " << s;
+    return nullptr;
+  }
+  if (transport != nullptr) {
+    LOG(INFO) << "Receiving remote tensors with the " << name << " transport";
+  }
+  return transport;
+}
+
+RpcRendezvousMgr::RecvBatchOptions BatchOptionsFromEnv() {
+  RpcRendezvousMgr::RecvBatchOptions options;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_RPC_RECV_TENSOR_BATCH_WINDOW_USECS",
+                                  options.window_usecs,
+                                  &options.window_usecs));
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_RPC_RECV_TENSOR_BATCH_MAX_TENSOR_BYTES",
+                                  options.max_tensor_bytes,
+                                  &options.max_tensor_bytes));
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_RPC_RECV_TENSOR_BATCH_MAX_BYTES",
+                                  options.max_batch_bytes,
+                                  &options.max_batch_bytes));
+  return options;
+}
+
 }  // namespace
 
 RpcRendezvousMgr::RpcRendezvousMgr(const WorkerEnv* env)
-    : BaseRendezvousMgr(env) {}
+    : BaseRendezvousMgr(env),
+      transport_(CreateTransportFromEnv(env)),
+      batch_policy_(
+          std::make_shared<RpcRecvBatchPolicy>(BatchOptionsFromEnv())) {}
+
+RpcRendezvousMgr::RpcRendezvousMgr(
+    const WorkerEnv* env, std::unique_ptr<RemoteTensorTransport> transport,
+    const RecvBatchOptions& batch_options)
+    : BaseRendezvousMgr(env),
+      transport_(std::move(transport)),
+      batch_policy_(std::make_shared<RpcRecvBatchPolicy>(batch_options)) {}
 
 tsl::core::RefCountPtr<BaseRemoteRendezvous> RpcRendezvousMgr::Create(
     int64_t step_id, const WorkerEnv* worker_env) {
   return tsl::core::RefCountPtr<BaseRemoteRendezvous>(
-      new RpcRemoteRendezvous(worker_env, step_id));
+      new RpcRemoteRendezvous(worker_env, step_id, transport_, batch_policy_));
 }
 
 }  // end namespace tensorflow
@@ -16,13 +16,18 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RPC_RENDEZVOUS_MGR_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RPC_RENDEZVOUS_MGR_H_
 
+#include <cstdint>
+#include <memory>
+
 #include "tensorflow/core/distributed_runtime/base_rendezvous_mgr.h"
+#include "tensorflow/core/distributed_runtime/rpc/remote_tensor_transport.h"
 #include "tensorflow/core/distributed_runtime/worker_env.h"
 #include "tensorflow/core/platform/macros.h"
 
 namespace tensorflow {
 
 class DeviceMgr;
+class RpcRecvBatchPolicy;
 
 // RendezvousMgr keeps track of a set of local rendezvous instances.
 // All tensors sent by this worker are buffered in a RendezvousMgr
@@ -42,15 +47,48 @@ class DeviceMgr;
 //
 // Tensors sent and recved through rendezvous managed by this
 // RendezvousMgr must have keys generated by Rendezvous::CreateKey.
+//
+// Remote tensors are received with the RecvTensor RPC, unless a
+// RemoteTensorTransport handles them. If batching is enabled, concurrent
+// recvs of tensors that were small in earlier steps are coalesced into
+// RecvTensorBatch RPCs to their source worker.
 class RpcRendezvousMgr : public BaseRendezvousMgr {
  public:
+  struct RecvBatchOptions {
+    // How long a batch waits for more recvs before it is sent. Zero disables
+    // batching.
+    int64_t window_usecs = 0;
+
+    // Only tensors whose last received size is at most this many bytes are
+    // batched.
+    int64_t max_tensor_bytes = 4096;
+
+    // A batch is sent as soon as its expected size reaches this many bytes.
+    int64_t max_batch_bytes = 256 << 10;
+  };
+
+  // Uses the RemoteTensorTransport named by the TF_RPC_RENDEZVOUS_TRANSPORT
+  // environment variable, if any, and batches recvs as configured by the
+  // TF_RPC_RECV_TENSOR_BATCH_WINDOW_USECS,
+  // TF_RPC_RECV_TENSOR_BATCH_MAX_TENSOR_BYTES and
+  // TF_RPC_RECV_TENSOR_BATCH_MAX_BYTES environment variables.
   explicit RpcRendezvousMgr(const WorkerEnv* env);
 
+  // Uses `transport`, which may be null, to receive remote tensors, and
+  // batches recvs as configured by `batch_options`.
+  RpcRendezvousMgr(const WorkerEnv* env,
+                   std::unique_ptr<RemoteTensorTransport> transport,
+                   const RecvBatchOptions& batch_options = RecvBatchOptions());
+
  protected:
   tsl::core::RefCountPtr<BaseRemoteRendezvous> Create(
       int64_t step_id, const WorkerEnv* worker_env) override;
 
  private:
+  // Shared with the rendezvous, which may outlive this manager.
+  std::shared_ptr<RemoteTensorTransport> transport_;
+  std::shared_ptr<RpcRecvBatchPolicy> batch_policy_;
+
   RpcRendezvousMgr(const RpcRendezvousMgr&) = delete;
   void operator=(const RpcRendezvousMgr&) = delete;
 };
@@ -15,13 +15,22 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/distributed_runtime/rpc/remote_tensor_transport.h"
 #include "tensorflow/core/distributed_runtime/test_utils.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/control_flow.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
@@ -99,12 +108,135 @@ class DummyWorkerCache : public WorkerCacheInterface {
   DummyWorker* dummy_remote_worker_ = nullptr;
 };
 
+// A worker that answers RecvTensorBatch requests, if it supports them, with
+// the edge names of the requested tensors. If `max_ready_per_batch` is
+// positive, only that many tensors of each batch are ready.
+class BatchingWorker : public DummyWorker {
+ public:
+  explicit BatchingWorker(bool supports_batching, int max_ready_per_batch)
+      : supports_batching_(supports_batching),
+        max_ready_per_batch_(max_ready_per_batch) {}
+
+  void RecvTensorBatchAsync(CallOptions* opts,
+                            const RecvTensorBatchRequest* request,
+                            RecvTensorBatchResponse* response,
+                            StatusCallback done) override {
+    num_batches_.fetch_add(1);
+    if (!supports_batching_) {
+      WorkerInterface::RecvTensorBatchAsync(opts, request, response,
+                                            std::move(done));
+      return;
+    }
+    num_batched_tensors_.fetch_add(request->requests_size());
+    for (int i = 0; i < request->requests_size(); ++i) {
+      const RecvTensorRequest& req = request->requests(i);
+      {
+        mutex_lock l(mu_);
+        request_ids_.insert(req.request_id());
+      }
+      RecvTensorResponse* item_response = response->add_responses();
+      if (max_ready_per_batch_ > 0 && i >= max_ready_per_batch_) {
+        response->add_not_ready(i);
+        continue;
+      }
+      Rendezvous::ParsedKey parsed = MakeKey(req.rendezvous_key());
+      V(string(parsed.edge_name)).AsProtoField(item_response->mutable_tensor());
+    }
+    SchedClosure([done = std::move(done)]() { done(absl::OkStatus()); });
+  }
+
+  int num_batches() const { return num_batches_.load(); }
+  int num_batched_tensors() const { return num_batched_tensors_.load(); }
+  int num_request_ids() const {
+    mutex_lock l(mu_);
+    return request_ids_.size();
+  }
+
+ private:
+  const bool supports_batching_;
+  const int max_ready_per_batch_;
+  std::atomic<int> num_batches_{0};
+  std::atomic<int> num_batched_tensors_{0};
+  mutable mutex mu_;
+  absl::flat_hash_set<int64_t> request_ids_ TF_GUARDED_BY(mu_);
+};
+
+// A worker cache that always returns the same BatchingWorker.
+class BatchingWorkerCache : public DummyWorkerCache {
+ public:
+  explicit BatchingWorkerCache(bool supports_batching, int max_ready_per_batch)
+      : worker_(supports_batching, max_ready_per_batch) {}
+
+  WorkerInterface* GetOrCreateWorker(const string& target) override {
+    return &worker_;
+  }
+  void ReleaseWorker(const string& target, WorkerInterface* worker) override {}
+
+  const BatchingWorker& worker() const { return worker_; }
+
+ private:
+  BatchingWorker worker_;
+};
+
+// A transport that receives the tensors named "via_transport", producing their
+// source device name.
+class FakeTransport : public RemoteTensorTransport {
+ public:
+  class Call : public RecvCall {
+   public:
+    explicit Call(const string& src_device) : tensor_(V(src_device)) {}
+
+    void Start(std::function<void()> recv_done) override {
+      SchedClosure(std::move(recv_done));
+    }
+    void StartAbort(const Status& s) override {
+      mutex_lock l(mu_);
+      status_.Update(s);
+    }
+    Status status() const override {
+      mutex_lock l(mu_);
+      return status_;
+    }
+    const Tensor& tensor() const override { return tensor_; }
+    bool is_dead() const override { return false; }
+
+   private:
+    mutable mutex mu_;
+    Status status_ TF_GUARDED_BY(mu_);
+    const Tensor tensor_;
+  };
+
+  std::unique_ptr<RecvCall> CreateRecvCall(
+      WorkerInterface* worker, int64_t step_id,
+      const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
+      Device* dst_device) override {
+    if (parsed.edge_name != "via_transport") return nullptr;
+    num_calls_.fetch_add(1);
+    return std::make_unique<Call>(string(parsed.src_device));
+  }
+
+  int num_calls() const { return num_calls_.load(); }
+
+ private:
+  std::atomic<int> num_calls_{0};
+};
+
 static Device* CreateDevice(const char* type, const char* name) {
   class FakeDevice : public Device {
    public:
     explicit FakeDevice(const DeviceAttributes& attr) : Device(nullptr, attr) {}
     Status Sync() override { return absl::OkStatus(); }
     Allocator* GetAllocator(AllocatorAttributes) override { return nullptr; }
+    Status MakeTensorFromProto(const TensorProto& tensor_proto,
+                               const AllocatorAttributes alloc_attrs,
+                               Tensor* tensor) override {
+      Tensor parsed(tensor_proto.dtype());
+      if (!parsed.FromProto(cpu_allocator(), tensor_proto)) {
+        return errors::InvalidArgument("Cannot parse tensor from proto");
+      }
+      *tensor = std::move(parsed);
+      return absl::OkStatus();
+    }
   };
   DeviceAttributes attr;
   attr.set_name(name);
@@ -305,6 +437,159 @@ TEST_F(RpcRendezvousMgrTest, RemoteRecvOne) {
   rmgr_.Cleanup(step_id);
 }
 
+TEST_F(RpcRendezvousMgrTest, RemoteRecvThroughTransport) {
+  const int64_t step_id = 123;
+  const string src_device = "/job:worker/replica:1/task:2/cpu:0";
+  auto transport = std::make_unique<FakeTransport>();
+  FakeTransport* fake_transport = transport.get();
+  RpcRendezvousMgr rmgr(&env, std::move(transport));
+  {
+    tsl::core::RefCountPtr<RemoteRendezvous> rendez = rmgr.Find(step_id);
+    TF_ASSERT_OK(rendez->Initialize(&worker_session_));
+    Rendezvous::Args args;
+    Tensor val(DT_STRING);
+    bool val_dead = false;
+
+    TF_ASSERT_OK(rendez->Recv(
+        MakeKey(Rendezvous::CreateKey(src_device, 7890,
+                                      "/job:mnist/replica:1/task:2/cpu:1",
+                                      "via_transport", FrameAndIter(0, 0))),
+        args, &val, &val_dead));
+    EXPECT_EQ(V(val), src_device);
+    EXPECT_EQ(fake_transport->num_calls(), 1);
+
+    // Tensors that the transport doesn't handle use the RecvTensor RPC.
+    TF_ASSERT_OK(rendez->Recv(
+        MakeKey(Rendezvous::CreateKey(src_device, 7890,
+                                      "/job:mnist/replica:1/task:2/cpu:1",
+                                      "foo", FrameAndIter(0, 0))),
+        args, &val, &val_dead));
+    EXPECT_EQ(fake_transport->num_calls(), 1);
+  }
+  rmgr.Cleanup(step_id);
+}
+
+TEST(RemoteTensorTransportRegistryTest, Create) {
+  RemoteTensorTransportRegistry::Register("fake", [](const WorkerEnv*) {
+    return std::make_unique<FakeTransport>();
+  });
+  std::unique_ptr<RemoteTensorTransport> transport;
+  TF_ASSERT_OK(RemoteTensorTransportRegistry::Create("fake", nullptr,
+                                                     &transport));
+  EXPECT_NE(transport, nullptr);
+  TF_ASSERT_OK(RemoteTensorTransportRegistry::Create("", nullptr, &transport));
+  EXPECT_EQ(transport, nullptr);
+  EXPECT_TRUE(errors::IsNotFound(
+      RemoteTensorTransportRegistry::Create("unknown", nullptr, &transport)));
+}
+
+class RpcRendezvousMgrBatchingTest : public RpcRendezvousMgrTest {
+ protected:
+  static constexpr int kNumTensors = 10;
+
+  void CreateSession(bool supports_batching, int max_ready_per_batch = 0) {
+    batching_cache_ =
+        new BatchingWorkerCache(supports_batching, max_ready_per_batch);
+    batching_session_ = std::make_unique<WorkerSession>(
+        "batching_session", "/job:mnist/replica:1/task:2",
+        std::unique_ptr<WorkerCacheInterface>(batching_cache_),
+        std::unique_ptr<DeviceMgr>(CreateDeviceMgr()),
+        std::unique_ptr<GraphMgr>(), nullptr,
+        [](WorkerSession* worker_session, bool called,
+           DeviceMgr* remote_device_mgr) { return nullptr; });
+  }
+
+  // Receives `kNumTensors` remote tensors concurrently in step `step_id`,
+  // and returns the received values.
+  std::vector<Tensor> RecvAll(RpcRendezvousMgr* rmgr, int64_t step_id) {
+    std::vector<Tensor> values(kNumTensors);
+    {
+      tsl::core::RefCountPtr<RemoteRendezvous> rendez = rmgr->Find(step_id);
+      TF_CHECK_OK(rendez->Initialize(batching_session_.get()));
+      Rendezvous::Args args;
+      mutex mu;
+      Status status;
+      BlockingCounter counter(kNumTensors);
+      for (int i = 0; i < kNumTensors; ++i) {
+        rendez->RecvAsync(
+            MakeKey(Rendezvous::CreateKey(
+                "/job:worker/replica:1/task:2/cpu:0", 7890,
+                "/job:mnist/replica:1/task:2/cpu:1", strings::StrCat("t", i),
+                FrameAndIter(0, 0))),
+            args,
+            [&, i](const Status& s, const Rendezvous::Args&,
+                   const Rendezvous::Args&, const Tensor& val, const bool) {
+              {
+                mutex_lock l(mu);
+                status.Update(s);
+                values[i] = val;
+              }
+              counter.DecrementCount();
+            });
+      }
+      counter.Wait();
+      TF_EXPECT_OK(status);
+    }
+    rmgr->Cleanup(step_id);
+    return values;
+  }
+
+  RpcRendezvousMgr::RecvBatchOptions BatchOptions() {
+    RpcRendezvousMgr::RecvBatchOptions options;
+    options.window_usecs = 100 * 1000;
+    return options;
+  }
+
+  BatchingWorkerCache* batching_cache_;  // Owned by batching_session_.
+  std::unique_ptr<WorkerSession> batching_session_;
+};
+
+TEST_F(RpcRendezvousMgrBatchingTest, BatchesSmallTensors) {
+  CreateSession(/*supports_batching=*/true);
+  RpcRendezvousMgr rmgr(&env, /*transport=*/nullptr, BatchOptions());
+
+  // The sizes of the tensors are unknown in the first step.
+  RecvAll(&rmgr, 1);
+  EXPECT_EQ(batching_cache_->worker().num_batches(), 0);
+
+  std::vector<Tensor> values = RecvAll(&rmgr, 2);
+  EXPECT_GE(batching_cache_->worker().num_batches(), 1);
+  EXPECT_EQ(batching_cache_->worker().num_batched_tensors(), kNumTensors);
+  for (int i = 0; i < kNumTensors; ++i) {
+    EXPECT_EQ(V(values[i]), strings::StrCat("t", i));
+  }
+}
+
+TEST_F(RpcRendezvousMgrBatchingTest, RequestsTensorsThatWereNotReadyAgain) {
+  CreateSession(/*supports_batching=*/true, /*max_ready_per_batch=*/1);
+  RpcRendezvousMgr rmgr(&env, /*transport=*/nullptr, BatchOptions());
+
+  RecvAll(&rmgr, 1);
+  std::vector<Tensor> values = RecvAll(&rmgr, 2);
+  // Every batch delivers one tensor, and the others are requested again with
+  // the same request ids.
+  EXPECT_EQ(batching_cache_->worker().num_batches(), kNumTensors);
+  EXPECT_GT(batching_cache_->worker().num_batched_tensors(), kNumTensors);
+  EXPECT_EQ(batching_cache_->worker().num_request_ids(), kNumTensors);
+  for (int i = 0; i < kNumTensors; ++i) {
+    EXPECT_EQ(V(values[i]), strings::StrCat("t", i));
+  }
+}
+
+TEST_F(RpcRendezvousMgrBatchingTest, FallsBackWithoutBatchSupport) {
+  CreateSession(/*supports_batching=*/false);
+  RpcRendezvousMgr rmgr(&env, /*transport=*/nullptr, BatchOptions());
+
+  RecvAll(&rmgr, 1);
+  RecvAll(&rmgr, 2);
+  const int num_batches = batching_cache_->worker().num_batches();
+  EXPECT_GE(num_batches, 1);
+
+  // Batching is disabled for the worker after the first failed batch.
+  RecvAll(&rmgr, 3);
+  EXPECT_EQ(batching_cache_->worker().num_batches(), num_batches);
+}
+
 TEST_F(RpcRendezvousMgrTest, RemoteRecvAsyncMany) {
   const int64_t step_id = 123;
   const Rendezvous::ParsedKey key = MakeKey(Rendezvous::CreateKey(
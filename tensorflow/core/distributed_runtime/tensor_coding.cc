@@ -30,6 +30,7 @@ void TensorResponse::Clear() {
   device_ = nullptr;
   alloc_attrs_ = AllocatorAttributes();
   allocator_ = nullptr;
+  host_allocator_ = nullptr;
   already_used_ = false;
   ClearTensor();
 }
@@ -48,6 +49,16 @@ void TensorResponse::InitAlloc(DeviceBase* d, const AllocatorAttributes& aa) {
     on_host_ = true;
   }
   allocator_ = device_->GetAllocator(alloc_attrs_);
+  if (on_host_) {
+    host_allocator_ = allocator_;
+  } else if (d->tensorflow_accelerator_device_info() != nullptr &&
+             d->tensorflow_accelerator_device_info()->default_context !=
+                 nullptr) {
+    AllocatorAttributes host_attrs;
+    host_attrs.set_on_host(true);
+    host_attrs.set_gpu_compatible(true);
+    host_allocator_ = device_->GetAllocator(host_attrs);
+  }
 }
 
 Status TensorResponse::InitFrom(RecvTensorResponse* response) {
@@ -80,6 +91,18 @@ void TensorResponse::InitPartial(const RecvTensorResponse& response,
 }
 
 Status TensorResponse::ParseFrom(Source* source) {
+  if (!on_host_ && host_allocator_ != nullptr) {
+    // Parse the contents straight into pinned host memory, and copy them to
+    // the device from there, instead of parsing a TensorProto first.
+    if (already_used_) {
+      ClearTensor();
+    }
+    already_used_ = true;
+    if (ParseFast(source) && tensor_.dtype() != DT_INVALID) {
+      return CopyToDevice();
+    }
+    ClearTensor();
+  }
   if (!on_host_) {
     protobuf::io::CodedInputStream input(source->contents());
 
@@ -155,7 +178,7 @@ bool TensorResponse::ParseTensorSubmessage(
       if (ok && !seen_tensor_content) {
         // No tensor content: could be because it's a zero-length tensor
         TensorShape shape(tensor_meta->tensor_shape());
-        Tensor t(allocator_, tensor_meta->dtype(), shape);
+        Tensor t(host_allocator_, tensor_meta->dtype(), shape);
         tensor_ = std::move(t);
       }
       return ok;
@@ -195,7 +218,7 @@ bool TensorResponse::ParseTensorSubmessage(
         if (!ReadVarintSizeAsInt(input, &num_bytes)) return false;
         seen_tensor_content = true;
         TensorShape shape(tensor_meta->tensor_shape());
-        Tensor t(allocator_, tensor_meta->dtype(), shape);
+        Tensor t(host_allocator_, tensor_meta->dtype(), shape);
         StringPiece buf = t.tensor_data();
         if (static_cast<size_t>(num_bytes) != buf.size()) return false;
         // TODO(jeff,sanjay): Figure out a way to avoid this copy if
@@ -275,6 +298,21 @@ bool TensorResponse::ParseFast(Source* source) {
   return false;
 }
 
+Status TensorResponse::CopyToDevice() {
+  Tensor host_tensor = std::move(tensor_);
+  Tensor device_tensor(allocator_, host_tensor.dtype(), host_tensor.shape());
+  if (host_tensor.NumElements() > 0) {
+    TF_RETURN_IF_ERROR(
+        device_->tensorflow_accelerator_device_info()
+            ->default_context->CopyCPUTensorToDeviceSync(
+                &host_tensor, static_cast<Device*>(device_), &device_tensor));
+  }
+  tensor_ = std::move(device_tensor);
+  // Like the slow path, keep only the metadata of the tensor.
+  meta_.clear_tensor();
+  return absl::OkStatus();
+}
+
 bool TensorResponse::ParseSlow(Source* source) {
   if (!meta_.ParseFromZeroCopyStream(source->contents())) {
     return false;
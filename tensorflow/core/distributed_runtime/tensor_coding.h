@@ -95,11 +95,17 @@ class TensorResponse {
                              TensorProto* tensor_meta);
   bool ParseFast(Source* source);
   bool ParseSlow(Source* source);
+  Status CopyToDevice();
 
   bool on_host_ = false;
   DeviceBase* device_ = nullptr;
   AllocatorAttributes alloc_attrs_;
   Allocator* allocator_ = nullptr;
+  // Allocator of the host memory that the fast path parses tensor contents
+  // into. For accelerator destinations this is pinned memory, from which the
+  // contents are copied to the device, and nullptr if the device has no
+  // accelerator device context.
+  Allocator* host_allocator_ = nullptr;
   bool already_used_ = false;
   Tensor tensor_;
   RecvTensorResponse meta_;
@@ -15,10 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include "tensorflow/core/framework/device.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
@@ -46,6 +48,57 @@ class DummyDevice : public DeviceBase {
   DeviceAttributes attr_;
 };
 
+// Copies "device" tensors, which live in host memory, with memcpy.
+class FakeAcceleratorDeviceContext : public DeviceContext {
+ public:
+  void CopyCPUTensorToDevice(const Tensor* cpu_tensor, Device* device,
+                             Tensor* device_tensor, StatusCallback done,
+                             bool sync_dst_compute) const override {
+    ++num_copies_;
+    memcpy(const_cast<char*>(device_tensor->tensor_data().data()),
+           cpu_tensor->tensor_data().data(), cpu_tensor->TotalBytes());
+    done(absl::OkStatus());
+  }
+
+  int num_copies() const { return num_copies_; }
+
+ private:
+  mutable int num_copies_ = 0;
+};
+
+class FakeAcceleratorDevice : public Device {
+ public:
+  explicit FakeAcceleratorDevice(Env* env)
+      : Device(env, MakeAttributes()),
+        context_(new FakeAcceleratorDeviceContext) {
+    accelerator_device_info_.default_context = context_;
+    set_tensorflow_accelerator_device_info(&accelerator_device_info_);
+  }
+  ~FakeAcceleratorDevice() override { context_->Unref(); }
+
+  Status Sync() override { return absl::OkStatus(); }
+
+  Allocator* GetAllocator(AllocatorAttributes attr) override {
+    if (attr.on_host() && attr.gpu_compatible()) ++num_pinned_allocators_;
+    return cpu_allocator();
+  }
+
+  const FakeAcceleratorDeviceContext& context() const { return *context_; }
+  int num_pinned_allocators() const { return num_pinned_allocators_; }
+
+ private:
+  static DeviceAttributes MakeAttributes() {
+    DeviceAttributes attributes;
+    attributes.set_name("/job:a/replica:0/task:0/device:GPU:0");
+    attributes.set_device_type("GPU");
+    return attributes;
+  }
+
+  FakeAcceleratorDeviceContext* context_;
+  AcceleratorDeviceInfo accelerator_device_info_;
+  int num_pinned_allocators_ = 0;
+};
+
 class StringSource : public TensorResponse::Source {
  public:
   explicit StringSource(const string* s, int block_size)
@@ -156,6 +209,31 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(TensorResponseTest, AcceleratorDestination) {
+  Tensor src(DT_FLOAT, TensorShape({4, 100}));
+  test::FillIota<float>(&src, 1.0f);
+  RecvTensorResponse proto;
+  proto.set_send_start_micros(123456);
+  src.AsProtoTensorContent(proto.mutable_tensor());
+  string encoded;
+  proto.AppendToString(&encoded);
+
+  FakeAcceleratorDevice device(Env::Default());
+  TensorResponse response;
+  response.InitAlloc(&device, AllocatorAttributes());
+  EXPECT_EQ(device.num_pinned_allocators(), 1);
+  for (int i = 0; i < 2; i++) {  // Twice so we exercise reuse of "response"
+    StringSource source(&encoded, 128);
+    TF_EXPECT_OK(response.ParseFrom(&source));
+    EXPECT_EQ(response.metadata().send_start_micros(), 123456);
+    EXPECT_FALSE(response.metadata().has_tensor());
+    test::ExpectTensorEqual<float>(response.tensor(), src);
+  }
+  // The contents were parsed into host memory and copied once per response,
+  // instead of being parsed into a TensorProto first.
+  EXPECT_EQ(device.context().num_copies(), 2);
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
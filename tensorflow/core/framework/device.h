@@ -31,6 +31,7 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/control_flow.h"
@@ -156,6 +157,16 @@ class Device : public DeviceBase {
     return OkStatus();
   }
 
+  // Fills in `device_context_map`, indexed by node id, with the DeviceContext
+  // each node of `graph` should run with. A nullptr entry, or an empty map,
+  // means the node runs with the default context of the device. The device
+  // keeps ownership of the returned contexts, which must outlive `graph`.
+  virtual Status FillContextMap(
+      const Graph* /*graph*/,
+      std::vector<DeviceContext*>* /*device_context_map*/) {
+    return OkStatus();
+  }
+
   // Returns the op segment of this device.  The caller can reuse op
   // kernels registered for the same session running on this device.
   OpSegment* op_segment() { return &op_seg_; }
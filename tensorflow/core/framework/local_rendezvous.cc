@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/framework/local_rendezvous.h"
 
 #include <memory>
+#include <new>
 #include <string>
 #include <utility>
 
@@ -106,6 +107,26 @@ struct LocalRendezvous::Item {
   }
 };
 
+namespace {
+// The maximum number of free items kept by each bucket.
+constexpr size_t kMaxFreeItemsPerBucket = 64;
+}  // namespace
+
+void* LocalRendezvous::TableBucket::AllocateItem() {
+  if (free_items.empty()) return ::operator new(sizeof(Item));
+  void* item = free_items.back();
+  free_items.pop_back();
+  return item;
+}
+
+void LocalRendezvous::TableBucket::ReleaseItem(void* item) {
+  if (free_items.size() < kMaxFreeItemsPerBucket) {
+    free_items.push_back(item);
+  } else {
+    ::operator delete(item);
+  }
+}
+
 void LocalRendezvous::ItemQueue::push_back(Item* item) {
   if (TF_PREDICT_TRUE(head == nullptr)) {
     // The queue is empty.
@@ -130,6 +151,10 @@ LocalRendezvous::~LocalRendezvous() {
         bucket.pending_callback_cond_var.wait_for(
             l, std::chrono::milliseconds(50));
       }
+      for (void* item : bucket.free_items) {
+        ::operator delete(item);
+      }
+      bucket.free_items.clear();
     }
     if (!bucket.table.empty()) {
       table_not_empty = true;
@@ -140,14 +165,10 @@ LocalRendezvous::~LocalRendezvous() {
   }
 }
 
-namespace {
-uint64 KeyHash(const StringPiece& k) { return Hash64(k.data(), k.size()); }
-}  // namespace
-
 Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
                              const Rendezvous::Args& send_args,
                              const Tensor& val, const bool is_dead) {
-  uint64 key_hash = KeyHash(key.FullKey());
+  const uint64 key_hash = key.FullKeyHash();
   DVLOG(2) << "Send " << this << " " << key_hash << " " << key.FullKey();
 
   if (is_dead) {
@@ -160,7 +181,9 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
         ->IncrementBy(1);
   }
 
-  TF_RETURN_IF_ERROR(status());
+  if (TF_PREDICT_FALSE(aborted_.load(std::memory_order_acquire))) {
+    TF_RETURN_IF_ERROR(status());
+  }
 
   int bucket_index = key_hash % num_buckets_;
   auto& bucket = table_buckets_[bucket_index];
@@ -172,8 +195,6 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
     // There is no waiter for this message. Append the message
     // into the queue. The waiter will pick it up when arrives.
     // Only send-related fields need to be filled.
-    // TODO(b/143786186): Investigate moving the allocation of `Item` outside
-    // the lock.
     auto rc_owner = tsl::core::GetNewRef(rc_owner_);
     DVLOG(2) << "Enqueue Send Item (key:" << key.FullKey() << "). ";
     activity_watcher::ActivityScope activity_scope(
@@ -188,8 +209,9 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
               });
         },
         /*level=*/1);
-    queue->push_back(new Item(std::move(rc_owner), send_args, val, is_dead,
-                              std::move(activity_scope)));
+    queue->push_back(new (bucket.AllocateItem()) Item(
+        std::move(rc_owner), send_args, val, is_dead,
+        std::move(activity_scope)));
     bucket.mu.unlock();
     return OkStatus();
   }
@@ -211,30 +233,34 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
 
   DCHECK_EQ(item->type, Item::kRecv);
   (*item->recv_state.waiter)(OkStatus(), send_args, item->args, val, is_dead);
+  // Release the owner at last since it may destruct the rendezvous.
+  auto rc_owner = std::move(item->rc_owner);
+  item->~Item();
   {
     mutex_lock l(bucket.mu);
+    bucket.ReleaseItem(item);
     bucket.pending_callback_counter--;
     if (bucket.pending_callback_counter == 0) {
       bucket.pending_callback_cond_var.notify_all();
     }
   }
-  // Delete the item at last since it may unref and destruct the rendezvous.
-  delete item;
   return OkStatus();
 }
 
 void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
                                 const Rendezvous::Args& recv_args,
                                 Rendezvous::DoneCallback done) {
-  uint64 key_hash = KeyHash(key.FullKey());
+  const uint64 key_hash = key.FullKeyHash();
   DVLOG(2) << "Recv " << this << " " << key_hash << " " << key.FullKey();
   tsl::core::RefCountPtr<Rendezvous> rc_keep_alive;
 
-  auto s = status();
-  if (!s.ok()) {
-    // Rendezvous has been aborted.
-    done(s, Rendezvous::Args(), recv_args, Tensor(), false);
-    return;
+  if (TF_PREDICT_FALSE(aborted_.load(std::memory_order_acquire))) {
+    auto s = status();
+    if (!s.ok()) {
+      // Rendezvous has been aborted.
+      done(s, Rendezvous::Args(), recv_args, Tensor(), false);
+      return;
+    }
   }
 
   int bucket_index = key_hash % num_buckets_;
@@ -307,8 +333,6 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
 
     DVLOG(2) << "Enqueue Recv Item (key:" << key.FullKey() << "). ";
 
-    // TODO(b/143786186): Investigate moving the allocation of `Item` outside
-    // the lock.
     activity_watcher::ActivityScope activity_scope(
         [&]() {
           return std::make_unique<activity_watcher::Activity>(
@@ -326,7 +350,7 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
       // NOTE(mrry): We must wrap `done` with code that deregisters the
       // cancellation callback before calling the `done` callback, because the
       // cancellation manager may no longer be live after `done` is called.
-      queue->push_back(new Item(
+      queue->push_back(new (bucket.AllocateItem()) Item(
           std::move(rc_owner), recv_args,
           [this, cm, token, done = std::move(done)](
               const Status& s, const Rendezvous::Args& send_args,
@@ -342,8 +366,10 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
           },
           token, std::move(activity_scope)));
     } else {
-      queue->push_back(new Item(std::move(rc_owner), recv_args, std::move(done),
-                                token, std::move(activity_scope)));
+      queue->push_back(new (bucket.AllocateItem())
+                           Item(std::move(rc_owner), recv_args,
+                                std::move(done), token,
+                                std::move(activity_scope)));
     }
 
     bucket.mu.unlock();
@@ -369,15 +395,17 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
   DCHECK_EQ(item->type, Item::kSend);
   done(OkStatus(), item->args, recv_args, *item->send_state.value,
        item->send_state.is_dead);
+  // Release the owner at last since it may destruct the rendezvous.
+  auto rc_owner = std::move(item->rc_owner);
+  item->~Item();
   {
     mutex_lock l(bucket.mu);
+    bucket.ReleaseItem(item);
     bucket.pending_callback_counter--;
     if (bucket.pending_callback_counter == 0) {
       bucket.pending_callback_cond_var.notify_all();
     }
   }
-  // Delete the item at last since it may unref and destruct the rendezvous.
-  delete item;
 }
 
 mutex& LocalRendezvous::aborted_rendezs_mu_ = *new mutex();
@@ -400,6 +428,7 @@ void LocalRendezvous::DoAbort(const Status& status) {
   {
     mutex_lock l(mu_);
     status_.Update(status);
+    aborted_.store(true, std::memory_order_release);
   }
   LOG_EVERY_POW_2(INFO) << "Local rendezvous is aborting with status: "
                         << status;
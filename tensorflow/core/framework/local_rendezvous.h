@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 #define TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 
+#include <atomic>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -96,12 +97,25 @@ class LocalRendezvous {
     // Track the number of pening callbacks using a counter.
     int pending_callback_counter TF_GUARDED_BY(mu) = 0;
     condition_variable pending_callback_cond_var TF_GUARDED_BY(mu);
+
+    // The memory of the consumed items, which is reused for the new items of
+    // this bucket so that a steady stream of Send/Recv does not malloc.
+    std::vector<void*> free_items TF_GUARDED_BY(mu);
+
+    // Returns uninitialized memory for an Item.
+    void* AllocateItem() TF_EXCLUSIVE_LOCKS_REQUIRED(mu);
+    // Takes the memory of a destroyed Item, which came from
+    // `AllocateItem()` or `operator new`.
+    void ReleaseItem(void* item) TF_EXCLUSIVE_LOCKS_REQUIRED(mu);
   };
 
   // Immutable set of buckets. This uses less memory than std::vector.
   const std::unique_ptr<TableBucket[]> table_buckets_;
   mutex mu_;
   Status status_ TF_GUARDED_BY(mu_);
+  // Whether `status_` is not OK, so that Send and Recv only need to take `mu_`
+  // once the rendezvous is aborted.
+  std::atomic<bool> aborted_{false};
 
   // We deliberately leak one reference of the aborted rendezvous here, so that
   // they won't be destructed, and lose the status_.
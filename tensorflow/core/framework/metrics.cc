@@ -57,6 +57,14 @@ auto* graph_run_time_usecs_histogram = tsl::monitoring::Sampler<0>::New(
     // Power of 2 with bucket count 20 (> 17 minutes)
     {tsl::monitoring::Buckets::Exponential(1000, 2, 20)});
 
+auto* graph_run_framework_overhead_usecs_histogram =
+    tsl::monitoring::Sampler<0>::New(
+        {"/tensorflow/core/graph_run_framework_overhead_usecs_histogram",
+         "The wall-clock time spent by a session run outside of its graph "
+         "executors, in microseconds."},
+        // Power of 2 with bucket count 20 (> 1 second)
+        {tsl::monitoring::Buckets::Exponential(1, 2, 20)});
+
 auto* graph_pending_queue_length_histogram = tsl::monitoring::Sampler<0>::New(
     {"/tensorflow/core/graph_pending_queue_length_histogram",
      "The number of pending (ready but not running) tasks in graph executor."},
@@ -377,6 +385,13 @@ auto* function_graph_optimization_time_usecs = tsl::monitoring::Counter<0>::New(
     "The amount of time TensorFlow has spent optimizing function graphs, in "
     "microseconds. ");
 
+auto* function_graph_optimization_phase_time_usecs =
+    tsl::monitoring::Counter<1>::New(
+        "/tensorflow/core/function_graph_optimization_phase_time_usecs",
+        "The amount of time TensorFlow has spent in each phase of the "
+        "optimization of function graphs, in microseconds.",
+        "phase");
+
 auto* graph_optimization_saving_time_usecs = tsl::monitoring::Counter<1>::New(
     "/tensorflow/core/graph_optimization_saving_time_usec",
     "The amount of time TensorFlow has saved by caching the optimized "
@@ -418,6 +433,20 @@ auto* xla_compilation_time_usecs = tsl::monitoring::Counter<0>::New(
     "/tensorflow/core/xla_compilation_time_usecs",
     "The total time spent on compiling XLA graphs in microseconds.");
 
+auto* xla_compilation_cache_evictions = tsl::monitoring::Counter<0>::New(
+    "/tensorflow/core/xla_compilation_cache_evictions",
+    "The number of executables evicted from the XLA compilation cache.");
+
+auto* xla_compilation_cache_evicted_bytes = tsl::monitoring::Counter<0>::New(
+    "/tensorflow/core/xla_compilation_cache_evicted_bytes",
+    "The total size in bytes of the executables evicted from the XLA "
+    "compilation cache.");
+
+auto* xla_compilation_cache_recompiles = tsl::monitoring::Counter<0>::New(
+    "/tensorflow/core/xla_compilation_cache_recompiles",
+    "The number of XLA compilations of signatures whose executable had been "
+    "evicted from the compilation cache.");
+
 auto* xla_tpu_spmd_cores_per_replica = tsl::monitoring::Counter<1>::New(
     "/tensorflow/tpu/xla_spmd_cores_per_replica",
     "The number of cores used by XLA SPMD-replicated models.", "cores");
@@ -809,6 +838,12 @@ void UpdateGraphExecTime(const uint64 running_time_usecs) {
   }
 }
 
+void UpdateGraphFrameworkOverhead(const uint64 overhead_usecs) {
+  static auto* graph_run_framework_overhead_usecs_histogram_cell =
+      graph_run_framework_overhead_usecs_histogram->GetCell();
+  graph_run_framework_overhead_usecs_histogram_cell->Add(overhead_usecs);
+}
+
 void UpdateGraphPendingQueueLength(uint64 len) {
   static auto* graph_pending_queue_length_cell =
       graph_pending_queue_length_histogram->GetCell();
@@ -834,6 +869,18 @@ void UpdateFunctionGraphOptimizationTime(const uint64 running_time_usecs) {
   }
 }
 
+void UpdateFunctionGraphOptimizationPhaseTime(const std::string& phase,
+                                              const uint64 running_time_usecs) {
+  if (running_time_usecs > 0) {
+    function_graph_optimization_phase_time_usecs->GetCell(phase)->IncrementBy(
+        running_time_usecs);
+  }
+}
+
+uint64 GetFunctionGraphOptimizationPhaseTimeUsecs(const std::string& phase) {
+  return function_graph_optimization_phase_time_usecs->GetCell(phase)->value();
+}
+
 void UpdateFunctionGraphOptimizationSavingTime(const uint64 saving_time_usecs,
                                                GraphOptimizationSource source) {
   if (saving_time_usecs > 0) {
@@ -921,6 +968,21 @@ void UpdateXlaCompilationTime(const uint64 compilation_time_usecs) {
   }
 }
 
+void UpdateXlaCompilationCacheEviction(int64_t evicted_bytes) {
+  static auto* xla_compilation_cache_evictions_cell =
+      xla_compilation_cache_evictions->GetCell();
+  static auto* xla_compilation_cache_evicted_bytes_cell =
+      xla_compilation_cache_evicted_bytes->GetCell();
+  xla_compilation_cache_evictions_cell->IncrementBy(1);
+  xla_compilation_cache_evicted_bytes_cell->IncrementBy(evicted_bytes);
+}
+
+void UpdateXlaCompilationCacheRecompileCount() {
+  static auto* xla_compilation_cache_recompiles_cell =
+      xla_compilation_cache_recompiles->GetCell();
+  xla_compilation_cache_recompiles_cell->IncrementBy(1);
+}
+
 void RecordUnusedOutput(const string& op_name) {
   graph_unused_outputs->GetCell(op_name)->IncrementBy(1);
 }
@@ -267,6 +267,10 @@ void RecordGraphOutputTensors(const size_t size);
 void RecordTPUXlaSpmdCoresPerReplica(int64_t cores_per_replica);
 
 void UpdateGraphExecTime(const uint64 running_time_usecs);
+
+// Updates the time spent by a session run outside of its graph executors,
+// i.e. the per-call overhead of the framework.
+void UpdateGraphFrameworkOverhead(const uint64 overhead_usecs);
 void UpdateGraphPendingQueueLength(uint64 len);
 
 // Records that one output of an op of type `op_name` was unused.
@@ -300,6 +304,15 @@ void UpdateGraphBuildTime(const uint64 running_time_usecs);
 // Updates the metric stored for time spent optimizing function graphs.
 void UpdateFunctionGraphOptimizationTime(const uint64 running_time_usecs);
 
+// Updates the metric stored for time spent in the `phase` of the optimization
+// of function graphs, e.g. "placement" or "partitioning".
+void UpdateFunctionGraphOptimizationPhaseTime(const std::string& phase,
+                                              const uint64 running_time_usecs);
+
+// Retrieves the total time spent in the `phase` of the optimization of
+// function graphs.
+uint64 GetFunctionGraphOptimizationPhaseTimeUsecs(const std::string& phase);
+
 // Updates the metric stored for time saved by caching graph optimization.
 void UpdateFunctionGraphOptimizationSavingTime(uint64 saving_time_usec,
                                                GraphOptimizationSource source);
@@ -522,6 +535,14 @@ void UpdateTpuVariableDistributionTime(const uint64 distribution_time_usecs);
 // Updates the metrics stored about time XLA spents compiling graphs.
 void UpdateXlaCompilationTime(const uint64 compilation_time_usecs);
 
+// Updates the metrics stored about XLA executables evicted from the
+// compilation cache to stay within its memory budget.
+void UpdateXlaCompilationCacheEviction(int64_t evicted_bytes);
+
+// Increments the count of XLA compilations of signatures whose executable had
+// been evicted from the compilation cache.
+void UpdateXlaCompilationCacheRecompileCount();
+
 // Increments (by 1) a simple integer counter that is exposed for testing.
 void IncrementTestCounter(const string& name, const string& label);
 
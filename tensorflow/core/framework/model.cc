@@ -20,6 +20,7 @@ limitations under the License.
 #include <cstdint>
 #include <limits>
 #include <memory>
+#include <numeric>
 #include <optional>
 #include <queue>
 
@@ -49,6 +50,9 @@ namespace {
 constexpr int32_t kGapTimeWindow = 100;
 // Gap time upper threshold: any gap time over this duration will be dropped.
 constexpr absl::Duration kGapDurationUpperThreshold = absl::Seconds(10);
+// Minimum number of recorded consumer step times needed for gradient descent to
+// account for the consumer.
+constexpr int32_t kMinConsumerStepTimes = 10;
 // In outlier computation, points that are larger than `kOutlierSigmas` standard
 // deviations are considered outliers.
 constexpr double kOutlierSigmas = 2.0;
@@ -348,6 +352,83 @@ inline void UpdateParameterValues(const Node::ParameterGradients& gradients,
   }
 }
 
+// Models how the consumer step time changes with the parallelism of the input
+// pipeline. Each input pipeline thread is assumed to keep a CPU busy for the
+// same fraction of time it did when the consumer step time was measured, and
+// the consumer step time is assumed to be inversely proportional to the CPUs
+// that the busy threads leave to the consumer.
+struct ConsumerContention {
+  // Measured consumer step time.
+  double step_time_nsec = 0.0;
+  double cpu_budget = 0.0;
+  // Fraction of time an input pipeline thread is busy.
+  double thread_utilization = 0.0;
+  // CPUs left to the consumer when its step time was measured.
+  double consumer_cpus = 1.0;
+};
+
+// Returns the sum of the parallelism parameter values.
+double TotalParallelism(const Node::ModelParameters& parameters) {
+  double parallelism = 0.0;
+  for (const auto& pair : parameters) {
+    if (pair.second->name == kParallelism) {
+      parallelism += pair.second->value;
+    }
+  }
+  return parallelism;
+}
+
+// Builds the contention model from the consumer step time measured while the
+// pipeline rooted at `snapshot` ran with its current parameter values.
+ConsumerContention MakeConsumerContention(std::shared_ptr<Node> snapshot,
+                                          const Node::ModelParameters& params,
+                                          double step_time_nsec,
+                                          int64_t cpu_budget) {
+  // The CPU time it takes the pipeline to produce one element, consumed once
+  // per step.
+  ModelTiming model_timing(snapshot);
+  Node::NodeVector nodes =
+      snapshot->CollectNodes(TraversalOrder::BFS, IsAnyNode);
+  nodes.push_back(snapshot);
+  double cpu_time_nsec = 0.0;
+  for (const auto& node : nodes) {
+    const ModelTiming::NodeTiming* timing = model_timing.GetTiming(node.get());
+    if (timing != nullptr) {
+      cpu_time_nsec += timing->self_time_nsec;
+    }
+  }
+
+  ConsumerContention contention;
+  contention.step_time_nsec = step_time_nsec;
+  contention.cpu_budget = static_cast<double>(cpu_budget);
+  const double parallelism = std::max(TotalParallelism(params), 1.0);
+  contention.thread_utilization =
+      std::clamp(cpu_time_nsec / (parallelism * step_time_nsec), 0.0, 1.0);
+  contention.consumer_cpus =
+      std::max(contention.cpu_budget -
+                   contention.thread_utilization * parallelism,
+               1.0);
+  return contention;
+}
+
+// Returns the estimated consumer step time when the input pipeline runs with
+// `parallelism` threads, and stores its derivative w.r.t. `parallelism` in
+// `derivative`.
+double ConsumerStepTime(const ConsumerContention& contention,
+                        double parallelism, double* derivative) {
+  const double consumer_cpus =
+      contention.cpu_budget - contention.thread_utilization * parallelism;
+  if (consumer_cpus <= 1.0) {
+    // The consumer is left with a single CPU, which it is assumed to keep.
+    *derivative = 0.0;
+    return contention.step_time_nsec * contention.consumer_cpus;
+  }
+  const double step_time_nsec =
+      contention.step_time_nsec * contention.consumer_cpus / consumer_cpus;
+  *derivative = step_time_nsec * contention.thread_utilization / consumer_cpus;
+  return step_time_nsec;
+}
+
 // Copies the parameter values (which are for optimization tuning) and updates
 // the state values (which are for the input pipeline to follow).
 inline void UpdateStateValues(Node::ModelParameters* parameters) {
@@ -2111,7 +2192,9 @@ void Node::TotalBufferedBytesHelper(Node::NodeValues* total_bytes) const
   if (!parameter) {
     parameter = gtl::FindOrNull(parameters_, kParallelism);
   }
-  if (parameter) {
+  // Source nodes have no buffer parameter, but may still buffer data they read
+  // ahead of their consumer.
+  if (parameter || inputs_.empty()) {
     result = buffered_bytes_;
   }
   for (auto& input : inputs_) {
@@ -2135,6 +2218,11 @@ void Node::TotalMaximumBufferedBytesHelper(Node::NodeValues* total_bytes) const
 }
 
 double Node::MaximumBufferedBytes() const TF_SHARED_LOCKS_REQUIRED(mu_) {
+  // The readahead buffers of a source node do not depend on any tunable
+  // parameter, so the bytes it currently buffers are all it will use.
+  if (inputs_.empty()) {
+    return buffered_bytes_;
+  }
   return 0;
 }
 
@@ -2618,6 +2706,19 @@ void Model::OptimizeGradientDescent(
   CollectParameters(snapshot, parameters, &parallelism_parameters,
                     &buffer_size_parameters);
 
+  // The contention model is built from the parameter values that the consumer
+  // step times were measured with.
+  std::optional<ConsumerContention> contention;
+  const double consumer_step_time_nsec = ComputeConsumerStepTimeNsec();
+  if (consumer_step_time_nsec > 0.0) {
+    contention =
+        MakeConsumerContention(snapshot, parameters, consumer_step_time_nsec,
+                               optimization_params.cpu_budget());
+    VLOG(2) << "Accounting for a consumer step time of "
+            << consumer_step_time_nsec << " nanoseconds and an input thread "
+            << "utilization of " << contention->thread_utilization;
+  }
+
   // Initialize the parameter values to minimal before tuning.
   for (auto& pair : parameters) {
     pair.second->value = pair.second->min;
@@ -2648,6 +2749,24 @@ void Model::OptimizeGradientDescent(
     Model::ParameterGradients gradients;
     new_output_time = OutputTime(
         snapshot, optimization_params.model_input_time(), &gradients);
+    if (contention.has_value()) {
+      // The end-to-end step time is bound by the slower of the input pipeline
+      // and the consumer. While the consumer is slower, only the parallelism
+      // parameters affect it, through the CPUs they take away.
+      double derivative;
+      const double step_time_nsec = ConsumerStepTime(
+          *contention, TotalParallelism(parameters), &derivative);
+      if (step_time_nsec > new_output_time) {
+        new_output_time = step_time_nsec;
+        gradients.clear();
+        for (const auto& pair : parameters) {
+          if (pair.second->name == kParallelism) {
+            gradients[std::make_pair(pair.first, pair.second->name)] =
+                derivative;
+          }
+        }
+      }
+    }
     // We also terminate once the improvement of the output latency is too
     // small.
     if (std::abs(output_time - new_output_time) < kOptimizationPrecision) {
@@ -2770,6 +2889,37 @@ void Model::RecordIteratorGapTime(uint64_t duration_usec) {
   while (gap_times_usec_.size() > kGapTimeWindow) {
     gap_times_usec_.pop_front();
   }
+  if (experiments_.contains("autotune_consumer_contention")) {
+    consumer_step_times_usec_.push_back(duration_usec);
+    while (consumer_step_times_usec_.size() > kGapTimeWindow) {
+      consumer_step_times_usec_.pop_front();
+    }
+  }
+}
+
+void Model::RecordConsumerStepTime(uint64_t duration_usec) {
+  mutex_lock l(gap_mu_);
+  if (duration_usec >= absl::ToInt64Microseconds(kGapDurationUpperThreshold)) {
+    VLOG(3) << "Dropped tf.data Model consumer step time: " << duration_usec;
+    return;
+  }
+  consumer_step_times_usec_.push_back(duration_usec);
+  while (consumer_step_times_usec_.size() > kGapTimeWindow) {
+    consumer_step_times_usec_.pop_front();
+  }
+}
+
+double Model::ComputeConsumerStepTimeNsec() {
+  tf_shared_lock l(gap_mu_);
+  if (consumer_step_times_usec_.size() < kMinConsumerStepTimes) {
+    return 0.0;
+  }
+  const uint64_t sum =
+      std::accumulate(consumer_step_times_usec_.begin(),
+                      consumer_step_times_usec_.end(), uint64_t{0});
+  return (static_cast<double>(sum) /
+          static_cast<double>(consumer_step_times_usec_.size())) *
+         1.0e3;
 }
 
 double Model::ComputeTargetTimeNsec() {
@@ -239,8 +239,18 @@ class RamBudgetManager {
 
   void UpdateBudget(int64_t budget) {
     mutex_lock l(mu_);
-    budget_ = budget;
-    VLOG(2) << "Updated ram budget to " << budget;
+    budget_ = budget_limit_.has_value() ? std::min(budget, *budget_limit_)
+                                        : budget;
+    VLOG(2) << "Updated ram budget to " << budget_;
+  }
+
+  // Caps the budget set by `UpdateBudget` at `limit` bytes. This is used to
+  // share the process RAM between the models of several input pipelines.
+  void UpdateBudgetLimit(int64_t limit) {
+    mutex_lock l(mu_);
+    budget_limit_ = limit;
+    budget_ = std::min(budget_, limit);
+    VLOG(2) << "Updated ram budget limit to " << limit;
   }
 
   std::string DebugString() {
@@ -253,6 +263,8 @@ class RamBudgetManager {
  private:
   mutable mutex mu_;
   int64_t budget_ TF_GUARDED_BY(mu_) = 0;
+  // Upper bound on `budget_`, if set by `UpdateBudgetLimit`.
+  std::optional<int64_t> budget_limit_ TF_GUARDED_BY(mu_);
   // Number of bytes allocated by legacy prefetch autotuner.
   int64_t legacy_prefetch_allocated_ TF_GUARDED_BY(mu_) = 0;
   // Number of bytes allocated by the model.
@@ -804,9 +816,11 @@ class Node {
       TF_SHARED_LOCKS_REQUIRED(mu_);
 
   // Compute and return the maximum buffered bytes on the node itself. By
-  // default non-tunable nodes are assumed not to buffer any bytes, so the
-  // tunable nodes as subclasses are expected to override this method to ensure
-  // that the optimization algorithm respects the memory budget.
+  // default non-tunable nodes are assumed not to buffer any bytes, except for
+  // source nodes, which report the bytes they read ahead via
+  // `record_buffer_event`. The tunable nodes as subclasses are expected to
+  // override this method to ensure that the optimization algorithm respects the
+  // memory budget.
   virtual double MaximumBufferedBytes() const TF_SHARED_LOCKS_REQUIRED(mu_);
 
   // Restores node from the proto. Note that this is not done recursively, i.e.
@@ -1041,6 +1055,18 @@ class Model {
   // having executed an optimization round before.
   double ComputeSnapshotProcessingTimeNsec() const;
 
+  // Records the time the consumer of the pipeline (e.g. a training step) spent
+  // on its own work between two `GetNext()` calls. `GRADIENT_DESCENT` uses the
+  // recorded times to account for the CPUs that the consumer shares with the
+  // input pipeline. With the "autotune_consumer_contention" experiment, the
+  // iterator gap times are recorded as consumer step times, so training loops
+  // that call this method directly should not enable the experiment.
+  void RecordConsumerStepTime(uint64_t duration_usec);
+
+  // Returns the average recorded consumer step time in nsecs. Returns 0 if
+  // there are not sufficient recorded step times to produce a good estimate.
+  double ComputeConsumerStepTimeNsec();
+
  private:
   // Determines whether optimization should stop given total processing time,
   // estimated output time, and estimated number of buffers bytes.
@@ -1088,6 +1114,11 @@ class Model {
   // repeated until either the output time improvement is smaller than threshold
   // value or the output time is less than the processing time needed to produce
   // an element divided by CPU budget.
+  //
+  // If consumer step times have been recorded, the objective is the estimated
+  // end-to-end step time instead: the larger of the output time and the
+  // consumer step time, where the latter grows as input pipeline threads take
+  // CPUs away from the consumer.
   void OptimizeGradientDescent(std::shared_ptr<Node> snapshot,
                                const OptimizationParams& optimization_params,
                                CancellationManager* cancellation_manager);
@@ -1210,6 +1241,8 @@ class Model {
   mutable mutex gap_mu_;
   // Stores the latest gap times between consecutive `GetNext()`.
   std::deque<uint64_t> gap_times_usec_ TF_GUARDED_BY(gap_mu_);
+  // Stores the latest consumer step times.
+  std::deque<uint64_t> consumer_step_times_usec_ TF_GUARDED_BY(gap_mu_);
   // The experiment that this job is part of.
   absl::flat_hash_set<std::string> experiments_;
   // Stores the optimization snapshot of the Model.
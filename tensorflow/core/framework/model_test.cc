@@ -386,6 +386,25 @@ TEST(SourceTest, Model) {
   EXPECT_EQ(source->OutputTime(&input_times, nullptr), 50);
 }
 
+TEST(SourceTest, BufferedBytes) {
+  std::shared_ptr<Node> known_many =
+      model::MakeKnownRatioNode({0, "known_many", nullptr}, 1);
+  std::shared_ptr<Node> source =
+      model::MakeSourceNode({1, "source", known_many});
+  known_many->add_input(source);
+  auto cleanup = gtl::MakeCleanup(
+      [known_many, source]() { known_many->remove_input(source); });
+  EXPECT_EQ(known_many->TotalBufferedBytes(), 0);
+  EXPECT_EQ(known_many->TotalMaximumBufferedBytes(), 0);
+  source->record_buffer_event(100, 0);
+  EXPECT_EQ(source->buffered_bytes(), 100);
+  EXPECT_EQ(known_many->TotalBufferedBytes(), 100);
+  EXPECT_EQ(known_many->TotalMaximumBufferedBytes(), 100);
+  source->record_buffer_event(-60, 0);
+  EXPECT_EQ(known_many->TotalBufferedBytes(), 40);
+  EXPECT_EQ(known_many->TotalMaximumBufferedBytes(), 40);
+}
+
 TEST(UnknownRatioTest, Model) {
   std::shared_ptr<Node> unknown_many =
       model::MakeUnknownRatioNode({0, "unknown_many", nullptr});
@@ -1386,6 +1405,82 @@ TEST_P(OptimizeZeroRamBudgetTest, Model) {
 INSTANTIATE_TEST_SUITE_P(Test, OptimizeZeroRamBudgetTest,
                          ::testing::Values(0, 1, 2, 3));
 
+// Returns a model with a single node whose parallelism is tuned, and which
+// takes 100us to produce an element.
+std::unique_ptr<Model> MakeSingleParallelNodeModel(
+    std::shared_ptr<Node>* node) {
+  *node = model::MakeAsyncKnownRatioNode(
+      {1, "1", nullptr}, 1,
+      {model::MakeParameter("parallelism",
+                            std::make_shared<SharedState>(
+                                /*value=*/model::kAutotune,
+                                std::make_shared<mutex>(),
+                                std::make_shared<condition_variable>()),
+                            /*min=*/1, /*max=*/16)});
+  (*node)->record_element();
+  (*node)->add_processing_time(100000);
+  auto model = std::make_unique<Model>();
+  model->AddNode([node](model::Node::Args args) { return *node; }, "1",
+                 nullptr, node);
+  return model;
+}
+
+TEST(OptimizeGradientDescentTest, WithoutConsumerStepTimes) {
+  std::shared_ptr<Node> node;
+  std::unique_ptr<Model> model = MakeSingleParallelNodeModel(&node);
+  CancellationManager cancellation_manager;
+  RamBudgetManager ram_budget_manager(0);
+  model->Optimize(AutotuneAlgorithm::GRADIENT_DESCENT, CpuBudgetFunc(4),
+                  /*ram_budget_share=*/1.0,
+                  /*fixed_ram_budget=*/1 << 20,
+                  /*model_input_time=*/0, ram_budget_manager,
+                  &cancellation_manager);
+  EXPECT_GT(node->parameter_value("parallelism"), 1);
+}
+
+TEST(OptimizeGradientDescentTest, ConsumerBound) {
+  std::shared_ptr<Node> node;
+  std::unique_ptr<Model> model = MakeSingleParallelNodeModel(&node);
+  // The consumer takes 1s per step, far longer than the input pipeline, so
+  // extra input parallelism only takes CPUs away from the consumer.
+  for (int i = 0; i < 10; ++i) {
+    model->RecordConsumerStepTime(1000000);
+  }
+  CancellationManager cancellation_manager;
+  RamBudgetManager ram_budget_manager(0);
+  model->Optimize(AutotuneAlgorithm::GRADIENT_DESCENT, CpuBudgetFunc(4),
+                  /*ram_budget_share=*/1.0,
+                  /*fixed_ram_budget=*/1 << 20,
+                  /*model_input_time=*/0, ram_budget_manager,
+                  &cancellation_manager);
+  EXPECT_EQ(node->parameter_value("parallelism"), 1);
+}
+
+TEST(ModelTest, ConsumerStepTime) {
+  model::Model model;
+  for (int i = 0; i < 9; ++i) {
+    model.RecordConsumerStepTime(10);
+  }
+  // Not enough step times have been recorded yet.
+  EXPECT_EQ(model.ComputeConsumerStepTimeNsec(), 0);
+  model.RecordConsumerStepTime(20);
+  // Step times that are >= 10 seconds are dropped.
+  model.RecordConsumerStepTime(10000000);
+  EXPECT_DOUBLE_EQ(model.ComputeConsumerStepTimeNsec(), 11 * 1e3);
+  // Gap times are only recorded as step times with the experiment.
+  model.RecordIteratorGapTime(1000);
+  EXPECT_DOUBLE_EQ(model.ComputeConsumerStepTimeNsec(), 11 * 1e3);
+}
+
+TEST(ModelTest, ConsumerStepTimeFromGapTimes) {
+  model::Model model;
+  model.AddExperiment("autotune_consumer_contention");
+  for (int i = 0; i < 10; ++i) {
+    model.RecordIteratorGapTime(10);
+  }
+  EXPECT_DOUBLE_EQ(model.ComputeConsumerStepTimeNsec(), 10 * 1e3);
+}
+
 TEST(RecordTimeTest, RecordTimeTest) {
   std::shared_ptr<Node> source = model::MakeSourceNode({});
   EXPECT_FALSE(source->is_recording());
@@ -3574,6 +3669,22 @@ TEST(RamBudgetManagerTest, RequestAllocationsWithBudgetAdjustment) {
   EXPECT_TRUE(rbm.RequestLegacyPrefetchBytes(4));
 }
 
+TEST(RamBudgetManagerTest, BudgetLimit) {
+  RamBudgetManager rbm(20);
+  rbm.UpdateBudgetLimit(10);
+  EXPECT_EQ(rbm.AvailableModelRam(), 10);
+  // The budget is capped at the limit.
+  rbm.UpdateBudget(15);
+  EXPECT_EQ(rbm.AvailableModelRam(), 10);
+  rbm.UpdateBudget(5);
+  EXPECT_EQ(rbm.AvailableModelRam(), 5);
+  // Raising the limit takes effect at the next budget update.
+  rbm.UpdateBudgetLimit(30);
+  EXPECT_EQ(rbm.AvailableModelRam(), 5);
+  rbm.UpdateBudget(25);
+  EXPECT_EQ(rbm.AvailableModelRam(), 25);
+}
+
 TEST(NodeTest, OnlyCollectParametersThatHaveElementsProduced) {
   // Builds a graph:
   // root <- parallel_map <- parallel_interleave
@@ -816,10 +816,14 @@ Status OpKernelContext::allocate_output(int index, const TensorShape& shape,
     }
   }
   profiler::ScopedMemoryDebugAnnotation op_annotation(
-      op_kernel().name_view().data(), step_id(), "output", type,
+      op_kernel().name_view().data(), step_id(), "output", type, index,
       [&shape]() { return shape.DebugString(); });
   auto output_tensor = std::make_unique<Tensor>();
-  Status s = allocate_tensor(type, shape, output_tensor.get(), attr);
+  Status s;
+  if (!maybe_reuse_output_buffer(index, type, shape, attr,
+                                 output_tensor.get())) {
+    s = allocate_tensor(type, shape, output_tensor.get(), attr);
+  }
   if (s.ok()) {
     outputs_[index] = TensorValue(output_tensor.release());
     *output = outputs_[index].tensor;
@@ -827,6 +831,27 @@ Status OpKernelContext::allocate_output(int index, const TensorShape& shape,
   return s;
 }
 
+bool OpKernelContext::maybe_reuse_output_buffer(int index, DataType type,
+                                                const TensorShape& shape,
+                                                AllocatorAttributes attr,
+                                                Tensor* out_tensor) {
+  // Tracked and logged allocations must go through the allocator, and the
+  // buffers of non memcpy-able types must be constructed for each output.
+  if (params_->reusable_outputs == nullptr || attr.scope_id > 0 ||
+      track_allocations() || params_->log_memory ||
+      !DataTypeCanUseMemcpy(type)) {
+    return false;
+  }
+  Tensor& reusable = params_->reusable_outputs[index];
+  if (!reusable.IsInitialized() || reusable.dtype() != type ||
+      reusable.NumElements() != shape.num_elements() ||
+      !reusable.RefCountIsOne() || !out_tensor->CopyFrom(reusable, shape)) {
+    return false;
+  }
+  reusable = Tensor();
+  return true;
+}
+
 Status OpKernelContext::allocate_temp(
     DataType type, const TensorShape& shape, Tensor* out_temp,
     AllocatorAttributes allocator_attr,
@@ -953,7 +978,7 @@ bool OpKernelContext::maybe_set_output_by_allocate_and_copy(
             << output_alloc_attr(index).scope_id;
     profiler::ScopedMemoryDebugAnnotation op_annotation(
         op_kernel().name_view().data(), step_id(), "output", tensor.dtype(),
-        [&tensor]() { return tensor.shape().DebugString(); });
+        index, [&tensor]() { return tensor.shape().DebugString(); });
     auto new_tensor = std::make_unique<Tensor>();
     Status s = allocate_tensor(tensor.dtype(), tensor.shape(), new_tensor.get(),
                                output_alloc_attr(index));
@@ -665,6 +665,12 @@ class OpKernelContext {
     // Device context.
     DeviceContext* op_device_context = nullptr;
 
+    // Device contexts, other than `op_device_context`, that produced some of
+    // the inputs and whose pending work must be ordered before this kernel. A
+    // nullptr entry stands for the default context of the device.
+    const absl::InlinedVector<DeviceContext*, 2UL>* wait_device_contexts =
+        nullptr;
+
     // Control-flow op supports.
     FrameAndIter frame_iter;
 
@@ -696,6 +702,11 @@ class OpKernelContext {
     // outputs are required.
     bool* outputs_required_array = nullptr;
 
+    // Array indexed by output number of tensors whose buffers may be reused
+    // for the outputs allocated by the kernel, when nothing else references
+    // them. If null, all outputs are allocated.
+    Tensor* reusable_outputs = nullptr;
+
     // For access to distributed coordination service.
     tsl::CoordinationServiceAgent* coordination_service_agent = nullptr;
   };
@@ -1052,6 +1063,12 @@ class OpKernelContext {
     return ret;
   }
 
+  // Returns the device contexts this kernel must wait for, in addition to
+  // op_device_context(), or nullptr if there are none.
+  const absl::InlinedVector<DeviceContext*, 2UL>* wait_device_contexts() const {
+    return params_->wait_device_contexts;
+  }
+
   AllocatorAttributes input_alloc_attr(int index) const {
     if (params_->input_alloc_attrs.empty()) {
       return AllocatorAttributes();
@@ -1280,6 +1297,12 @@ class OpKernelContext {
                          Tensor* out_tensor, AllocatorAttributes allocator_attr,
                          const AllocationAttributes& allocation_attr);
 
+  // Returns `true` if the output at `index` was set to the buffer of
+  // `params_->reusable_outputs[index]` instead of being allocated.
+  bool maybe_reuse_output_buffer(int index, DataType type,
+                                 const TensorShape& shape,
+                                 AllocatorAttributes attr, Tensor* out_tensor);
+
   // Helpers for `set_output()`.
 
   // Returns `true` if the tensor was copied into an allocated output.
@@ -520,6 +520,7 @@ void Graph::Copy(const Graph& src) {
   node_map.reserve(src.num_nodes());
   node_map[src.source_node()] = source_node();
   node_map[src.sink_node()] = sink_node();
+  Reserve(src.num_op_nodes(), src.num_edges());
   for (Node* n : src.op_nodes()) {
     auto copy = CopyNode(n);
     copy->in_edges_.reserve(n->in_edges().size());
@@ -588,6 +589,37 @@ Node* Graph::AddNode(NodeDef node_def, Status* status) {
   return node;
 }
 
+void Graph::Reserve(int num_nodes, int num_edges) {
+  nodes_.reserve(nodes_.size() + num_nodes);
+  edges_.reserve(edges_.size() + num_edges);
+
+  // The new nodes and edges are put below the free ones, in reverse order, so
+  // that the free ones are reused first and the new ones are handed out in
+  // increasing address order.
+  const int new_nodes = num_nodes - static_cast<int>(free_nodes_.size());
+  if (new_nodes > 0) {
+    char* slab = arena_.Alloc(new_nodes * sizeof(Node));
+    std::vector<Node*> nodes;
+    nodes.reserve(new_nodes + free_nodes_.size());
+    for (int i = new_nodes - 1; i >= 0; --i) {
+      nodes.push_back(new (slab + i * sizeof(Node)) Node);  // placement new
+    }
+    nodes.insert(nodes.end(), free_nodes_.begin(), free_nodes_.end());
+    free_nodes_.swap(nodes);
+  }
+  const int new_edges = num_edges - static_cast<int>(free_edges_.size());
+  if (new_edges > 0) {
+    char* slab = arena_.Alloc(new_edges * sizeof(Edge));
+    std::vector<Edge*> edges;
+    edges.reserve(new_edges + free_edges_.size());
+    for (int i = new_edges - 1; i >= 0; --i) {
+      edges.push_back(new (slab + i * sizeof(Edge)) Edge);  // placement new
+    }
+    edges.insert(edges.end(), free_edges_.begin(), free_edges_.end());
+    free_edges_.swap(edges);
+  }
+}
+
 Node* Graph::CopyNode(const Node* node) {
   DCHECK(!node->IsSource());
   DCHECK(!node->IsSink());
@@ -565,6 +565,11 @@ class Graph {
   // Same as above, but using StatusOr. This method is always preferred.
   absl::StatusOr<Node*> AddNode(NodeDef node_def);
 
+  // Preallocates contiguous storage for `num_nodes` more nodes and
+  // `num_edges` more edges, so that the ones added next are adjacent in memory
+  // instead of being spread over many small arena blocks.
+  void Reserve(int num_nodes, int num_edges);
+
   // Copies *node, which may belong to another graph, to a new node,
   // which is returned.  Does not copy any edges.  *this owns the
   // returned instance.
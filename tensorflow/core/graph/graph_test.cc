@@ -309,6 +309,24 @@ TEST_F(GraphTest, NodeByIndex) {
   EXPECT_EQ(b_new_c_edge, c_input_edges[0]);
 }
 
+TEST_F(GraphTest, Reserve) {
+  Node* removed = AddNodeWithName("Removed");
+  graph_.RemoveNode(removed);
+  graph_.Reserve(3, 2);
+
+  // The removed node is reused first, then the reserved ones are adjacent.
+  Node* a = FromNodeDef("A", "OneOutput", 0);
+  Node* b = FromNodeDef("B", "OneInput", 1);
+  Node* c = FromNodeDef("C", "OneInput", 1);
+  EXPECT_EQ(a, removed);
+  EXPECT_EQ(c, b + 1);
+  const Edge* a_to_b = graph_.AddEdge(a, 0, b, 0);
+  const Edge* a_to_c = graph_.AddEdge(a, 0, c, 0);
+  EXPECT_EQ(a_to_c, a_to_b + 1);
+  EXPECT_EQ(graph_.num_op_nodes(), 3);
+  EXPECT_EQ(graph_.num_edges(), 3);
+}
+
 TEST_F(GraphTest, NodeIteration) {
   // Set up the graph with some holes due to removals.
   Node* a = FromNodeDef("A", "OneOutput", 0);
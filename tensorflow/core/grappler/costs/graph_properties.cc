@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 
 #include "absl/hash/hash.h"
+#include "absl/strings/str_cat.h"
 #include "absl/types/optional.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
@@ -37,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 
 namespace tensorflow {
@@ -2514,10 +2516,85 @@ Status GraphProperties::UpdateEnqueue(
   return absl::OkStatus();
 }
 
+std::shared_ptr<const GraphPropertiesCache::Entry> GraphPropertiesCache::Lookup(
+    const Fprint128& key) {
+  mutex_lock l(mu_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    ++num_misses_;
+    return nullptr;
+  }
+  ++num_hits_;
+  return it->second;
+}
+
+void GraphPropertiesCache::Insert(const Fprint128& key,
+                                  std::shared_ptr<const Entry> entry) {
+  if (capacity_ <= 0) return;
+  mutex_lock l(mu_);
+  if (!entries_.emplace(key, std::move(entry)).second) return;
+  insertion_order_.push_back(key);
+  while (static_cast<int>(insertion_order_.size()) > capacity_) {
+    entries_.erase(insertion_order_.front());
+    insertion_order_.pop_front();
+  }
+}
+
+int64_t GraphPropertiesCache::num_hits() const {
+  mutex_lock l(mu_);
+  return num_hits_;
+}
+
+int64_t GraphPropertiesCache::num_misses() const {
+  mutex_lock l(mu_);
+  return num_misses_;
+}
+
 Status GraphProperties::InferStatically(bool assume_valid_feeds,
                                         bool aggressive_shape_inference,
                                         bool include_input_tensor_values,
                                         bool include_output_tensor_values) {
+  GraphPropertiesCache* cache = item_.graph_properties_cache.get();
+  string signature;
+  if (cache == nullptr ||
+      !SerializeToStringDeterministic(item_.graph, &signature)) {
+    return InferStaticallyUncached(
+        assume_valid_feeds, aggressive_shape_inference,
+        include_input_tensor_values, include_output_tensor_values);
+  }
+  for (const auto& feed : item_.feed) {
+    absl::StrAppend(&signature, "|", feed.first, ":",
+                    DataTypeString(feed.second.dtype()), ":",
+                    feed.second.shape().DebugString());
+  }
+  absl::StrAppend(&signature, "|", assume_valid_feeds,
+                  aggressive_shape_inference, include_input_tensor_values,
+                  include_output_tensor_values);
+  const Fprint128 key = Fingerprint128(signature);
+
+  if (std::shared_ptr<const GraphPropertiesCache::Entry> entry =
+          cache->Lookup(key)) {
+    VLOG(2) << "Reusing the shapes inferred for an identical graph.";
+    input_properties_ = entry->input_properties;
+    output_properties_ = entry->output_properties;
+    incompatible_shape_nodes_ = entry->incompatible_shape_nodes;
+    return absl::OkStatus();
+  }
+
+  TF_RETURN_IF_ERROR(InferStaticallyUncached(
+      assume_valid_feeds, aggressive_shape_inference,
+      include_input_tensor_values, include_output_tensor_values));
+  auto entry = std::make_shared<GraphPropertiesCache::Entry>();
+  entry->input_properties = input_properties_;
+  entry->output_properties = output_properties_;
+  entry->incompatible_shape_nodes = incompatible_shape_nodes_;
+  cache->Insert(key, std::move(entry));
+  return absl::OkStatus();
+}
+
+Status GraphProperties::InferStaticallyUncached(
+    bool assume_valid_feeds, bool aggressive_shape_inference,
+    bool include_input_tensor_values, bool include_output_tensor_values) {
   FunctionLibraryDefinition function_library(OpRegistry::Global(),
                                              item_.graph.library());
   absl::flat_hash_map<string, absl::flat_hash_set<int>> fed_ports;
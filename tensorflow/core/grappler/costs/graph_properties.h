@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_GRAPH_PROPERTIES_H_
 #define TENSORFLOW_CORE_GRAPPLER_COSTS_GRAPH_PROPERTIES_H_
 
+#include <cstdint>
+#include <deque>
+#include <memory>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -25,6 +28,9 @@ limitations under the License.
 #include "tensorflow/core/grappler/clusters/cluster.h"
 #include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
 #include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
 
@@ -72,6 +78,55 @@ ABSL_CONST_INIT const char kOutputShapes[] = "_output_shape_vector";
 class SymbolicShapeRefiner;
 class TopoQueue;
 
+// Keeps the results of `GraphProperties::InferStatically` for the most recent
+// graphs, so that passes that do not change the graph (which is common for the
+// later iterations of the meta optimizer) don't pay for shape inference again.
+//
+// Entries are keyed by a fingerprint of the graph, the feeds and the inference
+// options. Results are reused for whole graphs only: symbolic dimensions are
+// numbered over the entire graph, so the properties of unchanged nodes can't be
+// combined with those re-inferred for modified ones. This class is thread-safe.
+class GraphPropertiesCache {
+ public:
+  struct Entry {
+    absl::flat_hash_map<string, std::vector<OpInfo::TensorProperties>>
+        input_properties;
+    absl::flat_hash_map<string, std::vector<OpInfo::TensorProperties>>
+        output_properties;
+    std::unordered_set<string> incompatible_shape_nodes;
+  };
+
+  static constexpr int kDefaultCapacity = 4;
+
+  explicit GraphPropertiesCache(int capacity = kDefaultCapacity)
+      : capacity_(capacity) {}
+
+  // Returns the entry cached under `key`, or nullptr if there is none.
+  std::shared_ptr<const Entry> Lookup(const Fprint128& key)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Caches `entry` under `key`, evicting the oldest entry if the cache is full.
+  void Insert(const Fprint128& key, std::shared_ptr<const Entry> entry)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  int64_t num_hits() const TF_LOCKS_EXCLUDED(mu_);
+  int64_t num_misses() const TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  const int capacity_;
+
+  mutable mutex mu_;
+  absl::flat_hash_map<Fprint128, std::shared_ptr<const Entry>, Fprint128Hasher>
+      entries_ TF_GUARDED_BY(mu_);
+  // Keys of `entries_`, oldest first.
+  std::deque<Fprint128> insertion_order_ TF_GUARDED_BY(mu_);
+  int64_t num_hits_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_misses_ TF_GUARDED_BY(mu_) = 0;
+
+  GraphPropertiesCache(const GraphPropertiesCache&) = delete;
+  void operator=(const GraphPropertiesCache&) = delete;
+};
+
 // Infer OpInfo::TensorProperties for graph nodes inputs/outputs.
 //
 // Typical use case, is to infer tensor properties from a graph, before doing
@@ -96,6 +151,8 @@ class GraphProperties {
   // will included in the input properties.
   // If include_output_tensor_values is true, the values of constant tensors
   // will be included in the output properties.
+  // If `item.graph_properties_cache` is set, the results are taken from and
+  // added to that cache.
   Status InferStatically(bool assume_valid_feeds,
                          bool aggressive_shape_inference,
                          bool include_input_tensor_values,
@@ -159,6 +216,12 @@ class GraphProperties {
   }
 
  private:
+  // Infers the properties without looking them up in the cache.
+  Status InferStaticallyUncached(bool assume_valid_feeds,
+                                 bool aggressive_shape_inference,
+                                 bool include_input_tensor_values,
+                                 bool include_output_tensor_values);
+
   // Relaxes shapes <shapes_and_types>, determined from an EnqueueV2 node, into
   // <*queue_shapes_and_types>.
   static Status RelaxEnqueueShapesAndMergeTypes(
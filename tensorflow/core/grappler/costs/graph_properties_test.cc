@@ -233,6 +233,47 @@ TEST_F(GraphPropertiesTest, Clear) {
   EXPECT_FALSE(properties.has_properties());
 }
 
+TEST_F(GraphPropertiesTest, ReusesCachedProperties) {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false,
+                                          cluster_->GetDeviceNames());
+  GrapplerItem item;
+  CHECK(fake_input.NextItem(&item));
+  auto cache = std::make_shared<GraphPropertiesCache>();
+  item.graph_properties_cache = cache;
+
+  GraphProperties properties(item);
+  TF_ASSERT_OK(properties.InferStatically(true));
+  EXPECT_EQ(0, cache->num_hits());
+  EXPECT_EQ(1, cache->num_misses());
+
+  GraphProperties cached_properties(item);
+  TF_ASSERT_OK(cached_properties.InferStatically(true));
+  EXPECT_EQ(1, cache->num_hits());
+  for (const auto& node : item.graph.node()) {
+    ASSERT_EQ(properties.GetOutputProperties(node.name()).size(),
+              cached_properties.GetOutputProperties(node.name()).size());
+    for (int i = 0; i < properties.GetOutputProperties(node.name()).size();
+         ++i) {
+      EXPECT_EQ(
+          properties.GetOutputProperties(node.name())[i].DebugString(),
+          cached_properties.GetOutputProperties(node.name())[i].DebugString());
+    }
+  }
+
+  // Other inference options and modified graphs are inferred again.
+  GraphProperties other_options(item);
+  TF_ASSERT_OK(other_options.InferStatically(false));
+  EXPECT_EQ(1, cache->num_hits());
+  EXPECT_EQ(2, cache->num_misses());
+
+  GrapplerItem modified_item = item;
+  modified_item.graph.mutable_node(0)->set_device("/cpu:0");
+  GraphProperties modified_properties(modified_item);
+  TF_ASSERT_OK(modified_properties.InferStatically(true));
+  EXPECT_EQ(1, cache->num_hits());
+  EXPECT_EQ(3, cache->num_misses());
+}
+
 TEST_F(GraphPropertiesTest, DynamicProperties) {
   TrivialTestGraphInputYielder fake_input(4, 1, 10, false,
                                           cluster_->GetDeviceNames());
@@ -0,0 +1,130 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/profiled_op_level_cost_estimator.h"
+
+#include <array>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/match.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/grappler/costs/robust_stats.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// Device tracers record the kernels of a node as "<node name>:<kernel name>",
+// while node names can't contain colons.
+absl::string_view NodeNameFromStats(const NodeExecStats& node_stats) {
+  absl::string_view name = node_stats.node_name();
+  return name.substr(0, name.find(':'));
+}
+
+// The kinds of devices of the StepStats, by order of preference for the
+// latency of a node. The device tracer records each kernel of a GPU node both
+// on "stream:all" and on the stream it ran on, while the host device records
+// the time it took to launch them. Only one kind is used for each node, so
+// that no kernel is counted twice.
+enum StatsKind { kAllStreamsStats, kStreamStats, kHostStats, kNumStatsKinds };
+
+StatsKind StatsKindOfDevice(absl::string_view device) {
+  if (absl::EndsWith(device, "/stream:all")) return kAllStreamsStats;
+  if (absl::StrContains(device, "/stream:") ||
+      absl::StrContains(device, "/memcpy")) {
+    return kStreamStats;
+  }
+  return kHostStats;
+}
+
+}  // namespace
+
+void ProfiledOpLevelCostEstimator::AddStepStats(const StepStats& step_stats) {
+  // The latency of a node in the step is the sum of all its kernels, e.g. of
+  // all the kernels of a GPU op, or of its executions in a loop.
+  absl::flat_hash_map<std::string,
+                      std::array<std::optional<double>, kNumStatsKinds>>
+      step_latencies;
+  for (const auto& dev_stats : step_stats.dev_stats()) {
+    const StatsKind kind = StatsKindOfDevice(dev_stats.device());
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      const std::string node_name(NodeNameFromStats(node_stats));
+      if (node_name.empty()) continue;
+      std::optional<double>& latency = step_latencies[node_name][kind];
+      latency = latency.value_or(0) + node_stats.op_end_rel_micros() -
+                node_stats.op_start_rel_micros();
+    }
+  }
+  for (const auto& [node_name, latencies] : step_latencies) {
+    for (const std::optional<double>& latency : latencies) {
+      if (!latency.has_value()) continue;
+      std::vector<double>& samples = samples_[node_name];
+      samples.push_back(*latency);
+      // Outliers, e.g. the steps that warm up the caches, shouldn't skew the
+      // estimates.
+      latencies_[node_name] =
+          Costs::Duration(RobustStats(samples).mean() * 1e3);
+      break;
+    }
+  }
+}
+
+Status ProfiledOpLevelCostEstimator::AddRunMetadataFromFile(
+    const std::string& path) {
+  RunMetadata run_metadata;
+  if (!ReadBinaryProto(Env::Default(), path, &run_metadata).ok()) {
+    TF_RETURN_IF_ERROR(ReadTextProto(Env::Default(), path, &run_metadata));
+  }
+  AddStepStats(run_metadata.step_stats());
+  return absl::OkStatus();
+}
+
+std::optional<Costs::Duration>
+ProfiledOpLevelCostEstimator::GetMeasuredLatency(
+    const std::string& node_name) const {
+  auto it = latencies_.find(node_name);
+  if (it == latencies_.end()) return std::nullopt;
+  return it->second;
+}
+
+Costs ProfiledOpLevelCostEstimator::PredictCosts(
+    const OpContext& op_context) const {
+  Costs costs = OpLevelCostEstimator::PredictCosts(op_context);
+  std::optional<Costs::Duration> latency =
+      GetMeasuredLatency(op_context.name);
+  if (!latency.has_value()) return costs;
+
+  // The measured latency covers both the computation and the memory accesses,
+  // which the analytical model can't attribute reliably.
+  VLOG(2) << "Using the measured latency of " << op_context.name << ": "
+          << latency->count() << "ns instead of "
+          << costs.execution_time.count() << "ns";
+  costs.execution_time = *latency;
+  costs.compute_time = *latency;
+  costs.memory_time = Costs::Duration(0);
+  costs.intermediate_memory_time = Costs::Duration(0);
+  costs.intermediate_memory_read_time = Costs::Duration(0);
+  costs.intermediate_memory_write_time = Costs::Duration(0);
+  costs.inaccurate = false;
+  return costs;
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,74 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_PROFILED_OP_LEVEL_COST_ESTIMATOR_H_
+#define TENSORFLOW_CORE_GRAPPLER_COSTS_PROFILED_OP_LEVEL_COST_ESTIMATOR_H_
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/grappler/costs/cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Predicts the cost of the nodes from latencies measured while running the
+// graph, e.g. on the production hardware, and recorded in the `StepStats` of a
+// `RunMetadata`. Nodes without measurements fall back to the analytical
+// estimates of `OpLevelCostEstimator`.
+//
+// To make the `VirtualScheduler` simulate the recorded profile, pass this
+// estimator to the `AnalyticalCostEstimator`.
+class ProfiledOpLevelCostEstimator : public OpLevelCostEstimator {
+ public:
+  ProfiledOpLevelCostEstimator() = default;
+  ~ProfiledOpLevelCostEstimator() override {}
+
+  // Records the latency of each node executed in `step_stats`, which covers one
+  // step: the sum of the latencies of all its kernels, from the device streams
+  // if it ran on a GPU, and from the host otherwise. Nodes executed in several
+  // steps are estimated from all their steps.
+  void AddStepStats(const StepStats& step_stats);
+
+  // Records the latencies in the `RunMetadata` stored in the file at `path`,
+  // as written by `WriteBinaryProto` or `WriteTextProto`.
+  Status AddRunMetadataFromFile(const std::string& path);
+
+  // Returns the measured latency of `node_name`, if any.
+  std::optional<Costs::Duration> GetMeasuredLatency(
+      const std::string& node_name) const;
+
+  // Returns the analytical estimate of the costs, with the measured latency
+  // for the execution, compute and memory times if there is one.
+  Costs PredictCosts(const OpContext& op_context) const override;
+
+ private:
+  // Node names to their measured latencies in each step, in microseconds.
+  absl::flat_hash_map<std::string, std::vector<double>> samples_;
+  // Node names to their estimated latencies, computed from `samples_`.
+  absl::flat_hash_map<std::string, Costs::Duration> latencies_;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_COSTS_PROFILED_OP_LEVEL_COST_ESTIMATOR_H_
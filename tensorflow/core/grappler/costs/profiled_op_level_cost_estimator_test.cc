@@ -0,0 +1,168 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/profiled_op_level_cost_estimator.h"
+
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kCpuDevice[] = "/job:localhost/replica:0/task:0/device:CPU:0";
+constexpr char kGpuDevice[] = "/job:localhost/replica:0/task:0/device:GPU:0";
+
+void AddNodeStats(const std::string& node_name, int64_t latency_micros,
+                  StepStats* step_stats,
+                  const std::string& device = kCpuDevice) {
+  DeviceStepStats* dev_stats = nullptr;
+  for (DeviceStepStats& existing : *step_stats->mutable_dev_stats()) {
+    if (existing.device() == device) dev_stats = &existing;
+  }
+  if (dev_stats == nullptr) {
+    dev_stats = step_stats->add_dev_stats();
+    dev_stats->set_device(device);
+  }
+  NodeExecStats* node_stats = dev_stats->add_node_stats();
+  node_stats->set_node_name(node_name);
+  node_stats->set_all_start_micros(100);
+  node_stats->set_op_start_rel_micros(1);
+  node_stats->set_op_end_rel_micros(1 + latency_micros);
+}
+
+OpContext MatMulContext(const std::string& name) {
+  OpContext op_context;
+  op_context.name = name;
+  op_context.op_info.set_op("MatMul");
+  for (int i = 0; i < 2; ++i) {
+    OpInfo::TensorProperties* input = op_context.op_info.add_inputs();
+    input->set_dtype(DT_FLOAT);
+    input->mutable_shape()->add_dim()->set_size(100);
+    input->mutable_shape()->add_dim()->set_size(100);
+  }
+  DeviceProperties* device = op_context.op_info.mutable_device();
+  device->set_type("CPU");
+  device->set_num_cores(4);
+  device->set_frequency(2600);
+  device->set_bandwidth(24 * 1024 * 1024);
+  return op_context;
+}
+
+TEST(ProfiledOpLevelCostEstimatorTest, UsesMeasuredLatencies) {
+  StepStats step_stats;
+  AddNodeStats("matmul", 250, &step_stats);
+  ProfiledOpLevelCostEstimator estimator;
+  estimator.AddStepStats(step_stats);
+
+  const Costs costs = estimator.PredictCosts(MatMulContext("matmul"));
+  EXPECT_EQ(Costs::Duration(250000), costs.execution_time);
+  EXPECT_EQ(Costs::Duration(250000), costs.compute_time);
+  EXPECT_EQ(Costs::Duration(0), costs.memory_time);
+  EXPECT_FALSE(costs.inaccurate);
+}
+
+TEST(ProfiledOpLevelCostEstimatorTest, FallsBackToAnalyticalEstimates) {
+  ProfiledOpLevelCostEstimator estimator;
+  OpLevelCostEstimator analytical_estimator;
+  EXPECT_EQ(analytical_estimator.PredictCosts(MatMulContext("matmul"))
+                .execution_time,
+            estimator.PredictCosts(MatMulContext("matmul")).execution_time);
+  EXPECT_FALSE(estimator.GetMeasuredLatency("matmul").has_value());
+}
+
+TEST(ProfiledOpLevelCostEstimatorTest, SumsExecutionsWithinStep) {
+  StepStats step_stats;
+  AddNodeStats("matmul", 100, &step_stats);
+  AddNodeStats("matmul", 50, &step_stats);
+  ProfiledOpLevelCostEstimator estimator;
+  estimator.AddStepStats(step_stats);
+  ASSERT_TRUE(estimator.GetMeasuredLatency("matmul").has_value());
+  EXPECT_EQ(Costs::Duration(150000), *estimator.GetMeasuredLatency("matmul"));
+}
+
+TEST(ProfiledOpLevelCostEstimatorTest, AggregatesSteps) {
+  ProfiledOpLevelCostEstimator estimator;
+  for (int step = 0; step < 3; ++step) {
+    StepStats step_stats;
+    AddNodeStats("matmul", 100, &step_stats);
+    estimator.AddStepStats(step_stats);
+  }
+  ASSERT_TRUE(estimator.GetMeasuredLatency("matmul").has_value());
+  EXPECT_EQ(Costs::Duration(100000), *estimator.GetMeasuredLatency("matmul"));
+}
+
+TEST(ProfiledOpLevelCostEstimatorTest, CountsGpuKernelsOnce) {
+  StepStats step_stats;
+  // The launch of the kernels on the host, and each kernel both on its stream
+  // and on "stream:all".
+  AddNodeStats("matmul", 10, &step_stats, kGpuDevice);
+  AddNodeStats("matmul:gemm", 100, &step_stats,
+               absl::StrCat(kGpuDevice, "/stream:all"));
+  AddNodeStats("matmul:bias", 50, &step_stats,
+               absl::StrCat(kGpuDevice, "/stream:all"));
+  AddNodeStats("matmul:gemm", 100, &step_stats,
+               absl::StrCat(kGpuDevice, "/stream:7"));
+  AddNodeStats("matmul:bias", 50, &step_stats,
+               absl::StrCat(kGpuDevice, "/stream:8"));
+  ProfiledOpLevelCostEstimator estimator;
+  estimator.AddStepStats(step_stats);
+  ASSERT_TRUE(estimator.GetMeasuredLatency("matmul").has_value());
+  EXPECT_EQ(Costs::Duration(150000), *estimator.GetMeasuredLatency("matmul"));
+}
+
+TEST(ProfiledOpLevelCostEstimatorTest, SumsGpuKernelsOfStreams) {
+  StepStats step_stats;
+  AddNodeStats("matmul", 10, &step_stats, kGpuDevice);
+  AddNodeStats("matmul:gemm", 100, &step_stats,
+               absl::StrCat(kGpuDevice, "/stream:7"));
+  AddNodeStats("matmul:bias", 50, &step_stats,
+               absl::StrCat(kGpuDevice, "/stream:8"));
+  ProfiledOpLevelCostEstimator estimator;
+  estimator.AddStepStats(step_stats);
+  ASSERT_TRUE(estimator.GetMeasuredLatency("matmul").has_value());
+  EXPECT_EQ(Costs::Duration(150000), *estimator.GetMeasuredLatency("matmul"));
+}
+
+TEST(ProfiledOpLevelCostEstimatorTest, ReadsRunMetadata) {
+  RunMetadata run_metadata;
+  AddNodeStats("matmul", 40, run_metadata.mutable_step_stats());
+  const std::string path =
+      io::JoinPath(testing::TmpDir(), "profiled_run_metadata.pb");
+  TF_ASSERT_OK(WriteBinaryProto(Env::Default(), path, run_metadata));
+
+  ProfiledOpLevelCostEstimator estimator;
+  TF_ASSERT_OK(estimator.AddRunMetadataFromFile(path));
+  ASSERT_TRUE(estimator.GetMeasuredLatency("matmul").has_value());
+  EXPECT_EQ(Costs::Duration(40000), *estimator.GetMeasuredLatency("matmul"));
+  EXPECT_FALSE(estimator
+                   .AddRunMetadataFromFile(io::JoinPath(
+                       testing::TmpDir(), "missing_run_metadata.pb"))
+                   .ok());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
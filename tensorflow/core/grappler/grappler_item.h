@@ -32,6 +32,8 @@ limitations under the License.
 namespace tensorflow {
 namespace grappler {
 
+class GraphPropertiesCache;
+
 // A TensorFlow model to optimize.
 // Models are represented by the combination of a graph, one of more fetch
 // nodes, and potentially a set of nodes to feed.
@@ -71,6 +73,11 @@ struct GrapplerItem {
   // ensure that the optimized metagraph can still be loaded.
   std::vector<string> keep_ops;
 
+  // If set, the shape inference results of `GraphProperties::InferStatically`
+  // are reused for identical graphs of this item and of the items derived from
+  // it, e.g. across the passes of the meta optimizer.
+  std::shared_ptr<GraphPropertiesCache> graph_properties_cache;
+
   // Return the set of node evaluated during a regular train/inference step.
   std::vector<const NodeDef*> MainOpsFanin() const;
   // Return the set of node run to populate the queues (if any).
@@ -0,0 +1,350 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/op_def.pb.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/function_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/gtl/map_util.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kMapDataset[] = "MapDataset";
+constexpr char kParallelMapDataset[] = "ParallelMapDataset";
+constexpr char kParallelMapDatasetV2[] = "ParallelMapDatasetV2";
+constexpr char kBatchDataset[] = "BatchDataset";
+constexpr char kBatchDatasetV2[] = "BatchDatasetV2";
+constexpr char kMapDefun[] = "MapDefun";
+
+bool IsMap(const NodeDef& node) {
+  return node.op() == kMapDataset || node.op() == kParallelMapDataset ||
+         node.op() == kParallelMapDatasetV2;
+}
+
+bool IsBatch(const NodeDef& node) {
+  return node.op() == kBatchDataset || node.op() == kBatchDatasetV2;
+}
+
+// Returns the element shapes of `input_node`, the input of `map_node`, in
+// `shapes`, or false if they are not all fully defined. `batch` only stacks
+// elements whose components have the same shape, so the rewrite must not
+// batch inputs whose shapes vary even if the map outputs do not.
+bool GetStaticInputShapes(const NodeDef& map_node, const NodeDef& input_node,
+                          std::vector<TensorShape>* shapes) {
+  const AttrValue* output_shapes =
+      gtl::FindOrNull(input_node.attr(), "output_shapes");
+  if (output_shapes == nullptr) {
+    VLOG(1) << "Not vectorizing " << map_node.name()
+            << " because the shapes of its input are unknown.";
+    return false;
+  }
+  shapes->clear();
+  for (const auto& shape_proto : output_shapes->list().shape()) {
+    PartialTensorShape shape(shape_proto);
+    TensorShape static_shape;
+    if (!shape.AsTensorShape(&static_shape)) {
+      VLOG(1) << "Not vectorizing " << map_node.name()
+              << " because its input has shape " << shape.DebugString()
+              << ", which is not fully defined.";
+      return false;
+    }
+    shapes->push_back(static_shape);
+  }
+  return true;
+}
+
+// Returns whether `map_node` and its function `func` can be rewritten without
+// changing the semantics of the pipeline. `input_shapes` are the element shapes
+// of the input of `map_node`.
+bool CanVectorize(const NodeDef& map_node, const FunctionDef& func,
+                  const FunctionLibraryDefinition& function_library,
+                  const std::vector<TensorShape>& input_shapes) {
+  const AttrValue* preserve_cardinality =
+      gtl::FindOrNull(map_node.attr(), "preserve_cardinality");
+  if (preserve_cardinality == nullptr || !preserve_cardinality->b()) {
+    // `MapDefun` reports an `OutOfRange` error raised by the function as an
+    // error instead of the end of the input.
+    VLOG(1) << "Not vectorizing " << map_node.name()
+            << " because it does not preserve cardinality.";
+    return false;
+  }
+  if (function_utils::IsFunctionStateful(function_library, func)) {
+    VLOG(1) << "Not vectorizing " << map_node.name()
+            << " because its function is stateful.";
+    return false;
+  }
+  const int num_captured =
+      map_node.attr().at("Targuments").list().type_size();
+  if (func.signature().input_arg_size() <= num_captured) {
+    VLOG(1) << "Not vectorizing " << map_node.name()
+            << " because its function has no element arguments.";
+    return false;
+  }
+  const int num_element_args =
+      func.signature().input_arg_size() - num_captured;
+  if (static_cast<int>(input_shapes.size()) != num_element_args) {
+    VLOG(1) << "Not vectorizing " << map_node.name()
+            << " because its input has " << input_shapes.size()
+            << " components, but its function has " << num_element_args
+            << " element arguments.";
+    return false;
+  }
+  // Batching resources and variants (e.g. ragged tensors or datasets) before
+  // the map, or stacking them by slice after it, does not necessarily match
+  // how `batch` combines them.
+  auto is_supported_type = [](DataType type) {
+    return type != DT_INVALID && type != DT_RESOURCE && type != DT_VARIANT;
+  };
+  for (int i = 0; i < func.signature().input_arg_size(); ++i) {
+    const DataType type = func.signature().input_arg(i).type();
+    if (type == DT_INVALID) {
+      return false;
+    }
+    if (i < num_element_args && !is_supported_type(type)) {
+      VLOG(1) << "Not vectorizing " << map_node.name()
+              << " because its function has an element argument of type "
+              << DataTypeString(type) << ".";
+      return false;
+    }
+  }
+  for (const auto& arg : func.signature().output_arg()) {
+    if (!is_supported_type(arg.type())) {
+      VLOG(1) << "Not vectorizing " << map_node.name()
+              << " because its function has an output of type "
+              << DataTypeString(arg.type()) << ".";
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns the element shapes of the outputs of `map_node`, or unknown shapes if
+// the node does not set them.
+std::vector<PartialTensorShape> ElementShapes(const NodeDef& map_node,
+                                              int num_outputs) {
+  std::vector<PartialTensorShape> shapes(num_outputs);
+  const AttrValue* output_shapes =
+      gtl::FindOrNull(map_node.attr(), "output_shapes");
+  if (output_shapes == nullptr ||
+      output_shapes->list().shape_size() != num_outputs) {
+    return shapes;
+  }
+  for (int i = 0; i < num_outputs; ++i) {
+    shapes[i] = PartialTensorShape(output_shapes->list().shape(i));
+  }
+  return shapes;
+}
+
+// Adds a function to `library` that applies `func` to the slices of its
+// batched element arguments using `MapDefun`. The function has the signature of
+// `func`, with batched element arguments and outputs.
+FunctionDef* AddVectorizedFunction(const NodeDef& map_node,
+                                   const FunctionDef& func,
+                                   FunctionDefLibrary* library) {
+  FunctionDef* vectorized = library->add_function();
+  graph_utils::SetUniqueGraphFunctionName(
+      absl::StrCat("vectorized_", func.signature().name()), library,
+      vectorized);
+  OpDef* signature = vectorized->mutable_signature();
+  *signature->mutable_input_arg() = func.signature().input_arg();
+  *signature->mutable_output_arg() = func.signature().output_arg();
+
+  const int num_captured =
+      map_node.attr().at("Targuments").list().type_size();
+  const int num_element_args = signature->input_arg_size() - num_captured;
+  std::vector<string> inputs;
+  DataTypeVector element_types, captured_types, output_types;
+  for (int i = 0; i < signature->input_arg_size(); ++i) {
+    const auto& arg = signature->input_arg(i);
+    inputs.push_back(arg.name());
+    if (i < num_element_args) {
+      element_types.push_back(arg.type());
+    } else {
+      captured_types.push_back(arg.type());
+    }
+  }
+  for (const auto& arg : signature->output_arg()) {
+    output_types.push_back(arg.type());
+  }
+
+  AttrValue element_types_attr, captured_types_attr, output_types_attr,
+      output_shapes_attr, func_attr;
+  SetAttrValue(element_types, &element_types_attr);
+  SetAttrValue(captured_types, &captured_types_attr);
+  SetAttrValue(output_types, &output_types_attr);
+  SetAttrValue(ElementShapes(map_node, output_types.size()),
+               &output_shapes_attr);
+  func_attr = map_node.attr().at("f");
+  NodeDef* map_defun = function_utils::AddNode(
+      /*name=*/"", kMapDefun, inputs,
+      {{"Targuments", element_types_attr},
+       {"Tcaptured", captured_types_attr},
+       {"output_types", output_types_attr},
+       {"output_shapes", output_shapes_attr},
+       {"f", func_attr}},
+      vectorized);
+  for (int i = 0; i < signature->output_arg_size(); ++i) {
+    (*vectorized->mutable_ret())[signature->output_arg(i).name()] =
+        absl::StrCat(map_defun->name(), ":output:", i);
+  }
+  return vectorized;
+}
+
+// Returns the size of the leading dimension of the outputs of `batch_node`, or
+// -1 if it is unknown.
+int64_t BatchDimSize(const NodeDef& batch_node) {
+  const AttrValue* output_shapes =
+      gtl::FindOrNull(batch_node.attr(), "output_shapes");
+  if (output_shapes == nullptr || output_shapes->list().shape_size() == 0) {
+    return -1;
+  }
+  PartialTensorShape shape(output_shapes->list().shape(0));
+  if (shape.unknown_rank() || shape.dims() == 0) return -1;
+  return shape.dim_size(0);
+}
+
+// Returns a copy of `batch_node` that batches the input of `map_node`, whose
+// elements have the shapes `input_shapes`.
+NodeDef MakeBatchNode(const NodeDef& batch_node, const NodeDef& map_node,
+                      const FunctionDef& vectorized,
+                      const std::vector<TensorShape>& input_shapes,
+                      MutableGraphView* graph) {
+  NodeDef new_batch_node = batch_node;
+  graph_utils::SetUniqueGraphNodeName(batch_node.op(), graph->graph(),
+                                      &new_batch_node);
+  new_batch_node.set_input(0, map_node.input(0));
+
+  // The element arguments of the vectorized function are the components of
+  // the batches.
+  const int num_captured =
+      map_node.attr().at("Targuments").list().type_size();
+  const int num_components =
+      vectorized.signature().input_arg_size() - num_captured;
+  DataTypeVector output_types;
+  for (int i = 0; i < num_components; ++i) {
+    output_types.push_back(vectorized.signature().input_arg(i).type());
+  }
+  SetAttrValue(output_types, &(*new_batch_node.mutable_attr())["output_types"]);
+  std::vector<PartialTensorShape> output_shapes;
+  const int64_t batch_dim_size = BatchDimSize(batch_node);
+  for (const TensorShape& input_shape : input_shapes) {
+    PartialTensorShape output_shape({batch_dim_size});
+    output_shapes.push_back(
+        output_shape.Concatenate(PartialTensorShape(input_shape.dim_sizes())));
+  }
+  SetAttrValue(output_shapes,
+               &(*new_batch_node.mutable_attr())["output_shapes"]);
+  return new_batch_node;
+}
+
+// Returns a copy of `map_node` that applies `vectorized` to the output of
+// `new_batch_node`, with the output signature of `batch_node`.
+NodeDef MakeMapNode(const NodeDef& map_node, const NodeDef& batch_node,
+                    const NodeDef& new_batch_node,
+                    const FunctionDef& vectorized, MutableGraphView* graph) {
+  NodeDef new_map_node = map_node;
+  graph_utils::SetUniqueGraphNodeName(map_node.op(), graph->graph(),
+                                      &new_map_node);
+  new_map_node.set_input(0, new_batch_node.name());
+  AttrValue func_attr;
+  func_attr.mutable_func()->set_name(vectorized.signature().name());
+  (*new_map_node.mutable_attr())["f"] = func_attr;
+  graph_utils::CopyShapesAndTypesAttrs(batch_node, &new_map_node);
+  graph_utils::MaybeSetFusedMetadata(map_node, batch_node, &new_map_node);
+  return new_map_node;
+}
+
+}  // namespace
+
+Status MapVectorization::OptimizeAndCollectStats(Cluster* cluster,
+                                                 const GrapplerItem& item,
+                                                 GraphDef* output,
+                                                 OptimizationStats* stats) {
+  *output = item.graph;
+  MutableGraphView graph(output);
+  absl::flat_hash_set<string> nodes_to_delete;
+  FunctionLibraryDefinition function_library(OpRegistry::Global(),
+                                             item.graph.library());
+
+  for (const NodeDef& node : item.graph.node()) {
+    if (!IsBatch(node)) continue;
+    const NodeDef& batch_node = node;
+    const NodeDef* map_node = graph_utils::GetInputNode(batch_node, graph);
+    if (map_node == nullptr || !IsMap(*map_node)) continue;
+    // The map is evaluated per element for any other consumer anyway.
+    if (graph.GetFanouts(*map_node, /*include_controlled_nodes=*/false)
+            .size() != 1) {
+      continue;
+    }
+    const NodeDef* input_node = graph_utils::GetInputNode(*map_node, graph);
+    std::vector<TensorShape> input_shapes;
+    if (input_node == nullptr ||
+        !GetStaticInputShapes(*map_node, *input_node, &input_shapes)) {
+      continue;
+    }
+    const FunctionDef* func =
+        function_library.Find(map_node->attr().at("f").func().name());
+    if (func == nullptr ||
+        !CanVectorize(*map_node, *func, function_library, input_shapes)) {
+      continue;
+    }
+
+    const FunctionDef* vectorized =
+        AddVectorizedFunction(*map_node, *func, output->mutable_library());
+    TF_RETURN_IF_ERROR(function_library.AddFunctionDef(*vectorized));
+    const NodeDef* new_batch_node = graph.AddNode(
+        MakeBatchNode(batch_node, *map_node, *vectorized, input_shapes,
+                      &graph));
+    const NodeDef* new_map_node = graph.AddNode(MakeMapNode(
+        *map_node, batch_node, *new_batch_node, *vectorized, &graph));
+    TF_RETURN_IF_ERROR(
+        graph.UpdateFanouts(batch_node.name(), new_map_node->name()));
+
+    nodes_to_delete.insert(map_node->name());
+    nodes_to_delete.insert(batch_node.name());
+    stats->num_changes++;
+  }
+
+  TF_RETURN_IF_ERROR(graph.DeleteNodes(nodes_to_delete));
+  return absl::OkStatus();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(MapVectorization, "map_vectorization");
+
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,210 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/function_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_test_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using graph_tests_utils::MakeBatchV2Node;
+using graph_tests_utils::MakeMapNode;
+using graph_tests_utils::MakeParallelMapV2Node;
+
+NodeDef WithPreserveCardinality(NodeDef map_node, bool preserve_cardinality) {
+  AddNodeAttr("preserve_cardinality", preserve_cardinality, &map_node);
+  return map_node;
+}
+
+// Returns a pipeline `range -> map -> batch`, where `map_node` is named "map",
+// reads from "range" and applies `function`, and the elements of "range" have
+// the shape `input_shape` and the type `input_type`.
+GrapplerItem MakePipeline(NodeDef map_node, const FunctionDef& function,
+                          const PartialTensorShape& input_shape =
+                              PartialTensorShape({}),
+                          DataType input_type = DT_INT32) {
+  using test::function::NDef;
+  const std::vector<PartialTensorShape> input_shapes = {input_shape};
+  const DataTypeVector input_types = {input_type};
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("start", "Const", {}, {{"value", 0}, {"dtype", DT_INT32}}),
+       NDef("stop", "Const", {}, {{"value", 10}, {"dtype", DT_INT32}}),
+       NDef("step", "Const", {}, {{"value", 1}, {"dtype", DT_INT32}}),
+       NDef("range", "RangeDataset", {"start", "stop", "step"},
+            {{"output_shapes", absl::Span<const PartialTensorShape>(
+                                   input_shapes)},
+             {"output_types", absl::Span<const DataType>(input_types)}}),
+       NDef("num_parallel_calls", "Const", {},
+            {{"value", -1}, {"dtype", DT_INT64}}),
+       map_node,
+       NDef("batch_size", "Const", {}, {{"value", 5}, {"dtype", DT_INT64}}),
+       NDef("drop_remainder", "Const", {},
+            {{"value", false}, {"dtype", DT_BOOL}}),
+       MakeBatchV2Node("batch", "map", "batch_size", "drop_remainder",
+                       /*parallel_copy=*/false)},
+      {function});
+  return item;
+}
+
+void ExpectVectorized(const GraphDef& output, const string& map_op) {
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("batch", output));
+  ASSERT_TRUE(graph_utils::ContainsNodeWithOp(map_op, output));
+  ASSERT_TRUE(graph_utils::ContainsNodeWithOp("BatchDatasetV2", output));
+
+  // The batch now comes first, and the map applies the vectorized function.
+  const NodeDef& map_node =
+      output.node(graph_utils::FindGraphNodeWithOp(map_op, output));
+  const NodeDef& batch_node =
+      output.node(graph_utils::FindGraphNodeWithOp("BatchDatasetV2", output));
+  EXPECT_EQ(map_node.input(0), batch_node.name());
+  EXPECT_EQ(batch_node.input(0), "range");
+  EXPECT_EQ(batch_node.input(1), "batch_size");
+  EXPECT_EQ(batch_node.input(2), "drop_remainder");
+  // The batches of scalars have a static inner shape.
+  ASSERT_EQ(batch_node.attr().at("output_shapes").list().shape_size(), 1);
+  EXPECT_EQ(
+      PartialTensorShape(batch_node.attr().at("output_shapes").list().shape(0))
+          .DebugString(),
+      "[?]");
+
+  const int function_index = graph_utils::FindGraphFunctionWithName(
+      map_node.attr().at("f").func().name(), output.library());
+  ASSERT_NE(function_index, -1);
+  const FunctionDef& vectorized = output.library().function(function_index);
+  const int map_defun_index =
+      function_utils::FindFunctionNodeWithOp("MapDefun", vectorized);
+  ASSERT_NE(map_defun_index, -1);
+  const NodeDef& map_defun = vectorized.node_def(map_defun_index);
+  EXPECT_EQ(map_defun.attr().at("f").func().name(), "XTimesTwoInt32");
+  EXPECT_EQ(map_defun.input(0), vectorized.signature().input_arg(0).name());
+}
+
+TEST(MapVectorizationTest, VectorizesMap) {
+  GrapplerItem item = MakePipeline(
+      WithPreserveCardinality(MakeMapNode("map", "range", "XTimesTwoInt32"),
+                              true),
+      test::function::XTimesTwoInt32());
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  ExpectVectorized(output, "MapDataset");
+}
+
+TEST(MapVectorizationTest, VectorizesParallelMap) {
+  GrapplerItem item =
+      MakePipeline(WithPreserveCardinality(
+                       MakeParallelMapV2Node("map", "range",
+                                             "num_parallel_calls",
+                                             "XTimesTwoInt32", "default"),
+                       true),
+                   test::function::XTimesTwoInt32());
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  ExpectVectorized(output, "ParallelMapDatasetV2");
+  const NodeDef& map_node = output.node(
+      graph_utils::FindGraphNodeWithOp("ParallelMapDatasetV2", output));
+  EXPECT_EQ(map_node.input(1), "num_parallel_calls");
+}
+
+TEST(MapVectorizationTest, DoesNotVectorizeWithoutPreserveCardinality) {
+  GrapplerItem item = MakePipeline(
+      WithPreserveCardinality(MakeMapNode("map", "range", "XTimesTwoInt32"),
+                              false),
+      test::function::XTimesTwoInt32());
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+TEST(MapVectorizationTest, DoesNotVectorizeStatefulFunction) {
+  GrapplerItem item = MakePipeline(
+      WithPreserveCardinality(MakeMapNode("map", "range", "RandomUniformFn"),
+                              true),
+      test::function::RandomUniform());
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+TEST(MapVectorizationTest, DoesNotVectorizeSharedMap) {
+  GrapplerItem item = MakePipeline(
+      WithPreserveCardinality(MakeMapNode("map", "range", "XTimesTwoInt32"),
+                              true),
+      test::function::XTimesTwoInt32());
+  // Another consumer of the map still needs its per-element outputs.
+  *item.graph.add_node() = test::function::NDef(
+      "take", "TakeDataset", {"map", "batch_size"}, {});
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+TEST(MapVectorizationTest, DoesNotVectorizeInputWithUnknownShape) {
+  // Batching the input first would fail on elements of different sizes, which
+  // the map could have mapped to outputs of the same shape.
+  GrapplerItem item = MakePipeline(
+      WithPreserveCardinality(MakeMapNode("map", "range", "XTimesTwoInt32"),
+                              true),
+      test::function::XTimesTwoInt32(), PartialTensorShape({-1}));
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+TEST(MapVectorizationTest, DoesNotVectorizeVariantInput) {
+  const FunctionDef variant_size = FunctionDefHelper::Define(
+      "VariantSize", {"x: variant"}, {"y: int32"}, {},
+      {{{"y"}, "Size", {"x"}, {{"T", DT_VARIANT}, {"out_type", DT_INT32}}}});
+  GrapplerItem item = MakePipeline(
+      WithPreserveCardinality(MakeMapNode("map", "range", "VariantSize"),
+                              true),
+      variant_size, PartialTensorShape({}), DT_VARIANT);
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
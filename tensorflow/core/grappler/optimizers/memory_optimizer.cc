@@ -30,6 +30,8 @@ limitations under the License.
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/grappler/costs/graph_memory.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
 #include "tensorflow/core/grappler/costs/utils.h"
 #include "tensorflow/core/grappler/graph_topology_view.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -977,6 +979,36 @@ struct MemInfo {
   bool operator<(const MemInfo& other) const { return fitness < other.fitness; }
 };
 
+// Simulates the execution of `item` on the devices of `cluster` and records
+// the time at which each node completes.
+static bool EstimateCompletionTimes(
+    Cluster* cluster, const GrapplerItem& item,
+    std::unordered_map<string, Costs::NanoSeconds>* op_completion_times) {
+  VirtualCluster vcluster(cluster->GetDevices());
+  if (!vcluster.Provision().ok()) {
+    return false;
+  }
+  if (!vcluster.Initialize(item).ok()) {
+    return false;
+  }
+  RunMetadata metadata;
+  Status s = vcluster.Run(item.graph, item.feed, item.fetch, &metadata);
+  if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
+    return false;
+  }
+
+  for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      Costs::NanoSeconds exec_time =
+          Costs::NanoSeconds(1) +
+          Costs::MicroSeconds(node_stats.all_start_micros() +
+                              node_stats.op_end_rel_micros());
+      op_completion_times->emplace(node_stats.node_name(), exec_time);
+    }
+  }
+  return true;
+}
+
 static bool IdentifySwappingCandidates(
     Cluster* cluster, GrapplerItem* item,
     std::unique_ptr<GraphMemory>* memory_ptr,
@@ -1012,29 +1044,8 @@ static bool IdentifySwappingCandidates(
     int64_t required_savings = mem_usage.used_memory - prop.memory_size();
 
     std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
-    {
-      VirtualCluster vcluster(cluster->GetDevices());
-      if (!vcluster.Provision().ok()) {
-        return false;
-      }
-      if (!vcluster.Initialize(*item).ok()) {
-        return false;
-      }
-      RunMetadata metadata;
-      Status s = vcluster.Run(item->graph, item->feed, item->fetch, &metadata);
-      if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
-        return false;
-      }
-
-      for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
-        for (const auto& node_stats : dev_stats.node_stats()) {
-          Costs::NanoSeconds exec_time =
-              Costs::NanoSeconds(1) +
-              Costs::MicroSeconds(node_stats.all_start_micros() +
-                                  node_stats.op_end_rel_micros());
-          op_completion_times.emplace(node_stats.node_name(), exec_time);
-        }
-      }
+    if (!EstimateCompletionTimes(cluster, *item, &op_completion_times)) {
+      return false;
     }
 
     Costs::Duration peak_time = -1;
@@ -1270,6 +1281,233 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
   return updated_graph;
 }
 
+struct RematerializationCandidate {
+  NodeDef* node;
+  std::unordered_set<NodeDef*> uses_left;
+  int64_t memory_used;
+  Costs::Duration recompute_time;
+
+  // Frees the most memory per unit of recompute time first.
+  bool operator<(const RematerializationCandidate& other) const {
+    return static_cast<double>(memory_used) * other.recompute_time.count() >
+           static_cast<double>(other.memory_used) * recompute_time.count();
+  }
+};
+
+// Returns whether `node` can be recomputed from its inputs, i.e. whether a copy
+// of the node produces the same outputs.
+bool IsRecomputable(const NodeDef& node,
+                    const std::unordered_set<string>& feeds,
+                    const std::unordered_set<string>& skip_list) {
+  if (feeds.count(node.name()) != 0 || skip_list.count(node.name()) != 0) {
+    return false;
+  }
+  if (NumNonControlInputs(node) == 0 || IsControlFlow(node) ||
+      IsPersistent(node) || IsStateful(node) ||
+      !IsFreeOfSideEffect(node)) {
+    return false;
+  }
+  return true;
+}
+
+// Trades compute for memory on the GPUs whose peak memory usage exceeds their
+// capacity: the tensors that are live at the peak and cheaper to recompute than
+// to swap are recomputed right before their uses after the peak, until enough
+// memory is saved. The cost of recomputing a tensor is the compute time of its
+// producer estimated by the OpLevelCostEstimator, and the cost of swapping it
+// the time to transfer it over PCIe. Only producers whose inputs stay alive
+// until the last recomputed use anyway are considered, so that recomputing
+// them does not extend the lifetime of other tensors. The remaining savings
+// are left to the swapping pass.
+bool RematerializationPass(Cluster* cluster,
+                           std::unique_ptr<GraphMemory>* memory_ptr,
+                           GrapplerItem* item,
+                           std::unordered_set<string>* skip_list) {
+  if ((*memory_ptr) == nullptr) {
+    memory_ptr->reset(new GraphMemory(*item));
+    Status s = (*memory_ptr)->InferStatically(cluster->GetDevices());
+    if (!s.ok()) {
+      memory_ptr->reset();
+      VLOG(1) << "Failed to infer memory usage: " << s.message();
+      return false;
+    }
+  }
+  const GraphMemory& memory = **memory_ptr;
+
+  std::unordered_map<string, int64_t> required_savings;
+  for (const auto& device : cluster->GetDevices()) {
+    const DeviceProperties& prop = device.second;
+    if (prop.type() != "GPU" || prop.memory_size() <= 0) {
+      continue;
+    }
+    const int64_t used_memory =
+        memory.GetPeakMemoryUsage(device.first).used_memory;
+    if (used_memory > prop.memory_size()) {
+      required_savings[device.first] = used_memory - prop.memory_size();
+    }
+  }
+  if (required_savings.empty()) {
+    return false;
+  }
+
+  std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
+  if (!EstimateCompletionTimes(cluster, *item, &op_completion_times)) {
+    return false;
+  }
+  GraphProperties properties(*item);
+  if (!properties
+           .InferStatically(/*assume_valid_feeds=*/true,
+                            /*aggressive_shape_inference=*/false,
+                            /*include_tensor_values=*/false)
+           .ok()) {
+    return false;
+  }
+
+  // The recomputed subgraphs are wired up based on a topological numbering of
+  // the nodes, see RecomputationRewritingPass.
+  if (!TopologicalSort(&item->graph).ok()) {
+    return false;
+  }
+  NodeMap node_map(&item->graph);
+  std::unordered_map<const NodeDef*, int> topological_numbering;
+  for (int node_number = 0; node_number < item->graph.node_size();
+       ++node_number) {
+    topological_numbering[item->graph.mutable_node(node_number)] =
+        item->graph.node_size() - node_number - 1;
+  }
+  std::unordered_set<string> feeds;
+  for (const auto& feed : item->feed) {
+    feeds.insert(NodeName(feed.first));
+  }
+  OpLevelCostEstimator cost_estimator;
+
+  bool updated_graph = false;
+  for (auto& device_savings : required_savings) {
+    const string& device_name = device_savings.first;
+    const DeviceProperties& device_properties =
+        cluster->GetDevices().at(device_name);
+    const GraphMemory::MemoryUsage& mem_usage =
+        memory.GetPeakMemoryUsage(device_name);
+    Costs::Duration peak_time = -1;
+    std::unordered_map<string, Costs::Duration> deallocation_times;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      peak_time = std::max(peak_time, live_tensor.allocation_time);
+      deallocation_times[strings::StrCat(live_tensor.node, ":",
+                                         live_tensor.output_id)] =
+          live_tensor.deallocation_time;
+    }
+
+    std::vector<RematerializationCandidate> candidates;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      if (live_tensor.memory_used <= 1024) {
+        // Don't bother with small tensors.
+        continue;
+      }
+      NodeDef* node = node_map.GetNode(live_tensor.node);
+      if (node == nullptr || !IsRecomputable(*node, feeds, *skip_list)) {
+        continue;
+      }
+
+      // Only the uses after the peak benefit from the recomputation.
+      RematerializationCandidate candidate;
+      candidate.node = node;
+      candidate.memory_used = live_tensor.memory_used;
+      Costs::Duration last_use = peak_time;
+      bool valid = true;
+      for (NodeDef* output : node_map.GetOutputs(node->name())) {
+        auto it = op_completion_times.find(output->name());
+        if (it == op_completion_times.end() ||
+            skip_list->count(output->name()) != 0) {
+          valid = false;
+          break;
+        }
+        if (it->second > peak_time) {
+          candidate.uses_left.insert(output);
+          last_use = std::max(last_use, it->second);
+        }
+      }
+      if (!valid || candidate.uses_left.empty()) {
+        continue;
+      }
+      for (const string& input : node->input()) {
+        if (IsControlInput(input)) {
+          continue;
+        }
+        const TensorId tensor_id = ParseTensorName(input);
+        auto it = deallocation_times.find(
+            strings::StrCat(tensor_id.node(), ":", tensor_id.index()));
+        if (it == deallocation_times.end() || it->second < last_use) {
+          valid = false;
+          break;
+        }
+      }
+      if (!valid) {
+        continue;
+      }
+
+      OpContext op_context;
+      op_context.name = node->name();
+      op_context.device_name = device_name;
+      op_context.op_info.set_op(node->op());
+      *op_context.op_info.mutable_attr() = node->attr();
+      for (const auto& input : properties.GetInputProperties(node->name())) {
+        *op_context.op_info.add_inputs() = input;
+      }
+      for (const auto& output : properties.GetOutputProperties(node->name())) {
+        *op_context.op_info.add_outputs() = output;
+      }
+      *op_context.op_info.mutable_device() = device_properties;
+      const Costs costs = cost_estimator.PredictCosts(op_context);
+      if (costs.inaccurate) {
+        continue;
+      }
+      candidate.recompute_time =
+          std::max(costs.execution_time, Costs::Duration(1));
+      // Let's assume we're going to swap over PCIe running at 16 GBps.
+      const Costs::NanoSeconds time_to_swap(live_tensor.memory_used / 16.0);
+      if (candidate.recompute_time >= time_to_swap) {
+        VLOG(2) << "Swapping " << node->name()
+                << " is cheaper than recomputing it";
+        continue;
+      }
+      candidates.push_back(std::move(candidate));
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+    for (const RematerializationCandidate& candidate : candidates) {
+      if (device_savings.second < 0) {
+        break;
+      }
+      // The inputs of the nodes feeding or fed by a recomputed node have been
+      // rewritten, and the lifetimes estimated above no longer hold.
+      bool inputs_changed = false;
+      for (const string& input : candidate.node->input()) {
+        const string input_node = NodeName(input);
+        if (node_map.GetNode(input_node) == nullptr ||
+            skip_list->count(input_node) != 0) {
+          inputs_changed = true;
+          break;
+        }
+      }
+      if (inputs_changed) {
+        continue;
+      }
+      VLOG(1) << "Will recompute " << candidate.node->name() << " of size "
+              << candidate.memory_used << " in "
+              << candidate.recompute_time.count() << "ns";
+      RecomputeSubgraph({candidate.node}, candidate.uses_left, node_map,
+                        topological_numbering, &item->graph);
+      // Don't swap or recompute the tensor again in subsequent passes.
+      skip_list->insert(candidate.node->name());
+      skip_list->insert(
+          AddPrefixToNodeName(candidate.node->name(), kRecomputedNodePrefix));
+      device_savings.second -= candidate.memory_used;
+      updated_graph = true;
+    }
+  }
+  return updated_graph;
+}
+
 bool CrossesTaskOrCpuGpuBoundary(const NodeDef& node1, const NodeDef& node2) {
   string task1;
   string device1;
@@ -1422,6 +1660,16 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
         }
       }
 
+      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+      if (optimization_level_ == RewriterConfig::HEURISTICS) {
+        if (RematerializationPass(cluster, &memory, &optimized_item,
+                                  &skip_list)) {
+          // Reset the inferred memory usage since the graph changed.
+          memory.reset();
+          updated_graph = true;
+        }
+      }
+
       GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
       if ((optimization_level_ == RewriterConfig::DEFAULT_MEM_OPT ||
            optimization_level_ == RewriterConfig::SWAPPING_HEURISTICS ||
@@ -20,6 +20,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/strings/strip.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -393,6 +394,62 @@ TEST_F(MemoryOptimizerTest, UnswappableInputs) {
 #endif
 }
 
+TEST_F(MemoryOptimizerTest, RematerializationHeuristics) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output v = ops::Variable(s.WithOpName("v").WithDevice("/gpu:0"),
+                           {128, 128, 8}, DT_FLOAT);
+  Output a = ops::Identity(s.WithOpName("a").WithDevice("/gpu:0"), v);
+  Output b = ops::Square(s.WithOpName("b").WithDevice("/gpu:0"), a);
+  Output c = ops::Sqrt(s.WithOpName("c").WithDevice("/gpu:0"), a);
+  Output d = ops::Exp(s.WithOpName("d").WithDevice("/gpu:0"), c);
+  Output axis = ops::Const(s.WithOpName("axis"), 0);
+  Output e =
+      ops::Concat(s.WithOpName("e").WithDevice("/gpu:0"), {b, c, d}, axis);
+  Output f = ops::Log(s.WithOpName("f").WithDevice("/gpu:0"), b);
+  Output g = ops::Mul(s.WithOpName("g").WithDevice("/gpu:0"), a, f);
+
+  Output constant = ops::Const(s.WithOpName("constant"), 0.0f, {128, 128, 8});
+  Output init = ops::Assign(s.WithOpName("init"), v, constant);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"e", "g"};
+  item.init_ops = {init.name()};
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+
+  MemoryOptimizer optimizer(RewriterConfig::HEURISTICS);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  // Recomputed nodes are copies of side effect free nodes, and are triggered
+  // by a control dependency.
+  NodeMap node_map(&output);
+  for (const auto& node : output.node()) {
+    absl::string_view original_name = node.name();
+    if (!absl::ConsumePrefix(&original_name, "Recomputed/")) {
+      continue;
+    }
+    const NodeDef* original = node_map.GetNode(string(original_name));
+    ASSERT_NE(nullptr, original);
+    EXPECT_EQ(original->op(), node.op());
+    EXPECT_NE("v", original->name());
+    EXPECT_TRUE(IsControlInput(node.input(node.input_size() - 1)));
+    for (const string& input : node.input()) {
+      EXPECT_NE(nullptr, node_map.GetNode(input));
+    }
+  }
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  auto tensors_expected = EvaluateFetchNodes(item);
+  GrapplerItem optimized = item.WithGraph(std::move(output));
+  auto tensors = EvaluateFetchNodes(optimized);
+  for (int i = 0; i < item.fetch.size(); ++i) {
+    test::ExpectTensorEqual<float>(tensors_expected[i], tensors[i]);
+  }
+#endif
+}
+
 TEST_F(MemoryOptimizerTest, AccumulationRewrites) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output a = ops::RandomNormal(s.WithOpName("a").WithDevice("/cpu:0"),
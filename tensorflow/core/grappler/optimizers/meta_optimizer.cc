@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <functional>
+#include <optional>
 #include <string>
 #include <type_traits>
 #include <utility>
@@ -36,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/optimizers/arithmetic_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/auto_mixed_precision.h"
 #include "tensorflow/core/grappler/optimizers/auto_parallel.h"
@@ -62,7 +64,9 @@ limitations under the License.
 #include "tensorflow/core/grappler/verifiers/structure_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/util.h"
 #include "tensorflow/core/util/xla_config_registry.h"
@@ -269,7 +273,8 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
 MetaOptimizer::MetaOptimizer(DeviceBase* cpu_device, const ConfigProto& cfg)
     : cpu_device_(cpu_device),
       config_proto_(cfg),
-      cfg_(*config_proto_.mutable_graph_options()->mutable_rewrite_options()) {
+      cfg_(*config_proto_.mutable_graph_options()->mutable_rewrite_options()),
+      optimized_graph_cache_(OptimizedGraphCache::Global()) {
   DCHECK(cpu_device_ == nullptr ||
          cpu_device_->attributes().device_type() == "CPU");
   auto global_jit_level =
@@ -756,7 +761,8 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
 
 Status MetaOptimizer::OptimizeGraph(
     const std::vector<std::unique_ptr<GraphOptimizer>>& optimizers,
-    Cluster* cluster, GrapplerItem&& item, GraphDef* optimized_graph) {
+    Cluster* cluster, GrapplerItem&& item, GraphDef* optimized_graph,
+    std::vector<GraphOptimizationResult>* results) {
   int min_graph_nodes = cfg_.min_graph_nodes() == 0 ? kDefaultMinGraphNodes
                                                     : cfg_.min_graph_nodes();
   if (item.graph.node_size() < min_graph_nodes) {
@@ -813,6 +819,11 @@ Status MetaOptimizer::OptimizeGraph(
     CompressConstants(optimized_graph);
   }
 
+  // Passes that leave the graph unchanged don't need to infer shapes again.
+  if (item.graph_properties_cache == nullptr) {
+    item.graph_properties_cache = std::make_shared<GraphPropertiesCache>();
+  }
+
   for (int iteration = 0; iteration < NumIterations(cfg_); ++iteration) {
     // Don't bother optimizing further if the graph is already tiny.
     if (optimized_graph->node_size() < min_graph_nodes) {
@@ -888,7 +899,8 @@ Status MetaOptimizer::OptimizeGraph(
                                    }) != optimization_result.results.end();
 
   // Record graph optimization result.
-  optimization_results_.push_back(optimization_result);
+  if (results == nullptr) results = &optimization_results_;
+  results->push_back(optimization_result);
 
   if (is_optimized) {
     TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
@@ -900,8 +912,9 @@ Status MetaOptimizer::OptimizeGraph(
   return absl::OkStatus();
 }
 
-Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
-                                    GraphDef* optimized_graph) {
+Status MetaOptimizer::OptimizeGraph(
+    Cluster* cluster, GrapplerItem&& item, GraphDef* optimized_graph,
+    std::vector<GraphOptimizationResult>* results) {
   std::vector<std::unique_ptr<GraphOptimizer>> optimizers;
   std::set<std::string> device_types;
   TF_RETURN_IF_ERROR(GetGraphDevice(item.graph, &device_types));
@@ -913,7 +926,42 @@ Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
   PrintUserAndPluginConfigs(device_types);
 
   return OptimizeGraph(std::move(optimizers), cluster, std::move(item),
-                       optimized_graph);
+                       optimized_graph, results);
+}
+
+Status MetaOptimizer::OptimizeFunctionBody(
+    Cluster* cluster, bool is_tpu_graph, const GrapplerFunctionItem& func_item,
+    GraphDef* optimized_func_graph,
+    std::vector<GraphOptimizationResult>* results) {
+  if (!is_tpu_graph) {
+    GrapplerFunctionItem func_item_copy = func_item;
+    return OptimizeGraph(cluster, std::move(func_item_copy),
+                         optimized_func_graph, results);
+  }
+
+  // Skip optimizing functions if this is a TPU graph. Currently, Grappler
+  // passes do not handle TPU functions correctly in a variety of ways
+  // (Note that due to the pre-placement TPU graph rewriting passes, the
+  // TPU-related ops are encapsulated away into functions). For example,
+  // TPU graphs contain TPUReplicateMetadata node that carries relevant
+  // TPU metadata and Grappler passes could prune that away. Grappler
+  // passes could also cause issues around shape inference. Since the
+  // desired and existing behavior is to not optimize TPU functions with
+  // Grappler, this check preserves that. The only exception is
+  // implementation selector what is required to swap in some TPU specific
+  // lowering code and is verified the work correctly on TPUs.
+  ImplementationSelector implementation_selector;
+
+  // Implementation selector needs to have access to valid function
+  // signature and attributes, and it doesn't need actual function body.
+  GrapplerFunctionItem func_item_copy = func_item;
+  std::unique_ptr<FunctionDefLibrary> func_item_function_library(
+      func_item_copy.graph.release_library());
+  *func_item_copy.graph.mutable_library() =
+      GetFunctionDefLibraryStub(*func_item_function_library);
+
+  return implementation_selector.Optimize(cluster, func_item_copy,
+                                          optimized_func_graph);
 }
 
 Status MetaOptimizer::RunOptimizer(
@@ -943,7 +991,9 @@ Status MetaOptimizer::RunOptimizer(
       {kGrapplerCategory, optimizer->name()});
   Status status =
       optimizer->Optimize(cluster, *optimized_item, optimized_graph);
-  auto duration_ms = timings.DurationMicroSec().value() / 1000.0f;
+  const int64_t duration_us =
+      static_cast<int64_t>(timings.DurationMicroSec().value());
+  auto duration_ms = duration_us / 1000.0f;
   timings.ReportAndStop();
 
   string message;
@@ -978,7 +1028,8 @@ Status MetaOptimizer::RunOptimizer(
         optimized_graph_function_library.release());
   }
 
-  OptimizerResult optimizer_result{optimizer->name(), message, status};
+  OptimizerResult optimizer_result{optimizer->name(), message, status,
+                                   duration_us};
   optimization_result->results.push_back(optimizer_result);
 
   if (!status.ok()) {
@@ -1079,6 +1130,19 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       "Deleted $0 unreachable functions from the graph (library size = $1)",
       old_library_size - new_library_size, new_library_size);
 
+  // Reuse the result of a previous optimization of the same item, if any.
+  std::string cache_key;
+  if (optimized_graph_cache_->enabled()) {
+    cache_key = OptimizedGraphCache::Key(item, config_proto_.graph_options(),
+                                         cluster);
+    if (std::optional<GraphDef> cached_graph =
+            optimized_graph_cache_->Lookup(cache_key)) {
+      VLOG(1) << "Using cached optimized graph for grappler item: " << item.id;
+      *optimized_graph = *std::move(cached_graph);
+      return absl::OkStatus();
+    }
+  }
+
   // Save a few small fields from item before we move it.
   bool optimize_function_library =
       item.optimization_options().optimize_function_library;
@@ -1166,9 +1230,48 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
 
   // Optimize each function only once.
   absl::flat_hash_set<string> optimized_funcs;
+
+  // Optimizes the functions in a pass over the library concurrently, if
+  // requested. Custom optimizers are not required to be thread-safe.
+  const int function_parallelism =
+      cfg_.custom_optimizers().empty()
+          ? cfg_.experimental_function_optimization_parallelism()
+          : 1;
+  std::unique_ptr<thread::ThreadPool> function_thread_pool;
+  if (function_parallelism > 1) {
+    function_thread_pool = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "meta_optimizer_functions", function_parallelism);
+  }
+
+  // Adds the result of optimizing the body of a function to `flib`.
+  const auto merge_optimized_function =
+      [&](const string& func_name, GrapplerFunctionItem& func_item,
+          GraphDef&& optimized_func_graph) -> Status {
+    // Function body optimization might have created new specialized
+    // functions for each instantiation context. Add them to the library.
+    for (const FunctionDef& func_def :
+         optimized_func_graph.library().function()) {
+      if (flib.Find(func_def.signature().name()) == nullptr) {
+        TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
+      }
+    }
+
+    // Convert optimized graph back to FunctionDef.
+    FunctionDef optimized_func;
+    func_item.SwapFunctionBody(std::move(optimized_func_graph));
+    TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, flib, &optimized_func));
+
+    // Replace optimized function with a new FunctionDef.
+    return flib.ReplaceFunction(func_name, optimized_func);
+  };
+
   while (optimize_function_library) {
     optimize_function_library = false;
 
+    // Functions to optimize concurrently in this pass, in library order.
+    std::vector<string> func_names;
+    std::vector<GrapplerFunctionItem> func_items;
+
     int function_idx = 0;
     for (const FunctionDef& func : optimized_graph->library().function()) {
       GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
@@ -1226,53 +1329,49 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       func_item.optimization_options().allow_pruning_stateful_and_dataset_ops =
           false;
 
+      if (function_thread_pool != nullptr) {
+        func_names.push_back(func_name);
+        func_items.push_back(std::move(func_item));
+        continue;
+      }
+
       // Optimize function body graph.
       GraphDef optimized_func_graph;
-      if (is_tpu_graph) {
-        // Skip optimizing functions if this is a TPU graph. Currently, Grappler
-        // passes do not handle TPU functions correctly in a variety of ways
-        // (Note that due to the pre-placement TPU graph rewriting passes, the
-        // TPU-related ops are encapsulated away into functions). For example,
-        // TPU graphs contain TPUReplicateMetadata node that carries relevant
-        // TPU metadata and Grappler passes could prune that away. Grappler
-        // passes could also cause issues around shape inference. Since the
-        // desired and existing behavior is to not optimize TPU functions with
-        // Grappler, this check preserves that. The only exception is
-        // implementation selector what is required to swap in some TPU specific
-        // lowering code and is verified the work correctly on TPUs.
-        ImplementationSelector implementation_selector;
-
-        // Implementation selector needs to have access to valid function
-        // signature and attributes, and it doesn't need actual function body.
-        std::unique_ptr<FunctionDefLibrary> func_item_function_library(
-            func_item.graph.release_library());
-        *func_item.graph.mutable_library() =
-            GetFunctionDefLibraryStub(*func_item_function_library);
-
-        TF_RETURN_IF_ERROR(implementation_selector.Optimize(
-            cluster, func_item, &optimized_func_graph));
-      } else {
-        GrapplerFunctionItem func_item_copy = func_item;
-        TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
-                                         &optimized_func_graph));
+      TF_RETURN_IF_ERROR(OptimizeFunctionBody(
+          cluster, is_tpu_graph, func_item, &optimized_func_graph,
+          /*results=*/nullptr));
+      TF_RETURN_IF_ERROR(merge_optimized_function(
+          func_name, func_item, std::move(optimized_func_graph)));
+    }
+
+    if (!func_items.empty()) {
+      // Every function of the pass is optimized against the library as of the
+      // start of the pass, and the results are merged in library order, so the
+      // outcome does not depend on scheduling.
+      const int num_funcs = func_items.size();
+      std::vector<GraphDef> optimized_func_graphs(num_funcs);
+      std::vector<std::vector<GraphOptimizationResult>> func_results(
+          num_funcs);
+      std::vector<Status> func_statuses(num_funcs);
+      BlockingCounter counter(num_funcs);
+      for (int i = 0; i < num_funcs; ++i) {
+        function_thread_pool->Schedule([&, i]() {
+          func_statuses[i] = OptimizeFunctionBody(
+              cluster, is_tpu_graph, func_items[i], &optimized_func_graphs[i],
+              &func_results[i]);
+          counter.DecrementCount();
+        });
       }
+      counter.Wait();
 
-      // Function body optimization might have created new specialized
-      // functions for each instantiation context. Add them to the library.
-      for (const FunctionDef& func_def :
-           optimized_func_graph.library().function()) {
-        if (flib.Find(func_def.signature().name()) == nullptr) {
-          TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
+      for (int i = 0; i < num_funcs; ++i) {
+        TF_RETURN_IF_ERROR(func_statuses[i]);
+        for (GraphOptimizationResult& result : func_results[i]) {
+          optimization_results_.push_back(std::move(result));
         }
+        TF_RETURN_IF_ERROR(merge_optimized_function(
+            func_names[i], func_items[i], std::move(optimized_func_graphs[i])));
       }
-
-      // Convert optimized graph back to FunctionDef.
-      FunctionDef optimized_func;
-      func_item.SwapFunctionBody(std::move(optimized_func_graph));
-      TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, flib, &optimized_func));
-
-      // Replace optimized function with a new FunctionDef.
-      TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
     }
 
     // If optimized at least one function, update the graph library.
@@ -1316,6 +1415,13 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
         *optimized_graph);
   }
 
+  if (!cache_key.empty()) {
+    Status s = optimized_graph_cache_->Insert(cache_key, *optimized_graph);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to cache optimized graph for grappler item "
+                   << item.id << ": " << s;
+    }
+  }
   return absl::OkStatus();
 }
 
@@ -1335,6 +1441,18 @@ string MetaOptimizer::GetResultString() const {
 
 void MetaOptimizer::PrintResult() { VLOG(1) << GetResultString(); }
 
+absl::flat_hash_map<string, absl::flat_hash_map<string, int64_t>>
+MetaOptimizer::GetOptimizerTimings() const {
+  absl::flat_hash_map<string, absl::flat_hash_map<string, int64_t>> timings;
+  for (const GraphOptimizationResult& graph_result : optimization_results_) {
+    auto& item_timings = timings[graph_result.id];
+    for (const OptimizerResult& result : graph_result.results) {
+      item_timings[result.optimizer_name] += result.duration_us;
+    }
+  }
+  return timings;
+}
+
 bool MetaOptimizerEnabled(const ConfigProto& cfg) {
   const auto& rewrite_cfg = cfg.graph_options().rewrite_options();
   if (rewrite_cfg.disable_meta_optimizer()) {
@@ -16,12 +16,19 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_H_
 #define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_H_
 
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/common_runtime/device_set.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils/functions.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/optimized_graph_cache.h"
 #include "tensorflow/core/grappler/verifiers/graph_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -54,6 +61,18 @@ class MetaOptimizer : public GraphOptimizer {
 
   void PrintResult();
 
+  // Returns the time in microseconds that each optimizer spent on each
+  // grappler item (the main graph and each optimized function) during the last
+  // optimization, keyed by item id and then by optimizer name.
+  absl::flat_hash_map<string, absl::flat_hash_map<string, int64_t>>
+  GetOptimizerTimings() const;
+
+  // Sets the cache of optimized graphs, which defaults to
+  // `OptimizedGraphCache::Global()`. `cache` must outlive this optimizer.
+  void set_optimized_graph_cache(OptimizedGraphCache* cache) {
+    optimized_graph_cache_ = cache;
+  }
+
  private:
   std::unique_ptr<GraphOptimizer> MakeNewOptimizer(
       const string& optimizer, const std::set<string>& device_types) const;
@@ -89,23 +108,11 @@ class MetaOptimizer : public GraphOptimizer {
 
   void PrintUserAndPluginConfigs(const std::set<string>& device_types) const;
 
-  // Run optimization pass over a single GrapplerItem. Meta optimizer might run
-  // multiple such passes: 1) for the main graph 2) for the function library
-  Status OptimizeGraph(
-      const std::vector<std::unique_ptr<GraphOptimizer>>& optimizers,
-      Cluster* cluster, GrapplerItem&& item, GraphDef* optimized_graph);
-  Status OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
-                       GraphDef* optimized_graph);
-
-  DeviceBase* const cpu_device_;  // may be NULL
-  ConfigProto config_proto_;
-  RewriterConfig& cfg_;
-  bool xla_auto_clustering_on_;
-
   struct OptimizerResult {
     string optimizer_name;
     string message;
     Status status;
+    int64_t duration_us = 0;
   };
 
   struct GraphOptimizationResult {
@@ -114,6 +121,31 @@ class MetaOptimizer : public GraphOptimizer {
     std::vector<OptimizerResult> results;
   };
 
+  // Run optimization pass over a single GrapplerItem. Meta optimizer might run
+  // multiple such passes: 1) for the main graph 2) for the function library.
+  // The result of the pass is appended to `results`, or to
+  // `optimization_results_` if `results` is null.
+  Status OptimizeGraph(
+      const std::vector<std::unique_ptr<GraphOptimizer>>& optimizers,
+      Cluster* cluster, GrapplerItem&& item, GraphDef* optimized_graph,
+      std::vector<GraphOptimizationResult>* results = nullptr);
+  Status OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
+                       GraphDef* optimized_graph,
+                       std::vector<GraphOptimizationResult>* results = nullptr);
+
+  // Optimizes the body of the function in `func_item`. Can be called
+  // concurrently for different functions.
+  Status OptimizeFunctionBody(Cluster* cluster, bool is_tpu_graph,
+                              const GrapplerFunctionItem& func_item,
+                              GraphDef* optimized_func_graph,
+                              std::vector<GraphOptimizationResult>* results);
+
+  DeviceBase* const cpu_device_;  // may be NULL
+  ConfigProto config_proto_;
+  RewriterConfig& cfg_;
+  bool xla_auto_clustering_on_;
+  OptimizedGraphCache* optimized_graph_cache_;
+
   Status RunOptimizer(GraphOptimizer* optimizer, Cluster* cluster,
                       GrapplerItem* optimized_item, GraphDef* optimized_graph,
                       GraphOptimizationResult* optimization_result);
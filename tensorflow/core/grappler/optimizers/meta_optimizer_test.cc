@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/inputs/trivial_test_graph_input_yielder.h"
 #include "tensorflow/core/grappler/optimizers/custom_graph_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/optimized_graph_cache.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -150,6 +151,40 @@ TEST_F(MetaOptimizerTest, RunsCustomOptimizer) {
   EXPECT_TRUE(TestOptimizer::IsOptimized());
 }
 
+TEST_F(MetaOptimizerTest, ReusesCachedOptimizedGraph) {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
+  GrapplerItem item;
+  ASSERT_TRUE(fake_input.NextItem(&item));
+
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("TestOptimizer");
+  rewriter_config.set_min_graph_nodes(-1);
+
+  OptimizedGraphCache::Config cache_config;
+  cache_config.in_process_capacity_bytes = 1 << 20;
+  OptimizedGraphCache cache(cache_config);
+
+  TestOptimizer::SetOptimized(false);
+  MetaOptimizer optimizer(nullptr, config_proto);
+  optimizer.set_optimized_graph_cache(&cache);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(TestOptimizer::IsOptimized());
+  EXPECT_EQ(cache.num_misses(), 1);
+
+  // The second optimization of the same item does not run the passes.
+  TestOptimizer::SetOptimized(false);
+  MetaOptimizer second_optimizer(nullptr, config_proto);
+  second_optimizer.set_optimized_graph_cache(&cache);
+  GraphDef cached_output;
+  TF_EXPECT_OK(second_optimizer.Optimize(nullptr, item, &cached_output));
+  EXPECT_FALSE(TestOptimizer::IsOptimized());
+  EXPECT_EQ(cache.num_hits(), 1);
+  CompareGraphs(output, cached_output);
+}
+
 TEST_F(MetaOptimizerTest, RunsCustomOptimizerWithParams) {
   TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
   GrapplerItem item;
@@ -420,6 +455,87 @@ TEST_F(MetaOptimizerTest, OptimizeFunctionLibrary) {
   test::ExpectTensorEqual<int>(tensors_expected[1], tensors[1]);
 }
 
+TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryInParallel) {
+  using test::function::NDef;
+
+  //   MyMul(x, y)    = x * y
+  //  *MySquare(x)    = MyMul(x, x)
+  //  *MyQuadratic(x) = MySquare(MySquare(x))
+  //
+  //  * - marked as noinline
+  FunctionDef mul_func = FunctionDefHelper::Create(
+      "MyMul", {"x:T", "y:T"}, {"z:T"}, {"T: {float, double}"},
+      {{{"mul"}, "Mul", {"x", "y"}, {{"T", "$T"}}}},
+      /*ret_def=*/
+      {{"z", "mul:z:0"}});
+
+  FunctionDef square_func = FunctionDefHelper::Create(
+      "MySquare", {"x:T"}, {"z:T"}, {"T: {float, double}"},
+      {{{"my_mul"}, "MyMul", {"x", "x"}, {{"T", "$T"}}}},
+      /*ret_def=*/
+      {{"z", "my_mul:z:0"}});
+  (*square_func.mutable_attr())["_noinline"].set_b(true);
+
+  FunctionDef quadratic_func = FunctionDefHelper::Create(
+      "MyQuadratic", {"x:T"}, {"z:T"}, {"T: {float, double}"},
+      {{{"square"}, "MySquare", {"x"}, {{"T", "$T"}}},
+       {{"quadratic"}, "MySquare", {"square:z"}, {{"T", "$T"}}}},
+      /*ret_def=*/
+      {{"z", "quadratic:z:0"}});
+  (*quadratic_func.mutable_attr())["_noinline"].set_b(true);
+
+  GrapplerItem item;
+  item.id = "tf_graph";
+  item.graph = test::function::GDef(
+      {NDef("a", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+       NDef("b", "Placeholder", {}, {{"dtype", DT_INT32}}, kDevice),
+       NDef("square", "MySquare", {"a"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("quadratic", "MyQuadratic", {"b"}, {{"T", DT_INT32}}, kDevice),
+       NDef("out_s", "Identity", {"square:0"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("out_q", "Identity", {"quadratic:0"}, {{"T", DT_INT32}}, kDevice)},
+      /*funcs=*/
+      {mul_func, square_func, quadratic_func});
+
+  const auto optimize = [&](int function_parallelism, GraphDef* output) {
+    ConfigProto config_proto;
+    auto& rewriter_config =
+        *config_proto.mutable_graph_options()->mutable_rewrite_options();
+    rewriter_config.set_meta_optimizer_iterations(RewriterConfig::TWO);
+    rewriter_config.set_function_optimization(RewriterConfig::ON);
+    rewriter_config.add_optimizers("function");
+    rewriter_config.set_min_graph_nodes(-1);
+    rewriter_config.set_experimental_function_optimization_parallelism(
+        function_parallelism);
+    MetaOptimizer optimizer(nullptr, config_proto);
+    TF_EXPECT_OK(optimizer.Optimize(nullptr, item, output));
+    return optimizer.GetOptimizerTimings();
+  };
+
+  GraphDef serial_output;
+  optimize(/*function_parallelism=*/1, &serial_output);
+  GraphDef parallel_output;
+  const auto timings = optimize(/*function_parallelism=*/4, &parallel_output);
+
+  // The pipeline has no functions that depend on the optimization of
+  // functions in the same pass, so both modes produce the same graph.
+  CompareGraphs(serial_output, parallel_output);
+  FunctionLibraryDefinition parallel_flib(OpRegistry::Global(),
+                                          parallel_output.library());
+  EXPECT_EQ(parallel_flib.num_functions(),
+            serial_output.library().function_size());
+  for (const FunctionDef& func : serial_output.library().function()) {
+    const FunctionDef* parallel_func =
+        parallel_flib.Find(func.signature().name());
+    ASSERT_NE(parallel_func, nullptr);
+    CompareFunctions(func, *parallel_func);
+  }
+
+  // Timings are reported for the main graph and each optimized function.
+  EXPECT_TRUE(timings.contains("tf_graph"));
+  EXPECT_TRUE(timings.contains(absl::Substitute(
+      "$0_specialized_for_$1_at_$2", "MySquare", "square", "tf_graph")));
+}
+
 TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryPruneUnusedOutputs) {
   using test::function::NDef;
 
@@ -0,0 +1,246 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/optimized_graph_cache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
+#include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kFileSuffix[] = ".pb";
+
+// Appends a length-prefixed `value` to `signature`, so that different sequences
+// of values never produce the same signature.
+void AppendField(absl::string_view value, std::string* signature) {
+  absl::StrAppend(signature, value.size(), ":", value);
+}
+
+void AppendSortedFields(std::vector<std::string> values,
+                        std::string* signature) {
+  std::sort(values.begin(), values.end());
+  AppendField(absl::StrCat(values.size()), signature);
+  for (const std::string& value : values) {
+    AppendField(value, signature);
+  }
+}
+
+bool AppendProto(const protobuf::MessageLite& proto, std::string* signature) {
+  std::string serialized;
+  if (!SerializeToStringDeterministic(proto, &serialized)) return false;
+  AppendField(serialized, signature);
+  return true;
+}
+
+}  // namespace
+
+OptimizedGraphCache::OptimizedGraphCache(const Config& config)
+    : config_(config) {}
+
+/* static */ OptimizedGraphCache* OptimizedGraphCache::Global() {
+  static OptimizedGraphCache* cache = [] {
+    Config config;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_GRAPPLER_CACHE_BYTES",
+                                    /*default_val=*/0,
+                                    &config.in_process_capacity_bytes));
+    TF_CHECK_OK(ReadStringFromEnvVar("TF_GRAPPLER_CACHE_DIR",
+                                     /*default_val=*/"",
+                                     &config.persistent_cache_directory));
+    TF_CHECK_OK(
+        ReadBoolFromEnvVar("TF_GRAPPLER_CACHE_DIR_READ_ONLY",
+                           /*default_val=*/false,
+                           &config.persistent_cache_directory_read_only));
+    return new OptimizedGraphCache(config);
+  }();
+  return cache;
+}
+
+/* static */ std::string OptimizedGraphCache::Key(
+    const GrapplerItem& item, const GraphOptions& graph_options,
+    const Cluster* cluster) {
+  std::string signature;
+  AppendField(TF_VERSION_STRING, &signature);
+  AppendField(absl::StrCat(TF_GRAPH_DEF_VERSION), &signature);
+  if (!AppendProto(item.graph, &signature) ||
+      !AppendProto(graph_options, &signature)) {
+    return "";
+  }
+
+  std::vector<std::string> feeds;
+  for (const auto& [name, tensor] : item.feed) {
+    feeds.push_back(absl::StrCat(name, ":", DataTypeString(tensor.dtype()), ":",
+                                 tensor.shape().DebugString()));
+  }
+  AppendSortedFields(std::move(feeds), &signature);
+  AppendSortedFields(item.fetch, &signature);
+  AppendSortedFields(item.init_ops, &signature);
+  AppendSortedFields(item.keep_ops, &signature);
+  AppendField(item.save_op, &signature);
+  AppendField(item.restore_op, &signature);
+  AppendField(item.save_restore_loc_tensor, &signature);
+
+  const GrapplerItem::OptimizationOptions& options =
+      item.optimization_options();
+  AppendField(absl::StrCat(options.allow_non_differentiable_rewrites,
+                           options.allow_pruning_stateful_and_dataset_ops,
+                           options.optimize_function_library,
+                           options.is_eager_mode, ":",
+                           options.intra_op_parallelism_threads),
+              &signature);
+
+  AppendSortedFields(
+      std::vector<std::string>(item.devices().begin(), item.devices().end()),
+      &signature);
+  if (cluster != nullptr) {
+    std::vector<std::string> devices;
+    for (const auto& [name, properties] : cluster->GetDevices()) {
+      std::string serialized;
+      if (!SerializeToStringDeterministic(properties, &serialized)) return "";
+      devices.push_back(absl::StrCat(name, ":", serialized));
+    }
+    AppendSortedFields(std::move(devices), &signature);
+  }
+
+  const Fprint128 fingerprint = Fingerprint128(signature);
+  return absl::StrFormat("%016x%016x", fingerprint.high64, fingerprint.low64);
+}
+
+std::optional<GraphDef> OptimizedGraphCache::Lookup(const std::string& key) {
+  if (key.empty() || !enabled()) return std::nullopt;
+  {
+    mutex_lock l(mu_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      lru_.splice(lru_.begin(), lru_, it->second.lru_position);
+      ++num_hits_;
+      return it->second.graph;
+    }
+  }
+
+  std::optional<GraphDef> graph = ReadFromDirectory(key);
+  mutex_lock l(mu_);
+  if (!graph.has_value()) {
+    ++num_misses_;
+    return std::nullopt;
+  }
+  ++num_hits_;
+  InsertInProcess(key, *graph);
+  return graph;
+}
+
+Status OptimizedGraphCache::Insert(const std::string& key,
+                                   const GraphDef& optimized_graph) {
+  if (key.empty()) return absl::OkStatus();
+  {
+    mutex_lock l(mu_);
+    InsertInProcess(key, optimized_graph);
+  }
+  if (config_.persistent_cache_directory.empty() ||
+      config_.persistent_cache_directory_read_only) {
+    return absl::OkStatus();
+  }
+  return WriteToDirectory(key, optimized_graph);
+}
+
+int64_t OptimizedGraphCache::num_hits() const {
+  mutex_lock l(mu_);
+  return num_hits_;
+}
+
+int64_t OptimizedGraphCache::num_misses() const {
+  mutex_lock l(mu_);
+  return num_misses_;
+}
+
+void OptimizedGraphCache::InsertInProcess(const std::string& key,
+                                          const GraphDef& graph) {
+  const int64_t size_bytes = graph.ByteSizeLong();
+  if (size_bytes > config_.in_process_capacity_bytes) return;
+  if (entries_.contains(key)) return;
+  while (size_bytes_ + size_bytes > config_.in_process_capacity_bytes) {
+    auto it = entries_.find(lru_.back());
+    size_bytes_ -= it->second.size_bytes;
+    entries_.erase(it);
+    lru_.pop_back();
+  }
+  lru_.push_front(key);
+  Entry& entry = entries_[key];
+  entry.graph = graph;
+  entry.size_bytes = size_bytes;
+  entry.lru_position = lru_.begin();
+  size_bytes_ += size_bytes;
+}
+
+std::string OptimizedGraphCache::GetFilePath(const std::string& key) const {
+  return io::JoinPath(config_.persistent_cache_directory,
+                      absl::StrCat(key, kFileSuffix));
+}
+
+std::optional<GraphDef> OptimizedGraphCache::ReadFromDirectory(
+    const std::string& key) const {
+  if (config_.persistent_cache_directory.empty()) return std::nullopt;
+  Env* env = Env::Default();
+  const std::string file_path = GetFilePath(key);
+  if (!env->FileExists(file_path).ok()) return std::nullopt;
+  GraphDef graph;
+  Status s = ReadBinaryProto(env, file_path, &graph);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to read optimized graph from " << file_path << ": "
+                 << s;
+    return std::nullopt;
+  }
+  VLOG(1) << "Loaded optimized graph from " << file_path;
+  return graph;
+}
+
+Status OptimizedGraphCache::WriteToDirectory(const std::string& key,
+                                             const GraphDef& graph) const {
+  Env* env = Env::Default();
+  const std::string& directory = config_.persistent_cache_directory;
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(directory));
+
+  // Write to a temporary file, then move it into place, so that concurrent
+  // readers never see a partially written entry.
+  std::string temp_path = io::JoinPath(directory, key);
+  if (!env->CreateUniqueFileName(&temp_path, ".pb.tmp")) {
+    return absl::UnavailableError(
+        absl::StrCat("Could not create a unique file inside ", directory));
+  }
+  TF_RETURN_IF_ERROR(WriteBinaryProto(env, temp_path, graph));
+  return env->RenameFile(temp_path, GetFilePath(key));
+}
+
+}  // namespace grappler
+}  // namespace tensorflow
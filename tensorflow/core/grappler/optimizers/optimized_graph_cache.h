@@ -0,0 +1,129 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_OPTIMIZED_GRAPH_CACHE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_OPTIMIZED_GRAPH_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Caches the graphs produced by the meta optimizer, so that optimizing the
+// same graph again (e.g. when the same SavedModel is loaded by many replicas
+// or in many sessions) returns the previous result instead of re-running all
+// the passes.
+//
+// Entries are keyed by `OptimizedGraphCache::Key`, a fingerprint of everything
+// the optimization result depends on. Entries are kept in memory, up to
+// `in_process_capacity_bytes` of serialized graphs, and, if
+// `persistent_cache_directory` is set, in files in that directory, each named
+// after its key. As with `DeviceExecutablePersistor`, files are written to a
+// temporary path and moved into place, so concurrent writers and readers only
+// see complete entries. This class is thread-safe.
+class OptimizedGraphCache {
+ public:
+  struct Config {
+    // Maximum total size of the serialized graphs kept in memory. Zero
+    // disables the in-process cache.
+    int64_t in_process_capacity_bytes = 0;
+
+    // If non-empty, optimized graphs are saved to and loaded from the
+    // specified file system directory path.
+    std::string persistent_cache_directory;
+
+    // Cache directory is read-only if set to true.
+    bool persistent_cache_directory_read_only = false;
+  };
+
+  explicit OptimizedGraphCache(const Config& config);
+
+  // Returns the process-wide cache used by the meta optimizer. It is configured
+  // by the `TF_GRAPPLER_CACHE_BYTES`, `TF_GRAPPLER_CACHE_DIR` and
+  // `TF_GRAPPLER_CACHE_DIR_READ_ONLY` environment variables.
+  static OptimizedGraphCache* Global();
+
+  // Returns the key of the result of optimizing `item` with `graph_options` on
+  // `cluster`, which may be null. The key covers the graph and its function
+  // library, the feeds, fetches and nodes to preserve, the optimization
+  // options, the devices, the rewriter and optimizer configs and the
+  // TensorFlow version. Custom and plugin optimizers are only identified by
+  // their configuration. Returns an empty key, which is never cached, if
+  // `item` or `graph_options` cannot be serialized.
+  static std::string Key(const GrapplerItem& item,
+                         const GraphOptions& graph_options,
+                         const Cluster* cluster);
+
+  // Returns whether lookups can return entries.
+  bool enabled() const {
+    return config_.in_process_capacity_bytes > 0 ||
+           !config_.persistent_cache_directory.empty();
+  }
+
+  // Returns the optimized graph cached under `key`, or std::nullopt if there
+  // is none. Entries found on disk are added to the in-process cache.
+  std::optional<GraphDef> Lookup(const std::string& key) TF_LOCKS_EXCLUDED(mu_);
+
+  // Caches `optimized_graph` under `key`, evicting the least recently used
+  // in-process entries to stay within capacity.
+  Status Insert(const std::string& key, const GraphDef& optimized_graph)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  int64_t num_hits() const TF_LOCKS_EXCLUDED(mu_);
+  int64_t num_misses() const TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct Entry {
+    GraphDef graph;
+    int64_t size_bytes = 0;
+    std::list<std::string>::iterator lru_position;
+  };
+
+  void InsertInProcess(const std::string& key, const GraphDef& graph)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  std::string GetFilePath(const std::string& key) const;
+  std::optional<GraphDef> ReadFromDirectory(const std::string& key) const;
+  Status WriteToDirectory(const std::string& key, const GraphDef& graph) const;
+
+  const Config config_;
+
+  mutable mutex mu_;
+  absl::flat_hash_map<std::string, Entry> entries_ TF_GUARDED_BY(mu_);
+  // Keys of `entries_`, most recently used first.
+  std::list<std::string> lru_ TF_GUARDED_BY(mu_);
+  int64_t size_bytes_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_hits_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_misses_ TF_GUARDED_BY(mu_) = 0;
+
+  OptimizedGraphCache(const OptimizedGraphCache&) = delete;
+  void operator=(const OptimizedGraphCache&) = delete;
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_OPTIMIZED_GRAPH_CACHE_H_
@@ -0,0 +1,182 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/optimized_graph_cache.h"
+
+#include <optional>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using test::function::NDef;
+
+GrapplerItem MakeItem(const string& op) {
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("a", "Const", {}, {{"dtype", DT_FLOAT}}),
+       NDef("b", op, {"a"}, {{"T", DT_FLOAT}})});
+  item.fetch = {"b"};
+  return item;
+}
+
+GraphDef MakeGraph(int num_nodes) {
+  GraphDef graph;
+  for (int i = 0; i < num_nodes; ++i) {
+    *graph.add_node() =
+        NDef(absl::StrCat("node_", i), "Const", {}, {{"dtype", DT_FLOAT}});
+  }
+  return graph;
+}
+
+OptimizedGraphCache::Config InProcessConfig(int64_t capacity_bytes) {
+  OptimizedGraphCache::Config config;
+  config.in_process_capacity_bytes = capacity_bytes;
+  return config;
+}
+
+TEST(OptimizedGraphCacheTest, KeyIsDeterministic) {
+  GraphOptions graph_options;
+  EXPECT_EQ(OptimizedGraphCache::Key(MakeItem("Relu"), graph_options, nullptr),
+            OptimizedGraphCache::Key(MakeItem("Relu"), graph_options, nullptr));
+  EXPECT_FALSE(
+      OptimizedGraphCache::Key(MakeItem("Relu"), graph_options, nullptr)
+          .empty());
+}
+
+TEST(OptimizedGraphCacheTest, KeyDependsOnInputs) {
+  GraphOptions graph_options;
+  const GrapplerItem item = MakeItem("Relu");
+  const std::string key =
+      OptimizedGraphCache::Key(item, graph_options, nullptr);
+
+  EXPECT_NE(key,
+            OptimizedGraphCache::Key(MakeItem("Tanh"), graph_options, nullptr));
+
+  GrapplerItem other_fetch = item;
+  other_fetch.fetch = {"a"};
+  EXPECT_NE(key,
+            OptimizedGraphCache::Key(other_fetch, graph_options, nullptr));
+
+  GrapplerItem other_devices = item;
+  TF_ASSERT_OK(
+      other_devices.AddDevice("/job:localhost/replica:0/task:0/CPU:0"));
+  EXPECT_NE(key,
+            OptimizedGraphCache::Key(other_devices, graph_options, nullptr));
+
+  GrapplerItem other_options = item;
+  other_options.optimization_options().allow_non_differentiable_rewrites =
+      false;
+  EXPECT_NE(key,
+            OptimizedGraphCache::Key(other_options, graph_options, nullptr));
+
+  GraphOptions other_graph_options;
+  other_graph_options.mutable_rewrite_options()->set_constant_folding(
+      RewriterConfig::OFF);
+  EXPECT_NE(key,
+            OptimizedGraphCache::Key(item, other_graph_options, nullptr));
+}
+
+TEST(OptimizedGraphCacheTest, Disabled) {
+  OptimizedGraphCache cache(OptimizedGraphCache::Config{});
+  EXPECT_FALSE(cache.enabled());
+  TF_ASSERT_OK(cache.Insert("key", MakeGraph(1)));
+  EXPECT_FALSE(cache.Lookup("key").has_value());
+}
+
+TEST(OptimizedGraphCacheTest, InProcess) {
+  OptimizedGraphCache cache(InProcessConfig(1 << 20));
+  EXPECT_TRUE(cache.enabled());
+  EXPECT_FALSE(cache.Lookup("key").has_value());
+  EXPECT_EQ(cache.num_misses(), 1);
+
+  const GraphDef graph = MakeGraph(2);
+  TF_ASSERT_OK(cache.Insert("key", graph));
+  std::optional<GraphDef> cached_graph = cache.Lookup("key");
+  ASSERT_TRUE(cached_graph.has_value());
+  EXPECT_EQ(cached_graph->SerializeAsString(), graph.SerializeAsString());
+  EXPECT_EQ(cache.num_hits(), 1);
+}
+
+TEST(OptimizedGraphCacheTest, EvictsLeastRecentlyUsed) {
+  const GraphDef graph = MakeGraph(10);
+  OptimizedGraphCache cache(InProcessConfig(2 * graph.ByteSizeLong()));
+  TF_ASSERT_OK(cache.Insert("a", graph));
+  TF_ASSERT_OK(cache.Insert("b", graph));
+  EXPECT_TRUE(cache.Lookup("a").has_value());
+
+  // "b" is now the least recently used entry.
+  TF_ASSERT_OK(cache.Insert("c", graph));
+  EXPECT_TRUE(cache.Lookup("a").has_value());
+  EXPECT_FALSE(cache.Lookup("b").has_value());
+  EXPECT_TRUE(cache.Lookup("c").has_value());
+}
+
+TEST(OptimizedGraphCacheTest, SkipsGraphsLargerThanCapacity) {
+  const GraphDef graph = MakeGraph(10);
+  OptimizedGraphCache cache(InProcessConfig(graph.ByteSizeLong() - 1));
+  TF_ASSERT_OK(cache.Insert("key", graph));
+  EXPECT_FALSE(cache.Lookup("key").has_value());
+}
+
+TEST(OptimizedGraphCacheTest, PersistentDirectory) {
+  OptimizedGraphCache::Config config;
+  config.persistent_cache_directory =
+      io::JoinPath(testing::TmpDir(), "optimized_graph_cache_persistent");
+  const GraphDef graph = MakeGraph(3);
+  {
+    OptimizedGraphCache cache(config);
+    TF_ASSERT_OK(cache.Insert("key", graph));
+  }
+
+  // A new cache, e.g. in another process, finds the graph on disk.
+  OptimizedGraphCache cache(config);
+  std::optional<GraphDef> cached_graph = cache.Lookup("key");
+  ASSERT_TRUE(cached_graph.has_value());
+  EXPECT_EQ(cached_graph->SerializeAsString(), graph.SerializeAsString());
+  EXPECT_FALSE(cache.Lookup("other_key").has_value());
+}
+
+TEST(OptimizedGraphCacheTest, ReadOnlyPersistentDirectory) {
+  OptimizedGraphCache::Config config;
+  config.persistent_cache_directory =
+      io::JoinPath(testing::TmpDir(), "optimized_graph_cache_read_only");
+  config.persistent_cache_directory_read_only = true;
+  {
+    OptimizedGraphCache cache(config);
+    TF_ASSERT_OK(cache.Insert("key", MakeGraph(3)));
+  }
+  EXPECT_FALSE(Env::Default()
+                   ->FileExists(io::JoinPath(
+                       config.persistent_cache_directory, "key.pb"))
+                   .ok());
+  OptimizedGraphCache cache(config);
+  EXPECT_FALSE(cache.Lookup("key").has_value());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
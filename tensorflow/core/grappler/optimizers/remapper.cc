@@ -24,6 +24,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/versions.pb.h"
@@ -82,6 +83,20 @@ namespace grappler {
 //
 // _FusedConv2D/_FusedConv3D + <Activation> -> _FusedConv2D/_FusedConv3D
 // Supported Activations: LeakyRelu, Mish
+//
+// ConcatV2 of embedding lookups -> _FusedSparseSegmentReduceConcat
+//   ConcatV2(SparseSegment{Sum,Mean}(<GatherV2>(params), indices, segment_ids),
+//            ..., axis=1)  // This fusion only works on CPU.
+//
+// RaggedGather + RaggedTensorToTensor -> _FusedRaggedGatherToTensor
+//   // This fusion only works on CPU, for one ragged dimension.
+//
+// Independent MatMul + <BiasAdd> with the same shapes -> BatchMatMulV2
+//   Unpack(BatchMatMulV2(Pack(a), Pack(b)) + <Pack(bias)>)
+//   // This fusion is opt-in, see HorizontalMatMulFusionEnabled().
+//
+// ResourceApplyAdams sharing hyperparameters -> _ResourceApplyAdamMulti
+//   // The replaced ops become NoOps that depend on the fused op.
 
 namespace {
 
@@ -92,6 +107,13 @@ constexpr char kFusedDepthwiseConv2dNative[] = "_FusedDepthwiseConv2dNative";
 constexpr char kFusedBatchNormEx[] = "_FusedBatchNormEx";
 constexpr char kFusedBatchNormGradEx[] = "_FusedBatchNormGradEx";
 constexpr char kTensorToHashBucket[] = "_TensorToHashBucketFast";
+constexpr char kFusedSparseSegmentReduceConcat[] =
+    "_FusedSparseSegmentReduceConcat";
+constexpr char kFusedRaggedGatherToTensor[] = "_FusedRaggedGatherToTensor";
+
+// Largest MatMul, in multiply-adds, that is fused horizontally. Above this
+// size a single MatMul keeps the device busy on its own.
+constexpr int64_t kMaxHorizontalMatMulSize = 1 << 20;
 constexpr char kLeakyRelu[] = "LeakyRelu";
 constexpr char kMklFusedMish[] = "_MklFusedMish";
 constexpr char kRelu[] = "Relu";
@@ -170,6 +192,40 @@ struct TensorToHashBucket {
   int string_to_hash_bucket = kMissingIndex;
 };
 
+// ConcatV2 of SparseSegmentSum/SparseSegmentMean ops that can be replaced with
+// a _FusedSparseSegmentReduceConcat. The data of a segment reduction can be
+// gathered from embedding tables by a GatherV2.
+struct SparseSegmentReduceConcat {
+  SparseSegmentReduceConcat() = default;
+
+  int concat = kMissingIndex;
+  std::vector<int> segment_reductions;
+  // The GatherV2 feeding each segment reduction, or kMissingIndex.
+  std::vector<int> gathers;
+};
+
+// MatMul with an optional BiasAdd that can be computed in one BatchMatMulV2
+// together with other independent MatMuls of the same shapes.
+struct HorizontalMatMul {
+  HorizontalMatMul() = default;
+  HorizontalMatMul(int matmul, int bias_add)
+      : matmul(matmul), bias_add(bias_add) {}
+
+  int matmul = kMissingIndex;
+  int bias_add = kMissingIndex;
+};
+
+// RaggedTensorToTensor of the rows gathered by a RaggedGather, that can be
+// replaced with a _FusedRaggedGatherToTensor.
+struct RaggedGatherToTensor {
+  RaggedGatherToTensor() = default;
+  RaggedGatherToTensor(int ragged_gather, int to_tensor)
+      : ragged_gather(ragged_gather), to_tensor(to_tensor) {}
+
+  int ragged_gather = kMissingIndex;
+  int to_tensor = kMissingIndex;
+};
+
 // Pad followed by Conv3D/FusedConv3D
 struct PadWithConv3D {
   PadWithConv3D() = default;
@@ -388,6 +444,34 @@ bool BlasLtMatmulEnabled() {
   return is_enabled;
 }
 
+// Horizontal MatMul fusion trades the launches of small MatMuls for the copies
+// into and out of a batch, which does not pay off for every model, so it is
+// enabled with TF_REMAPPER_HORIZONTAL_MATMUL_FUSION=1.
+bool HorizontalMatMulFusionEnabled() {
+  static bool is_enabled = [] {
+    bool is_enabled = false;
+    TF_CHECK_OK(tensorflow::ReadBoolFromEnvVar(
+        "TF_REMAPPER_HORIZONTAL_MATMUL_FUSION", /*default_val=*/false,
+        &is_enabled));
+    return is_enabled;
+  }();
+  return is_enabled;
+}
+
+// Grouping the ResourceApplyAdam ops of a model into _ResourceApplyAdamMulti
+// ops is enabled by default, and can be disabled with
+// TF_REMAPPER_MULTI_TENSOR_APPLY_FUSION=0.
+bool MultiTensorApplyFusionEnabled() {
+  static bool is_enabled = [] {
+    bool is_enabled = true;
+    TF_CHECK_OK(tensorflow::ReadBoolFromEnvVar(
+        "TF_REMAPPER_MULTI_TENSOR_APPLY_FUSION", /*default_val=*/true,
+        &is_enabled));
+    return is_enabled;
+  }();
+  return is_enabled;
+}
+
 bool IsGpuCompatibleDataFormat(const RemapperContext& ctx,
                                const NodeDef* conv2d) {
   DCHECK(IsConv2D(*conv2d)) << "Expected Conv2D op";
@@ -2096,16 +2180,38 @@ bool IsCommonNormPattern(RemapperContext* ctx, int node_index,
   return found_op_type_match;
 }
 
+// Reads the value of a Const node holding a single float, bfloat16 or half.
+bool GetScalarConstAsFloat(const NodeDef& node, float* value) {
+  if (!IsConstant(node) || !node.attr().count("value")) return false;
+  Tensor tensor;
+  if (!tensor.FromProto(node.attr().at("value").tensor()) ||
+      tensor.NumElements() != 1) {
+    return false;
+  }
+  switch (tensor.dtype()) {
+    case DT_FLOAT:
+      *value = tensor.flat<float>()(0);
+      return true;
+    case DT_BFLOAT16:
+      *value = static_cast<float>(tensor.flat<bfloat16>()(0));
+      return true;
+    case DT_HALF:
+      *value = static_cast<float>(tensor.flat<Eigen::half>()(0));
+      return true;
+    default:
+      return false;
+  }
+}
+
 // Keras LayerNormalization api uses multiple TensorFlow ops. Current fusion
 // pattern is only for the case, when LayerNormalization uses FusedBatcNormV3.
 // We further restrict it to only 2D or 3D tensor inputs to keras
-// LayerNormalization api.
-bool FindMklLayerNorm(RemapperContext* ctx, int node_index,
-                      std::map<string, int>* matched_nodes_map,
-                      std::set<int>* remove_node_indices,
-                      std::vector<string>* input_node_names, float* epsilon) {
-  if (!IsMKLEnabled()) return false;
-
+// LayerNormalization api. The matched ops are fused into _MklLayerNorm with
+// oneDNN and into _FusedLayerNorm otherwise.
+bool FindLayerNorm(RemapperContext* ctx, int node_index,
+                   std::map<string, int>* matched_nodes_map,
+                   std::set<int>* remove_node_indices,
+                   std::vector<string>* input_node_names, float* epsilon) {
   // The following pattern will be searched in the graph with additional
   // contraints. Here * means any type of op.
   // clang-format off
@@ -2284,6 +2390,10 @@ bool FindMklLayerNorm(RemapperContext* ctx, int node_index,
         if (static_cast<int64>(rank - 1) != mean_axis_tensor.flat<int64>()(0))
           return false;
       }
+      // The epsilon is the constant added to the variance.
+      NodeDef* epsilon_node =
+          ctx->graph_view.GetNode(matched_nodes_map->at("epsilon"))->node();
+      if (!GetScalarConstAsFloat(*epsilon_node, epsilon)) return false;
       auto* gamma_node =
           ctx->graph_view.GetNode(matched_nodes_map->at("gamma"))->node();
       auto* beta_node =
@@ -2316,6 +2426,186 @@ bool FindMklLayerNorm(RemapperContext* ctx, int node_index,
   return found_op_type_match;
 }
 
+// Checks that a layer normalization found by FindLayerNorm can run as
+// _FusedLayerNorm on CPU: the normalization is over the last dimension, which
+// only the custom pattern checks, and gamma and beta are vectors as long as
+// that dimension.
+bool IsCpuCompatibleLayerNorm(const RemapperContext& ctx,
+                              const std::map<string, int>& matched_nodes_map) {
+  if (ctx.xla_cpu_jit_disable_fusion) return false;
+  if (matched_nodes_map.count("fused_batch_norm")) return false;
+  const NodeDef* output_node =
+      ctx.graph_view.GetNode(matched_nodes_map.at("output"))->node();
+  if (!NodeIsOnCpu(output_node)) return false;
+  const DataType dtype = GetDataTypeFromAttr(*output_node, "T");
+  if (dtype != DT_FLOAT && dtype != DT_BFLOAT16 && dtype != DT_HALF) {
+    return false;
+  }
+
+  auto output_shape = [&](const string& key) {
+    const NodeDef* node =
+        ctx.graph_view.GetNode(matched_nodes_map.at(key))->node();
+    const auto& props = ctx.graph_properties.GetOutputProperties(node->name());
+    return props.empty() ? TensorShapeProto() : props[0].shape();
+  };
+  const TensorShapeProto input_shape = output_shape("input");
+  if (input_shape.unknown_rank() || input_shape.dim_size() == 0) return false;
+  const int64_t depth = input_shape.dim(input_shape.dim_size() - 1).size();
+  if (depth < 0) return false;
+  for (const char* key : {"gamma", "beta"}) {
+    const TensorShapeProto shape = output_shape(key);
+    if (shape.unknown_rank() || shape.dim_size() != 1 ||
+        shape.dim(0).size() != depth) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Finds the scaled dot-product attention of transformer models,
+// softmax(scale * Q * K^T) * V, which _FusedScaledDotProductAttention computes
+// on CPU without materializing the attention scores.
+bool FindScaledDotProductAttention(RemapperContext* ctx, int node_index,
+                                   std::map<string, int>* matched_nodes_map,
+                                   std::set<int>* remove_node_indices,
+                                   float* scale) {
+  // clang-format off
+  //          Subgraph for fusion
+  //          -------------------
+  //
+  //     *(query)  *(key)
+  //          \     /
+  //        BatchMatMul(qk)   Const                      FusedOp
+  //              \           /                          -------
+  //               Mul|RealDiv  (optional)
+  //                   |                     *(query) *(key) *(value)
+  //                Softmax                       \     |     /
+  //                    \   *(value)       _FusedScaledDotProductAttention
+  //                     \  /
+  //                BatchMatMul(output)
+  // clang-format on
+  using utils::MatchingDirection;
+  using utils::NodeStatus;
+  // clang-format off
+  utils::OpTypePattern scaled_attention_pattern =
+    {"BatchMatMul|BatchMatMulV2", "output", NodeStatus::kReplace,
+      {
+        {"Softmax", "softmax", NodeStatus::kRemove,
+          {
+            {"Mul|RealDiv", "scale", NodeStatus::kRemove,
+              {
+                {"BatchMatMul|BatchMatMulV2", "qk", NodeStatus::kRemove},
+                {"Const", "scale_value", NodeStatus::kRemain}
+              }
+            }
+          }
+        },
+        {"*", "value", NodeStatus::kRemain}
+      }
+    };
+
+  utils::OpTypePattern attention_pattern =
+    {"BatchMatMul|BatchMatMulV2", "output", NodeStatus::kReplace,
+      {
+        {"Softmax", "softmax", NodeStatus::kRemove,
+          {
+            {"BatchMatMul|BatchMatMulV2", "qk", NodeStatus::kRemove}
+          }
+        },
+        {"*", "value", NodeStatus::kRemain}
+      }
+    };
+  // clang-format on
+
+  utils::SubGraphMatcher<MatchingDirection::kFollowInputs> graph_matcher(
+      &(ctx->graph_view));
+  matched_nodes_map->clear();
+  remove_node_indices->clear();
+  bool found_op_type_match = graph_matcher.GetMatchedNodes(
+      scaled_attention_pattern, ctx->nodes_to_preserve,
+      ctx->graph_view.GetNode(node_index), matched_nodes_map,
+      remove_node_indices);
+  if (!found_op_type_match) {
+    matched_nodes_map->clear();
+    remove_node_indices->clear();
+    found_op_type_match = graph_matcher.GetMatchedNodes(
+        attention_pattern, ctx->nodes_to_preserve,
+        ctx->graph_view.GetNode(node_index), matched_nodes_map,
+        remove_node_indices);
+  }
+  if (!found_op_type_match) return false;
+  if (ctx->xla_cpu_jit_disable_fusion) return false;
+  for (int index : *remove_node_indices) {
+    if (HasControlFaninOrFanout(*ctx->graph_view.GetNode(index))) return false;
+  }
+
+  auto get_node = [&](const string& key) {
+    return ctx->graph_view.GetNode(matched_nodes_map->at(key))->node();
+  };
+  const NodeDef* output_node = get_node("output");
+  const NodeDef* qk_node = get_node("qk");
+  if (!NodeIsOnCpu(output_node)) return false;
+  const DataType dtype = GetDataTypeFromAttr(*output_node, "T");
+  if (dtype != DT_FLOAT && dtype != DT_BFLOAT16 && dtype != DT_HALF) {
+    return false;
+  }
+  // The scores are Q * K^T and the output is the softmax times V.
+  auto get_adj = [](const NodeDef* node, const char* name) {
+    return node->attr().count(name) && node->attr().at(name).b();
+  };
+  if (get_adj(qk_node, "adj_x") || !get_adj(qk_node, "adj_y") ||
+      get_adj(output_node, "adj_x") || get_adj(output_node, "adj_y")) {
+    return false;
+  }
+
+  *scale = 1.0f;
+  if (matched_nodes_map->count("scale")) {
+    const NodeDef* scale_node = get_node("scale");
+    float scale_value;
+    if (!GetScalarConstAsFloat(*get_node("scale_value"), &scale_value)) {
+      return false;
+    }
+    if (IsRealDiv(*scale_node)) {
+      // Only qk / c is a scaling of the scores.
+      if (scale_node->input(0) != qk_node->name() || scale_value == 0) {
+        return false;
+      }
+      *scale = 1.0f / scale_value;
+    } else {
+      *scale = scale_value;
+    }
+  }
+
+  // The fused op does not broadcast the batch dimensions, so they must be
+  // known and the same for the query, key and value.
+  if (!ctx->inferred_graph_properties) {
+    Status s = ctx->graph_properties.InferStatically(
+        /*assume_valid_feeds=*/true,
+        /*aggressive_shape_inference=*/false,
+        /*include_input_tensor_values=*/false,
+        /*include_output_tensor_values=*/true);
+    if (!s.ok()) return false;
+    ctx->inferred_graph_properties = true;
+  }
+  const auto& qk_props =
+      ctx->graph_properties.GetInputProperties(qk_node->name());
+  const auto& output_props =
+      ctx->graph_properties.GetInputProperties(output_node->name());
+  if (qk_props.size() != 2 || output_props.size() != 2) return false;
+  const TensorShapeProto& query_shape = qk_props[0].shape();
+  const int rank = Rank(query_shape);
+  if (rank < 2) return false;
+  for (const TensorShapeProto* shape :
+       {&qk_props[1].shape(), &output_props[1].shape()}) {
+    if (Rank(*shape) != rank) return false;
+    for (int i = 0; i < rank - 2; ++i) {
+      const int64_t size = query_shape.dim(i).size();
+      if (size < 0 || shape->dim(i).size() != size) return false;
+    }
+  }
+  return true;
+}
+
 bool FindFusedBatchNorm(const RemapperContext& ctx, int node_index,
                         FusedBatchNorm* matched) {
   const auto* node_view = ctx.graph_view.GetNode(node_index);
@@ -2705,6 +2995,166 @@ bool FindTensorToHashBucket(const RemapperContext& ctx, int node_index,
   return true;
 }
 
+bool IsSparseSegmentSumOrMean(const NodeDef& node) {
+  return node.op() == "SparseSegmentSum" || node.op() == "SparseSegmentMean";
+}
+
+// Returns whether `node_view` holds a scalar integer constant equal to one of
+// `values`.
+bool IsScalarIntConstant(const utils::MutableNodeView& node_view,
+                         std::initializer_list<int64_t> values) {
+  const NodeDef* node_def = node_view.node();
+  Tensor const_tensor;
+  if (!IsConstant(*node_def) ||
+      !const_tensor.FromProto(node_def->attr().at("value").tensor()) ||
+      const_tensor.NumElements() != 1) {
+    return false;
+  }
+  int64_t value;
+  if (const_tensor.dtype() == DT_INT32) {
+    value = const_tensor.flat<int32>()(0);
+  } else if (const_tensor.dtype() == DT_INT64) {
+    value = const_tensor.flat<int64_t>()(0);
+  } else {
+    return false;
+  }
+  return std::find(values.begin(), values.end(), value) != values.end();
+}
+
+// Returns whether the properties of input `port` of `node` are a matrix.
+bool HasMatrixInput(const RemapperContext& ctx, const NodeDef& node,
+                    int port) {
+  const std::vector<OpInfo::TensorProperties>& props =
+      ctx.graph_properties.GetInputProperties(node.name());
+  return static_cast<int>(props.size()) > port &&
+         !props[port].shape().unknown_rank() &&
+         props[port].shape().dim_size() == 2;
+}
+
+bool FindSparseSegmentReduceConcat(const RemapperContext& ctx, int node_index,
+                                   SparseSegmentReduceConcat* matched) {
+  // Root of the pattern must be a ConcatV2 along the columns.
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (!IsConcat(*node_def) || node_def->op() != "ConcatV2" ||
+      !NodeIsOnCpu(node_def) || HasControlFaninOrFanout(*node_view)) {
+    return false;
+  }
+  if (!HasDataType(node_def, DT_FLOAT) && !HasDataType(node_def, DT_DOUBLE)) {
+    return false;
+  }
+  int num_values;
+  if (!TryGetNodeAttr(*node_def, "N", &num_values) || num_values < 2 ||
+      node_view->NumRegularFanins() != num_values + 1 ||
+      !IsScalarIntConstant(*node_view->GetRegularFanin(num_values).node_view(),
+                           {1, -1})) {
+    return false;
+  }
+
+  SparseSegmentReduceConcat pattern;
+  pattern.concat = node_index;
+  const NodeDef* first_reduction = nullptr;
+  for (int i = 0; i < num_values; ++i) {
+    const auto& concat_fanin = node_view->GetRegularFanin(i);
+    const auto* reduction_view = concat_fanin.node_view();
+    const auto* reduction = reduction_view->node();
+    if (!IsSparseSegmentSumOrMean(*reduction) ||
+        reduction->device() != node_def->device() ||
+        HasControlFaninOrFanout(*reduction_view) ||
+        !HasAtMostOneFanoutAtPort0(*reduction_view) ||
+        IsInPreserveSet(ctx, reduction) ||
+        !HaveSameDataType(node_def, reduction)) {
+      return false;
+    }
+    if (first_reduction == nullptr) first_reduction = reduction;
+    if (!HaveSameDataType(first_reduction, reduction, "Tidx") ||
+        !HaveSameDataType(first_reduction, reduction, "Tsegmentids")) {
+      return false;
+    }
+    // The fused kernel reduces the rows of matrices.
+    if (!HasMatrixInput(ctx, *reduction, 0)) return false;
+
+    // Look through a GatherV2 that looks up the rows of an embedding table.
+    int gather_index = kMissingIndex;
+    const auto* data_view = reduction_view->GetRegularFanin(0).node_view();
+    const auto* data = data_view->node();
+    int batch_dims = 0;
+    if (IsGather(*data) && data->op() == "GatherV2" &&
+        data->device() == node_def->device() &&
+        !HasControlFaninOrFanout(*data_view) &&
+        HasAtMostOneFanoutAtPort0(*data_view) &&
+        !IsInPreserveSet(ctx, data) &&
+        HasDataType(data, GetDataTypeFromAttr(*reduction, "Tidx"),
+                    "Tindices") &&
+        (!TryGetNodeAttr(*data, "batch_dims", &batch_dims) ||
+         batch_dims == 0) &&
+        data_view->NumRegularFanins() == 3 &&
+        IsScalarIntConstant(*data_view->GetRegularFanin(2).node_view(), {0}) &&
+        HasMatrixInput(ctx, *data, 0)) {
+      gather_index = data_view->node_index();
+    }
+    pattern.segment_reductions.push_back(reduction_view->node_index());
+    pattern.gathers.push_back(gather_index);
+  }
+
+  *matched = std::move(pattern);
+  return true;
+}
+
+bool FindRaggedGatherToTensor(const RemapperContext& ctx, int node_index,
+                              RaggedGatherToTensor* matched) {
+  // Root of the pattern must be a RaggedTensorToTensor of a ragged tensor
+  // with a single ROW_SPLITS partition.
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (node_def->op() != "RaggedTensorToTensor" || !NodeIsOnCpu(node_def) ||
+      HasControlFaninOrFanout(*node_view) ||
+      node_view->NumRegularFanins() != 4) {
+    return false;
+  }
+  std::vector<string> row_partition_types;
+  if (!TryGetNodeAttr(*node_def, "row_partition_types",
+                      &row_partition_types) ||
+      row_partition_types.size() != 1 ||
+      row_partition_types[0] != "ROW_SPLITS") {
+    return false;
+  }
+
+  // The values and the row splits must be the outputs of one RaggedGather,
+  // which has no other consumers.
+  const auto& values_fanin = node_view->GetRegularFanin(1);
+  const auto& splits_fanin = node_view->GetRegularFanin(3);
+  const auto* gather_view = values_fanin.node_view();
+  const auto* gather = gather_view->node();
+  if (gather->op() != "RaggedGather" || values_fanin.index() != 1 ||
+      splits_fanin.node_view() != gather_view || splits_fanin.index() != 0 ||
+      gather->device() != node_def->device() ||
+      HasControlFaninOrFanout(*gather_view) ||
+      gather_view->GetRegularFanout(0).size() != 1 ||
+      gather_view->GetRegularFanout(1).size() != 1 ||
+      IsInPreserveSet(ctx, gather)) {
+    return false;
+  }
+  int params_ragged_rank;
+  int output_ragged_rank;
+  if (!TryGetNodeAttr(*gather, "PARAMS_RAGGED_RANK", &params_ragged_rank) ||
+      !TryGetNodeAttr(*gather, "OUTPUT_RAGGED_RANK", &output_ragged_rank) ||
+      params_ragged_rank != 1 || output_ragged_rank != 1) {
+    return false;
+  }
+
+  // The fused kernel only broadcasts a scalar default value.
+  const std::vector<OpInfo::TensorProperties>& props =
+      ctx.graph_properties.GetInputProperties(node_def->name());
+  if (props.size() < 3 || props[2].shape().unknown_rank() ||
+      props[2].shape().dim_size() != 0) {
+    return false;
+  }
+
+  *matched = RaggedGatherToTensor(gather_view->node_index(), node_index);
+  return true;
+}
+
 // clang-format off
 // HardSwish pattern
 //                        input     Const (value: 3)
@@ -3845,19 +4295,18 @@ Status AddFusedMatMulBiasAddAndGelu(
   return absl::OkStatus();
 }
 
-Status AddMklLayerNorm(RemapperContext* ctx,
-                       const std::map<string, int>& matched_nodes_map,
-                       const std::set<int>& remove_node_indices,
-                       const std::vector<string>& input_node_names,
-                       std::vector<bool>* invalidated_nodes,
-                       std::vector<bool>* nodes_to_delete,
-                       const float epsilon) {
+Status AddLayerNorm(RemapperContext* ctx,
+                    const std::map<string, int>& matched_nodes_map,
+                    const std::set<int>& remove_node_indices,
+                    const std::vector<string>& input_node_names,
+                    std::vector<bool>* invalidated_nodes,
+                    std::vector<bool>* nodes_to_delete, const float epsilon) {
   auto* output_node =
       ctx->graph_view.GetNode(matched_nodes_map.at("output"))->node();
 
   NodeDef fused_node;
   fused_node.set_name(output_node->name());
-  fused_node.set_op("_MklLayerNorm");
+  fused_node.set_op(IsMKLEnabled() ? "_MklLayerNorm" : "_FusedLayerNorm");
   fused_node.set_device(output_node->device());
   for (const auto& name : input_node_names) fused_node.add_input(name);
   auto* attr = fused_node.mutable_attr();
@@ -3878,6 +4327,40 @@ Status AddMklLayerNorm(RemapperContext* ctx,
   return absl::OkStatus();
 }
 
+Status AddScaledDotProductAttention(
+    RemapperContext* ctx, const std::map<string, int>& matched_nodes_map,
+    const std::set<int>& remove_node_indices,
+    std::vector<bool>* invalidated_nodes, std::vector<bool>* nodes_to_delete,
+    const float scale) {
+  auto* output_node =
+      ctx->graph_view.GetNode(matched_nodes_map.at("output"))->node();
+  auto* qk_node = ctx->graph_view.GetNode(matched_nodes_map.at("qk"))->node();
+
+  NodeDef fused_node;
+  fused_node.set_name(output_node->name());
+  fused_node.set_op("_FusedScaledDotProductAttention");
+  fused_node.set_device(output_node->device());
+  fused_node.add_input(qk_node->input(0));
+  fused_node.add_input(qk_node->input(1));
+  fused_node.add_input(output_node->input(1));
+  auto* attr = fused_node.mutable_attr();
+  (*attr)["T"] = output_node->attr().at("T");
+  SetAttrValue(scale, &(*attr)["scale"]);
+  SetAttrValue(false, &(*attr)["is_causal"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_node), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+  (*invalidated_nodes)[matched_nodes_map.at("output")] = true;
+
+  for (const auto& node_idx : remove_node_indices) {
+    (*nodes_to_delete)[node_idx] = true;
+  }
+  return absl::OkStatus();
+}
+
 Status ReplaceMulMaximumWithLeakyRelu(
     RemapperContext* ctx, const std::map<string, int>& matched_nodes_map,
     const std::set<int>& remove_node_indices,
@@ -4336,6 +4819,640 @@ Status AddTensorToHashBucketNode(RemapperContext* ctx,
   return absl::OkStatus();
 }
 
+Status AddSparseSegmentReduceConcatNode(
+    RemapperContext* ctx, const SparseSegmentReduceConcat& matched,
+    std::vector<bool>* invalidated_nodes, std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& concat = graph->node(matched.concat);
+  const int num_values = matched.segment_reductions.size();
+  VLOG(2) << "Fuse " << num_values
+          << " sparse segment reductions with ConcatV2: concat="
+          << concat.name() << " on device=" << concat.device();
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+
+  std::vector<string> data(num_values);
+  std::vector<string> indices(num_values);
+  std::vector<string> segment_ids(num_values);
+  std::vector<string> combiners(num_values);
+  for (int i = 0; i < num_values; ++i) {
+    const NodeDef& reduction = graph->node(matched.segment_reductions[i]);
+    data[i] = reduction.input(0);
+    indices[i] = reduction.input(1);
+    segment_ids[i] = reduction.input(2);
+    combiners[i] = reduction.op() == "SparseSegmentMean" ? "mean" : "sum";
+    (*nodes_to_delete)[matched.segment_reductions[i]] = true;
+    if (matched.gathers[i] == kMissingIndex) continue;
+
+    // Reduce the rows of the embedding table directly: the reduction of
+    // Gather(params, ids) at `indices` is the reduction of `params` at
+    // Gather(ids, indices).
+    const NodeDef& gather = graph->node(matched.gathers[i]);
+    NodeDef fused_indices;
+    fused_indices.set_name(absl::StrCat(reduction.name(), "/fused_indices"));
+    fused_indices.set_op("GatherV2");
+    fused_indices.set_device(gather.device());
+    fused_indices.add_input(gather.input(1));  // 0: params
+    fused_indices.add_input(indices[i]);       // 1: indices
+    fused_indices.add_input(gather.input(2));  // 2: axis
+    auto* indices_attr = fused_indices.mutable_attr();
+    (*indices_attr)["Tparams"] = reduction.attr().at("Tidx");
+    (*indices_attr)["Tindices"] = reduction.attr().at("Tidx");
+    (*indices_attr)["Taxis"] = gather.attr().at("Taxis");
+    SetAttrValue(0, &(*indices_attr)["batch_dims"]);
+
+    data[i] = gather.input(0);
+    indices[i] = fused_indices.name();
+    mutation->AddNode(std::move(fused_indices), &status);
+    TF_RETURN_IF_ERROR(status);
+    (*nodes_to_delete)[matched.gathers[i]] = true;
+  }
+
+  const NodeDef& first_reduction = graph->node(matched.segment_reductions[0]);
+  NodeDef fused_op;
+  fused_op.set_name(concat.name());
+  fused_op.set_op(kFusedSparseSegmentReduceConcat);
+  fused_op.set_device(concat.device());
+  for (const string& input : data) fused_op.add_input(input);
+  for (const string& input : indices) fused_op.add_input(input);
+  for (const string& input : segment_ids) fused_op.add_input(input);
+
+  auto* attr = fused_op.mutable_attr();
+  (*attr)["N"] = concat.attr().at("N");
+  (*attr)["T"] = concat.attr().at("T");
+  (*attr)["Tidx"] = first_reduction.attr().at("Tidx");
+  (*attr)["Tsegmentids"] = first_reduction.attr().at("Tsegmentids");
+  SetAttrValue(combiners, &(*attr)["combiners"]);
+
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.concat] = true;
+
+  return absl::OkStatus();
+}
+
+Status AddRaggedGatherToTensorNode(RemapperContext* ctx,
+                                   const RaggedGatherToTensor& matched,
+                                   std::vector<bool>* invalidated_nodes,
+                                   std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& ragged_gather = graph->node(matched.ragged_gather);
+  const NodeDef& to_tensor = graph->node(matched.to_tensor);
+  VLOG(2) << "Fuse RaggedGather with RaggedTensorToTensor: ragged_gather="
+          << ragged_gather.name() << " to_tensor=" << to_tensor.name()
+          << " on device=" << to_tensor.device();
+
+  NodeDef fused_op;
+  fused_op.set_name(to_tensor.name());
+  fused_op.set_op(kFusedRaggedGatherToTensor);
+  fused_op.set_device(to_tensor.device());
+  fused_op.add_input(ragged_gather.input(0));  // 0: params_splits
+  fused_op.add_input(ragged_gather.input(1));  // 1: params_dense_values
+  fused_op.add_input(ragged_gather.input(2));  // 2: indices
+  fused_op.add_input(to_tensor.input(0));      // 3: shape
+  fused_op.add_input(to_tensor.input(2));      // 4: default_value
+
+  auto* attr = fused_op.mutable_attr();
+  (*attr)["Tvalues"] = ragged_gather.attr().at("Tvalues");
+  (*attr)["Tindices"] = ragged_gather.attr().at("Tindices");
+  (*attr)["Tsplits"] = ragged_gather.attr().at("Tsplits");
+  (*attr)["Tshape"] = to_tensor.attr().at("Tshape");
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.to_tensor] = true;
+  (*nodes_to_delete)[matched.ragged_gather] = true;
+
+  return absl::OkStatus();
+}
+
+// Returns the shapes of the inputs of `node` if they are all fully defined.
+bool GetFullyDefinedInputShapes(const RemapperContext& ctx,
+                                const NodeDef& node,
+                                std::vector<TensorShape>* shapes) {
+  const std::vector<OpInfo::TensorProperties>& props =
+      ctx.graph_properties.GetInputProperties(node.name());
+  shapes->clear();
+  for (const auto& prop : props) {
+    if (prop.shape().unknown_rank() || !TensorShape::IsValid(prop.shape())) {
+      return false;
+    }
+    shapes->emplace_back(prop.shape());
+  }
+  return !shapes->empty();
+}
+
+// Returns whether the MatMul at `node_index` (with its BiasAdd, if any) can be
+// fused horizontally. If it can, sets `matched` and `signature`, which is
+// equal for the MatMuls that can be computed in the same BatchMatMulV2.
+bool FindHorizontalMatMul(const RemapperContext& ctx, int node_index,
+                          HorizontalMatMul* matched, string* signature) {
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (!IsMatMul(*node_def) || HasControlFaninOrFanout(*node_view) ||
+      node_view->NumRegularFanins() != 2) {
+    return false;
+  }
+  if (!HasDataType(node_def, DT_FLOAT) && !HasDataType(node_def, DT_HALF) &&
+      !HasDataType(node_def, DT_BFLOAT16)) {
+    return false;
+  }
+  std::vector<TensorShape> shapes;
+  if (!GetFullyDefinedInputShapes(ctx, *node_def, &shapes) ||
+      shapes.size() != 2 || shapes[0].dims() != 2 || shapes[1].dims() != 2) {
+    return false;
+  }
+  bool transpose_a = false;
+  bool transpose_b = false;
+  TryGetNodeAttr(*node_def, "transpose_a", &transpose_a);
+  TryGetNodeAttr(*node_def, "transpose_b", &transpose_b);
+  const int64_t m = shapes[0].dim_size(transpose_a ? 1 : 0);
+  const int64_t k = shapes[0].dim_size(transpose_a ? 0 : 1);
+  const int64_t n = shapes[1].dim_size(transpose_b ? 0 : 1);
+  if (m * k * n > kMaxHorizontalMatMulSize) return false;
+
+  // Fuse the BiasAdd that is the only consumer of the MatMul.
+  int bias_add = kMissingIndex;
+  const auto& fanouts = node_view->GetRegularFanout(0);
+  if (fanouts.size() == 1 && node_view->NumRegularFanouts() == 1) {
+    const auto* bias_add_view = fanouts[0].node_view();
+    const auto* bias_add_def = bias_add_view->node();
+    std::vector<TensorShape> bias_add_shapes;
+    string data_format = "NHWC";
+    TryGetNodeAttr(*bias_add_def, kDataFormat, &data_format);
+    if (IsBiasAdd(*bias_add_def) && fanouts[0].index() == 0 &&
+        data_format == "NHWC" && !HasControlFaninOrFanout(*bias_add_view) &&
+        bias_add_def->device() == node_def->device() &&
+        HaveSameDataType(node_def, bias_add_def) &&
+        !IsInPreserveSet(ctx, node_def) &&
+        GetFullyDefinedInputShapes(ctx, *bias_add_def, &bias_add_shapes) &&
+        bias_add_shapes.size() == 2 && bias_add_shapes[1].dims() == 1) {
+      bias_add = bias_add_view->node_index();
+    }
+  }
+
+  *matched = HorizontalMatMul(node_index, bias_add);
+  *signature = absl::StrCat(
+      node_def->device(), ";",
+      DataTypeString(GetDataTypeFromAttr(*node_def, "T")), ";", transpose_a,
+      transpose_b, ";", shapes[0].DebugString(), ";", shapes[1].DebugString(),
+      ";", bias_add != kMissingIndex);
+  return true;
+}
+
+// Replaces the MatMuls in `group`, which must have the same signature and be
+// independent of each other, with one BatchMatMulV2. The outputs of the
+// replaced nodes become Identity nodes of the same name, so that their
+// consumers and fetches are unchanged.
+Status AddHorizontalMatMulNodes(RemapperContext* ctx,
+                                const std::vector<HorizontalMatMul>& group,
+                                std::vector<bool>* invalidated_nodes,
+                                std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& first_matmul = graph->node(group[0].matmul);
+  const bool has_bias = group[0].bias_add != kMissingIndex;
+  const string prefix = AddPrefixToNodeName("horizontal_matmul",
+                                            first_matmul.name());
+  const string& device = first_matmul.device();
+  const AttrValue& dtype = first_matmul.attr().at("T");
+  VLOG(2) << "Fuse " << group.size()
+          << " MatMuls horizontally: first matmul=" << first_matmul.name()
+          << " on device=" << device;
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  const auto add_node = [&](NodeDef* node, const string& name,
+                            const string& op) {
+    node->set_name(absl::StrCat(prefix, "/", name));
+    node->set_op(op);
+    node->set_device(device);
+    (*node->mutable_attr())["T"] = dtype;
+  };
+  const auto add_pack = [&](const string& name, int input_port,
+                            bool from_bias_add) -> string {
+    NodeDef pack;
+    add_node(&pack, name, "Pack");
+    for (const HorizontalMatMul& matmul : group) {
+      const NodeDef& input_node =
+          graph->node(from_bias_add ? matmul.bias_add : matmul.matmul);
+      pack.add_input(input_node.input(input_port));
+    }
+    SetAttrValue(static_cast<int>(group.size()), &(*pack.mutable_attr())["N"]);
+    SetAttrValue(0, &(*pack.mutable_attr())["axis"]);
+    string pack_name = pack.name();
+    mutation->AddNode(std::move(pack), &status);
+    return pack_name;
+  };
+
+  const string a = add_pack("a", 0, /*from_bias_add=*/false);
+  TF_RETURN_IF_ERROR(status);
+  const string b = add_pack("b", 1, /*from_bias_add=*/false);
+  TF_RETURN_IF_ERROR(status);
+
+  NodeDef batch_matmul;
+  add_node(&batch_matmul, "BatchMatMulV2", "BatchMatMulV2");
+  batch_matmul.add_input(a);
+  batch_matmul.add_input(b);
+  bool transpose_a = false;
+  bool transpose_b = false;
+  TryGetNodeAttr(first_matmul, "transpose_a", &transpose_a);
+  TryGetNodeAttr(first_matmul, "transpose_b", &transpose_b);
+  SetAttrValue(transpose_a, &(*batch_matmul.mutable_attr())["adj_x"]);
+  SetAttrValue(transpose_b, &(*batch_matmul.mutable_attr())["adj_y"]);
+  string output = batch_matmul.name();
+  mutation->AddNode(std::move(batch_matmul), &status);
+  TF_RETURN_IF_ERROR(status);
+
+  if (has_bias) {
+    // Add the bias of each MatMul to all the rows of its result:
+    // [N, m, n] + [N, 1, n].
+    const string bias = add_pack("bias", 1, /*from_bias_add=*/true);
+    TF_RETURN_IF_ERROR(status);
+
+    NodeDef axis;
+    axis.set_name(absl::StrCat(prefix, "/bias_axis"));
+    axis.set_op("Const");
+    axis.set_device(device);
+    axis.add_input(AsControlDependency(bias));
+    (*axis.mutable_attr())["dtype"].set_type(DT_INT32);
+    Tensor axis_t(DT_INT32, TensorShape({}));
+    axis_t.scalar<int32>()() = 1;
+    axis_t.AsProtoTensorContent(
+        (*axis.mutable_attr())["value"].mutable_tensor());
+    string axis_name = axis.name();
+    mutation->AddNode(std::move(axis), &status);
+    TF_RETURN_IF_ERROR(status);
+
+    NodeDef expand_dims;
+    add_node(&expand_dims, "ExpandDims", "ExpandDims");
+    expand_dims.add_input(bias);
+    expand_dims.add_input(axis_name);
+    SetAttrValue(DT_INT32, &(*expand_dims.mutable_attr())["Tdim"]);
+    string expand_dims_name = expand_dims.name();
+    mutation->AddNode(std::move(expand_dims), &status);
+    TF_RETURN_IF_ERROR(status);
+
+    NodeDef add;
+    add_node(&add, "AddV2", "AddV2");
+    add.add_input(output);
+    add.add_input(expand_dims_name);
+    output = add.name();
+    mutation->AddNode(std::move(add), &status);
+    TF_RETURN_IF_ERROR(status);
+  }
+
+  NodeDef unpack;
+  add_node(&unpack, "Unpack", "Unpack");
+  unpack.add_input(output);
+  SetAttrValue(static_cast<int>(group.size()),
+               &(*unpack.mutable_attr())["num"]);
+  SetAttrValue(0, &(*unpack.mutable_attr())["axis"]);
+  const string unpack_name = unpack.name();
+  mutation->AddNode(std::move(unpack), &status);
+  TF_RETURN_IF_ERROR(status);
+
+  for (int i = 0; i < group.size(); ++i) {
+    const int root = has_bias ? group[i].bias_add : group[i].matmul;
+    NodeDef identity;
+    identity.set_name(graph->node(root).name());
+    identity.set_op("Identity");
+    identity.set_device(device);
+    identity.add_input(TensorIdToString({unpack_name, i}));
+    (*identity.mutable_attr())["T"] = dtype;
+    mutation->AddNode(std::move(identity), &status);
+    TF_RETURN_IF_ERROR(status);
+
+    (*invalidated_nodes)[root] = true;
+    if (has_bias) (*nodes_to_delete)[group[i].matmul] = true;
+  }
+  return mutation->Apply();
+}
+
+// Groups the independent MatMuls of the same signature, and replaces each
+// group with one BatchMatMulV2. Requires the graph to be sorted topologically.
+Status FuseHorizontalMatMuls(RemapperContext* ctx,
+                             std::vector<bool>* invalidated_nodes,
+                             std::vector<bool>* nodes_to_delete) {
+  const int num_nodes = ctx->graph_view.NumNodes();
+  std::vector<HorizontalMatMul> candidates;
+  std::vector<string> signatures;
+  absl::flat_hash_map<string, int> num_matmuls_by_signature;
+  for (int i = 0; i < num_nodes; ++i) {
+    HorizontalMatMul matched;
+    string signature;
+    if (FindHorizontalMatMul(*ctx, i, &matched, &signature)) {
+      candidates.push_back(matched);
+      signatures.push_back(signature);
+      ++num_matmuls_by_signature[signature];
+    }
+  }
+  std::vector<int> candidate_index(num_nodes, -1);
+  int num_candidates = 0;
+  for (int i = 0; i < candidates.size(); ++i) {
+    if (num_matmuls_by_signature[signatures[i]] < 2) continue;
+    candidates[num_candidates] = candidates[i];
+    signatures[num_candidates] = signatures[i];
+    candidate_index[candidates[i].matmul] = num_candidates++;
+  }
+  if (num_candidates == 0) return absl::OkStatus();
+  candidates.resize(num_candidates);
+  signatures.resize(num_candidates);
+
+  // Give up on graphs that are not sorted, e.g. with loops.
+  for (int i = 0; i < num_nodes; ++i) {
+    const auto* node_view = ctx->graph_view.GetNode(i);
+    for (const auto& fanin : node_view->GetRegularFanins()) {
+      if (fanin.node_view()->node_index() >= i) return absl::OkStatus();
+    }
+    for (const auto& fanin : node_view->GetControllingFanins()) {
+      if (fanin.node_view()->node_index() >= i) return absl::OkStatus();
+    }
+  }
+
+  // Two MatMuls can only be fused if neither one depends on the other, so
+  // collect the candidates that each candidate (transitively) depends on.
+  // The search from a node stops at the candidates it reaches, whose own
+  // dependencies `matmul_depends_on` already holds.
+  std::vector<std::vector<bool>> matmul_depends_on(
+      num_candidates, std::vector<bool>(num_candidates, false));
+  std::vector<int> visited(num_nodes, -1);
+  int num_searches = 0;
+  const auto collect_dependencies = [&](int start, int self,
+                                        std::vector<bool>* depends_on) {
+    const int search = num_searches++;
+    std::vector<int> stack = {start};
+    while (!stack.empty()) {
+      const int node_index = stack.back();
+      stack.pop_back();
+      if (visited[node_index] == search) continue;
+      visited[node_index] = search;
+      const int c = candidate_index[node_index];
+      if (node_index != start && c >= 0) {
+        if (c != self) (*depends_on)[c] = true;
+        for (int d = 0; d < num_candidates; ++d) {
+          if (matmul_depends_on[c][d]) (*depends_on)[d] = true;
+        }
+        continue;
+      }
+      const auto* node_view = ctx->graph_view.GetNode(node_index);
+      for (const auto& fanin : node_view->GetRegularFanins()) {
+        stack.push_back(fanin.node_view()->node_index());
+      }
+      for (const auto& fanin : node_view->GetControllingFanins()) {
+        stack.push_back(fanin.node_view()->node_index());
+      }
+    }
+  };
+  // The candidates a MatMul reaches come before it, so their dependencies
+  // have already been collected.
+  for (int c = 0; c < num_candidates; ++c) {
+    collect_dependencies(candidates[c].matmul, c, &matmul_depends_on[c]);
+  }
+  // The BiasAdd, if any, depends on everything that its MatMul does, and
+  // possibly on more candidates through the bias.
+  std::vector<std::vector<bool>> depends_on = matmul_depends_on;
+  for (int c = 0; c < num_candidates; ++c) {
+    if (candidates[c].bias_add != kMissingIndex) {
+      collect_dependencies(candidates[c].bias_add, c, &depends_on[c]);
+    }
+  }
+
+  // Greedily group the candidates of each signature in topological order. A
+  // candidate joins a group if it neither depends on a member nor a member
+  // depends on it.
+  std::vector<bool> grouped(num_candidates, false);
+  for (int c = 0; c < num_candidates; ++c) {
+    if (grouped[c]) continue;
+    std::vector<int> members = {c};
+    for (int other = c + 1; other < num_candidates; ++other) {
+      if (grouped[other] || signatures[other] != signatures[c]) continue;
+      const bool independent = absl::c_none_of(members, [&](int member) {
+        return depends_on[other][member] || depends_on[member][other];
+      });
+      if (independent) members.push_back(other);
+    }
+    if (members.size() < 2) continue;
+
+    std::vector<HorizontalMatMul> group;
+    std::vector<bool> in_group(num_candidates, false);
+    std::vector<bool> group_depends_on(num_candidates, false);
+    for (int member : members) {
+      grouped[member] = true;
+      in_group[member] = true;
+      group.push_back(candidates[member]);
+      for (int d = 0; d < num_candidates; ++d) {
+        if (depends_on[member][d]) group_depends_on[d] = true;
+      }
+    }
+
+    // The group becomes a single node, so whatever depends on one member now
+    // depends on the inputs of all of them. Later groups must take this into
+    // account to not create cycles.
+    for (int other = 0; other < num_candidates; ++other) {
+      std::vector<bool>& other_depends_on = depends_on[other];
+      const bool depends_on_group =
+          absl::c_any_of(members, [&](int m) { return other_depends_on[m]; });
+      if (!depends_on_group && !in_group[other]) continue;
+      for (int d = 0; d < num_candidates; ++d) {
+        if (group_depends_on[d] || (depends_on_group && in_group[d])) {
+          other_depends_on[d] = true;
+        }
+      }
+    }
+    TF_RETURN_IF_ERROR(AddHorizontalMatMulNodes(ctx, group, invalidated_nodes,
+                                                nodes_to_delete));
+  }
+  return absl::OkStatus();
+}
+
+// Returns whether `node` is compiled by XLA, with the attributes set by XLA
+// clustering, jit_compile and TPU replication.
+bool IsMarkedForXlaCompilation(const NodeDef& node) {
+  for (const char* attr_name :
+       {"_xla_compile_id", "_tpu_replicate", "_XlaMustCompile", "_XlaCompile",
+        "_XlaCluster"}) {
+    auto it = node.attr().find(attr_name);
+    if (it != node.attr().end() &&
+        (!it->second.s().empty() || it->second.b())) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns whether the ResourceApplyAdam at `node_index` can be grouped with
+// others into a _ResourceApplyAdamMulti. If it can, sets `signature`, which is
+// equal for the ops sharing their device, attributes and hyperparameters.
+bool FindResourceApplyAdam(const RemapperContext& ctx, int node_index,
+                           string* signature) {
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  // Only group placed ops, so that the variables of a group are colocated.
+  if (node_def->op() != "ResourceApplyAdam" || node_def->device().empty() ||
+      node_view->NumRegularFanins() != 10) {
+    return false;
+  }
+  // _ResourceApplyAdamMulti only has CPU and GPU kernels, and no XLA kernel.
+  if (IsMarkedForXlaCompilation(*node_def)) return false;
+  const DataType dtype = GetDataTypeFromAttr(*node_def, "T");
+  if (NodeIsOnCpu(node_def)) {
+    if (dtype != DT_HALF && dtype != DT_BFLOAT16 && dtype != DT_FLOAT &&
+        dtype != DT_DOUBLE && dtype != DT_COMPLEX64 && dtype != DT_COMPLEX128) {
+      return false;
+    }
+  } else if (NodeIsOnGpu(node_def)) {
+    if (dtype != DT_HALF && dtype != DT_FLOAT && dtype != DT_DOUBLE &&
+        dtype != DT_COMPLEX64 && dtype != DT_COMPLEX128) {
+      return false;
+    }
+  } else {
+    return false;
+  }
+  bool use_locking = false;
+  bool use_nesterov = false;
+  TryGetNodeAttr(*node_def, "use_locking", &use_locking);
+  TryGetNodeAttr(*node_def, "use_nesterov", &use_nesterov);
+  *signature = absl::StrCat(node_def->device(), ";", DataTypeString(dtype),
+                            ";", use_locking, use_nesterov);
+  // beta1_power, beta2_power, lr, beta1, beta2 and epsilon.
+  for (int i = 3; i < 9; ++i) {
+    absl::StrAppend(signature, ";", node_def->input(i));
+  }
+  return true;
+}
+
+// Replaces the ResourceApplyAdam ops in `group`, which must have the same
+// signature and be independent of each other, with one
+// _ResourceApplyAdamMulti. The replaced ops become NoOps of the same name that
+// depend on it, so that their control fanouts and fetches are unchanged.
+Status AddResourceApplyAdamMultiNode(RemapperContext* ctx,
+                                     const std::vector<int>& group,
+                                     std::vector<bool>* invalidated_nodes) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& first = graph->node(group[0]);
+  const int n = group.size();
+  VLOG(2) << "Fuse " << n << " ResourceApplyAdam ops: first=" << first.name()
+          << " on device=" << first.device();
+
+  NodeDef fused;
+  fused.set_name(AddPrefixToNodeName("adam_multi", first.name()));
+  fused.set_op("_ResourceApplyAdamMulti");
+  fused.set_device(first.device());
+  // var, m and v of all the ops, then the shared hyperparameters, then grad.
+  for (int input : {0, 1, 2}) {
+    for (int node : group) fused.add_input(graph->node(node).input(input));
+  }
+  for (int input = 3; input < 9; ++input) fused.add_input(first.input(input));
+  for (int node : group) fused.add_input(graph->node(node).input(9));
+  absl::flat_hash_set<string> fanin_nodes;
+  for (const string& input : fused.input()) {
+    fanin_nodes.insert(string(ParseTensorName(input).node()));
+  }
+  for (int node : group) {
+    const auto* node_view = ctx->graph_view.GetNode(node);
+    for (const auto& fanin : node_view->GetControllingFanins()) {
+      const string& name = fanin.node_view()->node()->name();
+      if (fanin_nodes.insert(name).second) {
+        fused.add_input(AsControlDependency(name));
+      }
+    }
+  }
+  auto* attr = fused.mutable_attr();
+  for (const char* name : {"T", "use_locking", "use_nesterov"}) {
+    if (first.attr().count(name)) (*attr)[name] = first.attr().at(name);
+  }
+  SetAttrValue(n, &(*attr)["N"]);
+  const string fused_name = fused.name();
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused), &status);
+  TF_RETURN_IF_ERROR(status);
+  for (int node : group) {
+    NodeDef no_op;
+    no_op.set_name(graph->node(node).name());
+    no_op.set_op("NoOp");
+    no_op.set_device(first.device());
+    no_op.add_input(AsControlDependency(fused_name));
+    mutation->AddNode(std::move(no_op), &status);
+    TF_RETURN_IF_ERROR(status);
+    (*invalidated_nodes)[node] = true;
+  }
+  return mutation->Apply();
+}
+
+// Groups the independent ResourceApplyAdam ops of the same signature, and
+// replaces each group with one _ResourceApplyAdamMulti, so that models with
+// many variables do not launch a kernel per variable and step.
+Status FuseResourceApplyAdams(RemapperContext* ctx,
+                              std::vector<bool>* invalidated_nodes) {
+  const int num_nodes = ctx->graph_view.NumNodes();
+  std::vector<string> signatures;
+  absl::flat_hash_map<string, std::vector<int>> candidates_by_signature;
+  for (int i = 0; i < num_nodes; ++i) {
+    string signature;
+    if (!FindResourceApplyAdam(*ctx, i, &signature)) continue;
+    std::vector<int>& candidates = candidates_by_signature[signature];
+    if (candidates.empty()) signatures.push_back(signature);
+    candidates.push_back(i);
+  }
+
+  for (const string& signature : signatures) {
+    const std::vector<int>& candidates = candidates_by_signature[signature];
+    if (candidates.size() < 2) continue;
+
+    // An op that (transitively) depends on another candidate must stay out
+    // of the group, or the group would depend on itself. Walk the fanouts of
+    // all the candidates at once to find them.
+    std::vector<bool> reached(ctx->graph_view.NumNodes(), false);
+    std::vector<int> queue;
+    const auto visit_fanouts = [&](int node) {
+      const auto* node_view = ctx->graph_view.GetNode(node);
+      for (const auto& fanouts : node_view->GetRegularFanouts()) {
+        for (const auto& fanout : fanouts) {
+          queue.push_back(fanout.node_index());
+        }
+      }
+      for (const auto& fanout : node_view->GetControlledFanouts()) {
+        queue.push_back(fanout.node_index());
+      }
+    };
+    for (int candidate : candidates) visit_fanouts(candidate);
+    while (!queue.empty()) {
+      const int node = queue.back();
+      queue.pop_back();
+      if (reached[node]) continue;
+      reached[node] = true;
+      visit_fanouts(node);
+    }
+
+    // The slots of a variable must only be updated once by the group.
+    std::vector<int> group;
+    absl::flat_hash_set<string> variables;
+    for (int candidate : candidates) {
+      if (reached[candidate]) continue;
+      const NodeDef& node = ctx->graph_view.graph()->node(candidate);
+      if (!variables.insert(node.input(0)).second ||
+          !variables.insert(node.input(1)).second ||
+          !variables.insert(node.input(2)).second) {
+        continue;
+      }
+      group.push_back(candidate);
+    }
+    if (group.size() < 2) continue;
+    TF_RETURN_IF_ERROR(
+        AddResourceApplyAdamMultiNode(ctx, group, invalidated_nodes));
+  }
+  return absl::OkStatus();
+}
+
 Status AddFusedBatchMatMul(RemapperContext* ctx,
                            const std::map<string, int>& matched_nodes_map,
                            const std::set<int>& remove_node_indices,
@@ -4809,17 +5926,40 @@ bool RequiresInferredShapes(const RemapperContext& ctx, int node_index,
     return true;
   };
 
+  // Candidate for a _FusedSparseSegmentReduceConcat fusion.
+  const auto is_sparse_segment_reduce_concat_candidate = [&]() -> bool {
+    if (node_def->op() != "ConcatV2" || node_view->NumRegularFanins() < 1) {
+      return false;
+    }
+    return IsSparseSegmentSumOrMean(
+        *node_view->GetRegularFanin(0).node_view()->node());
+  };
+
+  // Candidate for a _FusedRaggedGatherToTensor fusion.
+  const auto is_ragged_gather_to_tensor_candidate = [&]() -> bool {
+    if (node_def->op() != "RaggedTensorToTensor" ||
+        node_view->NumRegularFanins() < 2) {
+      return false;
+    }
+    return node_view->GetRegularFanin(1).node_view()->node()->op() ==
+           "RaggedGather";
+  };
+
   if (IsMKLEnabled())
     return is_batch_norm_candidate() || is_batch_norm_fusion_candidate() ||
            IsContractionWithAdd(ctx, node_index) ||
            is_act_biasadd_conv_candidate() || IsBiasAdd(*node_def) ||
-           IsTranspose(*node_def);
+           IsTranspose(*node_def) ||
+           is_sparse_segment_reduce_concat_candidate() ||
+           is_ragged_gather_to_tensor_candidate();
 
   return is_act_biasadd_conv_candidate() || is_batch_norm_candidate() ||
          is_batch_norm_fusion_candidate() ||
          is_batch_norm_grad_fusion_candidate() ||
          is_matmul_gelu_exact_fusion_candidate() ||
-         is_act_biasadd_matmul_candidate();
+         is_act_biasadd_matmul_candidate() ||
+         is_sparse_segment_reduce_concat_candidate() ||
+         is_ragged_gather_to_tensor_candidate();
 }
 
 inline bool IsXlaCpuGlobalJitOn() {
@@ -4860,6 +6000,26 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
   bool allow_non_differentiable_rewrites =
       item.optimization_options().allow_non_differentiable_rewrites;
 
+  // Batch small independent MatMuls before they are fused vertically.
+  if (HorizontalMatMulFusionEnabled()) {
+    const bool assume_valid_feeds = opt_level_ == RewriterConfig::AGGRESSIVE;
+    TF_RETURN_IF_ERROR(ctx.graph_properties.InferStatically(
+        assume_valid_feeds,
+        /*aggressive_shape_inference=*/false,
+        /*include_input_tensor_values=*/true,
+        /*include_output_tensor_values=*/false));
+    ctx.inferred_graph_properties = true;
+    TF_RETURN_IF_ERROR(
+        FuseHorizontalMatMuls(&ctx, &invalidated_nodes, &nodes_to_delete));
+  }
+
+  // Apply Adam to the variables sharing their hyperparameters at once. The
+  // fused op has no XLA kernel, so this is skipped when XLA clusters the
+  // graph.
+  if (MultiTensorApplyFusionEnabled() && !ctx.xla_auto_clustering_on) {
+    TF_RETURN_IF_ERROR(FuseResourceApplyAdams(&ctx, &invalidated_nodes));
+  }
+
   for (int i = num_nodes - 1; i >= 0; --i) {
     // Check if node was invalidated by one of the previous remaps.
     if (invalidated_nodes[i] || nodes_to_delete[i]) {
@@ -5048,9 +6208,9 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       remove_node_indices.clear();
       input_node_names.clear();
       float epsilon = 0.001;
-      if (FindMklLayerNorm(&ctx, i, &matched_nodes_map, &remove_node_indices,
-                           &input_node_names, &epsilon)) {
-        TF_RETURN_IF_ERROR(AddMklLayerNorm(
+      if (FindLayerNorm(&ctx, i, &matched_nodes_map, &remove_node_indices,
+                        &input_node_names, &epsilon)) {
+        TF_RETURN_IF_ERROR(AddLayerNorm(
             &ctx, matched_nodes_map, remove_node_indices, input_node_names,
             &invalidated_nodes, &nodes_to_delete, epsilon));
         continue;
@@ -5079,9 +6239,37 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       }
     }
 
-    // Remap MatMul + BiasAdd + gelu-subgraph
+    // Remap smaller ops from layernorm python api into _FusedLayerNorm on CPU.
+    // With oneDNN they are remapped into _MklLayerNorm above.
     std::map<string, int> matched_nodes_map;
     std::set<int> remove_node_indices;
+    if (!IsMKLEnabled() && allow_non_differentiable_rewrites) {
+      std::vector<string> input_node_names;
+      float epsilon = 0.001;
+      if (FindLayerNorm(&ctx, i, &matched_nodes_map, &remove_node_indices,
+                        &input_node_names, &epsilon) &&
+          IsCpuCompatibleLayerNorm(ctx, matched_nodes_map)) {
+        TF_RETURN_IF_ERROR(AddLayerNorm(
+            &ctx, matched_nodes_map, remove_node_indices, input_node_names,
+            &invalidated_nodes, &nodes_to_delete, epsilon));
+        continue;
+      }
+
+      // Remap BatchMatMul + Softmax + BatchMatMul attention into
+      // _FusedScaledDotProductAttention on CPU.
+      float scale = 1.0f;
+      if (FindScaledDotProductAttention(&ctx, i, &matched_nodes_map,
+                                        &remove_node_indices, &scale)) {
+        TF_RETURN_IF_ERROR(AddScaledDotProductAttention(
+            &ctx, matched_nodes_map, remove_node_indices, &invalidated_nodes,
+            &nodes_to_delete, scale));
+        continue;
+      }
+    }
+
+    // Remap MatMul + BiasAdd + gelu-subgraph
+    matched_nodes_map.clear();
+    remove_node_indices.clear();
     bool is_gelu_approximate = false;
     if (FindMatMulBiasAddAndGelu(&ctx, i, cluster, &matched_nodes_map,
                                  &remove_node_indices, &is_gelu_approximate)) {
@@ -5182,6 +6370,27 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       continue;
     }
 
+    // Fuse the sparse segment reductions of an embedding lookup with the
+    // ConcatV2 of their results. This fusion only works on CPU.
+    SparseSegmentReduceConcat sparse_segment_reduce_concat;
+    if (allow_non_differentiable_rewrites &&
+        FindSparseSegmentReduceConcat(ctx, i, &sparse_segment_reduce_concat)) {
+      TF_RETURN_IF_ERROR(AddSparseSegmentReduceConcatNode(
+          &ctx, sparse_segment_reduce_concat, &invalidated_nodes,
+          &nodes_to_delete));
+      continue;
+    }
+
+    // Densify the rows of a ragged gather directly. This fusion only works
+    // on CPU.
+    RaggedGatherToTensor ragged_gather_to_tensor;
+    if (allow_non_differentiable_rewrites &&
+        FindRaggedGatherToTensor(ctx, i, &ragged_gather_to_tensor)) {
+      TF_RETURN_IF_ERROR(AddRaggedGatherToTensorNode(
+          &ctx, ragged_gather_to_tensor, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
     // During inference, most of the inputs to FusedBatchNorm are constant, and
     // we can therefore replace the op with a much cheaper set of primitives.
     FusedBatchNorm fused_batch_norm;
@@ -0,0 +1,183 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/remapper.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+
+class RemapperHorizontalMatMulTest : public GrapplerTest {
+ protected:
+  // The remapper reads the variable the first time it runs, i.e. in the first
+  // test of this binary.
+  void SetUp() override {
+    setenv("TF_REMAPPER_HORIZONTAL_MATMUL_FUSION", "1", /*overwrite=*/1);
+  }
+};
+
+TEST_F(RemapperHorizontalMatMulTest, FusesIndependentMatMuls) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto shape = ops::Placeholder::Shape({8, 16});
+  auto weights_shape = ops::Placeholder::Shape({16, 16});
+  auto bias_shape = ops::Placeholder::Shape({16});
+
+  // Towers "a" and "b" are independent; tower "c" reads the output of "a".
+  std::vector<std::pair<string, Tensor>> feed;
+  const auto add_tower = [&](const string& tower, Output input) -> Output {
+    const string weights_name = absl::StrCat("weights_", tower);
+    const string bias_name = absl::StrCat("bias_", tower);
+    auto weights = Placeholder(s.WithOpName(weights_name), DT_FLOAT,
+                               weights_shape);
+    auto bias = Placeholder(s.WithOpName(bias_name), DT_FLOAT, bias_shape);
+    feed.emplace_back(weights_name, GenerateRandomTensor<DT_FLOAT>({16, 16}));
+    feed.emplace_back(bias_name, GenerateRandomTensor<DT_FLOAT>({16}));
+    auto matmul =
+        ops::MatMul(s.WithOpName(absl::StrCat("matmul_", tower)), input,
+                    weights);
+    return ops::BiasAdd(s.WithOpName(absl::StrCat("bias_add_", tower)),
+                        matmul, bias);
+  };
+  auto input_a = Placeholder(s.WithOpName("input_a"), DT_FLOAT, shape);
+  auto input_b = Placeholder(s.WithOpName("input_b"), DT_FLOAT, shape);
+  feed.emplace_back("input_a", GenerateRandomTensor<DT_FLOAT>({8, 16}));
+  feed.emplace_back("input_b", GenerateRandomTensor<DT_FLOAT>({8, 16}));
+  Output tower_a = add_tower("a", input_a);
+  Output tower_b = add_tower("b", input_b);
+  Output tower_c = add_tower("c", tower_a);
+  auto fetch_b = ops::Identity(s.WithOpName("fetch_b"), tower_b);
+  auto fetch_c = ops::Identity(s.WithOpName("fetch_c"), tower_c);
+
+  GrapplerItem item;
+  item.fetch = {"fetch_b", "fetch_c"};
+  item.feed = feed;
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int num_batch_matmuls = 0;
+  std::set<string> unpacked;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "matmul_a");
+    EXPECT_NE(node.name(), "matmul_b");
+    if (node.op() == "BatchMatMulV2") {
+      ++num_batch_matmuls;
+    } else if (node.name() == "bias_add_a" || node.name() == "bias_add_b") {
+      EXPECT_EQ(node.op(), "Identity");
+      ASSERT_EQ(node.input_size(), 1);
+      unpacked.insert(node.input(0));
+    } else if (node.name() == "bias_add_c") {
+      // Tower "c" depends on tower "a", so it can't be in the same batch.
+      EXPECT_NE(node.op(), "Identity");
+    }
+  }
+  EXPECT_EQ(num_batch_matmuls, 1);
+  EXPECT_EQ(unpacked.size(), 2);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 2);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 2);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+  test::ExpectTensorNear<float>(tensors[1], tensors_expected[1], 1e-6);
+}
+
+TEST_F(RemapperHorizontalMatMulTest, DoesNotFuseMatMulsDependentThroughBias) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto shape = ops::Placeholder::Shape({8, 16});
+  auto weights_shape = ops::Placeholder::Shape({16, 16});
+  auto bias_shape = ops::Placeholder::Shape({16});
+
+  std::vector<std::pair<string, Tensor>> feed;
+  const auto placeholder = [&](const string& name,
+                               const ops::Placeholder::Attrs& attrs,
+                               const TensorShape& tensor_shape) -> Output {
+    feed.emplace_back(name, GenerateRandomTensor<DT_FLOAT>(tensor_shape));
+    return Placeholder(s.WithOpName(name), DT_FLOAT, attrs);
+  };
+  const auto add_tower = [&](const string& tower, Output bias) -> Output {
+    auto input = placeholder(absl::StrCat("input_", tower), shape, {8, 16});
+    auto weights =
+        placeholder(absl::StrCat("weights_", tower), weights_shape, {16, 16});
+    auto matmul =
+        ops::MatMul(s.WithOpName(absl::StrCat("matmul_", tower)), input,
+                    weights);
+    return ops::BiasAdd(s.WithOpName(absl::StrCat("bias_add_", tower)),
+                        matmul, bias);
+  };
+  // The MatMul of tower "c" is independent of tower "a", but its bias is
+  // computed from the output of "a".
+  Output tower_a = add_tower("a", placeholder("bias_a", bias_shape, {16}));
+  Output tower_b = add_tower("b", placeholder("bias_b", bias_shape, {16}));
+  Output tower_c = add_tower(
+      "c", ops::Sum(s.WithOpName("bias_c"), tower_a, ops::Const(s, {0})));
+  auto fetch_b = ops::Identity(s.WithOpName("fetch_b"), tower_b);
+  auto fetch_c = ops::Identity(s.WithOpName("fetch_c"), tower_c);
+
+  GrapplerItem item;
+  item.fetch = {"fetch_b", "fetch_c"};
+  item.feed = feed;
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int num_batch_matmuls = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.op() == "BatchMatMulV2") {
+      ++num_batch_matmuls;
+    } else if (node.name() == "bias_add_a" || node.name() == "bias_add_b") {
+      EXPECT_EQ(node.op(), "Identity");
+    } else if (node.name() == "bias_add_c") {
+      EXPECT_NE(node.op(), "Identity");
+    }
+  }
+  EXPECT_EQ(num_batch_matmuls, 1);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 2);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 2);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+  test::ExpectTensorNear<float>(tensors[1], tensors_expected[1], 1e-5);
+}
+
+}  // namespace grappler
+}  // namespace tensorflow
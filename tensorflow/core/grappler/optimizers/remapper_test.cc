@@ -15,8 +15,15 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
 #include "tensorflow/cc/ops/nn_ops_internal.h"
+#include "tensorflow/cc/ops/resource_variable_ops.h"
 #include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/function_testlib.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
@@ -1699,6 +1706,124 @@ class FuseMklLayerNormPattern : public RemapperTest {
 
 TEST_F(FuseMklLayerNormPattern, F32) { RunTest<DT_FLOAT>(); }
 
+TEST_F(RemapperTest, FuseLayerNormOnCpu) {
+  if (IsMKLEnabled()) GTEST_SKIP() << "Test not applicable to MKL.";
+  using ::tensorflow::ops::Placeholder;
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto input = Placeholder(s.WithOpName("input"), DT_FLOAT,
+                           ops::Placeholder::Shape({2, 3, 4}));
+  auto r_indices = ops::Const(s.WithOpName("r_indices"), {2}, {1});
+  ops::Mean::Attrs attrs;
+  attrs = attrs.KeepDims(true);
+  auto mean = ops::Mean(s.WithOpName("mean"), input, r_indices, attrs);
+  auto sub = ops::Sub(s.WithOpName("sub"), input, mean);
+  auto s_diff = ops::SquaredDifference(s.WithOpName("s_diff"), mean, input);
+  auto variance = ops::Mean(s.WithOpName("variance"), s_diff, r_indices, attrs);
+  auto e_const = ops::Const(s.WithOpName("e_const"), {0.01f}, {});
+  auto add_1 = ops::AddV2(s.WithOpName("add_1"), e_const, variance);
+  auto rsqrt = ops::Rsqrt(s.WithOpName("rsqrt"), add_1);
+  auto mul = ops::Mul(s.WithOpName("mul"), sub, rsqrt);
+  auto g_const = ops::Const(s.WithOpName("g_const"), {1.0f, 2.0f, 3.0f, 4.0f});
+  auto mul_1 = ops::Mul(s.WithOpName("mul_1"), g_const, mul);
+  auto b_const = ops::Const(s.WithOpName("b_const"), {0.5f, 0.0f, 1.0f, 2.0f});
+  auto add_2 = ops::AddV2(s.WithOpName("add_2"), mul_1, b_const);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), add_2);
+
+  auto input_t = GenerateRandomTensor<DT_FLOAT>({2, 3, 4});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"input", input_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "add_2") {
+      EXPECT_EQ(node.op(), "_FusedLayerNorm");
+      ASSERT_GE(node.input_size(), 3);
+      EXPECT_EQ(node.input(0), "input");
+      EXPECT_EQ(node.input(1), "g_const");
+      EXPECT_EQ(node.input(2), "b_const");
+      EXPECT_FLOAT_EQ(node.attr().at("epsilon").f(), 0.01f);
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-4);
+}
+
+TEST_F(RemapperTest, FuseScaledDotProductAttentionOnCpu) {
+  if (IsMKLEnabled()) GTEST_SKIP() << "Test not applicable to MKL.";
+  using ::tensorflow::ops::Placeholder;
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto query = Placeholder(s.WithOpName("query"), DT_FLOAT,
+                           ops::Placeholder::Shape({2, 5, 4}));
+  auto key = Placeholder(s.WithOpName("key"), DT_FLOAT,
+                         ops::Placeholder::Shape({2, 7, 4}));
+  auto value = Placeholder(s.WithOpName("value"), DT_FLOAT,
+                           ops::Placeholder::Shape({2, 7, 3}));
+  auto qk = ops::BatchMatMulV2(s.WithOpName("qk"), query, key,
+                               ops::BatchMatMulV2::AdjY(true));
+  auto divisor = ops::Const(s.WithOpName("divisor"), 2.0f, {});
+  auto scaled = ops::RealDiv(s.WithOpName("scaled"), qk, divisor);
+  auto softmax = ops::Softmax(s.WithOpName("softmax"), scaled);
+  auto attention =
+      ops::BatchMatMulV2(s.WithOpName("attention"), softmax, value);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), attention);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"query", GenerateRandomTensor<DT_FLOAT>({2, 5, 4})},
+               {"key", GenerateRandomTensor<DT_FLOAT>({2, 7, 4})},
+               {"value", GenerateRandomTensor<DT_FLOAT>({2, 7, 3})}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "softmax");
+    if (node.name() == "attention") {
+      EXPECT_EQ(node.op(), "_FusedScaledDotProductAttention");
+      ASSERT_EQ(node.input_size(), 3);
+      EXPECT_EQ(node.input(0), "query");
+      EXPECT_EQ(node.input(1), "key");
+      EXPECT_EQ(node.input(2), "value");
+      EXPECT_FLOAT_EQ(node.attr().at("scale").f(), 0.5f);
+      EXPECT_FALSE(node.attr().at("is_causal").b());
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-5);
+}
+
 class RemapperTensorToHashBucketTest : public RemapperTest {
  public:
   template <DataType DTYPE>
@@ -1767,6 +1892,359 @@ TEST_F(RemapperTensorToHashBucketTest, I32) { RunTest<DT_INT32>(); }
 
 TEST_F(RemapperTensorToHashBucketTest, I64) { RunTest<DT_INT64>(); }
 
+class RemapperSparseSegmentReduceConcatTest : public RemapperTest {
+ public:
+  template <DataType DTYPE>
+  void RunTest() {
+    using ::tensorflow::ops::Placeholder;
+
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+    // The first feature is looked up from an embedding table; the second one
+    // reduces an already dense input.
+    auto table = Placeholder(s.WithOpName("table"), DTYPE,
+                             ops::Placeholder::Shape({16, 4}));
+    auto ids = Placeholder(s.WithOpName("ids"), DT_INT32,
+                           ops::Placeholder::Shape({6}));
+    auto dense = Placeholder(s.WithOpName("dense"), DTYPE,
+                             ops::Placeholder::Shape({5, 3}));
+    auto indices_0 = ops::Const(s.WithOpName("indices_0"), {0, 1, 2, 4, 5});
+    auto segment_ids_0 =
+        ops::Const(s.WithOpName("segment_ids_0"), {0, 0, 1, 2, 2});
+    auto indices_1 = ops::Const(s.WithOpName("indices_1"), {4, 3, 2, 1});
+    auto segment_ids_1 =
+        ops::Const(s.WithOpName("segment_ids_1"), {0, 1, 1, 2});
+    auto axis_0 = ops::Const(s.WithOpName("axis_0"), 0);
+    auto axis_1 = ops::Const(s.WithOpName("axis_1"), 1);
+
+    auto gather = ops::GatherV2(s.WithOpName("gather"), table, ids, axis_0);
+    auto sum = ops::SparseSegmentSum(s.WithOpName("sum"), gather, indices_0,
+                                     segment_ids_0);
+    auto mean = ops::SparseSegmentMean(s.WithOpName("mean"), dense, indices_1,
+                                       segment_ids_1);
+    auto concat = ops::Concat(s.WithOpName("concat"),
+                              {sum.output, mean.output}, axis_1);
+    auto fetch = ops::Identity(s.WithOpName("fetch"), concat);
+
+    auto table_t = GenerateRandomTensor<DTYPE>({16, 4});
+    auto ids_t = test::AsTensor<int32>({15, 3, 7, 0, 9, 11});
+    auto dense_t = GenerateRandomTensor<DTYPE>({5, 3});
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    item.feed = {{"table", table_t}, {"ids", ids_t}, {"dense", dense_t}};
+    TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+    // This fusion is only supported on CPU.
+    for (int i = 0; i < item.graph.node_size(); ++i) {
+      item.graph.mutable_node(i)->set_device("/device:CPU:0");
+    }
+
+    Remapper optimizer(RewriterConfig::ON);
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+    int found = 0;
+    for (const NodeDef& node : output.node()) {
+      EXPECT_NE(node.name(), "gather");
+      EXPECT_NE(node.name(), "sum");
+      EXPECT_NE(node.name(), "mean");
+      if (node.name() == "concat") {
+        EXPECT_EQ(node.op(), "_FusedSparseSegmentReduceConcat");
+        ASSERT_EQ(node.input_size(), 6);
+        EXPECT_EQ(node.input(0), "table");
+        EXPECT_EQ(node.input(1), "dense");
+        EXPECT_EQ(node.input(2), "sum/fused_indices");
+        EXPECT_EQ(node.input(3), "indices_1");
+        EXPECT_EQ(node.input(4), "segment_ids_0");
+        EXPECT_EQ(node.input(5), "segment_ids_1");
+        const auto& combiners = node.attr().at("combiners").list();
+        ASSERT_EQ(combiners.s_size(), 2);
+        EXPECT_EQ(combiners.s(0), "sum");
+        EXPECT_EQ(combiners.s(1), "mean");
+        found++;
+      } else if (node.name() == "sum/fused_indices") {
+        EXPECT_EQ(node.op(), "GatherV2");
+        ASSERT_EQ(node.input_size(), 3);
+        EXPECT_EQ(node.input(0), "ids");
+        EXPECT_EQ(node.input(1), "indices_0");
+        EXPECT_EQ(node.input(2), "axis_0");
+        found++;
+      }
+    }
+    EXPECT_EQ(found, 2);
+
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+    ASSERT_EQ(tensors_expected.size(), 1);
+    auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+    ASSERT_EQ(tensors.size(), 1);
+    typedef typename EnumToDataType<DTYPE>::Type T;
+    test::ExpectTensorNear<T>(tensors[0], tensors_expected[0], 1e-6);
+  }
+};
+
+TEST_F(RemapperSparseSegmentReduceConcatTest, F32) { RunTest<DT_FLOAT>(); }
+
+TEST_F(RemapperSparseSegmentReduceConcatTest, F64) { RunTest<DT_DOUBLE>(); }
+
+TEST_F(RemapperTest, FuseRaggedGatherToTensor) {
+  using test::function::NDef;
+  const string kDevice = "/device:CPU:0";
+
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("splits", "Placeholder", {},
+            {{"dtype", DT_INT64}, {"shape", PartialTensorShape({5})}},
+            kDevice),
+       NDef("values", "Placeholder", {},
+            {{"dtype", DT_FLOAT}, {"shape", PartialTensorShape({9})}},
+            kDevice),
+       NDef("indices", "Placeholder", {},
+            {{"dtype", DT_INT32}, {"shape", PartialTensorShape({4})}},
+            kDevice),
+       NDef("shape", "Placeholder", {},
+            {{"dtype", DT_INT64}, {"shape", PartialTensorShape({2})}},
+            kDevice),
+       NDef("default_value", "Placeholder", {},
+            {{"dtype", DT_FLOAT}, {"shape", PartialTensorShape({})}},
+            kDevice),
+       NDef("gather", "RaggedGather", {"splits", "values", "indices"},
+            {{"Tvalues", DT_FLOAT},
+             {"Tindices", DT_INT32},
+             {"Tsplits", DT_INT64},
+             {"PARAMS_RAGGED_RANK", 1},
+             {"OUTPUT_RAGGED_RANK", 1}},
+            kDevice),
+       NDef("to_tensor", "RaggedTensorToTensor",
+            {"shape", "gather:1", "default_value", "gather:0"},
+            {{"T", DT_FLOAT},
+             {"Tindex", DT_INT64},
+             {"Tshape", DT_INT64},
+             {"num_row_partition_tensors", 1},
+             {"row_partition_types", std::vector<string>{"ROW_SPLITS"}}},
+            kDevice),
+       NDef("fetch", "Identity", {"to_tensor"}, {{"T", DT_FLOAT}}, kDevice)},
+      {});
+  item.fetch = {"fetch"};
+  item.feed = {
+      {"splits", test::AsTensor<int64_t>({0, 3, 3, 7, 9})},
+      {"values", test::AsTensor<float>({1, 2, 3, 4, 5, 6, 7, 8, 9})},
+      {"indices", test::AsTensor<int32>({2, 1, 0, 3})},
+      {"shape", test::AsTensor<int64_t>({5, 3})},
+      {"default_value", test::AsScalar<float>(-1)}};
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "gather");
+    if (node.name() == "to_tensor") {
+      EXPECT_EQ(node.op(), "_FusedRaggedGatherToTensor");
+      ASSERT_EQ(node.input_size(), 5);
+      EXPECT_EQ(node.input(0), "splits");
+      EXPECT_EQ(node.input(1), "values");
+      EXPECT_EQ(node.input(2), "indices");
+      EXPECT_EQ(node.input(3), "shape");
+      EXPECT_EQ(node.input(4), "default_value");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorEqual<float>(tensors[0], tensors_expected[0]);
+}
+
+// The fusion is tested in remapper_horizontal_matmul_test.cc, since the
+// remapper reads whether it is enabled once per process.
+TEST_F(RemapperTest, HorizontalMatMulFusionDisabledByDefault) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  auto shape = ops::Placeholder::Shape({8, 16});
+  auto lhs_a = Placeholder(s.WithOpName("lhs_a"), DT_FLOAT, shape);
+  auto rhs_a = Placeholder(s.WithOpName("rhs_a"), DT_FLOAT, shape);
+  auto lhs_b = Placeholder(s.WithOpName("lhs_b"), DT_FLOAT, shape);
+  auto rhs_b = Placeholder(s.WithOpName("rhs_b"), DT_FLOAT, shape);
+  auto matmul_a = ops::MatMul(s.WithOpName("matmul_a"), lhs_a, rhs_a,
+                              ops::MatMul::TransposeB(true));
+  auto matmul_b = ops::MatMul(s.WithOpName("matmul_b"), lhs_b, rhs_b,
+                              ops::MatMul::TransposeB(true));
+
+  GrapplerItem item;
+  item.fetch = {"matmul_a", "matmul_b"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.op(), "BatchMatMulV2");
+  }
+}
+
+TEST_F(RemapperTest, FuseResourceApplyAdams) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  const TensorShape shape({3, 5});
+  auto scalar = [&](const string& name, float value) {
+    return ops::Const(s.WithOpName(name), value);
+  };
+  auto beta1_power = scalar("beta1_power", 0.9f);
+  auto beta2_power = scalar("beta2_power", 0.999f);
+  auto lr = scalar("lr", 0.01f);
+  auto beta1 = scalar("beta1", 0.9f);
+  auto beta2 = scalar("beta2", 0.999f);
+  auto epsilon = scalar("epsilon", 1e-7f);
+
+  // The updates of "a" and "b" are independent; the gradient of "c" is only
+  // computed once "a" is updated.
+  std::vector<string> fetch;
+  std::map<string, Operation> applies;
+  const auto add_variable = [&](const string& name,
+                                std::vector<Operation> grad_deps) {
+    std::vector<Output> handles;
+    std::vector<Operation> inits;
+    for (const string& slot : {"var", "m", "v"}) {
+      const string handle_name = absl::StrCat(slot, "_", name);
+      auto handle =
+          ops::VarHandleOp(s.WithOpName(handle_name), DT_FLOAT, shape,
+                           ops::VarHandleOp::SharedName(handle_name));
+      Tensor init = GenerateRandomTensor<DT_FLOAT>(shape);
+      if (slot != "var") init.flat<float>() = init.flat<float>().abs();
+      auto init_value = ops::Const(s.WithOpName(absl::StrCat("init_value_",
+                                                             handle_name)),
+                                   Input::Initializer(init));
+      inits.push_back(ops::AssignVariableOp(
+          s.WithOpName(absl::StrCat("init_", handle_name)), handle,
+          init_value).operation);
+      handles.push_back(handle);
+    }
+    auto grad = ops::Identity(
+        s.WithOpName(absl::StrCat("grad_", name))
+            .WithControlDependencies(grad_deps),
+        ops::Const(s.WithOpName(absl::StrCat("grad_value_", name)),
+                   Input::Initializer(GenerateRandomTensor<DT_FLOAT>(shape))));
+    auto apply = ops::ResourceApplyAdam(
+        s.WithOpName(absl::StrCat("apply_", name)).WithControlDependencies(
+            inits),
+        handles[0], handles[1], handles[2], beta1_power, beta2_power, lr,
+        beta1, beta2, epsilon, grad);
+    applies.emplace(name, apply.operation);
+    for (int i = 0; i < 3; ++i) {
+      const string read_name = absl::StrCat("read_", i, "_", name);
+      ops::ReadVariableOp(s.WithOpName(read_name).WithControlDependencies(
+                              {apply.operation}),
+                          handles[i], DT_FLOAT);
+      fetch.push_back(read_name);
+    }
+  };
+  add_variable("a", {});
+  add_variable("b", {});
+  add_variable("c", {applies.at("a")});
+
+  GrapplerItem item;
+  item.fetch = fetch;
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  string fused_name;
+  for (const NodeDef& node : output.node()) {
+    if (node.op() == "_ResourceApplyAdamMulti") {
+      EXPECT_TRUE(fused_name.empty());
+      fused_name = node.name();
+      EXPECT_EQ(node.attr().at("N").i(), 2);
+      ASSERT_GE(node.input_size(), 14);
+      EXPECT_EQ(node.input(0), "var_a");
+      EXPECT_EQ(node.input(1), "var_b");
+      EXPECT_EQ(node.input(6), "beta1_power");
+      EXPECT_EQ(node.input(12), "grad_a");
+      EXPECT_EQ(node.input(13), "grad_b");
+    }
+  }
+  ASSERT_FALSE(fused_name.empty());
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "apply_a" || node.name() == "apply_b") {
+      EXPECT_EQ(node.op(), "NoOp");
+      ASSERT_EQ(node.input_size(), 1);
+      EXPECT_EQ(node.input(0), AsControlDependency(fused_name));
+    } else if (node.name() == "apply_c") {
+      // "c" depends on the update of "a", so it can't be in the same group.
+      EXPECT_EQ(node.op(), "ResourceApplyAdam");
+    }
+  }
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  ASSERT_EQ(tensors_expected.size(), fetch.size());
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(tensors.size(), fetch.size());
+  for (int i = 0; i < fetch.size(); ++i) {
+    test::ExpectTensorNear<float>(tensors[i], tensors_expected[i], 1e-6);
+  }
+}
+
+TEST_F(RemapperTest, FusesResourceApplyAdamsOnlyWithKernels) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  const TensorShape shape({3, 5});
+  auto scalar = [&](const string& name, float value) {
+    return ops::Const(s.WithOpName(name), value);
+  };
+  auto beta1_power = scalar("beta1_power", 0.9f);
+  auto beta2_power = scalar("beta2_power", 0.999f);
+  auto lr = scalar("lr", 0.01f);
+  auto beta1 = scalar("beta1", 0.9f);
+  auto beta2 = scalar("beta2", 0.999f);
+  auto epsilon = scalar("epsilon", 1e-7f);
+  for (const string& name : {"a", "b"}) {
+    std::vector<Output> handles;
+    for (const string& slot : {"var", "m", "v"}) {
+      const string handle_name = absl::StrCat(slot, "_", name);
+      handles.push_back(
+          ops::VarHandleOp(s.WithOpName(handle_name), DT_FLOAT, shape,
+                           ops::VarHandleOp::SharedName(handle_name)));
+    }
+    auto grad = ops::Const(s.WithOpName(absl::StrCat("grad_", name)),
+                           Input::Initializer(
+                               GenerateRandomTensor<DT_FLOAT>(shape)));
+    ops::ResourceApplyAdam(s.WithOpName(absl::StrCat("apply_", name)),
+                           handles[0], handles[1], handles[2], beta1_power,
+                           beta2_power, lr, beta1, beta2, epsilon, grad);
+  }
+  GrapplerItem item;
+  item.fetch = {"apply_a", "apply_b"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  const auto num_fused = [&](const string& device, bool xla_compiled) {
+    GrapplerItem placed = item;
+    for (NodeDef& node : *placed.graph.mutable_node()) {
+      node.set_device(device);
+      if (xla_compiled) (*node.mutable_attr())["_XlaMustCompile"].set_b(true);
+    }
+    Remapper optimizer(RewriterConfig::ON);
+    GraphDef output;
+    TF_CHECK_OK(optimizer.Optimize(nullptr, placed, &output));
+    int num_fused = 0;
+    for (const NodeDef& node : output.node()) {
+      if (node.op() == "_ResourceApplyAdamMulti") ++num_fused;
+    }
+    return num_fused;
+  };
+  EXPECT_EQ(num_fused("/device:CPU:0", /*xla_compiled=*/false), 1);
+  // There is neither a TPU nor an XLA kernel for _ResourceApplyAdamMulti.
+  EXPECT_EQ(num_fused("/device:TPU:0", /*xla_compiled=*/false), 0);
+  EXPECT_EQ(num_fused("/device:CPU:0", /*xla_compiled=*/true), 0);
+}
+
 class RemapperFuseMatMulWithBiasTest : public RemapperTest {
  public:
   template <DataType DTYPE>
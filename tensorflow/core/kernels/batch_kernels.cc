@@ -23,6 +23,7 @@ limitations under the License.
 #include <utility>
 
 #include "absl/status/status.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
@@ -121,6 +122,15 @@ int32 NumBatchThreadsFromEnvironmentWithDefault(int default_num_batch_threads) {
                                                    : default_num_batch_threads;
 }
 
+// Returns whether batched outputs are handed back to each invocation as views
+// into the batched output tensors; see
+// BatchResourceBase::set_zero_copy_batch_outputs().
+bool ZeroCopyBatchOutputsFromEnvironment() {
+  bool zero_copy = false;
+  const char* val = std::getenv("TF_BATCH_ZERO_COPY_OUTPUTS");
+  return val && absl::SimpleAtob(val, &zero_copy) && zero_copy;
+}
+
 static thread::ThreadPool* GetOrCreateBatchThreadsPool() {
   static thread::ThreadPool* shared_thread_pool = [&]() -> thread::ThreadPool* {
     serving::BoundedExecutor::Options options;
@@ -420,6 +430,8 @@ void BatchFunctionKernel::ComputeAsync(OpKernelContext* c, DoneCallback done) {
       if (session_metadata) {
         new_resource->set_session_metadata(*session_metadata);
       }
+      new_resource->set_zero_copy_batch_outputs(
+          ZeroCopyBatchOutputsFromEnvironment());
       *r = new_resource.release();
       return absl::OkStatus();
     };
@@ -442,6 +454,8 @@ void BatchFunctionKernel::ComputeAsync(OpKernelContext* c, DoneCallback done) {
       if (session_metadata) {
         new_resource->set_session_metadata(*session_metadata);
       }
+      new_resource->set_zero_copy_batch_outputs(
+          ZeroCopyBatchOutputsFromEnvironment());
       *r = new_resource.release();
       return absl::OkStatus();
     };
@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
 #include "tensorflow/core/kernels/batching_util/warmup.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/test.h"
@@ -49,6 +50,8 @@ limitations under the License.
 namespace tensorflow {
 namespace {
 
+using ::tensorflow::monitoring::testing::CellReader;
+using ::tensorflow::monitoring::testing::Histogram;
 using PerModelData = serving::WarmupStateRegistry::PerModelData;
 
 class BatchFunctionKernelTest : public test_util::BatchFunctionKernelTestBase {
@@ -235,6 +238,42 @@ TEST_P(BatchFunctionTest, PaddingWorksWithoutCriticality) {
   }
 }
 
+TEST_P(BatchFunctionTest, RecordsTaskLatencyBreakdown) {
+  CellReader<Histogram> reader(
+      "/tensorflow/serving/batching/task_latency_breakdown_us");
+  SessionMetadata session_metadata;
+  session_metadata.set_name("latency_breakdown_model");
+  session_metadata.set_version(123);
+
+  bool enable_low_priority_queue = GetParam();
+  {
+    tsl::BlockingCounter blocking_counter(8);
+    for (int i = 0; i < 8; ++i) {
+      Env::Default()->SchedClosure([&]() {
+        BatchFunctionTestState test_state;
+        test_state.set_session_metadata(session_metadata);
+        TF_ASSERT_OK(test_state.Init(
+            cpu_device_.get(), enable_low_priority_queue,
+            serving::kLowPriorityPaddingWithMaxBatchSizeAttrValue,
+            /*expected_batch_size=*/8));
+        test_state.AddInputFromList<int64_t>(TensorShape({1, 2}), {123, 456});
+        TF_EXPECT_OK(test_state.RunOpKernel());
+        blocking_counter.DecrementCount();
+      });
+    }
+
+    blocking_counter.Wait();
+  }
+
+  for (absl::string_view stage :
+       {"queueing", "input_processing", "execution", "output_split"}) {
+    EXPECT_EQ(reader.Delta("latency_breakdown_model", "BatchTPUInput", stage)
+                  .num(),
+              8)
+        << stage;
+  }
+}
+
 #if defined(PLATFORM_GOOGLE)
 TEST_P(BatchFunctionTest,
        LowPriorityTaskPaddingHighPriorityBatchUptoMaxBatchSize) {
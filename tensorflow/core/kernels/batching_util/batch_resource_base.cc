@@ -213,6 +213,54 @@ void RecordBatchDelayUsV2(int64_t batch_delay_us, const string& model_name,
       ->Add(static_cast<double>(batch_delay_us));
 }
 
+// Returns the time between two timestamps of `BatchTask` in microseconds, or -1
+// if the task hasn't reached either of them.
+int64_t StageDurationUs(uint64 from_nanos, uint64 to_nanos) {
+  if (from_nanos == 0 || to_nanos < from_nanos) return -1;
+  return (to_nanos - from_nanos) / 1000;
+}
+
+void RecordBatchTaskLatencyBreakdown(const BatchResourceBase::BatchTask& task,
+                                     const string& model_name,
+                                     const string& op_name) {
+  static auto* cell = tensorflow::monitoring::Sampler<3>::New(
+      {"/tensorflow/serving/batching/task_latency_breakdown_us",
+       "Tracks the time (in microseconds) a task spends in each stage of "
+       "batching by model_name, op_name and stage: 'queueing' until a batch "
+       "thread dequeues its batch, 'input_processing' until the batched "
+       "computation starts, 'execution' and 'output_split'.",
+       "model_name", "op_name", "stage"},
+      // It's 27 buckets with the last bucket being 2^26 to DBL_MAX;
+      // so the limits are [1, 2, 4, 8, ..., 64 * 1024 * 1024, DBL_MAX].
+      monitoring::Buckets::Exponential(1, 2, 27));
+  const int64_t queueing_us =
+      StageDurationUs(task.start_time, task.dequeue_time);
+  const int64_t input_processing_us =
+      StageDurationUs(task.dequeue_time, task.execution_start_time);
+  const int64_t execution_us =
+      StageDurationUs(task.execution_start_time, task.execution_end_time);
+  const int64_t output_split_us =
+      StageDurationUs(task.execution_end_time, task.split_end_time);
+  for (const auto& [stage, duration_us] :
+       {std::make_pair("queueing", queueing_us),
+        std::make_pair("input_processing", input_processing_us),
+        std::make_pair("execution", execution_us),
+        std::make_pair("output_split", output_split_us)}) {
+    if (duration_us < 0) continue;
+    cell->GetCell(model_name, op_name, stage)
+        ->Add(static_cast<double>(duration_us));
+  }
+  profiler::TraceMe::InstantActivity([&] {
+    return profiler::TraceMeEncode(
+        "BatchTaskLatencyBreakdown",
+        {{"guid", task.guid},
+         {"queueing_us", queueing_us},
+         {"input_processing_us", input_processing_us},
+         {"execution_us", execution_us},
+         {"output_split_us", output_split_us}});
+  });
+}
+
 void RecordBatchParamBatchTimeoutMicros(int64_t batch_timeout_micros,
                                         const string& model_name,
                                         const string& op_name) {
@@ -232,6 +280,17 @@ void RecordBatchParamMaxBatchSize(int64_t max_batch_size,
   cell->GetCell(model_name, op_name)->Set(max_batch_size);
 }
 
+void RecordBatchParamTargetBatchSize(int64_t target_batch_size,
+                                     const string& model_name,
+                                     const string& op_name) {
+  static auto* cell = monitoring::Gauge<int64_t, 2>::New(
+      "/tensorflow/serving/batching/target_batch_size",
+      "Tracks the batch size at which a batch is scheduled before its timeout, "
+      "as chosen by adaptive batching.",
+      "model_name", "op_name");
+  cell->GetCell(model_name, op_name)->Set(target_batch_size);
+}
+
 void RecordBatchParamMaxEnqueuedBatches(int64_t max_enqueued_batches,
                                         const string& model_name,
                                         const string& op_name) {
@@ -396,9 +455,19 @@ Status BatchResourceBase::RegisterInput(
   RecordInputBatchSizeV2(tensors[0].shape().dim_size(0), GetModelName(context),
                          context->op_kernel().name());
   if (batcher_) {
-    RecordBatchParamBatchTimeoutMicros(
-        batcher_queue_options_.batch_timeout_micros, GetModelName(context),
-        context->op_kernel().name());
+    if (batcher_queue_options_.adaptive_batching_options.enabled) {
+      // Report the latest decisions of the adaptive batching controller.
+      RecordBatchParamBatchTimeoutMicros(
+          adaptive_batch_timeout_micros_.load(std::memory_order_relaxed),
+          GetModelName(context), context->op_kernel().name());
+      RecordBatchParamTargetBatchSize(
+          adaptive_target_batch_size_.load(std::memory_order_relaxed),
+          GetModelName(context), context->op_kernel().name());
+    } else {
+      RecordBatchParamBatchTimeoutMicros(
+          batcher_queue_options_.batch_timeout_micros, GetModelName(context),
+          context->op_kernel().name());
+    }
     RecordBatchParamMaxBatchSize(
         batcher_queue_options_.max_execution_batch_size, GetModelName(context),
         context->op_kernel().name());
@@ -729,6 +798,12 @@ Status BatchResourceBase::ConcatInputTensors(
       }
     }
 
+    // A batch of a single unpadded task is processed in place.
+    if (to_concatenate.size() == 1) {
+      concatenated_tensors->push_back(std::move(to_concatenate[0]));
+      continue;
+    }
+
     Tensor concatenated_tensor;
     Status concat_status =
         Concat(context, to_concatenate, &concatenated_tensor);
@@ -887,12 +962,17 @@ Status BatchResourceBase::SplitOutputTensors(
     }
 
     std::vector<Tensor> split_tensor;
-    const Status split_status = tensor::Split(
-        output_tensor, task_sizes_plus_optional_padding, &split_tensor);
-    DCHECK(split_status.ok()) << split_status;
-    if (!split_status.ok()) {
-      return errors::Internal("Tensor split operation failed: ",
-                              split_status.message());
+    if (!zero_copy_batch_outputs_ ||
+        !SplitIntoAlignedSlices(output_tensor,
+                                task_sizes_plus_optional_padding,
+                                &split_tensor)) {
+      const Status split_status = tensor::Split(
+          output_tensor, task_sizes_plus_optional_padding, &split_tensor);
+      DCHECK(split_status.ok()) << split_status;
+      if (!split_status.ok()) {
+        return errors::Internal("Tensor split operation failed: ",
+                                split_status.message());
+      }
     }
     DCHECK_EQ(split_tensor.size(), task_sizes_plus_optional_padding.size());
     if (split_tensor.size() != task_sizes_plus_optional_padding.size()) {
@@ -923,6 +1003,25 @@ Status BatchResourceBase::SplitOutputTensors(
   return absl::OkStatus();
 }
 
+/*static*/ bool BatchResourceBase::SplitIntoAlignedSlices(
+    const Tensor& tensor, absl::Span<const int64_t> sizes,
+    std::vector<Tensor>* slices) {
+  if (tensor.dims() == 0) return false;
+  std::vector<Tensor> result;
+  result.reserve(sizes.size());
+  int64_t position = 0;
+  for (const int64_t size : sizes) {
+    if (size < 0 || position + size > tensor.dim_size(0)) return false;
+    Tensor slice = tensor.Slice(position, position + size);
+    if (!slice.IsAligned()) return false;
+    result.push_back(std::move(slice));
+    position += size;
+  }
+  if (position != tensor.dim_size(0)) return false;
+  std::move(result.begin(), result.end(), std::back_inserter(*slices));
+  return true;
+}
+
 void BatchResourceBase::CleanUpFunctionHelper(BatchTask& task,
                                               const Status& status) const {
   WithContext wc(task.propagated_context);
@@ -959,6 +1058,7 @@ void BatchResourceBase::ProcessFuncBatch(
   auto& last_task = batch->task(batch->num_tasks() - 1);
   OpKernelContext* last_task_context = last_task.context;
   const std::string& model_name = GetModelName(last_task_context);
+  const std::string& op_name = last_task_context->op_kernel().name();
 
   // Regardless of the outcome, we need to propagate the status to the
   // individual tasks and signal that they are done. We use MakeCleanup() to
@@ -978,6 +1078,11 @@ void BatchResourceBase::ProcessFuncBatch(
     // Clear the measurements before unblocking the batch task, as measurements
     // are associated with the task's thread context.
     batch_cost_measurements.clear();
+    // Recorded before any task is done, since that may release the context
+    // that `model_name` and `op_name` refer to.
+    for (int i = 0; i < batch->num_tasks(); ++i) {
+      RecordBatchTaskLatencyBreakdown(batch->task(i), model_name, op_name);
+    }
     for (int i = 0; i < batch->num_tasks(); ++i) {
       CleanUpFunctionHelper(*batch->mutable_task(i), status);
     }
@@ -1013,11 +1118,10 @@ void BatchResourceBase::ProcessFuncBatch(
   uint64 current_time = EnvTime::NowNanos();
   for (int i = 0; i < batch->num_tasks(); ++i) {
     RecordBatchDelayUs((current_time - batch->task(i).start_time) * 1e-3,
-                       model_name, last_task_context->op_kernel().name(),
-                       processed_size);
+                       model_name, op_name, processed_size);
     RecordBatchDelayUsV2((current_time - batch->task(i).start_time) * 1e-3,
-                         model_name, last_task_context->op_kernel().name(),
-                         processed_size);
+                         model_name, op_name, processed_size);
+    batch->mutable_task(i)->execution_start_time = current_time;
   }
   // Releases the cleanup method here, because the callback of the function
   // library runtime will handle it now.
@@ -1034,13 +1138,22 @@ void BatchResourceBase::ProcessFuncBatch(
           // queue rather than the end.
           cleanup_fn(final_status);
         });
+        const uint64 execution_end_time = EnvTime::NowNanos();
+        for (int i = 0; i < batch->num_tasks(); ++i) {
+          batch->mutable_task(i)->execution_end_time = execution_end_time;
+        }
         final_status = run_status;
         if (!final_status.ok()) {
           return;
         }
         if (last_task.forced_warmup_batch_size == 0) {
+          profiler::TraceMe trace_me("SplitOutputTensors");
           final_status = SplitOutputTensors(combined_outputs, batch.get(),
                                             unbatched_tasks);
+          const uint64 split_end_time = EnvTime::NowNanos();
+          for (int i = 0; i < batch->num_tasks(); ++i) {
+            batch->mutable_task(i)->split_end_time = split_end_time;
+          }
         }
       });
 }
@@ -1155,6 +1268,10 @@ void BatchResourceBase::ProcessBatch(std::unique_ptr<BatchT> batch) const {
 void BatchResourceBase::ProcessBatchCallBack(
     std::unique_ptr<Batch<BatchTask>> batch,
     std::vector<std::unique_ptr<BatchTask>> unbatched_tasks) {
+  const uint64 dequeue_time = EnvTime::NowNanos();
+  for (int i = 0; i < batch->num_tasks(); ++i) {
+    batch->mutable_task(i)->dequeue_time = dequeue_time;
+  }
   if (!session_metadata().name().empty()) {
     absl::MutexLock lock(&outstanding_batch_mu_);
     num_outstanding_batched_items_ -= batch->size();
@@ -1180,8 +1297,30 @@ Status BatchResourceBase::LookupOrCreateBatcherQueue(const string& queue_name,
 
   std::unique_ptr<BatcherQueueT> new_queue;
   if (batcher_) {
+    BatcherT::QueueOptions queue_options = batcher_queue_options_;
+    auto& adaptive_options = queue_options.adaptive_batching_options;
+    if (adaptive_options.enabled) {
+      adaptive_batch_timeout_micros_.store(
+          adaptive_options.max_batch_timeout_micros < 0
+              ? queue_options.batch_timeout_micros
+              : adaptive_options.max_batch_timeout_micros,
+          std::memory_order_relaxed);
+      adaptive_target_batch_size_.store(queue_options.max_execution_batch_size,
+                                        std::memory_order_relaxed);
+      adaptive_options.decision_callback =
+          [this, user_callback = adaptive_options.decision_callback](
+              int64_t batch_timeout_micros, size_t target_batch_size) {
+            adaptive_batch_timeout_micros_.store(batch_timeout_micros,
+                                                 std::memory_order_relaxed);
+            adaptive_target_batch_size_.store(target_batch_size,
+                                              std::memory_order_relaxed);
+            if (user_callback) {
+              user_callback(batch_timeout_micros, target_batch_size);
+            }
+          };
+    }
     TF_RETURN_IF_ERROR(batcher_->AddQueue(
-        batcher_queue_options_,
+        queue_options,
         absl::bind_front(&BatchResourceBase::ProcessBatchCallBack, this),
         &new_queue));
   } else if (adaptive_batcher_) {
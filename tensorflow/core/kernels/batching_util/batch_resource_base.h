@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_RESOURCE_BASE_H_
 #define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_RESOURCE_BASE_H_
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <map>
@@ -111,6 +112,16 @@ class BatchResourceBase : public ResourceBase {
 
     uint64 start_time;
 
+    // The times (from EnvTime::NowNanos()) at which a batch thread dequeued the
+    // batch holding this task, at which the batched computation started and
+    // finished, and at which the outputs were split out to this task. Zero
+    // until the task reaches that stage. Together with `start_time` they break
+    // down the latency of the task.
+    uint64 dequeue_time = 0;
+    uint64 execution_start_time = 0;
+    uint64 execution_end_time = 0;
+    uint64 split_end_time = 0;
+
     size_t size() const override { return inputs[0].shape().dim_size(0); }
 
     // Create a split task from this one. The caller needs to setup the inputs
@@ -183,6 +194,14 @@ class BatchResourceBase : public ResourceBase {
 
   const SessionMetadata& session_metadata() const { return session_metadata_; }
 
+  // If true, the outputs of a batch are returned to each task as
+  // `Tensor::Slice` views of the batched output tensors instead of copies,
+  // whenever the views are suitably aligned. The views keep the whole batched
+  // output tensor alive until every task has released its outputs.
+  void set_zero_copy_batch_outputs(bool zero_copy_batch_outputs) {
+    zero_copy_batch_outputs_ = zero_copy_batch_outputs;
+  }
+
   using CreateBatchTaskFn =
       std::function<StatusOr<std::unique_ptr<BatchTask>>()>;
 
@@ -270,6 +289,14 @@ class BatchResourceBase : public ResourceBase {
           batch_cost_measurements,
       int64_t processed_size, BatchT& batch);
 
+  // Splits `tensor` along its 0th dimension into views of sizes `sizes` that
+  // share its buffer, and appends them to `slices`. Returns false and leaves
+  // `slices` unchanged if any view would not be aligned, in which case the
+  // caller has to copy.
+  static bool SplitIntoAlignedSlices(const Tensor& tensor,
+                                     absl::Span<const int64_t> sizes,
+                                     std::vector<Tensor>* slices);
+
  private:
   // Implementation of calling the process batch function.
   virtual void ProcessFuncBatchImpl(
@@ -352,6 +379,12 @@ class BatchResourceBase : public ResourceBase {
   std::shared_ptr<AdaptiveBatcherT> adaptive_batcher_;
   AdaptiveBatcherT::QueueOptions adaptive_batcher_queue_options_;
 
+  // The latest decisions of the adaptive batching controllers of the batcher
+  // queues, reported through the batching parameter metrics. Used iff
+  // `batcher_queue_options_.adaptive_batching_options` is enabled.
+  std::atomic<int64_t> adaptive_batch_timeout_micros_{0};
+  std::atomic<int64_t> adaptive_target_batch_size_{0};
+
   // A collection of batcher queues, keyed on queue name.
   // TODO(olston): Garbage-collect unused queues (perhaps simply remove empty
   // ones (with a time delay?); it's okay if they get recreated later).
@@ -363,6 +396,9 @@ class BatchResourceBase : public ResourceBase {
   // A concatenated string of <allowed_batch_sizes_>, separated by ",". This is
   // used to record batching parameter.
   string allowed_batch_sizes_str_;
+
+  // See set_zero_copy_batch_outputs().
+  bool zero_copy_batch_outputs_ = false;
 };
 
 }  // namespace serving
@@ -294,6 +294,42 @@ TEST(SplitBatchCostsAndRecordMetricsTest, SplitOnlyNonZeroCostTypes) {
           UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100))))));
 }
 
+TEST(SplitIntoAlignedSlicesTest, AlignedRowsShareBuffer) {
+  // 64-byte rows keep every slice aligned.
+  Tensor tensor(DT_FLOAT, TensorShape({8, 16}));
+  std::vector<Tensor> slices;
+  ASSERT_TRUE(
+      BatchResourceBase::SplitIntoAlignedSlices(tensor, {2, 6}, &slices));
+  ASSERT_EQ(slices.size(), 2);
+  EXPECT_EQ(slices[0].shape(), TensorShape({2, 16}));
+  EXPECT_EQ(slices[1].shape(), TensorShape({6, 16}));
+  EXPECT_TRUE(slices[0].SharesBufferWith(tensor));
+  EXPECT_TRUE(slices[1].SharesBufferWith(tensor));
+  EXPECT_EQ(slices[1].tensor_data().data(),
+            tensor.tensor_data().data() + 2 * 16 * sizeof(float));
+}
+
+TEST(SplitIntoAlignedSlicesTest, RejectsMismatchedSizes) {
+  Tensor tensor(DT_FLOAT, TensorShape({8, 16}));
+  std::vector<Tensor> slices;
+  EXPECT_FALSE(
+      BatchResourceBase::SplitIntoAlignedSlices(tensor, {2, 5}, &slices));
+  EXPECT_FALSE(
+      BatchResourceBase::SplitIntoAlignedSlices(tensor, {2, 7}, &slices));
+  EXPECT_TRUE(slices.empty());
+}
+
+#if EIGEN_MAX_ALIGN_BYTES > 0
+TEST(SplitIntoAlignedSlicesTest, RejectsMisalignedSlices) {
+  // The second slice starts 12 bytes into the buffer.
+  Tensor tensor(DT_FLOAT, TensorShape({5, 3}));
+  std::vector<Tensor> slices;
+  EXPECT_FALSE(
+      BatchResourceBase::SplitIntoAlignedSlices(tensor, {1, 4}, &slices));
+  EXPECT_TRUE(slices.empty());
+}
+#endif  // EIGEN_MAX_ALIGN_BYTES > 0
+
 }  // namespace
 }  // namespace serving
 }  // namespace tensorflow
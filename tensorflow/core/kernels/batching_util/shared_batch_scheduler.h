@@ -18,13 +18,16 @@ limitations under the License.
 
 #include <stddef.h>
 
+#include <algorithm>
 #include <atomic>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <deque>
 #include <functional>
 #include <list>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -142,6 +145,22 @@ class SharedBatchScheduler
     // The environment to use.
     // (Typically only overridden by test code.)
     Env* env = Env::Default();
+
+    // If true, a batch thread that is ready for work takes the schedulable
+    // batch with the earliest deadline across all queues, instead of serving
+    // the queues round-robin. The deadline of a batch is the time its oldest
+    // task was enqueued plus the latency objective of the task's priority
+    // (see `QueueOptions::latency_slo_micros`).
+    bool enable_earliest_deadline_first = false;
+
+    // The number of batch threads that batches formed only from low priority
+    // tasks may not use. Such batches are deferred while fewer than this many
+    // batch threads are idle, which keeps threads available for high priority
+    // batches during bursts of low priority traffic.
+    //
+    // Used iff `enable_earliest_deadline_first` is true. Must be in
+    // [0, num_batch_threads).
+    int num_batch_threads_reserved_for_high_priority = 0;
   };
   // Ownership is shared between the caller of Create() and any queues created
   // via AddQueue().
@@ -257,7 +276,15 @@ class SharedBatchScheduler
       size_t max_enqueued_batches = 0;
       // See QueueOptions.allowed_batch_sizes
       std::vector<int32> allowed_batch_sizes;
+      // See QueueOptions.latency_slo_micros
+      int64_t latency_slo_micros = 0;
     };
+    // The latency objective of a task in this queue, in microseconds. Used as
+    // the deadline of a batch relative to its oldest task when
+    // `Options::enable_earliest_deadline_first` is true. Zero means
+    // `batch_timeout_micros`.
+    int64_t latency_slo_micros = 0;
+
     // A subset of queue options for high priority input. These options are
     // currently not being used in favor of the equivalents options at the
     // QueueOptions level.
@@ -269,6 +296,54 @@ class SharedBatchScheduler
     // effective only when enable_priority_queue is true.
     MixedPriorityBatchingPolicy mixed_priority_batching_policy =
         MixedPriorityBatchingPolicy::kLowPriorityPaddingWithMaxBatchSize;
+
+    // If true, Schedule() rejects low priority tasks with an UNAVAILABLE error
+    // while the oldest enqueued low priority task has already waited longer
+    // than `low_priority_queue_options.latency_slo_micros`, rather than
+    // admitting more work that can't meet its objective. Effective only when
+    // enable_priority_queue is true and that objective is positive.
+    bool shed_overdue_low_priority_tasks = false;
+
+    // Options of an opt-in controller that adapts when the open batch is
+    // scheduled to the observed load, for traffic whose rate varies too much
+    // for a single static `batch_timeout_micros`.
+    //
+    // The controller tracks moving averages of the task arrival rate and of
+    // the batch processing latency. The effective batch timeout is the part of
+    // `target_latency_micros` that is left after processing a batch, and the
+    // open batch becomes schedulable as soon as it holds as many elements as
+    // are expected to arrive within that timeout. At low arrival rates this
+    // schedules tasks without waiting for a batch that would not fill.
+    struct AdaptiveBatchingOptions {
+      // If false, batches are scheduled according to `batch_timeout_micros`
+      // and the maximum execution batch size, and the fields below are
+      // ignored.
+      bool enabled = false;
+
+      // The target for the time a task spends in the queue plus the time to
+      // process its batch, in microseconds. Must be positive.
+      int64_t target_latency_micros = 0;
+
+      // The bounds of the effective batch timeout. A negative
+      // `max_batch_timeout_micros` means `batch_timeout_micros`.
+      int64_t min_batch_timeout_micros = 0;
+      int64_t max_batch_timeout_micros = -1;
+
+      // The lower bound of the batch size at which the open batch becomes
+      // schedulable. The upper bound is the maximum execution batch size.
+      size_t min_target_batch_size = 1;
+
+      // The weight of a new sample in the moving averages. Must be in (0, 1].
+      double smoothing_factor = 0.1;
+
+      // If set, called with the effective batch timeout and target batch size
+      // whenever the controller changes either of them. Called on a batch
+      // thread, without holding any locks of the scheduler.
+      std::function<void(int64_t batch_timeout_micros,
+                         size_t target_batch_size)>
+          decision_callback;
+    };
+    AdaptiveBatchingOptions adaptive_batching_options;
   };
   Status AddQueue(const QueueOptions& options,
                   ProcessBatchCallback process_batch_callback,
@@ -281,6 +356,13 @@ class SharedBatchScheduler
                               BatchUniquePtr* batch_to_process_out)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // A variant of `GetNextWorkItem_Locked`, used iff
+  // `options_.enable_earliest_deadline_first` is true. Takes the batch with
+  // the earliest deadline across all queues.
+  void GetNextWorkItemByDeadline_Locked(
+      internal::Queue<TaskType>** queue_for_batch_out,
+      BatchUniquePtr* batch_to_process_out) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // The code executed in 'batch_threads_'. Obtains a batch to process from the
   // queue pointed to by 'next_queue_to_schedule_', and processes it. If that
   // queue declines to provide a batch to process, moves onto the next queue. If
@@ -316,6 +398,10 @@ class SharedBatchScheduler
   // whenever a batch becomes schedulable.
   condition_variable schedulable_batch_cv_;
 
+  // The number of batch threads that are processing a batch. Maintained iff
+  // `options_.enable_earliest_deadline_first` is true.
+  int num_busy_batch_threads_ TF_GUARDED_BY(mu_) = 0;
+
   // Threads that process batches obtained from the queues.
   std::vector<std::unique_ptr<PeriodicFunction>> batch_threads_;
 
@@ -404,11 +490,22 @@ class Queue {
   // this queue. Either returns a batch that is ready to be processed, or
   // nullptr if the queue declines to schedule a batch at this time. If it
   // returns a batch, the batch is guaranteed to be closed.
-  typename SharedBatchScheduler<TaskType>::BatchUniquePtr ScheduleBatch();
+  //
+  // If `allow_low_priority_batch` is false, batches formed only from low
+  // priority tasks are not scheduled.
+  typename SharedBatchScheduler<TaskType>::BatchUniquePtr ScheduleBatch(
+      bool allow_low_priority_batch = true);
 
   // A variant of `ScheduleBatch`.
   // Batches are guaranteed to form at task enqueue time.
-  std::unique_ptr<Batch<TaskType>> ScheduleBatchWithEagerSplit();
+  std::unique_ptr<Batch<TaskType>> ScheduleBatchWithEagerSplit(
+      bool allow_low_priority_batch = true);
+
+  // Returns the deadline of the batch that ScheduleBatch() with the same
+  // argument would return at the present time, or nullopt if it would not
+  // return a batch. See `QueueOptions::latency_slo_micros`.
+  std::optional<uint64> NextBatchDeadlineMicros(
+      bool allow_low_priority_batch) const;
 
   // Retrieves the low priority tasks that can be padded to a high priority
   // batch of the specified size.
@@ -448,6 +545,20 @@ class Queue {
   // Same as IsEmpty(), but assumes the caller already holds a lock on 'mu_'.
   bool IsEmptyInternal() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Returns the upper bound of the effective batch timeout of the adaptive
+  // batching controller.
+  int64_t MaxAdaptiveBatchTimeoutMicros() const;
+
+  // Updates the arrival statistics of the adaptive batching controller with a
+  // task of `task_size` that was enqueued just now.
+  void RecordTaskArrival(size_t task_size) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Updates the latency statistics of the adaptive batching controller with a
+  // batch that took `latency_micros` to process, and recomputes the effective
+  // batch timeout and target batch size. Returns true if either changed.
+  bool RecordBatchProcessingLatency(int64_t latency_micros)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // Returns true iff the task is a low priority task based on the queue option.
   bool IsLowPriorityTask(std::unique_ptr<TaskType>* task);
 
@@ -477,8 +588,12 @@ class Queue {
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // Determines whether the low priority tasks in `low_priority_tasks_` can form
-  // a batch on their own. If yes, returns a batch that is ready to be
-  // processed. Otherwise, returns an empty unique_ptr.
+  // a batch on their own.
+  bool IsLowPriorityBatchSchedulable() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // If `IsLowPriorityBatchSchedulable()`, returns a batch of low priority
+  // tasks that is ready to be processed. Otherwise, returns an empty
+  // unique_ptr.
   std::unique_ptr<Batch<TaskType>> ScheduleLowPriorityBatch()
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
@@ -497,7 +612,8 @@ class Queue {
   // tasks are not batched until they get scheduled, it only checks that a
   // single task does not it exceed input batch size limit and the total size of
   // the tasks in the queue does not exceed the max batch size * max enqueued
-  // batch sizes.
+  // batch sizes. Also sheds the task if `shed_overdue_low_priority_tasks` is
+  // set and the low priority queue is behind its latency objective.
   Status ValidateLowPriorityTaskQueueCapacity(const TaskType& task) const
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
@@ -590,10 +706,27 @@ class Queue {
   // task.
   uint64 open_batch_start_time_micros_ TF_GUARDED_BY(mu_);
 
+  // The times at which the first task was added to each of the closed batches
+  // in 'high_priority_batches_' (or 'task_handle_batches_'), front to back.
+  std::deque<uint64> closed_batch_start_times_micros_ TF_GUARDED_BY(mu_);
+
   // Whether this queue contains a batch that is eligible to be scheduled.
   // Used to keep track of when to call 'schedulable_batch_callback_'.
   bool schedulable_batch_ TF_GUARDED_BY(mu_) = false;
 
+  // The timeout and size at which the open batch becomes schedulable. These
+  // are `batch_timeout_micros` and `max_execution_batch_size()` unless the
+  // adaptive batching controller is enabled.
+  int64_t effective_batch_timeout_micros_ TF_GUARDED_BY(mu_);
+  size_t effective_target_batch_size_ TF_GUARDED_BY(mu_);
+
+  // Moving averages of the adaptive batching controller. Negative until the
+  // first sample.
+  double mean_arrival_interval_micros_ TF_GUARDED_BY(mu_) = -1;
+  double mean_task_size_ TF_GUARDED_BY(mu_) = -1;
+  double mean_processing_latency_micros_ TF_GUARDED_BY(mu_) = -1;
+  uint64 last_arrival_time_micros_ TF_GUARDED_BY(mu_) = 0;
+
   // The number of batches currently being processed by batch threads.
   // Incremented in ScheduleBatch() and decremented in ProcessBatch().
   int num_batches_being_processed_ TF_GUARDED_BY(mu_) = 0;
@@ -646,6 +779,15 @@ Status SharedBatchScheduler<TaskType>::Create(
     return errors::InvalidArgument("num_batch_threads must be positive; was ",
                                    options.num_batch_threads);
   }
+  if (options.enable_earliest_deadline_first &&
+      (options.num_batch_threads_reserved_for_high_priority < 0 ||
+       options.num_batch_threads_reserved_for_high_priority >=
+           options.num_batch_threads)) {
+    return errors::InvalidArgument(
+        "num_batch_threads_reserved_for_high_priority must be in [0, ",
+        options.num_batch_threads, "); was ",
+        options.num_batch_threads_reserved_for_high_priority);
+  }
   scheduler->reset(new SharedBatchScheduler<TaskType>(options));
   return absl::OkStatus();
 }
@@ -707,6 +849,14 @@ Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
         "max_enqueued_batches must be positive; was ",
         options.max_enqueued_batches);
   }
+  if (options.latency_slo_micros < 0 ||
+      options.low_priority_queue_options.latency_slo_micros < 0) {
+    return errors::InvalidArgument(
+        "latency_slo_micros must be non-negative; was ",
+        options.latency_slo_micros, " and ",
+        options.low_priority_queue_options.latency_slo_micros,
+        " for low priority tasks");
+  }
 
   if (options.enable_large_batch_splitting &&
       options.split_input_task_func == nullptr) {
@@ -732,6 +882,37 @@ Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
         options.max_execution_batch_size);
   }
 
+  const auto& adaptive_options = options.adaptive_batching_options;
+  if (adaptive_options.enabled) {
+    if (adaptive_options.target_latency_micros <= 0) {
+      return errors::InvalidArgument(
+          "adaptive_batching_options.target_latency_micros must be positive; "
+          "was ",
+          adaptive_options.target_latency_micros);
+    }
+    const int64_t max_batch_timeout_micros =
+        adaptive_options.max_batch_timeout_micros < 0
+            ? options.batch_timeout_micros
+            : adaptive_options.max_batch_timeout_micros;
+    if (adaptive_options.min_batch_timeout_micros < 0 ||
+        adaptive_options.min_batch_timeout_micros > max_batch_timeout_micros) {
+      return errors::InvalidArgument(
+          "adaptive_batching_options.min_batch_timeout_micros must be in [0, ",
+          max_batch_timeout_micros, "]; was ",
+          adaptive_options.min_batch_timeout_micros);
+    }
+    if (adaptive_options.min_target_batch_size == 0) {
+      return errors::InvalidArgument(
+          "adaptive_batching_options.min_target_batch_size must be positive");
+    }
+    if (!(adaptive_options.smoothing_factor > 0 &&
+          adaptive_options.smoothing_factor <= 1)) {
+      return errors::InvalidArgument(
+          "adaptive_batching_options.smoothing_factor must be in (0, 1]; was ",
+          adaptive_options.smoothing_factor);
+    }
+  }
+
   auto schedulable_batch_callback = [this] {
     mutex_lock l(mu_);
     schedulable_batch_cv_.notify_one();
@@ -782,6 +963,11 @@ template <typename TaskType>
 void SharedBatchScheduler<TaskType>::GetNextWorkItem_Locked(
     internal::Queue<TaskType>** queue_for_batch_out,
     BatchUniquePtr* batch_to_process_out) {
+  if (options_.enable_earliest_deadline_first) {
+    GetNextWorkItemByDeadline_Locked(queue_for_batch_out,
+                                     batch_to_process_out);
+    return;
+  }
   BatchUniquePtr batch_to_process;
   internal::Queue<TaskType>* queue_for_batch = nullptr;
   const int num_queues = queues_.size();
@@ -821,6 +1007,57 @@ void SharedBatchScheduler<TaskType>::GetNextWorkItem_Locked(
   *batch_to_process_out = std::move(batch_to_process);
 }
 
+template <typename TaskType>
+void SharedBatchScheduler<TaskType>::GetNextWorkItemByDeadline_Locked(
+    internal::Queue<TaskType>** queue_for_batch_out,
+    BatchUniquePtr* batch_to_process_out) {
+  // The calling thread is idle, so at least one batch thread is.
+  const int num_idle_batch_threads =
+      options_.num_batch_threads - num_busy_batch_threads_;
+  const bool allow_low_priority_batch =
+      num_idle_batch_threads >
+      options_.num_batch_threads_reserved_for_high_priority;
+
+  typename QueueList::iterator earliest_queue = queues_.end();
+  uint64 earliest_deadline_micros = 0;
+  for (auto it = queues_.begin(); it != queues_.end();) {
+    // See GetNextWorkItem_Locked() for why closedness is checked first.
+    const bool queue_closed = (*it)->closed();
+    const std::optional<uint64> deadline_micros =
+        (*it)->NextBatchDeadlineMicros(allow_low_priority_batch);
+    if (deadline_micros.has_value()) {
+      if (earliest_queue == queues_.end() ||
+          *deadline_micros < earliest_deadline_micros) {
+        earliest_queue = it;
+        earliest_deadline_micros = *deadline_micros;
+      }
+      ++it;
+    } else if (queue_closed && (*it)->IsEmpty()) {
+      // We've encountered a closed queue with no work to do. Drop it.
+      const bool is_next_queue_to_schedule = (it == next_queue_to_schedule_);
+      it = queues_.erase(it);
+      if (is_next_queue_to_schedule) next_queue_to_schedule_ = it;
+    } else {
+      ++it;
+    }
+  }
+  if (next_queue_to_schedule_ == queues_.end() && !queues_.empty()) {
+    next_queue_to_schedule_ = queues_.begin();
+  }
+
+  *queue_for_batch_out = nullptr;
+  *batch_to_process_out = BatchUniquePtr();
+  if (earliest_queue == queues_.end()) return;
+  // Batches are only taken from queues while holding `mu_`, so the batch whose
+  // deadline was computed above is still there.
+  BatchUniquePtr batch_to_process =
+      (*earliest_queue)->ScheduleBatch(allow_low_priority_batch);
+  if (BatchExists(batch_to_process)) {
+    *queue_for_batch_out = earliest_queue->get();
+    *batch_to_process_out = std::move(batch_to_process);
+  }
+}
+
 template <typename TaskType>
 void SharedBatchScheduler<TaskType>::ThreadLogic() {
   // A batch to process next (or nullptr if no work to do).
@@ -831,7 +1068,10 @@ void SharedBatchScheduler<TaskType>::ThreadLogic() {
     mutex_lock l(mu_);
     while (true) {
       GetNextWorkItem_Locked(&queue_for_batch, &batch_to_process);
-      if (BatchExists(batch_to_process)) break;
+      if (BatchExists(batch_to_process)) {
+        if (options_.enable_earliest_deadline_first) ++num_busy_batch_threads_;
+        break;
+      }
       // We couldn't find any work to do. Wait until a new batch becomes
       // schedulable, or some time has elapsed, before checking again.
       const int64_t kTimeoutMillis =
@@ -869,6 +1109,11 @@ void SharedBatchScheduler<TaskType>::ThreadLogic() {
   queue_for_batch->ProcessBatch(
       std::move(batch_to_schedule),
       queue_for_batch->GetLowPriorityTasksForPadding(batch_size_to_schedule));
+
+  if (options_.enable_earliest_deadline_first) {
+    mutex_lock l(mu_);
+    --num_busy_batch_threads_;
+  }
 }
 
 namespace internal {
@@ -883,6 +1128,14 @@ Queue<TaskType>::Queue(
       max_execution_batch_size_(GetMaxExecutionBatchSize(options_)),
       process_batch_callback_(process_batch_callback),
       schedulable_batch_callback_(schedulable_batch_callback) {
+  if (options_.adaptive_batching_options.enabled) {
+    // Behave like a static queue with the longest allowed timeout until the
+    // first batch has been processed.
+    effective_batch_timeout_micros_ = MaxAdaptiveBatchTimeoutMicros();
+  } else {
+    effective_batch_timeout_micros_ = options_.batch_timeout_micros;
+  }
+  effective_target_batch_size_ = max_execution_batch_size_;
   // Set the higher 32 bits of traceme_context_id_counter_ to be the creation
   // time of the queue. This prevents the batches in different queues to have
   // the same traceme_context_id_counter_.
@@ -938,6 +1191,7 @@ Status Queue<TaskType>::ScheduleWithLazySplit(std::unique_ptr<TaskType>* task) {
 
     const int64 open_batch_capacity =
         max_execution_batch_size - this->tail_batch_task_size();
+    const size_t task_size = (*task)->size();
 
     auto input_batch = std::make_shared<BatchInputTask<TaskType>>(
         std::move(*task), open_batch_capacity, max_execution_batch_size,
@@ -965,6 +1219,10 @@ Status Queue<TaskType>::ScheduleWithLazySplit(std::unique_ptr<TaskType>* task) {
       task_handle_batches_.back()->AddTask(std::move(task_handles[i]));
     }
 
+    if (options_.adaptive_batching_options.enabled) {
+      RecordTaskArrival(task_size);
+    }
+
     if (!schedulable_batch_) {
       if (GetBatches().size() > 1 || IsOpenBatchSchedulable()) {
         schedulable_batch_ = true;
@@ -1074,7 +1332,11 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplit(
       TF_RETURN_IF_ERROR(ValidateLowPriorityTaskQueueCapacity(**task));
       low_priority_tasks_.AddTask(std::move(*task), env_->NowMicros());
     } else {
+      const size_t task_size = (*task)->size();
       TF_RETURN_IF_ERROR(ScheduleWithoutOrEagerSplitImpl(task));
+      if (options_.adaptive_batching_options.enabled) {
+        RecordTaskArrival(task_size);
+      }
     }
 
     // Check if the batch queue has a schedulable batch and mark it schedulable
@@ -1207,12 +1469,26 @@ Status Queue<TaskType>::ValidateLowPriorityTaskQueueCapacity(
         options_.low_priority_queue_options.max_enqueued_batches,
         options_.low_priority_queue_options.max_execution_batch_size));
   }
+  const int64_t latency_slo_micros =
+      options_.low_priority_queue_options.latency_slo_micros;
+  if (options_.shed_overdue_low_priority_tasks && latency_slo_micros > 0 &&
+      !low_priority_tasks_.empty()) {
+    const uint64 oldest_task_wait_micros =
+        env_->NowMicros() - *low_priority_tasks_.EarliestTaskStartTime();
+    if (oldest_task_wait_micros > latency_slo_micros) {
+      return absl::UnavailableError(absl::StrFormat(
+          "The low priority task queue to which this task was submitted is "
+          "overloaded; its oldest task has waited %d microseconds while "
+          "latency_slo_micros=%d",
+          oldest_task_wait_micros, latency_slo_micros));
+    }
+  }
   return absl::OkStatus();
 }
 
 template <typename TaskType>
-std::unique_ptr<Batch<TaskType>>
-Queue<TaskType>::ScheduleBatchWithEagerSplit() {
+std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleBatchWithEagerSplit(
+    bool allow_low_priority_batch) {
   // The batch to schedule, which we may populate below. (If left as nullptr,
   // that means we are electing not to schedule a batch at this time.)
   std::unique_ptr<Batch<TaskType>> batch_to_schedule;
@@ -1230,9 +1506,10 @@ Queue<TaskType>::ScheduleBatchWithEagerSplit() {
       // There is at least one closed batch that is ready to be scheduled.
       batch_to_schedule = std::move(batches.front());
       batches.pop_front();
+      closed_batch_start_times_micros_.pop_front();
     }
 
-    if (batch_to_schedule == nullptr) {
+    if (batch_to_schedule == nullptr && allow_low_priority_batch) {
       // If there was no schedulable batch in the batch queue, try to schedule
       // from the low priority task queue.
       batch_to_schedule = ScheduleLowPriorityBatch();
@@ -1253,9 +1530,9 @@ Queue<TaskType>::ScheduleBatchWithEagerSplit() {
 
 template <typename TaskType>
 typename SharedBatchScheduler<TaskType>::BatchUniquePtr
-Queue<TaskType>::ScheduleBatch() {
+Queue<TaskType>::ScheduleBatch(bool allow_low_priority_batch) {
   if (!options_.enable_lazy_split) {
-    return ScheduleBatchWithEagerSplit();
+    return ScheduleBatchWithEagerSplit(allow_low_priority_batch);
   }
   // The batch to schedule, which we may populate below. (If left as nullptr,
   // that means we are electing not to schedule a batch at this time.)
@@ -1275,6 +1552,7 @@ Queue<TaskType>::ScheduleBatch() {
       ++num_batches_being_processed_;
       task_handles_to_schedule = std::move(task_handle_batches_.front());
       task_handle_batches_.pop_front();
+      closed_batch_start_times_micros_.pop_front();
     } else {
       schedulable_batch_ = false;
     }
@@ -1335,6 +1613,7 @@ void Queue<TaskType>::ProcessBatch(
       tsl::profiler::ContextType::kSharedBatchScheduler,
       batch->traceme_context_id());
 
+  const uint64 start_time_micros = env_->NowMicros();
   if (std::holds_alternative<ProcessBatchCallbackWithoutPaddingTasks>(
           process_batch_callback_)) {
     std::get<ProcessBatchCallbackWithoutPaddingTasks>(process_batch_callback_)(
@@ -1344,13 +1623,27 @@ void Queue<TaskType>::ProcessBatch(
         std::move(batch), std::move(padding_task));
   }
 
+  // Copied under `mu_`, since the queue may be destroyed as soon as it is
+  // released.
+  std::function<void(int64_t, size_t)> decision_callback;
+  int64_t batch_timeout_micros = 0;
+  size_t target_batch_size = 0;
   {
     mutex_lock l(mu_);
     --num_batches_being_processed_;
+    if (options_.adaptive_batching_options.enabled &&
+        RecordBatchProcessingLatency(env_->NowMicros() - start_time_micros)) {
+      decision_callback = options_.adaptive_batching_options.decision_callback;
+      batch_timeout_micros = effective_batch_timeout_micros_;
+      target_batch_size = effective_target_batch_size_;
+    }
     if (empty_notification_ != nullptr && IsEmptyInternal()) {
       empty_notification_->Notify();
     }
   }
+  if (decision_callback) {
+    decision_callback(batch_timeout_micros, target_batch_size);
+  }
 }
 
 template <typename TaskType>
@@ -1387,8 +1680,77 @@ bool Queue<TaskType>::IsEmptyInternal() const {
          batches.back()->empty() && low_priority_tasks_.empty();
 }
 
+template <typename TaskType>
+int64_t Queue<TaskType>::MaxAdaptiveBatchTimeoutMicros() const {
+  const auto& adaptive_options = options_.adaptive_batching_options;
+  return adaptive_options.max_batch_timeout_micros < 0
+             ? options_.batch_timeout_micros
+             : adaptive_options.max_batch_timeout_micros;
+}
+
+template <typename TaskType>
+void Queue<TaskType>::RecordTaskArrival(size_t task_size) {
+  const double alpha = options_.adaptive_batching_options.smoothing_factor;
+  const uint64 now_micros = env_->NowMicros();
+  if (mean_task_size_ < 0) {
+    mean_task_size_ = task_size;
+  } else {
+    const double interval_micros = now_micros - last_arrival_time_micros_;
+    mean_arrival_interval_micros_ =
+        mean_arrival_interval_micros_ < 0
+            ? interval_micros
+            : alpha * interval_micros +
+                  (1 - alpha) * mean_arrival_interval_micros_;
+    mean_task_size_ = alpha * task_size + (1 - alpha) * mean_task_size_;
+  }
+  last_arrival_time_micros_ = now_micros;
+}
+
+template <typename TaskType>
+bool Queue<TaskType>::RecordBatchProcessingLatency(int64_t latency_micros) {
+  const auto& adaptive_options = options_.adaptive_batching_options;
+  const double alpha = adaptive_options.smoothing_factor;
+  mean_processing_latency_micros_ =
+      mean_processing_latency_micros_ < 0
+          ? latency_micros
+          : alpha * latency_micros +
+                (1 - alpha) * mean_processing_latency_micros_;
+
+  // Spend what the latency target leaves after processing on waiting for more
+  // tasks to join the batch.
+  const int64_t batch_timeout_micros = std::clamp<int64_t>(
+      adaptive_options.target_latency_micros -
+          static_cast<int64_t>(mean_processing_latency_micros_),
+      adaptive_options.min_batch_timeout_micros,
+      MaxAdaptiveBatchTimeoutMicros());
+
+  // Once the open batch holds as many elements as are expected to arrive
+  // within the timeout, waiting for the rest of the timeout mostly adds
+  // latency. Without a measurable arrival interval, assume a high rate.
+  const size_t max_batch_size = max_execution_batch_size();
+  const size_t min_batch_size =
+      std::min(adaptive_options.min_target_batch_size, max_batch_size);
+  size_t target_batch_size = max_batch_size;
+  if (mean_arrival_interval_micros_ > 0) {
+    const double expected_batch_size = mean_task_size_ * batch_timeout_micros /
+                                       mean_arrival_interval_micros_;
+    target_batch_size = static_cast<size_t>(
+        std::clamp(std::ceil(expected_batch_size),
+                   static_cast<double>(min_batch_size),
+                   static_cast<double>(max_batch_size)));
+  }
+
+  const bool changed =
+      batch_timeout_micros != effective_batch_timeout_micros_ ||
+      target_batch_size != effective_target_batch_size_;
+  effective_batch_timeout_micros_ = batch_timeout_micros;
+  effective_target_batch_size_ = target_batch_size;
+  return changed;
+}
+
 template <typename TaskType>
 void Queue<TaskType>::StartNewBatch() {
+  closed_batch_start_times_micros_.push_back(open_batch_start_time_micros_);
   if (options_.enable_lazy_split) {
     task_handle_batches_.back()->Close();
     task_handle_batches_.emplace_back(new Batch<BatchInputTaskHandle<TaskType>>(
@@ -1417,9 +1779,9 @@ bool Queue<TaskType>::IsOpenBatchSchedulableAfterEagerSplit() const {
   if (open_batch->empty()) {
     return false;
   }
-  return closed_ || open_batch->size() >= max_execution_batch_size() ||
+  return closed_ || open_batch->size() >= effective_target_batch_size_ ||
          env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+             open_batch_start_time_micros_ + effective_batch_timeout_micros_;
 }
 
 template <typename TaskType>
@@ -1432,30 +1794,34 @@ bool Queue<TaskType>::IsOpenBatchSchedulable() const {
   if (open_batch->empty()) {
     return false;
   }
-  return closed_ || open_batch->size() >= max_execution_batch_size() ||
+  return closed_ || open_batch->size() >= effective_target_batch_size_ ||
          env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+             open_batch_start_time_micros_ + effective_batch_timeout_micros_;
 }
 
 template <typename TaskType>
-std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleLowPriorityBatch() {
-  std::unique_ptr<Batch<TaskType>> batch_to_schedule;
+bool Queue<TaskType>::IsLowPriorityBatchSchedulable() const {
   if (!options_.enable_priority_queue || low_priority_tasks_.empty()) {
-    // Return early if priority queue is disabled or there is no low priority
-    // task.
-    return batch_to_schedule;
+    // Priority queue is disabled or there is no low priority task.
+    return false;
   }
   if (env_->NowMicros() <
           *low_priority_tasks_.EarliestTaskStartTime() +
               options_.low_priority_queue_options.batch_timeout_micros &&
       low_priority_tasks_.size() <
           options_.low_priority_queue_options.max_execution_batch_size) {
-    // Return early if the low priority tasks can't fill up the max batch size
-    // and the earliest task didn't time out.
-    return batch_to_schedule;
+    // The low priority tasks can't fill up the max batch size and the earliest
+    // task didn't time out.
+    return false;
   }
-  if (!GetBatches().empty() && !GetBatches().front()->empty()) {
-    // Return early if there is a non-empty high priority batch in the queue.
+  // There must be no non-empty high priority batch in the queue.
+  return GetBatches().empty() || GetBatches().front()->empty();
+}
+
+template <typename TaskType>
+std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleLowPriorityBatch() {
+  std::unique_ptr<Batch<TaskType>> batch_to_schedule;
+  if (!IsLowPriorityBatchSchedulable()) {
     return batch_to_schedule;
   }
 
@@ -1469,6 +1835,30 @@ std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleLowPriorityBatch() {
   return batch_to_schedule;
 }
 
+template <typename TaskType>
+std::optional<uint64> Queue<TaskType>::NextBatchDeadlineMicros(
+    bool allow_low_priority_batch) const {
+  mutex_lock l(mu_);
+  const int64_t latency_slo_micros = options_.latency_slo_micros > 0
+                                         ? options_.latency_slo_micros
+                                         : options_.batch_timeout_micros;
+  if (num_enqueued_batches() >= 2) {
+    return closed_batch_start_times_micros_.front() + latency_slo_micros;
+  }
+  if (IsOpenBatchSchedulable()) {
+    return open_batch_start_time_micros_ + latency_slo_micros;
+  }
+  if (!options_.enable_lazy_split && allow_low_priority_batch &&
+      IsLowPriorityBatchSchedulable()) {
+    const auto& low_priority_options = options_.low_priority_queue_options;
+    return *low_priority_tasks_.EarliestTaskStartTime() +
+           (low_priority_options.latency_slo_micros > 0
+                ? low_priority_options.latency_slo_micros
+                : low_priority_options.batch_timeout_micros);
+  }
+  return std::nullopt;
+}
+
 template <typename TaskType>
 size_t Queue<TaskType>::tail_batch_task_size() const {
   if (options_.enable_lazy_split) {
@@ -1052,6 +1052,185 @@ TEST_P(SharedBatchSchedulerTest, ZeroQueueRewrittenToOneQueue) {
   }
 }
 
+TEST_P(SharedBatchSchedulerTest, AdaptiveBatchingShrinksTargetAtLowRate) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    mutex mu;
+    int num_batches_processed = 0;
+    auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      EXPECT_EQ(batch->size(), 1);
+      mutex_lock l(mu);
+      ++num_batches_processed;
+    };
+    Notification target_shrunk;
+    auto decision_callback = [&](int64_t batch_timeout_micros,
+                                 size_t target_batch_size) {
+      // Batches are processed instantly on the fake clock, so the whole
+      // latency target is spent on the timeout.
+      EXPECT_EQ(batch_timeout_micros, 1000);
+      if (target_batch_size == 1 && !target_shrunk.HasBeenNotified()) {
+        target_shrunk.Notify();
+      }
+    };
+
+    auto scheduler = CreateSharedBatchScheduler(1, &env);
+    QueueOptions options =
+        CreateQueueOptions(/*max_execution_batch_size=*/10,
+                           /*input_batch_size_limit=*/10,
+                           /*batch_timeout_micros=*/1000,
+                           /*max_enqueued_batches=*/2);
+    options.adaptive_batching_options.enabled = true;
+    options.adaptive_batching_options.target_latency_micros = 1000;
+    options.adaptive_batching_options.smoothing_factor = 1.0;
+    options.adaptive_batching_options.decision_callback = decision_callback;
+    auto queue = CreateQueue(scheduler, options, callback);
+
+    // Tasks arrive once per timeout, so a batch is expected to hold a single
+    // task. Until the controller has observed that, batches wait for the
+    // timeout.
+    for (int i = 0; i < 2; ++i) {
+      TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+      env.AdvanceByMicroseconds(1000);
+      while (true) {
+        {
+          mutex_lock l(mu);
+          if (num_batches_processed == i + 1) break;
+        }
+        Env::Default()->SleepForMicroseconds(1000);
+      }
+    }
+    target_shrunk.WaitForNotification();
+
+    // The next task is scheduled without advancing the clock.
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    while (true) {
+      {
+        mutex_lock l(mu);
+        if (num_batches_processed == 3) break;
+      }
+      Env::Default()->SleepForMicroseconds(1000);
+    }
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+TEST_P(SharedBatchSchedulerTest, InvalidAdaptiveBatchingOptions) {
+  auto callback = [](std::unique_ptr<Batch<FakeTask>> batch) {
+    // do nothing.
+  };
+
+  auto scheduler = CreateSharedBatchScheduler(2);
+
+  QueueOptions options =
+      CreateQueueOptions(/*max_execution_batch_size=*/10,
+                         /*input_batch_size_limit=*/10,
+                         /*batch_timeout_micros=*/1000,
+                         /*max_enqueued_batches=*/2);
+  options.adaptive_batching_options.enabled = true;
+  std::unique_ptr<Queue> queue;
+  EXPECT_THAT(
+      scheduler->AddQueue(options, callback, &queue),
+      testing::StatusIs(error::INVALID_ARGUMENT,
+                        HasSubstr("target_latency_micros")));
+
+  options.adaptive_batching_options.target_latency_micros = 1000;
+  options.adaptive_batching_options.min_batch_timeout_micros = 2000;
+  EXPECT_THAT(
+      scheduler->AddQueue(options, callback, &queue),
+      testing::StatusIs(error::INVALID_ARGUMENT,
+                        HasSubstr("min_batch_timeout_micros")));
+
+  options.adaptive_batching_options.min_batch_timeout_micros = 0;
+  TF_EXPECT_OK(scheduler->AddQueue(options, callback, &queue));
+}
+
+TEST_P(SharedBatchSchedulerTest, EarliestDeadlineFirstAcrossQueues) {
+  test_util::FakeClockEnv env(Env::Default());
+  mutex mu;
+  std::vector<string> processed_queues;
+  Notification processing, proceed;
+  auto make_callback = [&](const string& queue_name) {
+    return [&, queue_name](std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      if (!processing.HasBeenNotified()) {
+        processing.Notify();
+        proceed.WaitForNotification();
+      }
+      mutex_lock l(mu);
+      processed_queues.push_back(queue_name);
+    };
+  };
+
+  {
+    Scheduler::Options options;
+    options.num_batch_threads = 1;
+    options.env = &env;
+    options.enable_earliest_deadline_first = true;
+    std::shared_ptr<Scheduler> scheduler;
+    TF_ASSERT_OK(Scheduler::Create(options, &scheduler));
+
+    QueueOptions relaxed_options =
+        CreateQueueOptions(/*max_execution_batch_size=*/10,
+                           /*input_batch_size_limit=*/10,
+                           /*batch_timeout_micros=*/1000,
+                           /*max_enqueued_batches=*/2);
+    relaxed_options.latency_slo_micros = 10 * 1000 * 1000;
+    QueueOptions strict_options = relaxed_options;
+    strict_options.latency_slo_micros = 1000 * 1000;
+    auto relaxed_queue =
+        CreateQueue(scheduler, relaxed_options, make_callback("relaxed"));
+    auto strict_queue =
+        CreateQueue(scheduler, strict_options, make_callback("strict"));
+
+    // Occupy the only batch thread so that both of the following batches are
+    // pending when it becomes idle. Round-robin would serve the relaxed queue
+    // next.
+    TF_ASSERT_OK(ScheduleTask(10, strict_queue.get()));
+    processing.WaitForNotification();
+    TF_ASSERT_OK(ScheduleTask(10, relaxed_queue.get()));
+    TF_ASSERT_OK(ScheduleTask(10, strict_queue.get()));
+    proceed.Notify();
+  }
+  EXPECT_THAT(processed_queues,
+              testing::ElementsAre("strict", "strict", "relaxed"));
+}
+
+TEST_P(SharedBatchSchedulerTest, InvalidEarliestDeadlineFirstOptions) {
+  Scheduler::Options options;
+  options.num_batch_threads = 2;
+  options.enable_earliest_deadline_first = true;
+  options.num_batch_threads_reserved_for_high_priority = 2;
+  std::shared_ptr<Scheduler> scheduler;
+  EXPECT_THAT(Scheduler::Create(options, &scheduler),
+              testing::StatusIs(
+                  error::INVALID_ARGUMENT,
+                  HasSubstr("num_batch_threads_reserved_for_high_priority")));
+
+  options.num_batch_threads_reserved_for_high_priority = 1;
+  TF_ASSERT_OK(Scheduler::Create(options, &scheduler));
+
+  auto callback = [](std::unique_ptr<Batch<FakeTask>> batch) {
+    // do nothing.
+  };
+  QueueOptions queue_options =
+      CreateQueueOptions(/*max_execution_batch_size=*/10,
+                         /*input_batch_size_limit=*/10,
+                         /*batch_timeout_micros=*/1000,
+                         /*max_enqueued_batches=*/2);
+  queue_options.latency_slo_micros = -1;
+  std::unique_ptr<Queue> queue;
+  EXPECT_THAT(scheduler->AddQueue(queue_options, callback, &queue),
+              testing::StatusIs(error::INVALID_ARGUMENT,
+                                HasSubstr("latency_slo_micros")));
+}
+
 // TODO(b/161857471):
 // Add test coverage when input-split and no-split returns differently.
 INSTANTIATE_TEST_SUITE_P(
@@ -1304,6 +1483,119 @@ TEST_P(SharedBatchSchedulerPriorityTest,
   EXPECT_TRUE(queue_callback_called);
 }
 
+TEST_P(SharedBatchSchedulerPriorityTest,
+       LowPriorityBatchDeferredWhileThreadsAreReserved) {
+  mutex mu;
+  int num_low_priority_batches = 0;
+  Notification processing, proceed;
+  auto queue_callback = [&](std::unique_ptr<Batch<FakeTask>> batch,
+                            std::vector<std::unique_ptr<FakeTask>> tasks) {
+    ASSERT_TRUE(batch->IsClosed());
+    if (batch->task(0).criticality() ==
+        tsl::criticality::Criticality::kSheddable) {
+      mutex_lock l(mu);
+      ++num_low_priority_batches;
+      return;
+    }
+    processing.Notify();
+    proceed.WaitForNotification();
+  };
+
+  {
+    Scheduler::Options options;
+    options.num_batch_threads = 2;
+    options.enable_earliest_deadline_first = true;
+    options.num_batch_threads_reserved_for_high_priority = 1;
+    std::shared_ptr<Scheduler> scheduler;
+    TF_ASSERT_OK(Scheduler::Create(options, &scheduler));
+
+    QueueOptions queue_options = CreateQueueOptions(
+        /*max_execution_batch_size=*/10, /*input_batch_size_limit=*/10,
+        /*batch_timeout_micros=*/1 * 1000 * 1000, /*max_enqueued_batches=*/2,
+        /*enable_priority_queue=*/true);
+    queue_options.low_priority_queue_options.max_execution_batch_size = 10;
+    queue_options.low_priority_queue_options.batch_timeout_micros =
+        1 * 1000 * 1000;
+    queue_options.low_priority_queue_options.input_batch_size_limit = 10;
+    queue_options.low_priority_queue_options.max_enqueued_batches = 2;
+    queue_options.mixed_priority_batching_policy =
+        mixed_priority_batching_policy();
+    std::unique_ptr<Queue> queue =
+        CreateQueue(scheduler, queue_options, queue_callback);
+
+    // Occupy one of the two batch threads with a high priority batch. The
+    // other one is reserved for high priority batches.
+    TF_ASSERT_OK(ScheduleTask(10, queue.get(),
+                              tsl::criticality::Criticality::kCritical));
+    processing.WaitForNotification();
+    TF_ASSERT_OK(ScheduleTask(10, queue.get(),
+                              tsl::criticality::Criticality::kSheddable));
+    Env::Default()->SleepForMicroseconds(50 * 1000);
+    {
+      mutex_lock l(mu);
+      EXPECT_EQ(num_low_priority_batches, 0);
+    }
+    proceed.Notify();
+  }
+  EXPECT_EQ(num_low_priority_batches, 1);
+}
+
+TEST_P(SharedBatchSchedulerPriorityTest, ShedsOverdueLowPriorityTasks) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification processing, proceed;
+  auto queue_callback = [&](std::unique_ptr<Batch<FakeTask>> batch,
+                            std::vector<std::unique_ptr<FakeTask>> tasks) {
+    if (!processing.HasBeenNotified()) {
+      processing.Notify();
+      proceed.WaitForNotification();
+    }
+  };
+
+  {
+    std::shared_ptr<Scheduler> scheduler =
+        CreateSharedBatchScheduler(/*num_batch_threads=*/1, &env);
+
+    QueueOptions queue_options = CreateQueueOptions(
+        /*max_execution_batch_size=*/10, /*input_batch_size_limit=*/10,
+        /*batch_timeout_micros=*/1000, /*max_enqueued_batches=*/2,
+        /*enable_priority_queue=*/true);
+    queue_options.low_priority_queue_options.max_execution_batch_size = 10;
+    queue_options.low_priority_queue_options.batch_timeout_micros =
+        10 * 1000 * 1000;
+    queue_options.low_priority_queue_options.input_batch_size_limit = 10;
+    queue_options.low_priority_queue_options.max_enqueued_batches = 2;
+    queue_options.low_priority_queue_options.latency_slo_micros = 1000;
+    queue_options.mixed_priority_batching_policy =
+        mixed_priority_batching_policy();
+    queue_options.shed_overdue_low_priority_tasks = true;
+    std::unique_ptr<Queue> queue =
+        CreateQueue(scheduler, queue_options, queue_callback);
+
+    TF_ASSERT_OK(ScheduleTask(10, queue.get(),
+                              tsl::criticality::Criticality::kCritical));
+    processing.WaitForNotification();
+
+    TF_ASSERT_OK(ScheduleTask(1, queue.get(),
+                              tsl::criticality::Criticality::kSheddable));
+    env.AdvanceByMicroseconds(500);
+    TF_ASSERT_OK(ScheduleTask(1, queue.get(),
+                              tsl::criticality::Criticality::kSheddable));
+    env.AdvanceByMicroseconds(1000);
+    EXPECT_THAT(
+        ScheduleTask(1, queue.get(),
+                     tsl::criticality::Criticality::kSheddable),
+        testing::StatusIs(absl::StatusCode::kUnavailable,
+                          HasSubstr("latency_slo_micros=1000")));
+    // High priority tasks are still admitted.
+    TF_ASSERT_OK(ScheduleTask(1, queue.get(),
+                              tsl::criticality::Criticality::kCritical));
+
+    // Let the remaining tasks time out, so that the queue can be destroyed.
+    env.AdvanceByMicroseconds(10 * 1000 * 1000);
+    proceed.Notify();
+  }
+}
+
 // Lazy split is to be removed. The mixed priority batching is only supported
 // when the lazy split is not enabled.
 INSTANTIATE_TEST_SUITE_P(
@@ -18,13 +18,20 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <vector>
+
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/kernels/concat_lib.h"
 #include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
+// Inputs whose rows are narrower than this on average are copied in blocks of
+// rows of about kConcatBlockBytes of output.
+constexpr int64_t kConcatNarrowInputBytes = 64;
+constexpr int64_t kConcatBlockBytes = 16 << 10;
+
 // ElementCopier must be a struct with a single Copy function, which is passed
 // the output pointer, input pointer, input index, and number of elements to
 // copy from input to output.
@@ -54,30 +61,45 @@ void ConcatCPUImpl(
   int num_threads = std::min(4, worker_threads->num_threads);
   num_threads = static_cast<int>(
       std::min<int64_t>(num_threads, estimated_total_cost / 16384));
-  // Single threaded mode.
-  // TODO(dga):  Deduplicate this code w.r.t. sharded code below.
-  if (num_threads == 0) {
-    T* out = &(*output)(0, 0);
-    std::vector<const T*> inp;
-    inp.reserve(num_inputs);
-    for (const auto& input : inputs) {
-      inp.push_back(&(*input)(0, 0));
-    }
-    const int64_t dim0 = output->dimension(0);
-    for (int64_t i = 0; i < dim0; ++i) {
-      for (int64_t j = 0; j < num_inputs; ++j) {
-        auto size = sizes[j];
-        copier.Copy(out, inp[j], j, size);
-        out += size;
-        inp[j] += size;
+
+  // When the inputs are narrow, copying them row by row interleaves reads from
+  // all inputs, which defeats the hardware prefetchers. Instead, the rows are
+  // copied in blocks whose output fits in the L1 cache, one input at a time.
+  const int64_t row_bytes = row_size * static_cast<int64_t>(sizeof(T));
+  const bool narrow_inputs =
+      num_inputs > 1 && row_bytes > 0 &&
+      row_bytes < kConcatNarrowInputBytes * static_cast<int64_t>(num_inputs);
+  const int64_t rows_per_block =
+      narrow_inputs ? std::max<int64_t>(1, kConcatBlockBytes / row_bytes) : 1;
+
+  // Copies the full output rows [begin_row, end_row).
+  auto copy_rows = [&](int64_t begin_row, int64_t end_row) {
+    for (int64_t block = begin_row; block < end_row; block += rows_per_block) {
+      const int64_t block_end = std::min(end_row, block + rows_per_block);
+      T* out_block = output->data() + block * row_size;
+      for (size_t j = 0; j < num_inputs; ++j) {
+        const ptrdiff_t size = sizes[j];
+        const T* inp = inputs[j]->data() + block * size;
+        T* out = out_block;
+        for (int64_t i = block; i < block_end; ++i) {
+          copier.Copy(out, inp, j, size);
+          out += row_size;
+          inp += size;
+        }
+        out_block += size;
       }
     }
+  };
+
+  // Single threaded mode.
+  if (num_threads == 0) {
+    copy_rows(0, output->dimension(0));
     return;
   }
 
   // Sharded mode.
-  auto work = [&row_size, &sizes, &inputs, &output, &copier, &num_inputs](
-                  int64_t start, int64_t end) {
+  auto work = [&row_size, &sizes, &inputs, &output, &copier, &num_inputs,
+               &copy_rows](int64_t start, int64_t end) {
     int64_t skipped_rows = start / row_size;
     T* out = output->data() + skipped_rows * row_size;
     T* out_start = output->data() + start;
@@ -109,21 +131,16 @@ void ConcatCPUImpl(
     CHECK(out >= out_start);
     CHECK(out < out_end);
 
-    // Copy remaining data.
-    std::vector<const T*> inp;
-    inp.reserve(num_inputs);
-    for (const auto& input : inputs) {
-      inp.push_back(&(*input)(skipped_rows, 0));
+    // Copy the full rows, then the partial row at the end.
+    const int64_t end_row = end / row_size;
+    if (skipped_rows < end_row) {
+      copy_rows(skipped_rows, end_row);
+      out = output->data() + end_row * row_size;
     }
-    const int64_t dim0 = output->dimension(0);
-    for (int64_t i = skipped_rows; i < dim0; ++i) {
-      for (int64_t j = 0; j < num_inputs; ++j) {
-        ptrdiff_t size = std::min(sizes[j], out_end - out);
-        copier.Copy(out, inp[j], j, size);
-        out += size;
-        inp[j] += size;
-        if (out == out_end) return;
-      }
+    for (size_t j = 0; j < num_inputs && out < out_end; ++j) {
+      ptrdiff_t size = std::min(sizes[j], out_end - out);
+      copier.Copy(out, inputs[j]->data() + end_row * sizes[j], j, size);
+      out += size;
     }
   };
   Shard(worker_threads->num_threads, worker_threads->workers, output->size(),
@@ -192,6 +192,54 @@ void BM_ConcatManyDim1bfloat16(::testing::benchmark::State& state) {
 
 BENCHMARK(BM_ConcatManyDim1bfloat16)->UseRealTime()->Arg(18)->Arg(34)->Arg(60);
 
+// Concats along dimension 1 kNumInputs float inputs with kDim1 rows, every
+// fourth of which has `wide_dim2` columns and the others `narrow_dim2`.
+static void ConcatMixedHelper(::testing::benchmark::State& state,
+                              int narrow_dim2, int wide_dim2) {
+  Graph* g = new Graph(OpRegistry::Global());
+
+  const int kDim1 = 10000;
+  const int kNumInputs = 32;
+  Tensor concat_dim(DT_INT32, TensorShape({}));
+  concat_dim.scalar<int32>()() = 1;
+  std::vector<NodeBuilder::NodeOut> inputs;
+  inputs.reserve(kNumInputs);
+  int64_t row_size = 0;
+  for (int i = 0; i < kNumInputs; ++i) {
+    const int dim2 = i % 4 == 0 ? wide_dim2 : narrow_dim2;
+    Tensor in(DT_FLOAT, TensorShape({kDim1, dim2}));
+    in.flat<float>().setRandom();
+    inputs.push_back(test::graph::Constant(g, in));
+    row_size += dim2;
+  }
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Concat")
+                  .Input(test::graph::Constant(g, concat_dim))
+                  .Input(inputs)
+                  .Attr("N", kNumInputs)
+                  .Attr("T", DT_FLOAT)
+                  .Finalize(g, &node));
+  test::Benchmark("cpu", g, /*old_benchmark_api*/ false).Run(state);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * kDim1 *
+                          row_size * sizeof(float));
+}
+
+void BM_ConcatMixedDim1Float(::testing::benchmark::State& state) {
+  const int narrow_dim2 = state.range(0);
+  const int wide_dim2 = state.range(1);
+
+  ConcatMixedHelper(state, narrow_dim2, wide_dim2);
+}
+
+BENCHMARK(BM_ConcatMixedDim1Float)
+    ->UseRealTime()
+    ->ArgPair(1, 1)
+    ->ArgPair(1, 256)
+    ->ArgPair(4, 4)
+    ->ArgPair(4, 256)
+    ->ArgPair(64, 64);
+
 void MemcpyAlternativeHelper(::testing::benchmark::State& state, int dim2) {
   const int kDim1 = 100;
   std::vector<float> data1(kDim1 * dim2, 1.0f);
@@ -17,20 +17,26 @@ limitations under the License.
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/status/status.h"
+#include "tensorflow/core/data/compression_utils.h"
+#include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/global_shuffle_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/dataset.pb.h"
 #include "tensorflow/core/framework/dataset_options.pb.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/kernels/data/cache_ops.h"
 #include "tensorflow/core/kernels/data/iterator_ops.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -67,6 +73,7 @@ constexpr char kCreatedAt[] = "Created at";
 constexpr char kMemoryDatasetPrefix[] = "Memory";
 constexpr char kMemoryCache[] = "MemoryCache";
 constexpr char kCacheCompleted[] = "cache_completed";
+constexpr char kCompressed[] = "compressed";
 constexpr char kIndex[] = "index";
 constexpr char kImpl[] = "Impl";
 constexpr char kCacheDataset[] = "CacheDataset";
@@ -76,6 +83,74 @@ constexpr char kIncompleteCacheErrorMessage[] =
     "contents of the dataset  will be discarded. This can happen if you have "
     "an input pipeline similar to `dataset.cache().take(k).repeat()`. You "
     "should use `dataset.take(k).cache().repeat()` instead.";
+// Name of the experiment that stores the elements of in-memory caches
+// compressed. See `MemoryWriterIterator`.
+constexpr char kCompressedMemoryCacheExperiment[] = "compressed_memory_cache";
+
+// Whether the cache compresses components of type `dtype`. `CompressElement`
+// only supports memcpy-able and string tensors, so the remaining components,
+// such as variants and resources, are cached as they are.
+bool IsCompressibleComponent(DataType dtype) {
+  return DataTypeCanUseMemcpy(dtype) || dtype == DT_STRING;
+}
+
+// Compresses each compressible component of `element` into a scalar variant
+// tensor, and copies the other components to `compressed` unchanged.
+Status CompressCacheElement(const std::vector<Tensor>& element,
+                            std::vector<Tensor>* compressed) {
+  compressed->clear();
+  compressed->reserve(element.size());
+  for (const Tensor& component : element) {
+    if (!IsCompressibleComponent(component.dtype())) {
+      compressed->push_back(component);
+      continue;
+    }
+    CompressedElement compressed_component;
+    TF_RETURN_IF_ERROR(CompressElement({component}, &compressed_component));
+    Tensor tensor(DT_VARIANT, TensorShape({}));
+    tensor.scalar<Variant>()() = std::move(compressed_component);
+    compressed->push_back(std::move(tensor));
+  }
+  return absl::OkStatus();
+}
+
+// Uncompresses an element with components of types `dtypes` compressed by
+// `CompressCacheElement`.
+Status UncompressCacheElement(const DataTypeVector& dtypes,
+                              const std::vector<Tensor>& compressed,
+                              std::vector<Tensor>* element) {
+  if (compressed.size() != dtypes.size()) {
+    return errors::Internal("Expected ", dtypes.size(),
+                            " components in the cached element, got ",
+                            compressed.size(), ".");
+  }
+  element->clear();
+  element->reserve(compressed.size());
+  for (size_t i = 0; i < compressed.size(); ++i) {
+    if (!IsCompressibleComponent(dtypes[i])) {
+      element->push_back(compressed[i]);
+      continue;
+    }
+    const CompressedElement* compressed_component =
+        compressed[i].dtype() == DT_VARIANT && compressed[i].dims() == 0
+            ? compressed[i].scalar<Variant>()().get<CompressedElement>()
+            : nullptr;
+    if (compressed_component == nullptr) {
+      return errors::Internal("Expected component ", i,
+                              " of the cached element to be compressed.");
+    }
+    std::vector<Tensor> component;
+    TF_RETURN_IF_ERROR(UncompressElement(*compressed_component, &component));
+    if (component.size() != 1) {
+      return errors::Internal("Expected component ", i,
+                              " of the cached element to uncompress to a "
+                              "single tensor, got ",
+                              component.size(), ".");
+    }
+    element->push_back(std::move(component[0]));
+  }
+  return absl::OkStatus();
+}
 }  // namespace
 
 class DatasetRandomAccessCache {
@@ -763,7 +838,9 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
                              std::shared_ptr<MemoryCache> cache)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
-        cache_(std::move(cache)) {
+        cache_(std::move(cache)),
+        compress_elements_(
+            GetExperiments().contains(kCompressedMemoryCacheExperiment)) {
     input_->Ref();
     random_indexing_compatible_ = input_->RandomIndexingCompatible();
   }
@@ -877,6 +954,9 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
       mutex_lock l(mu_);
       if (cache_->IsCompleted()) {
         TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kCacheCompleted, ""));
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            prefix(), kCompressed,
+            static_cast<int64_t>(dataset()->compress_elements_)));
         TF_RETURN_IF_ERROR(
             WriteElementsToCheckpoint(writer, prefix(), cache_->data()));
       }
@@ -895,6 +975,8 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
         std::vector<std::vector<Tensor>> temp_cache;
         TF_RETURN_IF_ERROR(
             ReadElementsFromCheckpoint(ctx, reader, prefix(), &temp_cache));
+        TF_RETURN_IF_ERROR(
+            dataset()->RestoreCachedElements(reader, prefix(), &temp_cache));
         cache_->Complete(std::move(temp_cache));
       }
       TF_RETURN_IF_ERROR(InitializeIterator(ctx));
@@ -933,8 +1015,16 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
           }
           return absl::OkStatus();
         }
-        RecordBufferEnqueue(ctx, *out_tensors);
-        temp_cache_.emplace_back(*out_tensors);
+        if (dataset()->compress_elements_) {
+          // The cache size recorded for the model is the compressed size.
+          std::vector<Tensor> compressed;
+          TF_RETURN_IF_ERROR(CompressCacheElement(*out_tensors, &compressed));
+          RecordBufferEnqueue(ctx, compressed);
+          temp_cache_.push_back(std::move(compressed));
+        } else {
+          RecordBufferEnqueue(ctx, *out_tensors);
+          temp_cache_.emplace_back(*out_tensors);
+        }
         if (temp_cache_.size() == dataset()->input_->Cardinality()) {
           VLOG(2) << "Finalizing the cache because its size matches the "
                      "expected input cardinality.";
@@ -954,6 +1044,9 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
                           IteratorStateWriter* writer) override {
         mutex_lock l(mu_);
         if (!cache_->IsCompleted()) {
+          TF_RETURN_IF_ERROR(writer->WriteScalar(
+              prefix(), kCompressed,
+              static_cast<int64_t>(dataset()->compress_elements_)));
           TF_RETURN_IF_ERROR(
               WriteElementsToCheckpoint(writer, prefix(), temp_cache_));
         }
@@ -966,6 +1059,8 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
         if (!reader->Contains(prefix(), kCacheCompleted)) {
           TF_RETURN_IF_ERROR(
               ReadElementsFromCheckpoint(ctx, reader, prefix(), &temp_cache_));
+          TF_RETURN_IF_ERROR(dataset()->RestoreCachedElements(
+              reader, prefix(), &temp_cache_));
         }
         return RestoreInput(ctx, reader, input_impl_);
       }
@@ -1003,8 +1098,17 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
         mutex_lock l(mu_);
         if (index_ < cache_->size()) {
           const std::vector<Tensor>& cache_tensors = cache_->at(index_);
-          out_tensors->insert(out_tensors->begin(), cache_tensors.begin(),
-                              cache_tensors.end());
+          if (dataset()->compress_elements_) {
+            std::vector<Tensor> element;
+            TF_RETURN_IF_ERROR(UncompressCacheElement(
+                dataset()->output_dtypes(), cache_tensors, &element));
+            out_tensors->insert(out_tensors->begin(),
+                                std::make_move_iterator(element.begin()),
+                                std::make_move_iterator(element.end()));
+          } else {
+            out_tensors->insert(out_tensors->begin(), cache_tensors.begin(),
+                                cache_tensors.end());
+          }
           index_++;
           *end_of_sequence = false;
           return absl::OkStatus();
@@ -1072,9 +1176,42 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
     GlobalShuffleIterator global_shuffle_iterator_;
   };  // MemoryIterator
 
+  // Converts `elements`, read from the checkpoint under `prefix`, to the
+  // representation used by this dataset, since the checkpoint may have been
+  // written with the compressed memory cache experiment on when it is off, or
+  // the other way around.
+  Status RestoreCachedElements(
+      IteratorStateReader* reader, const string& prefix,
+      std::vector<std::vector<Tensor>>* elements) const {
+    // Checkpoints without the key were written before the cache could be
+    // compressed.
+    int64_t compressed = 0;
+    if (reader->Contains(prefix, kCompressed)) {
+      TF_RETURN_IF_ERROR(reader->ReadScalar(prefix, kCompressed, &compressed));
+    }
+    if (static_cast<bool>(compressed) == compress_elements_) {
+      return absl::OkStatus();
+    }
+    for (std::vector<Tensor>& element : *elements) {
+      std::vector<Tensor> converted;
+      if (compress_elements_) {
+        TF_RETURN_IF_ERROR(CompressCacheElement(element, &converted));
+      } else {
+        TF_RETURN_IF_ERROR(
+            UncompressCacheElement(output_dtypes(), element, &converted));
+      }
+      element = std::move(converted);
+    }
+    return absl::OkStatus();
+  }
+
   mutable mutex mu_;
   const DatasetBase* const input_;
   const std::shared_ptr<MemoryCache> cache_;
+  // Whether the memcpy-able and string components of the elements are stored
+  // compressed in `cache_`, which trades the time to uncompress them on every
+  // read for a smaller cache.
+  const bool compress_elements_;
   mutable std::unique_ptr<DatasetRandomAccessCache> dataset_random_access_cache_
       TF_GUARDED_BY(mu_);
   mutable std::unique_ptr<IteratorRandomAccessCache>
@@ -11,12 +11,16 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/cache_dataset_ops.h"
 
+#include <cstdlib>
 #include <string>
+#include <tuple>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/platform/path.h"
 
 namespace tensorflow {
@@ -26,6 +30,7 @@ namespace {
 constexpr char kNodeName[] = "cache_dataset";
 constexpr char kFileDatasetPrefix[] = "File";
 constexpr char kMemoryDatasetPrefix[] = "Memory";
+constexpr char kCompressedMemoryCacheExperiment[] = "compressed_memory_cache";
 
 class CacheDatasetParams : public DatasetParams {
  public:
@@ -150,6 +155,49 @@ CacheDatasetParams CacheDatasetParams4() {
                             kNodeName);
 }
 
+// Returns a vector of `TestVariant`s, each holding one of `values`.
+Tensor CreateTestVariants(const std::vector<int64_t>& values) {
+  Tensor tensor(DT_VARIANT, TensorShape({static_cast<int64_t>(values.size())}));
+  for (size_t i = 0; i < values.size(); ++i) {
+    tensor.vec<Variant>()(i) = DatasetOpsTestBase::TestVariant(
+        {CreateTensor<int64_t>(TensorShape({}), {values[i]})});
+  }
+  return tensor;
+}
+
+// Test case 5: cache data with int64, string and variant components in
+// memory.
+CacheDatasetParams CacheDatasetParams5() {
+  auto tensor_slice_dataset_params = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64_t>(TensorShape{3}, {0, 1, 2}),
+                      CreateTensor<tstring>(TensorShape{3}, {"a", "b", "c"}),
+                      CreateTestVariants({3, 4, 5})},
+      /*node_name=*/"tensor_slice");
+  return CacheDatasetParams(
+      std::move(tensor_slice_dataset_params),
+      /*filename=*/"",
+      /*output_dtypes=*/{DT_INT64, DT_STRING, DT_VARIANT},
+      /*output_shapes=*/
+      {PartialTensorShape({}), PartialTensorShape({}), PartialTensorShape({})},
+      kNodeName);
+}
+
+// Returns the components of the elements from `first` onwards produced by
+// `CacheDatasetParams5()`.
+std::vector<Tensor> CacheDatasetParams5Outputs(int first = 0) {
+  const std::vector<tstring> strings = {"a", "b", "c"};
+  std::vector<Tensor> outputs;
+  for (int i = first; i < 3; ++i) {
+    outputs.push_back(CreateTensor<int64_t>(TensorShape({}), {i}));
+    outputs.push_back(CreateTensor<tstring>(TensorShape({}), {strings[i]}));
+    Tensor variant(DT_VARIANT, TensorShape({}));
+    variant.scalar<Variant>()() = DatasetOpsTestBase::TestVariant(
+        {CreateTensor<int64_t>(TensorShape({}), {i + 3})});
+    outputs.push_back(std::move(variant));
+  }
+  return outputs;
+}
+
 std::vector<GetNextTestCase<CacheDatasetParams>> GetNextTestCases() {
   return {{/*dataset_params=*/CacheDatasetParams1(),
            /*expected_outputs=*/
@@ -162,7 +210,9 @@ std::vector<GetNextTestCase<CacheDatasetParams>> GetNextTestCases() {
            CreateTensors<int64_t>(TensorShape({3, 1}),
                                   {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}})},
           {/*dataset_params=*/CacheDatasetParams4(),
-           /*expected_outputs=*/{}}};
+           /*expected_outputs=*/{}},
+          {/*dataset_params=*/CacheDatasetParams5(),
+           /*expected_outputs=*/CacheDatasetParams5Outputs()}};
 }
 
 class ParameterizedGetNextTest : public CacheDatasetOpTest,
@@ -370,6 +420,181 @@ INSTANTIATE_TEST_CASE_P(CacheDatasetOpTest,
                         ParameterizedIteratorSaveAndRestoreTest,
                         ::testing::ValuesIn(IteratorSaveAndRestoreTestCases()));
 
+// Turns the "compressed_memory_cache" experiment on or off for the datasets
+// created afterwards.
+void SetCompressedMemoryCache(bool enabled) {
+  if (enabled) {
+    setenv("TF_JOB_NAME", "test_job", /*overwrite=*/1);
+    setenv("TF_TASK_ID", "0", /*overwrite=*/1);
+    setenv("TF_DATA_EXPERIMENT_OPT_IN", kCompressedMemoryCacheExperiment,
+           /*overwrite=*/1);
+  } else {
+    unsetenv("TF_JOB_NAME");
+    unsetenv("TF_TASK_ID");
+    unsetenv("TF_DATA_EXPERIMENT_OPT_IN");
+  }
+}
+
+// Reads `num_elements` elements from `iterator`, or all of them if
+// `num_elements` is negative, and appends their components to `out_tensors`.
+Status ReadElements(IteratorContext* ctx, IteratorBase* iterator,
+                    int num_elements, std::vector<Tensor>* out_tensors,
+                    bool* end_of_sequence) {
+  *end_of_sequence = false;
+  for (int i = 0; num_elements < 0 || i < num_elements; ++i) {
+    std::vector<Tensor> next;
+    TF_RETURN_IF_ERROR(iterator->GetNext(ctx, &next, end_of_sequence));
+    if (*end_of_sequence) break;
+    out_tensors->insert(out_tensors->end(), next.begin(), next.end());
+  }
+  return absl::OkStatus();
+}
+
+class CompressedMemoryCacheTest : public CacheDatasetOpTest {
+ public:
+  ~CompressedMemoryCacheTest() override { SetCompressedMemoryCache(false); }
+};
+
+std::vector<GetNextTestCase<CacheDatasetParams>>
+CompressedMemoryCacheGetNextTestCases() {
+  return {{/*dataset_params=*/CacheDatasetParams3(),
+           /*expected_outputs=*/
+           CreateTensors<int64_t>(TensorShape({3, 1}),
+                                  {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}})},
+          {/*dataset_params=*/CacheDatasetParams4(),
+           /*expected_outputs=*/{}},
+          {/*dataset_params=*/CacheDatasetParams5(),
+           /*expected_outputs=*/CacheDatasetParams5Outputs()}};
+}
+
+class ParameterizedCompressedMemoryCacheGetNextTest
+    : public CompressedMemoryCacheTest,
+      public ::testing::WithParamInterface<
+          GetNextTestCase<CacheDatasetParams>> {};
+
+TEST_P(ParameterizedCompressedMemoryCacheGetNextTest, GetNext) {
+  auto test_case = GetParam();
+  SetCompressedMemoryCache(true);
+  ASSERT_TRUE(GetExperiments().contains(kCompressedMemoryCacheExperiment));
+  TF_ASSERT_OK(Initialize(test_case.dataset_params));
+
+  // Test the write mode, which compresses the elements into the cache.
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  TF_ASSERT_OK(ReadElements(iterator_ctx_.get(), iterator_.get(),
+                            /*num_elements=*/-1, &out_tensors,
+                            &end_of_sequence));
+  TF_EXPECT_OK(ExpectEqual(out_tensors, test_case.expected_outputs,
+                           /*compare_order=*/true));
+
+  // Test the read mode, which uncompresses the cached elements.
+  TF_ASSERT_OK(dataset_->MakeIterator(
+      iterator_ctx_.get(), /*parent=*/nullptr,
+      test_case.dataset_params.iterator_prefix(), &iterator_));
+  out_tensors.clear();
+  TF_ASSERT_OK(ReadElements(iterator_ctx_.get(), iterator_.get(),
+                            /*num_elements=*/-1, &out_tensors,
+                            &end_of_sequence));
+  TF_EXPECT_OK(ExpectEqual(out_tensors, test_case.expected_outputs,
+                           /*compare_order=*/true));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    CompressedMemoryCacheTest, ParameterizedCompressedMemoryCacheGetNextTest,
+    ::testing::ValuesIn(CompressedMemoryCacheGetNextTestCases()));
+
+// Saves iterators with the experiment set to the first parameter and
+// restores them with the experiment set to the second one.
+class ParameterizedCompressedMemoryCacheSaveAndRestoreTest
+    : public CompressedMemoryCacheTest,
+      public ::testing::WithParamInterface<std::tuple<bool, bool>> {};
+
+TEST_P(ParameterizedCompressedMemoryCacheSaveAndRestoreTest, SaveAndRestore) {
+  const bool save_compressed = std::get<0>(GetParam());
+  const bool restore_compressed = std::get<1>(GetParam());
+  auto dataset_params = CacheDatasetParams5();
+  SetCompressedMemoryCache(save_compressed);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::unique_ptr<SerializationContext> serialization_ctx;
+  TF_ASSERT_OK(CreateSerializationContext(&serialization_ctx));
+
+  // Save the writer after it has cached two of the three elements.
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  TF_ASSERT_OK(ReadElements(iterator_ctx_.get(), iterator_.get(),
+                            /*num_elements=*/2, &out_tensors,
+                            &end_of_sequence));
+  VariantTensorDataWriter writer_checkpoint;
+  TF_ASSERT_OK(iterator_->Save(serialization_ctx.get(), &writer_checkpoint));
+
+  // Save the reader of the completed cache after it has read one element.
+  TF_ASSERT_OK(ReadElements(iterator_ctx_.get(), iterator_.get(),
+                            /*num_elements=*/-1, &out_tensors,
+                            &end_of_sequence));
+  TF_ASSERT_OK(dataset_->MakeIterator(iterator_ctx_.get(), /*parent=*/nullptr,
+                                      dataset_params.iterator_prefix(),
+                                      &iterator_));
+  out_tensors.clear();
+  TF_ASSERT_OK(ReadElements(iterator_ctx_.get(), iterator_.get(),
+                            /*num_elements=*/1, &out_tensors,
+                            &end_of_sequence));
+  VariantTensorDataWriter reader_checkpoint;
+  TF_ASSERT_OK(iterator_->Save(serialization_ctx.get(), &reader_checkpoint));
+
+  SetCompressedMemoryCache(restore_compressed);
+
+  // Restoring the writer finishes caching the elements in the new cache.
+  std::unique_ptr<TestDataset> writer_dataset;
+  TF_ASSERT_OK(MakeDataset(dataset_params, &writer_dataset));
+  std::vector<const VariantTensorData*> data;
+  writer_checkpoint.GetData(&data);
+  VariantTensorDataReader writer_reader(data);
+  std::unique_ptr<IteratorBase> iterator;
+  TF_ASSERT_OK(RestoreIterator(iterator_ctx_.get(), &writer_reader,
+                               dataset_params.iterator_prefix(),
+                               *writer_dataset->dataset(), &iterator));
+  out_tensors.clear();
+  TF_ASSERT_OK(ReadElements(iterator_ctx_.get(), iterator.get(),
+                            /*num_elements=*/-1, &out_tensors,
+                            &end_of_sequence));
+  EXPECT_TRUE(end_of_sequence);
+  TF_EXPECT_OK(ExpectEqual(out_tensors,
+                           CacheDatasetParams5Outputs(/*first=*/2),
+                           /*compare_order=*/true));
+  TF_ASSERT_OK(writer_dataset->dataset()->MakeIterator(
+      iterator_ctx_.get(), /*parent=*/nullptr,
+      dataset_params.iterator_prefix(), &iterator));
+  out_tensors.clear();
+  TF_ASSERT_OK(ReadElements(iterator_ctx_.get(), iterator.get(),
+                            /*num_elements=*/-1, &out_tensors,
+                            &end_of_sequence));
+  TF_EXPECT_OK(ExpectEqual(out_tensors, CacheDatasetParams5Outputs(),
+                           /*compare_order=*/true));
+
+  // Restoring the reader restores the completed cache.
+  std::unique_ptr<TestDataset> reader_dataset;
+  TF_ASSERT_OK(MakeDataset(dataset_params, &reader_dataset));
+  data.clear();
+  reader_checkpoint.GetData(&data);
+  VariantTensorDataReader reader_reader(data);
+  TF_ASSERT_OK(RestoreIterator(iterator_ctx_.get(), &reader_reader,
+                               dataset_params.iterator_prefix(),
+                               *reader_dataset->dataset(), &iterator));
+  out_tensors.clear();
+  TF_ASSERT_OK(ReadElements(iterator_ctx_.get(), iterator.get(),
+                            /*num_elements=*/-1, &out_tensors,
+                            &end_of_sequence));
+  EXPECT_TRUE(end_of_sequence);
+  TF_EXPECT_OK(ExpectEqual(out_tensors,
+                           CacheDatasetParams5Outputs(/*first=*/1),
+                           /*compare_order=*/true));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    CompressedMemoryCacheTest,
+    ParameterizedCompressedMemoryCacheSaveAndRestoreTest,
+    ::testing::Combine(::testing::Bool(), ::testing::Bool()));
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -0,0 +1,686 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/data/split_utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/kernels/data/experimental/parquet_reader.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/util/batch_util.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNumFiles[] = "num_files";
+constexpr char kFile[] = "file_";
+constexpr char kRowGroup[] = "row_group";
+constexpr char kRowOffset[] = "row_offset";
+
+// Replaces the nulls of `values` with `record_default` and drops the rows that
+// are not in `keep`, unless `keep` is empty.
+template <typename T>
+Status FinishColumn(const string& name, const Tensor& record_default,
+                    const std::vector<bool>& nulls,
+                    const std::vector<bool>& keep, int64_t num_kept,
+                    Tensor* values) {
+  const bool has_nulls = std::find(nulls.begin(), nulls.end(), true) !=
+                         nulls.end();
+  if (has_nulls && record_default.NumElements() == 0) {
+    return errors::InvalidArgument("Column ", name,
+                                   " has a null value but no default");
+  }
+  if (keep.empty()) {
+    if (has_nulls) {
+      auto flat = values->flat<T>();
+      for (int64_t i = 0; i < flat.size(); ++i) {
+        if (nulls[i]) flat(i) = record_default.flat<T>()(0);
+      }
+    }
+    return absl::OkStatus();
+  }
+  Tensor kept(values->dtype(), TensorShape({num_kept}));
+  auto src = values->flat<T>();
+  auto dst = kept.flat<T>();
+  int64_t j = 0;
+  for (int64_t i = 0; i < src.size(); ++i) {
+    if (!keep[i]) continue;
+    dst(j++) = nulls[i] ? record_default.flat<T>()(0) : std::move(src(i));
+  }
+  *values = std::move(kept);
+  return absl::OkStatus();
+}
+
+// Marks the rows whose non-null `values` are in [min, max].
+template <typename T>
+void FilterRows(const Tensor& values, const std::vector<bool>& nulls,
+                double min, double max, std::vector<bool>* keep) {
+  auto flat = values.flat<T>();
+  keep->resize(flat.size());
+  for (int64_t i = 0; i < flat.size(); ++i) {
+    const double value = static_cast<double>(flat(i));
+    (*keep)[i] = !nulls[i] && value >= min && value <= max;
+  }
+}
+
+bool IsNumeric(DataType dtype) {
+  return dtype == DT_INT32 || dtype == DT_INT64 || dtype == DT_FLOAT ||
+         dtype == DT_DOUBLE;
+}
+
+class ParquetDatasetOp : public DatasetOpKernel {
+ public:
+  explicit ParquetDatasetOp(OpKernelConstruction* ctx) : DatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+  }
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override {
+    const Tensor* filenames_tensor;
+    OP_REQUIRES_OK(ctx, ctx->input("filenames", &filenames_tensor));
+    OP_REQUIRES(
+        ctx, filenames_tensor->dims() <= 1,
+        errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+    std::vector<string> filenames;
+    filenames.reserve(filenames_tensor->NumElements());
+    for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+      filenames.push_back(filenames_tensor->flat<tstring>()(i));
+    }
+
+    const Tensor* columns_tensor;
+    OP_REQUIRES_OK(ctx, ctx->input("columns", &columns_tensor));
+    OP_REQUIRES(ctx, columns_tensor->dims() == 1,
+                errors::InvalidArgument("`columns` must be a vector."));
+    std::vector<string> columns;
+    columns.reserve(columns_tensor->NumElements());
+    for (int i = 0; i < columns_tensor->NumElements(); ++i) {
+      columns.push_back(columns_tensor->flat<tstring>()(i));
+    }
+    OP_REQUIRES(ctx, columns.size() == output_types_.size(),
+                errors::InvalidArgument("`columns` should match output size"));
+
+    OpInputList record_defaults_list;
+    OP_REQUIRES_OK(ctx,
+                   ctx->input_list("record_defaults", &record_defaults_list));
+    std::vector<Tensor> record_defaults;
+    record_defaults.reserve(record_defaults_list.size());
+    for (int i = 0; i < record_defaults_list.size(); ++i) {
+      OP_REQUIRES(ctx, record_defaults_list[i].dims() <= 1,
+                  errors::InvalidArgument(
+                      "Each record default should be at most rank 1"));
+      OP_REQUIRES(ctx, record_defaults_list[i].NumElements() < 2,
+                  errors::InvalidArgument(
+                      "There should only be 1 default per field but field ", i,
+                      " has ", record_defaults_list[i].NumElements()));
+      record_defaults.push_back(record_defaults_list[i]);
+    }
+
+    int64_t batch_size;
+    OP_REQUIRES_OK(
+        ctx, ParseScalarArgument<int64_t>(ctx, "batch_size", &batch_size));
+    OP_REQUIRES(ctx, batch_size > 0,
+                errors::InvalidArgument("batch_size should be positive"));
+
+    tstring filter_column;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<tstring>(ctx, "filter_column",
+                                                     &filter_column));
+    double filter_min, filter_max;
+    OP_REQUIRES_OK(ctx,
+                   ParseScalarArgument<double>(ctx, "filter_min", &filter_min));
+    OP_REQUIRES_OK(ctx,
+                   ParseScalarArgument<double>(ctx, "filter_max", &filter_max));
+
+    int64_t num_parallel_reads;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64_t>(ctx, "num_parallel_reads",
+                                                     &num_parallel_reads));
+    OP_REQUIRES(
+        ctx, num_parallel_reads > 0 || num_parallel_reads == model::kAutotune,
+        errors::InvalidArgument(
+            "num_parallel_reads should be positive or AUTOTUNE"));
+
+    *output = new Dataset(ctx, std::move(filenames), std::move(columns),
+                          std::move(record_defaults), batch_size,
+                          std::move(filter_column), filter_min, filter_max,
+                          num_parallel_reads, output_types_, output_shapes_);
+  }
+
+ private:
+  class Dataset : public DatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, std::vector<string> filenames,
+            std::vector<string> columns, std::vector<Tensor> record_defaults,
+            int64_t batch_size, string filter_column, double filter_min,
+            double filter_max, int64_t num_parallel_reads,
+            const DataTypeVector& output_types,
+            const std::vector<PartialTensorShape>& output_shapes)
+        : DatasetBase(DatasetContext(ctx)),
+          filenames_(std::move(filenames)),
+          columns_(std::move(columns)),
+          record_defaults_(std::move(record_defaults)),
+          batch_size_(batch_size),
+          filter_column_(std::move(filter_column)),
+          filter_min_(filter_min),
+          filter_max_(filter_max),
+          num_parallel_reads_(num_parallel_reads),
+          output_types_(output_types),
+          output_shapes_(output_shapes) {}
+
+    std::unique_ptr<IteratorBase> MakeIteratorInternal(
+        const string& prefix) const override {
+      return std::make_unique<Iterator>(
+          Iterator::Params{this, strings::StrCat(prefix, "::Parquet")});
+    }
+
+    Status MakeSplitProviders(std::vector<std::unique_ptr<SplitProvider>>*
+                                  split_providers) const override {
+      split_providers->push_back(
+          std::make_unique<IndexSplitProvider>(filenames_.size()));
+      return absl::OkStatus();
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return output_types_;
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return output_shapes_;
+    }
+
+    string DebugString() const override {
+      return "ParquetDatasetOp::Dataset";
+    }
+
+    Status CheckExternalState() const override { return absl::OkStatus(); }
+
+    Status InputDatasets(
+        std::vector<const DatasetBase*>* inputs) const override {
+      inputs->clear();
+      return absl::OkStatus();
+    }
+
+   protected:
+    Status AsGraphDefInternal(SerializationContext* ctx,
+                              DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* filenames = nullptr;
+      Node* columns = nullptr;
+      Node* batch_size = nullptr;
+      Node* filter_column = nullptr;
+      Node* filter_min = nullptr;
+      Node* filter_max = nullptr;
+      Node* num_parallel_reads = nullptr;
+
+      std::vector<Node*> record_defaults;
+      record_defaults.reserve(record_defaults_.size());
+      for (const Tensor& t : record_defaults_) {
+        Node* node;
+        TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+        record_defaults.emplace_back(node);
+      }
+
+      TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+      TF_RETURN_IF_ERROR(b->AddVector(columns_, &columns));
+      TF_RETURN_IF_ERROR(b->AddScalar(batch_size_, &batch_size));
+      TF_RETURN_IF_ERROR(b->AddScalar(filter_column_, &filter_column));
+      TF_RETURN_IF_ERROR(b->AddScalar(filter_min_, &filter_min));
+      TF_RETURN_IF_ERROR(b->AddScalar(filter_max_, &filter_max));
+      TF_RETURN_IF_ERROR(
+          b->AddScalar(num_parallel_reads_, &num_parallel_reads));
+      TF_RETURN_IF_ERROR(b->AddDataset(
+          this,
+          {
+              std::make_pair(0, filenames),
+              std::make_pair(1, columns),
+              std::make_pair(3, batch_size),
+              std::make_pair(4, filter_column),
+              std::make_pair(5, filter_min),
+              std::make_pair(6, filter_max),
+              std::make_pair(7, num_parallel_reads),
+          },                                     // Single tensor inputs
+          {std::make_pair(2, record_defaults)},  // Tensor list inputs
+          {}, output));
+      return absl::OkStatus();
+    }
+
+   private:
+    // An open Parquet file, whose row groups are decoded in order.
+    struct File {
+      int64_t index = 0;
+      std::unique_ptr<RandomAccessFile> file;
+      ParquetMetadata metadata;
+      // Index into `metadata.columns` of each output.
+      std::vector<int> columns;
+      int filter_column = -1;
+      // The next row group to decode.
+      int next_row_group = 0;
+    };
+
+    // A decoded row group, whose columns hold the rows that passed the
+    // filter.
+    struct RowGroup {
+      std::shared_ptr<File> file;
+      int row_group = 0;
+      bool done = false;
+      Status status;
+      std::vector<Tensor> columns;
+      int64_t num_rows = 0;
+    };
+
+    // Returns false if the statistics of `row_group` rule out any row passing
+    // the filter.
+    bool MayMatch(const File& file, int row_group) const {
+      if (file.filter_column < 0) return true;
+      double min, max;
+      if (!GetParquetColumnBounds(file.metadata,
+                                  file.metadata.row_groups[row_group],
+                                  file.filter_column, &min, &max)) {
+        return true;
+      }
+      return max >= filter_min_ && min <= filter_max_;
+    }
+
+    Status OpenFile(Env* env, int64_t index, std::shared_ptr<File>* out) const {
+      if (index < 0 || index >= filenames_.size()) {
+        return errors::InvalidArgument("Invalid file index ", index,
+                                       " for a dataset of ", filenames_.size(),
+                                       " files");
+      }
+      const string& filename = filenames_[index];
+      auto file = std::make_shared<File>();
+      file->index = index;
+      uint64 file_size;
+      TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+      TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file->file));
+      Status s = ReadParquetMetadata(file->file.get(), file_size,
+                                     &file->metadata);
+      if (!s.ok()) {
+        errors::AppendToMessage(&s, "while reading ", filename);
+        return s;
+      }
+      auto find_column = [&](const string& name, int* column) -> Status {
+        for (int i = 0; i < file->metadata.columns.size(); ++i) {
+          if (file->metadata.columns[i].name == name) {
+            *column = i;
+            return absl::OkStatus();
+          }
+        }
+        return errors::InvalidArgument("Column ", name, " not found in ",
+                                       filename);
+      };
+      file->columns.resize(columns_.size());
+      for (int i = 0; i < columns_.size(); ++i) {
+        TF_RETURN_IF_ERROR(find_column(columns_[i], &file->columns[i]));
+        const DataType dtype = ParquetTypeToDataType(
+            file->metadata.columns[file->columns[i]].type);
+        if (dtype != output_types_[i]) {
+          return errors::InvalidArgument(
+              "Column ", columns_[i], " of ", filename, " has type ",
+              DataTypeString(dtype), ", expected ",
+              DataTypeString(output_types_[i]));
+        }
+      }
+      if (!filter_column_.empty()) {
+        TF_RETURN_IF_ERROR(find_column(filter_column_, &file->filter_column));
+        const DataType dtype = ParquetTypeToDataType(
+            file->metadata.columns[file->filter_column].type);
+        if (!IsNumeric(dtype)) {
+          return errors::InvalidArgument("Filter column ", filter_column_,
+                                         " of ", filename,
+                                         " is not numeric");
+        }
+      }
+      *out = std::move(file);
+      return absl::OkStatus();
+    }
+
+    // Decodes the outputs of `result->row_group`. Thread-safe.
+    Status DecodeRowGroup(RowGroup* result) const {
+      const File& file = *result->file;
+      const ParquetRowGroup& row_group =
+          file.metadata.row_groups[result->row_group];
+      std::vector<bool> keep;
+      int64_t num_rows = row_group.num_rows;
+      if (file.filter_column >= 0) {
+        Tensor values;
+        std::vector<bool> nulls;
+        TF_RETURN_IF_ERROR(ReadParquetColumn(file.file.get(), file.metadata,
+                                             row_group, file.filter_column,
+                                             &values, &nulls));
+        switch (values.dtype()) {
+#define HANDLE_TYPE(T)                                                  \
+  case DataTypeToEnum<T>::value:                                        \
+    FilterRows<T>(values, nulls, filter_min_, filter_max_, &keep); \
+    break;
+          TF_CALL_int32(HANDLE_TYPE);
+          TF_CALL_int64(HANDLE_TYPE);
+          TF_CALL_float(HANDLE_TYPE);
+          TF_CALL_double(HANDLE_TYPE);
+#undef HANDLE_TYPE
+          default:
+            return errors::InvalidArgument("Filter column ", filter_column_,
+                                           " is not numeric");
+        }
+        num_rows = std::count(keep.begin(), keep.end(), true);
+      }
+
+      result->columns.resize(columns_.size());
+      for (int i = 0; i < columns_.size(); ++i) {
+        Tensor* values = &result->columns[i];
+        std::vector<bool> nulls;
+        TF_RETURN_IF_ERROR(ReadParquetColumn(file.file.get(), file.metadata,
+                                             row_group, file.columns[i],
+                                             values, &nulls));
+        switch (values->dtype()) {
+#define HANDLE_TYPE(T)                                                    \
+  case DataTypeToEnum<T>::value:                                          \
+    TF_RETURN_IF_ERROR(FinishColumn<T>(columns_[i], record_defaults_[i], \
+                                       nulls, keep, num_rows, values));  \
+    break;
+          TF_CALL_bool(HANDLE_TYPE);
+          TF_CALL_int32(HANDLE_TYPE);
+          TF_CALL_int64(HANDLE_TYPE);
+          TF_CALL_float(HANDLE_TYPE);
+          TF_CALL_double(HANDLE_TYPE);
+          TF_CALL_tstring(HANDLE_TYPE);
+#undef HANDLE_TYPE
+          default:
+            return errors::Unimplemented("Unsupported dtype ",
+                                         DataTypeString(values->dtype()));
+        }
+      }
+      result->num_rows = num_rows;
+      return absl::OkStatus();
+    }
+
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params) {}
+
+      ~Iterator() override {
+        // Row groups that have not started decoding are skipped, and
+        // destroying the thread pool waits for the others.
+        mutex_lock l(mu_);
+        cancelled_ = true;
+      }
+
+      Status Initialize(IteratorContext* ctx) override {
+        if (ctx->split_providers().empty()) {
+          split_provider_ = std::make_shared<IndexSplitProvider>(
+              dataset()->filenames_.size());
+        } else {
+          TF_ASSIGN_OR_RETURN(split_provider_,
+                              GetSingleSplitProvider(ctx, dataset()));
+        }
+        num_parallel_reads_ =
+            dataset()->num_parallel_reads_ == model::kAutotune
+                ? port::MaxParallelism()
+                : dataset()->num_parallel_reads_;
+        thread_pool_ = ctx->CreateThreadPool("parquet_decode",
+                                             num_parallel_reads_);
+        return absl::OkStatus();
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        // The row ranges of decoded row groups that make up the batch.
+        struct Slice {
+          std::shared_ptr<RowGroup> row_group;
+          int64_t offset;
+          int64_t num_rows;
+        };
+        std::vector<Slice> slices;
+        int64_t batch_size = 0;
+        {
+          mutex_lock l(mu_);
+          while (batch_size < dataset()->batch_size_) {
+            TF_RETURN_IF_ERROR(ScheduleLocked(ctx));
+            if (row_groups_.empty()) break;
+            std::shared_ptr<RowGroup> front = row_groups_.front();
+            while (!front->done) {
+              cond_var_.wait(l);
+            }
+            if (!front->status.ok()) {
+              row_groups_.pop_front();
+              row_offset_ = 0;
+              PopFinishedFilesLocked();
+              return front->status;
+            }
+            const int64_t num_rows =
+                std::min(dataset()->batch_size_ - batch_size,
+                         front->num_rows - row_offset_);
+            if (num_rows > 0) {
+              slices.push_back({front, row_offset_, num_rows});
+              batch_size += num_rows;
+              row_offset_ += num_rows;
+            }
+            if (row_offset_ == front->num_rows) {
+              row_groups_.pop_front();
+              row_offset_ = 0;
+              PopFinishedFilesLocked();
+            }
+          }
+        }
+        if (batch_size == 0) {
+          *end_of_sequence = true;
+          return absl::OkStatus();
+        }
+
+        // The rows are only read by this batch, so they can be moved (and the
+        // tensors reused when a batch spans a single whole row group).
+        out_tensors->reserve(dataset()->columns_.size());
+        for (int i = 0; i < dataset()->columns_.size(); ++i) {
+          Tensor& first = slices.front().row_group->columns[i];
+          if (slices.size() == 1 && slices.front().offset == 0 &&
+              first.dim_size(0) == batch_size) {
+            out_tensors->push_back(std::move(first));
+            continue;
+          }
+          out_tensors->emplace_back(ctx->allocator({}),
+                                    dataset()->output_types_[i],
+                                    TensorShape({batch_size}));
+          int64_t offset = 0;
+          for (const Slice& slice : slices) {
+            TF_RETURN_IF_ERROR(batch_util::MaybeMoveContiguousSlices(
+                slice.row_group->columns[i], slice.offset, offset,
+                slice.num_rows, &out_tensors->back()));
+            offset += slice.num_rows;
+          }
+        }
+        *end_of_sequence = false;
+        return absl::OkStatus();
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeSourceNode(std::move(args));
+      }
+
+      // Saves the split provider, which has handed out the files that are not
+      // read to the end yet, followed by those files and the position of the
+      // next row to return. Row groups that are decoded ahead are dropped and
+      // decoded again after restoring.
+      Status SaveInternal(SerializationContext* ctx,
+                          IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(split_provider_->Save(
+            [this](const std::string& key) { return full_name(key); },
+            writer));
+        PopFinishedFilesLocked();
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            full_name(kNumFiles), static_cast<int64_t>(files_.size())));
+        for (int i = 0; i < files_.size(); ++i) {
+          TF_RETURN_IF_ERROR(writer->WriteScalar(
+              full_name(strings::StrCat(kFile, i)), files_[i]->index));
+        }
+        if (!files_.empty()) {
+          const int64_t row_group = row_groups_.empty()
+                                        ? files_.front()->next_row_group
+                                        : row_groups_.front()->row_group;
+          TF_RETURN_IF_ERROR(
+              writer->WriteScalar(full_name(kRowGroup), row_group));
+          TF_RETURN_IF_ERROR(
+              writer->WriteScalar(full_name(kRowOffset), row_offset_));
+        }
+        return absl::OkStatus();
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        row_groups_.clear();
+        files_.clear();
+        row_offset_ = 0;
+        TF_RETURN_IF_ERROR(split_provider_->Restore(
+            [this](const std::string& key) { return full_name(key); },
+            reader));
+        int64_t num_files;
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(full_name(kNumFiles), &num_files));
+        for (int64_t i = 0; i < num_files; ++i) {
+          int64_t index;
+          TF_RETURN_IF_ERROR(
+              reader->ReadScalar(full_name(strings::StrCat(kFile, i)), &index));
+          std::shared_ptr<File> file;
+          TF_RETURN_IF_ERROR(dataset()->OpenFile(ctx->env(), index, &file));
+          files_.push_back(std::move(file));
+        }
+        if (!files_.empty()) {
+          int64_t row_group;
+          TF_RETURN_IF_ERROR(
+              reader->ReadScalar(full_name(kRowGroup), &row_group));
+          TF_RETURN_IF_ERROR(
+              reader->ReadScalar(full_name(kRowOffset), &row_offset_));
+          if (row_group < 0 ||
+              row_group > static_cast<int64_t>(
+                              files_.front()->metadata.row_groups.size())) {
+            return errors::DataLoss("Invalid row group ", row_group,
+                                    " in the checkpoint of ",
+                                    dataset()->filenames_[files_[0]->index]);
+          }
+          files_.front()->next_row_group = row_group;
+        }
+        return absl::OkStatus();
+      }
+
+     private:
+      static bool FullyScheduled(const File& file) {
+        return file.next_row_group == file.metadata.row_groups.size();
+      }
+
+      // Schedules the decoding of row groups until `num_parallel_reads_` are
+      // in flight or buffered, moving on to the next split once a file has
+      // been scheduled in full.
+      Status ScheduleLocked(IteratorContext* ctx)
+          TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        while (row_groups_.size() < num_parallel_reads_) {
+          auto it = std::find_if(files_.begin(), files_.end(),
+                                 [](const std::shared_ptr<File>& file) {
+                                   return !FullyScheduled(*file);
+                                 });
+          if (it == files_.end()) {
+            Tensor split;
+            bool end_of_splits;
+            TF_RETURN_IF_ERROR(split_provider_->GetNext(&split, &end_of_splits));
+            if (end_of_splits) break;
+            std::shared_ptr<File> file;
+            TF_RETURN_IF_ERROR(dataset()->OpenFile(
+                ctx->env(), split.scalar<int64_t>()(), &file));
+            files_.push_back(std::move(file));
+            continue;
+          }
+          std::shared_ptr<File> file = *it;
+          const int row_group = file->next_row_group++;
+          if (!dataset()->MayMatch(*file, row_group)) continue;
+          auto result = std::make_shared<RowGroup>();
+          result->file = std::move(file);
+          result->row_group = row_group;
+          row_groups_.push_back(result);
+          thread_pool_->Schedule([this, result = std::move(result)]() {
+            {
+              mutex_lock l(mu_);
+              if (cancelled_) return;
+            }
+            Status s = dataset()->DecodeRowGroup(result.get());
+            mutex_lock l(mu_);
+            result->status = std::move(s);
+            result->done = true;
+            cond_var_.notify_all();
+          });
+        }
+        PopFinishedFilesLocked();
+        return absl::OkStatus();
+      }
+
+      // Drops the files at the front of `files_` that have been scheduled in
+      // full and have no rows left to return.
+      void PopFinishedFilesLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        while (!files_.empty() && FullyScheduled(*files_.front()) &&
+               (row_groups_.empty() ||
+                row_groups_.front()->file != files_.front())) {
+          files_.pop_front();
+        }
+      }
+
+      mutex mu_;
+      condition_variable cond_var_;
+      std::shared_ptr<SplitProvider> split_provider_;
+      int64_t num_parallel_reads_ = 1;
+      // The files handed out by the split provider that have rows left to
+      // return, in order.
+      std::deque<std::shared_ptr<File>> files_ TF_GUARDED_BY(mu_);
+      // The row groups that are decoded or being decoded, in order.
+      std::deque<std::shared_ptr<RowGroup>> row_groups_ TF_GUARDED_BY(mu_);
+      // The number of rows of `row_groups_.front()` already returned.
+      int64_t row_offset_ TF_GUARDED_BY(mu_) = 0;
+      bool cancelled_ TF_GUARDED_BY(mu_) = false;
+      // Declared last, so that it is destroyed (and waits for its closures)
+      // before the state they use.
+      std::unique_ptr<thread::ThreadPool> thread_pool_;
+    };  // class Iterator
+
+    const std::vector<string> filenames_;
+    const std::vector<string> columns_;
+    const std::vector<Tensor> record_defaults_;
+    const int64_t batch_size_;
+    const tstring filter_column_;
+    const double filter_min_;
+    const double filter_max_;
+    const int64_t num_parallel_reads_;
+    const DataTypeVector output_types_;
+    const std::vector<PartialTensorShape> output_shapes_;
+  };  // class Dataset
+
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+};  // class ParquetDatasetOp
+
+REGISTER_KERNEL_BUILDER(Name("ParquetDataset").Device(DEVICE_CPU),
+                        ParquetDatasetOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
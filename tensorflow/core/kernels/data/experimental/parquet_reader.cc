@@ -0,0 +1,1073 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/parquet_reader.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <utility>
+
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/platform/byte_order.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/raw_coding.h"
+#include "tensorflow/core/platform/snappy.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kMagic[] = "PAR1";
+constexpr size_t kMagicSize = 4;
+constexpr size_t kFooterSize = sizeof(uint32) + kMagicSize;
+
+// Limits the nesting of Thrift structures, so that corrupted metadata cannot
+// exhaust the stack.
+constexpr int kMaxThriftDepth = 64;
+
+// Compression codecs.
+constexpr int32 kUncompressed = 0;
+constexpr int32 kSnappy = 1;
+constexpr int32 kGzip = 2;
+
+// Page types.
+constexpr int32 kDataPage = 0;
+constexpr int32 kDictionaryPage = 2;
+constexpr int32 kDataPageV2 = 3;
+
+// Encodings.
+constexpr int32 kPlain = 0;
+constexpr int32 kPlainDictionary = 2;
+constexpr int32 kRle = 3;
+constexpr int32 kRleDictionary = 8;
+
+// Field repetition types.
+constexpr int32 kOptional = 1;
+constexpr int32 kRepeated = 2;
+
+// Types of the Thrift compact protocol.
+enum ThriftType {
+  kStop = 0,
+  kBoolTrue = 1,
+  kBoolFalse = 2,
+  kByte = 3,
+  kI16 = 4,
+  kI32 = 5,
+  kI64 = 6,
+  kDouble = 7,
+  kBinary = 8,
+  kList = 9,
+  kSet = 10,
+  kMap = 11,
+  kStruct = 12,
+};
+
+// Decodes the parts of the Thrift compact protocol used by Parquet metadata.
+class ThriftReader {
+ public:
+  ThriftReader(const char* data, size_t size)
+      : data_(data), pos_(data), end_(data + size) {}
+
+  size_t position() const { return pos_ - data_; }
+
+  Status ReadVarint(uint64* value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (pos_ == end_) return Truncated();
+      const uint8 byte = static_cast<uint8>(*pos_++);
+      *value |= static_cast<uint64>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) return absl::OkStatus();
+    }
+    return errors::DataLoss("Invalid varint in Parquet metadata");
+  }
+
+  Status ReadI64(int64_t* value) {
+    uint64 zigzag;
+    TF_RETURN_IF_ERROR(ReadVarint(&zigzag));
+    *value = static_cast<int64_t>((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+    return absl::OkStatus();
+  }
+
+  Status ReadBinary(std::string* value) {
+    uint64 size;
+    TF_RETURN_IF_ERROR(ReadVarint(&size));
+    if (size > static_cast<uint64>(end_ - pos_)) return Truncated();
+    value->assign(pos_, size);
+    pos_ += size;
+    return absl::OkStatus();
+  }
+
+  Status ReadListHeader(int* element_type, int64_t* size) {
+    if (pos_ == end_) return Truncated();
+    const uint8 header = static_cast<uint8>(*pos_++);
+    *element_type = header & 0x0f;
+    *size = header >> 4;
+    if (*size == 15) {
+      uint64 size64;
+      TF_RETURN_IF_ERROR(ReadVarint(&size64));
+      if (size64 > static_cast<uint64>(end_ - pos_)) return Truncated();
+      *size = static_cast<int64_t>(size64);
+    }
+    return absl::OkStatus();
+  }
+
+  // Reads the fields of a struct, calling `read_field(id, type)` for each one.
+  // `read_field` must consume the value of the field, e.g. with `Skip()`.
+  template <typename ReadField>
+  Status ReadStruct(ReadField&& read_field) {
+    if (++depth_ > kMaxThriftDepth) {
+      return errors::DataLoss("Parquet metadata is nested too deeply");
+    }
+    int16 last_id = 0;
+    while (true) {
+      if (pos_ == end_) return Truncated();
+      const uint8 header = static_cast<uint8>(*pos_++);
+      const int type = header & 0x0f;
+      if (type == kStop) break;
+      int16 id;
+      if ((header >> 4) == 0) {
+        int64_t id64;
+        TF_RETURN_IF_ERROR(ReadI64(&id64));
+        id = static_cast<int16>(id64);
+      } else {
+        id = last_id + (header >> 4);
+      }
+      last_id = id;
+      TF_RETURN_IF_ERROR(read_field(id, type));
+    }
+    --depth_;
+    return absl::OkStatus();
+  }
+
+  // Reads a list, calling `read_element(type)` for each element.
+  template <typename ReadElement>
+  Status ReadList(ReadElement&& read_element) {
+    int element_type;
+    int64_t size;
+    TF_RETURN_IF_ERROR(ReadListHeader(&element_type, &size));
+    for (int64_t i = 0; i < size; ++i) {
+      TF_RETURN_IF_ERROR(read_element(element_type));
+    }
+    return absl::OkStatus();
+  }
+
+  // Skips a value of type `type`. Booleans are encoded in the field header of
+  // struct fields, but take a byte as elements of collections.
+  Status Skip(int type, bool in_collection = false) {
+    switch (type) {
+      case kBoolTrue:
+      case kBoolFalse:
+        return in_collection ? SkipBytes(1) : absl::OkStatus();
+      case kByte:
+        return SkipBytes(1);
+      case kI16:
+      case kI32:
+      case kI64: {
+        uint64 unused;
+        return ReadVarint(&unused);
+      }
+      case kDouble:
+        return SkipBytes(sizeof(double));
+      case kBinary: {
+        uint64 size;
+        TF_RETURN_IF_ERROR(ReadVarint(&size));
+        return SkipBytes(size);
+      }
+      case kList:
+      case kSet:
+        return ReadList([this](int element_type) {
+          return SkipNested(element_type);
+        });
+      case kMap: {
+        uint64 size;
+        TF_RETURN_IF_ERROR(ReadVarint(&size));
+        if (size == 0) return absl::OkStatus();
+        if (pos_ == end_) return Truncated();
+        const uint8 types = static_cast<uint8>(*pos_++);
+        for (uint64 i = 0; i < size; ++i) {
+          TF_RETURN_IF_ERROR(SkipNested(types >> 4));
+          TF_RETURN_IF_ERROR(SkipNested(types & 0x0f));
+        }
+        return absl::OkStatus();
+      }
+      case kStruct:
+        return ReadStruct(
+            [this](int16 id, int field_type) { return Skip(field_type); });
+      default:
+        return errors::DataLoss("Invalid Thrift type ", type,
+                                " in Parquet metadata");
+    }
+  }
+
+  // Reads the value of an integer field of type `type`.
+  template <typename Int>
+  Status ReadInt(int type, Int* value) {
+    if (type != kByte && type != kI16 && type != kI32 && type != kI64) {
+      return errors::DataLoss("Expected an integer in Parquet metadata, got ",
+                              "Thrift type ", type);
+    }
+    if (type == kByte) {
+      if (pos_ == end_) return Truncated();
+      *value = static_cast<int8>(*pos_++);
+      return absl::OkStatus();
+    }
+    int64_t value64;
+    TF_RETURN_IF_ERROR(ReadI64(&value64));
+    *value = static_cast<Int>(value64);
+    return absl::OkStatus();
+  }
+
+ private:
+  Status SkipNested(int type) {
+    if (++depth_ > kMaxThriftDepth) {
+      return errors::DataLoss("Parquet metadata is nested too deeply");
+    }
+    TF_RETURN_IF_ERROR(Skip(type, /*in_collection=*/true));
+    --depth_;
+    return absl::OkStatus();
+  }
+
+  Status SkipBytes(uint64 n) {
+    if (n > static_cast<uint64>(end_ - pos_)) return Truncated();
+    pos_ += n;
+    return absl::OkStatus();
+  }
+
+  static Status Truncated() {
+    return errors::DataLoss("Truncated Parquet metadata");
+  }
+
+  const char* const data_;
+  const char* pos_;
+  const char* const end_;
+  int depth_ = 0;
+};
+
+struct SchemaElement {
+  int32 type = -1;
+  int32 repetition_type = 0;
+  std::string name;
+  int32 num_children = 0;
+};
+
+Status ReadSchemaElement(ThriftReader* reader, SchemaElement* element) {
+  return reader->ReadStruct([&](int16 id, int type) -> Status {
+    switch (id) {
+      case 1:
+        return reader->ReadInt(type, &element->type);
+      case 3:
+        return reader->ReadInt(type, &element->repetition_type);
+      case 4:
+        return reader->ReadBinary(&element->name);
+      case 5:
+        return reader->ReadInt(type, &element->num_children);
+      default:
+        return reader->Skip(type);
+    }
+  });
+}
+
+Status ReadStatistics(ThriftReader* reader, ParquetColumnChunk* chunk) {
+  // Fields 1 and 2 are the deprecated bounds, which are only used if the
+  // writer did not record fields 5 and 6.
+  std::string deprecated_max, deprecated_min, max_value, min_value;
+  bool has_deprecated_max = false, has_deprecated_min = false;
+  bool has_max_value = false, has_min_value = false;
+  TF_RETURN_IF_ERROR(reader->ReadStruct([&](int16 id, int type) -> Status {
+    switch (id) {
+      case 1:
+        has_deprecated_max = true;
+        return reader->ReadBinary(&deprecated_max);
+      case 2:
+        has_deprecated_min = true;
+        return reader->ReadBinary(&deprecated_min);
+      case 5:
+        has_max_value = true;
+        return reader->ReadBinary(&max_value);
+      case 6:
+        has_min_value = true;
+        return reader->ReadBinary(&min_value);
+      default:
+        return reader->Skip(type);
+    }
+  }));
+  if (has_max_value && has_min_value) {
+    chunk->has_min_max = true;
+    chunk->max = std::move(max_value);
+    chunk->min = std::move(min_value);
+  } else if (has_deprecated_max && has_deprecated_min) {
+    chunk->has_min_max = true;
+    chunk->max = std::move(deprecated_max);
+    chunk->min = std::move(deprecated_min);
+  }
+  return absl::OkStatus();
+}
+
+Status ReadColumnMetaData(ThriftReader* reader, ParquetColumnChunk* chunk) {
+  return reader->ReadStruct([&](int16 id, int type) -> Status {
+    switch (id) {
+      case 4:
+        return reader->ReadInt(type, &chunk->codec);
+      case 5:
+        return reader->ReadInt(type, &chunk->num_values);
+      case 7:
+        return reader->ReadInt(type, &chunk->total_compressed_size);
+      case 9:
+        return reader->ReadInt(type, &chunk->data_page_offset);
+      case 11:
+        return reader->ReadInt(type, &chunk->dictionary_page_offset);
+      case 12:
+        return ReadStatistics(reader, chunk);
+      default:
+        return reader->Skip(type);
+    }
+  });
+}
+
+Status ReadColumnChunk(ThriftReader* reader, ParquetColumnChunk* chunk) {
+  bool has_meta_data = false;
+  TF_RETURN_IF_ERROR(reader->ReadStruct([&](int16 id, int type) -> Status {
+    switch (id) {
+      case 1:
+        return errors::Unimplemented(
+            "Parquet column chunks in external files are not supported");
+      case 3:
+        has_meta_data = true;
+        return ReadColumnMetaData(reader, chunk);
+      default:
+        return reader->Skip(type);
+    }
+  }));
+  if (!has_meta_data) {
+    return errors::DataLoss("Parquet column chunk without metadata");
+  }
+  return absl::OkStatus();
+}
+
+Status ReadRowGroup(ThriftReader* reader, ParquetRowGroup* row_group) {
+  return reader->ReadStruct([&](int16 id, int type) -> Status {
+    switch (id) {
+      case 1:
+        return reader->ReadList([&](int element_type) {
+          row_group->columns.emplace_back();
+          return ReadColumnChunk(reader, &row_group->columns.back());
+        });
+      case 3:
+        return reader->ReadInt(type, &row_group->num_rows);
+      default:
+        return reader->Skip(type);
+    }
+  });
+}
+
+// Flattens the schema, which Parquet stores as a depth-first list of its nodes,
+// into its leaf columns. Columns that are nested in groups or repeated are
+// recorded, so that chunks can be matched to columns, but cannot be read.
+Status FlattenSchema(const std::vector<SchemaElement>& schema,
+                     ParquetMetadata* metadata) {
+  if (schema.empty()) {
+    return errors::DataLoss("Parquet file without a schema");
+  }
+  struct Group {
+    int32 remaining_children;
+    std::string prefix;
+    bool nested;
+  };
+  std::vector<Group> groups = {{schema[0].num_children, "", false}};
+  for (size_t i = 1; i < schema.size(); ++i) {
+    while (!groups.empty() && groups.back().remaining_children == 0) {
+      groups.pop_back();
+    }
+    if (groups.empty()) {
+      return errors::DataLoss("Invalid Parquet schema");
+    }
+    Group& parent = groups.back();
+    --parent.remaining_children;
+    const SchemaElement& element = schema[i];
+    const std::string name = parent.prefix + element.name;
+    const bool nested = parent.nested || groups.size() > 1 ||
+                        element.repetition_type == kRepeated;
+    if (element.num_children > 0) {
+      groups.push_back({element.num_children, name + ".", nested});
+      continue;
+    }
+    ParquetColumn column;
+    column.name = name;
+    column.type = static_cast<ParquetType>(element.type);
+    column.optional = element.repetition_type == kOptional;
+    column.nested = nested;
+    metadata->columns.push_back(std::move(column));
+  }
+  return absl::OkStatus();
+}
+
+Status ReadFileMetaData(ThriftReader* reader, ParquetMetadata* metadata) {
+  std::vector<SchemaElement> schema;
+  TF_RETURN_IF_ERROR(reader->ReadStruct([&](int16 id, int type) -> Status {
+    switch (id) {
+      case 2:
+        return reader->ReadList([&](int element_type) {
+          schema.emplace_back();
+          return ReadSchemaElement(reader, &schema.back());
+        });
+      case 3:
+        return reader->ReadInt(type, &metadata->num_rows);
+      case 4:
+        return reader->ReadList([&](int element_type) {
+          metadata->row_groups.emplace_back();
+          return ReadRowGroup(reader, &metadata->row_groups.back());
+        });
+      default:
+        return reader->Skip(type);
+    }
+  }));
+  TF_RETURN_IF_ERROR(FlattenSchema(schema, metadata));
+  for (const ParquetRowGroup& row_group : metadata->row_groups) {
+    if (row_group.columns.size() != metadata->columns.size()) {
+      return errors::DataLoss("Parquet row group has ",
+                              row_group.columns.size(), " columns, expected ",
+                              metadata->columns.size());
+    }
+  }
+  return absl::OkStatus();
+}
+
+struct PageHeader {
+  int32 type = -1;
+  int32 uncompressed_page_size = 0;
+  int32 compressed_page_size = 0;
+  int32 num_values = 0;
+  int32 encoding = 0;
+  int32 definition_level_encoding = kRle;
+  // Only set for v2 data pages.
+  int32 definition_levels_byte_length = 0;
+  int32 repetition_levels_byte_length = 0;
+  bool is_compressed = true;
+};
+
+// Reads the fields shared by the headers of data and dictionary pages.
+Status ReadPageTypeHeader(ThriftReader* reader, int32 page_type,
+                          PageHeader* header) {
+  return reader->ReadStruct([&](int16 id, int type) -> Status {
+    if (id == 1) return reader->ReadInt(type, &header->num_values);
+    if (page_type == kDataPage) {
+      if (id == 2) return reader->ReadInt(type, &header->encoding);
+      if (id == 3) {
+        return reader->ReadInt(type, &header->definition_level_encoding);
+      }
+    } else if (page_type == kDictionaryPage) {
+      if (id == 2) return reader->ReadInt(type, &header->encoding);
+    } else if (page_type == kDataPageV2) {
+      if (id == 4) return reader->ReadInt(type, &header->encoding);
+      if (id == 5) {
+        return reader->ReadInt(type, &header->definition_levels_byte_length);
+      }
+      if (id == 6) {
+        return reader->ReadInt(type, &header->repetition_levels_byte_length);
+      }
+      if (id == 7 && (type == kBoolTrue || type == kBoolFalse)) {
+        header->is_compressed = type == kBoolTrue;
+        return absl::OkStatus();
+      }
+    }
+    return reader->Skip(type);
+  });
+}
+
+Status ReadPageHeader(ThriftReader* reader, PageHeader* header) {
+  return reader->ReadStruct([&](int16 id, int type) -> Status {
+    switch (id) {
+      case 1:
+        return reader->ReadInt(type, &header->type);
+      case 2:
+        return reader->ReadInt(type, &header->uncompressed_page_size);
+      case 3:
+        return reader->ReadInt(type, &header->compressed_page_size);
+      case 5:
+        return ReadPageTypeHeader(reader, kDataPage, header);
+      case 7:
+        return ReadPageTypeHeader(reader, kDictionaryPage, header);
+      case 8:
+        return ReadPageTypeHeader(reader, kDataPageV2, header);
+      default:
+        return reader->Skip(type);
+    }
+  });
+}
+
+Status Decompress(int32 codec, const char* input, size_t input_size,
+                  char* output, size_t output_size) {
+  switch (codec) {
+    case kUncompressed:
+      if (input_size != output_size) {
+        return errors::DataLoss("Parquet page size mismatch");
+      }
+      memcpy(output, input, input_size);
+      return absl::OkStatus();
+    case kSnappy: {
+      size_t uncompressed_size;
+      if (!port::Snappy_GetUncompressedLength(input, input_size,
+                                              &uncompressed_size) ||
+          uncompressed_size != output_size ||
+          !port::Snappy_Uncompress(input, input_size, output)) {
+        return errors::DataLoss("Failed to decompress a SNAPPY Parquet page");
+      }
+      return absl::OkStatus();
+    }
+    case kGzip: {
+      z_stream stream;
+      memset(&stream, 0, sizeof(stream));
+      // Accepts both the gzip and the zlib format.
+      if (inflateInit2(&stream, MAX_WBITS + 32) != Z_OK) {
+        return errors::Internal("Failed to initialize zlib");
+      }
+      stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input));
+      stream.avail_in = input_size;
+      stream.next_out = reinterpret_cast<Bytef*>(output);
+      stream.avail_out = output_size;
+      const int result = inflate(&stream, Z_FINISH);
+      inflateEnd(&stream);
+      if (result != Z_STREAM_END || stream.avail_out != 0) {
+        return errors::DataLoss("Failed to decompress a GZIP Parquet page");
+      }
+      return absl::OkStatus();
+    }
+    default:
+      return errors::Unimplemented("Unsupported Parquet compression codec ",
+                                   codec);
+  }
+}
+
+// Decodes the hybrid of run-length encoding and bit-packing that Parquet uses
+// for levels and dictionary indices.
+class RleBitPackedDecoder {
+ public:
+  RleBitPackedDecoder(const char* data, size_t size, int bit_width)
+      : pos_(reinterpret_cast<const uint8*>(data)),
+        end_(pos_ + size),
+        bit_width_(bit_width) {}
+
+  Status Decode(int64_t n, uint32* out) {
+    while (n > 0) {
+      if (repeat_count_ > 0) {
+        const int64_t count = std::min<int64_t>(n, repeat_count_);
+        std::fill_n(out, count, repeated_value_);
+        out += count;
+        n -= count;
+        repeat_count_ -= count;
+      } else if (packed_count_ > 0) {
+        const int64_t count = std::min<int64_t>(n, packed_count_);
+        for (int64_t i = 0; i < count; ++i) {
+          *out++ = ReadPacked();
+        }
+        n -= count;
+        packed_count_ -= count;
+      } else {
+        TF_RETURN_IF_ERROR(ReadRunHeader());
+      }
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  Status ReadRunHeader() {
+    uint64 header = 0;
+    for (int shift = 0;; shift += 7) {
+      if (pos_ == end_ || shift >= 64) return Truncated();
+      const uint8 byte = *pos_++;
+      header |= static_cast<uint64>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) break;
+    }
+    const uint64 count = header >> 1;
+    if (count == 0) {
+      return errors::DataLoss("Empty run in Parquet levels or indices");
+    }
+    if (header & 1) {
+      // Bit-packed groups of 8 values.
+      const uint64 size = count * bit_width_;
+      if (count > (uint64{1} << 40) ||
+          size > static_cast<uint64>(end_ - pos_)) {
+        return Truncated();
+      }
+      packed_data_ = pos_;
+      packed_end_ = pos_ + size;
+      packed_bit_ = 0;
+      packed_count_ = count * 8;
+      pos_ += size;
+    } else {
+      const int value_size = (bit_width_ + 7) / 8;
+      if (value_size > end_ - pos_) return Truncated();
+      repeated_value_ = 0;
+      for (int i = 0; i < value_size; ++i) {
+        repeated_value_ |= static_cast<uint32>(*pos_++) << (8 * i);
+      }
+      repeat_count_ = count;
+    }
+    return absl::OkStatus();
+  }
+
+  uint32 ReadPacked() {
+    // A value of up to 32 bits starting at any bit of a byte spans at most 5
+    // bytes.
+    const uint8* byte = packed_data_ + (packed_bit_ >> 3);
+    uint64 word = 0;
+    const int64_t available = std::min<int64_t>(5, packed_end_ - byte);
+    for (int64_t i = 0; i < available; ++i) {
+      word |= static_cast<uint64>(byte[i]) << (8 * i);
+    }
+    const uint64 mask = (uint64{1} << bit_width_) - 1;
+    const uint32 value = static_cast<uint32>((word >> (packed_bit_ & 7)) & mask);
+    packed_bit_ += bit_width_;
+    return value;
+  }
+
+  static Status Truncated() {
+    return errors::DataLoss("Truncated Parquet levels or indices");
+  }
+
+  const uint8* pos_;
+  const uint8* const end_;
+  const int bit_width_;
+
+  uint32 repeated_value_ = 0;
+  uint64 repeat_count_ = 0;
+
+  const uint8* packed_data_ = nullptr;
+  const uint8* packed_end_ = nullptr;
+  uint64 packed_bit_ = 0;
+  uint64 packed_count_ = 0;
+};
+
+// Decodes `n` PLAIN-encoded values of type `T` from `data` into `out`, and sets
+// `*size` to the number of bytes consumed.
+template <typename T>
+Status DecodePlain(const char* data, size_t size, int64_t n, T* out,
+                   size_t* consumed) {
+  if (size / sizeof(T) < static_cast<uint64>(n)) {
+    return errors::DataLoss("Truncated Parquet page");
+  }
+  if (port::kLittleEndian) {
+    memcpy(out, data, n * sizeof(T));
+  } else {
+    for (int64_t i = 0; i < n; ++i) {
+      if (sizeof(T) == sizeof(uint32)) {
+        const uint32 bits = core::DecodeFixed32(data + i * sizeof(T));
+        memcpy(&out[i], &bits, sizeof(T));
+      } else {
+        const uint64 bits = core::DecodeFixed64(data + i * sizeof(T));
+        memcpy(&out[i], &bits, sizeof(T));
+      }
+    }
+  }
+  *consumed = n * sizeof(T);
+  return absl::OkStatus();
+}
+
+template <>
+Status DecodePlain<bool>(const char* data, size_t size, int64_t n, bool* out,
+                         size_t* consumed) {
+  if (size < static_cast<uint64>((n + 7) / 8)) {
+    return errors::DataLoss("Truncated Parquet page");
+  }
+  for (int64_t i = 0; i < n; ++i) {
+    out[i] = (static_cast<uint8>(data[i >> 3]) >> (i & 7)) & 1;
+  }
+  *consumed = (n + 7) / 8;
+  return absl::OkStatus();
+}
+
+template <>
+Status DecodePlain<tstring>(const char* data, size_t size, int64_t n,
+                            tstring* out, size_t* consumed) {
+  size_t pos = 0;
+  for (int64_t i = 0; i < n; ++i) {
+    if (size - pos < sizeof(uint32)) {
+      return errors::DataLoss("Truncated Parquet page");
+    }
+    const uint32 length = core::DecodeFixed32(data + pos);
+    pos += sizeof(uint32);
+    if (size - pos < length) {
+      return errors::DataLoss("Truncated Parquet page");
+    }
+    out[i].assign(data + pos, length);
+    pos += length;
+  }
+  *consumed = pos;
+  return absl::OkStatus();
+}
+
+// Decodes the pages of a column chunk into a vector of `T`.
+template <typename T>
+class ColumnChunkDecoder {
+ public:
+  ColumnChunkDecoder(const ParquetColumn& column,
+                     const ParquetColumnChunk& chunk, int64_t num_rows,
+                     T* values, std::vector<bool>* nulls)
+      : column_(column),
+        chunk_(chunk),
+        num_rows_(num_rows),
+        values_(values),
+        nulls_(nulls) {}
+
+  Status Decode(const char* data, size_t size) {
+    size_t pos = 0;
+    while (row_ < num_rows_ && pos < size) {
+      ThriftReader reader(data + pos, size - pos);
+      PageHeader header;
+      TF_RETURN_IF_ERROR(ReadPageHeader(&reader, &header));
+      pos += reader.position();
+      if (header.compressed_page_size < 0 ||
+          static_cast<size_t>(header.compressed_page_size) > size - pos ||
+          header.uncompressed_page_size < 0) {
+        return errors::DataLoss("Truncated Parquet column chunk");
+      }
+      const char* page = data + pos;
+      pos += header.compressed_page_size;
+      switch (header.type) {
+        case kDictionaryPage:
+          TF_RETURN_IF_ERROR(DecodeDictionaryPage(header, page));
+          break;
+        case kDataPage:
+        case kDataPageV2:
+          TF_RETURN_IF_ERROR(DecodeDataPage(header, page));
+          break;
+        default:
+          // Index pages carry no values.
+          break;
+      }
+    }
+    if (row_ != num_rows_) {
+      return errors::DataLoss("Parquet column chunk of ", column_.name,
+                              " has ", row_, " values, expected ", num_rows_);
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  Status DecodeDictionaryPage(const PageHeader& header, const char* page) {
+    if (header.encoding != kPlain && header.encoding != kPlainDictionary) {
+      return errors::Unimplemented("Unsupported Parquet dictionary encoding ",
+                                   header.encoding);
+    }
+    if (header.num_values < 0) {
+      return errors::DataLoss("Invalid Parquet dictionary page");
+    }
+    std::string buffer(header.uncompressed_page_size, '\0');
+    TF_RETURN_IF_ERROR(Decompress(chunk_.codec, page,
+                                  header.compressed_page_size, &buffer[0],
+                                  buffer.size()));
+    dictionary_size_ = header.num_values;
+    dictionary_ = std::make_unique<T[]>(dictionary_size_);
+    size_t consumed;
+    return DecodePlain<T>(buffer.data(), buffer.size(), dictionary_size_,
+                          dictionary_.get(), &consumed);
+  }
+
+  Status DecodeDataPage(const PageHeader& header, const char* page) {
+    const int64_t num_values = header.num_values;
+    if (num_values < 0 || num_values > num_rows_ - row_) {
+      return errors::DataLoss("Parquet column chunk of ", column_.name,
+                              " has more values than rows");
+    }
+
+    // Decompress the page. The levels of v2 pages are never compressed.
+    std::string buffer(header.uncompressed_page_size, '\0');
+    size_t levels_size = 0;
+    if (header.type == kDataPageV2) {
+      if (header.definition_levels_byte_length < 0 ||
+          header.repetition_levels_byte_length != 0) {
+        return errors::Unimplemented("Repeated Parquet columns are not ",
+                                     "supported");
+      }
+      levels_size = header.definition_levels_byte_length;
+      if (levels_size > buffer.size() ||
+          levels_size > static_cast<size_t>(header.compressed_page_size)) {
+        return errors::DataLoss("Invalid Parquet data page");
+      }
+      memcpy(&buffer[0], page, levels_size);
+    }
+    TF_RETURN_IF_ERROR(Decompress(
+        header.is_compressed ? chunk_.codec : kUncompressed, page + levels_size,
+        header.compressed_page_size - levels_size, &buffer[levels_size],
+        buffer.size() - levels_size));
+    const char* data = buffer.data();
+    size_t size = buffer.size();
+
+    // Definition levels mark the nulls of optional columns.
+    int64_t num_defined = num_values;
+    std::vector<uint32> levels;
+    if (column_.optional) {
+      size_t definition_levels_size = levels_size;
+      if (header.type == kDataPage) {
+        if (header.definition_level_encoding != kRle) {
+          return errors::Unimplemented(
+              "Unsupported Parquet definition level encoding ",
+              header.definition_level_encoding);
+        }
+        if (size < sizeof(uint32)) {
+          return errors::DataLoss("Truncated Parquet data page");
+        }
+        definition_levels_size = core::DecodeFixed32(data);
+        data += sizeof(uint32);
+        size -= sizeof(uint32);
+        if (definition_levels_size > size) {
+          return errors::DataLoss("Truncated Parquet data page");
+        }
+      }
+      levels.resize(num_values);
+      RleBitPackedDecoder decoder(data, definition_levels_size,
+                                  /*bit_width=*/1);
+      TF_RETURN_IF_ERROR(decoder.Decode(num_values, levels.data()));
+      data += definition_levels_size;
+      size -= definition_levels_size;
+      num_defined = std::count(levels.begin(), levels.end(), 1);
+    } else {
+      data += levels_size;
+      size -= levels_size;
+    }
+
+    // Decode the defined values into the front of the page's rows.
+    T* out = values_ + row_;
+    switch (header.encoding) {
+      case kPlain: {
+        size_t consumed;
+        TF_RETURN_IF_ERROR(DecodePlain<T>(data, size, num_defined, out,
+                                          &consumed));
+        break;
+      }
+      case kPlainDictionary:
+      case kRleDictionary: {
+        if (!dictionary_) {
+          return errors::DataLoss("Parquet column chunk of ", column_.name,
+                                  " has no dictionary page");
+        }
+        if (size < 1 || static_cast<uint8>(data[0]) > 32) {
+          return errors::DataLoss("Invalid Parquet dictionary indices");
+        }
+        std::vector<uint32> indices(num_defined);
+        RleBitPackedDecoder decoder(data + 1, size - 1,
+                                    static_cast<uint8>(data[0]));
+        TF_RETURN_IF_ERROR(decoder.Decode(num_defined, indices.data()));
+        for (int64_t i = 0; i < num_defined; ++i) {
+          if (indices[i] >= dictionary_size_) {
+            return errors::DataLoss("Invalid Parquet dictionary index ",
+                                    indices[i]);
+          }
+          out[i] = dictionary_[indices[i]];
+        }
+        break;
+      }
+      default:
+        return errors::Unimplemented("Unsupported Parquet encoding ",
+                                     header.encoding);
+    }
+
+    // Spread the defined values over the rows, back to front so that no value
+    // is overwritten before it is moved.
+    if (nulls_ != nullptr && column_.optional) {
+      for (int64_t i = 0; i < num_values; ++i) {
+        (*nulls_)[row_ + i] = levels[i] == 0;
+      }
+    }
+    if (num_defined < num_values) {
+      int64_t j = num_defined;
+      for (int64_t i = num_values - 1; i >= 0; --i) {
+        if (levels[i] != 0) {
+          out[i] = std::move(out[--j]);
+        } else {
+          out[i] = T();
+        }
+      }
+    }
+    row_ += num_values;
+    return absl::OkStatus();
+  }
+
+  const ParquetColumn& column_;
+  const ParquetColumnChunk& chunk_;
+  const int64_t num_rows_;
+  T* const values_;
+  std::vector<bool>* const nulls_;
+  int64_t row_ = 0;
+
+  std::unique_ptr<T[]> dictionary_;
+  int64_t dictionary_size_ = 0;
+};
+
+template <typename T>
+Status DecodeColumnChunk(const ParquetColumn& column,
+                         const ParquetColumnChunk& chunk, int64_t num_rows,
+                         const char* data, size_t size, Tensor* values,
+                         std::vector<bool>* nulls) {
+  ColumnChunkDecoder<T> decoder(column, chunk, num_rows,
+                                values->flat<T>().data(), nulls);
+  return decoder.Decode(data, size);
+}
+
+}  // namespace
+
+DataType ParquetTypeToDataType(ParquetType type) {
+  switch (type) {
+    case ParquetType::kBoolean:
+      return DT_BOOL;
+    case ParquetType::kInt32:
+      return DT_INT32;
+    case ParquetType::kInt64:
+      return DT_INT64;
+    case ParquetType::kFloat:
+      return DT_FLOAT;
+    case ParquetType::kDouble:
+      return DT_DOUBLE;
+    case ParquetType::kByteArray:
+      return DT_STRING;
+    default:
+      return DT_INVALID;
+  }
+}
+
+Status ReadParquetMetadata(RandomAccessFile* file, uint64 file_size,
+                           ParquetMetadata* metadata) {
+  if (file_size < kMagicSize + kFooterSize) {
+    return errors::DataLoss("File is too small to be a Parquet file");
+  }
+  char footer[kFooterSize];
+  StringPiece result;
+  TF_RETURN_IF_ERROR(
+      file->Read(file_size - kFooterSize, kFooterSize, &result, footer));
+  if (result.size() != kFooterSize ||
+      memcmp(result.data() + sizeof(uint32), kMagic, kMagicSize) != 0) {
+    return errors::DataLoss("Not a Parquet file (or an encrypted one)");
+  }
+  const uint32 metadata_size = core::DecodeFixed32(result.data());
+  if (metadata_size > file_size - kMagicSize - kFooterSize) {
+    return errors::DataLoss("Invalid Parquet metadata size ", metadata_size);
+  }
+  std::string buffer(metadata_size, '\0');
+  TF_RETURN_IF_ERROR(file->Read(file_size - kFooterSize - metadata_size,
+                                metadata_size, &result, &buffer[0]));
+  if (result.size() != metadata_size) {
+    return errors::DataLoss("Truncated Parquet metadata");
+  }
+  *metadata = ParquetMetadata();
+  ThriftReader reader(result.data(), result.size());
+  return ReadFileMetaData(&reader, metadata);
+}
+
+bool GetParquetColumnBounds(const ParquetMetadata& metadata,
+                            const ParquetRowGroup& row_group, int column,
+                            double* min, double* max) {
+  const ParquetColumnChunk& chunk = row_group.columns[column];
+  if (!chunk.has_min_max) return false;
+  auto decode = [&](const std::string& bound, double* value) {
+    switch (metadata.columns[column].type) {
+      case ParquetType::kInt32:
+        if (bound.size() != sizeof(int32)) return false;
+        *value = static_cast<int32>(core::DecodeFixed32(bound.data()));
+        return true;
+      case ParquetType::kInt64:
+        if (bound.size() != sizeof(int64_t)) return false;
+        *value = static_cast<int64_t>(core::DecodeFixed64(bound.data()));
+        return true;
+      case ParquetType::kFloat: {
+        if (bound.size() != sizeof(float)) return false;
+        const uint32 bits = core::DecodeFixed32(bound.data());
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        *value = f;
+        return true;
+      }
+      case ParquetType::kDouble: {
+        if (bound.size() != sizeof(double)) return false;
+        const uint64 bits = core::DecodeFixed64(bound.data());
+        memcpy(value, &bits, sizeof(*value));
+        return true;
+      }
+      default:
+        return false;
+    }
+  };
+  return decode(chunk.min, min) && decode(chunk.max, max);
+}
+
+Status ReadParquetColumn(RandomAccessFile* file,
+                         const ParquetMetadata& metadata,
+                         const ParquetRowGroup& row_group, int column,
+                         Tensor* values, std::vector<bool>* nulls) {
+  const ParquetColumn& parquet_column = metadata.columns[column];
+  const ParquetColumnChunk& chunk = row_group.columns[column];
+  if (parquet_column.nested) {
+    return errors::Unimplemented("Nested or repeated Parquet column ",
+                                 parquet_column.name, " is not supported");
+  }
+  const DataType dtype = ParquetTypeToDataType(parquet_column.type);
+  if (dtype == DT_INVALID) {
+    return errors::Unimplemented("Parquet column ", parquet_column.name,
+                                 " has unsupported type ",
+                                 static_cast<int>(parquet_column.type));
+  }
+  if (row_group.num_rows < 0 || chunk.num_values != row_group.num_rows) {
+    return errors::DataLoss("Parquet column chunk of ", parquet_column.name,
+                            " has ", chunk.num_values, " values, expected ",
+                            row_group.num_rows);
+  }
+
+  // The chunk starts with its dictionary page, if any. Some writers set the
+  // dictionary offset to 0 when there is none.
+  int64_t offset = chunk.data_page_offset;
+  if (chunk.dictionary_page_offset > 0 &&
+      chunk.dictionary_page_offset < offset) {
+    offset = chunk.dictionary_page_offset;
+  }
+  if (offset < 0 || chunk.total_compressed_size < 0) {
+    return errors::DataLoss("Invalid Parquet column chunk of ",
+                            parquet_column.name);
+  }
+  std::string buffer(chunk.total_compressed_size, '\0');
+  StringPiece data;
+  Status s = file->Read(offset, buffer.size(), &data, &buffer[0]);
+  if (errors::IsOutOfRange(s)) {
+    return errors::DataLoss("Truncated Parquet column chunk of ",
+                            parquet_column.name);
+  }
+  TF_RETURN_IF_ERROR(s);
+
+  *values = Tensor(dtype, TensorShape({row_group.num_rows}));
+  if (nulls != nullptr) {
+    nulls->assign(row_group.num_rows, false);
+  }
+  switch (dtype) {
+#define HANDLE_TYPE(T)                                                      \
+  case DataTypeToEnum<T>::value:                                            \
+    return DecodeColumnChunk<T>(parquet_column, chunk, row_group.num_rows, \
+                                data.data(), data.size(), values, nulls);
+    TF_CALL_bool(HANDLE_TYPE);
+    TF_CALL_int32(HANDLE_TYPE);
+    TF_CALL_int64(HANDLE_TYPE);
+    TF_CALL_float(HANDLE_TYPE);
+    TF_CALL_double(HANDLE_TYPE);
+    TF_CALL_tstring(HANDLE_TYPE);
+#undef HANDLE_TYPE
+    default:
+      return errors::Unimplemented("Unsupported dtype ",
+                                   DataTypeString(dtype));
+  }
+}
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
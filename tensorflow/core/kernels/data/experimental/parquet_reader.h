@@ -0,0 +1,113 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_PARQUET_READER_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_PARQUET_READER_H_
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// A reader for the subset of the Parquet format that maps onto flat tensors:
+//
+//  * flat schemas, whose columns are REQUIRED or OPTIONAL leaves of the root;
+//  * BOOLEAN, INT32, INT64, FLOAT, DOUBLE and BYTE_ARRAY columns;
+//  * UNCOMPRESSED, SNAPPY and GZIP column chunks;
+//  * v1 and v2 data pages in the PLAIN, PLAIN_DICTIONARY and RLE_DICTIONARY
+//    encodings.
+//
+// Files using other features are reported as Unimplemented when the affected
+// column is read.
+
+// Physical types, with the values used in the Parquet format.
+enum class ParquetType {
+  kBoolean = 0,
+  kInt32 = 1,
+  kInt64 = 2,
+  kInt96 = 3,
+  kFloat = 4,
+  kDouble = 5,
+  kByteArray = 6,
+  kFixedLenByteArray = 7,
+};
+
+struct ParquetColumnChunk {
+  int32 codec = 0;
+  int64_t num_values = 0;
+  int64_t data_page_offset = -1;
+  int64_t dictionary_page_offset = -1;
+  int64_t total_compressed_size = 0;
+  // PLAIN-encoded bounds of the values in the chunk, if the writer recorded
+  // them.
+  bool has_min_max = false;
+  std::string min;
+  std::string max;
+};
+
+struct ParquetRowGroup {
+  int64_t num_rows = 0;
+  // Indexed like `ParquetMetadata::columns`.
+  std::vector<ParquetColumnChunk> columns;
+};
+
+struct ParquetColumn {
+  std::string name;
+  ParquetType type = ParquetType::kInt32;
+  bool optional = false;
+  // Set for columns that are repeated or nested in a group, which cannot be
+  // read.
+  bool nested = false;
+};
+
+struct ParquetMetadata {
+  int64_t num_rows = 0;
+  std::vector<ParquetColumn> columns;
+  std::vector<ParquetRowGroup> row_groups;
+};
+
+// Returns the dtype that a column of physical type `type` decodes to, or
+// DT_INVALID if the type is not supported.
+DataType ParquetTypeToDataType(ParquetType type);
+
+// Reads the metadata in the footer of `file`, which is `file_size` bytes long.
+Status ReadParquetMetadata(RandomAccessFile* file, uint64 file_size,
+                           ParquetMetadata* metadata);
+
+// Returns the bounds recorded for column `column` of `row_group` as doubles.
+// Returns false if there are none, or if the column is not numeric.
+bool GetParquetColumnBounds(const ParquetMetadata& metadata,
+                            const ParquetRowGroup& row_group, int column,
+                            double* min, double* max);
+
+// Decodes column `column` of `row_group` into `values`, a vector with one
+// element per row. If `nulls` is not null, it is resized to the number of rows
+// and marks the null values, which are left value-initialized in `values`.
+Status ReadParquetColumn(RandomAccessFile* file,
+                         const ParquetMetadata& metadata,
+                         const ParquetRowGroup& row_group, int column,
+                         Tensor* values, std::vector<bool>* nulls);
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_PARQUET_READER_H_
@@ -0,0 +1,551 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/parquet_reader.h"
+
+#include <zlib.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+// Writes structures in the Thrift compact protocol.
+class ThriftWriter {
+ public:
+  ThriftWriter() : last_ids_({0}) {}
+
+  void I32(int16 id, int32 value) { Int(id, /*type=*/5, value); }
+  void I64(int16 id, int64_t value) { Int(id, /*type=*/6, value); }
+  void Binary(int16 id, const std::string& value) {
+    FieldHeader(id, /*type=*/8);
+    Varint(value.size());
+    data_.append(value);
+  }
+  void BeginStruct(int16 id) {
+    FieldHeader(id, /*type=*/12);
+    last_ids_.push_back(0);
+  }
+  // Starts a list of `size` structs, each of which starts with
+  // `BeginListElement()`.
+  void BeginList(int16 id, int size) {
+    FieldHeader(id, /*type=*/9);
+    if (size < 15) {
+      data_.push_back(static_cast<char>(size << 4 | 12));
+    } else {
+      data_.push_back(static_cast<char>(0xf0 | 12));
+      Varint(size);
+    }
+  }
+  void BeginListElement() { last_ids_.push_back(0); }
+  void End() {
+    data_.push_back(0);
+    last_ids_.pop_back();
+  }
+
+  std::string Finish() {
+    data_.push_back(0);
+    return data_;
+  }
+
+ private:
+  void Int(int16 id, int type, int64_t value) {
+    FieldHeader(id, type);
+    Varint((static_cast<uint64>(value) << 1) ^ (value >> 63));
+  }
+  void FieldHeader(int16 id, int type) {
+    const int16 delta = id - last_ids_.back();
+    if (delta > 0 && delta < 16) {
+      data_.push_back(static_cast<char>(delta << 4 | type));
+    } else {
+      data_.push_back(static_cast<char>(type));
+      Varint((static_cast<uint64>(id) << 1) ^ (id >> 15));
+    }
+    last_ids_.back() = id;
+  }
+  void Varint(uint64 value) {
+    while (value >= 0x80) {
+      data_.push_back(static_cast<char>(value | 0x80));
+      value >>= 7;
+    }
+    data_.push_back(static_cast<char>(value));
+  }
+
+  std::string data_;
+  std::vector<int16> last_ids_;
+};
+
+std::string Fixed32(uint32 value) {
+  char buf[4];
+  core::EncodeFixed32(buf, value);
+  return std::string(buf, 4);
+}
+
+std::string Fixed64(uint64 value) {
+  char buf[8];
+  core::EncodeFixed64(buf, value);
+  return std::string(buf, 8);
+}
+
+std::string PlainInt64s(const std::vector<int64_t>& values) {
+  std::string result;
+  for (int64_t value : values) result += Fixed64(value);
+  return result;
+}
+
+std::string PlainDoubles(const std::vector<double>& values) {
+  std::string result;
+  for (double value : values) {
+    uint64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    result += Fixed64(bits);
+  }
+  return result;
+}
+
+std::string PlainInt32s(const std::vector<int32>& values) {
+  std::string result;
+  for (int32 value : values) result += Fixed32(value);
+  return result;
+}
+
+std::string PlainStrings(const std::vector<std::string>& values) {
+  std::string result;
+  for (const std::string& value : values) {
+    result += Fixed32(value.size());
+    result += value;
+  }
+  return result;
+}
+
+std::string PlainBools(const std::vector<bool>& values) {
+  std::string result((values.size() + 7) / 8, '\0');
+  for (size_t i = 0; i < values.size(); ++i) {
+    if (values[i]) result[i / 8] |= 1 << (i % 8);
+  }
+  return result;
+}
+
+// Encodes `values` as one run-length encoded run per group of equal values.
+std::string RleRuns(const std::vector<uint32>& values, int bit_width) {
+  std::string result;
+  for (size_t i = 0; i < values.size();) {
+    size_t j = i;
+    while (j < values.size() && values[j] == values[i]) ++j;
+    result.push_back(static_cast<char>((j - i) << 1));
+    for (int b = 0; b < (bit_width + 7) / 8; ++b) {
+      result.push_back(static_cast<char>(values[i] >> (8 * b)));
+    }
+    i = j;
+  }
+  return result;
+}
+
+// Encodes `values` as a single bit-packed run.
+std::string BitPacked(const std::vector<uint32>& values, int bit_width) {
+  const size_t num_groups = (values.size() + 7) / 8;
+  std::string result(1, static_cast<char>(num_groups << 1 | 1));
+  std::string packed(num_groups * bit_width, '\0');
+  for (size_t i = 0; i < values.size(); ++i) {
+    for (int b = 0; b < bit_width; ++b) {
+      if ((values[i] >> b) & 1) {
+        const size_t bit = i * bit_width + b;
+        packed[bit / 8] |= 1 << (bit % 8);
+      }
+    }
+  }
+  return result + packed;
+}
+
+std::string Gzip(const std::string& data) {
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  CHECK_EQ(deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                        MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY),
+           Z_OK);
+  std::string result(deflateBound(&stream, data.size()) + 32, '\0');
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  stream.avail_in = data.size();
+  stream.next_out = reinterpret_cast<Bytef*>(&result[0]);
+  stream.avail_out = result.size();
+  CHECK_EQ(deflate(&stream, Z_FINISH), Z_STREAM_END);
+  result.resize(stream.total_out);
+  deflateEnd(&stream);
+  return result;
+}
+
+constexpr int32 kDataPage = 0;
+constexpr int32 kDictionaryPage = 2;
+constexpr int32 kDataPageV2 = 3;
+constexpr int32 kPlain = 0;
+constexpr int32 kRle = 3;
+constexpr int32 kRleDictionary = 8;
+constexpr int32 kUncompressed = 0;
+constexpr int32 kGzip = 2;
+
+struct TestPage {
+  int32 type = kDataPage;
+  int32 num_values = 0;
+  int32 encoding = kPlain;
+  // The page as stored, i.e. compressed if the chunk is.
+  std::string body;
+  int32 uncompressed_size = -1;
+  // For v2 data pages.
+  int32 num_nulls = 0;
+  int32 definition_levels_byte_length = 0;
+};
+
+TestPage DataPage(int32 num_values, std::string body,
+                  int32 encoding = kPlain) {
+  TestPage page;
+  page.num_values = num_values;
+  page.encoding = encoding;
+  page.body = std::move(body);
+  return page;
+}
+
+// Returns a v1 data page of an optional column, whose nulls are given by
+// `definition_levels`.
+TestPage OptionalDataPage(const std::vector<uint32>& definition_levels,
+                          const std::string& values) {
+  const std::string levels = RleRuns(definition_levels, /*bit_width=*/1);
+  return DataPage(definition_levels.size(),
+                  Fixed32(levels.size()) + levels + values);
+}
+
+TestPage DictionaryPage(int32 num_values, std::string body) {
+  TestPage page = DataPage(num_values, std::move(body));
+  page.type = kDictionaryPage;
+  return page;
+}
+
+struct TestColumnChunk {
+  std::vector<TestPage> pages;
+  int32 codec = kUncompressed;
+  std::string min;
+  std::string max;
+};
+
+struct TestColumn {
+  std::string name;
+  ParquetType type;
+  int32 repetition_type;  // 0 for required, 1 for optional.
+};
+
+struct TestRowGroup {
+  int64_t num_rows;
+  std::vector<TestColumnChunk> columns;
+};
+
+std::string SerializePageHeader(const TestPage& page) {
+  ThriftWriter writer;
+  writer.I32(1, page.type);
+  writer.I32(2, page.uncompressed_size >= 0 ? page.uncompressed_size
+                                            : page.body.size());
+  writer.I32(3, page.body.size());
+  if (page.type == kDataPage) {
+    writer.BeginStruct(5);
+    writer.I32(1, page.num_values);
+    writer.I32(2, page.encoding);
+    writer.I32(3, kRle);
+    writer.I32(4, kRle);
+    writer.End();
+  } else if (page.type == kDictionaryPage) {
+    writer.BeginStruct(7);
+    writer.I32(1, page.num_values);
+    writer.I32(2, kPlain);
+    writer.End();
+  } else {
+    writer.BeginStruct(8);
+    writer.I32(1, page.num_values);
+    writer.I32(2, page.num_nulls);
+    writer.I32(3, page.num_values);
+    writer.I32(4, page.encoding);
+    writer.I32(5, page.definition_levels_byte_length);
+    writer.I32(6, 0);
+    writer.End();
+  }
+  return writer.Finish();
+}
+
+// Writes a Parquet file with the given columns. If `group_children` is
+// positive, the last `group_children` columns are nested in a group named
+// "group".
+std::string SerializeFile(const std::vector<TestColumn>& columns,
+                          const std::vector<TestRowGroup>& row_groups,
+                          int group_children = 0) {
+  std::string file = "PAR1";
+  std::vector<std::vector<std::pair<int64_t, int64_t>>> chunk_ranges;
+  for (const TestRowGroup& row_group : row_groups) {
+    chunk_ranges.emplace_back();
+    for (const TestColumnChunk& chunk : row_group.columns) {
+      const int64_t offset = file.size();
+      for (const TestPage& page : chunk.pages) {
+        file += SerializePageHeader(page);
+        file += page.body;
+      }
+      chunk_ranges.back().emplace_back(offset, file.size() - offset);
+    }
+  }
+
+  ThriftWriter writer;
+  writer.I32(1, 1);
+  const bool nested = group_children > 0;
+  writer.BeginList(2, columns.size() + 1 + nested);
+  writer.BeginListElement();
+  writer.Binary(4, "schema");
+  writer.I32(5, columns.size() - group_children + nested);
+  writer.End();
+  for (size_t i = 0; i < columns.size(); ++i) {
+    if (nested && i == columns.size() - group_children) {
+      writer.BeginListElement();
+      writer.I32(3, 0);
+      writer.Binary(4, "group");
+      writer.I32(5, group_children);
+      writer.End();
+    }
+    writer.BeginListElement();
+    writer.I32(1, static_cast<int32>(columns[i].type));
+    writer.I32(3, columns[i].repetition_type);
+    writer.Binary(4, columns[i].name);
+    writer.End();
+  }
+  int64_t num_rows = 0;
+  for (const TestRowGroup& row_group : row_groups) {
+    num_rows += row_group.num_rows;
+  }
+  writer.I64(3, num_rows);
+  writer.BeginList(4, row_groups.size());
+  for (size_t r = 0; r < row_groups.size(); ++r) {
+    const TestRowGroup& row_group = row_groups[r];
+    writer.BeginListElement();
+    writer.BeginList(1, row_group.columns.size());
+    for (size_t c = 0; c < row_group.columns.size(); ++c) {
+      const TestColumnChunk& chunk = row_group.columns[c];
+      const auto [offset, size] = chunk_ranges[r][c];
+      int64_t data_page_offset = offset;
+      int64_t dictionary_page_offset = -1;
+      if (chunk.pages.front().type == kDictionaryPage) {
+        dictionary_page_offset = offset;
+        data_page_offset += SerializePageHeader(chunk.pages.front()).size() +
+                            chunk.pages.front().body.size();
+      }
+      int64_t num_values = 0;
+      for (const TestPage& page : chunk.pages) {
+        if (page.type != kDictionaryPage) num_values += page.num_values;
+      }
+      writer.BeginListElement();
+      writer.I64(2, offset);
+      writer.BeginStruct(3);
+      writer.I32(1, static_cast<int32>(columns[c].type));
+      writer.I32(4, chunk.codec);
+      writer.I64(5, num_values);
+      writer.I64(6, size);
+      writer.I64(7, size);
+      writer.I64(9, data_page_offset);
+      if (dictionary_page_offset >= 0) {
+        writer.I64(11, dictionary_page_offset);
+      }
+      if (!chunk.min.empty()) {
+        writer.BeginStruct(12);
+        writer.Binary(5, chunk.max);
+        writer.Binary(6, chunk.min);
+        writer.End();
+      }
+      writer.End();
+      writer.End();
+    }
+    writer.I64(2, 0);
+    writer.I64(3, row_group.num_rows);
+    writer.End();
+  }
+  const std::string metadata = writer.Finish();
+  return file + metadata + Fixed32(metadata.size()) + "PAR1";
+}
+
+class ParquetReaderTest : public ::testing::Test {
+ protected:
+  Status Open(const std::string& contents) {
+    const std::string filename =
+        io::JoinPath(testing::TmpDir(), "parquet_reader_test.parquet");
+    TF_RETURN_IF_ERROR(WriteStringToFile(Env::Default(), filename, contents));
+    TF_RETURN_IF_ERROR(Env::Default()->NewRandomAccessFile(filename, &file_));
+    return ReadParquetMetadata(file_.get(), contents.size(), &metadata_);
+  }
+
+  std::unique_ptr<RandomAccessFile> file_;
+  ParquetMetadata metadata_;
+};
+
+TEST_F(ParquetReaderTest, ReadsColumns) {
+  const std::vector<TestColumn> columns = {
+      {"id", ParquetType::kInt64, 0},
+      {"score", ParquetType::kDouble, 1},
+      {"label", ParquetType::kByteArray, 1},
+      {"flag", ParquetType::kBoolean, 0},
+  };
+  TestRowGroup first = {3, {}};
+  first.columns.push_back(
+      {{DataPage(3, PlainInt64s({1, 2, 3}))}, kUncompressed, Fixed64(1),
+       Fixed64(3)});
+  first.columns.push_back(
+      {{OptionalDataPage({1, 0, 1}, PlainDoubles({0.5, 2.5}))}});
+  // Dictionary indices 1, 0, 1 for the non-null values.
+  first.columns.push_back(
+      {{DictionaryPage(2, PlainStrings({"cat", "dog"})),
+        DataPage(3, Fixed32(RleRuns({1, 1, 1}, 1).size()) +
+                        RleRuns({1, 1, 1}, 1) + std::string(1, 1) +
+                        BitPacked({1, 0, 1}, 1),
+                 kRleDictionary)}});
+  first.columns.push_back({{DataPage(3, PlainBools({true, false, true}))}});
+  TestRowGroup second = {2, {}};
+  second.columns.push_back(
+      {{DataPage(1, PlainInt64s({10})), DataPage(1, PlainInt64s({11}))},
+       kUncompressed,
+       Fixed64(10),
+       Fixed64(11)});
+  second.columns.push_back({{OptionalDataPage({0, 0}, "")}});
+  second.columns.push_back(
+      {{OptionalDataPage({1, 1}, PlainStrings({"x", "yz"}))}});
+  second.columns.push_back({{DataPage(2, PlainBools({false, true}))}});
+  TF_ASSERT_OK(Open(SerializeFile(columns, {first, second})));
+
+  EXPECT_EQ(metadata_.num_rows, 5);
+  ASSERT_EQ(metadata_.columns.size(), 4);
+  EXPECT_EQ(metadata_.columns[1].name, "score");
+  EXPECT_TRUE(metadata_.columns[1].optional);
+  EXPECT_FALSE(metadata_.columns[1].nested);
+  EXPECT_EQ(ParquetTypeToDataType(metadata_.columns[2].type), DT_STRING);
+  ASSERT_EQ(metadata_.row_groups.size(), 2);
+
+  double min, max;
+  ASSERT_TRUE(GetParquetColumnBounds(metadata_, metadata_.row_groups[1], 0,
+                                     &min, &max));
+  EXPECT_EQ(min, 10);
+  EXPECT_EQ(max, 11);
+  EXPECT_FALSE(GetParquetColumnBounds(metadata_, metadata_.row_groups[1], 1,
+                                      &min, &max));
+
+  Tensor values;
+  std::vector<bool> nulls;
+  TF_ASSERT_OK(ReadParquetColumn(file_.get(), metadata_,
+                                 metadata_.row_groups[0], 0, &values, &nulls));
+  test::ExpectTensorEqual<int64_t>(values, test::AsTensor<int64_t>({1, 2, 3}));
+  EXPECT_EQ(nulls, std::vector<bool>({false, false, false}));
+  TF_ASSERT_OK(ReadParquetColumn(file_.get(), metadata_,
+                                 metadata_.row_groups[1], 0, &values, &nulls));
+  test::ExpectTensorEqual<int64_t>(values, test::AsTensor<int64_t>({10, 11}));
+
+  TF_ASSERT_OK(ReadParquetColumn(file_.get(), metadata_,
+                                 metadata_.row_groups[0], 1, &values, &nulls));
+  test::ExpectTensorEqual<double>(values,
+                                  test::AsTensor<double>({0.5, 0, 2.5}));
+  EXPECT_EQ(nulls, std::vector<bool>({false, true, false}));
+  TF_ASSERT_OK(ReadParquetColumn(file_.get(), metadata_,
+                                 metadata_.row_groups[1], 1, &values, &nulls));
+  EXPECT_EQ(nulls, std::vector<bool>({true, true}));
+
+  TF_ASSERT_OK(ReadParquetColumn(file_.get(), metadata_,
+                                 metadata_.row_groups[0], 2, &values, &nulls));
+  test::ExpectTensorEqual<tstring>(
+      values, test::AsTensor<tstring>({"dog", "cat", "dog"}));
+  TF_ASSERT_OK(ReadParquetColumn(file_.get(), metadata_,
+                                 metadata_.row_groups[1], 2, &values,
+                                 /*nulls=*/nullptr));
+  test::ExpectTensorEqual<tstring>(values, test::AsTensor<tstring>({"x", "yz"}));
+
+  TF_ASSERT_OK(ReadParquetColumn(file_.get(), metadata_,
+                                 metadata_.row_groups[0], 3, &values, &nulls));
+  test::ExpectTensorEqual<bool>(values,
+                                test::AsTensor<bool>({true, false, true}));
+}
+
+TEST_F(ParquetReaderTest, ReadsCompressedDataPageV2) {
+  const std::string levels = RleRuns({1, 1, 0, 1}, /*bit_width=*/1);
+  const std::string values = PlainInt32s({7, -8, 9});
+  TestPage page = DataPage(4, levels + Gzip(values));
+  page.type = kDataPageV2;
+  page.uncompressed_size = levels.size() + values.size();
+  page.num_nulls = 1;
+  page.definition_levels_byte_length = levels.size();
+  TestColumnChunk chunk = {{page}, kGzip};
+  TF_ASSERT_OK(Open(SerializeFile({{"value", ParquetType::kInt32, 1}},
+                                  {{4, {chunk}}})));
+
+  Tensor tensor;
+  std::vector<bool> nulls;
+  TF_ASSERT_OK(ReadParquetColumn(file_.get(), metadata_,
+                                 metadata_.row_groups[0], 0, &tensor, &nulls));
+  test::ExpectTensorEqual<int32>(tensor, test::AsTensor<int32>({7, -8, 0, 9}));
+  EXPECT_EQ(nulls, std::vector<bool>({false, false, true, false}));
+}
+
+TEST_F(ParquetReaderTest, NestedColumnsAreUnimplemented) {
+  const std::vector<TestColumn> columns = {
+      {"id", ParquetType::kInt64, 0},
+      {"inner", ParquetType::kInt64, 0},
+  };
+  TestRowGroup row_group = {1, {}};
+  row_group.columns.push_back({{DataPage(1, PlainInt64s({1}))}});
+  row_group.columns.push_back({{DataPage(1, PlainInt64s({2}))}});
+  TF_ASSERT_OK(
+      Open(SerializeFile(columns, {row_group}, /*group_children=*/1)));
+  ASSERT_EQ(metadata_.columns.size(), 2);
+  EXPECT_FALSE(metadata_.columns[0].nested);
+  EXPECT_EQ(metadata_.columns[1].name, "group.inner");
+  EXPECT_TRUE(metadata_.columns[1].nested);
+
+  Tensor values;
+  TF_EXPECT_OK(ReadParquetColumn(file_.get(), metadata_,
+                                 metadata_.row_groups[0], 0, &values,
+                                 /*nulls=*/nullptr));
+  EXPECT_TRUE(errors::IsUnimplemented(
+      ReadParquetColumn(file_.get(), metadata_, metadata_.row_groups[0], 1,
+                        &values, /*nulls=*/nullptr)));
+}
+
+TEST_F(ParquetReaderTest, CorruptFiles) {
+  EXPECT_TRUE(errors::IsDataLoss(Open("PAR1")));
+  EXPECT_TRUE(errors::IsDataLoss(Open("PAR1 not a footer PAR2")));
+
+  TestRowGroup row_group = {2, {}};
+  row_group.columns.push_back({{DataPage(2, PlainInt64s({1}))}});
+  TF_ASSERT_OK(
+      Open(SerializeFile({{"id", ParquetType::kInt64, 0}}, {row_group})));
+  Tensor values;
+  EXPECT_TRUE(errors::IsDataLoss(
+      ReadParquetColumn(file_.get(), metadata_, metadata_.row_groups[0], 0,
+                        &values, /*nulls=*/nullptr)));
+
+  const std::string file =
+      SerializeFile({{"id", ParquetType::kInt64, 0}}, {row_group});
+  EXPECT_TRUE(errors::IsDataLoss(
+      Open(file.substr(0, 4) + file.substr(file.size() - 12))));
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
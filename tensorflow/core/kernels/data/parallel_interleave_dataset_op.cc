@@ -115,6 +115,12 @@ constexpr char kParallelInterleaveDatasetV4[] = "ParallelInterleaveDatasetV4";
 // a remote file) with other computation.
 constexpr int kDefaultCyclePrefetchFactor = 2;
 
+// With the `adaptive_interleave_prefetch` experiment, the number of future
+// cycle elements prefetched ahead of time starts at its default and grows up to
+// `kMaxCyclePrefetchFactor * cycle_length` when elements are not ready by the
+// time they enter the cycle, e.g. because remote files are slow to open.
+constexpr int kMaxCyclePrefetchFactor = 4;
+
 // `kPerIteratorPrefetchFactor * block_length + 1` is the default number of
 // per-iterator results that will be prefetched ahead of time. The `+ 1` is to
 // match the behavior of the original implementation.
@@ -171,6 +177,20 @@ int64_t ComputePrefetchInputElements(int64_t configured_prefetch_input_elements,
   return kDefaultCyclePrefetchFactor * cycle_length;
 }
 
+// Returns the maximum number of future cycle elements prefetched ahead of time.
+// It is larger than the initial `prefetch_input_elements` only if the latter is
+// autotuned and adaptive prefetching is enabled.
+int64_t ComputeMaxPrefetchInputElements(
+    int64_t configured_prefetch_input_elements, int64_t prefetch_input_elements,
+    int64_t cycle_length) {
+  if (configured_prefetch_input_elements != model::kAutotune ||
+      !GetExperiments().contains("adaptive_interleave_prefetch")) {
+    return prefetch_input_elements;
+  }
+  return std::max(prefetch_input_elements,
+                  static_cast<int64_t>(kMaxCyclePrefetchFactor * cycle_length));
+}
+
 int64_t ComputeMaxBufferedElements(int64_t prefetch_input_elements,
                                    int64_t buffer_output_elements,
                                    int64_t cycle_length) {
@@ -213,6 +233,8 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
             ComputeBufferOutputElements(buffer_output_elements, block_length)),
         prefetch_input_elements_(ComputePrefetchInputElements(
             prefetch_input_elements, cycle_length_)),
+        max_prefetch_input_elements_(ComputeMaxPrefetchInputElements(
+            prefetch_input_elements, prefetch_input_elements_, cycle_length_)),
         num_parallel_calls_(num_parallel_calls),
         deterministic_(deterministic),
         output_types_(output_types),
@@ -319,9 +341,14 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
           b->AddScalar(buffer_output_elements_, &buffer_output_elements_node));
       inputs.emplace_back(input_index++, buffer_output_elements_node);
 
+      // Adaptive prefetching requires `prefetch_input_elements` to remain
+      // autotuned.
       Node* prefetch_input_elements_node;
-      TF_RETURN_IF_ERROR(b->AddScalar(prefetch_input_elements_,
-                                      &prefetch_input_elements_node));
+      TF_RETURN_IF_ERROR(b->AddScalar(
+          max_prefetch_input_elements_ > prefetch_input_elements_
+              ? model::kAutotune
+              : prefetch_input_elements_,
+          &prefetch_input_elements_node));
       inputs.emplace_back(input_index++, prefetch_input_elements_node);
     }
 
@@ -365,7 +392,8 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
               params.dataset->num_parallel_calls_, mu_,
               num_parallel_calls_cond_var_)),
           deterministic_(deterministic),
-          current_elements_(params.dataset->cycle_length_) {}
+          current_elements_(params.dataset->cycle_length_),
+          prefetch_input_elements_(params.dataset->prefetch_input_elements_) {}
 
     ~ParallelInterleaveIterator() override { CancelThreads(/*wait=*/true); }
 
@@ -389,7 +417,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       // `future_elements_prefetch_` for the future workers.
       int max_current_workers = dataset()->cycle_length_;
       int future_workers =
-          dataset()->prefetch_input_elements_ + dataset()->cycle_length_;
+          dataset()->max_prefetch_input_elements_ + dataset()->cycle_length_;
       int num_threads = 1 + max_current_workers + future_workers;
       if (ctx->stats_aggregator()) {
         num_threads++;
@@ -485,9 +513,10 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
                                           deterministic_ ? 1.0 : 0.0),
            model::MakeNonTunableParameter(
                kMaxBufferedElements,
-               ComputeMaxBufferedElements(dataset()->prefetch_input_elements_,
-                                          dataset()->buffer_output_elements_,
-                                          dataset()->cycle_length_))});
+               ComputeMaxBufferedElements(
+                   dataset()->max_prefetch_input_elements_,
+                   dataset()->buffer_output_elements_,
+                   dataset()->cycle_length_))});
     }
 
     Status SaveInternal(SerializationContext* ctx,
@@ -819,6 +848,10 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
           std::shared_ptr<Element> future_element =
               std::move(future_elements_.front());
           future_elements_.pop_front();
+          if (future_element->results.empty() &&
+              (!future_element->initialized || future_element->iterator)) {
+            MaybeIncreasePrefetchInputElements();
+          }
           if (future_element->iterator) {
             EnableAutotune(ctx, future_element->iterator.get());
           }
@@ -831,6 +864,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         } else {
           current_elements_[cycle_index_] = MakeElement(ctx);
           if (current_elements_[cycle_index_]) {
+            MaybeIncreasePrefetchInputElements();
             current_elements_[cycle_index_]->cycle_index = cycle_index_;
             elements_to_process_.push_back(cycle_index_);
             element->cycle_index = cycle_index_;
@@ -852,6 +886,20 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       }
     }
 
+    // Prefetches one more future element, if adaptive prefetching allows it.
+    // Called when an element enters the cycle before its first results are
+    // ready, so that slow inputs get opened further ahead of time.
+    void MaybeIncreasePrefetchInputElements()
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (prefetch_input_elements_ >= dataset()->max_prefetch_input_elements_) {
+        return;
+      }
+      ++prefetch_input_elements_;
+      VLOG(2) << "Increased the number of prefetched input elements to "
+              << prefetch_input_elements_;
+      future_workers_cond_var_.notify_one();
+    }
+
     // Creates a new element.
     std::shared_ptr<Element> MakeElement(IteratorContext* ctx)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -882,7 +930,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       // `future_element_.size() < future_elements_prefetch_`, there will be a
       // future worker available to create a new future element.
       int future_workers =
-          dataset()->prefetch_input_elements_ + dataset()->cycle_length_;
+          dataset()->max_prefetch_input_elements_ + dataset()->cycle_length_;
       {
         mutex_lock l(*mu_);
         initial_current_workers = num_parallel_calls_->value;
@@ -1036,9 +1084,9 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
               current_workers_cond_var_.notify_one();
             }
           }
-          while (!cancelled_ && (future_elements_.size() >=
-                                     dataset()->prefetch_input_elements_ ||
-                                 wait_for_checkpoint_)) {
+          while (!cancelled_ &&
+                 (future_elements_.size() >= prefetch_input_elements_ ||
+                  wait_for_checkpoint_)) {
             WaitWorkerThread(ctx.get(), &future_workers_cond_var_, &l);
           }
           if (cancelled_) {
@@ -1693,6 +1741,10 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     // current element is exhausted.
     std::deque<std::shared_ptr<Element>> future_elements_ TF_GUARDED_BY(mu_);
 
+    // Number of elements that future workers keep in `future_elements_`.
+    // Grows up to `max_prefetch_input_elements_` with adaptive prefetching.
+    int64_t prefetch_input_elements_ TF_GUARDED_BY(mu_);
+
     // Identifies whether the global end of input has been reached.
     bool end_of_input_ TF_GUARDED_BY(mu_) = false;
 
@@ -1745,6 +1797,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
   const int64_t block_length_;
   const int64_t buffer_output_elements_;
   const int64_t prefetch_input_elements_;
+  const int64_t max_prefetch_input_elements_;
   const int64_t num_parallel_calls_;
   const DeterminismPolicy deterministic_;
   const DataTypeVector output_types_;
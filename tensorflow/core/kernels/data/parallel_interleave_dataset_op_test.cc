@@ -12,7 +12,10 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/parallel_interleave_dataset_op.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <cstdlib>
 #include <memory>
+#include <vector>
 
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
@@ -899,6 +902,149 @@ TEST_F(ParallelInterleaveDatasetOpTest, InvalidArguments) {
   }
 }
 
+// Interleaves 8 inputs of 3 elements each with a cycle length of 2, so that
+// most inputs are opened as future elements, and autotunes the number of them
+// prefetched ahead of time.
+ParallelInterleaveDatasetParams AdaptivePrefetchParams() {
+  std::vector<int64_t> values(24);
+  for (int64_t i = 0; i < values.size(); ++i) {
+    values[i] = i;
+  }
+  auto tensor_slice_dataset_params = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64_t>(TensorShape{8, 3, 1}, values)},
+      /*node_name=*/"tensor_slice");
+  return ParallelInterleaveDatasetParams(
+      tensor_slice_dataset_params,
+      /*other_arguments=*/{},
+      /*cycle_length=*/2,
+      /*block_length=*/1,
+      /*buffer_output_elements=*/model::kAutotune,
+      /*prefetch_input_elements=*/model::kAutotune,
+      /*num_parallel_calls=*/2,
+      /*func=*/
+      MakeTensorSliceDatasetFunc(
+          DataTypeVector({DT_INT64}),
+          std::vector<PartialTensorShape>({PartialTensorShape({1})})),
+      /*func_lib=*/{test::function::MakeTensorSliceDataset()},
+      /*type_arguments=*/{},
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({1})},
+      /*deterministic=*/DeterminismPolicy::kDeterministic,
+      /*node_name=*/kNodeName);
+}
+
+// The deterministic outputs of `AdaptivePrefetchParams()`: each pair of
+// inputs is interleaved in turn.
+std::vector<Tensor> AdaptivePrefetchOutputs() {
+  std::vector<Tensor> outputs;
+  for (int64_t pair = 0; pair < 4; ++pair) {
+    for (int64_t i = 0; i < 3; ++i) {
+      outputs.push_back(
+          CreateTensor<int64_t>(TensorShape{1}, {pair * 6 + i}));
+      outputs.push_back(
+          CreateTensor<int64_t>(TensorShape{1}, {pair * 6 + 3 + i}));
+    }
+  }
+  return outputs;
+}
+
+class AdaptiveInterleavePrefetchTest : public ParallelInterleaveDatasetOpTest {
+ public:
+  ~AdaptiveInterleavePrefetchTest() override {
+    SetAdaptiveInterleavePrefetch(false);
+  }
+
+ protected:
+  // Turns the `adaptive_interleave_prefetch` experiment on or off for the
+  // datasets created afterwards.
+  void SetAdaptiveInterleavePrefetch(bool enabled) {
+    if (enabled) {
+      setenv("TF_JOB_NAME", "test_job", /*overwrite=*/1);
+      setenv("TF_TASK_ID", "0", /*overwrite=*/1);
+      setenv("TF_DATA_EXPERIMENT_OPT_IN", "adaptive_interleave_prefetch",
+             /*overwrite=*/1);
+    } else {
+      unsetenv("TF_JOB_NAME");
+      unsetenv("TF_TASK_ID");
+      unsetenv("TF_DATA_EXPERIMENT_OPT_IN");
+    }
+  }
+
+  // Returns the `prefetch_input_elements` that `dataset` is serialized with.
+  Status SerializedPrefetchInputElements(const DatasetBase* dataset,
+                                         int64_t* prefetch_input_elements) {
+    GraphDefBuilder b;
+    DatasetBase::DatasetGraphDefBuilder db(&b);
+    SerializationContext serialization_ctx((SerializationContext::Params()));
+    Node* output_node = nullptr;
+    TF_RETURN_IF_ERROR(
+        db.AddInputDataset(&serialization_ctx, dataset, &output_node));
+    GraphDef graph_def;
+    TF_RETURN_IF_ERROR(b.ToGraphDef(&graph_def));
+    auto interleave_node = std::find_if(
+        graph_def.node().begin(), graph_def.node().end(),
+        [](const NodeDef& node) {
+          return node.op() == kParallelInterleaveDatasetV4;
+        });
+    if (interleave_node == graph_def.node().end()) {
+      return errors::NotFound("No ", kParallelInterleaveDatasetV4, " node.");
+    }
+    const int32_t kPrefetchInputElementsInput = 4;
+    auto input_node = std::find_if(
+        graph_def.node().begin(), graph_def.node().end(),
+        [&](const NodeDef& node) {
+          return node.name() ==
+                 interleave_node->input(kPrefetchInputElementsInput);
+        });
+    if (input_node == graph_def.node().end()) {
+      return errors::NotFound("No prefetch_input_elements node.");
+    }
+    *prefetch_input_elements =
+        input_node->attr().at("value").tensor().int64_val(0);
+    return absl::OkStatus();
+  }
+};
+
+// Test that adaptive prefetching is only used, and kept when the dataset is
+// serialized, when the experiment is on.
+TEST_F(AdaptiveInterleavePrefetchTest, PrefetchInputElementsInGraphDef) {
+  auto dataset_params = AdaptivePrefetchParams();
+  TF_ASSERT_OK(InitializeRuntime(dataset_params));
+  std::unique_ptr<TestDataset> dataset;
+  TF_ASSERT_OK(MakeDataset(dataset_params, &dataset));
+  int64_t prefetch_input_elements = 0;
+  TF_ASSERT_OK(SerializedPrefetchInputElements(dataset->dataset(),
+                                               &prefetch_input_elements));
+  // The default of twice the cycle length.
+  EXPECT_EQ(prefetch_input_elements, 4);
+
+  SetAdaptiveInterleavePrefetch(true);
+  ASSERT_TRUE(GetExperiments().contains("adaptive_interleave_prefetch"));
+  TF_ASSERT_OK(MakeDataset(dataset_params, &dataset));
+  TF_ASSERT_OK(SerializedPrefetchInputElements(dataset->dataset(),
+                                               &prefetch_input_elements));
+  EXPECT_EQ(prefetch_input_elements, model::kAutotune);
+}
+
+// Test that adaptive prefetching does not change the order or the values of
+// the outputs.
+TEST_F(AdaptiveInterleavePrefetchTest, GetNext) {
+  SetAdaptiveInterleavePrefetch(true);
+  ASSERT_TRUE(GetExperiments().contains("adaptive_interleave_prefetch"));
+  auto dataset_params = AdaptivePrefetchParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  while (!end_of_sequence) {
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+    out_tensors.insert(out_tensors.end(), next.begin(), next.end());
+  }
+  TF_EXPECT_OK(ExpectEqual(out_tensors, AdaptivePrefetchOutputs(),
+                           /*compare_order=*/true));
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/parallel_map_dataset_op.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <deque>
 #include <functional>
@@ -82,6 +83,13 @@ constexpr char kErrorMessage[] = "error_message";
 // Period between reporting dataset statistics.
 constexpr int kStatsReportingPeriodMillis = 1000;
 
+// Name of the experiment that bounds how far ahead of the oldest in-flight
+// element a non-deterministic iterator may return a result. See `ShouldWait`.
+constexpr char kBoundedReorderExperiment[] = "bounded_reorder_parallel_map";
+// Maximum distance from the oldest in-flight element of the results returned
+// by a non-deterministic iterator when `kBoundedReorderExperiment` is enabled.
+constexpr int64_t kMaxReorderDistance = 16;
+
 }  // namespace
 
 class ParallelMapDatasetOp::Dataset : public DatasetBase {
@@ -255,7 +263,11 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
           deterministic_(params.dataset->deterministic_.IsDeterministic() ||
                          params.dataset->deterministic_.IsDefault()),
           preserve_cardinality_(params.dataset->preserve_cardinality_),
-          autotune_(params.dataset->num_parallel_calls_ == model::kAutotune) {}
+          autotune_(params.dataset->num_parallel_calls_ == model::kAutotune),
+          max_reorder_distance_(
+              GetExperiments().contains(kBoundedReorderExperiment)
+                  ? kMaxReorderDistance
+                  : -1) {}
 
     ~Iterator() override {
       CancelThreads(/*wait=*/true);
@@ -657,8 +669,17 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
         // order) is end-of-input, we know that all earlier iterations have
         // already been completed, so it is safe to return that result for the
         // caller to process end of iteration.
-        for (auto it = invocation_results_.begin();
-             it != invocation_results_.end(); ++it) {
+        //
+        // If `max_reorder_distance_` is set, only the first results in
+        // `invocation_results_` are considered, so that no element is returned
+        // further than that distance ahead of the oldest in-flight element.
+        auto end = invocation_results_.end();
+        if (max_reorder_distance_ > 0) {
+          end = invocation_results_.begin() +
+                std::min<int64_t>(invocation_results_.size(),
+                                  max_reorder_distance_);
+        }
+        for (auto it = invocation_results_.begin(); it != end; ++it) {
           if ((*it)->notification.HasBeenNotified() &&
               (it == invocation_results_.begin() || !(*it)->end_of_input)) {
             std::swap(*result, *it);
@@ -751,6 +772,9 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
     const bool deterministic_;
     const bool preserve_cardinality_;
     const bool autotune_;
+    // If positive, the maximum distance from the oldest in-flight element of
+    // the results returned in non-deterministic mode.
+    const int64_t max_reorder_distance_;
     // Counts the number of outstanding calls.
     int64_t num_calls_ TF_GUARDED_BY(*mu_) = 0;
     // Controls cancellation of `input_impl_`. Must be ordered before
@@ -11,8 +11,15 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/parallel_map_dataset_op.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
 #include <gtest/gtest.h>
 #include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tsl/lib/core/status_test_util.h"
@@ -457,6 +464,108 @@ TEST_F(ParallelMapDatasetOpTest, InvalidNumParallelCalls) {
             absl::StatusCode::kInvalidArgument);
 }
 
+// Maximum distance between the position of an output and the position of its
+// input with the `bounded_reorder_parallel_map` experiment.
+constexpr int64_t kMaxReorderDistance = 16;
+
+// More parallel calls than `kMaxReorderDistance`, so that the bound is what
+// limits the reordering.
+ParallelMapDatasetParams BoundedReorderParallelMapDatasetParams() {
+  return ParallelMapDatasetParams(
+      RangeDatasetParams(0, 200, 1),
+      /*other_arguments=*/{},
+      /*num_parallel_calls=*/64,
+      /*func=*/MapFunc("XTimesTwo", DT_INT64),
+      /*func_lib*/ {test::function::XTimesTwo()},
+      /*type_arguments=*/{},
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*use_inter_op_parallelism=*/true,
+      /*deterministic=*/DeterminismPolicy::kNondeterministic,
+      /*preserve_cardinality=*/true,
+      /*node_name=*/kNodeName);
+}
+
+class BoundedReorderParallelMapTest : public ParallelMapDatasetOpTest {
+ public:
+  BoundedReorderParallelMapTest() {
+    setenv("TF_JOB_NAME", "test_job", /*overwrite=*/1);
+    setenv("TF_TASK_ID", "0", /*overwrite=*/1);
+    setenv("TF_DATA_EXPERIMENT_OPT_IN", "bounded_reorder_parallel_map",
+           /*overwrite=*/1);
+  }
+
+  ~BoundedReorderParallelMapTest() override {
+    unsetenv("TF_JOB_NAME");
+    unsetenv("TF_TASK_ID");
+    unsetenv("TF_DATA_EXPERIMENT_OPT_IN");
+  }
+
+ protected:
+  // Reads up to `num_elements` elements, or all the remaining ones if it is
+  // negative, and appends the inputs they were mapped from to `inputs`.
+  Status ReadInputs(int num_elements, std::vector<int64_t>* inputs) {
+    bool end_of_sequence = false;
+    for (int i = 0; num_elements < 0 || i < num_elements; ++i) {
+      std::vector<Tensor> next;
+      TF_RETURN_IF_ERROR(
+          iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+      if (end_of_sequence) break;
+      inputs->push_back(next[0].scalar<int64_t>()() / 2);
+    }
+    return absl::OkStatus();
+  }
+
+  // Checks that `inputs` holds every input once, at most
+  // `kMaxReorderDistance - 1` positions away from its own position.
+  void CheckBoundedReorder(const std::vector<int64_t>& inputs,
+                           int64_t num_inputs) {
+    for (int64_t position = 0; position < inputs.size(); ++position) {
+      EXPECT_LT(std::abs(inputs[position] - position), kMaxReorderDistance)
+          << "Input " << inputs[position] << " at position " << position;
+    }
+    std::vector<int64_t> sorted_inputs = inputs;
+    std::sort(sorted_inputs.begin(), sorted_inputs.end());
+    std::vector<int64_t> expected_inputs(num_inputs);
+    for (int64_t i = 0; i < num_inputs; ++i) {
+      expected_inputs[i] = i;
+    }
+    EXPECT_EQ(sorted_inputs, expected_inputs);
+  }
+};
+
+TEST_F(BoundedReorderParallelMapTest, GetNext) {
+  ASSERT_TRUE(GetExperiments().contains("bounded_reorder_parallel_map"));
+  auto dataset_params = BoundedReorderParallelMapDatasetParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<int64_t> inputs;
+  TF_ASSERT_OK(ReadInputs(/*num_elements=*/-1, &inputs));
+  CheckBoundedReorder(inputs, /*num_inputs=*/200);
+}
+
+TEST_F(BoundedReorderParallelMapTest, SaveAndRestore) {
+  ASSERT_TRUE(GetExperiments().contains("bounded_reorder_parallel_map"));
+  auto dataset_params = BoundedReorderParallelMapDatasetParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::unique_ptr<SerializationContext> serialization_ctx;
+  TF_ASSERT_OK(CreateSerializationContext(&serialization_ctx));
+  std::vector<int64_t> inputs;
+  for (int breakpoint : {25, 75, 150}) {
+    TF_ASSERT_OK(ReadInputs(breakpoint - static_cast<int>(inputs.size()),
+                            &inputs));
+    VariantTensorDataWriter writer;
+    TF_ASSERT_OK(iterator_->Save(serialization_ctx.get(), &writer));
+    std::vector<const VariantTensorData*> data;
+    writer.GetData(&data);
+    VariantTensorDataReader reader(data);
+    TF_ASSERT_OK(RestoreIterator(iterator_ctx_.get(), &reader,
+                                 dataset_params.iterator_prefix(), *dataset_,
+                                 &iterator_));
+  }
+  TF_ASSERT_OK(ReadInputs(/*num_elements=*/-1, &inputs));
+  CheckBoundedReorder(inputs, /*num_inputs=*/200);
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -64,19 +64,24 @@ constexpr char kStatus[] = "status";
 constexpr char kSizeSuffix[] = ".size";
 constexpr char kCodeSuffix[] = ".code";
 constexpr char kErrorMessageSuffix[] = ".error_message";
+// Name of the experiment that copies the elements in the prefetch buffer to
+// the pinned host allocator. See `PrefetchThread`.
+constexpr char kPinnedPrefetchBufferExperiment[] = "pinned_prefetch_buffer";
 
 }  // namespace
 
 class PrefetchDatasetOp::Dataset : public DatasetBase {
  public:
   Dataset(OpKernelContext* ctx, const DatasetBase* input, int64_t buffer_size,
-          int64_t slack_period, bool legacy_autotune, int64_t buffer_size_min)
+          int64_t slack_period, bool legacy_autotune, int64_t buffer_size_min,
+          bool pinned_buffer)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         buffer_size_(buffer_size),
         slack_period_(slack_period),
         legacy_autotune_(legacy_autotune),
-        buffer_size_min_(buffer_size_min) {
+        buffer_size_min_(buffer_size_min),
+        pinned_buffer_(pinned_buffer) {
     input_->Ref();
     random_indexing_compatible_ = absl::OkStatus();
     if (input_ != nullptr) {
@@ -512,7 +517,12 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
 
     // Prefetches elements of the input, storing results in an internal buffer.
     //
-    // It owns the iterator context passed to it.
+    // It owns the iterator context passed to it. If `pinned_buffer_` is set,
+    // the buffered elements are copied to the pinned host allocator, so that
+    // they can be copied to a GPU directly. The upstream iterators allocate
+    // from their usual allocators. The size of the buffer bounds the pinned
+    // memory in use, and the pinned host allocator recycles the memory of
+    // consumed elements for the next ones.
     void PrefetchThread(const std::shared_ptr<IteratorContext>& ctx) {
       RecordStart(ctx.get());
       auto cleanup = gtl::MakeCleanup([this, ctx] { RecordStop(ctx.get()); });
@@ -568,6 +578,10 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
           cond_var_->notify_all();
           return;
         }
+        if (buffer_element.status.ok() && dataset()->pinned_buffer_) {
+          buffer_element.status =
+              CopyToGpuCompatibleMemory(ctx.get(), &buffer_element.value);
+        }
 
         // 3. Signal that the element has been produced.
         {
@@ -670,6 +684,10 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
   // parameter.
   const int64_t buffer_size_min_ = 0;
 
+  // Determines whether the buffered elements are copied to the pinned host
+  // allocator.
+  const bool pinned_buffer_ = false;
+
   absl::Status random_indexing_compatible_;
   TraceMeMetadata traceme_metadata_;
 };
@@ -689,6 +707,7 @@ PrefetchDatasetOp::PrefetchDatasetOp(OpKernelConstruction* ctx)
     legacy_autotune_ = false;
     buffer_size_min_ = std::max(static_cast<int64_t>(1), buffer_size_min_);
   }
+  pinned_buffer_ = GetExperiments().contains(kPinnedPrefetchBufferExperiment);
 }
 
 void PrefetchDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
@@ -706,7 +725,7 @@ void PrefetchDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
   }
 
   *output = new Dataset(ctx, input, buffer_size, slack_period_,
-                        legacy_autotune_, buffer_size_min_);
+                        legacy_autotune_, buffer_size_min_, pinned_buffer_);
 }
 
 namespace {
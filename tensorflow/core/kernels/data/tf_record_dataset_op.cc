@@ -14,7 +14,19 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/data/global_shuffle_utils.h"
 #include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/tf_record_index.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
@@ -25,6 +37,8 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace data {
@@ -45,6 +59,12 @@ constexpr char kGcsFsPrefix[] = "gs://";
 constexpr char kS3FsPrefix[] = "s3://";
 constexpr int64_t kCloudTpuBlockSize = 127LL << 20;  // 127MB.
 constexpr int64_t kS3BlockSize = kCloudTpuBlockSize;
+// Readahead of files on remote file systems keeps up to `kReadaheadMaxBlocks`
+// reads of `buffer_size` bytes, clamped to the range below, in flight.
+constexpr int kReadaheadMaxBlocks = 8;
+constexpr int64_t kMinReadaheadBlockSize = 1LL << 20;   // 1MB.
+constexpr int64_t kMaxReadaheadBlockSize = 16LL << 20;  // 16MB.
+constexpr char kReadaheadThreadPool[] = "tf_record_readahead";
 
 bool is_cloud_tpu_gcs_fs() {
 #if (defined(PLATFORM_CLOUD_TPU) && defined(TPU_GCS_FS)) || \
@@ -54,6 +74,14 @@ bool is_cloud_tpu_gcs_fs() {
   return false;
 }
 
+// Returns true if `filename` is on a file system where each read pays a
+// request latency, e.g. GCS or S3.
+bool IsRemoteFile(const string& filename) {
+  StringPiece scheme, host, path;
+  io::ParseURI(filename, &scheme, &host, &path);
+  return !scheme.empty() && scheme != "file" && scheme != "ram";
+}
+
 class TFRecordDatasetOp::Dataset : public DatasetBase {
  public:
   explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
@@ -71,6 +99,19 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     }
   }
 
+  absl::Status RandomIndexingCompatible() const override {
+    if (!compression_type_.empty()) {
+      return absl::FailedPreconditionError(absl::StrCat(
+          DebugString(), " only supports random access of uncompressed files. ",
+          "Got compression type \"", compression_type_, "\"."));
+    }
+    if (!byte_offsets_.empty()) {
+      return absl::FailedPreconditionError(absl::StrCat(
+          DebugString(), " does not support random access with byte offsets."));
+    }
+    return absl::OkStatus();
+  }
+
   std::unique_ptr<IteratorBase> MakeIteratorInternal(
       const string& prefix) const override {
     name_utils::IteratorPrefixParams params;
@@ -102,6 +143,50 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
 
   Status CheckExternalState() const override { return absl::OkStatus(); }
 
+  // The cardinality is only known if it is computed with moderate effort and
+  // all the files have a prebuilt record offset index, see `tf_record_index.h`.
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    if (options.compute_level() <
+            CardinalityOptions::CARDINALITY_COMPUTE_MODERATE ||
+        !RandomIndexingCompatible().ok()) {
+      return kUnknownCardinality;
+    }
+    absl::StatusOr<const RecordIndex*> record_index = GetRecordIndex();
+    if (!record_index.ok()) {
+      VLOG(1) << "Cardinality of " << DebugString()
+              << " is unknown: " << record_index.status();
+      return kUnknownCardinality;
+    }
+    return (*record_index)->file_start_indices.back();
+  }
+
+  Status Get(OpKernelContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    return Get(AnyContext(ctx), index, out_tensors);
+  }
+
+  Status Get(AnyContext ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    TF_ASSIGN_OR_RETURN(const RecordIndex* record_index, GetRecordIndex());
+    const size_t file_index = record_index->FileIndex(index);
+    std::unique_ptr<RandomAccessFile> file;
+    TF_RETURN_IF_ERROR(Env::Default()->NewRandomAccessFile(
+        TranslateFileName(filenames_[file_index]), &file));
+    // Unbuffered reads, as only one record is read.
+    io::RecordReader reader(file.get());
+    out_tensors->clear();
+    out_tensors->emplace_back(ctx.allocator, DT_STRING, TensorShape({}));
+    tstring& record = out_tensors->back().scalar<tstring>()();
+    const int64_t file_start = record_index->file_start_indices[file_index];
+    TF_RETURN_IF_ERROR(reader.ReadRecordAtIndex(
+        record_index->FileOffsets(file_index), index - file_start, &record));
+    static monitoring::CounterCell* bytes_counter =
+        metrics::GetTFDataBytesReadCounter(kDatasetType);
+    bytes_counter->IncrementBy(record.size());
+    return absl::OkStatus();
+  }
+
  protected:
   Status AsGraphDefInternal(SerializationContext* ctx,
                             DatasetGraphDefBuilder* b,
@@ -120,16 +205,43 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
   }
 
  private:
+  // The record offset indices of all the files, used for random access.
+  struct RecordIndex {
+    // Offsets of all the records, in the order of the files.
+    std::vector<uint64_t> offsets;
+    // Index in `offsets` of the first record of each file, followed by the
+    // total number of records.
+    std::vector<int64_t> file_start_indices;
+
+    // Returns the index of the file holding record `index`.
+    size_t FileIndex(int64_t index) const {
+      return absl::c_upper_bound(file_start_indices, index) -
+             file_start_indices.begin() - 1;
+    }
+
+    // Returns the offsets of the records of file `file_index`.
+    absl::Span<const uint64_t> FileOffsets(size_t file_index) const {
+      return absl::MakeConstSpan(offsets).subspan(
+          file_start_indices[file_index],
+          file_start_indices[file_index + 1] - file_start_indices[file_index]);
+    }
+  };
+
   class Iterator : public DatasetIterator<Dataset> {
    public:
     explicit Iterator(const Params& params)
-        : DatasetIterator<Dataset>(params) {}
+        : DatasetIterator<Dataset>(params),
+          global_shuffle_iterator_(dataset()) {}
 
     bool SymbolicCheckpointCompatible() const override { return true; }
 
     Status GetNextInternal(IteratorContext* ctx,
                            std::vector<Tensor>* out_tensors,
                            bool* end_of_sequence) override {
+      if (ctx->index_mapper() != nullptr) {
+        return global_shuffle_iterator_.GetNext(ctx, out_tensors,
+                                                end_of_sequence);
+      }
       out_tensors->reserve(1);
       mutex_lock l(mu_);
       do {
@@ -169,7 +281,7 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
           return absl::OkStatus();
         }
 
-        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
+        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx));
       } while (true);
     }
 
@@ -177,6 +289,14 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
                         bool* end_of_sequence, int* num_skipped) override {
       *num_skipped = 0;
       mutex_lock l(mu_);
+      if (dataset()->RandomIndexingCompatible().ok()) {
+        absl::StatusOr<const RecordIndex*> record_index =
+            dataset()->GetRecordIndex();
+        if (record_index.ok()) {
+          return SkipWithRecordIndexLocked(ctx, **record_index, num_to_skip,
+                                           end_of_sequence, num_skipped);
+        }
+      }
       do {
         // We are currently processing a file, so try to skip reading
         // the next (num_to_skip - *num_skipped) record.
@@ -210,7 +330,7 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
           return absl::OkStatus();
         }
 
-        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
+        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx));
       } while (true);
     }
 
@@ -235,6 +355,9 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
 
     Status RestoreInternal(IteratorContext* ctx,
                            IteratorStateReader* reader) override {
+      if (ctx->restored_element_count().has_value()) {
+        return global_shuffle_iterator_.Restore(ctx);
+      }
       mutex_lock l(mu_);
       ResetStreamsLocked();
       int64_t current_file_index;
@@ -244,7 +367,7 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       if (reader->Contains(prefix(), kOffset)) {
         int64_t offset;
         TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kOffset, &offset));
-        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
+        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx));
         TF_RETURN_IF_ERROR(reader_->SeekOffset(offset));
       }
       return absl::OkStatus();
@@ -252,7 +375,8 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
 
    private:
     // Sets up reader streams to read from the file at `current_file_index_`.
-    Status SetupStreamsLocked(Env* env) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    Status SetupStreamsLocked(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       if (current_file_index_ >= dataset()->filenames_.size()) {
         return errors::InvalidArgument(
             "current_file_index_:", current_file_index_,
@@ -260,11 +384,15 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       }
 
       // Actually move on to next file.
-      TF_RETURN_IF_ERROR(env->NewRandomAccessFile(
-          TranslateFileName(dataset()->filenames_[current_file_index_]),
-          &file_));
-      reader_ = std::make_unique<io::SequentialRecordReader>(
-          file_.get(), dataset()->options_);
+      const string& filename = dataset()->filenames_[current_file_index_];
+      TF_RETURN_IF_ERROR(
+          ctx->env()->NewRandomAccessFile(TranslateFileName(filename), &file_));
+      io::RecordReaderOptions options = dataset()->options_;
+      if (options.buffer_size > 0 && IsRemoteFile(filename)) {
+        SetupReadaheadLocked(ctx, &options);
+      }
+      reader_ =
+          std::make_unique<io::SequentialRecordReader>(file_.get(), options);
       if (!dataset()->byte_offsets_.empty()) {
         TF_RETURN_IF_ERROR(
             reader_->SeekOffset(dataset()->byte_offsets_[current_file_index_]));
@@ -272,6 +400,73 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       return absl::OkStatus();
     }
 
+    // Skips records by seeking to the offset of the record to read next,
+    // instead of reading the records to skip.
+    Status SkipWithRecordIndexLocked(IteratorContext* ctx,
+                                     const RecordIndex& record_index,
+                                     int num_to_skip, bool* end_of_sequence,
+                                     int* num_skipped)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const std::vector<int64_t>& starts = record_index.file_start_indices;
+      const int64_t num_records = starts.back();
+      if (current_file_index_ == dataset()->filenames_.size()) {
+        *end_of_sequence = true;
+        return absl::OkStatus();
+      }
+      // Index of the record to read next.
+      int64_t position = starts[current_file_index_];
+      if (reader_) {
+        absl::Span<const uint64_t> offsets =
+            record_index.FileOffsets(current_file_index_);
+        position += absl::c_lower_bound(offsets, reader_->TellOffset()) -
+                    offsets.begin();
+      }
+      const int64_t target = std::min(position + num_to_skip, num_records);
+      *num_skipped = target - position;
+      if (target == num_records) {
+        ResetStreamsLocked();
+        current_file_index_ = dataset()->filenames_.size();
+        *end_of_sequence = *num_skipped < num_to_skip;
+        return absl::OkStatus();
+      }
+      const size_t file_index = record_index.FileIndex(target);
+      if (!reader_ || file_index != current_file_index_) {
+        ResetStreamsLocked();
+        current_file_index_ = file_index;
+        TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx));
+      }
+      TF_RETURN_IF_ERROR(reader_->SeekOffset(record_index.offsets[target]));
+      *end_of_sequence = false;
+      return absl::OkStatus();
+    }
+
+    // Replaces the buffer configured in `options` by readahead, which keeps
+    // several reads in flight ahead of the reader. The readahead buffers are
+    // reported to the model, so that they count against the RAM budget of
+    // autotuning.
+    void SetupReadaheadLocked(IteratorContext* ctx,
+                              io::RecordReaderOptions* options)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!readahead_pool_) {
+        readahead_pool_ = std::make_unique<thread::ThreadPool>(
+            ctx->env(), kReadaheadThreadPool, kReadaheadMaxBlocks);
+      }
+      io::ReadaheadOptions& readahead = options->readahead;
+      readahead.block_size = std::clamp(
+          options->buffer_size, kMinReadaheadBlockSize, kMaxReadaheadBlockSize);
+      readahead.max_blocks = kReadaheadMaxBlocks;
+      readahead.schedule = [pool = readahead_pool_.get()](
+                               std::function<void()> fn) {
+        pool->Schedule(std::move(fn));
+      };
+      if (ctx->model() && model_node()) {
+        readahead.buffer_usage_callback = [node = model_node()](
+                                              int64_t bytes_delta) {
+          node->record_buffer_event(bytes_delta, /*elements_delta=*/0);
+        };
+      }
+    }
+
     // Resets all reader streams.
     void ResetStreamsLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       reader_.reset();
@@ -281,17 +476,52 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     mutex mu_;
     size_t current_file_index_ TF_GUARDED_BY(mu_) = 0;
 
+    // Runs the readahead of `reader_`, so it must be destroyed after it.
+    std::unique_ptr<thread::ThreadPool> readahead_pool_ TF_GUARDED_BY(mu_);
+
     // `reader_` will borrow the object that `file_` points to, so
     // we must destroy `reader_` before `file_`.
     std::unique_ptr<RandomAccessFile> file_ TF_GUARDED_BY(mu_);
     std::unique_ptr<io::SequentialRecordReader> reader_ TF_GUARDED_BY(mu_);
+
+    GlobalShuffleIterator global_shuffle_iterator_;
   };
 
+  // Reads the record offset indices of the files on first use.
+  absl::StatusOr<const RecordIndex*> GetRecordIndex() const {
+    mutex_lock l(record_index_mu_);
+    if (record_index_ == nullptr && record_index_status_.ok()) {
+      auto record_index = std::make_unique<RecordIndex>();
+      record_index->file_start_indices.reserve(filenames_.size() + 1);
+      record_index->file_start_indices.push_back(0);
+      for (const string& filename : filenames_) {
+        absl::StatusOr<std::vector<uint64_t>> offsets =
+            ReadTFRecordIndex(Env::Default(), TranslateFileName(filename));
+        if (!offsets.ok()) {
+          record_index_status_ = offsets.status();
+          return record_index_status_;
+        }
+        record_index->offsets.insert(record_index->offsets.end(),
+                                     offsets->begin(), offsets->end());
+        record_index->file_start_indices.push_back(
+            record_index->offsets.size());
+      }
+      record_index_ = std::move(record_index);
+    }
+    TF_RETURN_IF_ERROR(record_index_status_);
+    return record_index_.get();
+  }
+
   const std::vector<string> filenames_;
   const tstring compression_type_;
   io::RecordReaderOptions options_;
   const std::vector<int64_t> byte_offsets_;
   const int op_version_;
+
+  mutable mutex record_index_mu_;
+  mutable std::unique_ptr<RecordIndex> record_index_
+      TF_GUARDED_BY(record_index_mu_);
+  mutable absl::Status record_index_status_ TF_GUARDED_BY(record_index_mu_);
 };
 
 TFRecordDatasetOp::TFRecordDatasetOp(OpKernelConstruction* ctx)
@@ -15,6 +15,7 @@ limitations under the License.
 #include <string>
 
 #include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/data/tf_record_index.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/file_system.h"
@@ -333,6 +334,95 @@ TEST_F(TFRecordDatasetOpTest, InvalidByteOffsetsToSeek) {
       absl::StatusCode::kDataLoss);
 }
 
+// Uncompressed files with record offset indices.
+TFRecordDatasetParams IndexedTFRecordDatasetParams() {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_indexed_1"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_indexed_2"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_indexed_3")};
+  TF_CHECK_OK(CreateTestFiles(filenames,
+                              {{"1", "22", "333"}, {}, {"a", "bb", "ccc"}},
+                              CompressionType::UNCOMPRESSED));
+  for (const tstring& filename : filenames) {
+    TF_CHECK_OK(WriteTFRecordIndex(Env::Default(), filename));
+  }
+  return TFRecordDatasetParams(filenames,
+                               CompressionType::UNCOMPRESSED,
+                               /*buffer_size=*/10,
+                               /*byte_offsets=*/{},
+                               /*node_name=*/kNodeName);
+}
+
+TEST_F(TFRecordDatasetOpTest, RandomAccessWithRecordIndex) {
+  auto dataset_params = IndexedTFRecordDatasetParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(dataset_->RandomIndexingCompatible());
+
+  CardinalityOptions options;
+  options.set_compute_level(CardinalityOptions::CARDINALITY_COMPUTE_MODERATE);
+  ASSERT_EQ(dataset_->Cardinality(options), 6);
+  std::vector<tstring> expected = {"1", "22", "333", "a", "bb", "ccc"};
+  for (int64_t i = expected.size() - 1; i >= 0; --i) {
+    std::vector<Tensor> out_tensors;
+    TF_ASSERT_OK(dataset_->Get(AnyContext(iterator_ctx_.get()), i,
+                               &out_tensors));
+    ASSERT_EQ(out_tensors.size(), 1);
+    EXPECT_EQ(out_tensors[0].scalar<tstring>()(), expected[i]);
+  }
+  std::vector<Tensor> out_tensors;
+  EXPECT_EQ(dataset_->Get(AnyContext(iterator_ctx_.get()), 6, &out_tensors)
+                .code(),
+            absl::StatusCode::kOutOfRange);
+}
+
+TEST_F(TFRecordDatasetOpTest, SkipWithRecordIndex) {
+  auto dataset_params = IndexedTFRecordDatasetParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  bool end_of_sequence = false;
+  int num_skipped = 0;
+  std::vector<Tensor> out_tensors;
+  TF_ASSERT_OK(iterator_->Skip(iterator_ctx_.get(), 2, &end_of_sequence,
+                               &num_skipped));
+  EXPECT_EQ(num_skipped, 2);
+  EXPECT_FALSE(end_of_sequence);
+  TF_ASSERT_OK(
+      iterator_->GetNext(iterator_ctx_.get(), &out_tensors, &end_of_sequence));
+  EXPECT_EQ(out_tensors[0].scalar<tstring>()(), "333");
+
+  // Skips across the empty file.
+  TF_ASSERT_OK(iterator_->Skip(iterator_ctx_.get(), 1, &end_of_sequence,
+                               &num_skipped));
+  EXPECT_EQ(num_skipped, 1);
+  out_tensors.clear();
+  TF_ASSERT_OK(
+      iterator_->GetNext(iterator_ctx_.get(), &out_tensors, &end_of_sequence));
+  EXPECT_EQ(out_tensors[0].scalar<tstring>()(), "bb");
+
+  TF_ASSERT_OK(iterator_->Skip(iterator_ctx_.get(), 5, &end_of_sequence,
+                               &num_skipped));
+  EXPECT_EQ(num_skipped, 1);
+  EXPECT_TRUE(end_of_sequence);
+}
+
+TEST_F(TFRecordDatasetOpTest, NoRandomAccessWithoutRecordIndex) {
+  auto dataset_params = TFRecordDatasetParams3();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  CardinalityOptions options;
+  options.set_compute_level(CardinalityOptions::CARDINALITY_COMPUTE_MODERATE);
+  EXPECT_EQ(dataset_->Cardinality(options), kUnknownCardinality);
+  std::vector<Tensor> out_tensors;
+  EXPECT_EQ(dataset_->Get(AnyContext(iterator_ctx_.get()), 0, &out_tensors)
+                .code(),
+            absl::StatusCode::kFailedPrecondition);
+}
+
+TEST_F(TFRecordDatasetOpTest, NoRandomAccessOfCompressedFiles) {
+  auto dataset_params = TFRecordDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  EXPECT_EQ(dataset_->RandomIndexingCompatible().code(),
+            absl::StatusCode::kFailedPrecondition);
+}
+
 std::vector<IteratorSaveAndRestoreTestCase<TFRecordDatasetParams>>
 IteratorSaveAndRestoreTestCases() {
   return {
@@ -0,0 +1,224 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/nn_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/core/kernels/dropout_op.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/stateless_random_ops.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+using CPUDevice = Eigen::ThreadPoolDevice;
+using GPUDevice = Eigen::GpuDevice;
+
+namespace functor {
+
+template <typename T>
+void Dropout<CPUDevice, T>::operator()(OpKernelContext* ctx,
+                                       const CPUDevice& d,
+                                       random::PhiloxRandom gen,
+                                       uint32 threshold, T scale, const T* x,
+                                       int64_t size, T* output, uint8* mask) {
+  const int64_t num_bytes =
+      (size + kDropoutElementsPerMaskByte - 1) / kDropoutElementsPerMaskByte;
+  const int64_t kByteCost =
+      kDropoutElementsPerMaskByte * (random::PhiloxRandom::kElementCost + 3);
+  auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
+  Shard(worker_threads.num_threads, worker_threads.workers, num_bytes,
+        kByteCost, [&](int64_t start_byte, int64_t limit_byte) {
+          // The samples of kBatchSize groups are computed together.
+          constexpr int kBytesPerBatch = random::PhiloxRandom::kBatchSize /
+                                         kDropoutSampleGroupsPerMaskByte;
+          random::PhiloxRandom::ResultType
+              samples[random::PhiloxRandom::kBatchSize];
+          random::PhiloxRandom local_gen = gen;
+          local_gen.Skip(start_byte * kDropoutSampleGroupsPerMaskByte);
+          for (int64_t byte = start_byte; byte < limit_byte;
+               byte += kBytesPerBatch) {
+            const int batch_bytes = static_cast<int>(
+                std::min<int64_t>(kBytesPerBatch, limit_byte - byte));
+            local_gen.GenerateBatch(
+                samples, batch_bytes * kDropoutSampleGroupsPerMaskByte);
+            for (int i = 0; i < batch_bytes; ++i) {
+              const int64_t offset = (byte + i) * kDropoutElementsPerMaskByte;
+              const int elements = static_cast<int>(std::min<int64_t>(
+                  kDropoutElementsPerMaskByte, size - offset));
+              mask[byte + i] = DropoutMaskByte(
+                  samples[i * kDropoutSampleGroupsPerMaskByte],
+                  samples[i * kDropoutSampleGroupsPerMaskByte + 1], threshold,
+                  scale, x + offset, elements, output + offset);
+            }
+          }
+        });
+}
+
+template <typename T>
+void DropoutGrad<CPUDevice, T>::operator()(OpKernelContext* ctx,
+                                           const CPUDevice& d, T scale,
+                                           const T* gradients,
+                                           const uint8* mask, int64_t size,
+                                           T* backprops) {
+  auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
+  Shard(worker_threads.num_threads, worker_threads.workers, size,
+        /*cost_per_unit=*/2, [&](int64_t start, int64_t limit) {
+          for (int64_t i = start; i < limit; ++i) {
+            backprops[i] = DropoutGradElement(gradients, mask, i, scale);
+          }
+        });
+}
+
+}  // namespace functor
+
+namespace {
+
+Status GetDropoutRate(const Tensor& rate_t, float* rate) {
+  if (!TensorShapeUtils::IsScalar(rate_t.shape())) {
+    return errors::InvalidArgument("rate must be a scalar, got shape ",
+                                   rate_t.shape().DebugString());
+  }
+  *rate = rate_t.scalar<float>()();
+  if (!(*rate >= 0.0f && *rate < 1.0f)) {
+    return errors::InvalidArgument("rate must be in [0, 1), got ", *rate);
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+template <typename Device, typename T>
+class DropoutOp : public OpKernel {
+ public:
+  explicit DropoutOp(OpKernelConstruction* context) : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& x = context->input(0);
+    const Tensor& seed_t = context->input(2);
+    float rate;
+    OP_REQUIRES_OK(context, GetDropoutRate(context->input(1), &rate));
+    OP_REQUIRES(context, seed_t.dims() == 1 && seed_t.dim_size(0) == 2,
+                errors::InvalidArgument("seed must have shape [2], not ",
+                                        seed_t.shape().DebugString()));
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {0}, 0, x.shape(), &output));
+    const int64_t size = x.NumElements();
+    Tensor* mask = nullptr;
+    OP_REQUIRES_OK(
+        context,
+        context->allocate_output(
+            1,
+            TensorShape({(size + kDropoutElementsPerMaskByte - 1) /
+                         kDropoutElementsPerMaskByte}),
+            &mask));
+    if (size == 0) return;
+
+    random::PhiloxRandom::Key key;
+    random::PhiloxRandom::ResultType counter;
+    OP_REQUIRES_OK(context, GenerateKey(seed_t, &key, &counter));
+
+    // An element is dropped iff its uint32 sample is below rate * 2^32.
+    const uint32 threshold =
+        static_cast<uint32>(static_cast<double>(rate) * 4294967296.0);
+    const T scale = static_cast<T>(1.0f / (1.0f - rate));
+    functor::Dropout<Device, T>()(
+        context, context->eigen_device<Device>(),
+        random::PhiloxRandom(counter, key), threshold, scale,
+        x.flat<T>().data(), size, output->flat<T>().data(),
+        mask->flat<uint8>().data());
+  }
+};
+
+template <typename Device, typename T>
+class DropoutGradOp : public OpKernel {
+ public:
+  explicit DropoutGradOp(OpKernelConstruction* context) : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& gradients = context->input(0);
+    const Tensor& mask = context->input(1);
+    float rate;
+    OP_REQUIRES_OK(context, GetDropoutRate(context->input(2), &rate));
+    const int64_t size = gradients.NumElements();
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(mask.shape()) &&
+                    mask.NumElements() ==
+                        (size + kDropoutElementsPerMaskByte - 1) /
+                            kDropoutElementsPerMaskByte,
+                errors::InvalidArgument(
+                    "mask must be a vector of ",
+                    (size + kDropoutElementsPerMaskByte - 1) /
+                        kDropoutElementsPerMaskByte,
+                    " bytes, got shape ", mask.shape().DebugString()));
+
+    Tensor* backprops = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {0}, 0, gradients.shape(), &backprops));
+    if (size == 0) return;
+
+    const T scale = static_cast<T>(1.0f / (1.0f - rate));
+    functor::DropoutGrad<Device, T>()(
+        context, context->eigen_device<Device>(), scale,
+        gradients.flat<T>().data(), mask.flat<uint8>().data(), size,
+        backprops->flat<T>().data());
+  }
+};
+
+#define REGISTER_KERNELS(DEVICE, T)                                   \
+  REGISTER_KERNEL_BUILDER(Name("Dropout")                             \
+                              .Device(DEVICE_##DEVICE)                \
+                              .HostMemory("rate")                     \
+                              .HostMemory("seed")                     \
+                              .TypeConstraint<T>("T"),                \
+                          DropoutOp<DEVICE##Device, T>);              \
+  REGISTER_KERNEL_BUILDER(Name("DropoutGrad")                         \
+                              .Device(DEVICE_##DEVICE)                \
+                              .HostMemory("rate")                     \
+                              .TypeConstraint<T>("T"),                \
+                          DropoutGradOp<DEVICE##Device, T>);
+
+#define REGISTER_CPU_KERNELS(T) REGISTER_KERNELS(CPU, T)
+TF_CALL_half(REGISTER_CPU_KERNELS);
+TF_CALL_bfloat16(REGISTER_CPU_KERNELS);
+TF_CALL_float(REGISTER_CPU_KERNELS);
+TF_CALL_double(REGISTER_CPU_KERNELS);
+#undef REGISTER_CPU_KERNELS
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#define REGISTER_GPU_KERNELS(T) REGISTER_KERNELS(GPU, T)
+TF_CALL_half(REGISTER_GPU_KERNELS);
+TF_CALL_bfloat16(REGISTER_GPU_KERNELS);
+TF_CALL_float(REGISTER_GPU_KERNELS);
+TF_CALL_double(REGISTER_GPU_KERNELS);
+#undef REGISTER_GPU_KERNELS
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#undef REGISTER_KERNELS
+
+}  // namespace tensorflow
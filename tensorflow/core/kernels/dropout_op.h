@@ -0,0 +1,111 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_DROPOUT_OP_H_
+#define TENSORFLOW_CORE_KERNELS_DROPOUT_OP_H_
+
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// The mask of the Dropout op has one bit per element: bit `i % 8` of byte
+// `i / 8` is set iff element `i` is kept. Element `i` is kept iff the uint32
+// sample `i` of the Philox stream is at least the threshold of the rate, so
+// each byte of the mask consumes two groups of samples.
+constexpr int kDropoutElementsPerMaskByte = 8;
+constexpr int kDropoutSampleGroupsPerMaskByte =
+    kDropoutElementsPerMaskByte / random::PhiloxRandom::kResultElementCount;
+
+// Applies the dropout to the `size` <= 8 elements of `x` of a mask byte, given
+// their samples `low` and `high`, and returns the mask byte. `x` and `output`
+// may alias.
+template <typename T>
+PHILOX_DEVICE_INLINE uint8 DropoutMaskByte(
+    const random::PhiloxRandom::ResultType& low,
+    const random::PhiloxRandom::ResultType& high, uint32 threshold, T scale,
+    const T* x, int size, T* output) {
+  constexpr int kGroupSize = random::PhiloxRandom::kResultElementCount;
+  uint8 mask = 0;
+  for (int i = 0; i < size; ++i) {
+    const uint32 sample = i < kGroupSize ? low[i] : high[i - kGroupSize];
+    const bool keep = sample >= threshold;
+    output[i] = keep ? static_cast<T>(x[i] * scale) : T(0);
+    mask |= static_cast<uint8>(keep) << i;
+  }
+  return mask;
+}
+
+// Returns the gradient of element `i` of the Dropout op.
+template <typename T>
+PHILOX_DEVICE_INLINE T DropoutGradElement(const T* gradients,
+                                          const uint8* mask, int64_t i,
+                                          T scale) {
+  const bool keep = (mask[i / kDropoutElementsPerMaskByte] >>
+                     (i % kDropoutElementsPerMaskByte)) &
+                    1;
+  return keep ? static_cast<T>(gradients[i] * scale) : T(0);
+}
+
+namespace functor {
+
+template <typename Device, typename T>
+struct Dropout;
+
+template <typename Device, typename T>
+struct DropoutGrad;
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+// Fills the `size` elements of `output` and the (size + 7) / 8 bytes of
+// `mask` from the samples of `gen`.
+template <typename T>
+struct Dropout<CPUDevice, T> {
+  void operator()(OpKernelContext* ctx, const CPUDevice& d,
+                  random::PhiloxRandom gen, uint32 threshold, T scale,
+                  const T* x, int64_t size, T* output, uint8* mask);
+};
+
+template <typename T>
+struct DropoutGrad<CPUDevice, T> {
+  void operator()(OpKernelContext* ctx, const CPUDevice& d, T scale,
+                  const T* gradients, const uint8* mask, int64_t size,
+                  T* backprops);
+};
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+typedef Eigen::GpuDevice GPUDevice;
+
+template <typename T>
+struct Dropout<GPUDevice, T> {
+  void operator()(OpKernelContext* ctx, const GPUDevice& d,
+                  random::PhiloxRandom gen, uint32 threshold, T scale,
+                  const T* x, int64_t size, T* output, uint8* mask);
+};
+
+template <typename T>
+struct DropoutGrad<GPUDevice, T> {
+  void operator()(OpKernelContext* ctx, const GPUDevice& d, T scale,
+                  const T* gradients, const uint8* mask, int64_t size,
+                  T* backprops);
+};
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DROPOUT_OP_H_
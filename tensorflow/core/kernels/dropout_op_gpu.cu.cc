@@ -0,0 +1,106 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#define EIGEN_USE_GPU
+
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/kernels/dropout_op.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/util/gpu_kernel_helper.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Each thread computes the elements of a mask byte from their two groups of
+// samples, so that the mask is written without atomics.
+template <typename T>
+__global__ void DropoutKernel(int64 num_bytes, random::PhiloxRandom gen,
+                              uint32 threshold, T scale,
+                              const T* __restrict__ x, int64 size,
+                              T* __restrict__ output,
+                              uint8* __restrict__ mask) {
+  for (int64 byte : GpuGridRangeX(num_bytes)) {
+    random::PhiloxRandom local_gen = gen;
+    local_gen.Skip(byte * kDropoutSampleGroupsPerMaskByte);
+    const random::PhiloxRandom::ResultType low = local_gen();
+    const random::PhiloxRandom::ResultType high = local_gen();
+    const int64 offset = byte * kDropoutElementsPerMaskByte;
+    const int elements =
+        size - offset < kDropoutElementsPerMaskByte
+            ? static_cast<int>(size - offset)
+            : kDropoutElementsPerMaskByte;
+    mask[byte] = DropoutMaskByte(low, high, threshold, scale, x + offset,
+                                 elements, output + offset);
+  }
+}
+
+template <typename T>
+__global__ void DropoutGradKernel(int64 size, T scale,
+                                  const T* __restrict__ gradients,
+                                  const uint8* __restrict__ mask,
+                                  T* __restrict__ backprops) {
+  GPU_1D_KERNEL_LOOP(i, size) {
+    backprops[i] = DropoutGradElement(gradients, mask, i, scale);
+  }
+}
+
+}  // namespace
+
+namespace functor {
+
+template <typename T>
+void Dropout<GPUDevice, T>::operator()(OpKernelContext* ctx,
+                                       const GPUDevice& d,
+                                       random::PhiloxRandom gen,
+                                       uint32 threshold, T scale, const T* x,
+                                       int64_t size, T* output, uint8* mask) {
+  const int64_t num_bytes =
+      (size + kDropoutElementsPerMaskByte - 1) / kDropoutElementsPerMaskByte;
+  GpuLaunchConfig config = GetGpuLaunchConfig(num_bytes, d);
+  TF_CHECK_OK(GpuLaunchKernel(DropoutKernel<T>, config.block_count,
+                              config.thread_per_block, 0, d.stream(),
+                              num_bytes, gen, threshold, scale, x, size,
+                              output, mask));
+}
+
+template <typename T>
+void DropoutGrad<GPUDevice, T>::operator()(OpKernelContext* ctx,
+                                           const GPUDevice& d, T scale,
+                                           const T* gradients,
+                                           const uint8* mask, int64_t size,
+                                           T* backprops) {
+  GpuLaunchConfig config = GetGpuLaunchConfig(size, d);
+  TF_CHECK_OK(GpuLaunchKernel(DropoutGradKernel<T>, config.block_count,
+                              config.thread_per_block, 0, d.stream(), size,
+                              scale, gradients, mask, backprops));
+}
+
+#define DEFINE_GPU_SPECS(T)                   \
+  template struct Dropout<GPUDevice, T>;      \
+  template struct DropoutGrad<GPUDevice, T>;
+
+TF_CALL_half(DEFINE_GPU_SPECS);
+TF_CALL_bfloat16(DEFINE_GPU_SPECS);
+TF_CALL_float(DEFINE_GPU_SPECS);
+TF_CALL_double(DEFINE_GPU_SPECS);
+#undef DEFINE_GPU_SPECS
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
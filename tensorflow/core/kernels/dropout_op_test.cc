@@ -0,0 +1,161 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/kernels/stateless_random_ops.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class DropoutOpTest : public OpsTestBase {
+ protected:
+  void MakeDropoutOp() {
+    TF_ASSERT_OK(NodeDefBuilder("dropout_op", "Dropout")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT64))
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  void MakeDropoutGradOp() {
+    TF_ASSERT_OK(NodeDefBuilder("dropout_grad_op", "DropoutGrad")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_UINT8))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  // Runs Dropout on `size` ones and returns its outputs.
+  void RunDropout(int size, float rate, int64_t seed, Tensor* output,
+                  Tensor* mask) {
+    inputs_.clear();
+    MakeDropoutOp();
+    AddInputFromArray<float>(TensorShape({size}), std::vector<float>(size, 1));
+    AddInputFromArray<float>(TensorShape({}), {rate});
+    AddInputFromArray<int64_t>(TensorShape({2}), {seed, 0});
+    TF_ASSERT_OK(RunOpKernel());
+    *output = *GetOutput(0);
+    *mask = *GetOutput(1);
+  }
+};
+
+bool IsKept(const Tensor& mask, int i) {
+  return (mask.vec<uint8>()(i / 8) >> (i % 8)) & 1;
+}
+
+TEST_F(DropoutOpTest, KeepsTheElementsOfTheMask) {
+  constexpr int kSize = 10003;
+  constexpr float kRate = 0.25f;
+  Tensor output, mask;
+  RunDropout(kSize, kRate, /*seed=*/17, &output, &mask);
+  EXPECT_EQ(output.shape(), TensorShape({kSize}));
+  EXPECT_EQ(mask.shape(), TensorShape({(kSize + 7) / 8}));
+
+  int kept = 0;
+  for (int i = 0; i < kSize; ++i) {
+    if (IsKept(mask, i)) {
+      EXPECT_FLOAT_EQ(output.vec<float>()(i), 1.0f / (1.0f - kRate));
+      ++kept;
+    } else {
+      EXPECT_EQ(output.vec<float>()(i), 0.0f);
+    }
+  }
+  EXPECT_NEAR(static_cast<float>(kept) / kSize, 1.0f - kRate, 0.02f);
+  // The unused bits of the last byte are zero.
+  for (int i = kSize; i < mask.NumElements() * 8; ++i) {
+    EXPECT_FALSE(IsKept(mask, i));
+  }
+}
+
+TEST_F(DropoutOpTest, MaskMatchesThePhiloxSamples) {
+  constexpr int kSize = 1000;
+  constexpr float kRate = 0.5f;
+  constexpr int64_t kSeed = 3;
+  Tensor output, mask;
+  RunDropout(kSize, kRate, kSeed, &output, &mask);
+
+  Tensor seed = test::AsTensor<int64_t>({kSeed, 0});
+  random::PhiloxRandom::Key key;
+  random::PhiloxRandom::ResultType counter;
+  TF_ASSERT_OK(GenerateKey(seed, &key, &counter));
+  random::PhiloxRandom gen(counter, key);
+  random::PhiloxRandom::ResultType samples;
+  for (int i = 0; i < kSize; ++i) {
+    if (i % 4 == 0) samples = gen();
+    EXPECT_EQ(IsKept(mask, i), samples[i % 4] >= (1u << 31)) << i;
+  }
+}
+
+TEST_F(DropoutOpTest, IsDeterministicForTheSameSeed) {
+  Tensor output1, mask1, output2, mask2, output3, mask3;
+  RunDropout(1000, 0.5f, /*seed=*/5, &output1, &mask1);
+  RunDropout(1000, 0.5f, /*seed=*/5, &output2, &mask2);
+  RunDropout(1000, 0.5f, /*seed=*/6, &output3, &mask3);
+  test::ExpectTensorEqual<float>(output1, output2);
+  test::ExpectTensorEqual<uint8>(mask1, mask2);
+  EXPECT_NE(mask1.tensor_data(), mask3.tensor_data());
+}
+
+TEST_F(DropoutOpTest, KeepsEverythingForZeroRate) {
+  Tensor output, mask;
+  RunDropout(20, 0.0f, /*seed=*/1, &output, &mask);
+  test::ExpectTensorEqual<float>(
+      output, test::AsTensor<float>(std::vector<float>(20, 1.0f)));
+  test::ExpectTensorEqual<uint8>(mask, test::AsTensor<uint8>({255, 255, 15}));
+}
+
+TEST_F(DropoutOpTest, FailsForInvalidRate) {
+  MakeDropoutOp();
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  AddInputFromArray<float>(TensorShape({}), {1.0f});
+  AddInputFromArray<int64_t>(TensorShape({2}), {1, 2});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+TEST_F(DropoutOpTest, GradientUsesTheMask) {
+  MakeDropoutGradOp();
+  AddInputFromArray<float>(TensorShape({10}),
+                           {1, 2, 3, 4, 5, 6, 7, 8, 9, 10});
+  AddInputFromArray<uint8>(TensorShape({2}), {0b10100101, 0b10});
+  AddInputFromArray<float>(TensorShape({}), {0.5f});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<float>(
+      *GetOutput(0),
+      test::AsTensor<float>({2, 0, 6, 0, 0, 12, 0, 16, 0, 20}));
+}
+
+TEST_F(DropoutOpTest, GradientFailsForWrongMaskSize) {
+  MakeDropoutGradOp();
+  AddInputFromArray<float>(TensorShape({10}),
+                           {1, 2, 3, 4, 5, 6, 7, 8, 9, 10});
+  AddInputFromArray<uint8>(TensorShape({1}), {255});
+  AddInputFromArray<float>(TensorShape({}), {0.5f});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,12 +15,16 @@ limitations under the License.
 
 // See docs in ../ops/data_flow_ops.cc.
 
+#include <algorithm>
+#include <functional>
 #include <vector>
+
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/util/util.h"
 
@@ -39,9 +43,17 @@ class DynamicPartitionOp_Shared : public OpKernel {
     //   in the graph?
   }
 
+  // Validates the inputs and allocates the outputs. The partitions are split
+  // into `*num_blocks` contiguous blocks of `*block_size` elements (the last
+  // one may be shorter) that are counted, and later copied, in parallel.
+  // `(*block_offsets)[b * num_partitions_ + p]` is the index in output `p` of
+  // the first element of block `b` that goes to partition `p`, so that the
+  // elements of every partition keep their order.
   void ValidateAndAllocateOutputs(OpKernelContext* c, const Tensor** data,
                                   const Tensor** partitions,
-                                  OpOutputList* Tout) {
+                                  OpOutputList* Tout, int64_t* num_blocks,
+                                  int64_t* block_size,
+                                  std::vector<int64_t>* block_offsets) {
     OP_REQUIRES_OK(c, c->input("data", data));
     OP_REQUIRES_OK(c, c->input("partitions", partitions));
     OP_REQUIRES(
@@ -52,17 +64,52 @@ class DynamicPartitionOp_Shared : public OpKernel {
             "got data.shape = ", (*data)->shape().DebugString(),
             ", partitions.shape = ", (*partitions)->shape().DebugString()));
 
-    // Count how many occurrences of each partition id we have in partitions
-    gtl::InlinedVector<int, 32> partition_count(num_partitions_);
     auto e_partitions = (*partitions)->flat<int32>();
     const int64_t N = e_partitions.dimension(0);
-    for (int64_t i = 0; i < N; i++) {
-      const int32_t p = internal::SubtleMustCopy(e_partitions(i));
-      OP_REQUIRES(c, FastBoundsCheck(p, num_partitions_),
+    const int64_t max_blocks = std::max<int64_t>(
+        1, std::min<int64_t>(
+               c->device()->tensorflow_cpu_worker_threads()->num_threads,
+               (*data)->TotalBytes() / kMinBytesPerBlock));
+    *block_size = std::max<int64_t>(1, (N + max_blocks - 1) / max_blocks);
+    *num_blocks = (N + *block_size - 1) / *block_size;
+
+    // Count how many occurrences of each partition id we have in each block
+    block_offsets->assign(*num_blocks * num_partitions_, 0);
+    std::vector<int64_t> bad_index(*num_blocks, -1);
+    std::vector<int32> bad_partition(*num_blocks);
+    ForEachBlock(c, *num_blocks, [&](int64_t first, int64_t last) {
+      for (int64_t b = first; b < last; ++b) {
+        int64_t* counts = block_offsets->data() + b * num_partitions_;
+        const int64_t limit = std::min(N, (b + 1) * *block_size);
+        for (int64_t i = b * *block_size; i < limit; ++i) {
+          const int32_t p = internal::SubtleMustCopy(e_partitions(i));
+          if (!FastBoundsCheck(p, num_partitions_)) {
+            bad_index[b] = i;
+            bad_partition[b] = p;
+            break;
+          }
+          counts[p]++;
+        }
+      }
+    });
+    for (int64_t b = 0; b < *num_blocks; ++b) {
+      OP_REQUIRES(c, bad_index[b] < 0,
                   errors::InvalidArgument(
-                      "partitions", SliceDebugString((*partitions)->shape(), i),
-                      " = ", p, " is not in [0, ", num_partitions_, ")"));
-      partition_count[p]++;
+                      "partitions",
+                      SliceDebugString((*partitions)->shape(), bad_index[b]),
+                      " = ", bad_partition[b], " is not in [0, ",
+                      num_partitions_, ")"));
+    }
+
+    // Turn the counts into offsets with a prefix sum over the blocks
+    gtl::InlinedVector<int64_t, 32> partition_count(num_partitions_);
+    for (int64_t b = 0; b < *num_blocks; ++b) {
+      int64_t* offsets = block_offsets->data() + b * num_partitions_;
+      for (int p = 0; p < num_partitions_; p++) {
+        const int64_t count = offsets[p];
+        offsets[p] = partition_count[p];
+        partition_count[p] += count;
+      }
     }
 
     // Allocate output tensors of the right size
@@ -79,6 +126,22 @@ class DynamicPartitionOp_Shared : public OpKernel {
   }
 
  protected:
+  // Calls `fn` on ranges of the blocks [0, num_blocks), from the CPU worker
+  // threads when there is more than one block.
+  static void ForEachBlock(OpKernelContext* c, int64_t num_blocks,
+                           const std::function<void(int64_t, int64_t)>& fn) {
+    if (num_blocks <= 1) {
+      fn(0, num_blocks);
+      return;
+    }
+    // Every block is worth a thread of its own.
+    c->device()->tensorflow_cpu_worker_threads()->workers->ParallelFor(
+        num_blocks, /*cost_per_unit=*/kMinBytesPerBlock, fn);
+  }
+
+  // The minimum number of bytes of data per block of partitions.
+  static constexpr int64_t kMinBytesPerBlock = 64 << 10;
+
   int num_partitions_;
 };
 
@@ -91,69 +154,59 @@ class DynamicPartitionOp : public DynamicPartitionOp_Shared {
     const Tensor* data;
     const Tensor* partitions;
     OpOutputList outputs;
-    ValidateAndAllocateOutputs(c, &data, &partitions, &outputs);
+    int64_t num_blocks;
+    int64_t block_size;
+    std::vector<int64_t> block_offsets;
+    ValidateAndAllocateOutputs(c, &data, &partitions, &outputs, &num_blocks,
+                               &block_size, &block_offsets);
     if (!c->status().ok()) return;
     if (num_partitions_ == 0 || data->NumElements() == 0) return;
 
     auto e_partitions = partitions->flat<int32>();
     const int64_t N = e_partitions.dimension(0);
-    gtl::InlinedVector<int, 32> output_index(num_partitions_);
-
-    if (partitions->dims() == data->dims()) {
-      // Walk through data and copy the data to the appropriate output tensor
-      const auto data_flat = data->flat<T>();
-      std::vector<Eigen::TensorMap<Eigen::Tensor<T, 1, Eigen::RowMajor>,
-                                   Eigen::Aligned> >
-          out_vec;
-      out_vec.reserve(num_partitions_);
-      for (int p = 0; p < num_partitions_; p++) {
-        out_vec.push_back(outputs[p]->vec<T>());
-      }
-      for (int64_t i = 0; i < N; i++) {
-        const int32_t p = internal::SubtleMustCopy(e_partitions(i));
-        OP_REQUIRES(
-            c, FastBoundsCheck(p, num_partitions_),
-            errors::InvalidArgument("indices[", i, "] is out of range"));
-        auto oi = output_index[p];
-        OP_REQUIRES(c, FastBoundsCheck(oi, out_vec[p].size()),
-                    errors::InvalidArgument(
-                        "out_vec[", p, "] size: ", out_vec[p].size(),
-                        " is not LTE output_index[", p, "] : ", oi));
-        out_vec[p](oi) = data_flat(i);
-        output_index[p]++;
-      }
-    } else {
-      // If data has extra dimensions, use Eigen slices
-      std::vector<Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>,
-                                   Eigen::Aligned> >
-          out_flat;
-      out_flat.reserve(num_partitions_);
-      for (int p = 0; p < num_partitions_; p++) {
-        out_flat.push_back(outputs[p]->flat_outer_dims<T>());
-      }
+    // When data has extra dimensions, every element copies a slice.
+    const int64_t slice_size = data->NumElements() / N;
+    const T* data_base = data->flat<T>().data();
+    gtl::InlinedVector<T*, 32> out_base(num_partitions_);
+    gtl::InlinedVector<int64_t, 32> out_rows(num_partitions_);
+    for (int p = 0; p < num_partitions_; p++) {
+      out_base[p] = outputs[p]->flat<T>().data();
+      out_rows[p] = outputs[p]->NumElements() / slice_size;
+    }
 
-      // Walk through data and copy the data to the appropriate output tensor
-      const int64_t slice_size = data->NumElements() / N;
-      const auto data_flat = data->shaped<T, 2>({N, slice_size});
-      Eigen::DSizes<Eigen::DenseIndex, 2> sizes(1, slice_size);
-      for (int64_t i = 0; i < N; i++) {
-        // outputs[p][output_index[p]++] = data[i]
-        const int32_t p = internal::SubtleMustCopy(e_partitions(i));
-        OP_REQUIRES(
-            c, FastBoundsCheck(p, num_partitions_),
-            errors::InvalidArgument("indices[", i,
-                                    "] has been asynchronously overwritten and "
-                                    "is no longer in range!"));
-        auto oi = output_index[p];
-        OP_REQUIRES(c, FastBoundsCheck(oi, out_flat[p].dimension(0)),
-                    errors::InvalidArgument("Size of output_index: ", oi,
-                                            " is no longer in range."));
-        Eigen::DSizes<Eigen::DenseIndex, 2> out_indices(oi, 0);
-        Eigen::DSizes<Eigen::DenseIndex, 2> data_indices(i, 0);
-        out_flat[p].slice(out_indices, sizes) =
-            data_flat.slice(data_indices, sizes);
-        output_index[p]++;
+    // Walk through data and copy the data to the appropriate output tensor,
+    // each block from the offsets computed for it.
+    std::vector<Status> block_status(num_blocks);
+    ForEachBlock(c, num_blocks, [&](int64_t first, int64_t last) {
+      for (int64_t b = first; b < last; ++b) {
+        const int64_t* offsets = block_offsets.data() + b * num_partitions_;
+        gtl::InlinedVector<int64_t, 32> output_index(
+            offsets, offsets + num_partitions_);
+        const int64_t limit = std::min(N, (b + 1) * block_size);
+        for (int64_t i = b * block_size; i < limit; ++i) {
+          // outputs[p][output_index[p]++] = data[i]
+          const int32_t p = internal::SubtleMustCopy(e_partitions(i));
+          if (!FastBoundsCheck(p, num_partitions_)) {
+            block_status[b] = errors::InvalidArgument(
+                "indices[", i,
+                "] has been asynchronously overwritten and is no longer in "
+                "range!");
+            break;
+          }
+          const int64_t oi = output_index[p];
+          if (!FastBoundsCheck(oi, out_rows[p])) {
+            block_status[b] = errors::InvalidArgument(
+                "Size of output_index: ", oi, " is no longer in range.");
+            break;
+          }
+          std::copy_n(data_base + i * slice_size, slice_size,
+                      out_base[p] + oi * slice_size);
+          output_index[p]++;
+        }
       }
+    });
+    for (const Status& s : block_status) {
+      OP_REQUIRES_OK(c, s);
     }
   }
 };
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/framework/allocator.h"
@@ -146,6 +147,32 @@ TEST_F(DynamicPartitionOpTest, SomeOutputsEmpty) {
   }
 }
 
+TEST_F(DynamicPartitionOpTest, Large_KeepsOrder) {
+  MakeOp();
+
+  // Enough data to be partitioned by several threads.
+  const int kSize = 200000;
+  std::vector<float> data(kSize);
+  std::vector<int32> partitions(kSize);
+  for (int i = 0; i < kSize; ++i) {
+    data[i] = i;
+    partitions[i] = (i / 3) % 4;
+  }
+  AddInputFromArray<float>(TensorShape({kSize}), data);
+  AddInputFromArray<int32>(TensorShape({kSize}), partitions);
+  TF_ASSERT_OK(RunOpKernel());
+
+  for (int p = 0; p < 4; ++p) {
+    std::vector<float> expected;
+    for (int i = 0; i < kSize; ++i) {
+      if (partitions[i] == p) expected.push_back(data[i]);
+    }
+    const int64_t size = expected.size();
+    test::ExpectTensorEqual<float>(*GetOutput(p),
+                                   test::AsTensor<float>(expected, {size}));
+  }
+}
+
 TEST_F(DynamicPartitionOpTest, Error_IndexOutOfRange) {
   MakeOp();
 
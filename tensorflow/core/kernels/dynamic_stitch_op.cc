@@ -16,6 +16,7 @@ limitations under the License.
 // See docs in ../ops/data_flow_ops.cc.
 
 #include <algorithm>
+#include <vector>
 
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -23,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "tensorflow/core/kernels/gpu_device_array.h"
@@ -247,6 +249,10 @@ class DynamicStitchOpGPU : public DynamicStitchOpImplBase<T> {
 
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
+// Above this many bytes of output, the CPU kernels copy the output rows in
+// parallel, rather than the inputs one after the other.
+constexpr size_t kMinBytesToStitchRowsInParallel = 128 << 10;
+
 template <class T, bool Parallel>
 class DynamicStitchOpImplCPU : public DynamicStitchOpImplBase<T> {
  public:
@@ -268,12 +274,18 @@ class DynamicStitchOpImplCPU : public DynamicStitchOpImplBase<T> {
     }
 
     if (first_dim_size > 0) {
-      functor::SetZeroFunctor<CPUDevice, T> f;
-      f(c->eigen_device<CPUDevice>(), merged->template flat<T>());
       auto merged_flat = merged->flat_outer_dims<T>();
       // slice_size must not be stored as int for cases of tensors over 2GB.
       const auto slice_size = merged_flat.dimension(1);
       const size_t slice_bytes = slice_size * sizeof(T);
+      if (c->device()->tensorflow_cpu_worker_threads()->num_threads > 1 &&
+          first_dim_size * slice_bytes >= kMinBytesToStitchRowsInParallel) {
+        StitchRowsInParallel(c, indices_inputs, data_inputs, first_dim_size,
+                             merged);
+        return;
+      }
+      functor::SetZeroFunctor<CPUDevice, T> f;
+      f(c->eigen_device<CPUDevice>(), merged->template flat<T>());
       auto OnInputNumber = [&](int input_num) {
         const Tensor& indices = indices_inputs[input_num];
         auto indices_vec = indices.flat<int32>();
@@ -328,6 +340,49 @@ class DynamicStitchOpImplCPU : public DynamicStitchOpImplBase<T> {
       }
     }
   }
+
+ private:
+  // Finds the last row of data written to every row of `merged`, walking the
+  // inputs in order so that duplicate indices resolve as in the serial loop,
+  // and then copies the rows of `merged` in parallel.
+  void StitchRowsInParallel(OpKernelContext* c,
+                            const OpInputList& indices_inputs,
+                            const OpInputList& data_inputs, int first_dim_size,
+                            Tensor* merged) {
+    auto merged_flat = merged->flat_outer_dims<T>();
+    const auto slice_size = merged_flat.dimension(1);
+    std::vector<const T*> sources(first_dim_size, nullptr);
+    int64_t num_written = 0;
+    for (int input_num = 0; input_num < indices_inputs.size(); input_num++) {
+      auto indices_vec = indices_inputs[input_num].flat<int32>();
+      const T* data_base = data_inputs[input_num].flat<T>().data();
+      for (int64_t i = 0; i < indices_vec.size(); i++) {
+        const int32_t index = internal::SubtleMustCopy(indices_vec(i));
+        OP_REQUIRES(
+            c, FastBoundsCheck(index, first_dim_size),
+            errors::InvalidArgument("indices[", i, "] is out of range"));
+        if (sources[index] == nullptr) ++num_written;
+        sources[index] = data_base + i * slice_size;
+      }
+    }
+    if (num_written < first_dim_size) {
+      functor::SetZeroFunctor<CPUDevice, T> f;
+      f(c->eigen_device<CPUDevice>(), merged->template flat<T>());
+    }
+
+    T* merged_base = merged_flat.data();
+    auto worker_threads = c->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, first_dim_size,
+          /*cost_per_unit=*/slice_size * sizeof(T),
+          [&](int64_t start, int64_t limit) {
+            for (int64_t row = start; row < limit; ++row) {
+              if (sources[row] != nullptr) {
+                std::copy_n(sources[row], slice_size,
+                            merged_base + row * slice_size);
+              }
+            }
+          });
+  }
 };
 
 // Using inheritance rather than a typedef so that these classes might have more
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/fake_input.h"
@@ -94,6 +95,49 @@ TEST_F(DynamicStitchOpTest, IndicesNotCoverAllPortions) {
   test::ExpectTensorEqual<float>(expected, *GetOutput(0));
 }
 
+TEST_F(DynamicStitchOpTest, Large_DuplicateIndicesTakeTheLastInput) {
+  MakeOp(2, DT_FLOAT);
+
+  // Enough data for the rows to be stitched by several threads. Rows 6k + 3
+  // are missing, and the even rows of the first input are overwritten.
+  const int kRows = 60000;
+  const int kSliceSize = 4;
+  std::vector<int32> indices0, indices1;
+  std::vector<float> data0, data1;
+  for (int row = 0; row < kRows; ++row) {
+    if (row % 3 != 0) {
+      indices0.push_back(row);
+      data0.insert(data0.end(), kSliceSize, row);
+    }
+    if (row % 2 == 0) {
+      indices1.push_back(row);
+      data1.insert(data1.end(), kSliceSize, row + 0.5f);
+    }
+  }
+  AddInputFromArray<int32>(TensorShape({static_cast<int64_t>(indices0.size())}),
+                           indices0);
+  AddInputFromArray<int32>(TensorShape({static_cast<int64_t>(indices1.size())}),
+                           indices1);
+  AddInputFromArray<float>(
+      TensorShape({static_cast<int64_t>(indices0.size()), kSliceSize}), data0);
+  AddInputFromArray<float>(
+      TensorShape({static_cast<int64_t>(indices1.size()), kSliceSize}), data1);
+  TF_ASSERT_OK(RunOpKernel());
+
+  std::vector<float> expected;
+  for (int row = 0; row < kRows; ++row) {
+    float value = 0;
+    if (row % 2 == 0) {
+      value = row + 0.5f;
+    } else if (row % 3 != 0) {
+      value = row;
+    }
+    expected.insert(expected.end(), kSliceSize, value);
+  }
+  test::ExpectTensorEqual<float>(
+      *GetOutput(0), test::AsTensor<float>(expected, {kRows, kSliceSize}));
+}
+
 TEST_F(DynamicStitchOpTest, Error_IndicesMultiDimensional) {
   MakeOp(2, DT_FLOAT);
 
@@ -0,0 +1,209 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/nn_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "Eigen/Core"  // from @eigen_archive
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+namespace {
+
+// The queries and keys are processed in blocks of these sizes, so that the
+// scores of a block of queries against a block of keys stay in the cache.
+constexpr int64_t kQueryBlockSize = 64;
+constexpr int64_t kKeyBlockSize = 128;
+
+template <typename T>
+using RowMajorMatrix =
+    Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+template <typename T>
+Eigen::Map<const RowMajorMatrix<T>> MapRows(const T* data, int64_t rows,
+                                            int64_t cols) {
+  return Eigen::Map<const RowMajorMatrix<T>>(data, rows, cols);
+}
+
+}  // namespace
+
+// Computes the attention of a block of queries over blocks of keys, keeping
+// for every query the running maximum and sum of the exponentiated scores
+// ("online softmax"), so that the scores of all the keys are never stored.
+// The products run on float copies of the blocks, whatever T is.
+template <typename T>
+class FusedScaledDotProductAttentionOp : public OpKernel {
+ public:
+  explicit FusedScaledDotProductAttentionOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("scale", &scale_));
+    OP_REQUIRES_OK(context, context->GetAttr("is_causal", &is_causal_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& query = context->input(0);
+    const Tensor& key = context->input(1);
+    const Tensor& value = context->input(2);
+    const int dims = query.dims();
+    OP_REQUIRES(context, dims >= 2,
+                errors::InvalidArgument("query must have >= 2 dimensions, got ",
+                                        query.shape().DebugString()));
+    OP_REQUIRES(
+        context, key.dims() == dims && value.dims() == dims,
+        errors::InvalidArgument("query, key and value must have the same rank, "
+                                "got ",
+                                query.shape().DebugString(), ", ",
+                                key.shape().DebugString(), " and ",
+                                value.shape().DebugString()));
+    for (int i = 0; i < dims - 2; ++i) {
+      OP_REQUIRES(
+          context,
+          key.dim_size(i) == query.dim_size(i) &&
+              value.dim_size(i) == query.dim_size(i),
+          errors::InvalidArgument(
+              "query, key and value must have the same batch dimensions, got ",
+              query.shape().DebugString(), ", ", key.shape().DebugString(),
+              " and ", value.shape().DebugString()));
+    }
+    const int64_t num_queries = query.dim_size(dims - 2);
+    const int64_t depth = query.dim_size(dims - 1);
+    const int64_t num_keys = key.dim_size(dims - 2);
+    const int64_t value_depth = value.dim_size(dims - 1);
+    OP_REQUIRES(context, key.dim_size(dims - 1) == depth,
+                errors::InvalidArgument(
+                    "query and key must have the same last dimension, got ",
+                    query.shape().DebugString(), " and ",
+                    key.shape().DebugString()));
+    OP_REQUIRES(context, value.dim_size(dims - 2) == num_keys,
+                errors::InvalidArgument(
+                    "key and value must have the same number of rows, got ",
+                    key.shape().DebugString(), " and ",
+                    value.shape().DebugString()));
+
+    TensorShape output_shape = query.shape();
+    output_shape.set_dim(dims - 1, value_depth);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, output_shape, &output));
+    if (output->NumElements() == 0) return;
+
+    int64_t batch_size = 1;
+    for (int i = 0; i < dims - 2; ++i) {
+      batch_size *= query.dim_size(i);
+    }
+    const int64_t num_query_blocks =
+        (num_queries + kQueryBlockSize - 1) / kQueryBlockSize;
+    const T* query_data = query.flat<T>().data();
+    const T* key_data = key.flat<T>().data();
+    const T* value_data = value.flat<T>().data();
+    T* output_data = output->flat<T>().data();
+
+    auto work = [&](int64_t start, int64_t limit) {
+      RowMajorMatrix<float> q, k, v, scores, acc;
+      Eigen::VectorXf row_max, row_sum;
+      for (int64_t unit = start; unit < limit; ++unit) {
+        const int64_t b = unit / num_query_blocks;
+        const int64_t q_start = (unit % num_query_blocks) * kQueryBlockSize;
+        const int64_t nq = std::min(kQueryBlockSize, num_queries - q_start);
+        q = MapRows(query_data + (b * num_queries + q_start) * depth, nq,
+                    depth)
+                .template cast<float>() *
+            scale_;
+        acc.setZero(nq, value_depth);
+        row_max.setConstant(nq, -std::numeric_limits<float>::infinity());
+        row_sum.setZero(nq);
+
+        // With causal masking, query q_start + r sees the keys before
+        // q_start + r + 1 + causal_offset.
+        const int64_t causal_offset = num_keys - num_queries;
+        const int64_t key_end =
+            is_causal_ ? std::min(num_keys, q_start + nq + causal_offset)
+                       : num_keys;
+        for (int64_t k_start = 0; k_start < key_end;
+             k_start += kKeyBlockSize) {
+          const int64_t nk = std::min(kKeyBlockSize, key_end - k_start);
+          k = MapRows(key_data + (b * num_keys + k_start) * depth, nk, depth)
+                  .template cast<float>();
+          v = MapRows(value_data + (b * num_keys + k_start) * value_depth, nk,
+                      value_depth)
+                  .template cast<float>();
+          scores.noalias() = q * k.transpose();
+          for (int64_t r = 0; r < nq; ++r) {
+            auto row = scores.row(r).array();
+            if (is_causal_) {
+              const int64_t visible = std::clamp<int64_t>(
+                  q_start + r + 1 + causal_offset - k_start, 0, nk);
+              row.tail(nk - visible) = -std::numeric_limits<float>::infinity();
+            }
+            const float new_max = std::max(row_max(r), row.maxCoeff());
+            if (new_max == -std::numeric_limits<float>::infinity()) {
+              // No key of this block is visible to the query yet.
+              row.setZero();
+              continue;
+            }
+            const float correction = std::exp(row_max(r) - new_max);
+            row = (row - new_max).exp();
+            row_sum(r) = row_sum(r) * correction + row.sum();
+            acc.row(r) *= correction;
+            row_max(r) = new_max;
+          }
+          acc.noalias() += scores * v;
+        }
+
+        T* out = output_data + (b * num_queries + q_start) * value_depth;
+        for (int64_t r = 0; r < nq; ++r) {
+          // Queries that see no key at all get zeros.
+          const float inv_sum = row_sum(r) > 0 ? 1.0f / row_sum(r) : 0.0f;
+          for (int64_t c = 0; c < value_depth; ++c) {
+            out[r * value_depth + c] = static_cast<T>(acc(r, c) * inv_sum);
+          }
+        }
+      }
+    };
+    const int64_t cost_per_unit =
+        2 * kQueryBlockSize * num_keys * (depth + value_depth);
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          batch_size * num_query_blocks, cost_per_unit, work);
+  }
+
+ private:
+  float scale_;
+  bool is_causal_;
+};
+
+#define REGISTER_CPU_KERNELS(T)                                   \
+  REGISTER_KERNEL_BUILDER(Name("_FusedScaledDotProductAttention") \
+                              .Device(DEVICE_CPU)                 \
+                              .TypeConstraint<T>("T"),            \
+                          FusedScaledDotProductAttentionOp<T>);
+
+TF_CALL_half(REGISTER_CPU_KERNELS);
+TF_CALL_bfloat16(REGISTER_CPU_KERNELS);
+TF_CALL_float(REGISTER_CPU_KERNELS);
+#undef REGISTER_CPU_KERNELS
+
+}  // namespace tensorflow
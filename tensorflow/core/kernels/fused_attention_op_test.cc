@@ -0,0 +1,177 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedScaledDotProductAttentionOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(DataType dtype, float scale, bool is_causal) {
+    TF_ASSERT_OK(NodeDefBuilder("fused_attention_op",
+                                "_FusedScaledDotProductAttention")
+                     .Input(FakeInput(dtype))
+                     .Input(FakeInput(dtype))
+                     .Input(FakeInput(dtype))
+                     .Attr("scale", scale)
+                     .Attr("is_causal", is_causal)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  void AddFloatInput(const Tensor& input) {
+    AddInputFromArray<float>(
+        input.shape(),
+        gtl::ArraySlice<float>(input.flat<float>().data(),
+                               input.NumElements()));
+  }
+};
+
+// Computes the attention with the scores of all the keys, in double.
+Tensor ReferenceAttention(const Tensor& query, const Tensor& key,
+                          const Tensor& value, float scale, bool is_causal) {
+  const int64_t batch = query.dim_size(0);
+  const int64_t num_queries = query.dim_size(1);
+  const int64_t depth = query.dim_size(2);
+  const int64_t num_keys = key.dim_size(1);
+  const int64_t value_depth = value.dim_size(2);
+  const auto q = query.tensor<float, 3>();
+  const auto k = key.tensor<float, 3>();
+  const auto v = value.tensor<float, 3>();
+  Tensor output(DT_FLOAT, TensorShape({batch, num_queries, value_depth}));
+  auto out = output.tensor<float, 3>();
+  for (int64_t b = 0; b < batch; ++b) {
+    for (int64_t i = 0; i < num_queries; ++i) {
+      const int64_t limit =
+          is_causal ? std::clamp<int64_t>(i + 1 + num_keys - num_queries, 0,
+                                          num_keys)
+                    : num_keys;
+      std::vector<double> scores(limit);
+      double max_score = -INFINITY;
+      for (int64_t j = 0; j < limit; ++j) {
+        double score = 0;
+        for (int64_t c = 0; c < depth; ++c) score += q(b, i, c) * k(b, j, c);
+        scores[j] = score * scale;
+        max_score = std::max(max_score, scores[j]);
+      }
+      double sum = 0;
+      for (double& score : scores) {
+        score = std::exp(score - max_score);
+        sum += score;
+      }
+      for (int64_t c = 0; c < value_depth; ++c) {
+        double result = 0;
+        for (int64_t j = 0; j < limit; ++j) result += scores[j] * v(b, j, c);
+        out(b, i, c) = limit > 0 ? result / sum : 0;
+      }
+    }
+  }
+  return output;
+}
+
+Tensor RandomTensor(const TensorShape& shape) {
+  Tensor tensor(DT_FLOAT, shape);
+  tensor.flat<float>().setRandom();
+  return tensor;
+}
+
+TEST_F(FusedScaledDotProductAttentionOpTest, MatchesTheReference) {
+  // The sizes are not multiples of the query and key blocks.
+  const Tensor query = RandomTensor(TensorShape({2, 70, 8}));
+  const Tensor key = RandomTensor(TensorShape({2, 130, 8}));
+  const Tensor value = RandomTensor(TensorShape({2, 130, 5}));
+  MakeOp(DT_FLOAT, /*scale=*/0.5f, /*is_causal=*/false);
+  AddFloatInput(query);
+  AddFloatInput(key);
+  AddFloatInput(value);
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorNear<float>(
+      *GetOutput(0),
+      ReferenceAttention(query, key, value, 0.5f, /*is_causal=*/false), 1e-5);
+}
+
+TEST_F(FusedScaledDotProductAttentionOpTest, CausalMatchesTheReference) {
+  const Tensor query = RandomTensor(TensorShape({2, 70, 8}));
+  const Tensor key = RandomTensor(TensorShape({2, 200, 8}));
+  const Tensor value = RandomTensor(TensorShape({2, 200, 5}));
+  MakeOp(DT_FLOAT, /*scale=*/0.5f, /*is_causal=*/true);
+  AddFloatInput(query);
+  AddFloatInput(key);
+  AddFloatInput(value);
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorNear<float>(
+      *GetOutput(0),
+      ReferenceAttention(query, key, value, 0.5f, /*is_causal=*/true), 1e-5);
+}
+
+TEST_F(FusedScaledDotProductAttentionOpTest, CausalQueriesWithoutKeysAreZero) {
+  // The first query sees no key, the second one sees the first key.
+  MakeOp(DT_FLOAT, /*scale=*/1.0f, /*is_causal=*/true);
+  AddInputFromArray<float>(TensorShape({2, 1}), {1, 1});
+  AddInputFromArray<float>(TensorShape({1, 1}), {1});
+  AddInputFromArray<float>(TensorShape({1, 2}), {3, 4});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<float>(*GetOutput(0),
+                                 test::AsTensor<float>({0, 0, 3, 4}, {2, 2}));
+}
+
+TEST_F(FusedScaledDotProductAttentionOpTest, Bfloat16) {
+  MakeOp(DT_BFLOAT16, /*scale=*/1.0f, /*is_causal=*/false);
+  // The scores are 0 and log(3), so the weights are 1/4 and 3/4.
+  AddInputFromArray<bfloat16>(TensorShape({1, 1}), {bfloat16(1.0f)});
+  AddInputFromArray<bfloat16>(TensorShape({2, 1}),
+                              {bfloat16(0.0f), bfloat16(std::log(3.0f))});
+  AddInputFromArray<bfloat16>(TensorShape({2, 1}),
+                              {bfloat16(4.0f), bfloat16(8.0f)});
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_NEAR(static_cast<float>(GetOutput(0)->flat<bfloat16>()(0)), 7.0f,
+              0.05f);
+}
+
+TEST_F(FusedScaledDotProductAttentionOpTest, ZeroDepth) {
+  // All the scores are 0, so every query averages the values.
+  MakeOp(DT_FLOAT, /*scale=*/1.0f, /*is_causal=*/false);
+  AddInputFromArray<float>(TensorShape({2, 3, 0}), {});
+  AddInputFromArray<float>(TensorShape({2, 2, 0}), {});
+  AddInputFromArray<float>(TensorShape({2, 2, 1}), {1, 3, 2, 6});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorNear<float>(
+      *GetOutput(0), test::AsTensor<float>({2, 2, 2, 4, 4, 4}, {2, 3, 1}),
+      1e-6);
+}
+
+TEST_F(FusedScaledDotProductAttentionOpTest, FailsForMismatchedDepth) {
+  MakeOp(DT_FLOAT, /*scale=*/1.0f, /*is_causal=*/false);
+  AddInputFromArray<float>(TensorShape({1, 2}), {1, 2});
+  AddInputFromArray<float>(TensorShape({1, 3}), {1, 2, 3});
+  AddInputFromArray<float>(TensorShape({1, 1}), {1});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+}  // namespace
+}  // namespace tensorflow
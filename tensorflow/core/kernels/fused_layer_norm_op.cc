@@ -0,0 +1,123 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/nn_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+// Normalizes every row of the last dimension of `x`. The mean and variance of
+// a row are computed in a single pass with Welford's algorithm, accumulating
+// in float for all T, and the row is then normalized while it is still in the
+// cache. This replaces the Mean, SquaredDifference, Mean, Rsqrt, Mul and Add
+// ops of a decomposed layer normalization, which each make a pass over memory.
+template <typename T>
+class FusedLayerNormOp : public OpKernel {
+ public:
+  explicit FusedLayerNormOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("epsilon", &epsilon_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& x = context->input(0);
+    const Tensor& scale = context->input(1);
+    const Tensor& offset = context->input(2);
+    OP_REQUIRES(context, TensorShapeUtils::IsVectorOrHigher(x.shape()),
+                errors::InvalidArgument("x must have >= 1 dimension, got ",
+                                        x.shape().DebugString()));
+    const int64_t depth = x.dim_size(x.dims() - 1);
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(scale.shape()) &&
+                    scale.NumElements() == depth,
+                errors::InvalidArgument("scale must be a vector of ", depth,
+                                        " elements, got shape ",
+                                        scale.shape().DebugString()));
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(offset.shape()) &&
+                    offset.NumElements() == depth,
+                errors::InvalidArgument("offset must be a vector of ", depth,
+                                        " elements, got shape ",
+                                        offset.shape().DebugString()));
+
+    Tensor* y = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {0}, 0, x.shape(), &y));
+    if (x.NumElements() == 0) return;
+
+    std::vector<float> scale_f(depth);
+    std::vector<float> offset_f(depth);
+    const auto scale_flat = scale.flat<T>();
+    const auto offset_flat = offset.flat<T>();
+    for (int64_t i = 0; i < depth; ++i) {
+      scale_f[i] = static_cast<float>(scale_flat(i));
+      offset_f[i] = static_cast<float>(offset_flat(i));
+    }
+
+    const T* x_data = x.flat<T>().data();
+    T* y_data = y->flat<T>().data();
+    const int64_t num_rows = x.NumElements() / depth;
+    const float epsilon = epsilon_;
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+          /*cost_per_unit=*/10 * depth, [&](int64_t start, int64_t limit) {
+            for (int64_t row = start; row < limit; ++row) {
+              const T* in = x_data + row * depth;
+              T* out = y_data + row * depth;
+              float mean = 0;
+              float m2 = 0;
+              for (int64_t i = 0; i < depth; ++i) {
+                const float value = static_cast<float>(in[i]);
+                const float delta = value - mean;
+                mean += delta / static_cast<float>(i + 1);
+                m2 += delta * (value - mean);
+              }
+              const float inv_stddev =
+                  1.0f / std::sqrt(m2 / static_cast<float>(depth) + epsilon);
+              for (int64_t i = 0; i < depth; ++i) {
+                const float normalized =
+                    (static_cast<float>(in[i]) - mean) * inv_stddev;
+                out[i] = static_cast<T>(normalized * scale_f[i] + offset_f[i]);
+              }
+            }
+          });
+  }
+
+ private:
+  float epsilon_;
+};
+
+#define REGISTER_CPU_KERNELS(T)                                          \
+  REGISTER_KERNEL_BUILDER(                                               \
+      Name("_FusedLayerNorm").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedLayerNormOp<T>);
+
+TF_CALL_half(REGISTER_CPU_KERNELS);
+TF_CALL_bfloat16(REGISTER_CPU_KERNELS);
+TF_CALL_float(REGISTER_CPU_KERNELS);
+#undef REGISTER_CPU_KERNELS
+
+}  // namespace tensorflow
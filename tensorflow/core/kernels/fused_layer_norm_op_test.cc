@@ -0,0 +1,101 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedLayerNormOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(DataType dtype, float epsilon) {
+    TF_ASSERT_OK(NodeDefBuilder("fused_layer_norm_op", "_FusedLayerNorm")
+                     .Input(FakeInput(dtype))
+                     .Input(FakeInput(dtype))
+                     .Input(FakeInput(dtype))
+                     .Attr("epsilon", epsilon)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(FusedLayerNormOpTest, NormalizesTheLastDimension) {
+  MakeOp(DT_FLOAT, /*epsilon=*/0.0f);
+  AddInputFromArray<float>(TensorShape({2, 4}), {1, 2, 3, 4, 10, 10, 30, 30});
+  AddInputFromArray<float>(TensorShape({4}), {1, 1, 2, 2});
+  AddInputFromArray<float>(TensorShape({4}), {0, 1, 0, 1});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // The rows have means 2.5 and 20, and variances 1.25 and 100.
+  const float a = 1.5f / std::sqrt(1.25f);
+  const float b = 0.5f / std::sqrt(1.25f);
+  test::ExpectTensorNear<float>(
+      *GetOutput(0),
+      test::AsTensor<float>({-a, 1 - b, 2 * b, 1 + 2 * a, -1, 0, 2, 3},
+                            {2, 4}),
+      1e-5);
+}
+
+TEST_F(FusedLayerNormOpTest, AddsEpsilonToTheVariance) {
+  MakeOp(DT_FLOAT, /*epsilon=*/3.0f);
+  AddInputFromArray<float>(TensorShape({1, 2}), {-1, 1});
+  AddInputFromArray<float>(TensorShape({2}), {1, 1});
+  AddInputFromArray<float>(TensorShape({2}), {0, 0});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorNear<float>(*GetOutput(0),
+                                test::AsTensor<float>({-0.5f, 0.5f}, {1, 2}),
+                                1e-6);
+}
+
+TEST_F(FusedLayerNormOpTest, Bfloat16AccumulatesInFloat) {
+  MakeOp(DT_BFLOAT16, /*epsilon=*/0.0f);
+  // A running sum of these values in bfloat16 would be off by much more than
+  // their spread.
+  std::vector<bfloat16> x;
+  for (int i = 0; i < 256; ++i) {
+    x.push_back(static_cast<bfloat16>(i % 2 == 0 ? 127.0f : 129.0f));
+  }
+  AddInputFromArray<bfloat16>(TensorShape({1, 256}), x);
+  AddInputFromArray<bfloat16>(TensorShape({256}),
+                              std::vector<bfloat16>(256, bfloat16(1.0f)));
+  AddInputFromArray<bfloat16>(TensorShape({256}),
+                              std::vector<bfloat16>(256, bfloat16(0.0f)));
+  TF_ASSERT_OK(RunOpKernel());
+  const auto y = GetOutput(0)->flat<bfloat16>();
+  for (int i = 0; i < 256; ++i) {
+    EXPECT_FLOAT_EQ(static_cast<float>(y(i)), i % 2 == 0 ? -1.0f : 1.0f) << i;
+  }
+}
+
+TEST_F(FusedLayerNormOpTest, FailsForWrongScaleSize) {
+  MakeOp(DT_FLOAT, /*epsilon=*/0.001f);
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({3}), {1, 1, 1});
+  AddInputFromArray<float>(TensorShape({2}), {0, 0});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_GATHER_FUNCTOR_H_
 #define TENSORFLOW_CORE_KERNELS_GATHER_FUNCTOR_H_
 
+#include <algorithm>
+#include <limits>
+
 #include "absl/base/prefetch.h"
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/bounds_check.h"
@@ -32,6 +35,13 @@ typedef Eigen::GpuDevice GPUDevice;
 
 namespace functor {
 
+// The number of slices between the prefetch of a slice and its copy, and the
+// number of bytes prefetched at the start of every slice. Later cache lines of
+// long slices are fetched by the hardware prefetcher.
+constexpr int64_t kGatherPrefetchDistance = 8;
+constexpr size_t kGatherPrefetchBytes = 256;
+constexpr size_t kGatherCacheLineBytes = 64;
+
 // Helper method to copy using memcpy.
 template <typename T, typename Index, typename SliceIndex,
           SliceIndex static_slice_elems>
@@ -56,32 +66,46 @@ SliceIndex HandleCopies(OpKernelContext* ctx,
   // Store the value of invalidate index for printing error information, it's a
   // shared variable.
   SliceIndex result = -1;
+  // Prefetches the start of the slice that is copied kGatherPrefetchDistance
+  // slices later, so that the cache misses of random rows of a large table
+  // overlap instead of stalling every copy in turn.
+  const size_t prefetch_bytes = std::min(slice_bytes, kGatherPrefetchBytes);
+  auto prefetch = [&](SliceIndex b, SliceIndex i) {
+    const Index index = indices(i);
+    if (!FastBoundsCheck(index, limit)) return;
+    const char* slice = reinterpret_cast<const char*>(&params(b, index, 0));
+    for (size_t offset = 0; offset < prefetch_bytes;
+         offset += kGatherCacheLineBytes) {
+      absl::PrefetchToLocalCache(slice + offset);
+    }
+  };
   auto work = [&](int64_t start, int64_t end) {
     SliceIndex batch_idx = static_cast<SliceIndex>(start / indices_size);
     SliceIndex indices_idx = static_cast<SliceIndex>(start % indices_size);
-    SliceIndex batch_idx_end = static_cast<SliceIndex>(end / indices_size);
-    SliceIndex indices_idx_end = static_cast<SliceIndex>(end % indices_size);
+    int64_t ahead = std::min(start + kGatherPrefetchDistance, end);
+    SliceIndex ahead_batch_idx = static_cast<SliceIndex>(ahead / indices_size);
+    SliceIndex ahead_indices_idx =
+        static_cast<SliceIndex>(ahead % indices_size);
+    for (int64_t i = start; i < ahead; ++i) {
+      prefetch(static_cast<SliceIndex>(i / indices_size),
+               static_cast<SliceIndex>(i % indices_size));
+    }
 
-    while ((batch_idx < batch_idx_end) ||
-           (batch_idx == batch_idx_end && indices_idx < indices_idx_end)) {
-      SliceIndex i_next = indices_idx + 1;
-      SliceIndex b_next = batch_idx + 1;
+    for (int64_t i = start; i < end; ++i) {
+      if (ahead < end) {
+        prefetch(ahead_batch_idx, ahead_indices_idx);
+        ++ahead;
+        if (++ahead_indices_idx == indices_size) {
+          ahead_indices_idx = 0;
+          ++ahead_batch_idx;
+        }
+      }
       const Index index = internal::SubtleMustCopy(indices(indices_idx));
       if (!FastBoundsCheck(index, limit)) {
         mutex_lock l(mu);
         result = indices_idx;
         return;
       }
-      if ((batch_idx == batch_idx_end && i_next < indices_idx_end) ||
-          (i_next < indices_size)) {
-        absl::PrefetchToLocalCache(&params(batch_idx, indices(i_next), 0));
-        absl::PrefetchToLocalCache(&out(batch_idx, i_next, 0));
-        b_next = batch_idx;
-      } else if (b_next <= batch_idx_end) {
-        absl::PrefetchToLocalCache(&params(b_next, indices(0), 0));
-        absl::PrefetchToLocalCache(&out(b_next, 0, 0));
-        i_next = 0;
-      }
       // Copy using memcpy if possible, otherwise an Eigen loop
       // TODO(cwhipkey): avoid linking to framework to get Allocator (to improve
       // ahead-of-time compilation binary size).
@@ -98,8 +122,10 @@ SliceIndex HandleCopies(OpKernelContext* ctx,
         out.template chip<0>(batch_idx).template chip<0>(indices_idx) =
             params.template chip<0>(batch_idx).template chip<0>(index);
       }
-      indices_idx = i_next;
-      batch_idx = b_next;
+      if (++indices_idx == indices_size) {
+        indices_idx = 0;
+        ++batch_idx;
+      }
     }
   };
 
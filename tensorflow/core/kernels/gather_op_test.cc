@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
+#include <cmath>
 #include <functional>
 #include <memory>
 #include <vector>
@@ -176,6 +178,36 @@ TEST_F(GatherOpTest, HighRank) {
   test::ExpectTensorEqual<float>(expected, *GetOutput(0));
 }
 
+TEST_F(GatherOpTest, ManyIndices_Axis1) {
+  // Enough indices for several shards, which prefetch across the rows of the
+  // outer dimension.
+  MakeOp(DT_FLOAT, DT_INT32);
+  constexpr int kOuter = 3;
+  constexpr int kRows = 1000;
+  constexpr int kInner = 5;
+  constexpr int kNumIndices = 20000;
+  std::vector<float> params(kOuter * kRows * kInner);
+  for (int i = 0; i < params.size(); ++i) params[i] = i;
+  std::vector<int32> indices(kNumIndices);
+  for (int i = 0; i < kNumIndices; ++i) indices[i] = (i * 7919) % kRows;
+  AddInputFromArray<float>(TensorShape({kOuter, kRows, kInner}), params);
+  AddInputFromArray<int32>(TensorShape({kNumIndices}), indices);
+  AddInputFromArray<int32>(TensorShape({}), {1});
+  TF_ASSERT_OK(RunOpKernel());
+
+  const auto output = GetOutput(0)->tensor<float, 3>();
+  ASSERT_EQ(GetOutput(0)->shape(),
+            TensorShape({kOuter, kNumIndices, kInner}));
+  for (int b = 0; b < kOuter; ++b) {
+    for (int i = 0; i < kNumIndices; ++i) {
+      for (int j = 0; j < kInner; ++j) {
+        ASSERT_EQ(output(b, i, j),
+                  params[(b * kRows + indices[i]) * kInner + j]);
+      }
+    }
+  }
+}
+
 TEST_F(GatherOpTest, Error_IndexOutOfRange) {
   MakeOp(DT_FLOAT, DT_INT32);
 
@@ -205,6 +237,7 @@ TEST_F(GatherOpTest, Error_BatchDimsOutOfRange) {
 }
 
 constexpr int kLookups = 2000;
+constexpr int kZipfLookups = 1 << 16;
 
 template <typename Index>
 static Graph* Gather(int dim) {
@@ -261,5 +294,47 @@ BM_GATHER(gpu, int32);
 BM_GATHER(cpu, int64_t);
 BM_GATHER(gpu, int64_t);
 
+// Embedding lookups follow a heavy-tailed distribution: rank r is drawn with
+// a probability about proportional to 1 / r. The ranks are hashed to rows, so
+// that the frequent ids are spread over the table.
+template <typename Index>
+static Graph* GatherZipf(int dim) {
+  Graph* g = new Graph(OpRegistry::Global());
+  // Always use a 512MB buffer.
+  const int kRows = ((512 << 20) / sizeof(float)) / dim;
+  Tensor params(DT_FLOAT, TensorShape({kRows, dim}));
+  params.flat<float>().setRandom();
+
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  Tensor indices(DataTypeToEnum<Index>::value, TensorShape({kZipfLookups}));
+  const double log_rows = std::log(static_cast<double>(kRows) + 1);
+  for (int i = 0; i < kZipfLookups; i++) {
+    const int64_t rank = std::min<int64_t>(
+        static_cast<int64_t>(std::exp(rnd.RandDouble() * log_rows)) - 1,
+        kRows - 1);
+    indices.flat<Index>()(i) = (rank * 2654435761LL) % kRows;
+  }
+
+  Tensor axis(DataTypeToEnum<Index>::value, TensorShape({}));
+  axis.scalar<Index>()() = 0;
+
+  test::graph::Gather(g, test::graph::Constant(g, params),
+                      test::graph::Constant(g, indices),
+                      test::graph::HostConstant(g, axis));
+  return g;
+}
+
+static void BM_cpu_gather_zipf(::testing::benchmark::State& state) {
+  const int dim = state.range(0);
+  test::Benchmark("cpu", GatherZipf<int64_t>(dim), /*old_benchmark_api=*/false)
+      .Run(state);
+  const int64_t tot =
+      static_cast<int64_t>(state.iterations()) * kZipfLookups * dim;
+  state.SetItemsProcessed(tot);
+  state.SetBytesProcessed(tot * sizeof(float));
+}
+BENCHMARK(BM_cpu_gather_zipf)->UseRealTime()->Arg(16)->Arg(64)->Arg(256);
+
 }  // namespace
 }  // namespace tensorflow
@@ -0,0 +1,148 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks of the image input pipeline of a typical image classification
+// model: decode, random crop, flip and resize. The images/s of the different
+// ways to run it are reported as items/s.
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int kImageSize = 512;
+constexpr int kCropSize = 400;
+constexpr int kOutputSize = 224;
+
+// Returns the JPEG encoding of a random `kImageSize`x`kImageSize` RGB image.
+tstring RandomJpeg() {
+  Tensor image(DT_UINT8, TensorShape({kImageSize, kImageSize, 3}));
+  image.flat<uint8>().setRandom();
+  jpeg::CompressFlags flags;
+  flags.format = jpeg::FORMAT_RGB;
+  return jpeg::Compress(image.flat<uint8>().data(), kImageSize, kImageSize,
+                        flags);
+}
+
+Tensor CropSize() {
+  Tensor crop_size(DT_INT32, TensorShape({2}));
+  crop_size.vec<int32>().setConstant(kOutputSize);
+  return crop_size;
+}
+
+// Crops the `batch_size` images of `images` to their centered `kCropSize`
+// square, resizes them to `kOutputSize` and flips them horizontally.
+Node* CropResizeAndFlip(Graph* g, Node* images, int batch_size) {
+  Tensor boxes(DT_FLOAT, TensorShape({batch_size, 4}));
+  auto boxes_matrix = boxes.matrix<float>();
+  const float border = (kImageSize - kCropSize) / 2.0f / kImageSize;
+  for (int i = 0; i < batch_size; ++i) {
+    boxes_matrix(i, 0) = boxes_matrix(i, 1) = border;
+    boxes_matrix(i, 2) = boxes_matrix(i, 3) = 1.0f - border;
+  }
+  Tensor box_ind(DT_INT32, TensorShape({batch_size}));
+  for (int i = 0; i < batch_size; ++i) box_ind.vec<int32>()(i) = i;
+  Node* resized;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "CropAndResize")
+                  .Input(images)
+                  .Input(test::graph::Constant(g, boxes))
+                  .Input(test::graph::Constant(g, box_ind))
+                  .Input(test::graph::Constant(g, CropSize()))
+                  .Finalize(g, &resized));
+  return test::graph::Reverse(g, resized,
+                              test::graph::Constant(g, test::AsTensor({2})));
+}
+
+// Decodes each image with `DecodeJpeg`, then crops, resizes and flips it.
+Graph* DecodeJpegAndAugment(int batch_size) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor contents(DT_STRING, TensorShape({}));
+  contents.scalar<tstring>()() = RandomJpeg();
+  for (int i = 0; i < batch_size; ++i) {
+    Node* image;
+    TF_CHECK_OK(NodeBuilder(g->NewName("n"), "DecodeJpeg")
+                    .Input(test::graph::Constant(g, contents))
+                    .Attr("channels", 3)
+                    .Finalize(g, &image));
+    Node* images = test::graph::Binary(
+        g, "ExpandDims", image, test::graph::Constant(g, test::AsScalar(0)));
+    CropResizeAndFlip(g, images, /*batch_size=*/1);
+  }
+  return g;
+}
+
+// Decodes, crops and resizes the batch with `DecodeAndResizeJpegBatch`, then
+// flips it.
+Graph* DecodeAndResizeJpegBatch(int batch_size) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor contents(DT_STRING, TensorShape({batch_size}));
+  contents.vec<tstring>().setConstant(RandomJpeg());
+  Tensor crop_windows(DT_INT32, TensorShape({batch_size, 4}));
+  const int border = (kImageSize - kCropSize) / 2;
+  for (int i = 0; i < batch_size; ++i) {
+    crop_windows.matrix<int32>()(i, 0) = border;
+    crop_windows.matrix<int32>()(i, 1) = border;
+    crop_windows.matrix<int32>()(i, 2) = kCropSize;
+    crop_windows.matrix<int32>()(i, 3) = kCropSize;
+  }
+  Node* images;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "DecodeAndResizeJpegBatch")
+                  .Input(test::graph::Constant(g, contents))
+                  .Input(test::graph::Constant(g, crop_windows))
+                  .Input(test::graph::Constant(g, CropSize()))
+                  .Finalize(g, &images));
+  test::graph::Reverse(g, images,
+                       test::graph::Constant(g, test::AsTensor({2})));
+  return g;
+}
+
+// Crops, resizes and flips a batch of decoded images, to compare the
+// augmentation on the host and on the device.
+Graph* Augment(int batch_size) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor images(DT_UINT8,
+                TensorShape({batch_size, kImageSize, kImageSize, 3}));
+  images.flat<uint8>().setRandom();
+  CropResizeAndFlip(
+      g, test::graph::Cast(g, test::graph::Constant(g, images), DT_FLOAT),
+      batch_size);
+  return g;
+}
+
+#define BM_ImagePipeline(DEVICE, PIPELINE, B)                          \
+  static void BM_##PIPELINE##_##DEVICE##_##B(                          \
+      ::testing::benchmark::State& state) {                            \
+    test::Benchmark(#DEVICE, PIPELINE(B), /*old_benchmark_api*/ false) \
+        .Run(state);                                                   \
+    state.SetItemsProcessed(state.iterations() * B);                   \
+  }                                                                    \
+  BENCHMARK(BM_##PIPELINE##_##DEVICE##_##B)->UseRealTime();
+
+BM_ImagePipeline(cpu, DecodeJpegAndAugment, 32);
+BM_ImagePipeline(cpu, DecodeAndResizeJpegBatch, 32);
+BM_ImagePipeline(cpu, Augment, 32);
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+BM_ImagePipeline(gpu, Augment, 32);
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+}  // namespace
+}  // namespace tensorflow
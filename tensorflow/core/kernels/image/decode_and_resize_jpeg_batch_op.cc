@@ -0,0 +1,285 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/image_ops.cc
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/stringpiece.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace {
+
+// Rough number of cycles to decode and resize an image, per output value. The
+// cost of an image is dominated by its decoding, which is only known once it
+// is decoded, so it is chosen high enough to give each image its own shard.
+constexpr int64_t kCostPerOutputValue = 1000;
+
+// Returns the largest DCT-domain downscaling ratio supported by libjpeg such
+// that the downscaled crop window is still at least as large as the output.
+// Decoding at a lower resolution skips most of the inverse DCT and color
+// conversion work for the pixels that the resize would later drop anyway.
+int ChooseRatio(int crop_height, int crop_width, int output_height,
+                int output_width) {
+  for (int ratio : {8, 4, 2}) {
+    if (crop_height / ratio >= output_height &&
+        crop_width / ratio >= output_width) {
+      return ratio;
+    }
+  }
+  return 1;
+}
+
+// Precomputed source coordinates and interpolation weight of one output row or
+// column.
+struct InterpolationCoefficient {
+  int64_t lower;
+  int64_t upper;
+  float lerp;
+};
+
+// Computes the coefficients that map the `output_size` output pixels to the
+// window of size `window_size` starting at `window_start` of the input, whose
+// pixels are spaced by `input_scale` and which is `input_size` pixels large.
+// Uses half pixel centers, like `tf.image.resize`.
+std::vector<InterpolationCoefficient> ComputeCoefficients(
+    int64_t output_size, float window_start, float window_size,
+    float input_scale, int64_t input_size) {
+  std::vector<InterpolationCoefficient> coefficients(output_size);
+  const float scale = window_size / output_size;
+  for (int64_t i = 0; i < output_size; ++i) {
+    const float in = std::clamp(
+        (window_start + (i + 0.5f) * scale) / input_scale - 0.5f, 0.0f,
+        static_cast<float>(input_size - 1));
+    coefficients[i].lower = static_cast<int64_t>(std::floor(in));
+    coefficients[i].upper = std::min(coefficients[i].lower + 1, input_size - 1);
+    coefficients[i].lerp = in - coefficients[i].lower;
+  }
+  return coefficients;
+}
+
+// Decodes a batch of JPEG images, crops them and resizes them to a common size
+// with bilinear interpolation. The images of the batch are decoded in parallel
+// on the intra-op thread pool, and each image is decoded in the DCT domain at
+// the lowest resolution that is still larger than its resized crop window.
+class DecodeAndResizeJpegBatchOp : public OpKernel {
+ public:
+  explicit DecodeAndResizeJpegBatchOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &channels_));
+    OP_REQUIRES(context, channels_ == 1 || channels_ == 3,
+                errors::InvalidArgument("channels must be 1 or 3, got ",
+                                        channels_));
+    flags_.components = channels_;
+    OP_REQUIRES_OK(context, context->GetAttr("fancy_upscaling",
+                                             &flags_.fancy_upscaling));
+    string dct_method;
+    OP_REQUIRES_OK(context, context->GetAttr("dct_method", &dct_method));
+    OP_REQUIRES(
+        context,
+        (dct_method.empty() || dct_method == "INTEGER_FAST" ||
+         dct_method == "INTEGER_ACCURATE"),
+        errors::InvalidArgument("dct_method must be one of "
+                                "{'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}"));
+    // Same default as `DecodeJpeg`, which favors speed over image quality.
+    flags_.dct_method =
+        dct_method == "INTEGER_ACCURATE" ? JDCT_ISLOW : JDCT_IFAST;
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(contents.shape()),
+                errors::InvalidArgument("contents must be a vector, got shape ",
+                                        contents.shape().DebugString()));
+    const int64_t batch_size = contents.dim_size(0);
+
+    const Tensor& crop_windows = context->input(1);
+    OP_REQUIRES(
+        context,
+        TensorShapeUtils::IsMatrix(crop_windows.shape()) &&
+            crop_windows.dim_size(1) == 4 &&
+            (crop_windows.dim_size(0) == 0 ||
+             crop_windows.dim_size(0) == batch_size),
+        errors::InvalidArgument(
+            "crop_windows must have shape [batch_size, 4] or [0, 4], got ",
+            crop_windows.shape().DebugString()));
+    const bool crop = crop_windows.dim_size(0) > 0;
+
+    const Tensor& size = context->input(2);
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(size.shape()) &&
+                    size.NumElements() == 2,
+                errors::InvalidArgument("size must be a vector of 2 elements, "
+                                        "got shape ",
+                                        size.shape().DebugString()));
+    const int32_t output_height = size.vec<int32>()(0);
+    const int32_t output_width = size.vec<int32>()(1);
+    OP_REQUIRES(context, output_height > 0 && output_width > 0,
+                errors::InvalidArgument("size must be positive, got [",
+                                        output_height, ", ", output_width,
+                                        "]"));
+
+    Tensor* images = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0,
+                       TensorShape({batch_size, output_height, output_width,
+                                    channels_}),
+                       &images));
+    if (batch_size == 0) return;
+
+    const auto contents_vec = contents.vec<tstring>();
+    const auto crop_windows_matrix = crop_windows.matrix<int32>();
+    const int64_t image_size =
+        static_cast<int64_t>(output_height) * output_width * channels_;
+    float* const images_data = images->flat<float>().data();
+    std::vector<absl::Status> statuses(batch_size);
+    auto decode = [&](int64_t start, int64_t limit) {
+      for (int64_t i = start; i < limit; ++i) {
+        const int32* crop_window = crop ? &crop_windows_matrix(i, 0) : nullptr;
+        statuses[i] = DecodeAndResize(contents_vec(i), crop_window,
+                                      output_height, output_width,
+                                      images_data + i * image_size);
+      }
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+          image_size * kCostPerOutputValue, decode);
+    for (const absl::Status& status : statuses) {
+      OP_REQUIRES_OK(context, status);
+    }
+  }
+
+ private:
+  // Decodes `input`, crops it to `crop_window` (`[crop_y, crop_x, crop_height,
+  // crop_width]`, or nullptr for the whole image) and resizes it into `output`.
+  absl::Status DecodeAndResize(StringPiece input, const int32* crop_window,
+                               int output_height, int output_width,
+                               float* output) const {
+    if (input.size() > std::numeric_limits<int>::max()) {
+      return errors::InvalidArgument("JPEG contents are too large for int: ",
+                                     input.size());
+    }
+    int width, height;
+    if (!jpeg::GetImageInfo(input.data(), input.size(), &width, &height,
+                            /*components=*/nullptr)) {
+      return errors::InvalidArgument("Invalid JPEG data, size ", input.size());
+    }
+    const int crop_y = crop_window != nullptr ? crop_window[0] : 0;
+    const int crop_x = crop_window != nullptr ? crop_window[1] : 0;
+    const int crop_height = crop_window != nullptr ? crop_window[2] : height;
+    const int crop_width = crop_window != nullptr ? crop_window[3] : width;
+    if (crop_height <= 0 || crop_width <= 0 || crop_y < 0 || crop_x < 0 ||
+        crop_y + static_cast<int64_t>(crop_height) > height ||
+        crop_x + static_cast<int64_t>(crop_width) > width) {
+      return errors::InvalidArgument(
+          "Invalid crop window [", crop_y, ", ", crop_x, ", ", crop_height,
+          ", ", crop_width, "] for an image of size ", height, "x", width);
+    }
+
+    // libjpeg decodes at `ceil(size / ratio)`. The crop window of the
+    // downscaled image is extended to whole downscaled pixels, and the exact
+    // window is applied by the resize below.
+    jpeg::UncompressFlags flags = flags_;
+    flags.ratio =
+        ChooseRatio(crop_height, crop_width, output_height, output_width);
+    const int ratio = flags.ratio;
+    const int scaled_height = (height + ratio - 1) / ratio;
+    const int scaled_width = (width + ratio - 1) / ratio;
+    const int scaled_y = crop_y / ratio;
+    const int scaled_x = crop_x / ratio;
+    const int scaled_crop_height =
+        std::min(scaled_height, (crop_y + crop_height + ratio - 1) / ratio) -
+        scaled_y;
+    const int scaled_crop_width =
+        std::min(scaled_width, (crop_x + crop_width + ratio - 1) / ratio) -
+        scaled_x;
+    if (scaled_crop_height < scaled_height ||
+        scaled_crop_width < scaled_width) {
+      flags.crop = true;
+      flags.crop_y = scaled_y;
+      flags.crop_x = scaled_x;
+      flags.crop_height = scaled_crop_height;
+      flags.crop_width = scaled_crop_width;
+    }
+
+    std::vector<uint8> decoded;
+    int decoded_height = 0;
+    int decoded_width = 0;
+    if (jpeg::Uncompress(
+            input.data(), input.size(), flags, /*nwarn=*/nullptr,
+            [&](int w, int h, int c) -> uint8* {
+              decoded_height = h;
+              decoded_width = w;
+              decoded.resize(static_cast<size_t>(w) * h * c);
+              return decoded.data();
+            }) == nullptr) {
+      return errors::InvalidArgument(
+          "jpeg::Uncompress failed. Invalid JPEG data or crop window.");
+    }
+
+    // Bilinear resize of the crop window, expressed in the coordinates of the
+    // decoded pixels.
+    const std::vector<InterpolationCoefficient> ys = ComputeCoefficients(
+        output_height, crop_y - scaled_y * ratio, crop_height, ratio,
+        decoded_height);
+    const std::vector<InterpolationCoefficient> xs = ComputeCoefficients(
+        output_width, crop_x - scaled_x * ratio, crop_width, ratio,
+        decoded_width);
+    const int64_t row_size = static_cast<int64_t>(decoded_width) * channels_;
+    for (int y = 0; y < output_height; ++y) {
+      const uint8* const top = decoded.data() + ys[y].lower * row_size;
+      const uint8* const bottom = decoded.data() + ys[y].upper * row_size;
+      const float y_lerp = ys[y].lerp;
+      for (int x = 0; x < output_width; ++x) {
+        const int64_t left = xs[x].lower * channels_;
+        const int64_t right = xs[x].upper * channels_;
+        const float x_lerp = xs[x].lerp;
+        for (int c = 0; c < channels_; ++c) {
+          const float top_value =
+              top[left + c] + (top[right + c] - top[left + c]) * x_lerp;
+          const float bottom_value =
+              bottom[left + c] +
+              (bottom[right + c] - bottom[left + c]) * x_lerp;
+          *output++ = top_value + (bottom_value - top_value) * y_lerp;
+        }
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  int channels_;
+  jpeg::UncompressFlags flags_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DecodeAndResizeJpegBatch").Device(DEVICE_CPU),
+                        DecodeAndResizeJpegBatchOp);
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,124 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int kImageSize = 64;
+constexpr uint8 kDarkValue = 50;
+constexpr uint8 kBrightValue = 200;
+// Tolerance on the decoded values, for the JPEG compression artifacts.
+constexpr float kTolerance = 10;
+
+// Returns a JPEG RGB image whose left half is dark and right half is bright.
+tstring TwoToneJpeg() {
+  std::vector<uint8> pixels(kImageSize * kImageSize * 3);
+  for (int y = 0; y < kImageSize; ++y) {
+    for (int x = 0; x < kImageSize; ++x) {
+      for (int c = 0; c < 3; ++c) {
+        pixels[(y * kImageSize + x) * 3 + c] =
+            x < kImageSize / 2 ? kDarkValue : kBrightValue;
+      }
+    }
+  }
+  jpeg::CompressFlags flags;
+  flags.format = jpeg::FORMAT_RGB;
+  return jpeg::Compress(pixels.data(), kImageSize, kImageSize, flags);
+}
+
+class DecodeAndResizeJpegBatchOpTest : public OpsTestBase {
+ protected:
+  void MakeOp() {
+    TF_ASSERT_OK(NodeDefBuilder("decode_op", "DecodeAndResizeJpegBatch")
+                     .Input(FakeInput(DT_STRING))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_INT32))
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(DecodeAndResizeJpegBatchOpTest, ResizesWholeImages) {
+  MakeOp();
+  const tstring jpeg = TwoToneJpeg();
+  AddInputFromArray<tstring>(TensorShape({2}), {jpeg, jpeg});
+  AddInputFromArray<int32>(TensorShape({0, 4}), {});
+  AddInputFromArray<int32>(TensorShape({2}), {8, 8});
+  TF_ASSERT_OK(RunOpKernel());
+
+  const Tensor& images = *GetOutput(0);
+  EXPECT_EQ(images.shape(), TensorShape({2, 8, 8, 3}));
+  const auto values = images.tensor<float, 4>();
+  for (int i = 0; i < 2; ++i) {
+    for (int y = 0; y < 8; ++y) {
+      for (int c = 0; c < 3; ++c) {
+        EXPECT_NEAR(values(i, y, 0, c), kDarkValue, kTolerance);
+        EXPECT_NEAR(values(i, y, 7, c), kBrightValue, kTolerance);
+      }
+    }
+  }
+}
+
+TEST_F(DecodeAndResizeJpegBatchOpTest, CropsBeforeResizing) {
+  MakeOp();
+  const tstring jpeg = TwoToneJpeg();
+  AddInputFromArray<tstring>(TensorShape({2}), {jpeg, jpeg});
+  AddInputFromArray<int32>(TensorShape({2, 4}),
+                           {0, 0, 64, 24, 8, 40, 48, 24});
+  AddInputFromArray<int32>(TensorShape({2}), {4, 4});
+  TF_ASSERT_OK(RunOpKernel());
+
+  const Tensor& images = *GetOutput(0);
+  EXPECT_EQ(images.shape(), TensorShape({2, 4, 4, 3}));
+  const auto values = images.tensor<float, 4>();
+  for (int y = 0; y < 4; ++y) {
+    for (int x = 0; x < 4; ++x) {
+      for (int c = 0; c < 3; ++c) {
+        EXPECT_NEAR(values(0, y, x, c), kDarkValue, kTolerance);
+        EXPECT_NEAR(values(1, y, x, c), kBrightValue, kTolerance);
+      }
+    }
+  }
+}
+
+TEST_F(DecodeAndResizeJpegBatchOpTest, FailsForInvalidCropWindow) {
+  MakeOp();
+  AddInputFromArray<tstring>(TensorShape({1}), {TwoToneJpeg()});
+  AddInputFromArray<int32>(TensorShape({1, 4}), {0, 48, 64, 32});
+  AddInputFromArray<int32>(TensorShape({2}), {4, 4});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+TEST_F(DecodeAndResizeJpegBatchOpTest, FailsForInvalidJpeg) {
+  MakeOp();
+  AddInputFromArray<tstring>(TensorShape({1}), {"not a jpeg"});
+  AddInputFromArray<int32>(TensorShape({0, 4}), {});
+  AddInputFromArray<int32>(TensorShape({2}), {4, 4});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -326,6 +326,33 @@ class TensorListReserve : public OpKernel {
     OP_REQUIRES_OK(c, c->GetAttr("element_dtype", &element_dtype_));
   }
 
+  // Gives `list` contiguous storage for its `num_elements` elements when
+  // their shape is known, so that filling the list with TensorListSetItem
+  // and stacking it does not concatenate the elements. The elements must be
+  // aligned rows of the buffer since kernels may map them as aligned Eigen
+  // tensors. Only host memory can be written in place by TensorListSetItem.
+  static Status MaybeAllocateBuffer(OpKernelContext* c, int32_t num_elements,
+                                    TensorList* list) {
+    TensorShape element_shape;
+    if (num_elements == 0 || c->device()->device_type() != DEVICE_CPU ||
+        !DataTypeCanUseMemcpy(list->element_dtype) ||
+        !list->element_shape.AsTensorShape(&element_shape)) {
+      return absl::OkStatus();
+    }
+    const int64_t row_bytes =
+        element_shape.num_elements() * DataTypeSize(list->element_dtype);
+    if (row_bytes == 0 || row_bytes % EIGEN_MAX_ALIGN_BYTES != 0) {
+      return absl::OkStatus();
+    }
+    TensorShape buffer_shape = element_shape;
+    TF_RETURN_IF_ERROR(buffer_shape.InsertDimWithStatus(0, num_elements));
+    Tensor buffer;
+    TF_RETURN_IF_ERROR(
+        c->allocate_temp(list->element_dtype, buffer_shape, &buffer));
+    list->SetBuffer(std::move(buffer));
+    return absl::OkStatus();
+  }
+
   void Compute(OpKernelContext* c) override {
     PartialTensorShape element_shape;
     OP_REQUIRES_OK(c, TensorShapeFromTensor(c->input(0), &element_shape));
@@ -343,6 +370,7 @@ class TensorListReserve : public OpKernel {
     output.element_shape = element_shape;
     output.element_dtype = element_dtype_;
     output.tensors().resize(num_elements, Tensor(DT_INVALID));
+    OP_REQUIRES_OK(c, MaybeAllocateBuffer(c, num_elements, &output));
     Tensor* result;
     AllocatorAttributes attr;
     attr.set_on_host(true);
@@ -480,6 +508,10 @@ class TensorListSetItem : public OpKernel {
     } else if (index >= l->tensors().size()) {
       output_list->tensors().resize(index + 1, Tensor(DT_INVALID));
     }
+    if (c->device()->device_type() == DEVICE_CPU &&
+        output_list->MaybeSetInBuffer(index, value)) {
+      return;
+    }
     output_list->tensors()[index] = value;
   }
 
@@ -219,6 +219,15 @@ class TensorListStack : public OpKernel {
                     partial_element_shape.DebugString()));
     TensorShape output_shape = element_shape;
     output_shape.InsertDim(0, tensor_list->tensors().size());
+    // The elements of a list filled in place are already stacked in its
+    // buffer, which was written for the last time when its last row was set.
+    const Tensor* stacked = c->device()->device_type() == DEVICE_CPU
+                                ? tensor_list->StackedBuffer()
+                                : nullptr;
+    if (stacked != nullptr && stacked->shape() == output_shape) {
+      c->set_output(0, *stacked);
+      return;
+    }
     Tensor* output;
     OP_REQUIRES_OK(c, c->allocate_output(0, output_shape, &output));
     if (output->NumElements() == 0) {
@@ -15,16 +15,30 @@ limitations under the License.
 
 // Tests kernels of lookup ops.
 
+#include <string>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/lookup_interface.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/shape_inference_testutil.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/lookup_table_op.h"
+#include "tensorflow/core/kernels/lookup_util.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 namespace {
@@ -100,5 +114,334 @@ TEST_F(LookupOpsTest, AnonymousHashTable_RefCounting) {
   EXPECT_FALSE(alive);
 }
 
+class LockFreeMutableHashTableTest : public OpsTestBase {
+ protected:
+  // Creates an AnonymousMutableHashTable that uses the lock-free kernel. The
+  // table is owned by the output of the kernel.
+  lookup::LookupInterface* CreateTable() {
+    TF_CHECK_OK(NodeDefBuilder("table", "AnonymousMutableHashTable")
+                    .Attr("key_dtype", DT_INT64)
+                    .Attr("value_dtype", DT_INT64)
+                    .Attr("_kernel", "lock_free")
+                    .Finalize(node_def()));
+    TF_CHECK_OK(InitOp());
+    TF_CHECK_OK(RunOpKernel());
+    auto table_or =
+        GetOutput(0)->scalar<ResourceHandle>()().GetResource<
+            lookup::LookupInterface>();
+    TF_CHECK_OK(table_or.status());
+    return table_or.value();
+  }
+
+  Tensor Find(lookup::LookupInterface* table, const Tensor& keys) {
+    Tensor values(DT_INT64, keys.shape());
+    TF_CHECK_OK(table->Find(context_.get(), keys, &values,
+                            test::AsScalar<int64_t>(-1)));
+    return values;
+  }
+};
+
+TEST_F(LockFreeMutableHashTableTest, InsertFindRemove) {
+  lookup::LookupInterface* table = CreateTable();
+  EXPECT_EQ(table->size(), 0);
+
+  // Enough keys to grow the table several times.
+  const int64_t kNumKeys = 1000;
+  Tensor keys(DT_INT64, TensorShape({kNumKeys}));
+  Tensor values(DT_INT64, TensorShape({kNumKeys}));
+  for (int64_t i = 0; i < kNumKeys; ++i) {
+    keys.flat<int64_t>()(i) = i * 7;
+    values.flat<int64_t>()(i) = i;
+  }
+  TF_ASSERT_OK(table->Insert(context_.get(), keys, values));
+  EXPECT_EQ(table->size(), kNumKeys);
+  test::ExpectTensorEqual<int64_t>(Find(table, keys), values);
+  test::ExpectTensorEqual<int64_t>(
+      Find(table, test::AsTensor<int64_t>({1, 7, 14, -7})),
+      test::AsTensor<int64_t>({-1, 1, 2, -1}));
+
+  // Updating an existing key does not change the size.
+  TF_ASSERT_OK(table->Insert(context_.get(), test::AsTensor<int64_t>({7}),
+                             test::AsTensor<int64_t>({100})));
+  EXPECT_EQ(table->size(), kNumKeys);
+
+  TF_ASSERT_OK(table->Remove(context_.get(),
+                             test::AsTensor<int64_t>({0, 14, 3})));
+  EXPECT_EQ(table->size(), kNumKeys - 2);
+  test::ExpectTensorEqual<int64_t>(
+      Find(table, test::AsTensor<int64_t>({0, 7, 14, 21})),
+      test::AsTensor<int64_t>({-1, 100, -1, 3}));
+
+  // Removed slots are reused.
+  TF_ASSERT_OK(table->Insert(context_.get(), test::AsTensor<int64_t>({14}),
+                             test::AsTensor<int64_t>({200})));
+  EXPECT_EQ(table->size(), kNumKeys - 1);
+  test::ExpectTensorEqual<int64_t>(Find(table, test::AsTensor<int64_t>({14})),
+                                   test::AsTensor<int64_t>({200}));
+}
+
+TEST_F(LockFreeMutableHashTableTest, ImportReplacesContents) {
+  lookup::LookupInterface* table = CreateTable();
+  TF_ASSERT_OK(table->Insert(context_.get(), test::AsTensor<int64_t>({1, 2}),
+                             test::AsTensor<int64_t>({10, 20})));
+  TF_ASSERT_OK(table->ImportValues(context_.get(),
+                                   test::AsTensor<int64_t>({2, 3, 3}),
+                                   test::AsTensor<int64_t>({21, 30, 31})));
+  EXPECT_EQ(table->size(), 2);
+  test::ExpectTensorEqual<int64_t>(
+      Find(table, test::AsTensor<int64_t>({1, 2, 3})),
+      test::AsTensor<int64_t>({-1, 21, 31}));
+}
+
+TEST_F(LockFreeMutableHashTableTest, ConcurrentFindDuringWrites) {
+  lookup::LookupInterface* table = CreateTable();
+  const int64_t kNumKeys = 4096;
+  Tensor keys(DT_INT64, TensorShape({kNumKeys}));
+  Tensor removed_keys(DT_INT64, TensorShape({kNumKeys / 2}));
+  for (int64_t i = 0; i < kNumKeys; ++i) keys.flat<int64_t>()(i) = i;
+  for (int64_t i = 0; i < kNumKeys / 2; ++i) {
+    removed_keys.flat<int64_t>()(i) = 2 * i + 1;
+  }
+
+  // Every key is only ever mapped to its own negation, so readers must
+  // observe either that value or the default, while the writer grows the
+  // table and churns tombstones.
+  std::atomic<bool> done{false};
+  {
+    thread::ThreadPool pool(Env::Default(), "readers", 4);
+    for (int t = 0; t < 4; ++t) {
+      pool.Schedule([&] {
+        while (!done.load()) {
+          Tensor values = Find(table, keys);
+          for (int64_t i = 0; i < kNumKeys; ++i) {
+            const int64_t value = values.flat<int64_t>()(i);
+            ASSERT_TRUE(value == -1 || value == -i) << i << " " << value;
+          }
+        }
+      });
+    }
+    for (int round = 0; round < 20; ++round) {
+      for (int64_t begin = 0; begin < kNumKeys; begin += 256) {
+        Tensor batch_keys = keys.Slice(begin, begin + 256);
+        Tensor batch_values(DT_INT64, TensorShape({256}));
+        for (int64_t i = 0; i < 256; ++i) {
+          batch_values.flat<int64_t>()(i) = -(begin + i);
+        }
+        TF_ASSERT_OK(table->Insert(context_.get(), batch_keys, batch_values));
+      }
+      if (round % 2 == 0) {
+        TF_ASSERT_OK(table->Remove(context_.get(), removed_keys));
+      }
+    }
+    done = true;
+  }
+  EXPECT_EQ(table->size(), kNumKeys);
+}
+
+class MutableDenseHashTableTest : public OpsTestBase {
+ protected:
+  // Creates an AnonymousMutableDenseHashTable with int64 keys of shape
+  // `key_shape` and int64 scalar values. Keys filled with -1 and -2 are the
+  // empty and deleted keys. The table is owned by the output of the kernel.
+  lookup::LookupInterface* CreateTable(const TensorShape& key_shape) {
+    TF_CHECK_OK(NodeDefBuilder("table", "AnonymousMutableDenseHashTable")
+                    .Input(FakeInput(DT_INT64))
+                    .Input(FakeInput(DT_INT64))
+                    .Attr("key_dtype", DT_INT64)
+                    .Attr("value_dtype", DT_INT64)
+                    .Attr("initial_num_buckets", 16)
+                    .Finalize(node_def()));
+    TF_CHECK_OK(InitOp());
+    std::vector<int64_t> empty_key(key_shape.num_elements(), -1);
+    std::vector<int64_t> deleted_key(key_shape.num_elements(), -2);
+    AddInputFromArray<int64_t>(key_shape, empty_key);
+    AddInputFromArray<int64_t>(key_shape, deleted_key);
+    TF_CHECK_OK(RunOpKernel());
+    auto table_or =
+        GetOutput(0)->scalar<ResourceHandle>()().GetResource<
+            lookup::LookupInterface>();
+    TF_CHECK_OK(table_or.status());
+    return table_or.value();
+  }
+};
+
+TEST_F(MutableDenseHashTableTest, FindAcrossBatches) {
+  lookup::LookupInterface* table = CreateTable(TensorShape({}));
+  // Not a multiple of the lookup batch size, and enough keys to rebucket.
+  const int64_t kNumKeys = 1001;
+  Tensor keys(DT_INT64, TensorShape({kNumKeys}));
+  Tensor values(DT_INT64, TensorShape({kNumKeys}));
+  Tensor expected(DT_INT64, TensorShape({2 * kNumKeys}));
+  Tensor lookup_keys(DT_INT64, TensorShape({2 * kNumKeys}));
+  for (int64_t i = 0; i < kNumKeys; ++i) {
+    keys.flat<int64_t>()(i) = 2 * i;
+    values.flat<int64_t>()(i) = 3 * i;
+  }
+  for (int64_t i = 0; i < 2 * kNumKeys; ++i) {
+    lookup_keys.flat<int64_t>()(i) = i;
+    expected.flat<int64_t>()(i) = (i % 2 == 0) ? 3 * (i / 2) : 7;
+  }
+  TF_ASSERT_OK(table->Insert(context_.get(), keys, values));
+
+  Tensor found(DT_INT64, TensorShape({2 * kNumKeys}));
+  TF_ASSERT_OK(table->Find(context_.get(), lookup_keys, &found,
+                           test::AsScalar<int64_t>(7)));
+  test::ExpectTensorEqual<int64_t>(found, expected);
+}
+
+TEST_F(MutableDenseHashTableTest, FindVectorKeys) {
+  lookup::LookupInterface* table = CreateTable(TensorShape({2}));
+  TF_ASSERT_OK(table->Insert(
+      context_.get(),
+      test::AsTensor<int64_t>({1, 2, 3, 4, 5, 6}, TensorShape({3, 2})),
+      test::AsTensor<int64_t>({10, 20, 30})));
+
+  Tensor found(DT_INT64, TensorShape({3}));
+  TF_ASSERT_OK(table->Find(
+      context_.get(),
+      test::AsTensor<int64_t>({3, 4, 4, 3, 1, 2}, TensorShape({3, 2})),
+      &found, test::AsScalar<int64_t>(0)));
+  test::ExpectTensorEqual<int64_t>(found, test::AsTensor<int64_t>({20, 0, 10}));
+}
+
+TEST_F(MutableDenseHashTableTest, FindRejectsReservedKeys) {
+  lookup::LookupInterface* table = CreateTable(TensorShape({}));
+  // The reserved keys are detected in any position of a lookup batch.
+  for (int64_t reserved_key : {-1, -2}) {
+    Tensor lookup_keys(DT_INT64, TensorShape({40}));
+    for (int64_t i = 0; i < 40; ++i) lookup_keys.flat<int64_t>()(i) = i;
+    lookup_keys.flat<int64_t>()(21) = reserved_key;
+    Tensor found(DT_INT64, TensorShape({40}));
+    EXPECT_TRUE(errors::IsInvalidArgument(table->Find(
+        context_.get(), lookup_keys, &found, test::AsScalar<int64_t>(0))));
+  }
+}
+
+TEST_F(MutableDenseHashTableTest, ExportAndImportDoNotCopyTheBuckets) {
+  lookup::LookupInterface* table = CreateTable(TensorShape({}));
+  Tensor keys = test::AsTensor<int64_t>({-1, 5, -1, -1, 7, -1, -1, -2},
+                                        TensorShape({8, 1}));
+  Tensor values = test::AsTensor<int64_t>({0, 50, 0, 0, 70, 0, 0, 0},
+                                          TensorShape({8, 1}));
+  TF_ASSERT_OK(table->ImportValues(context_.get(), keys, values));
+  EXPECT_EQ(table->size(), 2);
+
+  // The resource manager takes a reference to the table.
+  table->Ref();
+  inputs_.clear();
+  TF_ASSERT_OK(NodeDefBuilder("export", "LookupTableExportV2")
+                   .Input(FakeInput(DT_RESOURCE))
+                   .Attr("Tkeys", DT_INT64)
+                   .Attr("Tvalues", DT_INT64)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  AddResourceInput<lookup::LookupInterface>("", "table", table);
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_TRUE(GetOutput(0)->SharesBufferWith(keys));
+  EXPECT_TRUE(GetOutput(1)->SharesBufferWith(values));
+}
+
+// Runs MutableDenseHashTable::Find outside of a test fixture.
+class MutableDenseHashTableBenchmark : public MutableDenseHashTableTest {
+ public:
+  void TestBody() override {}
+
+  void Run(::testing::benchmark::State& state) {
+    const int64_t num_keys = state.range(0);
+    const int64_t batch_size = state.range(1);
+    lookup::LookupInterface* table = CreateTable(TensorShape({}));
+    Tensor keys(DT_INT64, TensorShape({num_keys}));
+    Tensor values(DT_INT64, TensorShape({num_keys}));
+    for (int64_t i = 0; i < num_keys; ++i) {
+      keys.flat<int64_t>()(i) = i * 7919;
+      values.flat<int64_t>()(i) = i;
+    }
+    TF_CHECK_OK(table->Insert(context_.get(), keys, values));
+
+    random::PhiloxRandom philox(301, 17);
+    random::SimplePhilox rnd(&philox);
+    Tensor lookup_keys(DT_INT64, TensorShape({batch_size}));
+    for (int64_t i = 0; i < batch_size; ++i) {
+      lookup_keys.flat<int64_t>()(i) = rnd.Uniform64(num_keys) * 7919;
+    }
+    Tensor found(DT_INT64, TensorShape({batch_size}));
+    const Tensor default_value = test::AsScalar<int64_t>(-1);
+    for (auto s : state) {
+      TF_CHECK_OK(
+          table->Find(context_.get(), lookup_keys, &found, default_value));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                            batch_size);
+  }
+};
+
+void BM_MutableDenseHashTableFind(::testing::benchmark::State& state) {
+  MutableDenseHashTableBenchmark benchmark;
+  benchmark.Run(state);
+}
+
+BENCHMARK(BM_MutableDenseHashTableFind)
+    ->UseRealTime()
+    ->ArgPair(1 << 10, 1024)
+    ->ArgPair(1 << 20, 1024)
+    ->ArgPair(1 << 20, 4096);
+
+// Writes `lines` to a new vocabulary file and returns its name.
+string WriteVocabFile(const string& name, const std::vector<string>& lines) {
+  const string filename = io::JoinPath(testing::TmpDir(), name);
+  TF_CHECK_OK(WriteStringToFile(
+      Env::Default(), filename,
+      absl::StrCat(absl::StrJoin(lines, "\n"), "\n")));
+  return filename;
+}
+
+TEST(InitializeTableFromTextFileTest, ParsesBatchesInParallel) {
+  // More lines than fit in a batch of the iterator.
+  constexpr int kNumLines = 150000;
+  std::vector<string> lines;
+  for (int i = 0; i < kNumLines; ++i) lines.push_back(absl::StrCat("word", i));
+  const string filename = WriteVocabFile("parallel_vocab.txt", lines);
+
+  thread::ThreadPool thread_pool(Env::Default(), "vocab", 4);
+  auto* table = new lookup::HashTable<tstring, int64_t>(nullptr, nullptr);
+  core::ScopedUnref unref(table);
+  TF_ASSERT_OK(lookup::InitializeTableFromTextFile(
+      filename, /*vocab_size=*/-1, /*delimiter=*/'\t', /*key_index=*/-2,
+      /*value_index=*/-1, /*offset=*/0, Env::Default(), &thread_pool,
+      /*serializer=*/nullptr, table));
+  EXPECT_EQ(table->size(), static_cast<size_t>(kNumLines));
+
+  Tensor keys = test::AsTensor<tstring>(
+      {"word0", "word65535", "word65536", "word149999", "missing"});
+  Tensor values(DT_INT64, keys.shape());
+  TF_ASSERT_OK(
+      table->Find(nullptr, keys, &values, test::AsScalar<int64_t>(-1)));
+  test::ExpectTensorEqual<int64_t>(
+      values, test::AsTensor<int64_t>({0, 65535, 65536, 149999, -1}));
+}
+
+TEST(InitializeTableFromTextFileTest, ReportsTheFirstBadLine) {
+  constexpr int kNumLines = 100000;
+  std::vector<string> lines;
+  for (int i = 0; i < kNumLines; ++i) {
+    lines.push_back(absl::StrCat("w", i, "\t", i));
+  }
+  // The error is the one of the first bad line, whatever block of the batch
+  // is parsed first.
+  lines[70001] = "w70001\tx";
+  lines[90000] = "w90000\ty";
+  const string filename = WriteVocabFile("bad_vocab.txt", lines);
+
+  thread::ThreadPool thread_pool(Env::Default(), "vocab", 4);
+  auto* table = new lookup::HashTable<tstring, int64_t>(nullptr, nullptr);
+  core::ScopedUnref unref(table);
+  Status s = lookup::InitializeTableFromTextFile(
+      filename, /*vocab_size=*/-1, /*delimiter=*/'\t', /*key_index=*/0,
+      /*value_index=*/1, /*offset=*/0, Env::Default(), &thread_pool,
+      /*serializer=*/nullptr, table);
+  EXPECT_TRUE(absl::IsInvalidArgument(s));
+  EXPECT_TRUE(absl::StrContains(s.message(), "in line 70001 ")) << s;
+}
+
 }  // namespace
 }  // namespace tensorflow
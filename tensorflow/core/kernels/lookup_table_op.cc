@@ -16,7 +16,12 @@ limitations under the License.
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <type_traits>
 #include <utility>
 
@@ -26,7 +31,9 @@ limitations under the License.
 #include "tensorflow/core/kernels/initializable_lookup_table.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace lookup {
@@ -520,43 +527,82 @@ class MutableDenseHashTable final : public LookupInterface {
     const auto deleted_key_matrix =
         deleted_key_.template shaped<K, 2>({1, key_size});
     const int64_t bit_mask = num_buckets_ - 1;
+    // Keys are looked up in batches. Hashing and the checks against the
+    // empty and deleted keys run over the whole batch in loops without
+    // cross-iteration dependencies, which the compiler vectorizes for scalar
+    // keys, and the home bucket of every key in the batch is prefetched
+    // before the first one is probed.
     // TODO(andreasst): parallelize using work_sharder
-    for (int64_t i = 0; i < num_elements; ++i) {
-      const uint64 key_hash = HashKey(key_matrix, i);
-      if (empty_key_hash_ == key_hash &&
-          IsEqualKey(empty_key_matrix, 0, key_matrix, i)) {
-        return errors::InvalidArgument(
-            "Using the empty_key as a table key is not allowed");
+    uint64 key_hashes[kFindBatchSize];
+    for (int64_t batch_begin = 0; batch_begin < num_elements;
+         batch_begin += kFindBatchSize) {
+      const int64_t batch_size =
+          std::min<int64_t>(kFindBatchSize, num_elements - batch_begin);
+      if (key_size == 1) {
+        const K* batch_keys = key_matrix.data() + batch_begin;
+        for (int64_t j = 0; j < batch_size; ++j) {
+          key_hashes[j] = HashScalar(batch_keys[j]);
+        }
+      } else {
+        for (int64_t j = 0; j < batch_size; ++j) {
+          key_hashes[j] = HashKey(key_matrix, batch_begin + j);
+        }
       }
-      if (deleted_key_hash_ == key_hash &&
-          IsEqualKey(deleted_key_matrix, 0, key_matrix, i)) {
-        return errors::InvalidArgument(
-            "Using the deleted_key as a table key is not allowed");
+      bool has_reserved_hash = false;
+      for (int64_t j = 0; j < batch_size; ++j) {
+        has_reserved_hash |= (key_hashes[j] == empty_key_hash_) |
+                             (key_hashes[j] == deleted_key_hash_);
       }
-      int64_t bucket_index = key_hash & bit_mask;
-      int64_t num_probes = 0;
-      while (true) {
-        if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
-          for (int64_t j = 0; j < value_size; ++j) {
-            // TODO(andreasst): check if we can get rid of SubtleMustCopy
-            // here and elsewhere in this file.
-            value_matrix(i, j) =
-                SubtleMustCopyIfIntegral(value_buckets_matrix(bucket_index, j));
+      if (TF_PREDICT_FALSE(has_reserved_hash)) {
+        for (int64_t j = 0; j < batch_size; ++j) {
+          const int64_t i = batch_begin + j;
+          if (empty_key_hash_ == key_hashes[j] &&
+              IsEqualKey(empty_key_matrix, 0, key_matrix, i)) {
+            return errors::InvalidArgument(
+                "Using the empty_key as a table key is not allowed");
           }
-          break;
-        }
-        if (IsEqualKey(key_buckets_matrix, bucket_index, empty_key_matrix, 0)) {
-          for (int64_t j = 0; j < value_size; ++j) {
-            value_matrix(i, j) = SubtleMustCopyIfIntegral(default_flat(j));
+          if (deleted_key_hash_ == key_hashes[j] &&
+              IsEqualKey(deleted_key_matrix, 0, key_matrix, i)) {
+            return errors::InvalidArgument(
+                "Using the deleted_key as a table key is not allowed");
           }
-          break;
         }
-        ++num_probes;
-        bucket_index =
-            (bucket_index + num_probes) & bit_mask;  // quadratic probing
-        if (num_probes >= num_buckets_) {
-          return errors::Internal(
-              "Internal error in MutableDenseHashTable lookup");
+      }
+      for (int64_t j = 0; j < batch_size; ++j) {
+        const int64_t bucket_index = key_hashes[j] & bit_mask;
+        port::prefetch<port::PREFETCH_HINT_T0>(
+            key_buckets_matrix.data() + bucket_index * key_size);
+        port::prefetch<port::PREFETCH_HINT_T0>(
+            value_buckets_matrix.data() + bucket_index * value_size);
+      }
+      for (int64_t j = 0; j < batch_size; ++j) {
+        const int64_t i = batch_begin + j;
+        int64_t bucket_index = key_hashes[j] & bit_mask;
+        int64_t num_probes = 0;
+        while (true) {
+          if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
+            for (int64_t k = 0; k < value_size; ++k) {
+              // TODO(andreasst): check if we can get rid of SubtleMustCopy
+              // here and elsewhere in this file.
+              value_matrix(i, k) = SubtleMustCopyIfIntegral(
+                  value_buckets_matrix(bucket_index, k));
+            }
+            break;
+          }
+          if (IsEqualKey(key_buckets_matrix, bucket_index, empty_key_matrix,
+                         0)) {
+            for (int64_t k = 0; k < value_size; ++k) {
+              value_matrix(i, k) = SubtleMustCopyIfIntegral(default_flat(k));
+            }
+            break;
+          }
+          ++num_probes;
+          bucket_index =
+              (bucket_index + num_probes) & bit_mask;  // quadratic probing
+          if (num_probes >= num_buckets_) {
+            return errors::Internal(
+                "Internal error in MutableDenseHashTable lookup");
+          }
         }
       }
     }
@@ -602,6 +648,9 @@ class MutableDenseHashTable final : public LookupInterface {
     return DoRemove(ctx, key);
   }
 
+  // The buckets are imported and exported without copies: the table adopts
+  // the restored tensors and exports its own, so that restoring or saving a
+  // large table does not need memory for a second copy of it.
   Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
                       const Tensor& values) override TF_LOCKS_EXCLUDED(mu_) {
     mutex_lock l(mu_);
@@ -864,6 +913,9 @@ class MutableDenseHashTable final : public LookupInterface {
     return true;
   }
 
+  // Number of keys that Find hashes and prefetches ahead of probing.
+  static constexpr int64_t kFindBatchSize = 16;
+
   TensorShape key_shape_;
   TensorShape value_shape_;
   float max_load_factor_;
@@ -878,6 +930,431 @@ class MutableDenseHashTable final : public LookupInterface {
   uint64 deleted_key_hash_;
 };
 
+// Lookup table of scalar keys and values for read-mostly workloads, e.g.
+// feature-id tables that are read by many concurrent inference threads while
+// being updated in the background. It is selected by setting the `_kernel`
+// attr of a MutableHashTableV2 or AnonymousMutableHashTable node to
+// "lock_free", and otherwise behaves like MutableHashTableOfScalars.
+//
+// The table uses open addressing with linear probing. Every slot is guarded by
+// a sequence lock, so Find never takes a lock: it re-reads a slot whose
+// sequence number changed while it was being read. Insert, Remove and
+// ImportValues are serialized by `mu_`. Growing the table publishes a new slot
+// array, and the old array is freed once every reader that could have
+// observed it has finished (see `ReaderScope`).
+//
+// Find hashes and prefetches the home slots of a small batch of keys before
+// probing any of them, and shards large key tensors over the intra-op
+// threads.
+template <class K, class V>
+class LockFreeMutableHashTableOfScalars final : public LookupInterface {
+ public:
+  LockFreeMutableHashTableOfScalars(OpKernelContext* ctx, OpKernel* kernel)
+      : slots_(new SlotArray(kMinCapacity)) {}
+
+  ~LockFreeMutableHashTableOfScalars() override { delete slots_.load(); }
+
+  size_t size() const override {
+    return num_entries_.load(std::memory_order_relaxed);
+  }
+
+  Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
+              const Tensor& default_value) override {
+    const auto key_values = key.flat<K>();
+    auto value_values = value->flat<V>();
+    const auto default_flat = default_value.flat<V>();
+    const bool is_full_size_default =
+        (value_values.size() == default_flat.size());
+
+    auto find_range = [&](int64_t begin, int64_t end) {
+      ReaderScope reader(this);
+      const SlotArray& slots = reader.slots();
+      K keys[kFindBatchSize];
+      uint64 hashes[kFindBatchSize];
+      for (int64_t batch = begin; batch < end; batch += kFindBatchSize) {
+        const int64_t n = std::min<int64_t>(kFindBatchSize, end - batch);
+        for (int64_t j = 0; j < n; ++j) {
+          keys[j] = SubtleMustCopyIfIntegral(key_values(batch + j));
+          hashes[j] = HashKey(keys[j]);
+          port::prefetch<port::PREFETCH_HINT_T0>(
+              &slots.slots[hashes[j] & slots.mask]);
+        }
+        for (int64_t j = 0; j < n; ++j) {
+          const int64_t i = batch + j;
+          if (!FindInSlots(slots, keys[j], hashes[j], &value_values(i))) {
+            value_values(i) =
+                is_full_size_default ? default_flat(i) : default_flat(0);
+          }
+        }
+      }
+    };
+    if (ctx != nullptr && ctx->device() != nullptr) {
+      auto* worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+      Shard(worker_threads->num_threads, worker_threads->workers,
+            key_values.size(), kFindCostPerKey, find_range);
+    } else {
+      find_range(0, key_values.size());
+    }
+    return absl::OkStatus();
+  }
+
+  Status Insert(OpKernelContext* ctx, const Tensor& keys,
+                const Tensor& values) override {
+    const auto key_values = keys.flat<K>();
+    const auto value_values = values.flat<V>();
+
+    mutex_lock l(mu_);
+    for (int64_t i = 0; i < key_values.size(); ++i) {
+      InsertLocked(SubtleMustCopyIfIntegral(key_values(i)),
+                   SubtleMustCopyIfIntegral(value_values(i)));
+    }
+    return absl::OkStatus();
+  }
+
+  Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
+    const auto key_values = keys.flat<K>();
+
+    mutex_lock l(mu_);
+    SlotArray* slots = slots_.load(std::memory_order_relaxed);
+    for (int64_t i = 0; i < key_values.size(); ++i) {
+      const K key = SubtleMustCopyIfIntegral(key_values(i));
+      const int64_t index = FindIndex(*slots, key);
+      if (index >= 0) {
+        WriteSlot(&slots->slots[index], kDeleted, key, V());
+        num_entries_.fetch_sub(1, std::memory_order_relaxed);
+        ++num_deleted_;
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
+                      const Tensor& values) override {
+    const auto key_values = keys.flat<K>();
+    const auto value_values = values.flat<V>();
+
+    // Readers keep seeing the previous contents until the imported slot array
+    // is complete.
+    SlotArray* new_slots = new SlotArray(CapacityFor(key_values.size()));
+    int64_t num_entries = 0;
+    for (int64_t i = 0; i < key_values.size(); ++i) {
+      const K key = SubtleMustCopyIfIntegral(key_values(i));
+      const V value = SubtleMustCopyIfIntegral(value_values(i));
+      const int64_t index = FindIndex(*new_slots, key);
+      if (index >= 0) {
+        WriteSlot(&new_slots->slots[index], kOccupied, key, value);
+      } else {
+        InsertNew(new_slots, key, value);
+        ++num_entries;
+      }
+    }
+
+    mutex_lock l(mu_);
+    ReplaceSlotsLocked(new_slots);
+    num_entries_.store(num_entries, std::memory_order_relaxed);
+    num_deleted_ = 0;
+    return absl::OkStatus();
+  }
+
+  Status ExportValues(OpKernelContext* ctx) override {
+    mutex_lock l(mu_);
+    int64_t size = num_entries_.load(std::memory_order_relaxed);
+
+    Tensor* keys;
+    Tensor* values;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output("keys", TensorShape({size}), &keys));
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output("values", TensorShape({size}), &values));
+    ExportKeysAndValues(keys, values);
+    return absl::OkStatus();
+  }
+
+  DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
+
+  DataType value_dtype() const override { return DataTypeToEnum<V>::v(); }
+
+  TensorShape key_shape() const final { return TensorShape(); }
+
+  TensorShape value_shape() const override { return TensorShape(); }
+
+  int64_t MemoryUsed() const override {
+    mutex_lock l(mu_);
+    return sizeof(LockFreeMutableHashTableOfScalars) +
+           slots_.load(std::memory_order_relaxed)->capacity() * sizeof(Slot);
+  }
+
+  Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
+    mutex_lock l(mu_);
+    int64_t size = num_entries_.load(std::memory_order_relaxed);
+    Tensor keys(key_dtype(), TensorShape({size}));
+    Tensor values(value_dtype(), TensorShape({size}));
+    ExportKeysAndValues(&keys, &values);
+
+    // See MutableHashTableOfScalars::AsGraphDef for the use of
+    // use_node_name_sharing. The `_kernel` attr selects this implementation
+    // again when the graph is loaded.
+    Node* table = ops::SourceOp(
+        "MutableHashTableV2",
+        builder->opts()
+            .WithName(UniqueNodeName("MutableHashTableFromGraphDef"))
+            .WithAttr("use_node_name_sharing", true)
+            .WithAttr("key_dtype", key_dtype())
+            .WithAttr("value_dtype", value_dtype())
+            .WithAttr("_kernel", "lock_free"));
+    Node* keys_node = ops::SourceOp(
+        "Const",
+        builder->opts().WithAttr("dtype", key_dtype()).WithAttr("value", keys));
+    Node* values_node =
+        ops::SourceOp("Const", builder->opts()
+                                   .WithAttr("dtype", value_dtype())
+                                   .WithAttr("value", values));
+    Node* import_table =
+        ops::TernaryOp("LookupTableImportV2", table, keys_node, values_node,
+                       builder->opts()
+                           .WithAttr("Tin", key_dtype())
+                           .WithAttr("Tout", value_dtype()));
+    *out = ops::UnaryOp("Identity", table,
+                        builder->opts().WithControlInput(import_table));
+    return absl::OkStatus();
+  }
+
+ private:
+  static_assert(std::is_arithmetic<K>::value && std::is_arithmetic<V>::value,
+                "LockFreeMutableHashTableOfScalars requires scalar keys and "
+                "values that fit in a std::atomic");
+
+  enum SlotState : uint32 { kEmpty = 0, kOccupied = 1, kDeleted = 2 };
+
+  // `seq` is odd while a writer is updating the slot.
+  struct Slot {
+    std::atomic<uint32> seq{0};
+    std::atomic<uint32> state{kEmpty};
+    std::atomic<K> key{K()};
+    std::atomic<V> value{V()};
+  };
+
+  struct SlotArray {
+    explicit SlotArray(int64_t capacity)
+        : mask(capacity - 1), slots(new Slot[capacity]) {}
+    int64_t capacity() const { return mask + 1; }
+
+    const int64_t mask;
+    std::unique_ptr<Slot[]> slots;
+  };
+
+  // Pins the current slot array for the lifetime of the scope.
+  //
+  // A reader registers itself in the counter of the current epoch's parity
+  // and re-checks the epoch. A writer that replaces the slot array advances
+  // the epoch and then waits for the counter of the previous parity to drain,
+  // so every reader that may still hold the old array has finished before it
+  // is freed.
+  class ReaderScope {
+   public:
+    explicit ReaderScope(const LockFreeMutableHashTableOfScalars* table)
+        : table_(table) {
+      while (true) {
+        epoch_ = table_->epoch_.load();
+        table_->readers_[epoch_ & 1].fetch_add(1);
+        if (table_->epoch_.load() == epoch_) break;
+        table_->readers_[epoch_ & 1].fetch_sub(1);
+      }
+      slots_ = table_->slots_.load();
+    }
+    ~ReaderScope() { table_->readers_[epoch_ & 1].fetch_sub(1); }
+
+    ReaderScope(const ReaderScope&) = delete;
+    void operator=(const ReaderScope&) = delete;
+
+    const SlotArray& slots() const { return *slots_; }
+
+   private:
+    const LockFreeMutableHashTableOfScalars* const table_;
+    uint64 epoch_;
+    const SlotArray* slots_;
+  };
+
+  static constexpr int64_t kMinCapacity = 16;
+  static constexpr float kMaxLoadFactor = 0.7f;
+  static constexpr int kFindBatchSize = 16;
+  static constexpr int64_t kFindCostPerKey = 50;
+
+  // Mixes the key bits, so that keys with regular strides (e.g. sequential
+  // feature ids) do not form long probe chains.
+  static uint64 HashKey(K key) {
+    uint64 h = 0;
+    std::memcpy(&h, &key, sizeof(K));
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+  }
+
+  // Returns the smallest power-of-two capacity that keeps `num_entries`
+  // entries at no more than half of the maximum load factor.
+  static int64_t CapacityFor(int64_t num_entries) {
+    int64_t capacity = kMinCapacity;
+    while (num_entries > capacity * kMaxLoadFactor / 2) capacity *= 2;
+    return capacity;
+  }
+
+  // Reads a consistent snapshot of `slot` into `*key` and `*value`, and
+  // returns its state.
+  static uint32 ReadSlot(const Slot& slot, K* key, V* value) {
+    while (true) {
+      const uint32 seq = slot.seq.load(std::memory_order_acquire);
+      if (seq & 1) continue;
+      const uint32 state = slot.state.load(std::memory_order_relaxed);
+      *key = slot.key.load(std::memory_order_relaxed);
+      *value = slot.value.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.seq.load(std::memory_order_relaxed) == seq) return state;
+    }
+  }
+
+  // Must only be called by the writer holding `mu_`, or on a slot array that
+  // is not yet visible to readers.
+  static void WriteSlot(Slot* slot, uint32 state, K key, V value) {
+    const uint32 seq = slot->seq.load(std::memory_order_relaxed);
+    slot->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot->state.store(state, std::memory_order_relaxed);
+    slot->key.store(key, std::memory_order_relaxed);
+    slot->value.store(value, std::memory_order_relaxed);
+    slot->seq.store(seq + 2, std::memory_order_release);
+  }
+
+  static bool FindInSlots(const SlotArray& slots, K key, uint64 hash,
+                          V* value) {
+    int64_t index = hash & slots.mask;
+    for (int64_t num_probes = 0; num_probes <= slots.mask; ++num_probes) {
+      K slot_key;
+      V slot_value;
+      const uint32 state = ReadSlot(slots.slots[index], &slot_key, &slot_value);
+      if (state == kEmpty) return false;
+      if (state == kOccupied && slot_key == key) {
+        *value = slot_value;
+        return true;
+      }
+      index = (index + 1) & slots.mask;
+    }
+    return false;
+  }
+
+  // Returns the index of the slot holding `key`, or -1. Only writers modify
+  // the slots, so this may read them directly, but must only be called by
+  // the writer holding `mu_` or on a slot array that is not yet visible.
+  static int64_t FindIndex(const SlotArray& slots, K key) {
+    int64_t index = HashKey(key) & slots.mask;
+    for (int64_t num_probes = 0; num_probes <= slots.mask; ++num_probes) {
+      const Slot& slot = slots.slots[index];
+      const uint32 state = slot.state.load(std::memory_order_relaxed);
+      if (state == kEmpty) return -1;
+      if (state == kOccupied &&
+          slot.key.load(std::memory_order_relaxed) == key) {
+        return index;
+      }
+      index = (index + 1) & slots.mask;
+    }
+    return -1;
+  }
+
+  // Stores `key`, which must not be present, in the first empty slot of its
+  // probe chain in `slots`, which must not be visible to readers yet and must
+  // not contain tombstones.
+  static void InsertNew(SlotArray* slots, K key, V value) {
+    int64_t index = HashKey(key) & slots->mask;
+    while (slots->slots[index].state.load(std::memory_order_relaxed) !=
+           kEmpty) {
+      index = (index + 1) & slots->mask;
+    }
+    WriteSlot(&slots->slots[index], kOccupied, key, value);
+  }
+
+  void InsertLocked(K key, V value) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    SlotArray* slots = slots_.load(std::memory_order_relaxed);
+    // Every probe chain must end in an empty slot, so tombstones count
+    // towards the load factor. Rehash before the new entry could exceed it.
+    const int64_t num_entries = num_entries_.load(std::memory_order_relaxed);
+    if (num_entries + num_deleted_ + 1 > slots->capacity() * kMaxLoadFactor) {
+      SlotArray* new_slots = new SlotArray(CapacityFor(num_entries + 1));
+      for (int64_t i = 0; i < slots->capacity(); ++i) {
+        const Slot& slot = slots->slots[i];
+        if (slot.state.load(std::memory_order_relaxed) != kOccupied) continue;
+        InsertNew(new_slots, slot.key.load(std::memory_order_relaxed),
+                  slot.value.load(std::memory_order_relaxed));
+      }
+      num_deleted_ = 0;
+      ReplaceSlotsLocked(new_slots);
+      slots = new_slots;
+    }
+
+    int64_t free_index = -1;
+    int64_t index = HashKey(key) & slots->mask;
+    while (true) {
+      Slot& slot = slots->slots[index];
+      const uint32 state = slot.state.load(std::memory_order_relaxed);
+      if (state == kOccupied) {
+        if (slot.key.load(std::memory_order_relaxed) == key) {
+          WriteSlot(&slot, kOccupied, key, value);
+          return;
+        }
+      } else if (free_index < 0) {
+        free_index = index;
+      }
+      if (state == kEmpty) break;
+      index = (index + 1) & slots->mask;
+    }
+    Slot* slot = &slots->slots[free_index];
+    if (slot->state.load(std::memory_order_relaxed) == kDeleted) {
+      --num_deleted_;
+    }
+    WriteSlot(slot, kOccupied, key, value);
+    num_entries_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Publishes `new_slots` and frees the previous slot array once no reader
+  // can observe it any more.
+  void ReplaceSlotsLocked(SlotArray* new_slots)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    SlotArray* old_slots = slots_.exchange(new_slots);
+    const uint64 old_epoch = epoch_.fetch_add(1);
+    while (readers_[old_epoch & 1].load() != 0) {
+      std::this_thread::yield();
+    }
+    delete old_slots;
+  }
+
+  // Writes all keys and values into `keys` and `values`. `keys` and `values`
+  // must point to tensors of size `size()`.
+  void ExportKeysAndValues(Tensor* keys, Tensor* values) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    auto keys_data = keys->flat<K>();
+    auto values_data = values->flat<V>();
+    const SlotArray* slots = slots_.load(std::memory_order_relaxed);
+    int64_t i = 0;
+    for (int64_t index = 0; index < slots->capacity(); ++index) {
+      const Slot& slot = slots->slots[index];
+      if (slot.state.load(std::memory_order_relaxed) != kOccupied) continue;
+      keys_data(i) = slot.key.load(std::memory_order_relaxed);
+      values_data(i) = slot.value.load(std::memory_order_relaxed);
+      ++i;
+    }
+  }
+
+  mutable mutex mu_;
+  // Written only while holding `mu_`; read without it by Find.
+  std::atomic<SlotArray*> slots_;
+  std::atomic<int64_t> num_entries_{0};
+  int64_t num_deleted_ TF_GUARDED_BY(mu_) = 0;
+  // See ReaderScope.
+  mutable std::atomic<uint64> epoch_{0};
+  mutable std::atomic<int64_t> readers_[2] = {{0}, {0}};
+};
+
 }  // namespace lookup
 
 // Base class for kernels that take a LookupTable handle as the 0th input.
@@ -1160,6 +1637,48 @@ REGISTER_KERNEL(tstring, int64_t);
 
 #undef REGISTER_KERNEL
 
+// Register the lock-free MutableHashTable op, selected with
+// `_kernel = "lock_free"`.
+#define REGISTER_KERNEL(key_dtype, value_dtype)                                \
+  REGISTER_KERNEL_BUILDER(                                                     \
+      Name("MutableHashTable")                                                 \
+          .Device(DEVICE_CPU)                                                  \
+          .TypeConstraint<key_dtype>("key_dtype")                              \
+          .TypeConstraint<value_dtype>("value_dtype")                          \
+          .Label("lock_free"),                                                 \
+      LookupTableOp<                                                           \
+          lookup::LockFreeMutableHashTableOfScalars<key_dtype, value_dtype>,   \
+          key_dtype, value_dtype>)                                             \
+  REGISTER_KERNEL_BUILDER(                                                     \
+      Name("MutableHashTableV2")                                               \
+          .Device(DEVICE_CPU)                                                  \
+          .TypeConstraint<key_dtype>("key_dtype")                              \
+          .TypeConstraint<value_dtype>("value_dtype")                          \
+          .Label("lock_free"),                                                 \
+      LookupTableOp<                                                           \
+          lookup::LockFreeMutableHashTableOfScalars<key_dtype, value_dtype>,   \
+          key_dtype, value_dtype>)                                             \
+  REGISTER_KERNEL_BUILDER(                                                     \
+      Name("AnonymousMutableHashTable")                                        \
+          .Device(DEVICE_CPU)                                                  \
+          .TypeConstraint<key_dtype>("key_dtype")                              \
+          .TypeConstraint<value_dtype>("value_dtype")                          \
+          .Label("lock_free"),                                                 \
+      AnonymousLookupTableOp<                                                  \
+          lookup::LockFreeMutableHashTableOfScalars<key_dtype, value_dtype>,   \
+          key_dtype, value_dtype>)
+
+REGISTER_KERNEL(int32, double);
+REGISTER_KERNEL(int32, float);
+REGISTER_KERNEL(int32, int32);
+REGISTER_KERNEL(int32, int64_t);
+REGISTER_KERNEL(int64_t, double);
+REGISTER_KERNEL(int64_t, float);
+REGISTER_KERNEL(int64_t, int32);
+REGISTER_KERNEL(int64_t, int64_t);
+
+#undef REGISTER_KERNEL
+
 // Register the MutableHashTableOfTensors op.
 #define REGISTER_KERNEL(key_dtype, value_dtype)                                \
   REGISTER_KERNEL_BUILDER(                                                     \
@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/lookup_util.h"
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 #include "absl/status/status.h"
 #include "tensorflow/core/framework/function_handle_cache.h"
 #include "tensorflow/core/framework/lookup_interface.h"
@@ -25,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace lookup {
@@ -57,9 +62,11 @@ Status GetNumLinesInTextFile(Env* env, const string& vocab_file,
   return absl::OkStatus();
 }
 
-// Iterator that reads a text file. Each iteration process one line, it parses
-// the line and populates the keys and values tensors used for initialization
-// with a single key and corresponding value.
+// Iterator that reads a text file. Each iteration reads a batch of up to
+// kLinesPerBatch lines, parses them and populates the keys and values tensors
+// used for initialization with the keys and corresponding values of the batch.
+// The lines are read serially, but parsed in parallel when a thread pool is
+// given, which matters for vocabularies of tens of millions of lines.
 //
 // What information of the line to populate the key or values is specified by
 // providing key_index and value_index.
@@ -81,17 +88,21 @@ class TextFileLineIterator
   // - Index -1 means the line number stored in int64.
   // - Index >= 0 represent index (starting at zero) of the split line based on
   //   delimiter.
+  //
+  // The lines are parsed on 'thread_pool' if it is not null.
   Status Init(const string& filename, int64_t vocab_size, char delimiter,
               DataType key_dtype, int64_t key_index, DataType value_dtype,
-              int64_t value_index, int64_t offset, Env* env) {
+              int64_t value_index, int64_t offset, Env* env,
+              thread::ThreadPool* thread_pool) {
     filename_ = filename;
     vocab_size_ = vocab_size;
     delimiter_ = delimiter;
-    key_ = Tensor(key_dtype, TensorShape({}));
-    value_ = Tensor(value_dtype, TensorShape({}));
+    key_dtype_ = key_dtype;
+    value_dtype_ = value_dtype;
     key_index_ = key_index;
     value_index_ = value_index;
     env_ = env;
+    thread_pool_ = thread_pool;
 
     status_ = env->NewRandomAccessFile(filename_, &file_);
     if (!status_.ok()) return status_;
@@ -101,6 +112,7 @@ class TextFileLineIterator
     next_id_ = 0;
     offset_ = offset;
     ignore_split_ = std::max(key_index_, value_index_) < 0;
+    end_status_ = absl::OkStatus();
     Next();
     return status_;
   }
@@ -108,62 +120,77 @@ class TextFileLineIterator
   void Next() override {
     if (!valid_) return;
 
-    string line;
-    status_ = input_buffer_->ReadLine(&line);
-    if (!status_.ok()) {
-      if (absl::IsOutOfRange(status_) && vocab_size_ != -1 &&
-          next_id_ != vocab_size_) {
-        status_ = errors::InvalidArgument("Invalid vocab_size in ", filename_,
-                                          ": expected ", vocab_size_,
-                                          " but got ", next_id_);
+    // Read the lines of the batch, stopping at the first line that ends the
+    // iteration. That status is returned after the batch is consumed.
+    const int64_t first_id = next_id_;
+    lines_.clear();
+    while (end_status_.ok() && lines_.size() < kLinesPerBatch) {
+      string line;
+      end_status_ = input_buffer_->ReadLine(&line);
+      if (!end_status_.ok()) {
+        if (absl::IsOutOfRange(end_status_) && vocab_size_ != -1 &&
+            next_id_ != vocab_size_) {
+          end_status_ = errors::InvalidArgument(
+              "Invalid vocab_size in ", filename_, ": expected ", vocab_size_,
+              " but got ", next_id_);
+        }
+        break;
       }
-      valid_ = false;
-      return;
-    }
-    if (vocab_size_ != -1 && next_id_ >= vocab_size_) {
-      LOG(WARNING) << "Truncated " << filename_ << " before its end at "
-                   << vocab_size_ << " records.";
-      LOG(WARNING) << "next_id_  : " << next_id_;
-      status_ = errors::OutOfRange("Finished reading ", vocab_size_,
-                                   " of lines from ", filename_);
-      valid_ = false;
-      return;
+      if (vocab_size_ != -1 && next_id_ >= vocab_size_) {
+        LOG(WARNING) << "Truncated " << filename_ << " before its end at "
+                     << vocab_size_ << " records.";
+        LOG(WARNING) << "next_id_  : " << next_id_;
+        end_status_ = errors::OutOfRange("Finished reading ", vocab_size_,
+                                         " of lines from ", filename_);
+        break;
+      }
+      if (line.empty()) {
+        end_status_ = errors::InvalidArgument(
+            "Invalid content in ", filename_, ": empty line found at position ",
+            input_buffer_->Tell(), ".");
+        break;
+      }
+      lines_.push_back(std::move(line));
+      next_id_++;
     }
-    if (line.empty()) {
-      status_ = errors::InvalidArgument("Invalid content in ", filename_,
-                                        ": empty line found at position ",
-                                        input_buffer_->Tell(), ".");
+    if (lines_.empty()) {
+      status_ = end_status_;
       valid_ = false;
       return;
     }
 
-    std::vector<string> tokens;
-    if (!ignore_split_) {
-      tokens = str_util::Split(line, delimiter_);
-      const auto expected_size =
-          static_cast<size_t>(std::max(key_index_, value_index_) + 1);
-      if (tokens.size() < expected_size) {
-        status_ = errors::InvalidArgument(
-            "Invalid number of columns in ", filename_, " line ", next_id_,
-            " (", line, ") : expected at least ", expected_size, " got ",
-            tokens.size());
+    const int64_t num_lines = lines_.size();
+    key_ = Tensor(key_dtype_, TensorShape({num_lines}));
+    value_ = Tensor(value_dtype_, TensorShape({num_lines}));
+    // The lines are parsed in blocks, and the error of the first failing block
+    // is reported, so that it is the same error as in a serial parse.
+    const int64_t num_blocks =
+        (num_lines + kLinesPerParseBlock - 1) / kLinesPerParseBlock;
+    std::vector<Status> statuses(num_blocks);
+    auto parse_blocks = [&](int64_t start, int64_t limit) {
+      for (int64_t block = start; block < limit; ++block) {
+        const int64_t end =
+            std::min(num_lines, (block + 1) * kLinesPerParseBlock);
+        for (int64_t i = block * kLinesPerParseBlock; i < end; ++i) {
+          statuses[block] = ParseLine(first_id, i);
+          if (!statuses[block].ok()) break;
+        }
+      }
+    };
+    if (thread_pool_ != nullptr && num_blocks > 1) {
+      thread_pool_->ParallelFor(num_blocks, kLinesPerParseBlock * kCostPerLine,
+                                parse_blocks);
+    } else {
+      parse_blocks(0, num_blocks);
+    }
+    for (const Status& status : statuses) {
+      if (!status.ok()) {
+        status_ = status;
         valid_ = false;
         return;
       }
     }
-
-    status_ = SetValue(line, tokens, key_index_, &key_);
-    if (!status_.ok()) {
-      valid_ = false;
-      return;
-    }
-    status_ = SetValue(line, tokens, value_index_, &value_);
-    if (!status_.ok()) {
-      valid_ = false;
-      return;
-    }
-
-    next_id_++;
+    status_ = absl::OkStatus();
   }
 
   bool Valid() const override { return valid_; }
@@ -188,28 +215,62 @@ class TextFileLineIterator
   }
 
  private:
+  // Enough lines per batch to amortize the parallel parse, few enough to keep
+  // the batch small next to the table.
+  static constexpr size_t kLinesPerBatch = 1 << 16;
+  static constexpr int64_t kLinesPerParseBlock = 1024;
+  static constexpr int64_t kCostPerLine = 500;
+
   Tensor key_;
   Tensor value_;
+  DataType key_dtype_;
+  DataType value_dtype_;
   bool valid_;  // true if the iterator points to an existing range.
   int64_t key_index_;
   int64_t value_index_;
   Env* env_;
+  thread::ThreadPool* thread_pool_;
   int64_t next_id_;
   int64_t offset_;
   int64_t vocab_size_;
   string filename_;
   char delimiter_;
   Status status_;
+  // The status that ends the iteration after the lines read so far.
+  Status end_status_;
   bool ignore_split_;
+  std::vector<string> lines_;
   std::unique_ptr<RandomAccessFile> file_;  // must outlive input_buffer_
   std::unique_ptr<io::InputBuffer> input_buffer_;
 
-  // Set the corresponding value from line or tokens based on 'index' into the
-  // tensor 't'. The value is transformed to the given data type 'dtype'.
+  // Parses line 'i' of the batch, whose first line has id 'first_id', into
+  // element 'i' of the keys and values tensors.
+  Status ParseLine(int64_t first_id, int64_t i) {
+    const string& line = lines_[i];
+    const int64_t line_id = first_id + i;
+    std::vector<string> tokens;
+    if (!ignore_split_) {
+      tokens = str_util::Split(line, delimiter_);
+      const auto expected_size =
+          static_cast<size_t>(std::max(key_index_, value_index_) + 1);
+      if (tokens.size() < expected_size) {
+        return errors::InvalidArgument(
+            "Invalid number of columns in ", filename_, " line ", line_id, " (",
+            line, ") : expected at least ", expected_size, " got ",
+            tokens.size());
+      }
+    }
+    TF_RETURN_IF_ERROR(SetValue(line, tokens, key_index_, line_id, i, &key_));
+    return SetValue(line, tokens, value_index_, line_id, i, &value_);
+  }
+
+  // Set the corresponding value from line or tokens based on 'index' into
+  // element 'i' of the tensor 't'. The value is transformed to the given data
+  // type 'dtype'.
   Status SetValue(const string& line, const std::vector<string>& tokens,
-                  int64_t index, Tensor* tensor) {
+                  int64_t index, int64_t line_id, int64_t i, Tensor* tensor) {
     if (index == kLineNumber) {
-      tensor->flat<int64_t>()(0) = next_id_ + offset_;
+      tensor->flat<int64_t>()(i) = line_id + offset_;
       return absl::OkStatus();
     }
     const string& token = (index == kWholeLine) ? line : tokens[index];
@@ -218,44 +279,39 @@ class TextFileLineIterator
       case DT_INT32: {
         int32_t value;
         if (!strings::safe_strto32(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
+          return errors::InvalidArgument("Field ", token, " in line ", line_id,
                                          " is not a valid int32.");
         }
-        tensor->flat<int32>()(0) = value + offset_;
+        tensor->flat<int32>()(i) = value + offset_;
       } break;
       case DT_INT64: {
         int64_t value;
         if (!strings::safe_strto64(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
+          return errors::InvalidArgument("Field ", token, " in line ", line_id,
                                          " is not a valid int64.");
         }
-        tensor->flat<int64_t>()(0) = value;
+        tensor->flat<int64_t>()(i) = value;
       } break;
       case DT_FLOAT: {
         float value;
         if (!strings::safe_strtof(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
+          return errors::InvalidArgument("Field ", token, " in line ", line_id,
                                          " is not a valid float.");
         }
-        tensor->flat<float>()(0) = value;
+        tensor->flat<float>()(i) = value;
       } break;
       case DT_DOUBLE: {
         double value;
         if (!strings::safe_strtod(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
+          return errors::InvalidArgument("Field ", token, " in line ", line_id,
                                          " is not a valid double.");
         }
-        tensor->flat<double>()(0) = value;
+        tensor->flat<double>()(i) = value;
       } break;
       case DT_STRING:
-        tensor->flat<tstring>()(0) = token;
+        tensor->flat<tstring>()(i) = token;
         break;
       default:
-        valid_ = false;
         return errors::InvalidArgument("Data type ", DataTypeString(dtype),
                                        " not supported.");
     }
@@ -375,6 +431,18 @@ Status InitializeTableFromTextFile(
     int32_t key_index, int32_t value_index, int64_t offset, Env* env,
     std::unique_ptr<InitializableLookupTable::InitializerSerializer> serializer,
     InitializableLookupTable* table) {
+  return InitializeTableFromTextFile(filename, vocab_size, delimiter, key_index,
+                                     value_index, offset, env,
+                                     /*thread_pool=*/nullptr,
+                                     std::move(serializer), table);
+}
+
+Status InitializeTableFromTextFile(
+    const string& filename, int64_t vocab_size, char delimiter,
+    int32_t key_index, int32_t value_index, int64_t offset, Env* env,
+    thread::ThreadPool* thread_pool,
+    std::unique_ptr<InitializableLookupTable::InitializerSerializer> serializer,
+    InitializableLookupTable* table) {
   if (key_index == kLineNumber && table->key_dtype() != DT_INT64) {
     return errors::InvalidArgument(
         "Key index for line number requires table key dtype of int64, got ",
@@ -404,7 +472,7 @@ Status InitializeTableFromTextFile(
   TextFileLineIterator iter;
   TF_RETURN_IF_ERROR(iter.Init(filename, vocab_size, delimiter, key_dtype,
                                key_index, value_dtype, value_index, offset,
-                               env));
+                               env, thread_pool));
   // For initialization from files, ignore if the table is already
   // initialized. The table shared name should contain the filename to
   // avoid trying to initialize the same table from the same file at the same
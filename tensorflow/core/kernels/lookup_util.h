@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/framework/lookup_interface.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/kernels/initializable_lookup_table.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace data {
@@ -65,6 +66,15 @@ Status InitializeTableFromTextFile(
     std::unique_ptr<InitializableLookupTable::InitializerSerializer> serializer,
     InitializableLookupTable* table);
 
+// Like above, and parses the lines of `filename` in parallel on `thread_pool`
+// if it is not null.
+Status InitializeTableFromTextFile(
+    const string& filename, int64_t vocab_size, char delimiter,
+    int32_t key_index, int32_t value_index, int64_t offset, Env* env,
+    thread::ThreadPool* thread_pool,
+    std::unique_ptr<InitializableLookupTable::InitializerSerializer> serializer,
+    InitializableLookupTable* table);
+
 }  // namespace lookup
 }  // namespace tensorflow
 
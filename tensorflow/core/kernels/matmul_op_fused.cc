@@ -48,6 +48,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/kernels/fused_eigen_output_kernels.h"
+#include "tensorflow/core/kernels/matmul_op_small.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/util/matmul_autotune.h"
 #include "tensorflow/core/util/tensor_format.h"
@@ -106,9 +107,38 @@ struct LaunchFusedMatMulOp<CPUDevice, T> {
 
     auto& d = context->eigen_device<CPUDevice>();
 
+    const bool transpose_a = dim_pair[0].first == 0;
+    const bool transpose_b = dim_pair[0].second == 1;
+    const int64_t m = output->dim_size(0);
+    const int64_t k = a.dim_size(transpose_a ? 0 : 1);
+    const int64_t n = output->dim_size(1);
+
     // Executes Eigen contraction with output kernel wrapped into type erased
     // wrapper to reduce the number of unique template instantiations.
     auto executeWithOutputKernel = [&](auto output_kernel) {
+      // Products of a few rows skip the Eigen contraction, and the output
+      // kernel is applied to the whole result as a single block. The output
+      // mapper is column-major because Eigen swaps the arguments of row-major
+      // contractions.
+      if constexpr (functor::SmallMatMul<T>::kIsSupportedType) {
+        if (!transpose_b && functor::SmallMatMul<T>::IsSupported(m, k, n)) {
+          T* out_data = output->flat<T>().data();
+          functor::SmallMatMul<T>::Launch(
+              *(context->device()->tensorflow_cpu_worker_threads()),
+              a.flat<T>().data(), transpose_a, b.flat<T>().data(), out_data,
+              m, k, n);
+          const Eigen::TensorContractionParams params{
+              /*swapped_arguments=*/true};
+          const Eigen::Index num_rows = n;
+          const Eigen::Index num_cols = m;
+          output_kernel(
+              ContractionOutputMapper<T, Eigen::Index>(out_data, num_rows),
+              params, /*i=*/Eigen::Index{0}, /*j=*/Eigen::Index{0}, num_rows,
+              num_cols);
+          return;
+        }
+      }
+
       OutputKernelWrapper output_kernel_wrapper(
           [&output_kernel](
               const ContractionOutputMapper<ComputeType, Eigen::Index>&
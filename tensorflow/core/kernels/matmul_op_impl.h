@@ -37,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/framework/type_traits.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/fill_functor.h"
+#include "tensorflow/core/kernels/matmul_op_small.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/bfloat16.h"
@@ -422,6 +423,25 @@ struct LaunchBatchMatMul<CPUDevice, Scalar> {
 
     // Number of matrix multiplies i.e. size of the batch.
     const int64_t batch_size = bcast.output_batch_size();
+
+    // Products of a few rows skip the Eigen contraction, whose setup costs
+    // about as much as the product itself.
+    if constexpr (functor::SmallMatMul<Scalar>::kIsSupportedType) {
+      const int64_t m =
+          (adj_x || trans_x) ? in_x.dim_size(2) : in_x.dim_size(1);
+      const int64_t k =
+          (adj_x || trans_x) ? in_x.dim_size(1) : in_x.dim_size(2);
+      if (batch_size == 1 && !adj_y && !trans_y &&
+          functor::SmallMatMul<Scalar>::IsSupported(m, k, out->dim_size(2))) {
+        functor::SmallMatMul<Scalar>::Launch(
+            *(context->device()->tensorflow_cpu_worker_threads()),
+            in_x.flat<Scalar>().data(), adj_x || trans_x,
+            in_y.flat<Scalar>().data(), out->flat<Scalar>().data(), m, k,
+            out->dim_size(2));
+        return;
+      }
+    }
+
     const int64_t cost_per_unit =
         in_x.dim_size(1) * in_x.dim_size(2) * out->dim_size(2);
     const int64_t small_dim = std::min(
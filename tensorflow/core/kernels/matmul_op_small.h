@@ -0,0 +1,174 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_MATMUL_OP_SMALL_H_
+#define TENSORFLOW_CORE_KERNELS_MATMUL_OP_SMALL_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+
+#include "Eigen/Core"  // from @eigen_archive
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace functor {
+
+// Matrix products with a few rows, like the ones of serving graphs with small
+// batches, spend about as much time packing operands and dispatching to the
+// thread pool in the Eigen contraction as they spend computing. SmallMatMul
+// computes them directly with register-blocked tiles written with Eigen packet
+// primitives, which map to SSE, AVX2, AVX-512 or NEON depending on the build.
+template <typename T>
+struct SmallMatMul {
+  static constexpr bool kIsSupportedType =
+      std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+  // Largest sizes of the products computed by SmallMatMul.
+  static constexpr int64_t kMaxRows = 16;
+  static constexpr int64_t kMaxDepth = 512;
+  static constexpr int64_t kMaxCols = 512;
+
+  // Returns whether out[m, n] = a[m, k] * b[k, n] should be computed by
+  // SmallMatMul.
+  static bool IsSupported(int64_t m, int64_t k, int64_t n) {
+    return kIsSupportedType && m > 0 && m <= kMaxRows && k > 0 &&
+           k <= kMaxDepth && n >= kPacketSize && n <= kMaxCols;
+  }
+
+  // Computes out = a * b, where `out` is a row-major [m, n] matrix, `a` is a
+  // row-major [m, k] matrix, or [k, m] if `transpose_a`, and `b` is a
+  // row-major [k, n] matrix. Products too small to amortize the thread pool
+  // are computed on the calling thread, larger ones are sharded by columns.
+  static void Launch(const DeviceBase::CpuWorkerThreads& worker_threads,
+                     const T* a, bool transpose_a, const T* b, T* out,
+                     int64_t m, int64_t k, int64_t n) {
+    // Same threshold as the sequential matmul in LaunchBatchMatMul.
+    constexpr int64_t kMaxInlineCost = 128 * 128;
+    if (m * k * n <= kMaxInlineCost) {
+      Run(a, transpose_a, b, out, m, k, n, 0, n);
+      return;
+    }
+    constexpr int64_t kBlockCols = 4 * kPacketSize;
+    const int64_t num_blocks = (n + kBlockCols - 1) / kBlockCols;
+    Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+          /*cost_per_unit=*/m * k * kBlockCols,
+          [&](int64_t start, int64_t limit) {
+            Run(a, transpose_a, b, out, m, k, n, start * kBlockCols,
+                std::min(limit * kBlockCols, n));
+          });
+  }
+
+  // Computes the columns [col_begin, col_end) of out = a * b.
+  static void Run(const T* a, bool transpose_a, const T* b, T* out, int64_t m,
+                  int64_t k, int64_t n, int64_t col_begin, int64_t col_end) {
+    const int64_t a_row_stride = transpose_a ? 1 : k;
+    const int64_t a_depth_stride = transpose_a ? m : 1;
+    int64_t row = 0;
+    for (; row + 4 <= m; row += 4) {
+      RunRows<4>(a, a_row_stride, a_depth_stride, b, out, k, n, row, col_begin,
+                 col_end);
+    }
+    switch (m - row) {
+      case 3:
+        RunRows<3>(a, a_row_stride, a_depth_stride, b, out, k, n, row,
+                   col_begin, col_end);
+        break;
+      case 2:
+        RunRows<2>(a, a_row_stride, a_depth_stride, b, out, k, n, row,
+                   col_begin, col_end);
+        break;
+      case 1:
+        RunRows<1>(a, a_row_stride, a_depth_stride, b, out, k, n, row,
+                   col_begin, col_end);
+        break;
+      default:
+        break;
+    }
+  }
+
+ private:
+  using Packet = typename Eigen::internal::packet_traits<T>::type;
+  static constexpr int64_t kPacketSize =
+      Eigen::internal::packet_traits<T>::size;
+
+  // Computes `kRows` rows of `out` starting at `row` for the columns
+  // [col_begin, col_end), by tiles of `kRows` x 2 packets while possible.
+  template <int kRows>
+  static void RunRows(const T* a, int64_t a_row_stride, int64_t a_depth_stride,
+                      const T* b, T* out, int64_t k, int64_t n, int64_t row,
+                      int64_t col_begin, int64_t col_end) {
+    int64_t col = col_begin;
+    for (; col + 2 * kPacketSize <= col_end; col += 2 * kPacketSize) {
+      Tile<kRows, 2>(a, a_row_stride, a_depth_stride, b, out, k, n, row, col);
+    }
+    for (; col + kPacketSize <= col_end; col += kPacketSize) {
+      Tile<kRows, 1>(a, a_row_stride, a_depth_stride, b, out, k, n, row, col);
+    }
+    for (; col < col_end; ++col) {
+      for (int r = 0; r < kRows; ++r) {
+        const T* a_row = a + (row + r) * a_row_stride;
+        T sum(0);
+        for (int64_t d = 0; d < k; ++d) {
+          sum += a_row[d * a_depth_stride] * b[d * n + col];
+        }
+        out[(row + r) * n + col] = sum;
+      }
+    }
+  }
+
+  // Computes the tile of `kRows` rows and `kPackets` packets of columns of
+  // `out` at (`row`, `col`), keeping all the accumulators in registers.
+  template <int kRows, int kPackets>
+  static EIGEN_ALWAYS_INLINE void Tile(const T* a, int64_t a_row_stride,
+                                       int64_t a_depth_stride, const T* b,
+                                       T* out, int64_t k, int64_t n,
+                                       int64_t row, int64_t col) {
+    using Eigen::internal::pmadd;
+    using Eigen::internal::pset1;
+    Packet acc[kRows][kPackets];
+    for (int r = 0; r < kRows; ++r) {
+      for (int p = 0; p < kPackets; ++p) acc[r][p] = pset1<Packet>(T(0));
+    }
+    const T* a_tile = a + row * a_row_stride;
+    for (int64_t d = 0; d < k; ++d) {
+      const T* b_row = b + d * n + col;
+      Packet b_packets[kPackets];
+      for (int p = 0; p < kPackets; ++p) {
+        b_packets[p] =
+            Eigen::internal::ploadu<Packet>(b_row + p * kPacketSize);
+      }
+      for (int r = 0; r < kRows; ++r) {
+        const Packet a_value =
+            pset1<Packet>(a_tile[r * a_row_stride + d * a_depth_stride]);
+        for (int p = 0; p < kPackets; ++p) {
+          acc[r][p] = pmadd(a_value, b_packets[p], acc[r][p]);
+        }
+      }
+    }
+    for (int r = 0; r < kRows; ++r) {
+      T* out_row = out + (row + r) * n + col;
+      for (int p = 0; p < kPackets; ++p) {
+        Eigen::internal::pstoreu(out_row + p * kPacketSize, acc[r][p]);
+      }
+    }
+  }
+};
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_MATMUL_OP_SMALL_H_
@@ -0,0 +1,100 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/matmul_op_small.h"
+
+#include "Eigen/Core"  // from @eigen_archive
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace functor {
+namespace {
+
+template <typename T>
+class SmallMatMulTest : public ::testing::Test {
+ protected:
+  using Matrix =
+      Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+  SmallMatMulTest() : pool_(Env::Default(), "test", /*num_threads=*/4) {
+    worker_threads_.num_threads = pool_.NumThreads();
+    worker_threads_.workers = &pool_;
+  }
+
+  void TestMatMul(int64_t m, int64_t k, int64_t n, bool transpose_a) {
+    ASSERT_TRUE(SmallMatMul<T>::IsSupported(m, k, n));
+    const Matrix a = Matrix::Random(transpose_a ? k : m, transpose_a ? m : k);
+    const Matrix b = Matrix::Random(k, n);
+    Matrix expected(m, n);
+    if (transpose_a) {
+      expected.noalias() = a.transpose() * b;
+    } else {
+      expected.noalias() = a * b;
+    }
+
+    Matrix out = Matrix::Constant(m, n, T(-1));
+    SmallMatMul<T>::Launch(worker_threads_, a.data(), transpose_a, b.data(),
+                           out.data(), m, k, n);
+    for (int64_t i = 0; i < m; ++i) {
+      for (int64_t j = 0; j < n; ++j) {
+        EXPECT_NEAR(out(i, j), expected(i, j), 1e-4)
+            << "m=" << m << " k=" << k << " n=" << n
+            << " transpose_a=" << transpose_a << " at (" << i << ", " << j
+            << ")";
+      }
+    }
+  }
+
+  thread::ThreadPool pool_;
+  DeviceBase::CpuWorkerThreads worker_threads_;
+};
+
+using SmallMatMulTypes = ::testing::Types<float, double>;
+TYPED_TEST_SUITE(SmallMatMulTest, SmallMatMulTypes);
+
+TYPED_TEST(SmallMatMulTest, Shapes) {
+  for (int64_t m : {1, 2, 3, 4, 5, 7, 16}) {
+    for (int64_t k : {1, 3, 64, 512}) {
+      for (int64_t n : {8, 9, 17, 33, 100, 512}) {
+        this->TestMatMul(m, k, n, /*transpose_a=*/false);
+        this->TestMatMul(m, k, n, /*transpose_a=*/true);
+      }
+    }
+  }
+}
+
+TYPED_TEST(SmallMatMulTest, IsSupported) {
+  using Kernel = SmallMatMul<TypeParam>;
+  EXPECT_TRUE(Kernel::IsSupported(1, 1, 512));
+  EXPECT_TRUE(Kernel::IsSupported(16, 512, 512));
+  EXPECT_FALSE(Kernel::IsSupported(0, 16, 16));
+  EXPECT_FALSE(Kernel::IsSupported(17, 16, 16));
+  EXPECT_FALSE(Kernel::IsSupported(4, 513, 16));
+  EXPECT_FALSE(Kernel::IsSupported(4, 16, 513));
+  // Too narrow for a single packet.
+  EXPECT_FALSE(Kernel::IsSupported(4, 16, 1));
+}
+
+TEST(SmallMatMulTypeTest, UnsupportedTypes) {
+  EXPECT_FALSE(SmallMatMul<Eigen::half>::IsSupported(4, 16, 16));
+  EXPECT_FALSE(SmallMatMul<int32>::IsSupported(4, 16, 16));
+}
+
+}  // namespace
+}  // namespace functor
+}  // namespace tensorflow
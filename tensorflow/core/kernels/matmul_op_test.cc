@@ -359,6 +359,13 @@ TYPED_TEST_P(FusedMatMulWithBiasOpTest, MatMul1x256x1) {
   this->VerifyMatMulWithBias(1, 256, 1, false, false);
 }
 
+TYPED_TEST_P(FusedMatMulWithBiasOpTest, MatMul7x100x37) {
+  this->VerifyMatMulWithBias(7, 100, 37, false, false);
+  this->VerifyMatMulWithBias(7, 100, 37, true, false);
+  this->VerifyMatMulWithBias(7, 100, 37, false, true);
+  this->VerifyMatMulWithBias(7, 100, 37, true, true);
+}
+
 static auto GetActivations(DataType dtype) {
   // "GeluExact", "Tanh", "Sigmoid" fusions are only supported for half-float
   // datatype
@@ -398,6 +405,15 @@ TYPED_TEST_P(FusedMatMulWithBiasOpTest, MatMul256x256x1WithActivation) {
   }
 }
 
+TYPED_TEST_P(FusedMatMulWithBiasOpTest, MatMul7x100x37WithActivation) {
+  for (const string& activation : GetActivations(this->kTValueType)) {
+    this->VerifyConv2DWithBiasAndActivation(7, 100, 37, false, false,
+                                            activation);
+    this->VerifyConv2DWithBiasAndActivation(7, 100, 37, true, false,
+                                            activation);
+  }
+}
+
 TYPED_TEST_P(FusedMatMulWithBiasOpTest, MatMul1x256x1WithActivation) {
   for (const string& activation : GetActivations(this->kTValueType)) {
     this->VerifyConv2DWithBiasAndActivation(1, 256, 1, false, false,
@@ -410,9 +426,11 @@ REGISTER_TYPED_TEST_SUITE_P(FusedMatMulWithBiasOpTest,       //
                             MatMul1x256x256,                 //
                             MatMul256x256x1,                 //
                             MatMul1x256x1,                   //
+                            MatMul7x100x37,                  //
                             MatMul256x128x64WithActivation,  //
                             MatMul1x256x256WithActivation,   //
                             MatMul256x256x1WithActivation,   //
+                            MatMul7x100x37WithActivation,    //
                             MatMul1x256x1WithActivation);
 
 // TODO(ezhulenev): Add support for more data types.
@@ -476,6 +494,12 @@ BM_Matmul(8, 512, 512, false, false);
 BM_Matmul(16, 512, 512, false, false);
 BM_Matmul(128, 512, 512, false, false);
 
+// Small fully connected layers of serving graphs
+BM_Matmul(1, 128, 128, false, false);
+BM_Matmul(4, 128, 128, false, false);
+BM_Matmul(4, 128, 128, true, false);
+BM_Matmul(16, 256, 256, false, false);
+
 BM_Matmul(1, 1024, 1024, false, false);
 BM_Matmul(8, 1024, 1024, false, false);
 BM_Matmul(16, 1024, 1024, false, false);
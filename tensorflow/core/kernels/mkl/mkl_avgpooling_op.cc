@@ -127,8 +127,9 @@ class MklAvgPoolingOp : public MklPoolingForwardOpBase<T> {
       // in oneDNN.
       Eigen::ThreadPoolInterface* eigen_interface =
           EigenThreadPoolFromTfContext(context);
-      tsl::OneDnnThreadPool eigen_tp(eigen_interface,
-                                     ThreadPoolUseCallerThread());
+      tsl::OneDnnThreadPool eigen_tp(
+          eigen_interface, ThreadPoolUseCallerThread(),
+          OneDnnNumThreads(context));
       pooling_fwd = MklPoolingFwdPrimitiveFactory<T>::Get(fwdParams);
 
       // Allocate output tensor.
@@ -346,8 +347,9 @@ class MklAvgPoolingGradOp : public MklPoolingBackwardOpBase<T> {
           this->native_format_);
       Eigen::ThreadPoolInterface* eigen_interface =
           EigenThreadPoolFromTfContext(context);
-      tsl::OneDnnThreadPool eigen_tp(eigen_interface,
-                                     ThreadPoolUseCallerThread());
+      tsl::OneDnnThreadPool eigen_tp(
+          eigen_interface, ThreadPoolUseCallerThread(),
+          OneDnnNumThreads(context));
       MklPoolingBwdPrimitive<T>* pooling_bwd =
           MklPoolingBwdPrimitiveFactory<T>::Get(bwdParams);
 
@@ -166,8 +166,9 @@ class BatchMatMulMkl : public OpKernel {
     // in oneDNN.
     Eigen::ThreadPoolInterface* eigen_interface =
         EigenThreadPoolFromTfContext(ctx);
-    tsl::OneDnnThreadPool eigen_tp(eigen_interface,
-                                   ThreadPoolUseCallerThread());
+    tsl::OneDnnThreadPool eigen_tp(
+        eigen_interface, ThreadPoolUseCallerThread(),
+        OneDnnNumThreads(ctx));
     // Create or retrieve matmul primitive from cache.
     MklMatMulPrimitive<Tlhs, Trhs, Toutput>* matmul_prim =
         MklMatMulPrimitiveFactory<float, Tlhs, Trhs, Toutput>::Get(
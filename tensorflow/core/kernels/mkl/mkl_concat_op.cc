@@ -765,8 +765,9 @@ class MklConcatOp : public OpKernel {
       // in oneDNN.
       Eigen::ThreadPoolInterface* eigen_interface =
           EigenThreadPoolFromTfContext(context);
-      tsl::OneDnnThreadPool eigen_tp(eigen_interface,
-                                     ThreadPoolUseCallerThread());
+      tsl::OneDnnThreadPool eigen_tp(
+          eigen_interface, ThreadPoolUseCallerThread(),
+          OneDnnNumThreads(context));
       if (!inputs.empty()) {
         if (are_all_mkl_inputs) {
           auto concat_pd =
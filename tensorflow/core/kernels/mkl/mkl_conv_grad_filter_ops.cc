@@ -521,8 +521,9 @@ class MklConvCustomBackpropFilterOp
       // in oneDNN.
       Eigen::ThreadPoolInterface* eigen_interface =
           EigenThreadPoolFromTfContext(context);
-      tsl::OneDnnThreadPool eigen_tp(eigen_interface,
-                                     ThreadPoolUseCallerThread());
+      tsl::OneDnnThreadPool eigen_tp(
+          eigen_interface, ThreadPoolUseCallerThread(),
+          OneDnnNumThreads(context));
       MklConvBwdFilterPrimitive<T>* conv_bwd_filter =
           MklConvBwdFilterPrimitiveFactory<T>::Get(convBwdFilterDims,
                                                    do_not_cache);
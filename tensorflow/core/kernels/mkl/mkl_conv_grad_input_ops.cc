@@ -475,8 +475,9 @@ class MklConvCustomBackpropInputOp
       // in oneDNN.
       Eigen::ThreadPoolInterface* eigen_interface =
           EigenThreadPoolFromTfContext(context);
-      tsl::OneDnnThreadPool eigen_tp(eigen_interface,
-                                     ThreadPoolUseCallerThread());
+      tsl::OneDnnThreadPool eigen_tp(
+          eigen_interface, ThreadPoolUseCallerThread(),
+          OneDnnNumThreads(context));
       MklConvBwdInputPrimitive<T>* conv_bwd_input =
           MklConvBwdInputPrimitiveFactory<T>::Get(convBwdInputDims,
                                                   do_not_cache);
@@ -993,8 +993,9 @@ class MklConvOp : public OpKernel {
       // in oneDNN.
       Eigen::ThreadPoolInterface* eigen_interface =
           EigenThreadPoolFromTfContext(context);
-      tsl::OneDnnThreadPool eigen_tp(eigen_interface,
-                                     ThreadPoolUseCallerThread());
+      tsl::OneDnnThreadPool eigen_tp(
+          eigen_interface, ThreadPoolUseCallerThread(),
+          OneDnnNumThreads(context));
       conv_fwd =
           MklConvFwdPrimitiveFactory<Tinput, Tfilter, Tbias, Ttemp_output>::Get(
               convFwdDims, do_not_cache);
@@ -116,8 +116,9 @@ struct MklEinsumHelper {
     // in oneDNN.
     Eigen::ThreadPoolInterface* eigen_interface =
         EigenThreadPoolFromTfContext(ctx);
-    tsl::OneDnnThreadPool eigen_tp(eigen_interface,
-                                   ThreadPoolUseCallerThread());
+    tsl::OneDnnThreadPool eigen_tp(
+        eigen_interface, ThreadPoolUseCallerThread(),
+        OneDnnNumThreads(ctx));
     // Create or retrieve matmul primitive from cache.
     MklMatMulPrimitive<T, T, T>* matmul_prim =
         MklMatMulPrimitiveFactory<T, T, T, T>::Get(
@@ -68,8 +68,9 @@ class MklLayerNormOp : public OpKernel {
       // in oneDNN.
       Eigen::ThreadPoolInterface* eigen_interface =
           EigenThreadPoolFromTfContext(ctx);
-      tsl::OneDnnThreadPool eigen_tp(eigen_interface,
-                                     ThreadPoolUseCallerThread());
+      tsl::OneDnnThreadPool eigen_tp(
+          eigen_interface, ThreadPoolUseCallerThread(),
+          OneDnnNumThreads(ctx));
       auto cpu_stream =
           std::unique_ptr<stream>(CreateStream(&eigen_tp, cpu_engine));
 
@@ -166,8 +166,9 @@ class MklMatMulOp : public OpKernel {
     // in oneDNN.
     Eigen::ThreadPoolInterface* eigen_interface =
         EigenThreadPoolFromTfContext(ctx);
-    tsl::OneDnnThreadPool eigen_tp(eigen_interface,
-                                   ThreadPoolUseCallerThread());
+    tsl::OneDnnThreadPool eigen_tp(
+        eigen_interface, ThreadPoolUseCallerThread(),
+        OneDnnNumThreads(ctx));
     // With threadpool , the runtime overhead is comparable to the kernel
     // execution for small kernel sizes. For such sizes, it may be better to run
     // the kernel single threaded. Here we are coming up with a cost model based
@@ -88,6 +88,12 @@ BM_Matmul(8, 512, 512, false, false);
 BM_Matmul(16, 512, 512, false, false);
 BM_Matmul(128, 512, 512, false, false);
 
+// Small fully connected layers of serving graphs
+BM_Matmul(1, 128, 128, false, false);
+BM_Matmul(4, 128, 128, false, false);
+BM_Matmul(4, 128, 128, true, false);
+BM_Matmul(16, 256, 256, false, false);
+
 BM_Matmul(1, 1024, 1024, false, false);
 BM_Matmul(8, 1024, 1024, false, false);
 BM_Matmul(16, 1024, 1024, false, false);
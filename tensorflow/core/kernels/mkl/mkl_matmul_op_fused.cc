@@ -148,8 +148,9 @@ class MklFusedMatMulOp : public MklDnnMatMulOpBase<T2, Tbias, Toutput> {
     // in oneDNN.
     Eigen::ThreadPoolInterface* eigen_interface =
         EigenThreadPoolFromTfContext(ctx);
-    tsl::OneDnnThreadPool eigen_tp(eigen_interface, ThreadPoolUseCallerThread(),
-                                   st ? 1 : -1);
+    tsl::OneDnnThreadPool eigen_tp(
+        eigen_interface, ThreadPoolUseCallerThread(),
+        st ? 1 : OneDnnNumThreads(ctx));
     MklDnnMatMulFwdPrimitive<float, T1, T2, Tbias, Toutput>* matmul_prim =
         MklDnnMatMulFwdPrimitiveFactory<float, T1, T2, Tbias, Toutput>::Get(
             matmul_params, 0);
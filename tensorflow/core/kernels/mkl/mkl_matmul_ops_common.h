@@ -1190,8 +1190,9 @@ void dnnl_gemm(char transa, char transb, int64_t m, int64_t n, int64_t k,
   // in oneDNN.
   Eigen::ThreadPoolInterface* eigen_interface =
       EigenThreadPoolFromTfContext(ctx);
-  tsl::OneDnnThreadPool eigen_tp(eigen_interface, ThreadPoolUseCallerThread(),
-                                 st ? 1 : -1);
+  tsl::OneDnnThreadPool eigen_tp(
+      eigen_interface, ThreadPoolUseCallerThread(),
+      st ? 1 : OneDnnNumThreads(ctx));
   MklMatMulPrimitive<T, T, T>* matmul_prim =
       MklMatMulPrimitiveFactory<T, T, T, T>::Get(params, 0);
 
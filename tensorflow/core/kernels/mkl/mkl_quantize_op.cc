@@ -488,8 +488,9 @@ class MklQuantizeV2Op : public OpKernel {
     // in oneDNN.
     Eigen::ThreadPoolInterface* eigen_interface =
         EigenThreadPoolFromTfContext(ctx);
-    tsl::OneDnnThreadPool eigen_tp(eigen_interface,
-                                   ThreadPoolUseCallerThread());
+    tsl::OneDnnThreadPool eigen_tp(
+        eigen_interface, ThreadPoolUseCallerThread(),
+        OneDnnNumThreads(ctx));
 
     float scale_factor = 0;
     if (mode_ == QUANTIZE_MODE_SCALED) {
@@ -168,8 +168,9 @@ class MklSparseMatrixMatMulOp : public MklDnnMatMulOpBase<T, void, T> {
                                           num_rhs_cols, sizeof(T));
       Eigen::ThreadPoolInterface* eigen_interface =
           EigenThreadPoolFromTfContext(ctx);
-      tsl::OneDnnThreadPool eigen_tp(eigen_interface,
-                                     ThreadPoolUseCallerThread(), st ? 1 : -1);
+      tsl::OneDnnThreadPool eigen_tp(
+          eigen_interface, ThreadPoolUseCallerThread(),
+          st ? 1 : OneDnnNumThreads(ctx));
 
       // Get the cached primitive.
       std::shared_ptr<dnnl::matmul::primitive_desc> matmul_pd =
@@ -0,0 +1,248 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Implements the _FusedRaggedGatherToTensor op, which the remapper creates
+// from RaggedGather -> RaggedTensorToTensor. Rows are gathered straight into
+// the padded dense output, without materializing the gathered splits and
+// values.
+
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/kernels/list_kernels.h"
+#include "tensorflow/core/util/ragged_to_dense_util.h"
+#include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Writes `num_rows` rows of `num_cols` values of `value_size` scalars each to
+// `output`. Row `i < indices.size()` holds the first `num_cols` values of row
+// `indices(i)` of the ragged params, the rest is padded with `default_value`.
+template <typename VALUE_TYPE, typename INDEX_TYPE, typename SPLITS_TYPE>
+void WriteGatheredRows(OpKernelContext* context, const Tensor& splits_in,
+                       const Tensor& values_in, const Tensor& indices_in,
+                       const Tensor& default_value_in, int64_t num_rows,
+                       int64_t num_cols, int64_t value_size, Tensor* output) {
+  const auto splits = splits_in.flat<SPLITS_TYPE>();
+  const auto indices = indices_in.flat<INDEX_TYPE>();
+  const VALUE_TYPE* values = values_in.flat<VALUE_TYPE>().data();
+  const VALUE_TYPE* default_value = default_value_in.flat<VALUE_TYPE>().data();
+  const bool scalar_default = default_value_in.NumElements() == 1;
+  VALUE_TYPE* out = output->flat<VALUE_TYPE>().data();
+  const int64_t num_indices = indices.size();
+  const int64_t row_size = num_cols * value_size;
+
+  auto write_rows = [&](int64_t start, int64_t limit) {
+    for (int64_t row = start; row < limit; ++row) {
+      VALUE_TYPE* out_row = out + row * row_size;
+      int64_t length = 0;
+      if (row < num_indices) {
+        const INDEX_TYPE index = indices(row);
+        const SPLITS_TYPE begin = splits(index);
+        length = std::min<int64_t>(splits(index + 1) - begin, num_cols);
+        std::copy_n(values + begin * value_size, length * value_size, out_row);
+      }
+      if (scalar_default) {
+        std::fill(out_row + length * value_size, out_row + row_size,
+                  *default_value);
+      } else {
+        for (int64_t col = length; col < num_cols; ++col) {
+          std::copy_n(default_value, value_size, out_row + col * value_size);
+        }
+      }
+    }
+  };
+  auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers, num_rows,
+        /*cost_per_unit=*/std::max<int64_t>(row_size, 1), write_rows);
+}
+
+}  // namespace
+
+template <typename INDEX_TYPE, typename SPLITS_TYPE>
+class RaggedGatherToTensorOpBase : public OpKernel {
+ public:
+  using OpKernel::OpKernel;
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& splits_in = context->input(0);
+    const Tensor& values_in = context->input(1);
+    const Tensor& indices_in = context->input(2);
+    const Tensor& shape_in = context->input(3);
+    const Tensor& default_value_in = context->input(4);
+
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(splits_in.shape()),
+                errors::InvalidArgument("params_splits must be a vector"));
+    OP_REQUIRES(context, splits_in.NumElements() > 0,
+                errors::InvalidArgument("Ragged splits may not be empty"));
+    OP_REQUIRES(context, values_in.dims() > 0,
+                errors::InvalidArgument("params.rank must be nonzero"));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(indices_in.shape()),
+                errors::InvalidArgument("indices must be a vector"));
+    OP_REQUIRES_OK(context, ValidateSplits(splits_in, values_in.dim_size(0)));
+
+    // Find the width of the widest gathered row while validating indices.
+    const auto splits = splits_in.flat<SPLITS_TYPE>();
+    const auto indices = indices_in.flat<INDEX_TYPE>();
+    const SPLITS_TYPE num_params = splits.size() - 1;
+    int64_t max_width = 0;
+    for (int64_t i = 0; i < indices.size(); ++i) {
+      const INDEX_TYPE index = indices(i);
+      OP_REQUIRES(context, index >= 0 && index < num_params,
+                  errors::InvalidArgument(
+                      "indices", SliceDebugString(indices_in.shape(), i),
+                      " = ", index, " is not in [0, ", num_params, ")"));
+      max_width = std::max<int64_t>(max_width,
+                                    splits(index + 1) - splits(index));
+    }
+
+    // Resolve the dimensions of the result that `shape` leaves unknown, the
+    // same way RaggedTensorToTensor does for a single ragged dimension.
+    TensorShapeProto values_shape;
+    values_in.shape().AsProto(&values_shape);
+    TensorShapeProto default_value_shape;
+    default_value_in.shape().AsProto(&default_value_shape);
+    OP_REQUIRES_OK(context, ValidateDefaultValueShape(default_value_shape,
+                                                      values_shape));
+    TensorShapeProto shape;
+    {
+      PartialTensorShape partial_shape;
+      OP_REQUIRES_OK(context, TensorShapeFromTensor(shape_in, &partial_shape));
+      partial_shape.AsProto(&shape);
+    }
+    TensorShapeProto output_shape_proto;
+    OP_REQUIRES_OK(context,
+                   CombineRaggedTensorToTensorShapes(
+                       /*ragged_rank=*/1, shape, values_shape,
+                       &output_shape_proto));
+    std::vector<int64_t> output_size;
+    for (const TensorShapeProto::Dim& dim : output_shape_proto.dim()) {
+      output_size.push_back(dim.size());
+    }
+    if (output_size[0] < 0) output_size[0] = indices.size();
+    if (output_size[1] < 0) output_size[1] = max_width;
+    TensorShape output_shape;
+    OP_REQUIRES_OK(context,
+                   TensorShapeUtils::MakeShape(output_size, &output_shape));
+
+    int64_t value_size = 1;
+    for (int i = 1; i < values_in.dims(); ++i) {
+      value_size *= values_in.dim_size(i);
+    }
+    int64_t output_value_size = 1;
+    for (int i = 2; i < output_shape.dims(); ++i) {
+      output_value_size *= output_shape.dim_size(i);
+    }
+    OP_REQUIRES(context, output_value_size == value_size,
+                errors::InvalidArgument(
+                    "shape ", output_shape.DebugString(),
+                    " is incompatible with the values of shape ",
+                    values_in.shape().DebugString()));
+    OP_REQUIRES(
+        context,
+        default_value_in.NumElements() == 1 ||
+            default_value_in.NumElements() == value_size,
+        errors::Unimplemented("default_value of shape ",
+                              default_value_in.shape().DebugString(),
+                              " must be a scalar or have the shape of a value ",
+                              "of the result"));
+
+    Tensor* output;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    if (output_shape.num_elements() == 0) return;
+    CallWriteGatheredRows(context, splits_in, values_in, indices_in,
+                          default_value_in, output_shape.dim_size(0),
+                          output_shape.dim_size(1), value_size, output);
+  }
+
+ protected:
+  // Call WriteGatheredRows() using the appropriate VALUE_TYPE template
+  // parameter, like RaggedGatherOp does to limit binary size.
+  virtual void CallWriteGatheredRows(OpKernelContext* context,
+                                     const Tensor& splits_in,
+                                     const Tensor& values_in,
+                                     const Tensor& indices_in,
+                                     const Tensor& default_value_in,
+                                     int64_t num_rows, int64_t num_cols,
+                                     int64_t value_size,
+                                     Tensor* output) const = 0;
+
+ private:
+  static Status ValidateSplits(const Tensor& splits_in,
+                               int64_t num_params_dense_values) {
+    const auto splits = splits_in.flat<SPLITS_TYPE>();
+    if (splits(0) < 0) {
+      return errors::InvalidArgument("Ragged splits must be non-negative");
+    }
+    if (splits(splits.size() - 1) > num_params_dense_values) {
+      return errors::InvalidArgument(
+          "Ragged splits must not point past values");
+    }
+    for (int64_t i = 1; i < splits.size(); ++i) {
+      if (splits(i - 1) > splits(i)) {
+        return errors::InvalidArgument("Ragged splits must be sorted");
+      }
+    }
+    return absl::OkStatus();
+  }
+};
+
+template <typename INDEX_TYPE, typename VALUE_TYPE, typename SPLITS_TYPE>
+class RaggedGatherToTensorOp
+    : public RaggedGatherToTensorOpBase<INDEX_TYPE, SPLITS_TYPE> {
+ public:
+  using RaggedGatherToTensorOpBase<INDEX_TYPE,
+                                   SPLITS_TYPE>::RaggedGatherToTensorOpBase;
+
+ private:
+  void CallWriteGatheredRows(OpKernelContext* context, const Tensor& splits_in,
+                             const Tensor& values_in, const Tensor& indices_in,
+                             const Tensor& default_value_in, int64_t num_rows,
+                             int64_t num_cols, int64_t value_size,
+                             Tensor* output) const override {
+    WriteGatheredRows<VALUE_TYPE, INDEX_TYPE, SPLITS_TYPE>(
+        context, splits_in, values_in, indices_in, default_value_in, num_rows,
+        num_cols, value_size, output);
+  }
+};
+
+#define REGISTER_CPU_KERNEL_WITH_INDEX_TYPE(index_type, value_type, \
+                                            splits_type)            \
+  REGISTER_KERNEL_BUILDER(                                          \
+      Name("_FusedRaggedGatherToTensor")                            \
+          .Device(DEVICE_CPU)                                       \
+          .TypeConstraint<index_type>("Tindices")                   \
+          .TypeConstraint<value_type>("Tvalues")                    \
+          .TypeConstraint<splits_type>("Tsplits"),                  \
+      RaggedGatherToTensorOp<index_type, value_type, splits_type>);
+#define REGISTER_CPU_KERNEL(value_type)                           \
+  REGISTER_CPU_KERNEL_WITH_INDEX_TYPE(int32, value_type, int32)   \
+  REGISTER_CPU_KERNEL_WITH_INDEX_TYPE(int64_t, value_type, int32) \
+  REGISTER_CPU_KERNEL_WITH_INDEX_TYPE(int32, value_type, int64_t) \
+  REGISTER_CPU_KERNEL_WITH_INDEX_TYPE(int64_t, value_type, int64_t)
+TF_CALL_POD_TYPES(REGISTER_CPU_KERNEL);
+TF_CALL_tstring(REGISTER_CPU_KERNEL);
+#undef REGISTER_CPU_KERNEL
+#undef REGISTER_CPU_KERNEL_WITH_INDEX_TYPE
+
+}  // namespace tensorflow
@@ -0,0 +1,132 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class RaggedGatherToTensorOpTest : public ::tensorflow::OpsTestBase {
+ protected:
+  // Builds the tensorflow test graph for _FusedRaggedGatherToTensor.
+  template <typename VALUE_TYPE>
+  void BuildRaggedGatherToTensorGraph(
+      const std::vector<int32>& indices,
+      const std::vector<int64_t>& params_splits,
+      const TensorShape& params_dense_values_shape,
+      const gtl::ArraySlice<VALUE_TYPE> params_dense_values,
+      const TensorShape& shape_shape, const std::vector<int64_t>& shape,
+      const TensorShape& default_value_shape,
+      const gtl::ArraySlice<VALUE_TYPE> default_value) {
+    const auto& value_dtype = DataTypeToEnum<VALUE_TYPE>::v();
+    TF_ASSERT_OK(NodeDefBuilder("tested_op", "_FusedRaggedGatherToTensor")
+                     .Input(FakeInput(DT_INT64))     // params_splits
+                     .Input(FakeInput(value_dtype))  // params_dense_values
+                     .Input(FakeInput(DT_INT32))     // indices
+                     .Input(FakeInput(DT_INT64))     // shape
+                     .Input(FakeInput(value_dtype))  // default_value
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    const int64_t num_splits = params_splits.size();
+    AddInputFromArray<int64_t>(TensorShape({num_splits}), params_splits);
+    AddInputFromArray<VALUE_TYPE>(params_dense_values_shape,
+                                  params_dense_values);
+    const int64_t num_indices = indices.size();
+    AddInputFromArray<int32>(TensorShape({num_indices}), indices);
+    AddInputFromArray<int64_t>(shape_shape, shape);
+    AddInputFromArray<VALUE_TYPE>(default_value_shape, default_value);
+  }
+};
+
+TEST_F(RaggedGatherToTensorOpTest, BoundingShape) {
+  // indices = [2, 1, 0, 3]
+  // params = [[.1, .2, .3], [], [.4, .5, .6, .7], [.8, .9]]
+  BuildRaggedGatherToTensorGraph<float>(
+      {2, 1, 0, 3},                          // indices
+      {0, 3, 3, 7, 9},                       // params_splits
+      TensorShape({9}),                      // params_dense_values.shape
+      {.1, .2, .3, .4, .5, .6, .7, .8, .9},  // params_dense_values
+      TensorShape({}), {-1},                 // shape
+      TensorShape({}), {0});                 // default_value
+
+  TF_ASSERT_OK(RunOpKernel());
+
+  test::ExpectTensorNear<float>(
+      *GetOutput(0),
+      test::AsTensor<float>({.4, .5, .6, .7, 0, 0, 0, 0,  //
+                             .1, .2, .3, 0, .8, .9, 0, 0},
+                            TensorShape({4, 4})),
+      0.1);
+}
+
+TEST_F(RaggedGatherToTensorOpTest, PadAndTruncate) {
+  BuildRaggedGatherToTensorGraph<float>(
+      {2, 1, 0, 3},                          // indices
+      {0, 3, 3, 7, 9},                       // params_splits
+      TensorShape({9}),                      // params_dense_values.shape
+      {.1, .2, .3, .4, .5, .6, .7, .8, .9},  // params_dense_values
+      TensorShape({2}), {5, 2},              // shape
+      TensorShape({}), {-1});                // default_value
+
+  TF_ASSERT_OK(RunOpKernel());
+
+  test::ExpectTensorNear<float>(
+      *GetOutput(0),
+      test::AsTensor<float>({.4, .5, -1, -1, .1, .2, .8, .9, -1, -1},
+                            TensorShape({5, 2})),
+      0.1);
+}
+
+TEST_F(RaggedGatherToTensorOpTest, InnerDimensions) {
+  // indices = [1, 2, 0]
+  // params = [[[1, 2]], [[3, 4], [5, 6]], []]
+  BuildRaggedGatherToTensorGraph<int32>(
+      {1, 2, 0},                      // indices
+      {0, 1, 3, 3},                   // params_splits
+      TensorShape({3, 2}),            // params_dense_values.shape
+      {1, 2, 3, 4, 5, 6},             // params_dense_values
+      TensorShape({3}), {-1, -1, 2},  // shape
+      TensorShape({2}), {9, 8});      // default_value
+
+  TF_ASSERT_OK(RunOpKernel());
+
+  test::ExpectTensorEqual<int32>(
+      *GetOutput(0), test::AsTensor<int32>({3, 4, 5, 6, 9, 8, 9, 8,  //
+                                            1, 2, 9, 8},
+                                           TensorShape({3, 2, 2})));
+}
+
+TEST_F(RaggedGatherToTensorOpTest, OutOfBounds) {
+  BuildRaggedGatherToTensorGraph<float>(
+      {2, 10},                               // indices
+      {0, 3, 3, 7, 9},                       // params_splits
+      TensorShape({9}),                      // params_dense_values.shape
+      {.1, .2, .3, .4, .5, .6, .7, .8, .9},  // params_dense_values
+      TensorShape({}), {-1},                 // shape
+      TensorShape({}), {0});                 // default_value
+
+  EXPECT_EQ("indices[1] = 10 is not in [0, 4)", RunOpKernel().message());
+}
+
+}  // namespace
+}  // namespace tensorflow
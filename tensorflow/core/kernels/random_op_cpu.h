@@ -21,6 +21,7 @@ limitations under the License.
 #include <algorithm>
 #include <cmath>
 #include <memory>
+#include <type_traits>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -72,6 +73,31 @@ struct FillPhiloxRandom {
   }
 };
 
+// A generator that returns the same samples as the PhiloxRandom it wraps, but
+// computes them PhiloxRandom::kBatchSize at a time with GenerateBatch(). The
+// wrapped generator is advanced past the samples buffered so far.
+class BatchedPhiloxRandom {
+ public:
+  using ResultType = PhiloxRandom::ResultType;
+  using ResultElementType = PhiloxRandom::ResultElementType;
+  static constexpr int kResultElementCount = PhiloxRandom::kResultElementCount;
+
+  explicit BatchedPhiloxRandom(PhiloxRandom* gen) : gen_(gen) {}
+
+  ResultType operator()() {
+    if (next_ == PhiloxRandom::kBatchSize) {
+      gen_->GenerateBatch(samples_, PhiloxRandom::kBatchSize);
+      next_ = 0;
+    }
+    return samples_[next_++];
+  }
+
+ private:
+  PhiloxRandom* gen_;
+  ResultType samples_[PhiloxRandom::kBatchSize];
+  int next_ = PhiloxRandom::kBatchSize;
+};
+
 // A class to fill a specified range of random groups
 template <class Distribution, bool VariableSamplesPerOutput>
 struct FillPhiloxRandomTask;
@@ -83,15 +109,28 @@ struct FillPhiloxRandomTask<Distribution, false> {
   typedef typename Distribution::ResultElementType T;
   static void Run(random::PhiloxRandom gen, T* data, int64_t size,
                   int64_t start_group, int64_t limit_group, Distribution dist) {
-    const int kGroupSize = Distribution::kResultElementCount;
-
     gen.Skip(start_group);
+    // Each group takes a single sample of the generator, so the samples can
+    // be computed in batches whenever the distribution accepts them.
+    if constexpr (std::is_invocable_v<Distribution&, BatchedPhiloxRandom*>) {
+      BatchedPhiloxRandom batched_gen(&gen);
+      Fill(&batched_gen, data, size, start_group, limit_group, dist);
+    } else {
+      Fill(&gen, data, size, start_group, limit_group, dist);
+    }
+  }
+
+ private:
+  template <class Generator>
+  static void Fill(Generator* gen, T* data, int64_t size, int64_t start_group,
+                   int64_t limit_group, Distribution& dist) {
+    const int kGroupSize = Distribution::kResultElementCount;
     int64_t offset = start_group * kGroupSize;
 
     // First fill all the full-size groups
     int64_t limit_group_full = std::min(limit_group, size / kGroupSize);
     for (int64_t index = start_group; index < limit_group_full; ++index) {
-      auto samples = dist(&gen);
+      auto samples = dist(gen);
       std::copy(&samples[0], &samples[0] + kGroupSize, data + offset);
       offset += kGroupSize;
     }
@@ -99,7 +138,7 @@ struct FillPhiloxRandomTask<Distribution, false> {
     // If there are any remaining elements that need to be filled, process them
     if (limit_group_full < limit_group) {
       int64_t remaining_size = size - limit_group_full * kGroupSize;
-      auto samples = dist(&gen);
+      auto samples = dist(gen);
       std::copy(&samples[0], &samples[0] + remaining_size, data + offset);
     }
   }
@@ -57,6 +57,7 @@ limitations under the License.
 #include "tensorflow/core/platform/stream_executor.h"
 #endif
 
+#include <algorithm>
 #include <memory>
 #include <type_traits>
 #include <vector>
@@ -204,11 +205,25 @@ void ReadVariablesOp::Compute(OpKernelContext* ctx) {
                   "found uninitialized: ",
                   absl::StrJoin(uninitialized_vars, ", ")));
 
+  // We're acquiring references to the underlying buffers while holding shared
+  // locks to guarantee ordering of reads and writes. The locks of all the
+  // variables are acquired at once, in address order like in
+  // MaybeLockVariableInputMutexesInOrder() to avoid deadlocks, so that the
+  // outputs are a consistent snapshot and each variable is locked once.
+  std::vector<mutex*> mutexes;
+  mutexes.reserve(variables.size());
+  for (const auto& variable : variables) {
+    mutexes.push_back(variable->mu());
+  }
+  std::sort(mutexes.begin(), mutexes.end());
+  mutexes.erase(std::unique(mutexes.begin(), mutexes.end()), mutexes.end());
+  std::vector<tf_shared_lock> locks;
+  locks.reserve(mutexes.size());
+  for (mutex* mu : mutexes) {
+    locks.emplace_back(*mu);
+  }
+
   for (size_t i = 0; i < dtypes_.size(); ++i) {
-    // We're acquiring a reference to the underlying buffer while
-    // holding a shared lock to guarantee ordering of reads and
-    // writes.
-    tf_shared_lock ml(*variables[i]->mu());
     OP_REQUIRES(ctx, dtypes_[i] == variables[i]->tensor()->dtype(),
                 errors::InvalidArgument(
                     "Trying to read variable ", handles[i]->name(),
@@ -0,0 +1,113 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/resource_handle.h"
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class ReadVariablesOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(int num_variables) {
+    TF_ASSERT_OK(NodeDefBuilder("read_variables", "_ReadVariablesOp")
+                     .Input(FakeInput(num_variables, DT_RESOURCE))
+                     .Attr("dtypes", DataTypeVector(num_variables, DT_FLOAT))
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  // Adds an input for a new float variable holding `value`, and returns the
+  // variable, which the input owns.
+  Var* AddVariable(float value) {
+    Var* var = new Var(DT_FLOAT);
+    *var->tensor() = test::AsScalar<float>(value);
+    var->is_initialized = true;
+    AddInputFromArray<ResourceHandle>(
+        TensorShape({}), {ResourceHandle::MakeRefCountingHandle(
+                             var, device_->name(), {}, {})});
+    return var;
+  }
+};
+
+TEST_F(ReadVariablesOpTest, ReadsVariables) {
+  MakeOp(2);
+  AddVariable(1.0f);
+  AddVariable(2.0f);
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<float>(*GetOutput(0), test::AsScalar<float>(1.0f));
+  test::ExpectTensorEqual<float>(*GetOutput(1), test::AsScalar<float>(2.0f));
+}
+
+TEST_F(ReadVariablesOpTest, ReadsVariableTwice) {
+  MakeOp(2);
+  AddVariable(1.0f);
+  // The same variable is locked once.
+  AddInputFromArray<ResourceHandle>(
+      TensorShape({}), {inputs_[0].tensor->scalar<ResourceHandle>()()});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<float>(*GetOutput(0), test::AsScalar<float>(1.0f));
+  test::ExpectTensorEqual<float>(*GetOutput(1), test::AsScalar<float>(1.0f));
+}
+
+TEST_F(ReadVariablesOpTest, LocksAllVariablesAtOnce) {
+  MakeOp(2);
+  Var* a = AddVariable(1.0f);
+  Var* b = AddVariable(2.0f);
+  // The variables are locked in mutex address order.
+  Var* locked_first = a->mu() < b->mu() ? a : b;
+  Var* locked_second = a->mu() < b->mu() ? b : a;
+
+  // While a writer holds the variable locked second, the kernel must keep the
+  // variable it locked first locked.
+  locked_second->mu()->lock();
+  Status status;
+  std::unique_ptr<Thread> reader(Env::Default()->StartThread(
+      {}, "reader", [this, &status]() { status = RunOpKernel(); }));
+  bool held_by_reader = false;
+  for (int i = 0; i < 10000 && !held_by_reader; ++i) {
+    if (locked_first->mu()->try_lock()) {
+      locked_first->mu()->unlock();
+      Env::Default()->SleepForMicroseconds(1000);
+    } else {
+      held_by_reader = true;
+    }
+  }
+  EXPECT_TRUE(held_by_reader);
+  *locked_second->tensor() = test::AsScalar<float>(-1.0f);
+  locked_second->mu()->unlock();
+  reader.reset();
+
+  TF_ASSERT_OK(status);
+  // The variable locked second is read after the write.
+  const int first_index = locked_first == a ? 0 : 1;
+  test::ExpectTensorEqual<float>(
+      *GetOutput(first_index),
+      test::AsScalar<float>(locked_first == a ? 1.0f : 2.0f));
+  test::ExpectTensorEqual<float>(*GetOutput(1 - first_index),
+                                 test::AsScalar<float>(-1.0f));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -22,6 +22,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
@@ -294,6 +295,15 @@ struct RestoreOp {
     status = run(&reader);
   }
 
+  // Allocates the output for restoring the full tensor, which is then read by
+  // BundleReader::LookupMany(). REQUIRES: shape_and_slice.empty()
+  Status allocate_full_output(BundleReader* reader, Tensor** restored_tensor) {
+    TensorShape restored_full_shape;
+    TF_RETURN_IF_ERROR(
+        reader->LookupTensorShape(tensor_name, &restored_full_shape));
+    return context->allocate_output(idx, restored_full_shape, restored_tensor);
+  }
+
   Status run(BundleReader* reader) {
     TensorShape restored_full_shape;
     TF_RETURN_IF_ERROR(
@@ -456,9 +466,35 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
       }
     }
 
-    // Read small tensors from the op thread.
+    // Read slices of small tensors from the op thread, and the full small
+    // tensors together, with coalesced reads that run concurrently.
+    std::vector<string> small_tensor_names;
+    std::vector<Tensor*> small_tensors;
     for (auto* op : small_restore_ops) {
-      TF_RETURN_IF_ERROR(op->run(&default_reader));
+      if (!op->shape_and_slice.empty()) {
+        TF_RETURN_IF_ERROR(op->run(&default_reader));
+        continue;
+      }
+      Tensor* restored_tensor;
+      TF_RETURN_IF_ERROR(
+          op->allocate_full_output(&default_reader, &restored_tensor));
+      small_tensor_names.push_back(op->tensor_name);
+      small_tensors.push_back(restored_tensor);
+    }
+    if (!small_tensors.empty()) {
+      // Reads on the intra-op pool of the device rather than `reader_pool`,
+      // so that the small reads do not queue behind the large restore ops.
+      // If this thread is itself one of the pool's workers, the reads run here
+      // instead, since waiting on the pool could then deadlock.
+      BundleReader::LookupManyOptions options;
+      const DeviceBase::CpuWorkerThreads* worker_threads =
+          context->device()->tensorflow_cpu_worker_threads();
+      if (small_tensors.size() > 1 &&
+          worker_threads->workers->CurrentThreadId() == -1) {
+        options.pool = worker_threads->workers;
+      }
+      TF_RETURN_IF_ERROR(default_reader.LookupMany(small_tensor_names,
+                                                   small_tensors, options));
     }
 
     // Wait for all scheduled work to finish and check the status of all
@@ -16,7 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_SCATTER_FUNCTOR_H_
 #define TENSORFLOW_CORE_KERNELS_SCATTER_FUNCTOR_H_
 
+#include <algorithm>
 #include <type_traits>
+#include <vector>
 
 #include "Eigen/Core"  // from @eigen_archive
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
@@ -26,7 +28,6 @@ limitations under the License.
 #include "tensorflow/core/framework/variant_op_registry.h"
 #include "tensorflow/core/kernels/dense_update_functor.h"
 #include "tensorflow/core/platform/types.h"
-#include "tensorflow/core/util/determinism.h"
 #include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
@@ -138,46 +139,60 @@ struct ScatterFunctor {
 
 template <typename Device, typename T, typename Index, scatter_op::UpdateOp op>
 struct ScatterFunctorBase {
+  // Splits the rows of params into contiguous ranges and applies the updates
+  // of every range on one thread, so that no two threads write the same row.
+  // The updates are bucketed by range with a stable counting sort, so every
+  // row sees its updates in the same order as in SerialExecute and the result
+  // does not depend on the scheduling.
   Index ParallelExecute(OpKernelContext* c, const Device& d,
                         typename TTypes<T>::Matrix params,
                         typename TTypes<T>::ConstMatrix updates,
                         typename TTypes<Index>::ConstFlat indices) {
     const Index N = static_cast<Index>(indices.size());
     const Index limit = static_cast<Index>(params.dimension(0));
-    const Index kMaxLocks = 1024;
-    const Index entries_per_lock = (limit + kMaxLocks - 1) / kMaxLocks;
-    // To reduce the number of locks and the memory usage, we divide the whole
-    // index space into kMaxLocks regions with each lock serializing access to
-    // a region.
-    mutex accessed[kMaxLocks];
-    std::atomic<Index> bad_index(-1);
-    auto ParallelScatter = [&](Index start, Index end) {
-      for (Index i = start; i < end; ++i) {
-        // Grab the index and check its validity.  Do this carefully,
-        // to avoid checking the value and grabbing it again from
-        // memory a second time (a security risk since it may change in
-        // between).
-        const Index index = ::tensorflow::internal::SubtleMustCopy(indices(i));
-        if (!FastBoundsCheck(index, limit)) {
-          bad_index = i;
-          return;
-        }
-        const Index lock_id = index / entries_per_lock;
-        // Copy last Ndim-1 dimensions of updates[i] to params[index]
-        {
-          mutex_lock l(accessed[lock_id]);
-          scatter_op::internal::Assign<op>::Run(params.template chip<0>(index),
-                                                updates.template chip<0>(i));
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *(c->device()->tensorflow_cpu_worker_threads());
+    const Index num_ranges = std::max<Index>(
+        1, std::min<Index>(limit, 4 * worker_threads.num_threads));
+    const Index rows_per_range = (limit + num_ranges - 1) / num_ranges;
+
+    // Grab the indices and check their validity.  Do this carefully,
+    // to avoid checking a value and grabbing it again from memory a
+    // second time (a security risk since it may change in between).
+    std::vector<Index> safe_indices(N);
+    std::vector<Index> range_starts(num_ranges + 1, 0);
+    for (Index i = 0; i < N; ++i) {
+      const Index index = ::tensorflow::internal::SubtleMustCopy(indices(i));
+      if (!FastBoundsCheck(index, limit)) return i;
+      safe_indices[i] = index;
+      ++range_starts[index / rows_per_range + 1];
+    }
+    for (Index r = 0; r < num_ranges; ++r) {
+      range_starts[r + 1] += range_starts[r];
+    }
+    std::vector<Index> order(N);
+    std::vector<Index> next(range_starts.begin(), range_starts.end() - 1);
+    for (Index i = 0; i < N; ++i) {
+      order[next[safe_indices[i] / rows_per_range]++] = i;
+    }
+
+    auto ParallelScatter = [&](int64_t start, int64_t end) {
+      for (Index r = start; r < end; ++r) {
+        for (Index k = range_starts[r]; k < range_starts[r + 1]; ++k) {
+          const Index i = order[k];
+          // Copy last Ndim-1 dimensions of updates[i] to params[index]
+          scatter_op::internal::Assign<op>::Run(
+              params.template chip<0>(safe_indices[i]),
+              updates.template chip<0>(i));
         }
       }
     };
     const float kMovingCost = 2.5f;
-    float shard_cost = kMovingCost * params.dimension(1);
-    const DeviceBase::CpuWorkerThreads& worker_threads =
-        *(c->device()->tensorflow_cpu_worker_threads());
-    Shard(worker_threads.num_threads, worker_threads.workers, N, shard_cost,
-          ParallelScatter);  // TODO: Come up with a good cost estimate.
-    return bad_index;
+    const float shard_cost =
+        kMovingCost * params.dimension(1) * (N / num_ranges + 1);
+    Shard(worker_threads.num_threads, worker_threads.workers, num_ranges,
+          shard_cost, ParallelScatter);
+    return -1;
   }
   Index SerialExecute(OpKernelContext* c, const Device& d,
                       typename TTypes<T>::Matrix params,
@@ -203,32 +218,23 @@ struct ScatterFunctorBase {
                    typename TTypes<T>::Matrix params,
                    typename TTypes<T>::ConstMatrix updates,
                    typename TTypes<Index>::ConstFlat indices) {
-#ifdef PLATFORM_GOOGLE
-    // The parallel version is significantly slower internally. Only call the
-    // serial version for now.
-    // TODO(penporn): Avoid locking in parallelization (sort beforehand).
-    return SerialExecute(c, d, params, updates, indices);
-#else
     // indices and params sizes were validated in DoCompute().
     const Index N = static_cast<Index>(indices.size());
     const Index limit = static_cast<Index>(params.dimension(0));
     const Index min_n_threshold = 1024;
     const Index ser_par_ratio = 10000;
-    // For parallelizing the updates, duplicate entries need to be handled
-    // correctly. Multiple updates to the same index has to be serialized.
-    // This can lead to lock contention which may nullify the benefits of
-    // parallelization. Assuming uniform random distribution of the indices, we
-    // come up with a rough heuristic and determine whether the updates execute
-    // serially or parallelly. Also if 'N' is small, overheads of parallel
-    // execution outweigh its benefits and hence we check the value of N.
-    const bool execute_serial = N < min_n_threshold ||
-                                (N / limit) > ser_par_ratio ||
-                                OpDeterminismRequired();
+    // The parallel version gives every thread a range of rows, so it does not
+    // help when the updates go to a few rows only. Assuming uniform random
+    // distribution of the indices, we come up with a rough heuristic and
+    // determine whether the updates execute serially or parallelly. Also if
+    // 'N' is small, overheads of parallel execution outweigh its benefits and
+    // hence we check the value of N.
+    const bool execute_serial =
+        N < min_n_threshold || (N / limit) > ser_par_ratio;
     if (execute_serial)
       return SerialExecute(c, d, params, updates, indices);
     else
       return ParallelExecute(c, d, params, updates, indices);
-#endif  // PLATFORM_GOOGLE
   }
 };
 
@@ -20,7 +20,9 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <atomic>
+#include <vector>
 
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 
@@ -105,6 +107,81 @@ namespace functor {
 // Implementation of update functor for CPU.
 template <typename T, typename Index, scatter_nd_op::UpdateOp OP, int IXDIM>
 struct ScatterNdFunctor<CPUDevice, T, Index, OP, IXDIM> {
+  // Below this many updates, or when the updates go to few rows, the updates
+  // are applied one after another.
+  static constexpr Eigen::DenseIndex kMinUpdatesToScatterInParallel = 1024;
+  static constexpr Eigen::DenseIndex kMaxUpdatesPerRowToScatterInParallel =
+      10000;
+
+  // Splits the rows of the output into contiguous ranges and applies the
+  // updates of every range on one thread, so that no two threads write the
+  // same row. The updates are bucketed by range with a stable counting sort,
+  // so every row sees its updates in the same order as in the serial loop.
+  static Index ParallelScatter(
+      const CPUDevice& d, const Index* batch_strides,
+      const Eigen::array<Eigen::DenseIndex, IXDIM>& output_shape_prefix,
+      typename TTypes<Index, 2>::ConstTensor Tindices,
+      typename TTypes<T, 2>::ConstTensor Tupdates,
+      typename TTypes<T, 2>::Tensor Toutput) {
+    const Eigen::DenseIndex batch_size = Tindices.dimension(0);
+    const Eigen::DenseIndex num_rows = Toutput.dimension(0);
+    std::vector<Index> rows(batch_size);
+    for (Eigen::DenseIndex loc = 0; loc < batch_size; ++loc) {
+      Index i = 0;
+      bool out_of_bounds = false;
+      for (int dim = 0; dim < IXDIM; ++dim) {
+        const Index ix_d = internal::SubtleMustCopy(Tindices(loc, dim));
+        out_of_bounds |= !FastBoundsCheck(ix_d, output_shape_prefix[dim]);
+        i += ix_d * batch_strides[dim];
+      }
+      if (TF_PREDICT_FALSE(out_of_bounds)) return loc;
+      rows[loc] = i;
+    }
+
+    const Eigen::DenseIndex num_ranges =
+        std::min<Eigen::DenseIndex>(num_rows, 4 * d.numThreads());
+    const Eigen::DenseIndex rows_per_range =
+        (num_rows + num_ranges - 1) / num_ranges;
+    std::vector<Eigen::DenseIndex> range_starts(num_ranges + 1, 0);
+    for (const Index row : rows) ++range_starts[row / rows_per_range + 1];
+    for (Eigen::DenseIndex r = 0; r < num_ranges; ++r) {
+      range_starts[r + 1] += range_starts[r];
+    }
+    std::vector<Eigen::DenseIndex> order(batch_size);
+    std::vector<Eigen::DenseIndex> next(range_starts.begin(),
+                                        range_starts.end() - 1);
+    for (Eigen::DenseIndex loc = 0; loc < batch_size; ++loc) {
+      order[next[rows[loc] / rows_per_range]++] = loc;
+    }
+
+    // The ranges run on the threads of d, so every update runs on the
+    // calling thread.
+    const Eigen::DefaultDevice range_device;
+    const Eigen::DenseIndex slice_size = Toutput.dimension(1);
+    d.parallelFor(
+        num_ranges,
+        Eigen::TensorOpCost(batch_size / num_ranges * slice_size * sizeof(T),
+                            batch_size / num_ranges * slice_size * sizeof(T),
+                            batch_size / num_ranges * slice_size),
+        [&](Eigen::DenseIndex start, Eigen::DenseIndex end) {
+          for (Eigen::DenseIndex r = start; r < end; ++r) {
+            for (Eigen::DenseIndex k = range_starts[r];
+                 k < range_starts[r + 1]; ++k) {
+              const Eigen::DenseIndex loc = order[k];
+              auto input_chip = Toutput.template chip<0>(rows[loc]);
+              auto output_chip = input_chip;
+              auto update_chip = Tupdates.template chip<0>(loc);
+              update_executor::UpdateExecutor<
+                  Eigen::DefaultDevice, decltype(input_chip),
+                  decltype(update_chip), decltype(output_chip),
+                  OP>::Execute(range_device, input_chip, update_chip,
+                               output_chip);
+            }
+          }
+        });
+    return -1;
+  }
+
   Index operator()(
       const CPUDevice& d, const Index slice_size,
       const Eigen::array<Eigen::DenseIndex, IXDIM> output_shape_prefix,
@@ -127,6 +204,14 @@ struct ScatterNdFunctor<CPUDevice, T, Index, OP, IXDIM> {
           batch_strides[dim + 1] * output_shape_prefix[dim + 1];
     }
 
+    const Eigen::DenseIndex num_rows = Toutput.dimension(0);
+    if (batch_size >= kMinUpdatesToScatterInParallel && d.numThreads() > 1 &&
+        num_rows > 0 &&
+        batch_size / num_rows <= kMaxUpdatesPerRowToScatterInParallel) {
+      return ParallelScatter(d, batch_strides, output_shape_prefix, Tindices,
+                             Tupdates, Toutput);
+    }
+
     for (Eigen::DenseIndex loc = 0; loc < batch_size; ++loc) {
       Index i = 0;
       bool out_of_bounds = false;
@@ -174,6 +174,35 @@ TEST_F(ScatterNdUpdateOpTest, HigherRank) {
   test::ExpectTensorEqual<float>(expected, params_tensor);
 }
 
+TEST_F(ScatterNdUpdateOpTest, ManyDuplicateIndices_LastUpdateWins) {
+  // Enough updates to run in parallel; every row gets 100 of them.
+  MakeOp(DT_FLOAT_REF, DT_INT32);
+  const int kRows = 50;
+  const int kCols = 3;
+  const int kNumUpdates = 5000;
+  std::vector<int32> indices(kNumUpdates);
+  std::vector<float> updates(kNumUpdates * kCols);
+  for (int i = 0; i < kNumUpdates; ++i) {
+    indices[i] = (i * 7) % kRows;
+    for (int j = 0; j < kCols; ++j) updates[i * kCols + j] = i * kCols + j;
+  }
+  AddInputFromArray<float>(TensorShape({kRows, kCols}),
+                           std::vector<float>(kRows * kCols, -1));
+  AddInputFromArray<int32>(TensorShape({kNumUpdates, 1}), indices);
+  AddInputFromArray<float>(TensorShape({kNumUpdates, kCols}), updates);
+  TF_ASSERT_OK(RunOpKernel());
+
+  std::vector<float> expected(kRows * kCols);
+  for (int i = 0; i < kNumUpdates; ++i) {
+    for (int j = 0; j < kCols; ++j) {
+      expected[indices[i] * kCols + j] = updates[i * kCols + j];
+    }
+  }
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>(expected, {kRows, kCols}),
+      *mutable_input(0).tensor);
+}
+
 TEST_F(ScatterNdUpdateOpTest, Error_IndexOutOfRange) {
   MakeOp(DT_FLOAT_REF, DT_INT32);
 
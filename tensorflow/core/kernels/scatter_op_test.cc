@@ -47,6 +47,17 @@ class ScatterUpdateOpTest : public OpsTestBase {
     TF_ASSERT_OK(InitOp());
   }
 };
+class ScatterAddOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(DataType variable_ref_type, DataType index_type) {
+    TF_ASSERT_OK(NodeDefBuilder("myop", "ScatterAdd")
+                     .Input(FakeInput(variable_ref_type))
+                     .Input(FakeInput(index_type))
+                     .Input(FakeInput(RemoveRefType(variable_ref_type)))
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
 class ScatterSubOpTest : public OpsTestBase {
  protected:
   void MakeOp(DataType variable_ref_type, DataType index_type) {
@@ -217,6 +228,40 @@ TEST_F(ScatterSubOpTest, StressIndexTest) {
   test::ExpectTensorEqual<int32>(expected, params_tensor);
 }
 
+TEST_F(ScatterAddOpTest, ManyDuplicateIndices_SameAsSerialSum) {
+  // Enough updates to run in parallel; every row gets 100 of them. The
+  // updates are not exactly representable sums, so any change in the order
+  // in which a row receives its updates changes the result.
+  MakeOp(DT_FLOAT_REF, DT_INT32);
+  const int kRows = 50;
+  const int kCols = 3;
+  const int kNumUpdates = 5000;
+  std::vector<int32> indices(kNumUpdates);
+  std::vector<float> updates(kNumUpdates * kCols);
+  for (int i = 0; i < kNumUpdates; ++i) {
+    indices[i] = (i * 7) % kRows;
+    for (int j = 0; j < kCols; ++j) {
+      updates[i * kCols + j] = 1.0f / (i * kCols + j + 1);
+    }
+  }
+  std::vector<float> params(kRows * kCols);
+  for (int i = 0; i < kRows * kCols; ++i) params[i] = 1e4f + i;
+  AddInputFromArray<float>(TensorShape({kRows, kCols}), params);
+  AddInputFromArray<int32>(TensorShape({kNumUpdates}), indices);
+  AddInputFromArray<float>(TensorShape({kNumUpdates, kCols}), updates);
+  TF_ASSERT_OK(RunOpKernel());
+
+  std::vector<float> expected = params;
+  for (int i = 0; i < kNumUpdates; ++i) {
+    for (int j = 0; j < kCols; ++j) {
+      expected[indices[i] * kCols + j] += updates[i * kCols + j];
+    }
+  }
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>(expected, {kRows, kCols}),
+      *mutable_input(0).tensor);
+}
+
 TEST_F(ScatterUpdateOpTest, Error_WrongDimsIndices) {
   MakeOp(DT_FLOAT_REF, DT_INT32);
 
@@ -18,7 +18,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_SEGMENT_REDUCTION_OPS_IMPL_H_
 #define TENSORFLOW_CORE_KERNELS_SEGMENT_REDUCTION_OPS_IMPL_H_
 
+#include <algorithm>
 #include <cstdint>
+#include <vector>
 
 #include "tensorflow/core/framework/op_requires.h"
 #include "tensorflow/core/platform/types.h"
@@ -41,8 +43,10 @@ limitations under the License.
 #include "tensorflow/core/kernels/segment_reduction_ops.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/determinism.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
@@ -612,61 +616,89 @@ class SparseSegmentReductionOpBase : public OpKernel {
     }
     auto temp_flat = temp.flat_outer_dims<float>();
 
-    int64_t start = 0, end = 1;
-    // Index from which the output is not initialized.
-    SegmentId uninitialized_index = 0;
-    SegmentId out_index = internal::SubtleMustCopy(segment_vec(start));
-
-    while (true) {
-      // We initialize next_index to 0 to avoid "warning: 'next_index' may be
-      // used uninitialized in this function" in the Mac build (since the
-      // compiler isn't smart enough to realize the code is safe).
+    // Validate the segment ids and record where each segment starts in
+    // `indices`, so that the reduction below can be split evenly over the
+    // indices rather than over the segments.
+    std::vector<SegmentId> segment_ids_present;
+    std::vector<int64_t> segment_starts;
+    SegmentId out_index = internal::SubtleMustCopy(segment_vec(0));
+    for (int64_t i = 0; i <= num_indices; ++i) {
       SegmentId next_index = 0;
-      if (end < num_indices) {
-        next_index = internal::SubtleMustCopy(segment_vec(end));
-        if (out_index == next_index) {
-          ++end;
-          continue;
-        }
+      if (i < num_indices) {
+        next_index = internal::SubtleMustCopy(segment_vec(i));
+        if (i > 0 && out_index == next_index) continue;
         // We have a new segment here.  Verify that the segment ids are growing.
-        OP_REQUIRES(context, out_index < next_index,
+        OP_REQUIRES(context, i == 0 || out_index < next_index,
                     errors::InvalidArgument("segment ids are not increasing"));
       }
-
-      OP_REQUIRES(
-          context, FastBoundsCheck(out_index, output_rows),
-          errors::InvalidArgument(
-              "Segment id ", out_index, " out of range [0, ", output_rows,
-              "), possibly because 'segment_ids' input is not sorted."));
-
-      // If there is a gap between two indices, we need to set that gap to the
-      // default value.
-      if (out_index > uninitialized_index) {
-        Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
-            out_index - uninitialized_index, num_col);
-        Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>, Eigen::Unaligned>
-            gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
-        gap_slice.setConstant(default_value_);
+      if (i > 0) {
+        OP_REQUIRES(
+            context, FastBoundsCheck(out_index, output_rows),
+            errors::InvalidArgument(
+                "Segment id ", out_index, " out of range [0, ", output_rows,
+                "), possibly because 'segment_ids' input is not sorted."));
+        segment_ids_present.push_back(out_index);
       }
-
-      auto out = output_flat.template chip<0>(out_index);
-      auto temp = temp_flat.template chip<0>(out_index);
-      const int bad_offset = Reduce<T, Index>(input_flat, indices_vec, start,
-                                              end - start, out, temp);
-      OP_REQUIRES(context, bad_offset < 0,
-                  errors::InvalidArgument(
-                      "Bad: indices[", start + bad_offset,
-                      "] == ", indices_vec(start + bad_offset),
-                      " out of range [0, ", input_flat.dimension(0), ")"));
-
-      start = end;
-      ++end;
-      uninitialized_index = out_index + 1;
+      segment_starts.push_back(i);
       out_index = next_index;
-      if (end > num_indices) break;
     }
+    const int64_t num_segments = segment_ids_present.size();
+
+    mutex mu;
+    // Smallest position in `indices` holding an out of range index.
+    int64_t bad_position = num_indices;
+
+    // Reduces the segments that start in [begin, end) of `indices`, and fills
+    // the gap before each of them with the default value.
+    auto reduce_segments = [&](int64_t begin, int64_t end) {
+      const auto starts_end = segment_starts.begin() + num_segments;
+      const int64_t first =
+          std::lower_bound(segment_starts.begin(), starts_end, begin) -
+          segment_starts.begin();
+      const int64_t last =
+          std::lower_bound(segment_starts.begin(), starts_end, end) -
+          segment_starts.begin();
+      for (int64_t s = first; s < last; ++s) {
+        const SegmentId segment_id = segment_ids_present[s];
+        const SegmentId gap_start = s == 0 ? 0 : segment_ids_present[s - 1] + 1;
+        // If there is a gap between two indices, we need to set that gap to
+        // the default value.
+        if (segment_id > gap_start) {
+          Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
+              segment_id - gap_start, num_col);
+          Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>,
+                           Eigen::Unaligned>
+              gap_slice(&output_flat(gap_start, 0), gap_slice_shape);
+          gap_slice.setConstant(default_value_);
+        }
+
+        const int64_t start = segment_starts[s];
+        auto out = output_flat.template chip<0>(segment_id);
+        auto temp_out = temp_flat.template chip<0>(segment_id);
+        const int bad_offset =
+            Reduce<T, Index>(input_flat, indices_vec, start,
+                             segment_starts[s + 1] - start, out, temp_out);
+        if (bad_offset >= 0) {
+          mutex_lock lock(mu);
+          bad_position = std::min(bad_position, start + bad_offset);
+          return;
+        }
+      }
+    };
+    // Each index adds one row of `num_col` values.
+    const int64_t cost_per_index = num_col;
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_indices,
+          cost_per_index, reduce_segments);
+    OP_REQUIRES(context, bad_position == num_indices,
+                errors::InvalidArgument(
+                    "Bad: indices[", bad_position,
+                    "] == ", indices_vec(bad_position), " out of range [0, ",
+                    input_flat.dimension(0), ")"));
 
     // Fill the gap at the end with the default value.
+    const SegmentId uninitialized_index =
+        segment_ids_present[num_segments - 1] + 1;
     if (uninitialized_index < output_rows) {
       Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
           output_rows - uninitialized_index, num_col);
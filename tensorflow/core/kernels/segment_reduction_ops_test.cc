@@ -181,6 +181,58 @@ BM_Reduce_Arg(64, 32, 2);
 BM_Reduce_Arg(4096, 32, 2);
 BM_Reduce_Arg(4096, 128, 2);
 
+template <DataType T>
+static void SparseSegmentSumHelper(::testing::benchmark::State& state) {
+  typedef typename EnumToDataType<T>::Type DT;
+  const int num_indices = state.range(0);
+  const int num_cols = state.range(1);
+  const int kNumRows = 100000;
+  const int kAverageSegmentSize = 20;
+
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor input(T, TensorShape({kNumRows, num_cols}));
+  input.flat<DT>().setRandom();
+  Tensor indices(DT_INT32, TensorShape({num_indices}));
+  auto indices_flat = indices.flat<int32>();
+  Tensor segment_ids(DT_INT32, TensorShape({num_indices}));
+  auto segment_ids_flat = segment_ids.flat<int32>();
+  for (int i = 0; i < num_indices; ++i) {
+    indices_flat(i) = (i * 7919) % kNumRows;
+    segment_ids_flat(i) = i / kAverageSegmentSize;
+  }
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "SparseSegmentSum")
+                  .Input(test::graph::Constant(g, input))
+                  .Input(test::graph::Constant(g, indices))
+                  .Input(test::graph::Constant(g, segment_ids))
+                  .Attr("T", T)
+                  .Finalize(g, &node));
+
+  test::Benchmark("cpu", g, /*old_benchmark_api*/ false).Run(state);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          num_indices * num_cols * sizeof(DT));
+}
+
+static void BM_SparseSegmentSum_FP32(::testing::benchmark::State& state) {
+  SparseSegmentSumHelper<DT_FLOAT>(state);
+}
+
+static void BM_SparseSegmentSum_BF16(::testing::benchmark::State& state) {
+  SparseSegmentSumHelper<DT_BFLOAT16>(state);
+}
+
+BENCHMARK(BM_SparseSegmentSum_FP32)
+    ->UseRealTime()
+    ->ArgPair(1000, 64)
+    ->ArgPair(100000, 64)
+    ->ArgPair(100000, 256);
+BENCHMARK(BM_SparseSegmentSum_BF16)
+    ->UseRealTime()
+    ->ArgPair(1000, 64)
+    ->ArgPair(100000, 64)
+    ->ArgPair(100000, 256);
+
 template <DataType T>
 static void SparseSegmentMeanGradHelper(::testing::benchmark::State& state,
                                         float uniqueness, int size) {
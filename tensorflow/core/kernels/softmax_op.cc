@@ -18,6 +18,9 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/str_util.h"
 #define EIGEN_USE_THREADS
 
+#include <cmath>
+
+#include "Eigen/Core"  // from @eigen_archive
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -43,6 +46,51 @@ struct SoftmaxFunctorBase {
 template <typename T>
 struct SoftmaxFunctor<CPUDevice, T> : SoftmaxFunctorBase<CPUDevice, T> {};
 
+// Row by row CPU implementation for the 16-bit floating point types. Every row
+// is converted to float once, so that exp runs on Eigen's vectorized float
+// path and the sum is accumulated in float, and is then rounded back to T.
+template <typename T>
+struct Softmax16BitCpuFunctor {
+  void operator()(const CPUDevice& d, typename TTypes<T>::ConstMatrix logits,
+                  typename TTypes<T>::Matrix softmax, const bool log) {
+    const Eigen::Index batch_size = logits.dimension(0);
+    const Eigen::Index num_classes = logits.dimension(1);
+    const Eigen::TensorOpCost cost(
+        num_classes * sizeof(T), num_classes * sizeof(T),
+        num_classes *
+            (Eigen::internal::functor_traits<
+                 Eigen::internal::scalar_exp_op<float>>::Cost +
+             4));
+    d.parallelFor(
+        batch_size, cost, [&](Eigen::Index first, Eigen::Index last) {
+          Eigen::ArrayXf row(num_classes);
+          for (Eigen::Index b = first; b < last; ++b) {
+            const T* in = logits.data() + b * num_classes;
+            T* out = softmax.data() + b * num_classes;
+            for (Eigen::Index i = 0; i < num_classes; ++i) {
+              row(i) = static_cast<float>(in[i]);
+            }
+            row -= row.maxCoeff();
+            if (log) {
+              row -= std::log(row.exp().sum());
+            } else {
+              row = row.exp();
+              row *= 1.0f / row.sum();
+            }
+            for (Eigen::Index i = 0; i < num_classes; ++i) {
+              out[i] = static_cast<T>(row(i));
+            }
+          }
+        });
+  }
+};
+template <>
+struct SoftmaxFunctor<CPUDevice, bfloat16>
+    : Softmax16BitCpuFunctor<bfloat16> {};
+template <>
+struct SoftmaxFunctor<CPUDevice, Eigen::half>
+    : Softmax16BitCpuFunctor<Eigen::half> {};
+
 }  // namespace functor
 
 template <typename Device, typename T>
@@ -0,0 +1,195 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Implements the _FusedSparseSegmentReduceConcat op, which the remapper creates
+// from the SparseSegment{Sum,Mean} ops of a multi-feature embedding lookup
+// whose outputs are concatenated. The rows of each feature are reduced directly
+// into their columns of the output, without intermediate tensors.
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+template <typename T, typename Index, typename SegmentId>
+class FusedSparseSegmentReduceConcatOp : public OpKernel {
+ public:
+  explicit FusedSparseSegmentReduceConcatOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    std::vector<string> combiners;
+    OP_REQUIRES_OK(context, context->GetAttr("combiners", &combiners));
+    int num_inputs;
+    OP_REQUIRES_OK(context, context->GetAttr("N", &num_inputs));
+    OP_REQUIRES(context, static_cast<int>(combiners.size()) == num_inputs,
+                errors::InvalidArgument("Expected ", num_inputs,
+                                        " combiners, got ", combiners.size()));
+    for (const string& combiner : combiners) {
+      OP_REQUIRES(context, combiner == "sum" || combiner == "mean",
+                  errors::InvalidArgument("Unsupported combiner: ", combiner));
+      is_mean_.push_back(combiner == "mean");
+    }
+  }
+
+  void Compute(OpKernelContext* context) override {
+    OpInputList data;
+    OP_REQUIRES_OK(context, context->input_list("data", &data));
+    OpInputList indices;
+    OP_REQUIRES_OK(context, context->input_list("indices", &indices));
+    OpInputList segment_ids;
+    OP_REQUIRES_OK(context, context->input_list("segment_ids", &segment_ids));
+
+    // Like SparseSegment{Sum,Mean}, the number of output rows is given by the
+    // last segment id, and ConcatV2 requires the same number for all inputs.
+    const int num_inputs = data.size();
+    int64_t num_rows = -1;
+    std::vector<int64_t> column_offsets(num_inputs + 1, 0);
+    for (int i = 0; i < num_inputs; ++i) {
+      OP_REQUIRES(context, TensorShapeUtils::IsMatrix(data[i].shape()),
+                  errors::InvalidArgument("data[", i, "] must be a matrix"));
+      OP_REQUIRES(context, TensorShapeUtils::IsVector(indices[i].shape()),
+                  errors::InvalidArgument("indices[", i, "] must be a vector"));
+      OP_REQUIRES(context, indices[i].shape() == segment_ids[i].shape(),
+                  errors::InvalidArgument("segment_ids[", i, "] and indices[",
+                                          i, "] should have same size."));
+      const auto segment_ids_flat = segment_ids[i].flat<SegmentId>();
+      const int64_t input_rows =
+          segment_ids_flat.size() > 0
+              ? static_cast<int64_t>(
+                    segment_ids_flat(segment_ids_flat.size() - 1)) +
+                    1
+              : 0;
+      OP_REQUIRES(context, input_rows >= 0,
+                  errors::InvalidArgument("segment ids must be >= 0"));
+      if (num_rows == -1) num_rows = input_rows;
+      OP_REQUIRES(context, input_rows == num_rows,
+                  errors::InvalidArgument(
+                      "ConcatOp : Dimension 0 in both shapes must be equal: "
+                      "shape[0] = [",
+                      num_rows, "] vs. shape[", i, "] = [", input_rows, "]"));
+      column_offsets[i + 1] = column_offsets[i] + data[i].dim_size(1);
+    }
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0, TensorShape({num_rows, column_offsets[num_inputs]}),
+                       &output));
+    auto output_matrix = output->matrix<T>();
+    output_matrix.setZero();
+    if (num_rows == 0) return;
+
+    // The inputs write disjoint columns of the output, so they are reduced in
+    // parallel.
+    std::vector<Status> statuses(num_inputs);
+    auto reduce = [&](int64_t begin, int64_t end) {
+      std::vector<int64_t> counts;
+      for (int64_t i = begin; i < end; ++i) {
+        statuses[i] = ReduceInput(data[i], indices[i], segment_ids[i],
+                                  is_mean_[i], column_offsets[i], num_rows,
+                                  &counts, &output_matrix);
+      }
+    };
+    int64_t cost_per_input = 0;
+    for (int i = 0; i < num_inputs; ++i) {
+      cost_per_input =
+          std::max(cost_per_input, indices[i].NumElements() *
+                                       data[i].dim_size(1));
+    }
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_inputs,
+          cost_per_input, reduce);
+    for (const Status& status : statuses) {
+      OP_REQUIRES_OK(context, status);
+    }
+  }
+
+ private:
+  static Status ReduceInput(const Tensor& data, const Tensor& indices,
+                            const Tensor& segment_ids, bool is_mean,
+                            int64_t column_offset, int64_t num_rows,
+                            std::vector<int64_t>* counts,
+                            typename TTypes<T>::Matrix* output) {
+    const auto data_matrix = data.matrix<T>();
+    const auto indices_flat = indices.flat<Index>();
+    const auto segment_ids_flat = segment_ids.flat<SegmentId>();
+    const int64_t num_data_rows = data.dim_size(0);
+    const int64_t num_columns = data.dim_size(1);
+    counts->assign(num_rows, 0);
+
+    SegmentId previous_segment = 0;
+    for (int64_t j = 0; j < indices_flat.size(); ++j) {
+      const Index index = indices_flat(j);
+      const SegmentId segment = segment_ids_flat(j);
+      if (index < 0 || index >= num_data_rows) {
+        return errors::InvalidArgument("Bad: indices[", j, "] == ", index,
+                                       " out of range [0, ", num_data_rows,
+                                       ")");
+      }
+      if (segment < previous_segment || segment >= num_rows) {
+        return errors::InvalidArgument("segment ids are not increasing");
+      }
+      previous_segment = segment;
+      for (int64_t k = 0; k < num_columns; ++k) {
+        (*output)(segment, column_offset + k) += data_matrix(index, k);
+      }
+      ++(*counts)[segment];
+    }
+
+    if (is_mean) {
+      for (int64_t row = 0; row < num_rows; ++row) {
+        if ((*counts)[row] <= 1) continue;
+        const T scale = T(1) / static_cast<T>((*counts)[row]);
+        for (int64_t k = 0; k < num_columns; ++k) {
+          (*output)(row, column_offset + k) *= scale;
+        }
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  std::vector<bool> is_mean_;
+};
+
+#define REGISTER_CPU_KERNEL(type, index_type, segment_ids_type)            \
+  REGISTER_KERNEL_BUILDER(                                                 \
+      Name("_FusedSparseSegmentReduceConcat")                              \
+          .Device(DEVICE_CPU)                                              \
+          .TypeConstraint<type>("T")                                       \
+          .TypeConstraint<index_type>("Tidx")                              \
+          .TypeConstraint<segment_ids_type>("Tsegmentids"),                \
+      FusedSparseSegmentReduceConcatOp<type, index_type, segment_ids_type>);
+
+#define REGISTER_CPU_KERNELS_FOR_INDEX_TYPES(type) \
+  REGISTER_CPU_KERNEL(type, int32, int32);         \
+  REGISTER_CPU_KERNEL(type, int32, int64_t);       \
+  REGISTER_CPU_KERNEL(type, int64_t, int32);       \
+  REGISTER_CPU_KERNEL(type, int64_t, int64_t);
+
+TF_CALL_float(REGISTER_CPU_KERNELS_FOR_INDEX_TYPES);
+TF_CALL_double(REGISTER_CPU_KERNELS_FOR_INDEX_TYPES);
+
+#undef REGISTER_CPU_KERNELS_FOR_INDEX_TYPES
+#undef REGISTER_CPU_KERNEL
+
+}  // namespace tensorflow
@@ -0,0 +1,106 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedSparseSegmentReduceConcatOpTest : public OpsTestBase {
+ protected:
+  Status Init(const std::vector<string>& combiners) {
+    const int num_inputs = combiners.size();
+    TF_CHECK_OK(NodeDefBuilder("op", "_FusedSparseSegmentReduceConcat")
+                    .Input(FakeInput(num_inputs, DT_FLOAT))
+                    .Input(FakeInput(num_inputs, DT_INT32))
+                    .Input(FakeInput(num_inputs, DT_INT32))
+                    .Attr("combiners", combiners)
+                    .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+TEST_F(FusedSparseSegmentReduceConcatOpTest, SumAndMean) {
+  TF_ASSERT_OK(Init({"sum", "mean"}));
+
+  // data
+  AddInputFromArray<float>(TensorShape({3, 2}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<float>(TensorShape({2, 1}), {10, 20});
+  // indices
+  AddInputFromArray<int32>(TensorShape({3}), {0, 2, 1});
+  AddInputFromArray<int32>(TensorShape({3}), {0, 1, 1});
+  // segment_ids
+  AddInputFromArray<int32>(TensorShape({3}), {0, 0, 1});
+  AddInputFromArray<int32>(TensorShape({3}), {0, 0, 1});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // Equivalent to ConcatV2([SparseSegmentSum(...), SparseSegmentMean(...)],
+  // axis=1).
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 3}));
+  test::FillValues<float>(&expected, {6, 8, 15, 3, 4, 20});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(FusedSparseSegmentReduceConcatOpTest, EmptySegments) {
+  TF_ASSERT_OK(Init({"mean", "sum"}));
+
+  AddInputFromArray<float>(TensorShape({2, 1}), {1, 2});
+  AddInputFromArray<float>(TensorShape({2, 1}), {3, 4});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 1});
+  AddInputFromArray<int32>(TensorShape({1}), {1});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 2});
+  AddInputFromArray<int32>(TensorShape({1}), {2});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({3, 2}));
+  test::FillValues<float>(&expected, {1, 0, 0, 0, 2, 4});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(FusedSparseSegmentReduceConcatOpTest, MismatchedRows) {
+  TF_ASSERT_OK(Init({"sum", "sum"}));
+
+  AddInputFromArray<float>(TensorShape({2, 1}), {1, 2});
+  AddInputFromArray<float>(TensorShape({2, 1}), {3, 4});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 1});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 1});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 1});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 0});
+  EXPECT_FALSE(RunOpKernel().ok());
+}
+
+TEST_F(FusedSparseSegmentReduceConcatOpTest, IndexOutOfRange) {
+  TF_ASSERT_OK(Init({"sum", "sum"}));
+
+  AddInputFromArray<float>(TensorShape({2, 1}), {1, 2});
+  AddInputFromArray<float>(TensorShape({2, 1}), {3, 4});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 2});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 1});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 1});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 1});
+  EXPECT_FALSE(RunOpKernel().ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
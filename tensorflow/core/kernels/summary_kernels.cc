@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/summary/schema.h"
 #include "tensorflow/core/summary/summary_db_writer.h"
 #include "tensorflow/core/summary/summary_file_writer.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/event.pb.h"
 
 namespace tensorflow {
@@ -33,7 +34,14 @@ REGISTER_KERNEL_BUILDER(Name("SummaryWriter").Device(DEVICE_CPU),
 class CreateSummaryFileWriterOp : public OpKernel {
  public:
   explicit CreateSummaryFileWriterOp(OpKernelConstruction* ctx)
-      : OpKernel(ctx) {}
+      : OpKernel(ctx) {
+    // Opt-in as the writer then returns before the summaries are written.
+    int64_t async_queue_size;
+    OP_REQUIRES_OK(ctx, ReadInt64FromEnvVar("TF_SUMMARY_ASYNC_QUEUE_SIZE",
+                                            /*default_val=*/0,
+                                            &async_queue_size));
+    async_queue_size_ = static_cast<int>(async_queue_size);
+  }
 
   void Compute(OpKernelContext* ctx) override {
     const Tensor* tmp;
@@ -57,13 +65,17 @@ class CreateSummaryFileWriterOp : public OpKernel {
     core::RefCountPtr<SummaryWriterInterface> s;
     OP_REQUIRES_OK(ctx, LookupOrCreateResource<SummaryWriterInterface>(
                             ctx, HandleFromInput(ctx, 0), &s,
-                            [max_queue, flush_millis, logdir, filename_suffix,
-                             ctx](SummaryWriterInterface** s) {
+                            [this, max_queue, flush_millis, logdir,
+                             filename_suffix, ctx](SummaryWriterInterface** s) {
                               return CreateSummaryFileWriter(
                                   max_queue, flush_millis, logdir,
-                                  filename_suffix, ctx->env(), s);
+                                  filename_suffix, async_queue_size_,
+                                  ctx->env(), s);
                             }));
   }
+
+ private:
+  int async_queue_size_;
 };
 REGISTER_KERNEL_BUILDER(Name("CreateSummaryFileWriter").Device(DEVICE_CPU),
                         CreateSummaryFileWriterOp);
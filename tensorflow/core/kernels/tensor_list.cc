@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/tensor_list.h"
 
+#include <cstring>
+#include <utility>
+
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/variant_op_registry.h"
@@ -25,6 +28,50 @@ TensorList::~TensorList() {
   if (tensors_) tensors_->Unref();
 }
 
+void TensorList::SetBuffer(Tensor buffer) {
+  DCHECK_GT(buffer.dims(), 0);
+  DCHECK(DataTypeCanUseMemcpy(buffer.dtype()));
+  tensors_->row_written_.assign(buffer.dim_size(0), false);
+  tensors_->buffer_ = std::move(buffer);
+}
+
+bool TensorList::MaybeSetInBuffer(int index, const Tensor& value) {
+  std::vector<bool>& row_written = tensors_->row_written_;
+  if (index < 0 || index >= static_cast<int>(row_written.size()) ||
+      row_written[index]) {
+    return false;
+  }
+  const Tensor& buffer = tensors_->buffer_;
+  if (value.dtype() != buffer.dtype()) return false;
+  Tensor row = buffer.SubSlice(index);
+  if (value.shape() != row.shape()) return false;
+  StringPiece src = value.tensor_data();
+  StringPiece dst = row.tensor_data();
+  std::memcpy(const_cast<char*>(dst.data()), src.data(), src.size());
+  tensors()[index] = std::move(row);
+  row_written[index] = true;
+  return true;
+}
+
+const Tensor* TensorList::StackedBuffer() const {
+  const std::vector<bool>& row_written = tensors_->row_written_;
+  if (row_written.empty() || tensors().size() != row_written.size()) {
+    return nullptr;
+  }
+  const Tensor& buffer = tensors_->buffer_;
+  const char* base = buffer.tensor_data().data();
+  const size_t row_bytes = buffer.TotalBytes() / row_written.size();
+  for (size_t i = 0; i < tensors().size(); ++i) {
+    const Tensor& t = tensors()[i];
+    if (!row_written[i] || t.dtype() != buffer.dtype() ||
+        !t.SharesBufferWith(buffer) ||
+        t.tensor_data().data() != base + i * row_bytes) {
+      return nullptr;
+    }
+  }
+  return &buffer;
+}
+
 void TensorList::Encode(VariantTensorData* data) const {
   data->set_type_name(TypeName());
   std::vector<size_t> invalid_indices;
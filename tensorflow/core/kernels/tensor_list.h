@@ -141,10 +141,35 @@ class TensorList {
   // container?
   bool RefCountIsOne() const { return tensors_->RefCountIsOne(); }
 
+  // Sets `buffer`, a host tensor of shape [num_elements] + element_shape with
+  // a memcpy-able dtype, as contiguous storage for the first num_elements
+  // elements of the list. The buffer belongs to the underlying container and
+  // is not shared with lists created by Copy().
+  void SetBuffer(Tensor buffer);
+
+  // If element `index` has never been written to the buffer and `value` has
+  // the shape of a row of the buffer, copies `value` into row `index`, sets
+  // the element to a view of that row and returns true. Returns false and
+  // leaves the list untouched otherwise.
+  //
+  // A row is written at most once, since the previous value of the element
+  // may still be referenced (e.g. by the output of a TensorListGetItem or by
+  // a Copy() of the list).
+  bool MaybeSetInBuffer(int index, const Tensor& value);
+
+  // Returns the buffer if each element of the list is the view of its row of
+  // the buffer, i.e. if the buffer holds the stacked elements of the list.
+  // Returns nullptr otherwise.
+  const Tensor* StackedBuffer() const;
+
  private:
   class Tensors : public core::RefCounted {
    public:
     std::vector<Tensor> values_;
+    // Contiguous storage for the elements, see SetBuffer(). `row_written_` is
+    // empty iff the container has no buffer.
+    Tensor buffer_;
+    std::vector<bool> row_written_;
   };
   Tensors* tensors_;
 };
@@ -0,0 +1,80 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/tensor_list.h"
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TensorList ListWithBuffer(int num_elements) {
+  TensorList list;
+  list.element_dtype = DT_FLOAT;
+  list.element_shape = PartialTensorShape({2});
+  list.tensors().resize(num_elements, Tensor(DT_INVALID));
+  list.SetBuffer(Tensor(DT_FLOAT, TensorShape({num_elements, 2})));
+  return list;
+}
+
+TEST(TensorListTest, StacksElementsSetInBuffer) {
+  TensorList list = ListWithBuffer(3);
+  EXPECT_EQ(list.StackedBuffer(), nullptr);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(list.MaybeSetInBuffer(
+        i, test::AsTensor<float>({2.0f * i, 2.0f * i + 1})));
+  }
+  const Tensor* stacked = list.StackedBuffer();
+  ASSERT_NE(stacked, nullptr);
+  test::ExpectTensorEqual<float>(
+      *stacked, test::AsTensor<float>({0, 1, 2, 3, 4, 5}, TensorShape({3, 2})));
+  test::ExpectTensorEqual<float>(list.tensors()[1],
+                                 test::AsTensor<float>({2, 3}));
+}
+
+TEST(TensorListTest, WritesEachRowOnce) {
+  TensorList list = ListWithBuffer(2);
+  ASSERT_TRUE(list.MaybeSetInBuffer(0, test::AsTensor<float>({1, 2})));
+  Tensor first = list.tensors()[0];
+  EXPECT_FALSE(list.MaybeSetInBuffer(0, test::AsTensor<float>({3, 4})));
+  // Values of the wrong shape or out of the buffer are not written.
+  EXPECT_FALSE(list.MaybeSetInBuffer(1, test::AsTensor<float>({1, 2, 3})));
+  EXPECT_FALSE(list.MaybeSetInBuffer(2, test::AsTensor<float>({1, 2})));
+  test::ExpectTensorEqual<float>(first, test::AsTensor<float>({1, 2}));
+}
+
+TEST(TensorListTest, DoesNotStackReplacedElements) {
+  TensorList list = ListWithBuffer(2);
+  ASSERT_TRUE(list.MaybeSetInBuffer(0, test::AsTensor<float>({1, 2})));
+  ASSERT_TRUE(list.MaybeSetInBuffer(1, test::AsTensor<float>({3, 4})));
+  list.tensors()[1] = test::AsTensor<float>({5, 6});
+  EXPECT_EQ(list.StackedBuffer(), nullptr);
+}
+
+TEST(TensorListTest, CopyDoesNotShareTheBuffer) {
+  TensorList list = ListWithBuffer(2);
+  ASSERT_TRUE(list.MaybeSetInBuffer(0, test::AsTensor<float>({1, 2})));
+  TensorList copy = list.Copy();
+  EXPECT_FALSE(copy.MaybeSetInBuffer(1, test::AsTensor<float>({3, 4})));
+  ASSERT_TRUE(list.MaybeSetInBuffer(1, test::AsTensor<float>({5, 6})));
+  EXPECT_EQ(copy.tensors()[1].dtype(), DT_INVALID);
+  test::ExpectTensorEqual<float>(copy.tensors()[0],
+                                 test::AsTensor<float>({1, 2}));
+}
+
+}  // namespace
+}  // namespace tensorflow
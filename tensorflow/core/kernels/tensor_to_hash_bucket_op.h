@@ -23,10 +23,12 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
-#include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/numbers.h"
+#include "tensorflow/core/platform/stringpiece.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -36,15 +38,14 @@ template <typename Device, typename T>
 struct LaunchTensorToHashBucket {
   void operator()(OpKernelContext* c, const int64_t num_buckets, const T* input,
                   const int num_elems, int64_t* output) {
-    string format = "%";
+    // Integers are hashed through their decimal representation, which must
+    // stay byte-identical to printf's "%d" and "%lld" since models bake the
+    // resulting bucket ids into their embedding tables.
     switch (DataTypeToEnum<T>::value) {
       case DT_INT8:
       case DT_INT16:
       case DT_INT32:
-        strings::Appendf(&format, "d");
-        break;
       case DT_INT64:
-        strings::Appendf(&format, "lld");
         break;
       default:
         bool type_not_supported = true;
@@ -54,15 +55,25 @@ struct LaunchTensorToHashBucket {
                                     DataTypeString(DataTypeToEnum<T>::value)));
     }
 
-    for (int i = 0; i < num_elems; ++i) {
-      string input_str = strings::Printf(format.c_str(), input[i]);
-      const uint64 input_hash = Fingerprint64(input_str);
-      const uint64 bucket_id = input_hash % num_buckets;
-      // The number of buckets is always in the positive range of int64 so is
-      // the resulting bucket_id. Casting the bucket_id from uint64 to int64 is
-      // safe.
-      output[i] = static_cast<int64_t>(bucket_id);
-    }
+    auto hash_range = [num_buckets, input, output](int64_t start,
+                                                   int64_t limit) {
+      char buffer[strings::kFastToBufferSize];
+      for (int64_t i = start; i < limit; ++i) {
+        const size_t length = strings::FastInt64ToBufferLeft(
+            static_cast<int64_t>(input[i]), buffer);
+        const uint64 input_hash = Fingerprint64(StringPiece(buffer, length));
+        const uint64 bucket_id = input_hash % num_buckets;
+        // The number of buckets is always in the positive range of int64 so
+        // is the resulting bucket_id. Casting the bucket_id from uint64 to
+        // int64 is safe.
+        output[i] = static_cast<int64_t>(bucket_id);
+      }
+    };
+    // Formatting and fingerprinting a short decimal string.
+    const int64_t kCostPerUnit = 100;
+    auto worker_threads = c->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_elems,
+          kCostPerUnit, hash_range);
   }
 };
 
@@ -20,7 +20,10 @@ limitations under the License.
 #include "tensorflow/core/kernels/topk_op.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <numeric>
+#include <type_traits>
 #include <vector>
 
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
@@ -30,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/gtl/top_n.h"
+#include "tensorflow/core/platform/bfloat16.h"
 #include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
@@ -129,6 +133,75 @@ class TopK : public OpKernel {
 
 namespace functor {
 
+// Radix selection requires mapping each value to an unsigned key with the same
+// order. `RadixSelectKey<T>::type` is void for the types it doesn't support.
+template <typename T>
+struct RadixSelectKey {
+  using type = void;
+};
+template <>
+struct RadixSelectKey<float> {
+  using type = uint32_t;
+};
+template <>
+struct RadixSelectKey<bfloat16> {
+  using type = uint16_t;
+};
+
+// Rows with at least this many columns, of which at least this many are
+// requested, use radix selection rather than a heap when the type allows it.
+constexpr int64_t kRadixSelectMinCols = 4096;
+constexpr int kRadixSelectMinK = 128;
+
+// Sets `keys` to the order preserving keys of `row`. Returns false if the row
+// holds a NaN, which has no place in that order.
+template <typename T, typename Key>
+bool ComputeRadixSelectKeys(const T* row, int64_t num_cols, Key* keys) {
+  constexpr Key kSignBit = Key(1) << (8 * sizeof(Key) - 1);
+  for (int64_t c = 0; c < num_cols; ++c) {
+    const T value = row[c];
+    if (Eigen::numext::isnan(value)) return false;
+    Key bits;
+    std::memcpy(&bits, &value, sizeof(Key));
+    // -0 and 0 compare equal, so they must have the same key.
+    if (bits == kSignBit) bits = 0;
+    keys[c] = (bits & kSignBit) ? ~bits : (bits | kSignBit);
+  }
+  return true;
+}
+
+// Writes the columns of the `k` largest keys to `indices`, by increasing
+// column; ties are broken in favor of the lower column, as in the heap path.
+// Each pass of the selection histograms one byte of the keys that match the
+// bytes selected so far, most significant byte first.
+template <typename Key, typename Tidx>
+void RadixSelectTopK(const Key* keys, int64_t num_cols, int k, Tidx* indices) {
+  Key prefix = 0;
+  Key prefix_mask = 0;
+  int64_t remaining = k;
+  for (int shift = 8 * (sizeof(Key) - 1); shift >= 0; shift -= 8) {
+    int64_t histogram[256] = {0};
+    for (int64_t c = 0; c < num_cols; ++c) {
+      if ((keys[c] & prefix_mask) == prefix) {
+        ++histogram[(keys[c] >> shift) & 0xFF];
+      }
+    }
+    int digit = 255;
+    for (; digit > 0 && histogram[digit] < remaining; --digit) {
+      remaining -= histogram[digit];
+    }
+    prefix |= static_cast<Key>(digit) << shift;
+    prefix_mask |= static_cast<Key>(0xFF) << shift;
+  }
+  // `prefix` is now the k-th largest key, of which `remaining` are selected.
+  int i = 0;
+  for (int64_t c = 0; c < num_cols; ++c) {
+    if (keys[c] > prefix || (keys[c] == prefix && remaining-- > 0)) {
+      indices[i++] = static_cast<Tidx>(c);
+    }
+  }
+}
+
 template <typename T, typename Tidx>
 struct TopKFunctor<CPUDevice, T, Tidx> {
   static EIGEN_ALWAYS_INLINE Status Compute(
@@ -161,7 +234,16 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
       return OkStatus();
     }
 
+    constexpr bool kHasRadixSelect =
+        !std::is_void<typename RadixSelectKey<T>::type>::value;
+    using Key = typename std::conditional<
+        kHasRadixSelect, typename RadixSelectKey<T>::type, char>::type;
+    const bool use_radix_select = kHasRadixSelect && k < num_cols &&
+                                  num_cols >= kRadixSelectMinCols &&
+                                  k >= kRadixSelectMinK;
+
     auto SortIndices = [&](int64_t start_batch, int64_t limit_batch) {
+      std::vector<Key> keys(use_radix_select ? num_cols : 0);
       for (int32_t b = start_batch; b < limit_batch; ++b) {
         const T* input_data = &input(b, 0);
         const auto stable_comp = [input_data](const int32_t a,
@@ -204,6 +286,11 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
             }
             run_begin = run_end;
           }
+        } else if (use_radix_select &&
+                   TopKRadixSelect<kHasRadixSelect>(input_data, num_cols, k,
+                                                    sorted, keys.data(),
+                                                    &indices(b, 0))) {
+          // The indices of this row are done.
         } else {
           // Use the TopN heap object to sort.
           gtl::TopN<Tidx, decltype(stable_comp)> filter(k, stable_comp);
@@ -241,7 +328,14 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
         cmp_cost *
         static_cast<double>(num_cols *
                             Eigen::numext::log2(static_cast<float>(k + 1)));
-    const double sort_cost = (k == num_cols) ? base_cost : 4 * base_cost;
+    double sort_cost = (k == num_cols) ? base_cost : 4 * base_cost;
+    if (use_radix_select) {
+      // One pass per key byte over the row, then sorting the selected k.
+      sort_cost = cmp_cost * (sizeof(Key) * num_cols +
+                              (sorted ? k * Eigen::numext::log2(
+                                                static_cast<float>(k + 1))
+                                      : 0));
+    }
     const double copy_cost = 2 * k * Eigen::TensorOpCost::AddCost<T>();
     const double total_cost = sort_cost + copy_cost;
     const int64_t final_cost = (total_cost >= static_cast<double>(kint64max))
@@ -253,6 +347,32 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
 
     return OkStatus();
   }
+
+ private:
+  // Selects the top `k` of `row` with RadixSelectTopK, then sorts them if
+  // requested. Returns false, leaving `indices` to the heap path, if the type
+  // has no radix keys or the row holds a NaN.
+  template <bool kHasRadixSelect, typename Key>
+  static typename std::enable_if<kHasRadixSelect, bool>::type TopKRadixSelect(
+      const T* row, int64_t num_cols, int k, bool sorted, Key* keys,
+      Tidx* indices) {
+    if (!ComputeRadixSelectKeys(row, num_cols, keys)) return false;
+    RadixSelectTopK(keys, num_cols, k, indices);
+    if (sorted) {
+      // The keys are distinct for unequal values, so this is the stable order.
+      std::sort(indices, indices + k, [keys](const Tidx a, const Tidx b) {
+        return keys[a] > keys[b] || (keys[a] == keys[b] && a < b);
+      });
+    }
+    return true;
+  }
+
+  template <bool kHasRadixSelect, typename Key>
+  static typename std::enable_if<!kHasRadixSelect, bool>::type
+  TopKRadixSelect(const T* row, int64_t num_cols, int k, bool sorted,
+                  Key* keys, Tidx* indices) {
+    return false;
+  }
 };
 
 }  // namespace functor
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_TRAINING_OP_HELPERS_H_
 #define TENSORFLOW_CORE_KERNELS_TRAINING_OP_HELPERS_H_
 
+#include <algorithm>
 #include <optional>
 
 #include "tensorflow/core/framework/op_kernel.h"
@@ -167,26 +168,22 @@ VariableInputLockHolder MaybeLockVariableInputMutexesInOrder(
   }
   std::vector<Var*> vars;
   std::vector<mutex*> mutexes;
-  std::vector<int> acquire_order;
   for (auto input : input_ids) {
     Var* var;
     mutex* mutex = GetTrainingVariableMutex<Device, T>(ctx, input, &var);
     if (var) vars.push_back(var);
-    // Only lock each mutex once if duplicates exist (n^2 but n is 2 or 3).
-    if (std::find(mutexes.begin(), mutexes.end(), mutex) == mutexes.end()) {
-      acquire_order.push_back(mutexes.size());
-      mutexes.push_back(mutex);
-    }
+    mutexes.push_back(mutex);
   }
-  std::sort(acquire_order.begin(), acquire_order.end(),
-            [&mutexes](int a, int b) { return mutexes[a] < mutexes[b]; });
+  // Only lock each mutex once if duplicates exist. Multi-tensor ops pass
+  // thousands of inputs, so sort instead of searching for each duplicate.
+  std::sort(mutexes.begin(), mutexes.end());
+  mutexes.erase(std::unique(mutexes.begin(), mutexes.end()), mutexes.end());
 
   auto locks = std::make_unique<std::vector<mutex_lock>>();
   auto shared_locks = std::make_unique<std::vector<tf_shared_lock>>();
-  locks->reserve(acquire_order.size());
+  locks->reserve(mutexes.size());
 
-  for (auto acquire : acquire_order) {
-    mutex* mu = mutexes[acquire];
+  for (mutex* mu : mutexes) {
     if (mu != nullptr) {
       if (!sparse || do_lock) {
         locks->emplace_back(*mu);
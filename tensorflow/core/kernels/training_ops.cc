@@ -17,6 +17,8 @@ limitations under the License.
 #include "tensorflow/core/kernels/training_ops.h"
 
 #include <algorithm>  // NOLINT
+#include <numeric>
+#include <vector>
 
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -847,6 +849,61 @@ struct ApplyAdamNonCuda {
 template <typename T>
 struct ApplyAdam<CPUDevice, T> : ApplyAdamNonCuda<CPUDevice, T> {};
 
+template <typename T>
+struct ApplyAdamMulti<CPUDevice, T> {
+  void operator()(const CPUDevice& d,
+                  const std::vector<AdamMultiVariable<T>>& variables,
+                  typename TTypes<T>::ConstScalar beta1_power,
+                  typename TTypes<T>::ConstScalar beta2_power,
+                  typename TTypes<T>::ConstScalar lr,
+                  typename TTypes<T>::ConstScalar beta1,
+                  typename TTypes<T>::ConstScalar beta2,
+                  typename TTypes<T>::ConstScalar epsilon, bool use_nesterov) {
+    // Shard the concatenation of all the variables, so that small variables
+    // share a shard instead of each paying for its own parallelFor.
+    std::vector<int64_t> offsets(variables.size() + 1, 0);
+    for (int i = 0; i < variables.size(); ++i) {
+      offsets[i + 1] = offsets[i] + variables[i].size;
+    }
+    const T alpha = lr() * Eigen::numext::sqrt(T(1) - beta2_power()) /
+                    (T(1) - beta1_power());
+
+    auto shard = [&](Index begin, Index end) {
+      // The last variable that starts at or before `begin`.
+      int i = std::upper_bound(offsets.begin(), offsets.end(), begin) -
+              offsets.begin() - 1;
+      for (; begin < end; ++i) {
+        const AdamMultiVariable<T>& variable = variables[i];
+        const Index start = begin - offsets[i];
+        const Index size = std::min<Index>(end, offsets[i + 1]) - begin;
+        auto var =
+            typename TTypes<T>::UnalignedTensor(variable.var + start, size);
+        auto m = typename TTypes<T>::UnalignedTensor(variable.m + start, size);
+        auto v = typename TTypes<T>::UnalignedTensor(variable.v + start, size);
+        auto g = typename TTypes<T>::UnalignedConstTensor(variable.grad + start,
+                                                          size);
+        m += (g - m) * (T(1) - beta1());
+        v += (g.square() - v) * (T(1) - beta2());
+        if (use_nesterov) {
+          var -= ((g * (T(1) - beta1()) + beta1() * m) * alpha) /
+                 (v.sqrt() + epsilon());
+        } else {
+          var -= (m * alpha) / (v.sqrt() + epsilon());
+        }
+        begin += size;
+      }
+    };
+
+    // Same cost per element as ApplyAdamNonCuda.
+    const Eigen::TensorOpCost cost(
+        sizeof(T) * 4, sizeof(T) * 3,
+        Eigen::TensorOpCost::AddCost<T>() * 10 +
+            Eigen::TensorOpCost::MulCost<T>() * 6 +
+            Eigen::TensorOpCost::DivCost<T>());
+    d.parallelFor(offsets.back(), cost, shard);
+  }
+};
+
 template <typename T>
 struct ApplyAdamWithAmsgrad<CPUDevice, T> {
   void operator()(const CPUDevice& d, typename TTypes<T>::Flat var,
@@ -3654,6 +3711,150 @@ REGISTER_KERNELS(GPU, complex128);
 #undef REGISTER_CPU_KERNELS
 #undef REGISTER_KERNELS
 
+// Applies Adam to N variables at once. The inputs are the N variables, the N
+// m slots, the N v slots, the hyperparameters shared by all the variables,
+// and the N gradients.
+template <typename Device, typename T>
+class ApplyAdamMultiOp : public OpKernel {
+ public:
+  explicit ApplyAdamMultiOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("N", &num_variables_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_nesterov", &use_nesterov_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const bool sparse = false;
+    const int n = num_variables_;
+    std::vector<int> variable_inputs(3 * n);
+    std::iota(variable_inputs.begin(), variable_inputs.end(), 0);
+    auto locks = MaybeLockVariableInputMutexesInOrder<Device, T>(
+        ctx, use_exclusive_lock_, sparse, variable_inputs);
+
+    static constexpr const char* kScalarNames[] = {
+        "beta1_power", "beta2_power", "lr", "beta1", "beta2", "epsilon"};
+    for (int i = 0; i < 6; ++i) {
+      const Tensor& scalar = ctx->input(3 * n + i);
+      OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(scalar.shape()),
+                  errors::InvalidArgument(kScalarNames[i], " is not a scalar: ",
+                                          scalar.shape().DebugString()));
+    }
+
+    // Keep the tensors of the variables alive until the update is done.
+    std::vector<Tensor> tensors;
+    tensors.reserve(3 * n);
+    std::vector<functor::AdamMultiVariable<T>> variables;
+    variables.reserve(n);
+    for (int i = 0; i < n; ++i) {
+      for (int input : {i, n + i, 2 * n + i}) {
+        Tensor tensor;
+        OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<Device, T>(
+                                ctx, input, use_exclusive_lock_, sparse,
+                                &tensor));
+        OP_REQUIRES(ctx, tensor.IsInitialized(),
+                    errors::FailedPrecondition(
+                        "Attempting to use uninitialized variables: ",
+                        requested_input(input)));
+        tensors.push_back(std::move(tensor));
+      }
+      Tensor& var = tensors[3 * i];
+      Tensor& m = tensors[3 * i + 1];
+      Tensor& v = tensors[3 * i + 2];
+      const Tensor& grad = ctx->input(3 * n + 6 + i);
+      OP_REQUIRES(
+          ctx, var.shape().IsSameSize(m.shape()),
+          errors::InvalidArgument("var and m do not have the same shape",
+                                  var.shape().DebugString(), " ",
+                                  m.shape().DebugString()));
+      OP_REQUIRES(
+          ctx, var.shape().IsSameSize(v.shape()),
+          errors::InvalidArgument("var and v do not have the same shape",
+                                  var.shape().DebugString(), " ",
+                                  v.shape().DebugString()));
+      OP_REQUIRES(
+          ctx, var.shape().IsSameSize(grad.shape()),
+          errors::InvalidArgument("var and grad do not have the same shape",
+                                  var.shape().DebugString(), " ",
+                                  grad.shape().DebugString()));
+      if (var.NumElements() == 0) continue;
+      variables.push_back({var.flat<T>().data(), m.flat<T>().data(),
+                           v.flat<T>().data(), grad.flat<T>().data(),
+                           var.NumElements()});
+    }
+    if (variables.empty()) return;
+
+    // The variables are updated concurrently, so a buffer updated twice would
+    // race with itself.
+    std::vector<const T*> buffers;
+    buffers.reserve(3 * variables.size());
+    for (const auto& variable : variables) {
+      buffers.insert(buffers.end(), {variable.var, variable.m, variable.v});
+    }
+    std::sort(buffers.begin(), buffers.end());
+    const bool distinct =
+        std::adjacent_find(buffers.begin(), buffers.end()) == buffers.end();
+    OP_REQUIRES(ctx, distinct,
+                errors::InvalidArgument("Duplicate variables or slots"));
+
+    const Device& device = ctx->template eigen_device<Device>();
+    functor::ApplyAdamMulti<Device, T>()(
+        device, variables, ctx->input(3 * n).scalar<T>(),
+        ctx->input(3 * n + 1).scalar<T>(), ctx->input(3 * n + 2).scalar<T>(),
+        ctx->input(3 * n + 3).scalar<T>(), ctx->input(3 * n + 4).scalar<T>(),
+        ctx->input(3 * n + 5).scalar<T>(), use_nesterov_);
+  }
+
+ private:
+  int num_variables_;
+  bool use_exclusive_lock_;
+  bool use_nesterov_;
+};
+
+#define REGISTER_KERNELS(D, T)                            \
+  REGISTER_KERNEL_BUILDER(Name("_ResourceApplyAdamMulti") \
+                              .HostMemory("var")          \
+                              .HostMemory("m")            \
+                              .HostMemory("v")            \
+                              .Device(DEVICE_##D)         \
+                              .TypeConstraint<T>("T"),    \
+                          ApplyAdamMultiOp<D##Device, T>);
+#define REGISTER_CPU_KERNELS(T) REGISTER_KERNELS(CPU, T);
+
+TF_CALL_FLOAT_TYPES(REGISTER_CPU_KERNELS);
+TF_CALL_COMPLEX_TYPES(REGISTER_CPU_KERNELS);
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+// Forward declarations of the functor specializations for GPU.
+namespace functor {
+#define DECLARE_GPU_SPEC(T)                                        \
+  template <>                                                      \
+  void ApplyAdamMulti<GPUDevice, T>::operator()(                   \
+      const GPUDevice& d,                                          \
+      const std::vector<AdamMultiVariable<T>>& variables,          \
+      typename TTypes<T>::ConstScalar beta1_power,                 \
+      typename TTypes<T>::ConstScalar beta2_power,                 \
+      typename TTypes<T>::ConstScalar lr,                          \
+      typename TTypes<T>::ConstScalar beta1,                       \
+      typename TTypes<T>::ConstScalar beta2,                       \
+      typename TTypes<T>::ConstScalar epsilon, bool use_nesterov); \
+  extern template struct ApplyAdamMulti<GPUDevice, T>;
+DECLARE_GPU_SPEC(Eigen::half);
+DECLARE_GPU_SPEC(float);
+DECLARE_GPU_SPEC(double);
+DECLARE_GPU_SPEC(complex64);
+DECLARE_GPU_SPEC(complex128);
+#undef DECLARE_GPU_SPEC
+}  // namespace functor
+
+REGISTER_KERNELS(GPU, Eigen::half);
+REGISTER_KERNELS(GPU, float);
+REGISTER_KERNELS(GPU, double);
+REGISTER_KERNELS(GPU, complex64);
+REGISTER_KERNELS(GPU, complex128);
+#endif
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_KERNELS
+
 template <typename Device, typename T>
 class ApplyAdamWithAmsgradOp : public OpKernel {
  public:
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_TRAINING_OPS_H_
 #define TENSORFLOW_CORE_KERNELS_TRAINING_OPS_H_
 
+#include <vector>
+
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -245,6 +247,31 @@ struct ApplyAdam {
                   typename TTypes<T>::ConstFlat grad, bool use_nesterov);
 };
 
+// A variable updated by ApplyAdamMulti, with its slots and its gradient.
+template <typename T>
+struct AdamMultiVariable {
+  T* var;
+  T* m;
+  T* v;
+  const T* grad;
+  int64_t size;
+};
+
+// Applies Adam with the same hyperparameters to all the `variables`, which
+// must be distinct and non-empty, in a few kernels instead of one per
+// variable.
+template <typename Device, typename T>
+struct ApplyAdamMulti {
+  void operator()(const Device& d,
+                  const std::vector<AdamMultiVariable<T>>& variables,
+                  typename TTypes<T>::ConstScalar beta1_power,
+                  typename TTypes<T>::ConstScalar beta2_power,
+                  typename TTypes<T>::ConstScalar lr,
+                  typename TTypes<T>::ConstScalar beta1,
+                  typename TTypes<T>::ConstScalar beta2,
+                  typename TTypes<T>::ConstScalar epsilon, bool use_nesterov);
+};
+
 template <typename Device, typename T>
 struct ApplyAdamWithAmsgrad {
   void operator()(const Device& d, typename TTypes<T>::Flat var,
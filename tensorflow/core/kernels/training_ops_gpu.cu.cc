@@ -218,6 +218,62 @@ __global__ __launch_bounds__(1024) void ApplyAdamKernel(
   }
 }
 
+// Up to kMaxVariables variables updated by one ApplyAdamMultiKernel. It is
+// passed by value, so that launching a chunk needs no copy to the device.
+template <typename T>
+struct AdamMultiChunk {
+  static constexpr int kMaxVariables = 24;
+
+  int num_variables = 0;
+  // Variable i spans [offsets[i], offsets[i + 1]) of the chunk's elements.
+  int64_t offsets[kMaxVariables + 1];
+  T* var[kMaxVariables];
+  T* m[kMaxVariables];
+  T* v[kMaxVariables];
+  const T* grad[kMaxVariables];
+};
+
+template <typename T>
+__global__ __launch_bounds__(1024) void ApplyAdamMultiKernel(
+    AdamMultiChunk<T> chunk, const T* const beta1_power_,
+    const T* const beta2_power_, const T* const lr_, const T* const beta1_,
+    const T* const beta2_, const T* const epsilon_, bool use_nesterov) {
+  const T mul_factor =
+      (*lr_) * Eigen::numext::sqrt(static_cast<T>(1.0) - (*beta2_power_)) /
+      (static_cast<T>(1.0) - (*beta1_power_));
+  const T epsilon = (*epsilon_);
+  const T beta1 = (*beta1_);
+  const T one_minus_beta1 = static_cast<T>(1.0) - (beta1);
+  const T one_minus_beta2 = static_cast<T>(1.0) - (*beta2_);
+
+  int t = 0;
+  for (int64_t i : GpuGridRangeX<int64_t>(chunk.offsets[chunk.num_variables])) {
+    // Each thread visits increasing elements, so the variable holding `i`
+    // never precedes the previous one.
+    while (chunk.offsets[t + 1] <= i) ++t;
+    const int64_t j = i - chunk.offsets[t];
+    T* var = chunk.var[t];
+    T* m = chunk.m[t];
+    T* v = chunk.v[t];
+    auto m_i = m[j];
+    auto g_i = chunk.grad[t][j];
+    auto v_i = v[j];
+
+    // Avoid += and -= due to std::complex<T> issues on device for MSVC.
+    m_i = m_i + one_minus_beta1 * (g_i - m_i);
+    v_i = v_i + one_minus_beta2 * (g_i * g_i - v_i);
+    if (use_nesterov) {
+      var[j] = var[j] - mul_factor * (m_i * beta1 + one_minus_beta1 * g_i) /
+                            (epsilon + Eigen::numext::sqrt(v_i));
+    } else {
+      var[j] = var[j] - mul_factor * m_i / (epsilon + Eigen::numext::sqrt(v_i));
+    }
+
+    m[j] = m_i;
+    v[j] = v_i;
+  }
+}
+
 template <typename T, typename Tindex>
 __global__ __launch_bounds__(1024) void SparseApplyKerasMomentumKernel(
     T* var, T* accum, const T* lr, const T* grad, const Tindex* indices,
@@ -890,6 +946,48 @@ struct ApplyAdam<GPUDevice, T> {
   }
 };
 
+template <typename T>
+struct ApplyAdamMulti<GPUDevice, T> {
+  void operator()(const GPUDevice& d,
+                  const std::vector<AdamMultiVariable<T>>& variables,
+                  typename TTypes<T>::ConstScalar beta1_power,
+                  typename TTypes<T>::ConstScalar beta2_power,
+                  typename TTypes<T>::ConstScalar lr,
+                  typename TTypes<T>::ConstScalar beta1,
+                  typename TTypes<T>::ConstScalar beta2,
+                  typename TTypes<T>::ConstScalar epsilon, bool use_nesterov) {
+    // Launch one kernel per chunk of variables instead of one per variable.
+    AdamMultiChunk<T> chunk;
+    chunk.offsets[0] = 0;
+    const auto launch = [&]() {
+      GpuLaunchConfig config = GetGpuLaunchConfig(
+          static_cast<int>(chunk.offsets[chunk.num_variables]), d);
+      TF_CHECK_OK(GpuLaunchKernel(
+          ApplyAdamMultiKernel<T>, config.block_count, config.thread_per_block,
+          0, d.stream(), chunk, beta1_power.data(), beta2_power.data(),
+          lr.data(), beta1.data(), beta2.data(), epsilon.data(),
+          use_nesterov));
+      chunk.num_variables = 0;
+    };
+    for (const AdamMultiVariable<T>& variable : variables) {
+      // Keep the size of a launch within the range of GetGpuLaunchConfig.
+      if (chunk.num_variables > 0 &&
+          chunk.offsets[chunk.num_variables] + variable.size >
+              std::numeric_limits<int32>::max()) {
+        launch();
+      }
+      const int i = chunk.num_variables++;
+      chunk.offsets[i + 1] = chunk.offsets[i] + variable.size;
+      chunk.var[i] = variable.var;
+      chunk.m[i] = variable.m;
+      chunk.v[i] = variable.v;
+      chunk.grad[i] = variable.grad;
+      if (chunk.num_variables == AdamMultiChunk<T>::kMaxVariables) launch();
+    }
+    if (chunk.num_variables > 0) launch();
+  }
+};
+
 template <typename T>
 struct ApplyAdamWithAmsgrad<GPUDevice, T> {
   void operator()(const GPUDevice& d, typename TTypes<T>::Flat var,
@@ -1199,6 +1297,12 @@ template struct functor::ApplyAdam<GPUDevice, double>;
 template struct functor::ApplyAdam<GPUDevice, complex64>;
 template struct functor::ApplyAdam<GPUDevice, complex128>;
 
+template struct functor::ApplyAdamMulti<GPUDevice, Eigen::half>;
+template struct functor::ApplyAdamMulti<GPUDevice, float>;
+template struct functor::ApplyAdamMulti<GPUDevice, double>;
+template struct functor::ApplyAdamMulti<GPUDevice, complex64>;
+template struct functor::ApplyAdamMulti<GPUDevice, complex128>;
+
 template struct functor::ApplyAdamWithAmsgrad<GPUDevice, Eigen::half>;
 template struct functor::ApplyAdamWithAmsgrad<GPUDevice, float>;
 template struct functor::ApplyAdamWithAmsgrad<GPUDevice, double>;
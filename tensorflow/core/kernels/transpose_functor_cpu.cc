@@ -15,7 +15,9 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <complex>
+#include <type_traits>
 
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/attr_value.pb.h"
@@ -68,12 +70,124 @@ void TransposeSimple(const CPUDevice& device, const Tensor& in,
   device.parallelFor(in.NumElements(), cost, std::move(transpose_fn));
 }
 
+// Copies the `num_rows` x `num_cols` tile at `src`, whose rows are
+// `src_stride` elements apart, to the transposed tile at `dst`, whose rows are
+// `dst_stride` elements apart. Full tiles have compile-time bounds so that the
+// compiler can unroll and vectorize their copy.
+template <typename T, int kTile>
+inline void TransposeTile(const T* src, int64_t src_stride, int64_t num_rows,
+                          int64_t num_cols, T* dst, int64_t dst_stride) {
+  if (num_rows == kTile && num_cols == kTile) {
+    for (int c = 0; c < kTile; ++c) {
+      for (int r = 0; r < kTile; ++r) {
+        dst[c * dst_stride + r] = src[r * src_stride + c];
+      }
+    }
+    return;
+  }
+  for (int64_t c = 0; c < num_cols; ++c) {
+    for (int64_t r = 0; r < num_rows; ++r) {
+      dst[c * dst_stride + r] = src[r * src_stride + c];
+    }
+  }
+}
+
+// Transposes `in` by tiles of the two dimensions that are innermost in the
+// input and in the output, respectively, so that every tile reads and writes
+// whole cache lines. The tiles of all the outer dimensions are processed in
+// parallel. Returns false without touching `out` if the innermost dimension
+// stays innermost, which Eigen already handles with contiguous copies.
+template <typename T>
+bool TransposeUsingTiles(const CPUDevice& device, const Tensor& in,
+                         const absl::Span<const int32> perm, Tensor* out) {
+  if (in.dims() < 2 || in.NumElements() == 0) return false;
+  internal::TransposePermsVec out_positions;
+  internal::TransposeDimsVec new_dims;
+  internal::ReduceTransposeDimensions(in.shape(), perm, &out_positions,
+                                      &new_dims);
+  // ReduceTransposeDimensions() returns the output position of every reduced
+  // input dimension, which is the inverse of the reduced permutation.
+  const int ndims = out_positions.size();
+  internal::TransposePermsVec new_perm(ndims);
+  for (int d = 0; d < ndims; ++d) new_perm[out_positions[d]] = d;
+  if (ndims < 2 || new_perm[ndims - 1] == ndims - 1) return false;
+
+  // Strides of the input and output, both indexed by input dimension.
+  gtl::InlinedVector<int64_t, 8> in_strides(ndims);
+  gtl::InlinedVector<int64_t, 8> out_strides(ndims);
+  int64_t stride = 1;
+  for (int d = ndims - 1; d >= 0; --d) {
+    in_strides[d] = stride;
+    stride *= new_dims[d];
+  }
+  stride = 1;
+  for (int i = ndims - 1; i >= 0; --i) {
+    out_strides[new_perm[i]] = stride;
+    stride *= new_dims[new_perm[i]];
+  }
+
+  // Input dimension `col_dim` is contiguous in the input, and input dimension
+  // `row_dim` is contiguous in the output.
+  const int col_dim = ndims - 1;
+  const int row_dim = new_perm[ndims - 1];
+  const int64_t num_rows = new_dims[row_dim];
+  const int64_t num_cols = new_dims[col_dim];
+  gtl::InlinedVector<int, 8> batch_dims;
+  int64_t num_batches = 1;
+  for (int d = 0; d < ndims; ++d) {
+    if (d == row_dim || d == col_dim) continue;
+    batch_dims.push_back(d);
+    num_batches *= new_dims[d];
+  }
+
+  // A tile row spans a cache line, so that tiles of 1 and 2 byte types are
+  // not limited to partial lines.
+  constexpr int kTile = std::max<int>(8, 64 / sizeof(T));
+  const int64_t row_tiles = (num_rows + kTile - 1) / kTile;
+  const int64_t col_tiles = (num_cols + kTile - 1) / kTile;
+  const int64_t tiles_per_batch = row_tiles * col_tiles;
+
+  const T* p = reinterpret_cast<const T*>(in.tensor_data().data());
+  T* q = reinterpret_cast<T*>(const_cast<char*>((out->tensor_data().data())));
+  auto transpose_fn = [&, p, q](int64_t begin, int64_t end) {
+    for (int64_t tile = begin; tile < end; ++tile) {
+      int64_t batch = tile / tiles_per_batch;
+      const int64_t batch_tile = tile - batch * tiles_per_batch;
+      const int64_t row = (batch_tile / col_tiles) * kTile;
+      const int64_t col = (batch_tile % col_tiles) * kTile;
+      int64_t in_offset = row * in_strides[row_dim] + col;
+      int64_t out_offset = col * out_strides[col_dim] + row;
+      for (int i = batch_dims.size() - 1; i >= 0; --i) {
+        const int d = batch_dims[i];
+        const int64_t batch_index = batch % new_dims[d];
+        batch /= new_dims[d];
+        in_offset += batch_index * in_strides[d];
+        out_offset += batch_index * out_strides[d];
+      }
+      TransposeTile<T, kTile>(p + in_offset, in_strides[row_dim],
+                              std::min<int64_t>(kTile, num_rows - row),
+                              std::min<int64_t>(kTile, num_cols - col),
+                              q + out_offset, out_strides[col_dim]);
+    }
+  };
+  Eigen::TensorOpCost cost(/*bytes_loaded=*/kTile * kTile * sizeof(T),
+                           /*bytes_stored=*/kTile * kTile * sizeof(T),
+                           /*compute_cycles=*/kTile * kTile);
+  device.parallelFor(num_batches * tiles_per_batch, cost,
+                     std::move(transpose_fn));
+  return true;
+}
+
 }  // namespace
 
 template <typename T, bool conjugate>
 struct Transpose<CPUDevice, T, conjugate> {
   static void run(const CPUDevice& d, const Tensor& in,
                   const absl::Span<const int32> perm, Tensor* out) {
+    if (!conjugate && std::is_trivially_copyable<T>::value &&
+        TransposeUsingTiles<T>(d, in, perm, out)) {
+      return;
+    }
     switch (in.dims()) {
       case 2:
         internal::TransposeUsingEigen<CPUDevice, T, 2>(d, in, perm, conjugate,
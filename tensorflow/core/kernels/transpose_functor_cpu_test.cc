@@ -0,0 +1,173 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#define EIGEN_USE_THREADS
+
+#include <vector>
+
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/transpose_functor.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+TensorShape TransposedShape(const TensorShape& shape,
+                            const std::vector<int32>& perm) {
+  TensorShape transposed;
+  for (int32 d : perm) transposed.AddDim(shape.dim_size(d));
+  return transposed;
+}
+
+// Transposes `in` one element at a time.
+template <typename T>
+Tensor ReferenceTranspose(const Tensor& in, const std::vector<int32>& perm) {
+  Tensor out(in.dtype(), TransposedShape(in.shape(), perm));
+  const int ndims = in.dims();
+  const auto in_flat = in.flat<T>();
+  auto out_flat = out.flat<T>();
+  std::vector<int64_t> out_index(ndims, 0);
+  for (int64_t o = 0; o < out.NumElements(); ++o) {
+    int64_t i = 0;
+    for (int d = 0; d < ndims; ++d) {
+      int64_t in_index = 0;
+      for (int k = 0; k < ndims; ++k) {
+        if (perm[k] == d) in_index = out_index[k];
+      }
+      i = i * in.dim_size(d) + in_index;
+    }
+    out_flat(o) = in_flat(i);
+    for (int k = ndims - 1; k >= 0; --k) {
+      if (++out_index[k] < out.dim_size(k)) break;
+      out_index[k] = 0;
+    }
+  }
+  return out;
+}
+
+class TransposeFunctorCpuTest : public ::testing::Test {
+ protected:
+  TransposeFunctorCpuTest()
+      : pool_(Env::Default(), "test", /*num_threads=*/4),
+        device_(pool_.AsEigenThreadPool(), pool_.NumThreads()) {}
+
+  template <typename T>
+  void TestTranspose(const TensorShape& shape,
+                     const std::vector<int32>& perm) {
+    Tensor in(DataTypeToEnum<T>::v(), shape);
+    auto in_flat = in.flat<T>();
+    for (int64_t i = 0; i < in.NumElements(); ++i) {
+      in_flat(i) = static_cast<T>(i % 101);
+    }
+    Tensor out(in.dtype(), TransposedShape(shape, perm));
+    TF_ASSERT_OK(DoTranspose(device_, in, perm, &out));
+    test::ExpectTensorEqual<T>(out, ReferenceTranspose<T>(in, perm));
+  }
+
+  template <typename T>
+  void TestAllPermutations() {
+    // Sizes that are not multiples of the tile size exercise partial tiles.
+    TestTranspose<T>(TensorShape({37, 71}), {1, 0});
+    TestTranspose<T>(TensorShape({64, 128}), {1, 0});
+    TestTranspose<T>(TensorShape({3, 19, 45}), {0, 2, 1});
+    TestTranspose<T>(TensorShape({3, 19, 45}), {2, 1, 0});
+    TestTranspose<T>(TensorShape({3, 19, 45}), {1, 2, 0});
+    TestTranspose<T>(TensorShape({2, 5, 33, 17}), {0, 2, 3, 1});
+    TestTranspose<T>(TensorShape({2, 5, 33, 17}), {0, 3, 1, 2});
+    TestTranspose<T>(TensorShape({2, 5, 33, 17}), {3, 1, 0, 2});
+    TestTranspose<T>(TensorShape({2, 5, 33, 17}), {0, 2, 1, 3});
+    TestTranspose<T>(TensorShape({2, 3, 4, 9, 10}), {4, 2, 0, 3, 1});
+    TestTranspose<T>(TensorShape({1, 40, 1, 20}), {3, 2, 1, 0});
+  }
+
+  thread::ThreadPool pool_;
+  CPUDevice device_;
+};
+
+TEST_F(TransposeFunctorCpuTest, Int8) { TestAllPermutations<int8>(); }
+
+TEST_F(TransposeFunctorCpuTest, Int16) { TestAllPermutations<int16>(); }
+
+TEST_F(TransposeFunctorCpuTest, Float) { TestAllPermutations<float>(); }
+
+TEST_F(TransposeFunctorCpuTest, Double) { TestAllPermutations<double>(); }
+
+TEST_F(TransposeFunctorCpuTest, Complex128) {
+  TestAllPermutations<complex128>();
+}
+
+TEST_F(TransposeFunctorCpuTest, Empty) {
+  Tensor in(DT_FLOAT, TensorShape({0, 5, 3}));
+  Tensor out(DT_FLOAT, TensorShape({3, 5, 0}));
+  TF_ASSERT_OK(DoTranspose(device_, in, {2, 1, 0}, &out));
+}
+
+// Permutation of the attention heads of a [batch, seq, heads, depth] tensor.
+constexpr int kBatch = 8;
+constexpr int kSeq = 512;
+constexpr int kHeads = 16;
+constexpr int kDepth = 64;
+
+template <typename T>
+void BM_Transpose(::testing::benchmark::State& state, bool use_eigen) {
+  const int num_threads = state.range(0);
+  const std::vector<int32> perm = {0, 2, 3, 1};
+  thread::ThreadPool pool(Env::Default(), "bench", num_threads);
+  CPUDevice device(pool.AsEigenThreadPool(), num_threads);
+  Tensor in(DataTypeToEnum<T>::v(),
+            TensorShape({kBatch, kSeq, kHeads, kDepth}));
+  in.flat<T>().setZero();
+  Tensor out(in.dtype(), TransposedShape(in.shape(), perm));
+  for (auto s : state) {
+    if (use_eigen) {
+      internal::TransposeUsingEigen<CPUDevice, T, 4>(device, in, perm,
+                                                     /*conjugate=*/false,
+                                                     &out);
+    } else {
+      TF_CHECK_OK(DoTranspose(device, in, perm, &out));
+    }
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * 2 *
+                          in.TotalBytes());
+}
+
+#define BM_TRANSPOSE(T)                                                   \
+  void BM_TransposeTiled_##T(::testing::benchmark::State& state) {        \
+    BM_Transpose<T>(state, /*use_eigen=*/false);                          \
+  }                                                                       \
+  void BM_TransposeEigen_##T(::testing::benchmark::State& state) {        \
+    BM_Transpose<T>(state, /*use_eigen=*/true);                           \
+  }                                                                       \
+  BENCHMARK(BM_TransposeTiled_##T)->UseRealTime()->Arg(1)->Arg(4)->Arg(8); \
+  BENCHMARK(BM_TransposeEigen_##T)->UseRealTime()->Arg(1)->Arg(4)->Arg(8);
+
+BM_TRANSPOSE(uint8);
+BM_TRANSPOSE(uint16);
+BM_TRANSPOSE(float);
+
+#undef BM_TRANSPOSE
+
+}  // namespace
+}  // namespace tensorflow
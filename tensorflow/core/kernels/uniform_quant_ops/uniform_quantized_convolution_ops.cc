@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/util/quantization/uniform_quant_ops_attr.pb.h"
 #include "tensorflow/core/util/quantization/uniform_quant_ops_params.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -205,10 +206,14 @@ void PadAndDilateTransposedLhs(
 // Quantized Conv on padded and dilated transposed lhs and transposed rhs, given
 // acc_f to calculate each value to accumulate, and out_f to calculate output
 // value on each accumulated value.
+//
+// The output spatial indices are split across the CPU worker threads. The lhs
+// spatial index of each rhs spatial index only depends on the output spatial
+// index, so it is computed once for all the batches and features.
 template <typename Tlhs, typename Trhs, typename Tout, typename AccF,
           typename OutF>
 void ConvWithAccFunctionAndOutFunction(
-    const Tensor& lhs, const Tensor& rhs,
+    OpKernelContext* context, const Tensor& lhs, const Tensor& rhs,
     const UniformQuantizedConvolutionParams& convolution_params, Tensor& out,
     const AccF& acc_f, const OutF& out_f) {
   const int64_t out_feature_group_size_by_feature_group_count =
@@ -219,59 +224,74 @@ void ConvWithAccFunctionAndOutFunction(
   auto lhs_tensor = lhs.flat_outer_dims<Tlhs, 3>();
   auto rhs_tensor = rhs.flat_outer_dims<Trhs, 3>();
   auto out_tensor = out.flat_outer_dims<Tout, 3>();
+  const int64_t rhs_spatial_size = rhs_tensor.dimension(2);
+
+  auto compute_spatial_range = [&](int64_t start, int64_t limit) {
+    std::vector<int64_t> lhs_spatial_idxs(rhs_spatial_size);
+    // Iter out spatial.
+    for (int64_t out_spatial_idx = start; out_spatial_idx < limit;
+         ++out_spatial_idx) {
+      for (int64_t rhs_spatial_idx = 0; rhs_spatial_idx < rhs_spatial_size;
+           ++rhs_spatial_idx) {
+        lhs_spatial_idxs[rhs_spatial_idx] = ConvolutionTransposedLhsSpatialIdx(
+            convolution_params, lhs.shape(), rhs.shape(), out.shape(),
+            rhs_spatial_idx, out_spatial_idx);
+      }
 
-  // Iter out batch.
-  for (int64_t out_batch_idx = 0; out_batch_idx < out_tensor.dimension(0);
-       ++out_batch_idx) {
-    // Iter out feature.
-    for (int64_t out_feature_idx = 0; out_feature_idx < out_tensor.dimension(1);
-         ++out_feature_idx) {
-      const int64_t lhs_batch_idx =
-          (out_feature_idx / out_feature_group_size_by_batch_group_count) *
-              out_tensor.dimension(0) +
-          out_batch_idx;
-
-      // Iter out spatial.
-      for (int out_spatial_idx = 0; out_spatial_idx < out_tensor.dimension(2);
-           ++out_spatial_idx) {
-        int32_t acc = 0;
-
-        // Iter rhs input feature.
-        for (int64_t rhs_in_feature_idx = 0;
-             rhs_in_feature_idx < rhs_tensor.dimension(1);
-             ++rhs_in_feature_idx) {
-          const int64_t lhs_feature_idx =
-              (out_feature_idx /
-               out_feature_group_size_by_feature_group_count) *
-                  rhs_tensor.dimension(1) +
-              rhs_in_feature_idx;
-
-          // Iter rhs spatial.
-          for (int64_t rhs_spatial_idx = 0;
-               rhs_spatial_idx < rhs_tensor.dimension(2); ++rhs_spatial_idx) {
-            const int64_t lhs_spatial_idx = ConvolutionTransposedLhsSpatialIdx(
-                convolution_params, lhs.shape(), rhs.shape(), out.shape(),
-                rhs_spatial_idx, out_spatial_idx);
-            const Tlhs lhs_val =
-                lhs_tensor(lhs_batch_idx, lhs_feature_idx, lhs_spatial_idx);
-            const Trhs rhs_val = rhs_tensor(out_feature_idx, rhs_in_feature_idx,
-                                            rhs_spatial_idx);
-            acc += acc_f(lhs_val, rhs_val, lhs_batch_idx, out_feature_idx);
+      // Iter out batch.
+      for (int64_t out_batch_idx = 0; out_batch_idx < out_tensor.dimension(0);
+           ++out_batch_idx) {
+        // Iter out feature.
+        for (int64_t out_feature_idx = 0;
+             out_feature_idx < out_tensor.dimension(1); ++out_feature_idx) {
+          const int64_t lhs_batch_idx =
+              (out_feature_idx / out_feature_group_size_by_batch_group_count) *
+                  out_tensor.dimension(0) +
+              out_batch_idx;
+          int32_t acc = 0;
+
+          // Iter rhs input feature.
+          for (int64_t rhs_in_feature_idx = 0;
+               rhs_in_feature_idx < rhs_tensor.dimension(1);
+               ++rhs_in_feature_idx) {
+            const int64_t lhs_feature_idx =
+                (out_feature_idx /
+                 out_feature_group_size_by_feature_group_count) *
+                    rhs_tensor.dimension(1) +
+                rhs_in_feature_idx;
+
+            // Iter rhs spatial.
+            for (int64_t rhs_spatial_idx = 0;
+                 rhs_spatial_idx < rhs_spatial_size; ++rhs_spatial_idx) {
+              const Tlhs lhs_val =
+                  lhs_tensor(lhs_batch_idx, lhs_feature_idx,
+                             lhs_spatial_idxs[rhs_spatial_idx]);
+              const Trhs rhs_val = rhs_tensor(
+                  out_feature_idx, rhs_in_feature_idx, rhs_spatial_idx);
+              acc += acc_f(lhs_val, rhs_val, lhs_batch_idx, out_feature_idx);
+            }
           }
-        }
 
-        out_tensor(out_batch_idx, out_feature_idx, out_spatial_idx) =
-            out_f(acc, lhs_batch_idx, out_feature_idx);
+          out_tensor(out_batch_idx, out_feature_idx, out_spatial_idx) =
+              out_f(acc, lhs_batch_idx, out_feature_idx);
+        }
       }
     }
-  }
+  };
+  const auto& worker_threads =
+      *context->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads.num_threads, worker_threads.workers,
+        out_tensor.dimension(2),
+        /*cost_per_unit=*/out_tensor.dimension(0) * out_tensor.dimension(1) *
+            rhs_tensor.dimension(1) * rhs_spatial_size * 3,
+        compute_spatial_range);
 }
 
 // Quantized Conv on per-tensor quantized padded and dilated transposed lhs and
 // per-tensor quantized transposed rhs.
 template <typename Tin, typename Tout>
 Status EvalLhsPerTensorAndRhsPerTensorQuantizedConv(
-    const Tensor& lhs, const Tensor& rhs,
+    OpKernelContext* context, const Tensor& lhs, const Tensor& rhs,
     const UniformQuantizedConvolutionParams& convolution_params,
     const float lhs_scale, const int32_t lhs_zero_point, const float rhs_scale,
     const int32_t rhs_zero_point, const float output_scale,
@@ -285,7 +305,7 @@ Status EvalLhsPerTensorAndRhsPerTensorQuantizedConv(
       effective_multiplier, effective_quantized_multiplier, effective_shift));
 
   ConvWithAccFunctionAndOutFunction<Tin, Tin, Tout>(
-      lhs, rhs, convolution_params, out,
+      context, lhs, rhs, convolution_params, out,
       /*acc_f=*/
       [lhs_zero_point, rhs_zero_point](Tin lhs_val, Tin rhs_val,
                                        int64_t lhs_batch_idx,
@@ -361,7 +381,7 @@ Status EvalLhsPerTensorAndRhsPerChannelQuantizedConv(
   const int32_t* output_zero_points_data =
       output_zero_points.flat<int32_t>().data();
   ConvWithAccFunctionAndOutFunction<Tin, Tin, Tout>(
-      lhs, rhs, convolution_params, out,
+      context, lhs, rhs, convolution_params, out,
       /*acc_f=*/
       [lhs_zero_point, rhs_zero_points_data](Tin lhs_val, Tin rhs_val,
                                              int64_t lhs_batch_idx,
@@ -398,7 +418,7 @@ void EvalLhsPerBatchAndRhsPerTensorQuantizedConv(
   const int32_t* lhs_zero_points_data = lhs_zero_points.flat<int32_t>().data();
 
   ConvWithAccFunctionAndOutFunction<Tlhs, Trhs, float>(
-      lhs, rhs, convolution_params, out,
+      context, lhs, rhs, convolution_params, out,
       /*acc_f=*/
       [lhs_zero_points_data, rhs_zero_point](Tlhs lhs_val, Trhs rhs_val,
                                              int64_t lhs_batch_idx,
@@ -418,7 +438,7 @@ void EvalLhsPerBatchAndRhsPerTensorQuantizedConv(
 // per-channel quantized transposed rhs.
 template <typename Tlhs, typename Trhs>
 void EvalLhsPerBatchAndRhsPerChannelQuantizedConv(
-    const Tensor& lhs, const Tensor& rhs,
+    OpKernelContext* context, const Tensor& lhs, const Tensor& rhs,
     const UniformQuantizedConvolutionParams& convolution_params,
     const Tensor& lhs_scales, const Tensor& lhs_zero_points,
     const Tensor& rhs_scales, const Tensor& rhs_zero_points, Tensor& out) {
@@ -428,7 +448,7 @@ void EvalLhsPerBatchAndRhsPerChannelQuantizedConv(
   const int32_t* rhs_zero_points_data = rhs_zero_points.flat<int32_t>().data();
 
   ConvWithAccFunctionAndOutFunction<Tlhs, Trhs, float>(
-      lhs, rhs, convolution_params, out,
+      context, lhs, rhs, convolution_params, out,
       /*acc_f=*/
       [lhs_zero_points_data, rhs_zero_points_data](Tlhs lhs_val, Trhs rhs_val,
                                                    int64_t lhs_batch_idx,
@@ -500,8 +520,8 @@ Status EvalQuantizedConv(
     const float output_scale = output_scales.scalar<float>()();
     const int32_t output_zero_point = output_zero_points.scalar<int32_t>()();
     TF_RETURN_IF_ERROR(EvalLhsPerTensorAndRhsPerTensorQuantizedConv<Tin, Tout>(
-        lhs_padded_and_dilated, rhs_transposed, convolution_params, lhs_scale,
-        lhs_zero_point, rhs_scale, rhs_zero_point, output_scale,
+        context, lhs_padded_and_dilated, rhs_transposed, convolution_params,
+        lhs_scale, lhs_zero_point, rhs_scale, rhs_zero_point, output_scale,
         output_zero_point, output_quantization_min_val,
         output_quantization_max_val, out_transposed));
   }
@@ -581,8 +601,9 @@ Status EvalHybridConv(
 
   if (rhs_scales.dims() != 0) {
     EvalLhsPerBatchAndRhsPerChannelQuantizedConv<TlhsQuant, Trhs>(
-        lhs_padded_and_dilated, rhs_transposed, convolution_params, lhs_scales,
-        lhs_zero_points, rhs_scales, rhs_zero_points, out_transposed);
+        context, lhs_padded_and_dilated, rhs_transposed, convolution_params,
+        lhs_scales, lhs_zero_points, rhs_scales, rhs_zero_points,
+        out_transposed);
   } else {
     EvalLhsPerBatchAndRhsPerTensorQuantizedConv<TlhsQuant, Trhs>(
         context, lhs_padded_and_dilated, rhs_transposed, convolution_params,
@@ -13,9 +13,13 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
+#include <vector>
+
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/kernels/uniform_quant_ops/math_utils.h"
 #include "tensorflow/core/kernels/uniform_quant_ops/tensor_utils.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -42,46 +46,101 @@ Status DotInputShapeValid(const TensorShape& lhs_shape,
   return absl::OkStatus();
 }
 
+// Number of output channels of a row of the output computed by a unit of work
+// of DotWithZeroPointsAndOutputFunction.
+constexpr int64_t kDotOutputChannelBlockSize = 256;
+
 // Performs dot(lhs, rhs) and writes output to output. Assumes that output is
 // already allocated with correct size.
 //
 // Given
-// int32_t acc_f(Tlhs lhs_val, Trhs rhs_val, int64_t batch_idx,
-//     int64_t output_channel_idx)
+// int32_t lhs_zero_point_f(int64_t batch_idx),
+// int32_t rhs_zero_point_f(int64_t output_channel_idx)
 // and
 // int32_t output_f(int32_t acc_val, int64_t batch_idx,
 //     int64_t output_channel_idx)
-// for each output element, accumulate value using acc_f along the contracting
-// dimension and writes the accumulated value using output_f.
-template <typename Tlhs, typename Trhs, typename Tout, typename AccF,
-          typename OutputF>
-void DotWithAccFunctionAndOutputFunction(const Tensor& lhs, const Tensor& rhs,
-                                         Tensor& output, const AccF& acc_f,
-                                         const OutputF& output_f) {
+// for each output element, accumulates
+// (lhs_val - lhs_zero_point) * (rhs_val - rhs_zero_point) along the
+// contracting dimension and writes the accumulated value using output_f.
+//
+// The accumulated value is computed as
+// sum(lhs_val * rhs_val) - lhs_zero_point * sum(rhs_val)
+//     - rhs_zero_point * sum(lhs_val) + depth * lhs_zero_point * rhs_zero_point
+// so that the inner loop is a plain multiply-add over a contiguous row of rhs.
+// Rows of the output are computed in blocks of output channels on the CPU
+// worker threads.
+template <typename Tlhs, typename Trhs, typename Tout, typename LhsZeroPointF,
+          typename RhsZeroPointF, typename OutputF>
+void DotWithZeroPointsAndOutputFunction(OpKernelContext* context,
+                                        const Tensor& lhs, const Tensor& rhs,
+                                        Tensor& output,
+                                        const LhsZeroPointF& lhs_zero_point_f,
+                                        const RhsZeroPointF& rhs_zero_point_f,
+                                        const OutputF& output_f) {
   const int64_t batches = output.dim_size(0);
   const int64_t output_depth = output.dim_size(1);
   const int64_t accum_depth = rhs.dim_size(0);
+  if (batches == 0 || output_depth == 0) return;
 
   const Tlhs* lhs_data = lhs.flat<Tlhs>().data();
   const Trhs* rhs_data = rhs.flat<Trhs>().data();
   Tout* output_data = output.flat<Tout>().data();
 
-  for (int64_t b = 0; b < batches; ++b) {
+  std::vector<int32_t> rhs_sums(output_depth, 0);
+  for (int64_t d = 0; d < accum_depth; ++d) {
+    const Trhs* rhs_row = rhs_data + d * output_depth;
     for (int64_t out_c = 0; out_c < output_depth; ++out_c) {
-      int32_t acc = 0;
+      rhs_sums[out_c] += static_cast<int32_t>(rhs_row[out_c]);
+    }
+  }
+
+  const int64_t blocks_per_batch =
+      (output_depth + kDotOutputChannelBlockSize - 1) /
+      kDotOutputChannelBlockSize;
+  auto compute_blocks = [&](int64_t start, int64_t limit) {
+    std::vector<int32_t> acc(kDotOutputChannelBlockSize);
+    for (int64_t block = start; block < limit; ++block) {
+      const int64_t b = block / blocks_per_batch;
+      const int64_t block_start =
+          (block % blocks_per_batch) * kDotOutputChannelBlockSize;
+      const int64_t block_size = std::min(kDotOutputChannelBlockSize,
+                                          output_depth - block_start);
+      std::fill(acc.begin(), acc.end(), 0);
+      int32_t lhs_sum = 0;
       for (int64_t d = 0; d < accum_depth; ++d) {
-        acc += acc_f(lhs_data[b * accum_depth + d],
-                     rhs_data[d * output_depth + out_c], b, out_c);
+        const int32_t lhs_val =
+            static_cast<int32_t>(lhs_data[b * accum_depth + d]);
+        lhs_sum += lhs_val;
+        const Trhs* rhs_row = rhs_data + d * output_depth + block_start;
+        for (int64_t i = 0; i < block_size; ++i) {
+          acc[i] += lhs_val * static_cast<int32_t>(rhs_row[i]);
+        }
+      }
+      const int64_t lhs_zero_point = lhs_zero_point_f(b);
+      for (int64_t i = 0; i < block_size; ++i) {
+        const int64_t out_c = block_start + i;
+        const int64_t rhs_zero_point = rhs_zero_point_f(out_c);
+        const int64_t correction =
+            accum_depth * lhs_zero_point * rhs_zero_point -
+            lhs_zero_point * rhs_sums[out_c] - rhs_zero_point * lhs_sum;
+        output_data[b * output_depth + out_c] = output_f(
+            static_cast<int32_t>(acc[i] + correction), b, out_c);
       }
-      output_data[b * output_depth + out_c] = output_f(acc, b, out_c);
     }
-  }
+  };
+  const auto& worker_threads =
+      *context->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads.num_threads, worker_threads.workers,
+        batches * blocks_per_batch,
+        /*cost_per_unit=*/accum_depth * kDotOutputChannelBlockSize * 2,
+        compute_blocks);
 }
 
 // Performs dot on per-tensor quantized lhs and per-tensor quantized rhs.
 template <typename Tin, typename Tout>
 Status EvalLhsPerTensorAndRhsPerTensorQuantizedDot(
-    const Tensor& lhs, const Tensor& rhs, float lhs_scale,
+    OpKernelContext* context, const Tensor& lhs, const Tensor& rhs,
+    float lhs_scale,
     int32_t lhs_zero_point, float rhs_scale, int32_t rhs_zero_point,
     float output_scale, int32_t output_zero_point,
     int output_quantization_min_val, int output_quantization_max_val,
@@ -93,14 +152,10 @@ Status EvalLhsPerTensorAndRhsPerTensorQuantizedDot(
   TF_RETURN_IF_ERROR(QuantizeMultiplier(
       effective_multiplier, effective_quantized_multiplier, effective_shift));
 
-  DotWithAccFunctionAndOutputFunction<Tin, Tin, Tout>(
-      lhs, rhs, output,
-      [lhs_zero_point, rhs_zero_point](Tin lhs_val, Tin rhs_val, int64_t b,
-                                       int64_t out_c) {
-        return static_cast<Tout>(
-            (static_cast<int32_t>(lhs_val) - lhs_zero_point) *
-            (static_cast<int32_t>(rhs_val) - rhs_zero_point));
-      },
+  DotWithZeroPointsAndOutputFunction<Tin, Tin, Tout>(
+      context, lhs, rhs, output,
+      [lhs_zero_point](int64_t b) { return lhs_zero_point; },
+      [rhs_zero_point](int64_t out_c) { return rhs_zero_point; },
       [effective_quantized_multiplier, effective_shift, output_zero_point,
        output_quantization_min_val,
        output_quantization_max_val](int32_t acc, int64_t b, int64_t out_c) {
@@ -160,12 +215,11 @@ Status EvalLhsPerTensorAndRhsPerChannelQuantizedDot(
 
   const int32_t* output_zero_points_data =
       output_zero_points.flat<int32_t>().data();
-  DotWithAccFunctionAndOutputFunction<Tin, Tin, Tout>(
-      lhs, rhs, output,
-      [lhs_zero_point, rhs_zero_points_data](Tin lhs_val, Tin rhs_val,
-                                             int64_t b, int64_t out_c) {
-        return (static_cast<int32_t>(lhs_val) - lhs_zero_point) *
-               (static_cast<int32_t>(rhs_val) - rhs_zero_points_data[out_c]);
+  DotWithZeroPointsAndOutputFunction<Tin, Tin, Tout>(
+      context, lhs, rhs, output,
+      [lhs_zero_point](int64_t b) { return lhs_zero_point; },
+      [rhs_zero_points_data](int64_t out_c) {
+        return rhs_zero_points_data[out_c];
       },
       [effective_quantized_multipliers_data, effective_shifts_data,
        output_zero_points_data, output_quantization_min_val,
@@ -191,13 +245,10 @@ void EvalLhsPerBatchAndRhsPerTensorQuantizedDot(
   const float* lhs_scales_data = lhs_scales.flat<float>().data();
   const int32_t* lhs_zero_points_data = lhs_zero_points.flat<int32_t>().data();
 
-  DotWithAccFunctionAndOutputFunction<Tlhs, Trhs, float>(
-      lhs, rhs, output,
-      [lhs_zero_points_data, rhs_zero_point](Tlhs lhs_val, Trhs rhs_val,
-                                             int64_t b, int64_t out_c) {
-        return (static_cast<int32_t>(lhs_val) - lhs_zero_points_data[b]) *
-               (static_cast<int32_t>(rhs_val) - rhs_zero_point);
-      },
+  DotWithZeroPointsAndOutputFunction<Tlhs, Trhs, float>(
+      context, lhs, rhs, output,
+      [lhs_zero_points_data](int64_t b) { return lhs_zero_points_data[b]; },
+      [rhs_zero_point](int64_t out_c) { return rhs_zero_point; },
       [lhs_scales_data, rhs_scale](int32_t acc, int64_t b, int64_t out_c) {
         return acc * lhs_scales_data[b] * rhs_scale;
       });
@@ -207,20 +258,19 @@ void EvalLhsPerBatchAndRhsPerTensorQuantizedDot(
 // (dimension 1) quantized rhs.
 template <typename Tlhs, typename Trhs>
 void EvalLhsPerBatchAndRhsPerChannelQuantizedDot(
-    const Tensor& lhs, const Tensor& rhs, const Tensor& lhs_scales,
-    const Tensor& lhs_zero_points, const Tensor& rhs_scales,
-    const Tensor& rhs_zero_points, Tensor& output) {
+    OpKernelContext* context, const Tensor& lhs, const Tensor& rhs,
+    const Tensor& lhs_scales, const Tensor& lhs_zero_points,
+    const Tensor& rhs_scales, const Tensor& rhs_zero_points, Tensor& output) {
   const float* lhs_scales_data = lhs_scales.flat<float>().data();
   const int32_t* lhs_zero_points_data = lhs_zero_points.flat<int32_t>().data();
   const float* rhs_scales_data = rhs_scales.flat<float>().data();
   const int32_t* rhs_zero_points_data = rhs_zero_points.flat<int32_t>().data();
 
-  DotWithAccFunctionAndOutputFunction<Tlhs, Trhs, float>(
-      lhs, rhs, output,
-      [lhs_zero_points_data, rhs_zero_points_data](Tlhs lhs_val, Trhs rhs_val,
-                                                   int64_t b, int64_t out_c) {
-        return (static_cast<int32_t>(lhs_val) - lhs_zero_points_data[b]) *
-               (static_cast<int32_t>(rhs_val) - rhs_zero_points_data[out_c]);
+  DotWithZeroPointsAndOutputFunction<Tlhs, Trhs, float>(
+      context, lhs, rhs, output,
+      [lhs_zero_points_data](int64_t b) { return lhs_zero_points_data[b]; },
+      [rhs_zero_points_data](int64_t out_c) {
+        return rhs_zero_points_data[out_c];
       },
       [lhs_scales_data, rhs_scales_data](int32_t acc, int64_t b,
                                          int64_t out_c) {
@@ -253,7 +303,7 @@ Status EvalQuantizedDot(OpKernelContext* context, const Tensor& lhs,
     const float output_scale = output_scales.scalar<float>()();
     const int32_t output_zero_point = output_zero_points.scalar<int32_t>()();
     return EvalLhsPerTensorAndRhsPerTensorQuantizedDot<Tin, Tout>(
-        lhs, rhs, lhs_scale, lhs_zero_point, rhs_scale, rhs_zero_point,
+        context, lhs, rhs, lhs_scale, lhs_zero_point, rhs_scale, rhs_zero_point,
         output_scale, output_zero_point, output_quantization_min_val,
         output_quantization_max_val, output);
   }
@@ -292,7 +342,7 @@ Status EvalHybridDot(OpKernelContext* context, const Tensor& lhs,
   }
   if (rhs_scales.dims() != 0) {
     EvalLhsPerBatchAndRhsPerChannelQuantizedDot<qint8, Trhs>(
-        lhs_quantized, rhs, lhs_scales, lhs_zero_points, rhs_scales,
+        context, lhs_quantized, rhs, lhs_scales, lhs_zero_points, rhs_scales,
         rhs_zero_points, output);
   } else {
     EvalLhsPerBatchAndRhsPerTensorQuantizedDot<qint8, Trhs>(
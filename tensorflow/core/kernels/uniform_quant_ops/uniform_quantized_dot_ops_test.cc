@@ -12,6 +12,8 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <vector>
+
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
@@ -208,6 +210,73 @@ TEST_F(UniformQuantizedDotTest, PerChannelQuantizedEffectiveMultiplierOne) {
   test::ExpectTensorEqual<qint32>(expected, *GetOutput(0));
 }
 
+TEST_F(UniformQuantizedDotTest, PerChannelQuantizedManyOutputChannels) {
+  TF_ASSERT_OK(
+      NodeDefBuilder("test", "UniformQuantizedDot")
+          .Input(FakeInput(DT_QINT8))
+          .Input(FakeInput(DT_QINT8))
+          .Input(FakeInput(DT_FLOAT))
+          .Input(FakeInput(DT_INT32))
+          .Input(FakeInput(DT_FLOAT))
+          .Input(FakeInput(DT_INT32))
+          .Input(FakeInput(DT_FLOAT))
+          .Input(FakeInput(DT_INT32))
+          .Attr("Tin", DT_QINT8)
+          .Attr("Tout", DT_QINT32)
+          .Attr("lhs_quantization_min_val", -128)
+          .Attr("lhs_quantization_max_val", 127)
+          .Attr("rhs_quantization_min_val", -128)
+          .Attr("rhs_quantization_max_val", 127)
+          .Attr("rhs_quantization_axis", 1)
+          .Attr("output_quantization_axis", 1)
+          .Attr("output_quantization_min_val",
+                static_cast<int32_t>(-2147483648))
+          .Attr("output_quantization_max_val", static_cast<int32_t>(2147483647))
+          .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+
+  // Enough output channels to span several blocks of the kernel.
+  constexpr int kBatches = 3;
+  constexpr int kDepth = 20;
+  constexpr int kChannels = 600;
+  constexpr int kLhsZeroPoint = 3;
+  std::vector<qint8> lhs(kBatches * kDepth);
+  for (int i = 0; i < lhs.size(); ++i) lhs[i] = (i * 7) % 23 - 11;
+  std::vector<qint8> rhs(kDepth * kChannels);
+  for (int i = 0; i < rhs.size(); ++i) rhs[i] = (i * 13) % 29 - 14;
+  std::vector<int32_t> rhs_zero_points(kChannels);
+  for (int c = 0; c < kChannels; ++c) rhs_zero_points[c] = c % 5 - 2;
+
+  AddInputFromArray<qint8>(TensorShape({kBatches, kDepth}), lhs);
+  AddInputFromArray<qint8>(TensorShape({kDepth, kChannels}), rhs);
+  AddInputFromArray<float>(TensorShape({}), {1.0});
+  AddInputFromArray<int32>(TensorShape({}), {kLhsZeroPoint});
+  AddInputFromArray<float>(TensorShape({kChannels}),
+                           std::vector<float>(kChannels, 1.0));
+  AddInputFromArray<int32>(TensorShape({kChannels}), rhs_zero_points);
+  AddInputFromArray<float>(TensorShape({kChannels}),
+                           std::vector<float>(kChannels, 1.0));
+  AddInputFromArray<int32>(TensorShape({kChannels}),
+                           std::vector<int32>(kChannels, 0));
+
+  TF_ASSERT_OK(RunOpKernel());
+  std::vector<qint32> expected_values(kBatches * kChannels);
+  for (int b = 0; b < kBatches; ++b) {
+    for (int c = 0; c < kChannels; ++c) {
+      int32_t acc = 0;
+      for (int d = 0; d < kDepth; ++d) {
+        acc += (static_cast<int32_t>(lhs[b * kDepth + d]) - kLhsZeroPoint) *
+               (static_cast<int32_t>(rhs[d * kChannels + c]) -
+                rhs_zero_points[c]);
+      }
+      expected_values[b * kChannels + c] = acc;
+    }
+  }
+  Tensor expected(allocator(), DT_QINT32, TensorShape({kBatches, kChannels}));
+  test::FillValues<qint32>(&expected, expected_values);
+  test::ExpectTensorEqual<qint32>(expected, *GetOutput(0));
+}
+
 TEST_F(UniformQuantizedDotTest, HybridPerTensorQuantized) {
   TF_ASSERT_OK(NodeDefBuilder("test", "UniformQuantizedDotHybrid")
                    .Input(FakeInput(DT_FLOAT))
@@ -13,9 +13,12 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
@@ -26,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace {
@@ -68,6 +72,10 @@ struct UniqueOpHashMap<bfloat16, TIndex> {
   using map_type = std::unordered_map<bfloat16, TIndex>;
 };
 
+// Inputs with at least this many elements are deduplicated in parallel when
+// unique is run over single elements.
+constexpr int64_t kParallelUniqueMinSize = 64 * 1024;
+
 // `UniqueOp` computes the unique elements in the input tensor.
 //
 // * `T` is the element type.
@@ -143,7 +151,16 @@ class UniqueOp : public OpKernel {
     auto idx_vec = idx->template vec<TIndex>();
 
     int64_t uniq_size;
-    if (new_sizes[0] == 1 && new_sizes[2] == 1) {
+    bool counts_computed = false;
+    auto* worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    if (new_sizes[0] == 1 && new_sizes[2] == 1 &&
+        new_sizes[1] >= kParallelUniqueMinSize &&
+        worker_threads->num_threads > 1) {
+      ComputeParallel(context, input, axis, worker_threads->workers, idx_vec,
+                      &uniq_size);
+      if (!context->status().ok()) return;
+      counts_computed = true;
+    } else if (new_sizes[0] == 1 && new_sizes[2] == 1) {
       // Specialized and faster implementation when unique is run over single
       // elements. Here we put T directly into the map rather than ints pointing
       // to them as in the general case.
@@ -225,7 +242,7 @@ class UniqueOp : public OpKernel {
       }
     }
 
-    if (num_outputs() > 2) {
+    if (num_outputs() > 2 && !counts_computed) {
       Tensor* output = nullptr;
       OP_REQUIRES_OK(context, context->allocate_output(
                                   2, TensorShape({uniq_size}), &output));
@@ -237,6 +254,156 @@ class UniqueOp : public OpKernel {
       }
     }
   }
+
+ private:
+  using MapType = typename UniqueOpHashMap<T, TIndex>::map_type;
+
+  // Parallel version of the single element case. Elements are partitioned by
+  // hash so that each partition can be deduplicated by a single thread, then
+  // the unique elements are numbered in the order of their first occurrence,
+  // which gives the same outputs as the sequential loop. Also computes the
+  // counts output, if any.
+  void ComputeParallel(OpKernelContext* context, const Tensor& input,
+                       int64_t axis, thread::ThreadPool* workers,
+                       typename TTypes<TIndex>::Vec idx_vec,
+                       int64_t* uniq_size) {
+    using Key = typename MapType::key_type;
+    auto Tin = input.flat<T>();
+    const int64_t N = static_cast<int64_t>(Tin.size());
+    const int num_partitions = 2 * workers->NumThreads();
+    const int64_t num_blocks = num_partitions;
+    const int64_t block_size = (N + num_blocks - 1) / num_blocks;
+    // Time to hash and look up one element, roughly.
+    const int64_t kCostPerElement = 100;
+    const typename MapType::hasher hasher;
+    auto partition_of = [&](int64_t i) {
+      // Use the high bits of the hash, the maps use the low ones.
+      const uint64_t h = static_cast<uint64_t>(hasher(Key(Tin(i)))) *
+                         0x9E3779B97F4A7C15ULL;
+      return static_cast<int>((h >> 32) % num_partitions);
+    };
+    auto for_each_block = [&](const std::function<void(int64_t, int64_t,
+                                                       int64_t)>& fn) {
+      workers->ParallelFor(num_blocks, block_size * kCostPerElement,
+                           [&](int64_t begin, int64_t end) {
+                             for (int64_t b = begin; b < end; ++b) {
+                               fn(b, b * block_size,
+                                  std::min(N, (b + 1) * block_size));
+                             }
+                           });
+    };
+
+    // Assign each element to a partition, and lay out the positions of the
+    // elements of each partition contiguously, in input order.
+    std::vector<int> partition(N);
+    std::vector<int64_t> offsets(num_blocks * num_partitions, 0);
+    for_each_block([&](int64_t b, int64_t begin, int64_t end) {
+      int64_t* counts = &offsets[b * num_partitions];
+      for (int64_t i = begin; i < end; ++i) {
+        partition[i] = partition_of(i);
+        ++counts[partition[i]];
+      }
+    });
+    std::vector<int64_t> partition_starts(num_partitions + 1, 0);
+    int64_t total = 0;
+    for (int p = 0; p < num_partitions; ++p) {
+      partition_starts[p] = total;
+      for (int64_t b = 0; b < num_blocks; ++b) {
+        const int64_t count = offsets[b * num_partitions + p];
+        offsets[b * num_partitions + p] = total;
+        total += count;
+      }
+    }
+    partition_starts[num_partitions] = total;
+    std::vector<int64_t> positions(N);
+    for_each_block([&](int64_t b, int64_t begin, int64_t end) {
+      int64_t* next = &offsets[b * num_partitions];
+      for (int64_t i = begin; i < end; ++i) {
+        positions[next[partition[i]]++] = i;
+      }
+    });
+
+    // Deduplicate each partition. `idx_vec` temporarily holds the index of
+    // each element among the unique elements of its partition.
+    std::vector<std::vector<int64_t>> first_positions(num_partitions);
+    std::vector<std::vector<TIndex>> local_counts(num_partitions);
+    std::vector<char> is_first(N, 0);
+    workers->ParallelFor(
+        num_partitions, block_size * kCostPerElement,
+        [&](int64_t begin, int64_t end) {
+          for (int64_t p = begin; p < end; ++p) {
+            MapType uniq;
+            uniq.reserve(2 * (partition_starts[p + 1] - partition_starts[p]));
+            for (int64_t k = partition_starts[p]; k < partition_starts[p + 1];
+                 ++k) {
+              const int64_t i = positions[k];
+              auto it = uniq.emplace(Tin(i), first_positions[p].size());
+              idx_vec(i) = it.first->second;
+              if (it.second) {
+                first_positions[p].push_back(i);
+                local_counts[p].push_back(0);
+                is_first[i] = 1;
+              }
+              ++local_counts[p][it.first->second];
+            }
+          }
+        });
+
+    // Number the unique elements by their first occurrence: each block counts
+    // its first occurrences, then numbers them from the block's offset.
+    std::vector<int64_t> block_firsts(num_blocks + 1, 0);
+    for_each_block([&](int64_t b, int64_t begin, int64_t end) {
+      block_firsts[b + 1] = std::count(is_first.begin() + begin,
+                                       is_first.begin() + end, 1);
+    });
+    for (int64_t b = 0; b < num_blocks; ++b) {
+      block_firsts[b + 1] += block_firsts[b];
+    }
+    *uniq_size = block_firsts[num_blocks];
+    // Reuses `positions` to hold the output index of each first occurrence.
+    for_each_block([&](int64_t b, int64_t begin, int64_t end) {
+      int64_t next = block_firsts[b];
+      for (int64_t i = begin; i < end; ++i) {
+        if (is_first[i]) positions[i] = next++;
+      }
+    });
+
+    TensorShape output_shape(input.shape());
+    output_shape.set_dim(axis, *uniq_size);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    auto Tout = output->flat<T>();
+    TIndex* counts = nullptr;
+    if (num_outputs() > 2) {
+      Tensor* count_output = nullptr;
+      OP_REQUIRES_OK(context,
+                     context->allocate_output(2, TensorShape({*uniq_size}),
+                                              &count_output));
+      counts = count_output->vec<TIndex>().data();
+    }
+
+    // Map the partition local indices to the output indices.
+    std::vector<std::vector<TIndex>> output_indices(num_partitions);
+    workers->ParallelFor(
+        num_partitions, block_size * kCostPerElement,
+        [&](int64_t begin, int64_t end) {
+          for (int64_t p = begin; p < end; ++p) {
+            output_indices[p].resize(first_positions[p].size());
+            for (size_t u = 0; u < first_positions[p].size(); ++u) {
+              const int64_t i = first_positions[p][u];
+              const int64_t j = positions[i];
+              output_indices[p][u] = j;
+              Tout(j) = Tin(i);
+              if (counts != nullptr) counts[j] = local_counts[p][u];
+            }
+          }
+        });
+    for_each_block([&](int64_t b, int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        idx_vec(i) = output_indices[partition[i]][idx_vec(i)];
+      }
+    });
+  }
 };
 
 #define REGISTER_UNIQUE(type)                                      \
@@ -111,6 +111,32 @@ void BM_Unique_INT32_Repeat(::testing::benchmark::State& state) {
                           sizeof(int32));
 }
 
+void BM_Unique_INT64(::testing::benchmark::State& state) {
+  const int dim = state.range(0);
+  const int max_int = state.range(1);
+
+  Graph* g = new Graph(OpRegistry::Global());
+
+  Tensor input(DT_INT64, TensorShape({dim}));
+  auto input_flat = input.flat<int64_t>();
+  for (int i = 0; i < dim; ++i) {
+    input_flat(i) = std::rand() % max_int;
+  }
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Unique")
+                  .Input(test::graph::Constant(g, input))
+                  .Attr("T", DT_INT64)
+                  .Finalize(g, &node));
+  FixupSourceAndSinkEdges(g);
+
+  test::Benchmark("cpu", g, nullptr, nullptr, nullptr,
+                  "SINGLE_THREADED_EXECUTOR", /*old_benchmark_api*/ false)
+      .Run(state);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * dim *
+                          sizeof(int64_t));
+}
+
 TensorProto GetRandomStringsTensorProto(int dim, int max_str_len) {
   TensorProto tensor_proto;
   tensor_proto.set_dtype(DT_STRING);
@@ -166,7 +192,20 @@ BENCHMARK(BM_Unique_INT32)
     ->ArgPair(16 * 1024, 64 * 1024 * 1024)
     ->ArgPair(64 * 1024, 64 * 1024 * 1024)
     ->ArgPair(1024 * 1024, 64 * 1024 * 1024)
-    ->ArgPair(4 * 1024 * 1024, 64 * 1024 * 1024);
+    ->ArgPair(4 * 1024 * 1024, 64 * 1024 * 1024)
+    ->ArgPair(16 * 1024 * 1024, 1024 * 1024)
+    ->ArgPair(16 * 1024 * 1024, 64 * 1024 * 1024);
+
+BENCHMARK(BM_Unique_INT64)
+    ->UseRealTime()
+    ->ArgPair(1024, 1024 * 1024)
+    ->ArgPair(64 * 1024, 1024 * 1024)
+    ->ArgPair(1024 * 1024, 1024 * 1024)
+    ->ArgPair(16 * 1024 * 1024, 1024 * 1024)
+    ->ArgPair(1024, 64 * 1024 * 1024)
+    ->ArgPair(64 * 1024, 64 * 1024 * 1024)
+    ->ArgPair(1024 * 1024, 64 * 1024 * 1024)
+    ->ArgPair(16 * 1024 * 1024, 64 * 1024 * 1024);
 
 BENCHMARK(BM_Unique_INT32_Repeat)
     ->UseRealTime()
@@ -201,7 +240,8 @@ BENCHMARK(BM_Unique_STRING)
     ->Arg(4 * 1024)
     ->Arg(16 * 1024)
     ->Arg(64 * 1024)
-    ->Arg(256 * 1024);
+    ->Arg(256 * 1024)
+    ->Arg(1024 * 1024);
 
 }  // namespace
 }  // namespace tensorflow
@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/lib/monitoring/counter.h"
 
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace monitoring {
@@ -86,6 +88,25 @@ TEST(UnlabeledCounterDeathTest, DiesOnDecrement) {
       "decrement");
 }
 
+auto* concurrent_counter_without_labels = Counter<0>::New(
+    "/tensorflow/test/concurrent_counter_without_labels",
+    "Counter without any labels which is incremented from many threads.");
+
+TEST(UnlabeledCounterTest, ConcurrentIncrements) {
+  auto* cell = concurrent_counter_without_labels->GetCell();
+  constexpr int kNumThreads = 16;
+  constexpr int kIncrementsPerThread = 1000;
+  {
+    thread::ThreadPool pool(Env::Default(), "increment", kNumThreads);
+    for (int i = 0; i < kNumThreads; ++i) {
+      pool.Schedule([cell] {
+        for (int j = 0; j < kIncrementsPerThread; ++j) cell->IncrementBy(2);
+      });
+    }
+  }
+  EXPECT_EQ(2 * kNumThreads * kIncrementsPerThread, cell->value());
+}
+
 TEST(LabeledCounterTest, SameName) {
   auto* same_counter = Counter<1>::New("/tensorflow/test/counter_with_labels",
                                        "Counter with one label.", "MyLabel");
@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/lib/monitoring/sampler.h"
 
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace monitoring {
@@ -112,6 +114,32 @@ TEST(ExponentialSamplerTest, ExponentialBucketBoundaries) {
   EqHistograms(expected, cell->value());
 }
 
+auto* concurrent_sampler_without_labels = Sampler<0>::New(
+    {"/tensorflow/test/concurrent_sampler_without_labels",
+     "Sampler without labels which is added to from many threads."},
+    Buckets::Explicit({1.5, 2.8}));
+
+TEST(UnlabeledSamplerTest, ConcurrentAdds) {
+  constexpr int kNumThreads = 16;
+  constexpr int kSamplesPerThread = 1000;
+  Histogram expected({1.5, 2.8, DBL_MAX});
+  auto* cell = concurrent_sampler_without_labels->GetCell();
+  {
+    thread::ThreadPool pool(Env::Default(), "add", kNumThreads);
+    for (int i = 0; i < kNumThreads; ++i) {
+      pool.Schedule([cell] {
+        for (int j = 0; j < kSamplesPerThread; ++j) cell->Add(j % 4);
+      });
+    }
+  }
+  // The samples are small integers, so their sums are exact in any order.
+  for (int i = 0; i < kNumThreads; ++i) {
+    for (int j = 0; j < kSamplesPerThread; ++j) expected.Add(j % 4);
+  }
+
+  EqHistograms(expected, cell->value());
+}
+
 TEST(ExplicitSamplerTest, SameName) {
   auto* same_sampler = Sampler<1>::New({"/tensorflow/test/sampler_with_labels",
                                         "Sampler with one label.", "MyLabel"},
@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/nccl/nccl_manager.h"
 
 #include <utility>
+#include <vector>
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
@@ -22,12 +23,14 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/unbounded_work_queue.h"
 #include "tensorflow/core/profiler/lib/annotated_traceme.h"
 #include "tensorflow/core/profiler/lib/connected_traceme.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/util/env_var.h"
 #if GOOGLE_CUDA
 #include "xla/stream_executor/cuda/cuda_activation.h"
 #elif TENSORFLOW_USE_ROCM
@@ -713,6 +716,33 @@ size_t ComputeBufferSize(const NcclManager::Participant* p,
   }
   return num_elements * DataTypeSize(data_type);
 }
+
+// Returns the maximum number of pending collectives that a kernel launch
+// thread launches in a single NCCL group. Defaults to 1, i.e. every collective
+// is launched on its own.
+int MaxLaunchGroupSize() {
+  static const int max_group_size = [] {
+    int64_t value;
+    Status s = ReadInt64FromEnvVar("TF_NCCL_MAX_LAUNCH_GROUP_SIZE",
+                                   /*default_val=*/1, &value);
+    if (!s.ok() || value < 1) {
+      LOG(ERROR) << "Invalid TF_NCCL_MAX_LAUNCH_GROUP_SIZE, using 1: " << s;
+      return 1;
+    }
+    return static_cast<int>(value);
+  }();
+  return max_group_size;
+}
+
+monitoring::SamplerCell* LaunchGroupSizeCell() {
+  static auto* sampler = monitoring::Sampler<0>::New(
+      {"/tensorflow/core/nccl/launch_group_size",
+       "The number of collective participants launched together by a kernel "
+       "launch thread."},
+      {monitoring::Buckets::Exponential(1, 2, 10)});
+  static auto* cell = sampler->GetCell();
+  return cell;
+}
 }  // namespace
 
 void NcclManager::LoopKernelLaunches(NcclStream* nccl_stream) {
@@ -725,33 +755,15 @@ void NcclManager::LoopKernelLaunches(NcclStream* nccl_stream) {
   cudaStream_t cu_stream = reinterpret_cast<cudaStream_t>(
       comm_stream->platform_specific_handle().stream);
 
-  while (true) {
-    // Find collective to run.
-    std::pair<Collective*, int> next_launch;
-    {
-      VLOG(3) << "Locking mutex nccl_stream " << nccl_stream;
-      mutex_lock l(nccl_stream->mu);
-      while (nccl_stream->pending_launches_.empty()) {
-        if (nccl_stream->shutdown_requested) {
-          // No work and shutdown requested, exit.
-          return;
-        }
-        nccl_stream->cv.wait(l);
-      }
-      next_launch = nccl_stream->pending_launches_.back();
-      nccl_stream->pending_launches_.pop_back();
-    }
-
-    // Launch the nccl kernel.
-    Collective* collective = next_launch.first;
-    tensorflow::profiler::TraceMeConsumer traceme("Run Collective",
-                                                  collective->trace_context);
-
+  const int max_group_size = MaxLaunchGroupSize();
+  // Launches the nccl kernel of participant `p_idx` of `collective` and sets
+  // `nccl_result`. Returns false if the participant was not launched, in which
+  // case it has already been completed.
+  auto launch = [&](Collective* collective, int p_idx,
+                    ncclResult_t& nccl_result) {
     ncclDataType_t data_type = ToNcclType(collective->data_type);
-    int p_idx = next_launch.second;
     Participant* p = collective->participants[p_idx].get();
     auto nccl_comm = collective->communicator->members[p_idx].nccl_comm;
-    ncclResult_t nccl_result = ncclSuccess;
     switch (collective->type) {
       case kAllReduce: {
         const void* sendbuff = p->input->tensor_data().data();
@@ -793,7 +805,7 @@ void NcclManager::LoopKernelLaunches(NcclStream* nccl_stream) {
           p->done_callback(errors::Internal(
               "Both input and output are null in ncclBroadcast"));
           collective->Unref();
-          continue;
+          return false;
         }
         VLOG(2) << "call NcclBroadcast collective_key "
                 << collective->collective_key << " participant " << p_idx
@@ -902,23 +914,80 @@ void NcclManager::LoopKernelLaunches(NcclStream* nccl_stream) {
         break;
       }
     }
+    return true;
+  };
 
-    // Run the done_callback when the nccl kernel finishes running.
-    auto done_callback = [collective, p_idx, nccl_result]() {
-      VLOG(2) << "done Nccl kernel collective_key "
-              << collective->collective_key << " participant " << p_idx
-              << " ncclResult " << nccl_result;
-      if (nccl_result == ncclSuccess) {
-        collective->participants[p_idx]->done_callback(OkStatus());
-      } else {
-        // Propagate the error, but note that if other members of the collective
-        // did launch their kernels, then they are hanging.
-        collective->participants[p_idx]->done_callback(errors::Unknown(
-            "Error invoking NCCL: ", ncclGetErrorString(nccl_result)));
+  std::vector<std::pair<Collective*, int>> launches;
+  std::vector<ncclResult_t> results;
+  while (true) {
+    // Find collectives to run. The collectives that are already pending, up to
+    // `max_group_size`, are launched together in an NCCL group, so that a
+    // backlog of small collectives does not pay one launch each.
+    launches.clear();
+    {
+      VLOG(3) << "Locking mutex nccl_stream " << nccl_stream;
+      mutex_lock l(nccl_stream->mu);
+      while (nccl_stream->pending_launches_.empty()) {
+        if (nccl_stream->shutdown_requested) {
+          // No work and shutdown requested, exit.
+          return;
+        }
+        nccl_stream->cv.wait(l);
       }
-      collective->Unref();
-    };
-    p->event_mgr->ThenExecute(comm_stream, done_callback);
+      while (!nccl_stream->pending_launches_.empty() &&
+             static_cast<int>(launches.size()) < max_group_size) {
+        launches.push_back(nccl_stream->pending_launches_.back());
+        nccl_stream->pending_launches_.pop_back();
+      }
+    }
+    LaunchGroupSizeCell()->Add(launches.size());
+
+    // Launch the nccl kernels.
+    const bool grouped = launches.size() > 1;
+    if (grouped) ncclGroupStart();
+    results.assign(launches.size(), ncclSuccess);
+    size_t num_launched = 0;
+    for (size_t i = 0; i < launches.size(); ++i) {
+      Collective* collective = launches[i].first;
+      tensorflow::profiler::TraceMeConsumer traceme("Run Collective",
+                                                    collective->trace_context);
+      if (launch(collective, launches[i].second, results[i])) {
+        launches[num_launched] = launches[i];
+        results[num_launched] = results[i];
+        ++num_launched;
+      }
+    }
+    if (grouped) {
+      const ncclResult_t group_result = ncclGroupEnd();
+      if (group_result != ncclSuccess) {
+        for (size_t i = 0; i < num_launched; ++i) {
+          if (results[i] == ncclSuccess) results[i] = group_result;
+        }
+      }
+    }
+
+    for (size_t i = 0; i < num_launched; ++i) {
+      Collective* collective = launches[i].first;
+      const int p_idx = launches[i].second;
+      const ncclResult_t nccl_result = results[i];
+      Participant* p = collective->participants[p_idx].get();
+      // Run the done_callback when the nccl kernel finishes running.
+      auto done_callback = [collective, p_idx, nccl_result]() {
+        VLOG(2) << "done Nccl kernel collective_key "
+                << collective->collective_key << " participant " << p_idx
+                << " ncclResult " << nccl_result;
+        if (nccl_result == ncclSuccess) {
+          collective->participants[p_idx]->done_callback(OkStatus());
+        } else {
+          // Propagate the error, but note that if other members of the
+          // collective did launch their kernels, then they are hanging.
+          collective->participants[p_idx]->done_callback(errors::Unknown(
+              "Error invoking NCCL: ", ncclGetErrorString(nccl_result)));
+        }
+        collective->Unref();
+      };
+      p->event_mgr->ThenExecute(comm_stream, done_callback);
+    }
   }
 }
 
@@ -255,6 +255,9 @@ class NcclManager {
 
   // Run <collective>.  This calls takes ownership of <collective>.
   void RunCollective(Collective* collective);
+  // Launches the kernels of the collectives queued on `stream`. Up to
+  // TF_NCCL_MAX_LAUNCH_GROUP_SIZE (default 1) collectives that are pending
+  // at once are launched in a single NCCL group.
   void LoopKernelLaunches(NcclStream* stream);
 
   mutex mu_;
@@ -826,6 +826,46 @@ REGISTER_OP("ExperimentalParallelInterleaveDataset")
                                                            "output_types"))
     .SetShapeFn(shape_inference::ScalarShape);
 
+REGISTER_OP("ParquetDataset")
+    .Input("filenames: string")
+    .Input("columns: string")
+    .Input("record_defaults: output_types")
+    .Input("batch_size: int64")
+    .Input("filter_column: string")
+    .Input("filter_min: double")
+    .Input("filter_max: double")
+    .Input("num_parallel_reads: int64")
+    .Output("handle: variant")
+    .Attr("output_types: list({bool,int32,int64,float,double,string}) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetDoNotOptimize()  // TODO(b/123753214): See comment in dataset_ops.cc.
+    .SetTypeConstructor(full_type::VariadicTensorContainer(TFT_DATASET,
+                                                           "output_types"))
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused;
+      // `filenames` must be a scalar or a vector.
+      TF_RETURN_IF_ERROR(c->WithRankAtMost(c->input(0), 1, &unused));
+      // `columns` must be a vector.
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &unused));
+      // `record_defaults` must be lists of scalars.
+      const int num_columns = c->num_inputs() - 7;
+      for (int i = 2; i < 2 + num_columns; ++i) {
+        shape_inference::ShapeHandle v;
+        TF_RETURN_IF_ERROR(c->WithRankAtMost(c->input(i), 1, &v));
+        if (c->Rank(c->input(i)) == 1 && c->Value(c->Dim(v, 0)) > 1) {
+          return errors::InvalidArgument(
+              "Shape of a default must be a length-0 or length-1 vector, or a "
+              "scalar.");
+        }
+      }
+      // `batch_size`, `filter_column`, `filter_min`, `filter_max` and
+      // `num_parallel_reads` must be scalars.
+      for (int i = 2 + num_columns; i < c->num_inputs(); ++i) {
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 0, &unused));
+      }
+      return shape_inference::ScalarShape(c);
+    });
+
 REGISTER_OP("ParseExampleDataset")
     .Input("input_dataset: variant")
     .Input("num_parallel_calls: int64")
@@ -1284,6 +1324,8 @@ REGISTER_OP("SnapshotChunkDataset")
     .Attr("output_types: list(type) >= 1")
     .Attr("output_shapes: list(shape) >= 1")
     .Attr("compression: string = ''")
+    .Attr("chunk_format: {'TFRECORD', 'COLUMNAR'} = 'TFRECORD'")
+    .Attr("projection: list(int) = []")
     .SetTypeConstructor(full_type::VariadicTensorContainer(TFT_DATASET,
                                                            "output_types"))
     .SetShapeFn([](shape_inference::InferenceContext* c) {
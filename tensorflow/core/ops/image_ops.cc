@@ -526,6 +526,35 @@ REGISTER_OP("DecodeAndCropJpeg")
       return absl::OkStatus();
     });
 
+// --------------------------------------------------------------------------
+REGISTER_OP("DecodeAndResizeJpegBatch")
+    .Input("contents: string")
+    .Input("crop_windows: int32")
+    .Input("size: int32")
+    .Attr("channels: int = 3")
+    .Attr("fancy_upscaling: bool = true")
+    .Attr("dct_method: string = ''")
+    .Output("images: float")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle contents;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 1, &contents));
+      ShapeHandle crop_windows;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &crop_windows));
+      DimensionHandle unused_dim;
+      TF_RETURN_IF_ERROR(
+          c->WithValue(c->Dim(crop_windows, 1), 4, &unused_dim));
+
+      int32_t channels;
+      TF_RETURN_IF_ERROR(c->GetAttr("channels", &channels));
+      if (channels != 1 && channels != 3) {
+        return errors::InvalidArgument("channels must be 1 or 3, got ",
+                                       channels);
+      }
+      return SetOutputToSizedImage(c, c->Dim(contents, 0),
+                                   2 /* size_input_idx */,
+                                   c->MakeDim(channels));
+    });
+
 // --------------------------------------------------------------------------
 REGISTER_OP("EncodeJpeg")
     .Input("image: uint8")
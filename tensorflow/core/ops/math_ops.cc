@@ -1403,6 +1403,46 @@ REGISTER_OP("SparseSegmentMeanWithNumSegments")
     .Attr("sparse_gradient: bool = false")
     .SetShapeFn(SparseSegmentReductionWithNumSegmentsShapeFn);
 
+REGISTER_OP("_FusedSparseSegmentReduceConcat")
+    .Input("data: N * T")
+    .Input("indices: N * Tidx")
+    .Input("segment_ids: N * Tsegmentids")
+    .Output("output: T")
+    .Attr("N: int >= 1")
+    .Attr("combiners: list(string)")
+    .Attr("T: {float, double}")
+    .Attr("Tidx: {int32, int64} = DT_INT32")
+    .Attr("Tsegmentids: {int32, int64} = DT_INT32")
+    .SetShapeFn([](InferenceContext* c) {
+      int num_inputs;
+      TF_RETURN_IF_ERROR(c->GetAttr("N", &num_inputs));
+      DimensionHandle num_columns = c->MakeDim(0);
+      for (int i = 0; i < num_inputs; ++i) {
+        ShapeHandle data_shape;
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 2, &data_shape));
+        ShapeHandle indices_shape;
+        TF_RETURN_IF_ERROR(
+            c->WithRank(c->input(num_inputs + i), 1, &indices_shape));
+        ShapeHandle segment_ids_shape;
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(2 * num_inputs + i), 1,
+                                       &segment_ids_shape));
+        ShapeHandle unused;
+        TF_RETURN_IF_ERROR(c->Merge(indices_shape, segment_ids_shape, &unused));
+        TF_RETURN_IF_ERROR(
+            c->Add(num_columns, c->Dim(data_shape, 1), &num_columns));
+      }
+      c->set_output(0, c->Matrix(InferenceContext::kUnknownDim, num_columns));
+      return absl::OkStatus();
+    })
+    .Doc(R"doc(
+Internal operation which is a composition of `N` SparseSegmentSum or
+SparseSegmentMean ops, as selected by `combiners`, and a ConcatV2 of their
+outputs along the second axis: reserved for internal use.
+
+Do not invoke this operator directly in Python. A fusion optimization is
+expected to create these operators.
+)doc");
+
 REGISTER_OP("SparseSegmentMeanGrad")
     .Input("grad: T")
     .Input("indices: Tidx")
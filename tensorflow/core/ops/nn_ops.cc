@@ -260,6 +260,81 @@ Do not invoke this operator directly in Python. A fusion optimization is
 expected to create these operators.
 )doc");
 
+REGISTER_OP("_FusedLayerNorm")
+    .Input("x: T")
+    .Input("scale: T")
+    .Input("offset: T")
+    .Output("y: T")
+    .Attr("T: {half, float, bfloat16}")
+    .Attr("epsilon: float = 0.001")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle x;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 1, &x));
+      DimensionHandle depth = c->Dim(x, -1);
+      for (int i = 1; i <= 2; ++i) {
+        ShapeHandle vec;
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 1, &vec));
+        TF_RETURN_IF_ERROR(c->Merge(depth, c->Dim(vec, 0), &depth));
+      }
+      c->set_output(0, x);
+      return absl::OkStatus();
+    })
+    .Doc(R"doc(
+Internal LayerNorm operation: reserved for internal use.
+
+Normalizes `x` over its last dimension to zero mean and unit variance, then
+scales the result by `scale` and shifts it by `offset`.
+
+Do not invoke this operator directly in Python. A fusion optimization is
+expected to create these operators.
+)doc");
+
+REGISTER_OP("_FusedScaledDotProductAttention")
+    .Input("query: T")
+    .Input("key: T")
+    .Input("value: T")
+    .Output("output: T")
+    .Attr("T: {half, float, bfloat16}")
+    .Attr("scale: float = 1.0")
+    .Attr("is_causal: bool = false")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle query = c->input(0);
+      ShapeHandle key = c->input(1);
+      ShapeHandle value = c->input(2);
+      if (!c->RankKnown(query) || !c->RankKnown(key) || !c->RankKnown(value)) {
+        return shape_inference::UnknownShape(c);
+      }
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(query, 2, &query));
+      TF_RETURN_IF_ERROR(c->WithRank(key, c->Rank(query), &key));
+      TF_RETURN_IF_ERROR(c->WithRank(value, c->Rank(query), &value));
+      ShapeHandle batch;
+      TF_RETURN_IF_ERROR(c->Subshape(query, 0, -2, &batch));
+      for (ShapeHandle input : {key, value}) {
+        ShapeHandle input_batch;
+        TF_RETURN_IF_ERROR(c->Subshape(input, 0, -2, &input_batch));
+        TF_RETURN_IF_ERROR(c->Merge(batch, input_batch, &batch));
+      }
+      DimensionHandle unused;
+      TF_RETURN_IF_ERROR(c->Merge(c->Dim(query, -1), c->Dim(key, -1), &unused));
+      TF_RETURN_IF_ERROR(c->Merge(c->Dim(key, -2), c->Dim(value, -2), &unused));
+      ShapeHandle output;
+      TF_RETURN_IF_ERROR(c->Concatenate(
+          batch, c->Matrix(c->Dim(query, -2), c->Dim(value, -1)), &output));
+      c->set_output(0, output);
+      return absl::OkStatus();
+    })
+    .Doc(R"doc(
+Internal scaled dot-product attention operation: reserved for internal use.
+
+Computes `softmax(scale * query * key^T) * value` over the last two dimensions
+without materializing the attention scores. With `is_causal`, query `i` only
+attends to the keys up to `i + num_keys - num_queries`, so that the queries of
+a KV cache are aligned with the last keys.
+
+Do not invoke this operator directly in Python. A fusion optimization is
+expected to create these operators.
+)doc");
+
 REGISTER_OP("FusedBatchNormGrad")
     .Input("y_backprop: T")
     .Input("x: T")
@@ -3384,4 +3459,44 @@ REGISTER_OP("IsotonicRegression")
       return absl::OkStatus();
     });
 
+REGISTER_OP("Dropout")
+    .Input("x: T")
+    .Input("rate: float")
+    .Input("seed: Tseed")
+    .Output("output: T")
+    .Output("mask: uint8")
+    .Attr("T: {half, bfloat16, float, double}")
+    .Attr("Tseed: {int32, int64} = DT_INT64")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 0, &unused));
+      ShapeHandle seed;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &seed));
+      DimensionHandle unused_dim;
+      TF_RETURN_IF_ERROR(c->WithValue(c->Dim(seed, 0), 2, &unused_dim));
+      c->set_output(0, c->input(0));
+      // The mask has one bit per element of `x`.
+      DimensionHandle mask_bits;
+      TF_RETURN_IF_ERROR(c->Add(c->NumElements(c->input(0)), 7, &mask_bits));
+      DimensionHandle mask_bytes;
+      TF_RETURN_IF_ERROR(c->Divide(mask_bits, 8, /*evenly_divisible=*/false,
+                                   &mask_bytes));
+      c->set_output(1, c->Vector(mask_bytes));
+      return absl::OkStatus();
+    });
+
+REGISTER_OP("DropoutGrad")
+    .Input("gradients: T")
+    .Input("mask: uint8")
+    .Input("rate: float")
+    .Output("backprops: T")
+    .Attr("T: {half, bfloat16, float, double}")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 0, &unused));
+      c->set_output(0, c->input(0));
+      return absl::OkStatus();
+    });
+
 }  // namespace tensorflow
@@ -41,6 +41,53 @@ REGISTER_OP("RaggedGather")
     .Attr("OUTPUT_RAGGED_RANK: int >= 0")
     .SetShapeFn(RaggedGatherShapeFn);
 
+REGISTER_OP("_FusedRaggedGatherToTensor")
+    .Input("params_splits: Tsplits")
+    .Input("params_dense_values: Tvalues")
+    .Input("indices: Tindices")
+    .Input("shape: Tshape")
+    .Input("default_value: Tvalues")
+    .Output("result: Tvalues")
+    .Attr("Tvalues: type")
+    .Attr("Tindices: {int32, int64}")
+    .Attr("Tsplits: {int32, int64} = DT_INT64")
+    .Attr("Tshape: {int32, int64}")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 1, &unused));
+      ShapeHandle params_dense_values;
+      TF_RETURN_IF_ERROR(
+          c->WithRankAtLeast(c->input(1), 1, &params_dense_values));
+      ShapeHandle indices;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &indices));
+
+      // The result is [nrows, ncols] + params_dense_values.shape[1:], where
+      // `shape` may override any dimension.
+      ShapeHandle value;
+      TF_RETURN_IF_ERROR(c->Subshape(params_dense_values, 1, &value));
+      ShapeHandle result;
+      TF_RETURN_IF_ERROR(
+          c->Concatenate(c->UnknownShapeOfRank(2), value, &result));
+      ShapeHandle shape;
+      TF_RETURN_IF_ERROR(
+          c->MakeShapeFromShapeTensorTreatScalarAsUnknownShape(3, &shape));
+      TF_RETURN_IF_ERROR(c->Merge(result, shape, &result));
+      if (!c->ValueKnown(c->Dim(result, 0))) {
+        TF_RETURN_IF_ERROR(
+            c->ReplaceDim(result, 0, c->Dim(indices, 0), &result));
+      }
+      c->set_output(0, result);
+      return absl::OkStatus();
+    })
+    .Doc(R"doc(
+Internal operation which is a composition of a RaggedGather of the rows of a
+ragged tensor with one ragged dimension and a RaggedTensorToTensor of the
+result: reserved for internal use.
+
+Do not invoke this operator directly in Python. A fusion optimization is
+expected to create these operators.
+)doc");
+
 REGISTER_OP("RaggedCross")
     .Input("ragged_values: ragged_values_types")
     .Input("ragged_row_splits: ragged_splits_types")
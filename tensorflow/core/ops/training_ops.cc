@@ -831,6 +831,41 @@ REGISTER_OP("ResourceApplyAdam")
     .Attr("use_nesterov: bool = false")
     .SetShapeFn(ApplyAdamShapeFn</*is_resource=*/true>);
 
+// Internal op that the remapper creates from ResourceApplyAdam ops sharing
+// their hyperparameters, to update N variables in a few kernels.
+REGISTER_OP("_ResourceApplyAdamMulti")
+    .Input("var: N * resource")
+    .Input("m: N * resource")
+    .Input("v: N * resource")
+    .Input("beta1_power: T")
+    .Input("beta2_power: T")
+    .Input("lr: T")
+    .Input("beta1: T")
+    .Input("beta2: T")
+    .Input("epsilon: T")
+    .Input("grad: N * T")
+    .Attr("N: int >= 1")
+    .Attr("T: numbertype")
+    .Attr("use_locking: bool = false")
+    .Attr("use_nesterov: bool = false")
+    .SetShapeFn([](InferenceContext* c) {
+      int n;
+      TF_RETURN_IF_ERROR(c->GetAttr("N", &n));
+      ShapeHandle unused;
+      for (int i = 0; i < 6; ++i) {
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(3 * n + i), 0, &unused));
+      }
+      for (int i = 0; i < n; ++i) {
+        ShapeHandle s = ShapeOrHandleShape<true>(c, i);                // var
+        TF_RETURN_IF_ERROR(
+            c->Merge(s, ShapeOrHandleShape<true>(c, n + i), &s));      // m
+        TF_RETURN_IF_ERROR(
+            c->Merge(s, ShapeOrHandleShape<true>(c, 2 * n + i), &s));  // v
+        TF_RETURN_IF_ERROR(c->Merge(s, c->input(3 * n + 6 + i), &s));  // grad
+      }
+      return absl::OkStatus();
+    });
+
 template <bool is_resource>
 static Status ApplyAdamWithAmsgradShapeFn(InferenceContext* c) {
   ShapeHandle unused;
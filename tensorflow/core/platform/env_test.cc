@@ -18,6 +18,7 @@ limitations under the License.
 #include <sys/stat.h>
 
 #include <memory>
+#include <vector>
 
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -92,6 +93,31 @@ TEST_F(DefaultEnvTest, IncompleteReadOutOfRange) {
   EXPECT_EQ(input, result);
 }
 
+TEST_F(DefaultEnvTest, ReadMany) {
+  const string filename = io::JoinPath(BaseDir(), "read_many");
+  const string input = CreateTestFile(env_, filename, 200);
+  std::unique_ptr<RandomAccessFile> f;
+  TF_EXPECT_OK(env_->NewRandomAccessFile(filename, &f));
+
+  // More ranges than fit in flight at once, including one past EOF.
+  constexpr int kNumRequests = 100;
+  std::vector<RandomAccessFile::ReadRequest> requests(kNumRequests + 1);
+  std::vector<string> scratch(kNumRequests + 1, string(10, 0));
+  for (int i = 0; i <= kNumRequests; ++i) {
+    requests[i].offset = (i * 37) % 190;
+    requests[i].n = 10;
+    requests[i].scratch = &scratch[i][0];
+  }
+  requests[kNumRequests].offset = 195;
+  EXPECT_EQ(error::OUT_OF_RANGE, f->ReadMany(absl::MakeSpan(requests)).code());
+  for (int i = 0; i < kNumRequests; ++i) {
+    TF_EXPECT_OK(requests[i].status);
+    EXPECT_EQ(input.substr(requests[i].offset, 10), requests[i].result);
+  }
+  EXPECT_EQ(error::OUT_OF_RANGE, requests[kNumRequests].status.code());
+  EXPECT_EQ(input.substr(195), requests[kNumRequests].result);
+}
+
 TEST_F(DefaultEnvTest, ReadFileToString) {
   for (const int length : {0, 1, 1212, 2553, 4928, 8196, 9000, (1 << 20) - 1,
                            1 << 20, (1 << 20) + 1, (256 << 20) + 100}) {
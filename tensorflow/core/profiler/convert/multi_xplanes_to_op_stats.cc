@@ -15,8 +15,17 @@ limitations under the License.
 
 #include "tensorflow/core/profiler/convert/multi_xplanes_to_op_stats.h"
 
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <utility>
 #include <vector>
 
+#include "absl/status/statusor.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/profiler/convert/op_stats_combiner.h"
 #include "tensorflow/core/profiler/convert/preprocess_single_host_xplane.h"
@@ -28,37 +37,86 @@ limitations under the License.
 
 namespace tensorflow {
 namespace profiler {
+namespace {
+
+// Maximum number of hosts converted at the same time, each of which holds its
+// XSpace in memory.
+constexpr int kMaxParallelHosts = 8;
+
+absl::StatusOr<OpStats> ConvertHostXSpaceToOpStats(
+    const SessionSnapshot& session_snapshot, int host_id,
+    const OpStatsOptions& options) {
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<XSpace> xspace,
+                      session_snapshot.GetXSpace(host_id));
+  PreprocessSingleHostXSpace(xspace.get(), /*step_grouping=*/true,
+                             /*derived_timeline=*/false);
+  return ConvertXSpaceToOpStats(*xspace, options);
+}
+
+}  // namespace
 
 Status ConvertMultiXSpacesToCombinedOpStats(
     const SessionSnapshot& session_snapshot, const OpStatsOptions& options,
     OpStats* combined_op_stats) {
-  // Read multiple XSpaces and convert to multiple OpStats.
-  // TODO(profiler): Change the combiner to convert and combine one OpStats at a
-  // time, to reduce peak memory usage.
-  std::vector<OpStats> all_op_stats;
-  all_op_stats.reserve(session_snapshot.XSpaceSize());
-  for (int i = 0; i < session_snapshot.XSpaceSize(); i++) {
-    TF_ASSIGN_OR_RETURN(std::unique_ptr<XSpace> xspace,
-                        session_snapshot.GetXSpace(i));
-    PreprocessSingleHostXSpace(xspace.get(), /*step_grouping=*/true,
-                               /*derived_timeline=*/false);
-    all_op_stats.push_back(ConvertXSpaceToOpStats(*xspace, options));
-  }
+  const int num_hosts = session_snapshot.XSpaceSize();
+  IncrementalOpStatsCombiner combiner(combined_op_stats);
+  auto combine = [&combiner](OpStats op_stats, int host_id) {
+    HardwareType hardware_type =
+        ParseHardwareType(op_stats.run_environment().device_type());
+    combiner.Add(std::move(op_stats), hardware_type, host_id);
+  };
 
-  // Combine OpStats.
-  std::vector<OpStatsInfo> all_op_stats_info;
-  all_op_stats_info.reserve(all_op_stats.size());
-  for (int i = 0; i < all_op_stats.size(); i++) {
-    all_op_stats_info.emplace_back(
-        &all_op_stats[i],
-        ParseHardwareType(all_op_stats[i].run_environment().device_type()), i);
+  const int num_threads =
+      std::min({num_hosts, port::MaxParallelism(), kMaxParallelHosts});
+  if (num_threads <= 1) {
+    for (int i = 0; i < num_hosts; i++) {
+      TF_ASSIGN_OR_RETURN(
+          OpStats op_stats,
+          ConvertHostXSpaceToOpStats(session_snapshot, i, options));
+      combine(std::move(op_stats), i);
+    }
+  } else {
+    // Hosts are converted in parallel but combined in order, so that the
+    // result does not depend on scheduling. Conversions are started at most
+    // <window> hosts ahead of the next one to combine, which bounds the number
+    // of XSpaces and OpStats in memory.
+    const int window = 2 * num_threads;
+    mutex mu;
+    condition_variable cv;
+    std::vector<std::optional<absl::StatusOr<OpStats>>> results(num_hosts);
+    Status status;
+    // Declared last, so that it waits for the conversions before the state
+    // they use is destroyed.
+    thread::ThreadPool pool(Env::Default(), "convert_xspaces", num_threads);
+    int num_scheduled = 0;
+    for (int i = 0; i < num_hosts; i++) {
+      for (; num_scheduled < std::min(num_hosts, i + window); num_scheduled++) {
+        pool.Schedule([&, host_id = num_scheduled] {
+          absl::StatusOr<OpStats> result =
+              ConvertHostXSpaceToOpStats(session_snapshot, host_id, options);
+          mutex_lock lock(mu);
+          results[host_id] = std::move(result);
+          cv.notify_all();
+        });
+      }
+      absl::StatusOr<OpStats> result;
+      {
+        mutex_lock lock(mu);
+        while (!results[i].has_value()) cv.wait(lock);
+        result = *std::move(results[i]);
+        results[i].reset();
+      }
+      if (!result.ok()) {
+        status = result.status();
+        break;
+      }
+      combine(*std::move(result), i);
+    }
+    TF_RETURN_IF_ERROR(status);
   }
 
   // Do not limit the maximum number of steps during the merge of OpStats.
-  StepIntersection step_intersection =
-      ComputeStepIntersectionToMergeOpStats(all_op_stats_info, kuint32max);
-  CombineAllOpStats(all_op_stats_info, step_intersection, combined_op_stats);
-
+  combiner.Finalize(kuint32max);
   return absl::OkStatus();
 }
 
@@ -25,7 +25,9 @@ namespace tensorflow {
 namespace profiler {
 
 // Converts and combines multiple XSpace protos into a single OpStats
-// <combined_op_stats>.
+// <combined_op_stats>. The XSpaces are loaded, converted and combined a few
+// hosts at a time, in parallel, so that memory usage is bounded regardless of
+// the number of hosts.
 // Return the first error status during conversion, or return OkStatus() if
 // there is no error.
 Status ConvertMultiXSpacesToCombinedOpStats(
@@ -0,0 +1,166 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/convert/op_samples_to_op_metrics_db.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/profiler/convert/xplane_to_op_metrics_db.h"
+#include "tensorflow/core/profiler/lib/op_sampler.h"
+#include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/core/profiler/utils/op_metrics_db_utils.h"
+#include "tensorflow/core/profiler/utils/xplane_builder.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+auto* sampled_op_self_time_ns = monitoring::Counter<1>::New(
+    "/tensorflow/core/profiler/sampled_op_self_time_ns",
+    "The self time in nanoseconds of the sampled ops of a given type.",
+    "op_type");
+
+auto* sampled_op_occurrences = monitoring::Counter<1>::New(
+    "/tensorflow/core/profiler/sampled_op_occurrences",
+    "The number of executions of the sampled ops of a given type.",
+    "op_type");
+
+auto* sampled_op_bytes = monitoring::Counter<1>::New(
+    "/tensorflow/core/profiler/sampled_op_bytes",
+    "The bytes of the outputs of the sampled ops of a given type.",
+    "op_type");
+
+auto* sampled_op_dropped = monitoring::Counter<0>::New(
+    "/tensorflow/core/profiler/sampled_op_dropped",
+    "The number of op samples overwritten before being exported.");
+
+}  // namespace
+
+OpMetricsDb ConvertOpSamplesToOpMetricsDb(absl::Span<const OpSample> samples) {
+  absl::flat_hash_map<int64_t, std::vector<const OpSample*>> samples_by_thread;
+  absl::flat_hash_map<std::string, uint64_t> bytes_by_name;
+  for (const OpSample& sample : samples) {
+    samples_by_thread[sample.thread_id].push_back(&sample);
+    bytes_by_name[sample.name] += sample.bytes;
+  }
+
+  XPlane plane;
+  XPlaneBuilder plane_builder(&plane);
+  for (auto& [thread_id, thread_samples] : samples_by_thread) {
+    absl::c_sort(thread_samples, [](const OpSample* a, const OpSample* b) {
+      return a->start_ns < b->start_ns;
+    });
+    XLineBuilder line = plane_builder.GetOrCreateLine(thread_id);
+    line.SetTimestampNs(thread_samples.front()->start_ns);
+    line.ReserveEvents(thread_samples.size());
+    for (const OpSample* sample : thread_samples) {
+      // Host events are named after the TF op fullname "name:type".
+      XEventBuilder event =
+          line.AddEvent(*plane_builder.GetOrCreateEventMetadata(
+              absl::StrCat(sample->name, ":", sample->type)));
+      event.SetTimestampNs(sample->start_ns);
+      event.SetEndTimestampNs(std::max(sample->end_ns, sample->start_ns));
+    }
+  }
+
+  OpMetricsDb db = ConvertHostThreadsXPlaneToOpMetricsDb(plane);
+  for (OpMetrics& metrics : *db.mutable_metrics_db()) {
+    auto it = bytes_by_name.find(metrics.name());
+    if (it != bytes_by_name.end()) metrics.set_bytes_accessed(it->second);
+  }
+  return db;
+}
+
+SampledOpMetricsExporter::SampledOpMetricsExporter(OpSampler* sampler,
+                                                   absl::Duration period)
+    : sampler_(sampler), period_(period) {
+  if (period_ > absl::ZeroDuration()) {
+    thread_.reset(Env::Default()->StartThread(
+        ThreadOptions(), "sampled_op_metrics_exporter", [this] { Run(); }));
+  }
+}
+
+SampledOpMetricsExporter::~SampledOpMetricsExporter() {
+  {
+    mutex_lock lock(mu_);
+    stopped_ = true;
+    cv_.notify_all();
+  }
+  // Joins the thread.
+  thread_.reset();
+}
+
+void SampledOpMetricsExporter::MaybeStartGlobalExporter(
+    absl::Duration period) {
+  OpSampler* sampler = OpSampler::Get();
+  if (!sampler->enabled()) return;
+  static SampledOpMetricsExporter* exporter =
+      new SampledOpMetricsExporter(sampler, period);
+  (void)exporter;
+}
+
+void SampledOpMetricsExporter::Run() {
+  while (true) {
+    {
+      mutex_lock lock(mu_);
+      if (!stopped_) {
+        WaitForMilliseconds(&lock, &cv_, absl::ToInt64Milliseconds(period_));
+      }
+      if (stopped_) return;
+    }
+    Export();
+  }
+}
+
+void SampledOpMetricsExporter::Export() {
+  mutex_lock export_lock(export_mu_);
+  OpMetricsDb db = ConvertOpSamplesToOpMetricsDb(sampler_->Drain());
+  for (const OpMetrics& metrics : db.metrics_db()) {
+    if (IsIdleOp(metrics)) continue;
+    sampled_op_self_time_ns->GetCell(metrics.category())
+        ->IncrementBy(metrics.self_time_ps() / 1000);
+    sampled_op_occurrences->GetCell(metrics.category())
+        ->IncrementBy(metrics.occurrences());
+    sampled_op_bytes->GetCell(metrics.category())
+        ->IncrementBy(metrics.bytes_accessed());
+  }
+  const uint64_t dropped = sampler_->dropped();
+  sampled_op_dropped->GetCell()->IncrementBy(dropped - exported_dropped_);
+  exported_dropped_ = dropped;
+
+  mutex_lock lock(mu_);
+  latest_op_metrics_db_ = std::move(db);
+}
+
+OpMetricsDb SampledOpMetricsExporter::latest_op_metrics_db() const {
+  mutex_lock lock(mu_);
+  return latest_op_metrics_db_;
+}
+
+}  // namespace profiler
+}  // namespace tensorflow
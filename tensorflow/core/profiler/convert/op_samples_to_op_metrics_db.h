@@ -0,0 +1,77 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PROFILER_CONVERT_OP_SAMPLES_TO_OP_METRICS_DB_H_
+#define TENSORFLOW_CORE_PROFILER_CONVERT_OP_SAMPLES_TO_OP_METRICS_DB_H_
+
+#include <cstdint>
+#include <memory>
+
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/profiler/lib/op_sampler.h"
+#include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+
+// Converts op samples to an OpMetricsDb the same way as the host threads of a
+// profile, with the bytes of the outputs of the ops as bytes accessed.
+OpMetricsDb ConvertOpSamplesToOpMetricsDb(absl::Span<const OpSample> samples);
+
+// Periodically drains an OpSampler and exports the metrics of the sampled ops
+// to the /tensorflow/core/profiler/sampled_op_* monitoring counters, labelled
+// by op type, for dashboards.
+class SampledOpMetricsExporter {
+ public:
+  // Exports the samples of `sampler` every `period`, or only when Export() is
+  // called if `period` is zero.
+  SampledOpMetricsExporter(OpSampler* sampler, absl::Duration period);
+  ~SampledOpMetricsExporter();
+
+  // Starts a process-wide exporter of OpSampler::Get() if sampling is enabled.
+  static void MaybeStartGlobalExporter(absl::Duration period);
+
+  // Drains the sampler and exports its samples.
+  void Export();
+
+  // Returns the metrics of the samples drained by the last Export().
+  OpMetricsDb latest_op_metrics_db() const;
+
+ private:
+  void Run();
+
+  OpSampler* const sampler_;
+  const absl::Duration period_;
+
+  mutex export_mu_;
+  // Number of dropped samples of `sampler_` already exported.
+  uint64_t exported_dropped_ TF_GUARDED_BY(export_mu_) = 0;
+
+  mutable mutex mu_;
+  condition_variable cv_;
+  bool stopped_ TF_GUARDED_BY(mu_) = false;
+  OpMetricsDb latest_op_metrics_db_ TF_GUARDED_BY(mu_);
+
+  std::unique_ptr<Thread> thread_;
+};
+
+}  // namespace profiler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_CONVERT_OP_SAMPLES_TO_OP_METRICS_DB_H_
@@ -0,0 +1,97 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/convert/op_samples_to_op_metrics_db.h"
+
+#include <vector>
+
+#include "absl/time/time.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/profiler/lib/op_sampler.h"
+#include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
+#include "tensorflow/core/profiler/utils/math_utils.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+OpSample MakeSample(const char* name, const char* type, uint64_t start_ns,
+                    uint64_t end_ns, uint64_t bytes, int64_t thread_id) {
+  OpSample sample;
+  sample.name = name;
+  sample.type = type;
+  sample.start_ns = start_ns;
+  sample.end_ns = end_ns;
+  sample.bytes = bytes;
+  sample.thread_id = thread_id;
+  return sample;
+}
+
+const OpMetrics* FindOpMetrics(const OpMetricsDb& db, const char* name) {
+  for (const OpMetrics& metrics : db.metrics_db()) {
+    if (metrics.name() == name) return &metrics;
+  }
+  return nullptr;
+}
+
+TEST(ConvertOpSamplesToOpMetricsDb, HostOpMetricsDb) {
+  // The samples of a thread are not necessarily in the order of their start.
+  std::vector<OpSample> samples = {
+      MakeSample("matmul", "MatMul", 120, 150, 256, /*thread_id=*/1),
+      MakeSample("matmul", "MatMul", 100, 110, 256, /*thread_id=*/1),
+      MakeSample("relu", "Relu", 100, 120, 64, /*thread_id=*/2)};
+
+  OpMetricsDb db = ConvertOpSamplesToOpMetricsDb(samples);
+  // matmul, relu, Idle.
+  EXPECT_EQ(db.metrics_db_size(), 3);
+  EXPECT_EQ(db.total_op_time_ps(), tsl::profiler::NanoToPico(30 + 10 + 20));
+
+  const OpMetrics* matmul = FindOpMetrics(db, "matmul");
+  ASSERT_NE(matmul, nullptr);
+  EXPECT_EQ(matmul->category(), "MatMul");
+  EXPECT_EQ(matmul->occurrences(), 2);
+  EXPECT_EQ(matmul->time_ps(), tsl::profiler::NanoToPico(40));
+  EXPECT_EQ(matmul->self_time_ps(), tsl::profiler::NanoToPico(40));
+  EXPECT_EQ(matmul->bytes_accessed(), 512);
+
+  const OpMetrics* relu = FindOpMetrics(db, "relu");
+  ASSERT_NE(relu, nullptr);
+  EXPECT_EQ(relu->category(), "Relu");
+  EXPECT_EQ(relu->occurrences(), 1);
+  EXPECT_EQ(relu->time_ps(), tsl::profiler::NanoToPico(20));
+  EXPECT_EQ(relu->bytes_accessed(), 64);
+}
+
+TEST(SampledOpMetricsExporter, Export) {
+  OpSampler sampler(/*sampling_rate=*/1, /*capacity=*/16);
+  SampledOpMetricsExporter exporter(&sampler, absl::ZeroDuration());
+  sampler.Record("add", "AddV2", 1000, 1500, 16);
+
+  exporter.Export();
+  OpMetricsDb db = exporter.latest_op_metrics_db();
+  const OpMetrics* add = FindOpMetrics(db, "add");
+  ASSERT_NE(add, nullptr);
+  EXPECT_EQ(add->category(), "AddV2");
+  EXPECT_EQ(add->time_ps(), tsl::profiler::NanoToPico(500));
+  EXPECT_EQ(add->bytes_accessed(), 16);
+
+  // The samples are exported once.
+  exporter.Export();
+  EXPECT_EQ(FindOpMetrics(exporter.latest_op_metrics_db(), "add"), nullptr);
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tensorflow
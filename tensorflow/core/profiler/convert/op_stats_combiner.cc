@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstddef>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -151,14 +152,49 @@ void CombineDiagnostics(const Diagnostics& src, Diagnostics* dst) {
   dst->mutable_errors()->MergeFrom(src.errors());
 }
 
-// Combine the src OpStats into the dst OpStats.
-void CombineOpStats(
-    bool no_accelerator_in_system, int src_host_id, HardwareType hardware_type,
-    const StepIntersection& step_intersection, const OpStats& src, OpStats* dst,
+// Combines the step databases of the workers in <worker_step_dbs>, given as
+// pairs of host id and step database, using the steps in range
+// <step_intersection>.
+void CombineStepDatabases(
+    const StepIntersection& step_intersection,
+    const std::vector<std::pair<int, const StepDatabaseResult*>>&
+        worker_step_dbs,
+    OpStats* combined_op_stats) {
+  StepDatabaseResult* combined_step_db = combined_op_stats->mutable_step_db();
+  // Initialize the StepDatabaseResult field that depends on the number of
+  // steps.
+  for (uint32 dst_step_num : step_intersection.DstStepNumbers()) {
+    combined_step_db->add_step_sequence()->set_step_num(dst_step_num);
+  }
+  // Record the number of steps that are dropped.
+  combined_step_db->set_num_steps_dropped(step_intersection.StepsDropped());
+
+  combined_step_db->set_empty_intersect(step_intersection.EmptyIntersect());
+
+  OpMetricsDbCombiner hlo_metrics_db_complete_steps_only_combiner(
+      combined_op_stats->mutable_hlo_metrics_db_complete_steps_only());
+  std::vector<OpMetricsDbCombiner> hlo_metrics_db_per_step_combiners;
+  hlo_metrics_db_per_step_combiners.reserve(
+      combined_step_db->step_sequence_size());
+  for (PerCoreStepInfo& step_info :
+       *combined_step_db->mutable_step_sequence()) {
+    hlo_metrics_db_per_step_combiners.emplace_back(
+        step_info.mutable_hlo_metrics_db());
+  }
+
+  for (const auto& [src_host_id, step_db] : worker_step_dbs) {
+    CombineStepDatabase(src_host_id, step_intersection, *step_db,
+                        combined_step_db,
+                        &hlo_metrics_db_complete_steps_only_combiner,
+                        &hlo_metrics_db_per_step_combiners);
+  }
+}
+
+// Combine the src OpStats, except for its step_db, into the dst OpStats.
+void CombineOpStatsExceptStepDb(
+    int src_host_id, const OpStats& src, OpStats* dst,
     OpMetricsDbCombiner* host_op_metrics_db_combiner,
-    OpMetricsDbCombiner* device_op_metrics_db_combiner,
-    OpMetricsDbCombiner* hlo_metrics_db_complete_steps_only_combiner,
-    std::vector<OpMetricsDbCombiner>* hlo_metrics_db_per_step_combiners) {
+    OpMetricsDbCombiner* device_op_metrics_db_combiner) {
   // Combine host_metrics_db.
   // Host OpMetricsDb does not need to update the number of cores a certain op
   // occurs.
@@ -167,14 +203,6 @@ void CombineOpStats(
   // Combine device_metrics_db.
   device_op_metrics_db_combiner->Combine(src.device_op_metrics_db());
 
-  // Combine step_db.
-  if (!IsCoordinator(no_accelerator_in_system, hardware_type)) {
-    CombineStepDatabase(src_host_id, step_intersection, src.step_db(),
-                        dst->mutable_step_db(),
-                        hlo_metrics_db_complete_steps_only_combiner,
-                        hlo_metrics_db_per_step_combiners);
-  }
-
   // Combine run environment info.
   CombineRunEnvironment(src.run_environment(), dst->mutable_run_environment());
 
@@ -202,6 +230,21 @@ void CombineOpStats(
           src.performance_counter_result().matrix_unit_utilization_percent());
 }
 
+// Completes the combination of the OpStats of <num_hosts> hosts.
+void FinalizeCombinedOpStats(int num_hosts, OpStats* combined_op_stats) {
+  // Sorts all the kernel reports that have been merged by CombineTfOpStats and
+  // keeps only the top kernel reports with long kernel duration.
+  SortAndKeepTopKDurationKernelReportsInDb(
+      combined_op_stats->mutable_kernel_stats_db());
+
+  // Process performance counter results.
+  combined_op_stats->mutable_performance_counter_result()
+      ->set_matrix_unit_utilization_percent(
+          combined_op_stats->performance_counter_result()
+              .matrix_unit_utilization_percent() /
+          num_hosts);
+}
+
 }  // namespace
 
 bool IsCoordinator(bool no_accelerator_in_system, HardwareType hardware_type) {
@@ -252,55 +295,97 @@ void CombineAllOpStats(const std::vector<OpStatsInfo>& all_op_stats_info,
     return;
   }
 
-  StepDatabaseResult* combined_step_db = combined_op_stats->mutable_step_db();
-  // Initialize the StepDatabaseResult field that depends on the number of
-  // steps.
-  for (uint32 dst_step_num : step_intersection.DstStepNumbers()) {
-    combined_step_db->add_step_sequence()->set_step_num(dst_step_num);
+  // Combine step_db of the workers.
+  bool no_accelerator_in_system = NoAcceleratorInSystem(all_op_stats_info);
+  std::vector<std::pair<int, const StepDatabaseResult*>> worker_step_dbs;
+  for (const auto& op_stats_info : all_op_stats_info) {
+    if (IsCoordinator(no_accelerator_in_system, op_stats_info.hardware_type))
+      continue;
+    worker_step_dbs.emplace_back(op_stats_info.src_host_id,
+                                 &op_stats_info.op_stats->step_db());
   }
-  // Record the number of steps that are dropped.
-  combined_step_db->set_num_steps_dropped(step_intersection.StepsDropped());
-
-  combined_step_db->set_empty_intersect(step_intersection.EmptyIntersect());
+  CombineStepDatabases(step_intersection, worker_step_dbs, combined_op_stats);
 
   // Initialize all the OpMetricsDbCombiners.
   OpMetricsDbCombiner host_op_metrics_db_combiner(
       combined_op_stats->mutable_host_op_metrics_db());
   OpMetricsDbCombiner device_op_metrics_db_combiner(
       combined_op_stats->mutable_device_op_metrics_db());
-  OpMetricsDbCombiner hlo_metrics_db_complete_steps_only_combiner(
-      combined_op_stats->mutable_hlo_metrics_db_complete_steps_only());
-  std::vector<OpMetricsDbCombiner> hlo_metrics_db_per_step_combiners;
-  hlo_metrics_db_per_step_combiners.reserve(
-      combined_step_db->step_sequence_size());
-  for (PerCoreStepInfo& step_info :
-       *combined_step_db->mutable_step_sequence()) {
-    hlo_metrics_db_per_step_combiners.emplace_back(
-        step_info.mutable_hlo_metrics_db());
+
+  for (const auto& op_stats_info : all_op_stats_info) {
+    CombineOpStatsExceptStepDb(op_stats_info.src_host_id,
+                               *op_stats_info.op_stats, combined_op_stats,
+                               &host_op_metrics_db_combiner,
+                               &device_op_metrics_db_combiner);
   }
 
-  bool no_accelerator_in_system = NoAcceleratorInSystem(all_op_stats_info);
+  FinalizeCombinedOpStats(all_op_stats_info.size(), combined_op_stats);
+}
 
-  for (const auto& op_stats_info : all_op_stats_info) {
-    CombineOpStats(no_accelerator_in_system, op_stats_info.src_host_id,
-                   op_stats_info.hardware_type, step_intersection,
-                   *op_stats_info.op_stats, combined_op_stats,
-                   &host_op_metrics_db_combiner, &device_op_metrics_db_combiner,
-                   &hlo_metrics_db_complete_steps_only_combiner,
-                   &hlo_metrics_db_per_step_combiners);
+IncrementalOpStatsCombiner::IncrementalOpStatsCombiner(
+    OpStats* combined_op_stats)
+    : combined_op_stats_(combined_op_stats),
+      host_op_metrics_db_combiner_(
+          combined_op_stats->mutable_host_op_metrics_db()),
+      device_op_metrics_db_combiner_(
+          combined_op_stats->mutable_device_op_metrics_db()) {}
+
+void IncrementalOpStatsCombiner::Add(OpStats op_stats,
+                                     HardwareType hardware_type,
+                                     int src_host_id) {
+  ++num_hosts_;
+  // Like CombineAllOpStats, a single OpStats is not merged. Keep the first one
+  // until there is a second one.
+  if (num_hosts_ == 1) {
+    first_host_ = HostStepDb{src_host_id, hardware_type, {}};
+    first_op_stats_ = std::move(op_stats);
+    return;
   }
+  if (first_op_stats_.has_value()) {
+    CombineExceptStepDb(*std::move(first_op_stats_), first_host_);
+    first_op_stats_.reset();
+  }
+  CombineExceptStepDb(std::move(op_stats),
+                      HostStepDb{src_host_id, hardware_type, {}});
+}
 
-  // Sorts all the kernel reports that have been merged by CombineTfOpStats and
-  // keeps only the top kernel reports with long kernel duration.
+void IncrementalOpStatsCombiner::CombineExceptStepDb(OpStats op_stats,
+                                                     HostStepDb host) {
+  CombineOpStatsExceptStepDb(host.src_host_id, op_stats, combined_op_stats_,
+                             &host_op_metrics_db_combiner_,
+                             &device_op_metrics_db_combiner_);
+  // Keeping only the top kernel reports after each host bounds their number,
+  // and keeps the same ones as doing it once at the end.
   SortAndKeepTopKDurationKernelReportsInDb(
-      combined_op_stats->mutable_kernel_stats_db());
+      combined_op_stats_->mutable_kernel_stats_db());
+  host.step_db.Swap(op_stats.mutable_step_db());
+  host_step_dbs_.push_back(std::move(host));
+}
 
-  // Process performance counter results.
-  combined_op_stats->mutable_performance_counter_result()
-      ->set_matrix_unit_utilization_percent(
-          combined_op_stats->performance_counter_result()
-              .matrix_unit_utilization_percent() /
-          all_op_stats_info.size());
+void IncrementalOpStatsCombiner::Finalize(uint32 max_step_per_host) {
+  if (num_hosts_ == 0) return;
+  if (num_hosts_ == 1) {
+    *combined_op_stats_ = *std::move(first_op_stats_);
+    first_op_stats_.reset();
+    return;
+  }
+
+  bool no_accelerator_in_system = true;
+  for (const HostStepDb& host : host_step_dbs_) {
+    if (HasDevice(host.hardware_type)) no_accelerator_in_system = false;
+  }
+  absl::flat_hash_map<uint32, const StepDatabaseResult*> per_host_step_db;
+  std::vector<std::pair<int, const StepDatabaseResult*>> worker_step_dbs;
+  for (const HostStepDb& host : host_step_dbs_) {
+    if (IsCoordinator(no_accelerator_in_system, host.hardware_type)) continue;
+    per_host_step_db[host.src_host_id] = &host.step_db;
+    worker_step_dbs.emplace_back(host.src_host_id, &host.step_db);
+  }
+  StepIntersection step_intersection(max_step_per_host, per_host_step_db);
+  CombineStepDatabases(step_intersection, worker_step_dbs, combined_op_stats_);
+  host_step_dbs_.clear();
+
+  FinalizeCombinedOpStats(num_hosts_, combined_op_stats_);
 }
 
 }  // namespace profiler
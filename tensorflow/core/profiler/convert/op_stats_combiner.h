@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_PROFILER_CONVERT_OP_STATS_COMBINER_H_
 #define TENSORFLOW_CORE_PROFILER_CONVERT_OP_STATS_COMBINER_H_
 
+#include <optional>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -24,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/convert/op_metrics_db_combiner.h"
 #include "tensorflow/core/profiler/protobuf/hardware_types.pb.h"
 #include "tensorflow/core/profiler/protobuf/op_stats.pb.h"
+#include "tensorflow/core/profiler/protobuf/steps_db.pb.h"
 #include "tensorflow/core/profiler/utils/step_intersection.h"
 
 namespace tensorflow {
@@ -80,6 +82,44 @@ void CombineAllOpStats(const std::vector<OpStatsInfo>& all_op_stats_info,
                        const StepIntersection& step_intersection,
                        OpStats* combined_op_stats);
 
+// Combines OpStats one host at a time, so that the OpStats of all the hosts do
+// not need to be in memory at the same time. Only their step databases are
+// kept until Finalize(), because the steps to combine depend on the steps of
+// every host. The result is the same as CombineAllOpStats() with the
+// StepIntersection of ComputeStepIntersectionToMergeOpStats().
+class IncrementalOpStatsCombiner {
+ public:
+  // <combined_op_stats> must be empty and outlive the combiner.
+  explicit IncrementalOpStatsCombiner(OpStats* combined_op_stats);
+
+  // Combines the OpStats of host <src_host_id>. The hosts must be added in
+  // the same order as they would be in CombineAllOpStats().
+  void Add(OpStats op_stats, HardwareType hardware_type, int src_host_id);
+
+  // Combines the step databases of the hosts, with at most
+  // <max_step_per_host> steps.
+  void Finalize(uint32 max_step_per_host);
+
+ private:
+  struct HostStepDb {
+    int src_host_id = 0;
+    HardwareType hardware_type = UNKNOWN_HARDWARE;
+    StepDatabaseResult step_db;
+  };
+
+  // Combines <op_stats> except for its step_db, which is kept for Finalize().
+  void CombineExceptStepDb(OpStats op_stats, HostStepDb host);
+
+  OpStats* const combined_op_stats_;
+  OpMetricsDbCombiner host_op_metrics_db_combiner_;
+  OpMetricsDbCombiner device_op_metrics_db_combiner_;
+  int num_hosts_ = 0;
+  // The first OpStats, which is not combined unless there is a second one.
+  std::optional<OpStats> first_op_stats_;
+  HostStepDb first_host_;
+  std::vector<HostStepDb> host_step_dbs_;
+};
+
 }  // namespace profiler
 }  // namespace tensorflow
 
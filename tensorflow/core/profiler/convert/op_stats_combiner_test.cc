@@ -18,9 +18,13 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/protobuf/hardware_types.pb.h"
+#include "tensorflow/core/profiler/protobuf/kernel_stats.pb.h"
+#include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
 #include "tensorflow/core/profiler/protobuf/op_stats.pb.h"
 #include "tensorflow/core/profiler/protobuf/steps_db.pb.h"
 #include "tensorflow/core/profiler/utils/step_intersection.h"
@@ -80,6 +84,74 @@ TEST(CombineAllOpStatsTest, CombineRunEnvironmentWithUnknownDevice) {
   EXPECT_EQ("TPU", dst_op_stats.run_environment().device_type());
 }
 
+// Returns the OpStats of a host with one core and steps [first_step,
+// first_step + num_steps).
+OpStats MakeHostOpStats(const char* device_type, uint32 first_step,
+                        uint32 num_steps) {
+  OpStats op_stats;
+  op_stats.mutable_run_environment()->set_device_type(device_type);
+  op_stats.mutable_run_environment()->add_hostnames(
+      absl::StrCat(device_type, first_step));
+  OpMetrics* host_op = op_stats.mutable_host_op_metrics_db()->add_metrics_db();
+  host_op->set_name("host_op");
+  host_op->set_occurrences(first_step);
+  host_op->set_time_ps(1000 * first_step);
+  KernelReport* kernel = op_stats.mutable_kernel_stats_db()->add_reports();
+  kernel->set_name(absl::StrCat("kernel", first_step));
+  kernel->set_total_duration_ns(first_step);
+  for (uint32 step = first_step; step < first_step + num_steps; step++) {
+    PerCoreStepInfo* step_info =
+        op_stats.mutable_step_db()->add_step_sequence();
+    step_info->set_step_num(step);
+    StepInfoResult& core_step = (*step_info->mutable_step_info_per_core())[0];
+    core_step.set_step_num(step);
+    core_step.set_begin_ps(step * 100);
+    core_step.set_duration_ps(100);
+    OpMetrics* hlo_op = step_info->mutable_hlo_metrics_db()->add_metrics_db();
+    hlo_op->set_name("hlo_op");
+    hlo_op->set_occurrences(1);
+    hlo_op->set_time_ps(10 * step);
+  }
+  return op_stats;
+}
+
+TEST(IncrementalOpStatsCombinerTest, SameAsCombineAllOpStats) {
+  std::vector<OpStats> all_op_stats = {MakeHostOpStats("TPU", 1, 3),
+                                       MakeHostOpStats("CPU", 1, 4),
+                                       MakeHostOpStats("TPU", 2, 3)};
+  std::vector<HardwareType> hardware_types = {TPU, CPU_ONLY, TPU};
+  std::vector<OpStatsInfo> all_op_stats_info;
+  for (int i = 0; i < all_op_stats.size(); i++) {
+    all_op_stats_info.emplace_back(&all_op_stats[i], hardware_types[i], i);
+  }
+  OpStats expected;
+  CombineAllOpStats(
+      all_op_stats_info,
+      ComputeStepIntersectionToMergeOpStats(all_op_stats_info, kuint32max),
+      &expected);
+
+  OpStats combined;
+  IncrementalOpStatsCombiner combiner(&combined);
+  for (int i = 0; i < all_op_stats.size(); i++) {
+    combiner.Add(all_op_stats[i], hardware_types[i], i);
+  }
+  combiner.Finalize(kuint32max);
+
+  EXPECT_EQ(combined.step_db().step_sequence_size(), 2);
+  EXPECT_EQ(combined.kernel_stats_db().reports_size(), 3);
+  EXPECT_TRUE(protobuf::util::MessageDifferencer::Equals(combined, expected))
+      << combined.DebugString() << "\nvs.\n" << expected.DebugString();
+}
+
+TEST(IncrementalOpStatsCombinerTest, SingleHost) {
+  OpStats op_stats = MakeHostOpStats("TPU", 1, 2);
+  OpStats combined;
+  IncrementalOpStatsCombiner combiner(&combined);
+  combiner.Add(op_stats, TPU, 0);
+  combiner.Finalize(kuint32max);
+  EXPECT_TRUE(protobuf::util::MessageDifferencer::Equals(combined, op_stats));
+}
+
 }  // namespace
 }  // namespace profiler
 }  // namespace tensorflow
@@ -104,6 +104,7 @@ MemoryProfile GenerateMemoryProfile(const XPlane* host_trace) {
         metadata.set_memory_activity(DEALLOCATION);
       }
       metadata.set_step_id(kInvalidStepId);
+      metadata.set_output_index(-1);
 
       std::string memory_id;
       event.ForEachStat([&](const XStatVisitor& stat) {
@@ -156,6 +157,9 @@ MemoryProfile GenerateMemoryProfile(const XPlane* host_trace) {
           case StatType::kTensorShapes:
             metadata.set_tensor_shape(std::string(stat.StrOrRefValue()));
             break;
+          case StatType::kOutputIndex:
+            metadata.set_output_index(stat.IntValue());
+            break;
         }
       });
 
@@ -211,6 +215,8 @@ void UpdateDeallocation(PerAllocatorMemoryProfile* memory_profile) {
             alloc_meta->data_type());
         snapshot.mutable_activity_metadata()->set_tensor_shape(
             alloc_meta->tensor_shape());
+        snapshot.mutable_activity_metadata()->set_output_index(
+            alloc_meta->output_index());
         // In case of following (unexpected) deallocations to the same chunk
         // address, leave the metadata as it is (empty or already captured).
         addr_metadata_map.erase(address);
@@ -249,7 +255,7 @@ int64_t GetPeakMemoryStep(int64_t peak_bytes_profile,
 
 // Functor that compares (index, metadata) pair to sort in the order of
 // allocation bytes and requested bytes (descending), as well as TF Op name,
-// region type, data type, and tensor shape (ascending).
+// output index, region type, data type, and tensor shape (ascending).
 struct MetadataComparator {
   bool operator()(const IndexMetaPair& a, const IndexMetaPair& b) const {
     const MemoryActivityMetadata* a_meta = a.second;
@@ -257,14 +263,14 @@ struct MetadataComparator {
     DCHECK_NE(a_meta, nullptr);
     DCHECK_NE(b_meta, nullptr);
 
-    auto lhs =
-        std::make_tuple(-a_meta->allocation_bytes(), -a_meta->requested_bytes(),
-                        a_meta->tf_op_name(), a_meta->region_type(),
-                        a_meta->data_type(), a_meta->tensor_shape());
-    auto rhs =
-        std::make_tuple(-b_meta->allocation_bytes(), -b_meta->requested_bytes(),
-                        b_meta->tf_op_name(), b_meta->region_type(),
-                        b_meta->data_type(), b_meta->tensor_shape());
+    auto lhs = std::make_tuple(
+        -a_meta->allocation_bytes(), -a_meta->requested_bytes(),
+        a_meta->tf_op_name(), a_meta->output_index(), a_meta->region_type(),
+        a_meta->data_type(), a_meta->tensor_shape());
+    auto rhs = std::make_tuple(
+        -b_meta->allocation_bytes(), -b_meta->requested_bytes(),
+        b_meta->tf_op_name(), b_meta->output_index(), b_meta->region_type(),
+        b_meta->data_type(), b_meta->tensor_shape());
     return lhs < rhs;
   }
 };
@@ -289,6 +295,7 @@ void InsertSpecialAllocations(int64_t unmapped_allocation_bytes,
     special_allocation->set_data_type(
         tensorflow::DataTypeString(static_cast<tensorflow::DataType>(0)));
     special_allocation->set_tensor_shape("unknown");
+    special_allocation->set_output_index(-1);
     active_allocs->push_back({--index, special_allocation});
   }
   int64_t stack_bytes =
@@ -306,6 +313,7 @@ void InsertSpecialAllocations(int64_t unmapped_allocation_bytes,
     special_allocation->set_data_type(
         tensorflow::DataTypeString(static_cast<tensorflow::DataType>(0)));
     special_allocation->set_tensor_shape("unknown");
+    special_allocation->set_output_index(-1);
     active_allocs->push_back({--index, special_allocation});
   }
 }
@@ -316,6 +324,7 @@ bool operator==(const IndexMetaPair& a, const IndexMetaPair& b) {
   return a_meta->allocation_bytes() == b_meta->allocation_bytes() &&
          a_meta->requested_bytes() == b_meta->requested_bytes() &&
          a_meta->tf_op_name() == b_meta->tf_op_name() &&
+         a_meta->output_index() == b_meta->output_index() &&
          a_meta->region_type() == b_meta->region_type() &&
          a_meta->data_type() == b_meta->data_type() &&
          a_meta->tensor_shape() == b_meta->tensor_shape();
@@ -555,6 +564,44 @@ MemoryProfile ConvertXPlaneToMemoryProfile(const XPlane& host_plane,
   return memory_profile;
 }
 
+std::vector<PeakMemoryTensor> GetPeakMemoryTensors(
+    const MemoryProfile& memory_profile) {
+  std::vector<PeakMemoryTensor> tensors;
+  for (const auto& memory_id : memory_profile.memory_ids()) {
+    const PerAllocatorMemoryProfile* allocator_memory_profile = gtl::FindOrNull(
+        memory_profile.memory_profile_per_allocator(), memory_id);
+    if (allocator_memory_profile == nullptr) continue;
+    const auto& snapshots = allocator_memory_profile->memory_profile_snapshots();
+    const auto& special_allocations =
+        allocator_memory_profile->special_allocations();
+    for (const ActiveAllocation& allocation :
+         allocator_memory_profile->active_allocations()) {
+      const MemoryActivityMetadata* metadata = nullptr;
+      if (allocation.snapshot_index() >= 0) {
+        if (allocation.snapshot_index() >= snapshots.size()) continue;
+        metadata = &snapshots[allocation.snapshot_index()].activity_metadata();
+      } else {
+        if (allocation.special_index() < 0 ||
+            allocation.special_index() >= special_allocations.size()) {
+          continue;
+        }
+        metadata = &special_allocations[allocation.special_index()];
+      }
+      PeakMemoryTensor& tensor = tensors.emplace_back();
+      tensor.memory_id = memory_id;
+      tensor.tf_op_name = metadata->tf_op_name();
+      tensor.output_index = metadata->output_index();
+      tensor.region_type = metadata->region_type();
+      tensor.data_type = metadata->data_type();
+      tensor.tensor_shape = metadata->tensor_shape();
+      tensor.allocation_bytes = metadata->allocation_bytes();
+      tensor.step_id = metadata->step_id();
+      tensor.num_occurrences = allocation.num_occurrences();
+    }
+  }
+  return tensors;
+}
+
 Status ConvertXSpaceToMemoryProfileJson(const XSpace& xspace,
                                         std::string* json_output) {
   if (const XPlane* host_plane =
@@ -16,7 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_PROFILER_CONVERT_XPLANE_TO_MEMORY_PROFILE_H_
 #define TENSORFLOW_CORE_PROFILER_CONVERT_XPLANE_TO_MEMORY_PROFILE_H_
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/types.h"
@@ -32,6 +34,28 @@ namespace profiler {
 MemoryProfile ConvertXPlaneToMemoryProfile(const XPlane& host_plane,
                                            int64_t max_num_snapshots = 1000);
 
+// A tensor (or a group of identical tensors) live at the peak memory usage of
+// an allocator, with the op that produced it.
+struct PeakMemoryTensor {
+  // Id of the allocator, e.g. "GPU_0_bfc".
+  std::string memory_id;
+  std::string tf_op_name;
+  // Index of the output of tf_op_name, or -1 if the tensor is not an output.
+  int32_t output_index = -1;
+  std::string region_type;
+  std::string data_type;
+  std::string tensor_shape;
+  // Bytes of each of the num_occurrences identical tensors.
+  int64_t allocation_bytes = 0;
+  int64_t step_id = 0;
+  int64_t num_occurrences = 0;
+};
+
+// Returns the tensors live at the peak memory usage of each allocator of
+// memory_profile, in the order of memory_ids and from the largest tensor.
+std::vector<PeakMemoryTensor> GetPeakMemoryTensors(
+    const MemoryProfile& memory_profile);
+
 Status ConvertXSpaceToMemoryProfileJson(const XSpace& xspace,
                                         std::string* json_output);
 }  // namespace profiler
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/profiler/convert/xplane_to_memory_profile.h"
 
+#include <vector>
+
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/types.h"
@@ -122,6 +124,71 @@ TEST(ConvertXPlaneToMemoryProfile, OneAllocatorMultiActivitiesTest) {
       2000);
 }
 
+// Tests that the tensors live at the peak memory usage are reported with the
+// op outputs they were allocated for.
+TEST(ConvertXPlaneToMemoryProfile, PeakMemoryTensorsTest) {
+  XSpace space;
+  XPlane* host_plane = GetOrCreateHostXPlane(&space);
+  XPlaneBuilder host_plane_builder(host_plane);
+  host_plane_builder.ReserveLines(1);
+
+  auto tf_executor_thread = host_plane_builder.GetOrCreateLine(0);
+  CreateXEvent(&host_plane_builder, &tf_executor_thread, "MemoryAllocation",
+               40000, 1000,
+               {{StatType::kBytesReserved, int64_t{2000}},
+                {StatType::kBytesAllocated, int64_t{3000}},
+                {StatType::kPeakBytesInUse, int64_t{3000}},
+                {StatType::kRequestedBytes, int64_t{200}},
+                {StatType::kAllocationBytes, int64_t{256}},
+                {StatType::kAddress, int64_t{222333}},
+                {StatType::kDataType, int64_t{1}},
+                {StatType::kAllocatorName, "GPU_0_bfc"},
+                {StatType::kTfOp, "foo/bar"},
+                {StatType::kRegionType, "output"},
+                {StatType::kOutputIndex, int64_t{1}},
+                {StatType::kTensorShapes, "[8, 8]"}});
+
+  CreateXEvent(&host_plane_builder, &tf_executor_thread, "MemoryAllocation",
+               70000, 1000,
+               {{StatType::kBytesReserved, int64_t{2000}},
+                {StatType::kBytesAllocated, int64_t{5000}},
+                {StatType::kPeakBytesInUse, int64_t{5000}},
+                {StatType::kRequestedBytes, int64_t{300}},
+                {StatType::kAllocationBytes, int64_t{300}},
+                {StatType::kAddress, int64_t{345678}},
+                {StatType::kDataType, int64_t{9}},
+                {StatType::kAllocatorName, "GPU_0_bfc"},
+                {StatType::kTfOp, "mul_grad/Sum"},
+                {StatType::kRegionType, "temp"},
+                {StatType::kOutputIndex, int64_t{-1}},
+                {StatType::kTensorShapes, "[1, 2]"}});
+
+  tsl::profiler::GroupTfEvents(&space);
+  MemoryProfile memory_profile = ConvertXPlaneToMemoryProfile(*host_plane);
+  std::vector<PeakMemoryTensor> tensors = GetPeakMemoryTensors(memory_profile);
+  // The unmapped heap memory, the stack, and the two tensors.
+  ASSERT_EQ(tensors.size(), 4);
+  EXPECT_EQ(tensors[0].tf_op_name, "unused preallocated device memory");
+  EXPECT_EQ(tensors[0].allocation_bytes, 5000 - 300 - 256);
+  EXPECT_EQ(tensors[1].tf_op_name, "stack");
+  EXPECT_EQ(tensors[1].allocation_bytes, 2000);
+
+  EXPECT_EQ(tensors[2].memory_id, "GPU_0_bfc");
+  EXPECT_EQ(tensors[2].tf_op_name, "mul_grad/Sum");
+  EXPECT_EQ(tensors[2].output_index, -1);
+  EXPECT_EQ(tensors[2].region_type, "temp");
+  EXPECT_EQ(tensors[2].allocation_bytes, 300);
+
+  EXPECT_EQ(tensors[3].memory_id, "GPU_0_bfc");
+  EXPECT_EQ(tensors[3].tf_op_name, "foo/bar");
+  EXPECT_EQ(tensors[3].output_index, 1);
+  EXPECT_EQ(tensors[3].region_type, "output");
+  EXPECT_EQ(tensors[3].data_type, "float");
+  EXPECT_EQ(tensors[3].tensor_shape, "[8, 8]");
+  EXPECT_EQ(tensors[3].allocation_bytes, 256);
+  EXPECT_EQ(tensors[3].num_occurrences, 1);
+}
+
 }  // namespace
 }  // namespace profiler
 }  // namespace tensorflow
@@ -20,11 +20,14 @@ limitations under the License.
 #include <string>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/dataset_options.pb.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/profiler/protobuf/tf_data_stats.pb.h"
 #include "tensorflow/core/profiler/utils/html_utils.h"
@@ -328,6 +331,10 @@ void SetBottleneckAnalysis(CombinedTfDataStats* combined_tf_data_stats) {
         input_pipeline.iterator_long_name.size());
     bottleneck_analysis->set_iterator_latency_ps(
         input_pipeline.iterator_latency_ps);
+    for (std::string& node_name :
+         GetModelNodePath(input_pipeline.iterator_long_name)) {
+      bottleneck_analysis->add_model_node_path(std::move(node_name));
+    }
   }
 }
 
@@ -416,9 +423,20 @@ void SetSuggestion(CombinedTfDataStats* combined_tf_data_stats) {
        *combined_tf_data_stats->mutable_bottleneck_analysis()) {
     bottleneck_analysis.set_suggestion(
         GetSuggestion(GetBottleneckType(bottleneck_analysis.iterator_name())));
+    SetRecommendations(&bottleneck_analysis);
   }
 }
 
+void AddRecommendation(TfDataRecommendation::Kind kind,
+                       absl::string_view description, bool in_options_patch,
+                       TfDataBottleneckAnalysis* bottleneck_analysis) {
+  TfDataRecommendation* recommendation =
+      bottleneck_analysis->add_recommendations();
+  recommendation->set_kind(kind);
+  recommendation->set_description(description.data(), description.size());
+  recommendation->set_in_options_patch(in_options_patch);
+}
+
 void SetSummary(CombinedTfDataStats* combined_tf_data_stats) {
   int64_t max_latency_ps = 0;
   if (combined_tf_data_stats->bottleneck_analysis_size()) {
@@ -492,6 +510,128 @@ BottleneckType GetBottleneckType(absl::string_view bottleneck_iterator_name) {
   return BottleneckType::kOther;
 }
 
+std::vector<std::string> GetModelNodePath(
+    absl::string_view iterator_long_name) {
+  std::vector<std::string> path =
+      absl::StrSplit(iterator_long_name, "::", absl::SkipEmpty());
+  // Drops the "Iterator" prefix and the outermost iterator.
+  path.erase(path.begin(), path.begin() + std::min<size_t>(2, path.size()));
+  return path;
+}
+
+void SetRecommendations(TfDataBottleneckAnalysis* bottleneck_analysis) {
+  bottleneck_analysis->clear_recommendations();
+  bottleneck_analysis->clear_options_patch();
+  const std::string& name = bottleneck_analysis->iterator_name();
+  const auto& path = bottleneck_analysis->model_node_path();
+  absl::string_view parent_name =
+      path.size() >= 2 ? absl::string_view(path[path.size() - 2]) : "";
+  data::Options* options_patch = bottleneck_analysis->mutable_options_patch();
+  data::OptimizationOptions* optimization_options =
+      options_patch->mutable_optimization_options();
+  const std::string cache_description = absl::StrCat(
+      "Add cache() after ", name,
+      " if its output fits into memory and no upstream transformation is "
+      "random (e.g. shuffle).");
+
+  switch (GetBottleneckType(name)) {
+    case BottleneckType::kSlowSource:
+      AddRecommendation(
+          TfDataRecommendation::PARALLELISM,
+          absl::StrCat("Read the inputs of ", name,
+                       " in parallel with interleave(..., "
+                       "num_parallel_calls=tf.data.AUTOTUNE) over its files."),
+          /*in_options_patch=*/false, bottleneck_analysis);
+      AddRecommendation(TfDataRecommendation::CACHE, cache_description,
+                        /*in_options_patch=*/false, bottleneck_analysis);
+      break;
+    case BottleneckType::kSlowTransformationWithParallelVersion:
+      if (name == "Map") {
+        optimization_options->set_map_parallelization(true);
+        AddRecommendation(TfDataRecommendation::PARALLELISM,
+                          "Run Map with num_parallel_calls=tf.data.AUTOTUNE. "
+                          "The map_parallelization option does so for "
+                          "stateless functions.",
+                          /*in_options_patch=*/true, bottleneck_analysis);
+        if (parent_name == "Batch") {
+          optimization_options->set_map_and_batch_fusion(true);
+          AddRecommendation(TfDataRecommendation::VECTORIZATION,
+                            "Batch before Map and vectorize the mapped "
+                            "function, or let the map_and_batch_fusion option "
+                            "fuse them.",
+                            /*in_options_patch=*/true, bottleneck_analysis);
+        }
+      } else {
+        AddRecommendation(
+            TfDataRecommendation::PARALLELISM,
+            absl::StrCat("Run ", name,
+                         " with num_parallel_calls=tf.data.AUTOTUNE."),
+            /*in_options_patch=*/false, bottleneck_analysis);
+      }
+      AddRecommendation(TfDataRecommendation::CACHE, cache_description,
+                        /*in_options_patch=*/false, bottleneck_analysis);
+      break;
+    case BottleneckType::kSlowTransformationWithoutParallelVersion:
+      if (name == "Filter") {
+        optimization_options->set_filter_parallelization(true);
+        AddRecommendation(TfDataRecommendation::PARALLELISM,
+                          "Evaluate the Filter predicate in parallel with the "
+                          "filter_parallelization option.",
+                          /*in_options_patch=*/true, bottleneck_analysis);
+      } else if (name == "Batch") {
+        optimization_options->set_parallel_batch(true);
+        AddRecommendation(TfDataRecommendation::PARALLELISM,
+                          "Copy the Batch elements in parallel with the "
+                          "parallel_batch option.",
+                          /*in_options_patch=*/true, bottleneck_analysis);
+      } else {
+        AddRecommendation(TfDataRecommendation::PARALLELISM,
+                          absl::StrCat("Run multiple copies of the input "
+                                       "pipeline up to ",
+                                       name, " over sharded inputs."),
+                          /*in_options_patch=*/false, bottleneck_analysis);
+      }
+      AddRecommendation(TfDataRecommendation::CACHE, cache_description,
+                        /*in_options_patch=*/false, bottleneck_analysis);
+      break;
+    default:
+      break;
+  }
+
+  std::vector<absl::string_view> iterator_names =
+      absl::StrSplit(bottleneck_analysis->iterator_long_name(), "::");
+  if (!absl::c_linear_search(iterator_names, "Prefetch")) {
+    optimization_options->set_inject_prefetch(true);
+    AddRecommendation(TfDataRecommendation::PREFETCH,
+                      "Prefetch the output of the input pipeline so that it "
+                      "overlaps with the training step, with the "
+                      "inject_prefetch option.",
+                      /*in_options_patch=*/true, bottleneck_analysis);
+  } else if (name != "Prefetch") {
+    AddRecommendation(TfDataRecommendation::PREFETCH,
+                      "Set the buffer_size of prefetch to tf.data.AUTOTUNE so "
+                      "that its depth is tuned to the producer latency.",
+                      /*in_options_patch=*/false, bottleneck_analysis);
+  }
+
+  // The tuned parallelism and prefetch depths rely on autotuning.
+  if (optimization_options->ByteSizeLong() > 0) {
+    options_patch->mutable_autotune_options()->set_enabled(true);
+  } else {
+    bottleneck_analysis->clear_options_patch();
+  }
+}
+
+data::Options GetOptionsPatch(
+    const CombinedTfDataStats& combined_tf_data_stats) {
+  data::Options options_patch;
+  for (const TfDataBottleneckAnalysis& bottleneck_analysis :
+       combined_tf_data_stats.bottleneck_analysis()) {
+    options_patch.MergeFrom(bottleneck_analysis.options_patch());
+  }
+  return options_patch;
+}
+
 void CombinedTfDataStatsBuilder::Add(absl::string_view host_name,
                                      XPlane* host_plane) {
   TfDataStats& tf_data_stats =
@@ -16,7 +16,11 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_PROFILER_CONVERT_XPLANE_TO_TF_DATA_STATS_H_
 #define TENSORFLOW_CORE_PROFILER_CONVERT_XPLANE_TO_TF_DATA_STATS_H_
 
+#include <string>
+#include <vector>
+
 #include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/dataset_options.pb.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/protobuf/tf_data_stats.pb.h"
@@ -38,6 +42,22 @@ enum class BottleneckType {
 
 BottleneckType GetBottleneckType(absl::string_view bottleneck_iterator_name);
 
+// Returns the names of the tf.data Model nodes from the root of the input
+// pipeline to the iterator with the given long name, e.g. {"Prefetch", "Map"}
+// for "Iterator::Root::Prefetch::Map". The outermost iterator has no parent
+// and therefore no Model node.
+std::vector<std::string> GetModelNodePath(absl::string_view iterator_long_name);
+
+// Sets the recommendations and the options patch of `bottleneck_analysis`
+// from its bottleneck iterator and Model node path.
+void SetRecommendations(TfDataBottleneckAnalysis* bottleneck_analysis);
+
+// Returns the tf.data options that apply the recommendations of all the
+// bottlenecks that can be applied automatically. The result is meant to be
+// merged into the options of the input pipelines on the next run.
+data::Options GetOptionsPatch(
+    const CombinedTfDataStats& combined_tf_data_stats);
+
 class CombinedTfDataStatsBuilder {
  public:
   explicit CombinedTfDataStatsBuilder(
@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/profiler/convert/xplane_to_tf_data_stats.h"
 
+#include <string>
+#include <vector>
+
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/profiler/protobuf/tf_data_stats.pb.h"
 #include "tensorflow/core/profiler/protobuf/xplane.pb.h"
@@ -26,7 +29,9 @@ namespace tensorflow {
 namespace profiler {
 namespace {
 
+using ::testing::ElementsAre;
 using ::testing::EqualsProto;
+using ::testing::IsEmpty;
 
 // Test with the following example dataset:
 // dataset = tf.data.Dataset.range(8)
@@ -87,6 +92,11 @@ TEST(XPlaneToTfDataStatsTest, HostInputPipeline) {
           iterator_long_name: "Iterator::Prefetch::Range"
           iterator_latency_ps: 80000000
           suggestion: "See <a href=\"https://www.tensorflow.org/guide/data_performance_analysis\" target=\"_blank\">this</a> for suggestions."
+          model_node_path: "Range"
+          recommendations {
+            kind: PREFETCH
+            description: "Set the buffer_size of prefetch to tf.data.AUTOTUNE so that its depth is tuned to the producer latency."
+          }
         }
         tf_data_stats: {
           key: "host1"
@@ -345,6 +355,16 @@ TEST(XPlaneToTfDataStatsTest, MapAndBatch) {
           iterator_long_name: "Iterator::MapAndBatch::Range"
           iterator_latency_ps: 60000000
           suggestion: "See <a href=\"https://www.tensorflow.org/guide/data_performance_analysis\" target=\"_blank\">this</a> for suggestions."
+          model_node_path: "Range"
+          recommendations {
+            kind: PREFETCH
+            description: "Prefetch the output of the input pipeline so that it overlaps with the training step, with the inject_prefetch option."
+            in_options_patch: true
+          }
+          options_patch {
+            optimization_options { inject_prefetch: true }
+            autotune_options { enabled: true }
+          }
         }
         tf_data_stats: {
           key: "host1"
@@ -411,6 +431,43 @@ TEST(XPlaneToTfDataStatsTest, MapAndBatch) {
       )pb"));
 }
 
+TEST(XPlaneToTfDataStatsTest, GetModelNodePath) {
+  EXPECT_THAT(GetModelNodePath("Iterator::Root::Prefetch::Map"),
+              ElementsAre("Prefetch", "Map"));
+  EXPECT_THAT(GetModelNodePath("Iterator::Root"), IsEmpty());
+}
+
+TEST(XPlaneToTfDataStatsTest, MapRecommendations) {
+  CombinedTfDataStats combined_tf_data_stats;
+  TfDataBottleneckAnalysis* bottleneck_analysis =
+      combined_tf_data_stats.add_bottleneck_analysis();
+  bottleneck_analysis->set_iterator_name("Map");
+  bottleneck_analysis->set_iterator_long_name(
+      "Iterator::Root::Prefetch::Batch::Map");
+  for (const std::string& node_name :
+       GetModelNodePath(bottleneck_analysis->iterator_long_name())) {
+    bottleneck_analysis->add_model_node_path(node_name);
+  }
+  SetRecommendations(bottleneck_analysis);
+
+  std::vector<TfDataRecommendation::Kind> kinds;
+  for (const TfDataRecommendation& recommendation :
+       bottleneck_analysis->recommendations()) {
+    kinds.push_back(recommendation.kind());
+  }
+  EXPECT_THAT(kinds, ElementsAre(TfDataRecommendation::PARALLELISM,
+                                 TfDataRecommendation::VECTORIZATION,
+                                 TfDataRecommendation::CACHE,
+                                 TfDataRecommendation::PREFETCH));
+  EXPECT_THAT(GetOptionsPatch(combined_tf_data_stats), EqualsProto(R"pb(
+                optimization_options {
+                  map_and_batch_fusion: true
+                  map_parallelization: true
+                }
+                autotune_options { enabled: true }
+              )pb"));
+}
+
 }  // namespace
 }  // namespace profiler
 }  // namespace tensorflow
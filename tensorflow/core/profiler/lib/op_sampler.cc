@@ -0,0 +1,160 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/profiler/lib/op_sampler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+uint64_t RoundUpToPowerOfTwo(int64_t n) {
+  uint64_t result = 1;
+  while (result < static_cast<uint64_t>(n)) result <<= 1;
+  return result;
+}
+
+// Stores the first `num_words * 8` characters of `str`, padded with zeros.
+void StoreString(absl::string_view str, int num_words,
+                 std::atomic<uint64_t>* words) {
+  char buffer[OpSampler::kMaxNameLength] = {};
+  std::memcpy(buffer, str.data(),
+              std::min<size_t>(str.size(), num_words * sizeof(uint64_t)));
+  for (int i = 0; i < num_words; ++i) {
+    uint64_t word;
+    std::memcpy(&word, buffer + i * sizeof(uint64_t), sizeof(word));
+    words[i].store(word, std::memory_order_relaxed);
+  }
+}
+
+std::string LoadString(int num_words, const std::atomic<uint64_t>* words) {
+  char buffer[OpSampler::kMaxNameLength];
+  for (int i = 0; i < num_words; ++i) {
+    const uint64_t word = words[i].load(std::memory_order_relaxed);
+    std::memcpy(buffer + i * sizeof(uint64_t), &word, sizeof(word));
+  }
+  const size_t size = num_words * sizeof(uint64_t);
+  return std::string(buffer, strnlen(buffer, size));
+}
+
+}  // namespace
+
+OpSampler* OpSampler::Get() {
+  static OpSampler* sampler = [] {
+    int64_t sampling_rate = 0;
+    Status status = ReadInt64FromEnvVar("TF_OP_SAMPLER_RATE",
+                                        /*default_val=*/0, &sampling_rate);
+    if (!status.ok()) LOG(WARNING) << status;
+    return new OpSampler(std::max<int64_t>(sampling_rate, 0));
+  }();
+  return sampler;
+}
+
+OpSampler::OpSampler(int64_t sampling_rate, int64_t capacity)
+    : sampling_rate_(sampling_rate),
+      mask_(RoundUpToPowerOfTwo(capacity) - 1) {
+  // The ring is only needed when sampling.
+  if (sampling_rate_ > 0) slots_.reset(new Slot[mask_ + 1]);
+}
+
+void OpSampler::Record(absl::string_view name, absl::string_view type,
+                       uint64_t start_ns, uint64_t end_ns, uint64_t bytes) {
+  if (slots_ == nullptr) return;
+  const uint64_t pos = next_.fetch_add(1, std::memory_order_relaxed);
+  Slot& slot = slots_[pos & mask_];
+  // Claim the slot, unless the writer of an older sample is still writing it
+  // or a newer sample already overwrote it.
+  uint64_t seq = slot.seq.load(std::memory_order_relaxed);
+  if ((seq & 1) != 0 || seq > 2 * pos ||
+      !slot.seq.compare_exchange_strong(seq, 2 * pos + 1,
+                                        std::memory_order_relaxed)) {
+    return;
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+  std::atomic<uint64_t>* words = slot.words;
+  StoreString(name, kNameWords, words);
+  words += kNameWords;
+  StoreString(type, kTypeWords, words);
+  words += kTypeWords;
+  words[0].store(start_ns, std::memory_order_relaxed);
+  words[1].store(end_ns, std::memory_order_relaxed);
+  words[2].store(bytes, std::memory_order_relaxed);
+  words[3].store(Env::Default()->GetCurrentThreadId(),
+                 std::memory_order_relaxed);
+  slot.seq.store(2 * pos + 2, std::memory_order_release);
+}
+
+bool OpSampler::ReadSlot(uint64_t pos, OpSample* sample,
+                         bool* in_progress) const {
+  const Slot& slot = slots_[pos & mask_];
+  const uint64_t seq = slot.seq.load(std::memory_order_acquire);
+  *in_progress = seq < 2 * pos + 2;
+  if (seq != 2 * pos + 2) return false;
+  const std::atomic<uint64_t>* words = slot.words;
+  sample->name = LoadString(kNameWords, words);
+  words += kNameWords;
+  sample->type = LoadString(kTypeWords, words);
+  words += kTypeWords;
+  sample->start_ns = words[0].load(std::memory_order_relaxed);
+  sample->end_ns = words[1].load(std::memory_order_relaxed);
+  sample->bytes = words[2].load(std::memory_order_relaxed);
+  sample->thread_id = words[3].load(std::memory_order_relaxed);
+  // The sample is valid only if no writer claimed the slot while it was read.
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return slot.seq.load(std::memory_order_relaxed) == seq;
+}
+
+std::vector<OpSample> OpSampler::Drain() {
+  std::vector<OpSample> samples;
+  if (slots_ == nullptr) return samples;
+  mutex_lock lock(drain_mu_);
+  const uint64_t end = next_.load(std::memory_order_acquire);
+  const uint64_t capacity = mask_ + 1;
+  uint64_t pos = read_pos_;
+  if (end - pos > capacity) {
+    dropped_.fetch_add(end - capacity - pos, std::memory_order_relaxed);
+    pos = end - capacity;
+  }
+  samples.reserve(end - pos);
+  for (; pos < end; ++pos) {
+    OpSample sample;
+    bool in_progress;
+    if (ReadSlot(pos, &sample, &in_progress)) {
+      samples.push_back(std::move(sample));
+    } else if (in_progress) {
+      // Drain this sample and the ones after it next time.
+      break;
+    } else {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  read_pos_ = pos;
+  return samples;
+}
+
+}  // namespace profiler
+}  // namespace tensorflow
@@ -0,0 +1,127 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_PROFILER_LIB_OP_SAMPLER_H_
+#define TENSORFLOW_CORE_PROFILER_LIB_OP_SAMPLER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace profiler {
+
+// An op execution recorded by the OpSampler.
+struct OpSample {
+  std::string name;
+  std::string type;
+  uint64_t start_ns = 0;
+  uint64_t end_ns = 0;
+  // Bytes of the outputs of the op.
+  uint64_t bytes = 0;
+  int64_t thread_id = 0;
+};
+
+// OpSampler records the execution of the ops of one step out of every
+// `sampling_rate` steps into a fixed size ring buffer, so that op latencies
+// can be monitored continuously in production without running the profiler.
+//
+// Record() is lock-free and does not allocate: ops claim a slot with an atomic
+// increment and publish it with a sequence number. When the ring wraps around
+// before it is drained, the oldest samples are overwritten and counted as
+// dropped. A sample is also lost when the writer of the sample one lap older
+// is still writing its slot. Drain() may be called concurrently with Record()
+// from any thread.
+class OpSampler {
+ public:
+  // Maximum number of characters kept from the op names and types.
+  static constexpr int kMaxNameLength = 96;
+  static constexpr int kMaxTypeLength = 32;
+
+  static constexpr int64_t kDefaultCapacity = 1 << 14;
+
+  // Returns the process-wide sampler, which samples one step in every
+  // TF_OP_SAMPLER_RATE steps. Sampling is disabled when TF_OP_SAMPLER_RATE is
+  // not set or is 0.
+  static OpSampler* Get();
+
+  // Samples one step in every `sampling_rate` steps, or none when
+  // `sampling_rate` is 0. `capacity` is rounded up to a power of two.
+  explicit OpSampler(int64_t sampling_rate,
+                     int64_t capacity = kDefaultCapacity);
+
+  OpSampler(const OpSampler&) = delete;
+  void operator=(const OpSampler&) = delete;
+
+  bool enabled() const { return sampling_rate_ > 0; }
+
+  // Returns whether the ops of step `step_id` should be recorded.
+  bool ShouldSampleStep(int64_t step_id) const {
+    return sampling_rate_ > 0 && step_id % sampling_rate_ == 0;
+  }
+
+  // Records the execution of op `name` of type `type` on the calling thread.
+  void Record(absl::string_view name, absl::string_view type,
+              uint64_t start_ns, uint64_t end_ns, uint64_t bytes);
+
+  // Returns the samples recorded since the previous call, oldest first.
+  std::vector<OpSample> Drain();
+
+  // Returns the number of samples that were overwritten before being drained.
+  uint64_t dropped() const {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  static constexpr int kNameWords = kMaxNameLength / sizeof(uint64_t);
+  static constexpr int kTypeWords = kMaxTypeLength / sizeof(uint64_t);
+  // Name, type, start, end, bytes and thread id.
+  static constexpr int kSlotWords = kNameWords + kTypeWords + 4;
+
+  struct Slot {
+    // 2 * pos + 1 while the sample at position `pos` is written, 2 * pos + 2
+    // once it is complete.
+    std::atomic<uint64_t> seq{0};
+    // The sample, stored as atomic words so that readers racing with a writer
+    // that overwrites the slot never read a torn word.
+    std::atomic<uint64_t> words[kSlotWords];
+  };
+
+  // Reads the sample at position `pos` into `sample`. Returns false if it was
+  // overwritten, or if it is not published yet, in which case `*in_progress`
+  // is set.
+  bool ReadSlot(uint64_t pos, OpSample* sample, bool* in_progress) const;
+
+  const int64_t sampling_rate_;
+  const uint64_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+  // Position of the next sample to write.
+  std::atomic<uint64_t> next_{0};
+  std::atomic<uint64_t> dropped_{0};
+
+  mutex drain_mu_;
+  // Position of the next sample to drain.
+  uint64_t read_pos_ TF_GUARDED_BY(drain_mu_) = 0;
+};
+
+}  // namespace profiler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_LIB_OP_SAMPLER_H_
@@ -0,0 +1,109 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/profiler/lib/op_sampler.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+TEST(OpSamplerTest, ShouldSampleStep) {
+  OpSampler sampler(/*sampling_rate=*/10);
+  EXPECT_TRUE(sampler.enabled());
+  EXPECT_TRUE(sampler.ShouldSampleStep(0));
+  EXPECT_FALSE(sampler.ShouldSampleStep(7));
+  EXPECT_TRUE(sampler.ShouldSampleStep(20));
+
+  OpSampler disabled(/*sampling_rate=*/0);
+  EXPECT_FALSE(disabled.enabled());
+  EXPECT_FALSE(disabled.ShouldSampleStep(0));
+  disabled.Record("a", "A", 1, 2, 3);
+  EXPECT_TRUE(disabled.Drain().empty());
+}
+
+TEST(OpSamplerTest, RecordAndDrain) {
+  OpSampler sampler(/*sampling_rate=*/1, /*capacity=*/8);
+  const std::string long_name(200, 'n');
+  sampler.Record("matmul", "MatMul", 100, 150, 64);
+  sampler.Record(long_name, "Conv2DBackpropFilterWithAVeryLongTypeName", 160,
+                 170, 0);
+
+  std::vector<OpSample> samples = sampler.Drain();
+  ASSERT_EQ(samples.size(), 2);
+  EXPECT_EQ(samples[0].name, "matmul");
+  EXPECT_EQ(samples[0].type, "MatMul");
+  EXPECT_EQ(samples[0].start_ns, 100);
+  EXPECT_EQ(samples[0].end_ns, 150);
+  EXPECT_EQ(samples[0].bytes, 64);
+  EXPECT_EQ(samples[0].thread_id, Env::Default()->GetCurrentThreadId());
+  EXPECT_EQ(samples[1].name, long_name.substr(0, OpSampler::kMaxNameLength));
+  EXPECT_EQ(samples[1].type.size(), OpSampler::kMaxTypeLength);
+
+  EXPECT_TRUE(sampler.Drain().empty());
+  EXPECT_EQ(sampler.dropped(), 0);
+}
+
+TEST(OpSamplerTest, OverwritesOldestSamples) {
+  OpSampler sampler(/*sampling_rate=*/1, /*capacity=*/5);
+  // The capacity is rounded up to 8.
+  for (int i = 0; i < 10; ++i) {
+    sampler.Record(absl::StrCat("op", i), "Op", i, i + 1, 0);
+  }
+  std::vector<OpSample> samples = sampler.Drain();
+  ASSERT_EQ(samples.size(), 8);
+  EXPECT_EQ(samples.front().name, "op2");
+  EXPECT_EQ(samples.back().name, "op9");
+  EXPECT_EQ(sampler.dropped(), 2);
+}
+
+TEST(OpSamplerTest, ConcurrentRecordAndDrain) {
+  constexpr int kThreads = 4;
+  constexpr int kSamplesPerThread = 1000;
+  OpSampler sampler(/*sampling_rate=*/1, /*capacity=*/64);
+  std::vector<OpSample> samples;
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kThreads);
+    for (int t = 0; t < kThreads; ++t) {
+      pool.Schedule([&sampler, t] {
+        for (int i = 0; i < kSamplesPerThread; ++i) {
+          sampler.Record(absl::StrCat("op", t), "Op", i, i, t);
+        }
+      });
+    }
+    for (int i = 0; i < 100; ++i) {
+      for (OpSample& sample : sampler.Drain()) samples.push_back(sample);
+    }
+  }
+  for (OpSample& sample : sampler.Drain()) samples.push_back(sample);
+
+  // Samples may be lost, but the drained ones are never torn.
+  EXPECT_FALSE(samples.empty());
+  EXPECT_LE(samples.size() + sampler.dropped(), kThreads * kSamplesPerThread);
+  for (const OpSample& sample : samples) {
+    EXPECT_EQ(sample.name, absl::StrCat("op", sample.bytes));
+    EXPECT_EQ(sample.start_ns, sample.end_ns);
+  }
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tensorflow
@@ -15,6 +15,8 @@ limitations under the License.
 #include "tensorflow/core/summary/summary_file_writer.h"
 
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
@@ -24,19 +26,27 @@ limitations under the License.
 #include "tensorflow/core/framework/summary.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/summary/summary_converter.h"
 #include "tensorflow/core/util/events_writer.h"
 
 namespace tensorflow {
 namespace {
 
+auto* dropped_events = monitoring::Counter<0>::New(
+    "/tensorflow/core/summary/dropped_events",
+    "The number of summary events dropped because the queue of the background "
+    "summary file writer was full.");
+
 class SummaryFileWriter : public SummaryWriterInterface {
  public:
-  SummaryFileWriter(int max_queue, int flush_millis, Env* env)
+  SummaryFileWriter(int max_queue, int flush_millis, int async_queue_size,
+                    Env* env)
       : SummaryWriterInterface(),
         is_initialized_(false),
         max_queue_(max_queue),
         flush_millis_(flush_millis),
+        async_queue_size_(async_queue_size),
         env_(env) {}
 
   Status Initialize(const string& logdir, const string& filename_suffix) {
@@ -56,13 +66,20 @@ class SummaryFileWriter : public SummaryWriterInterface {
     const string uniquified_filename_suffix = absl::StrCat(
         ".", pid, ".", file_id_counter.fetch_add(1), sep, filename_suffix);
     mutex_lock ml(mu_);
-    events_writer_ =
-        std::make_unique<EventsWriter>(io::JoinPath(logdir, "events"));
-    TF_RETURN_WITH_CONTEXT_IF_ERROR(
-        events_writer_->InitWithSuffix(uniquified_filename_suffix),
-        "Could not initialize events writer.");
+    {
+      mutex_lock wl(writer_mu_);
+      events_writer_ =
+          std::make_unique<EventsWriter>(io::JoinPath(logdir, "events"));
+      TF_RETURN_WITH_CONTEXT_IF_ERROR(
+          events_writer_->InitWithSuffix(uniquified_filename_suffix),
+          "Could not initialize events writer.");
+    }
     last_flush_ = env_->NowMicros();
     is_initialized_ = true;
+    if (async_queue_size_ > 0) {
+      writer_thread_.reset(env_->StartThread(
+          ThreadOptions(), "summary_file_writer", [this] { WriterLoop(); }));
+    }
     return absl::OkStatus();
   }
 
@@ -71,11 +88,25 @@ class SummaryFileWriter : public SummaryWriterInterface {
     if (!is_initialized_) {
       return errors::FailedPrecondition("Class was not properly initialized.");
     }
-    return InternalFlush();
+    if (writer_thread_ == nullptr) return InternalFlush();
+
+    // Wait for the background thread to write and flush the events so far.
+    const int64_t generation = ScheduleFlush();
+    while (flushed_generation_ < generation) {
+      flushed_cv_.wait(ml);
+    }
+    return async_status_;
   }
 
   ~SummaryFileWriter() override {
     (void)Flush();  // Ignore errors.
+    {
+      mutex_lock ml(mu_);
+      shutdown_ = true;
+      pending_cv_.notify_all();
+    }
+    // Joins the background thread, if any.
+    writer_thread_.reset();
   }
 
   Status WriteTensor(int64_t global_step, Tensor t, const string& tag,
@@ -155,7 +186,17 @@ class SummaryFileWriter : public SummaryWriterInterface {
     queue_.emplace_back(std::move(event));
     if (queue_.size() > max_queue_ ||
         env_->NowMicros() - last_flush_ > 1000 * flush_millis_) {
-      return InternalFlush();
+      if (writer_thread_ == nullptr) return InternalFlush();
+      if (pending_.size() + queue_.size() > async_queue_size_) {
+        // Drop the events rather than blocking the caller until the
+        // background thread catches up.
+        dropped_events->GetCell()->IncrementBy(queue_.size());
+        queue_.clear();
+        last_flush_ = env_->NowMicros();
+      } else {
+        ScheduleFlush();
+      }
+      return async_status_;
     }
     return absl::OkStatus();
   }
@@ -168,25 +209,82 @@ class SummaryFileWriter : public SummaryWriterInterface {
   }
 
   Status InternalFlush() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    for (const std::unique_ptr<Event>& e : queue_) {
+    Status status = WriteAndFlush(queue_);
+    queue_.clear();
+    last_flush_ = env_->NowMicros();
+    return status;
+  }
+
+  Status WriteAndFlush(const std::vector<std::unique_ptr<Event>>& events)
+      TF_LOCKS_EXCLUDED(writer_mu_) {
+    mutex_lock wl(writer_mu_);
+    for (const std::unique_ptr<Event>& e : events) {
       events_writer_->WriteEvent(*e);
     }
-    queue_.clear();
     TF_RETURN_WITH_CONTEXT_IF_ERROR(events_writer_->Flush(),
                                     "Could not flush events file.");
-    last_flush_ = env_->NowMicros();
     return absl::OkStatus();
   }
 
+  // Hands the queued events over to the background thread and returns the
+  // generation that is flushed once they are written.
+  int64_t ScheduleFlush() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    for (std::unique_ptr<Event>& e : queue_) {
+      pending_.push_back(std::move(e));
+    }
+    queue_.clear();
+    last_flush_ = env_->NowMicros();
+    pending_cv_.notify_one();
+    return ++scheduled_generation_;
+  }
+
+  // Writes the pending events on the background thread, so that the file
+  // system latency is not paid by the threads writing summaries.
+  void WriterLoop() {
+    while (true) {
+      int64_t generation;
+      std::vector<std::unique_ptr<Event>> events;
+      {
+        mutex_lock ml(mu_);
+        while (!shutdown_ && flushed_generation_ == scheduled_generation_) {
+          pending_cv_.wait(ml);
+        }
+        if (flushed_generation_ == scheduled_generation_) return;
+        generation = scheduled_generation_;
+        events.swap(pending_);
+      }
+      Status status = WriteAndFlush(events);
+      mutex_lock ml(mu_);
+      async_status_.Update(status);
+      flushed_generation_ = generation;
+      flushed_cv_.notify_all();
+    }
+  }
+
   bool is_initialized_;
   const int max_queue_;
   const int flush_millis_;
+  // If positive, the maximum number of events waiting for the background
+  // thread to write them. Otherwise, events are written on the calling thread.
+  const int async_queue_size_;
   uint64 last_flush_;
   Env* env_;
   mutex mu_;
   std::vector<std::unique_ptr<Event>> queue_ TF_GUARDED_BY(mu_);
+  // The events handed over to the background thread.
+  std::vector<std::unique_ptr<Event>> pending_ TF_GUARDED_BY(mu_);
+  int64_t scheduled_generation_ TF_GUARDED_BY(mu_) = 0;
+  int64_t flushed_generation_ TF_GUARDED_BY(mu_) = 0;
+  // The first error of the background thread.
+  Status async_status_ TF_GUARDED_BY(mu_);
+  bool shutdown_ TF_GUARDED_BY(mu_) = false;
+  condition_variable pending_cv_;
+  condition_variable flushed_cv_;
+  std::unique_ptr<Thread> writer_thread_;
+  // Serializes the writes of the calling and the background threads.
+  mutex writer_mu_;
   // A pointer to allow deferred construction.
-  std::unique_ptr<EventsWriter> events_writer_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<EventsWriter> events_writer_ TF_GUARDED_BY(writer_mu_);
   std::vector<std::pair<string, SummaryMetadata>> registered_summaries_
       TF_GUARDED_BY(mu_);
 };
@@ -197,7 +295,18 @@ Status CreateSummaryFileWriter(int max_queue, int flush_millis,
                                const string& logdir,
                                const string& filename_suffix, Env* env,
                                SummaryWriterInterface** result) {
-  SummaryFileWriter* w = new SummaryFileWriter(max_queue, flush_millis, env);
+  return CreateSummaryFileWriter(max_queue, flush_millis, logdir,
+                                 filename_suffix, /*async_queue_size=*/0, env,
+                                 result);
+}
+
+Status CreateSummaryFileWriter(int max_queue, int flush_millis,
+                               const string& logdir,
+                               const string& filename_suffix,
+                               int async_queue_size, Env* env,
+                               SummaryWriterInterface** result) {
+  SummaryFileWriter* w =
+      new SummaryFileWriter(max_queue, flush_millis, async_queue_size, env);
   const Status s = w->Initialize(logdir, filename_suffix);
   if (!s.ok()) {
     w->Unref();
@@ -38,6 +38,20 @@ Status CreateSummaryFileWriter(int max_queue, int flush_millis,
                                const string& filename_suffix, Env* env,
                                SummaryWriterInterface** result);
 
+/// \brief Same as above, but writes the summaries on a background thread if
+/// async_queue_size is positive.
+///
+/// Summaries are then handed over to the background thread instead of being
+/// written by the thread writing them, so that a slow file system does not
+/// stall it. At most async_queue_size summaries wait to be written, further
+/// ones are dropped and counted in /tensorflow/core/summary/dropped_events.
+/// Flush() still blocks until the summaries written so far are flushed.
+Status CreateSummaryFileWriter(int max_queue, int flush_millis,
+                               const string& logdir,
+                               const string& filename_suffix,
+                               int async_queue_size, Env* env,
+                               SummaryWriterInterface** result);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_SUMMARY_SUMMARY_FILE_WRITER_H_
@@ -259,6 +259,48 @@ TEST_F(SummaryFileWriterTest, WallTime) {
       [](const Event& e) { EXPECT_EQ(e.wall_time(), 7.023); }));
 }
 
+TEST_F(SummaryFileWriterTest, WriteOnBackgroundThread) {
+  // Keep unique with all other test names in this file.
+  const string test_name = "write_on_background_thread_test";
+  SummaryWriterInterface* writer;
+  TF_CHECK_OK(CreateSummaryFileWriter(/*max_queue=*/0, /*flush_millis=*/1,
+                                      testing::TmpDir(), test_name,
+                                      /*async_queue_size=*/100, &env_,
+                                      &writer));
+  for (int step = 0; step < 10; ++step) {
+    std::unique_ptr<Event> e{new Event};
+    e->set_step(step);
+    TF_CHECK_OK(writer->WriteEvent(std::move(e)));
+  }
+  // Flush() waits for the background thread to write the events.
+  TF_CHECK_OK(writer->Flush());
+
+  std::vector<string> files;
+  TF_CHECK_OK(env_.GetChildren(testing::TmpDir(), &files));
+  int num_files = 0;
+  for (const string& f : files) {
+    if (!absl::StrContains(f, test_name)) continue;
+    ++num_files;
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env_.NewRandomAccessFile(io::JoinPath(testing::TmpDir(), f),
+                                         &read_file));
+    io::RecordReader reader(read_file.get(), io::RecordReaderOptions());
+    tstring record;
+    uint64 offset = 0;
+    // The first event is the file version.
+    TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+    for (int step = 0; step < 10; ++step) {
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      Event e;
+      e.ParseFromString(record);
+      EXPECT_EQ(e.step(), step);
+    }
+    EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&offset, &record)));
+  }
+  EXPECT_EQ(num_files, 1);
+  writer->Unref();
+}
+
 TEST_F(SummaryFileWriterTest, AvoidFilenameCollision) {
   // Keep unique with all other test names in this file.
   string test_name = "avoid_filename_collision_test";
@@ -14,12 +14,18 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner.h"
 
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <string>
 #include <utility>
 
+#include "tensorflow/core/framework/device_factory.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace tfrt_stub {
@@ -81,8 +87,119 @@ tensorflow::Status CreateOpKernel(
   return absl::OkStatus();
 }
 
+bool ShareStatelessOpKernels() {
+  bool share = false;
+  Status s = tensorflow::ReadBoolFromEnvVar(
+      "TF_TFRT_SHARE_STATELESS_OP_KERNELS", /*default_val=*/false, &share);
+  if (!s.ok()) {
+    LOG_EVERY_N_SEC(WARNING, 30) << s;
+    return false;
+  }
+  return share;
+}
+
 }  // namespace
 
+StatelessOpKernelCache& StatelessOpKernelCache::Global() {
+  static auto* const cache = new StatelessOpKernelCache();
+  return *cache;
+}
+
+bool StatelessOpKernelCache::IsShareable(const tensorflow::OpDef& op_def,
+                                         const tensorflow::NodeDef& node_def,
+                                         const tensorflow::Device& device) {
+  if (op_def.is_stateful() ||
+      device.device_type() != tensorflow::DEVICE_CPU) {
+    return false;
+  }
+  // Kernels with function attributes instantiate their functions with the
+  // function library of the model.
+  for (const auto& [name, attr_value] : node_def.attr()) {
+    if (attr_value.has_func() || attr_value.list().func_size() > 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+absl::StatusOr<tensorflow::Device*> StatelessOpKernelCache::GetHostDevice() {
+  tensorflow::mutex_lock lock(mu_);
+  if (host_device_ == nullptr) {
+    host_device_ = tensorflow::DeviceFactory::NewDevice(
+        tensorflow::DEVICE_CPU, tensorflow::SessionOptions(),
+        "/job:localhost/replica:0/task:0");
+    if (host_device_ == nullptr) {
+      return tensorflow::errors::Internal(
+          "Failed to create the host device of the stateless kernel cache.");
+    }
+  }
+  return host_device_.get();
+}
+
+absl::StatusOr<std::shared_ptr<OpKernel>> StatelessOpKernelCache::GetOrCreate(
+    const tensorflow::NodeDef& node_def, absl::string_view device_name,
+    int graph_def_version) {
+  std::string serialized_node_def;
+  if (!tensorflow::SerializeToStringDeterministic(node_def,
+                                                  &serialized_node_def)) {
+    return tensorflow::errors::Internal("Failed to serialize NodeDef ",
+                                        node_def.name());
+  }
+  const tensorflow::Fprint128 fingerprint =
+      tensorflow::Fingerprint128(serialized_node_def);
+  Key key(fingerprint.low64, fingerprint.high64, std::string(device_name),
+          graph_def_version);
+
+  {
+    tensorflow::mutex_lock lock(mu_);
+    auto it = kernels_.find(key);
+    if (it != kernels_.end()) {
+      if (auto kernel = it->second.lock()) return kernel;
+    }
+  }
+
+  // The kernel is constructed without holding the lock, so that models loaded
+  // concurrently don't wait for each other's kernels.
+  TF_ASSIGN_OR_RETURN(tensorflow::Device * host_device, GetHostDevice());
+  Status status;
+  std::unique_ptr<OpKernel> kernel = tensorflow::CreateOpKernel(
+      tensorflow::DEVICE_CPU, host_device,
+      host_device->GetAllocator(tensorflow::AllocatorAttributes()), node_def,
+      graph_def_version, &status);
+  TF_RETURN_IF_ERROR(status);
+  // Asynchronous kernels usually keep the state of the computations in
+  // flight, so they are not shared.
+  if (kernel->AsAsync() != nullptr) {
+    return tensorflow::errors::FailedPrecondition(
+        "Asynchronous kernel of ", node_def.name(), " is not shared.");
+  }
+  std::shared_ptr<OpKernel> shared_kernel = std::move(kernel);
+
+  tensorflow::mutex_lock lock(mu_);
+  auto& entry = kernels_[key];
+  // Another runner might have created the same kernel in the meantime.
+  if (auto existing_kernel = entry.lock()) return existing_kernel;
+  entry = shared_kernel;
+  MaybeRemoveExpiredEntries();
+  return shared_kernel;
+}
+
+void StatelessOpKernelCache::MaybeRemoveExpiredEntries() {
+  if (kernels_.size() < next_sweep_size_) return;
+  absl::erase_if(kernels_,
+                 [](const auto& entry) { return entry.second.expired(); });
+  next_sweep_size_ = std::max<size_t>(64, 2 * kernels_.size());
+}
+
+size_t StatelessOpKernelCache::size() const {
+  tensorflow::mutex_lock lock(mu_);
+  size_t size = 0;
+  for (const auto& [key, kernel] : kernels_) {
+    if (!kernel.expired()) ++size;
+  }
+  return size;
+}
+
 absl::StatusOr<OpKernelRunner> OpKernelRunner::Create(
     absl::string_view op_name, absl::string_view node_name,
     absl::string_view device_name, int num_args,
@@ -130,16 +247,33 @@ absl::StatusOr<OpKernelRunner> OpKernelRunner::Create(
   function_library_runtime =
       process_function_library_runtime.GetFLR(device->name());
 
-  std::unique_ptr<OpKernel> op_kernel;
-  TF_RETURN_IF_ERROR(CreateOpKernel(function_library_runtime,
-                                    std::move(node_def), &op_kernel));
+  std::shared_ptr<OpKernel> op_kernel;
+  if (ShareStatelessOpKernels() &&
+      StatelessOpKernelCache::IsShareable(*op_def, node_def, *device)) {
+    auto shared_kernel = StatelessOpKernelCache::Global().GetOrCreate(
+        node_def, device->name(),
+        function_library_runtime->graph_def_version());
+    if (shared_kernel.ok()) {
+      op_kernel = *std::move(shared_kernel);
+    } else {
+      VLOG(1) << "Creating a non-shared kernel for " << node_def.name()
+              << ": " << shared_kernel.status();
+    }
+  }
+
+  if (op_kernel == nullptr) {
+    std::unique_ptr<OpKernel> unique_op_kernel;
+    TF_RETURN_IF_ERROR(CreateOpKernel(function_library_runtime,
+                                      std::move(node_def), &unique_op_kernel));
+    op_kernel = std::move(unique_op_kernel);
+  }
   return OpKernelRunner(device, function_library_runtime, std::move(op_kernel));
 }
 
 OpKernelRunner::OpKernelRunner(
     tensorflow::Device* device,
     tensorflow::FunctionLibraryRuntime* function_library_runtime,
-    std::unique_ptr<tensorflow::OpKernel> op_kernel)
+    std::shared_ptr<tensorflow::OpKernel> op_kernel)
     : op_kernel_(std::move(op_kernel)), info_(std::make_unique<Info>()) {
   DCHECK(device);
   DCHECK(function_library_runtime);
@@ -18,12 +18,15 @@ limitations under the License.
 #include <assert.h>
 #include <stddef.h>
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/inlined_vector.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
@@ -34,7 +37,9 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
 namespace tfrt_stub {
@@ -119,9 +124,11 @@ class OpKernelRunner {
   explicit OpKernelRunner(
       tensorflow::Device* device,
       tensorflow::FunctionLibraryRuntime* function_library_runtime,
-      std::unique_ptr<OpKernel> op_kernel);
+      std::shared_ptr<OpKernel> op_kernel);
 
-  std::unique_ptr<OpKernel> op_kernel_;
+  // Shared with other runners if the kernel comes from the
+  // StatelessOpKernelCache.
+  std::shared_ptr<OpKernel> op_kernel_;
   absl::Span<const AllocatorAttributes> input_alloc_attrs_;
   absl::Span<const AllocatorAttributes> output_alloc_attrs_;
 
@@ -136,6 +143,62 @@ class OpKernelRunner {
   std::unique_ptr<Info> info_;
 };
 
+// Process-wide cache of the kernels of stateless ops placed on CPU devices,
+// shared by the OpKernelRunners of all the models loaded in the process, so
+// that loading a new version or a variant of a model reuses the kernels
+// already constructed for the models in use instead of creating them again.
+//
+// Kernels are keyed by the fingerprint of their NodeDef, the name of their
+// device and the graph def version, and are refcounted: a kernel is destroyed
+// once no runner uses it anymore. As a shared kernel can outlive the model
+// that created it, it is constructed on a CPU device owned by the cache and
+// without a function library; the runners still run it on their own device.
+//
+// OpKernelRunner::Create() uses the cache if the environment variable
+// TF_TFRT_SHARE_STATELESS_OP_KERNELS is set to true.
+//
+// StatelessOpKernelCache is thread-safe.
+class StatelessOpKernelCache {
+ public:
+  static StatelessOpKernelCache& Global();
+
+  // Returns true if the kernel of `node_def` placed on `device` can be shared,
+  // i.e. its op is stateless, it has no function attributes and `device` is a
+  // CPU device.
+  static bool IsShareable(const tensorflow::OpDef& op_def,
+                          const tensorflow::NodeDef& node_def,
+                          const tensorflow::Device& device);
+
+  // Returns the shared kernel of `node_def` placed on the device named
+  // `device_name`, creating it if no runner uses one. Returns an error if the
+  // kernel can't be created or is asynchronous, in which case the caller is
+  // expected to create its own kernel.
+  absl::StatusOr<std::shared_ptr<OpKernel>> GetOrCreate(
+      const tensorflow::NodeDef& node_def, absl::string_view device_name,
+      int graph_def_version);
+
+  // Returns the number of kernels currently in use.
+  size_t size() const;
+
+ private:
+  // The low and high 64 bits of the NodeDef fingerprint, the device name and
+  // the graph def version.
+  using Key = std::tuple<uint64_t, uint64_t, std::string, int>;
+
+  absl::StatusOr<tensorflow::Device*> GetHostDevice();
+
+  // Removes the entries of kernels that are no longer used. This is amortized
+  // over the insertions, as runners don't notify the cache when they release
+  // a kernel.
+  void MaybeRemoveExpiredEntries() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  mutable tensorflow::mutex mu_;
+  std::unique_ptr<tensorflow::Device> host_device_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<Key, std::weak_ptr<OpKernel>> kernels_
+      TF_GUARDED_BY(mu_);
+  size_t next_sweep_size_ TF_GUARDED_BY(mu_) = 64;
+};
+
 // OpKernelRunState keeps the states needed for per-kernel execution.
 struct OpKernelRunState {
   std::vector<const tensorflow::TensorBuffer*> tensor_buffers;
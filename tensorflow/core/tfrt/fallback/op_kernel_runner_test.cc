@@ -14,10 +14,15 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner.h"
 
+#include <stdlib.h>
+
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/device_factory.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -25,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/tfrt/fallback/fallback_state.h"
@@ -60,6 +66,13 @@ REGISTER_KERNEL_BUILDER(Name("TestOp").Device(DEVICE_CPU), TestOpKernel);
 // not have `f` attribute. Users will not invoke this op directly.
 REGISTER_OP("TestOp").Input("x: int32").Output("y: int32");
 
+REGISTER_KERNEL_BUILDER(Name("TestStatefulOp").Device(DEVICE_CPU),
+                        TestOpKernel);
+REGISTER_OP("TestStatefulOp")
+    .Input("x: int32")
+    .Output("y: int32")
+    .SetIsStateful();
+
 TEST(OpKernelRunnerTest, Create) {
   tensorflow::SessionOptions session_options;
   tensorflow::FunctionDefLibrary fdef_lib;
@@ -126,6 +139,54 @@ TEST(OpKernelRunnerTest, OpKernelRunnerCache) {
   EXPECT_EQ(runner->op_kernel()->name(), "TestOp_100_0");
 }
 
+absl::StatusOr<OpKernelRunner> CreateRunner(
+    const FallbackState& fallback_state, absl::string_view op_name) {
+  return OpKernelRunner::Create(
+      op_name, /*node_name=*/absl::StrCat(op_name, "_node_name"),
+      /*device_name=*/"/job:localhost/replica:0/task:0/device:CPU:0",
+      /*num_args=*/1,
+      /*attr_builder=*/
+      [](tensorflow::AttrValueMap*) { return absl::OkStatus(); },
+      fallback_state.device_manager(),
+      fallback_state.process_function_library_runtime());
+}
+
+TEST(OpKernelRunnerTest, ShareStatelessOpKernelsAcrossModels) {
+  setenv("TF_TFRT_SHARE_STATELESS_OP_KERNELS", "true", /*overwrite=*/1);
+  auto cleanup = gtl::MakeCleanup(
+      [] { unsetenv("TF_TFRT_SHARE_STATELESS_OP_KERNELS"); });
+
+  tensorflow::SessionOptions session_options;
+  tensorflow::FunctionDefLibrary fdef_lib;
+  TF_ASSERT_OK_AND_ASSIGN(auto fallback_state_1,
+                          FallbackState::Create(session_options, fdef_lib));
+  TF_ASSERT_OK_AND_ASSIGN(auto fallback_state_2,
+                          FallbackState::Create(session_options, fdef_lib));
+  const size_t initial_size = StatelessOpKernelCache::Global().size();
+
+  {
+    TF_ASSERT_OK_AND_ASSIGN(auto runner_1,
+                            CreateRunner(*fallback_state_1, "TestOp"));
+    TF_ASSERT_OK_AND_ASSIGN(auto runner_2,
+                            CreateRunner(*fallback_state_2, "TestOp"));
+
+    // The runners share the kernel but run it on the device of their model.
+    EXPECT_EQ(runner_1.op_kernel(), runner_2.op_kernel());
+    EXPECT_NE(runner_1.device(), runner_2.device());
+    EXPECT_EQ(StatelessOpKernelCache::Global().size(), initial_size + 1);
+
+    TF_ASSERT_OK_AND_ASSIGN(auto stateful_runner_1,
+                            CreateRunner(*fallback_state_1, "TestStatefulOp"));
+    TF_ASSERT_OK_AND_ASSIGN(auto stateful_runner_2,
+                            CreateRunner(*fallback_state_2, "TestStatefulOp"));
+    EXPECT_NE(stateful_runner_1.op_kernel(), stateful_runner_2.op_kernel());
+    EXPECT_EQ(StatelessOpKernelCache::Global().size(), initial_size + 1);
+  }
+
+  // The kernel is released with the last runner using it.
+  EXPECT_EQ(StatelessOpKernelCache::Global().size(), initial_size);
+}
+
 TEST(OpKernelRunnerTest, OpKernelRunState) {
   SessionOptions options;
   auto* device_count = options.config.mutable_device_count();
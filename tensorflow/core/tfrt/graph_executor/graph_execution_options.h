@@ -83,7 +83,9 @@ struct GraphExecutionOptions {
   struct CostAnalysisOptions {
     enum CostAnalysisVersion {
       kDisabled,
-      kOnce,  // Cost recording and recompilation occurs on the first run only.
+      // Costs are recorded on the first `num_requests_to_record` runs only,
+      // and the executable is recompiled right after.
+      kOnce,
       kPeriodic,  // This is experimental.
     };
     CostAnalysisVersion version = kDisabled;
@@ -96,6 +98,12 @@ struct GraphExecutionOptions {
     // Number of times to record costs before resetting Op cost estimates.
     // However, a reset always occurs after the first execution.
     int updates_per_interval = 1;
+
+    // Number of runs whose costs are recorded before recompiling with kOnce.
+    // Averaging the costs over several runs keeps the one-off costs of the
+    // first run (e.g. lazy initialization of kernels) from skewing the
+    // assignment of ops to streams.
+    int num_requests_to_record = 1;
   };
 
   CostAnalysisOptions cost_analysis_options;
@@ -104,6 +112,10 @@ struct GraphExecutionOptions {
   // This option is experimental.
   bool enable_mlrt = false;
 
+  // If true, the MLRT executions of the requests reuse the register buffers of
+  // the previous requests instead of allocating them for each function call.
+  bool enable_mlrt_register_pool = false;
+
   // If true, the IFRT will be used instead of the TPU Runner.
   // This option is experimental.
   bool use_ifrt = false;
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <array>
+#include <chrono>  // NOLINT(build/c++11)
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -62,6 +63,7 @@ limitations under the License.
 #include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/monitoring/gauge.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -139,6 +141,48 @@ auto* graph_executor_mode = monitoring::Gauge<std::string, 2>::New(
     "executor modes (BEF vs MLRT interpreter)",
     "model_name", "model_version");
 
+auto* expired_request_count = monitoring::Counter<2>::New(
+    "/tfrt/graph_executor/expired_request_count",
+    "The number of requests that are still running when their deadline "
+    "passes.",
+    "model_name", "model_version");
+
+auto* expired_request_time = monitoring::Counter<2>::New(
+    "/tfrt/graph_executor/expired_request_time",
+    "The total time in microseconds that requests keep running after their "
+    "deadline, i.e. the work wasted on results that are dropped.",
+    "model_name", "model_version");
+
+// Lends `mlrt::RegisterPool`s to the requests, so that the register buffers of
+// a request are reused by the following ones.
+class RegisterPoolCache {
+ public:
+  static RegisterPoolCache& Global() {
+    static auto* const cache = new RegisterPoolCache();
+    return *cache;
+  }
+
+  std::unique_ptr<mlrt::RegisterPool> Take() {
+    tensorflow::mutex_lock lock(mu_);
+    if (pools_.empty()) return std::make_unique<mlrt::RegisterPool>();
+    auto pool = std::move(pools_.back());
+    pools_.pop_back();
+    return pool;
+  }
+
+  void Give(std::unique_ptr<mlrt::RegisterPool> pool) {
+    tensorflow::mutex_lock lock(mu_);
+    if (pools_.size() < kMaxPools) pools_.push_back(std::move(pool));
+  }
+
+ private:
+  // Bounds the memory kept after a burst of concurrent requests.
+  static constexpr size_t kMaxPools = 256;
+
+  tensorflow::mutex mu_;
+  std::vector<std::unique_ptr<mlrt::RegisterPool>> pools_ TF_GUARDED_BY(mu_);
+};
+
 }  // namespace
 
 tensorflow::Status RunMlrtFunction(
@@ -148,7 +192,8 @@ tensorflow::Status RunMlrtFunction(
     tfrt::ConcurrentWorkQueue& work_queue,
     absl::Span<const tensorflow::Tensor> inputs,
     std::vector<tensorflow::Tensor>* outputs,
-    SyncResourceState* sync_resource_state) {
+    SyncResourceState* sync_resource_state,
+    mlrt::RegisterPool* register_pool) {
   DCHECK(function);
   const auto* fallback_request_state =
       request_context->GetDataIfExists<tfd::KernelFallbackCompatRequestState>();
@@ -156,6 +201,7 @@ tensorflow::Status RunMlrtFunction(
 
   mlrt::ExecutionContext execution_context(&loaded_executable);
   execution_context.set_work_queue(&work_queue);
+  execution_context.set_register_pool(register_pool);
 
   // Set up tfrt::SyncContext which is used for vrooml only.
   //
@@ -355,6 +401,23 @@ tensorflow::Status GraphExecutionRunOnFunction(
         deadline, request_info->tfrt_request_context);
   }
 
+  // Requests that are still running past their deadline are cancelled, and
+  // everything they do after it is wasted. Record it, as it is a sign that the
+  // model is overloaded.
+  auto record_expired_request = tensorflow::gtl::MakeCleanup([&]() {
+    if (!run_options.deadline.has_value()) return;
+    auto now = absl::ToChronoTime(absl::Now());
+    if (now <= *run_options.deadline) return;
+    auto model_version = absl::StrCat(options.model_metadata.version());
+    expired_request_count
+        ->GetCell(options.model_metadata.name(), model_version)
+        ->IncrementBy(1);
+    expired_request_time->GetCell(options.model_metadata.name(), model_version)
+        ->IncrementBy(std::chrono::duration_cast<std::chrono::microseconds>(
+                          now - *run_options.deadline)
+                          .count());
+  });
+
   ScopedStreamCallback scoped_stream_callback;
 
   if (run_options.streamed_output_callback && !stream_callback_id.has_value()) {
@@ -393,10 +456,18 @@ tensorflow::Status GraphExecutionRunOnFunction(
           "Function not found in MLRT executable: ", signature_name));
     }
 
-    return RunMlrtFunction(function, *loaded_executable,
-                           request_info->tfrt_request_context,
-                           *request_info->request_queue, inputs, outputs,
-                           /*sync_resource_state=*/nullptr);
+    std::unique_ptr<mlrt::RegisterPool> register_pool;
+    if (options.enable_mlrt_register_pool) {
+      register_pool = RegisterPoolCache::Global().Take();
+    }
+    auto status = RunMlrtFunction(
+        function, *loaded_executable, request_info->tfrt_request_context,
+        *request_info->request_queue, inputs, outputs,
+        /*sync_resource_state=*/nullptr, register_pool.get());
+    if (register_pool != nullptr) {
+      RegisterPoolCache::Global().Give(std::move(register_pool));
+    }
+    return status;
   }
 
   DCHECK(func);
@@ -1042,6 +1113,12 @@ CostRecorder* GraphExecutor::LoadedClientGraph::MaybeGetCostRecorder(
     return nullptr;
   }
   const auto& options = graph_executor_->options().cost_analysis_options;
+  if (options.version == Options::CostAnalysisOptions::kOnce) {
+    cost_analysis_data_.is_available = false;
+    *do_recompilation = 1 + cost_analysis_data_.num_cost_updates >=
+                        options.num_requests_to_record;
+    return cost_analysis_data_.cost_recorder.get();
+  }
   absl::Duration elapsed_duration = now - cost_analysis_data_.start_time;
   double intended_num_updates = absl::ToDoubleSeconds(elapsed_duration) /
                                 absl::ToDoubleSeconds(options.reset_interval) *
@@ -1148,7 +1225,10 @@ GraphExecutor::LoadedClientGraph::LoadedClientGraph(
     // Initialize in a way that ensures recompilation on the first run.
     cost_analysis_data_.start_time = absl::Now() - options.reset_interval;
     cost_analysis_data_.is_available = true;
-    cost_analysis_data_.num_cost_updates = options.updates_per_interval - 1;
+    cost_analysis_data_.num_cost_updates =
+        options.version == Options::CostAnalysisOptions::kOnce
+            ? 0
+            : options.updates_per_interval - 1;
     cost_analysis_data_.cost_recorder = std::make_unique<CostRecorder>();
     if (executable_context_->IsForMlrt()) {
       cost_analysis_data_.tf_mlir_with_op_keys =
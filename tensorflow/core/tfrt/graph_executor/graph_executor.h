@@ -132,7 +132,8 @@ tensorflow::Status GraphExecutionRunOnFunction(
     std::optional<StreamCallbackId> stream_callback_id,
     CostRecorder* cost_recorder = nullptr);
 
-// Runs a MLRT function for executing tensorflow graphs.
+// Runs a MLRT function for executing tensorflow graphs. If `register_pool` is
+// not null, the registers of the function calls are taken from it.
 tensorflow::Status RunMlrtFunction(
     mlrt::bc::Function function,
     const mlrt::LoadedExecutable& loaded_executable,
@@ -140,7 +141,8 @@ tensorflow::Status RunMlrtFunction(
     tfrt::ConcurrentWorkQueue& work_queue,
     absl::Span<const tensorflow::Tensor> inputs,
     std::vector<tensorflow::Tensor>* outputs,
-    SyncResourceState* sync_resource_state);
+    SyncResourceState* sync_resource_state,
+    mlrt::RegisterPool* register_pool = nullptr);
 
 // Loads (if not yet) and runs a subgraph in a graph as per each request.
 class GraphExecutor {
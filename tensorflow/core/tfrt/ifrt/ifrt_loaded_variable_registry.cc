@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/tfrt/ifrt/ifrt_loaded_variable_registry.h"
 
+#include <cstdint>
 #include <utility>
 
 #include "absl/container/flat_hash_map.h"
@@ -32,13 +33,18 @@ namespace ifrt_serving {
 absl::Status IfrtLoadedVariableRegistry::TryRegisterLoadedVariable(
     const Key& key, LoadedVariableConstructor&& loaded_variable_constructor) {
   absl::MutexLock lock(&mutex_);
-  auto& variable = loaded_variable_map_[key];
-  if (variable.array.IsValid()) {
+  auto it = loaded_variable_map_.find(key);
+  if (it != loaded_variable_map_.end()) {
     // Already registered. This is rare.
     VLOG(1) << "Variable '" << key.input_name << "' already registered.";
+    it->second.last_use = ++use_count_;
     return absl::OkStatus();
   }
-  TF_ASSIGN_OR_RETURN(variable, loaded_variable_constructor());
+  TF_ASSIGN_OR_RETURN(LoadedVariable variable, loaded_variable_constructor());
+  loaded_bytes_ += variable.size_bytes;
+  loaded_variable_map_[key] = {.variable = std::move(variable),
+                               .last_use = ++use_count_};
+  MaybeEvict(key);
   return absl::OkStatus();
 }
 
@@ -50,7 +56,39 @@ IfrtLoadedVariableRegistry::GetLoadedVariable(const Key& key) const {
     return absl::NotFoundError(
         absl::StrCat("Variable '", key.input_name, "' not found."));
   }
-  return it->second;
+  it->second.last_use = ++use_count_;
+  return it->second.variable;
+}
+
+void IfrtLoadedVariableRegistry::SetMaxLoadedBytes(int64_t max_loaded_bytes) {
+  absl::MutexLock lock(&mutex_);
+  max_loaded_bytes_ = max_loaded_bytes;
+}
+
+int64_t IfrtLoadedVariableRegistry::loaded_bytes() const {
+  absl::MutexLock lock(&mutex_);
+  return loaded_bytes_;
+}
+
+void IfrtLoadedVariableRegistry::MaybeEvict(const Key& key_to_keep) {
+  if (max_loaded_bytes_ <= 0) return;
+  // Eviction only happens when a variable is loaded, which is rare compared to
+  // lookups, so a linear scan for the least recently used entry is fine.
+  while (loaded_bytes_ > max_loaded_bytes_ && loaded_variable_map_.size() > 1) {
+    auto lru = loaded_variable_map_.end();
+    for (auto it = loaded_variable_map_.begin();
+         it != loaded_variable_map_.end(); ++it) {
+      if (it->first == key_to_keep) continue;
+      if (lru == loaded_variable_map_.end() ||
+          it->second.last_use < lru->second.last_use) {
+        lru = it;
+      }
+    }
+    VLOG(1) << "Evicting variable '" << lru->first.input_name << "' of "
+            << lru->second.variable.size_bytes << " bytes.";
+    loaded_bytes_ -= lru->second.variable.size_bytes;
+    loaded_variable_map_.erase(lru);
+  }
 }
 
 }  // namespace ifrt_serving
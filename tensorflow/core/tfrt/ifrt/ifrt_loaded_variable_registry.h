@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_IFRT_IFRT_LOADED_VARIABLE_REGISTRY_H_
 #define TENSORFLOW_CORE_TFRT_IFRT_IFRT_LOADED_VARIABLE_REGISTRY_H_
 
+#include <cstdint>
 #include <string>
 
 #include "absl/container/flat_hash_map.h"
@@ -55,6 +56,9 @@ class IfrtLoadedVariableRegistry {
 
   struct LoadedVariable {
     xla::ifrt::Future<tsl::RCReference<xla::ifrt::Array>> array;
+    // Size of the variable on the devices, used to enforce the limit set by
+    // `SetMaxLoadedBytes()`.
+    int64_t size_bytes = 0;
   };
   using LoadedVariableConstructor =
       absl::AnyInvocable<absl::StatusOr<LoadedVariable>() const>;
@@ -68,13 +72,35 @@ class IfrtLoadedVariableRegistry {
       const Key& key, LoadedVariableConstructor&& loaded_variable_constructor)
       ABSL_LOCKS_EXCLUDED(mutex_);
 
+  // Returns NotFound if the variable was never registered or was evicted, in
+  // which case the caller needs to register it again.
   absl::StatusOr<LoadedVariable> GetLoadedVariable(const Key& key) const
       ABSL_LOCKS_EXCLUDED(mutex_);
 
+  // Limits the total `size_bytes` of the registered variables. When a variable
+  // is registered over the limit, the least recently used variables are
+  // evicted until the total fits again (or only the new variable is left).
+  // Evicting a variable only drops the reference of the registry, so the
+  // executions that already got it are not affected. 0 means no limit, which
+  // is the default.
+  void SetMaxLoadedBytes(int64_t max_loaded_bytes) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  int64_t loaded_bytes() const ABSL_LOCKS_EXCLUDED(mutex_);
+
  private:
+  struct Entry {
+    LoadedVariable variable;
+    // Value of `use_count_` at the last registration or lookup.
+    mutable int64_t last_use = 0;
+  };
+
+  void MaybeEvict(const Key& key_to_keep) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   mutable absl::Mutex mutex_;
-  absl::flat_hash_map<Key, LoadedVariable> loaded_variable_map_
-      ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<Key, Entry> loaded_variable_map_ ABSL_GUARDED_BY(mutex_);
+  mutable int64_t use_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t loaded_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t max_loaded_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
 };
 
 }  // namespace ifrt_serving
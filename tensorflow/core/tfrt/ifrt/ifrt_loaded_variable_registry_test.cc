@@ -0,0 +1,98 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/tfrt/ifrt/ifrt_loaded_variable_registry.h"
+
+#include <cstdint>
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xla/python/ifrt/array.h"
+#include "xla/python/ifrt/future.h"
+#include "xla/tsl/concurrency/ref_count.h"
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/platform/status_matchers.h"
+
+namespace tensorflow {
+namespace ifrt_serving {
+namespace {
+
+using tsl::testing::IsOk;
+using tsl::testing::StatusIs;
+
+IfrtLoadedVariableRegistry::Key MakeKey(const std::string& name) {
+  return {.device_ids = {0}, .input_name = name};
+}
+
+absl::Status Register(IfrtLoadedVariableRegistry& registry,
+                      const std::string& name, int64_t size_bytes) {
+  return registry.TryRegisterLoadedVariable(
+      MakeKey(name),
+      [&]() -> absl::StatusOr<IfrtLoadedVariableRegistry::LoadedVariable> {
+        // The registry never awaits the array, so a ready error is enough.
+        return IfrtLoadedVariableRegistry::LoadedVariable{
+            .array = xla::ifrt::Future<tsl::RCReference<xla::ifrt::Array>>(
+                absl::UnimplementedError("Not loaded in test")),
+            .size_bytes = size_bytes};
+      });
+}
+
+TEST(IfrtLoadedVariableRegistryTest, NoEvictionWithoutLimit) {
+  IfrtLoadedVariableRegistry registry;
+  TF_ASSERT_OK(Register(registry, "a", 100));
+  TF_ASSERT_OK(Register(registry, "b", 100));
+  EXPECT_EQ(registry.loaded_bytes(), 200);
+  EXPECT_THAT(registry.GetLoadedVariable(MakeKey("a")), IsOk());
+  EXPECT_THAT(registry.GetLoadedVariable(MakeKey("b")), IsOk());
+}
+
+TEST(IfrtLoadedVariableRegistryTest, EvictsLeastRecentlyUsedVariables) {
+  IfrtLoadedVariableRegistry registry;
+  registry.SetMaxLoadedBytes(250);
+  TF_ASSERT_OK(Register(registry, "a", 100));
+  TF_ASSERT_OK(Register(registry, "b", 100));
+  // Makes "b" the least recently used variable.
+  TF_ASSERT_OK(registry.GetLoadedVariable(MakeKey("a")).status());
+  TF_ASSERT_OK(Register(registry, "c", 100));
+
+  EXPECT_EQ(registry.loaded_bytes(), 200);
+  EXPECT_THAT(registry.GetLoadedVariable(MakeKey("a")), IsOk());
+  EXPECT_THAT(registry.GetLoadedVariable(MakeKey("b")),
+              StatusIs(absl::StatusCode::kNotFound));
+  EXPECT_THAT(registry.GetLoadedVariable(MakeKey("c")), IsOk());
+
+  // An evicted variable can be registered again.
+  TF_ASSERT_OK(Register(registry, "b", 100));
+  EXPECT_THAT(registry.GetLoadedVariable(MakeKey("b")), IsOk());
+  EXPECT_EQ(registry.loaded_bytes(), 200);
+}
+
+TEST(IfrtLoadedVariableRegistryTest, KeepsVariableLargerThanLimit) {
+  IfrtLoadedVariableRegistry registry;
+  registry.SetMaxLoadedBytes(50);
+  TF_ASSERT_OK(Register(registry, "a", 100));
+  TF_ASSERT_OK(Register(registry, "b", 100));
+
+  EXPECT_EQ(registry.loaded_bytes(), 100);
+  EXPECT_THAT(registry.GetLoadedVariable(MakeKey("a")),
+              StatusIs(absl::StatusCode::kNotFound));
+  EXPECT_THAT(registry.GetLoadedVariable(MakeKey("b")), IsOk());
+}
+
+}  // namespace
+}  // namespace ifrt_serving
+}  // namespace tensorflow
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/tfrt/ifrt/ifrt_loaded_variable_utils.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
@@ -36,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/framework/resource_handle.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_loaded_variable_registry.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_restore_tensor_registry.h"
 #include "tensorflow/core/tfrt/ifrt/sharding_utils.h"
@@ -121,14 +123,19 @@ absl::Status AsyncLoadRestoredTensorAsIfrtLoadedVariable(
       xla::ifrt::Future<tsl::RCReference<xla::ifrt::Array>>(
           loaded_variable_promise);
   TF_ASSIGN_OR_RETURN(
-      absl::StatusOr<ifrt_serving::DtypeAndShape> dtype_and_shape,
+      ifrt_serving::DtypeAndShape dtype_and_shape,
       ifrt_restore_tensor_registry.GetDtypeAndShape(runtime_name));
+  // Counts a full copy per device, which is exact for replicated variables and
+  // overestimates sharded ones.
+  const int64_t size_bytes = dtype_and_shape.shape.num_elements() *
+                             DataTypeSize(dtype_and_shape.dtype) *
+                             sharding_config.device_ids_size();
   TF_RETURN_IF_ERROR(ifrt_loaded_variable_registry.TryRegisterLoadedVariable(
       loaded_variable_key,
       [&]() -> absl::StatusOr<
                 ifrt_serving::IfrtLoadedVariableRegistry::LoadedVariable> {
         return ifrt_serving::IfrtLoadedVariableRegistry::LoadedVariable(
-            {.array = loaded_variable_future});
+            {.array = loaded_variable_future, .size_bytes = size_bytes});
       }));
   restored_tensor_future.OnReady(
       [ifrt_client = std::move(ifrt_client), &thread_pool = thread_pool,
@@ -33,7 +33,10 @@ const tsl::thread::ThreadPool& IfrtModelContext::GetThreadPool() const {
 }
 
 absl::Status IfrtModelContext::Freeze() {
-  restore_tensor_registry_.Freeze();
+  // Evicted variables are loaded again from their host tensors.
+  if (max_loaded_variable_bytes_ <= 0) {
+    restore_tensor_registry_.Freeze();
+  }
   for (auto& program_handle : handles_) {
     TF_RETURN_IF_ERROR(program_handle.Freeze());
   }
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_IFRT_IFRT_MODEL_CONTEXT_H_
 #define TENSORFLOW_CORE_TFRT_IFRT_IFRT_MODEL_CONTEXT_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
@@ -31,6 +32,7 @@ limitations under the License.
 #include "xla/python/ifrt/client.h"
 #include "xla/tsl/concurrency/ref_count.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/tfrt/ifrt/ifrt_config.pb.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_executable_registry.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_loaded_variable_registry.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_restore_tensor_registry.h"
@@ -112,6 +114,24 @@ class IfrtModelContext {
     checkpoint_loader_queue_ = work_queue;
   }
 
+  // The batching configuration of the IFRT programs of the model. It must be
+  // set before the programs are compiled.
+  const IfrtServingBatchingConfigProto& batching_config() const {
+    return batching_config_;
+  }
+  void set_batching_config(IfrtServingBatchingConfigProto batching_config) {
+    batching_config_ = std::move(batching_config);
+  }
+
+  // Limits the device memory used by the loaded variables of the model; the
+  // least recently used ones are evicted and loaded again on their next use.
+  // The host tensors of the variables are then kept by `Freeze()` for the
+  // reloads. 0 means no limit, which is the default.
+  void set_max_loaded_variable_bytes(int64_t max_loaded_variable_bytes) {
+    max_loaded_variable_bytes_ = max_loaded_variable_bytes;
+    loaded_variable_registry_.SetMaxLoadedBytes(max_loaded_variable_bytes);
+  }
+
   // Freeze the model: release the resources such as host tensors that are used
   // by the device only. The caller guarantees all resources released in this
   // function is no longer in use in regular execution path.
@@ -132,6 +152,10 @@ class IfrtModelContext {
   // Dedicated work queue for heavy task such as variable tensor restoration.
   tfrt::ConcurrentWorkQueue* checkpoint_loader_queue_ = nullptr;
 
+  IfrtServingBatchingConfigProto batching_config_;
+
+  int64_t max_loaded_variable_bytes_ = 0;
+
   std::vector<ServingExecutableRegistry::Handle> handles_;
 
   IfrtLoadedVariableRegistry loaded_variable_registry_;
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/tfrt/ifrt/ifrt_serving_executable.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -33,6 +34,7 @@ limitations under the License.
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "mlir/IR/BuiltinOps.h"  // from @llvm-project
 #include "mlir/IR/OwningOpRef.h"  // from @llvm-project
@@ -66,6 +68,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/protobuf/tpu/compile_metadata.pb.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_config.pb.h"
@@ -154,6 +157,38 @@ absl::StatusOr<std::vector<xla::ifrt::Device*>> GetAssignedDevices(
   return devices;
 }
 
+// Returns true and sets `batch_key` and `batch_size` if `inputs` can be batched
+// along their first dimension, i.e. if all the non-variable inputs have the
+// same non-zero size of their first dimension.
+bool GetBatchKey(absl::Span<const tensorflow::Tensor> inputs,
+                 absl::Span<const int> variable_arg_indices,
+                 std::string& batch_key, int64_t& batch_size) {
+  batch_size = 0;
+  int variable_index = 0;
+  for (int i = 0; i < inputs.size(); i++) {
+    if (variable_index < variable_arg_indices.size() &&
+        i == variable_arg_indices[variable_index]) {
+      const tsl::tstring& name = inputs[i].scalar<tsl::tstring>()();
+      absl::StrAppend(&batch_key, "v", i, ":", name.size(), ":", name, ";");
+      variable_index++;
+      continue;
+    }
+    const tensorflow::Tensor& input = inputs[i];
+    if (input.dims() == 0) return false;
+    if (batch_size == 0) {
+      batch_size = input.dim_size(0);
+    } else if (input.dim_size(0) != batch_size) {
+      return false;
+    }
+    absl::StrAppend(&batch_key, "t", i, ":", input.dtype());
+    for (int d = 1; d < input.dims(); ++d) {
+      absl::StrAppend(&batch_key, ",", input.dim_size(d));
+    }
+    absl::StrAppend(&batch_key, ";");
+  }
+  return batch_size > 0;
+}
+
 }  // namespace
 
 absl::StatusOr<std::unique_ptr<IfrtServingExecutable>>
@@ -167,7 +202,8 @@ IfrtServingExecutable::Create(
     tfrt::ConcurrentWorkQueue* checkpoint_loader_queue,
     tensorflow::DeviceMgr* device_mgr,
     tensorflow::XlaHelpers::ShapeRepresentationFn shape_representation_fn,
-    IfrtServingCoreSelector* ifrt_serving_core_selector) {
+    IfrtServingCoreSelector* ifrt_serving_core_selector,
+    const IfrtServingBatchingConfigProto& batching_config) {
   TF_ASSIGN_OR_RETURN(
       tensorflow::tpu::TPUCompileMetadataProto original_compile_metadata,
       GetCompileMetadata(*module, *client));
@@ -177,7 +213,7 @@ IfrtServingExecutable::Create(
       std::move(client), thread_pool, ifrt_loaded_variable_registry,
       ifrt_restore, checkpoint_loader_queue, device_mgr,
       std::move(shape_representation_fn), ifrt_serving_core_selector,
-      std::move(original_compile_metadata)));
+      batching_config, std::move(original_compile_metadata)));
 }
 
 absl::StatusOr<tsl::RCReference<xla::ifrt::Array>>
@@ -495,6 +531,168 @@ absl::StatusOr<std::vector<tensorflow::Tensor>> IfrtServingExecutable::Execute(
     }
   }
 
+  std::string batch_key;
+  int64_t batch_size;
+  if (batching_config_.max_batch_size() > 0 &&
+      GetBatchKey(inputs, variable_arg_indices, batch_key, batch_size) &&
+      batch_size <= batching_config_.max_batch_size()) {
+    return ExecuteBatched(inputs, variable_arg_indices, batch_key, batch_size);
+  }
+  return ExecuteUnbatched(inputs, variable_arg_indices);
+}
+
+absl::StatusOr<std::vector<tensorflow::Tensor>>
+IfrtServingExecutable::ExecuteBatched(
+    absl::Span<const tensorflow::Tensor> inputs,
+    absl::Span<const int> variable_arg_indices, const std::string& batch_key,
+    int64_t batch_size) {
+  BatchTask task;
+  task.inputs = inputs;
+  task.batch_size = batch_size;
+
+  std::shared_ptr<Batch> batch;
+  bool is_first_task = false;
+  {
+    absl::MutexLock lock(&batch_mutex_);
+    std::shared_ptr<Batch>& open_batch = open_batches_[batch_key];
+    if (open_batch != nullptr &&
+        open_batch->batch_size + batch_size > open_batch->max_batch_size) {
+      // The call doesn't fit: let the open batch be executed right away, and
+      // start a new one.
+      open_batch->closed = true;
+      open_batch = nullptr;
+    }
+    if (open_batch == nullptr) {
+      open_batch = std::make_shared<Batch>();
+      open_batch->max_batch_size = batching_config_.max_batch_size();
+      is_first_task = true;
+    }
+    open_batch->tasks.push_back(&task);
+    open_batch->batch_size += batch_size;
+    batch = open_batch;
+  }
+
+  if (!is_first_task) {
+    task.done.WaitForNotification();
+    return std::move(task.outputs);
+  }
+
+  // This call is the first of the batch: wait for other calls to join, then
+  // execute the batch.
+  std::vector<BatchTask*> tasks;
+  batch_mutex_.LockWhenWithTimeout(
+      absl::Condition(batch.get(), &Batch::IsReady),
+      absl::Microseconds(batching_config_.batch_timeout_micros()));
+  auto it = open_batches_.find(batch_key);
+  if (it != open_batches_.end() && it->second == batch) {
+    open_batches_.erase(it);
+  }
+  batch->closed = true;
+  tasks = batch->tasks;
+  batch_mutex_.Unlock();
+
+  VLOG(2) << "Executing a batch of " << tasks.size() << " calls";
+  absl::StatusOr<std::vector<std::vector<tensorflow::Tensor>>> outputs =
+      ExecuteBatch(tasks, variable_arg_indices);
+  for (int i = 0; i < tasks.size(); ++i) {
+    if (outputs.ok()) {
+      tasks[i]->outputs = std::move((*outputs)[i]);
+    } else {
+      tasks[i]->outputs = outputs.status();
+    }
+    if (i > 0) tasks[i]->done.Notify();
+  }
+  return std::move(task.outputs);
+}
+
+int64_t IfrtServingExecutable::GetPaddedBatchSize(int64_t batch_size) const {
+  int64_t padded_batch_size = -1;
+  for (int64_t allowed_batch_size : batching_config_.allowed_batch_sizes()) {
+    if (allowed_batch_size >= batch_size &&
+        (padded_batch_size == -1 || allowed_batch_size < padded_batch_size)) {
+      padded_batch_size = allowed_batch_size;
+    }
+  }
+  return padded_batch_size == -1 ? batch_size : padded_batch_size;
+}
+
+absl::StatusOr<std::vector<std::vector<tensorflow::Tensor>>>
+IfrtServingExecutable::ExecuteBatch(
+    absl::Span<BatchTask* const> tasks,
+    absl::Span<const int> variable_arg_indices) {
+  int64_t batch_size = 0;
+  std::vector<int64_t> split_sizes;
+  split_sizes.reserve(tasks.size() + 1);
+  for (const BatchTask* task : tasks) {
+    batch_size += task->batch_size;
+    split_sizes.push_back(task->batch_size);
+  }
+  const int64_t padded_batch_size = GetPaddedBatchSize(batch_size);
+  const int64_t padding_size = padded_batch_size - batch_size;
+  if (padding_size > 0) split_sizes.push_back(padding_size);
+
+  if (tasks.size() == 1 && padding_size == 0) {
+    TF_ASSIGN_OR_RETURN(
+        std::vector<tensorflow::Tensor> outputs,
+        ExecuteUnbatched(tasks.front()->inputs, variable_arg_indices));
+    return std::vector<std::vector<tensorflow::Tensor>>{std::move(outputs)};
+  }
+
+  // Variables are the same for all the tasks of the batch. The other inputs
+  // are concatenated, and padded with copies of the first row.
+  absl::Span<const tensorflow::Tensor> first_inputs = tasks.front()->inputs;
+  std::vector<tensorflow::Tensor> batched_inputs;
+  batched_inputs.reserve(first_inputs.size());
+  int variable_index = 0;
+  for (int i = 0; i < first_inputs.size(); i++) {
+    if (variable_index < variable_arg_indices.size() &&
+        i == variable_arg_indices[variable_index]) {
+      batched_inputs.push_back(first_inputs[i]);
+      variable_index++;
+      continue;
+    }
+    std::vector<tensorflow::Tensor> rows;
+    rows.reserve(tasks.size() + padding_size);
+    for (const BatchTask* task : tasks) {
+      rows.push_back(task->inputs[i]);
+    }
+    rows.insert(rows.end(), padding_size, first_inputs[i].Slice(0, 1));
+    tensorflow::Tensor batched_input;
+    TF_RETURN_IF_ERROR(tensorflow::tensor::Concat(rows, &batched_input));
+    batched_inputs.push_back(std::move(batched_input));
+  }
+
+  // The batch is executed as a single call, so it reserves a single core from
+  // the core selector.
+  TF_ASSIGN_OR_RETURN(std::vector<tensorflow::Tensor> batched_outputs,
+                      ExecuteUnbatched(batched_inputs, variable_arg_indices));
+
+  std::vector<std::vector<tensorflow::Tensor>> outputs(tasks.size());
+  for (auto& task_outputs : outputs) {
+    task_outputs.reserve(batched_outputs.size());
+  }
+  for (const tensorflow::Tensor& batched_output : batched_outputs) {
+    if (batched_output.dims() == 0 ||
+        batched_output.dim_size(0) != padded_batch_size) {
+      return absl::FailedPreconditionError(absl::StrCat(
+          "Expected outputs batched along their first dimension with size ",
+          padded_batch_size, " for program ", program_id_, ", but got shape ",
+          batched_output.shape().DebugString()));
+    }
+    std::vector<tensorflow::Tensor> split_outputs;
+    TF_RETURN_IF_ERROR(tensorflow::tensor::Split(batched_output, split_sizes,
+                                                 &split_outputs));
+    for (int i = 0; i < tasks.size(); ++i) {
+      outputs[i].push_back(std::move(split_outputs[i]));
+    }
+  }
+  return outputs;
+}
+
+absl::StatusOr<std::vector<tensorflow::Tensor>>
+IfrtServingExecutable::ExecuteUnbatched(
+    absl::Span<const tensorflow::Tensor> inputs,
+    absl::Span<const int> variable_arg_indices) {
   TF_ASSIGN_OR_RETURN(std::vector<DtypeAndShape> dtypes_and_shapes,
                       BuildDtypeAndShape(inputs, variable_arg_indices,
                                          ifrt_restore_tensor_registry_));
@@ -554,11 +752,19 @@ absl::StatusOr<std::vector<tensorflow::Tensor>> IfrtServingExecutable::Execute(
           .device_ids = std::move(device_ids),
           .input_name = inputs[i].scalar<tsl::tstring>()(),
       };
-      TF_ASSIGN_OR_RETURN(
-          auto loaded_variable,
-          ifrt_loaded_variable_registry_.GetLoadedVariable(key));
+      auto loaded_variable =
+          ifrt_loaded_variable_registry_.GetLoadedVariable(key);
+      if (absl::IsNotFound(loaded_variable.status())) {
+        // The variable may have been evicted by the loading of another one
+        // since `AsyncLoadIfrtArray()` above, so load it again.
+        const int variable_arg_index[] = {i};
+        TF_RETURN_IF_ERROR(AsyncLoadIfrtArray(inputs, variable_arg_index,
+                                              *executable_bundle, devices));
+        loaded_variable = ifrt_loaded_variable_registry_.GetLoadedVariable(key);
+      }
+      TF_RETURN_IF_ERROR(loaded_variable.status());
       TF_ASSIGN_OR_RETURN(tsl::RCReference<xla::ifrt::Array> single_array,
-                          loaded_variable.array.Await());
+                          loaded_variable->array.Await());
       args.push_back(std::move(single_array));
       variable_index++;
     } else {
@@ -30,6 +30,7 @@ limitations under the License.
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
 #include "absl/types/span.h"
 #include "mlir/IR/BuiltinOps.h"  // from @llvm-project
 #include "mlir/IR/MLIRContext.h"  // from @llvm-project
@@ -49,6 +50,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/protobuf/tpu/compile_metadata.pb.h"
+#include "tensorflow/core/tfrt/ifrt/ifrt_config.pb.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_loaded_variable_registry.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_restore_tensor_registry.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_serving_core_selector.h"
@@ -72,7 +74,8 @@ class IfrtServingExecutable {
       tfrt::ConcurrentWorkQueue* checkpoint_loader_queue,
       tensorflow::DeviceMgr* device_mgr,
       tensorflow::XlaHelpers::ShapeRepresentationFn shape_representation_fn,
-      IfrtServingCoreSelector* ifrt_serving_core_selector);
+      IfrtServingCoreSelector* ifrt_serving_core_selector,
+      const IfrtServingBatchingConfigProto& batching_config);
 
   // Movable but not copyable.
   IfrtServingExecutable(IfrtServingExecutable&& other) = default;
@@ -85,6 +88,9 @@ class IfrtServingExecutable {
 
   // Executes the computation.
   // variable_arg_indices are in sorted order.
+  //
+  // If batching is enabled, the call may be merged with concurrent calls into
+  // a single execution (see `IfrtServingBatchingConfigProto`).
   absl::StatusOr<std::vector<tensorflow::Tensor>> Execute(
       absl::Span<const tensorflow::Tensor> inputs,
       absl::Span<const int> variable_arg_indices);
@@ -143,6 +149,7 @@ class IfrtServingExecutable {
       tensorflow::DeviceMgr* device_mgr,
       tensorflow::XlaHelpers::ShapeRepresentationFn shape_representation_fn,
       IfrtServingCoreSelector* ifrt_serving_core_selector,
+      const IfrtServingBatchingConfigProto& batching_config,
       tensorflow::tpu::TPUCompileMetadataProto original_compile_metadata)
       : program_id_(program_id),
         model_name_(std::string(model_name)),
@@ -156,7 +163,30 @@ class IfrtServingExecutable {
         checkpoint_loader_queue_(checkpoint_loader_queue),
         device_mgr_(device_mgr),
         shape_representation_fn_(std::move(shape_representation_fn)),
-        ifrt_serving_core_selector_(std::move(ifrt_serving_core_selector)) {}
+        ifrt_serving_core_selector_(std::move(ifrt_serving_core_selector)),
+        batching_config_(batching_config) {}
+
+  // A call waiting to be executed as part of a batch.
+  struct BatchTask {
+    absl::Span<const tensorflow::Tensor> inputs;
+    // The size of the first dimension of the non-variable inputs.
+    int64_t batch_size = 0;
+    absl::StatusOr<std::vector<tensorflow::Tensor>> outputs;
+    absl::Notification done;
+  };
+
+  // The calls merged into one execution. The first call of the batch executes
+  // it once the batch is ready, and notifies the other calls. Guarded by
+  // `batch_mutex_`.
+  struct Batch {
+    std::vector<BatchTask*> tasks;
+    int64_t batch_size = 0;
+    int64_t max_batch_size = 0;
+    // Set when no call can join the batch anymore.
+    bool closed = false;
+
+    bool IsReady() const { return closed || batch_size >= max_batch_size; }
+  };
 
   int64_t program_id_;
   using SharedCachedExecutableBundle = std::shared_ptr<CachedExecutableBundle>;
@@ -179,6 +209,7 @@ class IfrtServingExecutable {
   tensorflow::DeviceMgr* device_mgr_;  // Not owned. For host callback.
   tensorflow::XlaHelpers::ShapeRepresentationFn shape_representation_fn_;
   IfrtServingCoreSelector* ifrt_serving_core_selector_;
+  IfrtServingBatchingConfigProto batching_config_;
 
   mutable absl::Mutex mutex_;
   absl::flat_hash_map<Key, xla::ifrt::Future<SharedCachedExecutableBundle>>
@@ -186,6 +217,32 @@ class IfrtServingExecutable {
 
   bool is_frozen_ ABSL_GUARDED_BY(mutex_) = false;
 
+  absl::Mutex batch_mutex_;
+  // The batches that calls can join, keyed by the dtypes, the inner
+  // dimensions and the variables of their inputs.
+  absl::flat_hash_map<std::string, std::shared_ptr<Batch>> open_batches_
+      ABSL_GUARDED_BY(batch_mutex_);
+
+  absl::StatusOr<std::vector<tensorflow::Tensor>> ExecuteUnbatched(
+      absl::Span<const tensorflow::Tensor> inputs,
+      absl::Span<const int> variable_arg_indices);
+
+  // Adds the call to the open batch of `batch_key`, and returns its outputs
+  // once the batch is executed.
+  absl::StatusOr<std::vector<tensorflow::Tensor>> ExecuteBatched(
+      absl::Span<const tensorflow::Tensor> inputs,
+      absl::Span<const int> variable_arg_indices, const std::string& batch_key,
+      int64_t batch_size);
+
+  // Executes `tasks` as one call whose non-variable inputs are concatenated
+  // and padded, and returns the outputs of each task in order.
+  absl::StatusOr<std::vector<std::vector<tensorflow::Tensor>>> ExecuteBatch(
+      absl::Span<BatchTask* const> tasks,
+      absl::Span<const int> variable_arg_indices);
+
+  // Returns the size the inputs of a batch of `batch_size` rows are padded to.
+  int64_t GetPaddedBatchSize(int64_t batch_size) const;
+
   // Asynchronously load the restored variable tensors to Ifrt array.
   absl::Status AsyncLoadIfrtArray(
       absl::Span<const tensorflow::Tensor> inputs,
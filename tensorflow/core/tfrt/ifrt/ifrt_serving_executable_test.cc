@@ -24,6 +24,7 @@ limitations under the License.
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/log/check.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -51,6 +52,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/platform/resource_loader.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/tfrt/ifrt/ifrt_config.pb.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_loaded_variable_registry.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_restore_tensor_registry.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_serving_core_selector.h"
@@ -80,6 +82,7 @@ using ::tensorflow::test::AsTensor;
 using ::tensorflow::test::TensorEq;
 using ::testing::ElementsAre;
 using ::testing::Return;
+using ::tsl::testing::IsOkAndHolds;
 using ::tsl::testing::StatusIs;
 
 const tsl::thread::ThreadPool& GetThreadPool() {
@@ -147,7 +150,8 @@ TEST_F(IfrtServingExecutableTest, Basic) {
           program_id, "test", "main", std::move(mlir_module), client,
           &GetThreadPool(), &ifrt_loaded_variable_registry,
           &ifrt_restore_tensor_registry, work_queue.get(), device_mgr.get(),
-          tensorflow::IdentityShapeRepresentationFn(), core_selector_.get()));
+          tensorflow::IdentityShapeRepresentationFn(), core_selector_.get(),
+          /*batching_config=*/{}));
 
   auto x = AsTensor<int32_t>({1, 2, 3}, tensorflow::TensorShape({1, 3}));
   auto y = AsTensor<int32_t>({1, 2, 3}, tensorflow::TensorShape({3, 1}));
@@ -162,6 +166,85 @@ TEST_F(IfrtServingExecutableTest, Basic) {
   EXPECT_THAT(result, ElementsAre(TensorEq(expected_out)));
 }
 
+TEST_F(IfrtServingExecutableTest, BatchConcurrentCalls) {
+  // Create test input module
+  constexpr absl::string_view kDataDirectory =
+      "tensorflow/core/tfrt/ifrt/testdata";
+  std::string mlir_module_path = tensorflow::GetDataDependencyFilepath(
+      absl::StrCat(kDataDirectory, "/executable_batched.mlir"));
+
+  mlir::DialectRegistry registry;
+  mlir::registerAllDialects(registry);
+  mlir::RegisterAllTensorFlowDialects(registry);
+
+  mlir::MLIRContext context(registry);
+
+  mlir::OwningOpRef<mlir::ModuleOp> mlir_module =
+      mlir::parseSourceFile<mlir::ModuleOp>(mlir_module_path, &context);
+
+  ASSERT_TRUE(mlir_module);
+
+  // The three calls are executed as a single call on one core.
+  int64_t program_id = 123456;
+  EXPECT_CALL(selector_, ReserveDevice(absl::StrCat(program_id)))
+      .Times(1)
+      .WillOnce(Return(tsl::DeviceReservation(0, /*selector=*/nullptr)));
+
+  IfrtLoadedVariableRegistry ifrt_loaded_variable_registry;
+  IfrtRestoreTensorRegistry ifrt_restore_tensor_registry;
+  std::unique_ptr<tfrt::ConcurrentWorkQueue> work_queue =
+      tfrt::CreateMultiThreadedWorkQueue(
+          /*num_threads=*/4, /*num_blocking_threads=*/4);
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<tensorflow::StaticDeviceMgr> device_mgr,
+      CreateTfStaticDeviceMgr());
+
+  IfrtServingBatchingConfigProto batching_config;
+  batching_config.set_max_batch_size(4);
+  batching_config.set_batch_timeout_micros(60 * 1000 * 1000);
+  batching_config.add_allowed_batch_sizes(4);
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto executable,
+      IfrtServingExecutable ::Create(
+          program_id, "test", "main", std::move(mlir_module), client_,
+          &GetThreadPool(), &ifrt_loaded_variable_registry,
+          &ifrt_restore_tensor_registry, work_queue.get(), device_mgr.get(),
+          tensorflow::IdentityShapeRepresentationFn(), core_selector_.get(),
+          batching_config));
+
+  // The calls have 1 + 2 + 1 rows, so the batch is executed as soon as all of
+  // them have joined it.
+  std::vector<std::vector<tensorflow::Tensor>> inputs = {
+      {AsTensor<int32_t>({1, 2}, tensorflow::TensorShape({1, 2})),
+       AsTensor<int32_t>({10, 20}, tensorflow::TensorShape({1, 2}))},
+      {AsTensor<int32_t>({3, 4, 5, 6}, tensorflow::TensorShape({2, 2})),
+       AsTensor<int32_t>({30, 40, 50, 60}, tensorflow::TensorShape({2, 2}))},
+      {AsTensor<int32_t>({7, 8}, tensorflow::TensorShape({1, 2})),
+       AsTensor<int32_t>({70, 80}, tensorflow::TensorShape({1, 2}))},
+  };
+  std::vector<absl::StatusOr<std::vector<tensorflow::Tensor>>> results(
+      inputs.size());
+  {
+    std::vector<std::unique_ptr<tsl::Thread>> threads;
+    for (int i = 0; i < inputs.size(); ++i) {
+      threads.push_back(absl::WrapUnique(tsl::Env::Default()->StartThread(
+          tsl::ThreadOptions(), absl::StrCat("call_", i), [&, i] {
+            results[i] = executable->Execute(absl::MakeSpan(inputs[i]), {});
+          })));
+    }
+  }
+
+  EXPECT_THAT(results[0], IsOkAndHolds(ElementsAre(TensorEq(AsTensor<int32_t>(
+                              {11, 22}, tensorflow::TensorShape({1, 2}))))));
+  EXPECT_THAT(results[1],
+              IsOkAndHolds(ElementsAre(TensorEq(AsTensor<int32_t>(
+                  {33, 44, 55, 66}, tensorflow::TensorShape({2, 2}))))));
+  EXPECT_THAT(results[2], IsOkAndHolds(ElementsAre(TensorEq(AsTensor<int32_t>(
+                              {77, 88}, tensorflow::TensorShape({1, 2}))))));
+  EXPECT_EQ(executable->num_executables(), 1);
+}
+
 TEST_F(IfrtServingExecutableTest, MultipleShapes) {
   // Create test input module
   constexpr absl::string_view kDataDirectory =
@@ -205,7 +288,8 @@ TEST_F(IfrtServingExecutableTest, MultipleShapes) {
           program_id, "test", "main", std::move(mlir_module), client,
           &GetThreadPool(), &ifrt_loaded_variable_registry,
           &ifrt_restore_tensor_registry, work_queue.get(), device_mgr.get(),
-          tensorflow::IdentityShapeRepresentationFn(), core_selector_.get()));
+          tensorflow::IdentityShapeRepresentationFn(), core_selector_.get(),
+          /*batching_config=*/{}));
 
   auto x1 = AsTensor<int32_t>({1, 2, 3}, tensorflow::TensorShape({1, 3}));
   auto y1 = AsTensor<int32_t>({1, 2, 3}, tensorflow::TensorShape({3, 1}));
@@ -278,7 +362,8 @@ TEST_F(IfrtServingExecutableTest, ReturnFailOnUncompiledShapeAfterFrozen) {
           program_id, "test", "main", std::move(mlir_module), client,
           &GetThreadPool(), &ifrt_loaded_variable_registry,
           &ifrt_restore_tensor_registry, work_queue.get(), device_mgr.get(),
-          tensorflow::IdentityShapeRepresentationFn(), core_selector_.get()));
+          tensorflow::IdentityShapeRepresentationFn(), core_selector_.get(),
+          /*batching_config=*/{}));
 
   auto x1 = AsTensor<int32_t>({1, 2, 3}, tensorflow::TensorShape({1, 3}));
   auto y1 = AsTensor<int32_t>({1, 2, 3}, tensorflow::TensorShape({3, 1}));
@@ -350,7 +435,8 @@ TEST_F(IfrtServingExecutableTest, Spmd) {
           program_id, "test", "main", std::move(mlir_module), client,
           &GetThreadPool(), &ifrt_loaded_variable_registry,
           &ifrt_restore_tensor_registry, work_queue.get(), device_mgr.get(),
-          tensorflow::IdentityShapeRepresentationFn(), core_selector_.get()));
+          tensorflow::IdentityShapeRepresentationFn(), core_selector_.get(),
+          /*batching_config=*/{}));
 
   auto x = AsTensor<int32_t>({1, 2, 3, 4, 5, 6, 7, 8},
                              tensorflow::TensorShape({4, 2}));
@@ -411,7 +497,8 @@ TEST_F(IfrtServingExecutableTest, SpmdTwoReturns) {
           program_id, "test", "main", std::move(mlir_module), client,
           &GetThreadPool(), &ifrt_loaded_variable_registry,
           &ifrt_restore_tensor_registry, work_queue.get(), device_mgr.get(),
-          tensorflow::IdentityShapeRepresentationFn(), core_selector_.get()));
+          tensorflow::IdentityShapeRepresentationFn(), core_selector_.get(),
+          /*batching_config=*/{}));
 
   auto x = AsTensor<int32_t>({1, 2, 3, 4, 5, 6, 7, 8},
                              tensorflow::TensorShape({4, 2}));
@@ -479,7 +566,8 @@ TEST_F(IfrtServingExecutableTest, NoReturn) {
           program_id, "test", "main", std::move(mlir_module), client,
           &GetThreadPool(), &ifrt_loaded_variable_registry,
           &ifrt_restore_tensor_registry, work_queue.get(), device_mgr.get(),
-          tensorflow::IdentityShapeRepresentationFn(), core_selector_.get()));
+          tensorflow::IdentityShapeRepresentationFn(), core_selector_.get(),
+          /*batching_config=*/{}));
 
   auto x = AsTensor<int32_t>({1, 2, 3}, tensorflow::TensorShape({1, 3}));
   auto y = AsTensor<int32_t>({1, 2, 3}, tensorflow::TensorShape({3, 1}));
@@ -537,7 +625,8 @@ TEST_P(VariableInputTest, InterleaveVariable) {
           program_id, "test", "main", std::move(mlir_module), client,
           &GetThreadPool(), &ifrt_loaded_variable_registry,
           &ifrt_restore_tensor_registry, work_queue.get(), device_mgr.get(),
-          tensorflow::IdentityShapeRepresentationFn(), &core_selector));
+          tensorflow::IdentityShapeRepresentationFn(), &core_selector,
+          /*batching_config=*/{}));
 
   std::vector<tensorflow::Tensor> inputs;
   std::vector<int> loaded_variable_indices;
@@ -116,16 +116,47 @@ void UnwindOnError(ExecutionContext& context, int64_t pc);
 
 }
 
-class FunctionContext {
+// Recycles the register buffers of the function calls, so that only the first
+// calls at each depth of the call stack allocate them. It is not thread-safe,
+// and is meant to be used by one `ExecutionContext` at a time, e.g. by one
+// request after another.
+class RegisterPool {
  public:
-  FunctionContext(bc::Function function, ExecutionContext* execution_context)
-      : pc_(0),
-        registers_(function.num_regs()),
-        function_object_(function),
-        execution_context_(execution_context) {
-    DCHECK(execution_context);
+  explicit RegisterPool(size_t max_free_buffers = 16)
+      : max_free_buffers_(max_free_buffers) {}
+
+  RegisterPool(const RegisterPool&) = delete;
+  RegisterPool& operator=(const RegisterPool&) = delete;
+
+  std::vector<Value> Acquire(size_t num_regs) {
+    if (free_buffers_.empty()) return std::vector<Value>(num_regs);
+    std::vector<Value> registers = std::move(free_buffers_.back());
+    free_buffers_.pop_back();
+    registers.resize(num_regs);
+    return registers;
   }
 
+  void Release(std::vector<Value> registers) {
+    // Destroys the values right away, e.g. to release their tensors, and only
+    // keeps the buffer.
+    registers.clear();
+    if (free_buffers_.size() < max_free_buffers_) {
+      free_buffers_.push_back(std::move(registers));
+    }
+  }
+
+  size_t num_free_buffers() const { return free_buffers_.size(); }
+
+ private:
+  size_t max_free_buffers_;
+  std::vector<std::vector<Value>> free_buffers_;
+};
+
+class FunctionContext {
+ public:
+  FunctionContext(bc::Function function, ExecutionContext* execution_context);
+  ~FunctionContext();
+
   FunctionContext(const FunctionContext&) = delete;
   FunctionContext& operator=(const FunctionContext&) = delete;
   FunctionContext(FunctionContext&&) = default;
@@ -275,6 +306,13 @@ class ExecutionContext {
     work_queue_ = work_queue;
   }
 
+  // If not null, the registers of the function calls are taken from and given
+  // back to `register_pool`, which must outlive this context.
+  RegisterPool* register_pool() const { return register_pool_; }
+  void set_register_pool(RegisterPool* register_pool) {
+    register_pool_ = register_pool;
+  }
+
   template <typename Args, typename Results>
   void Call(bc::Function function_object, bc::Span<uint8_t> last_uses,
             Args args, Results results) {
@@ -494,6 +532,9 @@ class ExecutionContext {
   State state() const { return state_; }
 
  private:
+  // Declared before `function_stack_` as it is used to destroy the functions.
+  RegisterPool* register_pool_ = nullptr;
+
   absl::InlinedVector<FunctionContext, 2> function_stack_;
 
   State state_ = State::kReady;
@@ -521,6 +562,27 @@ class ExecutionContext {
                                               int64_t pc);
 };
 
+inline FunctionContext::FunctionContext(bc::Function function,
+                                        ExecutionContext* execution_context)
+    : pc_(0),
+      registers_(execution_context->register_pool() != nullptr
+                     ? execution_context->register_pool()->Acquire(
+                           function.num_regs())
+                     : std::vector<Value>(function.num_regs())),
+      function_object_(function),
+      execution_context_(execution_context) {
+  DCHECK(execution_context);
+}
+
+inline FunctionContext::~FunctionContext() {
+  // Moved-from contexts have no registers to give back.
+  if (execution_context_ != nullptr &&
+      execution_context_->register_pool() != nullptr &&
+      registers_.capacity() > 0) {
+    execution_context_->register_pool()->Release(std::move(registers_));
+  }
+}
+
 class KernelFrame {
  public:
   struct State {
@@ -2136,6 +2136,51 @@ TEST(KernelTest, While) {
             output.Get<int32_t>());
 }
 
+TEST(KernelTest, WhileWithRegisterPool) {
+  auto buffer = CreateWhileExecutable();
+
+  bc::Executable executable(buffer.data());
+
+  KernelRegistry registry;
+  RegisterBuiltinKernels(registry);
+  registry.Register("test_while_body", &TestWhileBody);
+  LoadedExecutable loaded_executable(executable, registry);
+
+  auto function = loaded_executable.GetFunction("main");
+  ASSERT_TRUE(function);
+
+  constexpr int32_t kStart = 0;
+  constexpr int32_t kEnd = 2;
+  constexpr int32_t kInitialValue = 6;
+
+  RegisterPool register_pool;
+  for (int i = 0; i < 2; ++i) {
+    ExecutionContext execution_context(&loaded_executable);
+    execution_context.set_register_pool(&register_pool);
+
+    Value inputs[4];
+    inputs[0].Set(true);
+    inputs[1].Set(kStart);
+    inputs[2].Set(kEnd);
+    inputs[3].Set(kInitialValue);
+    Value output;
+
+    std::vector<uint8_t> last_uses = {false, false, false, false};
+    execution_context.Call(function, last_uses, absl::MakeSpan(inputs),
+                           absl::Span<Value>(&output, 1));
+
+    Execute(execution_context);
+
+    ASSERT_TRUE(output.HasValue());
+    EXPECT_EQ(kInitialValue + kValueIncrementStep * (kEnd - kStart + 1),
+              output.Get<int32_t>());
+
+    // The iterations of the loop body reuse the same registers, and the next
+    // execution reuses the registers of both functions.
+    EXPECT_EQ(register_pool.num_free_buffers(), 2);
+  }
+}
+
 TEST(KernelTest, WhileWithInitialFalseCondition) {
   auto buffer = CreateWhileExecutable();
 
@@ -68,10 +68,22 @@ class Context : public mlrt::UserContext<Context> {
     return run_state;
   }
 
-  // Return true if there is a cancellation request.
+  // Return true if there is a cancellation request, e.g. when the deadline of
+  // the request has passed. The cancellation is forwarded to the
+  // CancellationManager of the request, so that long-running kernels polling it
+  // or registered on it can also return early.
   bool IsCancelled() {
-    return cancellation_context_ != nullptr &&
-           cancellation_context_->IsCancelled();
+    if (cancellation_context_ == nullptr ||
+        !cancellation_context_->IsCancelled()) {
+      return false;
+    }
+    auto* cancellation_manager =
+        fallback_request_state_->cancellation_manager();
+    if (cancellation_manager != nullptr &&
+        !cancellation_manager->IsCancelled()) {
+      cancellation_manager->StartCancel();
+    }
+    return true;
   }
 
  private:
@@ -774,7 +774,16 @@ struct ExecuteOp : mlrt::KernelFrame {
     return context().fallback_request_state().cpu_device();
   }
 
-  void Invoke() { ExecuteOpInternal</*IsAsync=*/false>(*this); }
+  void Invoke() {
+    // Skip the remaining ops of a cancelled request, e.g. one that is past its
+    // deadline, instead of doing work whose results are dropped.
+    if (context().IsCancelled()) {
+      execution_context().FailOnCancellation();
+      return;
+    }
+
+    ExecuteOpInternal</*IsAsync=*/false>(*this);
+  }
 };
 
 struct AsyncExecuteOp : ExecuteOp {
@@ -812,7 +821,14 @@ struct ExecuteOpDevice : ExecuteOp {
     return arguments()[0].Get<std::shared_ptr<tensorflow::Device>>();
   }
 
-  void Invoke() { ExecuteOpInternal</*IsAsync=*/false>(*this); }
+  void Invoke() {
+    if (context().IsCancelled()) {
+      execution_context().FailOnCancellation();
+      return;
+    }
+
+    ExecuteOpInternal</*IsAsync=*/false>(*this);
+  }
 };
 
 struct AsyncExecuteOpDevice : ExecuteOpDevice {
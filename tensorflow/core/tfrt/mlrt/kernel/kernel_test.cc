@@ -29,6 +29,7 @@ limitations under the License.
 #include "absl/strings/substitute.h"
 #include "absl/synchronization/notification.h"
 #include "absl/types/span.h"
+#include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/device.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/tfrt/fallback/device_with_custom_allocator.h"
@@ -177,6 +178,62 @@ TEST(KernelTest, CreateExecuteOp) {
       result.Get<tfrt_stub::FallbackTensor>().tensor(), expected);
 }
 
+TEST(KernelTest, ExecuteOpCanCancel) {
+  auto buffer = CreateExecutableForCreateExecuteOp("AddV2");
+
+  mlrt::bc::Executable executable(buffer.data());
+
+  mlrt::KernelRegistry registry;
+  RegisterTfMlrtKernels(registry);
+  mlrt::LoadedExecutable loaded_executable(executable, registry);
+
+  mlrt::ExecutionContext execution_context(&loaded_executable);
+
+  tensorflow::SessionOptions session_options;
+  tensorflow::FunctionDefLibrary fdef_lib;
+  TF_ASSERT_OK_AND_ASSIGN(auto fallback_state, tfrt_stub::FallbackState::Create(
+                                                   session_options, fdef_lib));
+
+  std::function<void(std::function<void()>)> runner =
+      [](const std::function<void()>& f) { f(); };
+  tfrt_stub::OpKernelRunnerTable runner_table;
+  tfd::FallbackResourceArray resource_array;
+  tfd::KernelFallbackCompatRequestState fallback_request_state(
+      &runner, &fallback_state->device_manager(), /*step_id=*/0, &runner_table,
+      &resource_array, /*user_intra_op_threadpool=*/nullptr,
+      /*model_metadata=*/std::nullopt,
+      &fallback_state->process_function_library_runtime());
+  tensorflow::CancellationManager cancellation_manager;
+  fallback_request_state.set_cancellation_manager(&cancellation_manager);
+
+  tfrt::RCReference<tfrt::CancellationContext> cancellation_context =
+      tfrt::TakeRef(new tfrt::CancellationContext());
+
+  tfrt::ResourceContext resource_context;
+
+  auto tf_context = std::make_unique<Context>(
+      &fallback_request_state, &resource_context, cancellation_context.get());
+  execution_context.AddUserContext(std::move(tf_context));
+
+  int32_t input = 100;
+  tensorflow::Tensor input_tensor(input);
+  mlrt::Value arg(tfrt_stub::FallbackTensor(std::move(input_tensor)));
+  mlrt::Value result;
+
+  std::vector<uint8_t> last_uses = {true};
+  execution_context.Call(executable.functions()[0], last_uses,
+                         absl::MakeSpan(&arg, 1), absl::MakeSpan(&result, 1));
+
+  cancellation_context->Cancel();
+
+  mlrt::Execute(execution_context);
+
+  EXPECT_THAT(execution_context.status(),
+              ::tsl::testing::StatusIs(absl::StatusCode::kCancelled));
+  // The cancellation is forwarded to the kernels of the request.
+  EXPECT_TRUE(cancellation_manager.IsCancelled());
+}
+
 mlrt::bc::Buffer CreateExecutableForCreateExecuteOpCustomDevice(
     absl::string_view op_name) {
   mlrt::bc::Buffer buffer;
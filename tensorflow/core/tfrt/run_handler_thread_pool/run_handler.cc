@@ -48,6 +48,16 @@ namespace {
 typedef typename internal::RunHandlerEnvironment::Task Task;
 typedef Eigen::RunQueue<Task, 1024> Queue;
 
+// Returns the next number of a xorshift64 sequence. `state` must not be zero.
+uint64_t NextRandom(uint64_t* state) {
+  uint64_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  *state = x;
+  return x;
+}
+
 }  // namespace
 
 namespace internal {
@@ -140,6 +150,7 @@ ThreadWorkSource::ThreadWorkSource()
       blocking_inflight_(0),
       non_blocking_inflight_(0),
       pending_tasks_(0),
+      priority_(0),
       traceme_id_(0),
       version_(0),
       sub_thread_pool_waiter_(nullptr) {
@@ -157,7 +168,8 @@ ThreadWorkSource::~ThreadWorkSource() {
 }
 
 Task ThreadWorkSource::EnqueueTask(Task t, bool is_blocking,
-                                   bool enable_wake_up) {
+                                   bool enable_wake_up,
+                                   int local_queue_index) {
   uint64_t id = t.f->trace_id;
   tsl::profiler::TraceMe activity(
       [id, is_blocking] {
@@ -169,16 +181,22 @@ Task ThreadWorkSource::EnqueueTask(Task t, bool is_blocking,
   Queue* task_queue = nullptr;
   thread_local int64_t closure_counter = 0;
 
-  if (!is_blocking) {
-    int queue_index = ++closure_counter % non_blocking_work_sharding_factor_;
-    task_queue = &(non_blocking_work_queues_[queue_index]->queue);
-    mu = &non_blocking_work_queues_[queue_index]->queue_op_mu;
-  } else {
-    task_queue = &blocking_work_queue_;
-    mu = &blocking_queue_op_mu_;
+  if (is_blocking && local_queue_index >= 0) {
+    // Only the owning thread calls PushFront on a local queue, so no lock is
+    // needed. Fall back to the shared queue if the local queue is full.
+    t = local_blocking_queues_[local_queue_index]->PushFront(std::move(t));
   }
 
-  {
+  if (t.f) {
+    if (!is_blocking) {
+      int queue_index = ++closure_counter % non_blocking_work_sharding_factor_;
+      task_queue = &(non_blocking_work_queues_[queue_index]->queue);
+      mu = &non_blocking_work_queues_[queue_index]->queue_op_mu;
+    } else {
+      task_queue = &blocking_work_queue_;
+      mu = &blocking_queue_op_mu_;
+    }
+
     tensorflow::mutex_lock l(*mu);
     // For a given queue, only one thread can call PushFront.
     t = task_queue->PushFront(std::move(t));
@@ -240,6 +258,30 @@ Task ThreadWorkSource::PopBlockingTask() {
   return blocking_work_queue_.PopBack();
 }
 
+void ThreadWorkSource::CreateLocalBlockingQueues(int num_local_queues) {
+  DCHECK(local_blocking_queues_.empty());
+  local_blocking_queues_.reserve(num_local_queues);
+  for (int i = 0; i < num_local_queues; ++i) {
+    local_blocking_queues_.push_back(std::make_unique<LocalQueue>());
+  }
+}
+
+Task ThreadWorkSource::PopLocalBlockingTask(int index) {
+  return local_blocking_queues_[index]->PopFront();
+}
+
+Task ThreadWorkSource::StealLocalBlockingTask(int index) {
+  return local_blocking_queues_[index]->PopBack();
+}
+
+int64_t ThreadWorkSource::GetPriority() const {
+  return priority_.load(std::memory_order_relaxed);
+}
+
+void ThreadWorkSource::SetPriority(int64_t priority) {
+  priority_.store(priority, std::memory_order_relaxed);
+}
+
 Task ThreadWorkSource::PopNonBlockingTask(int start_index,
                                           bool search_from_all_queue) {
   Task t;
@@ -259,7 +301,11 @@ Task ThreadWorkSource::PopNonBlockingTask(int start_index,
 
 int ThreadWorkSource::TaskQueueSize(bool is_blocking) {
   if (is_blocking) {
-    return blocking_work_queue_.Size();
+    unsigned total_size = blocking_work_queue_.Size();
+    for (const auto& local_queue : local_blocking_queues_) {
+      total_size += local_queue->Size();
+    }
+    return total_size;
   } else {
     unsigned total_size = 0;
     for (int i = 0; i < non_blocking_work_sharding_factor_; ++i) {
@@ -356,6 +402,7 @@ RunHandlerThreadPool::RunHandlerThreadPool(
       blocking_thread_max_waiting_time_(
           options.blocking_threads_max_sleep_time_micro_sec),
       enable_wake_up_(options.enable_wake_up),
+      use_work_stealing_(options.use_work_stealing),
       thread_data_(num_threads_),
       env_(env, thread_options, name),
       name_(name),
@@ -372,6 +419,7 @@ RunHandlerThreadPool::RunHandlerThreadPool(
     thread_data_[i].current_thread_work_sources =
         std::make_unique<Eigen::MaxSizeVector<ThreadWorkSource*>>(
             options.max_concurrent_handler);
+    thread_data_[i].steal_rng_state = i + 1;
   }
   VLOG(1) << "Creating RunHandlerThreadPool " << name << " with  "
           << num_blocking_threads_ << " blocking threads and "
@@ -420,7 +468,16 @@ void RunHandlerThreadPool::StartOneThreadForTesting() {
 void RunHandlerThreadPool::AddWorkToQueue(ThreadWorkSource* tws,
                                           bool is_blocking, TaskFunction fn) {
   Task t = env_.CreateTask(std::move(fn));
-  t = tws->EnqueueTask(std::move(t), is_blocking, enable_wake_up_);
+  int local_queue_index = -1;
+  if (use_work_stealing_ && is_blocking) {
+    // Inter-op threads queue their inter-op work to their own queue.
+    int thread_id = CurrentThreadId();
+    if (thread_id >= 0 && thread_id < tws->NumLocalBlockingQueues()) {
+      local_queue_index = thread_id;
+    }
+  }
+  t = tws->EnqueueTask(std::move(t), is_blocking, enable_wake_up_,
+                       local_queue_index);
   if (t.f) {
     VLOG(3) << "Running " << (is_blocking ? "inter" : "intra") << " work for "
             << tws->GetTracemeId();
@@ -474,6 +531,10 @@ int RunHandlerThreadPool::NumNonBlockingThreads() const {
   return num_non_blocking_threads_;
 }
 
+bool RunHandlerThreadPool::UseWorkStealing() const {
+  return use_work_stealing_;
+}
+
 RunHandlerThreadPool::ThreadData::ThreadData()
     : new_version(0), current_index(0), current_version(0) {}
 
@@ -515,6 +576,70 @@ Task RunHandlerThreadPool::FindTask(
   return t;
 }
 
+Task RunHandlerThreadPool::FindLocalTask(
+    int thread_id, int max_blocking_inflight,
+    const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
+    ThreadWorkSource** tws) {
+  Task t;
+  for (int i = 0; i < thread_work_sources.size(); ++i) {
+    ThreadWorkSource* source = thread_work_sources[i];
+    if (thread_id >= source->NumLocalBlockingQueues() ||
+        source->GetInflightTaskCount(true) >= max_blocking_inflight) {
+      continue;
+    }
+    t = source->PopLocalBlockingTask(thread_id);
+    if (t.f) {
+      *tws = source;
+      break;
+    }
+  }
+  return t;
+}
+
+Task RunHandlerThreadPool::StealTask(
+    int thread_id, int max_blocking_inflight,
+    const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
+    ThreadWorkSource** tws) {
+  Task t;
+  const int num_sources = thread_work_sources.size();
+  const int num_victims = num_blocking_threads_;
+  uint64_t* rng_state = &thread_data_[thread_id].steal_rng_state;
+
+  // The work sources are sorted by decreasing priority.
+  int stratum_begin = 0;
+  while (stratum_begin < num_sources) {
+    const int64_t priority =
+        thread_work_sources[stratum_begin]->GetPriority();
+    int stratum_end = stratum_begin + 1;
+    while (stratum_end < num_sources &&
+           thread_work_sources[stratum_end]->GetPriority() == priority) {
+      ++stratum_end;
+    }
+
+    // Visit every (request, victim thread) pair of the stratum once, starting
+    // from a random one, so that idle threads spread over the victims.
+    const int num_pairs = (stratum_end - stratum_begin) * num_victims;
+    const int start = NextRandom(rng_state) % num_pairs;
+    for (int i = 0; i < num_pairs; ++i) {
+      const int pair = (start + i) % num_pairs;
+      ThreadWorkSource* source =
+          thread_work_sources[stratum_begin + pair / num_victims];
+      const int victim = pair % num_victims;
+      if (victim == thread_id || victim >= source->NumLocalBlockingQueues() ||
+          source->GetInflightTaskCount(true) >= max_blocking_inflight) {
+        continue;
+      }
+      t = source->StealLocalBlockingTask(victim);
+      if (t.f) {
+        *tws = source;
+        return t;
+      }
+    }
+    stratum_begin = stratum_end;
+  }
+  return t;
+}
+
 // Main worker thread loop.
 void RunHandlerThreadPool::WorkerLoop(int thread_id,
                                       bool may_steal_blocking_work) {
@@ -543,7 +668,15 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
         thread_data_[thread_id].current_thread_work_sources.get();
     sub_thread_pool_id = thread_data_[thread_id].sub_thread_pool_id;
     int active_requests = thread_work_sources->size();
-    if (may_steal_blocking_work) {
+    if (may_steal_blocking_work && use_work_stealing_) {
+      // Run the work this thread has queued itself first, as its inputs are
+      // likely still in the cache.
+      t = FindLocalTask(thread_id, kMaxBlockingInflight, *thread_work_sources,
+                        &tws);
+    }
+    if (t.f) {
+      task_from_blocking_queue = true;
+    } else if (may_steal_blocking_work) {
       // Each thread will first look for tasks from requests that belongs to
       // its sub thread pool.
       int search_range_start =
@@ -570,6 +703,11 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
                      /*may_steal_blocking_work=*/true, *thread_work_sources,
                      &task_from_blocking_queue, &tws);
       }
+      if (!t.f && use_work_stealing_) {
+        t = StealTask(thread_id, kMaxBlockingInflight, *thread_work_sources,
+                      &tws);
+        task_from_blocking_queue = true;
+      }
     } else {
       // For non-blocking threads, it will always search from all pending
       // requests.
@@ -732,7 +870,8 @@ class RunHandlerPool::Impl {
                 options.use_adaptive_waiting_time, options.enable_wake_up,
                 options.max_concurrent_handler,
                 options.num_threads_in_sub_thread_pool,
-                options.sub_thread_request_percentage),
+                options.sub_thread_request_percentage,
+                options.use_work_stealing),
             tensorflow::Env::Default(), tensorflow::ThreadOptions(),
             "tf_run_handler_pool", &waiters_mu_, &queue_waiters_)),
         iterations_(0),
@@ -995,6 +1134,11 @@ void RunHandlerPool::Impl::LogInfo() {
 
 RunHandler::Impl::Impl(RunHandlerPool::Impl* pool_impl)
     : pool_impl_(pool_impl), eigen_thread_pool_(this) {
+  internal::RunHandlerThreadPool* thread_pool =
+      pool_impl->run_handler_thread_pool();
+  if (thread_pool->UseWorkStealing()) {
+    tws_.CreateLocalBlockingQueues(thread_pool->NumBlockingThreads());
+  }
   Reset(0, RunHandlerOptions());
 }
 
@@ -1016,6 +1160,7 @@ void RunHandler::Impl::Reset(int64_t step_id,
   step_id_ = step_id;
   options_ = options;
   tws_.SetTracemeId(step_id);
+  tws_.SetPriority(options.priority);
 }
 
 int RunHandler::Impl::RunHandlerEigenThreadPool::NumThreads() const {
@@ -108,6 +108,13 @@ class RunHandlerPool {
 
     // If true, threads will be waken up by new tasks.
     bool enable_wake_up = true;
+
+    // If true, inter-op closures scheduled from an inter-op thread are queued
+    // to a queue owned by that thread, and idle inter-op threads steal from
+    // the queues of randomly chosen threads, trying higher priority requests
+    // first. This avoids contention on the queues shared by all the threads
+    // when many requests are running concurrently.
+    bool use_work_stealing = false;
   };
   explicit RunHandlerPool(Options options);
   ~RunHandlerPool();
@@ -205,6 +212,9 @@ class RunHandlerEnvironment {
 
 typedef typename RunHandlerEnvironment::Task Task;
 typedef Eigen::RunQueue<Task, 1024> Queue;
+// The queues owned by the inter-op threads are smaller, since there is one per
+// thread and request. Tasks that don't fit go to the shared queue.
+typedef Eigen::RunQueue<Task, 64> LocalQueue;
 
 // To reduce cache misses, we use a doubly-linked list of Waiter structs and
 // queue them in LIFO order rather than the FIFO order used by a single
@@ -227,10 +237,32 @@ class ThreadWorkSource {
 
   ~ThreadWorkSource();
 
-  Task EnqueueTask(Task t, bool is_blocking, bool enable_wake_up);
+  // If `local_queue_index` is not negative, blocking tasks are queued to the
+  // local queue with that index. It must then be called by the thread owning
+  // the local queue.
+  Task EnqueueTask(Task t, bool is_blocking, bool enable_wake_up,
+                   int local_queue_index = -1);
 
   Task PopBlockingTask();
 
+  // Creates one local queue for blocking tasks per thread, used for work
+  // stealing. Must be called before any task is enqueued.
+  void CreateLocalBlockingQueues(int num_local_queues);
+
+  int NumLocalBlockingQueues() const { return local_blocking_queues_.size(); }
+
+  // Pops the most recently queued task from the local queue `index`. Must be
+  // called by the thread owning the local queue.
+  Task PopLocalBlockingTask(int index);
+
+  // Pops the least recently queued task from the local queue `index`. May be
+  // called by any thread.
+  Task StealLocalBlockingTask(int index);
+
+  int64_t GetPriority() const;
+
+  void SetPriority(int64_t priority);
+
   Task PopNonBlockingTask(int start_index, bool search_from_all_queue);
 
   int TaskQueueSize(bool is_blocking);
@@ -275,6 +307,8 @@ class ThreadWorkSource {
   std::atomic<int64_t> pending_tasks_;
 
   Queue blocking_work_queue_;
+  std::vector<std::unique_ptr<LocalQueue>> local_blocking_queues_;
+  std::atomic<int64_t> priority_;
   tensorflow::mutex blocking_queue_op_mu_;
   char pad_[128];
   tensorflow::mutex waiters_mu_;
@@ -301,6 +335,7 @@ class RunHandlerThreadPool {
     int max_concurrent_handler;
     std::vector<int> num_threads_in_sub_thread_pool;
     std::vector<double> sub_thread_request_percentage;
+    bool use_work_stealing;
     Options(int num_blocking_threads, int num_non_blocking_threads,
             bool wait_if_no_active_request,
             int non_blocking_threads_sleep_time_micro_sec,
@@ -308,7 +343,8 @@ class RunHandlerThreadPool {
             bool use_adaptive_waiting_time, bool enable_wake_up,
             int max_concurrent_handler,
             const std::vector<int>& num_threads_in_sub_thread_pool,
-            const std::vector<double>& sub_thread_request_percentage)
+            const std::vector<double>& sub_thread_request_percentage,
+            bool use_work_stealing = false)
         : num_blocking_threads(num_blocking_threads),
           num_non_blocking_threads(num_non_blocking_threads),
           wait_if_no_active_request(wait_if_no_active_request),
@@ -320,7 +356,8 @@ class RunHandlerThreadPool {
           enable_wake_up(enable_wake_up),
           max_concurrent_handler(max_concurrent_handler),
           num_threads_in_sub_thread_pool(num_threads_in_sub_thread_pool),
-          sub_thread_request_percentage(sub_thread_request_percentage) {}
+          sub_thread_request_percentage(sub_thread_request_percentage),
+          use_work_stealing(use_work_stealing) {}
   };
   struct PerThread {
     constexpr PerThread() : pool(nullptr), thread_id(-1) {}
@@ -357,6 +394,8 @@ class RunHandlerThreadPool {
 
   int NumNonBlockingThreads() const;
 
+  bool UseWorkStealing() const;
+
   void WorkerLoop(int thread_id, bool may_steal_blocking_work);
 
   // Search tasks from Requets range searching_range_start to
@@ -369,6 +408,21 @@ class RunHandlerThreadPool {
       const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
       bool* task_from_blocking_queue, ThreadWorkSource** tws);
 
+  // Pops a task from the local queues of the blocking thread 'thread_id',
+  // searching requests in priority order.
+  Task FindLocalTask(
+      int thread_id, int max_blocking_inflight,
+      const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
+      ThreadWorkSource** tws);
+
+  // Steals a task from the local queues of the other blocking threads. The
+  // requests are split into strata of equal priority, and each stratum is
+  // tried in priority order by picking random requests and threads in it.
+  Task StealTask(
+      int thread_id, int max_blocking_inflight,
+      const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
+      ThreadWorkSource** tws);
+
   void WaitForWorkInSubThreadPool(int thread_id, bool is_blocking,
                                   int sub_thread_pool_id);
 
@@ -389,6 +443,10 @@ class RunHandlerThreadPool {
         current_thread_work_sources;
 
     int sub_thread_pool_id;
+
+    // State of the random number generator used to pick the victims of work
+    // stealing. Should only be accessed by one thread.
+    uint64_t steal_rng_state;
   };
 
   const int num_threads_;
@@ -399,6 +457,7 @@ class RunHandlerThreadPool {
   const int non_blocking_thread_sleep_time_;
   const int blocking_thread_max_waiting_time_;
   const bool enable_wake_up_;
+  const bool use_work_stealing_;
   Eigen::MaxSizeVector<ThreadData> thread_data_;
   internal::RunHandlerEnvironment env_;
   std::atomic<bool> cancelled_;
@@ -56,6 +56,7 @@ RunHandlerThreadWorkQueue::RunHandlerThreadWorkQueue(const Options& options)
   pool_options.enable_wake_up = options.enable_wake_up;
   pool_options.wait_if_no_active_request = options.wait_if_no_active_request;
   pool_options.use_adaptive_waiting_time = options.use_adaptive_waiting_time;
+  pool_options.use_work_stealing = options.use_work_stealing;
   handler_pool_ = std::make_unique<RunHandlerPool>(pool_options);
 }
 
@@ -126,7 +127,8 @@ std::ostream& operator<<(std::ostream& strm,
               << options.use_adaptive_waiting_time
               << ", wait_if_no_active_request = "
               << options.wait_if_no_active_request
-              << ", enable_wake_up = " << options.enable_wake_up << "}";
+              << ", enable_wake_up = " << options.enable_wake_up
+              << ", use_work_stealing = " << options.use_work_stealing << "}";
 }
 
 }  // namespace tf
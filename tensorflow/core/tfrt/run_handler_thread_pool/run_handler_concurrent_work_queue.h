@@ -79,6 +79,10 @@ class RunHandlerThreadWorkQueue
 
     // If true, threads will be waken up by new tasks.
     bool enable_wake_up = true;
+
+    // If true, main threads queue the tasks they schedule to their own queues
+    // and steal work from each other. See `RunHandlerPool::Options`.
+    bool use_work_stealing = false;
   };
 
   explicit RunHandlerThreadWorkQueue(const Options& options);
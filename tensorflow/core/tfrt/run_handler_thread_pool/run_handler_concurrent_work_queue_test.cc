@@ -14,17 +14,25 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/tfrt/run_handler_thread_pool/run_handler_concurrent_work_queue.h"
 
+#include <atomic>
+#include <cstdint>
 #include <cstdio>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include <gtest/gtest.h>
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/blocking_counter.h"
 #include "absl/time/time.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/histogram/histogram.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 #include "tfrt/host_context/concurrent_work_queue.h"  // from @tf_runtime
 #include "tfrt/host_context/diagnostic.h"  // from @tf_runtime
@@ -161,6 +169,32 @@ TEST_F(RunHandlerThreadWorkQueueTest, RunningMixedTask) {
   EXPECT_EQ(n, 20);
 }
 
+TEST(RunHandlerThreadWorkQueueWorkStealingTest, RunningNestedTasks) {
+  RunHandlerThreadWorkQueue::Options options;
+  options.num_complementary_threads = 1;
+  options.num_main_threads = 4;
+  options.init_timeout_ms = 100;
+  options.use_work_stealing = true;
+  RunHandlerThreadWorkQueue pool(options);
+  auto queue = pool.InitializeRequest(/*request_id=*/100);
+  TF_ASSERT_OK(queue.status());
+
+  // The nested tasks are queued to the local queues of the main threads, and
+  // more than fit in them to also exercise the shared queue.
+  std::atomic<int> n = 0;
+  tensorflow::tfrt_stub::WorkQueueInterface* request_queue = queue->get();
+  for (int i = 0; i < 10; ++i) {
+    request_queue->AddTask(TaskFunction([&n, request_queue] {
+      for (int j = 0; j < 100; ++j) {
+        request_queue->AddTask(TaskFunction([&n] { ++n; }));
+      }
+      ++n;
+    }));
+  }
+  pool.Quiesce();
+  EXPECT_EQ(n, 1010);
+}
+
 TEST_F(RunHandlerThreadWorkQueueTest, NameReturnsValidString) {
   EXPECT_TRUE(absl::StrContains(pool_->name(), "RunHandlerThreadWorkQueue"));
 }
@@ -189,6 +223,75 @@ TEST_F(RunHandlerThreadWorkQueueTest, NoHandlerReturnsError) {
           "Could not obtain RunHandler for request after waiting for 1 ms."));
 }
 
+// Runs `kNumConcurrentRequests` requests at once, each fanning out to
+// `kNumTasksPerRequest` small inter-op tasks from a main thread, and reports
+// the 99th percentile of the request latencies.
+void BM_ConcurrentRequestsP99Latency(::testing::benchmark::State& state) {
+  constexpr int kNumConcurrentRequests = 1000;
+  constexpr int kNumTasksPerRequest = 16;
+
+  RunHandlerThreadWorkQueue::Options options;
+  options.num_main_threads = 8;
+  options.num_complementary_threads = 2;
+  options.init_timeout_ms = 10000;
+  options.max_concurrent_handler = kNumConcurrentRequests;
+  options.use_work_stealing = state.range(0);
+  RunHandlerThreadWorkQueue pool(options);
+
+  struct Request {
+    std::unique_ptr<tensorflow::tfrt_stub::WorkQueueInterface> queue;
+    uint64_t start_us;
+    uint64_t end_us;
+    std::atomic<int> remaining_tasks;
+  };
+  tensorflow::histogram::Histogram latencies_us;
+  tensorflow::Env* env = tensorflow::Env::Default();
+  for (auto s : state) {
+    state.PauseTiming();
+    std::vector<Request> requests(kNumConcurrentRequests);
+    for (int i = 0; i < kNumConcurrentRequests; ++i) {
+      auto queue = pool.InitializeRequest(/*request_id=*/i);
+      TF_CHECK_OK(queue.status());
+      requests[i].queue = *std::move(queue);
+      requests[i].remaining_tasks = kNumTasksPerRequest;
+    }
+    state.ResumeTiming();
+
+    absl::BlockingCounter done(kNumConcurrentRequests);
+    for (Request& request : requests) {
+      request.start_us = env->NowMicros();
+      request.queue->AddTask(TaskFunction([&request, &done, env] {
+        for (int i = 0; i < kNumTasksPerRequest; ++i) {
+          request.queue->AddTask(TaskFunction([&request, &done, env] {
+            uint64_t sum = 0;
+            for (int j = 0; j < 1000; ++j) sum += j * request.start_us;
+            tensorflow::testing::DoNotOptimize(sum);
+            if (--request.remaining_tasks == 0) {
+              request.end_us = env->NowMicros();
+              done.DecrementCount();
+            }
+          }));
+        }
+      }));
+    }
+    done.Wait();
+
+    state.PauseTiming();
+    for (const Request& request : requests) {
+      latencies_us.Add(request.end_us - request.start_us);
+    }
+    pool.Quiesce();
+    requests.clear();
+    state.ResumeTiming();
+  }
+  state.SetLabel(absl::StrCat("p99_latency_us=", latencies_us.Percentile(99),
+                              " p50_latency_us=", latencies_us.Median()));
+}
+BENCHMARK(BM_ConcurrentRequestsP99Latency)
+    ->ArgName("work_stealing")
+    ->Arg(0)
+    ->Arg(1);
+
 }  // namespace
 }  // namespace tf
 }  // namespace tfrt
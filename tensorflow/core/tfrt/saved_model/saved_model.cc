@@ -26,7 +26,6 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
-#include "absl/cleanup/cleanup.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
@@ -62,6 +61,7 @@ limitations under the License.
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/runtime_fallback/kernel/kernel_fallback_compat_request_state.h"
@@ -119,6 +119,22 @@ auto* saved_model_init_time_seconds =
         "/tensorflow/tfrt/saved_model/init_time",
         "Record the initialization time for the savedmodel.", "model_name");
 
+// The labels are the model, the signature(s) (empty for the loading of the
+// whole model) and the phase: "import", "compile", "init" or "total".
+auto* saved_model_load_time_breakdown_ms =
+    tensorflow::monitoring::Gauge<int64_t, 3>::New(
+        "/tensorflow/tfrt/saved_model/load_time_breakdown",
+        "Record the loading time in milliseconds for the savedmodel and its "
+        "signatures, per phase.",
+        "model_name", "signature", "phase");
+
+void RecordLoadTime(const std::string& model_name,
+                    const std::string& signature, const std::string& phase,
+                    absl::Duration duration) {
+  saved_model_load_time_breakdown_ms->GetCell(model_name, signature, phase)
+      ->Set(absl::ToInt64Milliseconds(duration));
+}
+
 // TODO(b/279197040) clean up this retention after input spec validation is
 // enabled everywhere.
 auto* saved_model_input_spec_validation_failure =
@@ -421,6 +437,29 @@ void GetDefaultInputValue(
   GetDefaultInputsFromModelConfig(context, signatures);
 }
 
+// Removes the signatures that are not in `allowlist` from `meta_graph_def`.
+absl::Status KeepAllowlistedSignatures(
+    absl::Span<const std::string> allowlist,
+    tensorflow::MetaGraphDef& meta_graph_def) {
+  auto& signature_defs = *meta_graph_def.mutable_signature_def();
+  for (const std::string& name : allowlist) {
+    if (!signature_defs.contains(name)) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Allowlisted signature ", name, " is not in the SavedModel."));
+    }
+  }
+  const absl::flat_hash_set<std::string> allowed(allowlist.begin(),
+                                                 allowlist.end());
+  for (auto it = signature_defs.begin(); it != signature_defs.end();) {
+    if (allowed.contains(it->first)) {
+      ++it;
+    } else {
+      it = signature_defs.erase(it);
+    }
+  }
+  return absl::OkStatus();
+}
+
 void UpdateCompileOptions(SavedModel::Options& options) {
   // Disable DecomposeResourceOpsPass for now, as DecomposeResourceGather does
   // not work well with GPU (b/232819415).
@@ -449,6 +488,7 @@ absl::StatusOr<std::unique_ptr<SavedModel>> SavedModelImpl::LoadSavedModel(
     Options options, tensorflow::MetaGraphDef meta_graph_def,
     absl::string_view saved_model_dir) {
   LOG(INFO) << "TFRT loading v1 savedmodel: " << saved_model_dir;
+  const auto load_start_time = absl::Now();
 
   if (options.graph_execution_options.use_ifrt) {
     if (!options.graph_execution_options.enable_mlrt ||
@@ -459,6 +499,11 @@ absl::StatusOr<std::unique_ptr<SavedModel>> SavedModelImpl::LoadSavedModel(
     }
   }
 
+  if (!options.signature_allowlist.empty()) {
+    TF_RETURN_IF_ERROR(
+        KeepAllowlistedSignatures(options.signature_allowlist, meta_graph_def));
+  }
+
   tfrt::metrics::AddTFRTVersionMetric();
 
   UpdateTpuTargetByBridgeCompatibility(options.graph_execution_options,
@@ -539,6 +584,8 @@ absl::StatusOr<std::unique_ptr<SavedModel>> SavedModelImpl::LoadSavedModel(
   const auto import_duration = absl::Now() - import_start_time;
   saved_model_import_time_seconds->GetCell(saved_model_dir_string)
       ->Set(absl::ToInt64Seconds(import_duration));
+  RecordLoadTime(saved_model_dir_string, /*signature=*/"", "import",
+                 import_duration);
   LOG(INFO) << "TFRT finished importing savedmodel. Took "
             << absl::ToInt64Milliseconds(import_duration) << " ms.";
 
@@ -647,6 +694,8 @@ absl::StatusOr<std::unique_ptr<SavedModel>> SavedModelImpl::LoadSavedModel(
   const auto compile_duration = absl::Now() - compile_start_time;
   saved_model_compile_time_seconds->GetCell(saved_model_dir_string)
       ->Set(absl::ToInt64Seconds(compile_duration));
+  RecordLoadTime(saved_model_dir_string, /*signature=*/"", "compile",
+                 compile_duration);
   LOG(INFO) << "TFRT finished compiling savedmodel. Took "
             << absl::ToInt64Milliseconds(compile_duration) << " ms.";
 
@@ -685,6 +734,8 @@ absl::StatusOr<std::unique_ptr<SavedModel>> SavedModelImpl::LoadSavedModel(
   const auto init_duration = absl::Now() - init_start_time;
   saved_model_init_time_seconds->GetCell(saved_model_dir_string)
       ->Set(absl::ToInt64Seconds(init_duration));
+  RecordLoadTime(saved_model_dir_string, /*signature=*/"", "init",
+                 init_duration);
   LOG(INFO) << "TFRT finished initializing savedmodel. Took "
             << absl::ToInt64Milliseconds(init_duration) << " ms.";
 
@@ -701,14 +752,26 @@ absl::StatusOr<std::unique_ptr<SavedModel>> SavedModelImpl::LoadSavedModel(
               << persistent_cache_directory << ", and set it to read-only.";
   }
 
+  const int num_signature_preload_threads =
+      options.enable_lazy_loading && !options.lazy_loading_use_graph_executor
+          ? options.num_signature_preload_threads
+          : 0;
+
   // Finally, create the saved model.
-  return {std::make_unique<SavedModelImpl>(
+  auto saved_model = std::make_unique<SavedModelImpl>(
       std::move(options), std::move(symbol_uids), std::move(meta_graph_def),
       std::move(bef), std::move(bef_file), std::move(bytecode),
       std::move(loaded_executable),
       std::move(initializers_and_signatures.signature_map),
       std::move(runner_table), std::move(resource_array),
-      std::move(graph_executor))};
+      std::move(graph_executor));
+  if (num_signature_preload_threads > 0) {
+    TF_RETURN_IF_ERROR(
+        saved_model->PreloadSignatures(num_signature_preload_threads));
+  }
+  RecordLoadTime(saved_model_dir_string, /*signature=*/"", "total",
+                 absl::Now() - load_start_time);
+  return {std::move(saved_model)};
 }
 
 SavedModelImpl::SavedModelImpl(
@@ -1047,9 +1110,13 @@ absl::StatusOr<JoinedSignature> JoinSignatures(
 }  // namespace
 
 // TODO(b/216379787): Reuse `GraphExecutor::LoadClientGraph()`.
-absl::StatusOr<std::reference_wrapper<const SavedModelImpl::LoadingResult>>
+absl::StatusOr<std::unique_ptr<SavedModelImpl::LoadingResult>>
 SavedModelImpl::LoadJoinedSignature(const JoinedSignature& joined_signature) {
+  const std::string& model_name =
+      options_.graph_execution_options.compile_options.saved_model_dir;
+
   // Step 1: Import the combined subgraph from proto to an MLIR module.
+  const auto import_start_time = absl::Now();
   mlir::DialectRegistry registry;
   RegisterMlirDialect(
       registry, graph_executor_->options().compile_options.backend_compiler);
@@ -1063,8 +1130,11 @@ SavedModelImpl::LoadJoinedSignature(const JoinedSignature& joined_signature) {
   // TODO(b/278143179): Upload module w/o control flow.
   SymbolUids symbol_uids;
   symbol_uids.tf_symbol_uid = MaybeUploadMlirToXsymbol(module.get());
+  RecordLoadTime(model_name, joined_signature.name, "import",
+                 absl::Now() - import_start_time);
 
   // Step 2: Compile the MLIR module from TF dialect to TFRT dialect (in BEF).
+  const auto compile_start_time = absl::Now();
   auto loading_result = std::make_unique<LoadingResult>();
   loading_result->name = joined_signature.name;
   loading_result->runner_table = std::make_unique<OpKernelRunnerTable>();
@@ -1077,6 +1147,7 @@ SavedModelImpl::LoadJoinedSignature(const JoinedSignature& joined_signature) {
       options_.graph_execution_options.compile_options.saved_model_dir,
       &graph_executor_->resource_context());
 
+  absl::Time init_start_time;
   if (options_.graph_execution_options.enable_mlrt) {
     ASSIGN_OR_RETURN_IN_COMPILE(
         loading_result->bytecode_buffer,
@@ -1087,6 +1158,9 @@ SavedModelImpl::LoadJoinedSignature(const JoinedSignature& joined_signature) {
     loading_result->bytecode_executable =
         std::make_unique<mlrt::LoadedExecutable>(
             executable, graph_executor_->kernel_registry());
+    init_start_time = absl::Now();
+    RecordLoadTime(model_name, joined_signature.name, "compile",
+                   init_start_time - compile_start_time);
     RETURN_IF_ERROR_IN_INIT(RunBytecodeInitializers(
         graph_executor_->options(), /*initializers_and_signatures=*/{},
         *loading_result->bytecode_executable,
@@ -1102,6 +1176,9 @@ SavedModelImpl::LoadJoinedSignature(const JoinedSignature& joined_signature) {
         loading_result->bef_file,
         tfrt::CreateBefFileFromBefBuffer(
             *options_.graph_execution_options.runtime, loading_result->bef));
+    init_start_time = absl::Now();
+    RecordLoadTime(model_name, joined_signature.name, "compile",
+                   init_start_time - compile_start_time);
     RETURN_IF_ERROR_IN_INIT(RunBefInitializers(
         graph_executor_->options(),
         /*initializers_and_signatures=*/{}, loading_result->bef_file.get(),
@@ -1110,42 +1187,96 @@ SavedModelImpl::LoadJoinedSignature(const JoinedSignature& joined_signature) {
         loading_result->resource_array.get(), fallback_state(),
         /*provide_inputs false for JIT compilation*/ false));
   }
+  RecordLoadTime(model_name, joined_signature.name, "init",
+                 absl::Now() - init_start_time);
   symbol_uids.tfrt_symbol_uid = MaybeUploadMlirToXsymbol(module.get());
   loading_result->symbol_uids = std::move(symbol_uids);
-
-  // Store loading_result in cache.
-  const auto* loading_result_ptr = loading_result.get();
-  loading_result_cache_[joined_signature.name] = std::move(loading_result);
-  return {*loading_result_ptr};
+  return loading_result;
 }
 
 absl::StatusOr<std::reference_wrapper<const SavedModelImpl::LoadingResult>>
 SavedModelImpl::GetOrCreateLoadingResult(const RunOptions& run_options,
                                          absl::Span<const std::string> names) {
   const auto joined_name = absl::StrJoin(names, kSignatureJoiningDelimiter);
-  tensorflow::mutex_lock l(loading_result_cache_mu_);
-  const auto iter = loading_result_cache_.find(joined_name);
-  if (iter != loading_result_cache_.end()) return {*iter->second};
-
-  if (run_options.disable_compilation) {
-    return tensorflow::errors::InvalidArgument(
-        absl::StrCat("GraphExecutor: compilation is disabled in execution but "
-                     "the compiled graph is not found for ",
-                     joined_name));
+  std::shared_ptr<LoadingResultCacheEntry> entry;
+  {
+    tensorflow::mutex_lock l(loading_result_cache_mu_);
+    const auto iter = loading_result_cache_.find(joined_name);
+    if (iter != loading_result_cache_.end()) {
+      entry = iter->second;
+    } else {
+      if (run_options.disable_compilation) {
+        return tensorflow::errors::InvalidArgument(absl::StrCat(
+            "GraphExecutor: compilation is disabled in execution but "
+            "the compiled graph is not found for ",
+            joined_name));
+      }
+      // Loads the signatures without holding the lock, so that other
+      // signatures can be loaded at the same time.
+      loading_result_cache_[joined_name] =
+          std::make_shared<LoadingResultCacheEntry>();
+    }
+  }
+  if (entry != nullptr) {
+    entry->ready.WaitForNotification();
+    TF_RETURN_IF_ERROR(entry->status);
+    return {*entry->loading_result};
   }
 
-  TF_ASSIGN_OR_RETURN(
-      const auto joined_signature,
-      JoinSignatures(names, signatures_, meta_graph_def_.signature_def()));
-
-  LOG(INFO) << "TFRT loading joined signature " << joined_signature.name;
-  absl::Cleanup log_finish([&joined_signature, start_time = absl::Now()]() {
+  absl::StatusOr<std::unique_ptr<LoadingResult>> loading_result =
+      [&]() -> absl::StatusOr<std::unique_ptr<LoadingResult>> {
+    TF_ASSIGN_OR_RETURN(
+        const auto joined_signature,
+        JoinSignatures(names, signatures_, meta_graph_def_.signature_def()));
+
+    LOG(INFO) << "TFRT loading joined signature " << joined_signature.name;
+    const auto start_time = absl::Now();
+    TF_ASSIGN_OR_RETURN(auto loading_result,
+                        LoadJoinedSignature(joined_signature));
+    const auto duration = absl::Now() - start_time;
+    RecordLoadTime(
+        options_.graph_execution_options.compile_options.saved_model_dir,
+        joined_signature.name, "total", duration);
     LOG(INFO) << "TFRT finished loading joined signature "
               << joined_signature.name << ". Took "
-              << absl::ToInt64Milliseconds(absl::Now() - start_time) << " ms.";
-  });
+              << absl::ToInt64Milliseconds(duration) << " ms.";
+    return loading_result;
+  }();
+
+  tensorflow::mutex_lock l(loading_result_cache_mu_);
+  entry = loading_result_cache_.at(joined_name);
+  if (!loading_result.ok()) {
+    // Removes the entry so that the next call loads the signatures again.
+    entry->status = loading_result.status();
+    loading_result_cache_.erase(joined_name);
+    entry->ready.Notify();
+    return entry->status;
+  }
+  entry->loading_result = *std::move(loading_result);
+  entry->ready.Notify();
+  return {*entry->loading_result};
+}
 
-  return LoadJoinedSignature(joined_signature);
+absl::Status SavedModelImpl::PreloadSignatures(int num_threads) {
+  if (signatures_.empty()) return absl::OkStatus();
+
+  tensorflow::mutex mu;
+  absl::Status status;
+  {
+    tensorflow::thread::ThreadPool thread_pool(
+        tensorflow::Env::Default(), "tfrt_preload_signatures",
+        std::min<int>(num_threads, signatures_.size()));
+    for (const auto& [name, signature] : signatures_) {
+      thread_pool.Schedule([&, name = name]() {
+        auto loading_result =
+            GetOrCreateLoadingResult(/*run_options=*/{}, {name});
+        tensorflow::mutex_lock l(mu);
+        status.Update(loading_result.status());
+      });
+    }
+    // The destructor of `thread_pool` waits for the loadings.
+  }
+  return status;
 }
 
 }  // namespace tfrt_stub
@@ -26,7 +26,9 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/notification.h"
 #include "absl/types/span.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
@@ -110,6 +112,19 @@ class SavedModel {
     // True if and only if SavedModel is being loaded to generate AOT results.
     bool aot_generation = false;
 
+    // If positive and lazy loading is enabled without
+    // `lazy_loading_use_graph_executor`, all the signatures are loaded at the
+    // end of the model loading, this many at a time, instead of at their first
+    // run.
+    int num_signature_preload_threads = 0;
+
+    // If non-empty, only the signatures with these names are kept, and the
+    // others are removed from the MetaGraphDef before anything is imported or
+    // compiled, so that they take neither load time nor memory. Together with
+    // lazy loading, each kept signature is still compiled and initialized on
+    // its first run, and only then the nodes it reaches are imported.
+    std::vector<std::string> signature_allowlist;
+
     GraphExecutionOptions graph_execution_options;
   };
 
@@ -289,17 +304,32 @@ class SavedModelImpl final : public SavedModel {
       const std::vector<std::string>& output_nodes,
       const std::vector<std::string>& target_nodes);
 
+  // A `LoadingResult` in `loading_result_cache_`, which is being loaded until
+  // `ready` is notified.
+  struct LoadingResultCacheEntry {
+    absl::Notification ready;
+    // Only valid after `ready` is notified.
+    absl::Status status;
+    std::unique_ptr<LoadingResult> loading_result;
+  };
+
   // Given the joined signature, loads the subgraph and returns loading result.
-  absl::StatusOr<std::reference_wrapper<const SavedModelImpl::LoadingResult>>
-  LoadJoinedSignature(const JoinedSignature& joined_signature)
-      TF_EXCLUSIVE_LOCKS_REQUIRED(loading_result_cache_mu_);
+  absl::StatusOr<std::unique_ptr<SavedModelImpl::LoadingResult>>
+  LoadJoinedSignature(const JoinedSignature& joined_signature);
 
-  // Returns the loading result given the signature names.
+  // Returns the loading result given the signature names. Different signatures
+  // are loaded concurrently, while the concurrent calls for the same signatures
+  // wait for a single loading.
   absl::StatusOr<std::reference_wrapper<const SavedModelImpl::LoadingResult>>
   GetOrCreateLoadingResult(const RunOptions& run_options,
                            absl::Span<const std::string> names)
       TF_LOCKS_EXCLUDED(loading_result_cache_mu_);
 
+  // Loads each signature on `num_threads` threads. See
+  // `Options::num_signature_preload_threads`.
+  absl::Status PreloadSignatures(int num_threads)
+      TF_LOCKS_EXCLUDED(loading_result_cache_mu_);
+
   SymbolUids symbol_uids_;
   // `meta_graph_def_` only contains metadata of the model. The graph_def field
   // is removed.
@@ -319,10 +349,10 @@ class SavedModelImpl final : public SavedModel {
   std::unique_ptr<OpKernelRunnerTable> runner_table_;
   std::unique_ptr<tfd::FallbackResourceArray> resource_array_;
   tensorflow::mutex loading_result_cache_mu_;
-  // For pointer stability of values in `absl::flat_hash_map<>`, additional
-  // `std::unique_ptr<>` is necessary. (See https://abseil.io/tips/136.)
+  // The entries are shared with the threads waiting for their loading, which
+  // still have them if a failed loading removes its entry.
   absl::flat_hash_map<std::string /*joined_name*/,
-                      std::unique_ptr<LoadingResult>>
+                      std::shared_ptr<LoadingResultCacheEntry>>
       loading_result_cache_ TF_GUARDED_BY(loading_result_cache_mu_);
 };
 
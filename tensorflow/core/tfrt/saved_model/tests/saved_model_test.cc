@@ -1071,6 +1071,76 @@ TEST(SavedModelTest, DisableCompilation) {
   TF_ASSERT_OK((*saved_model)->Run(run_options, "toy", inputs, &outputs));
 }
 
+TEST(SavedModelTest, PreloadSignatures) {
+  // SavedModel toy contains a graph of a single 'tf.AddV2' op. It is generated
+  // using the following python code:
+  //  x = tf.placeholder(tf.int32, shape=(3))
+  //  y = tf.compat.v1.get_variable(name='y', initializer=[1, 2, 3])
+  //  r = tf.matmul(x, y)
+  std::string saved_model_dir = tensorflow::GetDataDependencyFilepath(
+      "tensorflow/core/tfrt/saved_model/tests/toy_v1/1");
+
+  auto runtime = DefaultTfrtRuntime(/*num_threads=*/1);
+  auto options = DefaultSavedModelOptions(runtime.get());
+  options.enable_lazy_loading = true;
+  options.num_signature_preload_threads = 2;
+
+  auto saved_model = SavedModelImpl::LoadSavedModel(options, saved_model_dir,
+                                                    /*tags=*/{"serve"});
+  TF_CHECK_OK(saved_model.status());
+
+  // Set input 'x' to [[1, 1, 1]]
+  std::vector<tensorflow::Tensor> inputs;
+  inputs.push_back(
+      CreateTfTensor<int32_t>(/*shape=*/{1, 3}, /*data=*/{1, 1, 1}));
+
+  // The signature was loaded along with the model, so it runs without
+  // compilation.
+  tfrt::SavedModel::RunOptions run_options;
+  run_options.disable_compilation = true;
+
+  std::vector<tensorflow::Tensor> outputs;
+  TF_ASSERT_OK((*saved_model)->Run(run_options, "toy", inputs, &outputs));
+  ASSERT_EQ(outputs.size(), 1);
+
+  EXPECT_THAT(GetTfTensorData<int32_t>(outputs[0]),
+              ::testing::ElementsAreArray({6}));
+}
+
+TEST(SavedModelTest, SignatureAllowlist) {
+  std::string saved_model_dir = tensorflow::GetDataDependencyFilepath(
+      "tensorflow/core/tfrt/saved_model/tests/toy_v1/1");
+
+  auto runtime = DefaultTfrtRuntime(/*num_threads=*/1);
+  auto options = DefaultSavedModelOptions(runtime.get());
+  options.enable_lazy_loading = true;
+  options.signature_allowlist = {"toy"};
+
+  auto saved_model = SavedModelImpl::LoadSavedModel(options, saved_model_dir,
+                                                    /*tags=*/{"serve"});
+  TF_ASSERT_OK(saved_model.status());
+  EXPECT_THAT((*saved_model)->GetFunctionNames(),
+              ::testing::ElementsAre("toy"));
+
+  std::vector<tensorflow::Tensor> inputs;
+  inputs.push_back(
+      CreateTfTensor<int32_t>(/*shape=*/{1, 3}, /*data=*/{1, 1, 1}));
+  std::vector<tensorflow::Tensor> outputs;
+  TF_ASSERT_OK((*saved_model)->Run({}, "toy", inputs, &outputs));
+  ASSERT_EQ(outputs.size(), 1);
+  EXPECT_THAT(GetTfTensorData<int32_t>(outputs[0]),
+              ::testing::ElementsAreArray({6}));
+
+  EXPECT_FALSE((*saved_model)->Run({}, "another_toy", inputs, &outputs).ok());
+
+  options.signature_allowlist = {"missing"};
+  EXPECT_THAT(SavedModelImpl::LoadSavedModel(options, saved_model_dir,
+                                             /*tags=*/{"serve"})
+                  .status()
+                  .code(),
+              absl::StatusCode::kInvalidArgument);
+}
+
 TEST(SavedModelTest, CustomModelConfig) {
   // SavedModel toy contains a graph of a single 'tf.AddV2' op. It is generated
   // using the following python code:
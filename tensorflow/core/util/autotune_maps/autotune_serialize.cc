@@ -16,21 +16,37 @@ limitations under the License.
 // For Google-internal use only.
 #include "tensorflow/core/util/autotune_maps/autotune_serialize.h"
 
+#if !defined(PLATFORM_WINDOWS)
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif  // !defined(PLATFORM_WINDOWS)
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
 #include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "absl/base/call_once.h"
+#include "absl/strings/str_cat.h"
 #include "xla/status_macros.h"
 #include "xla/stream_executor/dnn.h"
 #include "xla/stream_executor/gpu/gpu_init.h"
 #include "xla/stream_executor/platform_manager.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/str_util.h"
 #include "tensorflow/core/util/activation_mode.h"
 #include "tensorflow/core/util/autotune_maps/autotune_map.pb.h"
 #include "tensorflow/core/util/autotune_maps/conv_autotune_maps.h"
 #include "tensorflow/core/util/autotune_maps/conv_parameters.h"
 #include "tensorflow/core/util/autotune_maps/conv_parameters.pb.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tsl/lib/strings/proto_serialization.h"
 #include "tsl/protobuf/dnn.pb.h"
 
@@ -43,6 +59,154 @@ using stream_executor::dnn::AlgorithmConfigProto;
 using stream_executor::dnn::AlgorithmDesc;
 using stream_executor::dnn::AlgorithmProto;
 
+// Returns the version of the DNN library used by the first GPU as
+// "major.minor.patch", or an empty string if it is unknown.
+std::string GetDnnVersion() {
+  auto platform = se::PlatformManager::PlatformWithName(se::GpuPlatformName());
+  if (!platform.ok() || (*platform)->VisibleDeviceCount() == 0) return "";
+  auto executor = (*platform)->ExecutorForDevice(0);
+  if (!executor.ok()) return "";
+  se::dnn::DnnSupport *dnn = (*executor)->AsDnn();
+  if (dnn == nullptr) return "";
+  auto version = dnn->GetVersion();
+  if (!version.ok()) return "";
+  return absl::StrCat(version->major_version(), ".", version->minor_version(),
+                      ".", version->patch());
+}
+
+// Adds the entries of `from` to `to`, replacing the entries of `to` with the
+// same key. Entries are sorted the same way as in ConvMapToProto.
+Status MergeConvMapProto(const ConvMapProto &from, ConvMapProto *to) {
+  std::map<string, ConvMapProto::Entry> sorted_map;
+  for (const ConvMapProto *m : {to, &from}) {
+    for (const ConvMapProto::Entry &kv : m->kv_pairs()) {
+      std::string serialized_params;
+      TF_RET_CHECK(
+          tsl::SerializeToStringDeterministic(kv.key(), &serialized_params));
+      sorted_map[std::move(serialized_params)] = kv;
+    }
+  }
+  to->clear_kv_pairs();
+  for (auto const &p : sorted_map) {
+    *to->add_kv_pairs() = p.second;
+  }
+  return absl::OkStatus();
+}
+
+// Returns the path of the autotune database, or an empty string if there is
+// none.
+std::string GetAutotuneDatabasePath() {
+  std::string path;
+  TF_CHECK_OK(ReadStringFromEnvVar("TF_AUTOTUNE_DATABASE", "", &path));
+  return path;
+}
+
+// Holds an exclusive advisory lock on "<path>.lock" while alive, so that the
+// processes sharing a database on the local file system merge their saves
+// instead of overwriting each other's. Other file systems have no such locks,
+// and concurrent saves to them may still drop the entries of one another.
+class ScopedDatabaseLock {
+ public:
+  explicit ScopedDatabaseLock(const std::string &path) {
+#if !defined(PLATFORM_WINDOWS)
+    StringPiece scheme, host, local_path;
+    io::ParseURI(path, &scheme, &host, &local_path);
+    if (!scheme.empty() && scheme != "file") return;
+    const std::string lock_path = absl::StrCat(local_path, ".lock");
+    fd_ = open(lock_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+      LOG(WARNING) << "Failed to open " << lock_path << ": "
+                   << strerror(errno);
+      return;
+    }
+    int result;
+    do {
+      result = flock(fd_, LOCK_EX);
+    } while (result != 0 && errno == EINTR);
+    if (result != 0) {
+      LOG(WARNING) << "Failed to lock " << lock_path << ": " << strerror(errno);
+      close(fd_);
+      fd_ = -1;
+    }
+#endif  // !defined(PLATFORM_WINDOWS)
+  }
+
+  ~ScopedDatabaseLock() {
+#if !defined(PLATFORM_WINDOWS)
+    if (fd_ >= 0) {
+      flock(fd_, LOCK_UN);
+      close(fd_);
+    }
+#endif  // !defined(PLATFORM_WINDOWS)
+  }
+
+ private:
+  int fd_ = -1;
+
+  ScopedDatabaseLock(const ScopedDatabaseLock &) = delete;
+  void operator=(const ScopedDatabaseLock &) = delete;
+};
+
+// Saves the autotune database in the background, so that the kernels adding
+// autotune results never wait for file I/O. The saves requested within
+// kSaveDelayMicros of each other are done as one, and a save still pending at
+// exit is done by an atexit handler.
+class AutotuneDatabaseSaver {
+ public:
+  static constexpr int64_t kSaveDelayMicros = 10 * 1000 * 1000;
+
+  static AutotuneDatabaseSaver *Get() {
+    static AutotuneDatabaseSaver *saver = new AutotuneDatabaseSaver();
+    return saver;
+  }
+
+  void ScheduleSave() {
+    mutex_lock lock(mu_);
+    if (thread_ == nullptr) {
+      thread_.reset(Env::Default()->StartThread(
+          ThreadOptions(), "autotune_database_saver", [this] { Run(); }));
+      std::atexit([] { Get()->SaveIfPending(); });
+    }
+    pending_ = true;
+    cv_.notify_one();
+  }
+
+  void SaveIfPending() {
+    {
+      mutex_lock lock(mu_);
+      if (!pending_) return;
+      pending_ = false;
+    }
+    const std::string path = GetAutotuneDatabasePath();
+    Status status = SaveAutotuneMapsToFile(path);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to save the autotune database at " << path
+                   << ": " << status;
+    }
+  }
+
+ private:
+  AutotuneDatabaseSaver() = default;
+
+  void Run() {
+    while (true) {
+      {
+        mutex_lock lock(mu_);
+        while (!pending_) cv_.wait(lock);
+      }
+      // Lets the results autotuned in the meantime join this save.
+      Env::Default()->SleepForMicroseconds(kSaveDelayMicros);
+      SaveIfPending();
+    }
+  }
+
+  mutex mu_;
+  condition_variable cv_;
+  bool pending_ TF_GUARDED_BY(mu_) = false;
+  // Never joined, since the saver lives until the process exits.
+  std::unique_ptr<Thread> thread_ TF_GUARDED_BY(mu_);
+};
+
 template <typename Op>
 StatusOr<ConvMapProto> ConvMapToProto(
     const AutotuneMap<ConvParameters, AutotuneEntry<Op>> &autotune_map) {
@@ -180,6 +344,7 @@ Status SerializeAutotuneMaps(std::string *output) {
                       ConvMapToProto(*ConvAutotuneMap::GetInstance()));
   TF_ASSIGN_OR_RETURN(*proto.mutable_fused_conv_map(),
                       ConvMapToProto(*FusedConvAutotuneMap::GetInstance()));
+  proto.set_dnn_version(GetDnnVersion());
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
   TF_RET_CHECK(tsl::SerializeToStringDeterministic(proto, output));
   return absl::OkStatus();
@@ -195,6 +360,15 @@ Status LoadSerializedAutotuneMaps(absl::string_view s) {
     return errors::InvalidArgument(
         "Failed to parse the autotune maps from string.");
   }
+  // Algorithms picked with another DNN library version may be slower, or not
+  // supported at all.
+  if (!proto.dnn_version().empty() && proto.dnn_version() != GetDnnVersion()) {
+    return errors::Aborted(
+        "Aborted because the loaded autotune results were produced with DNN "
+        "library version ",
+        proto.dnn_version(), ", but the runtime uses version ",
+        GetDnnVersion());
+  }
   TF_RETURN_IF_ERROR(
       PopulateConvMap(proto.conv_map(), ConvAutotuneMap::GetInstance()));
   TF_RETURN_IF_ERROR(PopulateConvMap(proto.fused_conv_map(),
@@ -204,6 +378,93 @@ Status LoadSerializedAutotuneMaps(absl::string_view s) {
   return absl::OkStatus();
 }
 
+Status LoadAutotuneMapsFromFile(const std::string &path) {
+  Env *env = Env::Default();
+  if (!env->FileExists(path).ok()) {
+    VLOG(1) << "No autotune database at " << path;
+    return absl::OkStatus();
+  }
+  std::string serialized;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, path, &serialized));
+  return LoadSerializedAutotuneMaps(serialized);
+}
+
+Status SaveAutotuneMapsToFile(const std::string &path) {
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  // Serializes the saves of this process, and those of the other processes
+  // sharing the file if it is local.
+  static mutex *save_mu = new mutex();
+  mutex_lock lock(*save_mu);
+  ScopedDatabaseLock database_lock(path);
+
+  AutotuneMapsProto proto;
+  {
+    std::string serialized;
+    TF_RETURN_IF_ERROR(SerializeAutotuneMaps(&serialized));
+    if (!proto.ParseFromString(serialized)) {
+      return errors::Internal("Failed to parse the serialized autotune maps.");
+    }
+  }
+
+  Env *env = Env::Default();
+  if (env->FileExists(path).ok()) {
+    std::string serialized;
+    AutotuneMapsProto existing;
+    if (ReadFileToString(env, path, &serialized).ok() &&
+        existing.ParseFromString(serialized) &&
+        existing.dnn_version() == proto.dnn_version()) {
+      TF_RETURN_IF_ERROR(
+          MergeConvMapProto(proto.conv_map(), existing.mutable_conv_map()));
+      TF_RETURN_IF_ERROR(MergeConvMapProto(proto.fused_conv_map(),
+                                           existing.mutable_fused_conv_map()));
+      proto = std::move(existing);
+    } else {
+      LOG(WARNING) << "Replacing the incompatible autotune database at "
+                   << path;
+    }
+  }
+
+  std::string serialized;
+  TF_RET_CHECK(tsl::SerializeToStringDeterministic(proto, &serialized));
+  // Write to a temporary file next to `path` and rename it, which replaces
+  // the database atomically on local and most distributed file systems.
+  std::string tmp_path = absl::StrCat(path, ".");
+  if (!env->CreateUniqueFileName(&tmp_path, ".tmp")) {
+    return errors::Internal("Failed to create a temporary file name for ",
+                            path);
+  }
+  Status status = WriteStringToFile(env, tmp_path, serialized);
+  if (status.ok()) status = env->RenameFile(tmp_path, path);
+  if (!status.ok()) {
+    env->DeleteFile(tmp_path).IgnoreError();
+    return status;
+  }
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  return absl::OkStatus();
+}
+
+void MaybeLoadAutotuneDatabase() {
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  static absl::once_flag once;
+  absl::call_once(once, [] {
+    const std::string path = GetAutotuneDatabasePath();
+    if (path.empty()) return;
+    Status status = LoadAutotuneMapsFromFile(path);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to load the autotune database at " << path
+                   << ": " << status;
+    }
+  });
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+}
+
+void MaybeSaveAutotuneDatabase() {
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  if (GetAutotuneDatabasePath().empty()) return;
+  AutotuneDatabaseSaver::Get()->ScheduleSave();
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+}
+
 void ResetAutotuneMaps() {
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
   ConvAutotuneMap::GetInstance()->ClearMap();
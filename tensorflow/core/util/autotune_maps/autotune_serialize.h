@@ -18,7 +18,8 @@ limitations under the License.
 // Supports serializing the autotune maps to string
 // (SerializeAutotuneMaps), as well as deserializing them from
 // string and injecting them into TF runtime
-// (LoadSerializedAutotuneMaps).
+// (LoadSerializedAutotuneMaps). The maps can also be persisted to a file
+// shared across restarts (SaveAutotuneMapsToFile, LoadAutotuneMapsFromFile).
 //
 // Aims to speed up the warmup time of neural nets.
 
@@ -40,6 +41,29 @@ Status LoadSerializedAutotuneMaps(absl::string_view s);
 // LoadSerializedAutotuneMaps.
 Status SerializeAutotuneMaps(std::string* output);
 
+// Loads the autotune maps from the file at `path` written by
+// SaveAutotuneMapsToFile. A missing file is not an error, so the first process
+// using a new database starts with empty maps.
+Status LoadAutotuneMapsFromFile(const std::string& path);
+
+// Merges all the autotune maps into the file at `path`. Entries of the file
+// that the runtime maps don't have are kept, unless the file was written with
+// another DNN library version. The file is replaced atomically, so processes
+// sharing it never read a partially written database. On the local file
+// system, the read, merge and write hold a lock on "<path>.lock", so that
+// concurrent saves from several processes keep all their entries.
+Status SaveAutotuneMapsToFile(const std::string& path);
+
+// Loads the autotune database named by the TF_AUTOTUNE_DATABASE environment
+// variable, if it is set. Only the first call loads it.
+void MaybeLoadAutotuneDatabase();
+
+// Schedules a save of the autotune maps to the autotune database named by the
+// TF_AUTOTUNE_DATABASE environment variable, if it is set. Returns without
+// waiting for it: the save is done by a background thread, which combines the
+// saves requested within a few seconds of each other, or at exit.
+void MaybeSaveAutotuneDatabase();
+
 // Resets all autotune maps. For test use only.
 void ResetAutotuneMaps();
 
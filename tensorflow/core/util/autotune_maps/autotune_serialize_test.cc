@@ -22,6 +22,9 @@ limitations under the License.
 #include "xla/stream_executor/gpu/gpu_init.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/util/autotune_maps/autotune_map.pb.h"
 #include "tensorflow/core/util/autotune_maps/conv_autotune_maps.h"
 #include "tensorflow/core/util/autotune_maps/conv_parameters.h"
 #include "tensorflow/core/util/autotune_maps/conv_parameters.pb.h"
@@ -181,6 +184,87 @@ TEST(AutotuneSerializeTest, VersionControl) {
                HasSubstr("Aborted because the loaded autotune results")));
   EXPECT_EQ(ConvAutotuneMap::GetInstance()->GetMap().size(), 0);
 }
+
+// Tests that LoadSerializedAutotuneMaps rejects autotune results produced with
+// another DNN library version.
+TEST(AutotuneSerializeTest, DnnVersionControl) {
+  TF_CHECK_OK(GpuDriver::Init());
+  ResetAutotuneMaps();
+  std::string serialized_string;
+  TF_CHECK_OK(SerializeAutotuneMaps(&serialized_string));
+  AutotuneMapsProto proto;
+  ASSERT_TRUE(proto.ParseFromString(serialized_string));
+  EXPECT_FALSE(proto.dnn_version().empty());
+
+  proto.set_dnn_version("0.0.0");
+  EXPECT_THAT(
+      LoadSerializedAutotuneMaps(proto.SerializeAsString()),
+      StatusIs(error::ABORTED,
+               HasSubstr("Aborted because the loaded autotune results")));
+}
+
+// Tests that SaveAutotuneMapsToFile merges the runtime autotune maps into the
+// ones already in the file, and that LoadAutotuneMapsFromFile loads them all.
+TEST(AutotuneSerializeTest, File) {
+  TF_CHECK_OK(GpuDriver::Init());
+  ResetAutotuneMaps();
+  const std::string path =
+      io::JoinPath(testing::TmpDir(), "autotune_serialize_test_file");
+  Env::Default()->DeleteFile(path).IgnoreError();
+
+  // A missing file leaves the autotune maps empty.
+  TF_CHECK_OK(LoadAutotuneMapsFromFile(path));
+  EXPECT_EQ(ConvAutotuneMap::GetInstance()->GetMap().size(), 0);
+
+  ConvParameters conv_params_example_a = {
+      GetStreamExec(),
+      /*batch=*/1,
+      /*in_depths=*/1,
+      /*in=*/{{1, 1}},
+      /*data_format=*/TensorFormat::FORMAT_NCHW,
+      /*out_depths=*/1,
+      /*filter=*/{{1, 1}},
+      /*dilation=*/{{1, 1}},
+      /*stride=*/{{1, 1}},
+      /*padding=*/{{1, 1}},
+      /*dtype=*/DataType::DT_INT8,
+      /*group_count=*/1};
+  ConvParameters conv_params_example_b = {
+      GetStreamExec(),
+      /*batch=*/2,
+      /*in_depths=*/1,
+      /*in=*/{{1, 1}},
+      /*data_format=*/TensorFormat::FORMAT_NCHW,
+      /*out_depths=*/1,
+      /*filter=*/{{1, 1}},
+      /*dilation=*/{{1, 1}},
+      /*stride=*/{{1, 1}},
+      /*padding=*/{{1, 1}},
+      /*dtype=*/DataType::DT_INT8,
+      /*group_count=*/1};
+  AlgorithmDesc algorithm_a(/*algo_id=*/1, /*use_tensor_ops=*/true);
+  AlgorithmDesc algorithm_b(/*algo_id=*/2, /*use_tensor_ops=*/false);
+  AutotuneEntry<se::dnn::ConvOp> example_a(algorithm_a, algorithm_a);
+  AutotuneEntry<se::dnn::ConvOp> example_b(algorithm_b, algorithm_b);
+
+  // Each save adds the entries of a process that autotuned one convolution.
+  ConvAutotuneMap::GetInstance()->Insert(conv_params_example_a, example_a);
+  TF_CHECK_OK(SaveAutotuneMapsToFile(path));
+  ResetAutotuneMaps();
+  ConvAutotuneMap::GetInstance()->Insert(conv_params_example_b, example_b);
+  TF_CHECK_OK(SaveAutotuneMapsToFile(path));
+  ResetAutotuneMaps();
+
+  TF_CHECK_OK(LoadAutotuneMapsFromFile(path));
+  EXPECT_EQ(ConvAutotuneMap::GetInstance()->GetMap().size(), 2);
+  AutotuneEntry<se::dnn::ConvOp> entry;
+  EXPECT_TRUE(
+      ConvAutotuneMap::GetInstance()->Find(conv_params_example_a, &entry));
+  EXPECT_EQ(entry, example_a);
+  EXPECT_TRUE(
+      ConvAutotuneMap::GetInstance()->Find(conv_params_example_b, &entry));
+  EXPECT_EQ(entry, example_b);
+}
 }  // namespace
 }  // namespace tensorflow
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -15,12 +15,14 @@ limitations under the License.
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
 #include <algorithm>
+#include <cstring>
 #include <functional>
 #include <optional>
 #include <utility>
 #include <vector>
 
 #include "absl/base/casts.h"
+#include "absl/numeric/bits.h"
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
@@ -117,6 +119,62 @@ constexpr uint8 kVarintTag(uint32 tag) { return (tag << 3) | 0; }
 constexpr uint8 kDelimitedTag(uint32 tag) { return (tag << 3) | 2; }
 constexpr uint8 kFixed32Tag(uint32 tag) { return (tag << 3) | 5; }
 
+// Returns the number of varints in the packed field [begin, end), which is the
+// number of bytes without the continuation bit, or -1 if the last varint is
+// truncated.
+inline int64_t CountPackedVarints(const uint8* begin, const uint8* end) {
+  if (begin == end) return 0;
+  if (end[-1] & 0x80) return -1;
+  constexpr uint64 kContinuationBits = 0x8080808080808080ULL;
+  int64_t count = 0;
+  const uint8* p = begin;
+  for (; end - p >= 8; p += 8) {
+    uint64 word;
+    std::memcpy(&word, p, sizeof(word));
+    count += 8 - absl::popcount(word & kContinuationBits);
+  }
+  for (; p < end; ++p) count += (*p & 0x80) == 0;
+  return count;
+}
+
+// Decodes the packed varints in [begin, end) into the elements of "out"
+// starting at "out_begin", dropping the elements at or beyond "out_end".
+// Eight single-byte varints, the common case for small ids and counts, are
+// decoded at a time. Returns false on a malformed varint.
+inline bool DecodePackedVarints(const uint8* begin, const uint8* end,
+                                int64_t* out_begin, int64_t* out_end) {
+  constexpr uint64 kContinuationBits = 0x8080808080808080ULL;
+  const uint8* p = begin;
+  int64_t* out = out_begin;
+  while (p < end) {
+    if (port::kLittleEndian && end - p >= 8 && out_end - out >= 8) {
+      uint64 word;
+      std::memcpy(&word, p, sizeof(word));
+      if ((word & kContinuationBits) == 0) {
+        for (int i = 0; i < 8; ++i) {
+          out[i] = static_cast<int64_t>((word >> (8 * i)) & 0xff);
+        }
+        p += 8;
+        out += 8;
+        continue;
+      }
+    }
+    // Like CodedInputStream::ReadVarint64(), accepts at most 10 bytes.
+    uint64 value = 0;
+    int shift = 0;
+    uint8 byte;
+    do {
+      if (p == end || shift > 63) return false;
+      byte = *p++;
+      value |= static_cast<uint64>(byte & 0x7f) << shift;
+      shift += 7;
+    } while (byte & 0x80);
+    if (out < out_end) *out = static_cast<int64_t>(value);
+    ++out;
+  }
+  return true;
+}
+
 namespace parsed {
 
 // ParseDataType has to be called first, then appropriate ParseZzzzList.
@@ -303,15 +361,31 @@ class Feature {
         if (!stream.ExpectTag(kDelimitedTag(1))) return false;  // packed tag
         uint32 packed_length;
         if (!stream.ReadVarint32(&packed_length)) return false;
-        auto packed_limit = stream.PushLimit(packed_length);
-
-        while (!stream.ExpectAtEnd()) {
-          protobuf_uint64 n;  // There is no API for int64
-          if (!stream.ReadVarint64(&n)) return false;
-          int64_list->push_back(static_cast<int64_t>(n));
+        // Decodes the packed field in bulk straight from the serialized
+        // bytes, which CodedInputStream aliases, after sizing the output once.
+        const void* packed_data = nullptr;
+        int available = 0;
+        if (packed_length > 0 &&
+            (!stream.GetDirectBufferPointer(&packed_data, &available) ||
+             static_cast<uint32>(available) < packed_length)) {
+          return false;
         }
-
-        stream.PopLimit(packed_limit);
+        const uint8* packed_begin = static_cast<const uint8*>(packed_data);
+        const uint8* packed_end = packed_begin + packed_length;
+        const int64_t num_elements =
+            CountPackedVarints(packed_begin, packed_end);
+        if (num_elements < 0) return false;
+
+        // As in ParseFloatList(), a LimitedArraySlice may hold fewer elements
+        // than requested by resize().
+        const size_t initial_size = int64_list->size();
+        int64_list->resize(initial_size + num_elements);
+        int64_t* out_begin = int64_list->data() + initial_size;
+        if (!DecodePackedVarints(packed_begin, packed_end, out_begin,
+                                 int64_list->data() + int64_list->size())) {
+          return false;
+        }
+        if (!stream.Skip(packed_length)) return false;
       } else {  // non-packed
         while (!stream.ExpectAtEnd()) {
           if (!stream.ExpectTag(kVarintTag(1))) return false;
@@ -1014,46 +1088,38 @@ void CopyOrMoveBlock(const tstring* b, const tstring* e, tstring* t) {
 }
 
 template <typename T>
-void FillAndCopyVarLen(
-    const int d, const size_t num_elements,
-    const size_t num_elements_per_minibatch, const Config& config,
-    const std::vector<std::vector<SparseBuffer>>& varlen_dense_buffers,
-    Tensor* values) {
+void FillAndCopyVarLen(const int d, const size_t num_elements_per_minibatch,
+                       const Config& config, const SparseBuffer& buffer,
+                       const size_t first_example, Tensor* values) {
   const Tensor& default_value = config.dense[d].default_value;
 
-  // Copy-fill the tensors (creating the zero/fill-padding)
-  std::fill(values->flat<T>().data(), values->flat<T>().data() + num_elements,
-            default_value.flat<T>()(0));
-
   // Data is [batch_size, max_num_elements, data_stride_size]
   //   and num_elements_per_minibatch = max_num_elements * data_stride_size
-  auto data = values->flat<T>().data();
-
-  // Iterate over minibatch elements
-  for (size_t i = 0; i < varlen_dense_buffers.size(); ++i) {
-    const SparseBuffer& buffer = varlen_dense_buffers[i][d];
-    // Number of examples being stored in this buffer
-    const auto& end_indices = buffer.example_end_indices;
-    const size_t examples_in_buffer = end_indices.size();
-    // const size_t stride_size = config.dense[d].elements_per_stride;
-
-    const auto& list = GetListFromBuffer<T>(buffer);
-    auto list_ptr = list.begin();
-
-    size_t elements_tally = 0;
-    // Iterate through all the examples stored in this buffer.
-    for (size_t j = 0; j < examples_in_buffer; ++j) {
-      // Number of elements stored for this example.
-      const size_t num_elems = end_indices[j] - elements_tally;
-      CopyOrMoveBlock(list_ptr, list_ptr + num_elems, data);
-      // Move forward this many elements in the varlen buffer.
-      list_ptr += num_elems;
-      // Move forward to the next minibatch entry in the values output.
-      data += num_elements_per_minibatch;
-      elements_tally = end_indices[j];
-    }
-    DCHECK(elements_tally == list.size());
-  }
+  // Only the rows of the examples stored in this buffer are written.
+  const auto& end_indices = buffer.example_end_indices;
+  auto data =
+      values->flat<T>().data() + first_example * num_elements_per_minibatch;
+
+  // Copy-fill the rows (creating the zero/fill-padding)
+  std::fill(data, data + end_indices.size() * num_elements_per_minibatch,
+            default_value.flat<T>()(0));
+
+  const auto& list = GetListFromBuffer<T>(buffer);
+  auto list_ptr = list.begin();
+
+  size_t elements_tally = 0;
+  // Iterate through all the examples stored in this buffer.
+  for (size_t j = 0; j < end_indices.size(); ++j) {
+    // Number of elements stored for this example.
+    const size_t num_elems = end_indices[j] - elements_tally;
+    CopyOrMoveBlock(list_ptr, list_ptr + num_elems, data);
+    // Move forward this many elements in the varlen buffer.
+    list_ptr += num_elems;
+    // Move forward to the next minibatch entry in the values output.
+    data += num_elements_per_minibatch;
+    elements_tally = end_indices[j];
+  }
+  DCHECK(elements_tally == list.size());
 }
 
 // Thin vector like interface wrapper around a Tensor. This enable us to
@@ -1267,9 +1333,28 @@ Status FastParseExample(const Config& config,
     result->dense_values.push_back(std::move(fixed_dense_values[d]));
   }
 
-  // Merge SparseBuffers from all minibatches for every config.sparse.
-  auto MergeSparseMinibatches = [&](size_t d) {
-    // Loop over minibatches
+  // Merging the buffers of all minibatches takes two passes. The first sizes
+  // and allocates every output from the end indices of the buffers, and
+  // computes the offset of each minibatch in it. The second copies each
+  // minibatch's buffer straight to its offset in the final output, in
+  // parallel across features and minibatches.
+  std::vector<std::function<void()>> copy_tasks;
+
+  // Offsets of the minibatches in the values of a sparse or ragged feature.
+  auto MinibatchValueOffsets =
+      [&](const std::vector<std::vector<SparseBuffer>>& buffers, size_t d) {
+        std::vector<size_t> offsets(buffers.size() + 1, 0);
+        for (size_t i = 0; i < buffers.size(); ++i) {
+          const auto& end_indices = buffers[i][d].example_end_indices;
+          offsets[i + 1] =
+              offsets[i] + (end_indices.empty() ? 0 : end_indices.back());
+        }
+        return offsets;
+      };
+
+  // Allocates the outputs of every config.sparse.
+  std::vector<std::vector<size_t>> sparse_offsets(config.sparse.size());
+  for (size_t d = 0; d < config.sparse.size(); ++d) {
     size_t total_num_features = 0;
     size_t max_num_features = 0;
     CountSparseFeatures(sparse_buffers, d, &total_num_features,
@@ -1279,50 +1364,22 @@ Status FastParseExample(const Config& config,
     indices_shape.AddDim(total_num_features);
     indices_shape.AddDim(2);
     result->sparse_indices.emplace_back(DT_INT64, indices_shape);
-    Tensor* indices = &result->sparse_indices.back();
 
     TensorShape values_shape;
     values_shape.AddDim(total_num_features);
     result->sparse_values.emplace_back(config.sparse[d].dtype, values_shape);
-    Tensor* values = &result->sparse_values.back();
 
     result->sparse_shapes.emplace_back(DT_INT64, TensorShape({2}));
     auto shapes_shape_t = result->sparse_shapes.back().vec<int64_t>();
     shapes_shape_t(0) = serialized.size();
     shapes_shape_t(1) = max_num_features;
 
-    size_t offset = 0;
-    for (size_t i = 0; i < sparse_buffers.size(); ++i) {
-      SparseBuffer& buffer = sparse_buffers[i][d];
-
-      // Update indices.
-      size_t delta = 0;
-
-      if (indices->NumElements() > 0) {
-        int64* ix_p = &indices->matrix<int64_t>()(offset, 0);
-        size_t example_index = first_example_of_minibatch(i);
-        for (size_t example_end_index : buffer.example_end_indices) {
-          size_t feature_index = 0;
-          for (; delta < example_end_index; ++delta) {
-            // Column 0: example index
-            *ix_p = example_index;
-            // Column 1: the feature index buffer example
-            *(ix_p + 1) = feature_index;
-            ix_p += 2;
-            ++feature_index;
-          }
-          ++example_index;
-        }
-      }
-
-      CopySparseBufferToTensor(config.sparse[d].dtype, offset, &buffer, values);
-      offset += delta;
-    }
-  };
+    sparse_offsets[d] = MinibatchValueOffsets(sparse_buffers, d);
+  }
 
-  // Merge SparseBuffers from all minibatches for every config.ragged.
-  auto MergeRaggedMinibatches = [&](size_t d) {
-    // Loop over minibatches
+  // Allocates the outputs of every config.ragged.
+  std::vector<std::vector<size_t>> ragged_offsets(config.ragged.size());
+  for (size_t d = 0; d < config.ragged.size(); ++d) {
     size_t total_num_features = 0;
     size_t max_num_features = 0;
     CountSparseFeatures(ragged_buffers, d, &total_num_features,
@@ -1342,41 +1399,14 @@ Status FastParseExample(const Config& config,
     TensorShape values_shape;
     values_shape.AddDim(total_num_features);
     result->ragged_values.emplace_back(config.ragged[d].dtype, values_shape);
-    Tensor* values = &result->ragged_values.back();
-
-    size_t values_offset = 0;
-    size_t splits_offset = 0;
-    for (size_t i = 0; i < ragged_buffers.size(); ++i) {
-      SparseBuffer& buffer = ragged_buffers[i][d];
-      if (buffer.example_end_indices.empty()) continue;
-
-      // Update row_splits.  row_splits are formed by concatenating the example
-      // end_indices (adjusting each to start after the previous one ends).
-      if (config.ragged[d].splits_dtype == DT_INT64) {
-        int64* row_splits_out = &row_splits->flat<int64_t>()(splits_offset);
-        int64_t start = *row_splits_out;
-        for (size_t example_end_index : buffer.example_end_indices) {
-          *++row_splits_out = start + example_end_index;
-        }
-      } else {
-        int32* row_splits_out = &row_splits->flat<int32>()(splits_offset);
-        int32_t start = *row_splits_out;
-        for (size_t example_end_index : buffer.example_end_indices) {
-          *++row_splits_out = start + example_end_index;
-        }
-      }
 
-      CopySparseBufferToTensor(config.ragged[d].dtype, values_offset, &buffer,
-                               values);
-      values_offset += buffer.example_end_indices.back();
-      splits_offset += buffer.example_end_indices.size();
-    }
-  };
+    ragged_offsets[d] = MinibatchValueOffsets(ragged_buffers, d);
+  }
 
-  // Merge SparseBuffers from all minibatches for every config.dense having
-  // variable_length.
-  auto MergeDenseVarLenMinibatches = [&](size_t d) {
-    if (!config.dense[d].variable_length) return;
+  // Allocates the outputs of every config.dense having variable_length.
+  std::vector<size_t> varlen_elements_per_example(config.dense.size(), 0);
+  for (size_t d = 0; d < config.dense.size(); ++d) {
+    if (!config.dense[d].variable_length) continue;
 
     // Loop over minibatches
     size_t max_num_features = 0;
@@ -1400,48 +1430,113 @@ Status FastParseExample(const Config& config,
     for (int i = 1; i < config.dense[d].shape.dims(); ++i) {
       values_shape.AddDim(config.dense[d].shape.dim_size(i));
     }
-    Tensor values(config.dense[d].dtype, values_shape);
-    result->dense_values[d] = values;
-    const size_t num_elements = values.NumElements();
-
-    // Nothing to write, exit early.
-    if (num_elements == 0) return;
+    result->dense_values[d] = Tensor(config.dense[d].dtype, values_shape);
+    const size_t num_elements = result->dense_values[d].NumElements();
 
-    const size_t num_elements_per_minibatch = num_elements / batch_size;
+    // Nothing to write, skip copying.
+    if (num_elements == 0) continue;
 
-    switch (config.dense[d].dtype) {
-      case DT_INT64: {
-        FillAndCopyVarLen<int64_t>(d, num_elements, num_elements_per_minibatch,
-                                   config, varlen_dense_buffers, &values);
-        break;
-      }
-      case DT_FLOAT: {
-        FillAndCopyVarLen<float>(d, num_elements, num_elements_per_minibatch,
-                                 config, varlen_dense_buffers, &values);
-        break;
-      }
-      case DT_STRING: {
-        FillAndCopyVarLen<tstring>(d, num_elements, num_elements_per_minibatch,
-                                   config, varlen_dense_buffers, &values);
-        break;
-      }
-      default:
-        ReportUnexpectedDataType(config.dense[d].dtype);
-    }
-  };
-
-  for (size_t d = 0; d < config.dense.size(); ++d) {
-    MergeDenseVarLenMinibatches(d);
+    varlen_elements_per_example[d] = num_elements / batch_size;
   }
 
+  // The outputs are all allocated, so their addresses are stable from here.
   for (size_t d = 0; d < config.sparse.size(); ++d) {
-    MergeSparseMinibatches(d);
+    Tensor* indices = &result->sparse_indices[d];
+    Tensor* values = &result->sparse_values[d];
+    for (size_t i = 0; i < sparse_buffers.size(); ++i) {
+      copy_tasks.push_back([&, d, i, indices, values]() {
+        SparseBuffer& buffer = sparse_buffers[i][d];
+        const size_t offset = sparse_offsets[d][i];
+
+        // Update indices.
+        if (indices->NumElements() > 0) {
+          int64* ix_p = &indices->matrix<int64_t>()(offset, 0);
+          size_t example_index = first_example_of_minibatch(i);
+          size_t delta = 0;
+          for (size_t example_end_index : buffer.example_end_indices) {
+            size_t feature_index = 0;
+            for (; delta < example_end_index; ++delta) {
+              // Column 0: example index
+              *ix_p = example_index;
+              // Column 1: the feature index buffer example
+              *(ix_p + 1) = feature_index;
+              ix_p += 2;
+              ++feature_index;
+            }
+            ++example_index;
+          }
+        }
+
+        CopySparseBufferToTensor(config.sparse[d].dtype, offset, &buffer,
+                                 values);
+      });
+    }
   }
 
   for (size_t d = 0; d < config.ragged.size(); ++d) {
-    MergeRaggedMinibatches(d);
+    Tensor* row_splits = &result->ragged_splits[d];
+    Tensor* values = &result->ragged_values[d];
+    for (size_t i = 0; i < ragged_buffers.size(); ++i) {
+      copy_tasks.push_back([&, d, i, row_splits, values]() {
+        SparseBuffer& buffer = ragged_buffers[i][d];
+        if (buffer.example_end_indices.empty()) return;
+
+        // Update row_splits.  row_splits are formed by concatenating the
+        // example end_indices, each shifted by the number of values of the
+        // preceding minibatches.
+        const size_t values_offset = ragged_offsets[d][i];
+        const size_t splits_offset = first_example_of_minibatch(i);
+        if (config.ragged[d].splits_dtype == DT_INT64) {
+          int64* row_splits_out = &row_splits->flat<int64_t>()(splits_offset);
+          for (size_t example_end_index : buffer.example_end_indices) {
+            *++row_splits_out = values_offset + example_end_index;
+          }
+        } else {
+          int32* row_splits_out = &row_splits->flat<int32>()(splits_offset);
+          for (size_t example_end_index : buffer.example_end_indices) {
+            *++row_splits_out = values_offset + example_end_index;
+          }
+        }
+
+        CopySparseBufferToTensor(config.ragged[d].dtype, values_offset,
+                                 &buffer, values);
+      });
+    }
   }
 
+  for (size_t d = 0; d < config.dense.size(); ++d) {
+    if (varlen_elements_per_example[d] == 0) continue;
+    Tensor* values = &result->dense_values[d];
+    for (size_t i = 0; i < varlen_dense_buffers.size(); ++i) {
+      copy_tasks.push_back([&, d, i, values]() {
+        const SparseBuffer& buffer = varlen_dense_buffers[i][d];
+        const size_t first_example = first_example_of_minibatch(i);
+        switch (config.dense[d].dtype) {
+          case DT_INT64: {
+            FillAndCopyVarLen<int64_t>(d, varlen_elements_per_example[d],
+                                       config, buffer, first_example, values);
+            break;
+          }
+          case DT_FLOAT: {
+            FillAndCopyVarLen<float>(d, varlen_elements_per_example[d],
+                                     config, buffer, first_example, values);
+            break;
+          }
+          case DT_STRING: {
+            FillAndCopyVarLen<tstring>(d, varlen_elements_per_example[d],
+                                       config, buffer, first_example, values);
+            break;
+          }
+          default:
+            ReportUnexpectedDataType(config.dense[d].dtype);
+        }
+      });
+    }
+  }
+
+  ParallelFor([&](size_t t) { copy_tasks[t](); }, copy_tasks.size(),
+              thread_pool);
+
   return absl::OkStatus();
 }
 
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
+#include <limits>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -219,6 +220,32 @@ TEST(FastParse, SingleInt64) {
   TestCorrectness(Serialize(example));
 }
 
+TEST(FastParse, PackedInt64Varints) {
+  Example example;
+  Int64List* int64_list =
+      (*example.mutable_features()->mutable_feature())["int64_list"]
+          .mutable_int64_list();
+  // Runs of single-byte varints, interleaved with multi-byte and negative
+  // (ten-byte) varints.
+  for (int i = 0; i < 20; ++i) int64_list->add_value(i);
+  int64_list->add_value(128);
+  int64_list->add_value(-1);
+  for (int i = 0; i < 9; ++i) int64_list->add_value(127 - i);
+  int64_list->add_value(std::numeric_limits<int64_t>::max());
+  int64_list->add_value(std::numeric_limits<int64_t>::min());
+  int64_list->add_value(1);
+  TestCorrectness(Serialize(example));
+}
+
+TEST(FastParse, TruncatedPackedInt64Varint) {
+  // An example with feature "a", whose packed int64_list ends in the middle of
+  // a varint.
+  const string serialized(
+      "\x0a\x0c\x0a\x0a\x0a\x01\x61\x12\x05\x1a\x03\x0a\x01\x80");
+  Example fast_example;
+  EXPECT_FALSE(TestFastParse(serialized, &fast_example));
+}
+
 static string ExampleWithSomeFeatures() {
   Example example;
 
@@ -429,6 +456,44 @@ TEST(TestFastParseExample, Empty) {
   EXPECT_TRUE(status.ok()) << status;
 }
 
+// Parses batches of examples with a realistic mix of features: small ids,
+// 64-bit hashes, dense weights and short strings.
+static void BM_FastParseExample(::testing::benchmark::State& state) {
+  const int batch_size = state.range(0);
+  const int num_values = state.range(1);
+  random::PhiloxRandom philox(42);
+  random::SimplePhilox rng(&philox);
+
+  Example example;
+  auto& features = *example.mutable_features()->mutable_feature();
+  for (int i = 0; i < num_values; ++i) {
+    features["ids"].mutable_int64_list()->add_value(rng.Uniform(100));
+    features["hashes"].mutable_int64_list()->add_value(rng.Rand64());
+    features["weights"].mutable_float_list()->add_value(rng.RandFloat());
+    features["tokens"].mutable_bytes_list()->add_value(RandStr(&rng));
+  }
+  std::vector<tstring> serialized(batch_size, Serialize(example));
+
+  FastParseExampleConfig config;
+  AddSparseFeature("ids", DT_INT64, &config);
+  AddSparseFeature("hashes", DT_INT64, &config);
+  AddDenseFeature("weights", DT_FLOAT, {num_values}, false, 1, &config);
+  AddSparseFeature("tokens", DT_STRING, &config);
+
+  int64_t bytes = 0;
+  for (const tstring& s : serialized) bytes += s.size();
+  for (auto s : state) {
+    Result result;
+    TF_CHECK_OK(FastParseExample(config, serialized, {}, nullptr, &result));
+  }
+  state.SetBytesProcessed(state.iterations() * bytes);
+}
+BENCHMARK(BM_FastParseExample)
+    ->ArgPair(1, 16)
+    ->ArgPair(128, 16)
+    ->ArgPair(128, 256)
+    ->ArgPair(1024, 64);
+
 }  // namespace
 }  // namespace example
 }  // namespace tensorflow
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_UTIL_MKL_UTIL_H_
 #ifdef INTEL_MKL
 
+#include <algorithm>
 #include <list>
 #include <memory>
 #include <string>
@@ -39,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/util/onednn_env_vars.h"
 #include "tensorflow/core/util/padding.h"
 #include "tensorflow/core/util/tensor_format.h"
+#include "tensorflow/core/util/work_sharder.h"
 #if defined(DNNL_AARCH64_USE_ACL) && defined(ENABLE_ONEDNN_OPENMP)
 #include "tensorflow/core/platform/mutex.h"
 #endif
@@ -665,6 +667,16 @@ inline Eigen::ThreadPoolInterface* EigenThreadPoolFromTfContext(
       ->workers->AsEigenThreadPool();
 }
 
+// Returns the number of threads of the intra-op pool of `context` that oneDNN
+// primitives run on. Like Shard() and the Eigen devices, this honors the
+// per-thread max parallelism (see ScopedPerThreadMaxParallelism), e.g. the
+// max_intra_op_parallelism of tf.data, so that oneDNN and Eigen kernels of the
+// same request share the same limit on the same pool.
+inline int OneDnnNumThreads(OpKernelContext* context) {
+  const int num_threads = EigenThreadPoolFromTfContext(context)->NumThreads();
+  return std::max(1, std::min(num_threads, GetPerThreadMaxParallelism()));
+}
+
 // List of MklShape objects. Used in Concat/Split layers.
 typedef std::vector<MklDnnShape> MklDnnShapeList;
 
@@ -685,8 +697,9 @@ inline void ExecutePrimitive(const std::vector<primitive>& net,
   if (context != nullptr) {
     Eigen::ThreadPoolInterface* eigen_interface =
         EigenThreadPoolFromTfContext(context);
-    eigen_tp =
-        tsl::OneDnnThreadPool(eigen_interface, ThreadPoolUseCallerThread());
+    eigen_tp = tsl::OneDnnThreadPool(
+        eigen_interface, ThreadPoolUseCallerThread(),
+        OneDnnNumThreads(context));
     cpu_stream.reset(CreateStream(&eigen_tp, cpu_engine));
   } else {
     cpu_stream.reset(CreateStream(nullptr, cpu_engine));
@@ -1631,8 +1644,9 @@ class MklDnnData {
       if (context != nullptr) {
         Eigen::ThreadPoolInterface* eigen_interface =
             EigenThreadPoolFromTfContext(context);
-        eigen_tp =
-            tsl::OneDnnThreadPool(eigen_interface, ThreadPoolUseCallerThread());
+        eigen_tp = tsl::OneDnnThreadPool(
+            eigen_interface, ThreadPoolUseCallerThread(),
+            OneDnnNumThreads(context));
         cpu_stream.reset(CreateStream(&eigen_tp, prim->GetEngine()));
       } else {
         cpu_stream.reset(CreateStream(nullptr, prim->GetEngine()));
@@ -1701,8 +1715,9 @@ class MklDnnData {
       if (context != nullptr) {
         Eigen::ThreadPoolInterface* eigen_interface =
             EigenThreadPoolFromTfContext(context);
-        eigen_tp =
-            tsl::OneDnnThreadPool(eigen_interface, ThreadPoolUseCallerThread());
+        eigen_tp = tsl::OneDnnThreadPool(
+            eigen_interface, ThreadPoolUseCallerThread(),
+            OneDnnNumThreads(context));
         cpu_stream.reset(CreateStream(&eigen_tp, prim->GetEngine()));
       } else {
         cpu_stream.reset(CreateStream(nullptr, prim->GetEngine()));
@@ -1815,8 +1830,9 @@ class MklDnnData {
     if (ctx != nullptr) {
       Eigen::ThreadPoolInterface* eigen_interface =
           EigenThreadPoolFromTfContext(ctx);
-      eigen_tp =
-          tsl::OneDnnThreadPool(eigen_interface, ThreadPoolUseCallerThread());
+      eigen_tp = tsl::OneDnnThreadPool(
+          eigen_interface, ThreadPoolUseCallerThread(),
+          OneDnnNumThreads(ctx));
       cpu_stream.reset(CreateStream(&eigen_tp, prim->GetEngine()));
     } else {
       cpu_stream.reset(CreateStream(nullptr, prim->GetEngine()));
@@ -0,0 +1,151 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/tensor_bundle/async_bundle_writer.h"
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+
+AsyncBundleWriter::AsyncBundleWriter(Env* env, absl::string_view prefix,
+                                     const Options& options)
+    : env_(env), prefix_(prefix), options_(options) {}
+
+AsyncBundleWriter::~AsyncBundleWriter() {
+  thread_.reset();  // Joins the writing thread.
+}
+
+Status AsyncBundleWriter::Add(absl::string_view key, const Tensor& val) {
+  CHECK(!finished_) << "AsyncBundleWriter is finished";
+  if (!keys_.insert(std::string(key)).second) {
+    return errors::InvalidArgument("Adding duplicate key: ", key);
+  }
+  Item item;
+  item.key = std::string(key);
+  item.val = val;
+  items_.push_back(std::move(item));
+  return absl::OkStatus();
+}
+
+Status AsyncBundleWriter::AddSlice(absl::string_view full_tensor_key,
+                                   const TensorShape& full_tensor_shape,
+                                   const TensorSlice& slice_spec,
+                                   const Tensor& slice_tensor) {
+  CHECK(!finished_) << "AsyncBundleWriter is finished";
+  // Duplicate slices are reported by the BundleWriter of the shard, or by
+  // MergeBundles() if they end up in different shards.
+  Item item;
+  item.key = std::string(full_tensor_key);
+  item.val = slice_tensor;
+  item.is_slice = true;
+  item.full_tensor_shape = full_tensor_shape;
+  item.slice_spec = slice_spec;
+  items_.push_back(std::move(item));
+  return absl::OkStatus();
+}
+
+void AsyncBundleWriter::FinishAsync(std::function<void(const Status&)> done) {
+  CHECK(!finished_) << "AsyncBundleWriter is finished";
+  finished_ = true;
+  thread_.reset(env_->StartThread(
+      ThreadOptions(), "async_bundle_writer",
+      [this, done = std::move(done)]() { done(Write()); }));
+}
+
+Status AsyncBundleWriter::Finish() {
+  Status status;
+  Notification finished;
+  FinishAsync([&](const Status& s) {
+    status = s;
+    finished.Notify();
+  });
+  finished.WaitForNotification();
+  return status;
+}
+
+Status AsyncBundleWriter::Write() {
+  // Assigns the items, largest first, to the shard with the fewest bytes.
+  const int num_shards = std::max<int>(
+      1, std::min<int64_t>(options_.num_shards, items_.size()));
+  std::vector<size_t> order(items_.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+    return items_[a].val.TotalBytes() > items_[b].val.TotalBytes();
+  });
+  std::vector<std::vector<const Item*>> shards(num_shards);
+  std::vector<int64_t> shard_bytes(num_shards, 0);
+  for (size_t i : order) {
+    const int shard = std::min_element(shard_bytes.begin(), shard_bytes.end()) -
+                      shard_bytes.begin();
+    shards[shard].push_back(&items_[i]);
+    shard_bytes[shard] += items_[i].val.TotalBytes();
+  }
+
+  const std::string temp_dir =
+      strings::StrCat(prefix_, "_temp_", random::New64());
+  std::vector<tstring> shard_prefixes(num_shards);
+  for (int i = 0; i < num_shards; ++i) {
+    shard_prefixes[i] = io::JoinPath(
+        temp_dir, strings::StrCat("part-", i, "-of-", num_shards));
+  }
+
+  std::vector<Status> statuses(num_shards);
+  {
+    thread::ThreadPool pool(env_, "async_bundle_shard_writer", num_shards);
+    for (int i = 0; i < num_shards; ++i) {
+      pool.Schedule([this, i, &shards, &shard_prefixes, &statuses]() {
+        statuses[i] = WriteShard(shard_prefixes[i], shards[i]);
+      });
+    }
+  }  // Waits for all shards to be written.
+
+  Status status;
+  for (const Status& s : statuses) status.Update(s);
+  if (status.ok()) {
+    status = MergeBundles(env_, shard_prefixes, prefix_);
+  }
+
+  // Cleanup: best effort based and ignores errors.
+  int64_t undeleted_files, undeleted_dirs;
+  env_->DeleteRecursively(temp_dir, &undeleted_files, &undeleted_dirs)
+      .IgnoreError();
+  return status;
+}
+
+Status AsyncBundleWriter::WriteShard(const std::string& prefix,
+                                     const std::vector<const Item*>& items) {
+  BundleWriter writer(env_, prefix, options_.writer_options);
+  for (const Item* item : items) {
+    if (item->is_slice) {
+      TF_RETURN_IF_ERROR(writer.AddSlice(item->key, item->full_tensor_shape,
+                                         item->slice_spec, item->val));
+    } else {
+      TF_RETURN_IF_ERROR(writer.Add(item->key, item->val));
+    }
+  }
+  return writer.Finish();
+}
+
+}  // namespace tensorflow
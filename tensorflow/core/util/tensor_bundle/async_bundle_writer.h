@@ -0,0 +1,126 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// An asynchronous, sharded writer of tensor bundles.
+//
+// Unlike BundleWriter, which serializes and writes each tensor as it is added,
+// AsyncBundleWriter only takes a reference to the added tensors and writes
+// them in the background once FinishAsync() is called, so that the caller
+// can resume work while the bytes are written out:
+//
+//   AsyncBundleWriter writer(env, "/fs/train/ckpt-step");
+//   TF_RETURN_IF_ERROR(writer.Add("w", w));
+//   TF_RETURN_IF_ERROR(writer.Add("b", b));
+//   writer.FinishAsync([](const Status& s) { ... });
+//   // Continue training; "w" and "b" must not be modified in place.
+//
+// The tensors are split into shards of roughly equal byte size, which are
+// written concurrently by one BundleWriter each under a temporary directory,
+// and then merged with MergeBundles() into a single bundle. Readers see either
+// no bundle under the prefix or the complete one, as the metadata file is
+// moved into place last.
+
+#ifndef TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_ASYNC_BUNDLE_WRITER_H_
+#define TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_ASYNC_BUNDLE_WRITER_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_slice.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+
+// All threads accessing the same AsyncBundleWriter must synchronize.
+class AsyncBundleWriter {
+ public:
+  struct Options {
+    // The number of data shards, which are written concurrently. Fewer shards
+    // are written if fewer tensors are added.
+    int num_shards = 4;
+
+    // Options of the BundleWriter of each shard.
+    BundleWriter::Options writer_options;
+  };
+  AsyncBundleWriter(Env* env, absl::string_view prefix,
+                    const Options& options = Options());
+
+  // Waits for the background writes, if any, to finish.
+  ~AsyncBundleWriter();
+
+  // Adds the tensor "val" under key "key", like BundleWriter::Add().
+  //
+  // Takes a reference to the buffer of "val" instead of copying it. Until the
+  // write has finished, the buffer must not be modified in place; resource
+  // variables copy their buffer on write while it is shared. "val" must be in
+  // host memory.
+  Status Add(absl::string_view key, const Tensor& val) TF_MUST_USE_RESULT;
+
+  // Adds a slice of a partitioned tensor, like BundleWriter::AddSlice(), with
+  // the same requirements on "slice_tensor" as Add().
+  Status AddSlice(absl::string_view full_tensor_key,
+                  const TensorShape& full_tensor_shape,
+                  const TensorSlice& slice_spec,
+                  const Tensor& slice_tensor) TF_MUST_USE_RESULT;
+
+  // Starts writing the added tensors and returns immediately. Calls "done"
+  // from a background thread once the bundle is complete, or with the first
+  // error. Add(), AddSlice() and FinishAsync() must not be called afterwards.
+  void FinishAsync(std::function<void(const Status&)> done);
+
+  // Like FinishAsync(), but blocks until the bundle is complete.
+  Status Finish() TF_MUST_USE_RESULT;
+
+ private:
+  struct Item {
+    std::string key;
+    Tensor val;
+    // Only set for the slices of partitioned tensors.
+    bool is_slice = false;
+    TensorShape full_tensor_shape;
+    TensorSlice slice_spec;
+  };
+
+  // Writes all items and merges the shards into the bundle under prefix_.
+  Status Write();
+
+  // Writes "items" as a complete bundle under "prefix".
+  Status WriteShard(const std::string& prefix,
+                    const std::vector<const Item*>& items);
+
+  Env* const env_;  // Not owned.
+  const std::string prefix_;
+  const Options options_;
+
+  std::vector<Item> items_;
+  absl::flat_hash_set<std::string> keys_;
+  bool finished_ = false;
+  std::unique_ptr<Thread> thread_;  // Runs Write().
+
+  AsyncBundleWriter(const AsyncBundleWriter&) = delete;
+  void operator=(const AsyncBundleWriter&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_ASYNC_BUNDLE_WRITER_H_
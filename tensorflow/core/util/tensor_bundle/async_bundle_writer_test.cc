@@ -0,0 +1,116 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/tensor_bundle/async_bundle_writer.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+namespace {
+
+string Prefix(const string& prefix) {
+  return strings::StrCat(testing::TmpDir(), "/", prefix);
+}
+
+template <typename T>
+void Expect(BundleReader* reader, const string& key,
+            const Tensor& expected_val) {
+  Tensor val(expected_val.dtype(), expected_val.shape());
+  TF_ASSERT_OK(reader->Lookup(key, &val));
+  test::ExpectTensorEqual<T>(val, expected_val);
+}
+
+TEST(AsyncBundleWriterTest, WritesShardedBundle) {
+  Notification done;
+  {
+    AsyncBundleWriter::Options options;
+    options.num_shards = 3;
+    AsyncBundleWriter writer(Env::Default(), Prefix("foo"), options);
+    for (int i = 0; i < 8; ++i) {
+      TF_ASSERT_OK(writer.Add(strings::StrCat("foo_", i),
+                              test::AsScalar<float>(i)));
+    }
+    TF_ASSERT_OK(writer.Add("bar", test::AsTensor<tstring>({"a", "bc"})));
+    TF_EXPECT_OK(writer.AddSlice("baz", TensorShape({4}),
+                                 TensorSlice::ParseOrDie("0,2"),
+                                 test::AsTensor<int32>({0, 1})));
+    TF_EXPECT_OK(writer.AddSlice("baz", TensorShape({4}),
+                                 TensorSlice::ParseOrDie("2,2"),
+                                 test::AsTensor<int32>({2, 3})));
+    writer.FinishAsync([&](const Status& s) {
+      TF_EXPECT_OK(s);
+      done.Notify();
+    });
+  }
+  EXPECT_TRUE(done.HasBeenNotified());
+
+  BundleReader reader(Env::Default(), Prefix("foo"));
+  TF_ASSERT_OK(reader.status());
+  for (int i = 0; i < 8; ++i) {
+    Expect<float>(&reader, strings::StrCat("foo_", i),
+                  test::AsScalar<float>(i));
+  }
+  Expect<tstring>(&reader, "bar", test::AsTensor<tstring>({"a", "bc"}));
+  Expect<int32>(&reader, "baz", test::AsTensor<int32>({0, 1, 2, 3}));
+
+  // The temporary shards are merged and removed.
+  std::vector<string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(testing::TmpDir(), &children));
+  for (const string& child : children) {
+    EXPECT_FALSE(absl::StrContains(child, "foo_temp_")) << child;
+  }
+}
+
+TEST(AsyncBundleWriterTest, EmptyBundle) {
+  AsyncBundleWriter writer(Env::Default(), Prefix("empty"));
+  TF_ASSERT_OK(writer.Finish());
+  BundleReader reader(Env::Default(), Prefix("empty"));
+  TF_ASSERT_OK(reader.status());
+}
+
+TEST(AsyncBundleWriterTest, DuplicateKey) {
+  AsyncBundleWriter writer(Env::Default(), Prefix("dup"));
+  TF_ASSERT_OK(writer.Add("foo", test::AsScalar<float>(0)));
+  EXPECT_TRUE(
+      absl::IsInvalidArgument(writer.Add("foo", test::AsScalar<float>(1))));
+}
+
+TEST(AsyncBundleWriterTest, WriteError) {
+  // Adding the same slice twice fails the write of its shard.
+  AsyncBundleWriter::Options options;
+  options.num_shards = 1;
+  AsyncBundleWriter writer(Env::Default(), Prefix("bad"), options);
+  TF_ASSERT_OK(writer.Add("foo", test::AsScalar<float>(0)));
+  TF_ASSERT_OK(writer.AddSlice("bar", TensorShape({4}),
+                               TensorSlice::ParseOrDie("0,2"),
+                               test::AsTensor<int32>({0, 1})));
+  TF_ASSERT_OK(writer.AddSlice("bar", TensorShape({4}),
+                               TensorSlice::ParseOrDie("0,2"),
+                               test::AsTensor<int32>({0, 1})));
+  EXPECT_FALSE(writer.Finish().ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
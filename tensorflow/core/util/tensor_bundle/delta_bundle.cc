@@ -0,0 +1,140 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/tensor_bundle/delta_bundle.h"
+
+#include <cstring>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_slice.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Makes "val" the only owner of its buffer, so that its rows can be
+// overwritten. The reader returns tensors that alias the read-only mapped data
+// files if BundleReader::Options::use_mmap is set.
+void MakeWritable(Tensor* val) {
+  const TensorBuffer* buffer = DMAHelper::buffer(val);
+  if (buffer != nullptr && (!buffer->OwnsMemory() || !val->RefCountIsOne())) {
+    *val = tensor::DeepCopy(*val);
+  }
+}
+
+// Copies the rows of "rows" into "val", starting at row "start".
+Status CopyRows(const Tensor& rows, int64_t start, Tensor* val) {
+  Tensor dst = val->Slice(start, start + rows.dim_size(0));
+  if (DataTypeCanUseMemcpy(rows.dtype())) {
+    std::memcpy(const_cast<char*>(dst.tensor_data().data()),
+                rows.tensor_data().data(), rows.TotalBytes());
+  } else if (rows.dtype() == DT_STRING) {
+    auto src_flat = rows.unaligned_flat<tstring>();
+    auto dst_flat = dst.unaligned_flat<tstring>();
+    for (int64_t i = 0; i < src_flat.size(); ++i) {
+      dst_flat(i) = src_flat(i);
+    }
+  } else {
+    return errors::InvalidArgument("Dtype ", DataTypeString(rows.dtype()),
+                                   " is not supported in delta checkpoints.");
+  }
+  return absl::OkStatus();
+}
+
+// Overwrites the rows of "val" that are stored in "delta".
+Status ApplyDelta(BundleReader* delta, absl::string_view key, Tensor* val) {
+  if (!delta->Contains(key)) return absl::OkStatus();
+
+  DataType dtype;
+  TensorShape shape;
+  TF_RETURN_IF_ERROR(delta->LookupDtypeAndShape(key, &dtype, &shape));
+  if (dtype != val->dtype() || shape != val->shape()) {
+    return errors::InvalidArgument(
+        "Delta of tensor ", key, " has dtype ", DataTypeString(dtype),
+        " and shape ", shape.DebugString(), ", but the base has dtype ",
+        DataTypeString(val->dtype()), " and shape ",
+        val->shape().DebugString());
+  }
+
+  std::vector<TensorSlice> slices;
+  TF_RETURN_IF_ERROR(delta->LookupTensorSlices(key, &slices));
+  if (slices.empty()) {
+    // The delta stores the full tensor.
+    return delta->Lookup(key, val);
+  }
+  MakeWritable(val);
+  for (const TensorSlice& slice : slices) {
+    for (int d = 1; d < slice.dims(); ++d) {
+      if (!slice.IsFullAt(d)) {
+        return errors::InvalidArgument("Delta of tensor ", key,
+                                       " stores slice ", slice.DebugString(),
+                                       ", which is not a range of rows.");
+      }
+    }
+    TensorShape rows_shape = shape;
+    rows_shape.set_dim(0, slice.length(0));
+    // The rows are read into their own tensor, as the reader may replace the
+    // buffer of the tensor it reads into.
+    Tensor rows(dtype, rows_shape);
+    TF_RETURN_IF_ERROR(delta->LookupSlice(key, slice, &rows));
+    TF_RETURN_IF_ERROR(CopyRows(rows, slice.start(0), val));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+Status AddDirtyRows(BundleWriter* writer, absl::string_view key,
+                    const Tensor& val,
+                    absl::Span<const std::pair<int64_t, int64_t>> row_ranges) {
+  if (val.dims() < 1) {
+    return errors::InvalidArgument("Cannot add rows of scalar tensor ", key);
+  }
+  int64_t previous_limit = 0;
+  for (const auto& [start, limit] : row_ranges) {
+    if (start < previous_limit || limit < start || limit > val.dim_size(0)) {
+      return errors::InvalidArgument(
+          "Row ranges of tensor ", key,
+          " must be sorted, disjoint and within [0, ", val.dim_size(0),
+          "), got [", start, ", ", limit, ")");
+    }
+    previous_limit = limit;
+    if (start == limit) continue;
+    TensorSlice slice(val.dims());
+    slice.set_start(0, start);
+    slice.set_length(0, limit - start);
+    TF_RETURN_IF_ERROR(
+        writer->AddSlice(key, val.shape(), slice, val.Slice(start, limit)));
+  }
+  return absl::OkStatus();
+}
+
+Status LookupWithDeltas(BundleReader* base,
+                        absl::Span<BundleReader* const> deltas,
+                        absl::string_view key, Tensor* val) {
+  TF_RETURN_IF_ERROR(base->Lookup(key, val));
+  for (BundleReader* delta : deltas) {
+    TF_RETURN_IF_ERROR(ApplyDelta(delta, key, val));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,73 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Delta checkpoints of tensors of which only a few rows change between saves,
+// such as large embedding tables.
+//
+// A delta is an ordinary tensor bundle that stores, for each tensor, only the
+// rows that changed since the previous checkpoint. The changed rows are stored
+// as slices of the full tensor covering row ranges, so a delta is readable by
+// any BundleReader. A tensor is restored by reading it from the base bundle and
+// then overwriting its rows with those of each delta, in the order in which the
+// deltas were written:
+//
+//   // Saving, with the dirty row ranges tracked by the caller.
+//   BundleWriter writer(env, "/fs/train/ckpt-step-delta");
+//   TF_RETURN_IF_ERROR(AddDirtyRows(&writer, "emb", emb, {{3, 5}, {10, 11}}));
+//   TF_RETURN_IF_ERROR(writer.Finish());
+//
+//   // Restoring.
+//   BundleReader base(env, "/fs/train/ckpt-base");
+//   BundleReader delta(env, "/fs/train/ckpt-step-delta");
+//   Tensor emb(DT_FLOAT, shape);
+//   TF_RETURN_IF_ERROR(LookupWithDeltas(&base, {&delta}, "emb", &emb));
+
+#ifndef TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_DELTA_BUNDLE_H_
+#define TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_DELTA_BUNDLE_H_
+
+#include <cstdint>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+
+// Adds the rows [start, limit) of "val" for each pair in "row_ranges" to
+// "writer" under "key", as a delta of the full tensor "val".
+//
+// REQUIRES: "row_ranges" is sorted, its ranges are disjoint and within the
+// first dimension of "val", and val.dims() >= 1.
+Status AddDirtyRows(BundleWriter* writer, absl::string_view key,
+                    const Tensor& val,
+                    absl::Span<const std::pair<int64_t, int64_t>> row_ranges);
+
+// Looks up the tensor keyed by "key" in "base" into "val", like
+// BundleReader::Lookup(), and then overwrites its rows with those stored in
+// each of "deltas", in order. A delta that does not contain "key" leaves the
+// tensor unchanged, and a delta that contains the full tensor replaces it.
+//
+// Returns an InvalidArgument error if a delta stores the tensor with a
+// different dtype or shape, or stores slices that are not row ranges.
+Status LookupWithDeltas(BundleReader* base,
+                        absl::Span<BundleReader* const> deltas,
+                        absl::string_view key, Tensor* val);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_DELTA_BUNDLE_H_
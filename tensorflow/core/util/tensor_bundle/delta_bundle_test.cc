@@ -0,0 +1,164 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/tensor_bundle/delta_bundle.h"
+
+#include <string>
+
+#include "absl/status/status.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+namespace {
+
+string Prefix(const string& prefix) {
+  return strings::StrCat(testing::TmpDir(), "/", prefix);
+}
+
+TEST(DeltaBundleTest, AppliesDeltasInOrder) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("base"));
+    TF_ASSERT_OK(writer.Add(
+        "emb", test::AsTensor<float>({0, 0, 1, 1, 2, 2, 3, 3}, {4, 2})));
+    TF_ASSERT_OK(writer.Add("step", test::AsScalar<int64_t>(0)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleWriter writer(Env::Default(), Prefix("delta_1"));
+    TF_ASSERT_OK(AddDirtyRows(
+        &writer, "emb",
+        test::AsTensor<float>({0, 0, 10, 10, 20, 20, 3, 3}, {4, 2}),
+        {{1, 3}}));
+    TF_ASSERT_OK(writer.Add("step", test::AsScalar<int64_t>(1)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleWriter writer(Env::Default(), Prefix("delta_2"));
+    TF_ASSERT_OK(AddDirtyRows(
+        &writer, "emb",
+        test::AsTensor<float>({5, 5, 10, 10, 21, 21, 3, 3}, {4, 2}),
+        {{0, 1}, {2, 3}}));
+    TF_ASSERT_OK(writer.Finish());
+  }
+
+  BundleReader base(Env::Default(), Prefix("base"));
+  BundleReader delta_1(Env::Default(), Prefix("delta_1"));
+  BundleReader delta_2(Env::Default(), Prefix("delta_2"));
+  TF_ASSERT_OK(base.status());
+  TF_ASSERT_OK(delta_1.status());
+  TF_ASSERT_OK(delta_2.status());
+
+  Tensor emb(DT_FLOAT, TensorShape({4, 2}));
+  TF_ASSERT_OK(LookupWithDeltas(&base, {&delta_1, &delta_2}, "emb", &emb));
+  test::ExpectTensorEqual<float>(
+      emb, test::AsTensor<float>({5, 5, 10, 10, 21, 21, 3, 3}, {4, 2}));
+
+  Tensor step(DT_INT64, TensorShape({}));
+  TF_ASSERT_OK(LookupWithDeltas(&base, {&delta_1, &delta_2}, "step", &step));
+  test::ExpectTensorEqual<int64_t>(step, test::AsScalar<int64_t>(1));
+}
+
+TEST(DeltaBundleTest, MemmappedBase) {
+  const Tensor base_emb = test::AsTensor<float>({0, 0, 1, 1, 2, 2}, {3, 2});
+  {
+    BundleWriter::Options options;
+    options.data_alignment = 64;
+    BundleWriter writer(Env::Default(), Prefix("base"), options);
+    TF_ASSERT_OK(writer.Add("emb", base_emb));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleWriter writer(Env::Default(), Prefix("delta"));
+    TF_ASSERT_OK(AddDirtyRows(
+        &writer, "emb", test::AsTensor<float>({0, 0, 10, 10, 2, 2}, {3, 2}),
+        {{1, 2}}));
+    TF_ASSERT_OK(writer.Finish());
+  }
+
+  BundleReader::Options options;
+  options.use_mmap = true;
+  BundleReader base(Env::Default(), Prefix("base"), options);
+  BundleReader delta(Env::Default(), Prefix("delta"));
+  TF_ASSERT_OK(base.status());
+  TF_ASSERT_OK(delta.status());
+
+  Tensor mapped_emb(DT_FLOAT, TensorShape({3, 2}));
+  TF_ASSERT_OK(base.Lookup("emb", &mapped_emb));
+  Tensor emb(DT_FLOAT, TensorShape({3, 2}));
+  TF_ASSERT_OK(LookupWithDeltas(&base, {&delta}, "emb", &emb));
+  test::ExpectTensorEqual<float>(
+      emb, test::AsTensor<float>({0, 0, 10, 10, 2, 2}, {3, 2}));
+  // The mapped data file is left untouched.
+  EXPECT_NE(emb.tensor_data().data(), mapped_emb.tensor_data().data());
+  test::ExpectTensorEqual<float>(mapped_emb, base_emb);
+}
+
+TEST(DeltaBundleTest, StringRows) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("base"));
+    TF_ASSERT_OK(writer.Add("s", test::AsTensor<tstring>({"a", "b", "c"})));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleWriter writer(Env::Default(), Prefix("delta"));
+    TF_ASSERT_OK(AddDirtyRows(&writer, "s",
+                              test::AsTensor<tstring>({"a", "bb", "c"}),
+                              {{1, 2}}));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader base(Env::Default(), Prefix("base"));
+  BundleReader delta(Env::Default(), Prefix("delta"));
+  Tensor s(DT_STRING, TensorShape({3}));
+  TF_ASSERT_OK(LookupWithDeltas(&base, {&delta}, "s", &s));
+  test::ExpectTensorEqual<tstring>(s,
+                                   test::AsTensor<tstring>({"a", "bb", "c"}));
+}
+
+TEST(DeltaBundleTest, Errors) {
+  const Tensor val = test::AsTensor<float>({0, 1, 2, 3}, {4, 1});
+  {
+    BundleWriter writer(Env::Default(), Prefix("bad"));
+    EXPECT_TRUE(absl::IsInvalidArgument(
+        AddDirtyRows(&writer, "v", val, {{2, 3}, {1, 2}})));
+    EXPECT_TRUE(
+        absl::IsInvalidArgument(AddDirtyRows(&writer, "v", val, {{3, 5}})));
+    EXPECT_TRUE(absl::IsInvalidArgument(
+        AddDirtyRows(&writer, "v", test::AsScalar<float>(0), {})));
+  }
+  {
+    BundleWriter writer(Env::Default(), Prefix("base"));
+    TF_ASSERT_OK(writer.Add("v", val));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleWriter writer(Env::Default(), Prefix("delta"));
+    TF_ASSERT_OK(AddDirtyRows(&writer, "v",
+                              test::AsTensor<float>({0, 1, 2}, {3, 1}),
+                              {{0, 1}}));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader base(Env::Default(), Prefix("base"));
+  BundleReader delta(Env::Default(), Prefix("delta"));
+  Tensor v(DT_FLOAT, TensorShape({4, 1}));
+  EXPECT_TRUE(
+      absl::IsInvalidArgument(LookupWithDeltas(&base, {&delta}, "v", &v)));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,14 +15,18 @@ limitations under the License.
 
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdlib>
 #include <cstring>
 #include <memory>
 #include <utility>
 
 #include "absl/base/call_once.h"
+#include "absl/synchronization/blocking_counter.h"
 #include "absl/synchronization/mutex.h"
 #include "xla/tsl/util/byte_swap_array.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -82,8 +86,36 @@ const int kMaxFileReadThreads = 8;
 // Minimum size of a file section handled by each thread.
 const int64_t kMinSectionSize = static_cast<int64_t>(1) << 31;
 
+// The largest gap between neighbouring entries that BundleReader::LookupMany()
+// reads over to coalesce them into one read.
+const int64_t kMaxCoalescedReadGapBytes = 64 << 10;
+
 namespace {
 
+// A TensorBuffer that aliases the bytes of a memory-mapped data file, and keeps
+// the mapping alive.
+class MemmappedTensorBuffer : public TensorBuffer {
+ public:
+  MemmappedTensorBuffer(std::shared_ptr<const ReadOnlyMemoryRegion> region,
+                        const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(static_cast<int64_t>(size_));
+    proto->set_allocator_name("BundleReaderMemmap");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<const ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
 // Reads "num_elements" string elements from file[offset, offset+size) into the
 // length-N "destination".  Discards the original content of "destination".
 //
@@ -738,10 +770,19 @@ Status MergeBundles(Env* env, absl::Span<const tstring> prefixes,
         DataFilename(merged_prefix, p.second, merge.shard_ids.size())));
   }
 
-  // Writes the final metadata table under the merged prefix.
+  // Writes the final metadata table under the merged prefix. As in
+  // BundleWriter::Finish(), it is moved into place once written if the file
+  // system supports atomic moves, so that readers never see a partial table.
+  const string metadata_path = MetaFilename(merged_prefix);
+  bool use_temp_file = false;
+  TF_RETURN_IF_ERROR(env->HasAtomicMove(metadata_path, &use_temp_file));
+  const string temp_metadata_path =
+      use_temp_file
+          ? strings::StrCat(metadata_path, ".tempstate", random::New64())
+          : metadata_path;
   std::unique_ptr<WritableFile> merged_metadata;
   TF_RETURN_IF_ERROR(
-      env->NewWritableFile(MetaFilename(merged_prefix), &merged_metadata));
+      env->NewWritableFile(temp_metadata_path, &merged_metadata));
   {
     table::TableBuilder builder(TableBuilderOptions(), merged_metadata.get());
     // Header entry.
@@ -757,7 +798,13 @@ Status MergeBundles(Env* env, absl::Span<const tstring> prefixes,
     status = builder.Finish();
   }
   status.Update(merged_metadata->Close());
-  if (!status.ok()) return status;
+  if (status.ok() && use_temp_file) {
+    status = env->RenameFile(temp_metadata_path, metadata_path);
+  }
+  if (!status.ok()) {
+    if (use_temp_file) env->DeleteFile(temp_metadata_path).IgnoreError();
+    return status;
+  }
   VLOG(1) << "Merged bundles to:" << merged_prefix;
 
   // Cleanup: best effort based and ignores errors.
@@ -783,6 +830,7 @@ BundleReader::BundleReader(Env* env, StringPiece prefix, Options options)
       table_(nullptr),
       index_cache_(nullptr),
       iter_(nullptr),
+      use_mmap_(options.use_mmap),
       need_to_swap_bytes_(false),
       enable_multi_threading_for_testing_(
           options.enable_multi_threading_for_testing) {
@@ -879,9 +927,12 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
 
 Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   Tensor* ret = val;
+  // Owns `ret` when it is not `val`, so that it is freed on every return.
+  std::unique_ptr<Tensor> owned_ret;
   const TensorShape stored_shape(TensorShape(entry.shape()));
   if (val->NumElements() == 0) {
-    ret = new Tensor(entry.dtype(), stored_shape);
+    owned_ret = std::make_unique<Tensor>(entry.dtype(), stored_shape);
+    ret = owned_ret.get();
   }
 
   // Validates the "size" field.
@@ -906,6 +957,12 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
     }
   }
 
+  if (use_mmap_ && DataTypeCanUseMemcpy(entry.dtype())) {
+    bool mapped = false;
+    TF_RETURN_IF_ERROR(GetMappedValue(entry, val, &mapped));
+    if (mapped) return absl::OkStatus();
+  }
+
   // Open the data file if it has not been opened.
   io::InputBuffer* buffered_file = data_[entry.shard_id()];
   if (buffered_file == nullptr) {
@@ -1015,7 +1072,53 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   }
 
   *val = *ret;
-  if (ret != val) delete ret;
+  return absl::OkStatus();
+}
+
+Status BundleReader::GetMappedValue(const BundleEntryProto& entry,
+                                    Tensor* val, bool* mapped) {
+  *mapped = false;
+  if (need_to_swap_bytes_ || entry.size() == 0) return absl::OkStatus();
+
+  auto it = mapped_data_.find(entry.shard_id());
+  if (it == mapped_data_.end()) {
+    const string filename =
+        DataFilename(prefix_, entry.shard_id(), num_shards_);
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    Status s = env_->NewReadOnlyMemoryRegionFromFile(filename, &region);
+    if (!s.ok()) {
+      VLOG(1) << "Reading " << filename << " without memory-mapping: " << s;
+      region = nullptr;
+    }
+    it = mapped_data_.emplace(entry.shard_id(), std::move(region)).first;
+  }
+  const std::shared_ptr<const ReadOnlyMemoryRegion>& region = it->second;
+  if (region == nullptr) return absl::OkStatus();
+
+  if (entry.offset() < 0 ||
+      static_cast<uint64>(entry.offset() + entry.size()) > region->length()) {
+    return errors::DataLoss("TensorBundle at ", prefix_, " shard ",
+                            entry.shard_id(), " is truncated: entry at offset ",
+                            entry.offset(), " of ", entry.size(),
+                            " bytes, but the file has ", region->length(),
+                            " bytes");
+  }
+  const char* data = static_cast<const char*>(region->data()) + entry.offset();
+  if (reinterpret_cast<uintptr_t>(data) % EIGEN_MAX_ALIGN_BYTES != 0) {
+    return absl::OkStatus();
+  }
+  const uint32 actual_crc32c = crc32c::Value(data, entry.size());
+  if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+    return errors::DataLoss(
+        "TensorBundle at ", prefix_, " shard ", entry.shard_id(), " (",
+        entry.size(), " bytes): Checksum does not match: stored ",
+        strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+        " vs. calculated on the restored bytes ", actual_crc32c);
+  }
+  *val = Tensor(entry.dtype(), TensorShape(entry.shape()),
+                core::RefCountPtr<TensorBuffer>(
+                    new MemmappedTensorBuffer(region, data, entry.size())));
+  *mapped = true;
   return absl::OkStatus();
 }
 
@@ -1033,6 +1136,208 @@ Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   }
 }
 
+Status BundleReader::LookupMany(absl::Span<const std::string> keys,
+                                absl::Span<Tensor* const> vals,
+                                const LookupManyOptions& options) {
+  CHECK_EQ(keys.size(), vals.size());
+  std::vector<Status> statuses(keys.size());
+
+  // An entry whose data is fetched by one of the concurrent reads.
+  struct PendingEntry {
+    size_t index;  // Into "keys" and "vals".
+    BundleEntryProto entry;
+  };
+  std::vector<PendingEntry> pending;
+  // Entries that are read by GetValue() or GetSliceValue().
+  std::vector<PendingEntry> serial;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    CHECK(vals[i] != nullptr);
+    BundleEntryProto entry;
+    TF_RETURN_IF_ERROR(GetBundleEntryProto(keys[i], &entry));
+    if (use_mmap_ || !entry.slices().empty() ||
+        !DataTypeCanUseMemcpy(entry.dtype()) ||
+        vals[i]->NumElements() == 0) {
+      serial.push_back({i, std::move(entry)});
+      continue;
+    }
+    if (entry.size() != vals[i]->TotalBytes()) {
+      return errors::DataLoss("Invalid size in bundle entry: key ", keys[i],
+                              "; stored size ", entry.size(),
+                              "; expected size ", vals[i]->TotalBytes());
+    }
+    pending.push_back({i, std::move(entry)});
+  }
+
+  // Sorts the entries by their position in the data files, and groups runs of
+  // small entries into coalesced reads.
+  std::sort(pending.begin(), pending.end(),
+            [](const PendingEntry& a, const PendingEntry& b) {
+              return std::make_pair(a.entry.shard_id(), a.entry.offset()) <
+                     std::make_pair(b.entry.shard_id(), b.entry.offset());
+            });
+  struct Read {
+    int32 shard_id;
+    int64_t offset;
+    int64_t size;
+    size_t begin, end;  // The range of "pending" covered by this read.
+  };
+  std::vector<Read> reads;
+  const int64_t max_coalesced_bytes = options.max_coalesced_read_bytes;
+  for (size_t p = 0; p < pending.size(); ++p) {
+    const BundleEntryProto& entry = pending[p].entry;
+    const int64_t entry_end = entry.offset() + entry.size();
+    if (!reads.empty() && entry.size() < max_coalesced_bytes) {
+      Read& last = reads.back();
+      const int64_t last_end = last.offset + last.size;
+      if (last.shard_id == entry.shard_id() &&
+          last.size < max_coalesced_bytes && entry.offset() >= last_end &&
+          entry.offset() - last_end <= kMaxCoalescedReadGapBytes &&
+          entry_end - last.offset <= max_coalesced_bytes) {
+        last.size = entry_end - last.offset;
+        last.end = p + 1;
+        continue;
+      }
+    }
+    reads.push_back({entry.shard_id(), entry.offset(), entry.size(), p, p + 1});
+  }
+
+  // Checksums the bytes of "entry" at "data" and moves them into its tensor.
+  auto finish_entry = [&](const PendingEntry& pending_entry,
+                          const char* data) -> Status {
+    const BundleEntryProto& entry = pending_entry.entry;
+    Tensor* val = vals[pending_entry.index];
+    char* backing_buffer = const_cast<char*>(val->tensor_data().data());
+    if (data != backing_buffer) {
+      memmove(backing_buffer, data, entry.size());
+    }
+    // As in GetValue(), the checksum is computed before byte-swapping.
+    const uint32 actual_crc32c = crc32c::Value(backing_buffer, entry.size());
+    if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+      return errors::DataLoss(
+          "TensorBundle at ", prefix_, " shard ", entry.shard_id(), " (",
+          entry.size(), " bytes): Checksum does not match: stored ",
+          strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+          " vs. calculated on the restored bytes ", actual_crc32c);
+    }
+    if (need_to_swap_bytes_) {
+      TF_RETURN_IF_ERROR(ByteSwapTensor(val));
+    }
+    return absl::OkStatus();
+  };
+
+  // Returns the buffer that "read" fills: the tensor itself if the read is of
+  // a single entry, or else "*scratch", allocated to fit.
+  auto read_buffer = [&](const Read& read,
+                         std::unique_ptr<char[]>* scratch) -> char* {
+    if (read.end - read.begin == 1) {
+      Tensor* val = vals[pending[read.begin].index];
+      return const_cast<char*>(val->tensor_data().data());
+    }
+    scratch->reset(new char[read.size]);
+    return scratch->get();
+  };
+
+  // Finishes the entries of "read", whose bytes are "sp" if "s" is OK.
+  auto finish_read = [&](const Read& read, const Status& s, StringPiece sp) {
+    for (size_t p = read.begin; p < read.end; ++p) {
+      if (!s.ok()) {
+        statuses[pending[p].index] = s;
+        continue;
+      }
+      statuses[pending[p].index] = finish_entry(
+          pending[p], sp.data() + (pending[p].entry.offset() - read.offset));
+    }
+  };
+
+  auto run_read = [&](const Read& read) {
+    // BundleCache::GetFile() is thread-safe, and RandomAccessFile::Read()
+    // allows concurrent reads, so the buffered data_ files are not used.
+    RandomAccessFile* file = nullptr;
+    Status s = cache_->GetFile(
+        DataFilename(prefix_, read.shard_id, num_shards_), &file);
+    StringPiece sp;
+    std::unique_ptr<char[]> scratch;
+    if (s.ok()) {
+      s = file->Read(read.offset, read.size, &sp, read_buffer(read, &scratch));
+    }
+    finish_read(read, s, sp);
+  };
+
+  // Without a pool, hands all reads of each data file to ReadMany() at once,
+  // which a file system may serve with all of them in flight.
+  auto run_reads_of_each_file = [&]() {
+    for (size_t r = 0; r < reads.size();) {
+      const int32 shard_id = reads[r].shard_id;
+      size_t end = r;
+      while (end < reads.size() && reads[end].shard_id == shard_id) ++end;
+
+      RandomAccessFile* file = nullptr;
+      Status s =
+          cache_->GetFile(DataFilename(prefix_, shard_id, num_shards_), &file);
+      std::vector<RandomAccessFile::ReadRequest> requests(end - r);
+      std::vector<std::unique_ptr<char[]>> scratches(end - r);
+      if (s.ok()) {
+        for (size_t i = 0; i < requests.size(); ++i) {
+          requests[i].offset = reads[r + i].offset;
+          requests[i].n = reads[r + i].size;
+          requests[i].scratch = read_buffer(reads[r + i], &scratches[i]);
+        }
+        file->ReadMany(absl::MakeSpan(requests)).IgnoreError();
+      }
+      for (size_t i = 0; i < requests.size(); ++i) {
+        finish_read(reads[r + i], s.ok() ? requests[i].status : s,
+                    requests[i].result);
+      }
+      r = end;
+    }
+  };
+
+  // Each worker claims the next unclaimed read until none are left, which
+  // bounds the number of reads in flight by the number of workers.
+  std::atomic<size_t> next_read{0};
+  auto worker = [&]() {
+    for (size_t r = next_read.fetch_add(1); r < reads.size();
+         r = next_read.fetch_add(1)) {
+      run_read(reads[r]);
+    }
+  };
+  const int num_workers = static_cast<int>(std::min<size_t>(
+      reads.size(), std::max(1, options.max_outstanding_reads)));
+  absl::BlockingCounter workers_done(options.pool == nullptr ? 0
+                                                             : num_workers);
+  if (options.pool == nullptr) {
+    run_reads_of_each_file();
+  } else {
+    for (int i = 0; i < num_workers; ++i) {
+      options.pool->Schedule([&]() {
+        worker();
+        workers_done.DecrementCount();
+      });
+    }
+  }
+
+  // The remaining entries need the buffered data_ files, which are not
+  // thread-safe, so they are read here while the workers are busy.
+  for (const PendingEntry& pending_entry : serial) {
+    const size_t i = pending_entry.index;
+    const BundleEntryProto& entry = pending_entry.entry;
+    if (entry.slices().empty()) {
+      statuses[i] = GetValue(entry, vals[i]);
+    } else {
+      statuses[i] = GetSliceValue(
+          keys[i], entry,
+          /* a full slice */ TensorSlice(TensorShape(entry.shape()).dims()),
+          vals[i]);
+    }
+  }
+  workers_done.Wait();
+
+  for (const Status& s : statuses) {
+    TF_RETURN_IF_ERROR(s);
+  }
+  return absl::OkStatus();
+}
+
 Status BundleReader::ReadCurrent(Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
@@ -72,9 +72,11 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/functional/function_ref.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_slice.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/io/cache.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
@@ -212,6 +214,15 @@ class BundleReader {
 
     // For tests only.
     bool enable_multi_threading_for_testing = false;
+
+    // If true, memory-maps the data files, and Lookup() returns full tensors
+    // of memcpy-able types that alias the mapped bytes instead of copying
+    // them. Such tensors keep the mapping alive and must never be written
+    // to. A tensor is still copied if its data is not aligned to
+    // EIGEN_MAX_ALIGN_BYTES in the file (see BundleWriter::Options), if the
+    // bundle is of a different endianness, or if the file system does not
+    // support memory-mapping.
+    bool use_mmap = false;
   };
   BundleReader(Env* env, absl::string_view prefix, Options options);
 
@@ -291,6 +302,36 @@ class BundleReader {
                      const TensorSlice& slice_spec,
                      Tensor* val) TF_MUST_USE_RESULT;
 
+  struct LookupManyOptions {
+    // The pool that runs the reads. If null, the reads of each data file are
+    // issued together with RandomAccessFile::ReadMany() on the calling
+    // thread.
+    thread::ThreadPool* pool = nullptr;
+
+    // The maximum number of reads in flight at any time.
+    int max_outstanding_reads = 8;
+
+    // Neighbouring entries of one data file that are smaller than this are
+    // fetched together, with reads of up to this many bytes.
+    int64_t max_coalesced_read_bytes = 16 << 20;
+  };
+
+  // Looks up the tensors keyed by "keys" into "vals", like calling Lookup()
+  // for each pair, but fetches the tensor data of all data files concurrently
+  // on "options.pool". Each read fills either one tensor directly or several
+  // small neighbouring tensors, which are then checksummed and copied out by
+  // the reading thread while other reads are in flight.
+  //
+  // Partitioned, string and variant tensors are read by Lookup() on the
+  // calling thread.
+  //
+  // Returns the first error in the order of "keys"; on error any of "vals"
+  // may contain nonsense data.
+  // REQUIRES: status().ok() && keys.size() == vals.size()
+  Status LookupMany(absl::Span<const std::string> keys,
+                    absl::Span<Tensor* const> vals,
+                    const LookupManyOptions& options) TF_MUST_USE_RESULT;
+
   // Seeks to the first position in the bundle whose key is no less than "key".
   // REQUIRES: status().ok()
   void Seek(absl::string_view key) { return iter_->Seek(key); }
@@ -322,6 +363,12 @@ class BundleReader {
   Status GetValue(const BundleEntryProto& entry,
                   Tensor* val) TF_MUST_USE_RESULT;
 
+  // Makes "val" alias the memory-mapped bytes of "entry" and sets "*mapped" to
+  // true, or sets "*mapped" to false if the bytes have to be copied instead.
+  // REQUIRES: use_mmap_ && DataTypeCanUseMemcpy(entry.dtype())
+  Status GetMappedValue(const BundleEntryProto& entry, Tensor* val,
+                        bool* mapped) TF_MUST_USE_RESULT;
+
   // Reads the slice described by "slice_spec".  The corresponding full tensor
   // has key "ful_tensor_key" and metadata proto "full_tensor_entry".
   // REQUIRES: full_tensor_entry.slices_size() > 0
@@ -344,6 +391,12 @@ class BundleReader {
   // Owned InputBuffer objects. cache_ owns the underlying RandomAccessFiles.
   std::unordered_map<int32_t, io::InputBuffer*> data_;
 
+  // Memory-mapped data files, by shard id, if use_mmap_. Null for the files
+  // that cannot be mapped. Shared with the tensors that alias them.
+  bool use_mmap_ = false;
+  std::unordered_map<int32_t, std::shared_ptr<const ReadOnlyMemoryRegion>>
+      mapped_data_;
+
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
   std::unordered_map<std::string, checkpoint::TensorSliceSet*> tensor_slices_;
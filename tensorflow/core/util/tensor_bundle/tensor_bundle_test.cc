@@ -1151,6 +1151,120 @@ TEST(TensorBundleTest, LargeVariableLoadingTest) {
   }
 }
 
+TEST(TensorBundleTest, LookupMany) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("foo"));
+    TF_EXPECT_OK(writer.Add("foo_000", Constant_100x100<float>(0)));
+    TF_EXPECT_OK(writer.Add("foo_001", Constant_2x3<float>(1)));
+    TF_EXPECT_OK(writer.Add("foo_002", Constant_2x3<int32>(2)));
+    TF_EXPECT_OK(writer.Add("foo_003", Constant_2x3<tstring>("three")));
+    TF_EXPECT_OK(writer.Add("foo_004", Constant_100x100<double>(4)));
+    TF_EXPECT_OK(writer.Add("foo_005", Constant_2x3<double>(5)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  const std::vector<string> keys = {"foo_005", "foo_000", "foo_003",
+                                    "foo_001", "foo_004", "foo_002"};
+  const std::vector<Tensor> expected = {
+      Constant_2x3<double>(5),        Constant_100x100<float>(0),
+      Constant_2x3<tstring>("three"), Constant_2x3<float>(1),
+      Constant_100x100<double>(4),    Constant_2x3<int32>(2)};
+  thread::ThreadPool pool(Env::Default(), "lookup_many", 4);
+  // Exercises a coalesced read of all entries, reads of single entries, and
+  // a mix of both.
+  for (int64_t max_coalesced_read_bytes : {int64_t{16} << 20, int64_t{1},
+                                           int64_t{1} << 10}) {
+    for (thread::ThreadPool* options_pool :
+         {static_cast<thread::ThreadPool*>(nullptr), &pool}) {
+      BundleReader reader(Env::Default(), Prefix("foo"));
+      TF_ASSERT_OK(reader.status());
+      std::vector<Tensor> vals;
+      std::vector<Tensor*> val_ptrs;
+      vals.reserve(expected.size());
+      for (const Tensor& t : expected) {
+        vals.emplace_back(t.dtype(), t.shape());
+      }
+      for (Tensor& t : vals) val_ptrs.push_back(&t);
+      BundleReader::LookupManyOptions options;
+      options.pool = options_pool;
+      options.max_outstanding_reads = 2;
+      options.max_coalesced_read_bytes = max_coalesced_read_bytes;
+      TF_ASSERT_OK(reader.LookupMany(keys, val_ptrs, options));
+      test::ExpectTensorEqual<double>(vals[0], expected[0]);
+      test::ExpectTensorEqual<float>(vals[1], expected[1]);
+      test::ExpectTensorEqual<tstring>(vals[2], expected[2]);
+      test::ExpectTensorEqual<float>(vals[3], expected[3]);
+      test::ExpectTensorEqual<double>(vals[4], expected[4]);
+      test::ExpectTensorEqual<int32>(vals[5], expected[5]);
+    }
+  }
+}
+
+TEST(TensorBundleTest, LookupManyErrors) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("foo"));
+    TF_EXPECT_OK(writer.Add("foo_000", Constant_2x3<float>(0)));
+    TF_EXPECT_OK(writer.Add("foo_001", Constant_2x3<float>(1)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("foo"));
+  TF_ASSERT_OK(reader.status());
+  Tensor val0(DT_FLOAT, TensorShape({2, 3}));
+  Tensor val1(DT_FLOAT, TensorShape({3, 3}));
+  std::vector<string> keys = {"foo_000", "foo_001"};
+  std::vector<Tensor*> vals = {&val0, &val1};
+  EXPECT_TRUE(absl::IsDataLoss(
+      reader.LookupMany(keys, vals, BundleReader::LookupManyOptions())));
+  keys[1] = "foo_002";
+  EXPECT_TRUE(absl::IsNotFound(
+      reader.LookupMany(keys, vals, BundleReader::LookupManyOptions())));
+}
+
+TEST(TensorBundleTest, MemmappedLookup) {
+  {
+    BundleWriter::Options options;
+    options.data_alignment = 64;
+    BundleWriter writer(Env::Default(), Prefix("foo"), options);
+    TF_EXPECT_OK(writer.Add("foo_000", Constant_2x3<float>(0)));
+    TF_EXPECT_OK(writer.Add("foo_001", Constant_100x100<double>(1)));
+    TF_EXPECT_OK(writer.Add("foo_002", Constant_2x3<tstring>("two")));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  Tensor val0(DT_FLOAT, TensorShape({2, 3}));
+  Tensor val1(DT_DOUBLE, TensorShape({100, 100}));
+  Tensor val2(DT_STRING, TensorShape({2, 3}));
+  Tensor val1_again(DT_DOUBLE, TensorShape({100, 100}));
+  {
+    BundleReader::Options options;
+    options.use_mmap = true;
+    BundleReader reader(Env::Default(), Prefix("foo"), options);
+    TF_ASSERT_OK(reader.status());
+    TF_ASSERT_OK(reader.Lookup("foo_000", &val0));
+    TF_ASSERT_OK(reader.Lookup("foo_001", &val1));
+    TF_ASSERT_OK(reader.Lookup("foo_002", &val2));
+    TF_ASSERT_OK(reader.Lookup("foo_001", &val1_again));
+  }
+  // The tensors alias the mapping, which outlives the reader.
+  EXPECT_EQ(val1.tensor_data().data(), val1_again.tensor_data().data());
+  test::ExpectTensorEqual<float>(val0, Constant_2x3<float>(0));
+  test::ExpectTensorEqual<double>(val1, Constant_100x100<double>(1));
+  test::ExpectTensorEqual<tstring>(val2, Constant_2x3<tstring>("two"));
+}
+
+TEST(TensorBundleTest, MemmappedLookupOfUnalignedData) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("foo"));
+    TF_EXPECT_OK(writer.Add("foo_000", Constant_2x3<int8>(0)));
+    TF_EXPECT_OK(writer.Add("foo_001", Constant_2x3<float>(1)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader::Options options;
+  options.use_mmap = true;
+  BundleReader reader(Env::Default(), Prefix("foo"), options);
+  TF_ASSERT_OK(reader.status());
+  Expect<int8>(&reader, "foo_000", Constant_2x3<int8>(0));
+  Expect<float>(&reader, "foo_001", Constant_2x3<float>(1));
+}
+
 absl::Status CreateFile(Env* env, const std::string& fname) {
   std::unique_ptr<WritableFile> file;
   TF_RETURN_IF_ERROR(env->NewWritableFile(fname, &file));
@@ -1319,15 +1319,22 @@ bool DTensorDevice::IsSparseDTensor(TFE_Context* context,
 std::unordered_map<std::string, int> DTensorDevice::GetStats(
     TFE_Context* context, TF_Status* status) const {
   const auto fm_stats = function_manager_->GetStats();
+  const auto mm_stats = module_manager_->GetStats();
   mutex_lock lock(mu_);
   const auto eager_stats = tensorflow::unwrap(context)->GetCacheStats();
   std::unordered_map<std::string, int> result{
       {"function_manager.hit", fm_stats.hits},
       {"function_manager.miss", fm_stats.misses},
       {"function_manager.size", fm_stats.size},
+      // A module manager miss is an SPMD expansion of the operation.
+      {"module_manager.hit", mm_stats.hits},
+      {"module_manager.miss", mm_stats.misses},
+      {"module_manager.size", mm_stats.size},
       {"eager_pure_optimization.hit", stats_.eager_pure_optimization_hits},
       {"device_cache.size", eager_stats.device_cache_size},
       {"kernel_cache.size", eager_stats.kernel_cache_size},
+      {"kernel_cache.hit", eager_stats.kernel_cache_hits},
+      {"kernel_cache.miss", eager_stats.kernel_cache_misses},
       {"local_rendezvous_cache.active.size",
        eager_stats.local_rendezvous_cache_active_size},
   };
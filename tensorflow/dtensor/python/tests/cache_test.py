@@ -118,6 +118,9 @@ class DTensorDeviceCacheTest(test_util.DTensorBaseTest):
     diff = {key: stats2[key] - stats1[key] for key in stats1.keys()}
     self.assertEqual(diff["function_manager.miss"], 1)
     self.assertEqual(diff["function_manager.hit"], 1)
+    # The SPMD expansion of the first call is reused by the second.
+    self.assertEqual(diff["module_manager.miss"], 1)
+    self.assertEqual(diff["module_manager.hit"], 1)
 
   def testFunctionInputConstantFoldingCacheMiss(self):
 
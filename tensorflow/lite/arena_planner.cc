@@ -18,8 +18,10 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <limits>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -33,6 +35,38 @@ constexpr int32_t kLastActiveNodeUndefined =
     std::numeric_limits<int32_t>::max();
 constexpr int32_t kNodeNotAssigned = std::numeric_limits<int32_t>::max();
 constexpr int32_t kScalarTensorBytes = 4;
+constexpr int32_t kOfflineMemoryAllocationVersion = 1;
+constexpr int kOfflineMemoryAllocationHeaderSize = 3;
+
+bool ParseOfflineMemoryAllocation(const char* data, size_t size,
+                                  int subgraph_index,
+                                  std::vector<int32_t>* offsets) {
+  if (size % sizeof(int32_t) != 0 ||
+      size < kOfflineMemoryAllocationHeaderSize * sizeof(int32_t)) {
+    return false;
+  }
+  std::vector<int32_t> values(size / sizeof(int32_t));
+  std::memcpy(values.data(), data, size);
+  if (values[0] != kOfflineMemoryAllocationVersion ||
+      values[1] != subgraph_index || values[2] < 0 ||
+      static_cast<size_t>(values[2]) !=
+          values.size() - kOfflineMemoryAllocationHeaderSize) {
+    return false;
+  }
+  offsets->assign(values.begin() + kOfflineMemoryAllocationHeaderSize,
+                  values.end());
+  return true;
+}
+
+std::string SerializeOfflineMemoryAllocation(
+    int subgraph_index, const std::vector<int32_t>& offsets) {
+  std::vector<int32_t> values = {kOfflineMemoryAllocationVersion,
+                                 subgraph_index,
+                                 static_cast<int32_t>(offsets.size())};
+  values.insert(values.end(), offsets.begin(), offsets.end());
+  return std::string(reinterpret_cast<const char*>(values.data()),
+                     values.size() * sizeof(int32_t));
+}
 
 ArenaPlanner::ArenaPlanner(TfLiteContext* context,
                            std::unique_ptr<GraphInfo> graph_info,
@@ -443,6 +477,14 @@ void ArenaPlanner::CreateTensorAllocationVector(
     std::vector<int32_t>* tensors_to_allocate) {
   const TfLiteTensor* tensors = this->graph_info_->tensors();
   auto tensor_compare = [&](int idx1, int idx2) {
+    // Tensors with an offline offset are allocated first, so that the other
+    // tensors are planned around them.
+    const bool offline1 = GetOfflineOffset(idx1) >= 0;
+    const bool offline2 = GetOfflineOffset(idx2) >= 0;
+    if (offline1 != offline2) {
+      return offline1;
+    }
+
     // Tensors that have lifespan through the whole model inference time are
     // allocated at the beginning of memory slice. Their respective order
     // doesn't matter in fact, so here they are sorted by index.
@@ -541,10 +583,18 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
       }
     }
     if (tensor.allocation_type == kTfLiteArenaRw) {
-      TF_LITE_ENSURE_STATUS(
-          arena_.Allocate(context_, tensor_alignment_, tensor.bytes,
-                          tensor_index, alloc_node_[tensor_index],
-                          dealloc_node_[tensor_index], &allocs_[tensor_index]));
+      const int32_t offline_offset = GetOfflineOffset(tensor_index);
+      if (offline_offset < 0 || tensor.bytes == 0 ||
+          !arena_.TryAllocateAt(tensor_alignment_, offline_offset,
+                                tensor.bytes, tensor_index,
+                                alloc_node_[tensor_index],
+                                dealloc_node_[tensor_index],
+                                &allocs_[tensor_index])) {
+        TF_LITE_ENSURE_STATUS(arena_.Allocate(
+            context_, tensor_alignment_, tensor.bytes, tensor_index,
+            alloc_node_[tensor_index], dealloc_node_[tensor_index],
+            &allocs_[tensor_index]));
+      }
     }
     // Check allocs_[].size to prevent from reallocation of persistent tensors.
     // Only allocate ArenaRwPersistent tensors which own their buffer.
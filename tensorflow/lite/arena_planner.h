@@ -18,8 +18,10 @@ limitations under the License.
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/lite/core/c/common.h"
@@ -32,6 +34,26 @@ namespace tflite {
 
 constexpr const int kDefaultArenaAlignment = 64;
 
+// Name of the model metadata holding arena offsets planned offline, e.g. by a
+// converter that can afford a better packing than the one done at runtime. As
+// in TFLite Micro, it is an array of little-endian int32 values:
+// [version (1), subgraph index, number of tensors, offset of each tensor],
+// where an offset of -1 lets the tensor be planned at runtime.
+constexpr char kOfflineMemoryAllocationMetadataKey[] =
+    "OfflineMemoryAllocation";
+
+// Parses `kOfflineMemoryAllocationMetadataKey` metadata into the offsets of the
+// tensors of the subgraph at `subgraph_index`. Returns false if the metadata is
+// malformed, or for another subgraph.
+bool ParseOfflineMemoryAllocation(const char* data, size_t size,
+                                  int subgraph_index,
+                                  std::vector<int32_t>* offsets);
+
+// Serializes the offsets of the tensors of the subgraph at `subgraph_index`
+// into `kOfflineMemoryAllocationMetadataKey` metadata.
+std::string SerializeOfflineMemoryAllocation(
+    int subgraph_index, const std::vector<int32_t>& offsets);
+
 // A memory planner that makes all the allocations using arenas.
 //
 // Before a model is executed by the interpreter, this class determines when
@@ -72,7 +94,24 @@ class ArenaPlanner : public MemoryPlanner {
   // Returns the base arena location for a given allocation type.
   std::intptr_t BasePointer(TfLiteAllocationType type);
 
+  // Sets the offsets, indexed by tensor, at which `kTfLiteArenaRw` tensors are
+  // placed in the arena, e.g. as planned offline. They are placed before the
+  // other tensors. Tensors without an offset, with a negative one, or whose
+  // offset would overlap with another live tensor, e.g. because the model was
+  // resized, are planned at runtime instead.
+  void SetOfflineOffsets(std::vector<int32_t> offline_offsets) {
+    offline_offsets_ = std::move(offline_offsets);
+  }
+
  private:
+  // Returns the offline offset of `tensor_index`, or -1 if it has none.
+  int32_t GetOfflineOffset(int tensor_index) const {
+    return tensor_index >= 0 &&
+                   static_cast<size_t>(tensor_index) < offline_offsets_.size()
+               ? offline_offsets_[tensor_index]
+               : -1;
+  }
+
   // Check whether the input tensor's memory may be shared the output tensor.
   // tensor_changed: true if the output tensor modifies the tensor data. For
   // example, `Reshape` doesn't modify data but Add does.
@@ -166,6 +205,9 @@ class ArenaPlanner : public MemoryPlanner {
 
   // Store number of references to each tensor.
   std::vector<int> refcounts_;
+
+  // Offsets planned offline, see `SetOfflineOffsets`.
+  std::vector<int32_t> offline_offsets_;
 };
 
 }  // namespace tflite
@@ -22,6 +22,7 @@ limitations under the License.
 #include <initializer_list>
 #include <memory>
 #include <set>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -370,6 +371,47 @@ TEST_F(ArenaPlannerTest, AllocsCorrectlyReset) {
   EXPECT_EQ(GetOffset(1), 4);
 }
 
+TEST_F(ArenaPlannerTest, SimpleGraphWithOfflineOffsets) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  // Tensors 4 and 5 are live at the same time, so only the first one to be
+  // allocated, i.e. the largest, gets its offline offset.
+  planner_->SetOfflineOffsets({-1, -1, 128, -1, 256, 256});
+  Execute(0, graph.nodes().size() - 1);
+
+  EXPECT_EQ(GetOffset(2), 128);
+  EXPECT_EQ(GetOffset(5), 256);
+  // The other tensors are planned in the gaps left by the offline ones.
+  EXPECT_EQ(GetOffset(4), 0);
+  EXPECT_EQ(GetOffset(0), GetOffsetAfter(4));
+  EXPECT_EQ(GetOffset(1), GetOffsetAfter(0));
+}
+
+TEST(OfflineMemoryAllocationTest, SerializeAndParse) {
+  const std::vector<int32_t> offsets = {-1, 0, 64, 128};
+  const std::string metadata = SerializeOfflineMemoryAllocation(1, offsets);
+
+  std::vector<int32_t> parsed_offsets;
+  ASSERT_TRUE(ParseOfflineMemoryAllocation(metadata.data(), metadata.size(),
+                                           /*subgraph_index=*/1,
+                                           &parsed_offsets));
+  EXPECT_EQ(parsed_offsets, offsets);
+
+  EXPECT_FALSE(ParseOfflineMemoryAllocation(metadata.data(), metadata.size(),
+                                            /*subgraph_index=*/0,
+                                            &parsed_offsets));
+  EXPECT_FALSE(ParseOfflineMemoryAllocation(
+      metadata.data(), metadata.size() - sizeof(int32_t),
+      /*subgraph_index=*/1, &parsed_offsets));
+}
+
 TEST_F(ArenaPlannerTest, SimpleGraphInputsPreserved) {
   TestGraph graph({0, 1},
                   {
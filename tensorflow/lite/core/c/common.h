@@ -313,6 +313,9 @@ typedef enum TfLiteQuantizationType {
   /// Affine quantization (with support for per-channel quantization).
   /// Corresponds to TfLiteAffineQuantization.
   kTfLiteAffineQuantization = 1,
+  /// Block-wise quantization of the innermost dimension.
+  /// Corresponds to TfLiteBlockwiseQuantization.
+  kTfLiteBlockwiseQuantization = 2,
 } TfLiteQuantizationType;
 
 /// Structure specifying the quantization used by the tensor, if-any.
@@ -338,6 +341,22 @@ typedef struct TfLiteAffineQuantization {
   int32_t quantized_dimension;
 } TfLiteAffineQuantization;
 
+/// Parameters for block-wise quantization. The innermost dimension of the
+/// tensor is split into blocks of `blocksize` consecutive values, each with its
+/// own scale, e.g. a [N, K] tensor has a [N, K / blocksize] tensor of scales.
+/// The scales and zero points are stored in other tensors of the subgraph.
+typedef struct TfLiteBlockwiseQuantization {
+  /// Index of the FLOAT32 or FLOAT16 tensor holding the scales.
+  int32_t scale;
+  /// Index of the tensor holding the zero points, or -1 if all the zero points
+  /// are 0.
+  int32_t zero_point;
+  int32_t blocksize;
+  /// The dimension of the tensor that the blocks of every scale belong to,
+  /// e.g. the output channel dimension of a filter.
+  int32_t quantized_dimension;
+} TfLiteBlockwiseQuantization;
+
 /// A union of pointers that points to memory for a given tensor.
 ///
 /// Do not access these members directly, if possible, use
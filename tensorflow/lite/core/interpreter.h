@@ -755,6 +755,55 @@ class Interpreter {
   /// \brief Apply InterpreterOptions which tunes behavior of the interpreter.
   TfLiteStatus ApplyOptions(InterpreterOptions* options);
 
+  /// \warning This is an experimental API and subject to change. \n
+  /// \brief Creates in `execution_context` an interpreter that runs the same
+  /// model as this one and that can be invoked concurrently with it, from
+  /// another thread. It has its own tensor arenas, variables, resources and
+  /// kernel state, but shares the read-only tensors (e.g. the weights), the
+  /// node options and the execution plan of this interpreter, which must
+  /// outlive it.
+  ///
+  /// This must be called before `AllocateTensors` and before any delegate is
+  /// applied to this interpreter. The default delegates of this interpreter
+  /// are created anew for the execution context; other delegates need to be
+  /// applied to it separately, e.g. an XNNPACK delegate per context sharing a
+  /// weights cache so that the packed weights are shared too.
+  TfLiteStatus CreateExecutionContext(
+      std::unique_ptr<Interpreter>* execution_context) const;
+
+  /// \warning This is an experimental API and subject to change. \n
+  /// \brief Prepares an execution context (see `CreateExecutionContext`) per
+  /// shape bucket, in which the inputs are resized to the shapes of the bucket
+  /// and the tensors are allocated. Running the model on one of these shapes
+  /// then only needs selecting the context of its bucket, instead of resizing
+  /// the inputs, which prepares all the nodes again, plans the arena again and
+  /// re-initializes the delegate kernels.
+  ///
+  /// `buckets[i][j]` is the shape of the j-th input of the primary subgraph in
+  /// the i-th bucket. Previously prepared buckets are discarded. The same
+  /// restrictions as for `CreateExecutionContext` apply.
+  TfLiteStatus PrepareShapeBuckets(
+      const std::vector<std::vector<std::vector<int>>>& buckets);
+
+  /// \warning This is an experimental API and subject to change. \n
+  /// \brief Returns the index of the smallest prepared shape bucket that can
+  /// hold inputs of shapes `input_shapes`, i.e. in which each input has the
+  /// same rank and dimensions at least as large, or -1 if there is none.
+  /// Inputs smaller than the shapes of the bucket need to be padded by the
+  /// caller.
+  int FindShapeBucket(const std::vector<std::vector<int>>& input_shapes) const;
+
+  /// \warning This is an experimental API and subject to change. \n
+  /// \brief Returns the execution context prepared for the shape bucket at
+  /// `bucket_index`, or nullptr if the index is out of range.
+  Interpreter* shape_bucket(int bucket_index) {
+    if (bucket_index < 0 ||
+        static_cast<size_t>(bucket_index) >= shape_buckets_.size()) {
+      return nullptr;
+    }
+    return shape_buckets_[bucket_index].get();
+  }
+
 #ifndef DOXYGEN_SKIP
   /// \warning This is an experimental API and subject to change. \n
   /// \brief Return the number of subgraphs in the model.
@@ -1000,6 +1049,11 @@ class Interpreter {
   // It "resets" to true at the beginning of each `Invoke`.
   std::atomic_flag continue_invocation_ = ATOMIC_FLAG_INIT;
   bool cancellation_enabled_ = false;
+
+  // Execution contexts prepared by PrepareShapeBuckets, and the shapes of
+  // their inputs.
+  std::vector<std::unique_ptr<Interpreter>> shape_buckets_;
+  std::vector<std::vector<std::vector<int>>> shape_bucket_shapes_;
 };
 
 }  // namespace impl
@@ -408,6 +408,48 @@ TfLiteStatus InterpreterBuilder::ParseQuantization(
     const QuantizationParameters* src_quantization,
     TfLiteQuantization* quantization, const std::vector<int>& dims) {
   quantization->type = kTfLiteNoQuantization;
+  // Block-wise quantization keeps its scales and zero points in other
+  // tensors, so its `scale` and `zero_point` fields are empty.
+  if (src_quantization &&
+      src_quantization->details_type() ==
+          QuantizationDetails_BlockwiseQuantization) {
+    const BlockwiseQuantization* src_blockwise =
+        src_quantization->details_as_BlockwiseQuantization();
+    if (!src_blockwise || src_blockwise->scales() < 0 ||
+        src_blockwise->zero_points() < -1 ||
+        src_blockwise->block_size() <= 0) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Invalid block-wise quantization parameters.");
+      return kTfLiteError;
+    }
+    if (!dims.empty() && dims.back() % src_blockwise->block_size() != 0) {
+      TF_LITE_REPORT_ERROR(
+          error_reporter_,
+          "Innermost dimension %d is not a multiple of the block size %d.",
+          dims.back(), src_blockwise->block_size());
+      return kTfLiteError;
+    }
+    if (src_quantization->quantized_dimension() < 0 ||
+        (!dims.empty() &&
+         src_quantization->quantized_dimension() >= dims.size())) {
+      TF_LITE_REPORT_ERROR(
+          error_reporter_,
+          "quantized_dimension must be in range [0, %d). Was %d.", dims.size(),
+          src_quantization->quantized_dimension());
+      return kTfLiteError;
+    }
+    quantization->type = kTfLiteBlockwiseQuantization;
+    auto* blockwise_quantization =
+        reinterpret_cast<TfLiteBlockwiseQuantization*>(
+            malloc(sizeof(TfLiteBlockwiseQuantization)));
+    blockwise_quantization->scale = src_blockwise->scales();
+    blockwise_quantization->zero_point = src_blockwise->zero_points();
+    blockwise_quantization->blocksize = src_blockwise->block_size();
+    blockwise_quantization->quantized_dimension =
+        src_quantization->quantized_dimension();
+    quantization->params = reinterpret_cast<void*>(blockwise_quantization);
+    return kTfLiteOk;
+  }
   if (!src_quantization || !src_quantization->scale() ||
       src_quantization->scale()->size() == 0) {
     return kTfLiteOk;
@@ -662,6 +704,18 @@ TfLiteStatus InterpreterBuilder::ParseTensors(
       TF_LITE_REPORT_ERROR(error_reporter_,
                            "Tensor %d has invalid quantization parameters.", i);
       status = kTfLiteError;
+    } else if (quantization.type == kTfLiteBlockwiseQuantization) {
+      const auto* blockwise_quantization =
+          static_cast<const TfLiteBlockwiseQuantization*>(quantization.params);
+      if (blockwise_quantization->scale >= tensors->size() ||
+          blockwise_quantization->zero_point >=
+              static_cast<int>(tensors->size())) {
+        TF_LITE_REPORT_ERROR(error_reporter_,
+                             "Tensor %d has out of range block-wise "
+                             "quantization tensors.",
+                             i);
+        status = kTfLiteError;
+      }
     }
     if (subgraph_info) subgraph_info->quantizations[i] = quantization;
 
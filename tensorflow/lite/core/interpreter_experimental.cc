@@ -23,6 +23,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/lite/c/common_internal.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/core/async/async_signature_runner.h"
 #include "tensorflow/lite/core/c/c_api_types.h"
@@ -153,6 +154,79 @@ TfLiteStatus Interpreter::ApplyOptions(InterpreterOptions* options) {
   return ApplyOptionsImpl(options);
 }
 
+TfLiteStatus Interpreter::CreateExecutionContext(
+    std::unique_ptr<Interpreter>* execution_context) const {
+  auto clone = std::make_unique<Interpreter>(error_reporter_);
+  if (subgraphs_.size() > 1) {
+    clone->AddSubgraphs(subgraphs_.size() - 1);
+  }
+  TF_LITE_ENSURE_STATUS(
+      clone->SetNumThreads(context_->recommended_num_threads));
+  TF_LITE_ENSURE_STATUS(clone->ApplyOptionsImpl(options_.get()));
+  for (int i = 0; i < subgraphs_.size(); ++i) {
+    TF_LITE_ENSURE_STATUS(subgraphs_[i]->CloneGraph(clone->subgraph(i)));
+  }
+  clone->SetSignatureDef(signature_defs_);
+  TF_LITE_ENSURE_STATUS(clone->SetMetadata(metadata_));
+  // Each execution context gets its own instances of the default delegates.
+  clone->lazy_delegate_providers_ = lazy_delegate_providers_;
+  if (cancellation_enabled_) {
+    TF_LITE_ENSURE_STATUS(clone->EnableCancellation());
+  }
+  *execution_context = std::move(clone);
+  return kTfLiteOk;
+}
+
+TfLiteStatus Interpreter::PrepareShapeBuckets(
+    const std::vector<std::vector<std::vector<int>>>& buckets) {
+  shape_buckets_.clear();
+  shape_bucket_shapes_.clear();
+  std::vector<std::unique_ptr<Interpreter>> contexts(buckets.size());
+  for (int i = 0; i < buckets.size(); ++i) {
+    if (buckets[i].size() != inputs().size()) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Shape bucket %d has %zu shapes for %zu inputs.", i,
+                           buckets[i].size(), inputs().size());
+      return kTfLiteError;
+    }
+    TF_LITE_ENSURE_STATUS(CreateExecutionContext(&contexts[i]));
+    for (int j = 0; j < buckets[i].size(); ++j) {
+      TF_LITE_ENSURE_STATUS(
+          contexts[i]->ResizeInputTensor(inputs()[j], buckets[i][j]));
+    }
+    TF_LITE_ENSURE_STATUS(contexts[i]->AllocateTensors());
+  }
+  shape_buckets_ = std::move(contexts);
+  shape_bucket_shapes_ = buckets;
+  return kTfLiteOk;
+}
+
+int Interpreter::FindShapeBucket(
+    const std::vector<std::vector<int>>& input_shapes) const {
+  int best_bucket = -1;
+  size_t best_num_elements = 0;
+  for (int i = 0; i < shape_bucket_shapes_.size(); ++i) {
+    const std::vector<std::vector<int>>& bucket = shape_bucket_shapes_[i];
+    if (bucket.size() != input_shapes.size()) continue;
+    bool fits = true;
+    size_t num_elements = 0;
+    for (int j = 0; j < bucket.size() && fits; ++j) {
+      fits = bucket[j].size() == input_shapes[j].size();
+      size_t input_num_elements = 1;
+      for (int k = 0; k < bucket[j].size() && fits; ++k) {
+        fits = bucket[j][k] >= input_shapes[j][k];
+        input_num_elements *= bucket[j][k];
+      }
+      num_elements += input_num_elements;
+    }
+    if (fits && (best_bucket == -1 || num_elements < best_num_elements)) {
+      best_bucket = i;
+      best_num_elements = num_elements;
+    }
+  }
+  return best_bucket;
+}
+
 async::AsyncSignatureRunner* Interpreter::GetAsyncSignatureRunner(
     const char* signature_key) {
   // Handles nullptr signature key.
@@ -17,14 +17,18 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <condition_variable>  // NOLINT(build/c++11)
 #include <cstdarg>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <functional>
 #include <iterator>
 #include <memory>
+#include <mutex>  // NOLINT(build/c++11)
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -41,6 +45,7 @@ limitations under the License.
 #include "tensorflow/lite/core/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
 #include "tensorflow/lite/graph_info.h"
 #include "tensorflow/lite/memory_planner.h"
 #include "tensorflow/lite/minimal_logging.h"
@@ -191,6 +196,41 @@ TfLiteStatus VerifyCustomAllocationForTensor(
   return kTfLiteOk;
 }
 
+// The CPU backend context of the calling thread, if it is a thread of a
+// `Subgraph::ParallelInvoker`. It replaces the one of the interpreter, which
+// must not be used by several threads at a time.
+thread_local TfLiteExternalContext* parallel_invoke_cpu_backend_context =
+    nullptr;
+
+// Returns true if 'node' must not run concurrently with any other node, as it
+// may have side effects beyond its output tensors, or may not be thread-safe.
+bool MustInvokeSerially(const TfLiteNode& node,
+                        const TfLiteRegistration& registration,
+                        const TfLiteTensor* tensors) {
+  if (node.delegate != nullptr || registration.registration_external) {
+    return true;
+  }
+  switch (registration.builtin_code) {
+    case kTfLiteBuiltinCustom:
+    case kTfLiteBuiltinCallOnce:
+    case kTfLiteBuiltinIf:
+    case kTfLiteBuiltinWhile:
+    case kTfLiteBuiltinStablehloComposite:
+    case kTfLiteBuiltinStablehloWhile:
+      return true;
+    default:
+      break;
+  }
+  for (const TfLiteIntArray* tensor_indices : {node.inputs, node.outputs}) {
+    for (int tensor_index : TfLiteIntArrayView(tensor_indices)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      const TfLiteType type = tensors[tensor_index].type;
+      if (type == kTfLiteResource || type == kTfLiteVariant) return true;
+    }
+  }
+  return false;
+}
+
 }  // namespace
 
 // A trivial implementation of GraphInfo around the Interpreter.
@@ -311,7 +351,7 @@ void Subgraph::CleanupNode(int node_index) {
   TfLiteIntArrayFree(node.outputs);
   TfLiteIntArrayFree(node.temporaries);
   TfLiteIntArrayFree(node.intermediates);
-  if (node.builtin_data) free(node.builtin_data);
+  if (node.builtin_data && owns_builtin_data_) free(node.builtin_data);
   OpFree(registration, node.user_data);
   node.builtin_data = nullptr;
 }
@@ -617,6 +657,11 @@ TfLiteStatus Subgraph::ReplaceNodeSubsetsWithDelegateKernels(
 TfLiteExternalContext* Subgraph::GetExternalContext(
     TfLiteExternalContextType type) {
   if (static_cast<int>(type) >= 0 && type < kTfLiteMaxExternalContexts) {
+    if (type == kTfLiteCpuBackendContext &&
+        parallel_invoke_cpu_backend_context != nullptr &&
+        external_contexts_[type] != nullptr) {
+      return parallel_invoke_cpu_backend_context;
+    }
     return external_contexts_[type];
   }
   return nullptr;
@@ -1137,6 +1182,118 @@ TfLiteStatus Subgraph::AddNodeWithParameters(
   return kTfLiteOk;
 }
 
+namespace {
+// Returns a deep copy of `quantization`.
+TfLiteQuantization CopyQuantization(const TfLiteQuantization& quantization) {
+  TfLiteQuantization copy;
+  copy.type = kTfLiteNoQuantization;
+  copy.params = nullptr;
+  if (quantization.type == kTfLiteAffineQuantization && quantization.params) {
+    const auto* params =
+        static_cast<const TfLiteAffineQuantization*>(quantization.params);
+    auto* params_copy = static_cast<TfLiteAffineQuantization*>(
+        calloc(1, sizeof(TfLiteAffineQuantization)));
+    params_copy->scale = TfLiteFloatArrayCopy(params->scale);
+    params_copy->zero_point = TfLiteIntArrayCopy(params->zero_point);
+    params_copy->quantized_dimension = params->quantized_dimension;
+    copy.type = kTfLiteAffineQuantization;
+    copy.params = params_copy;
+  } else if (quantization.type == kTfLiteBlockwiseQuantization &&
+             quantization.params) {
+    auto* params_copy = static_cast<TfLiteBlockwiseQuantization*>(
+        malloc(sizeof(TfLiteBlockwiseQuantization)));
+    *params_copy =
+        *static_cast<const TfLiteBlockwiseQuantization*>(quantization.params);
+    copy.type = kTfLiteBlockwiseQuantization;
+    copy.params = params_copy;
+  }
+  return copy;
+}
+
+std::vector<int> TfLiteIntArrayToVector(const TfLiteIntArray* array) {
+  if (array == nullptr) return {};
+  return std::vector<int>(array->data, array->data + array->size);
+}
+}  // namespace
+
+TfLiteStatus Subgraph::CloneGraph(Subgraph* clone) const {
+  if (state_ != kStateUninvokable || !delegates_applied_.empty()) {
+    clone->ReportError(
+        "CloneGraph is only supported before tensors are allocated and "
+        "delegates are applied.");
+    return kTfLiteError;
+  }
+  if (clone->tensors_size() != 0 || clone->nodes_size() != 0) {
+    clone->ReportError("CloneGraph requires an empty subgraph to clone into.");
+    return kTfLiteError;
+  }
+  clone->allocation_ = allocation_;
+  TF_LITE_ENSURE_STATUS(clone->AddTensors(tensors_.size()));
+  for (int i = 0; i < tensors_.size(); ++i) {
+    const TfLiteTensor& tensor = tensors_[i];
+    const std::vector<int> dims = TfLiteIntArrayToVector(tensor.dims);
+    if (tensor.allocation_type == kTfLiteMmapRo) {
+      if (tensor.sparsity != nullptr) {
+        clone->ReportError("CloneGraph does not support sparse tensor %d.", i);
+        return kTfLiteError;
+      }
+      const auto buffer_identifier = tensor_buffer_identifiers_.find(i);
+      TF_LITE_ENSURE_STATUS(clone->SetTensorParametersReadOnly(
+          i, tensor.type, tensor.name, dims,
+          CopyQuantization(tensor.quantization), tensor.data.raw_const,
+          tensor.bytes, allocation_, /*sparsity=*/nullptr,
+          buffer_identifier == tensor_buffer_identifiers_.end()
+              ? kTfLiteNoBufferIdentifier
+              : buffer_identifier->second));
+    } else if (tensor.data.raw != nullptr) {
+      clone->ReportError("CloneGraph does not support tensor %d with data.",
+                         i);
+      return kTfLiteError;
+    } else {
+      TF_LITE_ENSURE_STATUS(clone->SetTensorParametersReadWrite(
+          i, tensor.type, tensor.name, dims,
+          CopyQuantization(tensor.quantization), tensor.is_variable,
+          TfLiteIntArrayToVector(tensor.dims_signature)));
+    }
+  }
+  TF_LITE_ENSURE_STATUS(clone->SetInputs(inputs_));
+  TF_LITE_ENSURE_STATUS(clone->SetOutputs(outputs_));
+  TF_LITE_ENSURE_STATUS(clone->SetVariables(variables_));
+
+  // The nodes are copied directly rather than with AddNodeWithParameters,
+  // which would take the ownership of their builtin data.
+  clone->owns_builtin_data_ = false;
+  clone->nodes_and_registration_.reserve(nodes_and_registration_.size());
+  for (const auto& [node, registration] : nodes_and_registration_) {
+    clone->nodes_and_registration_.emplace_back();
+    auto& node_and_reg = clone->nodes_and_registration_.back();
+    TfLiteNode& node_copy = node_and_reg.first;
+    node_copy.inputs = TfLiteIntArrayCopy(node.inputs);
+    node_copy.outputs = TfLiteIntArrayCopy(node.outputs);
+    node_copy.intermediates = TfLiteIntArrayCopy(node.intermediates);
+    node_copy.temporaries = TfLiteIntArrayCreate(0);
+    if (node.custom_initial_data) {
+      node_copy.user_data =
+          clone->OpInit(registration, static_cast<const char*>(
+                                          node.custom_initial_data),
+                        node.custom_initial_data_size);
+    } else {
+      node_copy.user_data = clone->OpInit(
+          registration, static_cast<const char*>(node.builtin_data), 0);
+    }
+    node_copy.builtin_data = node.builtin_data;
+    node_copy.custom_initial_data = node.custom_initial_data;
+    node_copy.custom_initial_data_size = node.custom_initial_data_size;
+    node_copy.might_have_side_effect = node.might_have_side_effect;
+    node_copy.delegate = nullptr;
+    node_and_reg.second = registration;
+  }
+  clone->execution_plan_ = execution_plan_;
+  clone->state_ = kStateUninvokable;
+  if (!name_.empty()) clone->SetName(name_.c_str());
+  return kTfLiteOk;
+}
+
 namespace {
 // Returns true if any tensor identified by indexes in 'tensor_indexes' is
 // of type 'kTfLiteResource'. False otherwise.
@@ -1533,9 +1690,26 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
 #ifdef TFLITE_USE_SIMPLE_MEMORY_PLANNER
     memory_planner_.reset(new SimplePlanner(&context_, CreateGraphInfo()));
 #else
-    memory_planner_ = std::make_unique<ArenaPlanner>(
-        &context_, CreateGraphInfo(), ShouldPreserveAllTensors(),
+    // Nodes running concurrently must not share memory, as if all the
+    // tensors were preserved.
+    memory_planner_allows_parallel_invoke_ = NumParallelInvokeThreads() > 1;
+    auto arena_planner = std::make_unique<ArenaPlanner>(
+        &context_, CreateGraphInfo(),
+        ShouldPreserveAllTensors() || memory_planner_allows_parallel_invoke_,
         kDefaultTensorAlignment, subgraph_index_);
+    // Reuse the arena layout planned offline, if the model has one. Tensors
+    // added by kernels come after the ones of the model, and have no offset.
+    if (metadata_ != nullptr) {
+      auto it = metadata_->find(kOfflineMemoryAllocationMetadataKey);
+      std::vector<int32_t> offline_offsets;
+      if (it != metadata_->end() &&
+          ParseOfflineMemoryAllocation(it->second.data(), it->second.size(),
+                                       subgraph_index_, &offline_offsets) &&
+          offline_offsets.size() <= tensors_.size()) {
+        arena_planner->SetOfflineOffsets(std::move(offline_offsets));
+      }
+    }
+    memory_planner_ = std::move(arena_planner);
 #endif
     memory_planner_->PlanAllocations();
   }
@@ -1608,6 +1782,9 @@ TfLiteStatus Subgraph::InvokeImpl() {
     ReportError("Non-persistent memory is not available.");
     return kTfLiteError;
   }
+  if (NumParallelInvokeThreads() > 1 && CanInvokeInParallel()) {
+    return InvokeInParallel();
+  }
   TFLITE_SCOPED_TAGGED_DEFAULT_PROFILE(profiler_.get(), "Invoke");
 #ifdef TF_LITE_TENSORFLOW_PROFILER
   tensorflow::profiler::TraceMe* trace_subgraph =
@@ -1735,6 +1912,311 @@ TfLiteStatus Subgraph::InvokeImpl() {
   return status;
 }
 
+// Runs the nodes of an execution plan on the calling thread and a pool of
+// threads, as soon as the nodes they depend on have run.
+class Subgraph::ParallelInvoker {
+ public:
+  explicit ParallelInvoker(int num_threads) {
+    for (int i = 1; i < num_threads; ++i) {
+      threads_.emplace_back([this] { WorkerLoop(); });
+    }
+  }
+
+  ~ParallelInvoker() {
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& thread : threads_) thread.join();
+  }
+
+  ParallelInvoker(const ParallelInvoker&) = delete;
+  ParallelInvoker& operator=(const ParallelInvoker&) = delete;
+
+  int num_threads() const { return static_cast<int>(threads_.size()) + 1; }
+
+  // Computes the dependencies between the nodes of `execution_plan`, unless
+  // they were computed for the same execution plan already.
+  //
+  // A node depends on the last node writing each of its input tensors, and on
+  // the nodes reading or writing its output tensors since then. Variable input
+  // tensors count as written. Nodes for which `MustInvokeSerially()` holds
+  // depend on every node before them, and every node after them depends on
+  // them.
+  void MaybeComputeDependencies(
+      const std::vector<int>& execution_plan,
+      const std::vector<std::pair<TfLiteNode, TfLiteRegistration>>&
+          nodes_and_registration,
+      const TfLiteTensor* tensors, int num_tensors,
+      const ControlEdges* control_edges) {
+    if (execution_plan == execution_plan_) return;
+    execution_plan_ = execution_plan;
+    const int num_nodes = execution_plan.size();
+    successors_.assign(num_nodes, {});
+    num_predecessors_.assign(num_nodes, 0);
+
+    std::vector<int> last_writer(num_tensors, -1);
+    // Nodes that read each tensor since it was last written.
+    std::vector<std::vector<int>> readers(num_tensors);
+    // Nodes since the last node that must be invoked serially.
+    std::vector<int> since_last_serial;
+    int last_serial = -1;
+    std::vector<int> predecessors;
+    for (int i = 0; i < num_nodes; ++i) {
+      const auto& [node, registration] =
+          nodes_and_registration[execution_plan[i]];
+      predecessors.clear();
+      const bool serial = MustInvokeSerially(node, registration, tensors);
+      if (serial) {
+        predecessors.swap(since_last_serial);
+      }
+      if (last_serial >= 0) predecessors.push_back(last_serial);
+
+      auto write = [&](int tensor_index) {
+        if (last_writer[tensor_index] >= 0) {
+          predecessors.push_back(last_writer[tensor_index]);
+        }
+        predecessors.insert(predecessors.end(), readers[tensor_index].begin(),
+                            readers[tensor_index].end());
+        readers[tensor_index].clear();
+        last_writer[tensor_index] = i;
+      };
+      for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+        if (tensor_index == kTfLiteOptionalTensor) continue;
+        if (tensors[tensor_index].is_variable) {
+          write(tensor_index);
+        } else {
+          if (last_writer[tensor_index] >= 0) {
+            predecessors.push_back(last_writer[tensor_index]);
+          }
+          readers[tensor_index].push_back(i);
+        }
+      }
+      for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+        if (tensor_index == kTfLiteOptionalTensor) continue;
+        write(tensor_index);
+      }
+
+      std::sort(predecessors.begin(), predecessors.end());
+      predecessors.erase(std::unique(predecessors.begin(), predecessors.end()),
+                         predecessors.end());
+      for (int predecessor : predecessors) {
+        if (predecessor == i) continue;
+        successors_[predecessor].push_back(i);
+        ++num_predecessors_[i];
+      }
+
+      if (serial) {
+        since_last_serial.clear();
+        last_serial = i;
+      } else {
+        since_last_serial.push_back(i);
+      }
+    }
+
+    if (control_edges != nullptr && !control_edges->empty()) {
+      const int num_all_nodes = nodes_and_registration.size();
+      std::vector<int> execution_plan_index(num_all_nodes, -1);
+      for (int i = 0; i < num_nodes; ++i) {
+        execution_plan_index[execution_plan[i]] = i;
+      }
+      for (const auto& [from, to] : *control_edges) {
+        if (from < 0 || to < 0 || from >= num_all_nodes ||
+            to >= num_all_nodes) {
+          continue;
+        }
+        const int from_index = execution_plan_index[from];
+        const int to_index = execution_plan_index[to];
+        if (from_index < 0 || to_index <= from_index) continue;
+        successors_[from_index].push_back(to_index);
+        ++num_predecessors_[to_index];
+      }
+    }
+  }
+
+  // Calls `invoke_node` with the index in the execution plan of every node,
+  // once the nodes it depends on have run. No more nodes are started once a
+  // call fails, and the first failure is returned.
+  TfLiteStatus Run(const std::function<TfLiteStatus(int)>& invoke_node) {
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      invoke_node_ = &invoke_node;
+      num_pending_predecessors_ = num_predecessors_;
+      ready_.clear();
+      // `ready_` is used as a stack, so that a thread keeps running the nodes
+      // of the same branch.
+      for (int i = num_predecessors_.size() - 1; i >= 0; --i) {
+        if (num_predecessors_[i] == 0) ready_.push_back(i);
+      }
+      num_remaining_ = num_predecessors_.size();
+      num_running_ = 0;
+      status_ = kTfLiteOk;
+      num_busy_threads_ = threads_.size();
+      ++generation_;
+    }
+    cv_.notify_all();
+    RunNodes();
+
+    std::unique_lock<std::mutex> lock(mu_);
+    cv_.wait(lock, [this] { return num_busy_threads_ == 0; });
+    invoke_node_ = nullptr;
+    return status_;
+  }
+
+ private:
+  bool Done() const {
+    return num_remaining_ == 0 || (status_ != kTfLiteOk && num_running_ == 0);
+  }
+
+  // Runs ready nodes until all the nodes have run, or one of them failed.
+  void RunNodes() {
+    std::unique_lock<std::mutex> lock(mu_);
+    while (true) {
+      cv_.wait(lock, [this] { return !ready_.empty() || Done(); });
+      if (ready_.empty()) return;
+      const int node = ready_.back();
+      ready_.pop_back();
+      ++num_running_;
+      lock.unlock();
+      const TfLiteStatus status = (*invoke_node_)(node);
+      lock.lock();
+      --num_running_;
+      --num_remaining_;
+      if (status != kTfLiteOk) {
+        if (status_ == kTfLiteOk) status_ = status;
+        ready_.clear();
+      } else if (status_ == kTfLiteOk) {
+        for (int successor : successors_[node]) {
+          if (--num_pending_predecessors_[successor] == 0) {
+            ready_.push_back(successor);
+          }
+        }
+      }
+      // This thread takes one of the ready nodes itself.
+      if (ready_.size() > 1 || Done()) cv_.notify_all();
+    }
+  }
+
+  void WorkerLoop() {
+    ExternalCpuBackendContext cpu_backend_context;
+    parallel_invoke_cpu_backend_context = &cpu_backend_context;
+    int64_t generation = 0;
+    std::unique_lock<std::mutex> lock(mu_);
+    while (true) {
+      cv_.wait(lock, [&] { return stop_ || generation_ != generation; });
+      if (stop_) break;
+      generation = generation_;
+      lock.unlock();
+      RunNodes();
+      lock.lock();
+      if (--num_busy_threads_ == 0) cv_.notify_all();
+    }
+    parallel_invoke_cpu_backend_context = nullptr;
+  }
+
+  // The execution plan that the dependencies were computed for.
+  std::vector<int> execution_plan_;
+  // Indices in the execution plan of the nodes that depend on each node.
+  std::vector<std::vector<int>> successors_;
+  // Number of nodes that each node depends on.
+  std::vector<int> num_predecessors_;
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::vector<std::thread> threads_;
+  bool stop_ = false;
+  // Incremented by each `Run` to wake up the threads of the pool.
+  int64_t generation_ = 0;
+  // Number of threads of the pool that haven't finished the current `Run`.
+  int num_busy_threads_ = 0;
+
+  // The state of the current `Run`.
+  const std::function<TfLiteStatus(int)>* invoke_node_ = nullptr;
+  std::vector<int> num_pending_predecessors_;
+  std::vector<int> ready_;
+  int num_remaining_ = 0;
+  int num_running_ = 0;
+  TfLiteStatus status_ = kTfLiteOk;
+};
+
+bool Subgraph::CanInvokeInParallel() const {
+  if (!memory_planner_allows_parallel_invoke_ || profiler_ != nullptr ||
+      execution_plan_.size() < 2 ||
+      next_execution_plan_index_to_prepare_ !=
+          static_cast<int>(execution_plan_.size())) {
+    return false;
+  }
+  for (int node_index : execution_plan_) {
+    const TfLiteNode& node = nodes_and_registration_[node_index].first;
+    for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      const TfLiteTensor& tensor = tensors_[tensor_index];
+      // Let the sequential execution copy stale data from delegates and
+      // report missing data.
+      if ((tensor.delegate && tensor.delegate != node.delegate &&
+           tensor.data_is_stale) ||
+          (tensor.data.raw == nullptr && tensor.bytes > 0)) {
+        return false;
+      }
+    }
+    for (const TfLiteIntArray* tensor_indices :
+         {node.outputs, node.temporaries}) {
+      for (int tensor_index : TfLiteIntArrayView(tensor_indices)) {
+        if (tensor_index == kTfLiteOptionalTensor) continue;
+        if (tensors_[tensor_index].allocation_type == kTfLiteDynamic) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+TfLiteStatus Subgraph::InvokeInParallel() {
+  const int num_threads = NumParallelInvokeThreads();
+  if (parallel_invoker_ == nullptr ||
+      parallel_invoker_->num_threads() != num_threads) {
+    parallel_invoker_ = std::make_unique<ParallelInvoker>(num_threads);
+  }
+  parallel_invoker_->MaybeComputeDependencies(
+      execution_plan_, nodes_and_registration_, tensors_.data(),
+      tensors_.size(), control_edges_);
+  // Kernels may add tensors, which must not move the existing ones while other
+  // nodes run.
+  EnsureTensorsVectorCapacity();
+
+  // Serializes the error reporting.
+  std::mutex error_mu;
+  return parallel_invoker_->Run([&](int execution_plan_index) {
+    const int node_index = execution_plan_[execution_plan_index];
+    TfLiteNode& node = nodes_and_registration_[node_index].first;
+    const TfLiteRegistration& registration =
+        nodes_and_registration_[node_index].second;
+
+    if (check_cancelled_func_ != nullptr &&
+        check_cancelled_func_(cancellation_data_)) {
+      std::lock_guard<std::mutex> lock(error_mu);
+      ReportError("Client requested cancel during Invoke()");
+      return kTfLiteError;
+    }
+
+    if (continue_invocation_ && !continue_invocation_->test_and_set()) {
+      std::lock_guard<std::mutex> lock(error_mu);
+      ReportError("Client requested cancel during Invoke()");
+      return kTfLiteCancelled;
+    }
+
+    if (auto s = OpInvoke(registration, &node); s != kTfLiteOk) {
+      std::lock_guard<std::mutex> lock(error_mu);
+      auto err = ReportOpError(&context_, node, registration, node_index,
+                               "failed to invoke");
+      return s == kTfLiteCancelled ? s : err;
+    }
+    return kTfLiteOk;
+  });
+}
+
 TfLiteStatus Subgraph::ResizeTensor(TfLiteContext* context,
                                     TfLiteTensor* tensor,
                                     TfLiteIntArray* new_size) {
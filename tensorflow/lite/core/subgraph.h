@@ -592,6 +592,15 @@ class Subgraph {
   // Returns true if the subgraph has been fully delegated.
   bool IsFullyDelegated() const;
 
+  // Copies the tensors, nodes, inputs, outputs and variables of this subgraph
+  // to the empty subgraph `clone`, which then runs the same graph with its own
+  // tensor arenas and kernel state. The read-only tensors, the node options and
+  // the registrations are shared with this subgraph, which must outlive
+  // `clone`.
+  // Only supported before tensors are allocated and delegates are applied.
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus CloneGraph(Subgraph* clone) const;
+
   const std::unordered_map<size_t, size_t>& GetTensorBufferIdentifiers() {
     return tensor_buffer_identifiers_;
   }
@@ -727,6 +736,20 @@ class Subgraph {
   // Does not report invoke status through profiler.
   TfLiteStatus InvokeImpl();
 
+  // Number of threads set by `InterpreterOptions::SetNumParallelInvokeThreads`.
+  int NumParallelInvokeThreads() const {
+    return options_ ? options_->GetNumParallelInvokeThreads() : 0;
+  }
+
+  // Returns true if the nodes of the execution plan can be run concurrently by
+  // `InvokeInParallel`. This requires them to be all prepared, and none of
+  // their tensors to be dynamic.
+  bool CanInvokeInParallel() const;
+
+  // Runs the nodes of the execution plan on `NumParallelInvokeThreads()`
+  // threads, in an order that respects their data and control dependencies.
+  TfLiteStatus InvokeInParallel();
+
   // Allow a delegate to look at the graph and modify the graph to handle
   // parts of the graph themselves. After this is called, the graph may
   // contain new nodes that replace 1 more nodes.
@@ -1068,6 +1091,14 @@ class Subgraph {
 
   std::unique_ptr<MemoryPlanner> memory_planner_;
 
+  // True if `memory_planner_` never lets the tensors of different nodes share
+  // memory, which is required to run nodes concurrently.
+  bool memory_planner_allows_parallel_invoke_ = false;
+
+  // Schedules the nodes in `InvokeInParallel`. Created on first use.
+  class ParallelInvoker;
+  std::unique_ptr<ParallelInvoker> parallel_invoker_;
+
   // Maps tensor index to custom allocation for all applicable tensors.
   std::map<int, TfLiteCustomAllocation> custom_allocations_;
 
@@ -1164,6 +1195,10 @@ class Subgraph {
   // Maps tensor constant buffers used in the subgraph to a model-wide
   // identifiers.
   std::unordered_map<size_t, size_t> tensor_buffer_identifiers_;
+
+  // Whether the builtin data of the nodes is freed with them. False for a
+  // subgraph created by CloneGraph, whose nodes share it with the original.
+  bool owns_builtin_data_ = true;
 };
 
 }  // namespace tflite
@@ -20,6 +20,7 @@ limitations under the License.
 #include <complex>
 #include <cstdint>
 #include <cstring>
+#include <vector>
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/types/optional.h"
@@ -511,24 +512,38 @@ bool IsConstantTensor(const Tensor& tensor, const Model& model) {
   return false;
 }
 
+// Roles of the tensors of a sub-graph, kept as bit flags per tensor index.
+enum TensorRole : uint8_t {
+  kSubgraphInputTensor = 1 << 0,
+  kConstantTensor = 1 << 1,
+  kVariableTensor = 1 << 2,
+  kOutputTensor = 1 << 3,
+};
+
 // Performs basic consistency checks on a sub-graph.
 bool VerifySubGraphConsistency(const Model& model, const SubGraph& subgraph,
                                ErrorReporter* error_reporter) {
-  absl::flat_hash_set<int> subgraph_input_tensors, constant_tensors,
-      variable_tensors, output_tensors;
-  if (subgraph.tensors()) {
-    for (int i = 0, end = subgraph.tensors()->size(); i < end; ++i) {
-      const auto* tensor = subgraph.tensors()->Get(i);
-      if (IsConstantTensor(*tensor, model)) {
-        constant_tensors.insert(i);
-      } else if (tensor->is_variable()) {
-        variable_tensors.insert(i);
-      }
+  // The roles are looked up for every input and output of every operator, so
+  // they are kept in a flat array indexed by tensor rather than in hash sets.
+  const int num_tensors = subgraph.tensors() ? subgraph.tensors()->size() : 0;
+  std::vector<uint8_t> roles(num_tensors, 0);
+  auto has_role = [&](int tensor_idx, uint8_t role) {
+    return tensor_idx >= 0 && tensor_idx < num_tensors &&
+           (roles[tensor_idx] & role) != 0;
+  };
+  for (int i = 0; i < num_tensors; ++i) {
+    const auto* tensor = subgraph.tensors()->Get(i);
+    if (IsConstantTensor(*tensor, model)) {
+      roles[i] |= kConstantTensor;
+    } else if (tensor->is_variable()) {
+      roles[i] |= kVariableTensor;
     }
   }
   if (subgraph.inputs()) {
     for (const int tensor_idx : *subgraph.inputs()) {
-      subgraph_input_tensors.insert(tensor_idx);
+      if (tensor_idx >= 0 && tensor_idx < num_tensors) {
+        roles[tensor_idx] |= kSubgraphInputTensor;
+      }
     }
   }
 
@@ -548,11 +563,8 @@ bool VerifySubGraphConsistency(const Model& model, const SubGraph& subgraph,
       // Check for invalid inputs by ensuring all exist in produced_tensors.
       for (const int input_idx : *op->inputs()) {
         if (input_idx == kTfLiteOptionalTensor) continue;
-        if (constant_tensors.find(input_idx) == constant_tensors.end() &&
-            variable_tensors.find(input_idx) == variable_tensors.end() &&
-            subgraph_input_tensors.find(input_idx) ==
-                subgraph_input_tensors.end() &&
-            output_tensors.find(input_idx) == output_tensors.end()) {
+        if (!has_role(input_idx, kConstantTensor | kVariableTensor |
+                                     kSubgraphInputTensor | kOutputTensor)) {
           ReportError(error_reporter,
                       "Input tensor %d to op %d (%s) is not produced",
                       input_idx, op_idx, EnumNameBuiltinOperator(builtin_code));
@@ -562,25 +574,29 @@ bool VerifySubGraphConsistency(const Model& model, const SubGraph& subgraph,
       // Check for cycles/invalid outputs by ensuring that none exist in
       // produced_tensors.
       for (const int output_idx : *op->outputs()) {
-        if (constant_tensors.find(output_idx) != constant_tensors.end()) {
+        if (output_idx < 0 || output_idx >= num_tensors) {
+          ReportError(error_reporter,
+                      "Output tensor %d to op %d (%s) does not exist",
+                      output_idx, op_idx,
+                      EnumNameBuiltinOperator(builtin_code));
+          return false;
+        } else if (has_role(output_idx, kConstantTensor)) {
           ReportError(
               error_reporter, "Output tensor %d to op %d (%s) is a constant",
               output_idx, op_idx, EnumNameBuiltinOperator(builtin_code));
           return false;
-        } else if (variable_tensors.find(output_idx) !=
-                   variable_tensors.end()) {
+        } else if (has_role(output_idx, kVariableTensor)) {
           ReportError(
               error_reporter, "Output tensor %d to op %d (%s) is a variable",
               output_idx, op_idx, EnumNameBuiltinOperator(builtin_code));
           return false;
-        } else if (subgraph_input_tensors.find(output_idx) !=
-                   subgraph_input_tensors.end()) {
+        } else if (has_role(output_idx, kSubgraphInputTensor)) {
           ReportError(error_reporter,
                       "Output tensor %d to op %d (%s) is a subgraph input",
                       output_idx, op_idx,
                       EnumNameBuiltinOperator(builtin_code));
           return false;
-        } else if (output_tensors.find(output_idx) != output_tensors.end()) {
+        } else if (has_role(output_idx, kOutputTensor)) {
           ReportError(error_reporter,
                       "Output tensor %d to op %d (%s) is an output from "
                       "another op. There is a cycle in the graph",
@@ -589,7 +605,7 @@ bool VerifySubGraphConsistency(const Model& model, const SubGraph& subgraph,
           return false;
         }
         // This can be an input to a subsequent op.
-        output_tensors.insert(output_idx);
+        roles[output_idx] |= kOutputTensor;
       }
     }
   }
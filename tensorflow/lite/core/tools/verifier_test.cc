@@ -559,6 +559,22 @@ TEST(VerifyModel, OutputIsAVariable) {
             builder.GetErrorString());
 }
 
+TEST(VerifyModel, OutputDoesNotExist) {
+  TfLiteFlatbufferModelBuilder builder({}, {"test"});
+  builder.AddOperator({0, 1}, {3}, BuiltinOperator_CUSTOM, "test");
+  builder.AddTensor({2, 3}, TensorType_UINT8, {1, 2, 3, 4, 5, 6}, "input");
+  builder.AddTensor(
+      {2}, TensorType_STRING,
+      {2, 0, 0, 0, 16, 0, 0, 0, 17, 0, 0, 0, 19, 0, 0, 0, 'A', 'B', 'C'},
+      "data");
+  builder.AddTensor({2, 3}, TensorType_INT32, {}, "output");
+  builder.FinishModel({0, 1}, {2});
+  ASSERT_FALSE(builder.Verify());
+  ASSERT_FALSE(builder.VerifyWithOpResolver());
+  EXPECT_EQ("Output tensor 3 to op 0 (CUSTOM) does not exist",
+            builder.GetErrorString());
+}
+
 TEST(VerifyModel, OpWithOptionalTensor) {
   TfLiteFlatbufferModelBuilder builder({}, {"test"});
   builder.AddOperator({kTfLiteOptionalTensor, 0, 1}, {2},
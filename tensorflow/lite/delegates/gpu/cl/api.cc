@@ -24,10 +24,12 @@ limitations under the License.
 #include <algorithm>
 #include <cstring>
 #include <memory>
+#include <string>
 #include <variant>
 #include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
 #include "tensorflow/lite/delegates/gpu/cl/cl_command_queue.h"
 #include "tensorflow/lite/delegates/gpu/cl/cl_errors.h"
@@ -696,7 +698,9 @@ CreateGpuModelInfo GetCreateInfo(const Environment& environment,
   create_info.storage_type = GetStorageTypeFromOptions(environment, options);
   if (options.usage == InferenceUsage::FAST_SINGLE_ANSWER) {
     create_info.hints.Add(ModelHints::kReduceKernelsCount);
-    create_info.hints.Add(ModelHints::kFastTuning);
+    if (!options.exhaustive_tuning) {
+      create_info.hints.Add(ModelHints::kFastTuning);
+    }
   } else if (options.usage == InferenceUsage::BALANCED) {
     create_info.hints.Add(ModelHints::kReduceKernelsCount);
   } else if (options.usage == InferenceUsage::SUSTAINED_SPEED) {
@@ -1054,6 +1058,18 @@ class InferenceEnvironmentImpl : public InferenceEnvironment {
 
 }  // namespace
 
+std::string GetSerializationKey(const InferenceOptions& options) {
+  std::string key = absl::StrCat(static_cast<int>(options.usage), ",",
+                                 static_cast<int>(options.priority1), ",",
+                                 static_cast<int>(options.priority2), ",",
+                                 static_cast<int>(options.priority3), ",",
+                                 options.exhaustive_tuning);
+#ifdef TFLITE_GPU_ENABLE_INVOKE_LOOP
+  absl::StrAppend(&key, ",", options.gpu_invoke_loop_times);
+#endif
+  return key;
+}
+
 absl::Status NewInferenceEnvironment(
     const InferenceEnvironmentOptions& options,
     std::unique_ptr<InferenceEnvironment>* environment,
@@ -24,6 +24,7 @@ limitations under the License.
 
 #include <cstdint>
 #include <memory>
+#include <string>
 
 #include "absl/types/span.h"
 #include "tensorflow/lite/delegates/gpu/api.h"
@@ -53,7 +54,18 @@ namespace tflite {
 namespace gpu {
 namespace cl {
 
-struct InferenceOptions : public tflite::gpu::InferenceOptions {};
+struct InferenceOptions : public tflite::gpu::InferenceOptions {
+  // Tunes the work group sizes of all the kernels exhaustively, regardless of
+  // the usage. This is slow, so it is meant for BuildSerializedModel: the tuned
+  // work group sizes are stored in the serialized model and restored by
+  // NewInferenceBuilder on the same device and driver.
+  bool exhaustive_tuning = false;
+};
+
+// Returns a string made of the fields of `options`, for use in the keys of the
+// models serialized with them. Unlike the bytes of `options`, it does not
+// depend on the padding of the struct, so equal options give equal keys.
+std::string GetSerializationKey(const InferenceOptions& options);
 
 // Indicates environment
 struct InferenceEnvironmentProperties {
@@ -0,0 +1,57 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/delegates/gpu/cl/api.h"
+
+#include <cstring>
+#include <new>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/delegates/gpu/api.h"
+
+namespace tflite {
+namespace gpu {
+namespace cl {
+namespace {
+
+TEST(InferenceOptionsTest, EqualOptionsGiveEqualSerializationKeys) {
+  // Default-initialized in buffers holding different bytes, so that the
+  // padding of the two structs differs.
+  alignas(InferenceOptions) unsigned char zeros[sizeof(InferenceOptions)];
+  alignas(InferenceOptions) unsigned char ones[sizeof(InferenceOptions)];
+  std::memset(zeros, 0, sizeof(zeros));
+  std::memset(ones, 0xff, sizeof(ones));
+  InferenceOptions* a = new (zeros) InferenceOptions;
+  InferenceOptions* b = new (ones) InferenceOptions;
+  for (InferenceOptions* options : {a, b}) {
+    options->usage = InferenceUsage::FAST_SINGLE_ANSWER;
+    options->priority1 = InferencePriority::MIN_LATENCY;
+    options->exhaustive_tuning = true;
+  }
+  EXPECT_EQ(GetSerializationKey(*a), GetSerializationKey(*b));
+
+  b->exhaustive_tuning = false;
+  EXPECT_NE(GetSerializationKey(*a), GetSerializationKey(*b));
+  b->exhaustive_tuning = true;
+  b->priority2 = InferencePriority::MIN_MEMORY_USAGE;
+  EXPECT_NE(GetSerializationKey(*a), GetSerializationKey(*b));
+  a->~InferenceOptions();
+  b->~InferenceOptions();
+}
+
+}  // namespace
+}  // namespace cl
+}  // namespace gpu
+}  // namespace tflite
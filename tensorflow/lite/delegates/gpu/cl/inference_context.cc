@@ -31,6 +31,7 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/lite/delegates/gpu/cl/buffer.h"
 #include "tensorflow/lite/delegates/gpu/cl/cl_command_buffer.h"
 #include "tensorflow/lite/delegates/gpu/cl/cl_command_queue.h"
@@ -266,6 +267,12 @@ absl::Status ClarifyWithCommandBuffer(ProfilingCommandQueue* queue,
   return absl::OkStatus();
 }
 
+// Identifies the device and driver that the work group sizes are tuned for.
+std::string GetDeviceFingerprint(const GpuInfo& gpu_info) {
+  return absl::StrCat(gpu_info.opencl_info.device_name, "/",
+                      gpu_info.opencl_info.driver_version);
+}
+
 }  // namespace
 
 void InferenceContext::ExecutionHints::Init(const GpuInfo& gpu_info) {
@@ -404,6 +411,15 @@ absl::Status InferenceContext::RestoreDeserialized(
         "OpenCL driver changed, model respresentation invalid, must be "
         "regenerated.");
   }
+  // Models serialized before the device fingerprint was added only have the
+  // platform version to check.
+  if (decoded_fb->device_fingerprint() &&
+      decoded_fb->device_fingerprint()->str() !=
+          GetDeviceFingerprint(env->GetDevicePtr()->GetInfo())) {
+    return absl::InvalidArgumentError(
+        "OpenCL device changed, tuned work group sizes invalid, model must be "
+        "regenerated.");
+  }
   GpuModel gpu_model;
   RETURN_IF_ERROR(tflite::gpu::Decode(decoded_fb->gpu_model(), &gpu_model));
   RETURN_IF_ERROR(AllocateMemory(gpu_model, env->GetDevicePtr()->GetInfo(),
@@ -1080,6 +1096,8 @@ flatbuffers::Offset<data::InferenceContext> InferenceContext::Encode(
   }
   auto binary_programs_fb_vec = builder->CreateVector(binary_programs_fb);
   auto driver_version = builder->CreateString(device.GetPlatformVersion());
+  auto device_fingerprint =
+      builder->CreateString(GetDeviceFingerprint(device.GetInfo()));
 
   data::InferenceContextBuilder inf_builder(*builder);
   inf_builder.add_gpu_model(gpu_model_fb);
@@ -1087,6 +1105,7 @@ flatbuffers::Offset<data::InferenceContext> InferenceContext::Encode(
   inf_builder.add_binary_programs(binary_programs_fb_vec);
   inf_builder.add_tuned_work_group_sizes_per_node(work_groups_fb_vec);
   inf_builder.add_fingerprints_per_node(node_fingerprints_fb);
+  inf_builder.add_device_fingerprint(device_fingerprint);
   return inf_builder.Finish();
 }
 
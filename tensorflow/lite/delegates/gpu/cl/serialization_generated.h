@@ -111,7 +111,8 @@ struct InferenceContext FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
     VT_DRIVER_VERSION = 6,
     VT_BINARY_PROGRAMS = 8,
     VT_TUNED_WORK_GROUP_SIZES_PER_NODE = 10,
-    VT_FINGERPRINTS_PER_NODE = 12
+    VT_FINGERPRINTS_PER_NODE = 12,
+    VT_DEVICE_FINGERPRINT = 14
   };
   const tflite::gpu::data::GpuModel *gpu_model() const {
     return GetPointer<const tflite::gpu::data::GpuModel *>(VT_GPU_MODEL);
@@ -128,6 +129,9 @@ struct InferenceContext FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
   const ::flatbuffers::Vector<uint64_t> *fingerprints_per_node() const {
     return GetPointer<const ::flatbuffers::Vector<uint64_t> *>(VT_FINGERPRINTS_PER_NODE);
   }
+  const ::flatbuffers::String *device_fingerprint() const {
+    return GetPointer<const ::flatbuffers::String *>(VT_DEVICE_FINGERPRINT);
+  }
   bool Verify(::flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyOffset(verifier, VT_GPU_MODEL) &&
@@ -142,6 +146,8 @@ struct InferenceContext FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
            verifier.VerifyVectorOfTables(tuned_work_group_sizes_per_node()) &&
            VerifyOffset(verifier, VT_FINGERPRINTS_PER_NODE) &&
            verifier.VerifyVector(fingerprints_per_node()) &&
+           VerifyOffset(verifier, VT_DEVICE_FINGERPRINT) &&
+           verifier.VerifyString(device_fingerprint()) &&
            verifier.EndTable();
   }
 };
@@ -165,6 +171,9 @@ struct InferenceContextBuilder {
   void add_fingerprints_per_node(::flatbuffers::Offset<::flatbuffers::Vector<uint64_t>> fingerprints_per_node) {
     fbb_.AddOffset(InferenceContext::VT_FINGERPRINTS_PER_NODE, fingerprints_per_node);
   }
+  void add_device_fingerprint(::flatbuffers::Offset<::flatbuffers::String> device_fingerprint) {
+    fbb_.AddOffset(InferenceContext::VT_DEVICE_FINGERPRINT, device_fingerprint);
+  }
   explicit InferenceContextBuilder(::flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -182,8 +191,10 @@ inline ::flatbuffers::Offset<InferenceContext> CreateInferenceContext(
     ::flatbuffers::Offset<::flatbuffers::String> driver_version = 0,
     ::flatbuffers::Offset<::flatbuffers::Vector<::flatbuffers::Offset<tflite::gpu::cl::data::BinaryProgram>>> binary_programs = 0,
     ::flatbuffers::Offset<::flatbuffers::Vector<::flatbuffers::Offset<tflite::gpu::data::Int3>>> tuned_work_group_sizes_per_node = 0,
-    ::flatbuffers::Offset<::flatbuffers::Vector<uint64_t>> fingerprints_per_node = 0) {
+    ::flatbuffers::Offset<::flatbuffers::Vector<uint64_t>> fingerprints_per_node = 0,
+    ::flatbuffers::Offset<::flatbuffers::String> device_fingerprint = 0) {
   InferenceContextBuilder builder_(_fbb);
+  builder_.add_device_fingerprint(device_fingerprint);
   builder_.add_fingerprints_per_node(fingerprints_per_node);
   builder_.add_tuned_work_group_sizes_per_node(tuned_work_group_sizes_per_node);
   builder_.add_binary_programs(binary_programs);
@@ -198,18 +209,21 @@ inline ::flatbuffers::Offset<InferenceContext> CreateInferenceContextDirect(
     const char *driver_version = nullptr,
     const std::vector<::flatbuffers::Offset<tflite::gpu::cl::data::BinaryProgram>> *binary_programs = nullptr,
     const std::vector<::flatbuffers::Offset<tflite::gpu::data::Int3>> *tuned_work_group_sizes_per_node = nullptr,
-    const std::vector<uint64_t> *fingerprints_per_node = nullptr) {
+    const std::vector<uint64_t> *fingerprints_per_node = nullptr,
+    const char *device_fingerprint = nullptr) {
   auto driver_version__ = driver_version ? _fbb.CreateString(driver_version) : 0;
   auto binary_programs__ = binary_programs ? _fbb.CreateVector<::flatbuffers::Offset<tflite::gpu::cl::data::BinaryProgram>>(*binary_programs) : 0;
   auto tuned_work_group_sizes_per_node__ = tuned_work_group_sizes_per_node ? _fbb.CreateVector<::flatbuffers::Offset<tflite::gpu::data::Int3>>(*tuned_work_group_sizes_per_node) : 0;
   auto fingerprints_per_node__ = fingerprints_per_node ? _fbb.CreateVector<uint64_t>(*fingerprints_per_node) : 0;
+  auto device_fingerprint__ = device_fingerprint ? _fbb.CreateString(device_fingerprint) : 0;
   return tflite::gpu::cl::data::CreateInferenceContext(
       _fbb,
       gpu_model,
       driver_version__,
       binary_programs__,
       tuned_work_group_sizes_per_node__,
-      fingerprints_per_node__);
+      fingerprints_per_node__,
+      device_fingerprint__);
 }
 
 inline const tflite::gpu::cl::data::InferenceContext *GetInferenceContext(const void *buf) {
@@ -556,6 +556,10 @@ absl::Status DelegateKernelCore::InitializeOpenClApi(
     RETURN_IF_ERROR(cl_environment_->NewInferenceBuilder(
         options, std::move(*graph), builder));
   } else {
+    // Exhaustive tuning is part of the options fingerprint, so the serialized
+    // data tuned this way does not replace the data tuned the default way.
+    options.exhaustive_tuning = delegate_options.experimental_flags &
+                                TFLITE_GPU_EXPERIMENTAL_FLAGS_EXHAUSTIVE_TUNING;
     // If serialization data is found, initialize CL from it & return early.
     if (MaybeInitializeSerializedOpenCL(context, delegate_params, builder,
                                         &options, &env_options, &properties,
@@ -629,8 +633,9 @@ absl::Status DelegateKernelCore::MaybeInitializeSerializedOpenCL(
     Serialization* serialization) {
   if (!serialization) return absl::InvalidArgumentError("No serialization");
   // We use a fingerprint of the options to ensure compatibility.
+  const std::string options_key = cl::GetSerializationKey(*options);
   std::string options_fingerprint =
-      delegates::StrFingerprint(options, sizeof(cl::InferenceOptions));
+      delegates::StrFingerprint(options_key.data(), options_key.size());
   auto data_key = serialization->GetEntryForKernel(
       std::string(kSerializedDataPrefix) + options_fingerprint, context,
       delegate_params);
@@ -658,8 +663,9 @@ absl::Status DelegateKernelCore::SaveSerializedOpenCL(
     const std::vector<uint8_t>& serialized_model) {
   if (!serialization) return absl::InvalidArgumentError("No serialization");
   // We use a fingerprint of the options to ensure compatibility.
+  const std::string options_key = cl::GetSerializationKey(*options);
   std::string options_fingerprint =
-      delegates::StrFingerprint(options, sizeof(cl::InferenceOptions));
+      delegates::StrFingerprint(options_key.data(), options_key.size());
 
   // Save data.
   auto data_key = serialization->GetEntryForKernel(
@@ -894,8 +900,8 @@ class DelegateAsyncKernel : public BackendAsyncKernelInterface {
         buffer_attrs.buffer_type.has_value(),
         "calling RegisterBuffer with buffer resource type name unspecified");
     TFLITE_RET_CHECK_STATUS(
-        buffer_attrs.buffer_type.value() != BufferType::kUnknown,
-        "calling RegisterBuffer with unknown buffer resource type");
+        buffer_attrs.buffer_type.value() == BufferType::kAHardwareBufferBlob,
+        "calling RegisterBuffer with unsupported buffer resource type");
     size_t alignment = buffer_attrs.alignment.value_or(kRequiredByteAlignment);
     TFLITE_RET_CHECK_STATUS(
         alignment % kRequiredByteAlignment == 0,
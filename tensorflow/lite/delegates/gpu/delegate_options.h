@@ -71,6 +71,14 @@ enum TfLiteGpuExperimentalFlags {
   // TfLiteGpuDelegateOptionsV2.
   // Currently works only if CL backend is used.
   TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION = 1 << 3,
+  // Tunes the work group sizes of the kernels exhaustively when the serialized
+  // data is built, regardless of inference_preference. This makes the first
+  // initialization much slower, but the tuned work group sizes are serialized
+  // and restored by later initializations on the same device and driver.
+  //
+  // NOTE: Only used together with
+  // TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION.
+  TFLITE_GPU_EXPERIMENTAL_FLAGS_EXHAUSTIVE_TUNING = 1 << 4,
 };
 
 // IMPORTANT: Always use TfLiteGpuDelegateOptionsV2Default() method to create
@@ -35,6 +35,12 @@ BufferType BufferTypeFromString(const char* buffer_type) {
   if (std::strcmp(buffer_type, kBufferTypeAHardwareBufferBlob) == 0) {
     return BufferType::kAHardwareBufferBlob;
   }
+  if (std::strcmp(buffer_type, kBufferTypeHostMemory) == 0) {
+    return BufferType::kHostMemory;
+  }
+  if (std::strcmp(buffer_type, kBufferTypeDmaBuf) == 0) {
+    return BufferType::kDmaBuf;
+  }
   return BufferType::kUnknown;
 }
 
@@ -42,6 +48,10 @@ const char* StringFromBufferType(BufferType buffer_type) {
   switch (buffer_type) {
     case BufferType::kAHardwareBufferBlob:
       return kBufferTypeAHardwareBufferBlob;
+    case BufferType::kHostMemory:
+      return kBufferTypeHostMemory;
+    case BufferType::kDmaBuf:
+      return kBufferTypeDmaBuf;
     case BufferType::kUnknown:
       return "<unknown buffer type>";
   }
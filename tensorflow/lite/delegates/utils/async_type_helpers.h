@@ -24,6 +24,10 @@ limitations under the License.
 namespace tflite::delegates::utils {
 
 constexpr char kBufferTypeAHardwareBufferBlob[] = "ahardware_buffer_blob";
+// The backend buffer holds a CPU address.
+constexpr char kBufferTypeHostMemory[] = "host_memory";
+// The backend buffer holds a pointer to the file descriptor of a dma-buf.
+constexpr char kBufferTypeDmaBuf[] = "dma_buf";
 constexpr char kSyncTypeSyncFenceFd[] = "sync_fence_fd";
 
 // RAII wrapper of TfLiteAttributeMap.
@@ -54,7 +58,12 @@ inline ScopedTfLiteSynchronization CreateScopedTfLiteSynchronization() {
                                      TfLiteSynchronizationDelete);
 }
 
-enum class BufferType { kUnknown, kAHardwareBufferBlob };
+enum class BufferType {
+  kUnknown,
+  kAHardwareBufferBlob,
+  kHostMemory,
+  kDmaBuf,
+};
 
 struct BufferAttributes {
   std::optional<BufferType> buffer_type;
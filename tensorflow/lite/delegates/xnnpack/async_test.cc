@@ -0,0 +1,182 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/async/c/task.h"
+#include "tensorflow/lite/async/interop/c/attribute_map.h"
+#include "tensorflow/lite/async/interop/c/types.h"
+#include "tensorflow/lite/core/async/async_signature_runner.h"
+#include "tensorflow/lite/core/c/builtin_op_data.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/core/kernels/builtin_op_kernels.h"
+#include "tensorflow/lite/delegates/utils/async_type_helpers.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+#include "tensorflow/lite/interpreter_test_util.h"
+
+namespace tflite {
+namespace xnnpack {
+namespace {
+
+using ::tflite::delegates::utils::BufferAttributes;
+using ::tflite::delegates::utils::BufferType;
+using ::tflite::delegates::utils::CreateScopedTfLiteAttrMap;
+using ::tflite::delegates::utils::CreateScopedTfLiteBackendBuffer;
+using ::tflite::delegates::utils::ReadBufferAttrs;
+using ::tflite::delegates::utils::ScopedTfLiteBackendBuffer;
+using ::tflite::delegates::utils::WriteBufferAttrs;
+
+constexpr int kSize = 5;
+
+// Runs z = x + y with the XNNPACK delegate through the async API.
+class AsyncTest : public InterpreterTest {
+ protected:
+  void SetUp() override {
+    interpreter_->AddTensors(3);
+    interpreter_->SetInputs({0, 1});
+    interpreter_->SetOutputs({2});
+    TfLiteQuantizationParams quant;
+    for (int i = 0; i < 3; ++i) {
+      interpreter_->SetTensorParametersReadWrite(i, kTfLiteFloat32, "", {kSize},
+                                                 quant);
+    }
+    auto* params =
+        static_cast<TfLiteAddParams*>(calloc(1, sizeof(TfLiteAddParams)));
+    interpreter_->AddNodeWithParameters({0, 1}, {2}, nullptr, 0, params,
+                                        ops::builtin::Register_ADD());
+    BuildSignature("serving_default", {{"x", 0}, {"y", 1}}, {{"z", 2}});
+    ASSERT_EQ(interpreter_->ModifyGraphWithDelegate(delegate_.get()),
+              kTfLiteOk);
+    ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+    runner_ = interpreter_->GetAsyncSignatureRunner("serving_default");
+    ASSERT_NE(runner_, nullptr);
+  }
+
+  void TearDown() override { interpreter_.reset(); }
+
+  // Returns the size of the host memory buffers required for `name`.
+  size_t RequiredSize(TfLiteIoType io_type, const char* name) {
+    auto user = WriteBufferAttrs({/*buffer_type=*/BufferType::kHostMemory});
+    auto merged = CreateScopedTfLiteAttrMap(kTfLiteAttrMapTypeBuffer);
+    EXPECT_TRUE(runner_->ReconcileRestrictions(io_type, name, user.get(),
+                                               merged.get(), nullptr));
+    return ReadBufferAttrs(merged).size.value_or(0);
+  }
+
+  TfLiteBufferHandle Register(TfLiteIoType io_type, void* data, size_t size) {
+    ScopedTfLiteBackendBuffer buffer = CreateScopedTfLiteBackendBuffer();
+    TfLiteBackendBufferSetPtr(buffer.get(), data);
+    BufferAttributes attrs{};
+    attrs.buffer_type = BufferType::kHostMemory;
+    attrs.size = size;
+    TfLiteBufferHandle handle = kTfLiteNullBufferHandle;
+    EXPECT_EQ(runner_->RegisterBuffer(io_type, buffer.get(),
+                                      WriteBufferAttrs(attrs).get(), &handle),
+              kTfLiteOk);
+    buffers_.push_back(std::move(buffer));
+    return handle;
+  }
+
+  std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)>
+      delegate_{TfLiteXNNPackDelegateCreate(nullptr),
+                TfLiteXNNPackDelegateDelete};
+  async::AsyncSignatureRunner* runner_ = nullptr;
+  std::vector<ScopedTfLiteBackendBuffer> buffers_;
+};
+
+TEST_F(AsyncTest, PipelinedTasksUseRegisteredBuffers) {
+  constexpr int kNumTasks = 4;
+  const size_t input_size = RequiredSize(kTfLiteIoTypeInput, "x");
+  const size_t output_size = RequiredSize(kTfLiteIoTypeOutput, "z");
+  ASSERT_GE(input_size, kSize * sizeof(float));
+  ASSERT_GE(output_size, kSize * sizeof(float));
+
+  std::vector<std::vector<float>> x(kNumTasks), y(kNumTasks);
+  // The outputs of all the tasks are slices of a single buffer.
+  std::vector<float> z(kNumTasks * output_size / sizeof(float) + 1, 0.0f);
+  const TfLiteBufferHandle z_pool =
+      Register(kTfLiteIoTypeOutput, z.data(), z.size() * sizeof(float));
+  ASSERT_EQ(runner_->PrepareBackends(), kTfLiteOk);
+
+  std::vector<TfLiteExecutionTask*> tasks;
+  for (int t = 0; t < kNumTasks; ++t) {
+    x[t].resize(input_size / sizeof(float) + 1);
+    y[t].resize(input_size / sizeof(float) + 1);
+    for (int i = 0; i < kSize; ++i) {
+      x[t][i] = t;
+      y[t][i] = i;
+    }
+    BufferAttributes slice{};
+    slice.offset = t * output_size;
+    slice.size = output_size;
+    TfLiteBufferHandle z_slice = kTfLiteNullBufferHandle;
+    ASSERT_EQ(runner_->RegisterBufferSlice(
+                  z_pool, WriteBufferAttrs(slice).get(), &z_slice),
+              kTfLiteOk);
+
+    TfLiteExecutionTask* task = runner_->CreateTask();
+    ASSERT_NE(task, nullptr);
+    TfLiteExecutionTaskSetBuffer(
+        task, kTfLiteIoTypeInput, "x",
+        Register(kTfLiteIoTypeInput, x[t].data(), input_size));
+    TfLiteExecutionTaskSetBuffer(
+        task, kTfLiteIoTypeInput, "y",
+        Register(kTfLiteIoTypeInput, y[t].data(), input_size));
+    TfLiteExecutionTaskSetBuffer(task, kTfLiteIoTypeOutput, "z", z_slice);
+    tasks.push_back(task);
+  }
+
+  // All the tasks are scheduled before waiting for any of them.
+  for (TfLiteExecutionTask* task : tasks) {
+    ASSERT_EQ(runner_->InvokeAsync(task), kTfLiteOk);
+  }
+  for (int t = 0; t < kNumTasks; ++t) {
+    ASSERT_EQ(runner_->Wait(tasks[t]), kTfLiteOk);
+    const float* output = z.data() + t * output_size / sizeof(float);
+    for (int i = 0; i < kSize; ++i) {
+      EXPECT_EQ(output[i], t + i);
+    }
+  }
+  for (TfLiteExecutionTask* task : tasks) {
+    EXPECT_EQ(runner_->Finish(task), kTfLiteOk);
+  }
+}
+
+TEST_F(AsyncTest, RejectsInputBufferWithoutPadding) {
+  std::vector<float> x(kSize), y(kSize), z(kSize);
+  const TfLiteBufferHandle x_handle =
+      Register(kTfLiteIoTypeInput, x.data(), x.size() * sizeof(float));
+  const TfLiteBufferHandle y_handle =
+      Register(kTfLiteIoTypeInput, y.data(), y.size() * sizeof(float));
+  const TfLiteBufferHandle z_handle =
+      Register(kTfLiteIoTypeOutput, z.data(), z.size() * sizeof(float));
+  ASSERT_EQ(runner_->PrepareBackends(), kTfLiteOk);
+
+  TfLiteExecutionTask* task = runner_->CreateTask();
+  TfLiteExecutionTaskSetBuffer(task, kTfLiteIoTypeInput, "x", x_handle);
+  TfLiteExecutionTaskSetBuffer(task, kTfLiteIoTypeInput, "y", y_handle);
+  TfLiteExecutionTaskSetBuffer(task, kTfLiteIoTypeOutput, "z", z_handle);
+  EXPECT_NE(runner_->InvokeAsync(task), kTfLiteOk);
+  EXPECT_EQ(runner_->Finish(task), kTfLiteOk);
+}
+
+}  // namespace
+}  // namespace xnnpack
+}  // namespace tflite
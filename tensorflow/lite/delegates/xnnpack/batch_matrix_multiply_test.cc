@@ -253,6 +253,37 @@ TEST_F(BatchMatrixMultiplyTest, 4D_TransposeB) {
       .Test(xnnpack_delegate.get());
 }
 
+TEST_F(BatchMatrixMultiplyTest, BlockwiseQuantizedWeights2DTransposeB) {
+  const auto height = shape_rng();
+  const auto input_channels =
+      channels_rng() * BatchMatrixMultiplyTester::kBlockSize;
+  const auto output_channels = channels_rng();
+  auto xnnpack_delegate = get_delegate();
+
+  BatchMatrixMultiplyTester()
+      .InputADims({height, input_channels})
+      .InputBDims({output_channels, input_channels})
+      .InputBQuant(BatchMatrixMultiplyTester::kBlock)
+      .TransposeB(true)
+      .Test(xnnpack_delegate.get());
+}
+
+TEST_F(BatchMatrixMultiplyTest, BlockwiseQuantizedWeights3DTransposeB) {
+  const auto batch = shape_rng();
+  const auto height = shape_rng();
+  const auto input_channels =
+      channels_rng() * BatchMatrixMultiplyTester::kBlockSize;
+  const auto output_channels = channels_rng();
+  auto xnnpack_delegate = get_delegate();
+
+  BatchMatrixMultiplyTester()
+      .InputADims({batch, height, input_channels})
+      .InputBDims({output_channels, input_channels})
+      .InputBQuant(BatchMatrixMultiplyTester::kBlock)
+      .TransposeB(true)
+      .Test(xnnpack_delegate.get());
+}
+
 TEST_F(BatchMatrixMultiplyTest, MultiThreading) {
   const auto batch = shape_rng();
   const auto height = shape_rng();
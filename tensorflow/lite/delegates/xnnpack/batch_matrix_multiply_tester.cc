@@ -57,8 +57,15 @@ void BatchMatrixMultiplyTester::Test(TfLiteDelegate* delegate) const {
   auto input_rng_f32 =
       std::bind(std::uniform_real_distribution<float>(), std::ref(rng));
 
-  std::vector<char> buffer = CreateTfLiteModel();
+  const uint32_t seed = random_device();
+  std::vector<char> buffer = CreateTfLiteModel(seed, /*dequantize_b=*/false);
   const Model* model = GetModel(buffer.data());
+  std::vector<char> reference_buffer;
+  const Model* reference_model = model;
+  if (InputBQuant() == kBlock) {
+    reference_buffer = CreateTfLiteModel(seed, /*dequantize_b=*/true);
+    reference_model = GetModel(reference_buffer.data());
+  }
 
   std::unique_ptr<Interpreter> delegate_interpreter;
   ASSERT_EQ(
@@ -70,7 +77,7 @@ void BatchMatrixMultiplyTester::Test(TfLiteDelegate* delegate) const {
   std::unique_ptr<Interpreter> default_interpreter;
   ASSERT_EQ(
       InterpreterBuilder(
-          model,
+          reference_model,
           ::tflite::ops::builtin::BuiltinOpResolverWithoutDefaultDelegates())(
           &default_interpreter),
       kTfLiteOk);
@@ -78,8 +85,10 @@ void BatchMatrixMultiplyTester::Test(TfLiteDelegate* delegate) const {
   ASSERT_TRUE(delegate_interpreter);
   ASSERT_TRUE(default_interpreter);
 
-  ASSERT_EQ(delegate_interpreter->inputs().size(), 2);
-  ASSERT_EQ(default_interpreter->inputs().size(), 2);
+  // A block-wise quantized B is a constant, not an input of the model.
+  const size_t num_inputs = InputBQuant() == kBlock ? 1 : 2;
+  ASSERT_EQ(delegate_interpreter->inputs().size(), num_inputs);
+  ASSERT_EQ(default_interpreter->inputs().size(), num_inputs);
 
   ASSERT_EQ(delegate_interpreter->outputs().size(), 1);
   ASSERT_EQ(default_interpreter->outputs().size(), 1);
@@ -122,7 +131,9 @@ void BatchMatrixMultiplyTester::Test(TfLiteDelegate* delegate) const {
   // `[-1, 1]`. When no quantization is applied, the error measure is the value
   // $\gamma_k$ for the dot products used to compute the entries of the output
   // matrix. For quantized inputs, the error bound is the maximum accumulated
-  // quantization error for said dot product.
+  // quantization error for said dot product. Only `A` is quantized when `B`
+  // is block-wise quantized, with half the int8 quantization step of `[0, 1]`,
+  // and the block-wise quantized `B` is within `[-1, 1]`.
   const int32_t output_size = ComputeSize(OutputShape());
   const int32_t k = InputADims().back();
   float max_abs_error =
@@ -135,7 +146,10 @@ void BatchMatrixMultiplyTester::Test(TfLiteDelegate* delegate) const {
   }
 }
 
-std::vector<char> BatchMatrixMultiplyTester::CreateTfLiteModel() const {
+std::vector<char> BatchMatrixMultiplyTester::CreateTfLiteModel(
+    uint32_t seed, bool dequantize_b) const {
+  auto rng = std::mt19937(seed);
+
   /*************************** Define operator codes **************************/
   flatbuffers::FlatBufferBuilder builder;
   std::vector<flatbuffers::Offset<OperatorCode>> operator_codes{
@@ -148,15 +162,86 @@ std::vector<char> BatchMatrixMultiplyTester::CreateTfLiteModel() const {
 
   /****************************** Define tensors ******************************/
   std::vector<flatbuffers::Offset<Tensor>> tensors;
+  flatbuffers::Offset<Tensor> block_scales_tensor;
   tensors.emplace_back(CreateTensor(
       builder,
       builder.CreateVector<int32_t>(InputADims().data(), InputADims().size()),
       TensorType_FLOAT32, /*buffer=*/0));
 
-  if (InputBQuant() != kNone) {
+  if (InputBQuant() == kBlock) {
+    EXPECT_EQ(InputBDims().size(), 2);
+    EXPECT_TRUE(TransposeB());
+    const int32_t n = InputBDims()[0];
+    const int32_t k = InputBDims()[1];
+    EXPECT_EQ(k % kBlockSize, 0);
+    auto int4_pair_rng =
+        std::bind(std::uniform_int_distribution<int32_t>(
+                      0, std::numeric_limits<uint8_t>::max()),
+                  std::ref(rng));
+    // Multiples of 1/64 are exactly representable by the BF16 scales of
+    // XNNPACK and keep the dequantized values within [-1, 1].
+    auto scale_rng = std::bind(
+        [](int32_t numerator) { return numerator / 64.0f; },
+        std::bind(std::uniform_int_distribution<int32_t>(1, 8),
+                  std::ref(rng)));
+    std::vector<uint8_t> input2_data((n * k + 1) / 2);
+    std::generate(input2_data.begin(), input2_data.end(),
+                  std::ref(int4_pair_rng));
+    std::vector<float> scales(n * (k / kBlockSize));
+    std::generate(scales.begin(), scales.end(), std::ref(scale_rng));
+
+    if (dequantize_b) {
+      // INT4 values are packed two per byte, low nibble first.
+      std::vector<float> dequantized_input2_data(n * k);
+      for (int32_t i = 0; i < n * k; ++i) {
+        const int32_t nibble =
+            i % 2 == 0 ? input2_data[i / 2] & 0xF : input2_data[i / 2] >> 4;
+        dequantized_input2_data[i] =
+            (nibble >= 8 ? nibble - 16 : nibble) *
+            scales[(i / k) * (k / kBlockSize) + (i % k) / kBlockSize];
+      }
+      const int dequantized_buffer_id = buffers.size();
+      buffers.emplace_back(CreateBuffer(
+          builder,
+          builder.CreateVector(
+              reinterpret_cast<const uint8_t*>(dequantized_input2_data.data()),
+              sizeof(float) * dequantized_input2_data.size())));
+      tensors.emplace_back(CreateTensor(
+          builder,
+          builder.CreateVector<int32_t>(InputBDims().data(),
+                                        InputBDims().size()),
+          TensorType_FLOAT32, /*buffer=*/dequantized_buffer_id));
+    } else {
+      const int quantized_buffer_id = buffers.size();
+      buffers.emplace_back(CreateBuffer(
+          builder, builder.CreateVector(input2_data.data(),
+                                        input2_data.size())));
+      const int scales_buffer_id = buffers.size();
+      buffers.emplace_back(CreateBuffer(
+          builder,
+          builder.CreateVector(reinterpret_cast<const uint8_t*>(scales.data()),
+                               sizeof(float) * scales.size())));
+      // The scales tensor follows the output tensor.
+      tensors.emplace_back(CreateTensor(
+          builder,
+          builder.CreateVector<int32_t>(InputBDims().data(),
+                                        InputBDims().size()),
+          TensorType_INT4, /*buffer=*/quantized_buffer_id, /*name=*/0,
+          CreateQuantizationParameters(
+              builder, /*min=*/0, /*max=*/0, /*scale=*/0, /*zero_point=*/0,
+              QuantizationDetails_BlockwiseQuantization,
+              CreateBlockwiseQuantization(builder, /*scales=*/3,
+                                          /*zero_points=*/-1, kBlockSize)
+                  .Union())));
+      const std::array<int32_t, 2> scales_shape{{n, k / kBlockSize}};
+      block_scales_tensor = CreateTensor(
+          builder,
+          builder.CreateVector<int32_t>(scales_shape.data(),
+                                        scales_shape.size()),
+          TensorType_FLOAT32, /*buffer=*/scales_buffer_id);
+    }
+  } else if (InputBQuant() != kNone) {
     std::vector<float> input2_data(Input2Size());
-    std::random_device random_device;
-    auto rng = std::mt19937(random_device());
     auto input_rng_f32 = [&]() {
       return std::uniform_real_distribution<float>()(rng);
     };
@@ -216,6 +301,9 @@ std::vector<char> BatchMatrixMultiplyTester::CreateTfLiteModel() const {
       builder,
       builder.CreateVector<int32_t>(OutputShape().data(), OutputShape().size()),
       TensorType_FLOAT32));
+  if (!block_scales_tensor.IsNull()) {
+    tensors.push_back(block_scales_tensor);
+  }
 
   /***************************** Define operators *****************************/
   std::vector<int32_t> op_inputs{{0, 1}};
@@ -229,7 +317,10 @@ std::vector<char> BatchMatrixMultiplyTester::CreateTfLiteModel() const {
       BuiltinOptions_BatchMatMulOptions, batch_matmul_options.Union());
 
   /****************************** Define subgraph *****************************/
-  const std::array<int32_t, 2> subgraph_inputs{{0, 1}};
+  std::vector<int32_t> subgraph_inputs{{0}};
+  if (InputBQuant() != kBlock) {
+    subgraph_inputs.push_back(1);
+  }
   const std::array<int32_t, 1> subgraph_outputs{{2}};
   const flatbuffers::Offset<SubGraph> subgraph = CreateSubGraph(
       builder, builder.CreateVector(tensors.data(), tensors.size()),
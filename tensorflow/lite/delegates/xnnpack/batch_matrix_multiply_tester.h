@@ -38,8 +38,13 @@ class BatchMatrixMultiplyTester {
     kNone,
     kChannel,
     kTensor,
+    // Block-wise INT4, only for a static [N, K] B with TransposeB.
+    kBlock,
   };
 
+  // Block size of block-wise quantized inputs.
+  static constexpr int32_t kBlockSize = 32;
+
   BatchMatrixMultiplyTester() = default;
   BatchMatrixMultiplyTester(const BatchMatrixMultiplyTester&) = delete;
   BatchMatrixMultiplyTester& operator=(const BatchMatrixMultiplyTester&) =
@@ -93,7 +98,9 @@ class BatchMatrixMultiplyTester {
   void Test(TfLiteDelegate* delegate) const;
 
  private:
-  std::vector<char> CreateTfLiteModel() const;
+  // Block-wise quantized inputs are not supported by the TFLite kernels, so
+  // the reference model uses the dequantized input instead.
+  std::vector<char> CreateTfLiteModel(uint32_t seed, bool dequantize_b) const;
 
   WeightsType WeightsType() const { return weights_type_; }
 
@@ -41,6 +41,9 @@ int GenInputChannels(const std::function<int()> &rng,
     case WeightsType::kChannelWiseQuantizedInt4:
       // Int4 quantized kernels only support even number of channels.
       return (rng() / 2) * 2;
+    case WeightsType::kBlockWiseQuantizedInt4:
+      // The input channels must be a multiple of the block size.
+      return rng() * 32;
   }
 }
 
@@ -172,7 +175,8 @@ TEST_P(DynamicallyQuantizedFullyConnectedTest, 3DReshape) {
       std::bind(std::uniform_int_distribution<int32_t>(2, 9), std::ref(rng));
   const auto batch = 2;           // shape_rng();
   const auto width = 3;           // shape_rng();
-  const auto input_channels = 4;  // channels_rng();
+  const auto input_channels =
+      GetParam() == WeightsType::kBlockWiseQuantizedInt4 ? 32 : 4;
   const auto output_channels = channels_rng();
 
   DynamicallyQuantizedFullyConnectedTester()
@@ -461,6 +465,8 @@ std::string TestParamToString(testing::TestParamInfo<WeightsType> param) {
       return "ChannelWiseQuantizedInt8";
     case WeightsType::kTensorWiseQuantizedInt8:
       return "TensorWiseQuantizedInt8";
+    case WeightsType::kBlockWiseQuantizedInt4:
+      return "BlockWiseQuantizedInt4";
     default:
       assert(false);
       return "???";
@@ -472,7 +478,8 @@ INSTANTIATE_TEST_SUITE_P(
     DynamicallyQuantizedFullyConnectedTest,
     testing::Values(WeightsType::kTensorWiseQuantizedInt8,
                     WeightsType::kChannelWiseQuantizedInt4,
-                    WeightsType::kChannelWiseQuantizedInt8),
+                    WeightsType::kChannelWiseQuantizedInt8,
+                    WeightsType::kBlockWiseQuantizedInt4),
     TestParamToString);
 
 }  // namespace xnnpack
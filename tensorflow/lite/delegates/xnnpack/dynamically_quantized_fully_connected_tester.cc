@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <array>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
@@ -80,6 +81,33 @@ void DynamicallyQuantizedFullyConnectedTester::Test(
   float* delegate_output_data =
       delegate_interpreter->typed_output_tensor<float>(0);
 
+  if (WeightsType() == WeightsType::kBlockWiseQuantizedInt4) {
+    // The reference model computes in FP32 with the dequantized filter, so
+    // the outputs only differ by the error of the dynamic quantization of the
+    // input, which is at most half a quantization step per input channel.
+    const float* filter_data = default_interpreter->typed_tensor<float>(1);
+    const int32_t batch_size = InputSize() / InputChannels();
+    for (int32_t b = 0; b < batch_size; b++) {
+      const float* input_data = default_input_data + b * InputChannels();
+      const auto [min_it, max_it] =
+          std::minmax_element(input_data, input_data + InputChannels());
+      const float step =
+          (std::max(*max_it, 0.0f) - std::min(*min_it, 0.0f)) / 255.0f;
+      for (int32_t oc = 0; oc < OutputChannels(); oc++) {
+        float filter_abs_sum = 0.0f;
+        for (int32_t ic = 0; ic < InputChannels(); ic++) {
+          filter_abs_sum += std::abs(filter_data[oc * InputChannels() + ic]);
+        }
+        const int32_t index = b * OutputChannels() + oc;
+        EXPECT_NEAR(default_output_data[index], delegate_output_data[index],
+                    filter_abs_sum * step)
+            << "batch " << b << " / " << batch_size << ", output channel "
+            << oc << " / " << OutputChannels();
+      }
+    }
+    return;
+  }
+
   const int num_output_values = ComputeSize(OutputShape());
   int different_output_values = 0;
   // TFLite rounds to nearest with ties to Away. XNNPACK rounds to nearest with
@@ -100,8 +128,17 @@ void DynamicallyQuantizedFullyConnectedTester::Test(
 
 void DynamicallyQuantizedFullyConnectedTester::Test(
     TfLiteDelegate* delegate) const {
-  std::vector<char> buffer = CreateTfLiteModel();
+  std::random_device random_device;
+  const uint32_t seed = random_device();
+  std::vector<char> buffer = CreateTfLiteModel(seed,
+                                               /*dequantize_filter=*/false);
   const Model* model = GetModel(buffer.data());
+  std::vector<char> reference_buffer;
+  const Model* reference_model = model;
+  if (WeightsType() == WeightsType::kBlockWiseQuantizedInt4) {
+    reference_buffer = CreateTfLiteModel(seed, /*dequantize_filter=*/true);
+    reference_model = GetModel(reference_buffer.data());
+  }
 
   std::unique_ptr<Interpreter> delegate_interpreter;
   ASSERT_EQ(
@@ -113,7 +150,7 @@ void DynamicallyQuantizedFullyConnectedTester::Test(
   std::unique_ptr<Interpreter> default_interpreter;
   ASSERT_EQ(
       InterpreterBuilder(
-          model,
+          reference_model,
           ::tflite::ops::builtin::BuiltinOpResolverWithoutDefaultDelegates())(
           &default_interpreter),
       kTfLiteOk);
@@ -139,16 +176,19 @@ void DynamicallyQuantizedFullyConnectedTester::Test(
   Test(delegate_interpreter.get(), default_interpreter.get());
 }
 
-std::vector<char> DynamicallyQuantizedFullyConnectedTester::CreateTfLiteModel()
-    const {
-  std::random_device random_device;
-  auto rng = std::mt19937(random_device());
+std::vector<char> DynamicallyQuantizedFullyConnectedTester::CreateTfLiteModel(
+    uint32_t seed, bool dequantize_filter) const {
+  auto rng = std::mt19937(seed);
   auto filter_rng = std::bind(std::uniform_int_distribution<int32_t>(
                                   -std::numeric_limits<int8_t>::max(),
                                   std::numeric_limits<int8_t>::max()),
                               std::ref(rng));
   auto bias_rng =
       std::bind(std::uniform_real_distribution<float>(-10, 10), std::ref(rng));
+  // Multiples of 1/8 are exactly representable by the BF16 scales of XNNPACK.
+  auto block_scale_rng = std::bind(
+      [](int32_t numerator) { return numerator / 8.0f; },
+      std::bind(std::uniform_int_distribution<int32_t>(1, 8), std::ref(rng)));
 
   flatbuffers::FlatBufferBuilder builder;
 
@@ -160,7 +200,8 @@ std::vector<char> DynamicallyQuantizedFullyConnectedTester::CreateTfLiteModel()
   /*********************** Generate filter and bias data **********************/
   int filter_size_bytes = -1;
   switch (WeightsType()) {
-    case WeightsType::kChannelWiseQuantizedInt4: {
+    case WeightsType::kChannelWiseQuantizedInt4:
+    case WeightsType::kBlockWiseQuantizedInt4: {
       filter_size_bytes = (InputChannels() * OutputChannels() + 1) / 2;
       break;
     }
@@ -174,19 +215,58 @@ std::vector<char> DynamicallyQuantizedFullyConnectedTester::CreateTfLiteModel()
   std::generate(filter_data.begin(), filter_data.end(), std::ref(filter_rng));
   std::vector<float> bias_data(OutputChannels());
   std::generate(bias_data.begin(), bias_data.end(), std::ref(bias_rng));
+  const bool blockwise_quantized =
+      WeightsType() == WeightsType::kBlockWiseQuantizedInt4;
+  std::vector<float> block_scales;
+  std::vector<float> dequantized_filter_data;
+  if (blockwise_quantized) {
+    EXPECT_EQ(InputChannels() % BlockSize(), 0);
+    const int32_t blocks_per_channel = InputChannels() / BlockSize();
+    block_scales.resize(OutputChannels() * blocks_per_channel);
+    std::generate(block_scales.begin(), block_scales.end(),
+                  std::ref(block_scale_rng));
+    if (dequantize_filter) {
+      // INT4 values are packed two per byte, low nibble first.
+      dequantized_filter_data.resize(OutputChannels() * InputChannels());
+      for (int32_t oc = 0; oc < OutputChannels(); oc++) {
+        for (int32_t ic = 0; ic < InputChannels(); ic++) {
+          const int32_t index = oc * InputChannels() + ic;
+          const uint8_t packed = static_cast<uint8_t>(filter_data[index / 2]);
+          const int32_t nibble = index % 2 == 0 ? packed & 0xF : packed >> 4;
+          dequantized_filter_data[index] =
+              (nibble >= 8 ? nibble - 16 : nibble) *
+              block_scales[oc * blocks_per_channel + ic / BlockSize()];
+        }
+      }
+    }
+  }
 
   /****************************** Define buffers ******************************/
-  const std::array<flatbuffers::Offset<Buffer>, 3> buffersq{{
+  std::vector<flatbuffers::Offset<Buffer>> buffers{{
       CreateBuffer(builder, builder.CreateVector({})),
-      CreateBuffer(builder,
-                   builder.CreateVector(
-                       reinterpret_cast<const uint8_t*>(filter_data.data()),
-                       sizeof(int8_t) * filter_data.size())),
+      dequantize_filter && blockwise_quantized
+          ? CreateBuffer(builder,
+                         builder.CreateVector(
+                             reinterpret_cast<const uint8_t*>(
+                                 dequantized_filter_data.data()),
+                             sizeof(float) * dequantized_filter_data.size()))
+          : CreateBuffer(builder,
+                         builder.CreateVector(
+                             reinterpret_cast<const uint8_t*>(
+                                 filter_data.data()),
+                             sizeof(int8_t) * filter_data.size())),
       CreateBuffer(builder,
                    builder.CreateVector(
                        reinterpret_cast<const uint8_t*>(bias_data.data()),
                        sizeof(float) * bias_data.size())),
   }};
+  if (blockwise_quantized && !dequantize_filter) {
+    buffers.push_back(CreateBuffer(
+        builder,
+        builder.CreateVector(
+            reinterpret_cast<const uint8_t*>(block_scales.data()),
+            sizeof(float) * block_scales.size())));
+  }
 
   /****************************** Define tensors ******************************/
   const std::array<int32_t, 2> filter_shape{
@@ -198,9 +278,11 @@ std::vector<char> DynamicallyQuantizedFullyConnectedTester::CreateTfLiteModel()
       builder,
       builder.CreateVector<int32_t>(InputShape().data(), InputShape().size()),
       TensorType_FLOAT32, /*buffer=*/0));
-  tflite::TensorType filter_tensor_type;
+  tflite::TensorType filter_tensor_type = tflite::TensorType_FLOAT32;
   std::vector<float> filter_scale;
   std::vector<int64_t> filter_zero_point;
+  // The scales of block-wise quantized filters follow the output tensor.
+  const int32_t block_scales_tensor = HasBias() ? 4 : 3;
   switch (WeightsType()) {
     case WeightsType::kChannelWiseQuantizedInt4:
       filter_tensor_type = tflite::TensorType_INT4;
@@ -218,15 +300,38 @@ std::vector<char> DynamicallyQuantizedFullyConnectedTester::CreateTfLiteModel()
       filter_zero_point = {0};
       break;
     }
+    case WeightsType::kBlockWiseQuantizedInt4:
+      if (!dequantize_filter) {
+        filter_tensor_type = tflite::TensorType_INT4;
+      }
+      break;
+  }
+  if (!blockwise_quantized) {
+    tensors.emplace_back(CreateTensor(
+        builder,
+        builder.CreateVector<int32_t>(filter_shape.data(), filter_shape.size()),
+        filter_tensor_type, /*buffer=*/1, /*name=*/0,
+        CreateQuantizationParameters(
+            builder, /*min=*/0, /*max=*/0,
+            builder.CreateVector<float>(filter_scale),
+            builder.CreateVector<int64_t>(filter_zero_point))));
+  } else if (dequantize_filter) {
+    tensors.emplace_back(CreateTensor(
+        builder,
+        builder.CreateVector<int32_t>(filter_shape.data(), filter_shape.size()),
+        filter_tensor_type, /*buffer=*/1));
+  } else {
+    tensors.emplace_back(CreateTensor(
+        builder,
+        builder.CreateVector<int32_t>(filter_shape.data(), filter_shape.size()),
+        filter_tensor_type, /*buffer=*/1, /*name=*/0,
+        CreateQuantizationParameters(
+            builder, /*min=*/0, /*max=*/0, /*scale=*/0, /*zero_point=*/0,
+            QuantizationDetails_BlockwiseQuantization,
+            CreateBlockwiseQuantization(builder, block_scales_tensor,
+                                        /*zero_points=*/-1, BlockSize())
+                .Union())));
   }
-  tensors.emplace_back(CreateTensor(
-      builder,
-      builder.CreateVector<int32_t>(filter_shape.data(), filter_shape.size()),
-      filter_tensor_type, /*buffer=*/1, /*name=*/0,
-      CreateQuantizationParameters(
-          builder, /*min=*/0, /*max=*/0,
-          builder.CreateVector<float>(filter_scale),
-          builder.CreateVector<int64_t>(filter_zero_point))));
   if (HasBias()) {
     tensors.emplace_back(CreateTensor(
         builder,
@@ -237,6 +342,18 @@ std::vector<char> DynamicallyQuantizedFullyConnectedTester::CreateTfLiteModel()
       builder,
       builder.CreateVector<int32_t>(output_shape.data(), output_shape.size()),
       TensorType_FLOAT32));
+  // The operator and the subgraph only use the tensors up to the output.
+  const int32_t num_operator_tensors = static_cast<int32_t>(tensors.size());
+  if (blockwise_quantized && !dequantize_filter) {
+    EXPECT_EQ(num_operator_tensors, block_scales_tensor);
+    const std::array<int32_t, 2> block_scales_shape{
+        {OutputChannels(), InputChannels() / BlockSize()}};
+    tensors.emplace_back(CreateTensor(
+        builder,
+        builder.CreateVector<int32_t>(block_scales_shape.data(),
+                                      block_scales_shape.size()),
+        TensorType_FLOAT32, /*buffer=*/3));
+  }
 
   /***************************** Define operators *****************************/
   flatbuffers::Offset<FullyConnectedOptions> fully_connected_options =
@@ -244,14 +361,12 @@ std::vector<char> DynamicallyQuantizedFullyConnectedTester::CreateTfLiteModel()
           builder, Activation(), FullyConnectedOptionsWeightsFormat_DEFAULT,
           KeepDims(), /*asymmetric_quantize_inputs=*/true);
 
-  std::vector<int32_t> op_inputs{{static_cast<int32_t>(tensors.size()) - 3,
-                                  static_cast<int32_t>(tensors.size()) - 2}};
+  std::vector<int32_t> op_inputs{
+      {num_operator_tensors - 3, num_operator_tensors - 2}};
   if (HasBias()) {
-    op_inputs.insert(op_inputs.begin(),
-                     static_cast<int32_t>(tensors.size()) - 4);
+    op_inputs.insert(op_inputs.begin(), num_operator_tensors - 4);
   }
-  const std::array<int32_t, 1> op_outputs{
-      {static_cast<int32_t>(tensors.size()) - 1}};
+  const std::array<int32_t, 1> op_outputs{{num_operator_tensors - 1}};
   operators.emplace_back(CreateOperator(
       builder, /*opcode_index=*/0,
       builder.CreateVector<int32_t>(op_inputs.data(), op_inputs.size()),
@@ -260,9 +375,8 @@ std::vector<char> DynamicallyQuantizedFullyConnectedTester::CreateTfLiteModel()
 
   /****************************** Define subgraph *****************************/
   const std::array<int32_t, 1> subgraph_inputs{
-      {static_cast<int>(tensors.size()) - 3 - static_cast<int>(HasBias())}};
-  const std::array<int32_t, 1> subgraph_outputs{
-      {static_cast<int>(tensors.size()) - 1}};
+      {num_operator_tensors - 3 - static_cast<int>(HasBias())}};
+  const std::array<int32_t, 1> subgraph_outputs{{num_operator_tensors - 1}};
   flatbuffers::Offset<SubGraph> subgraph = CreateSubGraph(
       builder, builder.CreateVector(tensors.data(), tensors.size()),
       builder.CreateVector<int32_t>(subgraph_inputs.data(),
@@ -278,7 +392,7 @@ std::vector<char> DynamicallyQuantizedFullyConnectedTester::CreateTfLiteModel()
       builder, TFLITE_SCHEMA_VERSION,
       builder.CreateVector(operator_codes.data(), operator_codes.size()),
       builder.CreateVector(&subgraph, 1), description,
-      builder.CreateVector(buffersq.data(), buffersq.size()));
+      builder.CreateVector(buffers.data(), buffers.size()));
 
   builder.Finish(model_buffer);
 
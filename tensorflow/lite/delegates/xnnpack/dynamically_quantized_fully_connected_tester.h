@@ -34,6 +34,7 @@ enum class WeightsType {
   kChannelWiseQuantizedInt4,
   kChannelWiseQuantizedInt8,
   kTensorWiseQuantizedInt8,
+  kBlockWiseQuantizedInt4,
 };
 
 class DynamicallyQuantizedFullyConnectedTester {
@@ -98,6 +99,15 @@ class DynamicallyQuantizedFullyConnectedTester {
 
   inline float FilterScale() const { return filter_scale_; }
 
+  inline DynamicallyQuantizedFullyConnectedTester& BlockSize(
+      int32_t block_size) {
+    EXPECT_GT(block_size, 0);
+    block_size_ = block_size;
+    return *this;
+  }
+
+  inline int32_t BlockSize() const { return block_size_; }
+
   inline DynamicallyQuantizedFullyConnectedTester& KeepDims(bool keep_dims) {
     keep_dims_ = keep_dims;
     return *this;
@@ -142,7 +152,10 @@ class DynamicallyQuantizedFullyConnectedTester {
   void Test(TfLiteDelegate* delegate) const;
 
  private:
-  std::vector<char> CreateTfLiteModel() const;
+  // Block-wise quantized filters are not supported by the TFLite kernels, so
+  // the reference model uses the dequantized filter instead.
+  std::vector<char> CreateTfLiteModel(uint32_t seed,
+                                      bool dequantize_filter) const;
 
   inline bool HasBias() const { return has_bias_; }
 
@@ -162,6 +175,7 @@ class DynamicallyQuantizedFullyConnectedTester {
   enum WeightsType weights_type_ = WeightsType::kTensorWiseQuantizedInt8;
   int32_t filter_zero_point_ = 0;
   float filter_scale_ = 0.75f;
+  int32_t block_size_ = 32;
   bool keep_dims_ = false;
   bool has_bias_ = true;
   ::tflite::ActivationFunctionType activation_ =
@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/lite/delegates/xnnpack/quantization_util.h"
 
 #include <algorithm>
+#include <cmath>
+#include <cstring>
 
 #include "fp16.h"  // from @FP16
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
@@ -31,6 +33,21 @@ void DequantizeFloat16(const uint16_t *packed_fp16_data,
                  unpacked_fp32_data, fp16_ieee_to_fp32_value);
 }
 
+void QuantizeBFloat16(const float *unpacked_fp32_data,
+                      uint16_t *packed_bf16_data, size_t tensor_elements) {
+  std::transform(unpacked_fp32_data, unpacked_fp32_data + tensor_elements,
+                 packed_bf16_data, [](float value) -> uint16_t {
+                   uint32_t bits;
+                   std::memcpy(&bits, &value, sizeof(bits));
+                   if (std::isnan(value)) {
+                     // Keep NaNs quiet instead of rounding them to infinity.
+                     return static_cast<uint16_t>((bits >> 16) | 0x0040);
+                   }
+                   bits += 0x7FFF + ((bits >> 16) & 1);
+                   return static_cast<uint16_t>(bits >> 16);
+                 });
+}
+
 void DequantizeInt8(const int8_t *packed_s8_data, float *unpacked_fp32_data,
                     const RuntimeShape &tensor_shape, int32_t zero_point,
                     double scale) {
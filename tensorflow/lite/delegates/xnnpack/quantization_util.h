@@ -49,6 +49,11 @@ void PerChannelDequantizeInt8(const int8_t* packed_s8_data,
 void DequantizeFloat16(const uint16_t* packed_fp16_data,
                        float* unpacked_fp32_data, size_t tensor_elements);
 
+// Converts FP32 values to BF16, rounding to nearest with ties to even.
+// packed_bf16_data should be preallocated to have tensor_elements size.
+void QuantizeBFloat16(const float* unpacked_fp32_data,
+                      uint16_t* packed_bf16_data, size_t tensor_elements);
+
 }  // namespace xnnpack
 }  // namespace tflite
 
@@ -43,6 +43,17 @@ inline int32_t ZeroPointFromMinMax(const float min, const float max) {
          static_cast<int32_t>(-min / ScaleFromMinMax<T>(min, max) + 0.5f);
 }
 
+TEST(Quantize, BFloat16) {
+  // 1 + 2^-8 and 1 + 3 * 2^-8 are halfway between two BF16 values.
+  const std::vector<float> input = {1.0f,        -2.5f,   1.00390625f,
+                                    1.01171875f, 3.4e38f, 1e-40f};
+  std::vector<uint16_t> output(input.size());
+
+  QuantizeBFloat16(input.data(), output.data(), input.size());
+  EXPECT_THAT(output, testing::ElementsAre(0x3F80, 0xC020, 0x3F80, 0x3F82,
+                                           0x7F80, 0x0001));
+}
+
 TEST(Dequantize, Int8) {
   std::vector<int8_t> quantized_data = {-3, -2, -1, 1, 2, 3};
   std::vector<float> dequantized_data(quantized_data.size());
@@ -36,6 +36,7 @@ limitations under the License.
 #include <string>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "xnnpack.h"  // from @XNNPACK
 #include "flatbuffers/base.h"  // from @flatbuffers
@@ -57,6 +58,32 @@ namespace tflite::xnnpack {
 namespace {
 constexpr size_t kMinAlignment = 64;
 
+// The XNNPack commit that packs the weights. Cache files store a hash of it.
+// LINT.IfChange(xnnpack_version)
+constexpr char kXNNPackVersion[] = "50037f8072731a2cc30a961b96e199ad691887e4";
+// LINT.ThenChange(//tensorflow/workspace2.bzl)
+
+// Number of bytes hashed at the start and at the end of each buffer to
+// compute the model fingerprint.
+constexpr size_t kFingerprintSampleSize = 64;
+
+constexpr uint64_t kFnv1aOffsetBasis = 0xcbf29ce484222325ull;
+constexpr uint64_t kFnv1aPrime = 0x100000001b3ull;
+
+// Accumulates `size` bytes of `data` into a 64 bit FNV-1a hash.
+uint64_t Fnv1a(const void* data, size_t size, uint64_t hash) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * kFnv1aPrime;
+  }
+  return hash;
+}
+
+template <class T>
+uint64_t Fnv1aValue(const T& value, uint64_t hash) {
+  return Fnv1a(&value, sizeof(value), hash);
+}
+
 template <class F>
 class ScopeGuard {
  public:
@@ -85,6 +112,41 @@ bool FileExists(const char* path) {
 
 }  // namespace
 
+uint64_t GetXNNPackBuildIdentifier() {
+  static const uint64_t identifier =
+      Fnv1a(kXNNPackVersion, sizeof(kXNNPackVersion) - 1, kFnv1aOffsetBasis);
+  return identifier;
+}
+
+uint64_t ComputeModelFingerprint(
+    const TfLiteTensor* tensors, const size_t size,
+    const std::unordered_map<size_t, size_t>& tensor_index_to_identifier) {
+  // The map iteration order is not specified, sort it to get the same
+  // fingerprint in every process.
+  std::vector<std::pair<size_t, size_t>> identifiers(
+      tensor_index_to_identifier.begin(), tensor_index_to_identifier.end());
+  std::sort(identifiers.begin(), identifiers.end());
+  uint64_t hash = kFnv1aOffsetBasis;
+  for (const auto [index, identifier] : identifiers) {
+    XNNPACK_ABORT_CHECK(index < size,
+                        "Tensor index corresponds to a non existing tensor.");
+    const TfLiteTensor& tensor = tensors[index];
+    const uint64_t bytes = tensor.bytes;
+    const int32_t type = tensor.type;
+    hash = Fnv1aValue(static_cast<uint64_t>(index), hash);
+    hash = Fnv1aValue(static_cast<uint64_t>(identifier), hash);
+    hash = Fnv1aValue(type, hash);
+    hash = Fnv1aValue(bytes, hash);
+    if (tensor.data.data) {
+      const size_t sample_size = std::min(tensor.bytes, kFingerprintSampleSize);
+      const uint8_t* data = static_cast<const uint8_t*>(tensor.data.data);
+      hash = Fnv1a(data, sample_size, hash);
+      hash = Fnv1a(data + tensor.bytes - sample_size, sample_size, hash);
+    }
+  }
+  return hash;
+}
+
 void swap(MMapHandle& a, MMapHandle& b) {
   using std::swap;
   swap(a.size_, b.size_);
@@ -259,6 +321,7 @@ bool WeightCacheBuilder::Write(const char* path) {
   // space for it won't be added to the flatbuffer.
   schema_.flatbuffer_size = 1;
   schema_.base_offset = 1;
+  schema_.xnnpack_build_identifier = GetXNNPackBuildIdentifier();
   FinishPackedWeightsBuffer(
       builder, cache::schema::PackedWeights::Pack(builder, &schema_));
 
@@ -293,6 +356,8 @@ bool WeightCacheBuilder::Write(const char* path) {
   return true;
 }
 
+MMapWeightCacheProvider::~MMapWeightCacheProvider() { ReleaseBuildLock(); }
+
 MMapWeightCacheProvider::MMapWeightCacheProvider(
     MMapWeightCacheProvider&& other) {
   *this = std::move(other);
@@ -310,6 +375,10 @@ MMapWeightCacheProvider& MMapWeightCacheProvider::operator=(
   swap(cache_key_to_offset_, other.cache_key_to_offset_);
   swap(mmap_handle_, other.mmap_handle_);
   swap(mmap_buffer_base_offset_, other.mmap_buffer_base_offset_);
+  swap(mmap_model_fingerprint_, other.mmap_model_fingerprint_);
+  swap(model_fingerprint_, other.model_fingerprint_);
+  swap(model_fingerprint_is_set_, other.model_fingerprint_is_set_);
+  swap(build_lock_fd_, other.build_lock_fd_);
   swap(builder_, other.builder_);
   return *this;
 }
@@ -333,19 +402,23 @@ bool MMapWeightCacheProvider::Load(const std::string& path) {
 bool MMapWeightCacheProvider::Load() {
   XNNPACK_ABORT_CHECK(!file_path_.empty(),
                       "Path wasn't provided to weight cache provider.");
-  mmap_buffer_base_offset_ = 0;
-  cache_key_to_offset_.clear();
+  return LoadFrom(file_path_.c_str());
+}
 
-  if (!FileExists(file_path_.c_str())) {
+bool MMapWeightCacheProvider::LoadFrom(const char* path) {
+  UnMapCache();
+
+  if (!FileExists(path)) {
     TFLITE_LOG_PROD(tflite::TFLITE_LOG_WARNING,
-                    "XNNPack weight cache: could not load '%s': %s.",
-                    file_path_.c_str(), strerror(errno));
+                    "XNNPack weight cache: could not load '%s': %s.", path,
+                    strerror(errno));
     return false;
   }
 
-  if (!mmap_handle_.Map(file_path_.c_str())) {
+  if (!mmap_handle_.Map(path)) {
     return false;
   }
+  ScopeGuard unmap_on_error([this] { UnMapCache(); });
 
   // Verifiy the flabuffer part of the file.
   const size_t verifier_size =
@@ -367,7 +440,16 @@ bool MMapWeightCacheProvider::Load() {
         "XNNPack weight cache: could not get packed weights from flatbuffer.");
     return false;
   }
+  if (packed_weights->xnnpack_build_identifier() !=
+      GetXNNPackBuildIdentifier()) {
+    TFLITE_LOG_PROD(tflite::TFLITE_LOG_WARNING,
+                    "XNNPack weight cache: '%s' was built by a different "
+                    "XNNPack version.",
+                    path);
+    return false;
+  }
   mmap_buffer_base_offset_ = packed_weights->base_offset();
+  mmap_model_fingerprint_ = packed_weights->model_fingerprint();
   if (const auto buffers = packed_weights->buffers(); buffers) {
     for (auto* buffer : *buffers) {
       if (!buffer) {
@@ -383,12 +465,97 @@ bool MMapWeightCacheProvider::Load() {
           BufferLocation{.offset = buffer->offset(), .size = buffer->size()});
     }
   }
+  unmap_on_error.Deactivate();
+  return true;
+}
+
+void MMapWeightCacheProvider::UnMapCache() {
+  cache_key_to_offset_.clear();
+  mmap_handle_.UnMap();
+  mmap_buffer_base_offset_ = 0;
+  mmap_model_fingerprint_ = 0;
+}
+
+void MMapWeightCacheProvider::LoadOrLockForBuild() {
+  if (!AcquireBuildLock()) {
+    // The cache is still built, without coordinating with other processes.
+    return;
+  }
+  // Another process may have written the file while we waited for the lock.
+  if (FileExists(file_path_.c_str()) && Load()) {
+    if (mmap_model_fingerprint_ == model_fingerprint_) {
+      ReleaseBuildLock();
+      TFLITE_LOG_PROD(tflite::TFLITE_LOG_INFO,
+                      "XNNPack weight cache: loaded '%s' once it was built.",
+                      file_path_.c_str());
+      return;
+    }
+    UnMapCache();
+  }
+}
+
+bool MMapWeightCacheProvider::AcquireBuildLock() {
+#if defined(_MSC_VER)
+  return false;
+#else
+  if (build_lock_fd_ >= 0) {
+    return true;
+  }
+  const std::string lock_path = file_path_ + ".lock";
+  const int fd = open(lock_path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd == -1) {
+    TFLITE_LOG_PROD(tflite::TFLITE_LOG_WARNING,
+                    "XNNPack weight cache: could not open lock file ('%s'): "
+                    "%s.",
+                    lock_path.c_str(), strerror(errno));
+    return false;
+  }
+  // POSIX record locks are owned by the process: delegates of the same
+  // process never wait for each other and build their own cache.
+  struct flock lock = {};
+  lock.l_type = F_WRLCK;
+  lock.l_whence = SEEK_SET;
+  while (fcntl(fd, F_SETLKW, &lock) == -1) {
+    if (errno != EINTR) {
+      TFLITE_LOG_PROD(tflite::TFLITE_LOG_WARNING,
+                      "XNNPack weight cache: could not lock '%s': %s.",
+                      lock_path.c_str(), strerror(errno));
+      close(fd);
+      return false;
+    }
+  }
+  build_lock_fd_ = fd;
   return true;
+#endif
+}
+
+void MMapWeightCacheProvider::ReleaseBuildLock() {
+  if (build_lock_fd_ >= 0) {
+    // Closing the file releases the lock.
+    close(build_lock_fd_);
+    build_lock_fd_ = -1;
+  }
 }
 
 void MMapWeightCacheProvider::MapTensorIdentifiers(
     const TfLiteTensor* tensors, const size_t size,
     const std::unordered_map<size_t, size_t>& tensor_index_to_identifier) {
+  if (!model_fingerprint_is_set_) {
+    model_fingerprint_ =
+        ComputeModelFingerprint(tensors, size, tensor_index_to_identifier);
+    model_fingerprint_is_set_ = true;
+    builder_.SetModelFingerprint(model_fingerprint_);
+    if (IsFinalized() && mmap_model_fingerprint_ != model_fingerprint_) {
+      TFLITE_LOG_PROD(tflite::TFLITE_LOG_WARNING,
+                      "XNNPack weight cache: '%s' was built for a different "
+                      "model, rebuilding it.",
+                      file_path_.c_str());
+      UnMapCache();
+    }
+    if (!IsFinalized() && !file_path_.empty()) {
+      LoadOrLockForBuild();
+    }
+  }
   for (const auto [index, identifier] : tensor_index_to_identifier) {
     XNNPACK_ABORT_CHECK(index < size,
                         "Tensor index corresponds to a non existing tensor.");
@@ -449,7 +616,11 @@ void MMapWeightCacheProvider::Release() {
   cache_key_to_offset_.clear();
   mmap_handle_ = MMapHandle();
   mmap_buffer_base_offset_ = 0;
+  mmap_model_fingerprint_ = 0;
+  model_fingerprint_ = 0;
+  model_fingerprint_is_set_ = false;
   builder_ = WeightCacheBuilder();
+  ReleaseBuildLock();
 }
 
 bool MMapWeightCacheProvider::Finalize() {
@@ -462,12 +633,50 @@ bool MMapWeightCacheProvider::Finalize() {
                     "finalize the cache.");
     return false;
   }
-  if (!builder_.Write(file_path_.c_str())) {
+  ScopeGuard release_lock_on_return([this] { ReleaseBuildLock(); });
+
+#if defined(_MSC_VER)
+  const std::string write_path = file_path_;
+#else
+  // Write to a temporary file that is renamed once complete so that other
+  // processes never map a partially written cache.
+  std::string write_path = file_path_ + ".XXXXXX";
+  const int fd = mkstemp(write_path.data());
+  if (fd == -1) {
+    TFLITE_LOG_PROD(tflite::TFLITE_LOG_ERROR,
+                    "XNNPack weight cache: could not create temporary file "
+                    "('%s'): %s.",
+                    write_path.c_str(), strerror(errno));
+    return false;
+  }
+  fchmod(fd, 0644);
+  close(fd);
+  ScopeGuard remove_temp_file_on_error(
+      [&write_path] { unlink(write_path.c_str()); });
+#endif
+
+  if (!builder_.Write(write_path.c_str())) {
     return false;
   }
   builder_ = WeightCacheBuilder();
 
-  return Load();
+  // Map the file before renaming it: once renamed, another process may
+  // replace it.
+  if (!LoadFrom(write_path.c_str())) {
+    return false;
+  }
+
+#if !defined(_MSC_VER)
+  if (rename(write_path.c_str(), file_path_.c_str())) {
+    // The mapping stays valid, this process can still use the cache.
+    TFLITE_LOG_PROD(tflite::TFLITE_LOG_WARNING,
+                    "XNNPack weight cache: could not rename '%s' to '%s': %s.",
+                    write_path.c_str(), file_path_.c_str(), strerror(errno));
+    return true;
+  }
+  remove_temp_file_on_error.Deactivate();
+#endif
+  return true;
 }
 
 bool MMapWeightCacheProvider::IsFinalized() const {
@@ -136,6 +136,11 @@ class WeightCacheBuilder {
   // Checks whether this builder has data that needs to be written to disk.
   bool ShouldWrite() const;
 
+  // Sets the fingerprint of the model that is written to the file header.
+  void SetModelFingerprint(uint64_t fingerprint) {
+    schema_.model_fingerprint = fingerprint;
+  }
+
   // Writes the flatbuffer to disk.
   [[nodiscard /*Writing the weight cache can fail.*/]]
   bool Write(const char* path);
@@ -153,6 +158,20 @@ class WeightCacheBuilder {
   std::vector<uint8_t> buffer_data_;
 };
 
+// Identifies the XNNPack version that packed the weights of a cache file.
+//
+// Files written by a different version are rebuilt instead of being loaded.
+uint64_t GetXNNPackBuildIdentifier();
+
+// Computes a fingerprint of the constant buffers of a model.
+//
+// The fingerprint covers the buffer identifiers, the tensor types and sizes
+// and a sample of the start and end of each buffer. It is meant to detect a
+// cache file that was built for another model, not to authenticate it.
+uint64_t ComputeModelFingerprint(
+    const TfLiteTensor* tensors, size_t size,
+    const std::unordered_map<size_t, size_t>& tensor_index_to_identifier);
+
 // Allows XNNPack to directly load packed weights from disk instead of having to
 // repack them every time.
 //
@@ -166,9 +185,17 @@ class WeightCacheBuilder {
 //  - Load the cache file.
 //  - Finalize the cache before calling the run functions of XNNPack (setup and
 //    reshape are ok).
+//
+// The cache file can be shared by several processes. The first call to
+// `MapTensorIdentifiers` checks that a loaded file was built for the same model
+// and XNNPack version. If no valid file exists, it takes a lock on
+// `<file_path>.lock` so that only one process packs the weights while the
+// others wait for it and then map its file. The file is written to a
+// temporary path and renamed, so that readers never see a partial file.
 class MMapWeightCacheProvider {
  public:
   MMapWeightCacheProvider() = default;
+  ~MMapWeightCacheProvider();
   MMapWeightCacheProvider(const MMapWeightCacheProvider&) = delete;
   MMapWeightCacheProvider& operator=(const MMapWeightCacheProvider&) = delete;
   MMapWeightCacheProvider(MMapWeightCacheProvider&&);
@@ -190,6 +217,9 @@ class MMapWeightCacheProvider {
   bool Load();
 
   // Creates the tensor map.
+  //
+  // The first call also validates the loaded cache file against the model
+  // fingerprint and waits for a concurrent build of the file if needed.
   void MapTensorIdentifiers(
       const TfLiteTensor* tensors, size_t size,
       const std::unordered_map<size_t, size_t>& tensor_index_to_identifier);
@@ -271,6 +301,21 @@ class MMapWeightCacheProvider {
   // Hashes a cache key to lookup in `cache_key_to_identifier_`.
   PackIdentifier BuildPackIdentifier(const xnn_weights_cache_look_up_key& key);
 
+  // Maps the cache file at `path` and loads its buffer list.
+  bool LoadFrom(const char* path);
+
+  // Drops the mapped cache file.
+  void UnMapCache();
+
+  // Loads the cache file if it is valid for `model_fingerprint_`. Otherwise
+  // takes the build lock, which is held until the cache is finalized.
+  void LoadOrLockForBuild();
+
+  // Blocks until this process holds the lock guarding the cache file build.
+  bool AcquireBuildLock();
+
+  void ReleaseBuildLock();
+
   // Cache provider implementation for XNNPack.
   xnn_weights_cache_provider cache_provider_{
       .context = this,
@@ -297,6 +342,16 @@ class MMapWeightCacheProvider {
   // The offset to the first buffer data in the MMap allocation.
   size_t mmap_buffer_base_offset_;
 
+  // The model fingerprint stored in the mapped cache file.
+  uint64_t mmap_model_fingerprint_ = 0;
+
+  // The fingerprint of the model, set by the first `MapTensorIdentifiers`.
+  uint64_t model_fingerprint_ = 0;
+  bool model_fingerprint_is_set_ = false;
+
+  // File descriptor of the locked `<file_path>.lock` file, or -1.
+  int build_lock_fd_ = -1;
+
   // Used to build the cache.
   WeightCacheBuilder builder_;
 };
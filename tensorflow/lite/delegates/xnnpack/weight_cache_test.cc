@@ -592,6 +592,91 @@ TEST_F(LoadMMapWeightCacheProviderTest, LookUpSucceeds) {
               ElementsAreArray(reference_2.buffer));
 }
 
+TEST(MMapWeightCacheProviderTest, CacheBuiltForAnotherModelIsRebuilt) {
+  enum { kAlgoSeed };
+  TempFileDesc tmp_file(TempFileDesc::kAutoCLose);
+
+  FakeContext ctx;
+  ctx.AddTensor(/*buffer_identifier=*/0, /*size=*/12);
+  ctx.FinalizeTensors();
+  {
+    MMapWeightCacheProvider cache_provider;
+    cache_provider.SetFilePath(tmp_file.GetCPath());
+    cache_provider.MapTensorIdentifiers(ctx.tensors.data(), ctx.tensors.size(),
+                                        ctx.tensor_buffer_identifiers);
+    ctx.PackTensors(&cache_provider.GetCacheProvider(), kAlgoSeed, 0);
+    ASSERT_TRUE(cache_provider.Finalize());
+  }
+
+  FakeContext other_ctx;
+  other_ctx.AddTensor(/*buffer_identifier=*/0, /*size=*/24);
+  other_ctx.FinalizeTensors();
+  {
+    MMapWeightCacheProvider cache_provider;
+    ASSERT_TRUE(cache_provider.Load(tmp_file.GetPath()));
+    cache_provider.MapTensorIdentifiers(other_ctx.tensors.data(),
+                                        other_ctx.tensors.size(),
+                                        other_ctx.tensor_buffer_identifiers);
+    EXPECT_FALSE(cache_provider.IsFinalized());
+    EXPECT_TRUE(cache_provider.IsBuilding());
+  }
+  {
+    MMapWeightCacheProvider cache_provider;
+    ASSERT_TRUE(cache_provider.Load(tmp_file.GetPath()));
+    cache_provider.MapTensorIdentifiers(ctx.tensors.data(), ctx.tensors.size(),
+                                        ctx.tensor_buffer_identifiers);
+    EXPECT_TRUE(cache_provider.IsFinalized());
+  }
+}
+
+TEST(MMapWeightCacheProviderTest, RebuildingTheFileKeepsMappedCachesValid) {
+  enum { kAlgoSeed };
+  TempFileDesc tmp_file(TempFileDesc::kAutoCLose);
+
+  FakeContext ctx;
+  ctx.AddTensor(/*buffer_identifier=*/0, /*size=*/12);
+  ctx.FinalizeTensors();
+  MMapWeightCacheProvider cache_provider;
+  cache_provider.SetFilePath(tmp_file.GetCPath());
+  cache_provider.MapTensorIdentifiers(ctx.tensors.data(), ctx.tensors.size(),
+                                      ctx.tensor_buffer_identifiers);
+  const PackIdentifier pack_id =
+      ctx.PackTensors(&cache_provider.GetCacheProvider(), kAlgoSeed, 0);
+  ASSERT_TRUE(cache_provider.Finalize());
+
+  // Another model replaces the file while the first cache is in use.
+  FakeContext other_ctx;
+  other_ctx.AddTensor(/*buffer_identifier=*/0, /*size=*/24);
+  other_ctx.FinalizeTensors();
+  MMapWeightCacheProvider other_cache_provider;
+  other_cache_provider.SetFilePath(tmp_file.GetCPath());
+  other_cache_provider.MapTensorIdentifiers(
+      other_ctx.tensors.data(), other_ctx.tensors.size(),
+      other_ctx.tensor_buffer_identifiers);
+  const PackIdentifier other_pack_id = other_ctx.PackTensors(
+      &other_cache_provider.GetCacheProvider(), kAlgoSeed, 0);
+  ASSERT_TRUE(other_cache_provider.Finalize());
+
+  const auto& reference = ctx.packed_buffers.find(pack_id)->second;
+  EXPECT_THAT(LightSpan<const uint8_t>(
+                  cache_provider.OffsetToAddr(reference.offset),
+                  reference.buffer.size()),
+              ElementsAreArray(reference.buffer));
+
+  MMapWeightCacheProvider reloaded_cache_provider;
+  ASSERT_TRUE(reloaded_cache_provider.Load(tmp_file.GetPath()));
+  reloaded_cache_provider.MapTensorIdentifiers(
+      other_ctx.tensors.data(), other_ctx.tensors.size(),
+      other_ctx.tensor_buffer_identifiers);
+  ASSERT_TRUE(reloaded_cache_provider.IsFinalized());
+  const auto& other_reference =
+      other_ctx.packed_buffers.find(other_pack_id)->second;
+  EXPECT_THAT(LightSpan<const uint8_t>(
+                  reloaded_cache_provider.OffsetToAddr(other_reference.offset),
+                  other_reference.buffer.size()),
+              ElementsAreArray(other_reference.buffer));
+}
+
 TEST(MMapWeightCacheProviderTest, XnnpackCApiJourney) {
   using std::size;
   TempFileDesc temp_fd(TempFileDesc::kAutoCLose);
@@ -606,7 +691,7 @@ TEST(MMapWeightCacheProviderTest, XnnpackCApiJourney) {
   char fake_buffer_pointer[kBufferCount] = {0};
 
   {  // Build and reload scenario.
-    TfLiteTensor tensors[kBufferCount];
+    TfLiteTensor tensors[kBufferCount] = {};
     std::unordered_map<size_t, size_t> tensor_buffer_identifiers;
     for (int i = 0; i < kBufferCount; ++i) {
       tensors[i].data.data = (void*)(fake_buffer_pointer + i);
@@ -679,7 +764,7 @@ TEST(MMapWeightCacheProviderTest, XnnpackCApiJourney) {
   }
 
   {  // Load existing cache scenario.
-    TfLiteTensor tensors[kBufferCount];
+    TfLiteTensor tensors[kBufferCount] = {};
     std::unordered_map<size_t, size_t> tensor_buffer_identifiers;
     for (int i = 0; i < kBufferCount; ++i) {
       tensors[i].data.data = (void*)(fake_buffer_pointer + i);
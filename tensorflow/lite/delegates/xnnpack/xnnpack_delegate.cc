@@ -19,26 +19,43 @@ limitations under the License.
 #include <array>
 #include <cinttypes>
 #include <cmath>
+#include <condition_variable>  // NOLINT(build/c++11)
 #include <cstdint>
 #include <cstring>
+#include <deque>
 #include <limits>
 #include <map>
 #include <memory>
-#include <mutex>
+#include <mutex>  // NOLINT(build/c++11)
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+#if defined(__linux__)
+#include <linux/dma-buf.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif  // defined(__linux__)
+
 #include "experiments-config.h"  // from @XNNPACK
 #include "xnnpack.h"  // from @XNNPACK
+#include "tensorflow/lite/async/backend_async_kernel_interface.h"
+#include "tensorflow/lite/async/c/task.h"
+#include "tensorflow/lite/async/interop/c/attribute_map.h"
+#include "tensorflow/lite/async/interop/c/constants.h"
+#include "tensorflow/lite/async/interop/c/types.h"
 #include "tensorflow/lite/builtin_ops.h"
 #include "tensorflow/lite/c/c_api_types.h"
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/core/c/builtin_op_data.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/delegates/utils/async_type_helpers.h"
+#include "tensorflow/lite/delegates/utils/ret_macros.h"
 #include "tensorflow/lite/delegates/xnnpack/quantization_util.h"
 #include "tensorflow/lite/delegates/xnnpack/weight_cache.h"
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
@@ -52,6 +69,10 @@ limitations under the License.
 #include "tensorflow/lite/schema/schema_generated.h"
 #include "tensorflow/lite/tools/optimize/reduced_precision_support.h"
 
+#if defined(__linux__)
+#include "tensorflow/lite/delegates/utils/sync_fence.h"
+#endif  // defined(__linux__)
+
 struct TfLiteXNNPackDelegateWeightsCache;
 
 namespace tflite {
@@ -148,6 +169,19 @@ xnn_datatype GetXNNPackDatatype(TfLiteContext* context,
     }
     case kTfLiteInt8:
     case kTfLiteInt4: {
+      if (tensor.quantization.type == kTfLiteBlockwiseQuantization) {
+        // The scales live in a separate tensor, they are validated by
+        // CheckTensorQBInt4Type when the consuming node is visited.
+        if (tensor.type != kTfLiteInt4 ||
+            tensor.quantization.params == nullptr) {
+          TF_LITE_KERNEL_LOG(context,
+                             "unsupported block-wise quantization of %s "
+                             "tensor %d in XNNPACK delegate",
+                             TfLiteTypeGetName(tensor.type), t);
+          return xnn_datatype_invalid;
+        }
+        return xnn_datatype_qbint4;
+      }
       if (tensor.quantization.type != kTfLiteAffineQuantization) {
         TF_LITE_KERNEL_LOG(context,
                            "unsupported quantization type %d for %s "
@@ -747,6 +781,8 @@ class Delegate {
   MMapWeightCacheProvider weight_cache_provider_;
 };
 
+class SubgraphAsyncKernel;
+
 class Subgraph {
  public:
   // Defines all variable tensors in this subgraph. global_id_to_xnnpack_id is
@@ -972,6 +1008,11 @@ class Subgraph {
     std::unordered_map<int, uint32_t> tflite_tensor_to_xnnpack;
     std::vector<int> external_inputs;
     std::vector<int> external_outputs;
+    // Block-wise quantized INT4 tensors are converted to the representation
+    // XNNPACK expects. The converted data must outlive the runtime creation,
+    // which packs it.
+    std::vector<std::vector<uint16_t>> blockwise_bf16_scales;
+    std::vector<std::vector<uint8_t>> blockwise_u4_data;
     for (int t : tensors) {
       if (context->tensors[t].type == kTfLiteResource) {
         // We should never see a resource tensor if we are not handling variable
@@ -1068,6 +1109,46 @@ class Subgraph {
                   ->quantized_dimension,
               dims.data(), data, XNN_INVALID_VALUE_ID, flags, &xnnpack_id);
           break;
+        case xnn_datatype_qbint4: {
+          if (data == nullptr) {
+            status = xnn_status_invalid_parameter;
+            break;
+          }
+          const auto* quantization_params =
+              static_cast<const TfLiteBlockwiseQuantization*>(
+                  context->tensors[t].quantization.params);
+          const TfLiteTensor& scale_tensor =
+              context->tensors[quantization_params->scale];
+          const size_t num_scales = NumElements(&scale_tensor);
+          std::vector<float> fp32_scales(num_scales);
+          if (scale_tensor.type == kTfLiteFloat16) {
+            DequantizeFloat16(
+                reinterpret_cast<const uint16_t*>(scale_tensor.data.raw_const),
+                fp32_scales.data(), num_scales);
+          } else {
+            std::copy_n(GetTensorData<float>(&scale_tensor), num_scales,
+                        fp32_scales.begin());
+          }
+          blockwise_bf16_scales.emplace_back(num_scales);
+          QuantizeBFloat16(fp32_scales.data(),
+                           blockwise_bf16_scales.back().data(), num_scales);
+          // XNNPACK takes unsigned nibbles with a zero point, flipping the
+          // sign bit of both nibbles maps [-8, 7] to [0, 15].
+          const auto* s4_data = static_cast<const uint8_t*>(data);
+          const size_t num_bytes = context->tensors[t].bytes;
+          blockwise_u4_data.emplace_back(num_bytes);
+          std::transform(s4_data, s4_data + num_bytes,
+                         blockwise_u4_data.back().begin(),
+                         [](uint8_t v) { return v ^ 0x88; });
+          status = xnn_define_blockwise_quantized_tensor_value(
+              subgraph.get(), datatype, /*zero_point=*/8,
+              blockwise_bf16_scales.back().data(), dims.size(),
+              quantization_params->quantized_dimension,
+              quantization_params->blocksize, dims.data(),
+              blockwise_u4_data.back().data(), XNN_INVALID_VALUE_ID, flags,
+              &xnnpack_id);
+          break;
+        }
         default:
           status = xnn_define_tensor_value(
               subgraph.get(), datatype, dims.size(), dims.data(), data,
@@ -1227,14 +1308,21 @@ class Subgraph {
     return kTfLiteOk;
   }
 
-  TfLiteStatus Invoke(TfLiteContext* context, bool enable_subgraph_reshaping,
-                      Delegate* delegate) {
+  // Runs the subgraph. If `external_data` is not null, the external tensors
+  // it contains are read or written at the given locations instead of their
+  // TFLite tensor data.
+  TfLiteStatus Invoke(
+      TfLiteContext* context, bool enable_subgraph_reshaping,
+      Delegate* delegate,
+      const std::unordered_map<int, void*>* external_data = nullptr) {
     std::lock_guard<std::mutex> lock(delegate->workspace_mutex_);
     bool any_pointers_changed = false;
     for (std::pair<int, void*> io_info : externals_) {
       const TfLiteTensor& tensor = context->tensors[io_info.first];
       void* data_pointer = &dummy_data_;
-      if (tensor.data.raw != nullptr) {
+      if (external_data != nullptr && external_data->count(io_info.first)) {
+        data_pointer = external_data->at(io_info.first);
+      } else if (tensor.data.raw != nullptr) {
         data_pointer = tensor.data.raw;
       } else {
         if (tensor.bytes != 0) {
@@ -2160,6 +2248,86 @@ class Subgraph {
     return kTfLiteError;
   }
 
+  static TfLiteStatus CheckTensorQBInt4Type(const Delegate& delegate,
+                                            TfLiteContext* context,
+                                            const TfLiteTensor* tensors,
+                                            const TfLiteTensor& tensor,
+                                            int expected_quantized_dimension,
+                                            int tensor_index, int node_index) {
+    if (!delegate.support_signed_8bit_quantization() ||
+        !delegate.enable_latest_operators()) {
+      TF_LITE_MAYBE_KERNEL_LOG(
+          context,
+          "block-wise quantized tensor #%d in node #%d requires signed "
+          "quantization and the latest operators to be enabled",
+          tensor_index, node_index);
+      return kTfLiteError;
+    }
+    if (delegate.weight_cache_provider_.IsActive()) {
+      // The weight cache identifies weights by their buffer in the model,
+      // which the unpacked block-wise data does not have.
+      TF_LITE_MAYBE_KERNEL_LOG(
+          context,
+          "block-wise quantized tensor #%d in node #%d is not supported with "
+          "the weight cache file",
+          tensor_index, node_index);
+      return kTfLiteError;
+    }
+    const auto* quantization_params =
+        static_cast<const TfLiteBlockwiseQuantization*>(
+            tensor.quantization.params);
+    if (tensor.type != kTfLiteInt4 ||
+        tensor.quantization.type != kTfLiteBlockwiseQuantization ||
+        quantization_params == nullptr || NumDimensions(&tensor) != 2) {
+      TF_LITE_MAYBE_KERNEL_LOG(
+          context,
+          "unsupported block-wise quantized %s tensor #%d in node #%d",
+          TfLiteTypeGetName(tensor.type), tensor_index, node_index);
+      return kTfLiteError;
+    }
+    if (quantization_params->quantized_dimension !=
+        expected_quantized_dimension) {
+      TF_LITE_MAYBE_KERNEL_LOG(
+          context,
+          "unsupported quantized dimension %d in tensor #%d in node #%d",
+          quantization_params->quantized_dimension, tensor_index, node_index);
+      return kTfLiteError;
+    }
+    if (quantization_params->zero_point != -1) {
+      TF_LITE_MAYBE_KERNEL_LOG(context,
+                               "unsupported block-wise zero points in tensor "
+                               "#%d in node #%d",
+                               tensor_index, node_index);
+      return kTfLiteError;
+    }
+    const int block_size = quantization_params->blocksize;
+    const int output_channels = SizeOfDimension(&tensor, 0);
+    const int input_channels = SizeOfDimension(&tensor, 1);
+    // XNNPACK packs the blocks in multiples of 32 input channels.
+    if (block_size <= 0 || block_size % 32 != 0 ||
+        input_channels % block_size != 0) {
+      TF_LITE_MAYBE_KERNEL_LOG(
+          context,
+          "unsupported block size %d for %d input channels in tensor #%d in "
+          "node #%d",
+          block_size, input_channels, tensor_index, node_index);
+      return kTfLiteError;
+    }
+    const TfLiteTensor& scale_tensor = tensors[quantization_params->scale];
+    if ((scale_tensor.type != kTfLiteFloat32 &&
+         scale_tensor.type != kTfLiteFloat16) ||
+        scale_tensor.allocation_type != kTfLiteMmapRo ||
+        NumElements(&scale_tensor) !=
+            output_channels * (input_channels / block_size)) {
+      TF_LITE_MAYBE_KERNEL_LOG(
+          context,
+          "invalid block-wise scales tensor #%d for tensor #%d in node #%d",
+          quantization_params->scale, tensor_index, node_index);
+      return kTfLiteError;
+    }
+    return kTfLiteOk;
+  }
+
   static TfLiteStatus CheckTensorFloat32OrQInt32Type(const Delegate& delegate,
                                                      TfLiteContext* context,
                                                      const TfLiteTensor& tensor,
@@ -3220,12 +3388,34 @@ class Subgraph {
     TF_LITE_ENSURE_STATUS(CheckTensorFloat32Type(
         logging_context, input_a, node->inputs->data[0], node_index));
     const TfLiteTensor& input_b = tensors[node->inputs->data[1]];
-    TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQCInt8Type(
-        delegate, logging_context, input_b,
-        /*expected_quantized_dimension=*/params->adj_y
-            ? NumDimensions(&input_b) - 2
-            : NumDimensions(&input_b) - 1,
-        node->inputs->data[1], node_index));
+    // Block-wise quantized weights are only supported as a static [N, K]
+    // matrix, which is lowered to a fully connected operator.
+    const bool blockwise_quantized =
+        input_b.quantization.type == kTfLiteBlockwiseQuantization;
+    if (blockwise_quantized) {
+      if (!params->adj_y) {
+        TF_LITE_MAYBE_KERNEL_LOG(
+            logging_context,
+            "failed to delegate %s node #%d. block-wise quantized input B "
+            "requires adj_y",
+            EnumNameBuiltinOperator(BuiltinOperator_BATCH_MATMUL), node_index);
+        return kTfLiteError;
+      }
+      TF_LITE_ENSURE_STATUS(CheckTensorQBInt4Type(
+          delegate, logging_context, tensors, input_b,
+          /*expected_quantized_dimension=*/0, node->inputs->data[1],
+          node_index));
+      TF_LITE_ENSURE_STATUS(CheckTensorStaticAllocation(
+          logging_context, input_b, node->inputs->data[1],
+          BuiltinOperator_BATCH_MATMUL, node_index));
+    } else {
+      TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQCInt8Type(
+          delegate, logging_context, input_b,
+          /*expected_quantized_dimension=*/params->adj_y
+              ? NumDimensions(&input_b) - 2
+              : NumDimensions(&input_b) - 1,
+          node->inputs->data[1], node_index));
+    }
 
     // Check whether input_a will be quantized dynamically.
     const bool dynamically_quantized =
@@ -3278,7 +3468,51 @@ class Subgraph {
       // If we're using dynamic quantization, we first need to convert the first
       // input `A` from `float32` to `int8`, and set up the quantization
       // parameters of the already-quantized input `B`.
-      if (dynamically_quantized) {
+      if (blockwise_quantized) {
+        // Create the dynamically quantized input_a.
+        uint32_t dq_input_a_id = XNN_INVALID_VALUE_ID;
+        size_t dims_a[XNN_MAX_TENSOR_DIMS];
+        for (int i = 0; i < num_dims_a; ++i) {
+          dims_a[i] = SizeOfDimension(&input_a, i);
+        }
+        if (xnn_status status = xnn_define_dynamically_quantized_tensor_value(
+                subgraph, xnn_datatype_qdint8, num_dims_a,
+                /*num_nonbatch_dims=*/1, dims_a, XNN_INVALID_VALUE_ID,
+                /*flags=*/0, &dq_input_a_id);
+            status != xnn_status_success) {
+          TF_LITE_KERNEL_LOG(logging_context,
+                             "failed to create XNNPACK Value for tensor %d",
+                             -1);
+          return kTfLiteError;
+        }
+        if (xnn_status status = xnn_define_convert(
+                subgraph,
+                /*input_id=*/input_output_tensors.at(node->inputs->data[0]),
+                dq_input_a_id, /*flags=*/0);
+            status != xnn_status_success) {
+          TF_LITE_KERNEL_LOG(
+              logging_context, "failed to delegate %s node #%d",
+              EnumNameBuiltinOperator(BuiltinOperator_BATCH_MATMUL),
+              node_index);
+          return kTfLiteError;
+        }
+
+        // A x B^T with a [N, K] matrix B is a fully connected operator which
+        // keeps all the dimensions of A but the last one.
+        if (xnn_status status = xnn_define_fully_connected(
+                subgraph, -std::numeric_limits<float>::infinity(),
+                +std::numeric_limits<float>::infinity(), dq_input_a_id,
+                input_output_tensors.at(node->inputs->data[1]),
+                /*bias_id=*/XNN_INVALID_VALUE_ID,
+                input_output_tensors.at(node->outputs->data[0]), /*flags=*/0);
+            status != xnn_status_success) {
+          TF_LITE_KERNEL_LOG(
+              logging_context, "failed to delegate %s node #%d",
+              EnumNameBuiltinOperator(BuiltinOperator_BATCH_MATMUL),
+              node_index);
+          return kTfLiteError;
+        }
+      } else if (dynamically_quantized) {
         // Compute some shapes and sizes.
         const int32_t n = params->adj_y
                               ? SizeOfDimension(&input_b, num_dims_b - 2)
@@ -4099,6 +4333,8 @@ class Subgraph {
     TF_LITE_ENSURE_STATUS(CheckTensorShape(
         logging_context, filter_tensor, 2, node->inputs->data[1],
         BuiltinOperator_FULLY_CONNECTED, node_index));
+    const bool blockwise_quantized =
+        filter_tensor.quantization.type == kTfLiteBlockwiseQuantization;
     // Dynamic filter is supported, but only for FP32.
     if (delegate.support_dynamic_fully_connected_operator() &&
         filter_tensor.type == kTfLiteFloat32) {
@@ -4106,10 +4342,17 @@ class Subgraph {
           delegate, logging_context, filter_tensor, node->inputs->data[1],
           node_index));
     } else {
-      TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQCInt4OrQCInt8Type(
-          delegate, logging_context, filter_tensor,
-          /*expected_quantized_dimension=*/0, node->inputs->data[1],
-          node_index));
+      if (blockwise_quantized) {
+        TF_LITE_ENSURE_STATUS(CheckTensorQBInt4Type(
+            delegate, logging_context, tensors, filter_tensor,
+            /*expected_quantized_dimension=*/0, node->inputs->data[1],
+            node_index));
+      } else {
+        TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQCInt4OrQCInt8Type(
+            delegate, logging_context, filter_tensor,
+            /*expected_quantized_dimension=*/0, node->inputs->data[1],
+            node_index));
+      }
       if (quasi_static_tensors.count(node->inputs->data[1]) == 0) {
         TF_LITE_ENSURE_STATUS(CheckTensorStaticAllocation(
             logging_context, filter_tensor, node->inputs->data[1],
@@ -4197,12 +4440,23 @@ class Subgraph {
         logging_context, node_index, fc_params->activation, &output_min,
         &output_max));
 
+    if (blockwise_quantized && input_tensor.type != kTfLiteFloat32) {
+      TF_LITE_MAYBE_KERNEL_LOG(
+          logging_context,
+          "unsupported block-wise quantized filter with %s input in "
+          "FULLY_CONNECTED operator #%d",
+          TfLiteTypeGetName(input_tensor.type), node_index);
+      return kTfLiteError;
+    }
+
     if (subgraph != nullptr) {
       if (dynamically_quantized) {
         TfLiteAffineQuantization* filter_params =
-            reinterpret_cast<TfLiteAffineQuantization*>(
-                filter_tensor.quantization.params);
-        if (filter_params->scale->size != output_channels) {
+            blockwise_quantized ? nullptr
+                                : reinterpret_cast<TfLiteAffineQuantization*>(
+                                      filter_tensor.quantization.params);
+        if (filter_params != nullptr &&
+            filter_params->scale->size != output_channels) {
           TfLiteFloatArrayFree(filter_params->scale);
           filter_params->scale = TfLiteFloatArrayCreate(output_channels);
           std::fill_n(filter_params->scale->data, output_channels,
@@ -4256,25 +4510,31 @@ class Subgraph {
               node_index);
           return kTfLiteError;
         }
-        std::vector<size_t> filter_dims(
-            &filter_tensor.dims->data[0],
-            &filter_tensor.dims->data[NumDimensions(&filter_tensor)]);
-        const xnn_datatype filter_datatype = GetXNNPackDatatype(
-            logging_context, filter_tensor, node->inputs->data[1]);
-        int32_t zero_point_value = filter_params->zero_point->data[0];
+        // Block-wise quantized filters were fully defined with the other
+        // tensors of the subgraph.
         uint32_t kernel_id = XNN_INVALID_VALUE_ID;
-        status = xnn_define_channelwise_quantized_tensor_value_v2(
-            subgraph, filter_datatype, zero_point_value,
-            filter_params->scale->data, filter_dims.size(), /*channel_dim=*/0,
-            filter_dims.data(), GetTensorData<int8_t>(&filter_tensor),
-            XNN_INVALID_VALUE_ID,
-            /*flags=*/0, &kernel_id);
-        if (status != xnn_status_success) {
-          TF_LITE_KERNEL_LOG(
-              logging_context, "failed to update filter tensor %s node #%d",
-              EnumNameBuiltinOperator(BuiltinOperator_FULLY_CONNECTED),
-              node_index);
-          return kTfLiteError;
+        if (blockwise_quantized) {
+          kernel_id = input_output_tensors.at(node->inputs->data[1]);
+        } else {
+          std::vector<size_t> filter_dims(
+              &filter_tensor.dims->data[0],
+              &filter_tensor.dims->data[NumDimensions(&filter_tensor)]);
+          const xnn_datatype filter_datatype = GetXNNPackDatatype(
+              logging_context, filter_tensor, node->inputs->data[1]);
+          int32_t zero_point_value = filter_params->zero_point->data[0];
+          status = xnn_define_channelwise_quantized_tensor_value_v2(
+              subgraph, filter_datatype, zero_point_value,
+              filter_params->scale->data, filter_dims.size(),
+              /*channel_dim=*/0, filter_dims.data(),
+              GetTensorData<int8_t>(&filter_tensor), XNN_INVALID_VALUE_ID,
+              /*flags=*/0, &kernel_id);
+          if (status != xnn_status_success) {
+            TF_LITE_KERNEL_LOG(
+                logging_context, "failed to update filter tensor %s node #%d",
+                EnumNameBuiltinOperator(BuiltinOperator_FULLY_CONNECTED),
+                node_index);
+            return kTfLiteError;
+          }
         }
         status = xnn_define_fully_connected(
             subgraph, output_min, output_max, dq_quantized_id, kernel_id,
@@ -7297,6 +7557,14 @@ class Subgraph {
 
   inline Delegate* GetDelegate() const { return delegate_; }
 
+  inline const std::vector<int>& inputs() const { return inputs_; }
+
+  inline const std::vector<int>& outputs() const { return outputs_; }
+
+  // Returns the kernel running this subgraph through the TFLite async API,
+  // which is created on the first call.
+  TfLiteAsyncKernel* GetAsyncKernel();
+
  private:
   Subgraph(Delegate& delegate, xnn_runtime_t runtime,
            const std::unordered_set<int>& externals, std::vector<int>& inputs,
@@ -7340,8 +7608,652 @@ class Subgraph {
   bool variables_set_up_ = false;
   bool enable_subgraph_reshaping_ = false;
   Delegate* delegate_;
+  // Declared last so that pending asynchronous executions complete before
+  // the runtime is destroyed.
+  std::unique_ptr<SubgraphAsyncKernel> async_kernel_;
 };
 
+// Runs a Subgraph through the TFLite async API (see
+// tensorflow/lite/core/async/async_signature_runner.h).
+//
+// The inputs and outputs of a task are bound to buffers registered by the
+// application, that XNNPACK reads and writes in place. Scheduled tasks run in
+// order on a worker thread, so that the application can fill the inputs of
+// the next task while the previous one is running. Inputs can wait on sync
+// fences, which are waited for on the worker thread; outputs are ready when
+// Wait() returns.
+class SubgraphAsyncKernel
+    : public ::tflite::delegates::BackendAsyncKernelInterface {
+ public:
+  using BufferAttributes = ::tflite::delegates::utils::BufferAttributes;
+  using BufferType = ::tflite::delegates::utils::BufferType;
+  using SyncAttributes = ::tflite::delegates::utils::SyncAttributes;
+  using SyncType = ::tflite::delegates::utils::SyncType;
+
+  explicit SubgraphAsyncKernel(Subgraph* subgraph) : subgraph_(subgraph) {}
+
+  ~SubgraphAsyncKernel() override {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    cv_.notify_all();
+    if (worker_.joinable()) {
+      worker_.join();
+    }
+  }
+
+  // Buffer operations
+  TfLiteStatus RegisterBuffer(TfLiteOpaqueContext* opaque_context,
+                              TfLiteIoType io_type,
+                              const TfLiteBackendBuffer* buffer,
+                              const TfLiteAttributeMap* attrs,
+                              TfLiteBufferHandle handle) override;
+  TfLiteStatus RegisterBufferSlice(TfLiteOpaqueContext* opaque_context,
+                                   TfLiteBufferHandle buffer_pool,
+                                   const TfLiteAttributeMap* attrs,
+                                   TfLiteBufferHandle handle) override;
+  TfLiteStatus UnregisterBuffer(TfLiteOpaqueContext* opaque_context,
+                                TfLiteBufferHandle handle) override;
+
+  // Reconciliations
+  const std::vector<const char*>& SupportedBufferTypes(
+      TfLiteIoType io_type) const override {
+    return supported_buffer_types_;
+  }
+  const std::vector<const char*>& SupportedSynchronizations(
+      TfLiteIoType io_type) const override {
+    return io_type == kTfLiteIoTypeInput ? supported_input_synchronizations_
+                                         : supported_output_synchronizations_;
+  }
+  bool ReconcileRestrictions(const TfLiteOpaqueContext* opaque_context,
+                             const TfLiteOpaqueNode* opaque_node,
+                             int tensor_index,
+                             const TfLiteAttributeMap* user_provided_attributes,
+                             TfLiteAttributeMap* merged,
+                             TfLiteAttributeMap* conflict) const override;
+  TfLiteStatus SetAttributes(TfLiteOpaqueContext* opaque_context,
+                             TfLiteOpaqueNode* opaque_node, int tensor_index,
+                             const TfLiteAttributeMap* attrs) override;
+  TfLiteStatus SetBufferAttributes(const TfLiteBackendBuffer* buffer,
+                                   const TfLiteAttributeMap* attrs) override;
+  TfLiteStatus GetBufferAttributes(const TfLiteBackendBuffer* buffer,
+                                   TfLiteAttributeMap* attrs) override;
+  TfLiteStatus Prepare(TfLiteOpaqueContext* opaque_context,
+                       TfLiteOpaqueNode* opaque_node) override;
+
+  // Execution methods
+  TfLiteStatus Eval(TfLiteOpaqueContext* opaque_context,
+                    TfLiteOpaqueNode* opaque_node,
+                    TfLiteExecutionTask* task) override;
+  TfLiteStatus Wait(TfLiteOpaqueContext* opaque_context,
+                    TfLiteExecutionTask* task) override;
+  TfLiteStatus Finish(TfLiteOpaqueContext* opaque_context,
+                      TfLiteExecutionTask* task) override;
+
+ private:
+  // Inputs of the task are read up to XNN_EXTRA_BYTES past their end.
+  static constexpr size_t kRequiredInputPadding = XNN_EXTRA_BYTES;
+
+  // A dma-buf mapped into the address space of the process. It is shared by
+  // the buffers and buffer slices registered from it, and kept alive by the
+  // executions using it.
+  class DmaBufMapping {
+   public:
+    DmaBufMapping(int fd, void* address, size_t length)
+        : fd_(fd), address_(address), length_(length) {}
+    ~DmaBufMapping();
+
+    char* data() const { return static_cast<char*>(address_); }
+
+    // Brackets CPU accesses to the buffer with DMA_BUF_IOCTL_SYNC, so that
+    // caches are kept coherent with the devices sharing it.
+    bool BeginCpuAccess() const;
+    bool EndCpuAccess() const;
+
+   private:
+    int fd_;
+    void* address_;
+    size_t length_;
+  };
+
+  struct RegisteredBuffer {
+    char* data = nullptr;
+    size_t size = 0;
+    std::shared_ptr<DmaBufMapping> dma_buf;
+  };
+
+  // A scheduled execution of a task.
+  struct Execution {
+    TfLiteContext* context = nullptr;
+    // Locations of the external tensors bound to registered buffers.
+    std::unordered_map<int, void*> external_data;
+    std::vector<std::shared_ptr<DmaBufMapping>> dma_bufs;
+    std::vector<int> input_fence_fds;
+    bool done = true;
+    TfLiteStatus status = kTfLiteOk;
+  };
+
+  static TfLiteStatus ReadBufferAttributes(const TfLiteAttributeMap* attrs,
+                                           BufferAttributes& buffer_attrs);
+  static bool ReconcileBufferRestrictions(const TfLiteContext* context,
+                                          int tensor_index, bool is_input,
+                                          const BufferAttributes& user,
+                                          BufferAttributes& merged,
+                                          BufferAttributes& conflict);
+
+  TfLiteStatus BindBuffer(const TfLiteContext* context,
+                          const TfLiteExecutionTask* task, int tensor_index,
+                          bool is_input, Execution& execution);
+  TfLiteStatus Run(Execution& execution);
+  void WorkerLoop();
+
+  Subgraph* subgraph_;
+
+  const std::vector<const char*> supported_buffer_types_ = {
+      ::tflite::delegates::utils::kBufferTypeHostMemory,
+#if defined(__linux__)
+      ::tflite::delegates::utils::kBufferTypeDmaBuf,
+#endif  // defined(__linux__)
+  };
+  const std::vector<const char*> supported_input_synchronizations_ = {
+      kTfLiteSyncTypeNoSyncObj,
+#if defined(__linux__)
+      ::tflite::delegates::utils::kSyncTypeSyncFenceFd,
+#endif  // defined(__linux__)
+  };
+  const std::vector<const char*> supported_output_synchronizations_ = {
+      kTfLiteSyncTypeNoSyncObj};
+
+  std::mutex mutex_;
+  // Signalled when an execution is scheduled or completed, and on
+  // destruction.
+  std::condition_variable cv_;
+  std::unordered_map<TfLiteBufferHandle, RegisteredBuffer> buffers_;
+  std::unordered_map<const void*, BufferAttributes> attributes_by_buffer_;
+  std::unordered_map<int, SyncType> sync_type_by_tensor_index_;
+  bool prepared_ = false;
+  std::unordered_map<const TfLiteExecutionTask*, std::unique_ptr<Execution>>
+      executions_;
+  // Scheduled executions, in order. The front one is running.
+  std::deque<Execution*> queue_;
+  bool stopping_ = false;
+  std::thread worker_;
+};
+
+SubgraphAsyncKernel::DmaBufMapping::~DmaBufMapping() {
+#if defined(__linux__)
+  munmap(address_, length_);
+  close(fd_);
+#endif  // defined(__linux__)
+}
+
+bool SubgraphAsyncKernel::DmaBufMapping::BeginCpuAccess() const {
+#if defined(__linux__)
+  dma_buf_sync sync = {DMA_BUF_SYNC_START | DMA_BUF_SYNC_RW};
+  return ioctl(fd_, DMA_BUF_IOCTL_SYNC, &sync) == 0;
+#else
+  return false;
+#endif  // defined(__linux__)
+}
+
+bool SubgraphAsyncKernel::DmaBufMapping::EndCpuAccess() const {
+#if defined(__linux__)
+  dma_buf_sync sync = {DMA_BUF_SYNC_END | DMA_BUF_SYNC_RW};
+  return ioctl(fd_, DMA_BUF_IOCTL_SYNC, &sync) == 0;
+#else
+  return false;
+#endif  // defined(__linux__)
+}
+
+TfLiteStatus SubgraphAsyncKernel::ReadBufferAttributes(
+    const TfLiteAttributeMap* attrs, BufferAttributes& buffer_attrs) {
+  TFLITE_RET_CHECK_STATUS(
+      TfLiteAttributeMapIsBufferAttributeMap(attrs),
+      "calling RegisterBuffer with invalid attribute map type");
+  buffer_attrs = ::tflite::delegates::utils::ReadBufferAttrs(attrs);
+  TFLITE_RET_CHECK_STATUS(
+      buffer_attrs.buffer_type.has_value(),
+      "calling RegisterBuffer with buffer resource type name unspecified");
+  TFLITE_RET_CHECK_STATUS(
+      buffer_attrs.buffer_type.value() == BufferType::kHostMemory ||
+          buffer_attrs.buffer_type.value() == BufferType::kDmaBuf,
+      "calling RegisterBuffer with unsupported buffer resource type");
+  TFLITE_RET_CHECK_STATUS(buffer_attrs.size.has_value(),
+                          "calling RegisterBuffer with buffer size "
+                          "unspecified");
+  return kTfLiteOk;
+}
+
+bool SubgraphAsyncKernel::ReconcileBufferRestrictions(
+    const TfLiteContext* context, int tensor_index, bool is_input,
+    const BufferAttributes& user, BufferAttributes& merged,
+    BufferAttributes& conflict) {
+  const BufferType buffer_type =
+      user.buffer_type.value_or(BufferType::kHostMemory);
+  if (buffer_type != BufferType::kHostMemory &&
+      buffer_type != BufferType::kDmaBuf) {
+    conflict.buffer_type = BufferType::kHostMemory;
+    return false;
+  }
+  merged.buffer_type = buffer_type;
+  // XNNPACK doesn't require external data to be more aligned than its
+  // elements, which any allocation meets.
+  if (user.alignment.has_value()) {
+    merged.alignment = user.alignment;
+  }
+  if (user.padding.has_value()) {
+    merged.padding = user.padding;
+  }
+  const size_t required_size =
+      context->tensors[tensor_index].bytes +
+      (is_input ? kRequiredInputPadding : 0);
+  merged.size = std::max(user.size.value_or(0), required_size);
+  return true;
+}
+
+bool SubgraphAsyncKernel::ReconcileRestrictions(
+    const TfLiteOpaqueContext* opaque_context,
+    const TfLiteOpaqueNode* opaque_node, int tensor_index,
+    const TfLiteAttributeMap* user_provided_attributes,
+    TfLiteAttributeMap* merged, TfLiteAttributeMap* conflict) const {
+  TFLITE_ABORT_CHECK(opaque_context != nullptr, "");            // Crash OK
+  TFLITE_ABORT_CHECK(user_provided_attributes != nullptr, "");  // Crash OK
+  TFLITE_ABORT_CHECK(merged != nullptr, "");                    // Crash OK
+
+  // The following cast is safe only because this code is part of the
+  // TF Lite runtime implementation.  Apps using TF Lite should not rely on
+  // TfLiteOpaqueContext and TfLiteContext being equivalent.
+  const auto* context = reinterpret_cast<const TfLiteContext*>(opaque_context);
+  const bool is_input =
+      std::find(subgraph_->inputs().begin(), subgraph_->inputs().end(),
+                tensor_index) != subgraph_->inputs().end();
+  if (TfLiteAttributeMapIsBufferAttributeMap(user_provided_attributes)) {
+    if (!TfLiteAttributeMapIsBufferAttributeMap(merged) ||
+        (conflict != nullptr &&
+         !TfLiteAttributeMapIsBufferAttributeMap(conflict))) {
+      TFLITE_LOG_PROD(tflite::TFLITE_LOG_ERROR,
+                      "'merged' or 'conflict' have a different attribute map "
+                      "type than 'user_provided_attributes'");
+      return false;
+    }
+    BufferAttributes merged_attrs{};
+    BufferAttributes conflict_attrs{};
+    const bool ok = ReconcileBufferRestrictions(
+        context, tensor_index, is_input,
+        ::tflite::delegates::utils::ReadBufferAttrs(user_provided_attributes),
+        merged_attrs, conflict_attrs);
+    ::tflite::delegates::utils::WriteBufferAttrs(merged_attrs, merged);
+    if (conflict != nullptr) {
+      ::tflite::delegates::utils::WriteBufferAttrs(conflict_attrs, conflict);
+    }
+    return ok;
+  }
+  if (TfLiteAttributeMapIsSyncAttributeMap(user_provided_attributes)) {
+    if (!TfLiteAttributeMapIsSyncAttributeMap(merged) ||
+        (conflict != nullptr &&
+         !TfLiteAttributeMapIsSyncAttributeMap(conflict))) {
+      TFLITE_LOG_PROD(tflite::TFLITE_LOG_ERROR,
+                      "'merged' or 'conflict' have a different attribute map "
+                      "type than 'user_provided_attributes'");
+      return false;
+    }
+    const SyncType sync_type =
+        ::tflite::delegates::utils::ReadSyncAttrs(user_provided_attributes)
+            .sync_type.value_or(SyncType::kNoSyncObj);
+    SyncAttributes merged_attrs{};
+    SyncAttributes conflict_attrs{};
+    bool ok = sync_type == SyncType::kNoSyncObj;
+#if defined(__linux__)
+    ok |= is_input && sync_type == SyncType::kSyncFenceFd;
+#endif  // defined(__linux__)
+    if (ok) {
+      merged_attrs.sync_type = sync_type;
+    } else {
+      conflict_attrs.sync_type = SyncType::kNoSyncObj;
+    }
+    ::tflite::delegates::utils::WriteSyncAttrs(merged_attrs, merged);
+    if (conflict != nullptr) {
+      ::tflite::delegates::utils::WriteSyncAttrs(conflict_attrs, conflict);
+    }
+    return ok;
+  }
+  TFLITE_LOG_PROD(tflite::TFLITE_LOG_ERROR,
+                  "unknown type of user_provided_attributes");
+  return false;
+}
+
+TfLiteStatus SubgraphAsyncKernel::SetAttributes(
+    TfLiteOpaqueContext* opaque_context, TfLiteOpaqueNode* opaque_node,
+    int tensor_index, const TfLiteAttributeMap* attrs) {
+  // Buffer attributes are checked against the tensors when a task is
+  // scheduled, so only sync attributes need to be recorded.
+  if (TfLiteAttributeMapIsBufferAttributeMap(attrs)) {
+    return kTfLiteOk;
+  }
+  TFLITE_RET_CHECK_STATUS(
+      TfLiteAttributeMapIsSyncAttributeMap(attrs),
+      "calling SetAttributes with an invalid attribute map type");
+  const SyncAttributes sync_attrs =
+      ::tflite::delegates::utils::ReadSyncAttrs(attrs);
+  TFLITE_RET_CHECK_STATUS(
+      sync_attrs.sync_type.has_value(),
+      "calling SetAttributes with sync object type name unspecified");
+  const SyncType sync_type = sync_attrs.sync_type.value();
+  const bool is_input =
+      std::find(subgraph_->inputs().begin(), subgraph_->inputs().end(),
+                tensor_index) != subgraph_->inputs().end();
+  bool supported = sync_type == SyncType::kNoSyncObj;
+#if defined(__linux__)
+  supported |= is_input && sync_type == SyncType::kSyncFenceFd;
+#endif  // defined(__linux__)
+  TFLITE_RET_CHECK_STATUS(
+      supported, "calling SetAttributes with unsupported sync object type");
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  TFLITE_RET_CHECK_STATUS(!prepared_,
+                          "SetAttributes must be called before Prepare");
+  sync_type_by_tensor_index_[tensor_index] = sync_type;
+  return kTfLiteOk;
+}
+
+TfLiteStatus SubgraphAsyncKernel::SetBufferAttributes(
+    const TfLiteBackendBuffer* buffer, const TfLiteAttributeMap* attrs) {
+  TFLITE_ABORT_CHECK(buffer != nullptr, "Buffer is null");    // Crash OK
+  TFLITE_ABORT_CHECK(attrs != nullptr, "Attribute is null");  // Crash OK
+  BufferAttributes buffer_attrs;
+  TFLITE_RET_CHECK_STATUS(
+      ReadBufferAttributes(attrs, buffer_attrs) == kTfLiteOk,
+      "SetBufferAttributes(): Failed to check attributes");
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = attributes_by_buffer_.find(TfLiteBackendBufferGetPtr(buffer));
+  TFLITE_RET_CHECK_STATUS(it != attributes_by_buffer_.end(),
+                          "Unable to find the buffer.");
+  it->second = buffer_attrs;
+  return kTfLiteOk;
+}
+
+TfLiteStatus SubgraphAsyncKernel::GetBufferAttributes(
+    const TfLiteBackendBuffer* buffer, TfLiteAttributeMap* attrs) {
+  TFLITE_ABORT_CHECK(buffer != nullptr, "Buffer is null");        // Crash OK
+  TFLITE_ABORT_CHECK(attrs != nullptr, "Attribute map is null");  // Crash OK
+  TFLITE_RET_CHECK_STATUS(
+      TfLiteAttributeMapIsBufferAttributeMap(attrs),
+      "calling GetBufferAttributes with an invalid attribute map type");
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = attributes_by_buffer_.find(TfLiteBackendBufferGetPtr(buffer));
+  TFLITE_RET_CHECK_STATUS(it != attributes_by_buffer_.end(),
+                          "Unable to find the buffer.");
+  ::tflite::delegates::utils::WriteBufferAttrs(it->second, attrs);
+  return kTfLiteOk;
+}
+
+TfLiteStatus SubgraphAsyncKernel::RegisterBuffer(
+    TfLiteOpaqueContext* opaque_context, TfLiteIoType io_type,
+    const TfLiteBackendBuffer* buffer, const TfLiteAttributeMap* attrs,
+    TfLiteBufferHandle handle) {
+  TFLITE_ABORT_CHECK(buffer != nullptr, "");                  // Crash OK
+  TFLITE_ABORT_CHECK(attrs != nullptr, "");                   // Crash OK
+  TFLITE_ABORT_CHECK(handle != kTfLiteNullBufferHandle, "");  // Crash OK
+  BufferAttributes buffer_attrs;
+  TFLITE_RET_CHECK_STATUS(
+      ReadBufferAttributes(attrs, buffer_attrs) == kTfLiteOk,
+      "RegisterBuffer(): Failed to check attributes");
+  void* ptr = TfLiteBackendBufferGetPtr(buffer);
+  TFLITE_RET_CHECK_STATUS(ptr != nullptr,
+                          "calling RegisterBuffer with nullptr buffer");
+  const size_t offset = buffer_attrs.offset.value_or(0);
+  const size_t size = buffer_attrs.size.value();
+
+  RegisteredBuffer registered_buffer;
+  registered_buffer.size = size;
+  if (buffer_attrs.buffer_type.value() == BufferType::kHostMemory) {
+    registered_buffer.data = static_cast<char*>(ptr) + offset;
+  } else {
+#if defined(__linux__)
+    // The file descriptor is duplicated so that the buffer stays valid if the
+    // application closes it before unregistering the buffer.
+    const int fd = dup(*static_cast<const int*>(ptr));
+    TFLITE_RET_CHECK_STATUS(fd >= 0, "failed to duplicate dma-buf fd");
+    void* address = mmap(nullptr, offset + size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) {
+      close(fd);
+      TFLITE_LOG_PROD(tflite::TFLITE_LOG_ERROR, "failed to map dma-buf");
+      return kTfLiteDelegateError;
+    }
+    registered_buffer.dma_buf =
+        std::make_shared<DmaBufMapping>(fd, address, offset + size);
+    registered_buffer.data = registered_buffer.dma_buf->data() + offset;
+#else
+    TFLITE_LOG_PROD(tflite::TFLITE_LOG_ERROR,
+                    "dma-buf buffers are not supported");
+    return kTfLiteDelegateError;
+#endif  // defined(__linux__)
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto [it, inserted] =
+      buffers_.try_emplace(handle, std::move(registered_buffer));
+  TFLITE_RET_CHECK_STATUS(inserted,
+                          "RegisterBuffer called with duplicate handle");
+  attributes_by_buffer_[ptr] = buffer_attrs;
+  return kTfLiteOk;
+}
+
+TfLiteStatus SubgraphAsyncKernel::RegisterBufferSlice(
+    TfLiteOpaqueContext* opaque_context, TfLiteBufferHandle buffer_pool,
+    const TfLiteAttributeMap* attrs, TfLiteBufferHandle handle) {
+  TFLITE_ABORT_CHECK(attrs != nullptr, "");                   // Crash OK
+  TFLITE_ABORT_CHECK(handle != kTfLiteNullBufferHandle, "");  // Crash OK
+  TFLITE_RET_CHECK_STATUS(
+      TfLiteAttributeMapIsBufferAttributeMap(attrs),
+      "calling RegisterBufferSlice with invalid attribute map type");
+  const BufferAttributes slice_attrs =
+      ::tflite::delegates::utils::ReadBufferAttrs(attrs);
+  TFLITE_RET_CHECK_STATUS(
+      slice_attrs.offset.has_value() && slice_attrs.size.has_value(),
+      "calling RegisterBufferSlice with slice offset or size unspecified");
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto pool = buffers_.find(buffer_pool);
+  TFLITE_RET_CHECK_STATUS(pool != buffers_.end(),
+                          "RegisterBufferSlice called with unknown pool");
+  TFLITE_RET_CHECK_STATUS(
+      slice_attrs.offset.value() + slice_attrs.size.value() <=
+          pool->second.size,
+      "calling RegisterBufferSlice with slice out of the pool bounds");
+  RegisteredBuffer slice = pool->second;
+  slice.data += slice_attrs.offset.value();
+  slice.size = slice_attrs.size.value();
+  auto [it, inserted] = buffers_.try_emplace(handle, std::move(slice));
+  TFLITE_RET_CHECK_STATUS(inserted,
+                          "RegisterBufferSlice called with duplicate handle");
+  return kTfLiteOk;
+}
+
+TfLiteStatus SubgraphAsyncKernel::UnregisterBuffer(
+    TfLiteOpaqueContext* opaque_context, TfLiteBufferHandle handle) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = buffers_.find(handle);
+  TFLITE_RET_CHECK_STATUS(it != buffers_.end(),
+                          "UnregisterBuffer called with unknown handle");
+  // Scheduled executions keep dma-buf mappings alive until they complete.
+  buffers_.erase(it);
+  return kTfLiteOk;
+}
+
+TfLiteStatus SubgraphAsyncKernel::Prepare(TfLiteOpaqueContext* opaque_context,
+                                          TfLiteOpaqueNode* opaque_node) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  TFLITE_RET_CHECK_STATUS(!prepared_, "Prepare must be called at most once");
+  prepared_ = true;
+  return kTfLiteOk;
+}
+
+TfLiteStatus SubgraphAsyncKernel::BindBuffer(const TfLiteContext* context,
+                                             const TfLiteExecutionTask* task,
+                                             int tensor_index, bool is_input,
+                                             Execution& execution) {
+  const TfLiteBufferHandle handle =
+      TfLiteExecutionTaskGetBufferByIndex(task, tensor_index);
+  if (handle == kTfLiteNullBufferHandle) {
+    // The tensor is read or written in the TFLite tensor data.
+    return kTfLiteOk;
+  }
+  auto it = buffers_.find(handle);
+  TFLITE_RET_CHECK_STATUS(it != buffers_.end(),
+                          "calling Eval with an unregistered buffer handle");
+  const size_t required_size = context->tensors[tensor_index].bytes +
+                               (is_input ? kRequiredInputPadding : 0);
+  TFLITE_RET_CHECK_STATUS(it->second.size >= required_size,
+                          "calling Eval with a buffer too small for its "
+                          "tensor");
+  execution.external_data[tensor_index] = it->second.data;
+  if (it->second.dma_buf != nullptr) {
+    execution.dma_bufs.push_back(it->second.dma_buf);
+  }
+
+  auto sync_type = sync_type_by_tensor_index_.find(tensor_index);
+  if (is_input && sync_type != sync_type_by_tensor_index_.end() &&
+      sync_type->second == SyncType::kSyncFenceFd) {
+    TfLiteSynchronization* sync =
+        TfLiteExecutionTaskGetSyncByIndex(task, tensor_index);
+    void* sync_obj =
+        sync != nullptr ? TfLiteSynchronizationGetPtr(sync) : nullptr;
+    if (sync_obj != nullptr && *static_cast<int*>(sync_obj) != -1) {
+      execution.input_fence_fds.push_back(*static_cast<int*>(sync_obj));
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus SubgraphAsyncKernel::Eval(TfLiteOpaqueContext* opaque_context,
+                                       TfLiteOpaqueNode* opaque_node,
+                                       TfLiteExecutionTask* task) {
+  // The following cast is safe only because this code is part of the
+  // TF Lite runtime implementation.  Apps using TF Lite should not rely on
+  // TfLiteOpaqueContext and TfLiteContext being equivalent.
+  auto* context = reinterpret_cast<TfLiteContext*>(opaque_context);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  TFLITE_RET_CHECK_STATUS(prepared_, "Eval must be called after Prepare");
+  std::unique_ptr<Execution>& execution = executions_[task];
+  if (execution == nullptr) {
+    execution = std::make_unique<Execution>();
+  }
+  TFLITE_RET_CHECK_STATUS(execution->done,
+                          "calling Eval on a task that is still running");
+  execution->context = context;
+  execution->external_data.clear();
+  execution->dma_bufs.clear();
+  execution->input_fence_fds.clear();
+  for (int t : subgraph_->inputs()) {
+    TFLITE_RET_CHECK_STATUS(
+        BindBuffer(context, task, t, /*is_input=*/true, *execution) ==
+            kTfLiteOk,
+        "Eval(): Failed to bind input buffer");
+  }
+  for (int t : subgraph_->outputs()) {
+    TFLITE_RET_CHECK_STATUS(
+        BindBuffer(context, task, t, /*is_input=*/false, *execution) ==
+            kTfLiteOk,
+        "Eval(): Failed to bind output buffer");
+  }
+
+  execution->done = false;
+  execution->status = kTfLiteOk;
+  queue_.push_back(execution.get());
+  if (!worker_.joinable()) {
+    worker_ = std::thread(&SubgraphAsyncKernel::WorkerLoop, this);
+  }
+  cv_.notify_all();
+  return kTfLiteOk;
+}
+
+TfLiteStatus SubgraphAsyncKernel::Wait(TfLiteOpaqueContext* opaque_context,
+                                       TfLiteExecutionTask* task) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto it = executions_.find(task);
+  if (it == executions_.end()) {
+    return kTfLiteOk;
+  }
+  Execution* execution = it->second.get();
+  cv_.wait(lock, [execution] { return execution->done; });
+  return execution->status;
+}
+
+TfLiteStatus SubgraphAsyncKernel::Finish(TfLiteOpaqueContext* opaque_context,
+                                         TfLiteExecutionTask* task) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto it = executions_.find(task);
+  if (it == executions_.end()) {
+    return kTfLiteOk;
+  }
+  Execution* execution = it->second.get();
+  cv_.wait(lock, [execution] { return execution->done; });
+  executions_.erase(it);
+  return kTfLiteOk;
+}
+
+TfLiteStatus SubgraphAsyncKernel::Run(Execution& execution) {
+#if defined(__linux__)
+  TFLITE_RET_CHECK_STATUS(
+      ::tflite::delegates::utils::WaitForAllFds(execution.input_fence_fds)
+          .has_value(),
+      "failed to wait for input sync fences");
+#endif  // defined(__linux__)
+  size_t num_begun = 0;
+  // Ends the CPU access to the dma-bufs it was begun for, all of them even if
+  // ending one fails.
+  const auto end_cpu_access = [&execution, &num_begun]() {
+    bool ended = true;
+    for (size_t i = 0; i < num_begun; ++i) {
+      ended = execution.dma_bufs[i]->EndCpuAccess() && ended;
+    }
+    return ended;
+  };
+  for (; num_begun < execution.dma_bufs.size(); ++num_begun) {
+    const bool begun = execution.dma_bufs[num_begun]->BeginCpuAccess();
+    if (!begun) end_cpu_access();
+    TFLITE_RET_CHECK_STATUS(begun, "failed to begin CPU access to dma-buf");
+  }
+  const TfLiteStatus status = subgraph_->Invoke(
+      execution.context, subgraph_->EnableSubgraphReshaping(),
+      subgraph_->GetDelegate(), &execution.external_data);
+  TFLITE_RET_CHECK_STATUS(end_cpu_access(),
+                          "failed to end CPU access to dma-buf");
+  return status;
+}
+
+void SubgraphAsyncKernel::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      return;
+    }
+    Execution* execution = queue_.front();
+    lock.unlock();
+    const TfLiteStatus status = Run(*execution);
+    lock.lock();
+    queue_.pop_front();
+    execution->dma_bufs.clear();
+    execution->status = status;
+    execution->done = true;
+    cv_.notify_all();
+  }
+}
+
+TfLiteAsyncKernel* Subgraph::GetAsyncKernel() {
+  if (async_kernel_ == nullptr) {
+    async_kernel_ = std::make_unique<SubgraphAsyncKernel>(this);
+  }
+  return async_kernel_->kernel();
+}
+
 TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
   // Clear previous data, in case the delegate is reused without re-creation.
   static_unpacked_data_map_.clear();
@@ -7763,6 +8675,15 @@ TfLiteStatus SubgraphInvoke(TfLiteContext* context, TfLiteNode* node) {
                subgraph->GetDelegate());
 }
 
+TfLiteAsyncKernel* SubgraphAsyncKernelGet(TfLiteContext* context,
+                                          TfLiteNode* node) {
+  if (node->user_data == nullptr) {
+    return nullptr;
+  }
+
+  return static_cast<Subgraph*>(node->user_data)->GetAsyncKernel();
+}
+
 void SubgraphFree(TfLiteContext* context, void* buffer) {
   if (buffer != nullptr) {
     delete static_cast<Subgraph*>(buffer);
@@ -7778,6 +8699,8 @@ const TfLiteRegistration kSubgraphRegistration = {
     /*.builtin_code=*/0,
     /*.custom_name=*/"TfLiteXNNPackDelegate",
     /*.version=*/2,
+    /*.registration_external=*/nullptr,
+    /*.async_kernel=*/SubgraphAsyncKernelGet,
 };
 
 TfLiteStatus DelegatePrepare(TfLiteContext* context, TfLiteDelegate* delegate) {
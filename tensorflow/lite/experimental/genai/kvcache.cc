@@ -14,14 +14,17 @@ limitations under the License.
 ==============================================================================*/
 
 #include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
 
 #include "flatbuffers/flexbuffers.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/core/subgraph.h"
 #include "tensorflow/lite/experimental/resource/cache_buffer.h"
+#include "tensorflow/lite/experimental/resource/paged_cache_buffer.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
@@ -43,12 +46,21 @@ static const int kDefaultTransformerLayerId = 0;
 
 static const int KVCACHE_KEY_RESOURCE = 42;
 static const int KVCACHE_VALUE_RESOURCE = 43;
+static const int KVCACHE_PAGED_KEY_RESOURCE = 44;
+static const int KVCACHE_PAGED_VALUE_RESOURCE = 45;
+static const int KVCACHE_QUANTIZED_KEY_RESOURCE = 46;
+static const int KVCACHE_QUANTIZED_VALUE_RESOURCE = 47;
 
 struct OpData {
   int num_layers;
   int layer_index;
   int max_num_entries;
   int first_slot_index;
+  // Number of entries in a block of the paged cache, or 0 if the cache is
+  // contiguous.
+  int block_size;
+  // Whether the contiguous cache stores int8 entries, each with its own scale.
+  bool quantized;
   // Pointers to the key and value cache buffers that this Op doesn't own
   // (and therefore does not free on destruction of this Op).
   resource::CacheBuffer* key_cache_buffer;
@@ -56,6 +68,10 @@ struct OpData {
   bool is_initialized;
   uint8_t* key_cache_ptr;
   uint8_t* value_cache_ptr;
+  // Pointers to the paged key and value cache buffers that this Op doesn't
+  // own, used if `block_size` is positive.
+  resource::PagedCacheBuffer* paged_key_cache_buffer;
+  resource::PagedCacheBuffer* paged_value_cache_buffer;
 };
 
 void* KVCacheInit(TfLiteContext* context, const char* buffer, size_t length) {
@@ -66,14 +82,97 @@ void* KVCacheInit(TfLiteContext* context, const char* buffer, size_t length) {
   op_data->num_layers = -1;
   op_data->layer_index = -1;
   op_data->first_slot_index = -1;
+  op_data->block_size = 0;
+  op_data->quantized = false;
   op_data->key_cache_buffer = nullptr;
   op_data->value_cache_buffer = nullptr;
   op_data->is_initialized = false;
   op_data->key_cache_ptr = nullptr;
   op_data->value_cache_ptr = nullptr;
+  op_data->paged_key_cache_buffer = nullptr;
+  op_data->paged_value_cache_buffer = nullptr;
   return op_data;
 }
 
+// Returns the paged cache buffer of the given resource id, creating it if
+// needed. The buffer is shared by all the layers.
+TfLiteStatus GetOrCreatePagedCacheBuffer(TfLiteContext* context,
+                                         int resource_id, const OpData& op_data,
+                                         int entry_size,
+                                         resource::PagedCacheBuffer** buffer) {
+  Subgraph* subgraph = reinterpret_cast<Subgraph*>(context->impl_);
+  auto& resources = subgraph->resources();
+  if (resources.count(resource_id) == 0) {
+    auto* cbuffer = new resource::PagedCacheBuffer();
+    resources.emplace(resource_id, cbuffer);
+    TF_LITE_ENSURE_OK(context, cbuffer->Initialize(
+                                   op_data.num_layers, op_data.max_num_entries,
+                                   op_data.block_size, entry_size));
+  }
+  *buffer = static_cast<resource::PagedCacheBuffer*>(
+      resources.at(resource_id).get());
+  TF_LITE_ENSURE_EQ(context, (*buffer)->GetBlockSize(), op_data.block_size);
+  TF_LITE_ENSURE_EQ(context, (*buffer)->GetEntrySize(), entry_size);
+  return kTfLiteOk;
+}
+
+// Returns the storage of a contiguous cache buffer.
+uint8_t* GetCacheData(resource::CacheBuffer* buffer) {
+  if (buffer->IsQuantized()) {
+    return reinterpret_cast<uint8_t*>(buffer->GetQuantizedBuffer());
+  }
+  return reinterpret_cast<uint8_t*>(buffer->GetBuffer());
+}
+
+// Gives `output` one scale per entry along its sequence dimension, and copies
+// the scales of the layer from `buffer` to it.
+TfLiteStatus SetEntryQuantization(TfLiteContext* context, const OpData& op_data,
+                                  resource::CacheBuffer* buffer,
+                                  TfLiteTensor* output) {
+  const int num_entries = op_data.max_num_entries;
+  auto* params =
+      reinterpret_cast<TfLiteAffineQuantization*>(output->quantization.params);
+  if (output->quantization.type != kTfLiteAffineQuantization ||
+      params == nullptr || params->scale == nullptr ||
+      params->scale->size != num_entries) {
+    TfLiteQuantizationFree(&output->quantization);
+    params = reinterpret_cast<TfLiteAffineQuantization*>(
+        malloc(sizeof(TfLiteAffineQuantization)));
+    params->scale = TfLiteFloatArrayCreate(num_entries);
+    params->zero_point = TfLiteIntArrayCreate(num_entries);
+    memset(params->zero_point->data, 0, sizeof(int) * num_entries);
+    params->quantized_dimension = 1;
+    output->quantization.type = kTfLiteAffineQuantization;
+    output->quantization.params = params;
+  }
+  TF_LITE_ENSURE_EQ(context, params->quantized_dimension, 1);
+  memcpy(params->scale->data,
+         buffer->GetScales() + op_data.layer_index * num_entries,
+         sizeof(float) * num_entries);
+  return kTfLiteOk;
+}
+
+// Quantizes `num_entries` float entries of `entry_size` elements to int8, with
+// a symmetric scale per entry.
+void QuantizeEntries(const float* input, int num_entries, int entry_size,
+                     int8_t* output, float* scales) {
+  for (int i = 0; i < num_entries; ++i) {
+    const float* entry = input + i * entry_size;
+    float max_abs = 0.0f;
+    for (int j = 0; j < entry_size; ++j) {
+      max_abs = std::max(max_abs, std::abs(entry[j]));
+    }
+    const float scale = max_abs / 127.0f;
+    const float inverse_scale = scale > 0.0f ? 1.0f / scale : 0.0f;
+    for (int j = 0; j < entry_size; ++j) {
+      const float quantized = std::round(entry[j] * inverse_scale);
+      output[i * entry_size + j] = static_cast<int8_t>(
+          std::min(127.0f, std::max(-127.0f, quantized)));
+    }
+    scales[i] = scale;
+  }
+}
+
 TfLiteStatus KVCachePrepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_EQ(context, NumInputs(node), 3);
   TF_LITE_ENSURE_EQ(context, NumOutputs(node), 2);
@@ -88,6 +187,7 @@ TfLiteStatus KVCachePrepare(TfLiteContext* context, TfLiteNode* node) {
     int32_t max_num_entries = flexbuffer_map["kv_cache_max"].AsInt32();
     int32_t num_layers = flexbuffer_map["num_layers"].AsInt32();
     int32_t layer_index = flexbuffer_map["layer_index"].AsInt32();
+    int32_t block_size = flexbuffer_map["kv_cache_block_size"].AsInt32();
     op_data->max_num_entries =
         max_num_entries > 0 ? max_num_entries : kDefaultMaxNumCacheEntries;
     op_data->num_layers =
@@ -95,6 +195,8 @@ TfLiteStatus KVCachePrepare(TfLiteContext* context, TfLiteNode* node) {
     op_data->layer_index =
         layer_index > 0 ? layer_index : kDefaultTransformerLayerId;
     op_data->first_slot_index = 0;
+    op_data->block_size = block_size > 0 ? block_size : 0;
+    op_data->quantized = flexbuffer_map["kv_cache_quantized"].AsBool();
     op_data->is_initialized = true;
   }
 
@@ -131,8 +233,8 @@ TfLiteStatus KVCachePrepare(TfLiteContext* context, TfLiteNode* node) {
   kfull->allocation_type = kTfLiteCustom;
   vfull->allocation_type = kTfLiteCustom;
 
-  kfull->type = kTfLiteFloat32;
-  vfull->type = kTfLiteFloat32;
+  kfull->type = op_data->quantized ? kTfLiteInt8 : kTfLiteFloat32;
+  vfull->type = op_data->quantized ? kTfLiteInt8 : kTfLiteFloat32;
 
   TfLiteIntArray* input_dims = key->dims;
   TfLiteIntArray* kcache_dims = TfLiteIntArrayCopy(input_dims);
@@ -140,6 +242,33 @@ TfLiteStatus KVCachePrepare(TfLiteContext* context, TfLiteNode* node) {
   kcache_dims->data[1] = op_data->max_num_entries;
   vcache_dims->data[1] = op_data->max_num_entries;
 
+  if (op_data->block_size > 0) {
+    if (op_data->quantized) {
+      TF_LITE_KERNEL_LOG(context, "A paged cache can not be quantized.");
+      return kTfLiteError;
+    }
+    // The paged cache is gathered into the outputs, which point to the gather
+    // buffers of the resources so that only the entries in use are written.
+    // The gather buffers are shared by all the layers, which is fine as the
+    // outputs of a layer are consumed before the next layer gathers its cache.
+    const int entry_size = input_dims->data[2] * input_dims->data[3];
+    TF_LITE_ENSURE_OK(context, GetOrCreatePagedCacheBuffer(
+                                   context, KVCACHE_PAGED_KEY_RESOURCE,
+                                   *op_data, entry_size,
+                                   &op_data->paged_key_cache_buffer));
+    TF_LITE_ENSURE_OK(context, GetOrCreatePagedCacheBuffer(
+                                   context, KVCACHE_PAGED_VALUE_RESOURCE,
+                                   *op_data, entry_size,
+                                   &op_data->paged_value_cache_buffer));
+    kfull->data.data = op_data->paged_key_cache_buffer->GetGatherBuffer();
+    vfull->data.data = op_data->paged_value_cache_buffer->GetGatherBuffer();
+    TF_LITE_ENSURE_OK(context,
+                      context->ResizeTensor(context, kfull, kcache_dims));
+    TF_LITE_ENSURE_OK(context,
+                      context->ResizeTensor(context, vfull, vcache_dims));
+    return kTfLiteOk;
+  }
+
   TfLiteIntArray* kcache_buffer_dims = TfLiteIntArrayCreate(5);
   // Batch
   kcache_buffer_dims->data[0] = input_dims->data[0];
@@ -158,25 +287,37 @@ TfLiteStatus KVCachePrepare(TfLiteContext* context, TfLiteNode* node) {
   Subgraph* subgraph = reinterpret_cast<Subgraph*>(context->impl_);
   auto& resources = subgraph->resources();
 
-  if (resources.count(KVCACHE_KEY_RESOURCE) == 0) {
+  const int key_resource_id = op_data->quantized
+                                  ? KVCACHE_QUANTIZED_KEY_RESOURCE
+                                  : KVCACHE_KEY_RESOURCE;
+  const int value_resource_id = op_data->quantized
+                                    ? KVCACHE_QUANTIZED_VALUE_RESOURCE
+                                    : KVCACHE_VALUE_RESOURCE;
+  if (resources.count(key_resource_id) == 0) {
     auto* cbuffer = new resource::CacheBuffer();
-    cbuffer->Initialize(*kcache_buffer_dims);
-    resources.emplace(KVCACHE_KEY_RESOURCE, cbuffer);
+    if (op_data->quantized) {
+      cbuffer->InitializeQuantized(*kcache_buffer_dims);
+    } else {
+      cbuffer->Initialize(*kcache_buffer_dims);
+    }
+    resources.emplace(key_resource_id, cbuffer);
     op_data->key_cache_buffer = cbuffer;
   } else {
-    resource::ResourceBase* resourcePtr =
-        resources.at(KVCACHE_KEY_RESOURCE).get();
+    resource::ResourceBase* resourcePtr = resources.at(key_resource_id).get();
     resource::CacheBuffer* cbuffer = (resource::CacheBuffer*)(resourcePtr);
     op_data->key_cache_buffer = cbuffer;
   }
-  if (resources.count(KVCACHE_VALUE_RESOURCE) == 0) {
+  if (resources.count(value_resource_id) == 0) {
     auto* cbuffer = new resource::CacheBuffer();
-    cbuffer->Initialize(*vcache_buffer_dims);
-    resources.emplace(KVCACHE_VALUE_RESOURCE, cbuffer);
+    if (op_data->quantized) {
+      cbuffer->InitializeQuantized(*vcache_buffer_dims);
+    } else {
+      cbuffer->Initialize(*vcache_buffer_dims);
+    }
+    resources.emplace(value_resource_id, cbuffer);
     op_data->value_cache_buffer = cbuffer;
   } else {
-    resource::ResourceBase* resourcePtr =
-        resources.at(KVCACHE_VALUE_RESOURCE).get();
+    resource::ResourceBase* resourcePtr = resources.at(value_resource_id).get();
     resource::CacheBuffer* cbuffer = (resource::CacheBuffer*)(resourcePtr);
     op_data->value_cache_buffer = cbuffer;
   }
@@ -186,12 +327,11 @@ TfLiteStatus KVCachePrepare(TfLiteContext* context, TfLiteNode* node) {
   const int elements_in_one_entry = shape.Dims(2) * shape.Dims(3);
   const int elements_in_one_block =
       op_data->max_num_entries * elements_in_one_entry;
-  uint8_t* k_ptr =
-      reinterpret_cast<uint8_t*>(op_data->key_cache_buffer->GetBuffer());
-  uint8_t* v_ptr =
-      reinterpret_cast<uint8_t*>(op_data->value_cache_buffer->GetBuffer());
-  k_ptr = k_ptr + sizeof(float) * op_data->layer_index * elements_in_one_block;
-  v_ptr = v_ptr + sizeof(float) * op_data->layer_index * elements_in_one_block;
+  uint8_t* k_ptr = GetCacheData(op_data->key_cache_buffer);
+  uint8_t* v_ptr = GetCacheData(op_data->value_cache_buffer);
+  const size_t element_size = op_data->quantized ? 1 : sizeof(float);
+  k_ptr = k_ptr + element_size * op_data->layer_index * elements_in_one_block;
+  v_ptr = v_ptr + element_size * op_data->layer_index * elements_in_one_block;
 
   size_t kcache_dims_flatsize = kcache_dims->data[0] * kcache_dims->data[1] *
                                 kcache_dims->data[2] * kcache_dims->data[3];
@@ -212,6 +352,15 @@ TfLiteStatus KVCachePrepare(TfLiteContext* context, TfLiteNode* node) {
   op_data->key_cache_ptr = k_ptr;
   op_data->value_cache_ptr = v_ptr;
 
+  if (op_data->quantized) {
+    TF_LITE_ENSURE_OK(context, SetEntryQuantization(context, *op_data,
+                                                    op_data->key_cache_buffer,
+                                                    kfull));
+    TF_LITE_ENSURE_OK(context, SetEntryQuantization(context, *op_data,
+                                                    op_data->value_cache_buffer,
+                                                    vfull));
+  }
+
   TF_LITE_ENSURE_OK(context,
                     context->ResizeTensor(context, kfull, kcache_dims));
   TF_LITE_ENSURE_OK(context,
@@ -226,7 +375,80 @@ void KVCacheFree(TfLiteContext* context, void* buffer) {
   delete static_cast<OpData*>(buffer);
 }
 
+// Same as the contiguous cache below, except that dropping the oldest entries
+// releases their blocks instead of moving the remaining entries.
+TfLiteStatus KVCacheEvalPaged(TfLiteContext* context, TfLiteNode* node,
+                              OpData* op_data) {
+  const TfLiteTensor* position;
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kPositionTensor, &position));
+  const TfLiteTensor* key;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kKeyTensor, &key));
+  const TfLiteTensor* value;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kValueTensor, &value));
+  TfLiteTensor* kfull;
+  TfLiteTensor* vfull;
+  TF_LITE_ENSURE_OK(context,
+                    GetOutputSafe(context, node, kFullKeyTensor, &kfull));
+  TF_LITE_ENSURE_OK(context,
+                    GetOutputSafe(context, node, kFullValueTensor, &vfull));
+
+  resource::PagedCacheBuffer* key_cache = op_data->paged_key_cache_buffer;
+  resource::PagedCacheBuffer* value_cache = op_data->paged_value_cache_buffer;
+  const int layer_index = op_data->layer_index;
+  const int64_t max_num_entries = op_data->max_num_entries;
+
+  RuntimeShape shape(GetTensorShape(key));
+  const int64_t num_slots_needed = shape.Dims(1);
+  const int elements_in_one_entry = shape.Dims(2) * shape.Dims(3);
+  const size_t num_bytes_per_tensor = sizeof(float) * elements_in_one_entry;
+
+  const int64_t input_first_idx = position->data.i64[0];
+  const int64_t input_last_idx = input_first_idx + num_slots_needed - 1;
+  const int64_t cache_last_slot_idx =
+      op_data->first_slot_index + max_num_entries - 1;
+  const int slots_to_shift = std::min(
+      std::max(static_cast<int64_t>(0), input_last_idx - cache_last_slot_idx),
+      max_num_entries);
+  if (input_first_idx < op_data->first_slot_index) {
+    TF_LITE_KERNEL_LOG(
+        context,
+        "Can not specify a position before this cache's first slot index of %d",
+        op_data->first_slot_index);
+    return kTfLiteError;
+  }
+  if (slots_to_shift > 0) {
+    key_cache->DropFirstEntries(layer_index, slots_to_shift);
+    value_cache->DropFirstEntries(layer_index, slots_to_shift);
+  }
+  op_data->first_slot_index = op_data->first_slot_index + slots_to_shift;
+
+  const int64_t first_slot = input_first_idx - op_data->first_slot_index;
+  TF_LITE_ENSURE(context, first_slot + num_slots_needed <= max_num_entries);
+  for (int64_t i = 0; i < num_slots_needed; ++i) {
+    memcpy(key_cache->GetEntry(layer_index, first_slot + i),
+           key->data.f + i * elements_in_one_entry, num_bytes_per_tensor);
+    memcpy(value_cache->GetEntry(layer_index, first_slot + i),
+           value->data.f + i * elements_in_one_entry, num_bytes_per_tensor);
+  }
+
+  const size_t current_num_entries = first_slot + num_slots_needed;
+  key_cache->SetNumEntries(layer_index, current_num_entries);
+  value_cache->SetNumEntries(layer_index, current_num_entries);
+
+  TF_LITE_ENSURE_EQ(context, key_cache->GetGatherBuffer(), kfull->data.f);
+  TF_LITE_ENSURE_EQ(context, value_cache->GetGatherBuffer(), vfull->data.f);
+  key_cache->Gather(layer_index);
+  value_cache->Gather(layer_index);
+  return kTfLiteOk;
+}
+
 TfLiteStatus KVCacheEval(TfLiteContext* context, TfLiteNode* node) {
+  OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
+  if (op_data->block_size > 0) {
+    return KVCacheEvalPaged(context, node, op_data);
+  }
+
   const TfLiteTensor* position;
   TF_LITE_ENSURE_OK(context,
                     GetInputSafe(context, node, kPositionTensor, &position));
@@ -242,10 +464,9 @@ TfLiteStatus KVCacheEval(TfLiteContext* context, TfLiteNode* node) {
                     GetOutputSafe(context, node, kFullKeyTensor, &kfull));
   TF_LITE_ENSURE_OK(context,
                     GetOutputSafe(context, node, kFullValueTensor, &vfull));
-  OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
 
-  float* key_cache_ptr = op_data->key_cache_buffer->GetBuffer();
-  float* value_cache_ptr = op_data->value_cache_buffer->GetBuffer();
+  const bool quantized = op_data->quantized;
+  const size_t element_size = quantized ? 1 : sizeof(float);
   const int layer_index = op_data->layer_index;
   const int64_t max_num_entries = op_data->max_num_entries;
   int current_num_entries =
@@ -257,13 +478,21 @@ TfLiteStatus KVCacheEval(TfLiteContext* context, TfLiteNode* node) {
   const int elements_in_one_entry = shape.Dims(2) * shape.Dims(3);
   const int elements_in_one_block =
       op_data->max_num_entries * elements_in_one_entry;
-  const int64_t num_bytes_per_tensor = sizeof(float) * elements_in_one_entry;
+  const int64_t num_bytes_per_tensor = element_size * elements_in_one_entry;
 
   // Get the pointers to the individual caches for a layer.
-  uint8_t* k_ptr = reinterpret_cast<uint8_t*>(key_cache_ptr);
-  uint8_t* v_ptr = reinterpret_cast<uint8_t*>(value_cache_ptr);
-  k_ptr = k_ptr + sizeof(float) * op_data->layer_index * elements_in_one_block;
-  v_ptr = v_ptr + sizeof(float) * op_data->layer_index * elements_in_one_block;
+  uint8_t* k_ptr = GetCacheData(op_data->key_cache_buffer);
+  uint8_t* v_ptr = GetCacheData(op_data->value_cache_buffer);
+  k_ptr = k_ptr + element_size * op_data->layer_index * elements_in_one_block;
+  v_ptr = v_ptr + element_size * op_data->layer_index * elements_in_one_block;
+  float* k_scales = nullptr;
+  float* v_scales = nullptr;
+  if (quantized) {
+    k_scales = op_data->key_cache_buffer->GetScales() +
+               op_data->layer_index * max_num_entries;
+    v_scales = op_data->value_cache_buffer->GetScales() +
+               op_data->layer_index * max_num_entries;
+  }
 
   // 0. Ensure output ptr is pointing to the cache data
   TF_LITE_ENSURE_EQ(context, k_ptr, op_data->key_cache_ptr);
@@ -313,13 +542,19 @@ TfLiteStatus KVCacheEval(TfLiteContext* context, TfLiteNode* node) {
     // And we need to write the entire cache.
     num_slots_for_output = max_num_entries;
     const int bytes_offset =
-        sizeof(float) * elements_in_one_entry * slots_to_shift;
-    const int size_bytes_to_shift = sizeof(float) * elements_in_one_entry *
+        element_size * elements_in_one_entry * slots_to_shift;
+    const int size_bytes_to_shift = element_size * elements_in_one_entry *
                                     (max_num_entries - slots_to_shift);
     // TODO(b/333893996): This is O(cache_size) data motion. Consider optimizing
     // with a circular buffer or similar.
     memmove(k_ptr, k_ptr + bytes_offset, size_bytes_to_shift);
     memmove(v_ptr, v_ptr + bytes_offset, size_bytes_to_shift);
+    if (quantized) {
+      const size_t size_bytes_of_scales =
+          sizeof(float) * (max_num_entries - slots_to_shift);
+      memmove(k_scales, k_scales + slots_to_shift, size_bytes_of_scales);
+      memmove(v_scales, v_scales + slots_to_shift, size_bytes_of_scales);
+    }
   }
 
   // Update the first slot this cache now covers.
@@ -330,8 +565,23 @@ TfLiteStatus KVCacheEval(TfLiteContext* context, TfLiteNode* node) {
   const int64_t bytes_offset_for_cache = first_slot * num_bytes_per_tensor;
 
   // 4. Put the key and value in their respective caches.
-  memcpy(k_ptr + bytes_offset_for_cache, key->data.data, key->bytes);
-  memcpy(v_ptr + bytes_offset_for_cache, value->data.data, value->bytes);
+  if (quantized) {
+    QuantizeEntries(key->data.f, num_slots_needed, elements_in_one_entry,
+                    reinterpret_cast<int8_t*>(k_ptr + bytes_offset_for_cache),
+                    k_scales + first_slot);
+    QuantizeEntries(value->data.f, num_slots_needed, elements_in_one_entry,
+                    reinterpret_cast<int8_t*>(v_ptr + bytes_offset_for_cache),
+                    v_scales + first_slot);
+    TF_LITE_ENSURE_OK(context,
+                      SetEntryQuantization(context, *op_data,
+                                           op_data->key_cache_buffer, kfull));
+    TF_LITE_ENSURE_OK(context,
+                      SetEntryQuantization(context, *op_data,
+                                           op_data->value_cache_buffer, vfull));
+  } else {
+    memcpy(k_ptr + bytes_offset_for_cache, key->data.data, key->bytes);
+    memcpy(v_ptr + bytes_offset_for_cache, value->data.data, value->bytes);
+  }
 
   // Update counts.
   current_num_entries =
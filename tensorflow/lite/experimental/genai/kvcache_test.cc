@@ -16,7 +16,9 @@ limitations under the License.
 #include <cstdint>
 #include <vector>
 
+#include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "flatbuffers/flexbuffers.h"  // from @flatbuffers
 #include "tensorflow/lite/c/c_api_types.h"
 #include "tensorflow/lite/experimental/genai/genai_ops.h"
 #include "tensorflow/lite/kernels/test_util.h"
@@ -30,13 +32,14 @@ static const int kDefaultMaxNumCacheEntries = 2048;
 class SimpleCacheOpModel : public SingleOpModel {
  public:
   SimpleCacheOpModel(const TensorData& pos_tensor, const TensorData& k_tensor,
-                     const TensorData& v_tensor) {
+                     const TensorData& v_tensor,
+                     const std::vector<uint8_t>& custom_options = {}) {
     pos_ = AddInput(pos_tensor);
     k_ = AddInput(k_tensor);
     v_ = AddInput(v_tensor);
     kfull_ = AddOutput(k_tensor.type);
     vfull_ = AddOutput(v_tensor.type);
-    SetCustomOp("KV_Cache", {}, ops::custom::Register_KV_CACHE);
+    SetCustomOp("KV_Cache", custom_options, ops::custom::Register_KV_CACHE);
 
     BuildInterpreter({GetShape(pos_), GetShape(k_), GetShape(v_)});
   }
@@ -67,6 +70,24 @@ class SimpleCacheOpModel : public SingleOpModel {
     return output;
   }
 
+  // Returns the cache of `tensor` dequantized with its scale per entry.
+  std::vector<float> GetDequantized(int tensor) {
+    const TfLiteTensor* t = interpreter_->tensor(tensor);
+    EXPECT_EQ(t->type, kTfLiteInt8);
+    const auto* params =
+        reinterpret_cast<TfLiteAffineQuantization*>(t->quantization.params);
+    const int num_entries = t->dims->data[1];
+    const int entry_size = NumElements(t) / num_entries;
+    EXPECT_EQ(params->scale->size, num_entries);
+    std::vector<float> output(NumElements(t));
+    for (int i = 0; i < output.size(); ++i) {
+      output[i] = t->data.int8[i] * params->scale->data[i / entry_size];
+    }
+    return output;
+  }
+  std::vector<float> GetDequantizedFullK() { return GetDequantized(kfull_); }
+  std::vector<float> GetDequantizedFullV() { return GetDequantized(vfull_); }
+
   TfLiteStatus ReAllocate() { return interpreter_->AllocateTensors(); }
 
  protected:
@@ -237,5 +258,87 @@ TEST(SimpleCacheOp2Test, ShiftSlotsInCache) {
   ASSERT_EQ(m.Invoke(), kTfLiteError);
 }
 
+std::vector<uint8_t> CacheOptions(int max_num_entries, int block_size,
+                                  bool quantized = false) {
+  flexbuffers::Builder fbb;
+  fbb.Map([&]() {
+    fbb.Int("kv_cache_max", max_num_entries);
+    fbb.Int("kv_cache_block_size", block_size);
+    fbb.Bool("kv_cache_quantized", quantized);
+  });
+  fbb.Finish();
+  return fbb.GetBuffer();
+}
+
+TEST(SimpleCacheOp2Test, PagedCacheMatchesContiguousCache) {
+  const int kMaxNumEntries = 10;
+  SimpleCacheOpModel contiguous(
+      {TensorType_INT64, {2}}, {TensorType_FLOAT32, {1, 2, 2, 3}},
+      {TensorType_FLOAT32, {1, 2, 2, 3}},
+      CacheOptions(kMaxNumEntries, /*block_size=*/0));
+  SimpleCacheOpModel paged({TensorType_INT64, {2}},
+                           {TensorType_FLOAT32, {1, 2, 2, 3}},
+                           {TensorType_FLOAT32, {1, 2, 2, 3}},
+                           CacheOptions(kMaxNumEntries, /*block_size=*/4));
+
+  // Fill the cache and keep writing so that the oldest entries are dropped.
+  for (int i = 0; i < 12; ++i) {
+    std::vector<float> key(12);
+    std::vector<float> value(12);
+    for (int j = 0; j < 12; ++j) {
+      key[j] = i * 12 + j + 1;
+      value[j] = -key[j];
+    }
+    for (SimpleCacheOpModel* m : {&contiguous, &paged}) {
+      m->SetPosition({2 * i, 2 * i + 1});
+      m->SetKey(key);
+      m->SetValue(value);
+      ASSERT_EQ(m->Invoke(), kTfLiteOk);
+    }
+    ASSERT_EQ(paged.GetFullK(), contiguous.GetFullK());
+    ASSERT_EQ(paged.GetFullV(), contiguous.GetFullV());
+  }
+
+  paged.SetPosition({0, 1});
+  EXPECT_EQ(paged.Invoke(), kTfLiteError);
+}
+
+TEST(SimpleCacheOp2Test, QuantizedCacheMatchesContiguousCache) {
+  const int kMaxNumEntries = 10;
+  SimpleCacheOpModel contiguous(
+      {TensorType_INT64, {2}}, {TensorType_FLOAT32, {1, 2, 2, 3}},
+      {TensorType_FLOAT32, {1, 2, 2, 3}},
+      CacheOptions(kMaxNumEntries, /*block_size=*/0));
+  SimpleCacheOpModel quantized(
+      {TensorType_INT64, {2}}, {TensorType_FLOAT32, {1, 2, 2, 3}},
+      {TensorType_FLOAT32, {1, 2, 2, 3}},
+      CacheOptions(kMaxNumEntries, /*block_size=*/0, /*quantized=*/true));
+
+  // Fill the cache and keep writing so that the entries and their scales are
+  // shifted.
+  for (int i = 0; i < 12; ++i) {
+    std::vector<float> key(12);
+    std::vector<float> value(12);
+    for (int j = 0; j < 12; ++j) {
+      key[j] = (i + 1) * (j - 5.5f);
+      value[j] = -key[j] / 3;
+    }
+    for (SimpleCacheOpModel* m : {&contiguous, &quantized}) {
+      m->SetPosition({2 * i, 2 * i + 1});
+      m->SetKey(key);
+      m->SetValue(value);
+      ASSERT_EQ(m->Invoke(), kTfLiteOk);
+    }
+    // The rounding error of an entry is about half of its scale, which is
+    // the largest magnitude of the entry divided by 127.
+    EXPECT_THAT(quantized.GetDequantizedFullK(),
+                testing::Pointwise(testing::FloatNear((i + 1) * 5.5f / 250),
+                                   contiguous.GetFullK()));
+    EXPECT_THAT(quantized.GetDequantizedFullV(),
+                testing::Pointwise(testing::FloatNear((i + 1) * 5.5f / 750),
+                                   contiguous.GetFullV()));
+  }
+}
+
 }  // namespace
 }  // namespace tflite
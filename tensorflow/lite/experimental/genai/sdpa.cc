@@ -69,6 +69,66 @@ void* SDPAInit(TfLiteContext* context, const char* buffer, size_t length) {
   return op_data;
 }
 
+// Checks that `tensor` is float, or int8 with a scale per entry of its sequence
+// dimension as written by the quantized KV cache.
+TfLiteStatus CheckKeyOrValueType(TfLiteContext* context,
+                                 const TfLiteTensor* tensor) {
+  if (tensor->type == kTfLiteFloat32) {
+    return kTfLiteOk;
+  }
+  TF_LITE_ENSURE_TYPES_EQ(context, tensor->type, kTfLiteInt8);
+  TF_LITE_ENSURE_EQ(context, tensor->quantization.type,
+                    kTfLiteAffineQuantization);
+  const auto* params = reinterpret_cast<const TfLiteAffineQuantization*>(
+      tensor->quantization.params);
+  TF_LITE_ENSURE(context, params != nullptr && params->scale != nullptr);
+  TF_LITE_ENSURE_EQ(context, params->quantized_dimension, 1);
+  TF_LITE_ENSURE_EQ(context, params->scale->size, tensor->dims->data[1]);
+  return kTfLiteOk;
+}
+
+// Permutes the (B, S, N, H) `input` with `perm` into `output`, dequantizing it
+// on the way if it is int8. This avoids materializing a float copy of a
+// quantized KV cache before the transpose.
+void TransposeKeyOrValue(const TfLiteTensor* input, const int perm[4],
+                         const RuntimeShape& output_shape, float* output) {
+  const RuntimeShape input_shape = GetTensorShape(input);
+  tflite::TransposeParams params;
+  params.perm_count = 4;
+  for (int i = 0; i < 4; ++i) {
+    params.perm[i] = perm[i];
+  }
+  if (input->type != kTfLiteInt8) {
+    reference_ops::Transpose(params, input_shape, GetTensorData<float>(input),
+                             output_shape, output);
+    return;
+  }
+  const float* scales = reinterpret_cast<const TfLiteAffineQuantization*>(
+                            input->quantization.params)
+                            ->scale->data;
+  const int8_t* input_data = GetTensorData<int8_t>(input);
+  // The stride in `output` of each of the input dimensions.
+  int output_strides[4];
+  int stride = 1;
+  for (int i = 3; i >= 0; --i) {
+    output_strides[perm[i]] = stride;
+    stride *= output_shape.Dims(i);
+  }
+  int input_index = 0;
+  for (int b = 0; b < input_shape.Dims(0); ++b) {
+    for (int s = 0; s < input_shape.Dims(1); ++s) {
+      const float scale = scales[s];
+      for (int n = 0; n < input_shape.Dims(2); ++n) {
+        float* out = output + b * output_strides[0] + s * output_strides[1] +
+                     n * output_strides[2];
+        for (int h = 0; h < input_shape.Dims(3); ++h) {
+          out[h * output_strides[3]] = input_data[input_index++] * scale;
+        }
+      }
+    }
+  }
+}
+
 TfLiteStatus SDPAPrepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_EQ(context, NumInputs(node), 4);
   TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
@@ -91,6 +151,9 @@ TfLiteStatus SDPAPrepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_EQ(context, NumDimensions(v_tensor),
                     NumDimensions(mask_tensor));
   TF_LITE_ENSURE_EQ(context, NumDimensions(mask_tensor), 4);
+  TF_LITE_ENSURE_TYPES_EQ(context, k_tensor->type, v_tensor->type);
+  TF_LITE_ENSURE_OK(context, CheckKeyOrValueType(context, k_tensor));
+  TF_LITE_ENSURE_OK(context, CheckKeyOrValueType(context, v_tensor));
 
   // Get custom op params
   const uint8_t* buffer =
@@ -367,7 +430,8 @@ TfLiteStatus SDPAEval(TfLiteContext* context, TfLiteNode* node) {
   Notes:
   Scale is computed using 1/sqrt(head_dim),
   head_dim = q[-1] = embedding_dim // num_q_heads
-  Only support for FLOAT32 inputs for now.
+  Only support for FLOAT32 inputs for now, except for int8 k/v with a scale
+  per sequence entry.
   Only support static tensors for now (k/v[1] = max sequence length)
   */
 
@@ -379,13 +443,9 @@ TfLiteStatus SDPAEval(TfLiteContext* context, TfLiteNode* node) {
   const TfLiteTensor* key_tensor;
   TF_LITE_ENSURE_OK(context,
                     GetInputSafe(context, node, kKeyTensor, &key_tensor));
-  auto key_shape = GetTensorShape(key_tensor);
-  auto key_data = GetTensorData<float>(key_tensor);
   const TfLiteTensor* value_tensor;
   TF_LITE_ENSURE_OK(context,
                     GetInputSafe(context, node, kValueTensor, &value_tensor));
-  auto value_shape = GetTensorShape(value_tensor);
-  auto value_data = GetTensorData<float>(value_tensor);
   const TfLiteTensor* attention_mask_tensor;
   TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kAttentionMaskTensor,
                                           &attention_mask_tensor));
@@ -494,14 +554,9 @@ TfLiteStatus SDPAEval(TfLiteContext* context, TfLiteNode* node) {
                            transpose_q_out_shape, transpose_q_out_data);
 
   // permute k {0, 2, 1, 3}
-  tflite::TransposeParams transpose_k_params;
-  transpose_k_params.perm_count = 4;
-  transpose_k_params.perm[0] = 0;
-  transpose_k_params.perm[1] = 2;
-  transpose_k_params.perm[2] = 1;
-  transpose_k_params.perm[3] = 3;
-  reference_ops::Transpose(transpose_k_params, key_shape, key_data,
-                           transpose_k_out_shape, transpose_k_out_data);
+  const int transpose_k_perm[4] = {0, 2, 1, 3};
+  TransposeKeyOrValue(key_tensor, transpose_k_perm, transpose_k_out_shape,
+                      transpose_k_out_data);
 
   // broadcast k to match num_heads
   // broadcasting similar to torch.repeat_interleave
@@ -578,14 +633,9 @@ TfLiteStatus SDPAEval(TfLiteContext* context, TfLiteNode* node) {
                          add_out_shape, add_out_data);
 
   // permute v {0, 2, 3, 1}
-  tflite::TransposeParams transpose_v_params;
-  transpose_v_params.perm_count = 4;
-  transpose_v_params.perm[0] = 0;
-  transpose_v_params.perm[1] = 2;
-  transpose_v_params.perm[2] = 3;
-  transpose_v_params.perm[3] = 1;
-  reference_ops::Transpose(transpose_v_params, value_shape, value_data,
-                           transpose_v_out_shape, transpose_v_out_data);
+  const int transpose_v_perm[4] = {0, 2, 3, 1};
+  TransposeKeyOrValue(value_tensor, transpose_v_perm, transpose_v_out_shape,
+                      transpose_v_out_data);
 
   // broadcast v to match num_heads
   // broadcasting similar to torch.repeat_interleave
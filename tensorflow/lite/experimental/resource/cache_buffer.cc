@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/lite/experimental/resource/cache_buffer.h"
 
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 
@@ -39,7 +40,28 @@ TfLiteStatus CacheBuffer::Initialize(const TfLiteIntArray& shape) {
   return kTfLiteOk;
 }
 
-size_t CacheBuffer::GetSize() { return sizeof(float) * NumElements(dims_); }
+TfLiteStatus CacheBuffer::InitializeQuantized(const TfLiteIntArray& shape) {
+  dims_ = TfLiteIntArrayCopy(&shape);
+  const size_t buf_size = NumElements(&shape);
+  quantized_buffer_.reset(new int8_t[buf_size]);
+  memset(quantized_buffer_.get(), 0, buf_size);
+  const size_t num_scales = shape.data[0] * shape.data[1] * shape.data[2];
+  scales_.reset(new float[num_scales]);
+  memset(scales_.get(), 0, sizeof(float) * num_scales);
+
+  num_entries_.reset(new size_t[shape.data[1]]);
+  memset(num_entries_.get(), 0, sizeof(size_t) * shape.data[1]);
+  is_initialized_ = true;
+  return kTfLiteOk;
+}
+
+size_t CacheBuffer::GetSize() {
+  if (IsQuantized()) {
+    return NumElements(dims_) + sizeof(float) * dims_->data[0] *
+                                    dims_->data[1] * dims_->data[2];
+  }
+  return sizeof(float) * NumElements(dims_);
+}
 
 size_t CacheBuffer::GetNumEntries(int idx) const { return num_entries_[idx]; }
 
@@ -47,6 +69,12 @@ CacheBuffer::~CacheBuffer() { TfLiteIntArrayFree(dims_); }
 
 float* CacheBuffer::GetBuffer() { return buffer_.get(); }
 
+int8_t* CacheBuffer::GetQuantizedBuffer() { return quantized_buffer_.get(); }
+
+float* CacheBuffer::GetScales() { return scales_.get(); }
+
+bool CacheBuffer::IsQuantized() const { return quantized_buffer_ != nullptr; }
+
 void CacheBuffer::SetNumEntries(int idx, size_t count) {
   TFLITE_DCHECK(count <= dims_->data[2]);
   num_entries_[idx] = count;
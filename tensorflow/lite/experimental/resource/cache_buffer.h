@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_CACHE_BUFFER_H_
 #define TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_CACHE_BUFFER_H_
 
+#include <cstdint>
 #include <memory>
 #include <unordered_map>
 
@@ -38,8 +39,17 @@ class CacheBuffer : public ResourceVariable {
   CacheBuffer &operator=(const CacheBuffer &) = delete;
   // Initialize tensor of a certain shape using the provided type.
   TfLiteStatus Initialize(const TfLiteIntArray &shape);
+  // Initialize an int8 buffer of a certain shape, with one scale per entry of
+  // each layer.
+  TfLiteStatus InitializeQuantized(const TfLiteIntArray &shape);
   size_t GetNumEntries(int idx) const;
   float *GetBuffer();
+  // Only set if initialized with InitializeQuantized.
+  int8_t *GetQuantizedBuffer();
+  // The scales of the entries of the quantized buffer. Has shape:
+  // <batch, num layers, seq length>
+  float *GetScales();
+  bool IsQuantized() const;
   size_t GetSize();
   void SetNumEntries(int idx, size_t count);
 
@@ -49,6 +59,9 @@ class CacheBuffer : public ResourceVariable {
   // The float buffer for storage. Has shape:
   // <batch, num layers, seq length, num heads, head dim>
   std::unique_ptr<float[]> buffer_;
+  // The int8 buffer and its scales used instead of `buffer_` if quantized.
+  std::unique_ptr<int8_t[]> quantized_buffer_;
+  std::unique_ptr<float[]> scales_;
   TfLiteIntArray *dims_;
 };
 
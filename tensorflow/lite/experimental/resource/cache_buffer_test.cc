@@ -40,5 +40,26 @@ TEST(CacheBufferTest, Initialize) {
   TfLiteIntArrayFree(shape);
 }
 
+TEST(CacheBufferTest, InitializeQuantized) {
+  TfLiteIntArray* shape = TfLiteIntArrayCreate(4);
+  shape->data[0] = 1;
+  shape->data[1] = 3;
+  shape->data[2] = 5;
+  shape->data[3] = 7;
+
+  CacheBuffer cache_buffer;
+  cache_buffer.InitializeQuantized(*shape);
+
+  // 105 int8 elements and 15 float scales.
+  EXPECT_EQ(cache_buffer.GetSize(), 165);
+  EXPECT_TRUE(cache_buffer.IsQuantized());
+  EXPECT_EQ(cache_buffer.GetBuffer(), nullptr);
+  ASSERT_NE(cache_buffer.GetQuantizedBuffer(), nullptr);
+  ASSERT_NE(cache_buffer.GetScales(), nullptr);
+  EXPECT_EQ(cache_buffer.GetScales()[14], 0.0f);
+  EXPECT_EQ(cache_buffer.GetNumEntries(2), 0);
+  TfLiteIntArrayFree(shape);
+}
+
 }  // namespace resource
 }  // namespace tflite
@@ -0,0 +1,136 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/experimental/resource/paged_cache_buffer.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/kernels/internal/compatibility.h"
+
+namespace tflite {
+namespace resource {
+
+TfLiteStatus PagedCacheBuffer::Initialize(int num_layers, int max_num_entries,
+                                          int block_size, int entry_size) {
+  if (num_layers <= 0 || max_num_entries <= 0 || block_size <= 0 ||
+      entry_size <= 0) {
+    return kTfLiteError;
+  }
+  max_num_entries_ = max_num_entries;
+  block_size_ = block_size;
+  entry_size_ = entry_size;
+  blocks_.clear();
+  free_blocks_.clear();
+  layers_.assign(num_layers, Layer());
+  gather_buffer_.reset(
+      new float[static_cast<size_t>(max_num_entries) * entry_size]());
+  num_gathered_entries_ = 0;
+  is_initialized_ = true;
+  return kTfLiteOk;
+}
+
+int PagedCacheBuffer::AllocateBlock() {
+  const size_t block_elements = static_cast<size_t>(block_size_) * entry_size_;
+  int block;
+  if (!free_blocks_.empty()) {
+    block = free_blocks_.back();
+    free_blocks_.pop_back();
+  } else {
+    block = blocks_.size();
+    blocks_.emplace_back(new float[block_elements]);
+  }
+  memset(blocks_[block].get(), 0, sizeof(float) * block_elements);
+  return block;
+}
+
+float* PagedCacheBuffer::GetEntry(int layer, int index) {
+  TFLITE_DCHECK(index >= 0 && index < max_num_entries_);
+  Layer& l = layers_[layer];
+  const int slot = l.first_entry_offset + index;
+  const size_t block = slot / block_size_;
+  while (l.block_table.size() <= block) {
+    l.block_table.push_back(AllocateBlock());
+  }
+  return blocks_[l.block_table[block]].get() +
+         static_cast<size_t>(slot % block_size_) * entry_size_;
+}
+
+void PagedCacheBuffer::DropFirstEntries(int layer, int count) {
+  Layer& l = layers_[layer];
+  l.first_entry_offset += count;
+  const size_t num_dropped_blocks = std::min<size_t>(
+      l.first_entry_offset / block_size_, l.block_table.size());
+  free_blocks_.insert(free_blocks_.end(), l.block_table.begin(),
+                      l.block_table.begin() + num_dropped_blocks);
+  l.block_table.erase(l.block_table.begin(),
+                      l.block_table.begin() + num_dropped_blocks);
+  l.first_entry_offset -= num_dropped_blocks * block_size_;
+  if (l.block_table.empty()) {
+    // Without blocks, only the position of entry 0 in its block matters.
+    l.first_entry_offset %= block_size_;
+  }
+  l.num_entries -= std::min<size_t>(count, l.num_entries);
+}
+
+void PagedCacheBuffer::Gather(int layer) {
+  const Layer& l = layers_[layer];
+  const size_t num_entries = l.num_entries;
+  float* dst = gather_buffer_.get();
+  size_t num_copied = 0;
+  for (size_t i = 0; i < l.block_table.size() && num_copied < num_entries;
+       ++i) {
+    const int first = i == 0 ? l.first_entry_offset : 0;
+    const size_t count =
+        std::min<size_t>(block_size_ - first, num_entries - num_copied);
+    memcpy(dst + num_copied * entry_size_,
+           blocks_[l.block_table[i]].get() +
+               static_cast<size_t>(first) * entry_size_,
+           sizeof(float) * count * entry_size_);
+    num_copied += count;
+  }
+  // Zero the entries that are not backed by a block, and those left over by
+  // the previous call.
+  const size_t num_dirty = std::max(num_gathered_entries_, num_entries);
+  if (num_dirty > num_copied) {
+    memset(dst + num_copied * entry_size_, 0,
+           sizeof(float) * (num_dirty - num_copied) * entry_size_);
+  }
+  num_gathered_entries_ = num_copied;
+}
+
+size_t PagedCacheBuffer::GetNumEntries(int layer) const {
+  return layers_[layer].num_entries;
+}
+
+void PagedCacheBuffer::SetNumEntries(int layer, size_t count) {
+  TFLITE_DCHECK(count <= static_cast<size_t>(max_num_entries_));
+  layers_[layer].num_entries = count;
+}
+
+size_t PagedCacheBuffer::GetMemoryUsage() {
+  const size_t gather_buffer_size =
+      gather_buffer_ == nullptr
+          ? 0
+          : static_cast<size_t>(max_num_entries_) * entry_size_;
+  return sizeof(float) *
+         (blocks_.size() * block_size_ * entry_size_ + gather_buffer_size);
+}
+
+}  // namespace resource
+}  // namespace tflite
@@ -0,0 +1,108 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_PAGED_CACHE_BUFFER_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_PAGED_CACHE_BUFFER_H_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/experimental/resource/resource_variable.h"
+
+namespace tflite {
+namespace resource {
+
+/// WARNING: Experimental interface, subject to change.
+// A paged variant of `CacheBuffer`. Instead of reserving the maximum number of
+// entries of every layer up front, entries are stored in fixed-size blocks
+// taken from a pool shared by all the layers. Each layer keeps a block table
+// that maps its entries to blocks, so memory is only committed for the entries
+// in use and dropping the oldest entries returns their blocks to the pool
+// without moving any data.
+class PagedCacheBuffer : public ResourceVariable {
+ public:
+  PagedCacheBuffer() = default;
+  PagedCacheBuffer(const PagedCacheBuffer &) = delete;
+  PagedCacheBuffer &operator=(const PagedCacheBuffer &) = delete;
+
+  // Initializes the pool for `num_layers` layers of at most `max_num_entries`
+  // entries each. An entry holds `entry_size` floats and a block holds
+  // `block_size` entries.
+  TfLiteStatus Initialize(int num_layers, int max_num_entries, int block_size,
+                          int entry_size);
+
+  // Returns the storage of entry `index` of `layer`, taking the blocks needed
+  // to hold it from the pool. New blocks are zero-filled.
+  float *GetEntry(int layer, int index);
+
+  // Drops the `count` oldest entries of `layer`: entry `count` becomes entry
+  // 0. Blocks that no longer hold any entry are returned to the pool.
+  void DropFirstEntries(int layer, int count);
+
+  // Copies the entries in use of `layer` to the gather buffer, whose later
+  // entries are zero. Only the entries in use, and the entries a previous call
+  // wrote after them, are written, so the cost grows with the number of
+  // entries in use rather than with `max_num_entries`.
+  void Gather(int layer);
+
+  // Returns the gather buffer, which holds `max_num_entries` entries. It is
+  // shared by all the layers, so it holds the entries of the layer gathered
+  // last.
+  float *GetGatherBuffer() { return gather_buffer_.get(); }
+
+  size_t GetNumEntries(int layer) const;
+  void SetNumEntries(int layer, size_t count);
+
+  int GetBlockSize() const { return block_size_; }
+  int GetEntrySize() const { return entry_size_; }
+
+  // Returns the number of blocks held by the layers.
+  size_t GetNumUsedBlocks() const {
+    return blocks_.size() - free_blocks_.size();
+  }
+
+  size_t GetMemoryUsage() override;
+
+ private:
+  struct Layer {
+    // Maps the blocks of the layer, in entry order, to `blocks_` indices.
+    std::vector<int> block_table;
+    // The position of entry 0 in the first block of the table.
+    int first_entry_offset = 0;
+    // The number of entries currently used in the layer.
+    size_t num_entries = 0;
+  };
+
+  // Takes a zero-filled block from the pool and returns its index.
+  int AllocateBlock();
+
+  int max_num_entries_ = 0;
+  int block_size_ = 0;
+  int entry_size_ = 0;
+  std::vector<std::unique_ptr<float[]>> blocks_;
+  // Indices of the blocks of `blocks_` that no layer uses.
+  std::vector<int> free_blocks_;
+  std::vector<Layer> layers_;
+  std::unique_ptr<float[]> gather_buffer_;
+  // The number of entries at the start of `gather_buffer_` that may be
+  // non-zero.
+  size_t num_gathered_entries_ = 0;
+};
+
+}  // namespace resource
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_PAGED_CACHE_BUFFER_H_
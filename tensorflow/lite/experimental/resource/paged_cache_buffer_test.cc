@@ -0,0 +1,120 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/resource/paged_cache_buffer.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/c_api_types.h"
+
+namespace tflite {
+namespace resource {
+namespace {
+
+std::vector<float> Gathered(PagedCacheBuffer& cache_buffer, int size) {
+  const float* data = cache_buffer.GetGatherBuffer();
+  return std::vector<float>(data, data + size);
+}
+
+}  // namespace
+
+TEST(PagedCacheBufferTest, AllocatesBlocksOnDemand) {
+  PagedCacheBuffer cache_buffer;
+  ASSERT_EQ(cache_buffer.Initialize(/*num_layers=*/2, /*max_num_entries=*/10,
+                                    /*block_size=*/4, /*entry_size=*/2),
+            kTfLiteOk);
+  EXPECT_EQ(cache_buffer.GetNumUsedBlocks(), 0);
+  // Only the gather buffer is allocated up front.
+  EXPECT_EQ(cache_buffer.GetMemoryUsage(), sizeof(float) * 10 * 2);
+
+  for (int i = 0; i < 6; ++i) {
+    float* entry = cache_buffer.GetEntry(/*layer=*/1, i);
+    entry[0] = i + 1;
+    entry[1] = -(i + 1);
+  }
+  cache_buffer.SetNumEntries(1, 6);
+  EXPECT_EQ(cache_buffer.GetNumUsedBlocks(), 2);
+  EXPECT_EQ(cache_buffer.GetNumEntries(0), 0);
+  EXPECT_EQ(cache_buffer.GetNumEntries(1), 6);
+
+  cache_buffer.Gather(/*layer=*/1);
+  EXPECT_EQ(Gathered(cache_buffer, 20),
+            std::vector<float>({1, -1, 2, -2, 3, -3, 4, -4, 5, -5, 6, -6, 0,
+                                0, 0, 0, 0, 0, 0, 0}));
+  // The entries gathered from the previous layer are cleared.
+  cache_buffer.Gather(/*layer=*/0);
+  EXPECT_EQ(Gathered(cache_buffer, 20), std::vector<float>(20, 0));
+}
+
+TEST(PagedCacheBufferTest, DropFirstEntriesReleasesBlocks) {
+  PagedCacheBuffer cache_buffer;
+  ASSERT_EQ(cache_buffer.Initialize(/*num_layers=*/2, /*max_num_entries=*/10,
+                                    /*block_size=*/4, /*entry_size=*/1),
+            kTfLiteOk);
+  for (int i = 0; i < 10; ++i) {
+    *cache_buffer.GetEntry(/*layer=*/0, i) = i + 1;
+  }
+  cache_buffer.SetNumEntries(0, 10);
+  EXPECT_EQ(cache_buffer.GetNumUsedBlocks(), 3);
+
+  cache_buffer.DropFirstEntries(/*layer=*/0, 5);
+  EXPECT_EQ(cache_buffer.GetNumUsedBlocks(), 2);
+  EXPECT_EQ(cache_buffer.GetNumEntries(0), 5);
+  *cache_buffer.GetEntry(/*layer=*/0, 5) = 11;
+  cache_buffer.SetNumEntries(0, 6);
+
+  cache_buffer.Gather(/*layer=*/0);
+  EXPECT_EQ(Gathered(cache_buffer, 10),
+            std::vector<float>({6, 7, 8, 9, 10, 11, 0, 0, 0, 0}));
+
+  // The released block is reused by the other layer.
+  const size_t memory_usage = cache_buffer.GetMemoryUsage();
+  *cache_buffer.GetEntry(/*layer=*/1, 0) = 1;
+  EXPECT_EQ(cache_buffer.GetNumUsedBlocks(), 3);
+  EXPECT_EQ(cache_buffer.GetMemoryUsage(), memory_usage);
+  cache_buffer.SetNumEntries(1, 1);
+  cache_buffer.Gather(/*layer=*/1);
+  EXPECT_EQ(Gathered(cache_buffer, 10),
+            std::vector<float>({1, 0, 0, 0, 0, 0, 0, 0, 0, 0}));
+}
+
+TEST(PagedCacheBufferTest, GathersOnlyEntriesInUse) {
+  PagedCacheBuffer cache_buffer;
+  ASSERT_EQ(cache_buffer.Initialize(/*num_layers=*/1, /*max_num_entries=*/10,
+                                    /*block_size=*/4, /*entry_size=*/1),
+            kTfLiteOk);
+  for (int i = 0; i < 6; ++i) {
+    *cache_buffer.GetEntry(/*layer=*/0, i) = i + 1;
+  }
+  cache_buffer.SetNumEntries(0, 3);
+  cache_buffer.Gather(/*layer=*/0);
+  EXPECT_EQ(Gathered(cache_buffer, 10),
+            std::vector<float>({1, 2, 3, 0, 0, 0, 0, 0, 0, 0}));
+
+  // Entries outside of the gathered range are left untouched.
+  cache_buffer.GetGatherBuffer()[9] = -1;
+  cache_buffer.SetNumEntries(0, 6);
+  cache_buffer.Gather(/*layer=*/0);
+  EXPECT_EQ(Gathered(cache_buffer, 10),
+            std::vector<float>({1, 2, 3, 4, 5, 6, 0, 0, 0, -1}));
+
+  cache_buffer.SetNumEntries(0, 2);
+  cache_buffer.Gather(/*layer=*/0);
+  EXPECT_EQ(Gathered(cache_buffer, 10),
+            std::vector<float>({1, 2, 0, 0, 0, 0, 0, 0, 0, -1}));
+}
+
+}  // namespace resource
+}  // namespace tflite
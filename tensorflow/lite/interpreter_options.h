@@ -103,12 +103,38 @@ class InterpreterOptions {
     return experimental_cache_constant_cast_op_;
   }
 
+  // Sets the number of threads, including the calling thread, that `Invoke`
+  // uses to run the nodes of a subgraph that do not depend on each other
+  // concurrently, e.g. the branches of a multi-head model. Values below 2 keep
+  // the sequential execution.
+  //
+  // Intermediate tensors don't share memory with each other when this is
+  // enabled, so the arena is as large as with `SetPreserveAllTensors`.
+  // Subgraphs with dynamic tensors are still run sequentially, and delegated,
+  // custom, control flow and resource or variant ops are never run
+  // concurrently with other nodes. Each thread uses its own CPU backend
+  // context, so consider lowering the number of threads of the interpreter.
+  // This must be called before `AllocateTensors`.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  void SetNumParallelInvokeThreads(int value) {
+    experimental_num_parallel_invoke_threads_ = value;
+  }
+
+  // Returns the number of threads set by `SetNumParallelInvokeThreads`.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  int GetNumParallelInvokeThreads() const {
+    return experimental_num_parallel_invoke_threads_;
+  }
+
  private:
   bool experimental_preserve_all_tensors_ = false;
   bool experimental_ensure_dynamic_tensors_are_released_ = false;
   int experimental_optimize_memory_for_large_tensors_ = 0;
   bool experimental_disable_delegate_clustering_ = false;
   bool experimental_cache_constant_cast_op_ = false;
+  int experimental_num_parallel_invoke_threads_ = 0;
 };
 
 }  // namespace tflite
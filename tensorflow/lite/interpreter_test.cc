@@ -20,6 +20,8 @@ limitations under the License.
 #include <stdlib.h>
 #include <string.h>
 
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
 #include <map>
 #include <memory>
 #include <string>
@@ -754,6 +756,123 @@ TEST(BasicInterpreter, ReleaseNonPersistentMemory) {
   ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
 }
 
+TEST(BasicInterpreter, ExecutionContextsRunConcurrently) {
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(3), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({2}), kTfLiteOk);
+  TfLiteQuantizationParams quant;
+  const float weights[] = {10.0f, 20.0f, 30.0f};
+  ASSERT_EQ(interpreter.SetTensorParametersReadWrite(0, kTfLiteFloat32, "in",
+                                                     {3}, quant),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.SetTensorParametersReadOnly(
+                1, kTfLiteFloat32, "weights", {3}, quant,
+                reinterpret_cast<const char*>(weights), sizeof(weights)),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.SetTensorParametersReadWrite(2, kTfLiteFloat32, "out",
+                                                     {3}, quant),
+            kTfLiteOk);
+  auto* builtin_data =
+      reinterpret_cast<TfLiteAddParams*>(malloc(sizeof(TfLiteAddParams)));
+  builtin_data->activation = kTfLiteActNone;
+  builtin_data->pot_scale_int16 = false;
+  ASSERT_EQ(interpreter.AddNodeWithParameters({0, 1}, {2}, nullptr, 0,
+                                              builtin_data,
+                                              ops::builtin::Register_ADD()),
+            kTfLiteOk);
+
+  constexpr int kNumContexts = 4;
+  std::vector<std::unique_ptr<Interpreter>> contexts(kNumContexts);
+  for (auto& context : contexts) {
+    ASSERT_EQ(interpreter.CreateExecutionContext(&context), kTfLiteOk);
+    ASSERT_EQ(context->AllocateTensors(), kTfLiteOk);
+    // The weights are shared, the activations are not.
+    EXPECT_EQ(context->tensor(1)->data.raw_const,
+              reinterpret_cast<const char*>(weights));
+    EXPECT_NE(context->tensor(0)->data.raw, nullptr);
+  }
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_NE(contexts[0]->tensor(0)->data.raw, interpreter.tensor(0)->data.raw);
+
+  std::vector<std::thread> threads;
+  std::atomic<int> num_failures = 0;
+  for (int i = 0; i < kNumContexts; ++i) {
+    threads.emplace_back([&, i] {
+      Interpreter* context = contexts[i].get();
+      for (int step = 0; step < 100; ++step) {
+        float* input = context->typed_input_tensor<float>(0);
+        for (int j = 0; j < 3; ++j) input[j] = i * 100 + step + j;
+        if (context->Invoke() != kTfLiteOk) {
+          ++num_failures;
+          return;
+        }
+        const float* output = context->typed_output_tensor<float>(0);
+        for (int j = 0; j < 3; ++j) {
+          if (output[j] != i * 100 + step + j + weights[j]) ++num_failures;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(num_failures, 0);
+
+  // Execution contexts can only be created before allocation.
+  std::unique_ptr<Interpreter> context;
+  EXPECT_EQ(interpreter.CreateExecutionContext(&context), kTfLiteError);
+}
+
+TEST(BasicInterpreter, ShapeBuckets) {
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(2), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({1}), kTfLiteOk);
+  TfLiteQuantizationParams quant;
+  ASSERT_EQ(interpreter.SetTensorParametersReadWrite(0, kTfLiteFloat32, "in",
+                                                     {1, 2}, quant),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.SetTensorParametersReadWrite(1, kTfLiteFloat32, "out",
+                                                     {1, 2}, quant),
+            kTfLiteOk);
+  auto* builtin_data =
+      reinterpret_cast<TfLiteAddParams*>(malloc(sizeof(TfLiteAddParams)));
+  builtin_data->activation = kTfLiteActNone;
+  builtin_data->pot_scale_int16 = false;
+  ASSERT_EQ(interpreter.AddNodeWithParameters({0, 0}, {1}, nullptr, 0,
+                                              builtin_data,
+                                              ops::builtin::Register_ADD()),
+            kTfLiteOk);
+
+  // The number of shapes must match the number of inputs.
+  EXPECT_EQ(interpreter.PrepareShapeBuckets({{{1, 4}, {1, 4}}}), kTfLiteError);
+  ASSERT_EQ(interpreter.PrepareShapeBuckets({{{1, 16}}, {{1, 4}}, {{1, 8}}}),
+            kTfLiteOk);
+  EXPECT_EQ(interpreter.FindShapeBucket({{1, 3}}), 1);
+  EXPECT_EQ(interpreter.FindShapeBucket({{1, 5}}), 2);
+  EXPECT_EQ(interpreter.FindShapeBucket({{1, 16}}), 0);
+  EXPECT_EQ(interpreter.FindShapeBucket({{1, 17}}), -1);
+  EXPECT_EQ(interpreter.FindShapeBucket({{2, 4}}), -1);
+  EXPECT_EQ(interpreter.FindShapeBucket({{4}}), -1);
+  EXPECT_EQ(interpreter.shape_bucket(3), nullptr);
+
+  // Each bucket is ready to run on its shapes.
+  for (int i = 0; i < 3; ++i) {
+    Interpreter* bucket = interpreter.shape_bucket(i);
+    ASSERT_NE(bucket, nullptr);
+    const int size = bucket->input_tensor(0)->dims->data[1];
+    float* input = bucket->typed_input_tensor<float>(0);
+    for (int j = 0; j < size; ++j) input[j] = j;
+    ASSERT_EQ(bucket->Invoke(), kTfLiteOk);
+    ASSERT_EQ(bucket->output_tensor(0)->dims->data[1], size);
+    const float* output = bucket->typed_output_tensor<float>(0);
+    for (int j = 0; j < size; ++j) EXPECT_EQ(output[j], 2 * j);
+  }
+  EXPECT_EQ(interpreter.shape_bucket(0)->input_tensor(0)->dims->data[1], 16);
+  EXPECT_EQ(interpreter.shape_bucket(1)->input_tensor(0)->dims->data[1], 4);
+  // The interpreter itself is not resized.
+  EXPECT_EQ(interpreter.input_tensor(0)->dims->data[1], 2);
+}
+
 // Forcefully divides tensor allocation in three steps: one before invocation
 // and two more at invocation time. This happens because we use string tensors
 // and their sizes can't be determined until invocation time.
@@ -1127,6 +1246,71 @@ TEST(BasicInterpreter, ReleaseDynamicTensors) {
   ASSERT_EQ(interpreter.tensor(3)->bytes, sizeof(float) * 6 * 6);
 }
 
+// Number of nodes running `GetRendezvousOpRegistration()`.
+std::atomic<int> num_rendezvous_ops_running{0};
+
+// Op that copies its input to its output once two of these ops are running,
+// and fails if that doesn't happen within 10 seconds.
+TfLiteRegistration GetRendezvousOpRegistration() {
+  TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+  reg.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    ++num_rendezvous_ops_running;
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (num_rendezvous_ops_running < 2) {
+      if (std::chrono::steady_clock::now() > deadline) return kTfLiteError;
+      std::this_thread::yield();
+    }
+
+    const TfLiteTensor* input;
+    TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, 0, &input));
+    TfLiteTensor* output;
+    TF_LITE_ENSURE_OK(context, GetOutputSafe(context, node, 0, &output));
+    memcpy(output->data.raw, input->data.raw, input->bytes);
+    return kTfLiteOk;
+  };
+  return reg;
+}
+
+TEST(BasicInterpreter, ParallelInvokeRunsIndependentNodesConcurrently) {
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(3), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({1, 2}), kTfLiteOk);
+
+  TfLiteQuantizationParams quantized;
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "",
+                                                       {3}, quantized),
+              kTfLiteOk);
+  }
+
+  // Both nodes only read tensor 0, so they can run concurrently.
+  TfLiteRegistration reg = GetRendezvousOpRegistration();
+  ASSERT_EQ(
+      interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+  ASSERT_EQ(
+      interpreter.AddNodeWithParameters({0}, {2}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+
+  InterpreterOptions options;
+  options.SetNumParallelInvokeThreads(2);
+  interpreter.ApplyOptions(&options);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  float* input = interpreter.typed_tensor<float>(0);
+  for (int i = 0; i < 3; ++i) input[i] = i;
+  num_rendezvous_ops_running = 0;
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+
+  for (int i = 1; i < 3; ++i) {
+    const float* output = interpreter.typed_tensor<float>(i);
+    EXPECT_THAT(std::vector<float>(output, output + 3),
+                ElementsAre(0.f, 1.f, 2.f));
+  }
+}
+
 TEST(InterpreterTensorsCapacityTest, TestWithinHeadroom) {
   Interpreter interpreter;
   ASSERT_EQ(interpreter.AddTensors(Interpreter::kTensorsReservedCapacity),
@@ -65,6 +65,17 @@ bool SupportedSparsityFormat(const TfLiteSparsity& sparsity) {
 static const int kDimMetadataSizeRandomSparse = 2;
 static const int kDimMetadataSizeBlockSparse = 3;
 
+// Returns whether the weight is block sparse with blocks of `block_size`
+// values along `block_dim`, i.e. 1xN blocks for dimension 1 (input channels)
+// and Nx1 blocks for dimension 0 (output channels).
+bool IsBlockSparse(const TfLiteSparsity& sparsity, int block_dim,
+                   int block_size) {
+  return sparsity.dim_metadata_size == kDimMetadataSizeBlockSparse &&
+         sparsity.block_map != nullptr && sparsity.block_map->size == 1 &&
+         sparsity.block_map->data[0] == block_dim &&
+         sparsity.dim_metadata[2].dense_size == block_size;
+}
+
 TfLiteStatus CreateLedgerTensor(const TfLiteSparsity* sparsity,
                                 TfLiteContext* context, TfLiteTensor* ledger) {
   TF_LITE_ENSURE(context, sparsity != nullptr);
@@ -382,6 +393,10 @@ TfLiteStatus PrepareImpl(TfLiteContext* context, TfLiteNode* node,
   // Check proper datatype match among all Input Tensors
   TF_LITE_ENSURE_STATUS(
       CheckTypes(context, input, filter, bias, output, params));
+  // Block-wise quantized filters are only supported by the XNNPACK delegate.
+  TF_LITE_ENSURE_MSG(
+      context, filter->quantization.type != kTfLiteBlockwiseQuantization,
+      "Block-wise quantized filters are not supported.");
 
   // Check all the parameters of tensor match within themselves and match the
   // input configuration.
@@ -1368,8 +1383,7 @@ TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
           }
           // Int4 support for sparse filter tensor is currently not supported
           TF_LITE_ENSURE(context, filter->type != kTfLiteInt4);
-          if (sparsity.dim_metadata_size == kDimMetadataSizeBlockSparse &&
-              sparsity.dim_metadata[2].dense_size == 16) {
+          if (IsBlockSparse(sparsity, /*block_dim=*/1, /*block_size=*/16)) {
             // Block sparse with block size of 1x16.
             optimized_ops::FullyConnectedSparseWeight1x16(
                 sparsity, op_params, input_shape, GetTensorData<int8_t>(input),
@@ -1560,8 +1574,7 @@ TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
             filter_shape, GetTensorData<float>(filter),  // Disable formatting
             bias_shape, GetTensorData<float>(bias),      // Disable formatting
             output_shape, GetTensorData<float>(output));
-      } else if (sparsity.dim_metadata_size == kDimMetadataSizeBlockSparse &&
-                 sparsity.dim_metadata[2].dense_size == 4) {
+      } else if (IsBlockSparse(sparsity, /*block_dim=*/1, /*block_size=*/4)) {
         // Block sparse with block size of 1x4.
         optimized_ops::FullyConnectedSparseWeight1x4(
             sparsity, op_params,                         // Disable formatting
@@ -1570,6 +1583,15 @@ TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
             bias_shape, GetTensorData<float>(bias),      // Disable formatting
             output_shape, GetTensorData<float>(output),
             CpuBackendContext::GetFromContext(context));
+      } else if (IsBlockSparse(sparsity, /*block_dim=*/0, /*block_size=*/4)) {
+        // Block sparse with block size of 4x1.
+        optimized_ops::FullyConnectedSparseWeight4x1(
+            sparsity, op_params,                         // Disable formatting
+            input_shape, GetTensorData<float>(input),    // Disable formatting
+            filter_shape, GetTensorData<float>(filter),  // Disable formatting
+            bias_shape, GetTensorData<float>(bias),      // Disable formatting
+            output_shape, GetTensorData<float>(output),
+            CpuBackendContext::GetFromContext(context));
       } else {
         TF_LITE_KERNEL_LOG(context,
                            "Unsupported sparse fully-connected weight format.");
@@ -2016,6 +2016,47 @@ TEST_P(SparseFullyConnectedOpTest, Simple1x4TestMultiThreadedMoreBatches) {
   }
 }
 
+TEST_P(SparseFullyConnectedOpTest, Simple4x1Test) {
+  std::initializer_list<float> weight_data = {
+      1, 0,  2,  // u = 0
+      2, 0,  3,  // u = 1
+      3, 0,  4,  // u = 2
+      4, 0,  5,  // u = 3
+      0, 1,  0,  // u = 4
+      0, -1, 0,  // u = 5
+      0, 2,  0,  // u = 6
+      0, -2, 0,  // u = 7
+  };
+  TensorData weight = {};
+  weight.type = TensorType_FLOAT32;
+  weight.shape = {8, 3};
+  weight.traversal_order = {0, 1, 2};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  weight.block_map = {0};
+  weight.block_size = {4};
+  for (int num_threads = 1; num_threads <= 2; num_threads++) {
+    SparseFullyConnectedOpModel<float> m(
+        GetRegistration(),
+        /*units=*/8, /*batches=*/2,
+        /*input=*/{TensorType_FLOAT32, {2, 3}}, weight, weight_data,
+        /*output=*/{TensorType_FLOAT32},
+        /*bias_tensor_optional=*/false, /*num_threads=*/num_threads);
+    m.SetBias({1, 1, 1, 1, 1, 1, 1, 1});
+
+    m.SetInput({
+        1, 2, 3,   // b = 0
+        -1, 4, 2,  // b = 1
+    });
+
+    ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+    EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 8));
+    EXPECT_THAT(m.GetOutput(), ElementsAre(8, 12, 16, 20, 3, 0, 5, 0,  // b = 0
+                                           4, 5, 6, 7, 5, 0, 9, 0   // b = 1
+                                           ));
+  }
+}
+
 TEST_P(SparseHybridFullyConnectedOpTest, SparseHybrid1x16Test) {
   std::initializer_list<float> weight_data = {
       /* 1st row */
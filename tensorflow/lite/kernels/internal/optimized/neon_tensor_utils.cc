@@ -1961,6 +1961,32 @@ void NeonSparseMatrixBatchVectorMultiplyAccumulate1x4(
   }
 }
 
+void NeonSparseMatrixBatchVectorMultiplyAccumulate4x1(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result) {
+  constexpr int kBlockSize = kFloatValuesPerNeonVector;
+  TFLITE_DCHECK_EQ(m_rows % kBlockSize, 0);
+
+  for (int batch = 0; batch < n_batch; batch++) {
+    const float* matrix_ptr = matrix;
+    const float* vector_in_batch = vector + batch * m_cols;
+    float* result_in_batch = result + batch * m_rows;
+    for (int block_row = 0; block_row < m_rows / kBlockSize; block_row++) {
+      float32x4_t acc_32x4 = vmovq_n_f32(0.0);
+      for (int i = segments[block_row]; i < segments[block_row + 1]; i++) {
+        // Multiply the 4 rows of the block by their shared vector value.
+        float32x4_t matrix_f32x4 = vld1q_f32(matrix_ptr);
+        acc_32x4 =
+            vmlaq_n_f32(acc_32x4, matrix_f32x4, vector_in_batch[indices[i]]);
+        matrix_ptr += kBlockSize;
+      }
+      float* result_ptr = result_in_batch + block_row * kBlockSize;
+      vst1q_f32(result_ptr, vaddq_f32(vld1q_f32(result_ptr), acc_32x4));
+    }
+  }
+}
+
 void NeonSparseMatrixBatchVectorMultiplyAccumulate1x16(
     const int8_t* __restrict__ matrix, const int32_t* __restrict__ segments,
     const int32_t* __restrict__ indices, int m_rows, int m_cols,
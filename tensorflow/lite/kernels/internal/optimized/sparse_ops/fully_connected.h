@@ -198,6 +198,90 @@ struct FullyConnectedSparseWeight1x4Task : cpu_backend_threadpool::Task {
   const CpuBackendContext& cpu_backend_context;
 };
 
+inline void FullyConnectedSparseWeight4x1Impl(
+    const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
+    const RuntimeShape& input_shape, const float* input_data,
+    const RuntimeShape& weights_shape, const float* weights_data,
+    const RuntimeShape& bias_shape, const float* bias_data,
+    const RuntimeShape& output_shape, float* output_data, int thread_start,
+    int thread_end, const CpuBackendContext& cpu_backend_context) {
+  ruy::profiler::ScopeLabel label("FullyConnected");
+  ruy::profiler::ScopeLabel inner_label("4x1 Block Sparse");
+  const float output_activation_min = params.float_activation_min;
+  const float output_activation_max = params.float_activation_max;
+
+  const int input_dims_count = input_shape.DimensionsCount();
+  const int output_dims_count = output_shape.DimensionsCount();
+  const int weights_dims_count = weights_shape.DimensionsCount();
+  const int batches = thread_end - thread_start;
+  const int input_depth = MatchingDim(weights_shape, weights_dims_count - 1,
+                                      input_shape, input_dims_count - 1);
+  const int output_depth = MatchingDim(weights_shape, weights_dims_count - 2,
+                                       output_shape, output_dims_count - 1);
+  const int* w1_segments = sparsity.dim_metadata[1].array_segments->data;
+  const int* w1_indices = sparsity.dim_metadata[1].array_indices->data;
+
+  tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate4x1(
+      weights_data, w1_segments, w1_indices, weights_shape.Dims(0),
+      weights_shape.Dims(1), input_data + thread_start * input_depth, batches,
+      output_data + thread_start * output_depth);
+
+  ruy::profiler::ScopeLabel activation_label("activation function");
+  for (int b = thread_start; b < thread_end; ++b) {
+    for (int i = 0; i < output_depth; ++i) {
+      float total = output_data[b * output_depth + i];
+      const float bias_value = bias_data ? bias_data[i] : 0;
+      output_data[b * output_depth + i] = ActivationFunctionWithMinMax(
+          total + bias_value, output_activation_min, output_activation_max);
+    }
+  }
+}
+
+struct FullyConnectedSparseWeight4x1Task : cpu_backend_threadpool::Task {
+  FullyConnectedSparseWeight4x1Task(
+      const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
+      const RuntimeShape& input_shape, const float* input_data,
+      const RuntimeShape& weights_shape, const float* weights_data,
+      const RuntimeShape& bias_shape, const float* bias_data,
+      const RuntimeShape& output_shape, float* output_data, int thread_start,
+      int thread_end, const CpuBackendContext& cpu_backend_context_x)
+      : sparsity(sparsity),
+        params(params),
+        input_shape(input_shape),
+        input_data(input_data),
+        weights_shape(weights_shape),
+        weights_data(weights_data),
+        bias_shape(bias_shape),
+        bias_data(bias_data),
+        output_shape(output_shape),
+        output_data(output_data),
+        thread_start(thread_start),
+        thread_end(thread_end),
+        cpu_backend_context(cpu_backend_context_x) {}
+
+  void Run() override {
+    FullyConnectedSparseWeight4x1Impl(
+        sparsity, params, input_shape, input_data, weights_shape, weights_data,
+        bias_shape, bias_data, output_shape, output_data, thread_start,
+        thread_end, cpu_backend_context);
+  }
+
+ private:
+  const TfLiteSparsity& sparsity;
+  const FullyConnectedParams& params;
+  const RuntimeShape& input_shape;
+  const float* input_data;
+  const RuntimeShape& weights_shape;
+  const float* weights_data;
+  const RuntimeShape& bias_shape;
+  const float* bias_data;
+  const RuntimeShape& output_shape;
+  float* output_data;
+  int thread_start;
+  int thread_end;
+  const CpuBackendContext& cpu_backend_context;
+};
+
 inline void FullyConnectedSparseWeight1x16(
     const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
     const RuntimeShape& input_shape, const int8_t* input_data,
@@ -263,6 +347,46 @@ inline void FullyConnectedSparseWeight1x4(
                                   cpu_backend_context);
 }
 
+// Same as FullyConnectedSparseWeight1x4, for a sparse weight with block
+// pattern 4x1. The 4 output channels of a block share a single input value,
+// which suits weights pruned along the output dimension.
+inline void FullyConnectedSparseWeight4x1(
+    const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
+    const RuntimeShape& input_shape, const float* input_data,
+    const RuntimeShape& weights_shape, const float* weights_data,
+    const RuntimeShape& bias_shape, const float* bias_data,
+    const RuntimeShape& output_shape, float* output_data,
+    CpuBackendContext* cpu_backend_context) {
+  const int output_elements = output_shape.FlatSize();
+  memset(output_data, 0, output_elements * sizeof(float));
+
+  const int max_threads = cpu_backend_context->max_num_threads();
+  const int batches =
+      FlatSizeSkipDim(output_shape, output_shape.DimensionsCount() - 1);
+  const int thread_count = std::max(1, std::min(batches, max_threads));
+  if (thread_count == 1) {
+    return FullyConnectedSparseWeight4x1Impl(
+        sparsity, params, input_shape, input_data, weights_shape, weights_data,
+        bias_shape, bias_data, output_shape, output_data, 0, batches,
+        *cpu_backend_context);
+  }
+  std::vector<FullyConnectedSparseWeight4x1Task> tasks;
+  tasks.reserve(thread_count);
+  int thread_start = 0;
+  for (int i = 0; i < thread_count; ++i) {
+    int thread_end = thread_start + batches / thread_count;
+    if (i < batches % thread_count) thread_end++;
+
+    tasks.emplace_back(sparsity, params, input_shape, input_data, weights_shape,
+                       weights_data, bias_shape, bias_data, output_shape,
+                       output_data, thread_start, thread_end,
+                       *cpu_backend_context);
+    thread_start = thread_end;
+  }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
+}
+
 }  // namespace optimized_ops
 }  // namespace tflite
 #endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_OPS_FULLY_CONNECTED_H_
@@ -227,6 +227,31 @@ void PortableSparseMatrixBatchVectorMultiplyAccumulate1x4(
   }
 }
 
+void PortableSparseMatrixBatchVectorMultiplyAccumulate4x1(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result) {
+  const int kBlockSize = 4;
+  TFLITE_DCHECK_EQ(m_rows % kBlockSize, 0);
+  for (int batch = 0; batch < n_batch; batch++) {
+    const float* matrix_ptr = matrix;
+    const float* vector_in_batch = vector + batch * m_cols;
+    float* result_in_batch = result + batch * m_rows;
+    for (int block_row = 0; block_row < m_rows / kBlockSize; block_row++) {
+      float dot_prod[kBlockSize] = {0.0f};
+      for (int i = segments[block_row]; i < segments[block_row + 1]; i++) {
+        const float vector_value = vector_in_batch[indices[i]];
+        for (int r = 0; r < kBlockSize; r++) {
+          dot_prod[r] += *matrix_ptr++ * vector_value;
+        }
+      }
+      for (int r = 0; r < kBlockSize; r++) {
+        result_in_batch[block_row * kBlockSize + r] += dot_prod[r];
+      }
+    }
+  }
+}
+
 void PortableSparseMatrixBatchVectorMultiplyAccumulate1x16(
     const int8_t* __restrict__ matrix, const int32_t* __restrict__ segments,
     const int32_t* __restrict__ indices, int m_rows, int m_cols,
@@ -1558,6 +1558,49 @@ TEST(uKernels, SparseMatrixBatchVectorMultiplyAccumulateTest) {
 }
 
 #ifdef __ANDROID__
+TEST(uKernels, SparseMatrixBatchVectorMultiplyAccumulate4x1Test) {
+  const int kRow = 8;
+  const int kCol = 3;
+  const int kBatch = 2;
+  /* clang-format off */
+  float matrix[kRow * kCol] = {
+      1.0, 0.0, 5.0,
+      2.0, 0.0, 6.0,
+      3.0, 0.0, 7.0,
+      4.0, 0.0, 8.0,
+      0.0, -1.0, 0.0,
+      0.0, -2.0, 0.0,
+      0.0, -3.0, 0.0,
+      0.0, -4.0, 0.0};
+
+  // 4x1 block sparse format of the above matrix.
+  float matrix_values[] = {
+      1.0, 2.0, 3.0, 4.0,     // Rows 0 to 3, column 0.
+      5.0, 6.0, 7.0, 8.0,     // Rows 0 to 3, column 2.
+      -1.0, -2.0, -3.0, -4.0  // Rows 4 to 7, column 1.
+  };
+  const int32_t segments[] = {0, 2, 3};
+  const int32_t indices[] = {0, 2, 1};
+
+  float vector[kBatch * kCol] = {
+      1.0, 2.0, 3.0,   // 1st batch
+      -1.0, 0.5, 2.0,  // 2nd batch
+  };
+  /* clang-format on */
+
+  std::vector<float> dense_output(kRow * kBatch, 1.0);
+  MatrixBatchVectorMultiplyAccumulate(matrix, kRow, kCol, vector, kBatch,
+                                      dense_output.data());
+
+  std::vector<float> sparse_output(kRow * kBatch, 1.0);
+  SparseMatrixBatchVectorMultiplyAccumulate4x1(matrix_values, segments,
+                                               indices, kRow, kCol, vector,
+                                               kBatch, sparse_output.data());
+
+  EXPECT_THAT(sparse_output,
+              ElementsAreArray(ArrayFloatNear(dense_output, 1e-6)));
+}
+
 TEST(uKernels,
      SparseMatrixBatchVectorMultiplyAccumulateSymmetricQuantizedTest) {
   const int kRow = 4;
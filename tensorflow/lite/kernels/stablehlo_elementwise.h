@@ -88,19 +88,14 @@ TfLiteStatus EvalWithType(TfLiteContext* context, TfLiteNode* node) {
                     GetOutputSafe(context, node, kOutputTensor, &output));
   DataType* output_data = GetTensorData<DataType>(output);
 
-  int input_rank = input_tensor1->dims->size;
-  std::vector<int64_t> index(input_rank, 0);
-
-  do {
-    DataType input_value1 =
-        input_data1[TensorIndexToFlat(index.data(), input_rank, input_shape)];
-    DataType input_value2 =
-        input_data2[TensorIndexToFlat(index.data(), input_rank, input_shape)];
-
-    output_data[TensorIndexToFlat(index.data(), input_rank, input_shape)] =
-        ApplyComputation<DataType, computation_type>(input_value1,
-                                                     input_value2);
-  } while (NextIndex(input_rank, input_tensor1->dims->data, index.data()));
+  // Prepare checks that both inputs have the shape of the output, so the
+  // elements line up and are combined in a flat loop which the compiler can
+  // vectorize.
+  const int64_t num_elements = input_shape.FlatSize();
+  for (int64_t i = 0; i < num_elements; ++i) {
+    output_data[i] = ApplyComputation<DataType, computation_type>(
+        input_data1[i], input_data2[i]);
+  }
 
   return TfLiteStatus::kTfLiteOk;
 }
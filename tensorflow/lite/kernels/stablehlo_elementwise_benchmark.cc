@@ -0,0 +1,96 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Compares the stablehlo element-wise kernels with the equivalent TFLite
+// builtin kernels. Run with --benchmark_filter=all.
+
+#include <cstdint>
+#include <vector>
+
+#include "benchmark/benchmark.h"  // from @com_google_benchmark
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/kernels/test_util.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace {
+
+class BinaryOpModel : public SingleOpModel {
+ public:
+  BinaryOpModel(BuiltinOperator type, BuiltinOptions options_type,
+                int num_elements) {
+    const TensorData tensor = {TensorType_FLOAT32, {num_elements}};
+    input1_ = AddInput(tensor);
+    input2_ = AddInput(tensor);
+    output_ = AddOutput(tensor);
+    flatbuffers::Offset<void> options = 0;
+    switch (options_type) {
+      case BuiltinOptions_AddOptions:
+        options = CreateAddOptions(builder_).Union();
+        break;
+      case BuiltinOptions_MulOptions:
+        options = CreateMulOptions(builder_).Union();
+        break;
+      case BuiltinOptions_MaximumMinimumOptions:
+        options = CreateMaximumMinimumOptions(builder_).Union();
+        break;
+      default:
+        break;
+    }
+    SetBuiltinOp(type, options_type, options);
+    SetBypassDefaultDelegates();
+    BuildInterpreter({GetShape(input1_), GetShape(input2_)});
+    PopulateTensor<float>(input1_, std::vector<float>(num_elements, 1.5f));
+    PopulateTensor<float>(input2_, std::vector<float>(num_elements, -0.5f));
+  }
+};
+
+void BM_BinaryOp(benchmark::State& state, BuiltinOperator type,
+                 BuiltinOptions options_type) {
+  const int num_elements = state.range(0);
+  BinaryOpModel model(type, options_type, num_elements);
+  for (auto _ : state) {
+    if (model.Invoke() != kTfLiteOk) {
+      state.SkipWithError("Invoke failed");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * num_elements);
+}
+
+BENCHMARK_CAPTURE(BM_BinaryOp, StablehloAdd, BuiltinOperator_STABLEHLO_ADD,
+                  BuiltinOptions_NONE)
+    ->Range(1 << 10, 1 << 20);
+BENCHMARK_CAPTURE(BM_BinaryOp, Add, BuiltinOperator_ADD,
+                  BuiltinOptions_AddOptions)
+    ->Range(1 << 10, 1 << 20);
+BENCHMARK_CAPTURE(BM_BinaryOp, StablehloMultiply,
+                  BuiltinOperator_STABLEHLO_MULTIPLY, BuiltinOptions_NONE)
+    ->Range(1 << 10, 1 << 20);
+BENCHMARK_CAPTURE(BM_BinaryOp, Mul, BuiltinOperator_MUL,
+                  BuiltinOptions_MulOptions)
+    ->Range(1 << 10, 1 << 20);
+BENCHMARK_CAPTURE(BM_BinaryOp, StablehloMaximum,
+                  BuiltinOperator_STABLEHLO_MAXIMUM, BuiltinOptions_NONE)
+    ->Range(1 << 10, 1 << 20);
+BENCHMARK_CAPTURE(BM_BinaryOp, Maximum, BuiltinOperator_MAXIMUM,
+                  BuiltinOptions_MaximumMinimumOptions)
+    ->Range(1 << 10, 1 << 20);
+
+}  // namespace
+}  // namespace tflite
+
+BENCHMARK_MAIN();
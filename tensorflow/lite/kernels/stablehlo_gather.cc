@@ -177,6 +177,30 @@ TfLiteStatus EvalWithTypes(TfLiteContext* context, TfLiteNode* node) {
 
   Index<IndexType> batch_index(num_batch_dims);
   Index<IndexType> offset_index(data->num_offset_dims);
+  if (NumElements(output) == 0) {
+    return TfLiteStatus::kTfLiteOk;
+  }
+
+  const DataType* operand_data = GetTensorData<DataType>(operand);
+  DataType* result_data = GetTensorData<DataType>(output);
+
+  // When the innermost result dimension is an offset dimension which slices
+  // the innermost operand dimension, the elements of a result row are
+  // contiguous in the operand too, so the rows are copied whole.
+  const bool copy_rows =
+      result_rank > 0 &&
+      ArrayContains(data->offset_dims, data->num_offset_dims,
+                    result_rank - 1) &&
+      !ArrayContains(data->collapsed_slice_dims,
+                     data->num_collapsed_slice_dims, operand_rank - 1);
+  const int64_t row_size =
+      copy_rows ? result_runtime_shape.Dims(result_rank - 1) : 1;
+  std::vector<int> iteration_dims(
+      result_runtime_shape.DimsData(),
+      result_runtime_shape.DimsData() + result_rank);
+  if (copy_rows) {
+    iteration_dims[result_rank - 1] = 1;
+  }
   do {
     TF_LITE_ENSURE_OK(
         context, SetBatchAndOffsetIndices(result_index, data->offset_dims,
@@ -204,18 +228,14 @@ TfLiteStatus EvalWithTypes(TfLiteContext* context, TfLiteNode* node) {
     Index<IndexType> operand_lookup_index =
         AddIndices(final_starting_index, full_offset_index);
 
-    const DataType* operand_data = GetTensorData<DataType>(operand);
     IndexType flat_operand_index =
         TensorIndexToFlat(operand_lookup_index.data(),
-                          operand_lookup_index.size(), GetTensorShape(operand));
-    DataType looked_up_value = operand_data[flat_operand_index];
-
-    DataType* result_data = GetTensorData<DataType>(output);
+                          operand_lookup_index.size(), operand_shape);
     IndexType flat_result_index = TensorIndexToFlat(
-        result_index.data(), result_index.size(), GetTensorShape(output));
-    result_data[flat_result_index] = looked_up_value;
-  } while (NextIndex(result_rank, result_runtime_shape.DimsData(),
-                     result_index.data()));
+        result_index.data(), result_index.size(), result_runtime_shape);
+    std::copy_n(operand_data + flat_operand_index, row_size,
+                result_data + flat_result_index);
+  } while (NextIndex(result_rank, iteration_dims.data(), result_index.data()));
 
   return TfLiteStatus::kTfLiteOk;
 }
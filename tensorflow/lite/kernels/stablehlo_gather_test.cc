@@ -134,6 +134,33 @@ TEST(StablehloScatterOpTest, ClipsStartingIndices) {
   EXPECT_THAT(model.GetOutput<float>(), ElementsAreArray(expected_values));
 }
 
+TEST(StablehloScatterOpTest, GathersSlicesOfCollapsedInnermostDimension) {
+  TfLiteStablehloGatherParams params = {
+      {2, 3},     // offset_dims
+      2,          // num_offset_dims;
+      {2},        // collapsed_slice_dims
+      1,          // num_collapsed_slice_dims;
+      {1, 0},     // start_index_map
+      2,          // num_start_index_map;
+      2,          // index_vector_dim;
+      {2, 2, 1},  // slice_sizes
+      3,          // num_slice_sizes;
+      false       // indices_are_sorted;
+  };
+  StablehloGatherOpModel model({TensorType_FLOAT32, {3, 4, 2}},
+                               {TensorType_INT64, {2, 3, 2}}, params);
+
+  model.SetInput<float>({1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12,
+                         13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24});
+  model.SetIndices<int64_t>({0, 0, 1, 0, 2, 1, 0, 1, 1, 1, 0, 2});
+
+  ASSERT_EQ(model.Invoke(), kTfLiteOk);
+  std::vector<float> expected_values = {1,  3,  9,  11, 3,  5,  11, 13,
+                                        13, 15, 21, 23, 9,  11, 17, 19,
+                                        11, 13, 19, 21, 9,  11, 17, 19};
+  EXPECT_THAT(model.GetOutput<float>(), ElementsAreArray(expected_values));
+}
+
 TEST(StablehloScatterOpTest, WorksWithDynamicShapes) {
   TfLiteStablehloGatherParams params = {
       {2, 3},     // offset_dims
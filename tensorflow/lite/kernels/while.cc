@@ -16,6 +16,7 @@ limitations under the License.
 #include <stddef.h>
 
 #include <cstring>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/lite/context_util.h"
@@ -369,14 +370,16 @@ TfLiteStatus Eval_static(TfLiteContext* context, TfLiteNode* node) {
   // The follow graph illustrates the current implementation.
   // The body subgraph input tensors share memory with the node output tensors
   // so there is no need to copy from body subgraph output to inputs, only to
-  // node outputs.
+  // node outputs. Where possible the condition subgraph input tensors share
+  // memory with the node output tensors too, so that the copy to the node
+  // outputs also updates them.
   //
   // This Subgraph          Cond Subgraph         Body Subgraph
   // +-----------+   (1)   +------------+         +------------+
   // |   WHILE   |-------->|  SUBGRAPH  |         |  SUBGRAPH  |
   // |   INPUT   |         |   INPUT    |         |   INPUT    |
-  // |           |                                | shared w/  |
-  // |           |         |            | <----   |WHILE OUTPUT|
+  // |           |         | shared w/  |         | shared w/  |
+  // |           |         |WHILE OUTPUT| <----   |WHILE OUTPUT|
   // +-----------+         +------------+      \  +------------+
   //      |                      |              \       |
   //      | (2)                  | (3)       (5) \      | (4)
@@ -387,28 +390,59 @@ TfLiteStatus Eval_static(TfLiteContext* context, TfLiteNode* node) {
   // |           |<-------------------------------|            |
   // +-----------+         +------------+         +------------+
   //
-  // (1) Copy the inputs of WHILE op to the inputs of condition subgraph.
+  // (1) Copy the inputs of WHILE op to the condition subgraph inputs which
+  //     don't share memory with the WHILE outputs.
   // (2) Copy the inputs of WHILE op to the outputs of WHILE op.
   // (3) Invoke condition subgraph.
   //     Break if the result is false.
   // (4) Invoke body subgraph.
-  // (5) Copy the outputs of body subgraph to the inputs condition subgraph.
+  // (5) Copy the outputs of body subgraph to the condition subgraph inputs
+  //     which don't share memory with the WHILE outputs.
   // (6) Copy the outputs of body subgraph to the outputs of the WHILE op.
   //
   // The body subgraph shouldn't have dynamic sized outputs.
 
+  // Split the condition subgraph inputs into those which share memory with a
+  // tensor of this subgraph, and those which are copied, along with the WHILE
+  // inputs and body outputs they are copied from.
+  std::vector<std::pair<int, int>> shared_cond_inputs;
+  std::vector<int> copied_node_inputs, copied_body_outputs, copied_cond_inputs;
+  const int num_inputs = node->inputs->size;
+  const bool cond_is_static = !op_data->cond_has_dynamic_output_tensors &&
+                              !cond_subgraph->HasDynamicTensors();
+  for (int i = 0; i < num_inputs; ++i) {
+    const int cond_input_idx = cond_subgraph->inputs()[i];
+    if (cond_input_idx == kTfLiteOptionalTensor) continue;
+    const TfLiteTensor* cond_input = cond_subgraph->tensor(cond_input_idx);
+    // An input of the WHILE op whose output isn't consumed is loop invariant,
+    // so the condition can read it directly.
+    const int shared_idx = node->outputs->data[i] == kTfLiteOptionalTensor
+                               ? node->inputs->data[i]
+                               : node->outputs->data[i];
+    const TfLiteTensor* shared = this_subgraph->tensor(shared_idx);
+    // Resources and variants are copied deeply, and the size of a string
+    // tensor depends on its contents, so those are still copied.
+    if (cond_is_static && !IsResourceOrVariant(cond_input) &&
+        cond_input->type != kTfLiteString && cond_input->type == shared->type &&
+        cond_input->bytes == shared->bytes) {
+      shared_cond_inputs.emplace_back(cond_input_idx, shared_idx);
+    } else {
+      copied_node_inputs.push_back(node->inputs->data[i]);
+      copied_body_outputs.push_back(body_subgraph->outputs()[i]);
+      copied_cond_inputs.push_back(cond_input_idx);
+    }
+  }
+
   // Step 1. node->inputs -> cond->inputs (fast)
-  TF_LITE_ENSURE_OK(
-      context,
-      CopyTensorsData(context, this_subgraph, TfLiteIntArrayView(node->inputs),
-                      cond_subgraph, cond_subgraph->inputs()));
+  TF_LITE_ENSURE_OK(context,
+                    CopyTensorsData(context, this_subgraph, copied_node_inputs,
+                                    cond_subgraph, copied_cond_inputs));
 
   // Step 2. node->inputs to node->outputs
   TF_LITE_ENSURE_OK(
       context,
       CopyTensorsData(context, this_subgraph, TfLiteIntArrayView(node->inputs),
                       this_subgraph, TfLiteIntArrayView(node->outputs)));
-  const int num_inputs = node->inputs->size;
   for (int i = 0; i < num_inputs; ++i) {
     if (node->outputs->data[i] == kTfLiteOptionalTensor) continue;
     TfLiteTensor* body_input =
@@ -416,6 +450,10 @@ TfLiteStatus Eval_static(TfLiteContext* context, TfLiteNode* node) {
     TfLiteTensor* this_output = this_subgraph->tensor(node->outputs->data[i]);
     body_input->data = this_output->data;
   }
+  for (const auto& [cond_input_idx, shared_idx] : shared_cond_inputs) {
+    cond_subgraph->tensor(cond_input_idx)->data =
+        this_subgraph->tensor(shared_idx)->data;
+  }
 
   SetupUnconsumedOutputs(node, op_data, this_subgraph, body_subgraph);
 
@@ -438,9 +476,9 @@ TfLiteStatus Eval_static(TfLiteContext* context, TfLiteNode* node) {
 
     // Step 5. body->outputs -> cond->inputs (fast)
     TF_LITE_ENSURE_OK(
-        context,
-        CopyTensorsData(context, body_subgraph, body_subgraph->outputs(),
-                        cond_subgraph, cond_subgraph->inputs()));
+        context, CopyTensorsData(context, body_subgraph, copied_body_outputs,
+                                 cond_subgraph, copied_cond_inputs));
+    // Step 6. body->outputs -> node->outputs
     TF_LITE_ENSURE_OK(
         context,
         CopyTensorsData(context, body_subgraph, body_subgraph->outputs(),
@@ -380,6 +380,42 @@ TEST_F(WhileTest, TestTriangularNumberSequence) {
   }
 }
 
+TEST_F(WhileTest, TestStaticCondInputsShareWhileOutputs) {
+  interpreter_ = std::make_unique<Interpreter>();
+  AddSubgraphs(2);
+  builder_->BuildLessEqualCondSubgraph(interpreter_->subgraph(1), 5);
+  builder_->BuildAccumulateLoopBodySubgraph(interpreter_->subgraph(2));
+  builder_->BuildWhileSubgraph(&interpreter_->primary_subgraph());
+
+  ASSERT_EQ(interpreter_->ResizeInputTensor(interpreter_->inputs()[0], {1}),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter_->ResizeInputTensor(interpreter_->inputs()[1], {1}),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  FillIntTensor(interpreter_->tensor(interpreter_->inputs()[0]), {1});
+  FillIntTensor(interpreter_->tensor(interpreter_->inputs()[1]), {1});
+
+  ASSERT_EQ(interpreter_->Invoke(), kTfLiteOk);
+  TfLiteTensor* output1 = interpreter_->tensor(interpreter_->outputs()[0]);
+  CheckIntTensor(output1, {1}, {6});
+  TfLiteTensor* output2 = interpreter_->tensor(interpreter_->outputs()[1]);
+  CheckIntTensor(output2, {1}, {21});
+
+  // The condition reads the loop state from the WHILE outputs.
+  auto cond_subgraph = interpreter_->subgraph(1);
+  EXPECT_EQ(cond_subgraph->tensor(cond_subgraph->inputs()[0])->data.raw,
+            output1->data.raw);
+  EXPECT_EQ(cond_subgraph->tensor(cond_subgraph->inputs()[1])->data.raw,
+            output2->data.raw);
+
+  // The inputs are copied again on every invocation.
+  FillIntTensor(interpreter_->tensor(interpreter_->inputs()[0]), {3});
+  FillIntTensor(interpreter_->tensor(interpreter_->inputs()[1]), {6});
+  ASSERT_EQ(interpreter_->Invoke(), kTfLiteOk);
+  CheckIntTensor(output1, {1}, {6});
+  CheckIntTensor(output2, {1}, {21});
+}
+
 TEST_F(WhileTest, TestTriangularNumberSequenceWithShallowCopy) {
   const std::vector<int> expected = {1, 3, 6, 10, 15, 21, 28};
   for (int i = 0; i < expected.size(); ++i) {
@@ -0,0 +1,197 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/hw_counters_profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif
+
+#include "tensorflow/lite/core/api/profiler.h"
+#include "tensorflow/lite/profiling/profile_buffer.h"
+#include "tensorflow/lite/profiling/time.h"
+
+namespace tflite {
+namespace profiling {
+
+namespace {
+
+#if defined(__linux__)
+constexpr uint64_t kPerfEventConfigs[kNumHwCounters] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_REFERENCES,
+    PERF_COUNT_HW_CACHE_MISSES,
+};
+
+int OpenPerfEvent(uint64_t config, int group_fd) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = config;
+  attr.read_format = PERF_FORMAT_GROUP;
+  // Only the leader starts disabled; members follow the leader's state.
+  attr.disabled = group_fd == -1 ? 1 : 0;
+  // Counting user space only works with the default perf_event_paranoid
+  // setting of Android and most Linux distributions.
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return static_cast<int>(syscall(__NR_perf_event_open, &attr, /*pid=*/0,
+                                  /*cpu=*/-1, group_fd, /*flags=*/0));
+}
+#endif
+
+}  // namespace
+
+const char* HwCounterName(HwCounter counter) {
+  switch (counter) {
+    case HwCounter::kCycles:
+      return "cycles";
+    case HwCounter::kInstructions:
+      return "instructions";
+    case HwCounter::kCacheReferences:
+      return "cache_references";
+    case HwCounter::kCacheMisses:
+      return "cache_misses";
+  }
+  return "unknown";
+}
+
+HwCountersProfiler::HwCountersProfiler() {
+  counter_index_.fill(-1);
+#if defined(__linux__)
+  for (int i = 0; i < kNumHwCounters; ++i) {
+    const int group_fd = fds_.empty() ? -1 : fds_[0];
+    const int fd = OpenPerfEvent(kPerfEventConfigs[i], group_fd);
+    if (fd < 0) continue;
+    counter_index_[i] = num_open_counters_++;
+    fds_.push_back(fd);
+  }
+  if (!fds_.empty()) {
+    ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+#endif
+}
+
+HwCountersProfiler::~HwCountersProfiler() {
+#if defined(__linux__)
+  for (int fd : fds_) close(fd);
+#endif
+}
+
+uint32_t HwCountersProfiler::BeginEvent(const char* tag, EventType event_type,
+                                        int64_t event_metadata1,
+                                        int64_t event_metadata2) {
+  if (!enabled_ || tag == nullptr) return kInvalidEventHandle;
+  const bool is_delegate_op =
+      event_type == EventType::DELEGATE_OPERATOR_INVOKE_EVENT;
+  if (event_type != EventType::OPERATOR_INVOKE_EVENT &&
+      event_type != EventType::DELEGATE_PROFILED_OPERATOR_INVOKE_EVENT &&
+      !is_delegate_op) {
+    return kInvalidEventHandle;
+  }
+
+  const auto key =
+      std::make_tuple(is_delegate_op, event_metadata2, event_metadata1);
+  auto it = stats_index_.find(key);
+  if (it == stats_index_.end()) {
+    OpHwCounterStats stats;
+    stats.tag = tag;
+    stats.node_index = event_metadata1;
+    stats.subgraph_index = event_metadata2;
+    stats.is_delegate_op = is_delegate_op;
+    it = stats_index_.emplace(key, stats_.size()).first;
+    stats_.push_back(stats);
+  }
+
+  OpenEvent event;
+  event.stats_index = it->second;
+  // Sample the counters last so that the bookkeeping above isn't attributed
+  // to the op.
+  event.begin_time_us = time::NowMicros();
+  ReadCounters(&event.begin_values);
+  open_events_.push_back(event);
+  return static_cast<uint32_t>(open_events_.size() - 1);
+}
+
+void HwCountersProfiler::EndEvent(uint32_t event_handle) {
+  if (event_handle >= open_events_.size()) return;
+  std::array<uint64_t, kNumHwCounters> end_values;
+  ReadCounters(&end_values);
+  const uint64_t end_time_us = time::NowMicros();
+
+  const OpenEvent& event = open_events_[event_handle];
+  OpHwCounterStats& stats = stats_[event.stats_index];
+  ++stats.count;
+  stats.total_time_us += end_time_us - event.begin_time_us;
+  for (int i = 0; i < kNumHwCounters; ++i) {
+    stats.totals[i] += end_values[i] - event.begin_values[i];
+  }
+  // Operator events are scoped, so any event opened after this one has been
+  // closed already.
+  open_events_.resize(event_handle);
+}
+
+void HwCountersProfiler::Reset() {
+  enabled_ = false;
+  stats_.clear();
+  stats_index_.clear();
+  open_events_.clear();
+}
+
+std::vector<OpHwCounterStats> HwCountersProfiler::GetOpStats() const {
+  std::vector<OpHwCounterStats> result;
+  result.reserve(stats_.size());
+  for (const auto& entry : stats_index_) {
+    result.push_back(stats_[entry.second]);
+  }
+  return result;
+}
+
+void HwCountersProfiler::ReadCounters(
+    std::array<uint64_t, kNumHwCounters>* values) const {
+  values->fill(0);
+#if defined(__linux__)
+  if (fds_.empty()) return;
+  // Layout of a PERF_FORMAT_GROUP read: the number of counters followed by
+  // their values in the order they were added to the group.
+  uint64_t buffer[1 + kNumHwCounters];
+  const ssize_t size = read(fds_[0], buffer, sizeof(buffer));
+  if (size < static_cast<ssize_t>(sizeof(uint64_t))) return;
+  const int num_values = static_cast<int>(
+      std::min<uint64_t>(buffer[0], static_cast<uint64_t>(num_open_counters_)));
+  for (int i = 0; i < kNumHwCounters; ++i) {
+    if (counter_index_[i] >= 0 && counter_index_[i] < num_values) {
+      (*values)[i] = buffer[1 + counter_index_[i]];
+    }
+  }
+#endif
+}
+
+}  // namespace profiling
+}  // namespace tflite
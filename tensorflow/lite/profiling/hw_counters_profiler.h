@@ -0,0 +1,130 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_PROFILING_HW_COUNTERS_PROFILER_H_
+#define TENSORFLOW_LITE_PROFILING_HW_COUNTERS_PROFILER_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "tensorflow/lite/core/api/profiler.h"
+
+namespace tflite {
+namespace profiling {
+
+// Hardware counters sampled around every operator invocation.
+enum class HwCounter {
+  kCycles = 0,
+  kInstructions,
+  kCacheReferences,
+  kCacheMisses,
+};
+constexpr int kNumHwCounters = 4;
+
+// Returns a human readable name of `counter`, e.g. "cycles".
+const char* HwCounterName(HwCounter counter);
+
+// Accumulated hardware counter deltas of a single operator.
+struct OpHwCounterStats {
+  std::string tag;
+  int64_t node_index = 0;
+  int64_t subgraph_index = 0;
+  // Whether the op is an internal op of a delegate.
+  bool is_delegate_op = false;
+  // Number of profiled invocations.
+  int64_t count = 0;
+  // Total wall time of all invocations in microseconds.
+  uint64_t total_time_us = 0;
+  // Total counter deltas of all invocations, indexed by HwCounter.
+  std::array<uint64_t, kNumHwCounters> totals = {};
+
+  uint64_t Total(HwCounter counter) const {
+    return totals[static_cast<int>(counter)];
+  }
+};
+
+// A profiler that attributes hardware performance counter deltas to each
+// operator invocation. Counters are read through perf_event on Linux and
+// Android; on other platforms, or when the kernel denies access to the
+// counters, only invocation counts and wall time are recorded.
+//
+// Counters measure the thread that invokes the interpreter (user space only),
+// so work that an op offloads to a thread pool is not attributed to it. Run
+// with a single thread for exact per-op numbers.
+//
+// This class is *not thread safe*, like BufferedProfiler.
+class HwCountersProfiler : public tflite::Profiler {
+ public:
+  HwCountersProfiler();
+  ~HwCountersProfiler() override;
+
+  HwCountersProfiler(const HwCountersProfiler&) = delete;
+  HwCountersProfiler& operator=(const HwCountersProfiler&) = delete;
+
+  uint32_t BeginEvent(const char* tag, EventType event_type,
+                      int64_t event_metadata1,
+                      int64_t event_metadata2) override;
+
+  void EndEvent(uint32_t event_handle) override;
+
+  // Returns whether `counter` could be opened. Unavailable counters are
+  // reported as zero.
+  bool IsCounterAvailable(HwCounter counter) const {
+    return counter_index_[static_cast<int>(counter)] >= 0;
+  }
+
+  // Returns whether any counter could be opened.
+  bool IsAvailable() const { return num_open_counters_ > 0; }
+
+  void StartProfiling() { enabled_ = true; }
+  void StopProfiling() { enabled_ = false; }
+  // Clears all the accumulated stats.
+  void Reset();
+
+  // Returns the accumulated stats of the operators ordered by subgraph and node
+  // index, followed by those of the delegate internal ops.
+  std::vector<OpHwCounterStats> GetOpStats() const;
+
+ private:
+  struct OpenEvent {
+    size_t stats_index;
+    uint64_t begin_time_us;
+    std::array<uint64_t, kNumHwCounters> begin_values;
+  };
+
+  // Reads the current values of all counters into `values`.
+  void ReadCounters(std::array<uint64_t, kNumHwCounters>* values) const;
+
+  bool enabled_ = false;
+  // perf_event file descriptors; the first one is the group leader.
+  std::vector<int> fds_;
+  // Position of each HwCounter in the group read, or -1 if unavailable.
+  std::array<int, kNumHwCounters> counter_index_;
+  int num_open_counters_ = 0;
+
+  std::vector<OpHwCounterStats> stats_;
+  // Maps (is_delegate_op, subgraph_index, node_index) to stats_.
+  std::map<std::tuple<bool, int64_t, int64_t>, size_t> stats_index_;
+  std::vector<OpenEvent> open_events_;
+};
+
+}  // namespace profiling
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_PROFILING_HW_COUNTERS_PROFILER_H_
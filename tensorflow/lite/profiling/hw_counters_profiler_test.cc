@@ -0,0 +1,103 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/hw_counters_profiler.h"
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/api/profiler.h"
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+using EventType = Profiler::EventType;
+
+// Burns some instructions so that the counters have something to measure.
+int64_t Work(int n) {
+  volatile int64_t sum = 0;
+  for (int i = 0; i < n; ++i) sum += i;
+  return sum;
+}
+
+TEST(HwCountersProfilerTest, NoEventsWhenDisabled) {
+  HwCountersProfiler profiler;
+  uint32_t handle =
+      profiler.BeginEvent("Conv", EventType::OPERATOR_INVOKE_EVENT,
+                          /*event_metadata1=*/0, /*event_metadata2=*/0);
+  profiler.EndEvent(handle);
+  EXPECT_TRUE(profiler.GetOpStats().empty());
+}
+
+TEST(HwCountersProfilerTest, IgnoresNonOperatorEvents) {
+  HwCountersProfiler profiler;
+  profiler.StartProfiling();
+  uint32_t handle = profiler.BeginEvent("Invoke", EventType::DEFAULT,
+                                        /*event_metadata1=*/0,
+                                        /*event_metadata2=*/0);
+  profiler.EndEvent(handle);
+  EXPECT_TRUE(profiler.GetOpStats().empty());
+}
+
+TEST(HwCountersProfilerTest, AccumulatesPerOp) {
+  HwCountersProfiler profiler;
+  profiler.StartProfiling();
+  for (int run = 0; run < 3; ++run) {
+    uint32_t add = profiler.BeginEvent("ADD", EventType::OPERATOR_INVOKE_EVENT,
+                                       /*event_metadata1=*/1,
+                                       /*event_metadata2=*/0);
+    Work(10000);
+    profiler.EndEvent(add);
+
+    uint32_t delegate = profiler.BeginEvent(
+        "DELEGATE", EventType::OPERATOR_INVOKE_EVENT, /*event_metadata1=*/0,
+        /*event_metadata2=*/0);
+    uint32_t inner = profiler.BeginEvent(
+        "Convolution", EventType::DELEGATE_OPERATOR_INVOKE_EVENT,
+        /*event_metadata1=*/0, /*event_metadata2=*/0);
+    Work(10000);
+    profiler.EndEvent(inner);
+    profiler.EndEvent(delegate);
+  }
+  profiler.StopProfiling();
+
+  std::vector<OpHwCounterStats> stats = profiler.GetOpStats();
+  ASSERT_EQ(stats.size(), 3);
+  EXPECT_EQ(stats[0].tag, "DELEGATE");
+  EXPECT_EQ(stats[0].node_index, 0);
+  EXPECT_FALSE(stats[0].is_delegate_op);
+  EXPECT_EQ(stats[1].tag, "ADD");
+  EXPECT_EQ(stats[1].node_index, 1);
+  EXPECT_EQ(stats[2].tag, "Convolution");
+  EXPECT_TRUE(stats[2].is_delegate_op);
+  for (const OpHwCounterStats& op : stats) {
+    EXPECT_EQ(op.count, 3);
+  }
+
+  if (profiler.IsCounterAvailable(HwCounter::kInstructions)) {
+    EXPECT_GT(stats[1].Total(HwCounter::kInstructions), 0);
+    // The delegate op includes its internal op.
+    EXPECT_GE(stats[0].Total(HwCounter::kInstructions),
+              stats[2].Total(HwCounter::kInstructions));
+  }
+
+  profiler.Reset();
+  EXPECT_TRUE(profiler.GetOpStats().empty());
+}
+
+}  // namespace
+}  // namespace profiling
+}  // namespace tflite
@@ -284,6 +284,35 @@ TfLiteStatus SimpleMemoryArena::Allocate(
   return kTfLiteOk;
 }
 
+bool SimpleMemoryArena::TryAllocateAt(size_t alignment, size_t offset,
+                                      size_t size, int32_t tensor,
+                                      int32_t first_node, int32_t last_node,
+                                      ArenaAllocWithUsageInterval* new_alloc) {
+  if (alignment == 0 || alignment > underlying_buffer_.GetAlignment() ||
+      offset % alignment != 0) {
+    return false;
+  }
+  for (const auto& alloc : active_allocs_) {
+    if (alloc.last_node < first_node || alloc.first_node > last_node) {
+      continue;
+    }
+    if (offset < alloc.offset + alloc.size && alloc.offset < offset + size) {
+      return false;
+    }
+  }
+  new_alloc->tensor = tensor;
+  new_alloc->first_node = first_node;
+  new_alloc->last_node = last_node;
+  new_alloc->size = size;
+  new_alloc->offset = offset;
+  high_water_mark_ = std::max(high_water_mark_, offset + size);
+
+  auto insertion_it = std::upper_bound(active_allocs_.begin(),
+                                       active_allocs_.end(), *new_alloc);
+  active_allocs_.insert(insertion_it, *new_alloc);
+  return true;
+}
+
 TfLiteStatus SimpleMemoryArena::Commit(bool* arena_reallocated) {
   // Resize the arena to the high water mark (calculated by Allocate), retaining
   // old contents and alignment in the process. Since Alloc pointers are offset
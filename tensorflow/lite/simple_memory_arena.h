@@ -142,6 +142,14 @@ class SimpleMemoryArena {
                         int32_t tensor, int32_t first_node, int32_t last_node,
                         ArenaAllocWithUsageInterval* new_alloc);
 
+  // Like `Allocate`, but at the given `offset`, e.g. one planned offline.
+  // Returns false without allocating anything if `offset` is not aligned, or
+  // overlaps with an alloc whose usage interval intersects with
+  // [first_node, last_node].
+  bool TryAllocateAt(size_t alignment, size_t offset, size_t size,
+                     int32_t tensor, int32_t first_node, int32_t last_node,
+                     ArenaAllocWithUsageInterval* new_alloc);
+
   TfLiteStatus Commit(bool* arena_reallocated);
 
   TfLiteStatus ResolveAlloc(TfLiteContext* context,
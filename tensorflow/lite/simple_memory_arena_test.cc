@@ -121,6 +121,41 @@ TEST(SimpleMemoryArenaTest, TestClearPlan) {
   EXPECT_EQ(allocs[8].offset, 8192);
 }
 
+TEST(SimpleMemoryArenaTest, TryAllocateAt) {
+  TfLiteContext context;
+  SimpleMemoryArena arena(/*arena_alignment=*/64);
+  ArenaAllocWithUsageInterval allocs[4];
+
+  EXPECT_TRUE(arena.TryAllocateAt(/*alignment=*/32, /*offset=*/4096,
+                                  /*size=*/2047, /*tensor=*/0,
+                                  /*first_node=*/0, /*last_node=*/2,
+                                  &allocs[0]));
+  EXPECT_EQ(allocs[0].offset, 4096);
+  // Overlaps with tensor 0 while it is in use.
+  EXPECT_FALSE(arena.TryAllocateAt(/*alignment=*/32, /*offset=*/2048,
+                                   /*size=*/4096, /*tensor=*/1,
+                                   /*first_node=*/2, /*last_node=*/3,
+                                   &allocs[1]));
+  // Not aligned.
+  EXPECT_FALSE(arena.TryAllocateAt(/*alignment=*/32, /*offset=*/16,
+                                   /*size=*/2047, /*tensor=*/1,
+                                   /*first_node=*/2, /*last_node=*/3,
+                                   &allocs[1]));
+  // Tensor 0 is not in use anymore.
+  EXPECT_TRUE(arena.TryAllocateAt(/*alignment=*/32, /*offset=*/2048,
+                                  /*size=*/4096, /*tensor=*/2,
+                                  /*first_node=*/3, /*last_node=*/4,
+                                  &allocs[2]));
+
+  // Regular allocations are placed around the ones at a given offset.
+  arena.Allocate(&context, /*alignment=*/32, /*size=*/2047, /*tensor=*/3,
+                 /*first_node=*/1, /*last_node=*/3, &allocs[3]);
+  EXPECT_EQ(allocs[3].offset, 0);
+  arena.Allocate(&context, /*alignment=*/32, /*size=*/2047, /*tensor=*/1,
+                 /*first_node=*/2, /*last_node=*/3, &allocs[1]);
+  EXPECT_EQ(allocs[1].offset, 6144);
+}
+
 TEST(SimpleMemoryArenaTest, TestPurgeAllocs) {
   TfLiteContext context;
   context.ReportError = ReportError;
@@ -51,6 +51,7 @@ limitations under the License.
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
 #include "tensorflow/lite/string_util.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
+#include "tensorflow/lite/tools/benchmark/hw_counters_listener.h"
 #include "tensorflow/lite/tools/benchmark/profiling_listener.h"
 #include "tensorflow/lite/tools/delegates/delegate_provider.h"
 #include "tensorflow/lite/tools/logging.h"
@@ -485,6 +486,10 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
                           BenchmarkParam::Create<bool>(false));
   default_params.AddParam("profiling_output_csv_file",
                           BenchmarkParam::Create<std::string>(""));
+  default_params.AddParam("enable_hw_counters",
+                          BenchmarkParam::Create<bool>(false));
+  default_params.AddParam("hw_counters_output_csv_file",
+                          BenchmarkParam::Create<std::string>(""));
 
   default_params.AddParam("print_preinvoke_state",
                           BenchmarkParam::Create<bool>(false));
@@ -573,6 +578,14 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
           "profiling_output_csv_file", &params_,
           "File path to export profile data as CSV, if not set "
           "prints to stdout."),
+      CreateFlag<bool>(
+          "enable_hw_counters", &params_,
+          "report per-op hardware counters (cycles, instructions, cache "
+          "references and misses) read through perf_event. Only available on "
+          "Linux and Android."),
+      CreateFlag<std::string>(
+          "hw_counters_output_csv_file", &params_,
+          "File path to export the per-op hardware counters as CSV."),
       CreateFlag<bool>(
           "print_preinvoke_state", &params_,
           "print out the interpreter internals just before calling Invoke. The "
@@ -657,6 +670,10 @@ void BenchmarkTfLiteModel::LogParams() {
                       verbose);
   LOG_BENCHMARK_PARAM(std::string, "profiling_output_csv_file",
                       "CSV File to export profiling data to", verbose);
+  LOG_BENCHMARK_PARAM(bool, "enable_hw_counters", "Enable HW counters",
+                      verbose);
+  LOG_BENCHMARK_PARAM(std::string, "hw_counters_output_csv_file",
+                      "CSV File to export HW counters to", verbose);
   LOG_BENCHMARK_PARAM(bool, "print_preinvoke_state",
                       "Print pre-invoke interpreter state", verbose);
   LOG_BENCHMARK_PARAM(bool, "print_postinvoke_state",
@@ -933,6 +950,13 @@ TfLiteStatus BenchmarkTfLiteModel::Init() {
   }
 
   AddOwnedListener(MayCreateProfilingListener());
+  // The HW counters profiler is added next to the op profiler, which replaces
+  // any installed profiler, so it has to come after it.
+  if (params_.Get<bool>("enable_hw_counters")) {
+    AddOwnedListener(std::make_unique<HwCountersListener>(
+        interpreter_.get(),
+        params_.Get<std::string>("hw_counters_output_csv_file")));
+  }
   AddOwnedListener(std::unique_ptr<BenchmarkListener>(
       new InterpreterStatePrinter(interpreter_.get())));
 
@@ -0,0 +1,166 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/hw_counters_listener.h"
+
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/profiling/hw_counters_profiler.h"
+#include "tensorflow/lite/tools/logging.h"
+
+namespace tflite {
+namespace benchmark {
+
+namespace {
+
+using profiling::HwCounter;
+using profiling::OpHwCounterStats;
+
+constexpr double kCacheLineBytes = 64.0;
+
+double Ratio(uint64_t numerator, uint64_t denominator) {
+  return denominator == 0 ? 0.0
+                          : static_cast<double>(numerator) / denominator;
+}
+
+double Ipc(const OpHwCounterStats& op) {
+  return Ratio(op.Total(HwCounter::kInstructions),
+               op.Total(HwCounter::kCycles));
+}
+
+double CacheMissRate(const OpHwCounterStats& op) {
+  return Ratio(op.Total(HwCounter::kCacheMisses),
+               op.Total(HwCounter::kCacheReferences));
+}
+
+// Bytes per microsecond, i.e. MB/s.
+double EstimatedBandwidthMBps(const OpHwCounterStats& op) {
+  return kCacheLineBytes *
+         Ratio(op.Total(HwCounter::kCacheMisses), op.total_time_us);
+}
+
+std::string OpName(const OpHwCounterStats& op) {
+  std::ostringstream name;
+  if (op.is_delegate_op) name << "delegate:";
+  name << op.subgraph_index << ":" << op.node_index;
+  return name.str();
+}
+
+}  // namespace
+
+HwCountersListener::HwCountersListener(Interpreter* interpreter,
+                                       const std::string& csv_file_path)
+    : interpreter_(interpreter), csv_file_path_(csv_file_path) {
+  TFLITE_TOOLS_CHECK(interpreter);
+  interpreter_->AddProfiler(&profiler_);
+}
+
+void HwCountersListener::OnBenchmarkStart(const BenchmarkParams& params) {
+  if (!profiler_.IsAvailable()) {
+    TFLITE_LOG(WARN) << "Hardware counters are not available on this "
+                        "platform or access is denied (see "
+                        "/proc/sys/kernel/perf_event_paranoid); only op "
+                        "timings will be reported.";
+  }
+  profiler_.Reset();
+}
+
+void HwCountersListener::OnSingleRunStart(RunType run_type) {
+  if (run_type == REGULAR) profiler_.StartProfiling();
+}
+
+void HwCountersListener::OnSingleRunEnd() { profiler_.StopProfiling(); }
+
+void HwCountersListener::OnBenchmarkEnd(const BenchmarkResults& results) {
+  const std::vector<OpHwCounterStats> stats = profiler_.GetOpStats();
+  if (stats.empty()) return;
+  TFLITE_LOG(INFO) << "Operator-wise HW Counters for Regular Benchmark Runs:\n"
+                   << FormatSummary(stats);
+  if (csv_file_path_.empty()) return;
+  std::ofstream output_file(csv_file_path_);
+  if (!output_file.good()) {
+    TFLITE_LOG(ERROR) << "Failed to open " << csv_file_path_;
+    return;
+  }
+  output_file << FormatCsv(stats);
+}
+
+std::string HwCountersListener::FormatSummary(
+    const std::vector<OpHwCounterStats>& stats) {
+  std::ostringstream stream;
+  stream << std::setw(24) << "[node type]" << std::setw(16) << "[node]"
+         << std::setw(8) << "[count]" << std::setw(12) << "[avg us]"
+         << std::setw(14) << "[cycles]" << std::setw(16) << "[instructions]"
+         << std::setw(8) << "[IPC]" << std::setw(14) << "[cache refs]"
+         << std::setw(16) << "[cache misses]" << std::setw(10) << "[miss %]"
+         << std::setw(14) << "[est. MB/s]" << "\n";
+  stream << std::fixed;
+  OpHwCounterStats total;
+  for (const OpHwCounterStats& op : stats) {
+    const double count = op.count > 0 ? op.count : 1;
+    stream << std::setw(24) << op.tag << std::setw(16) << OpName(op)
+           << std::setw(8) << op.count << std::setprecision(3) << std::setw(12)
+           << op.total_time_us / count << std::setprecision(0)
+           << std::setw(14) << op.Total(HwCounter::kCycles) / count
+           << std::setw(16) << op.Total(HwCounter::kInstructions) / count
+           << std::setprecision(2) << std::setw(8) << Ipc(op)
+           << std::setprecision(0) << std::setw(14)
+           << op.Total(HwCounter::kCacheReferences) / count << std::setw(16)
+           << op.Total(HwCounter::kCacheMisses) / count
+           << std::setprecision(2) << std::setw(10) << 100 * CacheMissRate(op)
+           << std::setprecision(1) << std::setw(14)
+           << EstimatedBandwidthMBps(op) << "\n";
+    // Delegate internal ops are already part of their delegate kernel op.
+    if (op.is_delegate_op) continue;
+    total.total_time_us += op.total_time_us;
+    for (int i = 0; i < profiling::kNumHwCounters; ++i) {
+      total.totals[i] += op.totals[i];
+    }
+  }
+  stream << "Totals of all ops: " << std::setprecision(0)
+         << total.Total(HwCounter::kCycles) << " cycles, "
+         << total.Total(HwCounter::kInstructions) << " instructions, "
+         << std::setprecision(2) << Ipc(total) << " IPC, "
+         << 100 * CacheMissRate(total) << "% cache misses, "
+         << std::setprecision(1) << EstimatedBandwidthMBps(total)
+         << " est. MB/s\n";
+  return stream.str();
+}
+
+std::string HwCountersListener::FormatCsv(
+    const std::vector<OpHwCounterStats>& stats) {
+  std::ostringstream stream;
+  stream << "node type,subgraph index,node index,delegate op,count,"
+            "total time us,cycles,instructions,cache references,cache misses,"
+            "IPC,cache miss rate,est. bandwidth MB/s\n";
+  for (const OpHwCounterStats& op : stats) {
+    stream << op.tag << "," << op.subgraph_index << "," << op.node_index << ","
+           << (op.is_delegate_op ? 1 : 0) << "," << op.count << ","
+           << op.total_time_us << "," << op.Total(HwCounter::kCycles) << ","
+           << op.Total(HwCounter::kInstructions) << ","
+           << op.Total(HwCounter::kCacheReferences) << ","
+           << op.Total(HwCounter::kCacheMisses) << "," << Ipc(op) << ","
+           << CacheMissRate(op) << "," << EstimatedBandwidthMBps(op) << "\n";
+  }
+  return stream.str();
+}
+
+}  // namespace benchmark
+}  // namespace tflite
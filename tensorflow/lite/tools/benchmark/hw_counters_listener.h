@@ -0,0 +1,64 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_HW_COUNTERS_LISTENER_H_
+#define TENSORFLOW_LITE_TOOLS_BENCHMARK_HW_COUNTERS_LISTENER_H_
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/profiling/hw_counters_profiler.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_model.h"
+
+namespace tflite {
+namespace benchmark {
+
+// Reports per-op hardware counters (cycles, instructions, cache references and
+// misses) of the regular benchmark runs. The estimated memory bandwidth
+// assumes every cache miss fetches one 64-byte line from memory.
+class HwCountersListener : public BenchmarkListener {
+ public:
+  // The profiler is added to `interpreter`, so this has to be created after
+  // any listener that calls Interpreter::SetProfiler.
+  explicit HwCountersListener(Interpreter* interpreter,
+                              const std::string& csv_file_path = "");
+
+  void OnBenchmarkStart(const BenchmarkParams& params) override;
+
+  void OnSingleRunStart(RunType run_type) override;
+
+  void OnSingleRunEnd() override;
+
+  void OnBenchmarkEnd(const BenchmarkResults& results) override;
+
+  // Formats `stats` as a table, with values averaged over the invocations.
+  static std::string FormatSummary(
+      const std::vector<profiling::OpHwCounterStats>& stats);
+
+  // Formats `stats` as CSV, with one row per op.
+  static std::string FormatCsv(
+      const std::vector<profiling::OpHwCounterStats>& stats);
+
+ private:
+  Interpreter* interpreter_;
+  std::string csv_file_path_;
+  profiling::HwCountersProfiler profiler_;
+};
+
+}  // namespace benchmark
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_BENCHMARK_HW_COUNTERS_LISTENER_H_
@@ -18,6 +18,7 @@ import numpy as np
 from tensorflow.python.data.benchmarks import benchmark_base
 from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.data.ops import map_op
+from tensorflow.python.data.ops import options as options_lib
 from tensorflow.python.framework import constant_op
 from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import map_fn
@@ -189,6 +190,30 @@ class MapBenchmark(benchmark_base.DatasetBenchmarkBase):
       for num_parallel_calls in nums_parallel_calls:
         self._benchmark_nested_parallel_map(cycle_length, num_parallel_calls)
 
+  def benchmark_map_vectorization(self):
+
+    def benchmark_helper(batch_size, map_vectorization):
+      dataset = dataset_ops.Dataset.from_tensors(
+          constant_op.constant(1.0, shape=[64])).repeat(None)
+      dataset = dataset.map(lambda x: math_ops.reduce_sum(x * x))
+      dataset = dataset.batch(batch_size)
+      options = options_lib.Options()
+      options.experimental_optimization.map_vectorization = map_vectorization
+      dataset = dataset.with_options(options)
+      label = "vectorized" if map_vectorization else "unvectorized"
+      self.run_and_report_benchmark(
+          dataset,
+          num_elements=10000 // batch_size,
+          extras={
+              "model_name": "map.benchmark.11",
+              "parameters": "%d_%s" % (batch_size, label),
+          },
+          name="map_and_batch_size_%d_%s" % (batch_size, label))
+
+    for batch_size in [1, 10, 100]:
+      for map_vectorization in [False, True]:
+        benchmark_helper(batch_size, map_vectorization)
+
 
 if __name__ == "__main__":
   benchmark_base.test.main()
@@ -0,0 +1,103 @@
+# Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for the `MapVectorization` optimization."""
+from absl.testing import parameterized
+
+from tensorflow.python.data.experimental.ops import testing
+from tensorflow.python.data.kernel_tests import test_base
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.data.ops import options as options_lib
+from tensorflow.python.framework import combinations
+from tensorflow.python.framework import constant_op
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import errors
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import math_ops
+from tensorflow.python.ops import random_ops
+from tensorflow.python.platform import test
+
+
+def _with_map_vectorization(dataset):
+  options = options_lib.Options()
+  options.experimental_optimization.apply_default_optimizations = False
+  options.experimental_optimization.map_vectorization = True
+  return dataset.with_options(options)
+
+
+class MapVectorizationTest(test_base.DatasetTestBase, parameterized.TestCase):
+
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(drop_remainder=[True, False]),
+          combinations.combine(num_parallel_calls=[None, 2])))
+  def testMapVectorization(self, drop_remainder, num_parallel_calls):
+    dataset = dataset_ops.Dataset.range(10).apply(
+        testing.assert_next(["Batch", "ParallelMap" if num_parallel_calls
+                             else "Map"]))
+    dataset = dataset.map(
+        lambda x: (x * 2, [x, x + 1]), num_parallel_calls=num_parallel_calls)
+    dataset = dataset.batch(4, drop_remainder=drop_remainder)
+    dataset = _with_map_vectorization(dataset)
+    batches = [range(0, 4), range(4, 8)]
+    if not drop_remainder:
+      batches.append(range(8, 10))
+    self.assertDatasetProduces(
+        dataset,
+        expected_output=[([x * 2 for x in batch], [[x, x + 1] for x in batch])
+                         for batch in batches])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testCapturedInputs(self):
+    captured = constant_op.constant(3, dtype=dtypes.int64)
+    dataset = dataset_ops.Dataset.range(6).apply(
+        testing.assert_next(["Batch", "Map"]))
+    dataset = dataset.map(lambda x: x * captured).batch(3)
+    dataset = _with_map_vectorization(dataset)
+    self.assertDatasetProduces(
+        dataset, expected_output=[[0, 3, 6], [9, 12, 15]])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testStatefulFunctionIsNotVectorized(self):
+    dataset = dataset_ops.Dataset.range(6).apply(
+        testing.assert_next(["Map", "Batch"]))
+    dataset = dataset.map(
+        lambda x: x + random_ops.random_uniform([], 0, 1, dtype=dtypes.int64))
+    dataset = dataset.batch(3)
+    dataset = _with_map_vectorization(dataset)
+    self.assertDatasetProduces(
+        dataset, expected_output=[[0, 1, 2], [3, 4, 5]])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testInputWithUnknownShapeIsNotVectorized(self):
+    # Batching the variable-length inputs before the map would fail.
+    dataset = dataset_ops.Dataset.range(1, 4).map(
+        lambda x: array_ops.fill([x], x)).apply(
+            testing.assert_next(["Map", "Batch"]))
+    dataset = dataset.map(math_ops.reduce_sum).batch(3)
+    dataset = _with_map_vectorization(dataset)
+    self.assertDatasetProduces(dataset, expected_output=[[1, 4, 9]])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testIncompatibleShapesRaise(self):
+    dataset = dataset_ops.Dataset.range(1, 4).map(
+        lambda x: array_ops.fill([x], x)).batch(3)
+    dataset = _with_map_vectorization(dataset)
+    self.assertDatasetProduces(
+        dataset, expected_error=(errors.InvalidArgumentError, ""))
+
+
+if __name__ == "__main__":
+  test.main()
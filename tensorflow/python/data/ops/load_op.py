@@ -129,12 +129,15 @@ def _load_distributed_snapshot(
 ) -> dataset_ops.Dataset:
   """Loads a distributed snapshot."""
 
+  chunk_format = snapshot_pb2.DistributedSnapshotMetadata.ChunkFormat.Name(
+      metadata.chunk_format)
   dataset = _ListSnapshotChunksDataset(path)
   dataset = dataset.map(
       lambda chunk_file: _SnapshotChunkDataset(  # pylint:disable=g-long-lambda
           chunk_file,
           element_spec=_parse_element_spec(metadata.element_spec),
-          compression=metadata.compression))
+          compression=metadata.compression,
+          chunk_format=chunk_format))
   return reader_func(dataset)
 
 
@@ -209,12 +212,18 @@ class _LoadDataset(dataset_ops.DatasetSource):
 class _SnapshotChunkDataset(dataset_ops.DatasetSource):
   """A dataset for one chunk file from a tf.data distributed snapshot."""
 
-  def __init__(self, chunk_file: str, element_spec: Any, compression: str):
+  def __init__(
+      self,
+      chunk_file: str,
+      element_spec: Any,
+      compression: str,
+      chunk_format: str = "TFRECORD"):
     self._chunk_file = chunk_file
     self._element_spec = element_spec
     variant_tensor = ged_ops.snapshot_chunk_dataset(
         chunk_file,
         compression=compression,
+        chunk_format=chunk_format,
         **self._flat_structure)
     super().__init__(variant_tensor)
 
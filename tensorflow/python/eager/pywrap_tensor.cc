@@ -29,6 +29,7 @@ limitations under the License.
 #include "pybind11/pybind11.h"  // from @pybind11
 #include "tensorflow/c/c_api.h"
 #include "tensorflow/c/eager/c_api.h"
+#include "tensorflow/c/eager/c_api_experimental.h"
 #include "tensorflow/c/eager/c_api_internal.h"
 #include "tensorflow/c/eager/tfe_context_internal.h"
 #include "tensorflow/c/eager/tfe_tensorhandle_internal.h"
@@ -709,6 +710,20 @@ static PyObject* EagerTensor_copy_to_device(EagerTensor* self, PyObject* args,
   return EagerTensorFromHandle(handle);
 }
 
+// Function `_prefetch_to_host`.
+// Starts copying the tensor to host memory, so that a later `_numpy_internal`
+// does not wait for the copy.
+static PyObject* EagerTensor_prefetch_to_host(EagerTensor* self) {
+  TFE_TensorHandlePrefetchToHost(self->handle, &self->status);
+  if (tensorflow::MaybeRaiseExceptionFromTFStatus(&self->status,
+                                                  PyExc_RuntimeError)) {
+    // Cleanup self->status before returning.
+    self->status.status = absl::OkStatus();
+    return nullptr;
+  }
+  Py_RETURN_NONE;
+}
+
 // Function `_numpy_internal`.
 // Convert an EagerTensor to a Python numpy.ndarray object.
 // The two may share underlying storage so changes to one may reflect in the
@@ -832,6 +847,9 @@ static PyMethodDef EagerTensor_methods[] = {
     {"_copy_to_device", (PyCFunction)EagerTensor_copy_to_device,
      METH_VARARGS | METH_KEYWORDS,
      PyDoc_STR("Copies the tensor to the desired device.")},
+    {"_prefetch_to_host", (PyCFunction)EagerTensor_prefetch_to_host,
+     METH_NOARGS,
+     PyDoc_STR("Starts copying the tensor to host memory in the background.")},
     {"_num_elements", (PyCFunction)EagerTensor_num_elements, METH_NOARGS,
      PyDoc_STR("Number of elements in the tensor.")},
     {"_prefer_custom_summarizer",
@@ -441,6 +441,20 @@ class TFETensorTest(test_util.TensorFlowTestCase):
     self.assertAllEqual(
         np.array(memoryview(t)), np.array([0.0], dtype=np.float32))
 
+  def testPrefetchToHost(self):
+    t = constant_op.constant([1.0, 2.0])
+    t._prefetch_to_host()
+    self.assertAllEqual(t.numpy(), [1.0, 2.0])
+
+  @test_util.run_gpu_only
+  def testPrefetchToHostFromGPU(self):
+    with ops.device("/device:GPU:0"):
+      t = constant_op.constant([1.0, 2.0]) * 2.0
+    t._prefetch_to_host()
+    # Prefetching again reuses the pending host copy.
+    t._prefetch_to_host()
+    self.assertAllEqual(t.numpy(), [2.0, 4.0])
+
   @test_util.disable_tfrt("b/169877776: ResourceVariable is not initialized "
                           "properly in TFRT")
   def testResourceTensorCopy(self):
@@ -166,6 +166,19 @@ class UniqueTest(test.TestCase):
     self.assertAllEqual(tf_y, true_y)
     self.assertAllEqual(tf_idx, true_idx)
 
+  def testLargeOrderedByAppearance(self):
+    # Large enough for the parallel CPU implementation.
+    for dtype in [np.int32, np.int64]:
+      x = np.random.randint(0, high=50000, size=200000).astype(dtype)
+      _, first, inverse = np.unique(x, return_index=True, return_inverse=True)
+      order = np.argsort(first)
+      true_y = x[np.sort(first)]
+      true_idx = np.argsort(order)[inverse.reshape(-1)]
+      y, idx = array_ops.unique(x)
+      tf_y, tf_idx = self.evaluate([y, idx])
+      self.assertAllEqual(tf_y, true_y)
+      self.assertAllEqual(tf_idx, true_idx)
+
 
 class UniqueWithCountsTest(test.TestCase):
 
@@ -313,6 +326,19 @@ class UniqueWithCountsTest(test.TestCase):
     self.assertAllEqual(tf_idx, true_idx)
     self.assertAllEqual(tf_count, true_count)
 
+  def testLargeString(self):
+    # Large enough for the parallel CPU implementation.
+    x = [str(i) for i in np.random.randint(0, high=20000, size=100000)]
+    _, first, counts = np.unique(x, return_index=True, return_counts=True)
+    order = np.argsort(first)
+    y, idx, count = array_ops.unique_with_counts(x)
+    tf_y, tf_idx, tf_count = self.evaluate([y, idx, count])
+    self.assertAllEqual([s.decode('ascii') for s in tf_y],
+                        [x[i] for i in np.sort(first)])
+    self.assertAllEqual(tf_count, counts[order])
+    for i in range(0, len(x), 997):
+      self.assertEqual(x[i], tf_y[tf_idx[i]].decode('ascii'))
+
 
 if __name__ == '__main__':
   test.main()
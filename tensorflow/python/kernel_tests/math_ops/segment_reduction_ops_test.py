@@ -730,6 +730,25 @@ class SparseSegmentReductionOpTest(SparseSegmentReductionHelper):
         tf_ans = self.evaluate(s)
         self.assertAllClose(np_ans, tf_ans)
 
+  def testManySegmentsWithHoles(self):
+    # Large enough to be split over several threads on CPU, with segments of
+    # very different sizes and gaps between them.
+    tf_x, np_x = self._input([1000, 64], dtype=dtypes_lib.float32)
+    segment_indices = []
+    for i in range(0, 600, 3):
+      segment_indices.extend([i] * (1 + (i * 7) % 50))
+    num_indices = len(segment_indices)
+    tf_indices = np.random.randint(0, 1000, num_indices).astype(np.int32)
+    ops_list = [(np.add, None, math_ops.sparse_segment_sum), (
+        self._mean_cum_op, self._mean_reduce_op, math_ops.sparse_segment_mean)]
+    with self.session():
+      for np_op1, np_op2, tf_op in ops_list:
+        np_ans = self._sparseSegmentReduce(np_x, tf_indices, segment_indices,
+                                           np_op1, np_op2)
+        s = tf_op(data=tf_x, indices=tf_indices, segment_ids=segment_indices)
+        tf_ans = self.evaluate(s)
+        self.assertAllClose(np_ans, tf_ans)
+
   def testWithNumSegments(self):
     tf_x, np_x = self._input([10, 4], dtype=dtypes_lib.float32)
     ops_list = [(np.add, None, math_ops.sparse_segment_sum_with_num_segments),
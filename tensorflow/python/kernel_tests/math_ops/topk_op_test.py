@@ -183,6 +183,18 @@ class TopKTest(test.TestCase):
     self._testMediumTopK(np.float16)
     self._testMediumTopK(dtypes.bfloat16.as_numpy_dtype)
 
+  def testLargeKWithTies(self):
+    # Large enough for radix selection, with repeated and signed values.
+    b = 3
+    n = 20000
+    for dtype in [np.float32, dtypes.bfloat16.as_numpy_dtype]:
+      for k in [200, 5000]:
+        inputs = np.random.randint(-100, 100, size=(b, n)).astype(dtype)
+        indices = np.argsort(-inputs, axis=1, kind="mergesort")[:, :k]
+        values = -np.sort(-inputs, axis=1)[:, :k]
+        self._validateTopK(inputs, k, values, indices)
+        self._validateTopK(inputs, k, values, indices, sorted=False)
+
   def testStableSort(self):
     b = 5
     n = 500
@@ -166,6 +166,18 @@ class StringSplitOpTest(test.TestCase, parameterized.TestCase):
       self.assertAllEqual(indices, [[0, 0], [1, 0], [2, 0]])
       self.assertAllEqual(shape, [3, 1])
 
+  def testLongTokensOutliveSplitOutput(self):
+    # Copies of tokens that don't fit inline in a tstring must stay valid after
+    # the output of the split is freed.
+    long_token = b"x" * 100
+    strings = [long_token + b" " + long_token[:50], b"short"]
+
+    with self.cached_session():
+      values = string_ops.string_split(strings).values
+      copied = array_ops.gather(values, [2, 1, 0])
+      self.assertAllEqual(
+          self.evaluate(copied), [b"short", long_token[:50], long_token])
+
   @parameterized.named_parameters([
       dict(
           testcase_name="RaggedResultType",
@@ -45,6 +45,13 @@ class StringToHashBucketOpTest(test.TestCase):
       # Fingerprint64('d') -> 4470636696479570465 -> mod 10 -> 5
       self.assertAllEqual([9, 2, 2, 5], result)
 
+  def testStringToHashBucketsFastLargeInput(self):
+    # Large enough to be sharded over the intra-op thread pool.
+    with self.cached_session():
+      input_string = constant_op.constant(['a', 'b', 'c', 'd'] * 25000)
+      output = string_ops.string_to_hash_bucket_fast(input_string, 10)
+      self.assertAllEqual([9, 2, 2, 5] * 25000, self.evaluate(output))
+
   @test_util.run_deprecated_v1
   def testStringToOneHashBucketLegacyHash(self):
     with self.cached_session():
@@ -19,6 +19,7 @@ import numpy as np
 
 from tensorflow.python.framework import errors_impl
 from tensorflow.python.framework import test_util
+from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import string_ops
 from tensorflow.python.platform import test
 
@@ -310,6 +311,38 @@ class SubstrOpTest(test.TestCase, parameterized.TestCase):
       substr = self.evaluate(substr_op)
       self.assertAllEqual(substr, expected_value)
 
+  @parameterized.parameters(np.int32, np.int64)
+  def testLongSubstrings(self, dtype):
+    # Substrings that don't fit inline in a tstring.
+    test_string = [b"a" * 100, b"short", b"0123456789" * 5, b""]
+    position = np.array([10, 1, 3, 0], dtype)
+    length = np.array([80, 3, 45, 5], dtype)
+    expected_value = [b"a" * 80, b"hor", (b"0123456789" * 5)[3:48], b""]
+    substr_op = string_ops.substr(test_string, position, length)
+    with self.cached_session():
+      self.assertAllEqual(self.evaluate(substr_op), expected_value)
+
+    # Broadcast pos/len onto input string
+    test_string = [[b"x" * 30 + b"y" * 30], [b"z" * 40 + b"w" * 20]]
+    position = np.array([0, 25, -30], dtype)
+    length = np.array([30, 10, 30], dtype)
+    expected_value = [[b"x" * 30, b"x" * 5 + b"y" * 5, b"y" * 30],
+                      [b"z" * 30, b"z" * 10, b"z" * 10 + b"w" * 20]]
+    substr_op = string_ops.substr(test_string, position, length)
+    with self.cached_session():
+      self.assertAllEqual(self.evaluate(substr_op), expected_value)
+
+  def testLongSubstringsOutliveOutput(self):
+    # Copies of long substrings must stay valid after the output of Substr is
+    # freed.
+    test_string = [b"a" * 100, b"0123456789" * 5]
+    substr_op = string_ops.substr(test_string, [10, 3], [80, 45])
+    copied = array_ops.gather(substr_op, [1, 0, 1])
+    expected_value = [(b"0123456789" * 5)[3:48], b"a" * 80,
+                      (b"0123456789" * 5)[3:48]]
+    with self.cached_session():
+      self.assertAllEqual(self.evaluate(copied), expected_value)
+
   @parameterized.parameters(
       (np.int32, "BYTE"),
       (np.int64, "BYTE"),
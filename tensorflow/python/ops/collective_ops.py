@@ -41,8 +41,10 @@ def all_reduce(t,
       independent subdivision should begin.  Use [0] if no subdivision should
       be done.
     communication_hint: preferred collective communication.  The implementation
-      may fall back to another mechanism.  Options include `auto`, `ring`, and
-      `nccl`.
+      may fall back to another mechanism.  Options include `auto`, `ring`,
+      `nccl`, and, for CPU devices, `hierarchical`, which reduces within each
+      task before reducing across tasks, and `bfloat16`, which sends float
+      values as bfloat16 while still accumulating in float.
     timeout: a float. If set to a non zero, set a completion timeout to detect
       staleness.  If the timer goes off, a DeadlineExceededError is raised.  The
       timeout value in seconds. This feature is experimental.
@@ -117,8 +119,10 @@ def all_reduce_v2(t,
     final_op: string naming the unary Op to be applied to each fully reduced
       value.  Can be 'Id' for no operation.
     communication_hint: preferred collective communication.  The implementation
-      may fall back to another mechanism.  Options include `auto`, `ring`, and
-      `nccl`.
+      may fall back to another mechanism.  Options include `auto`, `ring`,
+      `nccl`, and, for CPU devices, `hierarchical`, which reduces within each
+      task before reducing across tasks, and `bfloat16`, which sends float
+      values as bfloat16 while still accumulating in float.
     timeout: a float. If set to a non zero, set a completion timeout to detect
       staleness.  If the timer goes off, a DeadlineExceededError is raised.  The
       timeout value in seconds. This feature is experimental.
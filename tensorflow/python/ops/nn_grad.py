@@ -1121,3 +1121,19 @@ def _IsotonicRegressionGrad(op: ops.Operation, grad_output, grad_segments):
   del grad_segments  # Discrete, non-differentiable.
   segments = op.outputs[1]
   return _MeanAggregator(grad_output, segments)
+
+
+@ops.RegisterGradient("Dropout")
+def _DropoutGrad(op: ops.Operation, grad_output, grad_mask):
+  """The gradients for `Dropout`, from the mask of the forward op."""
+  del grad_mask  # Discrete, non-differentiable.
+  mask = op.outputs[1]
+  rate = op.inputs[1]
+  return gen_nn_ops.dropout_grad(grad_output, mask, rate), None, None
+
+
+@ops.RegisterGradient("DropoutGrad")
+def _DropoutGradGrad(op: ops.Operation, grad):
+  mask = op.inputs[1]
+  rate = op.inputs[2]
+  return gen_nn_ops.dropout_grad(grad, mask, rate), None, None
@@ -93,6 +93,14 @@ struct AllocatorStats {
   std::optional<int64_t> pool_bytes;
   std::optional<int64_t> peak_pool_bytes;
 
+  // Stats for allocators with a front cache of small allocations (e.g.
+  // BFCAllocator with `front_cache_max_chunk_bytes` set). The bytes of free
+  // chunks held by the front cache are included in `bytes_in_use`.
+  std::optional<int64_t> front_cache_bytes;   // Bytes of cached free chunks.
+  std::optional<int64_t> front_cache_hits;    // Allocations from the cache.
+  std::optional<int64_t> front_cache_misses;  // Cacheable allocations that
+                                              // had to use the bins.
+
   AllocatorStats()
       : num_allocs(0),
         bytes_in_use(0),
@@ -22,7 +22,9 @@ limitations under the License.
 
 #include "absl/strings/string_view.h"
 #include "tsl/framework/allocator_retry.h"
+#include "tsl/framework/metrics.h"
 #include "tsl/lib/core/bits.h"
+#include "tsl/platform/env_time.h"
 #include "tsl/platform/file_system.h"
 #include "tsl/platform/logging.h"
 #include "tsl/platform/mutex.h"
@@ -84,6 +86,17 @@ BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
       CHECK_NE(BinForSize(bin_size * 2), BinFromIndex(b));
     }
   }
+
+  if (opts.front_cache_max_chunk_bytes > 0) {
+    CHECK_GT(opts.front_cache_num_shards, 0);
+    CHECK_LE(opts.front_cache_max_chunk_bytes,
+             FrontCacheClassBytes(kNumFrontCacheSizeClasses - 1));
+    VLOG(1) << "Enabling front cache for chunks of up to "
+            << strings::HumanReadableNumBytes(opts.front_cache_max_chunk_bytes)
+            << " with " << opts.front_cache_num_shards << " shards";
+    front_cache_shards_ =
+        std::make_unique<FrontCacheShard[]>(opts.front_cache_num_shards);
+  }
 }
 
 BFCAllocator::~BFCAllocator() {
@@ -242,6 +255,8 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
   if (r != nullptr) {
     return r;
   } else {
+    // The memory returned by the callbacks wakes up the retries below.
+    RunOutOfMemoryCallbacks();
     static const int64_t kMaxMillisToWait = 10000;  // 10 seconds
     r = retry_helper_.AllocateRaw(
         [this, &allocation_attr](size_t a, size_t nb, bool v) {
@@ -259,6 +274,18 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
 void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
                                 const AllocationAttributes& allocation_attr) {
   VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes;
+  const int size_class = FrontCacheSizeClass(num_bytes, allocation_attr);
+  if (size_class >= 0) {
+    void* cached = FrontCacheAllocate(size_class);
+    if (cached != nullptr) {
+      VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes << " " << cached
+              << " (front cache)";
+      return cached;
+    }
+    // Allocate the full size class, so that the chunk can be reused for any
+    // allocation in the class once it is cached.
+    num_bytes = FrontCacheClassBytes(size_class);
+  }
   void* result = [&] {
     if (!opts_.allow_retry_on_failure || !allocation_attr.retry_on_failure) {
       // If we have globally disabled retry-on-failure and fail to allocate an
@@ -284,6 +311,11 @@ void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
       }
       void* res = AllocateRawInternal(unused_alignment, num_bytes,
                                       dump_log_on_failure, freed_by_count);
+      if (res == nullptr && RunOutOfMemoryCallbacks()) {
+        // Only the memory the callbacks returned right away is of use here.
+        res = AllocateRawInternal(unused_alignment, num_bytes,
+                                  dump_log_on_failure, freed_by_count);
+      }
       if (res == nullptr) {
         int32 counter_value = log_counter.load(std::memory_order_relaxed);
         if (counter_value < kMaxFailureLogs) {
@@ -305,6 +337,19 @@ void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
                                           allocation_attr);
     }
   }();
+  if (result == nullptr && FlushFrontCache() > 0) {
+    // Memory pressure: the chunks held by the front cache have been returned
+    // to the bins, so try once more.
+    uint64 freed_by_count = 0;
+    if (allocation_attr.freed_by_func != nullptr) {
+      freed_by_count = (*allocation_attr.freed_by_func)();
+    }
+    result = AllocateRawInternal(unused_alignment, num_bytes,
+                                 /*dump_log_on_failure=*/false, freed_by_count);
+  }
+  if (result != nullptr && size_class >= 0) {
+    FrontCacheRegister(result, size_class);
+  }
   VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes << " " << result;
   VLOG(4) << "[mem-debug] AllocateRaw," << Name() << "," << num_bytes << ","
           << result << "," << tsl::CurrentStackTrace();
@@ -327,27 +372,9 @@ bool BFCAllocator::DeallocateFreeRegions(size_t rounded_bytes)
     return false;
   }
 
-  // Searching for free regions.
-  absl::flat_hash_set<void*> free_region_ptrs;
   size_t total_free_bytes = 0;
-  for (const AllocationRegion& region : region_manager_.regions()) {
-    ChunkHandle h = region_manager_.get_handle(region.ptr());
-    bool any_use = false;
-    while (h != kInvalidChunkHandle) {
-      const Chunk* c = ChunkFromHandle(h);
-      if (c->in_use()) {
-        any_use = true;
-        break;
-      }
-      h = c->next;
-    }
-
-    if (!any_use) {
-      VLOG(2) << "Found free region with ptr = " << region.ptr();
-      free_region_ptrs.insert(region.ptr());
-      total_free_bytes += region.memory_size();
-    }
-  }
+  absl::flat_hash_set<void*> free_region_ptrs =
+      FindFreeRegions(&total_free_bytes);
 
   if (total_free_bytes == 0) {
     return false;
@@ -376,6 +403,31 @@ bool BFCAllocator::DeallocateFreeRegions(size_t rounded_bytes)
   return true;
 }
 
+absl::flat_hash_set<void*> BFCAllocator::FindFreeRegions(
+    size_t* total_bytes) {
+  absl::flat_hash_set<void*> free_region_ptrs;
+  *total_bytes = 0;
+  for (const AllocationRegion& region : region_manager_.regions()) {
+    ChunkHandle h = region_manager_.get_handle(region.ptr());
+    bool any_use = false;
+    while (h != kInvalidChunkHandle) {
+      const Chunk* c = ChunkFromHandle(h);
+      if (c->in_use()) {
+        any_use = true;
+        break;
+      }
+      h = c->next;
+    }
+
+    if (!any_use) {
+      VLOG(2) << "Found free region with ptr = " << region.ptr();
+      free_region_ptrs.insert(region.ptr());
+      *total_bytes += region.memory_size();
+    }
+  }
+  return free_region_ptrs;
+}
+
 void BFCAllocator::DeallocateRegions(
     const absl::flat_hash_set<void*>& region_ptrs)
     TF_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
@@ -512,6 +564,96 @@ double BFCAllocator::GetFragmentation() {
          bytes_available;
 }
 
+BFCAllocator::FreeMemoryStats BFCAllocator::GetFreeMemoryStats() {
+  mutex_lock l(lock_);
+  return GetFreeMemoryStatsLocked();
+}
+
+BFCAllocator::FreeMemoryStats BFCAllocator::GetFreeMemoryStatsLocked() {
+  FreeMemoryStats stats;
+  stats.bin_free_bytes.resize(kNumBins);
+  stats.bin_free_chunks.resize(kNumBins);
+  for (BinNum b = 0; b < kNumBins; b++) {
+    for (ChunkHandle h : BinFromIndex(b)->free_chunks) {
+      stats.bin_free_bytes[b] += ChunkFromHandle(h)->size;
+    }
+    stats.bin_free_chunks[b] = BinFromIndex(b)->free_chunks.size();
+    stats.free_bytes += stats.bin_free_bytes[b];
+  }
+  stats.largest_free_chunk_bytes = LargestFreeChunk();
+  if (stats.free_bytes > 0) {
+    stats.fragmentation =
+        static_cast<double>(stats.free_bytes - stats.largest_free_chunk_bytes) /
+        stats.free_bytes;
+  }
+  return stats;
+}
+
+void BFCAllocator::MaybeUpdateFreeMemoryMetrics(bool force) {
+  const uint64 now_micros = EnvTime::NowMicros();
+  if (!force && now_micros < next_free_memory_metrics_micros_) return;
+  next_free_memory_metrics_micros_ =
+      now_micros + kFreeMemoryMetricsIntervalMicros;
+  const FreeMemoryStats stats = GetFreeMemoryStatsLocked();
+  metrics::UpdateBfcAllocatorFreeMemory(
+      name_, stats.largest_free_chunk_bytes, stats.fragmentation,
+      stats.bin_free_bytes, stats.bin_free_chunks);
+}
+
+size_t BFCAllocator::Compact(int peak_window) {
+  FlushFrontCache();
+  mutex_lock l(lock_);
+  if (!timestamped_chunks_.empty()) {
+    MergeTimestampedChunks(0);
+  }
+  // The memory to keep is the peak memory in use over the window.
+  compaction_peak_bytes_in_use_.push_back(peak_bytes_in_use_since_compaction_);
+  peak_bytes_in_use_since_compaction_ = stats_.bytes_in_use;
+  while (compaction_peak_bytes_in_use_.size() >
+         static_cast<size_t>(std::max(peak_window, 0))) {
+    compaction_peak_bytes_in_use_.pop_front();
+  }
+  int64_t keep_bytes = 0;
+  for (int64_t peak_bytes_in_use : compaction_peak_bytes_in_use_) {
+    keep_bytes = std::max(keep_bytes, peak_bytes_in_use);
+  }
+
+  size_t released_bytes = 0;
+  // The timestamped chunks that are not safe yet may still be in use by the
+  // device, so their regions are kept.
+  if (opts_.allow_growth && timestamped_chunks_.empty()) {
+    size_t free_bytes = 0;
+    absl::flat_hash_set<void*> free_region_ptrs = FindFreeRegions(&free_bytes);
+    // Release the largest free regions first, as long as the rest of the pool
+    // can still hold `keep_bytes`.
+    std::vector<const AllocationRegion*> free_regions;
+    for (void* ptr : free_region_ptrs) {
+      free_regions.push_back(region_manager_.RegionFor(ptr));
+    }
+    std::sort(free_regions.begin(), free_regions.end(),
+              [](const AllocationRegion* a, const AllocationRegion* b) {
+                return a->memory_size() > b->memory_size();
+              });
+    absl::flat_hash_set<void*> released_region_ptrs;
+    for (const AllocationRegion* region : free_regions) {
+      if (*stats_.pool_bytes - static_cast<int64_t>(released_bytes +
+                                                    region->memory_size()) <
+          keep_bytes) {
+        continue;
+      }
+      released_region_ptrs.insert(region->ptr());
+      released_bytes += region->memory_size();
+    }
+    if (!released_region_ptrs.empty()) {
+      VLOG(1) << "Returning " << strings::HumanReadableNumBytes(released_bytes)
+              << " of free regions of " << Name() << " to the sub allocator";
+      DeallocateRegions(released_region_ptrs);
+    }
+  }
+  MaybeUpdateFreeMemoryMetrics(/*force=*/true);
+  return released_bytes;
+}
+
 void BFCAllocator::AddTraceMe(absl::string_view traceme_name, const void* ptr) {
   BFCAllocator::Chunk* chunk = ChunkFromHandle(region_manager_.get_handle(ptr));
   AddTraceMe(traceme_name, chunk->ptr, chunk->requested_size, chunk->size);
@@ -547,6 +689,8 @@ void BFCAllocator::AddTraceMe(absl::string_view traceme_name,
                                {"id", annotation.pending_step_id},
                                {"region_type", region_type},
                                {"data_type", annotation.pending_data_type},
+                               {"output_index",
+                                annotation.pending_output_index},
                                {"shape", annotation.pending_shape_func()}});
           },
       /*level=*/tsl::profiler::TraceMeLevel::kInfo);
@@ -604,6 +748,8 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
         }
         stats_.peak_bytes_in_use =
             std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
+        peak_bytes_in_use_since_compaction_ = std::max(
+            peak_bytes_in_use_since_compaction_, stats_.bytes_in_use);
         stats_.largest_alloc_size =
             std::max<std::size_t>(stats_.largest_alloc_size, chunk->size);
 
@@ -684,10 +830,132 @@ void BFCAllocator::DeallocateRaw(void* ptr) {
   VLOG(4) << "[mem-debug] DeallocateRaw," << Name() << ","
           << (ptr ? RequestedSize(ptr) : 0) << "," << ptr << ","
           << tsl::CurrentStackTrace();
+  if (ptr != nullptr && FrontCacheDeallocate(ptr)) {
+    return;
+  }
   DeallocateRawInternal(ptr);
   retry_helper_.NotifyDealloc();
 }
 
+int BFCAllocator::FrontCacheSizeClass(
+    size_t num_bytes, const AllocationAttributes& allocation_attr) const {
+  if (front_cache_shards_ == nullptr || num_bytes == 0 ||
+      num_bytes > opts_.front_cache_max_chunk_bytes ||
+      allocation_attr.freed_by_func != nullptr || timing_counter_ != nullptr) {
+    return -1;
+  }
+  return Log2Ceiling64(RoundedBytes(num_bytes) >> kMinAllocationBits);
+}
+
+void* BFCAllocator::FrontCacheAllocate(int size_class) {
+  static std::atomic<uint32> next_thread_shard{0};
+  thread_local const uint32 thread_shard =
+      next_thread_shard.fetch_add(1, std::memory_order_relaxed);
+  FrontCacheShard& shard =
+      front_cache_shards_[thread_shard % opts_.front_cache_num_shards];
+  {
+    mutex_lock l(shard.mu);
+    std::vector<void*>& free_chunks = shard.free_chunks[size_class];
+    if (!free_chunks.empty()) {
+      void* ptr = free_chunks.back();
+      free_chunks.pop_back();
+      shard.free_bytes -= FrontCacheClassBytes(size_class);
+      front_cache_hits_.fetch_add(1, std::memory_order_relaxed);
+      return ptr;
+    }
+  }
+  front_cache_misses_.fetch_add(1, std::memory_order_relaxed);
+  return nullptr;
+}
+
+namespace {
+// Returns the front cache shard that owns `ptr`.
+size_t FrontCacheShardIndex(const void* ptr, int num_shards) {
+  // Chunks are at least kMinAllocationSize-aligned, so drop the low bits.
+  return (reinterpret_cast<std::uintptr_t>(ptr) >> 8) % num_shards;
+}
+}  // namespace
+
+void BFCAllocator::FrontCacheRegister(void* ptr, int size_class) {
+  FrontCacheShard& shard = front_cache_shards_[FrontCacheShardIndex(
+      ptr, opts_.front_cache_num_shards)];
+  mutex_lock l(shard.mu);
+  shard.size_classes[ptr] = size_class;
+}
+
+bool BFCAllocator::FrontCacheDeallocate(void* ptr) {
+  if (front_cache_shards_ == nullptr) return false;
+  FrontCacheShard& shard = front_cache_shards_[FrontCacheShardIndex(
+      ptr, opts_.front_cache_num_shards)];
+  {
+    mutex_lock l(shard.mu);
+    auto it = shard.size_classes.find(ptr);
+    if (it == shard.size_classes.end()) return false;
+    const size_t class_bytes = FrontCacheClassBytes(it->second);
+    if (shard.free_bytes + class_bytes <=
+        opts_.front_cache_max_bytes_per_shard) {
+      shard.free_chunks[it->second].push_back(ptr);
+      shard.free_bytes += class_bytes;
+      return true;
+    }
+    // The shard is full: return the chunk to the bins.
+    shard.size_classes.erase(it);
+  }
+  DeallocateRawInternal(ptr);
+  retry_helper_.NotifyDealloc();
+  return true;
+}
+
+void BFCAllocator::AddOutOfMemoryCallback(std::function<void()> callback) {
+  mutex_lock l(oom_callbacks_mu_);
+  oom_callbacks_.push_back(std::move(callback));
+}
+
+bool BFCAllocator::RunOutOfMemoryCallbacks() {
+  std::vector<std::function<void()>> callbacks;
+  {
+    mutex_lock l(oom_callbacks_mu_);
+    callbacks = oom_callbacks_;
+  }
+  for (const std::function<void()>& callback : callbacks) {
+    callback();
+  }
+  return !callbacks.empty();
+}
+
+size_t BFCAllocator::FlushFrontCache() {
+  if (front_cache_shards_ == nullptr) return 0;
+  size_t flushed_bytes = 0;
+  std::vector<void*> flushed;
+  for (int i = 0; i < opts_.front_cache_num_shards; ++i) {
+    FrontCacheShard& shard = front_cache_shards_[i];
+    // Collect the chunks first, so that `lock_` is never acquired while a
+    // shard lock is held.
+    {
+      mutex_lock l(shard.mu);
+      for (std::vector<void*>& free_chunks : shard.free_chunks) {
+        for (void* ptr : free_chunks) {
+          shard.size_classes.erase(ptr);
+          flushed.push_back(ptr);
+        }
+        free_chunks.clear();
+      }
+      flushed_bytes += shard.free_bytes;
+      shard.free_bytes = 0;
+    }
+    for (void* ptr : flushed) {
+      DeallocateRawInternal(ptr);
+    }
+    flushed.clear();
+  }
+  if (flushed_bytes > 0) {
+    VLOG(1) << "Flushed " << strings::HumanReadableNumBytes(flushed_bytes)
+            << " from the front cache of " << Name();
+    retry_helper_.NotifyDealloc();
+  }
+  return flushed_bytes;
+}
+
 void BFCAllocator::DeallocateRawInternal(void* ptr) {
   if (ptr == nullptr) {
     VLOG(2) << "tried to deallocate nullptr";
@@ -718,6 +986,8 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
   // correct aggregation stats (bytes_in_use, fragmentation).
   AddTraceMe("MemoryDeallocation", chunk_ptr, req_bytes, alloc_bytes);
 
+  MaybeUpdateFreeMemoryMetrics(/*force=*/false);
+
   if (VLOG_IS_ON(4)) {
     LOG(INFO) << "F: " << RenderOccupancy();
   }
@@ -1206,11 +1476,28 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 }
 
 absl::optional<AllocatorStats> BFCAllocator::GetStats() {
-  mutex_lock l(lock_);
-  return stats_;
+  AllocatorStats stats;
+  {
+    mutex_lock l(lock_);
+    stats = stats_;
+  }
+  if (front_cache_shards_ != nullptr) {
+    int64_t front_cache_bytes = 0;
+    for (int i = 0; i < opts_.front_cache_num_shards; ++i) {
+      mutex_lock l(front_cache_shards_[i].mu);
+      front_cache_bytes += front_cache_shards_[i].free_bytes;
+    }
+    stats.front_cache_bytes = front_cache_bytes;
+    stats.front_cache_hits = front_cache_hits_.load(std::memory_order_relaxed);
+    stats.front_cache_misses =
+        front_cache_misses_.load(std::memory_order_relaxed);
+  }
+  return stats;
 }
 
 bool BFCAllocator::ClearStats() {
+  front_cache_hits_.store(0, std::memory_order_relaxed);
+  front_cache_misses_.store(0, std::memory_order_relaxed);
   mutex_lock l(lock_);
   stats_.num_allocs = 0;
   stats_.peak_bytes_in_use = stats_.bytes_in_use;
@@ -18,11 +18,13 @@ limitations under the License.
 
 #include <array>
 #include <deque>
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "tsl/framework/allocator.h"
 #include "tsl/framework/allocator_retry.h"
@@ -69,6 +71,24 @@ class BFCAllocator : public Allocator {
     // Controls when a chunk should be split, if its size exceeds the requested
     // allocation size.
     double fragmentation_fraction = 0;
+
+    // If greater than zero, allocations of at most this many bytes are served
+    // from a sharded front cache of power-of-two size classes, so that most
+    // small allocations and deallocations do not take the allocator-wide lock.
+    // Chunks in the front cache remain allocated from the point of view of the
+    // bins. They are returned to the bins when a shard is full, or when an
+    // allocation cannot be satisfied otherwise.
+    //
+    // The front cache is bypassed for allocations with a `freed_by_func`, and
+    // when a timing counter has been set.
+    size_t front_cache_max_chunk_bytes = 0;
+
+    // The number of front cache shards. Allocating threads are assigned to
+    // shards round-robin, and freed chunks go to a shard chosen by address.
+    int front_cache_num_shards = 16;
+
+    // The maximum number of bytes of free chunks held by one front cache shard.
+    size_t front_cache_max_bytes_per_shard = 4 << 20;
   };
   BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator, size_t total_memory,
                const string& name, const Options& opts);
@@ -108,6 +128,37 @@ class BFCAllocator : public Allocator {
 
   MemoryDump RecordMemoryMap();
 
+  // A snapshot of the free memory of the allocator.
+  struct FreeMemoryStats {
+    // The bytes of the free chunks in the bins.
+    int64_t free_bytes = 0;
+    int64_t largest_free_chunk_bytes = 0;
+    // The fraction of `free_bytes` that is outside of the largest free chunk.
+    double fragmentation = 0;
+    // The bytes and number of free chunks of each bin.
+    std::vector<int64_t> bin_free_bytes;
+    std::vector<int64_t> bin_free_chunks;
+  };
+  FreeMemoryStats GetFreeMemoryStats();
+
+  // Returns the chunks of the front cache to the bins, where they coalesce
+  // with their free neighbors, and merges the timestamped chunks that are safe
+  // to reuse. If allow_growth is set, the regions left without any chunk in
+  // use are then returned to the sub allocator, except for enough of them to
+  // hold the peak memory in use between each of the last `peak_window` pairs
+  // of calls, so that the memory that the next step would allocate again is
+  // kept. Meant to be called at step boundaries, when little memory is in use.
+  // Returns the number of bytes returned to the sub allocator.
+  size_t Compact(int peak_window = 0);
+
+  // Adds a callback that is run when an allocation cannot be satisfied, before
+  // the allocation waits for memory to be freed or fails. It is meant for the
+  // owners of caches of memory allocated from this allocator: the callback
+  // should start returning that memory through DeallocateRaw(), right away or
+  // asynchronously, and must not allocate from this allocator. Callbacks are
+  // never removed.
+  void AddOutOfMemoryCallback(std::function<void()> callback);
+
  private:
   struct Bin;
 
@@ -121,6 +172,37 @@ class BFCAllocator : public Allocator {
 
   void DeallocateRawInternal(void* ptr);
 
+  // Returns the front cache size class for an allocation of `num_bytes`, or -1
+  // if the allocation must bypass the front cache.
+  int FrontCacheSizeClass(size_t num_bytes,
+                          const AllocationAttributes& allocation_attr) const;
+
+  // Returns the number of bytes of a chunk in the given size class.
+  static size_t FrontCacheClassBytes(int size_class) {
+    return kMinAllocationSize << size_class;
+  }
+
+  // Returns a cached free chunk of the given size class, or nullptr if the
+  // calling thread's shard has none.
+  void* FrontCacheAllocate(int size_class);
+
+  // Records that `ptr`, which was just allocated from the bins, belongs to the
+  // front cache.
+  void FrontCacheRegister(void* ptr, int size_class);
+
+  // Takes back `ptr` if it belongs to the front cache, either caching it or
+  // returning it to the bins. Returns false if `ptr` must be deallocated by
+  // the caller.
+  bool FrontCacheDeallocate(void* ptr);
+
+  // Returns every free chunk held by the front cache to the bins. Returns the
+  // number of bytes released.
+  size_t FlushFrontCache();
+
+  // Runs the callbacks added with AddOutOfMemoryCallback(). Returns false if
+  // there are none.
+  bool RunOutOfMemoryCallbacks();
+
   // Chunks whose freed_at_count is later than the safe frontier value are kept
   // on a special list and not subject to merging immediately upon being freed.
   //
@@ -278,6 +360,24 @@ class BFCAllocator : public Allocator {
   static constexpr size_t kMinAllocationBits = 8;
   static constexpr size_t kMinAllocationSize = 1 << kMinAllocationBits;
 
+  // The front cache has size classes of 256B, 512B, ..., 1MiB.
+  static constexpr int kNumFrontCacheSizeClasses = 13;
+
+  // A shard of the front cache.
+  //
+  // Aligned to avoid false sharing between the mutexes of different shards.
+  struct alignas(64) FrontCacheShard {
+    mutex mu;
+    // The size class of every chunk that hashes to this shard and belongs to
+    // the front cache, whether it is free or handed out to a user.
+    absl::flat_hash_map<const void*, int> size_classes TF_GUARDED_BY(mu);
+    // Free chunks, indexed by size class.
+    std::array<std::vector<void*>, kNumFrontCacheSizeClasses> free_chunks
+        TF_GUARDED_BY(mu);
+    // Total bytes of the chunks in `free_chunks`.
+    size_t free_bytes TF_GUARDED_BY(mu) = 0;
+  };
+
   // BFCAllocator allocates memory into a collection of disjoint
   // AllocationRegions.  Each AllocationRegion corresponds to one call to
   // SubAllocator::Alloc().  (Actually, if a subsequent call to
@@ -463,6 +563,11 @@ class BFCAllocator : public Allocator {
   // found and freed; false otherwise.
   bool DeallocateFreeRegions(size_t rounded_bytes);
 
+  // Returns the regions without any chunk in use, and sets `*total_bytes` to
+  // their total size.
+  absl::flat_hash_set<void*> FindFreeRegions(size_t* total_bytes)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Helper function to deallocate regions.
   void DeallocateRegions(const absl::flat_hash_set<void*>& region_ptrs)
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
@@ -519,6 +624,14 @@ class BFCAllocator : public Allocator {
   // size over total free memory, and returns a value within [0, 1].
   double GetFragmentation() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  FreeMemoryStats GetFreeMemoryStatsLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Exports the free memory stats as tsl::metrics, at most once per
+  // kFreeMemoryMetricsIntervalMicros unless `force` is set.
+  void MaybeUpdateFreeMemoryMetrics(bool force)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  static constexpr uint64 kFreeMemoryMetricsIntervalMicros = 1000 * 1000;
+
   // Information about a Bin that is useful for debugging.
   struct BinDebugInfo {
     size_t total_bytes_in_use = 0;
@@ -572,6 +685,15 @@ class BFCAllocator : public Allocator {
 
   std::atomic<uint64> safe_frontier_ = {0};
 
+  // Null if the front cache is disabled.
+  std::unique_ptr<FrontCacheShard[]> front_cache_shards_;
+  std::atomic<int64_t> front_cache_hits_{0};
+  std::atomic<int64_t> front_cache_misses_{0};
+
+  mutex oom_callbacks_mu_;
+  std::vector<std::function<void()>> oom_callbacks_
+      TF_GUARDED_BY(oom_callbacks_mu_);
+
   // Structures mutable after construction
   mutable mutex lock_;
   RegionManager region_manager_ TF_GUARDED_BY(lock_);
@@ -587,6 +709,11 @@ class BFCAllocator : public Allocator {
 
   // Stats.
   AllocatorStats stats_ TF_GUARDED_BY(lock_);
+  uint64 next_free_memory_metrics_micros_ TF_GUARDED_BY(lock_) = 0;
+  // The peak of stats_.bytes_in_use since the last Compact() call, and the
+  // peaks between the last calls, most recent last.
+  int64_t peak_bytes_in_use_since_compaction_ TF_GUARDED_BY(lock_) = 0;
+  std::deque<int64_t> compaction_peak_bytes_in_use_ TF_GUARDED_BY(lock_);
 #ifdef TENSORFLOW_MEM_DEBUG
   int64 action_counter_ TF_GUARDED_BY(lock_) = 0;
 #define MEM_DEBUG_SIZE_HISTORY_SIZE 4096
@@ -0,0 +1,276 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/framework/bfc_allocator.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "tsl/platform/env.h"
+#include "tsl/platform/mem.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/threadpool.h"
+
+namespace tsl {
+namespace {
+
+class AlignedSubAllocator : public SubAllocator {
+ public:
+  AlignedSubAllocator() : SubAllocator({}, {}) {}
+
+  void* Alloc(size_t alignment, size_t num_bytes,
+              size_t* bytes_received) override {
+    *bytes_received = num_bytes;
+    return port::AlignedMalloc(num_bytes, Allocator::kAllocatorAlignment);
+  }
+  void Free(void* ptr, size_t num_bytes) override { port::AlignedFree(ptr); }
+  bool SupportsCoalescing() const override { return false; }
+};
+
+std::unique_ptr<BFCAllocator> NewAllocator(size_t total_memory,
+                                           size_t front_cache_max_chunk_bytes) {
+  BFCAllocator::Options opts;
+  opts.allow_retry_on_failure = false;
+  opts.front_cache_max_chunk_bytes = front_cache_max_chunk_bytes;
+  return std::make_unique<BFCAllocator>(
+      std::make_unique<AlignedSubAllocator>(), total_memory, "test_bfc", opts);
+}
+
+TEST(BFCAllocatorTest, FrontCacheDisabledByDefault) {
+  auto a = NewAllocator(1 << 20, /*front_cache_max_chunk_bytes=*/0);
+  void* p = a->AllocateRaw(64, 1024);
+  ASSERT_NE(p, nullptr);
+  a->DeallocateRaw(p);
+  AllocatorStats stats = *a->GetStats();
+  EXPECT_FALSE(stats.front_cache_bytes.has_value());
+  EXPECT_EQ(0, stats.bytes_in_use);
+}
+
+TEST(BFCAllocatorTest, FrontCacheReusesChunks) {
+  auto a = NewAllocator(1 << 20, /*front_cache_max_chunk_bytes=*/4096);
+  void* p = a->AllocateRaw(64, 1000);
+  ASSERT_NE(p, nullptr);
+  // Rounded up to the 1KiB size class.
+  EXPECT_EQ(1024, a->AllocatedSize(p));
+  a->DeallocateRaw(p);
+
+  AllocatorStats stats = *a->GetStats();
+  EXPECT_EQ(1024, *stats.front_cache_bytes);
+  EXPECT_EQ(0, *stats.front_cache_hits);
+  EXPECT_EQ(1, *stats.front_cache_misses);
+  // Cached chunks are still in use from the point of view of the bins.
+  EXPECT_EQ(1024, stats.bytes_in_use);
+
+  // Any allocation in the same size class is served from the cache.
+  void* q = a->AllocateRaw(64, 900);
+  EXPECT_EQ(p, q);
+  stats = *a->GetStats();
+  EXPECT_EQ(0, *stats.front_cache_bytes);
+  EXPECT_EQ(1, *stats.front_cache_hits);
+  a->DeallocateRaw(q);
+}
+
+TEST(BFCAllocatorTest, FrontCacheBypassesLargeAllocations) {
+  auto a = NewAllocator(1 << 20, /*front_cache_max_chunk_bytes=*/4096);
+  void* p = a->AllocateRaw(64, 8192);
+  ASSERT_NE(p, nullptr);
+  a->DeallocateRaw(p);
+  AllocatorStats stats = *a->GetStats();
+  EXPECT_EQ(0, *stats.front_cache_bytes);
+  EXPECT_EQ(0, *stats.front_cache_misses);
+  EXPECT_EQ(0, stats.bytes_in_use);
+}
+
+TEST(BFCAllocatorTest, FrontCacheFlushesUnderMemoryPressure) {
+  auto a = NewAllocator(64 << 10, /*front_cache_max_chunk_bytes=*/4096);
+  // Fill the cache with most of the memory.
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 12; ++i) {
+    ptrs.push_back(a->AllocateRaw(64, 4096));
+    ASSERT_NE(ptrs.back(), nullptr);
+  }
+  for (void* p : ptrs) a->DeallocateRaw(p);
+  EXPECT_EQ(12 * 4096, *a->GetStats()->front_cache_bytes);
+
+  // A large allocation can only succeed once the cache has been flushed.
+  void* large = a->AllocateRaw(64, 32 << 10);
+  ASSERT_NE(large, nullptr);
+  EXPECT_EQ(0, *a->GetStats()->front_cache_bytes);
+  a->DeallocateRaw(large);
+  EXPECT_EQ(0, a->GetStats()->bytes_in_use);
+}
+
+TEST(BFCAllocatorTest, FrontCacheConcurrentAllocations) {
+  auto a = NewAllocator(64 << 20, /*front_cache_max_chunk_bytes=*/64 << 10);
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 8);
+    for (int t = 0; t < 8; ++t) {
+      pool.Schedule([&a, t]() {
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 1000; ++i) {
+          const size_t num_bytes = 256 * (1 + (i + t) % 64);
+          void* p = a->AllocateRaw(64, num_bytes);
+          CHECK(p != nullptr);
+          memset(p, t, num_bytes);
+          ptrs.push_back(p);
+          if (ptrs.size() > 16) {
+            a->DeallocateRaw(ptrs.front());
+            ptrs.erase(ptrs.begin());
+          }
+        }
+        for (void* p : ptrs) a->DeallocateRaw(p);
+      });
+    }
+  }
+  AllocatorStats stats = *a->GetStats();
+  EXPECT_GT(*stats.front_cache_hits, 0);
+  EXPECT_EQ(stats.bytes_in_use, *stats.front_cache_bytes);
+}
+
+TEST(BFCAllocatorTest, FreeMemoryStats) {
+  auto a = NewAllocator(1 << 20, /*front_cache_max_chunk_bytes=*/0);
+  void* p = a->AllocateRaw(64, 1024);
+  void* q = a->AllocateRaw(64, 1024);
+  ASSERT_NE(p, nullptr);
+  ASSERT_NE(q, nullptr);
+  // Leaves a free chunk of 1KiB before `q`, and the rest of the region after.
+  a->DeallocateRaw(p);
+
+  BFCAllocator::FreeMemoryStats stats = a->GetFreeMemoryStats();
+  int64_t free_chunks = 0;
+  int64_t free_bytes = 0;
+  for (size_t i = 0; i < stats.bin_free_chunks.size(); ++i) {
+    free_chunks += stats.bin_free_chunks[i];
+    free_bytes += stats.bin_free_bytes[i];
+  }
+  EXPECT_EQ(2, free_chunks);
+  EXPECT_EQ(stats.free_bytes, free_bytes);
+  EXPECT_EQ(*a->GetStats()->pool_bytes - 1024, stats.free_bytes);
+  EXPECT_EQ(stats.free_bytes - 1024, stats.largest_free_chunk_bytes);
+  EXPECT_DOUBLE_EQ(1024.0 / stats.free_bytes, stats.fragmentation);
+
+  a->DeallocateRaw(q);
+  stats = a->GetFreeMemoryStats();
+  EXPECT_EQ(stats.free_bytes, stats.largest_free_chunk_bytes);
+  EXPECT_EQ(0, stats.fragmentation);
+}
+
+TEST(BFCAllocatorTest, CompactReturnsFreeRegions) {
+  auto a = NewAllocator(1 << 20, /*front_cache_max_chunk_bytes=*/4096);
+  void* p = a->AllocateRaw(64, 1024);
+  ASSERT_NE(p, nullptr);
+  a->DeallocateRaw(p);
+  const int64_t pool_bytes = *a->GetStats()->pool_bytes;
+  EXPECT_GT(pool_bytes, 0);
+  EXPECT_EQ(1024, *a->GetStats()->front_cache_bytes);
+
+  // The cached chunk goes back to the bins, leaving the region unused.
+  EXPECT_EQ(static_cast<size_t>(pool_bytes), a->Compact());
+  AllocatorStats stats = *a->GetStats();
+  EXPECT_EQ(0, *stats.pool_bytes);
+  EXPECT_EQ(0, *stats.front_cache_bytes);
+  EXPECT_EQ(0, stats.bytes_in_use);
+
+  // The allocator grows again when needed.
+  p = a->AllocateRaw(64, 1024);
+  ASSERT_NE(p, nullptr);
+  a->DeallocateRaw(p);
+}
+
+TEST(BFCAllocatorTest, CompactKeepsRegionsForRecentPeakMemoryInUse) {
+  auto a = NewAllocator(1 << 20, /*front_cache_max_chunk_bytes=*/0);
+  // One step allocates and frees the same memory.
+  auto run_step = [&a]() {
+    void* p = a->AllocateRaw(64, 1024);
+    ASSERT_NE(p, nullptr);
+    a->DeallocateRaw(p);
+  };
+  run_step();
+  const int64_t pool_bytes = *a->GetStats()->pool_bytes;
+
+  // As long as steps keep allocating the memory, it is kept.
+  EXPECT_EQ(size_t{0}, a->Compact(/*peak_window=*/2));
+  run_step();
+  EXPECT_EQ(size_t{0}, a->Compact(/*peak_window=*/2));
+  EXPECT_EQ(pool_bytes, *a->GetStats()->pool_bytes);
+
+  // It is released once no step of the window allocated it.
+  EXPECT_EQ(size_t{0}, a->Compact(/*peak_window=*/2));
+  EXPECT_EQ(static_cast<size_t>(pool_bytes),
+            a->Compact(/*peak_window=*/2));
+  EXPECT_EQ(0, *a->GetStats()->pool_bytes);
+}
+
+TEST(BFCAllocatorTest, CompactKeepsRegionsInUse) {
+  auto a = NewAllocator(1 << 20, /*front_cache_max_chunk_bytes=*/0);
+  void* p = a->AllocateRaw(64, 1024);
+  ASSERT_NE(p, nullptr);
+  const int64_t pool_bytes = *a->GetStats()->pool_bytes;
+  EXPECT_EQ(size_t{0}, a->Compact());
+  EXPECT_EQ(pool_bytes, *a->GetStats()->pool_bytes);
+  a->DeallocateRaw(p);
+}
+
+TEST(BFCAllocatorTest, OutOfMemoryCallbackReturnsMemory) {
+  auto a = NewAllocator(64 << 10, /*front_cache_max_chunk_bytes=*/0);
+  void* held = a->AllocateRaw(64, 48 << 10);
+  ASSERT_NE(held, nullptr);
+  int num_calls = 0;
+  a->AddOutOfMemoryCallback([&] {
+    ++num_calls;
+    if (held != nullptr) a->DeallocateRaw(held);
+    held = nullptr;
+  });
+
+  // Fits without the held memory, so the callback is not run.
+  void* p = a->AllocateRaw(64, 8 << 10);
+  ASSERT_NE(p, nullptr);
+  EXPECT_EQ(0, num_calls);
+  a->DeallocateRaw(p);
+
+  // Only fits once the callback has returned the held memory.
+  p = a->AllocateRaw(64, 32 << 10);
+  ASSERT_NE(p, nullptr);
+  EXPECT_EQ(1, num_calls);
+  a->DeallocateRaw(p);
+}
+
+TEST(BFCAllocatorTest, RetryWaitsForMemoryReturnedByOutOfMemoryCallback) {
+  BFCAllocator::Options opts;
+  opts.allow_retry_on_failure = true;
+  BFCAllocator a(std::make_unique<AlignedSubAllocator>(), 64 << 10,
+                 "test_bfc", opts);
+  void* held = a.AllocateRaw(64, 48 << 10);
+  ASSERT_NE(held, nullptr);
+  std::unique_ptr<Thread> returner;
+  a.AddOutOfMemoryCallback([&] {
+    if (returner != nullptr) return;
+    // Return the memory later, the way a cache ordered after pending work
+    // would.
+    returner.reset(Env::Default()->StartThread({}, "returner", [&] {
+      Env::Default()->SleepForMicroseconds(10 * 1000);
+      a.DeallocateRaw(held);
+    }));
+  });
+
+  void* p = a.AllocateRaw(64, 32 << 10);
+  ASSERT_NE(p, nullptr);
+  a.DeallocateRaw(p);
+  returner.reset();
+}
+
+}  // namespace
+}  // namespace tsl
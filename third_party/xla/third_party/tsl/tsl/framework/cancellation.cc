@@ -16,8 +16,9 @@ limitations under the License.
 #include "tsl/framework/cancellation.h"
 
 #include <forward_list>
+#include <utility>
+#include <vector>
 
-#include "absl/memory/memory.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/logging.h"
 #include "tsl/platform/status.h"
@@ -42,38 +43,56 @@ void CancellationManager::StartCancel() {
   StartCancelWithStatus(OkStatus());
 }
 
+CancellationManager::State* CancellationManager::GetOrCreateState() {
+  State* state = state_.load(std::memory_order_acquire);
+  if (state != nullptr) return state;
+  auto new_state = std::make_unique<State>();
+  if (state_.compare_exchange_strong(state, new_state.get(),
+                                     std::memory_order_acq_rel,
+                                     std::memory_order_acquire)) {
+    return new_state.release();
+  }
+  // Another thread allocated the state first.
+  return state;
+}
+
 void CancellationManager::StartCancelWithStatus(const Status& status) {
-  gtl::FlatMap<CancellationToken, CallbackConfiguration> callbacks_to_run;
+  std::vector<CallbackConfiguration> callbacks_to_run;
   std::forward_list<CancellationManager*> children_to_cancel;
-  Notification* cancelled_notification = nullptr;
+  State* state;
   {
     mutex_lock l(mu_);
     if (is_cancelled_.load(std::memory_order_relaxed) || is_cancelling_) {
       return;
     }
     is_cancelling_ = true;
-    if (state_) {
-      std::swap(state_->callbacks, callbacks_to_run);
-
-      // Remove all children from the list of children.
-      CancellationManager* child = state_->first_child;
-      while (child != nullptr) {
-        children_to_cancel.push_front(child);
-        child->is_removed_from_parent_ = true;
-        child = child->next_sibling_;
-      }
-      state_->first_child = nullptr;
-
-      cancelled_notification = &state_->cancelled_notification;
+    // The state is needed even without callbacks, so that the callbacks
+    // registered concurrently see the cancellation in their shard.
+    state = GetOrCreateState();
+
+    // Remove all children from the list of children.
+    CancellationManager* child = state->first_child;
+    while (child != nullptr) {
+      children_to_cancel.push_front(child);
+      child->is_removed_from_parent_ = true;
+      child = child->next_sibling_;
     }
+    state->first_child = nullptr;
   }
-  // We call these callbacks without holding mu_, so that concurrent
+  for (CallbackShard& shard : state->callback_shards) {
+    mutex_lock l(shard.mu);
+    shard.cancelling = true;
+    for (auto& key_and_value : shard.callbacks) {
+      callbacks_to_run.push_back(std::move(key_and_value.second));
+    }
+    shard.callbacks.clear();
+  }
+  // We call these callbacks without holding any lock, so that concurrent
   // calls to DeregisterCallback, which can happen asynchronously, do
   // not block. The callbacks remain valid because any concurrent call
   // to DeregisterCallback will block until the
   // cancelled_notification_ is notified.
-  for (auto key_and_value : callbacks_to_run) {
-    CallbackConfiguration& config = key_and_value.second;
+  for (CallbackConfiguration& config : callbacks_to_run) {
     if (!status.ok() && config.log_error) {
       LOG(WARNING) << "Cancellation callback \"" << config.name
                    << "\" is triggered due to a "
@@ -90,9 +109,7 @@ void CancellationManager::StartCancelWithStatus(const Status& status) {
     is_cancelling_ = false;
     is_cancelled_.store(true, std::memory_order_release);
   }
-  if (cancelled_notification) {
-    cancelled_notification->Notify();
-  }
+  state->cancelled_notification.Notify();
 }
 
 bool CancellationManager::RegisterCallback(CancellationToken token,
@@ -111,41 +128,35 @@ bool CancellationManager::RegisterCallbackWithErrorLogging(
 bool CancellationManager::RegisterCallbackConfig(CancellationToken token,
                                                  CallbackConfiguration config) {
   DCHECK_LT(token, next_cancellation_token_) << "Invalid cancellation token";
-  mutex_lock l(mu_);
-  bool should_register = !is_cancelled_ && !is_cancelling_;
-  if (should_register) {
-    if (!state_) {
-      state_ = absl::make_unique<State>();
-    }
-    std::swap(state_->callbacks[token], config);
-  }
-  return should_register;
+  if (is_cancelled_.load(std::memory_order_acquire)) return false;
+  CallbackShard& shard = GetCallbackShard(GetOrCreateState(), token);
+  mutex_lock l(shard.mu);
+  if (shard.cancelling) return false;
+  std::swap(shard.callbacks[token], config);
+  return true;
 }
 
 bool CancellationManager::DeregisterCallback(CancellationToken token) {
-  mu_.lock();
-  if (is_cancelled_) {
-    mu_.unlock();
-    return false;
-  } else if (is_cancelling_) {
-    Notification* cancelled_notification =
-        state_ ? &state_->cancelled_notification : nullptr;
-    mu_.unlock();
-    // Wait for all of the cancellation callbacks to be called. This
-    // wait ensures that the caller of DeregisterCallback does not
-    // return immediately and free objects that may be used in the
-    // execution of any currently pending callbacks in StartCancel.
-    if (cancelled_notification) {
-      cancelled_notification->WaitForNotification();
-    }
-    return false;
-  } else {
-    if (state_) {
-      state_->callbacks.erase(token);
+  State* state = state_.load(std::memory_order_acquire);
+  if (state == nullptr) {
+    // No callback has been registered, and StartCancel() has not been called
+    // on this manager.
+    return !is_cancelled_.load(std::memory_order_acquire);
+  }
+  {
+    CallbackShard& shard = GetCallbackShard(state, token);
+    mutex_lock l(shard.mu);
+    if (!shard.cancelling) {
+      shard.callbacks.erase(token);
+      return true;
     }
-    mu_.unlock();
-    return true;
   }
+  // Wait for all of the cancellation callbacks to be called. This
+  // wait ensures that the caller of DeregisterCallback does not
+  // return immediately and free objects that may be used in the
+  // execution of any currently pending callbacks in StartCancel.
+  state->cancelled_notification.WaitForNotification();
+  return false;
 }
 
 bool CancellationManager::RegisterChild(CancellationManager* child) {
@@ -155,13 +166,11 @@ bool CancellationManager::RegisterChild(CancellationManager* child) {
     return true;
   }
 
-  if (!state_) {
-    state_ = absl::make_unique<State>();
-  }
+  State* state = GetOrCreateState();
 
   // Push `child` onto the front of the list of children.
-  CancellationManager* current_head = state_->first_child;
-  state_->first_child = child;
+  CancellationManager* current_head = state->first_child;
+  state->first_child = child;
   child->prev_sibling_ = nullptr;
   child->next_sibling_ = current_head;
   if (current_head) {
@@ -176,14 +185,15 @@ void CancellationManager::DeregisterChild(CancellationManager* child) {
   Notification* cancelled_notification = nullptr;
   {
     mutex_lock l(mu_);
+    State* state = state_.load(std::memory_order_acquire);
     if (!child->is_removed_from_parent_) {
       // Remove the child from this manager's list of children.
-      DCHECK(state_);
+      DCHECK(state);
 
       if (child->prev_sibling_ == nullptr) {
         // The child was at the head of the list.
-        DCHECK_EQ(state_->first_child, child);
-        state_->first_child = child->next_sibling_;
+        DCHECK_EQ(state->first_child, child);
+        state->first_child = child->next_sibling_;
       } else {
         child->prev_sibling_->next_sibling_ = child->next_sibling_;
       }
@@ -195,7 +205,7 @@ void CancellationManager::DeregisterChild(CancellationManager* child) {
       child->is_removed_from_parent_ = true;
     }
     if (is_cancelling_) {
-      cancelled_notification = &state_->cancelled_notification;
+      cancelled_notification = &state->cancelled_notification;
     }
   }
 
@@ -208,23 +218,25 @@ void CancellationManager::DeregisterChild(CancellationManager* child) {
 }
 
 bool CancellationManager::TryDeregisterCallback(CancellationToken token) {
-  mutex_lock lock(mu_);
-  if (is_cancelled_ || is_cancelling_) {
-    return false;
-  } else {
-    if (state_) {
-      state_->callbacks.erase(token);
-    }
-    return true;
+  State* state = state_.load(std::memory_order_acquire);
+  if (state == nullptr) {
+    return !is_cancelled_.load(std::memory_order_acquire);
   }
+  CallbackShard& shard = GetCallbackShard(state, token);
+  mutex_lock l(shard.mu);
+  if (shard.cancelling) return false;
+  shard.callbacks.erase(token);
+  return true;
 }
 
 CancellationManager::~CancellationManager() {
   if (parent_) {
     parent_->DeregisterChild(this);
   }
-  if (state_) {
+  State* state = state_.load(std::memory_order_acquire);
+  if (state) {
     StartCancel();
+    delete state;
   }
 }
 
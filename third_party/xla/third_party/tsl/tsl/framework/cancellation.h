@@ -18,8 +18,10 @@ limitations under the License.
 
 #include <atomic>
 #include <functional>
+#include <memory>
+#include <string>
 
-#include "tsl/lib/gtl/flatmap.h"
+#include "absl/container/flat_hash_map.h"
 #include "tsl/platform/hash.h"
 #include "tsl/platform/mutex.h"
 #include "tsl/platform/notification.h"
@@ -167,15 +169,36 @@ class CancellationManager {
     bool log_error = false;
   };
 
+  // The callbacks are sharded by token, so that the registrations and
+  // deregistrations of concurrent operations do not contend on a single lock.
+  // Only StartCancel() takes the locks of all the shards.
+  struct CallbackShard {
+    mutex mu;
+    // Set by StartCancel(), after which no callback is registered in the
+    // shard.
+    bool cancelling TF_GUARDED_BY(mu) = false;
+    absl::flat_hash_map<CancellationToken, CallbackConfiguration> callbacks
+        TF_GUARDED_BY(mu);
+  };
+  static constexpr int kNumCallbackShards = 8;
+
   struct State {
     Notification cancelled_notification;
-    gtl::FlatMap<CancellationToken, CallbackConfiguration> callbacks;
+    CallbackShard callback_shards[kNumCallbackShards];
 
     // If this CancellationManager has any children, this member points to the
     // head of a doubly-linked list of its children.
     CancellationManager* first_child = nullptr;  // Not owned.
   };
 
+  // Returns `state_`, which is allocated on first use.
+  State* GetOrCreateState();
+
+  CallbackShard& GetCallbackShard(State* state, CancellationToken token) {
+    return state->callback_shards[static_cast<uint64_t>(token) %
+                                  kNumCallbackShards];
+  }
+
   bool RegisterCallbackConfig(CancellationToken token,
                               CallbackConfiguration config);
 
@@ -202,7 +225,8 @@ class CancellationManager {
       nullptr;  // Not owned.
 
   mutex mu_;
-  std::unique_ptr<State> state_ TF_GUARDED_BY(mu_);
+  // Set once and owned. `first_child` is guarded by `mu_`.
+  std::atomic<State*> state_{nullptr};
 };
 
 // Registers the given cancellation callback, returning a function that can be
@@ -16,14 +16,17 @@ limitations under the License.
 #include "tsl/framework/cancellation.h"
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <numeric>
 #include <random>
 #include <vector>
 
+#include "tsl/platform/blocking_counter.h"
 #include "tsl/platform/notification.h"
 #include "tsl/platform/status.h"
 #include "tsl/platform/test.h"
+#include "tsl/platform/test_benchmark.h"
 #include "tsl/platform/threadpool.h"
 
 namespace tsl {
@@ -221,6 +224,37 @@ TEST(Cancellation, TryDeregisterDuringCancel) {
   cancel_complete.WaitForNotification();
 }
 
+TEST(Cancellation, ConcurrentRegisterDuringCancel) {
+  constexpr int kNumThreads = 8;
+  constexpr int kCallbacksPerThread = 1000;
+  CancellationManager cm;
+  // Each callback is either not registered, deregistered or run exactly once.
+  std::vector<std::atomic<int>> num_runs(kNumThreads * kCallbacksPerThread);
+  // Not std::vector<bool>, which the threads could not write concurrently.
+  std::vector<char> registered(num_runs.size(), false);
+  std::vector<char> deregistered(num_runs.size(), false);
+  {
+    thread::ThreadPool w(Env::Default(), "test", kNumThreads + 1);
+    for (int i = 0; i < kNumThreads; ++i) {
+      w.Schedule([&, i]() {
+        for (int j = 0; j < kCallbacksPerThread; ++j) {
+          const int index = i * kCallbacksPerThread + j;
+          CancellationToken token = cm.get_cancellation_token();
+          auto callback = [&num_runs, index]() { ++num_runs[index]; };
+          registered[index] = cm.RegisterCallback(token, callback);
+          if (!registered[index]) continue;
+          if (j % 2 == 0) deregistered[index] = cm.DeregisterCallback(token);
+        }
+      });
+    }
+    w.Schedule([&cm]() { cm.StartCancel(); });
+  }
+  EXPECT_TRUE(cm.IsCancelled());
+  for (size_t i = 0; i < num_runs.size(); ++i) {
+    EXPECT_EQ(num_runs[i], registered[i] && !deregistered[i] ? 1 : 0) << i;
+  }
+}
+
 TEST(Cancellation, Parent_CancelManyChildren) {
   CancellationManager parent;
   std::vector<std::unique_ptr<CancellationManager>> children;
@@ -281,4 +315,53 @@ TEST(Cancellation, Parent_RandomDestructionOrder) {
   }
 }
 
+void BM_RegisterAndDeregister(::testing::benchmark::State& state) {
+  CancellationManager cm;
+  for (auto s : state) {
+    CancellationToken token = cm.get_cancellation_token();
+    cm.RegisterCallback(token, []() {});
+    cm.DeregisterCallback(token);
+  }
+}
+BENCHMARK(BM_RegisterAndDeregister);
+
+// Each of the `state.range(0)` threads registers and deregisters callbacks
+// with the same manager, like the async kernels of a step.
+void BM_ConcurrentRegisterAndDeregister(::testing::benchmark::State& state) {
+  const int num_threads = state.range(0);
+  constexpr int kCallbacksPerThread = 1000;
+  thread::ThreadPool pool(Env::Default(), "test", num_threads);
+  for (auto s : state) {
+    CancellationManager cm;
+    BlockingCounter counter(num_threads);
+    for (int i = 0; i < num_threads; ++i) {
+      pool.Schedule([&cm, &counter]() {
+        for (int j = 0; j < kCallbacksPerThread; ++j) {
+          CancellationToken token = cm.get_cancellation_token();
+          cm.RegisterCallback(token, []() {});
+          cm.DeregisterCallback(token);
+        }
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+  state.SetItemsProcessed(state.iterations() * num_threads *
+                          kCallbacksPerThread);
+}
+BENCHMARK(BM_ConcurrentRegisterAndDeregister)->Arg(1)->Arg(4)->Arg(16);
+
+void BM_StartCancel(::testing::benchmark::State& state) {
+  const int num_callbacks = state.range(0);
+  for (auto s : state) {
+    CancellationManager cm;
+    for (int i = 0; i < num_callbacks; ++i) {
+      cm.RegisterCallback(cm.get_cancellation_token(), []() {});
+    }
+    cm.StartCancel();
+  }
+  state.SetItemsProcessed(state.iterations() * num_callbacks);
+}
+BENCHMARK(BM_StartCancel)->Arg(1)->Arg(1000);
+
 }  // namespace tsl
@@ -128,6 +128,12 @@ class CPUAllocator : public Allocator {
          alloc_bytes]() TF_NO_THREAD_SAFETY_ANALYSIS {
           const auto& annotation =
               tsl::profiler::ScopedMemoryDebugAnnotation::CurrentAnnotation();
+          const auto op_name = annotation.pending_op_name
+                                   ? annotation.pending_op_name
+                                   : "(null)";
+          const auto region_type = annotation.pending_region_type
+                                       ? annotation.pending_region_type
+                                       : "(null)";
           return tsl::profiler::TraceMeEncode(
               traceme_name, {{"allocator_name", Name()},
                              {"bytes_reserved", stats_.bytes_reserved},
@@ -136,10 +142,11 @@ class CPUAllocator : public Allocator {
                              {"requested_bytes", req_bytes},
                              {"allocation_bytes", alloc_bytes},
                              {"addr", reinterpret_cast<uint64>(chunk_ptr)},
-                             {"tf_op", annotation.pending_op_name},
+                             {"tf_op", op_name},
                              {"id", annotation.pending_step_id},
-                             {"region_type", annotation.pending_region_type},
+                             {"region_type", region_type},
                              {"data_type", annotation.pending_data_type},
+                             {"output_index", annotation.pending_output_index},
                              {"shape", annotation.pending_shape_func()}});
         },
         /*level=*/tsl::profiler::TraceMeLevel::kInfo);
@@ -16,8 +16,13 @@ limitations under the License.
 #include "tsl/framework/metrics.h"
 
 #include <cstdint>
+#include <string>
 
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tsl/lib/monitoring/counter.h"
+#include "tsl/lib/monitoring/gauge.h"
 
 namespace tsl {
 namespace metrics {
@@ -28,6 +33,28 @@ auto* bfc_allocator_delay =
                                 "The total time spent running each graph "
                                 "optimization pass in microseconds.");
 
+auto* bfc_allocator_largest_free_chunk =
+    monitoring::Gauge<int64_t, 1>::New(
+        "/tensorflow/core/bfc_allocator/largest_free_chunk_bytes",
+        "The size of the largest free chunk of a BFC allocator in bytes.",
+        "allocator");
+
+auto* bfc_allocator_fragmentation = monitoring::Gauge<double, 1>::New(
+    "/tensorflow/core/bfc_allocator/fragmentation",
+    "The fraction of the free memory of a BFC allocator that is outside of "
+    "its largest free chunk.",
+    "allocator");
+
+auto* bfc_allocator_bin_free_bytes = monitoring::Gauge<int64_t, 2>::New(
+    "/tensorflow/core/bfc_allocator/bin_free_bytes",
+    "The bytes of the free chunks in a bin of a BFC allocator.", "allocator",
+    "bin");
+
+auto* bfc_allocator_bin_free_chunks = monitoring::Gauge<int64_t, 2>::New(
+    "/tensorflow/core/bfc_allocator/bin_free_chunks",
+    "The number of free chunks in a bin of a BFC allocator.", "allocator",
+    "bin");
+
 }  // namespace
 
 void UpdateBfcAllocatorDelayTime(const uint64_t delay_usecs) {
@@ -37,5 +64,21 @@ void UpdateBfcAllocatorDelayTime(const uint64_t delay_usecs) {
   }
 }
 
+void UpdateBfcAllocatorFreeMemory(absl::string_view allocator_name,
+                                  int64_t largest_free_chunk_bytes,
+                                  double fragmentation,
+                                  absl::Span<const int64_t> bin_free_bytes,
+                                  absl::Span<const int64_t> bin_free_chunks) {
+  const std::string name(allocator_name);
+  bfc_allocator_largest_free_chunk->GetCell(name)->Set(
+      largest_free_chunk_bytes);
+  bfc_allocator_fragmentation->GetCell(name)->Set(fragmentation);
+  for (size_t i = 0; i < bin_free_bytes.size(); ++i) {
+    const std::string bin = absl::StrCat(i);
+    bfc_allocator_bin_free_bytes->GetCell(name, bin)->Set(bin_free_bytes[i]);
+    bfc_allocator_bin_free_chunks->GetCell(name, bin)->Set(bin_free_chunks[i]);
+  }
+}
+
 }  // namespace metrics
 }  // namespace tsl
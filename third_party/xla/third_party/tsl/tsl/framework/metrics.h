@@ -18,12 +18,25 @@ limitations under the License.
 
 #include <cstdint>
 
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+
 namespace tsl {
 namespace metrics {
 
 // Updates the metrics stored about time BFC allocator spents during delay.
 void UpdateBfcAllocatorDelayTime(const uint64_t delay_usecs);
 
+// Updates the metrics about the free memory of the BFC allocator named
+// `allocator_name`: the size of its largest free chunk, its fragmentation
+// (the fraction of the free memory outside of the largest free chunk), and the
+// bytes and number of free chunks of each of its bins.
+void UpdateBfcAllocatorFreeMemory(absl::string_view allocator_name,
+                                  int64_t largest_free_chunk_bytes,
+                                  double fragmentation,
+                                  absl::Span<const int64_t> bin_free_bytes,
+                                  absl::Span<const int64_t> bin_free_chunks);
+
 }  // namespace metrics
 }  // namespace tsl
 
@@ -28,6 +28,8 @@ limitations under the License.
 namespace tsl {
 
 inline constexpr int kHighPriority = 0;
+// Weight of the latest execution time in the per-device moving average.
+inline constexpr double kExecutionTimeEmaWeight = 0.1;
 
 DeviceReservation::DeviceReservation(int device_index,
                                      ServingDeviceSelector* device_selector)
@@ -72,8 +74,16 @@ DeviceReservation& DeviceReservation::operator=(DeviceReservation&& r) {
             << "], priority: " << priority
             << ", prefetch: " << static_cast<int>(prefetch_results)
             << ", time: " << now_ns - device_state.last_started_ns;
+    const int64_t exec_time_ns = now_ns - device_state.last_started_ns;
     const_cast<ExecutionInfo*>(execution_info)
-        ->AddTime(now_ns - device_state.last_started_ns, prefetch_results);
+        ->AddTime(exec_time_ns, prefetch_results);
+    if (device_state.execution_time_ema_ns == 0) {
+      device_state.execution_time_ema_ns = exec_time_ns;
+    } else {
+      device_state.execution_time_ema_ns += static_cast<int64_t>(
+          kExecutionTimeEmaWeight *
+          (exec_time_ns - device_state.execution_time_ema_ns));
+    }
     // Only update min_exec_time_ when running_average is updated. This avoids
     // the case where running_average is zero.
     if (!min_exec_time.has_value() ||
@@ -147,6 +157,10 @@ DeviceReservation& DeviceReservation::operator=(DeviceReservation&& r) {
     device_state.last_fingerprint = fingerprint;
   }
 
+  if (!fingerprint.empty()) {
+    device_state.resident_fingerprints.emplace(fingerprint);
+  }
+
   // Count number of programs in enqueued_programs queues.
   int64_t num_programs_enqueued = 0;
   for (int64_t i = 0; i < priority_queue_count; i++) {
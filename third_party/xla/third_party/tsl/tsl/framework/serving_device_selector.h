@@ -18,8 +18,10 @@ limitations under the License.
 #include <cstdint>
 #include <deque>
 #include <optional>
+#include <string>
 
 #include "absl/container/fixed_array.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "tsl/platform/logging.h"
@@ -128,6 +130,14 @@ class ServingDeviceSelector {
     // Whether execution timer was reset, true iff a program is enqueued while
     // all queues (for all priorities) were empty.
     bool timer_reset = true;
+    // Exponential moving average of the execution time of the programs
+    // completed on the device, in nanoseconds. Zero until one completes.
+    int64_t execution_time_ema_ns = 0;
+    // Free bytes of device memory as last reported, if known.
+    std::optional<int64_t> free_memory_bytes;
+    // Fingerprints of the programs enqueued on the device so far, whose
+    // weights are likely to be resident in its memory.
+    absl::flat_hash_set<std::string> resident_fingerprints;
   };
 
   // Struct of all tracked device states, which will be passed to Policy.
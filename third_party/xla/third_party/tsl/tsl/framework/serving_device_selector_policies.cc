@@ -15,6 +15,10 @@ limitations under the License.
 #include "tsl/framework/serving_device_selector_policies.h"
 
 #include <atomic>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <tuple>
 
 #include "absl/strings/string_view.h"
 #include "tsl/framework/serving_device_selector.h"
@@ -28,4 +32,65 @@ int RoundRobinPolicy::SelectDevice(
   return ordinal_.fetch_add(1, std::memory_order_relaxed) % num_devices;
 }
 
+/*static*/ int64_t LoadAwarePolicy::EstimateQueuedTimeNs(
+    const ServingDeviceSelector::DeviceState& device_state) {
+  auto queue_time_ns =
+      [&](const std::deque<ServingDeviceSelector::DeviceState::ProgramInfo>&
+              programs) {
+        int64_t time_ns = 0;
+        for (const auto& info : programs) {
+          int64_t program_time_ns =
+              info.execution_info == nullptr
+                  ? 0
+                  : info.execution_info->MaybeGetValidTime(
+                        info.prefetch_results);
+          if (program_time_ns == 0) {
+            program_time_ns = device_state.execution_time_ema_ns;
+          }
+          time_ns += program_time_ns;
+        }
+        return time_ns;
+      };
+  int64_t time_ns = 0;
+  for (const auto& programs : device_state.enqueued_programs) {
+    time_ns += queue_time_ns(programs);
+  }
+  for (const auto& programs : device_state.scheduled_programs) {
+    time_ns += queue_time_ns(programs);
+  }
+  return time_ns;
+}
+
+int LoadAwarePolicy::SelectDevice(
+    absl::string_view program_fingerprint,
+    const ServingDeviceSelector::DeviceStates& device_states) {
+  const int num_devices = device_states.states.size();
+  const int start =
+      ordinal_.fetch_add(1, std::memory_order_relaxed) % num_devices;
+  int best_device = start;
+  // Ordered by (low on memory, estimated time, -free memory).
+  std::tuple<bool, int64_t, int64_t> best_key = {
+      true, std::numeric_limits<int64_t>::max(),
+      std::numeric_limits<int64_t>::max()};
+  for (int i = 0; i < num_devices; ++i) {
+    const int device = (start + i) % num_devices;
+    const auto& state = device_states.states[device];
+    const int64_t free_memory_bytes = state.free_memory_bytes.value_or(0);
+    int64_t time_ns = EstimateQueuedTimeNs(state);
+    if (!program_fingerprint.empty() &&
+        !state.resident_fingerprints.contains(program_fingerprint)) {
+      time_ns += non_resident_penalty_ns_;
+    }
+    std::tuple<bool, int64_t, int64_t> key = {
+        state.free_memory_bytes.has_value() &&
+            free_memory_bytes < min_free_memory_bytes_,
+        time_ns, -free_memory_bytes};
+    if (key < best_key) {
+      best_key = key;
+      best_device = device;
+    }
+  }
+  return best_device;
+}
+
 }  // namespace tsl
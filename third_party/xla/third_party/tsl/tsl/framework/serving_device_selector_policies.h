@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_TSL_FRAMEWORK_SERVING_DEVICE_SELECTOR_POLICIES_H_
 
 #include <atomic>
+#include <cstdint>
 
 #include "tsl/framework/serving_device_selector.h"
 
@@ -23,6 +24,7 @@ namespace tsl {
 
 enum class ServingDeviceSelectorPolicy {
   kRoundRobin,
+  kLoadAware,
 };
 
 class RoundRobinPolicy : public ServingDeviceSelector::Policy {
@@ -37,6 +39,38 @@ class RoundRobinPolicy : public ServingDeviceSelector::Policy {
   std::atomic<uint64_t> ordinal_;
 };
 
+// Selects the device expected to become idle the earliest, estimated from the
+// programs queued on each device. Programs without an execution time estimate
+// are assumed to take as long as the moving average of the device.
+//
+// A device on which the program is not resident yet has
+// `non_resident_penalty_ns` added to its estimate, for loading the program
+// weights. Devices with less than `min_free_memory_bytes` of free memory are
+// only selected if all devices are. Ties are broken by free memory, then in a
+// round-robin fashion.
+class LoadAwarePolicy : public ServingDeviceSelector::Policy {
+ public:
+  explicit LoadAwarePolicy(int64_t non_resident_penalty_ns = 0,
+                           int64_t min_free_memory_bytes = 0)
+      : non_resident_penalty_ns_(non_resident_penalty_ns),
+        min_free_memory_bytes_(min_free_memory_bytes),
+        ordinal_(0) {}
+
+  int SelectDevice(
+      absl::string_view program_fingerprint,
+      const ServingDeviceSelector::DeviceStates& device_states) override;
+
+  // Returns the estimated time in nanoseconds until all the programs queued on
+  // the device of `device_state` are done.
+  static int64_t EstimateQueuedTimeNs(
+      const ServingDeviceSelector::DeviceState& device_state);
+
+ private:
+  const int64_t non_resident_penalty_ns_;
+  const int64_t min_free_memory_bytes_;
+  std::atomic<uint64_t> ordinal_;
+};
+
 }  // namespace tsl
 
 #endif  // TENSORFLOW_TSL_FRAMEWORK_SERVING_DEVICE_SELECTOR_POLICIES_H_
@@ -0,0 +1,189 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/lib/io/filter_block.h"
+
+#include <assert.h>
+
+#include <algorithm>
+
+#include "tsl/platform/coding.h"
+#include "tsl/platform/hash.h"
+#include "tsl/platform/raw_coding.h"
+
+namespace tsl {
+namespace table {
+
+const char kFilterBlockName[] = "filter.tsl.BloomFilter";
+
+namespace {
+
+// Generate new filter every 2KB of data
+constexpr size_t kFilterBaseLg = 11;
+constexpr size_t kFilterBase = 1 << kFilterBaseLg;
+
+// Number of probes that minimizes the false positive rate, rounded down to
+// reduce probing cost a little bit.
+size_t NumProbes(int bits_per_key) {
+  size_t k = static_cast<size_t>(bits_per_key * 0.69);  // 0.69 =~ ln(2)
+  return std::max<size_t>(1, std::min<size_t>(30, k));
+}
+
+uint32 BloomHash(const StringPiece& key) {
+  return Hash32(key.data(), key.size(), 0xbc9f1d34);
+}
+
+// Appends to `dst` a bloom filter of the `n` keys of `keys`.
+void CreateBloomFilter(const StringPiece* keys, size_t n, int bits_per_key,
+                       size_t num_probes, string* dst) {
+  // For small n, we can see a very high false positive rate.  Fix it
+  // by enforcing a minimum bloom filter length.
+  size_t bits = std::max<size_t>(64, n * bits_per_key);
+  const size_t bytes = (bits + 7) / 8;
+  bits = bytes * 8;
+
+  const size_t init_size = dst->size();
+  dst->resize(init_size + bytes, 0);
+  dst->push_back(static_cast<char>(num_probes));  // Remember # of probes
+  char* array = &(*dst)[init_size];
+  for (size_t i = 0; i < n; i++) {
+    // Use double-hashing to generate a sequence of hash values.
+    uint32 h = BloomHash(keys[i]);
+    const uint32 delta = (h >> 17) | (h << 15);  // Rotate right 17 bits
+    for (size_t j = 0; j < num_probes; j++) {
+      const uint32 bitpos = h % bits;
+      array[bitpos / 8] |= (1 << (bitpos % 8));
+      h += delta;
+    }
+  }
+}
+
+bool BloomFilterMayMatch(const StringPiece& key, const StringPiece& filter) {
+  const size_t len = filter.size();
+  if (len < 2) return false;
+
+  const char* array = filter.data();
+  const size_t bits = (len - 1) * 8;
+
+  // Use the encoded k so that we can read filters generated by
+  // bloom filters created using different parameters.
+  const size_t k = static_cast<uint8>(array[len - 1]);
+  if (k > 30) {
+    // Reserved for potentially new encodings for short bloom filters.
+    // Consider it a match.
+    return true;
+  }
+
+  uint32 h = BloomHash(key);
+  const uint32 delta = (h >> 17) | (h << 15);  // Rotate right 17 bits
+  for (size_t j = 0; j < k; j++) {
+    const uint32 bitpos = h % bits;
+    if ((array[bitpos / 8] & (1 << (bitpos % 8))) == 0) return false;
+    h += delta;
+  }
+  return true;
+}
+
+}  // namespace
+
+FilterBlockBuilder::FilterBlockBuilder(int bits_per_key)
+    : bits_per_key_(bits_per_key), num_probes_(NumProbes(bits_per_key)) {}
+
+void FilterBlockBuilder::StartBlock(uint64 block_offset) {
+  const uint64 filter_index = (block_offset / kFilterBase);
+  assert(filter_index >= filter_offsets_.size());
+  while (filter_index > filter_offsets_.size()) {
+    GenerateFilter();
+  }
+}
+
+void FilterBlockBuilder::AddKey(const StringPiece& key) {
+  start_.push_back(keys_.size());
+  keys_.append(key.data(), key.size());
+}
+
+StringPiece FilterBlockBuilder::Finish() {
+  if (!start_.empty()) {
+    GenerateFilter();
+  }
+
+  // Append array of per-filter offsets
+  const uint32 array_offset = result_.size();
+  for (size_t i = 0; i < filter_offsets_.size(); i++) {
+    core::PutFixed32(&result_, filter_offsets_[i]);
+  }
+
+  core::PutFixed32(&result_, array_offset);
+  result_.push_back(kFilterBaseLg);  // Save encoding parameter in result
+  return StringPiece(result_);
+}
+
+void FilterBlockBuilder::GenerateFilter() {
+  const size_t num_keys = start_.size();
+  if (num_keys == 0) {
+    // Fast path if there are no keys for this filter
+    filter_offsets_.push_back(result_.size());
+    return;
+  }
+
+  // Make list of keys from flattened key structure
+  start_.push_back(keys_.size());  // Simplify length computation
+  std::vector<StringPiece> tmp_keys(num_keys);
+  for (size_t i = 0; i < num_keys; i++) {
+    const char* base = keys_.data() + start_[i];
+    const size_t length = start_[i + 1] - start_[i];
+    tmp_keys[i] = StringPiece(base, length);
+  }
+
+  // Generate filter for current set of keys and append to result_.
+  filter_offsets_.push_back(result_.size());
+  CreateBloomFilter(tmp_keys.data(), num_keys, bits_per_key_, num_probes_,
+                    &result_);
+
+  keys_.clear();
+  start_.clear();
+}
+
+FilterBlockReader::FilterBlockReader(const StringPiece& contents)
+    : data_(nullptr), offset_(nullptr), num_(0), base_lg_(0) {
+  const size_t n = contents.size();
+  if (n < 5) return;  // 1 byte for base_lg_ and 4 for start of offset array
+  base_lg_ = contents[n - 1];
+  const uint32 last_word = core::DecodeFixed32(contents.data() + n - 5);
+  if (last_word > n - 5) return;
+  data_ = contents.data();
+  offset_ = data_ + last_word;
+  num_ = (n - 5 - last_word) / 4;
+}
+
+bool FilterBlockReader::KeyMayMatch(uint64 block_offset,
+                                    const StringPiece& key) const {
+  const uint64 index = block_offset >> base_lg_;
+  if (index < num_) {
+    const uint32 start = core::DecodeFixed32(offset_ + index * 4);
+    const uint32 limit = core::DecodeFixed32(offset_ + index * 4 + 4);
+    if (start <= limit && limit <= static_cast<size_t>(offset_ - data_)) {
+      const StringPiece filter = StringPiece(data_ + start, limit - start);
+      return BloomFilterMayMatch(key, filter);
+    } else if (start == limit) {
+      // Empty filters do not match any keys
+      return false;
+    }
+  }
+  return true;  // Errors are treated as potential matches
+}
+
+}  // namespace table
+}  // namespace tsl
@@ -0,0 +1,88 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// A filter block is stored near the end of a Table file.  It contains
+// bloom filters for all data blocks in the table combined into a single
+// filter block.  See table_format.txt for the encoding.
+
+#ifndef TENSORFLOW_TSL_LIB_IO_FILTER_BLOCK_H_
+#define TENSORFLOW_TSL_LIB_IO_FILTER_BLOCK_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "tsl/platform/stringpiece.h"
+#include "tsl/platform/types.h"
+
+namespace tsl {
+namespace table {
+
+// Name of the metaindex entry that points to the filter block.
+extern const char kFilterBlockName[];
+
+// A FilterBlockBuilder is used to construct all of the filters for a
+// particular Table.  It generates a single string which is stored as
+// a special block in the Table.
+//
+// The sequence of calls to FilterBlockBuilder must match the regexp:
+//      (StartBlock AddKey*)* Finish
+class FilterBlockBuilder {
+ public:
+  // Builds bloom filters with `bits_per_key` bits per key.  A good value
+  // is 10, which yields a filter with ~1% false positive rate.
+  explicit FilterBlockBuilder(int bits_per_key);
+
+  void StartBlock(uint64 block_offset);
+  void AddKey(const StringPiece& key);
+  StringPiece Finish();
+
+ private:
+  void GenerateFilter();
+
+  const int bits_per_key_;
+  const size_t num_probes_;
+  string keys_;                   // Flattened key contents
+  std::vector<size_t> start_;     // Starting index in keys_ of each key
+  string result_;                 // Filter data computed so far
+  std::vector<uint32> filter_offsets_;
+
+  // No copying allowed
+  FilterBlockBuilder(const FilterBlockBuilder&);
+  void operator=(const FilterBlockBuilder&);
+};
+
+class FilterBlockReader {
+ public:
+  // REQUIRES: "contents" must stay live while *this is live.
+  explicit FilterBlockReader(const StringPiece& contents);
+
+  // Returns false if `key` is definitely not in the data block starting at
+  // `block_offset`.
+  bool KeyMayMatch(uint64 block_offset, const StringPiece& key) const;
+
+ private:
+  const char* data_;    // Pointer to filter data (at block-start)
+  const char* offset_;  // Pointer to beginning of offset array (at block-end)
+  size_t num_;          // Number of entries in offset array
+  size_t base_lg_;      // Encoding parameter (see kFilterBaseLg in .cc file)
+};
+
+}  // namespace table
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_FILTER_BLOCK_H_
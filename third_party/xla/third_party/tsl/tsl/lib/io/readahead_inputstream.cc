@@ -0,0 +1,237 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/lib/io/readahead_inputstream.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#include "tsl/lib/io/random_inputstream.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+
+namespace tsl {
+namespace io {
+
+namespace {
+// Weight of the latest sample in the moving averages of the read and consume
+// times.
+constexpr double kSmoothingFactor = 0.2;
+
+void UpdateMovingAverage(double sample, double* average) {
+  if (*average == 0) {
+    *average = sample;
+  } else {
+    *average += kSmoothingFactor * (sample - *average);
+  }
+}
+}  // namespace
+
+struct ReadaheadInputStream::Block {
+  Block(int64_t offset, int64_t capacity,
+        const std::function<void(int64_t)>& buffer_usage_callback)
+      : offset(offset),
+        capacity(capacity),
+        data(new char[capacity]),
+        buffer_usage_callback(buffer_usage_callback) {
+    if (buffer_usage_callback) buffer_usage_callback(capacity);
+  }
+
+  ~Block() {
+    if (buffer_usage_callback) buffer_usage_callback(-capacity);
+  }
+
+  const int64_t offset;
+  const int64_t capacity;
+  const std::unique_ptr<char[]> data;
+  // Refers to the options of the stream, which outlives all its blocks.
+  const std::function<void(int64_t)>& buffer_usage_callback;
+
+  // Written by the read before it sets `done`.
+  int64_t size = 0;
+  Status status;
+  uint64 read_micros = 0;
+  bool done = false;
+
+  // Set by the consumer when it first reaches this block.
+  uint64 ready_micros = 0;
+};
+
+ReadaheadInputStream::ReadaheadInputStream(RandomAccessFile* file,
+                                           const ReadaheadOptions& options)
+    : file_(file), options_(options) {
+  window_ = std::min(2, std::max(1, options_.max_blocks));
+}
+
+ReadaheadInputStream::~ReadaheadInputStream() {
+  mutex_lock l(mu_);
+  while (num_outstanding_reads_ > 0) {
+    cond_var_.wait(l);
+  }
+}
+
+void ReadaheadInputStream::FillWindow() {
+  while (!stop_reading_ && blocks_.size() < static_cast<size_t>(window_)) {
+    auto block = std::make_shared<Block>(next_offset_, options_.block_size,
+                                         options_.buffer_usage_callback);
+    next_offset_ += options_.block_size;
+    blocks_.push_back(block);
+    {
+      mutex_lock l(mu_);
+      ++num_outstanding_reads_;
+    }
+    auto read = [this, block = std::move(block)]() mutable {
+      const uint64 start_micros = Env::Default()->NowMicros();
+      StringPiece result;
+      Status s = file_->Read(block->offset, block->capacity, &result,
+                             block->data.get());
+      if (result.data() != block->data.get()) {
+        memmove(block->data.get(), result.data(), result.size());
+      }
+      mutex_lock l(mu_);
+      block->size = result.size();
+      block->status = std::move(s);
+      block->read_micros = Env::Default()->NowMicros() - start_micros;
+      block->done = true;
+      // Drop the reference before the destructor can observe the read as
+      // finished, since releasing the block may report to the options.
+      block.reset();
+      --num_outstanding_reads_;
+      cond_var_.notify_all();
+    };
+    if (options_.schedule) {
+      options_.schedule(std::move(read));
+    } else {
+      read();
+    }
+  }
+}
+
+bool ReadaheadInputStream::WaitForFront() {
+  FillWindow();
+  if (blocks_.empty()) return false;
+  Block* front = blocks_.front().get();
+  if (front->ready_micros == 0) {
+    {
+      mutex_lock l(mu_);
+      while (!front->done) {
+        cond_var_.wait(l);
+      }
+    }
+    front->ready_micros = Env::Default()->NowMicros();
+    if (!front->status.ok() || front->size < front->capacity) {
+      stop_reading_ = true;
+    }
+  }
+  return true;
+}
+
+void ReadaheadInputStream::PopFront() {
+  const Block& front = *blocks_.front();
+  UpdateMovingAverage(front.read_micros, &read_micros_);
+  UpdateMovingAverage(Env::Default()->NowMicros() - front.ready_micros,
+                      &consume_micros_);
+  blocks_.pop_front();
+  UpdateWindow();
+}
+
+void ReadaheadInputStream::UpdateWindow() {
+  // Keep enough reads in flight to cover the read latency at the rate at which
+  // the consumer drains blocks, plus the block being consumed.
+  const int max_blocks = std::max(1, options_.max_blocks);
+  double window = max_blocks;
+  if (consume_micros_ > 0) {
+    window = std::ceil(read_micros_ / consume_micros_) + 1;
+  }
+  window_ = static_cast<int>(
+      std::clamp(window, 1.0, static_cast<double>(max_blocks)));
+}
+
+void ReadaheadInputStream::DropBlocks() {
+  blocks_.clear();
+  next_offset_ = pos_;
+  stop_reading_ = false;
+}
+
+Status ReadaheadInputStream::ReadNBytes(int64_t bytes_to_read,
+                                        tstring* result) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Can't read a negative number of bytes: ",
+                                   bytes_to_read);
+  }
+  result->clear();
+  result->reserve(bytes_to_read);
+  while (result->size() < static_cast<size_t>(bytes_to_read)) {
+    if (!WaitForFront()) {
+      return errors::OutOfRange("reached end of file");
+    }
+    const Block& front = *blocks_.front();
+    const int64_t available = front.offset + front.size - pos_;
+    if (available > 0) {
+      const int64_t bytes_to_copy =
+          std::min<int64_t>(available, bytes_to_read - result->size());
+      result->append(front.data.get() + (pos_ - front.offset), bytes_to_copy);
+      pos_ += bytes_to_copy;
+      continue;
+    }
+    // The block is exhausted. Blocks that ended early are kept, so that
+    // further reads keep returning their status.
+    if (!front.status.ok()) return front.status;
+    if (front.size < front.capacity) {
+      return errors::OutOfRange("reached end of file");
+    }
+    PopFront();
+  }
+  return OkStatus();
+}
+
+Status ReadaheadInputStream::SkipNBytes(int64_t bytes_to_skip) {
+  if (bytes_to_skip < 0) {
+    return errors::InvalidArgument("Can only skip forward, not ",
+                                   bytes_to_skip);
+  }
+  // Skipping within the blocks already issued reuses them.
+  if (pos_ + bytes_to_skip < next_offset_) {
+    tstring unused;
+    while (bytes_to_skip > 0) {
+      const int64_t bytes_to_read =
+          std::min<int64_t>(bytes_to_skip, options_.block_size);
+      TF_RETURN_IF_ERROR(ReadNBytes(bytes_to_read, &unused));
+      bytes_to_skip -= bytes_to_read;
+    }
+    return OkStatus();
+  }
+  // Otherwise restart reading at the destination, which is checked against
+  // the end of the file without reading the skipped bytes.
+  RandomAccessInputStream input_stream(file_);
+  TF_RETURN_IF_ERROR(input_stream.Seek(pos_));
+  Status s = input_stream.SkipNBytes(bytes_to_skip);
+  pos_ = input_stream.Tell();
+  DropBlocks();
+  return s;
+}
+
+int64_t ReadaheadInputStream::Tell() const { return pos_; }
+
+Status ReadaheadInputStream::Reset() {
+  pos_ = 0;
+  DropBlocks();
+  return OkStatus();
+}
+
+}  // namespace io
+}  // namespace tsl
@@ -0,0 +1,122 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_READAHEAD_INPUTSTREAM_H_
+#define TENSORFLOW_TSL_LIB_IO_READAHEAD_INPUTSTREAM_H_
+
+#include <deque>
+#include <functional>
+#include <memory>
+
+#include "tsl/lib/io/inputstream_interface.h"
+#include "tsl/platform/file_system.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/thread_annotations.h"
+#include "tsl/platform/types.h"
+
+namespace tsl {
+namespace io {
+
+struct ReadaheadOptions {
+  // Size of each read issued to the file.
+  int64_t block_size = 1 << 20;
+
+  // Upper bound on the number of blocks that are read or buffered ahead of the
+  // consumer. Zero disables readahead.
+  int max_blocks = 0;
+
+  // Runs a read in the background. Reads block on I/O, so `schedule` should
+  // have at least `max_blocks` threads available to keep the window full.
+  std::function<void(std::function<void()>)> schedule;
+
+  // If set, called with the change in the number of bytes held by the
+  // readahead buffers whenever a block is allocated or released. May be called
+  // from the threads that run `schedule`d reads.
+  std::function<void(int64_t)> buffer_usage_callback;
+};
+
+// Reads a RandomAccessFile sequentially while keeping several block reads in
+// flight ahead of the consumer, which hides the per-request latency of remote
+// file systems.
+//
+// The number of blocks in flight adapts to the measured throughput: it is
+// sized so that the blocks outstanding cover the read latency at the rate at
+// which the consumer drains them, and is bounded by `max_blocks`.
+//
+// A single instance of ReadaheadInputStream is NOT safe for concurrent use by
+// multiple threads.
+class ReadaheadInputStream : public InputStreamInterface {
+ public:
+  // Does not take ownership of 'file'. 'file' must outlive *this.
+  ReadaheadInputStream(RandomAccessFile* file, const ReadaheadOptions& options);
+
+  // Waits for the outstanding reads to finish.
+  ~ReadaheadInputStream() override;
+
+  Status ReadNBytes(int64_t bytes_to_read, tstring* result) override;
+
+  Status SkipNBytes(int64_t bytes_to_skip) override;
+
+  int64_t Tell() const override;
+
+  Status Reset() override;
+
+  // Returns the number of blocks that are currently allowed in flight.
+  int window() const { return window_; }
+
+ private:
+  struct Block;
+
+  // Issues reads until `window_` blocks are buffered or in flight.
+  void FillWindow();
+  // Waits for the first block to be read and makes it the current block.
+  // Returns false if no block is buffered.
+  bool WaitForFront();
+  // Releases the first block and updates the window from the time the
+  // consumer spent on it.
+  void PopFront();
+  // Drops all buffered blocks and restarts reading at `pos_`.
+  void DropBlocks();
+  // Sizes the window from the moving averages of the read and consume times.
+  void UpdateWindow();
+
+  RandomAccessFile* const file_;  // Not owned.
+  const ReadaheadOptions options_;
+
+  std::deque<std::shared_ptr<Block>> blocks_;
+  int64_t pos_ = 0;          // Offset of the next byte returned to the caller.
+  int64_t next_offset_ = 0;  // Offset of the next block to read.
+  // Set once a block hit the end of the file or an error, after which no
+  // further reads are issued.
+  bool stop_reading_ = false;
+
+  int window_ = 1;
+  // Exponential moving averages, in microseconds, of the latency of a block
+  // read and of the time the consumer spends on a block.
+  double read_micros_ = 0;
+  double consume_micros_ = 0;
+
+  mutex mu_;
+  condition_variable cond_var_;
+  int num_outstanding_reads_ TF_GUARDED_BY(mu_) = 0;
+
+  ReadaheadInputStream(const ReadaheadInputStream&) = delete;
+  void operator=(const ReadaheadInputStream&) = delete;
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_READAHEAD_INPUTSTREAM_H_
@@ -0,0 +1,127 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/lib/io/readahead_inputstream.h"
+
+#include <atomic>
+#include <memory>
+
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/threadpool.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+class ReadaheadInputStreamTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    fname_ = testing::TmpDir() + "/readahead_inputstream_test";
+    TF_ASSERT_OK(WriteStringToFile(env_, fname_, "0123456789"));
+    TF_ASSERT_OK(env_->NewRandomAccessFile(fname_, &file_));
+  }
+
+  ReadaheadOptions Options(int64_t block_size, int max_blocks) {
+    ReadaheadOptions options;
+    options.block_size = block_size;
+    options.max_blocks = max_blocks;
+    options.schedule = [this](std::function<void()> fn) {
+      pool_.Schedule(std::move(fn));
+    };
+    options.buffer_usage_callback = [this](int64_t bytes_delta) {
+      buffered_bytes_ += bytes_delta;
+    };
+    return options;
+  }
+
+  Env* env_ = Env::Default();
+  string fname_;
+  std::unique_ptr<RandomAccessFile> file_;
+  thread::ThreadPool pool_{env_, "readahead_test", 4};
+  std::atomic<int64_t> buffered_bytes_{0};
+};
+
+TEST_F(ReadaheadInputStreamTest, ReadNBytes) {
+  for (int64_t block_size : {1, 2, 3, 4, 10, 20}) {
+    for (int max_blocks : {1, 2, 4}) {
+      tstring read;
+      {
+        ReadaheadInputStream in(file_.get(), Options(block_size, max_blocks));
+        TF_ASSERT_OK(in.ReadNBytes(3, &read));
+        EXPECT_EQ(read, "012");
+        EXPECT_EQ(3, in.Tell());
+        TF_ASSERT_OK(in.ReadNBytes(0, &read));
+        EXPECT_EQ(read, "");
+        EXPECT_EQ(3, in.Tell());
+        TF_ASSERT_OK(in.ReadNBytes(5, &read));
+        EXPECT_EQ(read, "34567");
+        EXPECT_EQ(8, in.Tell());
+        EXPECT_GT(buffered_bytes_, 0);
+        EXPECT_LE(buffered_bytes_, block_size * max_blocks);
+        EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(20, &read)));
+        EXPECT_EQ(read, "89");
+        EXPECT_EQ(10, in.Tell());
+        EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &read)));
+        EXPECT_EQ(read, "");
+        EXPECT_EQ(10, in.Tell());
+
+        TF_ASSERT_OK(in.Reset());
+        TF_ASSERT_OK(in.ReadNBytes(10, &read));
+        EXPECT_EQ(read, "0123456789");
+        EXPECT_GE(in.window(), 1);
+        EXPECT_LE(in.window(), max_blocks);
+      }
+      // Every block is released with the stream.
+      EXPECT_EQ(buffered_bytes_, 0);
+    }
+  }
+}
+
+TEST_F(ReadaheadInputStreamTest, SkipNBytes) {
+  for (int64_t block_size : {1, 2, 3, 4, 10, 20}) {
+    tstring read;
+    ReadaheadInputStream in(file_.get(), Options(block_size, /*max_blocks=*/2));
+    TF_ASSERT_OK(in.SkipNBytes(3));
+    EXPECT_EQ(3, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(2, &read));
+    EXPECT_EQ(read, "34");
+    TF_ASSERT_OK(in.SkipNBytes(0));
+    EXPECT_EQ(5, in.Tell());
+    TF_ASSERT_OK(in.SkipNBytes(2));
+    EXPECT_EQ(7, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(1, &read));
+    EXPECT_EQ(read, "7");
+    EXPECT_TRUE(errors::IsOutOfRange(in.SkipNBytes(5)));
+    EXPECT_EQ(10, in.Tell());
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &read)));
+    EXPECT_EQ(read, "");
+  }
+}
+
+TEST_F(ReadaheadInputStreamTest, ReadsInline) {
+  ReadaheadOptions options = Options(/*block_size=*/4, /*max_blocks=*/3);
+  options.schedule = nullptr;
+  ReadaheadInputStream in(file_.get(), options);
+  tstring read;
+  EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(11, &read)));
+  EXPECT_EQ(read, "0123456789");
+  EXPECT_EQ(10, in.Tell());
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tsl
@@ -21,6 +21,7 @@ limitations under the License.
 #include "tsl/lib/io/buffered_inputstream.h"
 #include "tsl/lib/io/compression.h"
 #include "tsl/lib/io/random_inputstream.h"
+#include "tsl/lib/io/readahead_inputstream.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/raw_coding.h"
@@ -59,7 +60,9 @@ RecordReader::RecordReader(RandomAccessFile* file,
     : options_(options),
       input_stream_(new RandomAccessInputStream(file)),
       last_read_failed_(false) {
-  if (options.buffer_size > 0) {
+  if (options.readahead.max_blocks > 0) {
+    input_stream_.reset(new ReadaheadInputStream(file, options.readahead));
+  } else if (options.buffer_size > 0) {
     input_stream_.reset(new BufferedInputStream(input_stream_.release(),
                                                 options.buffer_size, true));
   }
@@ -223,6 +226,16 @@ Status RecordReader::ReadRecord(uint64* offset, tstring* record) {
   return OkStatus();
 }
 
+Status RecordReader::ReadRecordAtIndex(absl::Span<const uint64> offsets,
+                                       int64_t index, tstring* record) {
+  if (index < 0 || index >= static_cast<int64_t>(offsets.size())) {
+    return errors::OutOfRange("Record index ", index, " out of range [0, ",
+                              offsets.size(), ")");
+  }
+  uint64 offset = offsets[index];
+  return ReadRecord(&offset, record);
+}
+
 Status RecordReader::SkipRecords(uint64* offset, int num_to_skip,
                                  int* num_skipped) {
   TF_RETURN_IF_ERROR(PositionInputStream(*offset));
@@ -16,7 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_LIB_IO_RECORD_READER_H_
 #define TENSORFLOW_TSL_LIB_IO_RECORD_READER_H_
 
+#include "absl/types/span.h"
 #include "tsl/lib/io/inputstream_interface.h"
+#include "tsl/lib/io/readahead_inputstream.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/stringpiece.h"
 #if !defined(IS_SLIM_BUILD)
@@ -46,6 +48,11 @@ struct RecordReaderOptions {
   // compressed files.) Consider using SequentialRecordReader.
   int64_t buffer_size = 0;
 
+  // If readahead.max_blocks is non-zero, the file is read sequentially with
+  // several reads in flight ahead of the consumer, which replaces the buffer
+  // configured by buffer_size. The same restrictions on seeking apply.
+  ReadaheadOptions readahead;
+
   static RecordReaderOptions CreateRecordReaderOptions(
       const string& compression_type);
 
@@ -96,6 +103,13 @@ class RecordReader {
   // OUT_OF_RANGE for end of file, or something else for an error.
   Status ReadRecord(uint64* offset, tstring* record);
 
+  // Reads the record number `index` of the file into *record, given the
+  // record offset index of the file, i.e. the offset of each of its records
+  // (see RecordWriterOptions::index_dest). Returns OUT_OF_RANGE if there is no
+  // such record. Only supported without compression and buffering.
+  Status ReadRecordAtIndex(absl::Span<const uint64> offsets, int64_t index,
+                           tstring* record);
+
   // Skip num_to_skip record starting at "*offset" and update *offset
   // to point to the offset of the next num_to_skip + 1 record.
   // Return OK on success, OUT_OF_RANGE for end of file, or something
@@ -27,6 +27,7 @@ limitations under the License.
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/logging.h"
+#include "tsl/platform/raw_coding.h"
 #include "tsl/platform/status.h"
 #include "tsl/platform/strcat.h"
 #include "tsl/platform/test.h"
@@ -233,6 +234,50 @@ TEST(RecordReaderWriterTest, TestSkipOutOfRange) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestReadRecordAtIndex) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_index_test";
+  string index_fname = fname + ".idx";
+
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    std::unique_ptr<WritableFile> index_file;
+    TF_CHECK_OK(env->NewWritableFile(index_fname, &index_file));
+
+    io::RecordWriterOptions options;
+    options.index_dest = index_file.get();
+    io::RecordWriter writer(file.get(), options);
+    TF_EXPECT_OK(writer.WriteRecord("abc"));
+    TF_EXPECT_OK(writer.WriteRecord(""));
+    TF_EXPECT_OK(writer.WriteRecord("defg"));
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(file->Close());
+    TF_CHECK_OK(index_file->Close());
+  }
+
+  string index;
+  TF_CHECK_OK(ReadFileToString(env, index_fname, &index));
+  ASSERT_EQ(index.size(), 3 * sizeof(uint64));
+  std::vector<uint64> offsets;
+  for (size_t i = 0; i < 3; ++i) {
+    offsets.push_back(core::DecodeFixed64(index.data() + i * sizeof(uint64)));
+  }
+
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  io::RecordReader reader(read_file.get());
+  tstring record;
+  TF_EXPECT_OK(reader.ReadRecordAtIndex(offsets, 2, &record));
+  EXPECT_EQ("defg", record);
+  TF_EXPECT_OK(reader.ReadRecordAtIndex(offsets, 0, &record));
+  EXPECT_EQ("abc", record);
+  TF_EXPECT_OK(reader.ReadRecordAtIndex(offsets, 1, &record));
+  EXPECT_EQ("", record);
+  EXPECT_EQ(error::OUT_OF_RANGE,
+            reader.ReadRecordAtIndex(offsets, 3, &record).code());
+}
+
 TEST(RecordReaderWriterTest, TestMalformedInput) {
   Env* env = Env::Default();
   string fname =
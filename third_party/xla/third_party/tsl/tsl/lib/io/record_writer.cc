@@ -85,6 +85,12 @@ RecordWriter::RecordWriter(WritableFile* dest,
     LOG(FATAL) << "Unspecified compression type :" << options.compression_type;
   }
 #endif
+  if (options_.index_dest != nullptr &&
+      options_.compression_type != RecordWriterOptions::NONE) {
+    LOG(ERROR) << "Record offset indices are not supported with compression."
+               << " No index will be written.";
+    options_.index_dest = nullptr;
+  }
 }
 
 RecordWriter::~RecordWriter() {
@@ -106,6 +112,7 @@ Status RecordWriter::WriteRecord(StringPiece data) {
   //  uint32    masked crc of length
   //  byte      data[length]
   //  uint32    masked crc of data
+  TF_RETURN_IF_ERROR(AppendIndexEntry(data.size()));
   char header[kHeaderSize];
   char footer[kFooterSize];
   PopulateHeader(header, data.data(), data.size());
@@ -126,6 +133,7 @@ Status RecordWriter::WriteRecord(const absl::Cord& data) {
   //  uint32    masked crc of length
   //  byte      data[length]
   //  uint32    masked crc of data
+  TF_RETURN_IF_ERROR(AppendIndexEntry(data.size()));
   char header[kHeaderSize];
   char footer[kFooterSize];
   PopulateHeader(header, data);
@@ -136,6 +144,15 @@ Status RecordWriter::WriteRecord(const absl::Cord& data) {
 }
 #endif
 
+Status RecordWriter::AppendIndexEntry(size_t n) {
+  const uint64 offset = offset_;
+  offset_ += kHeaderSize + n + kFooterSize;
+  if (options_.index_dest == nullptr) return OkStatus();
+  char entry[sizeof(uint64)];
+  core::EncodeFixed64(entry, offset);
+  return options_.index_dest->Append(StringPiece(entry, sizeof(entry)));
+}
+
 Status RecordWriter::Close() {
   if (dest_ == nullptr) return OkStatus();
   if (IsZlibCompressed(options_) || IsSnappyCompressed(options_)) {
@@ -45,6 +45,13 @@ struct RecordWriterOptions {
   };
   CompressionType compression_type = NONE;
 
+  // If set, the offset of each record written is appended to `*index_dest` as
+  // a little-endian uint64, which makes it the record offset index of the
+  // file. Only supported without compression, since the records of compressed
+  // files do not start at fixed offsets. "*index_dest" must remain live while
+  // the writer is in use.
+  WritableFile* index_dest = nullptr;
+
   static RecordWriterOptions CreateRecordWriterOptions(
       const string& compression_type);
 
@@ -111,8 +118,14 @@ class RecordWriter {
 #endif
 
  private:
+  // Appends the offset of the next record, of `n` bytes, to the index if
+  // there is one.
+  Status AppendIndexEntry(size_t n);
+
   WritableFile* dest_;
   RecordWriterOptions options_;
+  // Offset in the file of the next record.
+  uint64 offset_ = 0;
 
   inline static uint32 MaskedCrc(const char* data, size_t n) {
     return crc32c::Mask(crc32c::Value(data, n));
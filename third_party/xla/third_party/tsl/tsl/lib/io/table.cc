@@ -15,8 +15,11 @@ limitations under the License.
 
 #include "tsl/lib/io/table.h"
 
+#include <string>
+
 #include "tsl/lib/io/block.h"
 #include "tsl/lib/io/cache.h"
+#include "tsl/lib/io/filter_block.h"
 #include "tsl/lib/io/format.h"
 #include "tsl/lib/io/table_options.h"
 #include "tsl/lib/io/two_level_iterator.h"
@@ -28,17 +31,47 @@ namespace tsl {
 namespace table {
 
 struct Table::Rep {
-  ~Rep() { delete index_block; }
+  ~Rep() {
+    delete filter;
+    delete[] filter_data;
+    delete index_block;
+  }
 
   Options options;
   absl::Status status;
   RandomAccessFile* file;
   uint64 cache_id;
+  FilterBlockReader* filter = nullptr;
+  const char* filter_data = nullptr;  // Owned by Rep if not nullptr.
 
   BlockHandle metaindex_handle;  // Handle to metaindex_block: saved from footer
   Block* index_block;
 };
 
+namespace {
+
+// Size of an empty block: a single restart point and the number of restarts.
+// The metaindex block of tables without meta blocks is empty, so it is not
+// worth reading.
+constexpr uint64 kEmptyBlockSize = 2 * sizeof(uint32);
+
+// State of a `Table::Get` call, updated by `SaveValue`.
+struct GetState {
+  StringPiece key;
+  std::string* value;
+  bool found;
+};
+
+void SaveValue(void* arg, const StringPiece& key, const StringPiece& value) {
+  GetState* state = reinterpret_cast<GetState*>(arg);
+  if (key == state->key) {
+    state->value->assign(value.data(), value.size());
+    state->found = true;
+  }
+}
+
+}  // namespace
+
 absl::Status Table::Open(const Options& options, RandomAccessFile* file,
                          uint64 size, Table** table) {
   *table = nullptr;
@@ -75,6 +108,7 @@ absl::Status Table::Open(const Options& options, RandomAccessFile* file,
     rep->index_block = index_block;
     rep->cache_id = (options.block_cache ? options.block_cache->NewId() : 0);
     *table = new Table(rep);
+    (*table)->ReadMeta(footer);
   } else {
     if (index_block) delete index_block;
   }
@@ -84,6 +118,43 @@ absl::Status Table::Open(const Options& options, RandomAccessFile* file,
 
 Table::~Table() { delete rep_; }
 
+void Table::ReadMeta(const Footer& footer) {
+  if (footer.metaindex_handle().size() <= kEmptyBlockSize) {
+    return;
+  }
+  BlockContents contents;
+  if (!ReadBlock(rep_->file, footer.metaindex_handle(), &contents).ok()) {
+    // Do not propagate errors since meta info is not needed for operation
+    return;
+  }
+  Block* meta = new Block(contents);
+
+  Iterator* iter = meta->NewIterator();
+  iter->Seek(kFilterBlockName);
+  if (iter->Valid() && iter->key() == StringPiece(kFilterBlockName)) {
+    ReadFilter(iter->value());
+  }
+  delete iter;
+  delete meta;
+}
+
+void Table::ReadFilter(const StringPiece& filter_handle_value) {
+  StringPiece v = filter_handle_value;
+  BlockHandle filter_handle;
+  if (!filter_handle.DecodeFrom(&v).ok()) {
+    return;
+  }
+
+  BlockContents block;
+  if (!ReadBlock(rep_->file, filter_handle, &block).ok()) {
+    return;
+  }
+  if (block.heap_allocated) {
+    rep_->filter_data = block.data.data();  // Will need to delete later
+  }
+  rep_->filter = new FilterBlockReader(block.data);
+}
+
 static void DeleteBlock(void* arg, void* ignored) {
   delete reinterpret_cast<Block*>(arg);
 }
@@ -165,13 +236,21 @@ absl::Status Table::InternalGet(const StringPiece& k, void* arg,
   Iterator* iiter = rep_->index_block->NewIterator();
   iiter->Seek(k);
   if (iiter->Valid()) {
-    Iterator* block_iter = BlockReader(this, iiter->value());
-    block_iter->Seek(k);
-    if (block_iter->Valid()) {
-      (*saver)(arg, block_iter->key(), block_iter->value());
+    StringPiece handle_value = iiter->value();
+    FilterBlockReader* filter = rep_->filter;
+    BlockHandle handle;
+    if (filter != nullptr && handle.DecodeFrom(&handle_value).ok() &&
+        !filter->KeyMayMatch(handle.offset(), k)) {
+      // Not found
+    } else {
+      Iterator* block_iter = BlockReader(this, iiter->value());
+      block_iter->Seek(k);
+      if (block_iter->Valid()) {
+        (*saver)(arg, block_iter->key(), block_iter->value());
+      }
+      s = block_iter->status();
+      delete block_iter;
     }
-    s = block_iter->status();
-    delete block_iter;
   }
   if (s.ok()) {
     s = iiter->status();
@@ -180,6 +259,16 @@ absl::Status Table::InternalGet(const StringPiece& k, void* arg,
   return s;
 }
 
+absl::Status Table::Get(const StringPiece& key, std::string* value) const {
+  GetState state = {key, value, /*found=*/false};
+  TF_RETURN_IF_ERROR(
+      const_cast<Table*>(this)->InternalGet(key, &state, &SaveValue));
+  if (!state.found) {
+    return errors::NotFound("Key not found in table");
+  }
+  return absl::OkStatus();
+}
+
 uint64 Table::ApproximateOffsetOf(const StringPiece& key) const {
   Iterator* index_iter = rep_->index_block->NewIterator();
   index_iter->Seek(key);
@@ -18,6 +18,8 @@ limitations under the License.
 
 #include <stdint.h>
 
+#include <string>
+
 #include "tsl/lib/io/iterator.h"
 
 namespace tsl {
@@ -26,6 +28,7 @@ class RandomAccessFile;
 
 namespace table {
 
+class Footer;
 struct Options;
 
 // A Table is a sorted map from strings to strings.  Tables are
@@ -61,6 +64,12 @@ class Table {
   // be close to the file length.
   uint64 ApproximateOffsetOf(const StringPiece& key) const;
 
+  // Looks up `key`.  If it is in the table, stores its value in "*value" and
+  // returns ok.  Otherwise returns a NotFound error.  If the table was built
+  // with bloom filters, the data block that could hold `key` is only read
+  // when its filter matches `key`.
+  absl::Status Get(const StringPiece& key, std::string* value) const;
+
  private:
   struct Rep;
   Rep* rep_;
@@ -68,6 +77,11 @@ class Table {
   explicit Table(Rep* rep) { rep_ = rep; }
   static Iterator* BlockReader(void*, const StringPiece&);
 
+  // Reads the meta blocks of the table, currently only its filter block.
+  // Errors are ignored, since the table can be read without meta blocks.
+  void ReadMeta(const Footer& footer);
+  void ReadFilter(const StringPiece& filter_handle_value);
+
   // Calls (*handle_result)(arg, ...) with the entry found after a call
   // to Seek(key).  May not make such a call if filter policy says
   // that key is not present.
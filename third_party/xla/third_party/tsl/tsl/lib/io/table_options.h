@@ -68,6 +68,13 @@ struct Options {
 
   // If non-null, use the specified cache for blocks.
   Cache* block_cache = nullptr;
+
+  // If positive, a bloom filter of the keys of each data block is stored in
+  // the table, with this many bits per key.  `Table::Get` then skips reading
+  // the data blocks that cannot hold the key.  10 bits per key give a false
+  // positive rate of about 1%.  Tables are read the same way with or without
+  // filters, so this only matters when building a table.
+  int bloom_filter_bits_per_key = 0;
 };
 
 }  // namespace table
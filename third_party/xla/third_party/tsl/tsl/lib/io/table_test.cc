@@ -21,6 +21,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/strings/escaping.h"
+#include "tsl/lib/core/status_test_util.h"
 #include "tsl/lib/io/block.h"
 #include "tsl/lib/io/block_builder.h"
 #include "tsl/lib/io/format.h"
@@ -30,6 +31,7 @@ limitations under the License.
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/snappy.h"
+#include "tsl/platform/stringprintf.h"
 #include "tsl/platform/test.h"
 
 namespace tsl {
@@ -246,6 +248,10 @@ class TableConstructor : public Constructor {
     return table_->ApproximateOffsetOf(key);
   }
 
+  absl::Status Get(const StringPiece& key, string* value) const {
+    return table_->Get(key, value);
+  }
+
   uint64 BytesRead() const { return source_->BytesRead(); }
 
  private:
@@ -634,5 +640,66 @@ TEST(TableTest, SeekToFirstKeyDoesNotReadTooMuch) {
   EXPECT_LT(c.BytesRead(), 200);
 }
 
+// Builds a table of `num_keys` keys "k<i>" of 100 bytes values.
+static void BuildLookupTable(int bloom_filter_bits_per_key, int num_keys,
+                             TableConstructor* c) {
+  for (int i = 0; i < num_keys; ++i) {
+    c->Add(strings::Printf("k%06d", i), string(100, 'a' + i % 26));
+  }
+  std::vector<string> keys;
+  KVMap kvmap;
+  Options options;
+  options.block_size = 1024;
+  options.compression = kNoCompression;
+  options.bloom_filter_bits_per_key = bloom_filter_bits_per_key;
+  c->Finish(options, &keys, &kvmap);
+}
+
+TEST(TableTest, Get) {
+  TableConstructor c;
+  BuildLookupTable(/*bloom_filter_bits_per_key=*/0, 1000, &c);
+  string value;
+  TF_EXPECT_OK(c.Get("k000000", &value));
+  EXPECT_EQ(value, string(100, 'a'));
+  TF_EXPECT_OK(c.Get("k000999", &value));
+  EXPECT_EQ(value, string(100, 'a' + 999 % 26));
+  EXPECT_TRUE(errors::IsNotFound(c.Get("k000000a", &value)));
+  EXPECT_TRUE(errors::IsNotFound(c.Get("k001000", &value)));
+  EXPECT_TRUE(errors::IsNotFound(c.Get("", &value)));
+}
+
+TEST(TableTest, GetWithBloomFilter) {
+  const int kNumKeys = 1000;
+  TableConstructor c;
+  BuildLookupTable(/*bloom_filter_bits_per_key=*/10, kNumKeys, &c);
+  string value;
+  for (int i = 0; i < kNumKeys; ++i) {
+    TF_ASSERT_OK(c.Get(strings::Printf("k%06d", i), &value));
+    EXPECT_EQ(value, string(100, 'a' + i % 26));
+  }
+
+  // Keys that are not in the table are mostly ruled out by the filters, so
+  // few data blocks are read to look them up.
+  const uint64 bytes_read = c.BytesRead();
+  for (int i = 0; i < kNumKeys; ++i) {
+    EXPECT_TRUE(
+        errors::IsNotFound(c.Get(strings::Printf("k%06da", i), &value)));
+  }
+  EXPECT_LT(c.BytesRead() - bytes_read, kNumKeys / 10 * 1024);
+}
+
+TEST(TableTest, GetWithoutBloomFilterReadsDataBlocks) {
+  const int kNumKeys = 1000;
+  TableConstructor c;
+  BuildLookupTable(/*bloom_filter_bits_per_key=*/0, kNumKeys, &c);
+  string value;
+  const uint64 bytes_read = c.BytesRead();
+  for (int i = 0; i < kNumKeys; ++i) {
+    EXPECT_TRUE(
+        errors::IsNotFound(c.Get(strings::Printf("k%06da", i), &value)));
+  }
+  EXPECT_GT(c.BytesRead() - bytes_read, kNumKeys / 2 * 1024);
+}
+
 }  // namespace table
 }  // namespace tsl
@@ -0,0 +1,47 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_MONITORING_CELL_SHARD_H_
+#define TENSORFLOW_TSL_LIB_MONITORING_CELL_SHARD_H_
+
+#include <atomic>
+#include <cstddef>
+
+namespace tsl {
+namespace monitoring {
+namespace internal {
+
+// Cells which are updated on hot paths keep their state in this many shards,
+// each on its own cache line, so that threads updating the same cell do not
+// contend for one line. The shards are summed up when the cell is read.
+inline constexpr int kNumCellShards = 8;
+
+inline constexpr size_t kCellShardAlignment = 64;
+
+// Returns the shard in [0, kNumCellShards) which the calling thread updates.
+// Threads are given the shards round-robin the first time they update any
+// cell, so that up to kNumCellShards threads never share a shard.
+inline int CurrentThreadCellShard() {
+  static std::atomic<unsigned int> next_shard{0};
+  thread_local const int shard =
+      next_shard.fetch_add(1, std::memory_order_relaxed) % kNumCellShards;
+  return shard;
+}
+
+}  // namespace internal
+}  // namespace monitoring
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_MONITORING_CELL_SHARD_H_
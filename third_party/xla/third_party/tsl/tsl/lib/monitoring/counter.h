@@ -84,6 +84,7 @@ class Counter {
 #include <memory>
 #include <tuple>
 
+#include "tsl/lib/monitoring/cell_shard.h"
 #include "tsl/lib/monitoring/collection_registry.h"
 #include "tsl/lib/monitoring/metric_def.h"
 #include "tsl/platform/logging.h"
@@ -103,10 +104,14 @@ namespace monitoring {
 // to which both cells belong) and performance (since map indexing and
 // associated locking are both avoided).
 //
+// The value is kept in per-thread shards, so that increments from many threads
+// do not contend for one cache line, and the shards are summed when the value
+// is read.
+//
 // This class is thread-safe.
 class CounterCell {
  public:
-  explicit CounterCell(int64_t value) : value_(value) {}
+  explicit CounterCell(int64_t value) { shards_[0].value = value; }
   ~CounterCell() {}
 
   // Atomically increments the value by step.
@@ -117,7 +122,10 @@ class CounterCell {
   int64_t value() const;
 
  private:
-  std::atomic<int64_t> value_;
+  struct alignas(internal::kCellShardAlignment) Shard {
+    std::atomic<int64_t> value{0};
+  };
+  std::array<Shard, internal::kNumCellShards> shards_;
 
   CounterCell(const CounterCell&) = delete;
   void operator=(const CounterCell&) = delete;
@@ -203,10 +211,17 @@ class Counter {
 
 inline void CounterCell::IncrementBy(const int64_t step) {
   DCHECK_LE(0, step) << "Must not decrement cumulative metrics.";
-  value_ += step;
+  shards_[internal::CurrentThreadCellShard()].value.fetch_add(
+      step, std::memory_order_relaxed);
 }
 
-inline int64_t CounterCell::value() const { return value_; }
+inline int64_t CounterCell::value() const {
+  int64_t value = 0;
+  for (const Shard& shard : shards_) {
+    value += shard.value.load(std::memory_order_relaxed);
+  }
+  return value;
+}
 
 template <int NumLabels>
 template <typename... MetricDefArgs>
@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tsl/lib/monitoring/sampler.h"
 
+#include <algorithm>
+#include <utility>
+
 // clang-format off
 // Required for IS_MOBILE_PLATFORM
 #include "tsl/platform/platform.h"
@@ -98,6 +101,40 @@ class ExponentialBuckets : public Buckets {
 
 }  // namespace
 
+HistogramProto SamplerCell::value() const {
+  HistogramProto pb;
+  bool has_samples = false;
+  for (const Shard& shard : shards_) {
+    HistogramProto shard_pb;
+    {
+      mutex_lock l(shard.mu);
+      if (shard.histogram == nullptr) continue;
+      shard.histogram->EncodeToProto(&shard_pb,
+                                     true /* preserve_zero_buckets */);
+    }
+    if (!has_samples) {
+      pb = std::move(shard_pb);
+      has_samples = true;
+      continue;
+    }
+    // With the zero buckets preserved, all the shards encode the same bucket
+    // limits.
+    pb.set_min(std::min(pb.min(), shard_pb.min()));
+    pb.set_max(std::max(pb.max(), shard_pb.max()));
+    pb.set_num(pb.num() + shard_pb.num());
+    pb.set_sum(pb.sum() + shard_pb.sum());
+    pb.set_sum_squares(pb.sum_squares() + shard_pb.sum_squares());
+    for (int i = 0; i < pb.bucket_size(); ++i) {
+      pb.set_bucket(i, pb.bucket(i) + shard_pb.bucket(i));
+    }
+  }
+  if (!has_samples) {
+    histogram::Histogram(bucket_limits_)
+        .EncodeToProto(&pb, true /* preserve_zero_buckets */);
+  }
+  return pb;
+}
+
 // static
 std::unique_ptr<Buckets> Buckets::Explicit(std::vector<double> bucket_limits) {
   return std::unique_ptr<Buckets>(
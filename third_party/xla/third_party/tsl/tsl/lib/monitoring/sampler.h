@@ -115,6 +115,7 @@ class Sampler {
 
 #include <float.h>
 
+#include <array>
 #include <map>
 #include <memory>
 #include <tuple>
@@ -122,6 +123,7 @@ class Sampler {
 #include <vector>
 
 #include "tsl/lib/histogram/histogram.h"
+#include "tsl/lib/monitoring/cell_shard.h"
 #include "tsl/lib/monitoring/collection_registry.h"
 #include "tsl/lib/monitoring/metric_def.h"
 #include "tsl/platform/macros.h"
@@ -142,11 +144,15 @@ using tensorflow::HistogramProto;
 // to which both cells belong) and performance (since map indexing and
 // associated locking are both avoided).
 //
+// The samples are added to per-thread shards of the histogram, so that
+// threads adding to the same cell do not contend for one lock, and the shards
+// are merged when the value is read.
+//
 // This class is thread-safe.
 class SamplerCell {
  public:
   explicit SamplerCell(const std::vector<double>& bucket_limits)
-      : histogram_(bucket_limits) {}
+      : bucket_limits_(bucket_limits) {}
 
   ~SamplerCell() {}
 
@@ -157,7 +163,14 @@ class SamplerCell {
   HistogramProto value() const;
 
  private:
-  histogram::ThreadSafeHistogram histogram_;
+  struct alignas(internal::kCellShardAlignment) Shard {
+    mutable mutex mu;
+    // Created when the first sample is added to the shard.
+    std::unique_ptr<histogram::Histogram> histogram TF_GUARDED_BY(mu);
+  };
+
+  const std::vector<double> bucket_limits_;
+  std::array<Shard, internal::kNumCellShards> shards_;
 
   SamplerCell(const SamplerCell&) = delete;
   void operator=(const SamplerCell&) = delete;
@@ -288,12 +301,13 @@ class Sampler {
 //  Implementation details follow. API readers may skip.
 ////
 
-inline void SamplerCell::Add(const double sample) { histogram_.Add(sample); }
-
-inline HistogramProto SamplerCell::value() const {
-  HistogramProto pb;
-  histogram_.EncodeToProto(&pb, true /* preserve_zero_buckets */);
-  return pb;
+inline void SamplerCell::Add(const double sample) {
+  Shard& shard = shards_[internal::CurrentThreadCellShard()];
+  mutex_lock l(shard.mu);
+  if (shard.histogram == nullptr) {
+    shard.histogram = std::make_unique<histogram::Histogram>(bucket_limits_);
+  }
+  shard.histogram->Add(sample);
 }
 
 template <int NumLabels>
@@ -111,6 +111,8 @@ class PhiloxRandom {
   // The type for the 64-bit key stored in the form of two 32-bit uint
   // that are used in the diffusion process.
   using Key = Array<uint32_t, 2>;
+  // The number of groups computed together by GenerateBatch().
+  static constexpr int kBatchSize = 16;
 
   PHILOX_DEVICE_INLINE
   PhiloxRandom() {}
@@ -190,6 +192,59 @@ class PhiloxRandom {
     return counter;
   }
 
+  // Equivalent to `count` calls of operator(), storing the results in
+  // `results[0..count)`. The rounds of kBatchSize consecutive counters are
+  // computed together, one counter per lane, in loops that compilers turn
+  // into SIMD multiplies and xors (e.g. 8 lanes with AVX2), so this is faster
+  // than the sequential calls on CPU for large counts. The results are
+  // bit-identical to those of operator().
+  void GenerateBatch(ResultType* results, int64_t count) {
+    uint32_t c0[kBatchSize], c1[kBatchSize], c2[kBatchSize], c3[kBatchSize];
+    while (count > 0) {
+      const int n = count < kBatchSize ? static_cast<int>(count) : kBatchSize;
+      ResultType lane_counter = counter_;
+      for (int i = 0; i < kBatchSize; ++i) {
+        c0[i] = lane_counter[0];
+        c1[i] = lane_counter[1];
+        c2[i] = lane_counter[2];
+        c3[i] = lane_counter[3];
+        IncrementCounter(&lane_counter);
+      }
+
+      uint32_t key0 = key_[0];
+      uint32_t key1 = key_[1];
+      for (int round = 0; round < 10; ++round) {
+        // Same as ComputeSingleRound() for each lane.
+        for (int i = 0; i < kBatchSize; ++i) {
+          const uint64_t product0 =
+              static_cast<uint64_t>(kPhiloxM4x32A) * c0[i];
+          const uint64_t product1 =
+              static_cast<uint64_t>(kPhiloxM4x32B) * c2[i];
+          const uint32_t next0 =
+              static_cast<uint32_t>(product1 >> 32) ^ c1[i] ^ key0;
+          const uint32_t next2 =
+              static_cast<uint32_t>(product0 >> 32) ^ c3[i] ^ key1;
+          c0[i] = next0;
+          c1[i] = static_cast<uint32_t>(product1);
+          c2[i] = next2;
+          c3[i] = static_cast<uint32_t>(product0);
+        }
+        key0 += kPhiloxW32A;
+        key1 += kPhiloxW32B;
+      }
+
+      for (int i = 0; i < n; ++i) {
+        results[i][0] = c0[i];
+        results[i][1] = c1[i];
+        results[i][2] = c2[i];
+        results[i][3] = c3[i];
+      }
+      Skip(n);
+      results += n;
+      count -= n;
+    }
+  }
+
  private:
   // We use the same constants as recommended by the original paper.
   static constexpr uint32_t kPhiloxW32A = 0x9E3779B9;
@@ -198,11 +253,14 @@ class PhiloxRandom {
   static constexpr uint32_t kPhiloxM4x32B = 0xCD9E8D57;
 
   // Helper function to skip the next sample of 128-bits in the current stream.
-  PHILOX_DEVICE_INLINE void SkipOne() {
-    if (++counter_[0] == 0) {
-      if (++counter_[1] == 0) {
-        if (++counter_[2] == 0) {
-          ++counter_[3];
+  PHILOX_DEVICE_INLINE void SkipOne() { IncrementCounter(&counter_); }
+
+  // Helper function to increment the 128-bit `counter` by one.
+  PHILOX_DEVICE_INLINE static void IncrementCounter(ResultType* counter) {
+    if (++(*counter)[0] == 0) {
+      if (++(*counter)[1] == 0) {
+        if (++(*counter)[2] == 0) {
+          ++(*counter)[3];
         }
       }
     }
@@ -69,6 +69,43 @@ TEST(PhiloxRandomTest, SkipMatchTest) {
   }
 }
 
+// This test checks that generating samples in batches returns the same
+// samples as generating them one at a time, including across the carries of
+// the counter and for counts that are not a multiple of the batch size.
+TEST(PhiloxRandomTest, GenerateBatchMatchTest) {
+  constexpr int count = 3 * PhiloxRandom::kBatchSize + 5;
+
+  uint64 test_seed = GetTestSeed();
+  PhiloxRandom::ResultType counter;
+  counter[0] = 0xfffffff0;
+  counter[1] = 0xffffffff;
+  counter[2] = static_cast<uint32>(test_seed);
+  counter[3] = 0;
+  PhiloxRandom::Key key;
+  key[0] = static_cast<uint32>(test_seed);
+  key[1] = static_cast<uint32>(test_seed >> 32);
+
+  PhiloxRandom batch_gen(counter, key);
+  std::vector<PhiloxRandom::ResultType> batch_samples(count);
+  batch_gen.GenerateBatch(&batch_samples[0], 1);
+  batch_gen.GenerateBatch(&batch_samples[1], count - 1);
+
+  PhiloxRandom gen(counter, key);
+  for (int i = 0; i < count; ++i) {
+    const PhiloxRandom::ResultType sample = gen();
+    for (int j = 0; j < PhiloxRandom::kResultElementCount; ++j) {
+      ASSERT_EQ(batch_samples[i][j], sample[j]) << i;
+    }
+  }
+
+  // Both generators continue with the same samples.
+  const PhiloxRandom::ResultType batch_next = batch_gen();
+  const PhiloxRandom::ResultType next = gen();
+  for (int j = 0; j < PhiloxRandom::kResultElementCount; ++j) {
+    ASSERT_EQ(batch_next[j], next[j]);
+  }
+}
+
 }  // namespace
 }  // namespace random
 }  // namespace tsl
@@ -29,6 +29,27 @@ limitations under the License.
 #include <time.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <memory>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+// IORING_FEAT_RW_CUR_POS was added together with IORING_OP_READ in Linux 5.6.
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && \
+    defined(IORING_FEAT_RW_CUR_POS)
+#define TSL_POSIX_HAVE_IO_URING 1
+#endif
+#endif
+#endif
+#ifndef TSL_POSIX_HAVE_IO_URING
+#define TSL_POSIX_HAVE_IO_URING 0
+#endif
+
+#include "absl/types/span.h"
 #include "tsl/platform/default/posix_file_system.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
@@ -45,6 +66,228 @@ using ::tsl::errors::IOError;
 // 128KB of copy buffer
 constexpr size_t kPosixCopyFileBufferSize = 128 * 1024;
 
+#if TSL_POSIX_HAVE_IO_URING
+namespace {
+
+// A minimal io_uring submission and completion queue, set up with the raw
+// system calls so that no liburing dependency is needed. Used by
+// PosixRandomAccessFile::ReadMany() to keep a batch of preads in flight from a
+// single thread.
+//
+// Not thread-safe: every thread that calls ReadMany() uses its own ring.
+class IoUring {
+ public:
+  // The number of reads in flight at once.
+  static constexpr unsigned kNumEntries = 64;
+
+  // Returns the ring of the calling thread, or null if io_uring is not usable,
+  // e.g. on kernels older than 5.6 or when it is blocked by a seccomp policy.
+  static IoUring* ForCurrentThread() {
+    thread_local std::unique_ptr<IoUring> ring = Create();
+    return ring != nullptr && ring->supported_ ? ring.get() : nullptr;
+  }
+
+  ~IoUring() {
+    if (sqes_ != MAP_FAILED) munmap(sqes_, sqes_size_);
+    if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != MAP_FAILED) munmap(sq_ring_, sq_ring_size_);
+    if (ring_fd_ >= 0) close(ring_fd_);
+  }
+
+  // Reads each of "requests" from "fd" with IORING_OP_READ. Calls
+  // "read_rest(request, bytes_read)" to finish the requests that io_uring
+  // completes short, and returns false if io_uring turns out not to support
+  // the reads, in which case "requests" are left for the caller.
+  template <typename ReadRest>
+  bool ReadMany(int fd, absl::Span<RandomAccessFile::ReadRequest> requests,
+                const ReadRest& read_rest) {
+    size_t next_to_submit = 0;
+    size_t num_completed = 0;
+    // The reads queued in the submission queue that the kernel has not
+    // consumed yet, and those it has and that are not completed.
+    unsigned num_to_submit = 0;
+    unsigned num_in_flight = 0;
+    while (num_completed < requests.size()) {
+      // Fills the submission queue.
+      unsigned sq_tail = *sq_tail_;
+      while (next_to_submit < requests.size() &&
+             num_in_flight + num_to_submit < sq_entries_) {
+        RandomAccessFile::ReadRequest& request = requests[next_to_submit];
+        const unsigned index = sq_tail & *sq_ring_mask_;
+        io_uring_sqe* sqe = &sqes_[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uint64_t>(request.scratch);
+        // Longer requests are finished by "read_rest".
+        sqe->len = static_cast<uint32_t>(
+            std::min<size_t>(request.n, std::numeric_limits<int32_t>::max()));
+        sqe->off = request.offset;
+        sqe->user_data = next_to_submit;
+        sq_array_[index] = index;
+        ++sq_tail;
+        ++num_to_submit;
+        ++next_to_submit;
+      }
+      __atomic_store_n(sq_tail_, sq_tail, __ATOMIC_RELEASE);
+
+      // Submits the new reads and waits for at least one completion.
+      int r;
+      do {
+        r = syscall(__NR_io_uring_enter, ring_fd_, num_to_submit, 1,
+                    IORING_ENTER_GETEVENTS, nullptr, 0);
+      } while (r < 0 && errno == EINTR);
+      if (r < 0) {
+        // The kernel may still write into the buffers of the reads in flight,
+        // so they have to complete before the caller reads or frees them. The
+        // ring is given up, and the reads left in the submission queue are
+        // never submitted.
+        LOG(ERROR) << "io_uring_enter() failed: " << strerror(errno);
+        WaitForAll(num_in_flight);
+        supported_ = false;
+        return false;
+      }
+      // The kernel may consume fewer entries than requested, and the others
+      // are submitted by the next call.
+      num_to_submit -= r;
+      num_in_flight += r;
+
+      // Reaps the completions.
+      unsigned cq_head = *cq_head_;
+      const unsigned cq_tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+      for (; cq_head != cq_tail; ++cq_head) {
+        const io_uring_cqe& cqe = cqes_[cq_head & *cq_ring_mask_];
+        RandomAccessFile::ReadRequest& request = requests[cqe.user_data];
+        --num_in_flight;
+        ++num_completed;
+        if (cqe.res == -EINVAL && num_completed == 1) {
+          // IORING_OP_READ is not supported by this kernel. The first
+          // completion tells, so no other read has been completed yet.
+          __atomic_store_n(cq_head_, cq_head + 1, __ATOMIC_RELEASE);
+          WaitForAll(num_in_flight);
+          supported_ = false;
+          return false;
+        }
+        if (cqe.res < 0) {
+          if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+            read_rest(request, 0);
+          } else {
+            request.result = StringPiece(request.scratch, 0);
+            request.status = IOError("io_uring read", -cqe.res);
+          }
+        } else if (static_cast<size_t>(cqe.res) < request.n) {
+          read_rest(request, cqe.res);
+        } else {
+          request.result = StringPiece(request.scratch, request.n);
+          request.status = absl::OkStatus();
+        }
+      }
+      __atomic_store_n(cq_head_, cq_head, __ATOMIC_RELEASE);
+    }
+    return true;
+  }
+
+ private:
+  IoUring() = default;
+
+  static std::unique_ptr<IoUring> Create() {
+    std::unique_ptr<IoUring> ring(new IoUring());
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    ring->ring_fd_ = syscall(__NR_io_uring_setup, kNumEntries, &params);
+    if (ring->ring_fd_ < 0) {
+      VLOG(1) << "io_uring is not available: " << strerror(errno);
+      return nullptr;
+    }
+    ring->sq_entries_ = params.sq_entries;
+
+    ring->sq_ring_size_ =
+        params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size_ =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+      ring->sq_ring_size_ = ring->cq_ring_size_ =
+          std::max(ring->sq_ring_size_, ring->cq_ring_size_);
+    }
+    ring->sq_ring_ = mmap(nullptr, ring->sq_ring_size_, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, ring->ring_fd_,
+                          IORING_OFF_SQ_RING);
+    if (ring->sq_ring_ == MAP_FAILED) return nullptr;
+    if (single_mmap) {
+      ring->cq_ring_ = ring->sq_ring_;
+    } else {
+      ring->cq_ring_ = mmap(nullptr, ring->cq_ring_size_,
+                            PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            ring->ring_fd_, IORING_OFF_CQ_RING);
+      if (ring->cq_ring_ == MAP_FAILED) return nullptr;
+    }
+    ring->sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes =
+        mmap(nullptr, ring->sqes_size_, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, ring->ring_fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) return nullptr;
+    ring->sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+    char* sq = static_cast<char*>(ring->sq_ring_);
+    ring->sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    ring->sq_ring_mask_ =
+        reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    ring->sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    char* cq = static_cast<char*>(ring->cq_ring_);
+    ring->cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    ring->cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    ring->cq_ring_mask_ =
+        reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    ring->cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    return ring;
+  }
+
+  // Waits for and discards "num_in_flight" completions. Only returns once all
+  // of them are reaped, since the kernel writes into the buffers of the reads
+  // until they complete.
+  void WaitForAll(unsigned num_in_flight) {
+    while (num_in_flight > 0) {
+      if (syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS,
+                  nullptr, 0) < 0 &&
+          errno != EINTR) {
+        // The kernel still posts the completions to the ring, so poll it.
+        usleep(100);
+      }
+      unsigned cq_head = *cq_head_;
+      const unsigned cq_tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+      for (; cq_head != cq_tail && num_in_flight > 0; ++cq_head) {
+        --num_in_flight;
+      }
+      __atomic_store_n(cq_head_, cq_head, __ATOMIC_RELEASE);
+    }
+  }
+
+  int ring_fd_ = -1;
+  bool supported_ = true;
+  unsigned sq_entries_ = 0;
+  void* sq_ring_ = MAP_FAILED;
+  size_t sq_ring_size_ = 0;
+  void* cq_ring_ = MAP_FAILED;
+  size_t cq_ring_size_ = 0;
+  io_uring_sqe* sqes_ = static_cast<io_uring_sqe*>(MAP_FAILED);
+  size_t sqes_size_ = 0;
+
+  // Pointers into the shared rings.
+  unsigned* sq_tail_ = nullptr;
+  unsigned* sq_ring_mask_ = nullptr;
+  unsigned* sq_array_ = nullptr;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned* cq_ring_mask_ = nullptr;
+  io_uring_cqe* cqes_ = nullptr;
+};
+
+}  // namespace
+#endif  // TSL_POSIX_HAVE_IO_URING
+
 // pread() based random-access
 class PosixRandomAccessFile : public RandomAccessFile {
  private:
@@ -97,6 +340,30 @@ class PosixRandomAccessFile : public RandomAccessFile {
     return s;
   }
 
+  absl::Status ReadMany(absl::Span<ReadRequest> requests) const override {
+#if TSL_POSIX_HAVE_IO_URING
+    IoUring* ring = requests.size() > 1 ? IoUring::ForCurrentThread() : nullptr;
+    if (ring != nullptr) {
+      // Finishes a read that io_uring completed short with pread().
+      auto read_rest = [this](ReadRequest& request, size_t bytes_read) {
+        StringPiece rest;
+        request.status =
+            Read(request.offset + bytes_read, request.n - bytes_read, &rest,
+                 request.scratch + bytes_read);
+        request.result = StringPiece(request.scratch, bytes_read + rest.size());
+      };
+      if (ring->ReadMany(fd_, requests, read_rest)) {
+        absl::Status status;
+        for (const ReadRequest& request : requests) {
+          status.Update(request.status);
+        }
+        return status;
+      }
+    }
+#endif  // TSL_POSIX_HAVE_IO_URING
+    return RandomAccessFile::ReadMany(requests);
+  }
+
 #if defined(TF_CORD_SUPPORT)
   absl::Status Read(uint64 offset, size_t n, absl::Cord* cord) const override {
     if (n == 0) {
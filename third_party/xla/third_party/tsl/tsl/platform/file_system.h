@@ -25,6 +25,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/types/span.h"
 #include "tsl/platform/cord.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/file_statistics.h"
@@ -775,6 +776,35 @@ class RandomAccessFile {
   virtual absl::Status Read(uint64 offset, size_t n, StringPiece* result,
                             char* scratch) const = 0;
 
+  /// \brief A byte range to read with `ReadMany()`.
+  struct ReadRequest {
+    uint64 offset = 0;
+    size_t n = 0;
+    /// Must hold `n` bytes, and stay live while `result` is used.
+    char* scratch = nullptr;
+
+    /// Set like `*result` and the returned status of `Read()`.
+    StringPiece result;
+    absl::Status status;
+  };
+
+  /// \brief Reads each of `requests`, like calling `Read()` for each of them,
+  /// but allows the implementation to have all of the reads in flight at
+  /// once instead of blocking on each of them in turn.
+  ///
+  /// Returns the first non-OK status of `requests`, in order.
+  ///
+  /// Safe for concurrent use by multiple threads.
+  virtual absl::Status ReadMany(absl::Span<ReadRequest> requests) const {
+    absl::Status status;
+    for (ReadRequest& request : requests) {
+      request.status =
+          Read(request.offset, request.n, &request.result, request.scratch);
+      status.Update(request.status);
+    }
+    return status;
+  }
+
 #if defined(TF_CORD_SUPPORT)
   /// \brief Read up to `n` bytes from the file starting at `offset`.
   virtual absl::Status Read(uint64 offset, size_t n, absl::Cord* cord) const {
@@ -31,6 +31,9 @@ struct MemoryDebugAnnotation {
   int64_t pending_step_id = 0;
   const char* pending_region_type = nullptr;
   int32_t pending_data_type = 0;
+  // Index of the op output the pending tensor is allocated for, or -1 if it is
+  // not an output.
+  int32_t pending_output_index = -1;
   // A lambda function, when invoked, it will generate the string that describe
   // the shape of the pending tensor. By default, the TensorShape string is an
   // empty string.
@@ -79,7 +82,16 @@ class ScopedMemoryDebugAnnotation {
 
   explicit ScopedMemoryDebugAnnotation(
       const char* op_name, int64_t step_id, const char* region_type,
-      int32_t data_type, std::function<std::string()>&& pending_shape_func) {
+      int32_t data_type, std::function<std::string()>&& pending_shape_func)
+      : ScopedMemoryDebugAnnotation(op_name, step_id, region_type, data_type,
+                                    /*output_index=*/-1,
+                                    std::move(pending_shape_func)) {}
+
+  // Annotates the allocation of output `output_index` of op `op_name`.
+  explicit ScopedMemoryDebugAnnotation(
+      const char* op_name, int64_t step_id, const char* region_type,
+      int32_t data_type, int32_t output_index,
+      std::function<std::string()>&& pending_shape_func) {
     MemoryDebugAnnotation* thread_local_annotation =
         ThreadMemoryDebugAnnotation();
     last_annotation_ = *thread_local_annotation;
@@ -87,6 +99,7 @@ class ScopedMemoryDebugAnnotation {
     thread_local_annotation->pending_step_id = step_id;
     thread_local_annotation->pending_region_type = region_type;
     thread_local_annotation->pending_data_type = data_type;
+    thread_local_annotation->pending_output_index = output_index;
     thread_local_annotation->pending_shape_func = std::move(pending_shape_func);
   }
 
@@ -227,6 +227,7 @@ const StatTypeMap& GetStatTypeMap() {
       {"data_type", kDataType},
       {"shape", kTensorShapes},
       {"layout", kTensorLayout},
+      {"output_index", kOutputIndex},
       {"kpi_name", kKpiName},
       {"kpi_value", kKpiValue},
       {"element_id", kElementId},
@@ -213,6 +213,7 @@ enum StatType {
   kDataType,
   kTensorShapes,
   kTensorLayout,
+  kOutputIndex,
   kKpiName,
   kKpiValue,
   kElementId,
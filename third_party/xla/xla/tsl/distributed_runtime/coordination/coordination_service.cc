@@ -494,8 +494,13 @@ void CoordinationServiceStandaloneImpl::StartCheckStaleness() {
 
 void CoordinationServiceStandaloneImpl::Stop(bool shut_staleness_thread) {
   {
-    absl::MutexLock l(&kv_mu_);
-    for (const auto& [key, get_kv_callbacks] : get_cb_) {
+    absl::flat_hash_map<std::string, std::vector<StatusOrValueCallback>>
+        get_cb;
+    {
+      absl::MutexLock l(&kv_mu_);
+      get_cb.swap(get_cb_);
+    }
+    for (const auto& [key, get_kv_callbacks] : get_cb) {
       for (const auto& get_kv_callback : get_kv_callbacks) {
         get_kv_callback(absl::CancelledError(
             absl::StrCat("Coordination service is shutting down. Cancelling "
@@ -503,7 +508,6 @@ void CoordinationServiceStandaloneImpl::Stop(bool shut_staleness_thread) {
                          key)));
       }
     }
-    get_cb_.clear();
   }
   {
     absl::MutexLock l(&state_mu_);
@@ -956,18 +960,25 @@ absl::Status CoordinationServiceStandaloneImpl::InsertKeyValue(
     const std::string& key, const std::string& value) {
   VLOG(3) << "InsertKeyValue(): " << key << ": " << value;
   const std::string norm_key = NormalizeKey(key);
-  absl::MutexLock l(&kv_mu_);
-  if (kv_store_.find(norm_key) != kv_store_.end()) {
-    return MakeCoordinationError(absl::AlreadyExistsError(
-        absl::StrCat("Config key ", key, " already exists.")));
-  }
-  kv_store_.emplace(norm_key, value);
-  auto iter = get_cb_.find(norm_key);
-  if (iter != get_cb_.end()) {
-    for (const auto& cb : iter->second) {
-      cb(value);
+  std::vector<StatusOrValueCallback> callbacks;
+  {
+    absl::MutexLock l(&kv_mu_);
+    if (kv_store_.find(norm_key) != kv_store_.end()) {
+      return MakeCoordinationError(absl::AlreadyExistsError(
+          absl::StrCat("Config key ", key, " already exists.")));
+    }
+    kv_store_.emplace(norm_key, value);
+    auto iter = get_cb_.find(norm_key);
+    if (iter != get_cb_.end()) {
+      callbacks = std::move(iter->second);
+      get_cb_.erase(iter);
     }
-    get_cb_.erase(iter);
+  }
+  // Respond to the waiting GetKeyValue() calls outside of the lock. With
+  // thousands of tasks waiting for the same key, responding under the lock
+  // would block every other key-value operation until all responses are sent.
+  for (const auto& cb : callbacks) {
+    cb(value);
   }
   return absl::OkStatus();
 }
@@ -976,25 +987,24 @@ void CoordinationServiceStandaloneImpl::GetKeyValueAsync(
     const std::string& key, StatusOrValueCallback done) {
   VLOG(3) << "GetKeyValue(): " << key;
   const std::string norm_key = NormalizeKey(key);
-  absl::MutexLock l(&kv_mu_);
-  const auto& iter = kv_store_.find(norm_key);
-  if (iter != kv_store_.end()) {
-    done(iter->second);
-    return;
-  }
-  auto cb_iter = get_cb_.find(norm_key);
-  if (cb_iter == get_cb_.end()) {
-    cb_iter =
-        get_cb_.emplace(norm_key, std::vector<StatusOrValueCallback>()).first;
+  std::string value;
+  {
+    absl::MutexLock l(&kv_mu_);
+    const auto& iter = kv_store_.find(norm_key);
+    if (iter == kv_store_.end()) {
+      get_cb_[norm_key].emplace_back(std::move(done));
+      return;
+    }
+    value = iter->second;
   }
-  cb_iter->second.emplace_back(std::move(done));
+  done(value);
 }
 
 absl::StatusOr<std::string> CoordinationServiceStandaloneImpl::TryGetKeyValue(
     const std::string& key) {
   VLOG(3) << "TryGetKeyValue(): " << key;
   const std::string norm_key = NormalizeKey(key);
-  absl::MutexLock l(&kv_mu_);
+  absl::ReaderMutexLock l(&kv_mu_);
   const auto& iter = kv_store_.find(norm_key);
   if (iter == kv_store_.end()) {
     return absl::NotFoundError(absl::StrCat("Config key ", key, " not found."));
@@ -1009,10 +1019,10 @@ std::vector<KeyValueEntry> CoordinationServiceStandaloneImpl::GetKeyValueDir(
   const std::string norm_key = NormalizeKey(directory_key);
   const std::string dir = absl::StrCat(norm_key, "/");
 
-  absl::MutexLock l(&kv_mu_);
+  absl::ReaderMutexLock l(&kv_mu_);
   // Find first key in ordered map that has the directory prefix.
   auto begin = kv_store_.lower_bound(dir);
-  std::map<std::string, std::string>::iterator it;
+  std::map<std::string, std::string>::const_iterator it;
   // Iterate through key range that match directory prefix.
   for (it = begin; it != kv_store_.end(); ++it) {
     // Stop once the next key does not have the directory prefix. Since keys are
@@ -562,6 +562,27 @@ TEST_F(CoordinateTwoTasksTest, TestSetGetValues) {
   EXPECT_FALSE(n4->HasBeenNotified());
 }
 
+TEST_F(CoordinateTwoTasksTest, GetKeyValueCallbackAccessesKeyValueStore) {
+  EnableCoordinationService();
+
+  // The callback of a pending GetKeyValue() is invoked without holding the
+  // key-value store lock, so it can access the store itself.
+  absl::Notification n;
+  absl::StatusOr<std::string> ret;
+  coord_service_->GetKeyValueAsync(
+      "key0", [&](const absl::StatusOr<std::string>& status_or_value) {
+        TF_EXPECT_OK(coord_service_->InsertKeyValue("key1", "value1"));
+        ret = coord_service_->TryGetKeyValue("key0");
+        n.Notify();
+      });
+  TF_ASSERT_OK(coord_service_->InsertKeyValue("key0", "value0"));
+  n.WaitForNotification();
+
+  TF_ASSERT_OK(ret.status());
+  EXPECT_EQ(ret.value(), "value0");
+  EXPECT_EQ(coord_service_->TryGetKeyValue("key1").value(), "value1");
+}
+
 TEST(CoordinationServiceTest, TryGetKeyValue) {
   const CoordinationServiceConfig config =
       GetCoordinationServiceConfig(/*num_tasks=*/1);
@@ -80,6 +80,7 @@ class PreemptionSyncManagerImpl : public PreemptionSyncManager {
       CoordinationServiceAgent* agent,
       std::unique_ptr<PreemptionNotifier> notifier) override;
   bool ReachedSyncPoint(int step_counter) override;
+  absl::Time GetDeathTime() override;
 
  private:
   // Determine the sync point upon receipt of preemption notice (death time).
@@ -96,6 +97,11 @@ class PreemptionSyncManagerImpl : public PreemptionSyncManager {
       kPreemptionSyncUnsetCounter;
   std::string current_call_counter_key_;
 
+  // Guarded by its own mutex as `mu_` is held during the whole sync protocol.
+  mutex death_time_mu_;
+  absl::Time death_time_ TF_GUARDED_BY(death_time_mu_) =
+      absl::InfiniteFuture();
+
   Env* env_;                         // Not owned;
   CoordinationServiceAgent* agent_;  // Not owned.
   absl::Notification shutdown_;
@@ -193,6 +199,8 @@ absl::Status PreemptionSyncManagerImpl::Initialize(
                             &death_time, &err)) {
           LOG(INFO) << "Received preemption notice with death_time "
                     << death_time;
+          mutex_lock l(death_time_mu_);
+          death_time_ = death_time;
         } else {
           LOG(ERROR) << "Unable to parse preemption notice's death time: "
                      << err;
@@ -317,6 +325,11 @@ bool PreemptionSyncManagerImpl::ReachedSyncPoint(int step_counter) {
   }
   return reached_sync_point;
 }
+
+absl::Time PreemptionSyncManagerImpl::GetDeathTime() {
+  mutex_lock l(death_time_mu_);
+  return death_time_;
+}
 }  // namespace
 std::unique_ptr<PreemptionSyncManager> CreatePreemptionSyncManager() {
   return std::make_unique<PreemptionSyncManagerImpl>();
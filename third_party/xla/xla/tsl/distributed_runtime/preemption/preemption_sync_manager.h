@@ -18,6 +18,7 @@ limitations under the License.
 #include <memory>
 #include <string>
 
+#include "absl/time/time.h"
 #include "xla/tsl/distributed_runtime/coordination/coordination_service_agent.h"
 #include "xla/tsl/distributed_runtime/preemption/preemption_notifier.h"
 #include "tsl/platform/status.h"
@@ -58,6 +59,14 @@ class PreemptionSyncManager {
   // step to pause training and handle the preemption (e.g. save checkpoint and
   // exit, or wait for preempted task to restart, then resume training).
   virtual bool ReachedSyncPoint(int step_counter) = 0;
+
+  // Returns the death time of the preemption notice propagated to all tasks,
+  // or absl::InfiniteFuture() if no notice has been received yet. Since all
+  // tasks get the same death time, they can use it at the sync point to agree
+  // on how to handle the preemption, e.g. save an emergency checkpoint to
+  // local disk and upload it later when the time left is too short for a
+  // regular checkpoint to remote storage.
+  virtual absl::Time GetDeathTime() = 0;
 };
 
 std::unique_ptr<PreemptionSyncManager> CreatePreemptionSyncManager();
@@ -223,6 +223,19 @@ TEST_F(PreemptionSyncManagerTest, DelayedPreemption_NoSyncPointYet) {
   EXPECT_FALSE(preempt_sync_mgr_->ReachedSyncPoint(step_counter++));
 }
 
+TEST_F(PreemptionSyncManagerTest, Preemption_DeathTimePropagated) {
+  EXPECT_EQ(preempt_sync_mgr_->GetDeathTime(), absl::InfiniteFuture());
+  EXPECT_EQ(preempt_sync_mgr2_->GetDeathTime(), absl::InfiniteFuture());
+
+  const absl::Time death_time =
+      absl::Trunc(absl::Now(), absl::Seconds(1)) + absl::Hours(1);
+  SendPreemptionNotice(death_time);
+
+  // Both tasks see the death time of the notice received by task 1.
+  EXPECT_EQ(preempt_sync_mgr_->GetDeathTime(), death_time);
+  EXPECT_EQ(preempt_sync_mgr2_->GetDeathTime(), death_time);
+}
+
 TEST_F(PreemptionSyncManagerTest, UnhealthyTask_NoSyncPoint) {
   int step_counter = 0;
   // Simulate task doing work and making progress.